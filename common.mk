@@ -24,6 +24,7 @@ ifeq ($(OS),Windows_NT)
 	ASMZ80 := $(BIN)/sjasm.exe
 	MACCER := $(BIN)/mac68k.exe
 	BINTOS := $(BIN)/bintos.exe
+	PERFCHECK := $(BIN)/perfcheck.exe
 	LTO_PLUGIN := --plugin=liblto_plugin-0.dll
 	LIBGCC := $(LIB)/libgcc.a
 else
@@ -42,6 +43,7 @@ else
 		ASMZ80 := $(BIN)/sjasm
 		MACCER := $(BIN)/mac68k
 		BINTOS := $(BIN)/bintos
+		PERFCHECK := $(BIN)/perfcheck
 		LTO_PLUGIN := --plugin=liblto_plugin-0.dll
 		LIBGCC := $(LIB)/libgcc.a
 	else
@@ -60,6 +62,7 @@ else
 		ASMZ80 := sjasm
 		MACCER := mac68k
 		BINTOS := bintos
+		PERFCHECK := perfcheck
 	    LTO_PLUGIN :=
 		LIBGCC := -lgcc
 	endif
@@ -69,3 +72,8 @@ JAVA := java
 ECHO := echo
 SIZEBND := $(JAVA) -jar $(BIN)/sizebnd.jar
 RESCOMP := $(JAVA) -jar $(BIN)/rescomp.jar
+
+# forward resource compilation to a running rescomp server (java -jar rescomp.jar -server <port>), compile locally if not running
+ifneq ($(RESCOMP_SERVER),)
+    RESCOMP := $(RESCOMP) -client $(RESCOMP_SERVER)
+endif
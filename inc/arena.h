@@ -0,0 +1,146 @@
+/**
+ *  \file arena.h
+ *  \brief Linear (arena) memory allocator unit.
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides a linear memory allocator for temporary data.<br>
+ * <br>
+ * An <i>Arena</i> is a fixed memory block (allocated from the heap with MEM_alloc(..)) where allocation is a simple
+ * pointer increment. Individual allocations can't be released, instead the whole arena is reset at once (or rewinded
+ * to a previous mark) which makes it perfect for per frame temporary data (sort keys, collision lists, decompression
+ * scratch buffers...) without any heap fragmentation:<pre>
+ * Arena* arena = ARENA_create(2048);
+ * ...
+ * u16* keys = ARENA_alloc(arena, numObject * sizeof(u16));
+ * void* mark = ARENA_mark(arena);
+ * u8* scratch = ARENA_alloc(arena, 512);
+ * ...
+ * // release scratch buffer only
+ * ARENA_rewind(arena, mark);
+ * ...
+ * // release everything
+ * ARENA_reset(arena);
+ * </pre>
+ * An arena can also be set as the <i>frame arena</i> using #ARENA_setFrameArena(..), it's then automatically reset on
+ * each SYS_doVBlankProcess() call.
+ */
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+
+/**
+ *  \brief
+ *      Arena allocator structure
+ *
+ *  \param start
+ *      start of arena memory
+ *  \param end
+ *      end of arena memory
+ *  \param current
+ *      next allocation position
+ */
+typedef struct
+{
+    u8* start;
+    u8* end;
+    u8* current;
+} Arena;
+
+
+/**
+ *  \brief
+ *      Frame arena (automatically reset on each SYS_doVBlankProcess() call), NULL if not set
+ */
+extern Arena* frameArena;
+
+
+/**
+ *  \brief
+ *      Create and allocate a new arena allocator
+ *
+ *  \param size
+ *      the capacity of the arena (in bytes)
+ *
+ *  \return the new created arena or NULL if there is not enough memory available for that.
+ *
+ *  \see ARENA_destroy(..)
+ */
+Arena* ARENA_create(u16 size);
+/**
+ *  \brief
+ *      Release the specified arena allocator (all allocations from this arena become invalid)
+ *
+ *  \param arena
+ *      Arena allocator to release
+ *
+ *  \see ARENA_create(..)
+ */
+void ARENA_destroy(Arena* arena);
+
+/**
+ *  \brief
+ *      Allocate memory from the specified arena (2 bytes aligned)
+ *
+ *  \param arena
+ *      Arena allocator
+ *  \param size
+ *      Number of bytes to allocate
+ *
+ *  \return the allocated memory or NULL if there is not enough space left in the arena
+ */
+void* ARENA_alloc(Arena* arena, u16 size);
+/**
+ *  \brief
+ *      Release all allocations from the specified arena
+ *
+ *  \param arena
+ *      Arena allocator
+ */
+void ARENA_reset(Arena* arena);
+/**
+ *  \brief
+ *      Returns the current allocation position of the arena so it can be restored later with #ARENA_rewind(..)
+ *
+ *  \param arena
+ *      Arena allocator
+ *
+ *  \see ARENA_rewind(..)
+ */
+void* ARENA_mark(Arena* arena);
+/**
+ *  \brief
+ *      Release all allocations done since the given mark
+ *
+ *  \param arena
+ *      Arena allocator
+ *  \param mark
+ *      position previously obtained with #ARENA_mark(..)
+ *
+ *  \see ARENA_mark(..)
+ */
+void ARENA_rewind(Arena* arena, void* mark);
+/**
+ *  \return
+ *      the free space (in bytes) remaining in the arena
+ *
+ *  \param arena
+ *      Arena allocator
+ */
+u16 ARENA_getFree(Arena* arena);
+
+/**
+ *  \brief
+ *      Set the frame arena which is automatically reset on each SYS_doVBlankProcess() call (after VBlank tasks were done).
+ *
+ *  \param arena
+ *      Arena allocator to use as frame arena (NULL to disable)
+ *
+ *      Data allocated from the frame arena is only valid until the next SYS_doVBlankProcess() call
+ *      (it can be safely used as source of DMA queue transfers).
+ */
+void ARENA_setFrameArena(Arena* arena);
+
+
+#endif // _ARENA_H_
@@ -0,0 +1,111 @@
+/**
+ *  \file asset_cache.h
+ *  \brief Unpacked resource cache unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit keeps unpacked copies of compressed resources (TileSet, TileMap and MapDefinition) in free heap memory so
+ * reloading a resource (as when re-entering a room) doesn't need to unpack it again: the cached copy is returned and only
+ * the VRAM upload remains.<br>
+ * Entries are keyed by the source resource pointer and evicted in least recently used order, either when the cache
+ * budget is exceeded or when #MEM_alloc(..) cannot satisfy an allocation (the cache registers itself as memory reclaim
+ * callback, see #MEM_setReclaimCallback(..)), in that case an unused entry at least as large as the requested block is
+ * evicted first.<br>
+ * An entry is referenced from its get method until #ASSETCACHE_release(..) so it is never evicted while in use:<pre>
+ * ASSETCACHE_init(16 * 1024);
+ * ...
+ * const TileSet* ts = ASSETCACHE_getTileSet(&room_tileset);
+ * VDP_loadTileSet(ts, TILE_USER_INDEX, DMA);
+ * ...
+ * ASSETCACHE_release(&room_tileset);</pre>
+ */
+
+#ifndef _ASSET_CACHE_H_
+#define _ASSET_CACHE_H_
+
+#include "vdp_tile.h"
+#include "map.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of cached resource
+ */
+#define ASSETCACHE_MAX_ENTRY    16
+
+
+/**
+ *  \brief
+ *      Initialize the cache and register it as memory reclaim callback.
+ *
+ *  \param maxSize
+ *      maximum amount of memory (in bytes) used by cached entries (0 = only limited by free memory)
+ */
+void ASSETCACHE_init(u16 maxSize);
+/**
+ *  \brief
+ *      Release all cached entries and unregister the memory reclaim callback.
+ */
+void ASSETCACHE_end(void);
+
+/**
+ *  \brief
+ *      Returns the unpacked version of the given TileSet (unpacked and added to cache if needed).
+ *
+ *  \param src
+ *      source TileSet
+ *  \return unpacked TileSet (<i>src</i> if not compressed) or NULL if there is not enough memory.<br>
+ *      The returned TileSet remains valid until #ASSETCACHE_release(..) is called with <i>src</i>.
+ */
+const TileSet* ASSETCACHE_getTileSet(const TileSet* src);
+/**
+ *  \brief
+ *      Returns the unpacked version of the given TileMap (unpacked and added to cache if needed).
+ *
+ *  \param src
+ *      source TileMap
+ *  \return unpacked TileMap (<i>src</i> if not compressed) or NULL if there is not enough memory.<br>
+ *      The returned TileMap remains valid until #ASSETCACHE_release(..) is called with <i>src</i>.
+ */
+const TileMap* ASSETCACHE_getTileMap(const TileMap* src);
+/**
+ *  \brief
+ *      Returns the unpacked version of the given MapDefinition (unpacked and added to cache if needed).
+ *
+ *  \param src
+ *      source MapDefinition
+ *  \return MapDefinition with unpacked metatiles, blocks and block indexes (<i>src</i> if not compressed) or NULL if there
+ *      is not enough memory. Streamed blocks (#MAP_BLOCKS_STREAM) are kept packed.<br>
+ *      #MAP_create(..) then doesn't need to unpack anything, note that the returned MapDefinition should remain valid
+ *      until the map is released, so call #ASSETCACHE_release(..) only after #MAP_release(..).
+ */
+const MapDefinition* ASSETCACHE_getMapDefinition(const MapDefinition* src);
+/**
+ *  \brief
+ *      Release a reference on the cached copy of the given resource, the entry stays in cache (until evicted).
+ *
+ *  \param src
+ *      source resource (as passed to the get method), ignored if not in cache
+ */
+void ASSETCACHE_release(const void* src);
+
+/**
+ *  \brief
+ *      Evict unused entries (least recently used first) until at least <i>size</i> bytes are released.
+ *
+ *  \return amount of memory (in bytes) released
+ */
+u16 ASSETCACHE_evict(u16 size);
+/**
+ *  \brief
+ *      Evict all unused entries.
+ */
+void ASSETCACHE_flush(void);
+/**
+ *  \brief
+ *      Returns amount of memory (in bytes) used by cached entries.
+ */
+u16 ASSETCACHE_getSize(void);
+
+
+#endif // _ASSET_CACHE_H_
@@ -0,0 +1,160 @@
+/**
+ *  \file asset_dir.h
+ *  \brief ROM asset directory (resource lookup by id)
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * Using the DIRECTORY function in a resource file makes rescomp export an #AssetDirectory of all resources of the file
+ * (read rescomp.txt), so data driven games (level scripts..) can retrieve resources from their id instead of using
+ * the C symbols directly.<br>
+ * The directory is an open addressing hash table of resource id hash so a lookup generally costs a single probe.<br>
+ * Rescomp also defines the hash of each resource as ASSETID_xxx so it doesn't have to be computed at runtime:<pre>
+ * // in level.res: DIRECTORY level_assets
+ * const TileSet* ts = ASSETDIR_get(&level_assets, ASSETID_forest_tileset, ASSET_TYPE_TILESET);
+ * ...
+ * // id from level script
+ * ASSETDIR_loadTileSet(&level_assets, ASSETDIR_hash(script->tilesetName), TILE_USER_INDEX, DMA);</pre>
+ */
+
+#ifndef _ASSET_DIR_H_
+#define _ASSET_DIR_H_
+
+#include "vdp_tile.h"
+#include "dma.h"
+
+
+#define ASSET_TYPE_BIN          0
+#define ASSET_TYPE_PALETTE      1
+#define ASSET_TYPE_TILESET      2
+#define ASSET_TYPE_TILEMAP      3
+#define ASSET_TYPE_MAP          4
+#define ASSET_TYPE_IMAGE        5
+#define ASSET_TYPE_BITMAP       6
+#define ASSET_TYPE_SPRITE       7
+/**
+ *  \brief
+ *      Resource from rescomp extension
+ */
+#define ASSET_TYPE_OTHER        255
+/**
+ *  \brief
+ *      Accept any asset type (see #ASSETDIR_get(..))
+ */
+#define ASSET_TYPE_ANY          0xFFFF
+
+
+/**
+ *  \brief
+ *      Asset directory entry
+ *
+ *  \param hash
+ *      hash of the resource id (see #ASSETDIR_hash(..))
+ *  \param data
+ *      resource pointer (raw data for BIN resource, resource structure otherwise), NULL for empty entry
+ *  \param size
+ *      unpacked size (in bytes) of the resource main binary data (tiles for TileSet or Image, block indexes for Map
+ *      and structure size for Sprite)
+ *  \param type
+ *      resource type (ASSET_TYPE_xxx)
+ *  \param compression
+ *      compression of the resource main binary data (COMPRESSION_xxx)
+ */
+typedef struct
+{
+    u32 hash;
+    const void* data;
+    u32 size;
+    u8 type;
+    u8 compression;
+    u16 reserved;
+} AssetEntry;
+
+/**
+ *  \brief
+ *      Asset directory (exported by rescomp)
+ *
+ *  \param mask
+ *      hash table size - 1 (table size is a power of 2)
+ *  \param num
+ *      number of asset
+ *  \param entries
+ *      hash table entries
+ */
+typedef struct
+{
+    u16 mask;
+    u16 num;
+    const AssetEntry* entries;
+} AssetDirectory;
+
+
+/**
+ *  \brief
+ *      Returns the hash of the given resource id (same as ASSETID_xxx definition generated by rescomp).
+ */
+u32 ASSETDIR_hash(const char* id);
+/**
+ *  \brief
+ *      Find the directory entry for the given resource id hash.
+ *
+ *  \return the entry or NULL if not found
+ */
+const AssetEntry* ASSETDIR_find(const AssetDirectory* dir, u32 id);
+/**
+ *  \brief
+ *      Find the directory entry for the given resource id (name).
+ *
+ *  \return the entry or NULL if not found
+ */
+const AssetEntry* ASSETDIR_findByName(const AssetDirectory* dir, const char* name);
+/**
+ *  \brief
+ *      Returns the resource for the given resource id hash.
+ *
+ *  \param dir
+ *      asset directory
+ *  \param id
+ *      resource id hash (ASSETID_xxx or #ASSETDIR_hash(..))
+ *  \param type
+ *      expected resource type (ASSET_TYPE_xxx) or #ASSET_TYPE_ANY
+ *  \return the resource (TileSet, Map.. structure or raw data for BIN resource) or NULL if not found or not of the expected type
+ */
+const void* ASSETDIR_get(const AssetDirectory* dir, u32 id, u16 type);
+/**
+ *  \brief
+ *      Returns the ROM bank (512 KB) of the main binary data of the given entry (useful to group loads by bank when using
+ *      the bank switch mechanism).
+ */
+u16 ASSETDIR_getBank(const AssetEntry* entry);
+
+/**
+ *  \brief
+ *      Unpack (or copy if not compressed) the given BIN resource in RAM, mapping its bank if needed.
+ *
+ *  \param dir
+ *      asset directory
+ *  \param id
+ *      BIN resource id hash
+ *  \param dest
+ *      destination buffer (should be large enough to store the unpacked data), if NULL a buffer is allocated (release it
+ *      with #MEM_free(..))
+ *  \return the destination buffer or NULL if resource not found (or not enough memory)
+ */
+void* ASSETDIR_loadData(const AssetDirectory* dir, u32 id, void* dest);
+/**
+ *  \brief
+ *      Load the given TileSet resource in VRAM (see #VDP_loadTileSet(..)).
+ *
+ *  \return FALSE if resource not found or not enough memory to unpack it
+ */
+bool ASSETDIR_loadTileSet(const AssetDirectory* dir, u32 id, u16 index, TransferMethod tm);
+/**
+ *  \brief
+ *      Load the given Palette resource in the given palette (see #PAL_setPalette(..)).
+ *
+ *  \return FALSE if resource not found
+ */
+bool ASSETDIR_loadPalette(const AssetDirectory* dir, u32 id, u16 numPal, TransferMethod tm);
+
+
+#endif // _ASSET_DIR_H_
@@ -0,0 +1,268 @@
+/**
+ *  \file async_load.h
+ *  \brief Asynchronous TileSet / Image / Map loading
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * #VDP_loadTileSet(..), #VDP_drawImageEx(..) and #MAP_create(..) unpack and upload compressed data at once which can
+ * freeze the game for several frames on large resources. The methods of this unit do the same work spread over frames
+ * using the idle time job queue (see job.h): LZ4W data is unpacked by chunks (see lz4w.h), other compressions are
+ * unpacked in a single job (which overruns a frame when the data is large), and tiles are queued for DMA within a per
+ * frame budget.<br>
+ * Each load returns a handle which can be polled (#ALOAD_isDone(..)) or signal completion through a callback, so a
+ * room transition can keep sprites animated while the next room is being loaded:<pre>
+ * AsyncLoad* tiles = ALOAD_loadTileSet(room->tileset, TILE_USER_INDEX, NULL, NULL);
+ * AsyncLoad* map = ALOAD_createMap(room->mapDef, BG_A, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USER_INDEX), NULL, NULL);
+ * while(!ALOAD_isDone(tiles) || !ALOAD_isDone(map))
+ * {
+ *     SPR_update();
+ *     SYS_doVBlankProcess();
+ * }
+ * ALOAD_release(tiles);
+ * Map* bga = ALOAD_getMap(map);</pre>
+ * Jobs only run while waiting for VBlank so a game using all its frame time doesn't progress loads, and with a user
+ * task (see task.h) the user task should call #JOB_process().
+ */
+
+#ifndef _ASYNC_LOAD_H_
+#define _ASYNC_LOAD_H_
+
+#include "vdp_tile.h"
+#include "vdp_bg.h"
+#include "map.h"
+#include "lz4w.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of simultaneous load
+ */
+#define ALOAD_MAX_LOAD          4
+
+/**
+ *  \brief
+ *      Default maximum number of byte unpacked per job (see #ALOAD_setBudget(..))
+ */
+#define ALOAD_UNPACK_CHUNK      2048
+/**
+ *  \brief
+ *      Default maximum number of byte queued for DMA per frame (see #ALOAD_setBudget(..))
+ */
+#define ALOAD_DMA_PER_FRAME     2048
+
+/**
+ *  \brief
+ *      Load state: handle not used
+ */
+#define ALOAD_STATE_FREE        0
+/**
+ *  \brief
+ *      Load state: load in progress
+ */
+#define ALOAD_STATE_PENDING     1
+/**
+ *  \brief
+ *      Load state: load completed
+ */
+#define ALOAD_STATE_DONE        2
+/**
+ *  \brief
+ *      Load state: load failed (not enough memory...)
+ */
+#define ALOAD_STATE_FAILED      3
+/**
+ *  \brief
+ *      Load state: released while in progress, handle is freed once queued transfers are done
+ */
+#define ALOAD_STATE_CANCELED    4
+
+
+typedef struct _asyncLoad AsyncLoad;
+
+/**
+ *  \brief
+ *      Load completion callback (called from the job queue, see job.h)
+ *
+ *  \param load
+ *      completed (or failed) load
+ *  \param data
+ *      user data given to the load method
+ */
+typedef void AsyncLoadCallback(AsyncLoad* load, void* data);
+
+/**
+ *  \brief
+ *      Asynchronous load handle (should be considered as opaque).
+ *
+ *  \param state
+ *      load state (ALOAD_STATE_xxx)
+ *  \param type
+ *      loaded resource type
+ *  \param step
+ *      current unpack section (Map)
+ *  \param compression
+ *      current unpack compression
+ *  \param src
+ *      packed / source data
+ *  \param dest
+ *      unpack buffer (NULL if data is transferred directly from source)
+ *  \param size
+ *      current section size (in byte)
+ *  \param unpacked
+ *      current section unpacked size (in byte)
+ *  \param sent
+ *      number of byte already queued for DMA
+ *  \param vramAddr
+ *      VRAM destination address
+ *  \param frame
+ *      frame (low 16 bits of vtimer) of the last DMA transfer
+ *  \param frameSent
+ *      number of byte queued for DMA on <i>frame</i>
+ *  \param stream
+ *      LZ4W streaming decoder
+ *  \param image
+ *      loaded Image (NULL for TileSet / Map)
+ *  \param plane
+ *      Image / Map plane
+ *  \param basetile
+ *      Image / Map base tile attributes
+ *  \param x
+ *      Image X position (in tile)
+ *  \param y
+ *      Image Y position (in tile)
+ *  \param loadpal
+ *      load Image palette
+ *  \param mapDef
+ *      source MapDefinition
+ *  \param unpackedDef
+ *      unpacked MapDefinition (owned by the handle)
+ *  \param map
+ *      created Map
+ *  \param callback
+ *      completion callback
+ *  \param data
+ *      callback user data
+ */
+struct _asyncLoad
+{
+    u16 state;
+    u16 type;
+    u16 step;
+    u16 compression;
+    const u8* src;
+    u8* dest;
+    u32 size;
+    u32 unpacked;
+    u32 sent;
+    u16 vramAddr;
+    u16 frame;
+    u16 frameSent;
+    LZ4WStream stream;
+    const Image* image;
+    VDPPlane plane;
+    u16 basetile;
+    u16 x;
+    u16 y;
+    bool loadpal;
+    const MapDefinition* mapDef;
+    MapDefinition* unpackedDef;
+    Map* map;
+    AsyncLoadCallback* callback;
+    void* data;
+};
+
+
+/**
+ *  \brief
+ *      Set the amount of work done for pending loads.
+ *
+ *  \param unpackChunk
+ *      maximum number of byte unpacked by a job (LZ4W data only, default is #ALOAD_UNPACK_CHUNK)
+ *  \param dmaPerFrame
+ *      maximum number of byte queued for DMA per frame and per load (default is #ALOAD_DMA_PER_FRAME)
+ */
+void ALOAD_setBudget(u16 unpackChunk, u16 dmaPerFrame);
+
+/**
+ *  \brief
+ *      Asynchronous version of #VDP_loadTileSet(..)
+ *
+ *  \param tileset
+ *      tileset to load
+ *  \param index
+ *      tile position in VRAM where we will upload the tileset
+ *  \param callback
+ *      completion callback (can be NULL)
+ *  \param data
+ *      callback user data
+ *  \return load handle or NULL if no handle is available (#ALOAD_MAX_LOAD) or the job queue is full.<br>
+ *      Handle should be released with #ALOAD_release(..) once done.
+ */
+AsyncLoad* ALOAD_loadTileSet(const TileSet* tileset, u16 index, AsyncLoadCallback* callback, void* data);
+/**
+ *  \brief
+ *      Asynchronous version of #VDP_drawImageEx(..): tiles are loaded first then tilemap (and palette) are set when all
+ *      tiles are in VRAM.
+ *
+ *  \param plane
+ *      Plane where we want to draw the image.
+ *  \param image
+ *      Image to draw.
+ *  \param basetile
+ *      Base tile attributes data (see TILE_ATTR_FULL() macro).
+ *  \param x
+ *      Plane X position (in tile).
+ *  \param y
+ *      Plane Y position (in tile).
+ *  \param loadpal
+ *      Load image palette data if set to TRUE.
+ *  \param callback
+ *      completion callback (can be NULL)
+ *  \param data
+ *      callback user data
+ *  \return load handle or NULL if no handle is available or the job queue is full
+ */
+AsyncLoad* ALOAD_drawImage(VDPPlane plane, const Image* image, u16 basetile, u16 x, u16 y, bool loadpal, AsyncLoadCallback* callback, void* data);
+/**
+ *  \brief
+ *      Asynchronous version of #MAP_create(..): compressed map data is unpacked into a buffer owned by the handle then
+ *      the Map is created (get it with #ALOAD_getMap(..)).<br>
+ *      The map tileset isn't loaded (use #ALOAD_loadTileSet(..)), release the handle only after #MAP_release(..).
+ *
+ *  \param mapDef
+ *      MapDefinition structure containing background/plane data.
+ *  \param plane
+ *      Plane where we want to draw the Map.
+ *  \param baseTile
+ *      Used to provide base tile index and base palette index (see TILE_ATTR_FULL() macro).
+ *  \param callback
+ *      completion callback (can be NULL)
+ *  \param data
+ *      callback user data
+ *  \return load handle or NULL if no handle is available or the job queue is full
+ */
+AsyncLoad* ALOAD_createMap(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile, AsyncLoadCallback* callback, void* data);
+
+/**
+ *  \brief
+ *      Returns the load state (ALOAD_STATE_xxx).
+ */
+u16 ALOAD_getState(const AsyncLoad* load);
+/**
+ *  \brief
+ *      Returns TRUE when the load is completed or failed.
+ */
+bool ALOAD_isDone(const AsyncLoad* load);
+/**
+ *  \brief
+ *      Returns the Map created by #ALOAD_createMap(..) (NULL if not yet done or failed).
+ */
+Map* ALOAD_getMap(const AsyncLoad* load);
+/**
+ *  \brief
+ *      Release the load handle (and its buffers), a load in progress is canceled.
+ */
+void ALOAD_release(AsyncLoad* load);
+
+
+#endif // _ASYNC_LOAD_H_
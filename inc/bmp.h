@@ -147,6 +147,7 @@
  *      <b>COMPRESSION_NONE</b><br>
  *      <b>COMPRESSION_APLIB</b><br>
  *      <b>COMPRESSION_LZ4W</b><br>
+ *      <b>COMPRESSION_DLZ</b><br>
  *  \param w
  *      Width in pixel.
  *  \param h
@@ -222,6 +223,47 @@ typedef struct
     u16 col;
 } Triangle;
 
+/**
+ *  \brief
+ *          Horizontal mirror flag for #BMP_createScale(..)
+ */
+#define BMP_SCALE_HFLIP             (1 << 0)
+/**
+ *  \brief
+ *          Vertical mirror flag for #BMP_createScale(..)
+ */
+#define BMP_SCALE_VFLIP             (1 << 1)
+
+/**
+ *  \brief
+ *          Precomputed bitmap scaling descriptor (see #BMP_createScale(..)).
+ *
+ *  \param srcW
+ *          source width (in pixel).
+ *  \param srcH
+ *          source height (in pixel).
+ *  \param dstW
+ *          destination width (in pixel, even value).
+ *  \param dstH
+ *          destination height (in pixel).
+ *  \param flags
+ *          mirror flags (BMP_SCALE_HFLIP / BMP_SCALE_VFLIP).
+ *  \param cols
+ *          source byte for each destination byte (dstW / 2 entries).
+ *  \param rows
+ *          source line for each destination line (dstH entries).
+ */
+typedef struct
+{
+    u16 srcW;
+    u16 srcH;
+    u16 dstW;
+    u16 dstH;
+    u16 flags;
+    u16 *cols;
+    u16 *rows;
+} BitmapScale;
+
 
 /**
  *      Current bitmap read buffer.
@@ -257,6 +299,34 @@ extern u8 *bmp_buffer_write;
  * Requires ~41 KB of memory which is dynamically allocated.
  */
 void BMP_init(u16 double_buffer, VDPPlane plane, u16 palette, u16 priority);
+/**
+ *  \brief
+ *      Initialize the software bitmap engine with custom view size and buffer layout.
+ *
+ *  \param double_buffer
+ *      Enabled VRAM double buffer (see #BMP_init(..)).
+ *  \param plane
+ *      Plane to use to display the bitmap (BG_A or BG_B).
+ *  \param palette
+ *      Palette index to use to render the bitmap plane.
+ *  \param priority
+ *      Set the priority of bitmap plane.
+ *  \param tileWidth
+ *      view width in tile (1-32), view is centered on screen.
+ *  \param tileHeight
+ *      view height in tile (1-20), view is centered on screen and blank area is extended to fit it.
+ *  \param tileLayout
+ *      FALSE to use the linear buffer layout (default), TRUE to store bitmap buffer in VDP tile order.
+ *
+ * A smaller view transfers less data on flip (a 256x128 letterboxed view flips faster than the full 256x160 one)
+ * and leaves a larger extended blank.<br>
+ * Drawing methods clip to view size, coordinates stay relative to top left corner of the view.<br>
+ * With tile layout the buffer is directly DMA'd in VRAM on flip (no CPU conversion) which is about twice faster,
+ * drawing methods are still available but access pixels through C code, #BMP_drawBitmapScaled(..) isn't supported
+ * and #BMP_getWritePointer(..) only gives access to the 8 pixels tile line containing the pixel.<br>
+ * Memory requirement is the same as #BMP_init(..).
+ */
+void BMP_initEx(u16 double_buffer, VDPPlane plane, u16 palette, u16 priority, u16 tileWidth, u16 tileHeight, u16 tileLayout);
 /**
  *  \brief
  *      End the software bitmap engine.
@@ -283,6 +353,44 @@ void BMP_reset(void);
  * By default buffer copy is disabled for obvious performance reason.
  */
 void BMP_setBufferCopy(u16 value);
+/**
+ *  \brief
+ *      Enable / disable dirty tile row blit.
+ *
+ *  \param value
+ *      TRUE to enable, FALSE to disable (default).
+ *
+ * When enabled, flip only transfers tile rows (8 pixels lines) which were modified by drawing methods
+ * (BMP_setPixel.., BMP_drawLine(..), BMP_drawPolygon(..), BMP_drawBitmap..(..), BMP_clear()...) so scenes where
+ * only a part of the bitmap is redrawn flip faster (unmodified rows cost nothing).<br>
+ * Data written directly through BMP_getWritePointer(..) should be declared with #BMP_markDirty(..).
+ */
+void BMP_setDirtyBlit(u16 value);
+/**
+ *  \brief
+ *      Mark bitmap lines of the write buffer as modified (see #BMP_setDirtyBlit(..)).
+ *
+ *  \param y
+ *      first modified line
+ *  \param h
+ *      number of modified line
+ */
+void BMP_markDirty(u16 y, u16 h);
+/**
+ *  \brief
+ *      Returns bitmap view width (in pixel) as set with #BMP_initEx(..)
+ */
+u16 BMP_getWidth(void);
+/**
+ *  \brief
+ *      Returns bitmap view height (in pixel) as set with #BMP_initEx(..)
+ */
+u16 BMP_getHeight(void);
+/**
+ *  \brief
+ *      Returns TRUE if bitmap buffer uses the tile ordered layout (see #BMP_initEx(..))
+ */
+u16 BMP_isTileLayout(void);
 /**
  *  \brief
  *      Flip bitmap buffer to screen.
@@ -558,6 +666,75 @@ u16 BMP_isPolygonCulled(const Vect2D_s16 *pts, u16 num);
  *  \return 0 if polygon was not drawn (outside screen or whatever).
  */
 u16 BMP_drawPolygon(const Vect2D_s16 *pts, u16 num, u8 col);
+/**
+ *  \brief
+ *      Fill a horizontal span (clipped to bitmap).<br>
+ *      Edge pixels are written by nibble, inner pixels by byte then by long so long spans are filled at
+ *      almost memory bandwidth.
+ *
+ *  \param x0
+ *      first pixel X coordinate.
+ *  \param x1
+ *      last pixel X coordinate (inclusive).
+ *  \param y
+ *      Y coordinate.
+ *  \param col
+ *      fill color (should be doubled: 0x11, 0x22...).
+ */
+void BMP_fillSpan(s16 x0, s16 x1, s16 y, u8 col);
+/**
+ *  \brief
+ *      Fill a rectangle (clipped to bitmap).
+ *
+ *  \param x
+ *      X coordinate.
+ *  \param y
+ *      Y coordinate.
+ *  \param w
+ *      width.
+ *  \param h
+ *      height.
+ *  \param col
+ *      fill color (should be doubled: 0x11, 0x22...).
+ */
+void BMP_fillRect(s16 x, s16 y, s16 w, s16 h, u8 col);
+/**
+ *  \brief
+ *      Copy a horizontal span of 4BPP pixels (textured span) in bitmap (clipped to bitmap).<br>
+ *      When source and destination have the same pixel alignment the span is copied by byte, otherwise pixels
+ *      are realigned on the fly.
+ *
+ *  \param src
+ *      4BPP source line data.
+ *  \param srcX
+ *      first source pixel.
+ *  \param x
+ *      destination X coordinate.
+ *  \param y
+ *      destination Y coordinate.
+ *  \param len
+ *      number of pixel to copy.
+ */
+void BMP_copySpan(const u8 *src, u16 srcX, s16 x, s16 y, s16 len);
+/**
+ *  \brief
+ *      Copy a horizontal span from a Genesis Bitmap line (see #BMP_copySpan(..)).
+ *
+ *  \param bitmap
+ *      Genesis Bitmap (should not be compressed).
+ *  \param srcX
+ *      first source pixel.
+ *  \param srcY
+ *      source line.
+ *  \param x
+ *      destination X coordinate.
+ *  \param y
+ *      destination Y coordinate.
+ *  \param len
+ *      number of pixel to copy (clipped to bitmap line).
+ *  \return FALSE if bitmap is compressed or srcY is outside bitmap.
+ */
+u16 BMP_drawBitmapSpan(const Bitmap *bitmap, u16 srcX, u16 srcY, s16 x, s16 y, s16 len);
 
 /**
  *  \brief
@@ -631,6 +808,49 @@ u16 BMP_drawBitmap(const Bitmap *bitmap, u16 x, u16 y, u16 loadpal);
  * So BMP_drawBitmapScaled(bitmap,0,0,w,h,pal) will produce same result as BMP_drawBitmapScaled(bitmap,1,0,w,h,pal)
  */
 u16 BMP_drawBitmapScaled(const Bitmap *bitmap, u16 x, u16 y, u16 w, u16 h, u16 loadpal);
+/**
+ *  \brief
+ *      Create a scaling descriptor to draw bitmaps of a given size at a given size.<br>
+ *      Source row / column stepping is computed once here so the descriptor can be kept and reused on each frame
+ *      (zoom effects) with #BMP_drawBitmapScaledEx(..).
+ *
+ *  \param srcW
+ *      source bitmap width.
+ *  \param srcH
+ *      source bitmap height.
+ *  \param dstW
+ *      final width (aligned to even value).
+ *  \param dstH
+ *      final height.
+ *  \param flags
+ *      BMP_SCALE_HFLIP and / or BMP_SCALE_VFLIP to mirror the bitmap, 0 otherwise.
+ *  \return
+ *      the scaling descriptor or NULL if there is not enough memory (use MEM_free(..) or #BMP_releaseScale(..) to release it).
+ */
+BitmapScale* BMP_createScale(u16 srcW, u16 srcH, u16 dstW, u16 dstH, u16 flags);
+/**
+ *  \brief
+ *      Release a scaling descriptor created with #BMP_createScale(..)
+ */
+void BMP_releaseScale(BitmapScale *scale);
+/**
+ *  \brief
+ *      Draw a Genesis Bitmap using a precomputed scaling descriptor (clipped to bitmap view).
+ *
+ *  \param bitmap
+ *      Genesis bitmap (at least as large as descriptor source size).<br>
+ *      The Bitmap is unpacked "on the fly" if needed (require some memory), use uncompressed bitmap for per frame zoom.
+ *  \param x
+ *      X coordinate (aligned to even value).
+ *  \param y
+ *      y coordinate.
+ *  \param scale
+ *      scaling descriptor.
+ *  \return
+ *      FALSE if bitmap is smaller than descriptor source size, if there is not enough memory to unpack it or if
+ *      tile layout is used.
+ */
+u16 BMP_drawBitmapScaledEx(const Bitmap *bitmap, s16 x, s16 y, const BitmapScale *scale);
 
 /**
  *  \deprecated
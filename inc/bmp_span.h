@@ -0,0 +1,101 @@
+/**
+ *  \file bmp_span.h
+ *  \brief Span buffer (s-buffer) polygon renderer for the bitmap engine
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit renders a whole set of flat shaded polygons in the bitmap engine write buffer with a single pass where
+ * each pixel is filled only once.<br>
+ * Polygons are first submitted with a depth value (they're only stored), #SPAN_render() then sorts them front to back
+ * and converts each of them to horizontal spans which are clipped against the spans already drawn on the line
+ * (s-buffer), only the visible part of each span is filled.<br>
+ * Compared to drawing polygons back to front with BMP_drawPolygon(..) (painter algorithm) there is no overdraw so
+ * complex or overlapping objects render faster:<pre>
+ * SPAN_init(64, 256, 1024);
+ * ...
+ * M3D_transform(&transformation, mesh_coord, pts_3D, numVertex);
+ * M3D_project_s16(pts_3D, pts_2D, numVertex);
+ * SPAN_addFaces(pts_2D, mesh_face_ind, 4, numFace, faceCols, faceDepths, TRUE);
+ * SPAN_render();
+ * BMP_flip(TRUE);</pre>
+ */
+
+#ifndef _BMP_SPAN_H_
+#define _BMP_SPAN_H_
+
+#include "bmp.h"
+
+
+/**
+ *  \brief
+ *      Initialize the span renderer.
+ *
+ *  \param maxPoly
+ *      maximum number of polygon per render
+ *  \param maxPoint
+ *      maximum number of polygon point per render (sum of point of all polygons)
+ *  \param maxSpan
+ *      maximum number of drawn span kept for occlusion (merged spans count for one), 4 to 8 per bitmap line
+ *      is generally enough
+ *  \return FALSE if there is not enough memory
+ */
+bool SPAN_init(u16 maxPoly, u16 maxPoint, u16 maxSpan);
+/**
+ *  \brief
+ *      End the span renderer and release memory.
+ */
+void SPAN_end(void);
+/**
+ *  \brief
+ *      Remove all submitted polygons.
+ */
+void SPAN_clear(void);
+/**
+ *  \brief
+ *      Submit a polygon for next #SPAN_render() call.
+ *
+ *  \param pts
+ *      Polygon points (convex polygon, points are copied).
+ *  \param num
+ *      number of point.
+ *  \param col
+ *      fill color (should be 8 bits filled: 0x00, 0x11, .. as for BMP_drawPolygon(..)).
+ *  \param depth
+ *      polygon depth, smaller value is nearer (drawn in front).
+ *  \return FALSE if there is no more polygon or point slot.
+ */
+bool SPAN_addPolygon(const Vect2D_s16 *pts, u16 num, u8 col, s16 depth);
+/**
+ *  \brief
+ *      Submit a set of indexed faces (mesh) for next #SPAN_render() call.
+ *
+ *  \param pts
+ *      projected points (M3D_project_s16(..) output).
+ *  \param indexes
+ *      face point indexes (vertPerFace indexes per face).
+ *  \param vertPerFace
+ *      number of point per face (3 for triangles, 4 for quads...).
+ *  \param numFace
+ *      number of face.
+ *  \param cols
+ *      color of each face (8 bits filled).
+ *  \param depths
+ *      depth of each face (smaller value is nearer).
+ *  \param cull
+ *      if TRUE back faced faces (see BMP_isPolygonCulled(..)) are ignored.
+ *  \return number of face submitted (culled faces excluded).
+ */
+u16 SPAN_addFaces(const Vect2D_s16 *pts, const u16 *indexes, u16 vertPerFace, u16 numFace, const u8 *cols, const s16 *depths, bool cull);
+/**
+ *  \brief
+ *      Render all submitted polygons in bitmap write buffer (front to back, each pixel filled once) then clear the
+ *      polygon list.
+ *
+ *  \return number of span filled.
+ *
+ *  Note that render is done on top of current write buffer content, only pixels covered by polygons are modified.
+ */
+u16 SPAN_render(void);
+
+
+#endif // _BMP_SPAN_H_
@@ -0,0 +1,215 @@
+/**
+ *  \file collision.h
+ *  \brief Collision broadphase unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit finds all colliding pairs among a set of collision bodies (boxes and circles) without testing every pair.<br>
+ * <br>
+ * Bodies are added each frame (directly or from the hit / attack collision of a sprite current animation frame, flip
+ * adjusted) then #COL_getPairs(..) sorts them on their left edge and sweeps the sorted list so only bodies overlapping
+ * on X are tested (sort and sweep), layer masks are checked before any box / circle test.<br>
+ * Coordinates are in pixel (use fix16ToInt(..) / fix32ToInt(..) for fixed point positions) and circle tests are done
+ * with 32 bit squared distances:<pre>
+ * COL_init(64);
+ * ...
+ * COL_clear();
+ * COL_addSprite(player->sprite, FALSE, LAYER_PLAYER, LAYER_ENEMY | LAYER_BULLET, player);
+ * for(u16 i = 0; i < numEnemy; i++)
+ *     COL_addSprite(enemies[i].sprite, TRUE, LAYER_ENEMY, 0, &enemies[i]);
+ * const u16 n = COL_getPairs(pairs, 32);
+ * for(u16 i = 0; i < n; i++) onHit(pairs[i].a->data, pairs[i].b->data);</pre>
+ * Sprites using the MASK collision type (see rescomp.txt) also have a 1bpp mask per animation frame, the broadphase
+ * uses the mask bounding box and #COL_testSpriteMasks(..) refines the found pairs per pixel.
+ */
+
+#ifndef _COLLISION_H_
+#define _COLLISION_H_
+
+#include "sprite_eng.h"
+
+
+/**
+ *  \brief
+ *      Collision body
+ *
+ *  \param x
+ *      bounding box X position (left, in pixel)
+ *  \param y
+ *      bounding box Y position (top, in pixel)
+ *  \param w
+ *      bounding box width (circle diameter)
+ *  \param h
+ *      bounding box height (circle diameter)
+ *  \param type
+ *      body shape (#COLLISION_TYPE_BOX or #COLLISION_TYPE_CIRCLE)
+ *  \param layer
+ *      layers the body belongs to (bit mask)
+ *  \param mask
+ *      layers the body collides with (bit mask)
+ *  \param data
+ *      user data (owner object...)
+ */
+typedef struct
+{
+    s16 x;
+    s16 y;
+    u16 w;
+    u16 h;
+    u16 type;
+    u16 layer;
+    u16 mask;
+    void* data;
+} ColBody;
+
+/**
+ *  \brief
+ *      Colliding body pair (see #COL_getPairs(..))
+ *
+ *  \param a
+ *      first body (its mask matches <i>b</i> layers)
+ *  \param b
+ *      second body
+ */
+typedef struct
+{
+    ColBody* a;
+    ColBody* b;
+} ColPair;
+
+
+/**
+ *  \brief
+ *      Initialize the collision unit for the given maximum number of body.
+ *
+ *  \return FALSE if there is not enough memory
+ */
+bool COL_init(u16 maxBody);
+/**
+ *  \brief
+ *      Release the collision unit.
+ */
+void COL_end(void);
+
+/**
+ *  \brief
+ *      Remove all bodies (should be done on each frame before adding bodies).
+ */
+void COL_clear(void);
+/**
+ *  \brief
+ *      Returns the number of added bodies.
+ */
+u16 COL_getNumBody(void);
+
+/**
+ *  \brief
+ *      Add a box body.
+ *
+ *  \param x
+ *      box X position (left)
+ *  \param y
+ *      box Y position (top)
+ *  \param w
+ *      box width
+ *  \param h
+ *      box height
+ *  \param layer
+ *      layers the body belongs to
+ *  \param mask
+ *      layers the body collides with
+ *  \param data
+ *      user data
+ *  \return the added body or NULL if the maximum number of body is reached
+ */
+ColBody* COL_addBox(s16 x, s16 y, u16 w, u16 h, u16 layer, u16 mask, void* data);
+/**
+ *  \brief
+ *      Add a circle body.
+ *
+ *  \param x
+ *      circle center X position
+ *  \param y
+ *      circle center Y position
+ *  \param ray
+ *      circle ray
+ *  \param layer
+ *      layers the body belongs to
+ *  \param mask
+ *      layers the body collides with
+ *  \param data
+ *      user data
+ *  \return the added body or NULL if the maximum number of body is reached
+ */
+ColBody* COL_addCircle(s16 x, s16 y, u16 ray, u16 layer, u16 mask, void* data);
+/**
+ *  \brief
+ *      Add a body from the collision of the sprite current animation frame (H / V flip are applied).
+ *
+ *  \param sprite
+ *      sprite
+ *  \param attack
+ *      use the attack collision instead of the hit collision
+ *  \param layer
+ *      layers the body belongs to
+ *  \param mask
+ *      layers the body collides with
+ *  \param data
+ *      user data
+ *  \return the added body or NULL if the frame has no collision or the maximum number of body is reached
+ */
+ColBody* COL_addSprite(const Sprite* sprite, bool attack, u16 layer, u16 mask, void* data);
+
+/**
+ *  \brief
+ *      Test if the 2 given bodies collide (layers are not checked).
+ */
+bool COL_testBodies(const ColBody* a, const ColBody* b);
+/**
+ *  \brief
+ *      Find all colliding body pairs (sort and sweep broadphase then box / circle test).<br>
+ *      A pair is reported once when a body mask matches the other body layers, the body whose mask matches is stored
+ *      in <i>a</i> (first body in sort order if both match).
+ *
+ *  \param pairs
+ *      destination pair array
+ *  \param maxPair
+ *      size of the pair array (search stops when it's full)
+ *  \return number of pair found
+ */
+u16 COL_getPairs(ColPair* pairs, u16 maxPair);
+
+/**
+ *  \brief
+ *      Per pixel test of 2 collision masks (see MASK collision type in rescomp.txt), rows are tested with shifted 32 bit
+ *      AND so it should only be used on bodies which passed the broadphase test (#COL_getPairs(..)).
+ *
+ *  \param a
+ *      first mask
+ *  \param flipA
+ *      first mask flip variant ((vflip << 1) | hflip), unflipped mask is used if the variant isn't available
+ *  \param ax
+ *      first mask area X position (left, in pixel)
+ *  \param ay
+ *      first mask area Y position (top, in pixel)
+ *  \param b
+ *      second mask
+ *  \param flipB
+ *      second mask flip variant
+ *  \param bx
+ *      second mask area X position
+ *  \param by
+ *      second mask area Y position
+ *  \return TRUE if at least one opaque pixel of each mask overlaps
+ */
+bool COL_testMasks(const CollisionMask* a, u16 flipA, s16 ax, s16 ay, const CollisionMask* b, u16 flipB, s16 bx, s16 by);
+/**
+ *  \brief
+ *      Per pixel test of the collision masks of the 2 sprites current animation frame (H / V flip are applied).<br>
+ *      Should be called on a colliding pair from #COL_getPairs(..), returns TRUE if a frame has no mask (broadphase
+ *      result is kept).
+ */
+bool COL_testSpriteMasks(const Sprite* a, const Sprite* b);
+
+
+#endif // _COLLISION_H_
@@ -73,6 +73,95 @@
  */
 #define DMA_DISABLED        0
 
+/**
+ *  \brief
+ *      Set it to 1 to enable DMA queue statistics (bytes and entries per frame, dropped transfers, VBlank overrun...).<br>
+ *      Statistics can then be read using DMA_getStats() to tune DMA_initEx(..) settings, it adds a bit of overhead to the DMA queue.
+ */
+#define ENABLE_DMA_STATS    0
+
+/**
+ *  \brief
+ *      Set it to 1 to enable heap allocation tracing (tag per allocation, allocated memory watermark, smallest largest free block...).<br>
+ *      Tracing data can be dumped with MEM_dumpTrace() to tune DMA_initEx(..) buffers or pool sizes, it adds overhead to MEM_alloc(..) / MEM_free(..)
+ *      and uses about 1.5 KB of RAM.
+ */
+#define ENABLE_MEM_TRACE    0
+
+/**
+ *  \brief
+ *      Set it to 1 to enable Map streaming statistics (columns / rows / tiles prepared per frame, preparation time, worst frame...).<br>
+ *      Statistics can be read using MAP_getStats() to tune DMA_setMaxTransferSize(..) and find level sections causing slowdowns.
+ */
+#define ENABLE_MAP_STATS    0
+
+/**
+ *  \brief
+ *      Set it to 1 to enable the frame profiler (see profiler.h), when disabled PROF_begin(..) / PROF_end(..) zones cost nothing.<br>
+ *      Library zones measure the VBlank process, DMA queue flush, sprite engine update, Map streaming and joypad polling.
+ */
+#define ENABLE_PROFILER     0
+
+/**
+ *  \brief
+ *      Set it to 1 to buffer KLog_xxx(..) records in RAM (texts and raw values) instead of formatting and sending
+ *      them to the debug port immediately.<br>
+ *      Records are formatted and sent by KLog_flush(), automatically called by SYS_doVBlankProcess() at end of frame, so
+ *      logging costs a small and constant time per call and doesn't distort timing (profiling, SPR_DEBUG...).<br>
+ *      Text located in ROM (string literals) is stored as a pointer while any other text (RAM / stack buffer) is copied
+ *      in the record (truncated to 63 characters), kprintf(..) is never buffered.
+ */
+#define ENABLE_KLOG_BUFFER  0
+
+/**
+ *  \brief
+ *      Size of the KLog record buffer in long word (must be a power of 2), a KLog_U2(..) record uses 5 long words.
+ */
+#define KLOG_BUFFER_SIZE    512
+
+/**
+ *  \brief
+ *      Set it to 1 to record a binary trace of timestamped begin / end events (profiler zones, V-Int / H-Int handlers,
+ *      XGM sound commands and user events, see trace.h).<br>
+ *      The trace can be converted to Chrome trace JSON with the tracedec tool (tools/tracedec) to get a frame timeline.
+ */
+#define ENABLE_TRACE        0
+
+/**
+ *  \brief
+ *      Size of the trace event ring buffer in event (long word, must be a power of 2 and <= 32768).
+ */
+#define TRACE_BUFFER_SIZE   512
+
+/**
+ *  \brief
+ *      Set it to 1 to send trace events to the KDebug port (as text lines) at end of frame, otherwise events are only kept
+ *      in the RAM ring buffer (last TRACE_BUFFER_SIZE events) which can be dumped from the emulator.
+ */
+#define TRACE_KDEBUG        1
+
+/**
+ *  \brief
+ *      Set it to 1 to place the DMA queue and DMA data buffer in the static RAM region (see RAM_REGION) instead of the heap.<br>
+ *      DMA_initEx(..) then doesn't allocate nor pack memory anymore, queue and buffer sizes are limited to DMA_QUEUE_SIZE_STATIC
+ *      and DMA_BUFFER_SIZE_STATIC.
+ */
+#define ENABLE_DMA_STATIC_MEMORY    0
+
+/**
+ *  \brief
+ *      Set it to 1 to automatically save a crash dump in SRAM on CPU exception (see SYS_hasCrashDump()).<br>
+ *      The dump contains exception state, registers, stack, last frames CPU load, missed frames, DMA queue statistics,
+ *      profiler zones and heap summary, it can be decoded on PC with the crashdump tool (tools/crashdump).
+ */
+#define ENABLE_CRASH_DUMP   0
+
+/**
+ *  \brief
+ *      SRAM offset (in byte) where the crash dump is saved (needs up to 512 bytes, default is end of 32 KB SRAM).
+ */
+#define CRASH_DUMP_SRAM_OFFSET      0x7E00
+
 /**
  *  \brief
  *      Set it to 1 to enable automatic bank switch using official SEGA mapper for ROM > 4MB.
@@ -83,6 +172,15 @@
  */
 #define ENABLE_BANK_SWITCH  0
 
+/**
+ *  \brief
+ *      First 512 KB region used as bank window for far data access when bank switch is enabled (accepted values: 1-6).
+ *
+ *      Regions from this one to region 7 (0x380000-0x3FFFFF) are managed as a cache of banks (see mapper.h) so
+ *      code and data not accessed through FAR(..) methods should be located below (default is 6 = 0x300000).
+ */
+#define BANK_SWITCH_FIRST_REGION    6
+
 /**
  *  \brief
  *      Set it to 1 if you want to use newlib with SGDK.<br>
@@ -124,11 +222,39 @@
 #error "Cannot enable FAT16 module without EVERDRIVE module"
 #endif
 
+/**
+ *  \brief
+ *      Set it to 1 if you want to load tilesets / palettes from Everdrive SD card for development hot reload (see devload.h).<br>
+ *      This cost about 3 KB of RAM.
+ */
+#define MODULE_DEVLOAD      0
+
+// DEVLOAD need FAT16
+#if ((MODULE_FAT16 == 0) && (MODULE_DEVLOAD != 0))
+#error "Cannot enable DEVLOAD module without FAT16 module"
+#endif
+
 /**
  *  \brief
  *      Set it to 1 if you want to enable MegaWiFi functions and support code (provided by Jesus Alonso - doragasu) */
 #define MODULE_MEGAWIFI     0
 
+/**
+ *  \brief
+ *      Set it to 1 to have the MegaWiFi UART serviced from the External interrupt instead of polling it from
+ *      lsd_process().<br>
+ *      The UART INT output should be routed to the External interrupt line (TH pin of a controller port configured as
+ *      input with TH interrupt enabled) as there is no interrupt pin on the cartridge slot.<br>
+ *      Received / sent data goes through RX / TX ring buffers (about 512 bytes of RAM), lsd_process() still has to be
+ *      called to run the frame state machines and callbacks but doesn't wait on the UART anymore.
+ */
+#define MEGAWIFI_UART_INT   0
+
+// MEGAWIFI_UART_INT need MEGAWIFI
+#if ((MODULE_MEGAWIFI == 0) && (MEGAWIFI_UART_INT != 0))
+#error "Cannot enable MEGAWIFI_UART_INT without MEGAWIFI module"
+#endif
+
 /**
  *  \brief
  *      Set it to 1 if you want to use the Fractal sound driver (provided by Aurora Fields).<br>
@@ -136,4 +262,86 @@
 #define MODULE_FRACTAL      0
 
 
+/**
+ *  \brief
+ *      Library profile: when SGDK_PROFILE is defined ('profile' target of makelib.gen and makefile.gen) the game
+ *      'lib_profile.h' header is included here so a game can declare the library features it uses.<br>
+ *      Any switch of this file can be overridden (#undef then #define) and the ENABLE_xxx switches below can be set to 0
+ *      to compile the corresponding code and data out of the library, ex:<pre>
+ *      // lib_profile.h
+ *      #define ENABLE_SPR_AUTO_VRAM_ALLOC      0
+ *      #define ENABLE_SPR_AUTO_VISIBILITY      0
+ *      #define ENABLE_Z80_DRIVER_2ADPCM        0
+ *      #undef ENABLE_DMA_STATS
+ *      #define ENABLE_DMA_STATS                0</pre>
+ *      The game and the library should be built with the same profile.
+ */
+#ifdef SGDK_PROFILE
+#include "lib_profile.h"
+#endif
+
+/**
+ *  \brief
+ *      Set it to 0 to compile out sprite engine automatic VRAM allocation (SPR_FLAG_AUTO_VRAM_ALLOC is ignored and
+ *      SPR_setVRAMTileIndex(sprite, -1) fails), sprite tiles index should then always be given in sprite attributes.
+ */
+#ifndef ENABLE_SPR_AUTO_VRAM_ALLOC
+#define ENABLE_SPR_AUTO_VRAM_ALLOC      1
+#endif
+/**
+ *  \brief
+ *      Set it to 0 to compile out sprite engine automatic VDP sprite allocation (SPR_FLAG_AUTO_SPRITE_ALLOC is ignored
+ *      and SPR_setSpriteTableIndex(sprite, -1) fails), VDP sprite index should then always be given to SPR_addSpriteEx(..).
+ */
+#ifndef ENABLE_SPR_AUTO_SPRITE_ALLOC
+#define ENABLE_SPR_AUTO_SPRITE_ALLOC    1
+#endif
+/**
+ *  \brief
+ *      Set it to 0 to compile out sprite engine automatic visibility (SPR_FLAG_AUTO_VISIBILITY and
+ *      SPR_FLAG_FAST_AUTO_VISIBILITY are ignored and AUTO_FAST / AUTO_SLOW visibility are handled as VISIBLE).
+ */
+#ifndef ENABLE_SPR_AUTO_VISIBILITY
+#define ENABLE_SPR_AUTO_VISIBILITY      1
+#endif
+/**
+ *  \brief
+ *      Set it to 1 so SPR_update() scans packed per sprite "hot" flags (4 sprites per long word) instead of walking the
+ *      whole sprite list, idle sprites (no animation timer, no animation clock and no pending change) are then skipped
+ *      without being dereferenced.<br>
+ *      Sprites are then processed in allocation slot order instead of depth order (only matters for which sprites get
+ *      their frame update delayed when the SPR_update() budget is exceeded) and Sprite gets an extra slot field.
+ */
+#ifndef ENABLE_SPR_HOT_SCAN
+#define ENABLE_SPR_HOT_SCAN             0
+#endif
+/**
+ *  \brief
+ *      Set it to 0 to compile out DMA queue transfer capacity handling: all queued transfers are done on DMA_flushQueue()
+ *      (DMA_setMaxTransferSize(..), priorities and DMA_setIgnoreOverCapacity(..) have no effect anymore).
+ */
+#ifndef ENABLE_DMA_CAPACITY_LIMIT
+#define ENABLE_DMA_CAPACITY_LIMIT       1
+#endif
+/**
+ *  \brief
+ *      Set them to 0 to remove the corresponding Z80 driver from the library (Z80_loadDriver(..) then fails for it).
+ */
+#ifndef ENABLE_Z80_DRIVER_PCM
+#define ENABLE_Z80_DRIVER_PCM           1
+#endif
+#ifndef ENABLE_Z80_DRIVER_2ADPCM
+#define ENABLE_Z80_DRIVER_2ADPCM        1
+#endif
+#ifndef ENABLE_Z80_DRIVER_4PCM
+#define ENABLE_Z80_DRIVER_4PCM          1
+#endif
+#ifndef ENABLE_Z80_DRIVER_XGM
+#define ENABLE_Z80_DRIVER_XGM           1
+#endif
+#ifndef ENABLE_Z80_DRIVER_UNPACK
+#define ENABLE_Z80_DRIVER_UNPACK        1
+#endif
+
+
 #endif // _CONFIG_
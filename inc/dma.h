@@ -43,6 +43,45 @@
 #define DMA_BUFFER_SIZE_PAL_MAX         (14 * 1024)
 #define DMA_BUFFER_SIZE_MIN             (2 * 1024)
 
+// DMA queue and buffer sizes when ENABLE_DMA_STATIC_MEMORY is set
+#define DMA_QUEUE_SIZE_STATIC           DMA_QUEUE_SIZE_DEFAULT
+#define DMA_BUFFER_SIZE_STATIC          DMA_BUFFER_SIZE_NTSC
+
+/**
+ *  \brief
+ *      High priority DMA transfer: always done even when the transfer capacity is exceeded (sprite table, palette...)
+ */
+#define DMA_PRIORITY_HIGH               0
+/**
+ *  \brief
+ *      Normal priority DMA transfer (default): done or ignored when the transfer capacity is exceeded (see DMA_setIgnoreOverCapacity(..))
+ */
+#define DMA_PRIORITY_NORMAL             1
+/**
+ *  \brief
+ *      Low priority DMA transfer: delayed to next DMA_flushQueue() call when the transfer capacity is exceeded (background streaming...).<br>
+ *      Source data should remain valid until the transfer is actually done.
+ */
+#define DMA_PRIORITY_LOW                2
+
+// approximated VRAM DMA capacity (in byte) per scanline (active display and blanked display)
+#define DMA_LINE_CAPACITY_ACTIVE_H40    18
+#define DMA_LINE_CAPACITY_ACTIVE_H32    16
+#define DMA_LINE_CAPACITY_BLANK_H40     205
+#define DMA_LINE_CAPACITY_BLANK_H32     167
+
+/**
+ *  \brief
+ *      Number of bins for VBlank overrun histogram: 0, 1-7, 8-15, 16-31, 32-63 and 64+ scanlines
+ */
+#define DMA_STATS_OVERRUN_BINS          6
+
+/**
+ *  \brief
+ *      Default maximum transfer length (in word) done through the CPU by #TRANSFER_AUTO (see #DMA_setAutoCPULen(..))
+ */
+#define DMA_AUTO_CPU_LEN_DEFAULT        16
+
 
 /**
  *  \brief
@@ -53,7 +92,8 @@ typedef enum
     CPU = 0,            /**< Transfer through the CPU immediately (slower.. useful for testing purpose mainly) */
     DMA = 1,            /**< Transfer through DMA immediately, using DMA is faster but can lock Z80 execution */
     DMA_QUEUE = 2,      /**< Put in the DMA queue so it will be transferred at next VBlank. Using DMA is faster but can lock Z80 execution */
-    DMA_QUEUE_COPY = 3  /**< Copy the buffer and put in the DMA queue so it will be transferred at next VBlank. Using DMA is faster but can lock Z80 execution */
+    DMA_QUEUE_COPY = 3, /**< Copy the buffer and put in the DMA queue so it will be transferred at next VBlank. Using DMA is faster but can lock Z80 execution */
+    TRANSFER_AUTO = 4   /**< Choose the best method from transfer size and current timing: small transfers are done through the CPU (immediately during VBlank, queued otherwise), larger ones are put in the DMA queue. Source data should remain valid until next VBlank (as for DMA_QUEUE) */
 } TransferMethod;
 
 
@@ -70,6 +110,66 @@ typedef struct
     u32 regCtrlWrite;   // GFX_DMA_VRAMCOPY_ADDR(to)
 } DMAOpInfo;
 
+/**
+ *  \brief
+ *      DMA fence completion callback, called with the fence id.
+ */
+typedef void DMACallback(u16 id);
+
+/**
+ *  \brief
+ *      DMA queue statistics (only available when ENABLE_DMA_STATS is set in config.h)
+ *
+ *  \param frames
+ *      number of DMA_flushQueue() calls since last reset
+ *  \param bytes
+ *      transfer size on last flush (CRAM and VSRAM transfers are counted for half as in the transfer capacity)
+ *  \param peakBytes
+ *      maximum transfer size for a single flush
+ *  \param totalBytes
+ *      total transfer size queued
+ *  \param entries
+ *      number of queue entries on last flush
+ *  \param peakEntries
+ *      maximum number of queue entries for a single flush
+ *  \param merged
+ *      number of transfers merged into previous entry
+ *  \param dropped
+ *      number of transfers lost (ignored over capacity, queue full or evicted by higher priority transfers)
+ *  \param delayed
+ *      number of transfers delayed to next flush (low priority or mid frame transfers)
+ *  \param truncated
+ *      number of transfers split by mid frame flush
+ *  \param bufferFull
+ *      number of failed temporary buffer allocations
+ *  \param peakBuffer
+ *      maximum temporary buffer usage (in bytes) for a single flush
+ *  \param overrun
+ *      histogram of VBlank overrun (in scanlines) for flushes started during VBlank, see #DMA_STATS_OVERRUN_BINS
+ *  \param lastOverrun
+ *      VBlank overrun (in scanlines) of the last flush started during VBlank
+ *  \param peakOverrun
+ *      maximum VBlank overrun (in scanlines) for a single flush
+ */
+typedef struct
+{
+    u32 frames;
+    u16 bytes;
+    u16 peakBytes;
+    u32 totalBytes;
+    u16 entries;
+    u16 peakEntries;
+    u16 merged;
+    u16 dropped;
+    u16 delayed;
+    u16 truncated;
+    u16 bufferFull;
+    u16 peakBuffer;
+    u16 overrun[DMA_STATS_OVERRUN_BINS];
+    u16 lastOverrun;
+    u16 peakOverrun;
+} DMAStats;
+
 
 /**
  *  \brief
@@ -107,7 +207,8 @@ void DMA_init(void);
  *      The buffer should be big enough to contains all temporary that you need to store before next #DMA_flushQueue() call.
  *
  *      SGDK automatically call this method on hard reset so you don't need to call it again unless
- *      you want to change the default parameters.
+ *      you want to change the default parameters.<br>
+ *      Queue and buffer are only re-allocated (and memory packed) when their size actually change.
  *
  * \see #DMA_setIgnoreOverCapacity(..)
  */
@@ -215,6 +316,28 @@ void DMA_setBufferSize(u16 value);
  *  \see DMA_setBufferSize(void)
  */
 void DMA_setBufferSizeToDefault(void);
+/**
+ *  \brief
+ *      Returns TRUE if the temporary data buffer is used in double buffer mode.
+ *
+ *  \see DMA_setDoubleBuffer(..)
+ */
+bool DMA_getDoubleBuffer(void);
+/**
+ *  \brief
+ *      Enable or disable double buffer mode for the temporary data buffer (default is FALSE).<br>
+ *      <b>WARNING:</b> changing this setting will clear the DMA queue.
+ *
+ *      In double buffer mode the temporary data buffer is split in 2 banks: allocations always happen in the bank which isn't
+ *      being transferred and banks are swapped on each #DMA_flushQueue() call.<br>
+ *      This way a buffer obtained with #DMA_reserveQueueDma(..) remains valid across one flush and data for the next frame can be
+ *      prepared while pending transfers (delayed or mid frame transfers) are still using the other bank.<br>
+ *      Each bank is half of the buffer size so you may want to increase it using #DMA_setBufferSize(..).
+ *
+ *  \see DMA_reserveQueueDma(..)
+ *  \see DMA_commitQueueDma(..)
+ */
+void DMA_setDoubleBuffer(bool value);
 /**
  *  \brief
  *      Return TRUE means that we ignore future DMA operation when we reach the maximum capacity (see #DMA_setIgnoreOverCapacity(..) method).
@@ -222,6 +345,39 @@ void DMA_setBufferSizeToDefault(void);
  *  \see DMA_setIgnoreOverCapacity(void)
  */
 bool DMA_getIgnoreOverCapacity(void);
+/**
+ *  \brief
+ *      Returns TRUE if the maximum transfer size is automatically computed from current video mode.
+ *
+ *  \see DMA_setAutoCapacity(..)
+ */
+bool DMA_getAutoCapacity(void);
+/**
+ *  \brief
+ *      Enable automatic computation of the maximum transfer size per frame (default is FALSE).
+ *
+ *      When enabled, the maximum transfer size is computed on each frame from the number of VBlank lines
+ *      (NTSC / PAL system, V28 / V30 mode) and the DMA bandwidth per line (H32 / H40 mode), see #DMA_getVBlankCapacity().<br>
+ *      On flush, VBlank lines already elapsed are also taken into account.<br>
+ *      Calling #DMA_setMaxTransferSize(..) doesn't disable it, the value is just overridden on next flush.
+ *
+ *  \see DMA_getVBlankCapacity()
+ *  \see DMA_getRemainingCapacity()
+ */
+void DMA_setAutoCapacity(bool value);
+/**
+ *  \brief
+ *      Returns the estimated DMA transfer capacity (in bytes) of a complete VBlank for current video mode and TV system.
+ */
+u16 DMA_getVBlankCapacity(void);
+/**
+ *  \brief
+ *      Returns the remaining DMA transfer capacity (in bytes) for current frame (maximum transfer size minus queued transfer size).<br>
+ *      Producers can use it to delay or degrade their updates instead of exceeding the capacity.
+ *
+ *  \see DMA_setAutoCapacity(..)
+ */
+u16 DMA_getRemainingCapacity(void);
 /**
  *  \brief
  *      Set the "over capacity" DMA queue strategy (default is FALSE).
@@ -236,7 +392,102 @@ void DMA_setIgnoreOverCapacity(bool value);
 
 /**
  *  \brief
- *      Clears the DMA queue (all queued operations are lost).<br>
+ *      Returns the priority used for next queued DMA transfers.
+ *
+ *  \see DMA_setQueuePriority(..)
+ */
+u16 DMA_getQueuePriority(void);
+/**
+ *  \brief
+ *      Set the priority used for next queued DMA transfers and returns the previous one.
+ *
+ *  \param value
+ *      priority to use for next DMA_queueDma(..), DMA_queueDmaFast(..), DMA_copyAndQueueDma(..) and DMA_allocateAndQueueDma(..) calls:<br>
+ *      #DMA_PRIORITY_HIGH = always transferred.<br>
+ *      #DMA_PRIORITY_NORMAL = default, transferred or ignored when capacity is exceeded depending DMA_setIgnoreOverCapacity(..) setting.<br>
+ *      #DMA_PRIORITY_LOW = delayed to next flush when capacity is exceeded, can also be evicted by higher priority transfers when the queue is full.
+ *  \return
+ *      the previous priority (so it can be restored)
+ *
+ *      When the transfer capacity is exceeded, high priority transfers are done first, then normal and low priority transfers
+ *      (in queue order) until capacity is reached.<br>
+ *      Be careful when changing priority for transfers overlapping the same VRAM area as they may be reordered.
+ *
+ *  \see DMA_setMaxTransferSize(..)
+ *  \see DMA_setIgnoreOverCapacity(..)
+ */
+u16 DMA_setQueuePriority(u16 value);
+
+/**
+ *  \brief
+ *      Returns TRUE if next queued DMA transfers are marked as safe for mid frame transfer.
+ *
+ *  \see DMA_setMidFrameTransfer(..)
+ */
+bool DMA_getMidFrameTransfer(void);
+/**
+ *  \brief
+ *      Mark next queued DMA transfers as safe (or not) to be done during active display.
+ *
+ *  \param value
+ *      TRUE = next queued transfers may be done during active display when they don't fit in VBlank capacity.<br>
+ *      FALSE = default, transfers only happen during VBlank.
+ *
+ *      When the transfer capacity is exceeded, mid frame transfers which don't fit are delayed (as low priority transfers) and
+ *      can then be flushed during active display using #DMA_flushQueueMidFrame(..) or automatically with #DMA_setHIntFlush(..).<br>
+ *      Only use it for data not visible on the current frame (off screen tiles, next frame buffer...) and keep source data valid
+ *      until the transfer is done.
+ *
+ *  \see DMA_setHIntFlush(..)
+ */
+void DMA_setMidFrameTransfer(bool value);
+/**
+ *  \brief
+ *      Returns the number of mid frame transfers waiting to be flushed during active display.
+ */
+u16 DMA_getMidFramePending(void);
+/**
+ *  \brief
+ *      Flush pending mid frame transfers up to the given size (transfers are split if needed).
+ *
+ *  \param maxSize
+ *      maximum size to transfer (in byte, CRAM and VSRAM transfers are counted for half as in the transfer capacity)
+ *  \return
+ *      the size actually transferred
+ *
+ *      This method is meant to be called from H-Int (or any time during active display) after VBlank DMA_flushQueue() delayed some
+ *      transfers marked with #DMA_setMidFrameTransfer(..).<br>
+ *      VDP address and auto increment are modified so main code shouldn't access the VDP while it can be called.
+ *
+ *  \see DMA_setMidFrameTransfer(..)
+ *  \see DMA_setHIntFlush(..)
+ */
+u16 DMA_flushQueueMidFrame(u16 maxSize);
+/**
+ *  \brief
+ *      Enable automatic flush of pending mid frame transfers from H-Int.
+ *
+ *  \param line
+ *      0 = disabled.<br>
+ *      Normal mode: H-Int happens every <i>line</i> scanlines and transfers what fits in the active display DMA slots
+ *      (#DMA_LINE_CAPACITY_ACTIVE_H40 bytes per line in H40).<br>
+ *      Blank mode: H-Int happens on scanline <i>line</i>, the display is disabled from there until VBlank and transfers
+ *      use blanked display DMA capacity (#DMA_LINE_CAPACITY_BLANK_H40 bytes per line in H40).
+ *  \param blank
+ *      use display blanking mode (bottom of the screen appears as backdrop color)
+ *
+ *      This method takes over the H-Int callback (see SYS_setHIntCallback(..)) and the H-Int counter.<br>
+ *      Main code shouldn't access the VDP while H-Int flush is enabled unless interrupts are disabled (see SYS_disableInts()).
+ *
+ *  \see DMA_setMidFrameTransfer(..)
+ *  \see DMA_flushQueueMidFrame(..)
+ */
+void DMA_setHIntFlush(u16 line, bool blank);
+
+/**
+ *  \brief
+ *      Clears the DMA queue (all queued operations are lost, queued fences are considered as completed without calling
+ *      their callback).<br>
  *  \see DMA_flushQueue(void)
  */
 void DMA_clearQueue(void);
@@ -266,6 +517,29 @@ u16 DMA_getQueueSize(void);
  *      PAL frame allows about 17 KB (in H40).
  */
 u16 DMA_getQueueTransferSize(void);
+/**
+ *  \brief
+ *      Returns the number of transfers which were merged into the previous queue entry since the last flush.<br>
+ *      A queued transfer is automatically merged with the previous one when source and destination are contiguous,
+ *      step and priority are identical and the merged transfer doesn't cross a 128 KB source bank.
+ *      Each merged transfer saves a complete DMA register setup at flush time.
+ */
+u16 DMA_getQueueMergeCount(void);
+
+#if (ENABLE_DMA_STATS != 0)
+/**
+ *  \brief
+ *      Returns DMA queue statistics accumulated since last #DMA_resetStats() call.
+ *
+ *  \see DMAStats
+ */
+const DMAStats* DMA_getStats(void);
+/**
+ *  \brief
+ *      Reset DMA queue statistics.
+ */
+void DMA_resetStats(void);
+#endif  // ENABLE_DMA_STATS
 
 /**
  *  \brief
@@ -291,6 +565,48 @@ void* DMA_allocateTemp(u16 len);
  *  \see DMA_allocateTemp(..)
  */
 void DMA_releaseTemp(u16 len);
+/**
+ *  \brief
+ *      Reserve space in the DMA temporary buffer to build data in place before queuing its transfer with #DMA_commitQueueDma(..).<br>
+ *      Unlike #DMA_allocateAndQueueDma(..) the transfer isn't queued until data is complete so a flush happening in between
+ *      can't transfer partially written data.
+ *
+ *  \param len
+ *      Number of word to reserve.
+ *  \return
+ *      The buffer to fill if reservation succeeded.<br>
+ *      Returns NULL if the buffer is full (or not big enough).
+ *
+ *      The reserved buffer is valid until the next #DMA_flushQueue() call (or the one after in double buffer mode).
+ *
+ *  \see DMA_commitQueueDma(..)
+ *  \see DMA_setDoubleBuffer(..)
+ */
+void* DMA_reserveQueueDma(u16 len);
+/**
+ *  \brief
+ *      Queue the transfer of a buffer previously reserved with #DMA_reserveQueueDma(..).
+ *
+ *  \param location
+ *      Destination location.<br>
+ *      Accepted values:<br>
+ *      - DMA_VRAM (for VRAM transfer).<br>
+ *      - DMA_CRAM (for CRAM transfer).<br>
+ *      - DMA_VSRAM (for VSRAM transfer).<br>
+ *  \param buffer
+ *      Buffer returned by #DMA_reserveQueueDma(..).
+ *  \param to
+ *      VRAM/CRAM/VSRAM destination address.
+ *  \param len
+ *      Number of word to transfer (should be less or equal to the reserved length).
+ *  \param step
+ *      destination (VRAM/VSRAM/CRAM) address increment step after each transfer (usually 2).
+ *  \return
+ *      FALSE if the transfer couldn't be queued (queue full or ignored because of capacity), TRUE otherwise.
+ *
+ *  \see DMA_reserveQueueDma(..)
+ */
+bool DMA_commitQueueDma(u8 location, void* buffer, u16 to, u16 len, u16 step);
 
 /**
  *  \brief
@@ -303,6 +619,7 @@ void DMA_releaseTemp(u16 len);
  *      - DMA<br>
  *      - DMA_QUEUE<br>
  *      - DMA_QUEUE_COPY<br>
+ *      - TRANSFER_AUTO<br>
  *  \param location
  *      Destination location.<br>
  *      Accepted values:<br>
@@ -322,9 +639,42 @@ void DMA_releaseTemp(u16 len);
  *  \return
  *      TRUE if the operation succeeded, FALSE otherwise (buffer or queue full).
  *  \see DMA_queueDMA(..)
+ *  \see DMA_getAutoTransferMethod(..)
  */
 bool DMA_transfer(TransferMethod tm, u8 location, void* from, u16 to, u16 len, u16 step);
 
+/**
+ *  \brief
+ *      Returns the immediate / queued method #TRANSFER_AUTO would use for a transfer of the given length.
+ *
+ *  \param len
+ *      Number of word to transfer.
+ *  \return
+ *      CPU if the transfer is small enough (see #DMA_setAutoCPULen(..)) and can be done right now (VBlank or display
+ *      disabled, and DMA queue empty so transfer order is preserved), DMA_QUEUE otherwise.
+ *
+ *      DMA_transfer(TRANSFER_AUTO, ..) also queues small transfers as CPU copies (done during next VBlank) when they
+ *      can't be done right now, this method is meant for functions which need to know the method beforehand.
+ */
+TransferMethod DMA_getAutoTransferMethod(u16 len);
+/**
+ *  \brief
+ *      Returns the maximum transfer length (in word) done through the CPU by #TRANSFER_AUTO.
+ *
+ *  \see DMA_setAutoCPULen(..)
+ */
+u16 DMA_getAutoCPULen(void);
+/**
+ *  \brief
+ *      Sets the maximum transfer length (in word) done through the CPU by #TRANSFER_AUTO.
+ *
+ *  \param value
+ *      transfers up to this length (in word) are done through the CPU, larger ones are put in the DMA queue.<br>
+ *      Default is #DMA_AUTO_CPU_LEN_DEFAULT: below that DMA setup and queue entry cost more than a CPU copy.<br>
+ *      Use 0 to always use the DMA queue.
+ */
+void DMA_setAutoCPULen(u16 value);
+
 /**
  *  \brief
  *      Return TRUE if we have enough DMA capacity to transfer the given data block len (see #DMA_setMaxTransferSize(..))
@@ -431,6 +781,70 @@ bool DMA_queueDma(u8 location, void* from, u16 to, u16 len, u16 step);
  */
 bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 step);
 
+/**
+ *  \brief
+ *      Queue a block DMA transfer: <i>num</i> transfers of <i>len</i> words each, source and destination being
+ *      incremented by given strides after each block (tilemap rectangle, sprite tiles column...).
+ *
+ *  \param location
+ *      Destination location.<br>
+ *      Accepted values:<br>
+ *      - DMA_VRAM (for VRAM transfer).<br>
+ *      - DMA_CRAM (for CRAM transfer).<br>
+ *      - DMA_VSRAM (for VSRAM transfer).<br>
+ *  \param from
+ *      Source buffer address of the first block.
+ *  \param to
+ *      VRAM/CRAM/VSRAM destination address of the first block.
+ *  \param len
+ *      Number of word to transfer per block.
+ *  \param step
+ *      destination (VRAM/VSRAM/CRAM) address increment step after each word (usually 2).
+ *  \param num
+ *      Number of block
+ *  \param fromStride
+ *      Source address increment (in byte) between 2 blocks.
+ *  \param toStride
+ *      Destination address increment (in byte) between 2 blocks.
+ *  \return
+ *      FALSE if the transfer couldn't be queued (queue full or ignored because of capacity), TRUE otherwise.
+ *
+ *      The whole block transfer only uses 2 queue entries and is expanded in separate DMA commands when the queue is flushed.<br>
+ *      If blocks cross a 128 KB source bank it falls back to one queue entry per block.
+ *
+ *  \see DMA_queueDma(..)
+ */
+bool DMA_queueDmaBlocks(u8 location, void* from, u16 to, u16 len, u16 step, u16 num, u16 fromStride, u16 toStride);
+/**
+ *  \brief
+ *      Unpack compressed data directly in the DMA temporary buffer and queue its transfer (no intermediate heap allocation).
+ *
+ *  \param location
+ *      Destination location.<br>
+ *      Accepted values:<br>
+ *      - DMA_VRAM (for VRAM transfer).<br>
+ *      - DMA_CRAM (for CRAM transfer).<br>
+ *      - DMA_VSRAM (for VSRAM transfer).<br>
+ *  \param from
+ *      Compressed source data.
+ *  \param to
+ *      VRAM/CRAM/VSRAM destination address.
+ *  \param len
+ *      Unpacked data size (in word).
+ *  \param compression
+ *      Compression type (COMPRESSION_NONE, COMPRESSION_APLIB, COMPRESSION_LZ4W or COMPRESSION_DLZ)
+ *  \return
+ *      FALSE if the transfer couldn't be done, TRUE otherwise.
+ *
+ *      If unpacked data doesn't fit in the DMA temporary buffer, data is unpacked in a heap buffer and transferred immediately
+ *      (outside VBlank) as compressed streams can't be unpacked by parts.<br>
+ *      Using double buffer mode (see #DMA_setDoubleBuffer(..)) is recommended so a VBlank flush happening during unpacking can't
+ *      release the buffer.
+ *
+ *  \see DMA_reserveQueueDma(..)
+ */
+bool DMA_queueCompressed(u8 location, const void* from, u16 to, u16 len, u16 compression);
+
 /**
  *  \brief
  *      Do DMA transfer operation immediately
@@ -531,6 +945,74 @@ void DMA_doVRamFill(u16 to, u16 len, u8 value, s16 step);
  *      should be 1 for a classic copy operation but you can use different value for specific operation.
  */
 void DMA_doVRamCopy(u16 from, u16 to, u16 len, s16 step);
+/**
+ *  \brief
+ *      Queue a VRAM DMA fill operation (done on next DMA_flushQueue() call along queued transfers).
+ *
+ *  \param to
+ *      VRAM destination address.
+ *  \param len
+ *      Number of byte to fill (minimum is 2 for even addr destination and 3 for odd addr destination).
+ *  \param value
+ *      Fill value (byte).
+ *  \param step
+ *      VRAM address increment step after each write (should be 1 for a classic fill operation).
+ *  \return
+ *      FALSE if the operation couldn't be queued (queue full or ignored because of capacity), TRUE otherwise.
+ *
+ *  \see DMA_doVRamFill(..)
+ */
+bool DMA_queueVRamFill(u16 to, u16 len, u8 value, s16 step);
+/**
+ *  \brief
+ *      Queue a VRAM DMA copy operation (done on next DMA_flushQueue() call along queued transfers).
+ *
+ *  \param from
+ *      VRAM Source address.
+ *  \param to
+ *      VRAM destination address.
+ *  \param len
+ *      Number of byte to copy (counted twice in transfer capacity as VRAM copy does both read and write).
+ *  \param step
+ *      VRAM address increment step after each write (should be 1 for a classic copy operation).
+ *  \return
+ *      FALSE if the operation couldn't be queued (queue full or ignored because of capacity), TRUE otherwise.
+ *
+ *  \see DMA_doVRamCopy(..)
+ */
+bool DMA_queueVRamCopy(u16 from, u16 to, u16 len, s16 step);
+
+/**
+ *  \brief
+ *      Queue a fence: it completes (and calls the callback if any) when all transfers queued before it have been processed.
+ *
+ *  \param callback
+ *      method called when fence is reached (can be NULL), it's called from DMA_flushQueue() so usually in V-Int context:
+ *      keep it short and don't queue new DMA transfers from it.
+ *  \return
+ *      the fence id (never 0) or 0 if the queue is full.
+ *
+ *      Fences are never ignored on over capacity nor evicted when the queue is full: whatever the current queue
+ *      priority, a fence is delayed to next flush as long as a transfer queued before it is delayed (low priority or mid
+ *      frame transfer). Transfers dropped on over capacity (see #DMA_setIgnoreOverCapacity(..)) don't hold fences.
+ *
+ *  \see DMA_isFenceDone(..)
+ *  \see DMA_getCompletedFence()
+ */
+u16 DMA_queueFence(DMACallback* callback);
+/**
+ *  \brief
+ *      Returns the id of the last completed fence (0 if none).
+ */
+u16 DMA_getCompletedFence(void);
+/**
+ *  \brief
+ *      Returns TRUE if the given fence has been completed.
+ *
+ *  \param id
+ *      fence id returned by #DMA_queueFence(..)
+ */
+bool DMA_isFenceDone(u16 id);
 
 /**
  *  \brief
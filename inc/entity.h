@@ -0,0 +1,134 @@
+/**
+ *  \file entity.h
+ *  \brief Entity table and spawner unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides methods to spawn level entities (enemies, items...) from an EntityTable resource
+ * (ENTITIES resource exported by rescomp from a TMX object layer).<br>
+ * <br>
+ * Entities are sorted on X position and indexed by column (bucket) so the spawner only parses the entities of the
+ * columns which became visible since last update, you typically call #ENTITY_updateSpawner(..) right after MAP_scrollTo(..):<pre>
+ * EntitySpawner spawner;
+ * ENTITY_initSpawner(&spawner, &level1_entities, onEntitySpawn);
+ * ...
+ * while(TRUE)
+ * {
+ *     MAP_scrollTo(map, camX, camY);
+ *     ENTITY_updateSpawner(&spawner, camX, screenWidth);
+ *     SYS_doVBlankProcess();
+ * }</pre>
+ * An entity is spawned again each time its column becomes visible again so use the entity index given to the callback
+ * if you need to track already spawned (or killed) entities.
+ */
+
+#ifndef _ENTITY_H_
+#define _ENTITY_H_
+
+
+/**
+ *  \brief
+ *      Entity definition structure (exported by rescomp).
+ *
+ *  \param x
+ *      entity X position (in pixel)
+ *  \param y
+ *      entity Y position (in pixel)
+ *  \param type
+ *      entity type (0 = no type)
+ *  \param param
+ *      entity custom parameter ('param' property of the TMX object)
+ */
+typedef struct
+{
+    u16 x;
+    u16 y;
+    u16 type;
+    u16 param;
+} EntityDef;
+
+/**
+ *  \brief
+ *      Entity table structure (exported by rescomp).
+ *
+ *  \param numEntity
+ *      number of entity
+ *  \param bucketShift
+ *      bucket (column) width as power of 2 (bucket width = 1 << bucketShift pixels)
+ *  \param numBucket
+ *      number of bucket
+ *  \param buckets
+ *      first entity index for each bucket (numBucket + 1 entries so last entry is numEntity)
+ *  \param entities
+ *      entities sorted on X position
+ */
+typedef struct
+{
+    u16 numEntity;
+    u16 bucketShift;
+    u16 numBucket;
+    const u16* buckets;
+    const EntityDef* entities;
+} EntityTable;
+
+/**
+ *  \brief
+ *      Entity spawn callback.
+ *
+ *  \param entity
+ *      entity definition to spawn
+ *  \param index
+ *      entity index in the entity table (can be used to track spawned / killed entities)
+ */
+typedef void EntitySpawnCallback(const EntityDef* entity, u16 index);
+
+/**
+ *  \brief
+ *      Entity spawner structure.
+ *
+ *  \param table
+ *      entity table
+ *  \param left
+ *      first visible bucket index (-1 if none)
+ *  \param right
+ *      last visible bucket index (-1 if none)
+ *  \param onSpawn
+ *      spawn callback
+ */
+typedef struct
+{
+    const EntityTable* table;
+    s16 left;
+    s16 right;
+    EntitySpawnCallback* onSpawn;
+} EntitySpawner;
+
+
+/**
+ *  \brief
+ *      Initialize the entity spawner (no bucket is visible so next #ENTITY_updateSpawner(..) call spawns all
+ *      entities of the visible columns).
+ *
+ *  \param spawner
+ *      entity spawner to initialize
+ *  \param table
+ *      entity table (ENTITIES resource)
+ *  \param onSpawn
+ *      callback called for each entity to spawn
+ */
+void ENTITY_initSpawner(EntitySpawner* spawner, const EntityTable* table, EntitySpawnCallback* onSpawn);
+/**
+ *  \brief
+ *      Update the entity spawner for the given view: entities of the columns which became visible since the last
+ *      update are spawned (spawn callback is called for each of them).
+ *
+ *  \param spawner
+ *      entity spawner
+ *  \param viewX
+ *      view (camera) X position (in pixel)
+ *  \param viewW
+ *      view width (in pixel), you may add a margin to spawn entities a bit before they are visible
+ */
+void ENTITY_updateSpawner(EntitySpawner* spawner, u16 viewX, u16 viewW);
+
+#endif // _ENTITY_H_
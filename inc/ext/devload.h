@@ -0,0 +1,99 @@
+/**
+ *  \file devload.h
+ *  \brief Development asset loader (hot reload from Everdrive SD card)
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit allows to load tilesets and palettes from files on the Everdrive SD card instead of ROM so art can be
+ * tweaked without reflashing the cartridge (development builds only).<br>
+ * A resource is resolved from its name (rescomp resource symbol name): the file "<name>.bin" is searched in the
+ * asset directory (long file name, case insensitive) and if missing, the 8.3 name made of the 8 first characters
+ * of the name and the BIN extension is tried. When the file isn't found (or there is no SD card) the ROM resource
+ * is used so the same code works on a standard cartridge:<pre>
+ * DEVLOAD_init("ASSETS");
+ * ...
+ * // call it again (on key press for instance) to reload the modified file
+ * DEVLOAD_TILESET(bga_tileset, TILE_USER_INDEX, DMA);
+ * DEVLOAD_PALETTE(PAL1, bga_pal, DMA);</pre>
+ * File formats are raw uncompressed data:<br>
+ * - tileset: 32 bytes per tile (4 bpp), tiles are streamed to VRAM by chunked DMA.<br>
+ * - palette: 2 bytes per color (big endian, same as ROM palette data).<br>
+ * Only the FAT16_DIR_SIZE (32) first entries of the asset directory are considered.<br>
+ * This module requires the FAT16 module (MODULE_FAT16 in config.h).
+ */
+
+#ifndef _DEVLOAD_H_
+#define _DEVLOAD_H_
+
+#if (MODULE_DEVLOAD != 0)
+
+#include "vdp_tile.h"
+#include "pal.h"
+
+
+/**
+ *  \brief
+ *      Load the given tileset resource (see #DEVLOAD_loadTileSet(..)), the resource symbol name is used to find the file.
+ */
+#define DEVLOAD_TILESET(res, index, tm)     DEVLOAD_loadTileSet(&(res), #res, index, tm)
+/**
+ *  \brief
+ *      Load the given palette resource (see #DEVLOAD_setPalette(..)), the resource symbol name is used to find the file.
+ */
+#define DEVLOAD_PALETTE(numPal, res, tm)    DEVLOAD_setPalette((numPal) * 16, &(res), #res, tm)
+
+
+/**
+ *  \brief
+ *      Initialize the development asset loader (SD card and FAT16 file system) and read the asset directory.
+ *
+ *  \param dirName
+ *      name of the asset directory (in root directory), NULL to use the root directory
+ *  \return FALSE if SD card or directory isn't available (all loads then use ROM data)
+ */
+bool DEVLOAD_init(const char* dirName);
+/**
+ *  \brief
+ *      Read again the asset directory (use it if files were added or resized on SD card since #DEVLOAD_init(..)).
+ *
+ *  \return FALSE if SD card or directory isn't available
+ */
+bool DEVLOAD_refresh(void);
+/**
+ *  \brief
+ *      Returns TRUE if a file with the given resource name exists in the asset directory.
+ */
+bool DEVLOAD_exists(const char* name);
+/**
+ *  \brief
+ *      Load a tileset from SD card file if present, from ROM otherwise.
+ *
+ *  \param tileset
+ *      ROM tileset (used as fallback)
+ *  \param name
+ *      resource name
+ *  \param index
+ *      Tile index where start tile data load (use TILE_USER_INDEX as base user index)
+ *  \param tm
+ *      Transfer method used for ROM fallback (SD card data is always transferred immediately by DMA)
+ *  \return FALSE if load failed
+ */
+bool DEVLOAD_loadTileSet(const TileSet* tileset, const char* name, u16 index, TransferMethod tm);
+/**
+ *  \brief
+ *      Set palette colors from SD card file if present, from ROM otherwise.
+ *
+ *  \param index
+ *      color index where to start to set colors
+ *  \param pal
+ *      ROM palette (used as fallback)
+ *  \param name
+ *      resource name
+ *  \param tm
+ *      Transfer method
+ */
+void DEVLOAD_setPalette(u16 index, const Palette* pal, const char* name, TransferMethod tm);
+
+#endif // MODULE_DEVLOAD
+
+#endif // _DEVLOAD_H_
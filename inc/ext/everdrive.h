@@ -87,6 +87,12 @@ u8 evd_mmcInit();
 u8 evd_mmcRdBlock(u32 mmc_addr, u8 *stor);
 
 
+//read num consecutive blocks (512b each) from SD/MMC card in a single multiple block read command (CMD18).
+//fallback to block by block read if card doesn't support it. mmc_addr should be multiple to 512, stor should be word aligned
+//will return 0 success
+u8 evd_mmcRdBlocks(u32 mmc_addr, u8 *stor, u16 num);
+
+
 //write block (512b) to SD/MMC card. mmc_addr should be multiple to 512
 //will return 0 success
 u8 evd_mmcWrBlock(u32 mmc_addr, u8 *data_ptr);
@@ -16,6 +16,8 @@
 #define FAT16_DIR_SIZE 32
 #define FAT16_TYPE_FILE  0x20
 #define FAT16_TYPE_DIR  0x10
+// number of FAT sectors (256 clusters each) kept in cache
+#define FAT16_FAT_CACHE_SIZE 4
 
 
 typedef struct {
@@ -77,6 +79,12 @@ u8 fat16WriteNextSector(Fat16File *file);
 u8 fat16DeleteRecord(Fat16Record *rec);
 u8 fat16CreateRecord(Fat16Record *rec, Fat16Dir *dir);
 u8 fat16SkipSectors(Fat16File *file, u16 num);
+// read len bytes of file from current position directly into dst (multiple block reads over contiguous clusters).
+// a partial last sector is fully consumed so len should be a multiple of 512 except for the last read of the file.
+// dst should be word aligned for best performance. will return 0 success
+u8 fat16ReadFile(Fat16File *file, u8 *dst, u32 len);
+// same as fat16ReadFile(..) but data is transferred to VRAM (by DMA) at vram_addr. will return 0 success
+u8 fat16ReadFileToVRAM(Fat16File *file, u16 vram_addr, u32 len);
 
 #endif  /* MODULE_FAT16 */
 
@@ -1064,7 +1064,8 @@ typedef struct Fractal_Data_ {
 
 /**
  *  \brief
- *          Initialize Fractal Sound
+ *          Initialize Fractal Sound and set it as current Z80 driver (#Z80_DRIVER_FRACTAL).<br>
+ *          Z80_loadDriver(Z80_DRIVER_FRACTAL, ..) calls it with the Fractal_Decompress(..) routine.
  *
  *  \param decompressFunction
  *          The function that handles decompression of DualPCM.dat
@@ -1083,9 +1084,17 @@ void Fractal_Init(void (*decompressFunction)(u8* source, u8* destination));
 void Fractal_Decompress(u8* source, u8* destination);
 /**
  *  \brief
- *          Update Fractal at the end of v-int
+ *          Update Fractal at the end of v-int.<br>
+ *          When Fractal is loaded as #Z80_DRIVER_FRACTAL (Z80_loadDriver(Z80_DRIVER_FRACTAL, ..) or Fractal_Init(..)) this is
+ *          automatically done by SGDK at V-Int time so you don't need to call it.
  */
 void Fractal_Update();
+/**
+ *  \brief
+ *          Returns an estimation of the 68000 CPU load (in % of frame time) used by Fractal_Update().<br>
+ *          The value is the mean computed over the last FRACTAL_LOAD_FRAME_NUM frames processed by the V-Int task.
+ */
+u16 Fractal_GetCPULoad();
 /**
  *  \brief
  *          Queue a sound for Fractal Sound
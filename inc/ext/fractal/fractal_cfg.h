@@ -59,6 +59,17 @@
  *      Whether to detect redkid based hardware, and attempt to fix its sound.
  */
 #define FEATURE_REDKIDFIX		1
+/**
+ *  \brief
+ *      Z80 RAM address of the DMA bus protection flag of the Z80 DualPCM driver (set to 1 by the 68000 while the DMA queue is flushed)
+ *      or 0 if the Z80 driver doesn't support it. See Z80_useBusProtection(..).
+ */
+#define FRACTAL_Z80_PROTECT_ADDR	0
+/**
+ *  \brief
+ *      Number of frame used to compute the Fractal CPU load mean (should be a power of 2), see Fractal_GetCPULoad()
+ */
+#define FRACTAL_LOAD_FRAME_NUM	16
 
 #endif // MODULE_FRACTAL
 
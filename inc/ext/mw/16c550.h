@@ -93,6 +93,13 @@ extern UartShadow sh;
 #define UART_MCR__OUT2		0x08	///< GPIO pin 2.
 /** \} */
 
+/** \addtogroup UartInts UartInts
+ *  \brief Interrupt sources enabled in the IER UART register.
+ *  \{ */
+#define UART_IER__RX		0x01	///< RX data available / timeout.
+#define UART_IER__THRE		0x02	///< TX holding register empty.
+/** \} */
+
 /** \addtogroup UartIns UartIns
  *  \brief Input pins readed in the MSR UART register.
  *  \{ */
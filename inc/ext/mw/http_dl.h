@@ -0,0 +1,125 @@
+/************************************************************************//**
+ * \file
+ *
+ * \brief HTTP download to SRAM or MegaWiFi flash.
+ *
+ * \defgroup http_dl http_dl
+ * \{
+ *
+ * \brief HTTP download to SRAM or MegaWiFi flash.
+ *
+ * Streams the body of an HTTP GET response directly to cartridge SRAM or to
+ * the MegaWiFi module flash (see mw_flash_write()), so large payloads (DLC
+ * levels, leaderboards...) can be fetched without holding them in work RAM.
+ * The body goes through a double buffer: while a chunk is written to its
+ * destination, the next one is being received.
+ *
+ * A progress callback is run after each written chunk, and the downloaded
+ * position is kept in the request so an interrupted download can be resumed
+ * later (using an HTTP Range request) just by calling dl_http_get() again
+ * with the same request.
+ *
+ * \code
+ * static bool progress(uint32_t pos, uint32_t total, void *ctx)
+ * {
+ *     draw_bar(pos, total);
+ *     return TRUE;
+ * }
+ * ...
+ * struct dl_req req = {
+ *     .url = "https://example.com/level5.bin", .target = DL_TARGET_FLASH,
+ *     .addr = 0x10000, .buf = buf, .buf_len = 1024, .progress = progress,
+ *     .tout_frames = MS_TO_FRAMES(10000)
+ * };
+ * status = dl_http_get(&req);
+ * \endcode
+ *
+ * \author Stephane Dallongeville
+ * \date 10/2026
+ *
+ * \note This module requires setting MODULE_MEGAWIFI to 1 in config.h and
+ * rebuilding the library (if you had to change them).
+ * \warning The function blocks the supervisor task (as the other synchronous
+ * MegaWiFi functions) and replaces the command data callback (see
+ * mw_cmd_data_cb_set()) during flash downloads.
+ ****************************************************************************/
+
+#ifndef _HTTP_DL_H_
+#define _HTTP_DL_H_
+
+#include "types.h"
+
+#if (MODULE_MEGAWIFI != 0)
+
+/// MegaWiFi flash sector length
+#define DL_FLASH_SECT_LEN	4096
+
+/// Minimum chunk length for flash downloads: network data received while a
+/// flash write command is running is queued in the next chunk
+#define DL_FLASH_MIN_BUF_LEN	(2 * MW_MSG_MAX_BUFLEN)
+
+/// Download error codes (negative values are returned by dl_http_get())
+enum dl_err {
+	DL_ERR_ABORTED = -5,	///< Aborted by the progress callback
+	DL_ERR_OVERFLOW = -4,	///< Received data does not fit the buffer
+	DL_ERR_WRITE = -3,	///< Flash erase or write failed
+	DL_ERR_RECV = -2,	///< Reception timeout or error
+	DL_ERR_PARAM = -1	///< Invalid request
+};
+
+/// Download destination
+enum dl_target {
+	DL_TARGET_SRAM = 0,	///< Cartridge SRAM
+	DL_TARGET_FLASH		///< MegaWiFi module flash
+};
+
+/************************************************************************//**
+ * \brief Download progress callback.
+ *
+ * \param[in] pos   Number of bytes downloaded (including the resume offset).
+ * \param[in] total Total length of the body (including the resume offset).
+ * \param[in] ctx   Request context.
+ *
+ * \return TRUE to continue, FALSE to abort the download (it can be resumed
+ * later).
+ ****************************************************************************/
+typedef bool (*dl_progress_cb)(uint32_t pos, uint32_t total, void *ctx);
+
+/// Download request
+struct dl_req {
+	const char *url;	///< URL to download
+	enum dl_target target;	///< Destination
+	/// Destination address: SRAM offset or flash address (as used by
+	/// mw_flash_write(), must be sector aligned)
+	uint32_t addr;
+	/// Bytes already downloaded: updated while downloading, keep it to
+	/// resume an interrupted download, set to 0 for a new download
+	uint32_t offset;
+	/// Total body length (set by dl_http_get())
+	uint32_t total;
+	char *buf;		///< Double buffer (2 * buf_len bytes)
+	uint16_t buf_len;	///< Chunk length (even)
+	dl_progress_cb progress;	///< Progress callback (optional)
+	void *ctx;		///< Progress callback context
+	int16_t tout_frames;	///< Timeout for each network operation
+};
+
+/************************************************************************//**
+ * \brief Downloads (or resumes downloading) the body of an HTTP GET request
+ * to SRAM or flash.
+ *
+ * \param[inout] req Download request, offset is updated with the number of
+ *               downloaded bytes (also on failure).
+ *
+ * \return The HTTP status code (200 or 206 on success) if the request was
+ * completed, a negative dl_err or mw_err code otherwise.
+ * \note If the server does not support Range requests, the download
+ * restarts from 0.
+ ****************************************************************************/
+int16_t dl_http_get(struct dl_req *req);
+
+#endif // MODULE_MEGAWIFI
+
+#endif /*_HTTP_DL_H_*/
+
+/** \} */
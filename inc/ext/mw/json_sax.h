@@ -0,0 +1,137 @@
+/************************************************************************//**
+ * \file
+ *
+ * \brief Incremental (SAX-style) JSON parser.
+ *
+ * \defgroup json_sax json_sax
+ * \{
+ *
+ * \brief Incremental (SAX-style) JSON parser.
+ *
+ * Unlike jsmn (see json.h), this parser does not need the whole document in
+ * memory nor a token array: data is fed chunk by chunk as it is received
+ * (e.g. from mw_recv() callbacks), and a callback is run for each value and
+ * for each object/array start and end. Memory usage is bounded by the
+ * parser structure (key and value buffers and nesting stack), so documents
+ * of any length can be parsed while receiving them.
+ *
+ * \code
+ * static int on_json(enum json_sax_event ev, const char *key,
+ *         const char *value, uint16_t depth, void *ctx)
+ * {
+ *     if (JSON_SAX_EV_STRING == ev && !strcmp(key, "score")) {
+ *         add_score(value);
+ *     }
+ *     return 0;
+ * }
+ * ...
+ * json_sax_init(&parser, on_json, NULL);
+ * while (receiving) {
+ *     ...
+ *     json_sax_feed(&parser, buf, len);
+ * }
+ * \endcode
+ *
+ * \author Stephane Dallongeville
+ * \date 10/2026
+ *
+ * \note Strings longer than JSON_SAX_MAX_VALUE (or keys longer than
+ * JSON_SAX_MAX_KEY) are truncated. Unicode escapes (\\uXXXX) are replaced by
+ * a '?' character.
+ ****************************************************************************/
+
+#ifndef _JSON_SAX_H_
+#define _JSON_SAX_H_
+
+#include "types.h"
+
+#if (MODULE_MEGAWIFI != 0)
+
+/// Maximum nesting level of objects and arrays
+#define JSON_SAX_MAX_DEPTH	8
+/// Maximum key length (longer keys are truncated)
+#define JSON_SAX_MAX_KEY	31
+/// Maximum value length (longer values are truncated)
+#define JSON_SAX_MAX_VALUE	63
+
+/// Return codes for json_sax_feed()
+enum json_sax_status {
+	JSON_SAX_ERR_DEPTH = -2,	///< Nesting too deep
+	JSON_SAX_ERR_SYNTAX = -1,	///< Malformed document
+	JSON_SAX_OK = 0,		///< More data is needed
+	JSON_SAX_DONE = 1,		///< Document completely parsed
+	JSON_SAX_STOP = 2		///< Parsing stopped by the callback
+};
+
+/// Parsing events
+enum json_sax_event {
+	JSON_SAX_EV_OBJ_START = 0,	///< Object start
+	JSON_SAX_EV_OBJ_END,		///< Object end
+	JSON_SAX_EV_ARR_START,		///< Array start
+	JSON_SAX_EV_ARR_END,		///< Array end
+	JSON_SAX_EV_STRING,		///< String value
+	JSON_SAX_EV_PRIMITIVE		///< Number, true, false or null value
+};
+
+/************************************************************************//**
+ * \brief Parsing event callback.
+ *
+ * \param[in] ev    Event type.
+ * \param[in] key   Key of the value or object/array (NULL inside arrays and
+ *                  for end events).
+ * \param[in] value Null terminated value (STRING and PRIMITIVE events only,
+ *                  NULL otherwise).
+ * \param[in] depth Number of enclosing objects/arrays (0 for the root
+ *                  object/array start and end events).
+ * \param[in] ctx   Context passed to json_sax_init().
+ *
+ * \return 0 to continue parsing, other value to stop it.
+ ****************************************************************************/
+typedef int (*json_sax_cb)(enum json_sax_event ev, const char *key,
+		const char *value, uint16_t depth, void *ctx);
+
+/// Parser state, do NOT access directly
+struct json_sax {
+	json_sax_cb cb;				///< Event callback
+	void *ctx;				///< Callback context
+	uint8_t state;				///< Parsing state
+	uint8_t depth;				///< Current nesting level
+	uint8_t in_key;				///< Parsing a key string
+	uint8_t skip;				///< Unicode digits to skip
+	uint8_t key_len;			///< Current key length
+	uint8_t val_len;			///< Current value length
+	uint8_t stack[JSON_SAX_MAX_DEPTH];	///< 1 = object, 0 = array
+	char key[JSON_SAX_MAX_KEY + 1];		///< Current key
+	char val[JSON_SAX_MAX_VALUE + 1];	///< Current value
+};
+
+/************************************************************************//**
+ * \brief Initializes (or resets) a parser.
+ *
+ * \param[out] p   Parser to initialize.
+ * \param[in]  cb  Event callback.
+ * \param[in]  ctx Context passed to the callback.
+ ****************************************************************************/
+void json_sax_init(struct json_sax *p, json_sax_cb cb, void *ctx);
+
+/************************************************************************//**
+ * \brief Feeds a chunk of the JSON document to the parser. Callbacks for
+ * the values completed in this chunk are run before it returns.
+ *
+ * \param[inout] p    Parser.
+ * \param[in]    data Document chunk (does not need to be null terminated).
+ * \param[in]    len  Chunk length.
+ *
+ * \return JSON_SAX_OK if more data is expected, JSON_SAX_DONE once the root
+ * object/array is complete, JSON_SAX_STOP if the callback stopped parsing
+ * or a negative value on error. Once done, stopped or failed, further data
+ * is ignored until json_sax_init() is called again.
+ ****************************************************************************/
+enum json_sax_status json_sax_feed(struct json_sax *p, const char *data,
+		uint16_t len);
+
+#endif // MODULE_MEGAWIFI
+
+#endif /*_JSON_SAX_H_*/
+
+/** \} */
@@ -16,10 +16,11 @@
  * \author Jesus Alonso (doragasu)
  * \date   2019
  * \note   Unfortunately the Megadrive does have neither an interrupt pin nor
- *         DMA threshold pins in the cartridge slot, so polling is the only
- *         way. So you have
- *         Megadrive does not have an interrupt pin on the cart, implementing
- *         more efficient data transmission techniques will be tricky.
+ *         DMA threshold pins in the cartridge slot, so polling is the default.
+ *         If the UART INT line is routed to the External interrupt (controller
+ *         port TH pin), set MEGAWIFI_UART_INT in config.h: the UART FIFOs are
+ *         then serviced from interrupt into RX/TX ring buffers and
+ *         lsd_process() only runs the frame state machines.
  * \warning The syncrhonous API is easier to use, but a lot less reliable:
  * * It polls, using all the CPU until the send/recv operation completes.
  * * A lsd_recv_sync() can freeze the machine if no frame is received. USE IT
@@ -60,6 +61,9 @@
 /// Number of buffer frames available
 #define LSD_BUF_FRAMES		2
 
+/// Maximum number of buffers in the receive pool
+#define LSD_POOL_MAX_BUFS	8
+
 /// Return status codes for LSD functions
 enum lsd_status {
 	LSD_STAT_ERR_FRAMING = -5,		///< Frame format error
@@ -143,6 +147,47 @@ enum lsd_status lsd_send_sync(uint8_t ch, const char *data, int16_t len);
 enum lsd_status lsd_recv(char *buf, int16_t len, void *ctx,
 		lsd_recv_cb recv_cb);
 
+/************************************************************************//**
+ * \brief Sets up the receive buffer pool used by lsd_recv_pool().
+ *
+ * \param[in] mem     Pool memory, must be at least buf_len * num bytes long.
+ * \param[in] buf_len Length of each buffer (frames longer than this are
+ *                    received in several parts).
+ * \param[in] num     Number of buffers (up to LSD_POOL_MAX_BUFS).
+ *
+ * \return LSD_STAT_COMPLETE on success, LSD_STAT_ERROR on bad parameters.
+ ****************************************************************************/
+int lsd_pool_init(char *mem, uint16_t buf_len, uint8_t num);
+
+/************************************************************************//**
+ * \brief Asynchronously receives frames into pool buffers, until
+ * lsd_recv_pool_stop() or lsd_recv() is called.
+ *
+ * Received data lands directly in a free pool buffer, that is handed to the
+ * callback by reference (no copy). The buffer then belongs to the caller
+ * until it is given back with lsd_pool_release(), and reception continues on
+ * the next free buffer (or waits for a buffer to be released).
+ *
+ * \param[in] ctx     Context for the receive callback function.
+ * \param[in] recv_cb Callback to run on each received frame or error.
+ *
+ * \return Status of the receive procedure.
+ ****************************************************************************/
+enum lsd_status lsd_recv_pool(void *ctx, lsd_recv_cb recv_cb);
+
+/************************************************************************//**
+ * \brief Stops reception into pool buffers. Buffers handed to the callback
+ * remain valid until released.
+ ****************************************************************************/
+void lsd_recv_pool_stop(void);
+
+/************************************************************************//**
+ * \brief Gives back a pool buffer received through lsd_recv_pool().
+ *
+ * \param[in] buf Buffer as passed to the receive callback.
+ ****************************************************************************/
+void lsd_pool_release(char *buf);
+
 /************************************************************************//**
  * \brief Syncrhonously Receives a frame using LSD protocol.
  *
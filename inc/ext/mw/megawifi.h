@@ -470,6 +470,35 @@ static inline enum lsd_status mw_recv(char *buf, int16_t len, void *ctx,
 	return lsd_recv(buf, len, ctx, recv_cb);
 }
 
+/************************************************************************//**
+ * \brief Receive data into buffers of the pool set with lsd_pool_init(),
+ * asyncrhonous zero-copy interface.
+ *
+ * Each received frame buffer is handed to the callback and must be given
+ * back with mw_recv_release() once processed.
+ *
+ * \param[in] ctx     Context pointer to pass to the reception callbak.
+ * \param[in] recv_cb Callback to run on each received frame or error.
+ *
+ * \return Status of the receive procedure.
+ * \note Commands use the caller buffer interface, so pool reception stops
+ * when a command is issued and must be restarted afterwards.
+ ****************************************************************************/
+static inline enum lsd_status mw_recv_pool(void *ctx, lsd_recv_cb recv_cb)
+{
+	return lsd_recv_pool(ctx, recv_cb);
+}
+
+/************************************************************************//**
+ * \brief Gives back a buffer received through mw_recv_pool().
+ *
+ * \param[in] buf Buffer as passed to the reception callback.
+ ****************************************************************************/
+static inline void mw_recv_release(char *buf)
+{
+	lsd_pool_release(buf);
+}
+
 /************************************************************************//**
  * \brief Receive data using an UDP socket in reuse mode.
  *
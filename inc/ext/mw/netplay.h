@@ -0,0 +1,153 @@
+/************************************************************************//**
+ * \file
+ *
+ * \brief Rollback netplay input channel for MegaWiFi.
+ *
+ * \defgroup netplay netplay
+ * \{
+ *
+ * \brief Rollback netplay input channel for MegaWiFi.
+ *
+ * Exchanges per frame joypad state with a remote peer over an UDP socket,
+ * and hides network latency using rollback: when the remote input for a
+ * frame is not yet known it is predicted (last known input is repeated),
+ * and once the real input arrives and differs from the prediction, the game
+ * state is restored and the mispredicted frames are simulated again.
+ *
+ * Each packet carries all local inputs not yet acknowledged by the peer (up
+ * to NP_INPUT_REDUNDANCY), so lost packets are covered by the next ones
+ * without retransmission. Packets also carry a timestamp echo used to
+ * compute the round trip time.
+ *
+ * The game provides three callbacks:
+ * - save: store the game state for the given frame. The game must keep at
+ *   least NP_MAX_ROLLBACK + 1 states (e.g. in a ring indexed by frame).
+ * - load: restore the game state saved for the given frame.
+ * - advance: simulate one frame with the given inputs, without rendering
+ *   nor playing sounds (only used during rollback).
+ *
+ * Typical frame loop:
+ * \code
+ * mw_udp_set(NP_CH, peer_addr, "1234", "1234");
+ * np_init(NP_CH, &callbacks, 2);
+ * while (TRUE) {
+ *     if (np_frame(JOY_readJoypad(JOY_1), &p1, &p2) == NP_STAT_OK) {
+ *         game_advance(p1, p2);
+ *     }
+ *     SYS_doVBlankProcess();
+ * }
+ * \endcode
+ *
+ * \author Stephane Dallongeville
+ * \date 10/2026
+ *
+ * \note This module requires setting MODULE_MEGAWIFI to 1 in config.h and
+ * rebuilding the library (if you had to change them).
+ * \warning Reception on the LSD link is taken over by this module, so no
+ * MegaWiFi command should be issued between np_init() and np_end().
+ ****************************************************************************/
+
+#ifndef _NETPLAY_H_
+#define _NETPLAY_H_
+
+#include "types.h"
+
+#if (MODULE_MEGAWIFI != 0)
+
+/// Length of the input rings (in frames, must be a power of 2)
+#define NP_INPUT_BUF_LEN	32
+/// Maximum number of past inputs carried by each packet
+#define NP_INPUT_REDUNDANCY	8
+/// Maximum number of frames the local side can run ahead of the peer
+#define NP_MAX_ROLLBACK		8
+/// Maximum supported input delay (in frames)
+#define NP_MAX_DELAY		8
+
+/// Return codes for netplay functions
+enum np_status {
+	NP_STAT_ERR_PARAM = -2,	///< Invalid parameter
+	NP_STAT_ERROR = -1,	///< General error
+	NP_STAT_OK = 0,		///< Frame can be advanced with returned inputs
+	NP_STAT_WAIT = 1	///< Too far ahead of peer, do not advance frame
+};
+
+/// Save game state for the given frame.
+typedef void (*np_save_cb)(uint16_t frame, void *ctx);
+/// Restore game state saved for the given frame.
+typedef void (*np_load_cb)(uint16_t frame, void *ctx);
+/// Simulate one frame with the given local and remote inputs.
+typedef void (*np_advance_cb)(uint16_t local_input, uint16_t remote_input,
+		void *ctx);
+
+/// Game callbacks used for rollback
+struct np_callbacks {
+	np_save_cb save;	///< Save state callback
+	np_load_cb load;	///< Load state callback
+	np_advance_cb advance;	///< Advance frame callback
+	void *ctx;		///< Context passed to the callbacks
+};
+
+/// Netplay statistics
+struct np_stats {
+	uint16_t rtt;		///< Last round trip time (in ticks, 1/300 s)
+	uint16_t rollbacks;	///< Number of rollbacks performed
+	uint16_t rollback_frames;	///< Total number of resimulated frames
+	uint16_t waits;		///< Number of frames waited for the peer
+	uint16_t lost;		///< Number of packets not sent (link busy)
+};
+
+/************************************************************************//**
+ * \brief Starts a netplay session on a configured UDP socket.
+ *
+ * \param[in] ch    Channel of the UDP socket (see mw_udp_set()), reuse mode
+ *                  is not supported.
+ * \param[in] cb    Game callbacks (copied).
+ * \param[in] delay Input delay in frames (up to NP_MAX_DELAY). Local input
+ *                  is applied delay frames after being read, reducing the
+ *                  number of rollbacks at the expense of input lag.
+ *
+ * \return NP_STAT_OK on success, NP_STAT_ERR_PARAM on bad parameters.
+ ****************************************************************************/
+enum np_status np_init(uint8_t ch, const struct np_callbacks *cb,
+		uint8_t delay);
+
+/************************************************************************//**
+ * \brief Ends the netplay session, stopping reception on the LSD link.
+ ****************************************************************************/
+void np_end(void);
+
+/************************************************************************//**
+ * \brief Runs the netplay session for one frame. Call it once per frame,
+ * before advancing the game.
+ *
+ * Processes received packets, rolls back and resimulates mispredicted
+ * frames (calling load, then advance and save for each frame), saves the
+ * state of current frame and sends the local input.
+ *
+ * \param[in]  local_input  Local joypad state read this frame.
+ * \param[out] local_out    Local input to apply to current frame.
+ * \param[out] remote_out   Remote input (real or predicted) to apply to
+ *                          current frame.
+ *
+ * \return NP_STAT_OK if the game should advance current frame with the
+ * returned inputs, NP_STAT_WAIT if the peer is too far behind (do not
+ * advance, local_input is discarded).
+ ****************************************************************************/
+enum np_status np_frame(uint16_t local_input, uint16_t *local_out,
+		uint16_t *remote_out);
+
+/************************************************************************//**
+ * \brief Returns current frame number (frame to be advanced).
+ ****************************************************************************/
+uint16_t np_frame_get(void);
+
+/************************************************************************//**
+ * \brief Returns the netplay statistics.
+ ****************************************************************************/
+const struct np_stats *np_stats_get(void);
+
+#endif // MODULE_MEGAWIFI
+
+#endif //_NETPLAY_H_
+
+/** \} */
@@ -15,8 +15,10 @@
 #include "mapper.h"
 #include "memory.h"
 #include "tools.h"
+#include "lz4w.h"
 
 #include "pool.h"
+#include "arena.h"
 #include "object.h"
 
 #include "font.h"
@@ -38,19 +40,42 @@
 #include "dma.h"
 
 #include "map.h"
+#include "tile_anim.h"
+#include "tile_cache.h"
+#include "tile_hash.h"
+#include "asset_cache.h"
+#include "async_load.h"
+#include "asset_dir.h"
+#include "text.h"
+#include "hud.h"
+#include "spr_text.h"
+#include "perf_hud.h"
+#include "raster.h"
 
 #include "bmp.h"
+#include "bmp_span.h"
+#include "mode7.h"
+#include "video.h"
 #include "sprite_eng.h"
+#include "collision.h"
+#include "particle.h"
+#include "entity.h"
 
 #include "sound.h"
 #include "xgm.h"
+#include "sfx.h"
 #include "z80_ctrl.h"
+#include "z80_job.h"
 #include "ym2612.h"
 #include "psg.h"
+#include "psg_sfx.h"
 #include "joy.h"
 #include "timer.h"
+#include "profiler.h"
+#include "trace.h"
 
 #include "task.h"
+#include "job.h"
 
 // modules
 #if (MODULE_EVERDRIVE != 0)
@@ -61,6 +86,10 @@
 #include "ext/fat16.h"
 #endif
 
+#if (MODULE_DEVLOAD != 0)
+#include "ext/devload.h"
+#endif
+
 #if (MODULE_MEGAWIFI != 0)
 #include "ext/mw/megawifi.h"
 #endif
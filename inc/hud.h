@@ -0,0 +1,147 @@
+/**
+ *  \file hud.h
+ *  \brief Window plane HUD unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit owns a top or bottom band of the window plane and displays a HUD in it.<br>
+ * It is built on a text layer (see text.h) so only modified cells are transferred: widgets (numbers, meters) are redrawn
+ * only when their value changes and #HUD_update(..) queues one DMA per modified row, a typical HUD costs a few tens of
+ * bytes per frame:<pre>
+ * HUD_init(FALSE, 2, TILE_ATTR(PAL0, TRUE, FALSE, FALSE));
+ * const s16 score = HUD_addNumber(6, 0, 8);
+ * const s16 life = HUD_addMeter(30, 0, 8, meterTileIndex, 4, 100);
+ * ...
+ * HUD_setValue(score, player.score);
+ * HUD_setValue(life, player.life);
+ * HUD_update();</pre>
+ */
+
+#ifndef _HUD_H_
+#define _HUD_H_
+
+#include "text.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of HUD widget
+ */
+#define HUD_WIDGET_MAX      16
+
+/**
+ *  \brief
+ *      Numeric widget
+ */
+#define HUD_NUMBER          0
+/**
+ *  \brief
+ *      Meter (gauge) widget
+ */
+#define HUD_METER           1
+
+
+/**
+ *  \brief
+ *      HUD widget
+ *
+ *  \param type
+ *      widget type (HUD_NUMBER or HUD_METER)
+ *  \param x
+ *      X position (in tile) in HUD
+ *  \param y
+ *      Y position (in tile) in HUD
+ *  \param len
+ *      number of digit (number) or of tile (meter)
+ *  \param tile
+ *      meter first tile (tile + 0 = empty cell, tile + steps = full cell, tile + n = partially filled cell)
+ *  \param steps
+ *      meter number of fill step per cell
+ *  \param max
+ *      meter maximum value
+ *  \param value
+ *      current value
+ */
+typedef struct
+{
+    u16 type;
+    u16 x;
+    u16 y;
+    u16 len;
+    u16 tile;
+    u16 steps;
+    u32 max;
+    u32 value;
+} HudWidget;
+
+
+/**
+ *  \brief
+ *      Initialize the HUD and set the window plane position.
+ *
+ *  \param bottom
+ *      FALSE to put HUD on top of screen, TRUE to put it on bottom
+ *  \param height
+ *      HUD height in tile
+ *  \param basetile
+ *      base tile attributes (palette, priority) for HUD text
+ *  \return FALSE if there is not enough memory
+ */
+bool HUD_init(bool bottom, u16 height, u16 basetile);
+/**
+ *  \brief
+ *      Release the HUD and hide the window plane.
+ */
+void HUD_end(void);
+/**
+ *  \brief
+ *      Returns text layer of the HUD (to draw static text with TEXT_drawText(..) for instance)
+ */
+TextLayer* HUD_getLayer(void);
+/**
+ *  \brief
+ *      Add a numeric widget
+ *
+ *  \param x
+ *      X position (in tile) in HUD
+ *  \param y
+ *      Y position (in tile) in HUD
+ *  \param digits
+ *      number of digit (padded with '0')
+ *  \return widget id or -1 if too many widget
+ */
+s16 HUD_addNumber(u16 x, u16 y, u16 digits);
+/**
+ *  \brief
+ *      Add a meter (gauge) widget
+ *
+ *  \param x
+ *      X position (in tile) in HUD
+ *  \param y
+ *      Y position (in tile) in HUD
+ *  \param len
+ *      meter length in tile
+ *  \param tile
+ *      meter first tile index (tile + 0 = empty cell ... tile + steps = full cell)
+ *  \param steps
+ *      number of fill step per cell
+ *  \param max
+ *      value for full meter
+ *  \return widget id or -1 if too many widget
+ */
+s16 HUD_addMeter(u16 x, u16 y, u16 len, u16 tile, u16 steps, u32 max);
+/**
+ *  \brief
+ *      Set widget value, widget is redrawn only if value changed.
+ */
+void HUD_setValue(s16 id, u32 value);
+/**
+ *  \brief
+ *      Queue HUD modifications (DMA queue), should be called once per frame.
+ *
+ *  \return number of row transfer queued
+ */
+u16 HUD_update(void);
+
+
+#endif // _HUD_H_
@@ -0,0 +1,77 @@
+/**
+ *  \file job.h
+ *  \brief Idle time background job queue
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides a small job queue consumed while waiting for VBlank (#VDP_waitVSync(), #VDP_waitVBlank(..),
+ * #VDP_waitVInt() and so #SYS_doVBlankProcess()) instead of just spinning.<br>
+ * Each job comes with an estimated cost (in scanline) and is executed only if enough active display lines remain
+ * before VBlank start, so jobs never delay the VBlank process. Jobs are executed in order (a job which doesn't
+ * fit blocks the following ones until next frame).<br>
+ * A job costing a whole frame or more can never fit: it's executed on the first wait for VBlank of a frame (provided
+ * it happens during active display) and so delays the VBlank process (frame overrun).<br>
+ * It's meant for deferrable work as map prefetch, tile decompression or save data encoding. When a user task is set
+ * (see task.h) the idle time is given to the user task and the queue isn't processed automatically anymore: call
+ * #JOB_process() from the user task to drain it.
+ */
+
+#ifndef _JOB_H_
+#define _JOB_H_
+
+
+/**
+ *  \brief
+ *      Job queue size (should be a power of 2)
+ */
+#define JOB_QUEUE_SIZE      16
+
+/**
+ *  \brief
+ *      Job function
+ */
+typedef void JobCallback(void* data);
+
+
+/**
+ *  \brief
+ *      Add a job to the queue.
+ *
+ *  \param fn
+ *      job function
+ *  \param data
+ *      parameter passed to the job function
+ *  \param cost
+ *      estimated job duration in scanline (a job is executed only when at least this number of active lines remains
+ *      before VBlank, a job costing the screen height or more is executed on the first VBlank wait of a frame and
+ *      overruns the frame)
+ *  \return FALSE if the queue is full
+ */
+bool JOB_push(JobCallback* fn, void* data, u16 cost);
+/**
+ *  \brief
+ *      Same as #JOB_push(..) except the job is executed on next frame at the earliest (jobs pushed after it wait as
+ *      well). Useful for a job which re-schedules itself once its work for the current frame is done.
+ */
+bool JOB_pushNextFrame(JobCallback* fn, void* data, u16 cost);
+/**
+ *  \brief
+ *      Remove all pending jobs.
+ */
+void JOB_clear(void);
+/**
+ *  \brief
+ *      Returns the number of pending jobs.
+ */
+u16 JOB_getNumPending(void);
+/**
+ *  \brief
+ *      Execute pending jobs while they fit before VBlank start (automatically done while waiting for VBlank when no
+ *      user task is set, otherwise the user task should call it).
+ *
+ *  \return number of executed jobs
+ */
+u16 JOB_process(void);
+
+
+#endif // _JOB_H_
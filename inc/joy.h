@@ -49,6 +49,40 @@
 #define JOY_NUM         0x0008
 #define JOY_ALL         0xFFFF
 
+/**
+ *  \brief
+ *      Number of state changes stored in the input history (should be a power of 2)
+ */
+#define JOY_HISTORY_SIZE        32
+/**
+ *  \brief
+ *      Number of joypad having input history (JOY_1 and JOY_2)
+ */
+#define JOY_HISTORY_JOY_NUM     2
+
+/**
+ *  \brief
+ *      Input replay mode (see #JOY_getReplayMode())
+ */
+#define JOY_REPLAY_OFF          0
+#define JOY_REPLAY_RECORD       1
+#define JOY_REPLAY_PLAY         2
+/**
+ *  \brief
+ *      Input record header magic (first word of record data)
+ */
+#define JOY_RECORD_MAGIC        0x4A52
+/**
+ *  \brief
+ *      Input record header size (in word): magic, random seed, number of entry (high and low word)
+ */
+#define JOY_RECORD_HEADER_SIZE  4
+/**
+ *  \brief
+ *      Input record entry size (in word): number of frame, JOY_1 state, JOY_2 state
+ */
+#define JOY_RECORD_ENTRY_SIZE   3
+
 
 #define BUTTON_UP       0x0001
 #define BUTTON_DOWN     0x0002
@@ -471,5 +505,135 @@ u16 JOY_waitPressTime(u16 joy, u16 btn, u16 ms);
  */
 void JOY_update(void);
 
+/**
+ *  \brief
+ *      Extra joypad sampling (3 and 6 buttons joypads on port 1 and 2).<br>
+ *<br>
+ *      Only updates the input history (see #JOY_getHistory(..)) so short button taps happening between 2 frame updates
+ *      aren't missed by #JOY_matchSequence(..). It only touches the IO ports so it can be called from the H-Int callback
+ *      to sample at a given scanline: <code>SYS_setHIntCallback(JOY_sample); VDP_setHIntCounter(112); VDP_setHInterrupt(TRUE);</code><br>
+ *      Avoid calling it less than 2 ms after #JOY_update() as 6 buttons joypads would see it as part of the 6 buttons read sequence.
+ */
+void JOY_sample(void);
+/**
+ *  \brief
+ *      Clear the input history.
+ */
+void JOY_clearHistory(void);
+/**
+ *  \brief
+ *      Get an entry of the input history.<br>
+ *<br>
+ *      The input history stores the last #JOY_HISTORY_SIZE state changes of JOY_1 and JOY_2 with the frame (vtimer low 16 bits)
+ *      they happened, it's updated by #JOY_update() (automatically done on VBlank process) and #JOY_sample().
+ *
+ *  \param joy
+ *      Joypad (JOY_1 or JOY_2)
+ *  \param index
+ *      History index (0 = current state, 1 = previous state...)
+ *  \param frame
+ *      If not NULL receives the frame when the state started
+ *  \return joypad state
+ */
+u16 JOY_getHistory(u16 joy, u16 index, u16 *frame);
+/**
+ *  \brief
+ *      Check if the given button sequence (motion input) was done in the last frames.<br>
+ *<br>
+ *      Each sequence element is a button mask which is matched when all its buttons are pressed and when direction buttons
+ *      exactly match (if the element contains any direction). Intermediate states are ignored and the last element has to
+ *      match the current state.<br>
+ *      Ex: quarter circle forward + A: <code>const u16 qcf[] = { BUTTON_DOWN, BUTTON_DOWN | BUTTON_RIGHT, BUTTON_RIGHT | BUTTON_A };</code>
+ *
+ *  \param joy
+ *      Joypad (JOY_1 or JOY_2)
+ *  \param seq
+ *      Sequence of button masks (oldest first)
+ *  \param len
+ *      Sequence length
+ *  \param maxFrames
+ *      Maximum sequence duration (in frame)
+ *  \return TRUE if the sequence is matched
+ */
+bool JOY_matchSequence(u16 joy, const u16 *seq, u16 len, u16 maxFrames);
+
+/**
+ *  \brief
+ *      Start recording JOY_1 and JOY_2 states in the given buffer (stops any current record or playback).<br>
+ *<br>
+ *      States are recorded on each #JOY_update() call (automatically done once per #SYS_doVBlankProcess() call) so a
+ *      record is frame accurate relatively to the game logic, even when frames are missed. Data is run length encoded
+ *      (see #JOY_RECORD_HEADER_SIZE and #JOY_RECORD_ENTRY_SIZE) and stored as big endian words so it can be saved to SRAM
+ *      with #JOY_saveRecord(..) then embedded in ROM as a BIN resource.
+ *
+ *  \param buffer
+ *      Record buffer
+ *  \param size
+ *      Record buffer size (in word), recording automatically stops when the buffer is full
+ *  \param seed
+ *      Random seed set with setRandomSeed(..) now and on playback start so random() sequence is reproduced, 0 to keep the current seed
+ *
+ *  \see JOY_stopRecord()
+ *  \see JOY_startPlayback(..)
+ */
+void JOY_startRecord(u16 *buffer, u16 size, u16 seed);
+/**
+ *  \brief
+ *      Stop the current record.
+ *
+ *  \return size of the recorded data (in word)
+ */
+u16 JOY_stopRecord(void);
+/**
+ *  \brief
+ *      Write the last record data in SRAM.
+ *
+ *  \param offset
+ *      SRAM offset where to write the record
+ *  \return size of the written data (in word), 0 if there is no record
+ */
+u16 JOY_saveRecord(u32 offset);
+/**
+ *  \brief
+ *      Read a record from SRAM (see #JOY_saveRecord(..)) so it can be played with #JOY_startPlayback(..).
+ *
+ *  \param offset
+ *      SRAM offset of the record
+ *  \param buffer
+ *      Destination buffer
+ *  \param size
+ *      Destination buffer size (in word)
+ *  \return size of the read data (in word), 0 if there is no valid record or if it doesn't fit in the buffer
+ */
+u16 JOY_loadRecord(u32 offset, u16 *buffer, u16 size);
+/**
+ *  \brief
+ *      Start playing the given record (from ROM or RAM).<br>
+ *<br>
+ *      JOY_1 and JOY_2 states (and joypad events) come from the record data instead of the controller ports until the
+ *      record ends, the random seed is reset first when the record stores one.
+ *
+ *  \param data
+ *      Record data (see #JOY_startRecord(..))
+ *  \return FALSE if data isn't a valid record
+ */
+bool JOY_startPlayback(const u16 *data);
+/**
+ *  \brief
+ *      Stop the current playback (controller ports are read again on next #JOY_update()).
+ */
+void JOY_stopPlayback(void);
+/**
+ *  \brief
+ *      Returns the current replay mode (#JOY_REPLAY_OFF, #JOY_REPLAY_RECORD or #JOY_REPLAY_PLAY).
+ */
+u16 JOY_getReplayMode(void);
+/**
+ *  \brief
+ *      Returns the current record / playback frame (number of #JOY_update() call since record / playback start).<br>
+ *      Useful to compare per frame profiling results of a same replay between 2 builds.
+ */
+u32 JOY_getReplayFrame(void);
+
 
 #endif // _JOY_H_
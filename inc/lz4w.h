@@ -0,0 +1,129 @@
+/**
+ *  \file lz4w.h
+ *  \brief LZ4W streaming and in-place decompression
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * #lz4w_unpack(..) unpacks a whole LZ4W block at once which requires the full destination buffer and can stall for
+ * several frames on large data. This unit provides a resumable decoder which stops after a given amount of unpacked
+ * bytes so unpacking can be spread over several frames:<pre>
+ * LZ4WStream stream;
+ * LZ4W_initStream(&stream, packed_data, buffer);
+ * while(!LZ4W_isStreamDone(&stream))
+ * {
+ *     // 2 KB per frame
+ *     LZ4W_unpackChunk(&stream, 2048);
+ *     SYS_doVBlankProcess();
+ * }</pre>
+ * It also supports in-place decompression: packed data is copied at the end of the destination buffer (see
+ * #LZ4W_prepareInPlace(..)) and unpacked over itself, so loading packed data from a non mapped storage only requires
+ * the destination buffer (plus a few bytes of safety margin).<br>
+ * Streaming decoder is written in C and is slower than #lz4w_unpack(..), use it only when bounded time or memory matters.
+ */
+
+#ifndef _LZ4W_H_
+#define _LZ4W_H_
+
+
+/**
+ *  \brief
+ *      LZ4W streaming decoder state (should be considered as opaque).
+ *
+ *  \param src
+ *      current packed data position
+ *  \param dst
+ *      current unpacked data position
+ *  \param dstStart
+ *      start of unpacked data
+ *  \param ref
+ *      match source for pending match
+ *  \param lit
+ *      remaining literal words of current segment
+ *  \param mat
+ *      remaining match words being copied
+ *  \param len
+ *      match length (in word) of current segment
+ *  \param off
+ *      match offset (in word) of current segment
+ *  \param op
+ *      operation to do once literals are copied
+ */
+typedef struct
+{
+    const u16* src;
+    u16* dst;
+    u8* dstStart;
+    const u16* ref;
+    u16 lit;
+    u16 mat;
+    u16 len;
+    u16 off;
+    u16 op;
+} LZ4WStream;
+
+
+/**
+ *  \brief
+ *      Initialize a LZ4W streaming decoder.
+ *
+ *  \param stream
+ *      decoder state to initialize
+ *  \param src
+ *      LZ4W packed data (word aligned)
+ *  \param dest
+ *      destination buffer (word aligned, large enough to contains unpacked data)
+ */
+void LZ4W_initStream(LZ4WStream* stream, const u8* src, u8* dest);
+/**
+ *  \brief
+ *      Unpack next chunk of data.
+ *
+ *  \param stream
+ *      decoder state
+ *  \param maxOut
+ *      maximum number of byte to unpack (rounded up to word), 0 means unpack until end
+ *  \return number of unpacked bytes for this chunk
+ */
+u16 LZ4W_unpackChunk(LZ4WStream* stream, u16 maxOut);
+/**
+ *  \brief
+ *      Returns #TRUE when all data has been unpacked.
+ */
+bool LZ4W_isStreamDone(const LZ4WStream* stream);
+/**
+ *  \brief
+ *      Returns current unpacked size (in byte).
+ */
+u32 LZ4W_getStreamSize(const LZ4WStream* stream);
+
+/**
+ *  \brief
+ *      Parse LZ4W packed data (without unpacking it) and returns its unpacked size.
+ *
+ *  \param src
+ *      LZ4W packed data (word aligned)
+ *  \param packedSize
+ *      if not NULL, packed size (in byte) is stored here
+ *  \param margin
+ *      if not NULL, minimum safety margin (in byte) for in-place decompression is stored here
+ *  \return unpacked size (in byte)
+ */
+u32 LZ4W_getInfo(const u8* src, u32* packedSize, u16* margin);
+/**
+ *  \brief
+ *      Copy packed data at the end of destination buffer so it can be unpacked in-place.
+ *
+ *  \param src
+ *      LZ4W packed data (word aligned)
+ *  \param dest
+ *      destination buffer (word aligned)
+ *  \param destSize
+ *      destination buffer size (in byte), should be at least unpacked size + margin (see #LZ4W_getInfo(..))
+ *  \return new packed data location to use with #LZ4W_initStream(..) or #lz4w_unpack(..) with <i>dest</i> as
+ *      destination buffer, or NULL if destination buffer is too small.<br>
+ *      Note that in-place decompression isn't possible if data was packed with a previous data block reference.
+ */
+const u8* LZ4W_prepareInPlace(const u8* src, u8* dest, u32 destSize);
+
+
+#endif // _LZ4W_H_
@@ -30,6 +30,55 @@
 #include "vdp.h"
 #include "vdp_tile.h"
 #include "pal.h"
+#include "maths.h"
+#include "tile_cache.h"
+
+
+/**
+ *  \brief
+ *      MapDefinition.compression flag: blocks are individually compressed and streamed through the block cache (see #MAP_createEx(..))
+ */
+#define MAP_BLOCKS_STREAM               0x1000
+/**
+ *  \brief
+ *      MapDefinition.compression flag (always used with #MAP_BLOCKS_STREAM): each block data starts with a base block index,
+ *      0xFFFF means the full (uncompressed) block data follows, otherwise the block is the given base block (always a full block)
+ *      with a patch list: number of patch (u16) then for each patch (metatile offset << 8) | metatile index (u16) when
+ *      MapDefinition.numMetaTile <= 256, or metatile offset (u16) followed by metatile index (u16) otherwise.<br>
+ *      Patches are applied when the block is unpacked in the block cache so map preparation cost isn't affected.
+ */
+#define MAP_BLOCKS_PATCH                0x2000
+/**
+ *  \brief
+ *      Default number of block in the block cache for streamed map (see #MAP_createEx(..))
+ */
+#define MAP_BLOCK_CACHE_SIZE_DEFAULT    16
+/**
+ *  \brief
+ *      Minimum number of block in the block cache for streamed map (must be able to hold all blocks of a column or row update)
+ */
+#define MAP_BLOCK_CACHE_SIZE_MIN        4
+
+/**
+ *  \brief
+ *      Map scroll mode: map can scroll in both directions (default, see #MAP_createEx(..))
+ */
+#define MAP_SCROLL_HV                   0
+/**
+ *  \brief
+ *      Map scroll mode: map only scrolls horizontally, only column updates are done (runner, side scroller)
+ */
+#define MAP_SCROLL_H_ONLY               1
+/**
+ *  \brief
+ *      Map scroll mode: map only scrolls vertically, only row updates are done (vertical shooter)
+ */
+#define MAP_SCROLL_V_ONLY               2
+/**
+ *  \brief
+ *      Maximum number of Map in a MapGroup (one per scrolling plane)
+ */
+#define MAP_GROUP_MAX                   2
 
 
 /**
@@ -47,10 +96,14 @@
  *      b0-b3=compression type for metaTiles<br>
  *      b4-b7=compression for blocks data<br>
  *      b8-b11=compression for blockIndexes data<br>
+ *      b12=#MAP_BLOCKS_STREAM flag: blocks are compressed individually (<i>blocks</i> is then a table of pointers to each block data)
+ *      so they can be unpacked on demand in a small block cache instead of unpacking the whole blocks data in RAM<br>
+ *      b13=#MAP_BLOCKS_PATCH flag: near duplicated blocks are encoded as a base block plus a patch list (streamed blocks only)<br>
  *      Accepted values:<br>
  *        <b>COMPRESSION_NONE</b><br>
  *        <b>COMPRESSION_APLIB</b><br>
  *        <b>COMPRESSION_LZ4W</b><br>
+ *        <b>COMPRESSION_DLZ</b><br>
  *  \param numMetaTile
  *      number of MetaTile
  *  \param numBlock
@@ -88,6 +141,134 @@ typedef struct
 } MapDefinition;
 
 
+/**
+ *  \brief
+ *      Block cache (LRU) used by streamed map (see #MAP_BLOCKS_STREAM)
+ *
+ *  \param size
+ *      number of block slot in cache
+ *  \param blockSize
+ *      size of unpacked block data (in bytes)
+ *  \param compression
+ *      blocks compression
+ *  \param wideIndex
+ *      block indexes are 16 bit
+ *  \param patch
+ *      blocks use base block + patch list encoding (see #MAP_BLOCKS_PATCH)
+ *  \param stamp
+ *      LRU access counter
+ *  \param misses
+ *      number of block unpacked since map creation (cache misses)
+ *  \param blockData
+ *      pointers to each (packed) block data
+ *  \param ids
+ *      block index stored in each slot (0xFFFF = empty)
+ *  \param stamps
+ *      last access stamp for each slot
+ *  \param data
+ *      unpacked blocks data
+ */
+typedef struct
+{
+    u16 size;
+    u16 blockSize;
+    u16 compression;
+    u16 wideIndex;
+    u16 patch;
+    u16 stamp;
+    u16 misses;
+    void** blockData;
+    u16* ids;
+    u16* stamps;
+    u8* data;
+} MapBlockCache;
+
+
+/**
+ *  \brief
+ *      Map streaming statistics (only available when ENABLE_MAP_STATS is set in config.h).<br>
+ *      A frame gathers all Map updates done during the same vtimer value.
+ *
+ *  \param frames
+ *      number of frame with at least one map update since last reset
+ *  \param columns
+ *      number of metatile column uploaded on last frame
+ *  \param rows
+ *      number of metatile row uploaded on last frame
+ *  \param tiles
+ *      number of tile prepared on last frame
+ *  \param time
+ *      map data preparation time on last frame (in scanline, 1 scanline ~ 488 CPU cycles)
+ *  \param totalColumns
+ *      total number of metatile column uploaded
+ *  \param totalRows
+ *      total number of metatile row uploaded
+ *  \param peakColumns
+ *      worst frame: number of metatile column uploaded
+ *  \param peakRows
+ *      worst frame: number of metatile row uploaded
+ *  \param peakTiles
+ *      worst frame: number of tile prepared (worst frame is the one with the most prepared tiles)
+ *  \param peakTime
+ *      worst frame: map data preparation time (in scanline)
+ *  \param peakFrame
+ *      worst frame: vtimer value
+ *  \param peakX
+ *      worst frame: view X position (in pixel) of the last scrolled map
+ *  \param peakY
+ *      worst frame: view Y position (in pixel) of the last scrolled map
+ */
+typedef struct
+{
+    u32 frames;
+    u16 columns;
+    u16 rows;
+    u16 tiles;
+    u16 time;
+    u32 totalColumns;
+    u32 totalRows;
+    u16 peakColumns;
+    u16 peakRows;
+    u16 peakTiles;
+    u16 peakTime;
+    u32 peakFrame;
+    u32 peakX;
+    u32 peakY;
+} MapStats;
+
+/**
+ *  \brief
+ *      Modified metatile entry of a MapOverlay
+ */
+typedef struct
+{
+    u16 x;
+    u16 y;
+    u16 value;
+} MapOverlayEntry;
+
+/**
+ *  \brief
+ *      Sparse overlay of modified metatiles (small hash table) used for runtime map modification (see #MAP_setMetaTile(..))
+ *
+ *  \param size
+ *      maximum number of modified metatile
+ *  \param mask
+ *      hash table mask (table size - 1)
+ *  \param num
+ *      current number of modified metatile
+ *  \param entries
+ *      hash table (x = 0xFFFF for empty entry)
+ */
+typedef struct
+{
+    u16 size;
+    u16 mask;
+    u16 num;
+    MapOverlayEntry* entries;
+} MapOverlay;
+
+
 /**
  *  \brief
  *      Map structure containing information for large background/plane update based on #MapDefinition
@@ -136,6 +317,32 @@ typedef struct
  *      internal
  *  \param getMetaTilemapRectCB
  *      internal
+ *  \param blockCache
+ *      block cache for streamed map (NULL if map isn't streamed)
+ *  \param prefetchCol
+ *      number of column to prepare ahead of view when camera is moving horizontally (see #MAP_setPrefetch(..))
+ *  \param prefetchRow
+ *      number of row to prepare ahead of view when camera is moving vertically (see #MAP_setPrefetch(..))
+ *  \param colLo
+ *      internal - first metatile column of the valid plane area
+ *  \param colHi
+ *      internal - last metatile column (exclusive) of the valid plane area
+ *  \param rowLo
+ *      internal - first metatile row of the valid plane area
+ *  \param rowHi
+ *      internal - last metatile row (exclusive) of the valid plane area
+ *  \param metaTileAttr
+ *      per metatile attribute table (collision...) used by #MAP_testPoints(..) and #MAP_testRect(..) (NULL if not set)
+ *  \param overlay
+ *      modified metatiles overlay (NULL if not allocated, see #MAP_createOverlay(..))
+ *  \param scrollMode
+ *      scroll mode (#MAP_SCROLL_HV, #MAP_SCROLL_H_ONLY or #MAP_SCROLL_V_ONLY)
+ *  \param updateMapCB
+ *      internal
+ *  \param tileCache
+ *      VRAM tile cache used to remap prepared tilemap data (NULL if not set, see #MAP_setTileCache(..))
+ *  \param mapDef
+ *      internal - map definition (used to release pinned far data)
  */
 typedef struct Map
 {
@@ -161,14 +368,48 @@ typedef struct Map
     void (*prepareMapDataRowCB)(struct Map *map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width);
     u16  (*getMetaTileCB)(struct Map *map, u16 x, u16 y);
     void (*getMetaTilemapRectCB)(struct Map *map, u16 x, u16 y, u16 w, u16 h, u16* dest);
+    MapBlockCache* blockCache;
+    u16 prefetchCol;
+    u16 prefetchRow;
+    s16 colLo;
+    s16 colHi;
+    s16 rowLo;
+    s16 rowHi;
+    const u8* metaTileAttr;
+    MapOverlay* overlay;
+    u16 scrollMode;
+    bool (*updateMapCB)(struct Map *map, s16 xt, s16 yt);
+    TileCache* tileCache;
+    const MapDefinition* mapDef;
 } Map;
 
+/**
+ *  \brief
+ *      Group of Map scrolled together with fixed parallax ratios (see #MAP_scrollGroupTo(..))
+ *
+ *  \param num
+ *      number of Map in the group
+ *  \param maps
+ *      Map of the group (should use different planes)
+ *  \param ratioX
+ *      parallax ratio applied to group X position for each Map (FIX16(1.0) = lockstep)
+ *  \param ratioY
+ *      parallax ratio applied to group Y position for each Map (FIX16(1.0) = lockstep)
+ */
+typedef struct
+{
+    u16 num;
+    Map* maps[MAP_GROUP_MAX];
+    fix16 ratioX[MAP_GROUP_MAX];
+    fix16 ratioY[MAP_GROUP_MAX];
+} MapGroup;
+
 
 /**
  *  \brief
  *      Create and return a Map structure required to use all MAP_xxx functions
  *      from a given MapDefinition.<br>
- *      When you're done with the map just use MEM_free(map) to release it.
+ *      When you're done with the map just use MAP_release(map) to release it.
  *
  *  \param mapDef
  *      MapDefinition structure containing background/plane data.
@@ -184,6 +425,44 @@ typedef struct Map
  *  \return initialized Map structure or <i>NULL</i> if there is not enough memory to allocate data for given MapDefinition.
  */
 Map* MAP_create(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile);
+/**
+ *  \brief
+ *      Same as #MAP_create(..) except you can specify the scroll mode and the block cache size used for streamed map.<br>
+ *      A map only scrolling in one direction (#MAP_SCROLL_H_ONLY or #MAP_SCROLL_V_ONLY) skips all the work for the
+ *      other direction: the fixed coordinate is only used when the map is (re)drawn so it should stay constant (or at
+ *      least stay inside the plane).<br>
+ *      Vertical only map also works with 32 tiles wide plane (H32 mode) as row updates are clipped to plane width.<br>
+ *      When MapDefinition uses #MAP_BLOCKS_STREAM, blocks stay compressed in ROM and only the blocks around the
+ *      view are unpacked in a small LRU cache so RAM usage is bounded whatever is the map size
+ *      (cacheSize * 64 bytes, or cacheSize * 128 bytes for map using more than 256 metatiles).
+ *  \param mapDef
+ *      MapDefinition structure containing background/plane data.
+ *  \param plane
+ *      Plane where we want to draw the Map (for #MAP_scrollTo(..) method).
+ *  \param baseTile
+ *      Used to provide base tile index and base palette index (see TILE_ATTR_FULL() macro).
+ *  \param mode
+ *      scroll mode, accepted values are:<br>
+ *      - #MAP_SCROLL_HV (same as #MAP_create(..))<br>
+ *      - #MAP_SCROLL_H_ONLY<br>
+ *      - #MAP_SCROLL_V_ONLY<br>
+ *  \param blockCacheSize
+ *      number of blocks in cache (only used for streamed map), should be large enough to hold the blocks of the
+ *      visible area (16 by default, see MAP_BLOCK_CACHE_SIZE_DEFAULT).
+ *  \return initialized Map structure or <i>NULL</i> if there is not enough memory to allocate data for given MapDefinition.
+ *  \see #MAP_create(..)
+ */
+Map* MAP_createEx(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile, u16 mode, u16 blockCacheSize);
+/**
+ *  \brief
+ *      Release a Map created with #MAP_create(..) or #MAP_createEx(..) (overlay included).<br>
+ *      When bank switch is enabled the far map data are pinned in bank regions (see #SYS_acquireFarData(..)) while the
+ *      Map exists so this method should be used instead of MEM_free(map).
+ *
+ *  \param map
+ *      Map to release
+ */
+void MAP_release(Map* map);
 
 /**
  *  \brief
@@ -220,6 +499,79 @@ void MAP_scrollTo(Map* map, u32 x, u32 y);
  *  \see #MAP_scrollTo(..)
  */
 void MAP_scrollToEx(Map* map, u32 x, u32 y, bool forceRedraw);
+/**
+ *  \brief
+ *      Set the number of metatile columns / rows to prepare ahead of the view (look-ahead, disabled by default).<br>
+ *      On frames where #MAP_scrollTo(..) doesn't need any plane update, one column (or row) is uploaded in the hidden
+ *      part of the plane in the camera moving direction. When the camera reaches it later there is nothing left to upload,
+ *      so fast camera moves cost about the same every frame instead of bursting several columns in one frame.<br>
+ *      Look-ahead is limited by the hidden part of the plane: with a 64 tiles wide plane up to 11 columns can be prepared,
+ *      with a 32 tiles high plane no row can be prepared (plane needs to be 64 tiles high for that).
+ *
+ *  \param map
+ *      Map structure containing map information.
+ *  \param columns
+ *      number of metatile (16x16 pixels) columns to prepare ahead (0 = disabled, 1 or 2 is usually enough)
+ *  \param rows
+ *      number of metatile (16x16 pixels) rows to prepare ahead (0 = disabled)
+ *
+ *  \see #MAP_scrollTo(..)
+ */
+void MAP_setPrefetch(Map* map, u16 columns, u16 rows);
+
+/**
+ *  \brief
+ *      Initialize an empty MapGroup
+ *
+ *  \param group
+ *      MapGroup to initialize
+ */
+void MAP_initGroup(MapGroup* group);
+/**
+ *  \brief
+ *      Add a Map to the MapGroup with the given parallax ratios
+ *
+ *  \param group
+ *      MapGroup to add the map to
+ *  \param map
+ *      Map to add (should use a different plane than the other maps of the group)
+ *  \param ratioX
+ *      ratio applied to the group X position to get the Map X position (FIX16(1.0) for lockstep, FIX16(0.5) for half speed...)
+ *  \param ratioY
+ *      ratio applied to the group Y position to get the Map Y position
+ *  \return FALSE if the group is full (see MAP_GROUP_MAX)
+ */
+bool MAP_addToGroup(MapGroup* group, Map* map, fix16 ratioX, fix16 ratioY);
+/**
+ *  \brief
+ *      Scroll all Map of the group to the given position (parallax ratio applied per Map).<br>
+ *      This is equivalent to calling #MAP_scrollTo(..) on each Map except that when the group holds one Map on BG_A and
+ *      one on BG_B, line (HSCROLL_LINE) and column (VSCROLL_COLUMN) scroll tables are uploaded in a single DMA instead of one per plane.
+ *
+ *  \param group
+ *      MapGroup to scroll
+ *  \param x
+ *      group view position X (each map is positioned at x * ratioX)
+ *  \param y
+ *      group view position Y (each map is positioned at y * ratioY)
+ *
+ *  \see #MAP_scrollTo(..)
+ */
+void MAP_scrollGroupTo(MapGroup* group, u32 x, u32 y);
+/**
+ *  \brief
+ *      Exactly as #MAP_scrollGroupTo(..) except we can force complete maps drawing
+ *
+ *  \param group
+ *      MapGroup to scroll
+ *  \param x
+ *      group view position X
+ *  \param y
+ *      group view position Y
+ *  \param forceRedraw
+ *      Set to <i>TRUE</i> to force a complete redraw of all maps (take more time)
+ */
+void MAP_scrollGroupToEx(MapGroup* group, u32 x, u32 y, bool forceRedraw);
 
 /**
  *  \brief
@@ -331,5 +683,173 @@ void MAP_getMetaTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest);
  */
 void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16* dest);
 
+/**
+ *  \brief
+ *      Set the per metatile attribute table (one byte per metatile, indexed by metatile index) used by collision queries.<br>
+ *      Attribute bits meaning is up to the user (solid, platform, water...).<br>
+ *      rescomp exports this table as <i>&lt;map_name&gt;_attributes</i> for MAP resource built from a TMX file defining tile attributes
+ *      ('attr' tile property or '&lt;layer&gt; attr' attribute layer).
+ *
+ *  \param map
+ *      Map structure containing map information.
+ *  \param attributes
+ *      attribute table (MapDefinition.numMetaTile entries), NULL to remove it
+ *
+ *  \see #MAP_getMetaTileAttribute(..)
+ *  \see #MAP_testPoints(..)
+ *  \see #MAP_testRect(..)
+ */
+void MAP_setMetaTileAttributes(Map* map, const u8* attributes);
+/**
+ *  \brief
+ *      Returns attribute (from table set with #MAP_setMetaTileAttributes(..)) of the metatile at given position
+ *
+ *  \param map
+ *      Map structure containing map information (attribute table should be set).
+ *  \param x
+ *      metatile X position
+ *  \param y
+ *      metatile Y position
+ */
+u8 MAP_getMetaTileAttribute(Map* map, u16 x, u16 y);
+/**
+ *  \brief
+ *      Read metatile attributes for a list of points in a single call.<br>
+ *      Much faster than calling #MAP_getMetaTile(..) for each point, especially for map with less than 256 metatiles
+ *      and 256 blocks which use a direct (inlined) access path.
+ *
+ *  \param map
+ *      Map structure containing map information (attribute table should be set).
+ *  \param points
+ *      points position (in pixel)
+ *  \param num
+ *      number of point
+ *  \param dest
+ *      destination buffer receiving attribute for each point (<i>num</i> bytes)
+ */
+void MAP_getPointsAttribute(Map* map, const Vect2D_u16* points, u16 num, u8* dest);
+/**
+ *  \brief
+ *      Test a list of points (up to 32) against metatile attributes.
+ *
+ *  \param map
+ *      Map structure containing map information (attribute table should be set).
+ *  \param points
+ *      points position (in pixel)
+ *  \param num
+ *      number of point (32 max)
+ *  \param mask
+ *      attribute mask to test (ex: solid bit)
+ *  \return bitmask where bit <i>n</i> is set if (attribute of point <i>n</i> & mask) != 0
+ */
+u32 MAP_testPoints(Map* map, const Vect2D_u16* points, u16 num, u8 mask);
+/**
+ *  \brief
+ *      Test a metatile rectangle (up to 32 metatiles) against metatile attributes.
+ *
+ *  \param map
+ *      Map structure containing map information (attribute table should be set).
+ *  \param x
+ *      metatile X position
+ *  \param y
+ *      metatile Y position
+ *  \param w
+ *      width in metatile
+ *  \param h
+ *      height in metatile (w * h should be <= 32)
+ *  \param mask
+ *      attribute mask to test (ex: solid bit)
+ *  \return bitmask where bit <i>(j * w) + i</i> is set if (attribute of metatile (x + i, y + j) & mask) != 0
+ */
+u32 MAP_testRect(Map* map, u16 x, u16 y, u16 w, u16 h, u8 mask);
+
+/**
+ *  \brief
+ *      Allocate the modified metatile overlay of the Map, required to use #MAP_setMetaTile(..).<br>
+ *      Modified metatiles are kept in a small hash table consulted when map data is prepared (scrolling) and
+ *      when metatile are read so modifications aren't lost when the area scrolls back in.
+ *      While overlay is empty the usual fast path is used.
+ *
+ *  \param map
+ *      Map structure containing map information.
+ *  \param size
+ *      maximum number of modified metatile
+ *  \return FALSE if there is not enough memory to allocate the overlay
+ *
+ *  \see #MAP_setMetaTile(..)
+ *  \see #MAP_releaseOverlay(..)
+ */
+bool MAP_createOverlay(Map* map, u16 size);
+/**
+ *  \brief
+ *      Release the modified metatile overlay of the Map (all modifications are lost, plane isn't redrawn)
+ *
+ *  \param map
+ *      Map structure containing map information.
+ */
+void MAP_releaseOverlay(Map* map);
+/**
+ *  \brief
+ *      Remove all metatile modifications (plane isn't redrawn, use #MAP_scrollToEx(..) with forceRedraw for that)
+ *
+ *  \param map
+ *      Map structure containing map information.
+ */
+void MAP_clearOverlay(Map* map);
+/**
+ *  \brief
+ *      Modify the metatile at given position (breakable blocks, doors...).<br>
+ *      If the metatile is currently in the plane it is immediately updated (DMA queue).
+ *
+ *  \param map
+ *      Map structure containing map information (overlay should be allocated with #MAP_createOverlay(..)).
+ *  \param x
+ *      metatile X position
+ *  \param y
+ *      metatile Y position
+ *  \param value
+ *      new metatile attribute (same format as #MAP_getMetaTile(..) return value)
+ *  \return FALSE if overlay is full (or not allocated)
+ *
+ *  \see #MAP_createOverlay(..)
+ */
+bool MAP_setMetaTile(Map* map, u16 x, u16 y, u16 value);
+
+/**
+ *  \brief
+ *      Attach a VRAM tile cache to the map: all tilemap data written to the plane are remapped through the cache
+ *      (tile index of map data is used as logical tile id), tiles are uploaded on demand.<br>
+ *      Map should be created with a base tile index of 0 (base palette and priority are still allowed).<br>
+ *      This allows maps using more unique tiles than what fit in VRAM, as long as the visible area fits in the cache.
+ *
+ *  \param map
+ *      Map structure containing map information.
+ *  \param cache
+ *      tile cache (see #TILECACHE_create(..)), NULL to remove it
+ *
+ *  \see #TILECACHE_create(..)
+ */
+void MAP_setTileCache(Map* map, TileCache* cache);
+
+#if (ENABLE_MAP_STATS != 0)
+/**
+ *  \brief
+ *      Returns Map streaming statistics accumulated since last #MAP_resetStats() call.
+ *
+ *  \see MapStats
+ */
+const MapStats* MAP_getStats(void);
+/**
+ *  \brief
+ *      Reset Map streaming statistics.
+ */
+void MAP_resetStats(void);
+/**
+ *  \brief
+ *      Log Map streaming statistics (KLog).
+ */
+void MAP_logStats(void);
+#endif  // ENABLE_MAP_STATS
+
 
 #endif // _MAP_H_
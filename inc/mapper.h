@@ -28,7 +28,13 @@
  *       If 0x01 is written to register 0xA130FF, 0x080000-0x0FFFFF is visible at 0x380000-0x3FFFFF.<br>
  *       If 0x08 is written to register 0xA130F9, the first 512KB of the normally invisible upper 1MB of ROM is now visible at 0x200000-0x27FFFF.<br>
  *<br>
- * The registers simply represent address ranges in the 4MB ROM area and you can page in data to these ranges by specifying the bank #
+ * The registers simply represent address ranges in the 4MB ROM area and you can page in data to these ranges by specifying the bank #<br>
+ *<br>
+ * FAR data access uses the regions from BANK_SWITCH_FIRST_REGION (see config.h, default is region 6) to region 7 as a cache of banks:<br>
+ * an already mapped bank is re-used and otherwise the least recently used region is remapped. SYS_getFarData(..) pointers stay
+ * valid only until a next FAR data access needs a region so loaders which keep data mapped for a while (DMA queue, PCM stream,
+ * map data) use SYS_acquireFarData(..) / SYS_releaseFarData(..) instead, which pin the region(s) until release.<br>
+ * SYS_getBankSwitchCount() gives the number of bank switch done during last frame to detect bank thrashing.
  */
 
 #ifndef _MAPPER_H_
@@ -45,6 +51,22 @@
 #define BANK_IN_MASK    (BANK_SIZE - 1)
 #define BANK_OUT_MASK   (0xFFFFFFFF ^ BANK_IN_MASK)
 
+
+/**
+ *  \brief
+ *      Group of 512 KB banks used together (generated by rescomp from BANK_GROUP resource).
+ *
+ *  \param numBank
+ *      number of bank
+ *  \param banks
+ *      start address of each bank
+ */
+typedef struct
+{
+    u16 numBank;
+    const void* banks[];
+} BankGroup;
+
 /**
  *  \brief
  *      Give access to specified 'far' data through SEGA official bank switch mechanism if needed.
@@ -61,6 +83,24 @@
     #define FAR_SAFE(data, size) data
 #endif
 
+/**
+ *  \brief
+ *      Give access to specified 'far' data and keep it mapped (pinned) until released with #FAR_RELEASE(..) or #FAR_RELEASE_VBLANK(..).
+ *
+ *  \see #SYS_acquireFarData(..)
+ *  \see #SYS_releaseFarData(..)
+ *  \see #SYS_releaseFarDataOnVBlank(..)
+ */
+#if (ENABLE_BANK_SWITCH != 0)
+    #define FAR_ACQUIRE(data, size) SYS_acquireFarData((void*) (data), size)
+    #define FAR_RELEASE(ptr, size) SYS_releaseFarData((void*) (ptr), size)
+    #define FAR_RELEASE_VBLANK(ptr, size) SYS_releaseFarDataOnVBlank((void*) (ptr), size)
+#else
+    #define FAR_ACQUIRE(data, size) (data)
+    #define FAR_RELEASE(ptr, size) ((void) 0)
+    #define FAR_RELEASE_VBLANK(ptr, size) ((void) 0)
+#endif
+
 
 /**
  *  \brief
@@ -78,6 +118,18 @@ u16 SYS_getBank(u16 regionIndex);
  *  \param bankIndex the effective 512KB data bank index mapped on this region. Accepted values: 0-63
  */
 void SYS_setBank(u16 regionIndex, u16 bankIndex);
+/**
+ *  \brief
+ *      Reserve (lock) one of the regions used for FAR data access so it's not remapped anymore by SYS_getFarData(..) methods.<br>
+ *      Useful when you want to manage the bank of a region by yourself with SYS_setBank(..).
+ *
+ *  \param regionIndex the 512KB region index we want to lock / unlock. Accepted values: BANK_SWITCH_FIRST_REGION-7 (other regions aren't used for FAR data access)
+ *  \param lock TRUE to lock the region, FALSE to release it
+ *
+ *  \see SYS_getFarData
+ *  \see SYS_acquireFarData
+ */
+void SYS_lockBank(u16 regionIndex, bool lock);
 
 /**
  *  \brief
@@ -86,9 +138,10 @@ void SYS_setBank(u16 regionIndex, u16 bankIndex);
  *  \param data data we want to access.
  *
  * This method will use bank switching to make the specified data accessible and return a valid pointer to it.<br>
- * <b>WARNING:</b> this method use the 0x00300000-0x003FFFFF range (2 regions) to make the requested data accessible using bank switching mechanism.<br>
- * If data bank is already accessible it re-uses the region otherwise it will change bank of one of the region so be careful of that if you want to access data
- * from different data bank at same time
+ * <b>WARNING:</b> this method use the bank regions (0x00300000-0x003FFFFF range by default) to make the requested data accessible using bank switching mechanism.<br>
+ * If data bank is already accessible it re-uses the region otherwise it will change bank of the least recently used region so be careful of that if you want to access data
+ * from different data bank at same time (use SYS_acquireFarData(..) in that case).<br>
+ * Returns NULL if all regions are pinned.
  *
  *  \see SYS_getFarDataEx
  *  \see SYS_getFarDataSafe
@@ -102,7 +155,8 @@ void* SYS_getFarData(void* data);
  *  \param high if set to TRUE then we use the high remappable bank for the FAR acces otherwise we use the low one
  *
  * This method will use bank switching to make the specified data accessible and return a valid pointer to it.<br>
- * It will use the 0x00300000-0x0037FFFF or 0x00380000-0x003FFFFF region depending the value of <i>high</i> parameter.<br>
+ * It will use the 0x00300000-0x0037FFFF or 0x00380000-0x003FFFFF region depending the value of <i>high</i> parameter
+ * (or any other available region if the requested one is pinned).<br>
  *
  *  \see SYS_getFarData
  *  \see SYS_getFarDataSafe
@@ -129,10 +183,10 @@ bool SYS_isCrossingBank(void* data, u32 size);
  *     Note that size should be > 0, if you don't the size then use SYS_getFarData(..) method instead.
  *
  * This method will use bank switching to make the specified data accessible and return a valid pointer to it.<br>
- * <b>WARNING:</b> this method use the 0x00300000-0x003FFFFF range (2 regions) to make the requested data accessible using bank switching mechanism.<br>
- * If data bank is already accessible it re-uses the region otherwise it will change bank of one of the region so be careful of that if you want to access data
+ * <b>WARNING:</b> this method use the bank regions (0x00300000-0x003FFFFF range by default) to make the requested data accessible using bank switching mechanism.<br>
+ * If data bank is already accessible it re-uses the region otherwise it will change bank of the least recently used region so be careful of that if you want to access data
  * from different data bank at same time :p<br>
- * The method checks if the data is crossing banks in which case it will set the 2 switchable/remappable regions to make the data fully accessible.
+ * The method checks if the data is crossing banks in which case it will set 2 consecutive regions to make the data fully accessible.
  *
  *  \see SYS_getFarDataSafeEx
  *  \see SYS_getFarData
@@ -149,11 +203,71 @@ void* SYS_getFarDataSafe(void* data, u32 size);
  *
  * This method will use bank switching to make the specified data accessible and return a valid pointer to it.<br>
  * It will use the 0x00300000-0x0037FFFF or 0x00380000-0x003FFFFF region depending the value of <i>high</i> parameter.<br>
- * The method checks if the data is crossing banks in which case it will set the 2 switchable/remappable regions to make the data fully accessible.
+ * The method checks if the data is crossing banks in which case it will set 2 consecutive regions to make the data fully accessible.
  *
  *  \see SYS_getFarDataSafe
  */
 void* SYS_getFarDataSafeEx(void* data, u32 size, bool high);
 
+/**
+ *  \brief
+ *      Make the given binary data ressource accessible, pin the used region(s) and return a pointer to it.
+ *
+ *  \param data far data we want to access.
+ *  \param size size (in byte) of the far data block we want to access (can cross a bank).
+ *  \return pointer to the data (to pass to SYS_releaseFarData(..) when done) or NULL if all regions are pinned.
+ *
+ * Same as SYS_getFarDataSafe(..) except that region(s) used to map the data are pinned (reference counted) so they
+ * won't be remapped by other FAR data access until SYS_releaseFarData(..) or SYS_releaseFarDataOnVBlank(..) is called.<br>
+ * Each pinned region reduces the number of regions available for FAR data access so release it as soon as possible.
+ *
+ *  \see SYS_releaseFarData
+ *  \see SYS_releaseFarDataOnVBlank
+ */
+void* SYS_acquireFarData(void* data, u32 size);
+/**
+ *  \brief
+ *      Release far data previously acquired with SYS_acquireFarData(..)
+ *
+ *  \param data pointer returned by SYS_acquireFarData(..)
+ *  \param size size (in byte) given to SYS_acquireFarData(..)
+ */
+void SYS_releaseFarData(void* data, u32 size);
+/**
+ *  \brief
+ *      Release far data previously acquired with SYS_acquireFarData(..) on next SYS_doVBlankProcess(), once the DMA queue
+ *      has been flushed (use it when data was used as source of a DMA_QUEUE transfer).
+ *
+ *  \param data pointer returned by SYS_acquireFarData(..)
+ *  \param size size (in byte) given to SYS_acquireFarData(..)
+ */
+void SYS_releaseFarDataOnVBlank(void* data, u32 size);
+
+/**
+ *  \brief
+ *      Map all banks of the given bank group in the FAR data regions so following FAR data access to the group
+ *      resources don't need any bank switch.
+ *
+ *  \param group bank group (see BANK_GROUP resource in rescomp.txt)
+ *  \return FALSE if the group doesn't fit in the available (not pinned nor locked) regions, in which case only the first banks are mapped
+ *
+ * Call it when loading a level (or whatever the group is for): rescomp places the FAR data of a BANK_GROUP in as few banks as possible
+ * so a group using no more banks than the number of FAR data regions (8 - BANK_SWITCH_FIRST_REGION) can be accessed without any bank
+ * switch until another bank is needed.<br>
+ * Banks in the direct access area (no bank switch needed) are ignored.
+ */
+bool SYS_mapBankGroup(const BankGroup* group);
+
+/**
+ *  \brief
+ *      Returns the number of bank switch done during the last frame (updated by SYS_doVBlankProcess()).
+ */
+u16 SYS_getBankSwitchCount(void);
+/**
+ *  \brief
+ *      Returns the total number of bank switch done since startup.
+ */
+u32 SYS_getBankSwitchTotal(void);
+
 
 #endif // _MAPPER_H_
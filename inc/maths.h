@@ -752,5 +752,134 @@ u16 getLog2Int(u32 value);
  */
 u32 getNextPow2(u32 value);
 
+/**
+ *  \brief
+ *      Return integer square root of specified 32 bits unsigned value (exact, rounded down).
+ *
+ *  \param value
+ *      value to return square root of
+ */
+u16 getSqrtInt(u32 value);
+/**
+ *  \brief
+ *      Return exact euclidean distance for specified vector (result should fit in fix16 range).
+ *
+ *  \param dx
+ *      delta X.
+ *  \param dy
+ *      delta Y.
+ */
+fix16 fix16Dist(fix16 dx, fix16 dy);
+/**
+ *  \brief
+ *      Return euclidean distance approximation (octagonal) for specified vector, faster than #fix16Dist(..)
+ *      but about 3% error.
+ *
+ *  \param dx
+ *      delta X.
+ *  \param dy
+ *      delta Y.
+ */
+fix16 fix16ApproxDist(fix16 dx, fix16 dy);
+/**
+ *  \brief
+ *      Return angle of specified vector (atan2) using a small interpolated table, error is below 1 unit.<br>
+ *      Angle is returned with the same unit as sinFix16(..) / cosFix16(..) (1024 = 2 PI) so an enemy can aim the player with:<pre>
+ *      angle = fix16Atan2(player.y - enemy.y, player.x - enemy.x);
+ *      velX = cosFix16(angle);
+ *      velY = sinFix16(angle);</pre>
+ *
+ *  \param y
+ *      delta Y.
+ *  \param x
+ *      delta X.
+ *  \return angle in [0..1023] range (0 if vector is null)
+ */
+u16 fix16Atan2(fix16 y, fix16 x);
+/**
+ *  \brief
+ *      Same as #fix16Atan2(..) for fix32 values.
+ */
+u16 fix32Atan2(fix32 y, fix32 x);
+
+/**
+ *  \brief
+ *      Add 2 fix16 arrays: dest[i] = src1[i] + src2[i] (dest can be src1 or src2).<br>
+ *      Batch methods are written in assembly and unrolled, use them to process many entities at once and save call overhead.
+ *
+ *  \param src1
+ *      first array
+ *  \param src2
+ *      second array
+ *  \param dest
+ *      result array
+ *  \param num
+ *      number of element
+ */
+void fix16AddArray(const fix16 *src1, const fix16 *src2, fix16 *dest, u16 num);
+/**
+ *  \brief
+ *      Add 2 fix32 arrays: dest[i] = src1[i] + src2[i] (dest can be src1 or src2).
+ *
+ *  \see fix16AddArray(..)
+ */
+void fix32AddArray(const fix32 *src1, const fix32 *src2, fix32 *dest, u16 num);
+/**
+ *  \brief
+ *      Multiply a fix16 array by a scalar: dest[i] = src[i] * scalar (dest can be src).
+ *
+ *  \param src
+ *      source array
+ *  \param scalar
+ *      multiplier
+ *  \param dest
+ *      result array
+ *  \param num
+ *      number of element
+ */
+void fix16MulScalarArray(const fix16 *src, fix16 scalar, fix16 *dest, u16 num);
+/**
+ *  \brief
+ *      Integrate positions: pos[i] += vel[i] * dt
+ *
+ *  \param pos
+ *      position array (updated)
+ *  \param vel
+ *      velocity array
+ *  \param dt
+ *      time step (FIX16(1) to simply add velocity)
+ *  \param num
+ *      number of element
+ */
+void V2f16IntegrateArray(V2f16 *pos, const V2f16 *vel, fix16 dt, u16 num);
+/**
+ *  \brief
+ *      Dot products: dest[i] = (v1[i].x * v2[i].x) + (v1[i].y * v2[i].y).<br>
+ *      Result is returned as fix32 as it can easily overflow fix16 range.
+ *
+ *  \param v1
+ *      first vector array
+ *  \param v2
+ *      second vector array
+ *  \param dest
+ *      result array
+ *  \param num
+ *      number of element
+ */
+void V2f16DotArray(const V2f16 *v1, const V2f16 *v2, fix32 *dest, u16 num);
+/**
+ *  \brief
+ *      Squared lengths: dest[i] = (v[i].x * v[i].x) + (v[i].y * v[i].y).<br>
+ *      Result is returned as fix32 as it can easily overflow fix16 range.
+ *
+ *  \param v
+ *      vector array
+ *  \param dest
+ *      result array
+ *  \param num
+ *      number of element
+ */
+void V2f16LengthSqArray(const V2f16 *v, fix32 *dest, u16 num);
+
 
 #endif // _MATHS_H_
@@ -9,6 +9,7 @@
  * - rotation X, Y, Z<br>
  * - one directionnal light<br>
  * - 2D projection<br>
+ * - near plane and side (frustum) polygon clipping<br>
  *<br>
  * Can transform (including 2D projection) about ~10000 vertices / seconde.
  */
@@ -17,6 +18,39 @@
 #define _MATHS3D_H_
 
 
+/**
+ *  \brief
+ *      Vertex is closer than near clip plane (see #M3D_getClipCode(..))
+ */
+#define M3D_CLIP_NEAR           (1 << 0)
+/**
+ *  \brief
+ *      Vertex is on the left of the view frustum (see #M3D_getClipCode(..))
+ */
+#define M3D_CLIP_LEFT           (1 << 1)
+/**
+ *  \brief
+ *      Vertex is on the right of the view frustum (see #M3D_getClipCode(..))
+ */
+#define M3D_CLIP_RIGHT          (1 << 2)
+/**
+ *  \brief
+ *      Vertex is above the view frustum (see #M3D_getClipCode(..))
+ */
+#define M3D_CLIP_TOP            (1 << 3)
+/**
+ *  \brief
+ *      Vertex is below the view frustum (see #M3D_getClipCode(..))
+ */
+#define M3D_CLIP_BOTTOM         (1 << 4)
+
+/**
+ *  \brief
+ *      Maximum number of vertex of a polygon given to #M3D_clipPolygon(..)
+ */
+#define M3D_CLIP_MAXVERTEX      16
+
+
 /**
  *  \brief
  *      Structure hosting settings / context for the 3D transform engine.
@@ -27,6 +61,7 @@ typedef struct
     fix16 camDist;
     V3f16 light;
     u16 lightEnabled;
+    fix16 nearZ;
 } Context3D;
 
 /**
@@ -59,6 +94,54 @@ typedef struct
     V3f16 lightInv;
 } Transformation3D;
 
+/**
+ *  \brief
+ *      Indexed 3D mesh (flat shaded faces) for #M3D_renderMesh(..)
+ *
+ *  \param numVertex
+ *      number of vertex
+ *  \param numFace
+ *      number of face
+ *  \param vertPerFace
+ *      number of vertex per face (3 for triangles, 4 for quads...), faces should be convex and use clockwise order
+ *  \param vertices
+ *      vertices (numVertex entries)
+ *  \param indexes
+ *      face vertex indexes (numFace * vertPerFace entries), vertices shared by several faces are only transformed once
+ *  \param normals
+ *      face normals (numFace entries) used for lighting, can be NULL
+ */
+typedef struct
+{
+    u16 numVertex;
+    u16 numFace;
+    u16 vertPerFace;
+    const V3f16* vertices;
+    const u16* indexes;
+    const V3f16* normals;
+} Mesh3D;
+
+/**
+ *  \brief
+ *      Vertex cache entry for #M3D_renderMesh(..) (internal use)
+ *
+ *  \param pt
+ *      projected position (only valid if vertex isn't closer than near plane)
+ *  \param pos
+ *      transformed position (fix16)
+ *  \param clip
+ *      clip code of transformed position (see #M3D_getClipCode(..))
+ *  \param stamp
+ *      render stamp, entry is valid if equal to current render stamp
+ */
+typedef struct
+{
+    V2s16 pt;
+    V3f16 pos;
+    u16 clip;
+    u16 stamp;
+} MeshVertex3D;
+
 /**
  *  \brief
  *      Reset math 3D engine (reset matrices and transformation parameters mainly).
@@ -94,6 +177,20 @@ void M3D_setViewport(u16 w, u16 h);
  *      Distance between the camera and the scene.
  */
 void M3D_setCamDistance(fix16 value);
+/**
+ *  \brief
+ *      Set near clip plane distance (from camera, default is FIX16(1)).<br>
+ *      Value should be greater than <i>camDist / 32</i> to keep projection in range.
+ *
+ *  \param value
+ *      Distance between the camera and the near clip plane.
+ */
+void M3D_setNearClip(fix16 value);
+/**
+ *  \brief
+ *      Get near clip plane distance.
+ */
+fix16 M3D_getNearClip(void);
 /**
  *  \brief
  *      Set light direction vector.
@@ -275,5 +372,55 @@ void M3D_project_f16(const V3f16* src, V2f16* dest, u16 numv);
  */
 void M3D_project_s16(const V3f16* src, V2s16* dest, u16 numv);
 
+/**
+ *  \brief
+ *      Returns the clip code of a transformed 3D vertex, 0 means the vertex is inside the view frustum.
+ *
+ *  \param v
+ *      Transformed 3D vertex.
+ *  \return combination of M3D_CLIP_NEAR, M3D_CLIP_LEFT, M3D_CLIP_RIGHT, M3D_CLIP_TOP and M3D_CLIP_BOTTOM flags
+ */
+u16 M3D_getClipCode(const V3f16* v);
+/**
+ *  \brief
+ *      Clip a transformed convex polygon against the near plane and the sides of the view frustum (Sutherland-Hodgman).<br>
+ *      Result can be projected with #M3D_project_s16(..) and drawn with BMP_drawPolygon(..).
+ *
+ *  \param src
+ *      Source polygon (transformed 3D vertices), at most M3D_CLIP_MAXVERTEX vertices.
+ *  \param num
+ *      Number of vertex of source polygon.
+ *  \param dest
+ *      Destination polygon (num + 5 entries), should not overlap source.
+ *  \return number of vertex of clipped polygon (0 if polygon is totally outside view frustum).
+ *
+ * Intersections are always computed from the inside vertex of an edge so an edge shared by 2 polygons is clipped
+ * exactly the same way for both (no crack).
+ */
+u16 M3D_clipPolygon(const V3f16* src, u16 num, V3f16* dest);
+
+/**
+ *  \brief
+ *      Transform, project, cull and light a mesh in a single pass then submit its visible faces to the span renderer
+ *      (see bmp_span.h), call SPAN_render() to draw them.
+ *
+ *  \param t
+ *      Transformation object containing rotation and translation parameters.
+ *  \param mesh
+ *      Mesh to render.
+ *  \param cache
+ *      vertex cache buffer (mesh->numVertex entries, content doesn't need to be initialized).
+ *  \param col
+ *      base face color index (0-15), lit faces use index col to col + 3 depending light intensity
+ *      (lighting is done only if enabled and mesh has normals).
+ *  \return number of visible face.
+ *
+ * Vertices are transformed and projected on first use by a face (vertices shared by several faces are processed once),
+ * back faced faces are rejected right after projection and lighting is computed only for visible faces.<br>
+ * Faces totally outside the view frustum are rejected before projection and faces crossing the near plane or the sides
+ * of the view frustum are clipped (see #M3D_clipPolygon(..)).
+ */
+u16 M3D_renderMesh(Transformation3D* t, const Mesh3D* mesh, MeshVertex3D* cache, u16 col);
+
 
 #endif // _MATHS3D_H_
@@ -23,6 +23,57 @@
 // asics memory address definitions
 #include "memory_base.h"
 
+/**
+ *  \brief
+ *      CPU load (in %) under which auto pack is done in SYS_doVBlankProcess()
+ *
+ *  \see MEM_setAutoPack(..)
+ */
+#define MEM_AUTO_PACK_MAX_CPU_LOAD  75
+
+/**
+ *  \brief
+ *      Place a global variable in the static RAM region.<br>
+ *      Static RAM region is located at a fixed address (chosen at link time) just below the stack and isn't part of the heap:
+ *      no allocation cost nor fragmentation. Its content is cleared on hard reset only.<pre>
+ *      static u16 buffer[1024] RAM_REGION;</pre>
+ *
+ *  \see MEM_getRegionSize()
+ */
+#define RAM_REGION                  __attribute__((section(".ramregion")))
+
+/**
+ *  \brief
+ *      Allocation tags (see #MEM_setTag(..)), user tags start at #MEM_TAG_USER_FIRST.
+ */
+#define MEM_TAG_USER                0
+#define MEM_TAG_SYS                 1
+#define MEM_TAG_DMA                 2
+#define MEM_TAG_SPRITE              3
+#define MEM_TAG_BMP                 4
+#define MEM_TAG_USER_FIRST          8
+/**
+ *  \brief
+ *      Number of allocation tags (tag values are masked with MEM_TAG_NUM - 1)
+ */
+#define MEM_TAG_NUM                 16
+/**
+ *  \brief
+ *      Maximum number of allocated blocks tracked by allocation tracing (see ENABLE_MEM_TRACE)
+ */
+#define MEM_TRACE_MAX_BLOCK         256
+
+/**
+ *  \brief
+ *      Memory reclaim callback (see #MEM_setReclaimCallback(..)).
+ *
+ *  \param size
+ *      size (in bytes, including block header) of the allocation which cannot be satisfied
+ *  \return
+ *      TRUE if some memory was released (allocation is retried), FALSE if nothing more can be released
+ */
+typedef bool MemReclaimCallback(u16 size);
+
 /**
  *  \brief
  *      Get u32 from u8 array (BigEndian order).
@@ -208,6 +259,54 @@ void* MEM_alloc(u16 size);
  *      You can call this method before trying to allocate small block of memory to reduce memory fragmentation.
  */
 void MEM_pack(void);
+/**
+ *  \brief
+ *      Incremental version of #MEM_pack(): coalesce at most <i>maxBlocks</i> adjacent free blocks then return.
+ *
+ *  \param maxBlocks
+ *      maximum number of free blocks to collapse for this call
+ *  \return
+ *      number of collapsed free blocks (0 means the end of heap was reached without anything to pack, next call restarts from heap).
+ *
+ *      Packing state is kept between calls so you can call it in idle time (as level transition) to get the heap
+ *      progressively packed without a long unbounded pause.<br>
+ *      Unlike #MEM_pack(), cached blocks from the small block allocator are not released.
+ *
+ *  \see MEM_setAutoPack(..)
+ */
+u16 MEM_packStep(u16 maxBlocks);
+/**
+ *  \brief
+ *      Returns the number of free blocks to coalesce per frame in auto pack mode (0 = disabled)
+ *
+ *  \see MEM_setAutoPack(..)
+ */
+u16 MEM_getAutoPack(void);
+/**
+ *  \brief
+ *      Enable automatic incremental packing (default is disabled).
+ *
+ *  \param maxBlocks
+ *      number of free blocks to coalesce per frame (0 to disable)
+ *
+ *      When enabled, #MEM_packStep(..) is called from SYS_doVBlankProcess() while waiting for VBlank as long as
+ *      CPU load is below #MEM_AUTO_PACK_MAX_CPU_LOAD.
+ *
+ *  \see MEM_packStep(..)
+ */
+void MEM_setAutoPack(u16 maxBlocks);
+/**
+ *  \brief
+ *      Set the memory reclaim callback (NULL by default).
+ *
+ *      The callback is called by #MEM_alloc(..) when an allocation still cannot be satisfied after heap packing, it can
+ *      release disposable memory (as cached data) using #MEM_free(..) and the allocation is retried until it succeeds or
+ *      the callback returns FALSE.<br>
+ *      Allocations done from inside the callback never call it again.
+ *
+ *  \see ASSETCACHE_init(..)
+ */
+void MEM_setReclaimCallback(MemReclaimCallback* cb);
 /**
  *  \brief
  *      Show memory dump
@@ -216,6 +315,96 @@ void MEM_pack(void);
  */
 void MEM_dump(void);
 
+/**
+ *  \brief
+ *      Returns TRUE if the small block allocator is enabled.
+ *
+ *  \see MEM_setSmallAllocator(..)
+ */
+bool MEM_getSmallAllocator(void);
+/**
+ *  \brief
+ *      Enable or disable the small block allocator (default is FALSE).
+ *
+ *      When enabled, allocations up to 128 bytes are rounded to a size class (8, 16, 32, 64 or 128 bytes) and released blocks
+ *      are kept in a free list per size class so they can be reused immediately without walking the heap.<br>
+ *      Cached blocks are given back to the heap on #MEM_pack(), when disabling the small block allocator or when an
+ *      allocation can't be satisfied otherwise.<br>
+ *      #MEM_getFree() includes cached blocks while #MEM_getAllocated() excludes them.
+ *
+ *  \see MEM_getSmallCached()
+ */
+void MEM_setSmallAllocator(bool value);
+/**
+ *  \brief
+ *      Returns memory (in bytes) currently retained in the small block allocator free lists.
+ */
+u16 MEM_getSmallCached(void);
+
+/**
+ *  \brief
+ *      Returns start address of the static RAM region (see #RAM_REGION), this is also the heap end address.
+ */
+u32 MEM_getRegionStart(void);
+/**
+ *  \brief
+ *      Returns size (in bytes) of the static RAM region (see #RAM_REGION).
+ */
+u16 MEM_getRegionSize(void);
+
+/**
+ *  \brief
+ *      Set the tag for next allocations (only used when ENABLE_MEM_TRACE is set).
+ *
+ *  \param tag
+ *      allocation tag (MEM_TAG_xxx or user tag from MEM_TAG_USER_FIRST to MEM_TAG_NUM-1)
+ *  \return
+ *      the previous tag so it can be restored after allocations.
+ *
+ *  \see MEM_dumpTrace()
+ */
+u16 MEM_setTag(u16 tag);
+/**
+ *  \brief
+ *      Returns the current allocation tag.
+ *
+ *  \see MEM_setTag(..)
+ */
+u16 MEM_getTag(void);
+
+#if (ENABLE_MEM_TRACE != 0)
+/**
+ *  \brief
+ *      Returns the highest amount of allocated memory (in bytes, including block headers) since last #MEM_resetTrace()
+ */
+u16 MEM_getPeakAllocated(void);
+/**
+ *  \brief
+ *      Returns the smallest value of the largest free block (in bytes) observed after an allocation since last #MEM_resetTrace()
+ */
+u16 MEM_getMinLargestFreeBlock(void);
+/**
+ *  \brief
+ *      Returns current allocated memory (in bytes, including block headers) for the given tag
+ */
+u16 MEM_getTagAllocated(u16 tag);
+/**
+ *  \brief
+ *      Returns the highest amount of allocated memory (in bytes, including block headers) for the given tag
+ */
+u16 MEM_getTagPeakAllocated(u16 tag);
+/**
+ *  \brief
+ *      Reset peak values of allocation tracing (current allocations remain tracked)
+ */
+void MEM_resetTrace(void);
+/**
+ *  \brief
+ *      Dump allocation tracing summary (global and per tag) using KLog methods
+ */
+void MEM_dumpTrace(void);
+#endif
+
 #if (ENABLE_NEWLIB == 0)
 /**
  *  \brief
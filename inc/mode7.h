@@ -0,0 +1,74 @@
+/**
+ *  \file mode7.h
+ *  \brief Mode 7 like perspective floor renderer for the bitmap engine
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit renders a textured perspective floor (racing games, pseudo 3D) in the bitmap engine write buffer.<br>
+ * Each bitmap line below the horizon is a straight line of the (infinitely repeated) floor texture: distance and
+ * texture stepping of each line only depend on camera height so they are precomputed (1/z tables) at init time,
+ * rendering a frame then only costs a rotation per line and an assembly texture sampler per pixel:<pre>
+ * M7_init(&floor_texture, 40, 32, 128);
+ * ...
+ * M7_setCamera(posX, posY, angle);
+ * M7_render();
+ * BMP_flip(TRUE);</pre>
+ * Lines above the horizon aren't modified (sky can be drawn there or the bitmap view can be reduced).
+ */
+
+#ifndef _MODE7_H_
+#define _MODE7_H_
+
+#include "bmp.h"
+
+
+/**
+ *  \brief
+ *      Initialize the floor renderer.
+ *
+ *  \param texture
+ *      floor texture, should be square with a size of 64, 128 or 256 pixels.<br>
+ *      A compressed texture is unpacked in memory (32 KB for a 256x256 texture) so it's better to keep it uncompressed.
+ *  \param horizon
+ *      horizon line (in bitmap view), floor is drawn below it.
+ *  \param height
+ *      camera height (in texel).
+ *  \param focal
+ *      camera focal length (in pixel), 128 gives a 90 degrees field of view on a 256 pixels wide view.
+ *  \return FALSE if texture size isn't supported or if there is not enough memory
+ */
+bool M7_init(const Bitmap *texture, u16 horizon, u16 height, u16 focal);
+/**
+ *  \brief
+ *      Release the floor renderer.
+ */
+void M7_end(void);
+/**
+ *  \brief
+ *      Change horizon line, camera height and focal length (perspective tables are recomputed).
+ *
+ *  \see M7_init(..)
+ */
+void M7_setView(u16 horizon, u16 height, u16 focal);
+/**
+ *  \brief
+ *      Set camera position and orientation.
+ *
+ *  \param x
+ *      X position (in texel).
+ *  \param y
+ *      Y position (in texel).
+ *  \param angle
+ *      view direction (0-1023 angle as used by sinFix16(..)), 0 = looking toward positive X.
+ */
+void M7_setCamera(fix32 x, fix32 y, u16 angle);
+/**
+ *  \brief
+ *      Render floor in bitmap write buffer (linear bitmap layout only).
+ *
+ *  \return number of rendered line
+ */
+u16 M7_render(void);
+
+
+#endif // _MODE7_H_
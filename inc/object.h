@@ -18,19 +18,46 @@
  *     ...
  * };</pre>
  *
- * Doing that your Entity structure can be used through OBJ_xxx methods.
+ * Doing that your Entity structure can be used through OBJ_xxx methods.<br>
+ * <br>
+ * Large levels can also use the activation system: objects register their bounds (#OBJ_setBounds(..)) and objects outside
+ * an activation margin around the camera are put to sleep (#OBJ_updateActivation(..)), sleeping objects are skipped by
+ * #OBJ_updateAll(..) / #OBJ_updateAllByType(..) and their sleep / wake method can release / recreate their sprite:<pre>
+ * OBJ_initActivation(256, 64);
+ * ...
+ * OBJ_setBounds(enemy, x, y, 32, 32);
+ * OBJ_setSleepMethods(enemy, enemySleep, enemyWake);
+ * ...
+ * MAP_scrollTo(map, camX, camY);
+ * OBJ_updateActivation(map);
+ * OBJ_updateAll(pool);</pre>
+ * Bounds are kept sorted on X so only objects around the camera (and objects crossing the activation area border) are
+ * tested on each frame.
  */
 
 #ifndef _OBJECT_H_
 #define _OBJECT_H_
 
 #include "pool.h"
+#include "map.h"
 
 
 /**
  * \brief Allocated state for object (mainly useful for debugging)
  */
 #define OBJ_ALLOCATED       0x8000
+/**
+ * \brief Sleeping state for object (outside activation area, see #OBJ_updateActivation(..))
+ */
+#define OBJ_SLEEPING        0x4000
+/**
+ * \brief Object has bounds registered in the activation system (see #OBJ_setBounds(..))
+ */
+#define OBJ_ACTIVATION      0x2000
+/**
+ * \brief Maximum number of object type which can have a batch update method (see #OBJ_setTypeUpdateMethod(..))
+ */
+#define OBJ_MAX_TYPE        16
 
 
 
@@ -45,13 +72,24 @@ typedef struct Object_ Object;
  *      Object
  */
 typedef void ObjectCallback(Object* obj);
+/**
+ *  \brief
+ *      Object batch function callback (update all objects of a same type at once)
+ *
+ *  \param objs
+ *      Objects array
+ *  \param num
+ *      number of object in the array
+ */
+typedef void ObjectBatchCallback(Object** objs, u16 num);
 
 /**
  *  \brief
  *      Base object structure
  *
  *  \param internalState
- *      Object internal state, you can use it but you should preserv bit 15 as it's used internally to detect invalid object
+ *      Object internal state, you can use it but you should preserv bits 13-15 as they're used internally to detect invalid
+ *      object and activation state
  *  \param type
  *      Object type, can be used to recognize the underlying object / structure type.
  *  \param init
@@ -85,6 +123,22 @@ typedef struct Object_
  *  \see POOL_create(..)
  */
 Pool* OBJ_createObjectPool(u16 size, u16 objectSize);
+/**
+ *  \brief
+ *      Create and allocate a new dense object pool (this method is an alias of #POOL_createDense(..)).<br>
+ *      Objects are kept contiguous in memory so #OBJ_updateAll(..) is faster, but objects are moved on release so
+ *      you should never keep pointers on them.
+ *
+ *  \param size
+ *      the capacity of the pool (in number of object)
+ *  \param objectSize
+ *      the size of a single object (usually you should use sizeof(Struct) here)
+ *
+ *  \return the new created object pool or NULL if there is not enough memory available for that.
+ *
+ *  \see POOL_createDense(..)
+ */
+Pool* OBJ_createDenseObjectPool(u16 size, u16 objectSize);
 
 /**
  *  \brief
@@ -119,12 +173,128 @@ void OBJ_release(Pool* pool, Object* obj, bool maintainCoherency);
 /**
  *  \brief
  *      Iterate over all active objects from the given object pool and call #update() method for each of them.<br>
- *      <b>WARNING:</b> You need to always set 'maintainCoherency' to <i>TRUE</i> when using OBJ_release(..) otherwise stack iteration won't work correctly.
+ *      <b>WARNING:</b> You need to always set 'maintainCoherency' to <i>TRUE</i> when using OBJ_release(..) otherwise stack iteration won't work correctly.<br>
+ *      For dense pool, objects are iterated from last to first so an object can safely release itself from its #update() method.<br>
+ *      Sleeping objects (see #OBJ_updateActivation(..)) are skipped.
  *
  *  \param pool
  *      Object pool to update all objects from.
  */
 void OBJ_updateAll(Pool* pool);
+/**
+ *  \brief
+ *      Iterate over all active objects from the given object pool grouped by object type (#Object.type field).<br>
+ *      Types are processed by priority order (see #OBJ_setTypeUpdateMethod(..)) and defined batch update method is called
+ *      once for all objects of the type, others objects get their own #update() method called.<br>
+ *      <b>WARNING:</b> You shouldn't release objects from a dense pool during batch update (objects are moved on release).
+ *
+ *  \param pool
+ *      Object pool to update all objects from.
+ *
+ *  \see OBJ_setTypeUpdateMethod(..)
+ */
+void OBJ_updateAllByType(Pool* pool);
+/**
+ *  \brief
+ *      Set the batch update method and update priority for the given object type (used by #OBJ_updateAllByType(..))
+ *
+ *  \param type
+ *      Object type (should be < OBJ_MAX_TYPE)
+ *  \param updateMethod
+ *      the method to update all objects of this type at once (NULL to use object #update() method)
+ *  \param priority
+ *      update priority for this type (lower value is updated first, type with same priority are updated by type order).<br>
+ *      Objects with type >= OBJ_MAX_TYPE are always updated last.
+ *
+ *  \see OBJ_updateAllByType(..)
+ */
+void OBJ_setTypeUpdateMethod(u16 type, ObjectBatchCallback* updateMethod, u16 priority);
+
+/**
+ *  \brief
+ *      Initialize the activation system (objects outside the camera activation area are put to sleep).<br>
+ *      Registered objects are referenced by pointer so they should come from a non dense pool.
+ *
+ *  \param maxObject
+ *      maximum number of object with registered bounds
+ *  \param margin
+ *      activation margin around the camera view (in pixel)
+ *  \return FALSE if there is not enough memory
+ *
+ *  \see OBJ_setBounds(..)
+ *  \see OBJ_updateActivation(..)
+ */
+bool OBJ_initActivation(u16 maxObject, u16 margin);
+/**
+ *  \brief
+ *      Release the activation system (sleeping objects stay sleeping).
+ */
+void OBJ_endActivation(void);
+/**
+ *  \brief
+ *      Set the activation margin around the camera view (in pixel).
+ */
+void OBJ_setActivationMargin(u16 margin);
+/**
+ *  \brief
+ *      Register or update the bounds of the given object in the activation system (object stays awake until the next
+ *      #OBJ_updateActivation(..) call).<br>
+ *      Bounds are usually the object spawn area, objects are found by linear search so updating bounds of moving
+ *      objects on each frame isn't recommended. Bounds are unregistered on #OBJ_release(..).
+ *
+ *  \param obj
+ *      Object
+ *  \param x
+ *      bounds X position in level (in pixel)
+ *  \param y
+ *      bounds Y position in level (in pixel)
+ *  \param w
+ *      bounds width
+ *  \param h
+ *      bounds height
+ *  \return FALSE if the activation system isn't initialized or is full
+ */
+bool OBJ_setBounds(Object* obj, s16 x, s16 y, u16 w, u16 h);
+/**
+ *  \brief
+ *      Set the methods called when the object is put to sleep / woken up by the activation system (should release /
+ *      recreate object sprite), object bounds should be registered first.
+ *
+ *  \param obj
+ *      Object
+ *  \param sleepMethod
+ *      method called before the object is put to sleep (NULL = none)
+ *  \param wakeMethod
+ *      method called when the object is woken up (NULL = none)
+ */
+void OBJ_setSleepMethods(Object* obj, ObjectCallback* sleepMethod, ObjectCallback* wakeMethod);
+/**
+ *  \brief
+ *      Returns TRUE if the given object is sleeping (outside activation area).
+ */
+bool OBJ_isSleeping(Object* obj);
+/**
+ *  \brief
+ *      Put to sleep / wake up registered objects from the given map view position (#Map.posX / #Map.posY), should be
+ *      called once per frame after #MAP_scrollTo(..) and before #OBJ_updateAll(..).
+ *
+ *  \param map
+ *      Map giving the camera position
+ *
+ *  \see OBJ_updateActivationEx(..)
+ */
+void OBJ_updateActivation(const Map* map);
+/**
+ *  \brief
+ *      Put to sleep / wake up registered objects from the given camera position (activation area = screen view
+ *      extended by the activation margin).
+ *
+ *  \param camX
+ *      camera X position in level (left, in pixel)
+ *  \param camY
+ *      camera Y position in level (top, in pixel)
+ */
+void OBJ_updateActivationEx(s16 camX, s16 camY);
 
 /**
  *  \brief
@@ -25,6 +25,33 @@
 #define VDPPALETTE_BLUEMASK         0x0E00
 #define VDPPALETTE_COLORMASK        0x0EEE
 
+/**
+ *  \brief
+ *      Number of fade channel (concurrent fades on separate color ranges, see #PAL_fadeChannel(..))
+ */
+#define PAL_FADE_CHANNEL_MAX        4
+
+/**
+ *  \brief
+ *      Fade channel mode: fade to given palette
+ */
+#define PAL_FADE_TO_PALETTE         0
+/**
+ *  \brief
+ *      Fade channel mode: fade to black
+ */
+#define PAL_FADE_TO_BLACK           1
+/**
+ *  \brief
+ *      Fade channel mode: fade to white
+ */
+#define PAL_FADE_TO_WHITE           2
+/**
+ *  \brief
+ *      Fade channel mode: fade to half intensity of current colors (same as VDP shadow)
+ */
+#define PAL_FADE_TO_SHADOW          3
+
 /**
  *  \brief
  *      Convert a RGB 24 bits color to VDP color
@@ -225,6 +252,25 @@ void PAL_setPaletteColorsDMA(u16 index, const Palette* pal);
  */
 void PAL_setPaletteDMA(u16 numPal, const u16* pal);
 
+/**
+ *  \brief
+ *      Enable / disable the palette buffer.<br>
+ *      When enabled, all palette writes (PAL_setColor(..), PAL_setColors(..), fading...) only modify a 64 colors RAM buffer
+ *      where modified colors are tracked, the modified range is then uploaded with a single DMA during VBlank
+ *      (see #SYS_doVBlankProcess()) so CRAM is never written during active display (no CRAM dots).<br>
+ *      Transfer method parameter is then ignored and get methods (PAL_getColor(..)...) read the buffer instead of CRAM.
+ *
+ *  \param value
+ *      TRUE to enable the palette buffer (initialized from current CRAM content), FALSE to disable it
+ *      (pending modifications are queued in the DMA queue).
+ */
+void PAL_setBuffered(bool value);
+/**
+ *  \brief
+ *      Returns TRUE if palette buffer is enabled (see #PAL_setBuffered(..))
+ */
+bool PAL_isBuffered(void);
+
 /**
  *  \brief
  *      Initialize a fading operation that will be manually controlled through #PAL_doFadeStep() calls
@@ -482,5 +528,38 @@ void PAL_waitFadeCompletion(void);
  */
 void PAL_interruptFade(void);
 
+/**
+ *  \brief
+ *      Start an asynchronous fade on a fade channel, from current palette colors to the target defined by <i>mode</i>.<br>
+ *      Several channels can fade simultaneously (ex: background to black while HUD flashes white) as long as they use
+ *      separate color ranges (and don't overlap with #PAL_fade(..) range).<br>
+ *      Component steps are precomputed in packed fixed point so each frame only costs one 32 bit add per color.
+ *
+ *  \param channel
+ *      fade channel (0 to PAL_FADE_CHANNEL_MAX - 1), restart the fade if channel is already fading
+ *  \param fromCol
+ *      Start color index for the fade operation (0-63).
+ *  \param toCol
+ *      End color index for the fade operation (0-63 and >= fromCol).
+ *  \param pal
+ *      target palette (only used with PAL_FADE_TO_PALETTE mode)
+ *  \param mode
+ *      fade mode: PAL_FADE_TO_PALETTE, PAL_FADE_TO_BLACK, PAL_FADE_TO_WHITE or PAL_FADE_TO_SHADOW
+ *  \param numFrame
+ *      Duration of palette fading in number of frame.
+ *  \return FALSE if parameters are invalid
+ */
+bool PAL_fadeChannel(u16 channel, u16 fromCol, u16 toCol, const u16* pal, u16 mode, u16 numFrame);
+/**
+ *  \brief
+ *      Stop fade on given channel (colors stay at current fade step).
+ */
+void PAL_stopFadeChannel(u16 channel);
+/**
+ *  \brief
+ *      Returns TRUE if given fade channel is currently fading.
+ */
+bool PAL_isFadingChannel(u16 channel);
+
 
 #endif // _VDP_PAL_H_
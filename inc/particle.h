@@ -0,0 +1,241 @@
+/**
+ *  \file particle.h
+ *  \brief Particle system unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides a lightweight particle system using raw hardware sprites of the sprite engine (see
+ * #SPR_reserveRawSprites(..)) so particles don't go through the Sprite objects update.<br>
+ * <br>
+ * Particles data is stored as separated arrays (position, velocity, lifetime) in fix16 format so the update loop only
+ * touches contiguous memory, and dead particles are removed by moving the last alive particle in their slot.<br>
+ * Each particle uses one raw sprite allocated with #SPR_allocateRawSprites(..) at system creation, #PARTICLE_update(..)
+ * writes them and marks them as modified so they are uploaded by SPR_update():<pre>
+ * SPR_init();
+ * SPR_reserveRawSprites(64);
+ * ParticleSystem* ps = PARTICLE_createSystem(64, 4, TILE_ATTR_FULL(PAL0, TRUE, FALSE, FALSE, tileIndex), SPRITE_SIZE(1, 1));
+ * PARTICLE_setGravity(ps, FIX16(0.1));
+ * ParticleEmitter* emitter = PARTICLE_addEmitter(ps, FIX16(160), FIX16(200), 0, FIX16(-4), FIX16(1.5), FIX16(1), FIX16(2), 60);
+ * ...
+ * while(TRUE)
+ * {
+ *     PARTICLE_update(ps);
+ *     SPR_update();
+ *     SYS_doVBlankProcess();
+ * }</pre>
+ * Particle sprites are linked in the hardware sprite list by the sprite engine (in front of sprite engine sprites).
+ */
+
+#ifndef _PARTICLE_H_
+#define _PARTICLE_H_
+
+#include "pool.h"
+
+
+/**
+ *  \brief
+ *      Particle emitter structure
+ *
+ *  \param x
+ *      emitter X position (in pixel, fix16 format)
+ *  \param y
+ *      emitter Y position (in pixel, fix16 format)
+ *  \param vx
+ *      base X velocity (in pixel per frame) of emitted particles
+ *  \param vy
+ *      base Y velocity (in pixel per frame) of emitted particles
+ *  \param spreadX
+ *      random X velocity spread (velocity = vx +/- spreadX)
+ *  \param spreadY
+ *      random Y velocity spread (velocity = vy +/- spreadY)
+ *  \param rate
+ *      number of emitted particles per frame (fix16 format so it can be lower than 1)
+ *  \param accum
+ *      emission accumulator (internal)
+ *  \param life
+ *      lifetime (in frame) of emitted particles
+ *  \param active
+ *      emitter is active (emission can be paused by setting it to FALSE)
+ */
+typedef struct
+{
+    fix16 x;
+    fix16 y;
+    fix16 vx;
+    fix16 vy;
+    fix16 spreadX;
+    fix16 spreadY;
+    fix16 rate;
+    fix16 accum;
+    u16 life;
+    bool active;
+} ParticleEmitter;
+
+/**
+ *  \brief
+ *      Particle system structure
+ *
+ *  \param maxParticle
+ *      maximum number of particle (number of allocated raw sprite)
+ *  \param numParticle
+ *      number of alive particle
+ *  \param x
+ *      particles X position array
+ *  \param y
+ *      particles Y position array
+ *  \param vx
+ *      particles X velocity array
+ *  \param vy
+ *      particles Y velocity array
+ *  \param life
+ *      particles remaining lifetime (in frame) array
+ *  \param sprites
+ *      VDP sprite index for each particle slot
+ *  \param gravity
+ *      gravity applied to Y velocity of all particles on each frame
+ *  \param emitters
+ *      emitter pool
+ *  \param attribut
+ *      VDP sprite attribut (tile index, palette, priority and flip) used for particles
+ *  \param size
+ *      VDP sprite size (see SPRITE_SIZE(..) macro) used for particles
+ *  \param rawIndex
+ *      first raw sprite index (see #SPR_allocateRawSprites(..))
+ */
+typedef struct
+{
+    u16 maxParticle;
+    u16 numParticle;
+    fix16* x;
+    fix16* y;
+    fix16* vx;
+    fix16* vy;
+    u16* life;
+    u8* sprites;
+    fix16 gravity;
+    Pool* emitters;
+    u16 attribut;
+    u8 size;
+    u16 rawIndex;
+} ParticleSystem;
+
+
+/**
+ *  \brief
+ *      Create a new particle system.
+ *
+ *  \param maxParticle
+ *      maximum number of particle (one raw sprite is allocated per particle)
+ *  \param maxEmitter
+ *      maximum number of emitter
+ *  \param attribut
+ *      VDP sprite attribut for particles (see TILE_ATTR_FULL(..) macro)
+ *  \param size
+ *      VDP sprite size for particles (see SPRITE_SIZE(..) macro)
+ *
+ *  \return the new particle system or NULL if not enough memory or raw sprites are available.
+ *
+ *  \see PARTICLE_releaseSystem(..)
+ */
+ParticleSystem* PARTICLE_createSystem(u16 maxParticle, u16 maxEmitter, u16 attribut, u8 size);
+/**
+ *  \brief
+ *      Release the particle system (memory and raw sprites).
+ *
+ *  \param ps
+ *      Particle system to release
+ */
+void PARTICLE_releaseSystem(ParticleSystem* ps);
+/**
+ *  \brief
+ *      Remove all particles from the particle system (emitters are kept).
+ *
+ *  \param ps
+ *      Particle system
+ */
+void PARTICLE_clear(ParticleSystem* ps);
+
+/**
+ *  \brief
+ *      Set gravity for the particle system.
+ *
+ *  \param ps
+ *      Particle system
+ *  \param value
+ *      value added to Y velocity of each particle on each frame (in pixel per frame, fix16 format)
+ */
+void PARTICLE_setGravity(ParticleSystem* ps, fix16 value);
+
+/**
+ *  \brief
+ *      Add a new emitter to the particle system.
+ *
+ *  \param ps
+ *      Particle system
+ *  \param x
+ *      emitter X position
+ *  \param y
+ *      emitter Y position
+ *  \param vx
+ *      base X velocity of emitted particles
+ *  \param vy
+ *      base Y velocity of emitted particles
+ *  \param spreadX
+ *      random X velocity spread
+ *  \param spreadY
+ *      random Y velocity spread
+ *  \param rate
+ *      number of emitted particles per frame (fix16 format)
+ *  \param life
+ *      lifetime (in frame) of emitted particles
+ *
+ *  \return the new emitter or NULL if no more emitter is available.
+ *
+ *  \see PARTICLE_removeEmitter(..)
+ */
+ParticleEmitter* PARTICLE_addEmitter(ParticleSystem* ps, fix16 x, fix16 y, fix16 vx, fix16 vy, fix16 spreadX, fix16 spreadY, fix16 rate, u16 life);
+/**
+ *  \brief
+ *      Remove an emitter from the particle system (already emitted particles remain alive).
+ *
+ *  \param ps
+ *      Particle system
+ *  \param emitter
+ *      emitter to remove
+ */
+void PARTICLE_removeEmitter(ParticleSystem* ps, ParticleEmitter* emitter);
+
+/**
+ *  \brief
+ *      Emit a single particle.
+ *
+ *  \param ps
+ *      Particle system
+ *  \param x
+ *      X position
+ *  \param y
+ *      Y position
+ *  \param vx
+ *      X velocity
+ *  \param vy
+ *      Y velocity
+ *  \param life
+ *      lifetime (in frame)
+ *
+ *  \return FALSE if the particle system is full.
+ */
+bool PARTICLE_emit(ParticleSystem* ps, fix16 x, fix16 y, fix16 vx, fix16 vy, u16 life);
+
+/**
+ *  \brief
+ *      Update the particle system: emit new particles from emitters, move particles (velocity and gravity),
+ *      remove dead or offscreen particles and write particle sprites (uploaded on next SPR_update()).<br>
+ *      Usually called once per frame.
+ *
+ *  \param ps
+ *      Particle system
+ */
+void PARTICLE_update(ParticleSystem* ps);
+
+
+#endif // _PARTICLE_H_
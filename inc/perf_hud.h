@@ -0,0 +1,97 @@
+/**
+ *  \file perf_hud.h
+ *  \brief Sprite based performance HUD
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit displays live performance counters with hardware sprites (see spr_text.h) so testers can report precise
+ * numbers from real hardware: CPU load, DMA queue size, VBlank overrun, #SPR_update() time, heap and sprite VRAM usage
+ * and XGM driver load.<br>
+ * Only one counter is refreshed per frame (round robin) and only modified characters are uploaded so the HUD costs a
+ * few hundred cycles and a few tens of DMA bytes per frame.<br>
+ * The HUD uses the sprite text unit which should be initialized with at least #PERFHUD_NUM_TILE free tiles, and
+ * sprite text uses raw sprites of the sprite engine (at least #PERFHUD_NUM_SPRITE should be reserved) so the HUD is
+ * displayed in front of sprite engine sprites and uploaded by #SPR_update():<pre>
+ * SPR_init();
+ * SPR_reserveRawSprites(PERFHUD_NUM_SPRITE);
+ * SPRTEXT_init(NULL, TILE_USER_INDEX + 256, PERFHUD_NUM_TILE);
+ * PERFHUD_init(8, 8, TILE_ATTR(PAL0, TRUE, FALSE, FALSE));
+ * ...
+ * if (pressed & BUTTON_START) PERFHUD_toggle();
+ * ...
+ * PERFHUD_update();
+ * SPR_update();
+ * SYS_doVBlankProcess();</pre>
+ * DMA flushed bytes and VBlank overrun counters are only available when ENABLE_DMA_STATS is set in config.h.
+ */
+
+#ifndef _PERF_HUD_H_
+#define _PERF_HUD_H_
+
+
+/**
+ *  \brief
+ *      Number of displayed counter (1 text line per counter)
+ */
+#define PERFHUD_NUM_LINE        9
+/**
+ *  \brief
+ *      Maximum length of a counter line (in character)
+ */
+#define PERFHUD_LINE_LEN        12
+/**
+ *  \brief
+ *      Number of sprite text VRAM tile required by the HUD (see SPRTEXT_init(..))
+ */
+#define PERFHUD_NUM_TILE        (PERFHUD_NUM_LINE * PERFHUD_LINE_LEN)
+/**
+ *  \brief
+ *      Number of raw sprite required by the HUD (see SPR_reserveRawSprites(..))
+ */
+#define PERFHUD_NUM_SPRITE      (PERFHUD_NUM_LINE * ((PERFHUD_LINE_LEN + 3) / 4))
+
+
+/**
+ *  \brief
+ *      Create the performance HUD (initially visible).
+ *
+ *  \param x
+ *      X position of the HUD (in pixel)
+ *  \param y
+ *      Y position of the HUD (in pixel)
+ *  \param attribut
+ *      sprite attributes (see TILE_ATTR(..) macro)
+ *  \return FALSE if there is not enough memory, raw sprite or sprite text tile
+ */
+bool PERFHUD_init(s16 x, s16 y, u16 attribut);
+/**
+ *  \brief
+ *      Release the performance HUD (should be called before #SPR_end() / #SPR_reset()).
+ */
+void PERFHUD_end(void);
+
+/**
+ *  \brief
+ *      Show or hide the performance HUD.
+ */
+void PERFHUD_setVisible(bool value);
+/**
+ *  \brief
+ *      Returns TRUE if the performance HUD is visible.
+ */
+bool PERFHUD_isVisible(void);
+/**
+ *  \brief
+ *      Toggle the performance HUD visibility.
+ */
+void PERFHUD_toggle(void);
+
+/**
+ *  \brief
+ *      Refresh one counter, should be called once per frame before #SPR_update() so modified sprites are uploaded on
+ *      the same frame (sprite engine time is the one of the previous #SPR_update()).
+ */
+void PERFHUD_update(void);
+
+
+#endif // _PERF_HUD_H_
@@ -31,6 +31,19 @@
  *    // do whatever you need on your bullet
  *    ...
  * }</pre>
+ * <i>Dense</i> pool (see #POOL_createDense(..)) doesn't need any allocation stack: allocated objects are always kept
+ * contiguous at the beginning of the bank (release moves the last allocated object in the released slot) so iteration
+ * walks contiguous memory and #POOL_find(..) is done with simple index math:<pre>
+ * Bullet* bullet = POOL_getFirstObject(bulletPool);
+ * u16 num = POOL_getNumAllocated(bulletPool);
+ * while(num--)
+ * {
+ *    // do whatever you need on your bullet
+ *    ...
+ *    bullet++;
+ * }</pre>
+ * As objects are moved on release, you should never keep pointer on objects from a dense pool (use them for bullets,
+ * particles or any object which isn't referenced elsewhere).
  *
  */
 
@@ -45,12 +58,15 @@
  *  \param bank
  *      bank data
  *  \param allocStack
- *      allocation stack used for fast allocate / release operation
- *  \param ree      point on first available object in the allocation stack
+ *      allocation stack used for fast allocate / release operation (NULL for dense pool)
+ *  \param free
+ *      point on first available object in the allocation stack
  *  \param objectSize
  *      size of a single object (in bytes)
  *  \param size
  *      size of the object pool (in number of object)
+ *  \param num
+ *      number of allocated object (dense pool only)
  */
 typedef struct
 {
@@ -59,9 +75,57 @@ typedef struct
     void** free;
     u16 objectSize;
     u16 size;
+    u16 num;
 } Pool;
 
 
+/**
+ *  \brief
+ *      Define a static dense object pool (bank is placed in .bss, no runtime initialization nor heap allocation needed).<br>
+ *      Should be used at file scope, the pool can then be used as any dense pool through <i>&name</i>:<pre>
+ *      POOL_DEFINE(bullets, 32, Bullet);
+ *      ...
+ *      Bullet* bullet = POOL_ALLOC_STATIC(bullets);
+ *      ...
+ *      POOL_RELEASE_STATIC(bullets, bullet);
+ *      ...
+ *      OBJ_updateAll(&bullets);</pre>
+ *      Never call POOL_destroy(..) on a static pool.
+ *
+ *  \param name
+ *      pool name (bank is named <i>name</i>Bank)
+ *  \param count
+ *      capacity of the pool (in number of object)
+ *  \param type
+ *      object type
+ *
+ *  \see POOL_createDense(..)
+ */
+#define POOL_DEFINE(name, count, type)                                              \
+    static type name##Bank[count];                                                  \
+    static Pool name = { name##Bank, NULL, NULL, sizeof(type), count, 0 }
+
+/**
+ *  \brief
+ *      Allocate an object from a static pool defined with #POOL_DEFINE(..), same as POOL_allocate(..) but inlined using typed access
+ *      (object size is known at compile time).
+ *
+ *  \return the allocated object or NULL if no more object is available
+ */
+#define POOL_ALLOC_STATIC(name)                 ((name.num < (sizeof(name##Bank) / sizeof(name##Bank[0]))) ? &name##Bank[name.num++] : NULL)
+/**
+ *  \brief
+ *      Release an object from a static pool defined with #POOL_DEFINE(..), same as POOL_release(..) but inlined using typed access.<br>
+ *      The last allocated object is moved in place of the released one.
+ */
+#define POOL_RELEASE_STATIC(name, obj)          (*(obj) = name##Bank[--name.num])
+/**
+ *  \brief
+ *      Get object at given index from a static pool defined with #POOL_DEFINE(..) (index should be < POOL_getNumAllocated(&name))
+ */
+#define POOL_GET_STATIC(name, index)            (&name##Bank[index])
+
+
 /**
  *  \brief
  *      Create and allocate a new object pool allocator
@@ -77,6 +141,24 @@ typedef struct
  *  \see POOL_reset(..)
  */
 Pool* POOL_create(u16 size, u16 objectSize);
+/**
+ *  \brief
+ *      Create and allocate a new dense object pool allocator.<br>
+ *      Dense pool doesn't use any allocation stack (saving 4 bytes per object), allocated objects are kept contiguous
+ *      in the bank (release moves the last allocated object in the released slot) so you should never keep pointers
+ *      on objects from a dense pool.
+ *
+ *  \param size
+ *      the capacity of the pool (in number of object)
+ *  \param objectSize
+ *      the size of a single object (usually you should use sizeof(Struct) here)
+ *
+ *  \return the new created object pool or NULL if there is not enough memory available for that.
+ *
+ *  \see POOL_create(..)
+ *  \see POOL_getFirstObject(..)
+ */
+Pool* POOL_createDense(u16 size, u16 objectSize);
 /**
  *  \brief
  *      Release the specified object pool allocator
@@ -121,7 +203,8 @@ void* POOL_allocate(Pool* pool);
  *      Object to release
  *  \param maintainCoherency
  *      set it to <i>TRUE</i> if you want to keep coherency for stack iteration (#see POOL_getFirst()).<br>
- *      Set it to <i>FALSE</i> for faster release process if you don't require object iteration through alloc stack.
+ *      Set it to <i>FALSE</i> for faster release process if you don't require object iteration through alloc stack.<br>
+ *      Ignored for dense pool (always coherent), be careful that the last allocated object is moved in place of the released one.
  *
  *  \see POOL_allocate(..)
  */
@@ -152,12 +235,24 @@ u16 POOL_getNumAllocated(Pool* pool);
  *      Object pool allocator
  *
  *  \see POOL_getNumAllocated(..)
+ *  \see POOL_getFirstObject(..)
  */
 void** POOL_getFirst(Pool* pool);
+/**
+ *  \return
+ *      the first allocated object (dense pool only), allocated objects are contiguous (useful to iterate over all allocated objects)
+ *
+ *  \param pool
+ *      Dense object pool allocator
+ *
+ *  \see POOL_createDense(..)
+ *  \see POOL_getNumAllocated(..)
+ */
+void* POOL_getFirstObject(Pool* pool);
 
 /**
  *  \return
- *      the position of an object in the alloc stack or -1 if the object isn't found (useful for debug purpose mainly)
+ *      the position of an object in the alloc stack (or object index for dense pool) or -1 if the object isn't found (useful for debug purpose mainly)
  *
  *  \param pool
  *      Object pool allocator
@@ -0,0 +1,189 @@
+/**
+ *  \file profiler.h
+ *  \brief Frame profiler
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides a small hierarchical frame profiler (requires ENABLE_PROFILER set to 1 in config.h).<br>
+ * Code zones are delimited with PROF_begin(id) / PROF_end(id) and can be nested, time is measured with #getSubTick()
+ * (V-Counter based, 1280 sub ticks per frame on NTSC and 1536 on PAL).<br>
+ * Each zone accumulates its time over the current frame (a zone can be entered several times per frame), then min /
+ * average / max frame time are computed over #PROF_FRAME_WINDOW frames.<br>
+ * Frame boundary is automatically handled by #SYS_doVBlankProcess() and results can be displayed with #PROF_draw(..)
+ * or sent to KDebug log with #PROF_log().<br>
+ * When ENABLE_PROFILER is 0 the PROF_begin(..) / PROF_end(..) macros are empty so zones can be left in the code.<br>
+ * When ENABLE_TRACE is set zones also record begin / end trace events (see trace.h).
+ *<pre>
+ * PROF_setZoneName(PROF_ZONE_USER + 0, "AI");
+ * ...
+ * PROF_begin(PROF_ZONE_USER + 0);
+ * updateEnemies();
+ * PROF_end(PROF_ZONE_USER + 0);</pre>
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include "trace.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of profiler zone
+ */
+#define PROF_MAX_ZONE           16
+/**
+ *  \brief
+ *      Maximum zone nesting depth
+ */
+#define PROF_MAX_DEPTH          8
+/**
+ *  \brief
+ *      Number of frame used to compute min / average / max zone time (power of 2)
+ */
+#define PROF_FRAME_WINDOW       16
+
+/**
+ *  \brief
+ *      Library zones (automatically measured when profiler is enabled)
+ */
+#define PROF_ZONE_VBLANK        0
+#define PROF_ZONE_DMA           1
+#define PROF_ZONE_SPRITE        2
+#define PROF_ZONE_MAP           3
+#define PROF_ZONE_JOY           4
+/**
+ *  \brief
+ *      First zone id available for user zones
+ */
+#define PROF_ZONE_USER          5
+
+/**
+ *  \brief
+ *      No parent zone
+ */
+#define PROF_NO_PARENT          0xFF
+
+
+/**
+ *  \brief
+ *      Profiler zone
+ *
+ *  \param name
+ *      zone name (can be NULL)
+ *  \param parent
+ *      parent zone (first zone the zone was found nested in) or #PROF_NO_PARENT
+ *  \param depth
+ *      nesting depth (0 for root zone)
+ *  \param calls
+ *      number of time the zone was entered on last completed frame
+ *  \param min
+ *      minimum frame time over last window (sub tick)
+ *  \param avg
+ *      average frame time over last window (sub tick)
+ *  \param max
+ *      maximum frame time over last window (sub tick)
+ *  \param frameTime
+ *      accumulated time for current frame (internal)
+ *  \param frameCalls
+ *      number of call for current frame (internal)
+ *  \param winMin
+ *      minimum frame time for current window (internal)
+ *  \param winMax
+ *      maximum frame time for current window (internal)
+ *  \param winSum
+ *      accumulated frame time for current window (internal)
+ */
+typedef struct
+{
+    const char* name;
+    u8 parent;
+    u8 depth;
+    u16 calls;
+    u16 min;
+    u16 avg;
+    u16 max;
+    u16 frameTime;
+    u16 frameCalls;
+    u16 winMin;
+    u16 winMax;
+    u32 winSum;
+} ProfZone;
+
+
+#if (ENABLE_PROFILER != 0)
+
+/**
+ *  \brief
+ *      Start measuring the given zone (should be followed by PROF_end(id)).
+ */
+#define PROF_begin(id)          PROF_beginZone(id)
+/**
+ *  \brief
+ *      End measuring the given zone (should be the last started zone).
+ */
+#define PROF_end(id)            PROF_endZone(id)
+
+/**
+ *  \brief
+ *      Reset all zones (names are preserved).
+ */
+void PROF_reset(void);
+/**
+ *  \brief
+ *      Set the name of the given zone (used by #PROF_draw(..) and #PROF_log()).
+ */
+void PROF_setZoneName(u16 id, const char* name);
+/**
+ *  \brief
+ *      Start measuring the given zone, use PROF_begin(id) macro instead.
+ */
+void PROF_beginZone(u16 id);
+/**
+ *  \brief
+ *      End measuring the given zone, use PROF_end(id) macro instead.
+ */
+void PROF_endZone(u16 id);
+/**
+ *  \brief
+ *      End the current profiler frame (automatically called by #SYS_doVBlankProcess()).
+ */
+void PROF_endFrame(void);
+/**
+ *  \brief
+ *      Returns the given zone (measured values are updated every #PROF_FRAME_WINDOW frames).
+ */
+const ProfZone* PROF_getZone(u16 id);
+/**
+ *  \brief
+ *      Draw zones average time as text bar graph using the text plane (one line per zone).<br>
+ *      A full bar (16 characters) represents a complete frame.
+ *
+ *  \param x
+ *      X position (in tile)
+ *  \param y
+ *      Y position (in tile) of the first zone
+ *  \return number of drawn line
+ */
+u16 PROF_draw(u16 x, u16 y);
+/**
+ *  \brief
+ *      Send zones min / average / max time to KDebug log.
+ */
+void PROF_log(void);
+
+#elif (ENABLE_TRACE != 0)
+
+// zones are still traced (see trace.h)
+#define PROF_begin(id)          TRACE_begin(id)
+#define PROF_end(id)            TRACE_end(id)
+
+#else
+
+#define PROF_begin(id)
+#define PROF_end(id)
+
+#endif  // ENABLE_PROFILER
+
+
+#endif // _PROFILER_H_
@@ -95,6 +95,14 @@ void PSG_write(u8 data);
  * Set envelope level for the specified PSG channel.
  */
 void PSG_setEnvelope(u8 channel, u8 value);
+/**
+ *  \brief
+ *      Same as #PSG_setEnvelope(..) except the write is done only if envelope level changed.
+ *
+ *  \return TRUE if the write was done, FALSE if it was redundant.
+ *  \see PSG_resetShadow()
+ */
+bool PSG_setEnvelopeCached(u8 channel, u8 value);
 /**
  *  \brief
  *      Set tone.
@@ -107,6 +115,14 @@ void PSG_setEnvelope(u8 channel, u8 value);
  * Set direct tone value for the specified PSG channel.
  */
 void PSG_setTone(u8 channel, u16 value);
+/**
+ *  \brief
+ *      Same as #PSG_setTone(..) except the write is done only if tone changed (and only the low part is written when possible).
+ *
+ *  \return TRUE if a write was done, FALSE if it was redundant.
+ *  \see PSG_resetShadow()
+ */
+bool PSG_setToneCached(u8 channel, u16 value);
 /**
  *  \brief
  *      Partial set tone (low bit only b3-b0).
@@ -148,6 +164,11 @@ void PSG_setFrequency(u8 channel, u16 value);
  *      #PSG_NOISE_FREQ_TONE3
  */
 void PSG_setNoise(u8 type, u8 frequency);
+/**
+ *  \brief
+ *      Invalidate the envelope / tone shadow used by cached methods (to call after a Z80 driver accessed the PSG).
+ */
+void PSG_resetShadow(void);
 
 
 #endif // _PSG_H_
@@ -0,0 +1,70 @@
+/**
+ *  \file psg_sfx.h
+ *  \brief PSG sound effect sequencer
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit plays pre-compiled PSG command streams directly from the 68000 (no Z80 involvement) so cheap PSG sound
+ * effects can be played on top of any music driver.<br>
+ * Sequencer is executed once per frame during the VBlank process (see #SYS_doVBlankProcess()) and only changed
+ * values are written to the PSG port (see #PSG_setToneCached(..) / #PSG_setEnvelopeCached(..)).<br>
+ * Each PSG channel can play one stream at once, a new stream only replaces the current one if its priority is
+ * equal or higher.<br>
+ *<br>
+ * Stream format (byte commands executed in order until a wait command is met):<br>
+ * <b>0x00-0x0F</b>: set envelope (0 = loudest, 15 = silent)<br>
+ * <b>0x10-0x13 LL</b>: set tone, tone = ((cmd &amp; 3) &lt;&lt; 8) | LL<br>
+ * <b>0x20-0x27</b>: set noise (only on channel 3), bit 2 = type (#PSG_NOISE_TYPE_WHITE), bits 1-0 = frequency<br>
+ * <b>0x40-0x7F</b>: wait (cmd &amp; 0x3F) + 1 frame(s)<br>
+ * <b>0x80 NN</b>: wait NN + 1 frame(s)<br>
+ * <b>0xFE</b>: loop to stream start<br>
+ * <b>0xFF</b>: end of stream (channel is silenced)<br>
+ *<br>
+ * A PSG channel also used by the XGM music will be overwritten by the music on next music PSG event so better to
+ * reserve channels for SFX (ex: channel 2 and noise channel).
+ */
+
+#ifndef _PSG_SFX_H_
+#define _PSG_SFX_H_
+
+
+#define PSGSFX_ENV          0x00
+#define PSGSFX_TONE         0x10
+#define PSGSFX_NOISE        0x20
+#define PSGSFX_WAIT         0x40
+#define PSGSFX_WAIT_LONG    0x80
+#define PSGSFX_LOOP         0xFE
+#define PSGSFX_END          0xFF
+
+
+/**
+ *  \brief
+ *      Start playing a PSG command stream on the given channel.
+ *
+ *  \param data
+ *      command stream (see format in unit description)
+ *  \param channel
+ *      PSG channel to use (0-3)
+ *  \param priority
+ *      stream priority, stream is started only if no stream or a stream of lower or equal priority is playing on the channel
+ *  \return FALSE if the stream wasn't started (channel busy with an higher priority stream)
+ */
+bool PSGSFX_play(const u8* data, u16 channel, u16 priority);
+/**
+ *  \brief
+ *      Stop the stream playing on the given channel and silence it.
+ */
+void PSGSFX_stop(u16 channel);
+/**
+ *  \brief
+ *      Stop all streams.
+ */
+void PSGSFX_stopAll(void);
+/**
+ *  \brief
+ *      Returns #TRUE if a stream is playing on the given channel.
+ */
+bool PSGSFX_isPlaying(u16 channel);
+
+
+#endif // _PSG_SFX_H_
@@ -0,0 +1,120 @@
+/**
+ *  \file raster.h
+ *  \brief Raster effect engine (mid frame color, VDP register and vertical scroll changes)
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit executes a per line table of CRAM writes, VDP register writes and vertical scroll (VSRAM) writes from
+ * H-Int so you can display more than 61 colors or change any VDP setting mid frame without writing your own
+ * H-Int handler.<br>
+ * The table is built from main loop (in any line order) and committed with #RASTER_commit(..), it is double buffered
+ * so the new table is only used from next frame (committed table stays active until next commit, table being built
+ * is kept so it can just be modified and committed again):<pre>
+ * RASTER_init(32);
+ * ...
+ * RASTER_clear();
+ * RASTER_addColor(112, 0, RGB24_TO_VDPCOLOR(0x2040A0));   // water background color
+ * RASTER_addColors(112, 16, water_pal.data, 3);
+ * RASTER_commit();</pre>
+ * H-Int is only triggered on lines having operations (H-Int counter is reprogrammed on each interrupt) plus 2 extra
+ * interrupts on top of screen, operations for line 0 are done during VBlank.<br>
+ * Operations of a line are done during the horizontal blank preceding it, there is only time for a few writes there
+ * so the number of operation per line is limited to RASTER_LINE_MAX_OP (extra writes would produce CRAM dots).<br>
+ * Note that raster engine owns the H-Int callback so it can't be used with DMA_setHIntFlush(..).
+ */
+
+#ifndef _RASTER_H_
+#define _RASTER_H_
+
+#include "vdp.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of operation for a single line (about what fit in horizontal blank)
+ */
+#define RASTER_LINE_MAX_OP      4
+
+
+/**
+ *  \brief
+ *      Initialize raster engine and enable it (H-Int callback is set on next VBlank).
+ *
+ *  \param maxOp
+ *      maximum number of operation in table
+ *  \return FALSE if there is not enough memory
+ */
+bool RASTER_init(u16 maxOp);
+/**
+ *  \brief
+ *      Disable raster engine and release its memory
+ */
+void RASTER_end(void);
+/**
+ *  \brief
+ *      Clear the table being built (active table isn't modified until #RASTER_commit(..))
+ */
+void RASTER_clear(void);
+/**
+ *  \brief
+ *      Add a CRAM write operation
+ *
+ *  \param line
+ *      line from which the new color is visible
+ *  \param index
+ *      color index (0-63)
+ *  \param value
+ *      color value
+ *  \return FALSE if table is full or line already has RASTER_LINE_MAX_OP operations
+ */
+bool RASTER_addColor(u16 line, u16 index, u16 value);
+/**
+ *  \brief
+ *      Add CRAM write operations for consecutive colors (one operation per color)
+ *
+ *  \param line
+ *      line from which the new colors are visible
+ *  \param index
+ *      first color index (0-63)
+ *  \param colors
+ *      color values
+ *  \param num
+ *      number of color
+ *  \return FALSE if not all colors could be added (see #RASTER_addColor(..))
+ */
+bool RASTER_addColors(u16 line, u16 index, const u16* colors, u16 num);
+/**
+ *  \brief
+ *      Add a VDP register write operation.<br>
+ *      Note that VDP register cache isn't updated (use it for temporary changes restored on a later line).
+ *
+ *  \param line
+ *      line from which the new register value is used
+ *  \param reg
+ *      VDP register index
+ *  \param value
+ *      register value
+ *  \return FALSE if table is full or line already has RASTER_LINE_MAX_OP operations
+ */
+bool RASTER_addRegister(u16 line, u16 reg, u8 value);
+/**
+ *  \brief
+ *      Add a vertical scroll (plane scroll mode) write operation
+ *
+ *  \param line
+ *      line from which the new scroll value is used
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param value
+ *      vertical scroll value
+ *  \return FALSE if table is full or line already has RASTER_LINE_MAX_OP operations
+ */
+bool RASTER_addVScroll(u16 line, VDPPlane plane, s16 value);
+/**
+ *  \brief
+ *      Commit table being built, it becomes the active table from next frame then a new table can be built.
+ */
+void RASTER_commit(void);
+
+
+#endif // _RASTER_H_
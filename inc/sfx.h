@@ -0,0 +1,125 @@
+/**
+ *  \file sfx.h
+ *  \brief Sound effect manager
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit handles PCM sound effects on top of the XGM or 4PCM driver so the game doesn't have to care about channels:<br>
+ * - a free channel is automatically picked from the channels reserved for SFX
+ * - when all channels are busy the lowest priority (then oldest) SFX is stolen if its priority isn't higher
+ * - requests of the same SFX in the same frame are coalesced and a per SFX cooldown (in frame) filters repeated requests
+ *<br>
+ * Channel usage is estimated from the sample length so no Z80 access is done to find a channel, and with the XGM driver
+ * the command queue is enabled (see #XGM_setCommandQueue(..)) so all SFX started in a frame cost a single Z80 bus request:<pre>
+ * SFX_init(Z80_DRIVER_XGM, SOUND_PCM_CH2, 3);
+ * const s16 jump = SFX_add(jump_sfx, sizeof(jump_sfx), 8, 0);
+ * const s16 coin = SFX_add(coin_sfx, sizeof(coin_sfx), 4, 6);
+ * ...
+ * SFX_play(coin);</pre>
+ */
+
+#ifndef _SFX_H_
+#define _SFX_H_
+
+
+/**
+ *  \brief
+ *      Maximum number of registered SFX
+ */
+#define SFX_MAX             32
+/**
+ *  \brief
+ *      First XGM sample id used for SFX (ids 64 to 255 are available for SFX)
+ */
+#define SFX_XGM_BASE_ID     64
+
+
+/**
+ *  \brief
+ *      Sound effect definition
+ *
+ *  \param sample
+ *      sample data (8 bits signed)
+ *  \param len
+ *      sample length (in byte)
+ *  \param duration
+ *      sample duration in frame (computed from driver playback rate)
+ *  \param priority
+ *      SFX priority (0 to 15, higher value mean higher priority)
+ *  \param cooldown
+ *      minimum number of frame between 2 starts of this SFX
+ *  \param lastFrame
+ *      frame (vtimer) where SFX was last started
+ */
+typedef struct
+{
+    const u8* sample;
+    u32 len;
+    u16 duration;
+    u16 priority;
+    u16 cooldown;
+    u32 lastFrame;
+} SfxDef;
+
+
+/**
+ *  \brief
+ *      Initialize the SFX manager and load the Z80 driver if needed.
+ *
+ *  \param driver
+ *      Z80 driver to use (#Z80_DRIVER_XGM or #Z80_DRIVER_4PCM)
+ *  \param firstChannel
+ *      first PCM channel reserved for SFX (#SOUND_PCM_CH1 to #SOUND_PCM_CH4), note that XGM music may use the first channel.
+ *  \param numChannel
+ *      number of PCM channel reserved for SFX
+ *  \return FALSE if driver or channel parameters are incorrect
+ */
+bool SFX_init(u16 driver, u16 firstChannel, u16 numChannel);
+/**
+ *  \brief
+ *      Register a sound effect.
+ *
+ *  \param sample
+ *      sample data, should be 256 bytes boundary aligned (SGDK automatically align sample resource as needed)
+ *  \param len
+ *      sample length (in byte), should be a multiple of 256
+ *  \param priority
+ *      SFX priority from 0 to 15 (higher value mean higher priority)
+ *  \param cooldown
+ *      minimum number of frame between 2 plays of this SFX (0 = only coalesce requests done in the same frame)
+ *  \return SFX id or -1 if too many SFX
+ */
+s16 SFX_add(const u8 *sample, u32 len, u16 priority, u16 cooldown);
+/**
+ *  \brief
+ *      Remove all registered SFX and stop them.
+ */
+void SFX_clear(void);
+/**
+ *  \brief
+ *      Play the given SFX.
+ *
+ *  \param id
+ *      SFX id (returned by #SFX_add(..))
+ *  \return channel used to play the SFX or -1 if the request was dropped (cooldown, already started this frame or no
+ *      channel available for this priority)
+ */
+s16 SFX_play(s16 id);
+/**
+ *  \brief
+ *      Stop all channels playing the given SFX.
+ */
+void SFX_stop(s16 id);
+/**
+ *  \brief
+ *      Stop all SFX.
+ */
+void SFX_stopAll(void);
+/**
+ *  \brief
+ *      Returns #TRUE if the given SFX is (estimated to be) playing.
+ */
+bool SFX_isPlaying(s16 id);
+
+
+#endif // _SFX_H_
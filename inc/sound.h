@@ -14,6 +14,7 @@
  * 2 channels 4 bits ADPCM sample driver.<br>
  * It can mix up to 2 ADCPM samples at a fixed 22050 Hz Khz rate.<br>
  * Address and size of samples have to be 256 bytes boundary.<br>
+ * Second channel can be disabled to free Z80 time (see SND_setNumChannel_2ADPCM(..) and SND_getCPULoad_2ADPCM()).<br>
  *<br>
  * <b>Z80_DRIVER_4PCM</b><br>
  * 4 channels 8 bits signed sample driver with volume support.<br>
@@ -21,6 +22,7 @@
  * with volume support (16 levels du to memory limitation).<br>
  * Address and size of samples have to be 256 bytes boundary.<br>
  * The driver does support "cutoff" when mixing so you can use true 8 bits samples :)<br>
+ * Upper channels can be disabled to free Z80 time (see SND_setNumChannel_4PCM(..) and SND_getCPULoad_4PCM()).<br>
  *<br>
  * <b>Z80_DRIVER_XGM</b><br>
  * eXtended VGM music player driver.<br>
@@ -227,6 +229,27 @@ void SND_startPlay_2ADPCM(const u8 *sample, const u32 len, const u16 channel, co
  *      #SOUND_PCM_CH2    = channel 2<br>
  */
 void SND_stopPlay_2ADPCM(const u16 channel);
+/**
+ *  \brief
+ *      Set the number of mixed channel (2 channels ADPCM player driver).<br>
+ *      Channel 2 is neither decoded nor mixed in single channel mode and its playback is paused until it's enabled again,
+ *      the Z80 time (and ROM accesses stealing 68000 bus time) saved this way is left free.
+ *
+ *  \param num
+ *      Number of mixed channel: 1 = channel 1 only, 2 (default) = both channels.
+ *  \see SND_getCPULoad_2ADPCM()
+ */
+void SND_setNumChannel_2ADPCM(const u16 num);
+/**
+ *  \brief
+ *      Returns the Z80 CPU load in % since last call (2 channels ADPCM player driver).<br>
+ *      The driver counts its free sample slots and its output buffers, this method reads and resets these counters so
+ *      it should be called regularly (each frame for instance) to get meaningful value.<br>
+ *      Returns 0 if the driver isn't loaded or no output buffer was done since last call.
+ *
+ *  \see SND_setNumChannel_2ADPCM()
+ */
+u16 SND_getCPULoad_2ADPCM(void);
 
 
 // Z80_DRIVER_4PCM
@@ -315,6 +338,27 @@ void SND_setVolume_4PCM(const u16 channel, const u8 volume);
  *      The returned value is comprised between 0 (quiet) to 15 (loud).
  */
 u8   SND_getVolume_4PCM(const u16 channel);
+/**
+ *  \brief
+ *      Set the number of mixed channel (4 channels PCM player driver).<br>
+ *      Channels above \a num are not mixed anymore and their playback is paused until they are enabled again, the Z80 time
+ *      (and ROM accesses stealing 68000 bus time) saved this way is left free.
+ *
+ *  \param num
+ *      Number of mixed channel from 1 (channel 1 only) to 4 (default, all channels).
+ *  \see SND_getCPULoad_4PCM()
+ */
+void SND_setNumChannel_4PCM(const u16 num);
+/**
+ *  \brief
+ *      Returns the Z80 CPU load in % since last call (4 channels PCM player driver).<br>
+ *      The driver counts its free sample slots and its output buffers, this method reads and resets these counters so
+ *      it should be called regularly (each frame for instance) to get meaningful value.<br>
+ *      Returns 0 if the driver isn't loaded or no output buffer was done since last call.
+ *
+ *  \see SND_setNumChannel_4PCM()
+ */
+u16  SND_getCPULoad_4PCM(void);
 
 
 // just to preserve backward compatibility
@@ -0,0 +1,143 @@
+/**
+ *  \file spr_text.h
+ *  \brief Sprite text overlay unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit draws text and numbers with raw hardware sprites of the sprite engine (see #SPR_reserveRawSprites(..)) so pause menus, damage
+ * numbers or timers can be displayed over scrolling planes without any tilemap write nor window plane usage.<br>
+ * <br>
+ * Font tiles are unpacked once in RAM (shared font tile cache) and each text character gets a slot in a reserved VRAM
+ * tile area: only characters which change are uploaded (1 tile DMA per character) and 4 characters are displayed by
+ * a single 4x1 sprite to save sprites per scanline.<br>
+ * Sprites are allocated with #SPR_allocateRawSprites(..) at text creation and are uploaded by SPR_update():<pre>
+ * SPR_init();
+ * SPR_reserveRawSprites(16);
+ * SPRTEXT_init(NULL, TILE_USER_INDEX + 256, 32);
+ * SprText* dmg = SPRTEXT_create(6, TILE_ATTR(PAL1, TRUE, FALSE, FALSE));
+ * SPRTEXT_setPosition(dmg, 120, 80);
+ * SPRTEXT_setUInt(dmg, 1250, 0);
+ * ...
+ * SPR_update();
+ * SYS_doVBlankProcess();</pre>
+ * Text sprites are linked in the hardware sprite list by the sprite engine (in front of sprite engine sprites).
+ */
+
+#ifndef _SPR_TEXT_H_
+#define _SPR_TEXT_H_
+
+#include "vdp_tile.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of 4 tiles block in the reserved VRAM tile area (1 block = 4 characters)
+ */
+#define SPRTEXT_MAX_BLOCK       64
+
+
+/**
+ *  \brief
+ *      Sprite text structure
+ *
+ *  \param maxLen
+ *      maximum text length (in character)
+ *  \param len
+ *      current text length
+ *  \param x
+ *      X position (in pixel)
+ *  \param y
+ *      Y position (in pixel)
+ *  \param attribut
+ *      sprite attributes (palette, priority, flip) without tile index
+ *  \param visible
+ *      text is visible
+ *  \param numSprite
+ *      number of allocated raw sprite (1 per 4 characters)
+ *  \param rawIndex
+ *      first raw sprite index (see #SPR_allocateRawSprites(..))
+ *  \param blocks
+ *      VRAM tile block of each sprite (internal)
+ *  \param text
+ *      current text (internal)
+ */
+typedef struct
+{
+    u16 maxLen;
+    u16 len;
+    s16 x;
+    s16 y;
+    u16 attribut;
+    bool visible;
+    u16 numSprite;
+    u16 rawIndex;
+    u8* blocks;
+    char* text;
+} SprText;
+
+
+/**
+ *  \brief
+ *      Initialize the sprite text unit: unpack the font in RAM and reserve the VRAM tile area used for characters.
+ *
+ *  \param font
+ *      font tileset (96 characters starting from ' '), NULL to use the default font
+ *  \param tileIndex
+ *      first tile of the VRAM area reserved for sprite text characters
+ *  \param numTile
+ *      number of tile in the VRAM area (1 per character, rounded down to a multiple of 4)
+ *  \return FALSE if there is not enough memory to unpack the font
+ */
+bool SPRTEXT_init(const TileSet* font, u16 tileIndex, u16 numTile);
+/**
+ *  \brief
+ *      Release the font cache (texts should be released first).
+ */
+void SPRTEXT_end(void);
+
+/**
+ *  \brief
+ *      Create a sprite text.
+ *
+ *  \param maxLen
+ *      maximum text length (in character)
+ *  \param attribut
+ *      sprite attributes (see TILE_ATTR(..) macro)
+ *  \return the sprite text (initially empty and visible at position 0,0) or NULL if there is not enough memory, raw
+ *      sprite or VRAM tile
+ */
+SprText* SPRTEXT_create(u16 maxLen, u16 attribut);
+/**
+ *  \brief
+ *      Release the given sprite text (raw sprites and VRAM tiles are released).
+ */
+void SPRTEXT_release(SprText* t);
+
+/**
+ *  \brief
+ *      Set the text (truncated to <i>maxLen</i>), only modified characters are uploaded to VRAM (DMA queue).
+ */
+void SPRTEXT_setText(SprText* t, const char* str);
+/**
+ *  \brief
+ *      Set the text from the given unsigned value (see #uintToStr(..)).
+ */
+void SPRTEXT_setUInt(SprText* t, u32 value, u16 minsize);
+/**
+ *  \brief
+ *      Set the text from the given signed value (see #intToStr(..)).
+ */
+void SPRTEXT_setInt(SprText* t, s32 value, u16 minsize);
+/**
+ *  \brief
+ *      Set the text position (in pixel, top left corner on screen).
+ */
+void SPRTEXT_setPosition(SprText* t, s16 x, s16 y);
+/**
+ *  \brief
+ *      Show or hide the text.
+ */
+void SPRTEXT_setVisible(SprText* t, bool value);
+
+
+#endif // _SPR_TEXT_H_
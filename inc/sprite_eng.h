@@ -16,6 +16,7 @@
 #include "vdp_spr.h"
 #include "pal.h"
 #include "pool.h"
+#include "maths.h"
 
 
 /**
@@ -92,6 +93,45 @@
  */
 #define SPR_MAX_DEPTH       0x7FFF
 
+/**
+ *  \brief
+ *      Sprite engine flag to enable deferred depth sorting (see #SPR_initWithFlags(..) method).<br>
+ *      When this flag is set, #SPR_setDepth(..) only stores the new depth value and mark the sprite list as unsorted,
+ *      the whole sprite list is then sorted at once (bucket / radix sort) on next #SPR_update() call.<br>
+ *      That is much faster than the default immediate sorting when many sprites change their depth on each frame.
+ */
+#define SPR_ENGINE_FLAG_DEFERRED_DEPTH_SORT     0x0001
+/**
+ *  \brief
+ *      Sprite engine flag to enable shared frame tiles (see #SPR_initWithFlags(..) method).<br>
+ *      When this flag is set, sprites using both automatic VRAM allocation and automatic tile upload don't reserve VRAM
+ *      for their biggest frame anymore: instead, VRAM is allocated per animation frame tileset and shared (reference counted)
+ *      between all sprites displaying the same frame, so tiles are uploaded only once for all of them.<br>
+ *      That can save a lot of VRAM and DMA bandwidth when many sprites use the same SpriteDefinition (enemies for instance)
+ *      but note that sprite VRAM tile index (<i>attribut</i> field) then changes on each frame change.
+ */
+#define SPR_ENGINE_FLAG_SHARED_FRAME_TILES      0x0002
+/**
+ *  \brief
+ *      Sprite engine flag to enable the flicker scheduler (see #SPR_initWithFlags(..) method).<br>
+ *      When this flag is set, #SPR_update() computes the per scanline sprite load (number of sprites and pixels) from the VDP sprite table
+ *      and when a scanline exceeds the VDP limits (20 sprites / 320 pixels in H40 mode, 16 sprites / 256 pixels in H32 mode) it rotates
+ *      the hardware sprite link order so overflow is spread over frames (flickering) instead of always hiding the same sprites.<br>
+ *      Note that sprite depth ordering is not respected anymore on frames where rotation happens.
+ *
+ *  \see SPR_getLineStats(..)
+ */
+#define SPR_ENGINE_FLAG_FLICKER_SCHEDULER       0x0004
+/**
+ *  \brief
+ *      Sprite engine flag to use best fit VRAM allocation (see #SPR_initWithFlags(..) method).<br>
+ *      Sprite tiles are allocated in the smallest free VRAM area large enough instead of the first one, that reduces
+ *      VRAM fragmentation when sprites with varied tile count are often added and released (see VRAM_POLICY_BEST_FIT).
+ *
+ *  \see SPR_getVRAMFragmentation()
+ */
+#define SPR_ENGINE_FLAG_VRAM_BEST_FIT           0x0008
+
 /**
  *  \brief
  *      Sprite visibility enumeration
@@ -179,6 +219,34 @@ typedef struct _collision
     } attack;
 } Collision;
 
+/**
+ *  \brief
+ *      Per pixel (1bpp) collision mask of an animation frame (see COL_testMasks(..)).
+ *
+ *  \param x
+ *      X position of the mask area (opaque pixels bounding box) in the frame cell
+ *  \param y
+ *      Y position of the mask area in the frame cell
+ *  \param w
+ *      width of the mask area
+ *  \param h
+ *      height of the mask area
+ *  \param numCol
+ *      number of 32 pixels wide column (w + 31) / 32
+ *  \param rows
+ *      mask rows for each flip variant (index = (vflip << 1) | hflip), NULL if the variant isn't available.<br>
+ *      Rows are stored by column (numCol * h u32), bit 31 is the leftmost pixel of the column.
+ */
+typedef struct
+{
+    u8 x;
+    u8 y;
+    u8 w;
+    u8 h;
+    u16 numCol;
+    const u32* rows[4];
+} CollisionMask;
+
 /**
  *  \brief
  *      Single VDP sprite info structure for sprite animation frame.
@@ -206,6 +274,24 @@ typedef struct
     u8 offsetXFlip;
 }  FrameVDPSprite;
 
+/**
+ *  \brief
+ *      Tiles delta of an animation frame against the previous frame of its animation (generated by rescomp -tiledelta).
+ *
+ *  \param from
+ *      tileset of the frame this delta applies to (tiles which should currently be in VRAM)
+ *  \param numRun
+ *      number of modified tiles run
+ *  \param runs
+ *      modified tiles runs (first tile index then number of tile for each run)
+ */
+typedef struct
+{
+    const TileSet* from;
+    u16 numRun;
+    u16 runs[];
+} TileDelta;
+
 /**
  *  \brief
  *      Sprite animation frame structure.
@@ -218,6 +304,23 @@ typedef struct
  *      tileset containing tiles for this animation frame (ordered for sprite)
  *  \param collision
  *      collision structure
+ *  \param tileDelta
+ *      modified tiles against previous frame (NULL if not available), when the previous frame tiles are still in VRAM
+ *      the Sprite Engine only uploads the modified tiles, otherwise the complete tileset is uploaded
+ *  \param mask
+ *      per pixel collision mask (NULL if not available, see MASK collision type in rescomp.txt)
+ *  \param boundsX
+ *      X offset of the frame bounding box (area covered by VDP sprites) relative to global Sprite position
+ *  \param boundsXFlip
+ *      X offset (H flip version) of the frame bounding box relative to global Sprite position
+ *  \param boundsY
+ *      Y offset of the frame bounding box relative to global Sprite position
+ *  \param boundsYFlip
+ *      Y offset (V flip version) of the frame bounding box relative to global Sprite position
+ *  \param boundsW
+ *      width of the frame bounding box
+ *  \param boundsH
+ *      height of the frame bounding box
  *  \param frameSprites
  *      array of VDP sprites info composing the frame
  */
@@ -227,9 +330,35 @@ typedef struct
     u8 timer;
     TileSet* tileset;                   // TODO: have a tileset per VDP sprite --> probably not a good idea performance wise
     Collision* collision;               // Require many DMA queue operations and fast DMA flush as well, also bring extra computing in calculating delayed update
+    const TileDelta* tileDelta;
+    const CollisionMask* mask;
+    u8 boundsX;
+    u8 boundsXFlip;
+    u8 boundsY;
+    u8 boundsYFlip;
+    u8 boundsW;
+    u8 boundsH;
     FrameVDPSprite frameVDPSprites[];
 } AnimationFrame;
 
+/**
+ *  \brief
+ *      Precomputed animation step (see rescomp -animsteps option).
+ *
+ *  \param frame
+ *      frame of this step
+ *  \param timer
+ *      frame duration (same as frame->timer)
+ *  \param next
+ *      index of next step (loop already resolved)
+ */
+typedef struct
+{
+    AnimationFrame* frame;
+    u8 timer;
+    u8 next;
+} AnimationStep;
+
 /**
  *  \brief
  *      Sprite animation structure.
@@ -240,14 +369,41 @@ typedef struct
  *      frame index for loop (last index if no loop)
  *  \param frames
  *      frames composing the animation
+ *  \param steps
+ *      contiguous (frame, duration, next index) table of the animation, NULL if not generated (see rescomp -animsteps option)
+ *  \param baseTileset
+ *      tiles common to all frames of the animation, uploaded once before frame tiles, NULL if none (see rescomp -basetiles option)
  */
 typedef struct
 {
     u8 numFrame;
     u8 loop;
     AnimationFrame** frames;
+    const AnimationStep* steps;
+    const TileSet* baseTileset;
 } Animation;
 
+/**
+ *  \brief
+ *      Animation clock: shared animation timing for many sprites playing the same animation together.
+ *
+ *  \param animation
+ *      animation driving the clock timing
+ *  \param frameInd
+ *      current frame index
+ *  \param timer
+ *      remaining time of current frame (0 = not animated)
+ *
+ *  The clock is advanced once per frame with #SPR_updateAnimationClock(..) and sprites attached to it with
+ *  #SPR_setAnimationClock(..) just follow its frame index instead of doing their own timing.
+ */
+typedef struct
+{
+    const Animation* animation;
+    u16 frameInd;
+    u16 timer;
+} AnimationClock;
+
 /**
  *  \brief
  *      Sprite definition structure.
@@ -266,8 +422,14 @@ typedef struct
  *      maximum number of tile used by a single animation frame (used for VRAM tile space allocation)
  *  \param maxNumSprite
  *      maximum number of VDP sprite used by a single animation frame (used for VDP sprite allocation)
+ *  \param numRotation
+ *      number of pre-rendered rotation steps per animation (1 = no rotation, see #SPR_setAngle(..))
+ *  \param numScale
+ *      number of pre-rendered scale steps per animation (1 = no scaling, see #SPR_setScaleStep(..))
  *
- *  Contains all animations for a Sprite and internal informations.
+ *  Contains all animations for a Sprite and internal informations.<br>
+ *  When rotation / scale variants are pre-rendered (SPRITE resource 'rotation' and 'scale' fields), animations are stored as
+ *  <i>(anim * numScale + scaleStep) * numRotation + rotationStep</i>.
  */
 typedef struct
 {
@@ -278,6 +440,8 @@ typedef struct
     Animation** animations;
     u16 maxNumTile;
     u16 maxNumSprite;
+    u8 numRotation;
+    u8 numScale;
 } SpriteDefinition;
 
 /**
@@ -297,12 +461,18 @@ typedef struct
  *      Animation pointer cache (internal)
  *  \param frame
  *      AnimationFrame pointer cache (internal)
+ *  \param lastTileset
+ *      tileset currently uploaded in VRAM for this sprite, used for tiles delta upload (internal)
+ *  \param lastBaseTileset
+ *      animation base tileset currently uploaded in VRAM for this sprite (internal)
  *  \param animInd
  *      current animation index (internal)
  *  \param frameInd
  *      current frame animation index (internal)
  *  \param timer
  *      timer for current frame (internal)
+ *  \param clock
+ *      animation clock the sprite follows, NULL if the sprite does its own animation timing (see #SPR_setAnimationClock(..))
  *  \param x
  *      current sprite X position on screen offseted by 0x80 (internal VDP position)
  *  \param y
@@ -314,6 +484,10 @@ typedef struct
  *  \param VDPSpriteIndex
  *      index of first allocated VDP sprite (0 when no yet allocated)<br>
  *      Number of allocated VDP sprite is defined by definition->maxNumSprite
+ *  \param VDPSpriteIndexMin
+ *      lowest index of allocated VDP sprites (used internally for partial sprite table upload)
+ *  \param VDPSpriteIndexMax
+ *      highest index of allocated VDP sprites (used internally for partial sprite table upload)
  *  \param lastVDPSprite
  *      Pointer to last VDP sprite used by this Sprite (used internally to update link between sprite)
  *  \param lastNumSprite
@@ -326,6 +500,8 @@ typedef struct
  *      pointer on previous Sprite in list
  *  \param next
  *      pointer on next Sprite in list
+ *  \param slot
+ *      sprite pool slot, index of the sprite hot flag (internal, only when ENABLE_SPR_HOT_SCAN is set)
  *
  *  Used to manage an active sprite in game condition.
  */
@@ -337,22 +513,57 @@ typedef struct Sprite
     void (*onFrameChange)(struct Sprite* sprite);
     Animation* animation;
     AnimationFrame* frame;
+    const TileSet* lastTileset;
+    const TileSet* lastBaseTileset;
     s16 animInd;
     s16 frameInd;
     u16 timer;
+    const AnimationClock* clock;
     s16 x;
     s16 y;
     s16 depth;
     u16 attribut;
     u16 VDPSpriteIndex;
+    u8 VDPSpriteIndexMin;
+    u8 VDPSpriteIndexMax;
     VDPSprite* lastVDPSprite;
     u16 lastNumSprite;
     s16 spriteToHide;
     u32 data;
     struct Sprite* prev;
     struct Sprite* next;
+#if (ENABLE_SPR_HOT_SCAN != 0)
+    u16 slot;
+#endif
 } Sprite;
 
+/**
+ *  \brief
+ *      Scanline sprite load statistics (see #SPR_ENGINE_FLAG_FLICKER_SCHEDULER).
+ *
+ *  \param overflowLines
+ *      number of scanlines exceeding VDP sprite limits on last #SPR_update() call
+ *  \param maxSprite
+ *      highest number of sprites on a single scanline on last #SPR_update() call
+ *  \param maxPixel
+ *      highest number of sprite pixels on a single scanline on last #SPR_update() call
+ *  \param maxLine
+ *      scanline having the highest number of sprites on last #SPR_update() call
+ *  \param overflowFrames
+ *      total number of #SPR_update() call where at least one scanline exceeded VDP sprite limits (since last #SPR_reset())
+ *  \param lineSprites
+ *      per scanline number of sprites (screenHeight entries) computed on last #SPR_update() call
+ */
+typedef struct
+{
+    u16 overflowLines;
+    u16 maxSprite;
+    u16 maxPixel;
+    u16 maxLine;
+    u16 overflowFrames;
+    const u8* lineSprites;
+} SpriteLineStats;
+
 /**
  *  \brief
  *      Sprite frame change event callback.<br>
@@ -388,7 +599,7 @@ extern u16 spriteVramSize;
  *  \brief
  *      Initialize the Sprite engine with default parameters.
  *
- *      Initialize the sprite engine using default parameters (420 reserved tiles in VRAM).<br>
+ *      Initialize the sprite engine using default parameters (420 reserved tiles in VRAM and no engine flag).<br>
  *      This also initialize the hardware sprite allocation system.
  *
  *  \see SPR_initEx(void)
@@ -397,19 +608,42 @@ extern u16 spriteVramSize;
 void SPR_init(void);
 /**
  *  \brief
- *      Init the Sprite engine with specified advanced parameters (VRAM allocation size and decompression buffer size).
+ *      Init the Sprite engine with specified advanced parameters (VRAM allocation size).
  *
  *  \param vramSize
  *      size (in tile) of the VRAM region for the automatic VRAM tile allocation.<br>
  *      If set to 0 the default size is used (420 tiles)
  *
- *      Initialize the sprite engine.<br>
+ *      Initialize the sprite engine (no engine flag, see #SPR_initWithFlags(..)).<br>
  *      This allocates a VRAM region for sprite tiles and initialize hardware sprite allocation system.
  *
  *  \see SPR_init(void)
  *  \see SPR_end(void)
  */
 void SPR_initEx(u16 vramSize);
+/**
+ *  \brief
+ *      Init the Sprite engine with specified advanced parameters (VRAM allocation size and engine flags).
+ *
+ *  \param vramSize
+ *      size (in tile) of the VRAM region for the automatic VRAM tile allocation.<br>
+ *      If set to 0 the default size is used (420 tiles)
+ *  \param flags
+ *      sprite engine settings:<br>
+ *      #SPR_ENGINE_FLAG_DEFERRED_DEPTH_SORT = sprite depth changes are not sorted immediately anymore,
+ *          instead the whole sprite list is sorted at once on #SPR_update() call (recommended when many sprites change depth every frame).<br>
+ *      #SPR_ENGINE_FLAG_SHARED_FRAME_TILES = sprites displaying the same animation frame share the same VRAM tiles
+ *          (only for sprites using #SPR_FLAG_AUTO_VRAM_ALLOC and #SPR_FLAG_AUTO_TILE_UPLOAD).<br>
+ *      #SPR_ENGINE_FLAG_FLICKER_SCHEDULER = rotate hardware sprite order when scanline sprite limit is exceeded (flickering instead of sprite loss).<br>
+ *      #SPR_ENGINE_FLAG_VRAM_BEST_FIT = use best fit allocation for sprite VRAM tiles (less fragmentation).<br>
+ *
+ *      Initialize the sprite engine.<br>
+ *      This allocates a VRAM region for sprite tiles and initialize hardware sprite allocation system.
+ *
+ *  \see SPR_initEx(..)
+ *  \see SPR_end(void)
+ */
+void SPR_initWithFlags(u16 vramSize, u16 flags);
 /**
  *  \brief
  *      End the Sprite engine.
@@ -601,6 +835,91 @@ u16 SPR_getNumActiveSprite(void);
  *      Defragment allocated VRAM for sprites, that can help when sprite allocation fail (SPR_addSprite(..) or SPR_addSpriteEx(..) return <i>NULL</i>).
  */
 void SPR_defragVRAM(void);
+/**
+ *  \brief
+ *      Set the maximum number of tile the incremental VRAM defragmenter can move on each #SPR_update() call.
+ *
+ *  \param value
+ *      maximum number of tile to move per frame (0 = disable incremental defragmentation, default).
+ *
+ *      Unlike SPR_defragVRAM(), the incremental defragmenter moves only a few sprite tile blocks per frame using VRAM to VRAM DMA copy
+ *      so the cost is spread over several frames. Only blocks fitting in the free area preceding them (and not larger than the budget) are moved,
+ *      SPR_defragVRAM() is still required to fully pack the sprite VRAM region.
+ *
+ *  \see SPR_defragVRAM()
+ *  \see SPR_setDefragVRAMThreshold(..)
+ */
+void SPR_setDefragVRAMBudget(u16 value);
+/**
+ *  \brief
+ *      Set the VRAM fragmentation level from which the incremental VRAM defragmenter is run on #SPR_update().
+ *
+ *  \param value
+ *      fragmentation level in percent (see #SPR_getVRAMFragmentation()), 0 = always run (default).
+ *
+ *  \see SPR_setDefragVRAMBudget(..)
+ */
+void SPR_setDefragVRAMThreshold(u16 value);
+/**
+ *  \brief
+ *      Returns the fragmentation level (in percent) of the sprite VRAM region (see VRAM_getFragmentation(..)).
+ */
+u16 SPR_getVRAMFragmentation(void);
+/**
+ *  \brief
+ *      Returns the number of free tile in the sprite VRAM region.
+ */
+u16 SPR_getFreeVRAM(void);
+/**
+ *  \brief
+ *      Set the per frame budget for sprite animation frame updates done in #SPR_update().
+ *
+ *  \param dmaSize
+ *      maximum number of bytes of sprite tile data to upload on each #SPR_update() call (0 = no limit, default).
+ *  \param cpuTime
+ *      maximum time (in subtick, see getSubTick()) spent in #SPR_update() before frame updates are delayed (0 = no limit, default).
+ *
+ *      When the budget is exhausted, remaining sprite frame updates are delayed to the next #SPR_update() call where they
+ *      will be processed first: visible sprites first then by depth (lowest depth first).<br>
+ *      It works the same way as the DMA capacity check done for delayed frame update so sprites with delayed frame update disabled
+ *      (see SPR_setDelayedFrameUpdate(..)) ignore the budget.
+ *
+ *  \see SPR_setDelayedFrameUpdate(..)
+ */
+void SPR_setUpdateBudget(u16 dmaSize, u16 cpuTime);
+/**
+ *  \brief
+ *      Enable animation frame prefetch for sprites using compressed tilesets.
+ *
+ *  \param numSlot
+ *      number of prefetch slot (number of frame which can be prefetched), 0 to disable prefetch (default).
+ *  \param slotSize
+ *      size of a slot (in tile), compressed frame tilesets larger than this can't be prefetched.
+ *  \return
+ *      FALSE if there is not enough memory to allocate prefetch slots, TRUE otherwise.
+ *
+ *      Each slot requires <i>slotSize * 32</i> bytes of memory.<br>
+ *      When enabled, SPR_prefetchFrames(..) unpacks the next animation frame of sprites in advance so the frame change
+ *      only requires a DMA transfer instead of a synchronous unpacking in #SPR_update().
+ *
+ *  \see SPR_prefetchFrames()
+ */
+bool SPR_setFramePrefetch(u16 numSlot, u16 slotSize);
+/**
+ *  \brief
+ *      Unpack the next animation frame tiles of animated sprites into free prefetch slots.
+ *
+ *  \return
+ *      the number of prefetched frame.
+ *
+ *      This method should be called in spare CPU time, typically after #SPR_update() and before SYS_doVBlankProcess(),
+ *      or from the user task (see TSK_userSet(..)) as long as sprites aren't modified while it's running.<br>
+ *      Only sprites using automatic tile upload are handled, visible sprites should be placed first in the sprite list
+ *      (lower depth) to get priority when there are not enough slots.
+ *
+ *  \see SPR_setFramePrefetch(..)
+ */
+u16 SPR_prefetchFrames(void);
 /**
  *  \brief
  *      Load all frames of SpriteDefinition (using DMA) at specified VRAM tile index and return the indexes table.<br>
@@ -668,6 +987,42 @@ s16 SPR_getPositionY(Sprite* sprite);
  *      Y position
  */
 void SPR_setPosition(Sprite* sprite, s16 x, s16 y);
+/**
+ *  \brief
+ *      Set position of several sprites at once.
+ *
+ *  \param sprites
+ *      Array of sprites to set position for
+ *  \param positions
+ *      Array of positions (positions[i] is used for sprites[i])
+ *  \param num
+ *      Number of sprite to set position for
+ *
+ *      Same as calling SPR_setPosition(..) on each sprite but faster as everything is done in a single loop.
+ *
+ *  \see SPR_setPosition(..)
+ *  \see SPR_setPositionsEx(..)
+ */
+void SPR_setPositions(Sprite** sprites, const Vect2D_s16* positions, u16 num);
+/**
+ *  \brief
+ *      Set position of several sprites at once, positions are read from an array of structures.
+ *
+ *  \param sprites
+ *      Array of sprites to set position for
+ *  \param positions
+ *      Pointer on the position of the first element, position should be stored as 2 consecutive s16 (X then Y)
+ *  \param stride
+ *      Size in bytes of a single element (offset from one position to the next one)
+ *  \param num
+ *      Number of sprite to set position for
+ *
+ *      Useful to update sprites directly from an entity array, ex: <i>SPR_setPositionsEx(sprites, &entities[0].x, sizeof(Entity), numEntity)</i>
+ *
+ *  \see SPR_setPosition(..)
+ *  \see SPR_setPositions(..)
+ */
+void SPR_setPositionsEx(Sprite** sprites, const s16* positions, u16 stride, u16 num);
 /**
  *  \brief
  *      Set sprite Horizontal Flip attribut.
@@ -723,7 +1078,8 @@ void SPR_setPriorityAttribut(Sprite* sprite, u16 value);
  *      The depth value (SPR_MIN_DEPTH to set always on top)
  *
  *  Sprite having lower depth are display in front of sprite with higher depth.<br>
- *  The sprite is *immediately* sorted when its depth value is changed.
+ *  The sprite is *immediately* sorted when its depth value is changed, except if the sprite engine
+ *  has been initialized with #SPR_ENGINE_FLAG_DEFERRED_DEPTH_SORT in which case sorting happen on next #SPR_update() call.
  */
 void SPR_setDepth(Sprite* sprite, s16 value);
 /**
@@ -776,6 +1132,74 @@ void SPR_setFrame(Sprite* sprite, s16 frame);
  */
 void SPR_nextFrame(Sprite* sprite);
 
+/**
+ *  \brief
+ *      Set the sprite rotation using the pre-rendered rotation variants of the sprite definition (SPRITE resource 'rotation'
+ *      field), current animation, frame and frame timer are preserved.
+ *
+ *  \param sprite
+ *      Sprite to set rotation for
+ *  \param angle
+ *      rotation angle in [0..1023] range (clockwise on screen, same unit as sinFix16(..) / fix16Atan2(..)), mapped to the
+ *      nearest pre-rendered rotation step.
+ */
+void SPR_setAngle(Sprite* sprite, u16 angle);
+/**
+ *  \brief
+ *      Set the sprite scale step using the pre-rendered scale variants of the sprite definition (SPRITE resource 'scale'
+ *      field), current animation, frame and frame timer are preserved.
+ *
+ *  \param sprite
+ *      Sprite to set scale for
+ *  \param step
+ *      scale step (0 = 100%, 1 = (numScale - 1) / numScale, ...)
+ */
+void SPR_setScaleStep(Sprite* sprite, u16 step);
+/**
+ *  \brief
+ *      Set current sprite animation (source animation index) keeping the current rotation and scale steps.<br>
+ *      Same as #SPR_setAnim(..) for sprite definition without pre-rendered rotation / scale variants.
+ *
+ *  \param sprite
+ *      Sprite to set animation for
+ *  \param anim
+ *      source animation index (animation row in the sprite image).
+ */
+void SPR_setBaseAnim(Sprite* sprite, s16 anim);
+
+/**
+ *  \brief
+ *      Initialize an animation clock on the given animation (start at frame 0).
+ *
+ *  \param clock
+ *      clock to initialize
+ *  \param animation
+ *      animation giving the clock frames timing
+ *
+ *  \see SPR_updateAnimationClock(..)
+ *  \see SPR_setAnimationClock(..)
+ */
+void SPR_initAnimationClock(AnimationClock* clock, const Animation* animation);
+/**
+ *  \brief
+ *      Advance the animation clock by one frame, call it once per frame before #SPR_update().
+ *
+ *  \param clock
+ *      clock to advance
+ */
+void SPR_updateAnimationClock(AnimationClock* clock);
+/**
+ *  \brief
+ *      Attach the sprite to an animation clock so it follows the clock frame index (no per sprite animation timing).
+ *
+ *  \param sprite
+ *      Sprite to attach
+ *  \param clock
+ *      animation clock to follow, NULL to go back to the sprite own animation timing.<br>
+ *      Sprite current animation should have at least as many frames as the clock animation (usually the same animation).
+ */
+void SPR_setAnimationClock(Sprite* sprite, const AnimationClock* clock);
+
 /**
  *  \brief
  *      Set the VRAM tile position reserved for this sprite.
@@ -856,8 +1280,8 @@ void SPR_setFrameChangeCallback(Sprite* sprite, FrameChangeCallback* callback);
  *      WARNING: this is different from SPR_isVisible(..) method, possible value are:<br>
  *      SpriteVisibility.VISIBLE        = sprite is visible<br>
  *      SpriteVisibility.HIDDEN         = sprite is not visible<br>
- *      SpriteVisibility.AUTO_FAST      = visibility is automatically computed - global visibility (only using sprite X position)<br>
- *      SpriteVisibility.AUTO_SLOW      = visibility is automatically computed - per hardware sprite visibility (only using sprite X position)<br>
+ *      SpriteVisibility.AUTO_FAST      = visibility is automatically computed - global visibility (using frame bounding box)<br>
+ *      SpriteVisibility.AUTO_SLOW      = visibility is automatically computed - per hardware sprite visibility (using frame bounding box then sprite X position)<br>
  *
  *  \param sprite
  *      Sprite to return <i>visibility</i> state
@@ -898,8 +1322,8 @@ bool SPR_isVisible(Sprite* sprite, bool recompute);
  *      Visibility value to set.<br>
  *      SpriteVisibility.VISIBLE        = sprite is visible<br>
  *      SpriteVisibility.HIDDEN         = sprite is not visible<br>
- *      SpriteVisibility.AUTO_FAST      = visibility is automatically computed - global visibility (only using sprite X position)<br>
- *      SpriteVisibility.AUTO_SLOW      = visibility is automatically computed - per hardware sprite visibility (only using sprite X position)<br>
+ *      SpriteVisibility.AUTO_FAST      = visibility is automatically computed - global visibility (using frame bounding box)<br>
+ *      SpriteVisibility.AUTO_SLOW      = visibility is automatically computed - per hardware sprite visibility (using frame bounding box then sprite X position)<br>
  *
  *      The only interest in having a sprite hidden / not visible is to avoid having it consuming scanline sprite budget:<br>
  *      The VDP is limited to a maximum of 20 sprites or 320 pixels of sprite per scanline (16 sprites/256 px in H32 mode).<br>
@@ -938,11 +1362,146 @@ void SPR_clear(void);
  *      Update and display the active list of sprite.
  *
  *  This actually updates all internal active sprites states and prepare the sprite list
- *  cache to send it to the hardware (VDP) at Vint.
+ *  cache to send it to the hardware (VDP) at Vint.<br>
+ *  Only the part of the VDP sprite table which has been modified since last update is sent to the VDP.
  *
  *  \see #SPR_addSprite(..)
  */
 void SPR_update(void);
+/**
+ *  \brief
+ *      Returns the time spent in the last #SPR_update() call (in sub tick, see getSubTick()).
+ */
+u16 SPR_getUpdateTime(void);
+/**
+ *  \brief
+ *      Insert a list of hardware sprites (not managed by the sprite engine) in front of the sprite engine list.
+ *
+ *  \param first
+ *      index of the first VDP sprite of the overlay list, -1 to remove the current overlay
+ *  \param last
+ *      index of the last VDP sprite of the overlay list (its link is managed by the sprite engine)
+ *
+ *      Overlay sprites are displayed above all sprite engine sprites (debug HUD, sprite text...), they should be
+ *      reserved with VDP_allocateSprites(..) and linked together from <i>first</i> to <i>last</i>.<br>
+ *      Overlay sprites are not part of the flicker scheduler scanline load and the overlay is removed by #SPR_reset().
+ *
+ *  \see VDP_allocateSprites(..)
+ */
+void SPR_setOverlaySprites(s16 first, s16 last);
+/**
+ *  \brief
+ *      Reserve hardware sprites for direct (raw) use alongside the sprite engine (particles, bullets, HUD...).
+ *
+ *  \param num
+ *      number of raw sprite to reserve (0 to release the current reservation)
+ *  \return FALSE if there is not enough free VDP sprite (previous reservation is released anyway)
+ *
+ *      Raw sprites are linked automatically between the overlay sprites (see #SPR_setOverlaySprites(..)) and the sprite
+ *      engine sprites, and they are uploaded with the sprite engine modified range on #SPR_update() so
+ *      VDP_updateSprites(..) should not be called.<br>
+ *      They are hidden on reservation, set them with #SPR_setRawSprite(..) / #SPR_setRawSpritePosition(..) using their
+ *      raw index (0 to num-1). Raw sprites are not part of the flicker scheduler scanline load and the reservation
+ *      is removed by #SPR_reset().<br>
+ *      Reserve them right after #SPR_init() so they get consecutive VDP sprite indexes (smaller upload range).
+ *
+ *  \see SPR_setNumLinkedRawSprite(..)
+ */
+bool SPR_reserveRawSprites(u16 num);
+/**
+ *  \brief
+ *      Returns the number of reserved raw sprite.
+ */
+u16 SPR_getNumRawSprite(void);
+/**
+ *  \brief
+ *      Set the number of raw sprite linked in the hardware sprite list (default is all reserved raw sprites).<br>
+ *      Unlinked raw sprites are not displayed and don't use VDP sprite / scanline capacity, so a particle system can
+ *      only link its active particles.
+ */
+void SPR_setNumLinkedRawSprite(u16 num);
+/**
+ *  \brief
+ *      Returns the VDP sprite index of the given raw sprite (-1 if out of range).<br>
+ *      If you modify vdpSpriteCache directly don't change the link field and call #SPR_setRawSpritesDirty(..).
+ */
+s16 SPR_getRawSpriteIndex(u16 ind);
+/**
+ *  \brief
+ *      Set a raw sprite (same as VDP_setSprite(..) but using the raw sprite index), it's uploaded on next #SPR_update().
+ *
+ *  \param ind
+ *      raw sprite index (0 to #SPR_getNumRawSprite() - 1)
+ *  \param x
+ *      screen X position
+ *  \param y
+ *      screen Y position
+ *  \param size
+ *      sprite size (see SPRITE_SIZE() macro)
+ *  \param attribut
+ *      sprite attributes (see TILE_ATTR_FULL() macro)
+ */
+void SPR_setRawSprite(u16 ind, s16 x, s16 y, u8 size, u16 attribut);
+/**
+ *  \brief
+ *      Set a raw sprite screen position, it's uploaded on next #SPR_update().
+ */
+void SPR_setRawSpritePosition(u16 ind, s16 x, s16 y);
+/**
+ *  \brief
+ *      Mark the given raw sprites as modified so they are uploaded on next #SPR_update().
+ *
+ *  \param ind
+ *      first raw sprite index
+ *  \param num
+ *      number of raw sprite
+ */
+void SPR_setRawSpritesDirty(u16 ind, u16 num);
+/**
+ *  \brief
+ *      Hide the given raw sprites (moved off screen), they are uploaded on next #SPR_update().
+ *
+ *  \param ind
+ *      first raw sprite index
+ *  \param num
+ *      number of raw sprite
+ */
+void SPR_hideRawSprites(u16 ind, u16 num);
+/**
+ *  \brief
+ *      Allocate a range of consecutive raw sprites from the current reservation (see #SPR_reserveRawSprites(..)) so
+ *      several units (particle.h, spr_text.h...) can share it.
+ *
+ *  \param num
+ *      number of raw sprite to allocate
+ *  \return first raw sprite index of the allocated range (hidden) or -1 if there is not enough free raw sprite.<br>
+ *      Allocations are lost when raw sprites are reserved again or on #SPR_reset().
+ *
+ *  \see SPR_releaseRawSprites(..)
+ */
+s16 SPR_allocateRawSprites(u16 num);
+/**
+ *  \brief
+ *      Release (and hide) a range of raw sprites previously allocated with #SPR_allocateRawSprites(..).
+ *
+ *  \param ind
+ *      first raw sprite index
+ *  \param num
+ *      number of raw sprite
+ */
+void SPR_releaseRawSprites(u16 ind, u16 num);
+
+/**
+ *  \brief
+ *      Get scanline sprite load statistics (only available if sprite engine was initialized with #SPR_ENGINE_FLAG_FLICKER_SCHEDULER).
+ *
+ *  \param stats
+ *      structure to fill with scanline statistics from last #SPR_update() call
+ *  \return FALSE if flicker scheduler is not enabled (stats are not filled), TRUE otherwise.
+ *
+ *  \see SPR_ENGINE_FLAG_FLICKER_SCHEDULER
+ */
+bool SPR_getLineStats(SpriteLineStats* stats);
 
 /**
  *  \brief
@@ -7,6 +7,16 @@
  * This unit provides methods to read from or write to SRAM.<br>
  * By default we suppose SRAM is 8bit and connected to odd address.<br>
  * You can change to even address by changing SRAM_BASE from 0x200001 to 0x200000 and rebuild the library.<br>
+ * Block transfers (SRAM_read(..) / SRAM_write(..)) should be preferred to byte / word / long accessors for large data.<br>
+ *<br>
+ * A save slot layer is also provided: each slot is stored twice in SRAM (double buffering) with a header containing a
+ * sequence number, the data length and a CRC-16. A new save always goes in the copy which doesn't hold the last valid save
+ * and its header is committed last so a save interrupted by a reset or power off never destroys the previous one:<pre>
+ * SRAM_setSlotLayout(0, sizeof(GameState));
+ * ...
+ * SRAM_writeSlot(0, &state, sizeof(GameState));
+ * ...
+ * if (SRAM_readSlot(0, &state, sizeof(GameState)) != sizeof(GameState)) initNewGame(&state);</pre>
  *<br>
  * Informations about SRAM (taken from Segaretro.org):<br>
  * The regions specified by 0xA130F9-0xA130FF (0x200000-0x3FFFFF) can be either ROM or RAM and can be write-protected.<br>
@@ -106,5 +116,80 @@ void SRAM_writeWord(u32 offset, u16 val);
  */
 void SRAM_writeLong(u32 offset, u32 val);
 
+/**
+ *  \brief
+ *      Read a block of data from the SRAM.
+ *
+ *  \param offset
+ *      Offset where we want to read.
+ *  \param dest
+ *      Destination buffer (faster if word aligned).
+ *  \param len
+ *      Number of byte to read.
+ */
+void SRAM_read(u32 offset, void* dest, u16 len);
+/**
+ *  \brief
+ *      Write a block of data to the SRAM.
+ *
+ *  \param offset
+ *      Offset where we want to write.
+ *  \param src
+ *      Source data (faster if word aligned).
+ *  \param len
+ *      Number of byte to write.
+ */
+void SRAM_write(u32 offset, const void* src, u16 len);
+
+/**
+ *  \brief
+ *      Set the save slot layout in SRAM.
+ *
+ *  \param offset
+ *      SRAM offset of the first slot.
+ *  \param dataSize
+ *      Maximum data size (in byte) of a slot.<br>
+ *      Each slot uses 2 * (dataSize + 8) bytes of SRAM (slot N starts at offset + (N * 2 * (dataSize + 8))), take care of not
+ *      overlapping the crash dump area if enabled (see CRASH_DUMP_SRAM_OFFSET in config.h).
+ */
+void SRAM_setSlotLayout(u32 offset, u16 dataSize);
+/**
+ *  \brief
+ *      Save data in the given slot (SRAM is enabled during the operation then disabled).
+ *
+ *  \param slot
+ *      Slot index.
+ *  \param data
+ *      Data to save.
+ *  \param len
+ *      Data size in byte (should be <= dataSize given to SRAM_setSlotLayout(..)).
+ *  \return FALSE if slot layout isn't set or data is too large.
+ */
+bool SRAM_writeSlot(u16 slot, const void* data, u16 len);
+/**
+ *  \brief
+ *      Load data from the given slot (SRAM is enabled during the operation then disabled).<br>
+ *      The newest valid copy is used, the previous save is automatically returned if the last one is corrupted.
+ *
+ *  \param slot
+ *      Slot index.
+ *  \param dest
+ *      Destination buffer.
+ *  \param maxLen
+ *      Size of destination buffer in byte.
+ *  \return size of loaded data, 0 if the slot doesn't contain any valid save.
+ */
+u16 SRAM_readSlot(u16 slot, void* dest, u16 maxLen);
+/**
+ *  \brief
+ *      Returns TRUE if the given slot contains a valid save (CRC is verified).
+ */
+bool SRAM_isSlotValid(u16 slot);
+/**
+ *  \brief
+ *      Erase the given slot (both copies).
+ */
+void SRAM_clearSlot(u16 slot);
+
 
 #endif // _SRAM_H_
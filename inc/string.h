@@ -209,6 +209,22 @@ u16 intToStr(s32 value, char *str, u16 minsize);
  * If resulting value is shorter than requested minsize the method prepends result with '0' character.
  */
 u16 uintToStr(u32 value, char *str, u16 minsize);
+/**
+ *  \brief
+ *      Convert a u16 value to string (faster than #uintToStr(..) as only 16 bit divisions are needed).
+ *
+ *  \param value
+ *      The u16 integer value to convert to string.
+ *  \param str
+ *      Destination string (it must be large enough to receive result).
+ *  \param minsize
+ *      Minimum size of resulting string.
+ *  \return string length
+ *
+ * Converts the specified u16 value to string (2 digits at once using a digit pair table).<br>
+ * If resulting value is shorter than requested minsize the method prepends result with '0' character.
+ */
+u16 uint16ToStr(u16 value, char *str, u16 minsize);
 /**
  *  \brief
  *      Convert a u32 value to hexadecimal string.
@@ -255,5 +271,109 @@ void fix32ToStr(fix32 value, char *str, u16 numdec);
  */
 void fix16ToStr(fix16 value, char *str, u16 numdec);
 
+/**
+ *  \brief
+ *      Copy <i>len</i> characters at <i>dst</i> and returns the end position (no null terminator).
+ */
+char* strPutMem(char *dst, const char *src, u16 len);
+/**
+ *  \brief
+ *      Copy <i>src</i> string (with null terminator) at <i>dst</i> and returns the end position (null terminator).
+ */
+char* strPutStr(char *dst, const char *src);
+/**
+ *  \brief
+ *      Same as #intToStr(..) but returns the end position of the string (null terminator).
+ */
+char* strPutInt(char *dst, s32 value, u16 minsize);
+/**
+ *  \brief
+ *      Same as #uintToStr(..) but returns the end position of the string (null terminator).
+ */
+char* strPutUInt(char *dst, u32 value, u16 minsize);
+/**
+ *  \brief
+ *      Same as #uint16ToStr(..) but returns the end position of the string (null terminator).
+ */
+char* strPutUInt16(char *dst, u16 value, u16 minsize);
+/**
+ *  \brief
+ *      Same as #intToHex(..) but returns the end position of the string (null terminator).
+ */
+char* strPutHex(char *dst, u32 value, u16 minsize);
+/**
+ *  \brief
+ *      Same as #fix16ToStr(..) but returns the end position of the string (null terminator).
+ */
+char* strPutFix16(char *dst, fix16 value, u16 numdec);
+/**
+ *  \brief
+ *      Same as #fix32ToStr(..) but returns the end position of the string (null terminator).
+ */
+char* strPutFix32(char *dst, fix32 value, u16 numdec);
+
+/**
+ *  \brief
+ *      Build a formatted string from a list of STRF_xxx items, resolved at compile time.
+ *
+ *  \param buf
+ *      Destination string (it must be large enough to receive result).
+ *  \param ...
+ *      Format items (#STRF_TEXT, #STRF_STR, #STRF_CHAR, #STRF_INT, #STRF_UINT, #STRF_U16, #STRF_HEX, #STRF_FIX16,
+ *      #STRF_FIX32)
+ *  \return string length
+ *
+ * Unlike #sprintf(..) there is no format string to parse at runtime: each item directly expands in the matching
+ * conversion call, which makes it much faster for strings updated every frame (HUD, debug info...):<pre>
+ * // same as sprintf(str, "SCORE %06lu x%d", score, mult)
+ * strformat(str, STRF_TEXT("SCORE "), STRF_UINT(score, 6), STRF_TEXT(" x"), STRF_U16(mult, 1));</pre>
+ */
+#define strformat(buf, ...)         ({ char* const _strfBuf = (buf); char* _strf = _strfBuf; __VA_ARGS__; *_strf = 0; (u16) (_strf - _strfBuf); })
+/**
+ *  \brief
+ *      #strformat(..) item: string literal (length is known at compile time)
+ */
+#define STRF_TEXT(lit)              (_strf = strPutMem(_strf, "" lit, sizeof(lit) - 1))
+/**
+ *  \brief
+ *      #strformat(..) item: null terminated string
+ */
+#define STRF_STR(s)                 (_strf = strPutStr(_strf, s))
+/**
+ *  \brief
+ *      #strformat(..) item: single character
+ */
+#define STRF_CHAR(c)                (*_strf++ = (c))
+/**
+ *  \brief
+ *      #strformat(..) item: s32 value (see #intToStr(..))
+ */
+#define STRF_INT(v, minsize)        (_strf = strPutInt(_strf, v, minsize))
+/**
+ *  \brief
+ *      #strformat(..) item: u32 value (see #uintToStr(..))
+ */
+#define STRF_UINT(v, minsize)       (_strf = strPutUInt(_strf, v, minsize))
+/**
+ *  \brief
+ *      #strformat(..) item: u16 value (see #uint16ToStr(..)), fastest decimal conversion
+ */
+#define STRF_U16(v, minsize)        (_strf = strPutUInt16(_strf, v, minsize))
+/**
+ *  \brief
+ *      #strformat(..) item: hexadecimal value (see #intToHex(..))
+ */
+#define STRF_HEX(v, minsize)        (_strf = strPutHex(_strf, v, minsize))
+/**
+ *  \brief
+ *      #strformat(..) item: fix16 value (see #fix16ToStr(..))
+ */
+#define STRF_FIX16(v, numdec)       (_strf = strPutFix16(_strf, v, numdec))
+/**
+ *  \brief
+ *      #strformat(..) item: fix32 value (see #fix32ToStr(..))
+ */
+#define STRF_FIX32(v, numdec)       (_strf = strPutFix32(_strf, v, numdec))
+
 #endif // _STRING_H_
 
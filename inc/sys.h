@@ -16,6 +16,48 @@
 #define PROCESS_DMA_TASK            (1 << 2)
 #define PROCESS_XGM_TASK            (1 << 3)
 #define PROCESS_VDP_SCROLL_TASK     (1 << 4)
+#define PROCESS_PALETTE_TASK        (1 << 5)
+#define PROCESS_PALETTE_FADE_CHANNEL (1 << 6)
+#define PROCESS_RASTER_TASK         (1 << 7)
+#define PROCESS_VDP_REG_TASK        (1 << 8)
+#define PROCESS_XGM_STREAM_TASK     (1 << 9)
+#define PROCESS_FRACTAL_TASK        (1 << 10)
+#define PROCESS_PSG_SFX_TASK        (1 << 11)
+
+
+#define CRASH_DUMP_MAGIC            0x53474344
+#define CRASH_DUMP_VERSION          1
+
+#define CRASH_BUS_ERROR             1
+#define CRASH_ADDRESS_ERROR         2
+#define CRASH_ILLEGAL_INST          3
+#define CRASH_ZERO_DIVIDE           4
+#define CRASH_CHK_INST              5
+#define CRASH_TRAPV_INST            6
+#define CRASH_PRIVILEGE_VIOLATION   7
+#define CRASH_ERROR_EXCEPTION       8
+#define CRASH_DIE                   9
+
+
+/**
+ *  \brief
+ *      Maximum number of registered V-Int or VBlank handlers (see #SYS_addVIntHandler(..))
+ */
+#define SYS_MAX_INT_HANDLER         8
+
+/**
+ *  \brief
+ *      Background checksum verification state (see #SYS_startChecksumCheck(..))
+ */
+#define CHECKSUM_CHECK_NONE         0
+#define CHECKSUM_CHECK_RUNNING      1
+#define CHECKSUM_CHECK_OK           2
+#define CHECKSUM_CHECK_FAILED       3
+/**
+ *  \brief
+ *      Maximum amount of ROM (in KB) verified per job by background checksum verification
+ */
+#define CHECKSUM_CHECK_MAX_KB       16
 
 
 #define ROM_ALIGN_BIT               17
@@ -30,6 +72,34 @@
 #define HINTERRUPT_CALLBACK         __attribute__ ((interrupt)) void
 
 
+/**
+ *  \brief
+ *      V-Int / VBlank handler information (times are in HV tick unit, see #getHVTick())
+ *
+ *  \param cb
+ *      handler callback
+ *  \param order
+ *      handler order (lower order handlers are called first)
+ *  \param budget
+ *      allowed time per call (0 = no budget)
+ *  \param time
+ *      time used on last call
+ *  \param maxTime
+ *      maximum time used for a single call
+ *  \param overrun
+ *      number of calls which exceeded the budget
+ */
+typedef struct
+{
+    VoidCallback* cb;
+    s16 order;
+    u16 budget;
+    u16 time;
+    u16 maxTime;
+    u16 overrun;
+} IntHandler;
+
+
 // exist through rom_head.c
 typedef struct
 {
@@ -332,6 +402,71 @@ void SYS_setVBlankCallback(VoidCallback *CB);
  * \see SYS_setHIntCallback(VoidCallback *CB);
  */
 void SYS_setVIntCallback(VoidCallback *CB);
+/**
+ *  \brief
+ *      Register a 'Vertical Interrupt' handler, several handlers can be registered (up to #SYS_MAX_INT_HANDLER).
+ *
+ *  \param CB
+ *      Pointer to the method to call on Vertical Interrupt.
+ *  \param order
+ *      Call order: handlers are called by ascending order (registration order for same order value), the callback
+ *      set with #SYS_setVIntCallback(..) is called just before the first handler with order >= 0.
+ *  \param budget
+ *      Allowed time (in HV tick unit, see #getHVTick()) for a call, calls above budget are counted in handler overrun field (0 = no budget).
+ *  \return FALSE if too many handlers are registered.
+ *
+ * Each handler call is timed so VBlank overruns can be attributed to the right handler (see #SYS_getVIntHandlers(..)).
+ *
+ * \see SYS_removeVIntHandler(VoidCallback *CB);
+ * \see SYS_addVBlankHandler(VoidCallback *CB, s16 order, u16 budget);
+ */
+bool SYS_addVIntHandler(VoidCallback *CB, s16 order, u16 budget);
+/**
+ *  \brief
+ *      Unregister a 'Vertical Interrupt' handler (registered with #SYS_addVIntHandler(..)).
+ *
+ *  \return FALSE if the handler wasn't found.
+ */
+bool SYS_removeVIntHandler(VoidCallback *CB);
+/**
+ *  \brief
+ *      Returns registered 'Vertical Interrupt' handlers (sorted by call order) and store their number in <i>num</i>.
+ */
+const IntHandler* SYS_getVIntHandlers(u16 *num);
+/**
+ *  \brief
+ *      Register a 'Vertical Blank' handler called from #SYS_doVBlankProcess(), several handlers can be registered (up to #SYS_MAX_INT_HANDLER).
+ *
+ *  \param CB
+ *      Pointer to the method to call on Vertical Blank period.
+ *  \param order
+ *      Call order: handlers are called by ascending order (registration order for same order value), the callback
+ *      set with #SYS_setVBlankCallback(..) is called just before the first handler with order >= 0.
+ *  \param budget
+ *      Allowed time (in HV tick unit, see #getHVTick()) for a call, calls above budget are counted in handler overrun field (0 = no budget).
+ *  \return FALSE if too many handlers are registered.
+ *
+ * \see SYS_removeVBlankHandler(VoidCallback *CB);
+ * \see SYS_addVIntHandler(VoidCallback *CB, s16 order, u16 budget);
+ */
+bool SYS_addVBlankHandler(VoidCallback *CB, s16 order, u16 budget);
+/**
+ *  \brief
+ *      Unregister a 'Vertical Blank' handler (registered with #SYS_addVBlankHandler(..)).
+ *
+ *  \return FALSE if the handler wasn't found.
+ */
+bool SYS_removeVBlankHandler(VoidCallback *CB);
+/**
+ *  \brief
+ *      Returns registered 'Vertical Blank' handlers (sorted by call order) and store their number in <i>num</i>.
+ */
+const IntHandler* SYS_getVBlankHandlers(u16 *num);
+/**
+ *  \brief
+ *      Reset time statistics (time, maxTime and overrun fields) of all V-Int and VBlank handlers.
+ */
+void SYS_resetHandlerStats(void);
 /**
  *  \brief
  *      Set 'Horizontal Interrupt' callback method (need to be prefixed by HINTERRUPT_CALLBACK).
@@ -413,6 +548,61 @@ fix32 SYS_getFPSAsFloat(void);
  * \see VDP_waitVInt(void)
  */
 u16 SYS_getCPULoad(void);
+/**
+ *  \brief
+ *      Returns the number of fixed timestep logic update to do before rendering the current frame (frame pacing).
+ *
+ * Returns the number of VBlank elapsed since the last call (capped to #SYS_setMaxLogicTick(..) value) so the game logic can
+ * run at constant 60/50 Hz speed even when a frame runs long: logic is updated several times and only the rendering
+ * (#SPR_update(), #MAP_scrollTo(..)...) is skipped for the missed frames.<br>
+ * Returns 0 if called twice in the same frame (VBlank process done with IMMEDIATELY) so logic never runs faster than the refresh rate.<pre>
+ * u16 n = SYS_getLogicTickCount();
+ * while(n--) updateGame();
+ * render();
+ * SYS_doVBlankProcess();</pre>
+ *
+ * \see SYS_resetLogicTick()
+ * \see SYS_getMissedFrameCount()
+ */
+u16 SYS_getLogicTickCount(void);
+/**
+ *  \brief
+ *      Reset logic tick count so next #SYS_getLogicTickCount() returns 1 (to call after a long operation as level loading).
+ */
+void SYS_resetLogicTick(void);
+/**
+ *  \brief
+ *      Set the maximum number of logic tick returned by #SYS_getLogicTickCount() (default = 4).<br>
+ *      Above this limit the game slows down instead of catching up (avoid spiral of death when logic itself is too slow).
+ */
+void SYS_setMaxLogicTick(u16 value);
+/**
+ *  \brief
+ *      Returns the number of missed (dropped) frames detected by #VDP_waitVSync() / #SYS_doVBlankProcess() since reset.
+ *
+ * \see SYS_resetMissedFrameCount()
+ */
+u32 SYS_getMissedFrameCount(void);
+/**
+ *  \brief
+ *      Reset the missed frame counter.
+ */
+void SYS_resetMissedFrameCount(void);
+/**
+ *  \brief
+ *      Returns the type of the crash dump saved in SRAM (CRASH_xxx value) or 0 if there is no valid crash dump.
+ *
+ * Crash dump is automatically saved on CPU exception (and #SYS_die(..)) when ENABLE_CRASH_DUMP is set in config.h,
+ * it's stored at CRASH_DUMP_SRAM_OFFSET and can be decoded with the crashdump tool from the SRAM (.srm) file.
+ *
+ * \see SYS_clearCrashDump()
+ */
+u16 SYS_hasCrashDump(void);
+/**
+ *  \brief
+ *      Invalidate the crash dump saved in SRAM.
+ */
+void SYS_clearCrashDump(void);
 /**
  *  \brief
  *      Show a cursor indicating current frame load level in scanline (top = 0% load, bottom = 100% load)
@@ -447,6 +637,26 @@ u16 SYS_computeChecksum(void);
  *      Returns TRUE if ROM checksum is ok (correspond to rom_head.checksum field)
  */
 bool SYS_isChecksumOk(void);
+/**
+ *  \brief
+ *      Start background ROM checksum verification so it doesn't delay boot.<br>
+ *      The ROM is verified by chunk of <i>kbPerJob</i> KB through the idle job queue (see job.h) so it only uses the time
+ *      spent waiting for VBlank, use #SYS_getChecksumCheckState() to get the result.
+ *
+ *  \param kbPerJob
+ *      amount of ROM (in KB, 1 to #CHECKSUM_CHECK_MAX_KB) verified per job (about 10 scanlines per KB)
+ *
+ *  \see SYS_getChecksumCheckState()
+ */
+void SYS_startChecksumCheck(u16 kbPerJob);
+/**
+ *  \brief
+ *      Returns background checksum verification state: #CHECKSUM_CHECK_NONE (not started), #CHECKSUM_CHECK_RUNNING,
+ *      #CHECKSUM_CHECK_OK or #CHECKSUM_CHECK_FAILED.
+ *
+ *  \see SYS_startChecksumCheck(..)
+ */
+u16 SYS_getChecksumCheckState(void);
 
 /**
  *  \brief
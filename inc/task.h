@@ -17,6 +17,12 @@
  * For the scheduler to work, VBlank interrupts must be enabled.
  *
  * These functions are implemented in task.s
+ *
+ * On top of it a cooperative scheduler (task_coop.c) can run several user tasks, each one with its own stack and
+ * priority: #TSK_initScheduler() installs the scheduler as the user task, tasks are added with #TSK_create(..) and
+ * give back the CPU with #TSK_yield() / #TSK_sleepFrames(..). The scheduler always runs the highest priority ready task
+ * (round robin for same priority) and returns to the supervisor task on V-Int as usual, so background work
+ * (decompression, streaming, path finding...) uses the idle time left by #SYS_doVBlankProcess() / #VDP_waitVSync().
  */
 
 #ifndef __TASK_H__
@@ -25,6 +31,24 @@
 #include "task_cst.h"
 
 
+/**
+ *  \brief
+ *      Maximum number of cooperative task
+ */
+#define TSK_MAX_TASK            8
+/**
+ *  \brief
+ *      Minimum stack size (in byte) for a cooperative task
+ */
+#define TSK_MIN_STACK_LENGTH    128
+
+/**
+ *  \brief
+ *      Cooperative task function, task ends when the function returns.
+ */
+typedef void TaskCallback(void* data);
+
+
 /**
  * \brief Configure the user task callback function.<br>
  *  Must be set with a not NULL callback before calling any TSK_xxx functions.
@@ -69,4 +93,59 @@ bool TSK_superPend(s16 wait);
  */
 void TSK_superPost(bool immediate);
 
+/**
+ * \brief Initialize the cooperative scheduler and set it as the user task
+ * (see #TSK_userSet(..)). All cooperative tasks are removed.
+ */
+void TSK_initScheduler(void);
+
+/**
+ * \brief Create a cooperative task.
+ *
+ * \param fn Task function.
+ * \param data Parameter passed to the task function.
+ * \param stackSize Task stack size in byte (dynamically allocated, minimum
+ *            is #TSK_MIN_STACK_LENGTH).
+ * \param priority Task priority, higher value means higher priority. A ready
+ *            task always runs before lower priority ones.
+ *
+ * \return Task id or -1 if no more task slot or not enough memory.
+ */
+s16 TSK_create(TaskCallback *fn, void* data, u16 stackSize, u16 priority);
+
+/**
+ * \brief Remove a cooperative task and release its stack. If the task is
+ * currently interrupted by V-Int it's considered dead right away (see #TSK_isAlive(..))
+ * but it keeps running until its next yield, its slot and stack are released then.
+ */
+void TSK_kill(s16 id);
+
+/**
+ * \brief End the current cooperative task (same as returning from task
+ * function). Must be called from a cooperative task.
+ */
+void TSK_exit(void);
+
+/**
+ * \brief Give the CPU back to the scheduler so another ready task can run.
+ * Must be called from a cooperative task.
+ */
+void TSK_yield(void);
+
+/**
+ * \brief Suspend the current cooperative task for the given number of frames
+ * (0 = simple yield). Must be called from a cooperative task.
+ */
+void TSK_sleepFrames(u16 frames);
+
+/**
+ * \brief Returns the id of the running cooperative task or -1 if none.
+ */
+s16 TSK_getCurrent(void);
+
+/**
+ * \brief Returns TRUE if the given cooperative task exists.
+ */
+bool TSK_isAlive(s16 id);
+
 #endif /*__TASK_H__*/
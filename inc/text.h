@@ -0,0 +1,182 @@
+/**
+ *  \file text.h
+ *  \brief Text layer unit (HUD / score display)
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * A text layer is a rectangle of a plane used to display text (HUD, score...).<br>
+ * It keeps a RAM shadow of the tilemap of the area so drawing methods only compare new text with current content and
+ * mark changed entries; #TEXT_update(..) then queues one DMA transfer per modified row (only the changed range).<br>
+ * Redrawing the same text or value every frame is then almost free:<pre>
+ * TextLayer* hud = TEXT_create(WINDOW, TILE_ATTR(PAL0, TRUE, FALSE, FALSE), 0, 0, 40, 2);
+ * ...
+ * while(TRUE)
+ * {
+ *     TEXT_drawUInt(hud, score, 6, 0, 8);
+ *     TEXT_update(hud);
+ *     SYS_doVBlankProcess();
+ * }</pre>
+ */
+
+#ifndef _TEXT_H_
+#define _TEXT_H_
+
+#include "vdp_tile.h"
+
+
+/**
+ *  \brief
+ *      Text layer structure
+ *
+ *  \param plane
+ *      plane where the text layer is displayed (BG_A, BG_B or WINDOW)
+ *  \param basetile
+ *      base tile attributes (palette, priority) for text, see TILE_ATTR() macro
+ *  \param x
+ *      X position (in tile) of the text layer in the plane
+ *  \param y
+ *      Y position (in tile) of the text layer in the plane
+ *  \param w
+ *      width (in tile) of the text layer
+ *  \param h
+ *      height (in tile) of the text layer
+ *  \param shadow
+ *      internal - RAM copy of the tilemap of the text layer (w * h entries)
+ *  \param dirtyLo
+ *      internal - first modified column of each row (w if row isn't modified)
+ *  \param dirtyHi
+ *      internal - last modified column (exclusive) of each row
+ */
+typedef struct
+{
+    VDPPlane plane;
+    u16 basetile;
+    u16 x;
+    u16 y;
+    u16 w;
+    u16 h;
+    u16* shadow;
+    u8* dirtyLo;
+    u8* dirtyHi;
+} TextLayer;
+
+
+/**
+ *  \brief
+ *      Create a text layer.<br>
+ *      Shadow is initialized as cleared (see #TEXT_clear(..)) but plane isn't modified until first #TEXT_update(..) call.
+ *
+ *  \param plane
+ *      plane where to display text (BG_A, BG_B or WINDOW)
+ *  \param basetile
+ *      base tile attributes (palette, priority) for text, see TILE_ATTR() macro
+ *  \param x
+ *      X position (in tile) of the text layer in the plane
+ *  \param y
+ *      Y position (in tile) of the text layer in the plane
+ *  \param w
+ *      width (in tile) of the text layer (max 255)
+ *  \param h
+ *      height (in tile) of the text layer
+ *  \return the new text layer or NULL if there is not enough memory
+ */
+TextLayer* TEXT_create(VDPPlane plane, u16 basetile, u16 x, u16 y, u16 w, u16 h);
+/**
+ *  \brief
+ *      Release a text layer (use MEM_free(..) internally)
+ */
+void TEXT_release(TextLayer* layer);
+/**
+ *  \brief
+ *      Clear the whole text layer (plane is updated on next #TEXT_update(..) call)
+ */
+void TEXT_clear(TextLayer* layer);
+/**
+ *  \brief
+ *      Clear part of a text row
+ *
+ *  \param layer
+ *      text layer
+ *  \param x
+ *      X position (in tile) inside the text layer
+ *  \param y
+ *      Y position (in tile) inside the text layer
+ *  \param w
+ *      number of tile to clear
+ */
+void TEXT_clearText(TextLayer* layer, u16 x, u16 y, u16 w);
+/**
+ *  \brief
+ *      Draw text in the text layer (text is clipped to layer width).<br>
+ *      Only characters which differ from current content are marked for update.
+ *
+ *  \param layer
+ *      text layer
+ *  \param str
+ *      string to draw
+ *  \param x
+ *      X position (in tile) inside the text layer
+ *  \param y
+ *      Y position (in tile) inside the text layer
+ */
+void TEXT_drawText(TextLayer* layer, const char* str, u16 x, u16 y);
+/**
+ *  \brief
+ *      Set raw tilemap entries in the text layer (custom tiles, gauges...), entries are used as is (layer base
+ *      attributes aren't added).<br>
+ *      Only entries which differ from current content are marked for update.
+ *
+ *  \param layer
+ *      text layer
+ *  \param data
+ *      tilemap entries
+ *  \param x
+ *      X position (in tile) inside the text layer
+ *  \param y
+ *      Y position (in tile) inside the text layer
+ *  \param len
+ *      number of entry (clipped to layer width)
+ */
+void TEXT_setTiles(TextLayer* layer, const u16* data, u16 x, u16 y, u16 len);
+/**
+ *  \brief
+ *      Draw an unsigned integer value in the text layer without intermediate string conversion.
+ *
+ *  \param layer
+ *      text layer
+ *  \param value
+ *      value to draw
+ *  \param x
+ *      X position (in tile) inside the text layer
+ *  \param y
+ *      Y position (in tile) inside the text layer
+ *  \param minsize
+ *      minimum number of digit (padded with '0')
+ */
+void TEXT_drawUInt(TextLayer* layer, u32 value, u16 x, u16 y, u16 minsize);
+/**
+ *  \brief
+ *      Draw a signed integer value in the text layer without intermediate string conversion.
+ *
+ *  \param layer
+ *      text layer
+ *  \param value
+ *      value to draw
+ *  \param x
+ *      X position (in tile) inside the text layer
+ *  \param y
+ *      Y position (in tile) inside the text layer
+ *  \param minsize
+ *      minimum number of digit (padded with '0', sign excluded)
+ */
+void TEXT_drawInt(TextLayer* layer, s32 value, u16 x, u16 y, u16 minsize);
+/**
+ *  \brief
+ *      Queue (DMA queue) modified entries of the text layer, one transfer per modified row.
+ *
+ *  \return number of row transfer queued
+ */
+u16 TEXT_update(TextLayer* layer);
+
+
+#endif // _TEXT_H_
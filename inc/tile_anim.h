@@ -0,0 +1,131 @@
+/**
+ *  \file tile_anim.h
+ *  \brief Animated tiles unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides animated background tiles (water, conveyor belts...) by swapping tile data in VRAM.<br>
+ * <br>
+ * An animation uses a TileSet containing all frames (frame <i>n</i> starts at tile <i>n * frameTiles</i>) and a fixed
+ * VRAM tile range, so tilemaps referencing these tiles don't need any update.<br>
+ * #TILEANIM_update(..) should be called once per frame, it only queues (DMA) the tile data of animations changing frame
+ * and respects a per frame transfer budget so frame cost stays predictable (late animations are delayed to next frame):<pre>
+ * TileAnimation* water = TILEANIM_create(&water_anim_tileset, waterTileIndex, 8, 6, NULL);
+ * TILEANIM_add(water);
+ * ...
+ * while(TRUE)
+ * {
+ *     TILEANIM_update();
+ *     SYS_doVBlankProcess();
+ * }</pre>
+ */
+
+#ifndef _TILE_ANIM_H_
+#define _TILE_ANIM_H_
+
+#include "vdp_tile.h"
+
+
+/**
+ *  \brief
+ *      Maximum number of simultaneously playing tile animation
+ */
+#define TILEANIM_MAX        16
+
+
+/**
+ *  \brief
+ *      Tile animation structure
+ *
+ *  \param frames
+ *      TileSet containing all animation frames (uncompressed)
+ *  \param vramIndex
+ *      VRAM tile index where animation tiles are uploaded
+ *  \param frameTiles
+ *      number of tile per frame
+ *  \param numFrame
+ *      number of frame
+ *  \param frameDelay
+ *      default frame duration (in frame)
+ *  \param timings
+ *      optional per frame duration table (<i>numFrame</i> entries), NULL to use <i>frameDelay</i> for all frames
+ *  \param frame
+ *      current frame
+ *  \param timer
+ *      remaining duration (in frame) of current frame, 0 means frame upload is pending
+ *  \param allocated
+ *      frames TileSet has been unpacked (internal, released with #TILEANIM_release(..))
+ */
+typedef struct
+{
+    const TileSet* frames;
+    u16 vramIndex;
+    u16 frameTiles;
+    u16 numFrame;
+    u16 frameDelay;
+    const u8* timings;
+    u16 frame;
+    u16 timer;
+    bool allocated;
+} TileAnimation;
+
+
+/**
+ *  \brief
+ *      Create a tile animation.<br>
+ *      First frame is uploaded on next #TILEANIM_update(..) call once animation has been added.
+ *
+ *  \param frames
+ *      TileSet containing all frames (unpacked in RAM if compressed)
+ *  \param vramIndex
+ *      VRAM tile index where animation tiles are uploaded
+ *  \param frameTiles
+ *      number of tile per frame (frames->numTile / frameTiles gives the number of frame)
+ *  \param frameDelay
+ *      frame duration (in frame)
+ *  \param timings
+ *      optional per frame duration table, NULL to use <i>frameDelay</i> for all frames
+ *  \return the new animation or NULL if there is not enough memory
+ */
+TileAnimation* TILEANIM_create(const TileSet* frames, u16 vramIndex, u16 frameTiles, u16 frameDelay, const u8* timings);
+/**
+ *  \brief
+ *      Release a tile animation (removed from playing animations if needed)
+ */
+void TILEANIM_release(TileAnimation* anim);
+/**
+ *  \brief
+ *      Add the animation to playing animations
+ *
+ *  \return FALSE if too many animations are already playing (see TILEANIM_MAX)
+ */
+bool TILEANIM_add(TileAnimation* anim);
+/**
+ *  \brief
+ *      Remove the animation from playing animations (current frame stays in VRAM)
+ */
+void TILEANIM_remove(TileAnimation* anim);
+/**
+ *  \brief
+ *      Remove all playing animations
+ */
+void TILEANIM_clear(void);
+/**
+ *  \brief
+ *      Set maximum transfer size (in bytes) used by tile animations per frame.
+ *
+ *  \param value
+ *      maximum transfer size in bytes, 0 (default) means use the remaining DMA capacity of the frame (see DMA_getRemainingCapacity())
+ */
+void TILEANIM_setBudget(u16 value);
+/**
+ *  \brief
+ *      Update playing animations and queue tile upload (DMA queue) for animations changing frame.<br>
+ *      Animations not fitting in the frame budget are delayed to next frame (starting from them).
+ *
+ *  \return number of animation frame uploaded
+ */
+u16 TILEANIM_update(void);
+
+
+#endif // _TILE_ANIM_H_
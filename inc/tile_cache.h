@@ -0,0 +1,125 @@
+/**
+ *  \file tile_cache.h
+ *  \brief VRAM tile cache (tile streaming) unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit allows to use a TileSet larger than the available VRAM by mapping its tiles (logical tile ids) to a fixed
+ * range of VRAM tile slots.<br>
+ * Tiles are uploaded on demand through the DMA queue and the least recently referenced tile is evicted when the cache
+ * is full, so the cache should be large enough to hold all tiles visible on screen plus some margin (tiles leaving the
+ * screen are then the ones evicted first).<br>
+ * When attached to a Map (see #MAP_setTileCache(..)) the map engine remaps all tilemap data it prepares
+ * (tile index of map data is then used as logical tile id into the cache TileSet).<br>
+ * Note that each tile upload uses a DMA queue entry (contiguous uploads are merged) so you may need to increase the DMA
+ * queue size (see DMA_setMaxQueueSize(..)).
+ */
+
+#ifndef _TILE_CACHE_H_
+#define _TILE_CACHE_H_
+
+#include "vdp_tile.h"
+
+
+/**
+ *  \brief
+ *      Tile cache structure
+ *
+ *  \param tiles
+ *      tile data of the cached TileSet (uncompressed)
+ *  \param numTile
+ *      number of tile (logical tile id) in the cached TileSet
+ *  \param vramIndex
+ *      first VRAM tile index used by the cache
+ *  \param numSlot
+ *      number of VRAM tile slot
+ *  \param slots
+ *      internal - VRAM slot of each logical tile (0xFFFF if not in VRAM)
+ *  \param ids
+ *      internal - logical tile id of each slot (0xFFFF if free)
+ *  \param prev
+ *      internal - LRU list (previous = more recently used slot)
+ *  \param next
+ *      internal - LRU list (next = less recently used slot)
+ *  \param stamps
+ *      internal - frame of last reference of each slot
+ *  \param head
+ *      internal - most recently used slot
+ *  \param tail
+ *      internal - least recently used slot (next victim)
+ *  \param hits
+ *      number of tile reference found in cache
+ *  \param misses
+ *      number of tile upload
+ *  \param overflows
+ *      number of tile evicted while referenced in current frame (cache too small, can produce visual glitches)
+ */
+typedef struct
+{
+    u32* tiles;
+    u16 numTile;
+    u16 vramIndex;
+    u16 numSlot;
+    u16* slots;
+    u16* ids;
+    u16* prev;
+    u16* next;
+    u16* stamps;
+    u16 head;
+    u16 tail;
+    u32 hits;
+    u32 misses;
+    u32 overflows;
+} TileCache;
+
+
+/**
+ *  \brief
+ *      Create a tile cache for the given TileSet.
+ *
+ *  \param tileset
+ *      TileSet to stream (should be uncompressed as tiles are transferred directly from ROM)
+ *  \param vramIndex
+ *      first VRAM tile index used by the cache
+ *  \param numSlot
+ *      number of VRAM tile slot used by the cache
+ *  \return the new tile cache or NULL if there is not enough memory (or TileSet is compressed)
+ */
+TileCache* TILECACHE_create(const TileSet* tileset, u16 vramIndex, u16 numSlot);
+/**
+ *  \brief
+ *      Release a tile cache (use MEM_free(..) internally)
+ */
+void TILECACHE_release(TileCache* cache);
+/**
+ *  \brief
+ *      Invalidate all cache slots (VRAM content is considered lost, ex: after VDP_clearPlane or tile loading over the cache area)
+ */
+void TILECACHE_clear(TileCache* cache);
+/**
+ *  \brief
+ *      Returns VRAM tile index for the given logical tile id, tile is uploaded (DMA queue) if not already in VRAM.
+ *
+ *  \param cache
+ *      tile cache
+ *  \param id
+ *      logical tile id (tile index in cached TileSet)
+ *  \return VRAM tile index
+ */
+u16 TILECACHE_get(TileCache* cache, u16 id);
+/**
+ *  \brief
+ *      Remap tilemap entries (in place): tile index of each entry is a logical tile id and is replaced by its VRAM tile index
+ *      (attributes are preserved), tiles are uploaded on demand.
+ *
+ *  \param cache
+ *      tile cache
+ *  \param tilemap
+ *      tilemap entries to remap
+ *  \param num
+ *      number of entry
+ */
+void TILECACHE_remapTilemap(TileCache* cache, u16* tilemap, u16 num);
+
+
+#endif // _TILE_CACHE_H_
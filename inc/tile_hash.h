@@ -0,0 +1,101 @@
+/**
+ *  \file tile_hash.h
+ *  \brief Runtime tile deduplication unit
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit provides a tile dictionary for graphics assembled at runtime (procedural maps, composited portraits...).<br>
+ * Each submitted tile (32 bytes) is hashed and compared with tiles already in the dictionary, including their H, V and
+ * HV flipped variants: an existing tile is reused (returned tilemap entry gets the needed flip attributes) and only new
+ * tiles are allocated in VRAM and uploaded (DMA queue), so duplicated tiles cost neither VRAM nor DMA bandwidth.<br>
+ * A RAM copy of each unique tile is kept for exact comparison (32 bytes per tile).
+ */
+
+#ifndef _TILE_HASH_H_
+#define _TILE_HASH_H_
+
+#include "vdp_tile.h"
+
+
+/**
+ *  \brief
+ *      Tile dictionary structure
+ *
+ *  \param vramIndex
+ *      first VRAM tile index used to allocate unique tiles
+ *  \param maxTile
+ *      maximum number of unique tile
+ *  \param numTile
+ *      current number of unique tile
+ *  \param mask
+ *      internal - hash table size - 1
+ *  \param table
+ *      internal - hash table (tile entry + 1, 0 = empty)
+ *  \param hashes
+ *      internal - hash of each unique tile
+ *  \param tiles
+ *      internal - RAM copy of each unique tile
+ */
+typedef struct
+{
+    u16 vramIndex;
+    u16 maxTile;
+    u16 numTile;
+    u16 mask;
+    u16* table;
+    u32* hashes;
+    u32* tiles;
+} TileHash;
+
+
+/**
+ *  \brief
+ *      Create a tile dictionary.
+ *
+ *  \param vramIndex
+ *      first VRAM tile index used to allocate unique tiles
+ *  \param maxTile
+ *      maximum number of unique tile (VRAM tiles from vramIndex to vramIndex + maxTile - 1 are used)
+ *  \return the new tile dictionary or NULL if there is not enough memory
+ */
+TileHash* TILEHASH_create(u16 vramIndex, u16 maxTile);
+/**
+ *  \brief
+ *      Release a tile dictionary (use MEM_free(..) internally)
+ */
+void TILEHASH_release(TileHash* hash);
+/**
+ *  \brief
+ *      Remove all tiles from dictionary (VRAM tiles can then be reused)
+ */
+void TILEHASH_clear(TileHash* hash);
+/**
+ *  \brief
+ *      Returns tilemap entry (VRAM tile index + flip attributes) for the given tile.<br>
+ *      If the tile (or one of its flipped variants) isn't found it is added and uploaded to VRAM (DMA queue).
+ *
+ *  \param hash
+ *      tile dictionary
+ *  \param tile
+ *      tile data (8 x u32)
+ *  \return tilemap entry (tile index and H/V flip attributes) or 0xFFFF if dictionary is full
+ */
+u16 TILEHASH_getTile(TileHash* hash, const u32* tile);
+/**
+ *  \brief
+ *      Same as #TILEHASH_getTile(..) for several tiles, tilemap entries are written in <i>dest</i>.
+ *
+ *  \param hash
+ *      tile dictionary
+ *  \param tiles
+ *      tiles data (num * 8 x u32)
+ *  \param num
+ *      number of tile
+ *  \param dest
+ *      destination tilemap entries (num entries), base attributes (palette, priority) can be added afterward
+ *  \return number of tile successfully processed (less than num if dictionary is full)
+ */
+u16 TILEHASH_getTiles(TileHash* hash, const u32* tiles, u16 num, u16* dest);
+
+
+#endif // _TILE_HASH_H_
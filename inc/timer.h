@@ -46,6 +46,25 @@ extern vu32 vtimer;
  * This is to avoid issue with the VCounter rollback during VBlank.
  */
 u32  getSubTick(void);
+/**
+ *  \brief
+ *      Returns elapsed HV ticks from console reset (high resolution monotonic clock).
+ *
+ * Combines vtimer with V and H counters (taking care of their jumps on NTSC / PAL, V28 / V30 and H32 / H40 modes) to
+ * give a cycle approximate clock useful to measure routines shorter than a scanline.<br>
+ * One HV tick is the H counter unit (2 pixels): #getHVTickPerLine() ticks per scanline (488 68000 cycles) so about 2.3
+ * cycles in H40 mode and 2.85 cycles in H32 mode.<br>
+ * Counter wraps after about 20 minutes, always use the difference between 2 values.<br>
+ * Note that changing video mode between 2 calls gives meaningless difference.
+ */
+u32  getHVTick(void);
+/**
+ *  \brief
+ *      Returns number of HV ticks per scanline for current video mode (211 in H40 mode, 171 in H32 mode).
+ *
+ * \see getHVTick()
+ */
+u16  getHVTickPerLine(void);
 /**
  *  \brief
  *      Returns elapsed ticks from console reset.
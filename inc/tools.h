@@ -31,6 +31,16 @@
  *      Use LZ4W compression scheme.
  */
 #define COMPRESSION_LZ4W        2
+/**
+ *  \brief
+ *      Use DLZ (delta LZ) compression scheme, word based LZ with delta / RLE runs designed for tiles and tilemaps.
+ */
+#define COMPRESSION_DLZ         3
+/**
+ *  \brief
+ *      Use byte RLE compression scheme (low ratio but very simple, can also be unpacked by the Z80, see z80_job.h).
+ */
+#define COMPRESSION_RLE         4
 
 
 /**
@@ -135,6 +145,15 @@ void KLog_F2x(s16 numDec, char* t1, fix32 v1, char* t2, fix32 v2);
 void KLog_F3x(s16 numDec, char* t1, fix32 v1, char* t2, fix32 v2, char* t3, fix32 v3);
 void KLog_F4x(s16 numDec, char* t1, fix32 v1, char* t2, fix32 v2, char* t3, fix32 v3, char* t4, fix32 v4);
 
+/**
+ *  \brief
+ *      Format and send to the debug port all buffered KLog_xxx(..) records (when ENABLE_KLOG_BUFFER is set).
+ *
+ *  Automatically called by SYS_doVBlankProcess() at end of frame, does nothing if ENABLE_KLOG_BUFFER is not set.<br>
+ *  Note that kprintf(..) is never buffered (it has to format its arguments immediately).
+ */
+void KLog_flush(void);
+
 
 /**
  *  \brief
@@ -239,6 +258,16 @@ Image *allocateImage(const Image *image);
  *      <i>NULL</i> is returned if there is not enough memory to store the data for given MapDefinition.
  */
 Map *allocateMap(const MapDefinition *mapDef);
+/**
+ *  \brief
+ *      Same as #allocateMap(..) except that block cache is allocated with the given size for streamed map (see #MAP_BLOCKS_STREAM).
+ *
+ *  \param mapDef
+ *      Source MapDefinition we want to allocate Map object for.
+ *  \param blockCacheSize
+ *      number of block in block cache (only used for streamed map)
+ */
+Map *allocateMapEx(const MapDefinition *mapDef, u16 blockCacheSize);
 
 /**
  *  \brief
@@ -310,6 +339,8 @@ Image *unpackImage(const Image *src, Image *dest);
  *      compression type, accepted values:<br>
  *      <b>COMPRESSION_APLIB</b><br>
  *      <b>COMPRESSION_LZ4W</b><br>
+ *      <b>COMPRESSION_DLZ</b><br>
+ *      <b>COMPRESSION_RLE</b><br>
  *  \param src
  *      Source data buffer containing the packed data to unpack.
  *  \param dest
@@ -344,6 +375,33 @@ u32 aplib_unpack(u8 *src, u8 *dest);
  *      Unpacked size.
  */
 u32 lz4w_unpack(const u8 *src, u8 *dest);
+/**
+ *  \brief
+ *      Unpack (DLZ) the specified source data buffer in the specified destination buffer.
+ *
+ *  \param src
+ *      Source data buffer containing the packed data (DLZ packed) to unpack (word aligned).
+ *  \param dest
+ *      Destination buffer where to store unpacked data (word aligned), be sure to allocate enough space.<br>
+ *      The size of unpacked data is contained in the first 4 bytes of 'src'.
+ *  \return
+ *      Unpacked size.
+ */
+u32 dlz_unpack(const u8 *src, u8 *dest);
+/**
+ *  \brief
+ *      Unpack (byte RLE) the specified source data buffer in the specified destination buffer.<br>
+ *      Packed stream is made of commands: 0 = end, 1-127 = number of literal byte following, 128-255 = following byte
+ *      repeated (command - 126) times.
+ *
+ *  \param src
+ *      Source data buffer containing the packed data (RLE packed) to unpack.
+ *  \param dest
+ *      Destination buffer where to store unpacked data, be sure to allocate enough space.
+ *  \return
+ *      Unpacked size.
+ */
+u32 rle_unpack(const u8 *src, u8 *dest);
 
 
 /**
@@ -432,6 +490,62 @@ void qsort_s32(s32 *data, u16 left, u16 right);
  */
 void qsort(void** data, u16 len, _comparatorCallback* cb);
 
+/**
+ *  \brief
+ *      Counting sort on u8 keys with payload (stable, O(n)), faster than qsort for large arrays.
+ *
+ *  \param keys
+ *      u8 keys to sort
+ *  \param values
+ *      payload array (moved along with keys)
+ *  \param len
+ *      number of element
+ *  \param tmp
+ *      temporary buffer of <i>len</i> * 4 bytes
+ */
+void radixsort_u8(u8* keys, void** values, u16 len, void* tmp);
+/**
+ *  \brief
+ *      Radix sort (2 counting sort passes) on u16 keys with payload (stable, O(n)), ideal for sorting objects by key
+ *      (sort s16 keys by adding 0x8000 to them).
+ *
+ *  \param keys
+ *      u16 keys to sort
+ *  \param values
+ *      payload array (moved along with keys)
+ *  \param len
+ *      number of element
+ *  \param tmp
+ *      temporary buffer of <i>len</i> * 6 bytes
+ */
+void radixsort_u16(u16* keys, void** values, u16 len, void* tmp);
+/**
+ *  \brief
+ *      Insertion sort on u16 keys with payload (stable), fastest method for nearly sorted data (as objects sorted by Y
+ *      from one frame to another) but O(n^2) in worst case.
+ *
+ *  \param keys
+ *      u16 keys to sort
+ *  \param values
+ *      payload array (moved along with keys)
+ *  \param len
+ *      number of element
+ */
+void insertsort_u16(u16* keys, void** values, u16 len);
+/**
+ *  \brief
+ *      Insertion sort on s16 keys with payload (stable), fastest method for nearly sorted data (as objects sorted by Y
+ *      from one frame to another) but O(n^2) in worst case.
+ *
+ *  \param keys
+ *      s16 keys to sort
+ *  \param values
+ *      payload array (moved along with keys)
+ *  \param len
+ *      number of element
+ */
+void insertsort_s16(s16* keys, void** values, u16 len);
+
 
 
 #endif // _TOOLS_H_
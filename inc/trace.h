@@ -0,0 +1,155 @@
+/**
+ *  \file trace.h
+ *  \brief Binary trace event stream
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit records a compact binary stream of timestamped begin / end events (requires ENABLE_TRACE set to 1 in
+ * config.h) which can be converted on PC to Chrome trace JSON with the tracedec tool (tools/tracedec) and visualized
+ * as a frame timeline (chrome://tracing, Perfetto...).<br>
+ * Each event is a single long word: event type (2 bits), event id (6 bits), frame counter low byte (8 bits) and
+ * VDP H/V counter (16 bits), so recording an event only costs a few dozen of cycles.<br>
+ * Library automatically traces profiler zones (PROF_begin(..) / PROF_end(..) macros, even if ENABLE_PROFILER is 0),
+ * V-Int and H-Int handlers and XGM sound commands.<br>
+ * Events are stored in a ring buffer which is either sent to the KDebug port at end of frame (TRACE_KDEBUG set to 1 in
+ * config.h, emulator log should then be saved to a file) or kept in RAM where the last events can be dumped from the
+ * emulator memory viewer (tracedec looks for the #TraceBuffer header in the RAM dump).
+ *<pre>
+ * TRACE_begin(TRACE_ID_USER + 0);
+ * updateEnemies();
+ * TRACE_end(TRACE_ID_USER + 0);</pre>
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+
+/**
+ *  \brief
+ *      Trace buffer header magic ('STRC')
+ */
+#define TRACE_MAGIC             0x53545243
+
+/**
+ *  \brief
+ *      Event types
+ */
+#define TRACE_BEGIN             0
+#define TRACE_END               1
+#define TRACE_INSTANT           2
+#define TRACE_EXT               3
+
+/**
+ *  \brief
+ *      Extended event ids (TRACE_EXT type), timestamp is replaced by a 16 bits value
+ */
+#define TRACE_EXT_FRAME         0
+#define TRACE_EXT_VALUE         1
+#define TRACE_EXT_LOST          2
+#define TRACE_EXT_CONFIG        3
+
+/**
+ *  \brief
+ *      Library event ids (0 to 15 are the profiler zones, see PROF_ZONE_xxx)
+ */
+#define TRACE_ID_VINT           16
+#define TRACE_ID_HINT           17
+#define TRACE_ID_SOUND          18
+/**
+ *  \brief
+ *      First event id available for user events (id should be < 64)
+ */
+#define TRACE_ID_USER           24
+
+/**
+ *  \brief
+ *      Sound command values (attached to #TRACE_ID_SOUND begin event)
+ */
+#define TRACE_SND_PLAY          0
+#define TRACE_SND_STOP          1
+#define TRACE_SND_PAUSE         2
+#define TRACE_SND_RESUME        3
+#define TRACE_SND_PCM_PLAY      4
+#define TRACE_SND_PCM_STOP      5
+
+
+/**
+ *  \brief
+ *      Trace ring buffer (exported so it can be found in a RAM dump)
+ *
+ *  \param magic
+ *      #TRACE_MAGIC
+ *  \param size
+ *      buffer size in event (TRACE_BUFFER_SIZE)
+ *  \param pos
+ *      write position (free running event counter)
+ *  \param events
+ *      event ring buffer
+ */
+typedef struct
+{
+    u32 magic;
+    u16 size;
+    u16 pos;
+    u32 events[];
+} TraceBuffer;
+
+
+#if (ENABLE_TRACE != 0)
+
+/**
+ *  \brief
+ *      Record a begin event for the given id (should be followed by TRACE_end(id)).
+ */
+#define TRACE_begin(id)         TRACE_event(TRACE_BEGIN, id)
+/**
+ *  \brief
+ *      Record an end event for the given id.
+ */
+#define TRACE_end(id)           TRACE_event(TRACE_END, id)
+/**
+ *  \brief
+ *      Record an instant event for the given id.
+ */
+#define TRACE_instant(id)       TRACE_event(TRACE_INSTANT, id)
+/**
+ *  \brief
+ *      Attach a 16 bits value to the last recorded event.
+ */
+#define TRACE_value(v)          TRACE_extEvent(TRACE_EXT_VALUE, v)
+
+/**
+ *  \brief
+ *      Trace ring buffer
+ */
+extern TraceBuffer* const traceBuffer;
+
+/**
+ *  \brief
+ *      Record an event of given type and id, use TRACE_xxx(..) macros instead.
+ */
+void TRACE_event(u16 type, u16 id);
+/**
+ *  \brief
+ *      Record an extended event (TRACE_EXT_xxx) with the given value, use TRACE_value(..) macro instead.
+ */
+void TRACE_extEvent(u16 id, u16 value);
+/**
+ *  \brief
+ *      Send buffered events to the KDebug port (when TRACE_KDEBUG is set).<br>
+ *      Automatically called by #SYS_doVBlankProcess() at end of frame.
+ */
+void TRACE_flush(void);
+
+#else
+
+#define TRACE_begin(id)
+#define TRACE_end(id)
+#define TRACE_instant(id)
+#define TRACE_value(v)
+
+#define TRACE_flush()
+
+#endif // ENABLE_TRACE
+
+#endif // _TRACE_H_
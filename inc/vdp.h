@@ -135,6 +135,15 @@
  */
 #define VDP_MAPS_START          maps_addr
 
+/**
+ *  \brief
+ *      Default VRAM address of background A, background B and window tilemaps (as set by VDP_init()), can be used with
+ *      #GFX_WRITE_PLANE_ADDR(..) when the default VRAM organization is kept.
+ */
+#define VDP_BG_A_DEFAULT        0xE000
+#define VDP_BG_B_DEFAULT        0xC000
+#define VDP_WINDOW_DEFAULT      0xD000
+
 /**
  *  \brief
  *      Definition to set horizontal scroll to mode plane.
@@ -356,6 +365,20 @@
  */
 #define GFX_HORZ_SCROLL(adr)        GFX_WRITE_VRAM_ADDR(VDP_SCROLL_H + (adr))
 
+/**
+ *  \brief
+ *      Returns the VRAM address of tilemap position (x, y) for a plane at <i>planeAddr</i> of <i>planeW</i> tiles
+ *      (no wrapping).<br>
+ *      Fully resolved at compile time when all parameters are constant (as VDP_BG_A_DEFAULT, 64, 1, 2).
+ */
+#define GFX_PLANE_ADDR(planeAddr, planeW, x, y)         ((planeAddr) + (((((y) * (planeW)) + (x))) * 2))
+/**
+ *  \brief
+ *      Set VDP command to write at tilemap position (x, y) for a plane at <i>planeAddr</i> of <i>planeW</i> tiles.<br>
+ *      Fully resolved at compile time when all parameters are constant (see #VDP_setTileMapCmd(..)).
+ */
+#define GFX_WRITE_PLANE_ADDR(planeAddr, planeW, x, y)   GFX_WRITE_VRAM_ADDR((u32) GFX_PLANE_ADDR(planeAddr, planeW, x, y))
+
 /**
  *  \brief
  *      Tests VDP status against specified flag (see VDP_XXX_FLAG).
@@ -455,6 +478,16 @@ extern u16 planeHeightSft;
  *  Possible values are: 5 or 6 (corresponding to window width 32 or 64)
  */
 extern u16 windowWidthSft;
+/**
+ *  \brief
+ *      Background plane row offset table (row * planeWidth * 2), updated on plane size change
+ */
+extern u16 planeRowOffset[128];
+/**
+ *  \brief
+ *      Window row offset table (row * windowWidth * 2), updated on screen width change
+ */
+extern u16 windowRowOffset[32];
 
 
 /**
@@ -493,6 +526,39 @@ u8   VDP_getReg(u16 reg);
  */
 void VDP_setReg(u16 reg, u8 value);
 
+/**
+ *  \brief
+ *      Returns TRUE if VDP register writes are deferred (see #VDP_setRegDeferred(..))
+ */
+bool VDP_getRegDeferred(void);
+/**
+ *  \brief
+ *      Enable / disable deferred VDP register writes.
+ *
+ *  \param value
+ *      TRUE to enable deferred mode, FALSE to write registers immediately (default).<br>
+ *      Disabling deferred mode writes pending changes immediately.
+ *
+ *  In deferred mode register modifications (VDP_setReg(..), VDP_setScreenWidth320(), VDP_setScrollingMode(..),
+ *  VDP_setBGAAddress(..)...) only update the register shadow and mark it as modified, all modified registers are then
+ *  written in a single batch at VBlank start (SYS_doVBlankProcess()).<br>
+ *  This makes a mode change done through several calls atomic (no frame displayed with half applied settings) and
+ *  a register modified several times in a frame is written only once.<br>
+ *  Auto increment, H-Int counter, display enable, DMA enable and H-Int enable are always written immediately as
+ *  transfer code and interrupts depend on them, for per scanline changes use raster effects (see raster.h).<br>
+ *  Note that getters (VDP_getReg(..), VDP_getScreenWidth()...) return the new value even if it isn't written yet.
+ */
+void VDP_setRegDeferred(bool value);
+/**
+ *  \brief
+ *      Immediately write pending (deferred) register changes.
+ *
+ *  \return number of register written
+ *
+ *  Can be used from a H-Int callback to apply a set of deferred changes at a specific scanline.
+ */
+u16 VDP_flushRegs(void);
+
 /**
  *  \brief
  *      Returns VDP enable state.
@@ -585,6 +651,45 @@ void VDP_setPlaneSize(u16 w, u16 h, bool setupVram);
  *      Use #VDP_setPlaneSize(..) instead.
  */
 void VDP_setPlanSize(u16 w, u16 h);
+/**
+ *  \brief
+ *      Plane and tables requirements for #VDP_setVRAMLayout(..)
+ *
+ *  \param planeWidth
+ *      plane width in tile (32, 64 or 128)
+ *  \param planeHeight
+ *      plane height in tile (32, 64 or 128)
+ *  \param window
+ *      window plane is used (if FALSE the window address is shared with plane A so window should stay disabled)
+ *  \param hscrollMode
+ *      horizontal scrolling mode which will be used (HSCROLL_PLANE only needs 4 bytes for the horizontal scroll table)
+ */
+typedef struct
+{
+    u16 planeWidth;
+    u16 planeHeight;
+    bool window;
+    u16 hscrollMode;
+} VDPLayout;
+
+/**
+ *  \brief
+ *      Set plane size and place tilemaps and tables (plane A / B, window, sprite list and horizontal scroll table) in
+ *      VRAM so the tile area (from tile 0 to the first table) is as large as possible.<br>
+ *      All table placements respecting VDP address alignments (for current H32 / H40 mode) are evaluated and the one
+ *      leaving the highest lowest table address is kept, unused window plane and horizontal scroll space can then hold
+ *      tiles. Font and sprite engine VRAM region are moved just below the new tables area (see TILE_FONT_INDEX and
+ *      TILE_SPRITE_INDEX) and tables area is cleared.<br>
+ *      Should be called with display off (before drawing backgrounds), tilemaps / scroll values should be set again.
+ *
+ *  \param layout
+ *      planes and tables requirements
+ *  \return number of tile available for user and sprite engine (TILE_FONT_INDEX - TILE_USER_INDEX)
+ *
+ *  \see VDP_setPlaneSize(..)
+ *  \see SPR_initWithFlags(..)
+ */
+u16 VDP_setVRAMLayout(const VDPLayout* layout);
 
 /**
  *  \brief
@@ -826,6 +931,16 @@ void VDP_setHScrollTableAddress(u16 value);
  * The number of cells on the screen stays the same regardless of which scanning mode is active.
  */
 void VDP_setScanMode(u16 mode);
+/**
+ *  \brief
+ *      Returns the current scan mode (#INTERLACED_NONE, #INTERLACED_MODE1 or #INTERLACED_MODE2)
+ *
+ * In Interlaced Mode 2 vertical resolution is doubled (448 or 480 lines) and cells are 8x16 pixels (64 bytes):
+ * - tile index in tilemap entries and sprite attributes is in 8x16 tile unit (see VDP_loadTileData8x16(..))<br>
+ * - sprite height is in 16 pixels unit and sprite Y position origin is 256 (Y in 448 lines unit)<br>
+ * - vertical scroll values are in 448 lines unit (Map engine converts them automatically).
+ */
+u16 VDP_getScanMode(void);
 
 /**
  *  \brief
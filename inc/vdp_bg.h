@@ -215,6 +215,142 @@ void VDP_setVerticalScrollVSync(VDPPlane plane, s16 value);
  */
 void VDP_setVerticalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, TransferMethod tm);
 
+/**
+ *  \brief
+ *      Initialize the scroll engine (allocate line / column scroll tables for both planes).<br>
+ *      The scroll engine owns double-buffered line (or tile depending HSCROLL mode) and column scroll tables:
+ *      helpers write the pending table which is compared to the uploaded one so only changed ranges are uploaded
+ *      during VBlank (PROCESS_VDP_SCROLL_TASK).<br>
+ *      Don't mix it with #VDP_setHorizontalScrollLine(..) / #VDP_setVerticalScrollTile(..) on the same plane.
+ *
+ *  \return FALSE if there is not enough memory to allocate scroll tables
+ *  \see VDP_releaseScrollEngine()
+ */
+bool VDP_initScrollEngine(void);
+/**
+ *  \brief
+ *      Release the scroll engine tables (see #VDP_initScrollEngine())
+ */
+void VDP_releaseScrollEngine(void);
+/**
+ *  \brief
+ *      Returns the pending line scroll table of the given plane (240 entries, used as 30 tile entries in HSCROLL_TILE mode)
+ *      for direct modification, #VDP_setLineScrollDirty(..) should then be called for the modified range.
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ */
+s16* VDP_getLineScrollTable(VDPPlane plane);
+/**
+ *  \brief
+ *      Mark a range of the line scroll table as modified (required after direct modification of #VDP_getLineScrollTable(..) table)
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first modified line (or tile in HSCROLL_TILE mode)
+ *  \param len
+ *      number of modified line
+ */
+void VDP_setLineScrollDirty(VDPPlane plane, u16 from, u16 len);
+/**
+ *  \brief
+ *      Set horizontal scroll value for a range of lines (parallax band).<br>
+ *      Line index is a tile index when HSCROLL_TILE mode is used.
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first line
+ *  \param len
+ *      number of line
+ *  \param value
+ *      H scroll offset
+ */
+void VDP_setLineScroll(VDPPlane plane, u16 from, u16 len, s16 value);
+/**
+ *  \brief
+ *      Set horizontal scroll values for a range of lines (each value applied to one line).
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first line
+ *  \param values
+ *      H scroll offsets
+ *  \param len
+ *      number of line
+ */
+void VDP_setLineScrollValues(VDPPlane plane, u16 from, const s16* values, u16 len);
+/**
+ *  \brief
+ *      Set horizontal scroll values for a range of lines where each value is applied to 2 consecutive lines (line-doubling).
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first line
+ *  \param values
+ *      H scroll offsets (<i>len / 2</i> entries)
+ *  \param len
+ *      number of line
+ */
+void VDP_setLineScrollDoubled(VDPPlane plane, u16 from, const s16* values, u16 len);
+/**
+ *  \brief
+ *      Set a sine wobble horizontal scroll on a range of lines:<br>
+ *      scroll(line) = base + (amplitude * sin(phase + ((line - from) * freq)))
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first line
+ *  \param len
+ *      number of line
+ *  \param base
+ *      base H scroll offset
+ *  \param amplitude
+ *      wobble amplitude (in pixel, fix16 format)
+ *  \param phase
+ *      start angle (1024 = 2 PI, see sinFix16(..)), increment it every frame to animate
+ *  \param freq
+ *      angle increment per line (1024 = 2 PI)
+ */
+void VDP_setLineScrollWobble(VDPPlane plane, u16 from, u16 len, s16 base, fix16 amplitude, u16 phase, u16 freq);
+/**
+ *  \brief
+ *      Set vertical scroll value for a range of 2-tiles columns.
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first column
+ *  \param len
+ *      number of column (20 max)
+ *  \param value
+ *      V scroll offset
+ */
+void VDP_setColumnScroll(VDPPlane plane, u16 from, u16 len, s16 value);
+/**
+ *  \brief
+ *      Set vertical scroll values for a range of 2-tiles columns (each value applied to one column).
+ *
+ *  \param plane
+ *      BG_A or BG_B
+ *  \param from
+ *      first column
+ *  \param values
+ *      V scroll offsets
+ *  \param len
+ *      number of column
+ */
+void VDP_setColumnScrollValues(VDPPlane plane, u16 from, const s16* values, u16 len);
+/**
+ *  \brief
+ *      Set a sine wobble vertical scroll on a range of 2-tiles columns (see #VDP_setLineScrollWobble(..))
+ */
+void VDP_setColumnScrollWobble(VDPPlane plane, u16 from, u16 len, s16 base, fix16 amplitude, u16 phase, u16 freq);
+
 /**
  *  \brief
  *      Clear specified plane (using DMA).
@@ -105,6 +105,7 @@
  *      <b>COMPRESSION_NONE</b><br>
  *      <b>COMPRESSION_APLIB</b><br>
  *      <b>COMPRESSION_LZ4W</b><br>
+ *      <b>COMPRESSION_DLZ</b><br>
  *  \param numTile
  *      number of tile in the <i>tiles</i> buffer.
  *  \param tiles
@@ -126,6 +127,7 @@ typedef struct
  *      <b>COMPRESSION_NONE</b><br>
  *      <b>COMPRESSION_APLIB</b><br>
  *      <b>COMPRESSION_LZ4W</b><br>
+ *      <b>COMPRESSION_DLZ</b><br>
  *  \param w
  *      tilemap width in tile.
  *  \param h
@@ -157,6 +159,14 @@ typedef struct
  *      Y position (in tile).
  */
 u16 VDP_getPlaneAddress(VDPPlane plane, u16 x, u16 y);
+/**
+ *  \brief
+ *      Return the VDP command word to write at the specified plane position (see #VDP_getPlaneAddress(..)).
+ *
+ *  Useful to set the VDP address directly (*((vu32*) GFX_CTRL_PORT) = cmd) or with #VDP_setTileMapCmd(..).<br>
+ *  For constant coordinates and plane address prefer #GFX_WRITE_PLANE_ADDR(..) which is resolved at compile time.
+ */
+u32 VDP_getPlaneWriteCmd(VDPPlane plane, u16 x, u16 y);
 
 /**
  *  \brief
@@ -189,7 +199,10 @@ void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm);
  *      Pointer to TileSet structure.<br>
  *      The TileSet is unpacked "on-the-fly" if needed (require some memory).<br>
  *      Using DMA_QUEUE for packed resource is unsafe as the resource will be released and eventually
- *      can be overwritten before DMA operation so use DMA_QUEUE_COPY in that case or unpack the resource first.
+ *      can be overwritten before DMA operation so use DMA_QUEUE_COPY in that case or unpack the resource first.<br>
+ *      With bank switching enabled, unpacked TileSet is transferred directly from ROM: a TileSet crossing a mapper bank
+ *      boundary is split in 2 transfers (one per bank region) so no RAM copy is needed (with DMA_QUEUE the mapped banks
+ *      should not change before the queue is flushed).
  *  \param index
  *      Tile index where start tile data load (use TILE_USER_INDEX as base user index).
  *  \param tm
@@ -207,6 +220,52 @@ void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm);
  *  ~190 bytes per scanline in hardware (during blanking)
  */
 u16 VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm);
+/**
+ *  \brief
+ *      Load 8x16 tile data (pattern) in VRAM, for interlaced mode 2 (see #VDP_setScanMode(..)).
+ *
+ *  \param data
+ *      Pointer to tile data, each 8x16 tile is 64 bytes (top 8x8 half followed by bottom 8x8 half).<br>
+ *      Use #VDP_convertTileData8x16(..) to build it from regular 8x8 tiles or the <i>IM2</i> TILESET ordering in rescomp.
+ *  \param index
+ *      8x16 tile index where start tile data load (VRAM address = index * 64).<br>
+ *      In interlaced mode 2 the tile index of tilemap entries and sprite attributes is in 8x16 tile unit.
+ *  \param num
+ *      Number of 8x16 tile to load.
+ *  \param tm
+ *      Transfer method (CPU, DMA, DMA_QUEUE or DMA_QUEUE_COPY)
+ */
+void VDP_loadTileData8x16(const u32 *data, u16 index, u16 num, TransferMethod tm);
+/**
+ *  \brief
+ *      Load 8x16 tiles from a TileSet structure, for interlaced mode 2 (see #VDP_setScanMode(..)).
+ *
+ *  \param tileset
+ *      TileSet using 8x16 tile ordering (<i>IM2</i> TILESET ordering in rescomp), <i>numTile</i> field still counts
+ *      8x8 tiles so it should be even.
+ *  \param index
+ *      8x16 tile index where start tile data load (VRAM address = index * 64).
+ *  \param tm
+ *      Transfer method (CPU, DMA, DMA_QUEUE or DMA_QUEUE_COPY)
+ *  \return
+ *      FALSE if there is not enough memory to unpack the specified TileSet (only if compression was enabled).
+ */
+u16 VDP_loadTileSet8x16(const TileSet *tileset, u16 index, TransferMethod tm);
+/**
+ *  \brief
+ *      Convert regular 8x8 tiles of an image into 8x16 tiles for interlaced mode 2.
+ *
+ *  \param src
+ *      source tiles: <i>w</i> x <i>h</i> 8x8 tiles stored in row order.
+ *  \param dest
+ *      destination buffer (same size as source, can't be the same buffer): (<i>w</i> x <i>h</i> / 2) 8x16 tiles stored
+ *      in row order, 8x16 tile (x, y) is built from 8x8 tiles (x, y * 2) and (x, (y * 2) + 1).
+ *  \param w
+ *      image width in tile
+ *  \param h
+ *      image height in 8x8 tile (should be even)
+ */
+void VDP_convertTileData8x16(const u32 *src, u32 *dest, u16 w, u16 h);
 /**
  *  \brief
  *      Load font tile data in VRAM.<br>
@@ -449,6 +508,20 @@ void VDP_setTileMapDataEx(u16 planeAddr, const u16 *data, u16 basetile, u16 ind,
  *  Set the specified tilemap position (tilemap wrapping supported) with given tile attributes.
  */
 void VDP_setTileMapXY(VDPPlane plane, u16 tile, u16 x, u16 y);
+/**
+ *  \brief
+ *      Set the tilemap position given by a VDP write command with given tile attributes.
+ *
+ *  \param cmd
+ *      VDP write command for the tilemap position, from #GFX_WRITE_PLANE_ADDR(..) (compile time) or
+ *      #VDP_getPlaneWriteCmd(..)
+ *  \param tile
+ *      tile index and attributes
+ *
+ *  Inlined and with constant command (as HUD or text position), it only costs 2 writes:<pre>
+ *  VDP_setTileMapCmd(GFX_WRITE_PLANE_ADDR(VDP_BG_A_DEFAULT, 64, 2, 1), TILE_ATTR_FULL(PAL0, TRUE, FALSE, FALSE, heartTile));</pre>
+ */
+#define VDP_setTileMapCmd(cmd, tile)    (*((vu32*) GFX_CTRL_PORT) = (cmd), *((vu16*) GFX_DATA_PORT) = (tile))
 /**
  *  \brief
  *      Clear specified region of tilemap.
@@ -0,0 +1,146 @@
+/**
+ *  \file video.h
+ *  \brief Frame delta video player
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * This unit plays full motion video (as "Bad Apple" demo) built with the rescomp VIDEO resource.<br>
+ * <br>
+ * All frames use a single 16 colors palette, a dictionary of the most recurring tiles is uploaded once at start and
+ * each frame only stores the new tiles (uploaded in VRAM slots not displayed by the current frame) and the tilemap
+ * entries changed since previous frame (see rescomp.txt for the encoding).<br>
+ * Frame data is unpacked in RAM, new tiles are queued as mid frame transfers (see #DMA_setMidFrameTransfer(..)) then
+ * the tilemap update is queued once they have been transferred, so a frame never displays tiles which aren't uploaded
+ * yet. When the VBlank capacity isn't enough the VBlank period can be extended with H-Int display blanking
+ * (see #DMA_setHIntFlush(..)).<br>
+ * Frame timing is based on vtimer from the first displayed frame: start the audio (PCM sample for instance) from the
+ * start callback (see #VID_setStartCallback(..)) to keep them in sync:<pre>
+ * VID_setStartCallback(startAudio);
+ * VID_play(&movie, BG_B, 0, 0, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USER_INDEX), 200);
+ * while(VID_update())
+ *     SYS_doVBlankProcess();</pre>
+ */
+
+#ifndef _VIDEO_H_
+#define _VIDEO_H_
+
+#include "vdp.h"
+#include "vdp_tile.h"
+#include "pal.h"
+
+
+/**
+ *  \brief
+ *      Video frame structure
+ *
+ *  \param compression
+ *      compression type of frame data
+ *  \param size
+ *      frame data size (in bytes, unpacked)
+ *  \param data
+ *      frame data (new tiles and tilemap update)
+ */
+typedef struct
+{
+    u16 compression;
+    u16 size;
+    const u8* data;
+} VideoFrame;
+
+/**
+ *  \brief
+ *      Video structure (built with the rescomp VIDEO resource)
+ *
+ *  \param w
+ *      width in tile
+ *  \param h
+ *      height in tile
+ *  \param fps
+ *      frame rate (frame per second)
+ *  \param numFrame
+ *      number of frame
+ *  \param maxFrameSize
+ *      maximum frame data size (in bytes, unpacked)
+ *  \param numTile
+ *      number of VRAM tile used by the video (dictionary + frame tiles)
+ *  \param palette
+ *      video palette (16 colors)
+ *  \param dictionary
+ *      recurring tiles uploaded at start (can be NULL)
+ *  \param frames
+ *      frames table
+ */
+typedef struct
+{
+    u16 w;
+    u16 h;
+    u16 fps;
+    u16 numFrame;
+    u16 maxFrameSize;
+    u16 numTile;
+    const Palette* palette;
+    const TileSet* dictionary;
+    const VideoFrame* frames;
+} Video;
+
+
+/**
+ *  \brief
+ *      Start playing the given video (current playing video is stopped).<br>
+ *      Palette and tile dictionary are loaded immediately (DMA) and first frame is displayed on next #VID_update(..).
+ *
+ *  \param video
+ *      video to play
+ *  \param plane
+ *      plane where to display the video (BG_A, BG_B or WINDOW)
+ *  \param x
+ *      video X position in plane (in tile)
+ *  \param y
+ *      video Y position in plane (in tile)
+ *  \param baseTile
+ *      base tile attributes: VRAM tile index of the video tiles (<i>video->numTile</i> tiles are used), palette index
+ *      (video palette is loaded there) and priority (see TILE_ATTR_FULL() macro)
+ *  \param blankLine
+ *      0 = no VBlank extension, otherwise display is blanked from this scanline to extend DMA capacity (bottom of the screen
+ *      appears as backdrop color, see #DMA_setHIntFlush(..))
+ *  \return FALSE if there is not enough memory or VRAM tiles to play the video
+ */
+bool VID_play(const Video* video, VDPPlane plane, u16 x, u16 y, u16 baseTile, u16 blankLine);
+/**
+ *  \brief
+ *      Stop video playback and release player buffers (last displayed frame stays on screen).<br>
+ *      Should be called after VBlank process as queued transfers may still use player buffers.
+ */
+void VID_stop(void);
+/**
+ *  \brief
+ *      Returns TRUE if a video is currently playing
+ */
+bool VID_isPlaying(void);
+/**
+ *  \brief
+ *      Returns number of frame displayed so far for the current video
+ */
+u16 VID_getFrame(void);
+/**
+ *  \brief
+ *      Set the callback called when the first video frame is displayed (used to start audio in sync with video).
+ *
+ *  \param CB
+ *      callback (NULL to disable), kept for next videos
+ */
+void VID_setStartCallback(VoidCallback* CB);
+/**
+ *  \brief
+ *      Video player update, should be called once per frame (before SYS_doVBlankProcess()).<br>
+ *      Queue the tilemap update of current frame when its tiles have been transferred and its display time is reached,
+ *      then unpack next frame and queue its tiles.<br>
+ *      When playback is late (transfers exceeding capacity) frames are displayed as soon as they are ready until
+ *      playback catches up.
+ *
+ *  \return FALSE when video is finished (player is then stopped) or no video is playing
+ */
+bool VID_update(void);
+
+
+#endif // _VIDEO_H_
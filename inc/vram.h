@@ -145,6 +145,19 @@
 #define _VRAM_H_
 
 
+/**
+ *  \brief
+ *      VRAM region allocation policy: take the first free block large enough, packing free blocks only when needed (default)
+ */
+#define VRAM_POLICY_FIRST_FIT   0
+/**
+ *  \brief
+ *      VRAM region allocation policy: take the smallest free block large enough (packing adjacent free blocks on the way),
+ *      slower allocation but it better preserves large free blocks when blocks of varied size are allocated and released.
+ */
+#define VRAM_POLICY_BEST_FIT    1
+
+
 /**
  *  \brief
  *      VRAM region structure.
@@ -157,6 +170,8 @@
  *      position of next free area
  *  \param vram
  *      allocation buffer
+ *  \param policy
+ *      allocation policy (VRAM_POLICY_FIRST_FIT or VRAM_POLICY_BEST_FIT)
  *
  * Define cache information for a VRAM region dedicated to tile storage.
  */
@@ -166,6 +181,7 @@ typedef struct
     u16 endIndex;
     u16 *free;
     u16 *vram;
+    u16 policy;
 } VRAMRegion;
 
 
@@ -237,6 +253,28 @@ u16 VRAM_getAllocated(VRAMRegion *region);
  *      the largest free block index in the specified VRAM region.
  */
 u16 VRAM_getLargestFreeBlock(VRAMRegion *region);
+/**
+ *  \brief
+ *      Return the fragmentation level of the given VRAM region.
+ *
+ *  \param region
+ *      VRAM region
+ *  \return
+ *      fragmentation level in percent: 0 means all free tiles are contiguous, 100 means free tiles are spread over
+ *      many small areas (computed as 100 - (largest contiguous free area * 100 / free tiles)).
+ */
+u16 VRAM_getFragmentation(VRAMRegion *region);
+
+/**
+ *  \brief
+ *      Set the allocation policy for the given VRAM region (reset to VRAM_POLICY_FIRST_FIT by VRAM_createRegion(..)).
+ *
+ *  \param region
+ *      VRAM region
+ *  \param policy
+ *      VRAM_POLICY_FIRST_FIT or VRAM_POLICY_BEST_FIT
+ */
+void VRAM_setPolicy(VRAMRegion *region, u16 policy);
 
 /**
  *  \brief
@@ -265,6 +303,27 @@ s16 VRAM_alloc(VRAMRegion *region, u16 size);
  *  \see VRAM_alloc(..)
  */
 void VRAM_free(VRAMRegion *region, u16 index);
+/**
+ *  \brief
+ *      Find the first allocated block which can be moved down into the free area preceding it and update allocation accordingly.<br>
+ *      Only the allocation state is modified, the caller is responsible for moving the tile data (see DMA_doVRamCopy(..)).
+ *
+ *  \param region
+ *      VRAM region
+ *  \param maxSize
+ *      Maximum size (in tile) of the block we want to move, larger blocks are left in place.
+ *  \param fromIndex
+ *      Receive the previous index in VRAM of the moved block.
+ *  \return
+ *      the new index in VRAM of the moved block.<br>
+ *      -1 if no block can be moved (region is packed or remaining blocks are too large).
+ *
+ * The free area preceding the block has to be at least as large as the block itself so the new location never
+ * overlap the previous one (tile data stay valid at the old location until VDP sprite table is updated).
+ *
+ *  \see VRAM_alloc(..)
+ */
+s16 VRAM_moveDown(VRAMRegion *region, u16 maxSize, u16 *fromIndex);
 
 
 #endif // _VRAM_H_
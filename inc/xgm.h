@@ -19,6 +19,20 @@
  */
 #define DRIVER_FLAG_MANUALSYNC_XGM  (1 << 0)
 #define DRIVER_FLAG_DELAYDMA_XGM    (1 << 1)
+#define DRIVER_FLAG_QUEUE_XGM       (1 << 2)
+#define DRIVER_FLAG_KEEPPCM_XGM     (1 << 3)
+#define DRIVER_FLAG_NOAUTODELAY_XGM (1 << 4)
+
+/**
+ *  \brief
+ *      Size of the XGM command queue (should be a power of 2), see #XGM_setCommandQueue(..)
+ */
+#define XGM_COMMAND_QUEUE_SIZE      16
+/**
+ *  \brief
+ *      Sample id reserved for PCM stream, see #XGM_startStreamPCM(..)
+ */
+#define XGM_STREAM_PCM_ID           255
 
 
 /**
@@ -172,6 +186,39 @@ void XGM_startPlayPCM(const u8 id, const u8 priority, const u16 channel);
  *      #SOUND_PCM_CH4    = channel 4<br>
  */
 void XGM_stopPlayPCM(const u16 channel);
+/**
+ *  \brief
+ *      Play a long PCM sample (voice track for instance) on specified channel, sample can be located anywhere in ROM (XGM music player driver).<br>
+ *      The sample is played as consecutive segments and each segment is started from SYS_doVBlankProcess() when previous one ends.<br>
+ *      If bank switch is enabled (see ENABLE_BANK_SWITCH flag in config.h), a segment never crosses a 512 KB bank and is
+ *      played through a bank region which stays pinned (see SYS_acquireFarData(..)) while the segment is played, so
+ *      sample can be larger than 4 MB and located in far ROM without duplicating data.<br>
+ *      Note that segment chaining is done at frame granularity so a very short gap (less than 1 frame) can be heard at
+ *      512 KB boundaries (about each 37 seconds).
+ *
+ *  \param sample
+ *      Sample address (real ROM address, not converted with FAR(..) macro), should be 256 bytes boundary aligned
+ *  \param len
+ *      Size of sample in bytes, should be a multiple of 256
+ *  \param priority
+ *      Value should go from 0 to 15 where 0 is lowest priority and 15 the highest one.
+ *  \param channel
+ *      Channel where we want to play the stream (#SOUND_PCM_CH2 to #SOUND_PCM_CH4 preferably)
+ *
+ *  \see XGM_stopStreamPCM()
+ *  \see XGM_STREAM_PCM_ID
+ */
+void XGM_startStreamPCM(const u8 *sample, const u32 len, const u8 priority, const u16 channel);
+/**
+ *  \brief
+ *      Stop the current PCM stream (XGM music player driver).
+ */
+void XGM_stopStreamPCM(void);
+/**
+ *  \brief
+ *      Returns #TRUE if a PCM stream is playing (XGM music player driver).
+ */
+bool XGM_isStreamingPCM(void);
 
 /**
  *  \brief
@@ -182,6 +229,48 @@ void XGM_stopPlayPCM(const u16 channel);
  *  \see XGM_setMusicTempo()
  */
 u32 XGM_getElapsed(void);
+/**
+ *  \brief
+ *      Returns #TRUE if the command queue is enabled (XGM music player driver).
+ *
+ *  \see XGM_setCommandQueue(..)
+ */
+u16 XGM_getCommandQueue(void);
+/**
+ *  \brief
+ *      Enable or disable the command queue (XGM music player driver, disabled by default).<br>
+ *      When enabled, #XGM_setPCM(..), #XGM_startPlayPCM(..), #XGM_stopPlayPCM(..) and #XGM_setLoopNumber(..) don't
+ *      access the Z80 anymore but store the command in a small queue in 68000 RAM. The queue is sent to the Z80 on next
+ *      frame process (#XGM_nextFrame(), automatically done on V-Int by default) using the Z80 bus request we already need there,
+ *      so we have a single bus request per frame whatever is the number of SFX commands (less 68000 stall and PCM jitter).<br>
+ *      The drawback is that commands take effect on next frame and #XGM_isPlayingPCM(..) doesn't see queued PCM yet.<br>
+ *      Other methods (#XGM_setPCMFast(..) included) still access the Z80 directly and aren't ordered with the queued commands.
+ *      Disabling the queue sends pending commands immediately.
+ *
+ *  \param value TRUE or FALSE
+ *  \see XGM_getCommandQueue()
+ *  \see XGM_COMMAND_QUEUE_SIZE
+ */
+void XGM_setCommandQueue(u16 value);
+/**
+ *  \brief
+ *      Returns #TRUE if the sample id table is kept across driver swaps (XGM music player driver).
+ *
+ *  \see XGM_setKeepPCMTable(..)
+ */
+u16 XGM_getKeepPCMTable(void);
+/**
+ *  \brief
+ *      Keep the sample id table across driver swaps (disabled by default).<br>
+ *      When enabled, the sample id table (see #XGM_setPCM(..)) is saved in 68000 RAM (1 KB, dynamically allocated)
+ *      when another Z80 driver is loaded and restored when the XGM driver is loaded again, so games switching between
+ *      XGM and another driver (ex: 4PCM for cutscenes) don't need to register all their samples again.<br>
+ *      Note that queued commands (see #XGM_setCommandQueue(..)) not yet sent to the Z80 aren't saved.
+ *
+ *  \param value TRUE or FALSE
+ *  \see XGM_getKeepPCMTable()
+ */
+void XGM_setKeepPCMTable(u16 value);
 /**
  *  \brief
  *      Get the current music tempo (in tick per second).<br>
@@ -291,13 +380,35 @@ u16 XGM_getForceDelayDMA(void);
  *      Even using the BUS protection with #XGM_set68KBUSProtection you may experience some altered PCM when the
  *      XGM music contains PSG data, this is because the Z80 uses the main BUS to access PSG.<br>
  *      By delaying a bit the DMA execution from the DMA queue we let the Z80 to execute all PSG commands and avoid any stall.
- *      The delay is about 3 scanlines so using the force delay DMA will reduce the DMA bandwidth for about 3 vblank lines.
+ *      The 68000 waits only until the Z80 reports the current XGM frame as processed (so usually no wait at all when the frame
+ *      contains few commands) with a maximum delay of about 3 scanlines so at worst it reduces the DMA bandwidth for 3 vblank lines.
  *
  *  \param value TRUE or FALSE
  *  \see XGM_getForceDelayDMA()
  *  \see XGM_set68KBUSProtection()
  */
 void XGM_setForceDelayDMA(u16 value);
+/**
+ *  \brief
+ *      Returns #TRUE if automatic DMA delay on heavy music frames is enabled (default).
+ *
+ *  \see XGM_setAutoDelayDMA()
+ */
+u16 XGM_getAutoDelayDMA(void);
+/**
+ *  \brief
+ *      Enable or disable automatic DMA delay on heavy music frames (enabled by default).<br>
+ *      Recent xgmtool versions store a heavy frame table in the compiled music (XGC) giving frames which contain a lot of
+ *      commands or PSG writes (Z80 uses the main BUS to access PSG). When one of these frames is sent to the Z80, the DMA
+ *      queue flush waits for the Z80 to process it (as #XGM_setForceDelayDMA(..) does for all frames) so PCM playback
+ *      isn't altered by the DMA, lighter frames don't delay the DMA at all.<br>
+ *      It has no effect on music compiled without the heavy frame table or when #XGM_setForceDelayDMA(..) is enabled.
+ *
+ *  \param value TRUE or FALSE
+ *  \see XGM_getAutoDelayDMA()
+ *  \see XGM_setForceDelayDMA()
+ */
+void XGM_setAutoDelayDMA(u16 value);
 /**
  *  \brief
  *      Returns an estimation of the Z80 CPU load (XGM driver).<br>
@@ -4,7 +4,11 @@
  *  \author Stephane Dallongeville
  *  \date 08/2011
  *
- * This unit provides access to the YM2612 through the 68000 CPU.
+ * This unit provides access to the YM2612 through the 68000 CPU.<br>
+ * A shadow of the YM2612 registers is maintained so a 68000 side music driver can use #YM2612_writeRegCached(..)
+ * or #YM2612_writeRegBuffered(..) to drop redundant register writes (and the busy wait coming with them).<br>
+ * The shadow is only accurate if the 68000 is the only one writing to the YM2612 (call #YM2612_resetShadow()
+ * after a Z80 driver accessed it).
  */
 
 #ifndef _YM2612_H_
@@ -15,6 +19,11 @@
  *      YM2612 base port address.
  */
 #define YM2612_BASEPORT     0xA04000
+/**
+ *  \brief
+ *      Maximum number of pending write for #YM2612_writeRegBuffered(..) (queue is flushed when full).
+ */
+#define YM2612_SHADOW_QUEUE_SIZE    128
 
 
 /**
@@ -71,6 +80,63 @@ void YM2612_writeReg(const u16 part, const u8 reg, const u8 data);
  */
 void YM2612_writeRegSafe(const u16 part, const u8 reg, const u8 data);
 
+/**
+ *  \brief
+ *      Invalidate the shadow register file (next cached / buffered write of each register will be always done).<br>
+ *      Pending buffered writes are discarded.
+ */
+void YM2612_resetShadow(void);
+/**
+ *  \brief
+ *      Returns the last value written (or buffered) for the given register.
+ *
+ *  \param part
+ *      part number (0-1)
+ *  \param reg
+ *      register number
+ */
+u8 YM2612_getShadowReg(const u16 part, const u8 reg);
+/**
+ *  \brief
+ *      Set YM2612 register value only if it differs from the shadow value.
+ *
+ *  \param part
+ *      part number (0-1)
+ *  \param reg
+ *      register number
+ *  \param data
+ *      register value
+ *  \return TRUE if the write was done, FALSE if it was redundant.
+ *
+ *  Key on/off register ($28) write is always done.<br>
+ *  Z80 bus should be taken (see Z80_getAndRequestBus(..)) as for #YM2612_writeReg(..).
+ */
+bool YM2612_writeRegCached(const u16 part, const u8 reg, const u8 data);
+/**
+ *  \brief
+ *      Buffer a YM2612 register write, redundant writes are dropped and the real writes are done by #YM2612_flushShadow().
+ *
+ *  \param part
+ *      part number (0-1)
+ *  \param reg
+ *      register number
+ *  \param data
+ *      register value
+ *  \return TRUE if the write is pending, FALSE if it was redundant.
+ *
+ *  A register written several times before the flush is only written once (with the last value) at the position of its first write.<br>
+ *  Key on/off register ($28) writes are events so they are all kept (in order).<br>
+ *  A frequency MSB write ($A4-$A6, $AC-$AE) is always followed by the LSB write on flush as the chip latches MSB until LSB is written.
+ */
+bool YM2612_writeRegBuffered(const u16 part, const u8 reg, const u8 data);
+/**
+ *  \brief
+ *      Write all pending buffered register writes (usually once per music tick), Z80 bus is requested if needed.
+ *
+ *  \return number of pending write done.
+ */
+u16 YM2612_flushShadow(void);
+
 /**
  *  \brief
  *      Enable YM2612 DAC.
@@ -163,6 +163,18 @@
  *      The driver is designed to avoid DMA contention when possible (depending CPU load).
  */
 #define Z80_DRIVER_XGM                  5
+/**
+ *  \brief
+ *      Fractal Sound driver (68000 music / SFX engine using the DualPCM Z80 driver), requires MODULE_FRACTAL in config.h.<br>
+ *      Fractal_Update() is automatically called at V-Int time (see ext/fractal/fractal.h).
+ */
+#define Z80_DRIVER_FRACTAL              6
+/**
+ *  \brief
+ *      RLE unpacker Z80 driver (coprocessor mode, no audio).<br>
+ *      The Z80 unpacks RLE data from ROM into its own RAM while the 68000 does other work (see z80_job.h).
+ */
+#define Z80_DRIVER_UNPACK               7
 /**
  *  \brief
  *      CUSTOM Z80 driver.
@@ -299,6 +311,7 @@ void Z80_download(const u16 from, u8 *dest, const u16 size);
  *  - #Z80_DRIVER_2ADPCM<br>
  *  - #Z80_DRIVER_4PCM<br>
  *  - #Z80_DRIVER_XGM<br>
+ *  - #Z80_DRIVER_UNPACK<br>
  *  - #Z80_DRIVER_CUSTOM<br>
  */
 u16  Z80_getLoadedDriver(void);
@@ -318,6 +331,7 @@ void Z80_unloadDriver(void);
  *      - #Z80_DRIVER_2ADPCM<br>
  *      - #Z80_DRIVER_4PCM<br>
  *      - #Z80_DRIVER_XGM<br>
+ *      - #Z80_DRIVER_UNPACK<br>
  *  \param waitReady
  *      Wait for driver to be ready.
  */
@@ -0,0 +1,82 @@
+/**
+ *  \file z80_job.h
+ *  \brief Z80 coprocessor unpacking
+ *  \author Stephane Dallongeville
+ *  \date 10/2026
+ *
+ * When no audio driver is needed (loading screen, level transition...) the Z80 can be used as a coprocessor: the
+ * #Z80_DRIVER_UNPACK driver reads RLE packed data (see COMPRESSION_RLE and rle_unpack(..)) from ROM through the Z80
+ * bank window and unpacks it into 2 Z80 RAM buffers (#Z80JOB_BLOCK_SIZE bytes each) while the 68000 does other work.<br>
+ * The 68000 pulls filled blocks as they come (to RAM or directly to VRAM through the DMA queue) so unpacking and block
+ * transfer overlap:<pre>
+ * Z80JOB_unpack(level_tiles);
+ * u16 addr = TILE_USER_INDEX * 32;
+ * while(Z80JOB_isBusy())
+ * {
+ *     addr += Z80JOB_pullToVRAM(addr);
+ *     // do something else (game logic, other loading step...)
+ *     SYS_doVBlankProcess();
+ * }</pre>
+ * The driver stops accessing ROM while the VBlank DMA queue is flushed (Z80 bus protection) and loading an audio driver
+ * cancels any unpacking in progress.
+ */
+
+#ifndef _Z80_JOB_H_
+#define _Z80_JOB_H_
+
+
+/**
+ *  \brief
+ *      Maximum size of a block returned by #Z80JOB_pull(..) (in byte)
+ */
+#define Z80JOB_BLOCK_SIZE       2048
+
+
+/**
+ *  \brief
+ *      Start unpacking the given RLE data with the Z80 (#Z80_DRIVER_UNPACK driver is loaded if needed).
+ *
+ *  \param src
+ *      RLE packed data (COMPRESSION_RLE, should be in ROM)
+ *  \return FALSE if an unpacking is already in progress (call #Z80JOB_pull(..) until #Z80JOB_isBusy() returns FALSE)
+ */
+bool Z80JOB_unpack(const u8* src);
+/**
+ *  \brief
+ *      Returns TRUE while unpacking is in progress or unpacked blocks remain to be pulled.
+ */
+bool Z80JOB_isBusy(void);
+
+/**
+ *  \brief
+ *      Copy next unpacked block (if ready) from Z80 RAM to the given buffer.
+ *
+ *  \param dest
+ *      destination buffer (should be #Z80JOB_BLOCK_SIZE bytes large)
+ *  \return block size in byte (0 if no block is ready yet)
+ */
+u16 Z80JOB_pull(u8* dest);
+/**
+ *  \brief
+ *      Copy next unpacked block (if ready) from Z80 RAM to the DMA temporary buffer and queue its transfer to VRAM.
+ *
+ *  \param vramAddr
+ *      VRAM destination address (word aligned)
+ *  \return block size in byte (0 if no block is ready yet or DMA queue / buffer is full, block is then kept)
+ */
+u16 Z80JOB_pullToVRAM(u16 vramAddr);
+
+/**
+ *  \brief
+ *      Unpack the given RLE data using the Z80 and wait for completion (mainly useful for testing, see #rle_unpack(..)).
+ *
+ *  \param src
+ *      RLE packed data
+ *  \param dest
+ *      destination buffer
+ *  \return unpacked size in byte (0 on error)
+ */
+u32 Z80JOB_unpackAll(const u8* src, u8* dest);
+
+
+#endif // _Z80_JOB_H_
@@ -4,6 +4,19 @@
 
 #define ENABLE_ASM
 
+// headless mode: all tests are executed without any pause then results are saved in SRAM and sent to KDebug log
+// (compared with tools/benchcmp), can be set from command line: make EXTRA_FLAGS=-DBENCH_HEADLESS=1
+#ifndef BENCH_HEADLESS
+#define BENCH_HEADLESS      0
+#endif
+
+// result display pause (removed in headless mode)
+#if (BENCH_HEADLESS != 0)
+#define BENCH_WAIT(ms)
+#else
+#define BENCH_WAIT(ms)      waitMs(ms)
+#endif
+
 
 void initMemTest();
 
@@ -0,0 +1,16 @@
+BIN tiles_raw "logo_tiles.bin" 2 2 0 NONE FALSE
+BIN tiles_ap "logo_tiles.bin" 2 2 0 APLIB FALSE
+BIN tiles_lz4w "logo_tiles.bin" 2 2 0 LZ4W FALSE
+BIN tiles_dlz "logo_tiles.bin" 2 2 0 DLZ FALSE
+BIN map_raw "logo_map.bin" 2 2 0 NONE FALSE
+BIN map_ap "logo_map.bin" 2 2 0 APLIB FALSE
+BIN map_lz4w "logo_map.bin" 2 2 0 LZ4W FALSE
+BIN map_dlz "logo_map.bin" 2 2 0 DLZ FALSE
+BIN bmp_raw "logo_bmp.bin" 2 2 0 NONE FALSE
+BIN bmp_ap "logo_bmp.bin" 2 2 0 APLIB FALSE
+BIN bmp_lz4w "logo_bmp.bin" 2 2 0 LZ4W FALSE
+BIN bmp_dlz "logo_bmp.bin" 2 2 0 DLZ FALSE
+BIN pcm_raw "snare_pcm.bin" 2 2 0 NONE FALSE
+BIN pcm_ap "snare_pcm.bin" 2 2 0 APLIB FALSE
+BIN pcm_lz4w "snare_pcm.bin" 2 2 0 LZ4W FALSE
+BIN pcm_dlz "snare_pcm.bin" 2 2 0 DLZ FALSE
@@ -0,0 +1,4 @@
+WAV snd_pcm "explode.wav" 0 16000
+WAV snd_adpcm "explode.wav" 1
+WAV snd_pcm4 "explode.wav" 2
+WAV snd_xgm "explode.wav" 5
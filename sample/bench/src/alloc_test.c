@@ -0,0 +1,450 @@
+#include <genesis.h>
+
+#include "main.h"
+
+
+// trace operations
+#define OP_ALLOC            0
+#define OP_FREE             1
+// release everything (level end)
+#define OP_RESET            2
+
+#define MAX_OP              512
+#define MAX_SLOT            48
+
+// pool object size (biggest sprite churn allocation) and capacity
+#define POOL_OBJ_SIZE       96
+#define POOL_CAPACITY       32
+
+// 68000 cycles per scanline
+#define CYCLES_PER_LINE     488
+
+
+typedef struct
+{
+    u8 type;
+    u8 slot;
+    u16 size;
+} TraceOp;
+
+typedef struct
+{
+    u32 ticks;
+    u16 numOp;
+    u16 peak;
+    u16 minLargest;
+    u16 fails;
+} TraceStat;
+
+
+// forward
+static u16 genLevelTrace(TraceOp* ops);
+static u16 genChurnTrace(TraceOp* ops);
+static u16 genDecompTrace(TraceOp* ops);
+static TraceOp* addOp(TraceOp* op, u16 type, u16 slot, u16 size);
+static void replayMem(const TraceOp* ops, u16 num, TraceStat* stat);
+static void replayVRam(const TraceOp* ops, u16 num, TraceStat* stat);
+static void replayPool(const TraceOp* ops, u16 num, TraceStat* stat);
+static void replayArena(const TraceOp* ops, u16 num, TraceStat* stat);
+static void initStat(TraceStat* stat);
+static void updateStat(TraceStat* stat, u16 used, u16 largest);
+static u16 displayResult(const char* trace, const char* allocator, TraceStat* stat, u16 y);
+
+
+static TraceOp trace[MAX_OP];
+static void* ptrs[MAX_SLOT];
+static s16 vramIndexes[MAX_SLOT];
+
+
+u16 executeAllocTraceTest(u16 *scores)
+{
+    TraceStat stat;
+    u16 num;
+    u16 y;
+    u16 *score;
+    u16 globalScore;
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing allocator trace tests...", 1, y++);
+    y++;
+    VDP_drawText("trace  alloc cyc/op  peak minLF fail", 1, y++);
+
+    // level loads: level data, temporary decompression buffer, released on level end
+    num = genLevelTrace(trace);
+    replayMem(trace, num, &stat);
+    *score = displayResult("level", "MEM", &stat, y++);
+    globalScore += *score++;
+    replayArena(trace, num, &stat);
+    *score = displayResult("level", "ARENA", &stat, y++);
+    globalScore += *score++;
+    replayVRam(trace, num, &stat);
+    *score = displayResult("level", "VRAM", &stat, y++);
+    globalScore += *score++;
+    y++;
+
+    // sprite churn: small object alloc / release in random order
+    num = genChurnTrace(trace);
+    replayMem(trace, num, &stat);
+    *score = displayResult("sprite", "MEM", &stat, y++);
+    globalScore += *score++;
+    replayPool(trace, num, &stat);
+    *score = displayResult("sprite", "POOL", &stat, y++);
+    globalScore += *score++;
+    replayVRam(trace, num, &stat);
+    *score = displayResult("sprite", "VRAM", &stat, y++);
+    globalScore += *score++;
+    y++;
+
+    // big temporary buffers interleaved with persistent small allocations
+    num = genDecompTrace(trace);
+    replayMem(trace, num, &stat);
+    *score = displayResult("unpack", "MEM", &stat, y++);
+    globalScore += *score++;
+    replayVRam(trace, num, &stat);
+    *score = displayResult("unpack", "VRAM", &stat, y++);
+    globalScore += *score++;
+    y++;
+
+    VDP_drawText("peak / minLF (min largest free block)", 1, y++);
+    VDP_drawText("in bytes (VRAM in tiles)", 1, y++);
+    VDP_drawText("score = 100000 / cycles per op", 1, y + 1);
+
+    BENCH_WAIT(5000);
+
+    VDP_clearPlane(BG_A, TRUE);
+
+    return globalScore;
+}
+
+
+static TraceOp* addOp(TraceOp* op, u16 type, u16 slot, u16 size)
+{
+    op->type = type;
+    op->slot = slot;
+    op->size = size;
+
+    return op + 1;
+}
+
+static u16 genLevelTrace(TraceOp* ops)
+{
+    TraceOp* op = ops;
+    u16 level, i;
+
+    // always the same trace
+    setRandomSeed(0x1234);
+
+    for(level = 0; level < 3; level++)
+    {
+        const u16 num = 20 + (level * 2);
+
+        for(i = 0; i < num; i++)
+        {
+            // level data (map, tileset, object tables...)
+            op = addOp(op, OP_ALLOC, i, 32 + ((random() % 32) * 32));
+
+            // temporary decompression buffer, released once data is unpacked
+            if ((i % 5) == 0)
+            {
+                op = addOp(op, OP_ALLOC, MAX_SLOT - 1, 1024);
+                op = addOp(op, OP_ALLOC, ++i, 32 + ((random() % 8) * 32));
+                op = addOp(op, OP_FREE, MAX_SLOT - 1, 0);
+            }
+        }
+
+        // level end
+        op = addOp(op, OP_RESET, 0, 0);
+    }
+
+    return op - ops;
+}
+
+static u16 genChurnTrace(TraceOp* ops)
+{
+    bool used[POOL_CAPACITY];
+    TraceOp* op = ops;
+    u16 i;
+
+    setRandomSeed(0x5678);
+    memset(used, 0, sizeof(used));
+
+    // initial sprites
+    for(i = 0; i < 24; i++)
+    {
+        op = addOp(op, OP_ALLOC, i, 16 + ((random() % 6) * 16));
+        used[i] = TRUE;
+    }
+
+    // sprites released / created in random order
+    for(i = 0; i < 384; i++)
+    {
+        const u16 slot = random() % POOL_CAPACITY;
+
+        if (used[slot]) op = addOp(op, OP_FREE, slot, 0);
+        else op = addOp(op, OP_ALLOC, slot, 16 + ((random() % 6) * 16));
+        used[slot] = !used[slot];
+    }
+
+    op = addOp(op, OP_RESET, 0, 0);
+
+    return op - ops;
+}
+
+static u16 genDecompTrace(TraceOp* ops)
+{
+    bool used[MAX_SLOT];
+    TraceOp* op = ops;
+    u16 slot;
+    u16 i, j;
+
+    setRandomSeed(0x9ABC);
+    memset(used, 0, sizeof(used));
+
+    slot = 1;
+    for(i = 0; i < 48; i++)
+    {
+        // temporary unpack buffer (slot 0)
+        op = addOp(op, OP_ALLOC, 0, 1024 + ((random() % 4) * 1024));
+
+        // persistent allocations done while buffer is alive
+        for(j = 0; j < 3; j++)
+        {
+            if (used[slot]) op = addOp(op, OP_FREE, slot, 0);
+            op = addOp(op, OP_ALLOC, slot, 16 + ((random() % 16) * 16));
+            used[slot] = TRUE;
+
+            // random slot reuse so persistent blocks are released in a different order
+            slot = 1 + (random() % (MAX_SLOT - 1));
+        }
+
+        op = addOp(op, OP_FREE, 0, 0);
+    }
+
+    op = addOp(op, OP_RESET, 0, 0);
+
+    return op - ops;
+}
+
+
+static void replayMem(const TraceOp* ops, u16 num, TraceStat* stat)
+{
+    const u16 base = MEM_getAllocated();
+    const TraceOp* op = ops;
+    u16 i, j;
+
+    initStat(stat);
+    memset(ptrs, 0, sizeof(ptrs));
+
+    for(i = 0; i < num; i++, op++)
+    {
+        u32 t;
+
+        t = getHVTick();
+        switch(op->type)
+        {
+            case OP_ALLOC:
+                ptrs[op->slot] = MEM_alloc(op->size);
+                if (!ptrs[op->slot]) stat->fails++;
+                stat->numOp++;
+                break;
+
+            case OP_FREE:
+                if (ptrs[op->slot]) MEM_free(ptrs[op->slot]);
+                ptrs[op->slot] = NULL;
+                stat->numOp++;
+                break;
+
+            case OP_RESET:
+                for(j = 0; j < MAX_SLOT; j++)
+                {
+                    if (ptrs[j])
+                    {
+                        MEM_free(ptrs[j]);
+                        ptrs[j] = NULL;
+                        stat->numOp++;
+                    }
+                }
+                break;
+        }
+        stat->ticks += getHVTick() - t;
+
+        updateStat(stat, MEM_getAllocated() - base, MEM_getLargestFreeBlock());
+    }
+}
+
+static void replayVRam(const TraceOp* ops, u16 num, TraceStat* stat)
+{
+    VRAMRegion region;
+    const TraceOp* op = ops;
+    u16 i, j;
+
+    // same region as VRAM alloc test
+    VRAM_createRegion(&region, 16, 1000);
+
+    initStat(stat);
+    for(i = 0; i < MAX_SLOT; i++) vramIndexes[i] = -1;
+
+    for(i = 0; i < num; i++, op++)
+    {
+        u32 t;
+
+        t = getHVTick();
+        switch(op->type)
+        {
+            case OP_ALLOC:
+                // bytes to tiles
+                vramIndexes[op->slot] = VRAM_alloc(&region, (op->size + 31) >> 5);
+                if (vramIndexes[op->slot] < 0) stat->fails++;
+                stat->numOp++;
+                break;
+
+            case OP_FREE:
+                if (vramIndexes[op->slot] >= 0) VRAM_free(&region, vramIndexes[op->slot]);
+                vramIndexes[op->slot] = -1;
+                stat->numOp++;
+                break;
+
+            case OP_RESET:
+                for(j = 0; j < MAX_SLOT; j++)
+                {
+                    if (vramIndexes[j] >= 0)
+                    {
+                        VRAM_free(&region, vramIndexes[j]);
+                        vramIndexes[j] = -1;
+                        stat->numOp++;
+                    }
+                }
+                break;
+        }
+        stat->ticks += getHVTick() - t;
+
+        updateStat(stat, VRAM_getAllocated(&region), VRAM_getLargestFreeBlock(&region));
+    }
+
+    VRAM_releaseRegion(&region);
+}
+
+static void replayPool(const TraceOp* ops, u16 num, TraceStat* stat)
+{
+    Pool* pool = POOL_create(POOL_CAPACITY, POOL_OBJ_SIZE);
+    const TraceOp* op = ops;
+    u16 i, j;
+
+    initStat(stat);
+    memset(ptrs, 0, sizeof(ptrs));
+
+    for(i = 0; i < num; i++, op++)
+    {
+        u32 t;
+
+        t = getHVTick();
+        switch(op->type)
+        {
+            case OP_ALLOC:
+                ptrs[op->slot] = POOL_allocate(pool);
+                if (!ptrs[op->slot]) stat->fails++;
+                stat->numOp++;
+                break;
+
+            case OP_FREE:
+                if (ptrs[op->slot]) POOL_release(pool, ptrs[op->slot], FALSE);
+                ptrs[op->slot] = NULL;
+                stat->numOp++;
+                break;
+
+            case OP_RESET:
+                for(j = 0; j < MAX_SLOT; j++)
+                {
+                    if (ptrs[j])
+                    {
+                        POOL_release(pool, ptrs[j], FALSE);
+                        ptrs[j] = NULL;
+                        stat->numOp++;
+                    }
+                }
+                break;
+        }
+        stat->ticks += getHVTick() - t;
+
+        // pool doesn't fragment: largest free block is the object size as long as the pool isn't full
+        updateStat(stat, POOL_getNumAllocated(pool) * POOL_OBJ_SIZE, POOL_getFree(pool) ? POOL_OBJ_SIZE : 0);
+    }
+
+    POOL_destroy(pool);
+}
+
+static void replayArena(const TraceOp* ops, u16 num, TraceStat* stat)
+{
+    // keep some heap for the others allocations
+    const u16 size = min(32768, MEM_getLargestFreeBlock() - 1024);
+    Arena* arena = ARENA_create(size);
+    const TraceOp* op = ops;
+    u16 i;
+
+    initStat(stat);
+
+    for(i = 0; i < num; i++, op++)
+    {
+        u32 t;
+
+        t = getHVTick();
+        switch(op->type)
+        {
+            case OP_ALLOC:
+                if (!ARENA_alloc(arena, op->size)) stat->fails++;
+                stat->numOp++;
+                break;
+
+            case OP_FREE:
+                // arena can't release single allocation (temporary buffer remains until reset)
+                break;
+
+            case OP_RESET:
+                ARENA_reset(arena);
+                stat->numOp++;
+                break;
+        }
+        stat->ticks += getHVTick() - t;
+
+        updateStat(stat, size - ARENA_getFree(arena), ARENA_getFree(arena));
+    }
+
+    ARENA_destroy(arena);
+}
+
+
+static void initStat(TraceStat* stat)
+{
+    stat->ticks = 0;
+    stat->numOp = 0;
+    stat->peak = 0;
+    stat->minLargest = 0xFFFF;
+    stat->fails = 0;
+}
+
+static void updateStat(TraceStat* stat, u16 used, u16 largest)
+{
+    if (used > stat->peak) stat->peak = used;
+    if (largest < stat->minLargest) stat->minLargest = largest;
+}
+
+static u16 displayResult(const char* trace, const char* allocator, TraceStat* stat, u16 y)
+{
+    char str[48];
+    u32 cycles;
+
+    cycles = (stat->ticks * CYCLES_PER_LINE) / (getHVTickPerLine() * stat->numOp);
+
+    sprintf(str, "%-6s %-5s %6lu %5u %5u %4u", trace, allocator, cycles, stat->peak, stat->minLargest, stat->fails);
+
+    // display test string
+    VDP_drawText(str, 1, y);
+
+    // keep test score in range
+    if (cycles < 10) return 10000;
+
+    return 100000 / cycles;
+}
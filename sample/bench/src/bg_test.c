@@ -75,7 +75,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     VDP_clearPlane(BG_A, TRUE);
     VDP_drawText("Draw/clear text...", 2, 0);
@@ -139,7 +139,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     // Image draw test
     pos = xy;
@@ -191,7 +191,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     VDP_clearPlane(BG_A, TRUE);
     VDP_drawText("128x64 image draw (packed fast)", 2, 0);
@@ -233,7 +233,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     // unpack image
     img = unpackImage(&logo_med, NULL);
@@ -278,7 +278,7 @@ u16 executeBGTest(u16 *scores)
     MEM_free(img);
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     // unpack image
     img = unpackImage(&logo_med, NULL);
@@ -325,7 +325,7 @@ u16 executeBGTest(u16 *scores)
     MEM_free(img);
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     pos = xy;
     for(i = 0; i < 1000; i++)
@@ -377,7 +377,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     VDP_clearPlane(BG_A, TRUE);
     VDP_drawText("64x32 image draw (packed fast)", 2, 0);
@@ -420,7 +420,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     // unpack image
     img = unpackImage(&logo_sm, NULL);
@@ -466,7 +466,7 @@ u16 executeBGTest(u16 *scores)
     MEM_free(img);
 
     // wait 5 seconds
-    waitMs(5000);
+    BENCH_WAIT(5000);
 
     // unpack image
     img = unpackImage(&logo_sm, NULL);
@@ -513,7 +513,7 @@ u16 executeBGTest(u16 *scores)
     globalScore += *score++;
     MEM_free(img);
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(xy);
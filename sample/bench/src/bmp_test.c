@@ -83,7 +83,7 @@ u16 executeBMPTest(u16 *scores)
 
     VDP_clearPlane(BG_A, TRUE);
     VDP_drawText("Bitmap buffer clear", 2, 1);
-    waitMs(3000);
+    BENCH_WAIT(3000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -99,7 +99,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("Pixel draw safe (with clipping)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -152,7 +152,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("Pixel draw fast (without clipping)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -205,7 +205,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("Pixel draw array safe (with clip.)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -231,7 +231,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("Pixel draw array fast (without clip.)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -258,7 +258,7 @@ u16 executeBMPTest(u16 *scores)
 
 
     VDP_drawText("Line draw safe (with clipping)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -312,7 +312,7 @@ u16 executeBMPTest(u16 *scores)
 
 
     VDP_drawText("Line draw fast (without clip.)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -356,7 +356,7 @@ u16 executeBMPTest(u16 *scores)
 
 
     VDP_drawText("Polygon draw", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     BMP_init(TRUE, BG_A, PAL1, FALSE);
@@ -389,7 +389,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("128x64 image draw (packed slow)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     PAL_setPalette(PAL1, logo_med_bmp.palette->data, CPU);
@@ -430,7 +430,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("128x64 image draw (packed fast)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     PAL_setPalette(PAL1, logo_med_bmp.palette->data, CPU);
@@ -471,7 +471,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("128x64 image draw (unpacked)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     // unpack bitmap
@@ -515,7 +515,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("64x32 image draw (packed slow)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     PAL_setPalette(PAL1, logo_sm_bmp.palette->data, CPU);
@@ -556,7 +556,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("64x32 image draw (packed fast)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     PAL_setPalette(PAL1, logo_sm_bmp.palette->data, CPU);
@@ -597,7 +597,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("64x32 image draw (unpacked)", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     // unpack bitmap
@@ -641,7 +641,7 @@ u16 executeBMPTest(u16 *scores)
     globalScore += *score++;
 
     VDP_drawText("128x64 image scaling", 2, 8);
-    waitMs(4000);
+    BENCH_WAIT(4000);
     VDP_clearPlane(BG_A, TRUE);
 
     // unpack bitmap
@@ -683,7 +683,7 @@ u16 executeBMPTest(u16 *scores)
     *score = displayResult(2 * 2 * (128-32), time, 3) * 10;
     globalScore += *score++;
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(polys);
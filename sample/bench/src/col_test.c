@@ -0,0 +1,222 @@
+#include <genesis.h>
+
+#include "main.h"
+
+
+#define MAX_BODY            96
+#define MAX_PAIR            256
+// number of measured step per point
+#define COL_STEP            8
+// number of body count points
+#define NUM_COUNT           4
+
+// 68000 cycles per scanline
+#define CYCLES_PER_LINE     488
+
+// layers (player shots hit enemies, enemies hit player)
+#define LAYER_SHOT          1
+#define LAYER_ENEMY         2
+#define LAYER_PLAYER        4
+
+
+typedef struct
+{
+    s16 x;
+    s16 y;
+    s16 vx;
+    s16 vy;
+    u16 size;
+} TestBody;
+
+
+// forward
+static void initBodies(u16 num);
+static void addBodies(u16 num, u16 step);
+static u16 naivePairs(u16 num);
+static void doColTest(u16 num, u32* naiveCycles, u32* sweepCycles, u16* naiveCount, u16* sweepCount);
+static u16 getScore(u32 cycles);
+static void displayResult(u16 num, u32 naiveCycles, u32 sweepCycles, u16 naiveCount, u16 sweepCount, u16 y);
+
+
+static TestBody testBodies[MAX_BODY];
+static ColBody* colBodies[MAX_BODY];
+static ColPair pairs[MAX_PAIR];
+
+
+u16 executeCollisionTest(u16 *scores)
+{
+    static const u16 counts[NUM_COUNT] = { 16, 32, 64, 96 };
+    u32 naiveCycles;
+    u32 sweepCycles;
+    u16 naiveCount;
+    u16 sweepCount;
+    u16 c;
+    u16 y;
+    u16 *score;
+    u16 globalScore;
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing collision tests...", 1, y++);
+    VDP_drawText("cycles per query (pairs found)", 1, y++);
+    y++;
+    VDP_drawText("num  naive       sweep        x", 1, y++);
+
+    COL_init(MAX_BODY);
+
+    for(c = 0; c < NUM_COUNT; c++)
+    {
+        // same bodies for all runs
+        setRandomSeed(0x1234 + c);
+        initBodies(counts[c]);
+
+        doColTest(counts[c], &naiveCycles, &sweepCycles, &naiveCount, &sweepCount);
+        displayResult(counts[c], naiveCycles, sweepCycles, naiveCount, sweepCount, y++);
+
+        *score = getScore(sweepCycles);
+        globalScore += *score++ / 4;
+        // speed up against naive loop (x100)
+        *score = (naiveCycles * 100) / sweepCycles;
+        score++;
+    }
+
+    COL_end();
+
+    y++;
+    VDP_drawText("naive = all pairs layer + shape test", 1, y++);
+    VDP_drawText("sweep = COL_getPairs(..)", 1, y++);
+    VDP_drawText("x = speed up (ERR = pair mismatch)", 1, y++);
+    VDP_drawText("score = 10000000 / sweep cycles", 1, y + 1);
+
+    BENCH_WAIT(5000);
+
+    VDP_clearPlane(BG_A, TRUE);
+
+    return globalScore;
+}
+
+
+static void initBodies(u16 num)
+{
+    TestBody* b = testBodies;
+
+    for(u16 i = 0; i < num; i++, b++)
+    {
+        b->x = random() % 320;
+        b->y = random() % 224;
+        b->vx = (random() & 7) - 4;
+        b->vy = (random() & 7) - 4;
+        b->size = 8 + (random() & 15);
+    }
+}
+
+// (re)build collision bodies for the given step (bodies move on each step)
+static void addBodies(u16 num, u16 step)
+{
+    const TestBody* b = testBodies;
+
+    COL_clear();
+
+    for(u16 i = 0; i < num; i++, b++)
+    {
+        const s16 x = b->x + (b->vx * step);
+        const s16 y = b->y + (b->vy * step);
+        u16 layer, mask;
+
+        // 1 player, 1/4 player shots, enemies
+        if (i == 0)
+        {
+            layer = LAYER_PLAYER;
+            mask = LAYER_ENEMY;
+        }
+        else if ((i & 3) == 0)
+        {
+            layer = LAYER_SHOT;
+            mask = LAYER_ENEMY;
+        }
+        else
+        {
+            layer = LAYER_ENEMY;
+            mask = 0;
+        }
+
+        // half boxes, half circles
+        if (i & 1) colBodies[i] = COL_addCircle(x, y, b->size >> 1, layer, mask, NULL);
+        else colBodies[i] = COL_addBox(x, y, b->size, b->size, layer, mask, NULL);
+    }
+}
+
+// reference O(n2) pair loop
+static u16 naivePairs(u16 num)
+{
+    u16 res = 0;
+
+    for(u16 i = 0; i < num; i++)
+    {
+        const ColBody* a = colBodies[i];
+
+        for(u16 j = i + 1; j < num; j++)
+        {
+            const ColBody* b = colBodies[j];
+
+            if (((a->mask & b->layer) || (b->mask & a->layer)) && COL_testBodies(a, b)) res++;
+        }
+    }
+
+    return res;
+}
+
+static void doColTest(u16 num, u32* naiveCycles, u32* sweepCycles, u16* naiveCount, u16* sweepCount)
+{
+    u32 naiveTicks;
+    u32 sweepTicks;
+    u16 s;
+
+    naiveTicks = 0;
+    sweepTicks = 0;
+    *naiveCount = 0;
+    *sweepCount = 0;
+
+    for(s = 0; s < COL_STEP; s++)
+    {
+        u32 t;
+
+        addBodies(num, s);
+
+        t = getHVTick();
+        *naiveCount += naivePairs(num);
+        naiveTicks += getHVTick() - t;
+
+        t = getHVTick();
+        *sweepCount += COL_getPairs(pairs, MAX_PAIR);
+        sweepTicks += getHVTick() - t;
+    }
+
+    *naiveCycles = (naiveTicks * CYCLES_PER_LINE) / (getHVTickPerLine() * COL_STEP);
+    *sweepCycles = (sweepTicks * CYCLES_PER_LINE) / (getHVTickPerLine() * COL_STEP);
+    if (*sweepCycles == 0) *sweepCycles = 1;
+}
+
+static u16 getScore(u32 cycles)
+{
+    // keep test score in range
+    if (cycles < 1000) return 10000;
+
+    return 10000000 / cycles;
+}
+
+static void displayResult(u16 num, u32 naiveCycles, u32 sweepCycles, u16 naiveCount, u16 sweepCount, u16 y)
+{
+    char str[48];
+    const u16 speedup = (naiveCycles * 10) / sweepCycles;
+
+    if (naiveCount != sweepCount)
+        sprintf(str, "%3u %6lu(%3u) %6lu(%3u) ERR", num, naiveCycles, naiveCount, sweepCycles, sweepCount);
+    else
+        sprintf(str, "%3u %6lu(%3u) %6lu(%3u) %2u.%u", num, naiveCycles, naiveCount, sweepCycles, sweepCount, speedup / 10, speedup % 10);
+
+    // display test string
+    VDP_drawText(str, 1, y);
+}
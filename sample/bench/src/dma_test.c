@@ -0,0 +1,322 @@
+#include <genesis.h>
+
+#include "main.h"
+
+
+// DMA buffer size (in byte)
+#define DMA_BUF_SIZE        8192
+// transfer size for VBlank tests (in byte), should fit in VBlank (H32 NTSC ~ 6 KB)
+#define VBLANK_SIZE         4096
+// number of frame for VBlank tests
+#define VBLANK_FRAME        32
+
+
+// forward
+static u32 displayResult(u32 bytes, fix32 time, u16 y);
+static u32 displayResultOp(u32 op, fix32 time, u16 y);
+static u32 displayResultVBlank(u32 value, const char* unit, u16 y);
+static u32 doVBlankDmaTest(u16* buffer);
+static u32 doVBlankFlushTest(void);
+static void vintCB(void);
+
+
+// HV tick at VBlank start (set by VInt callback)
+static vu32 vintTick;
+
+
+u16 executeDMATest(u16 *scores)
+{
+    fix32 start;
+    fix32 end;
+    u16 i, j;
+    u16 y;
+    u32 n;
+    u16 *buffer;
+    u16 *score;
+    u16 globalScore;
+    u16 vramAddr;
+    u16 maxQueue;
+
+    buffer = MEM_alloc(DMA_BUF_SIZE);
+    memset(buffer, 0, DMA_BUF_SIZE);
+    // safe location (user tiles area isn't used by text)
+    vramAddr = TILE_USER;
+    maxQueue = DMA_getMaxQueueSize();
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing DMA tests...", 1, y++);
+    VDP_drawText(IS_PAL_SYSTEM ? "PAL system" : "NTSC system", 2, y++);
+    y++;
+
+    VDP_drawText("200 x full queue (DMA_queueDma)", 2, y++);
+    i = 200;
+    n = 0;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        // each entry goes to a different address so they can't be merged
+        for(j = 0; j < maxQueue; j++)
+            if (DMA_queueDma(DMA_VRAM, buffer, vramAddr + (j * 64), 16, 2)) n++;
+        DMA_clearQueue();
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResultOp(n, end - start, y++);
+    globalScore += *score++;
+
+    VDP_drawText("200 x full queue (DMA_queueDmaFast)", 2, y++);
+    i = 200;
+    n = 0;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        for(j = 0; j < maxQueue; j++)
+            if (DMA_queueDmaFast(DMA_VRAM, buffer, vramAddr + (j * 64), 16, 2)) n++;
+        DMA_clearQueue();
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResultOp(n, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    // display off for raw bandwidth (text is visible once display is enabled again)
+    VDP_drawText("Display off tests...", 2, y++);
+    SYS_doVBlankProcess();
+    VDP_setEnable(FALSE);
+
+    VDP_drawText("200 x 8KB VRAM H40", 2, y++);
+    i = 200;
+    start = getTimeAsFix32(FALSE);
+    while(i--) DMA_doDma(DMA_VRAM, buffer, vramAddr, DMA_BUF_SIZE / 2, 2);
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(200 * DMA_BUF_SIZE, end - start, y++) / 8;
+    globalScore += *score++;
+
+    VDP_drawText("200 x 8KB VRAM H32", 2, y++);
+    VDP_setScreenWidth256();
+    i = 200;
+    start = getTimeAsFix32(FALSE);
+    while(i--) DMA_doDma(DMA_VRAM, buffer, vramAddr, DMA_BUF_SIZE / 2, 2);
+    end = getTimeAsFix32(FALSE);
+    VDP_setScreenWidth320();
+    *score = displayResult(200 * DMA_BUF_SIZE, end - start, y++) / 8;
+    globalScore += *score++;
+
+    VDP_drawText("4000 x 128B CRAM", 2, y++);
+    i = 4000;
+    start = getTimeAsFix32(FALSE);
+    while(i--) DMA_doDma(DMA_CRAM, buffer, 0, 64, 2);
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(4000 * 128, end - start, y++) / 8;
+    globalScore += *score++;
+
+    VDP_drawText("4000 x 80B VSRAM", 2, y++);
+    i = 4000;
+    start = getTimeAsFix32(FALSE);
+    while(i--) DMA_doDma(DMA_VSRAM, buffer, 0, 40, 2);
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(4000 * 80, end - start, y++) / 8;
+    globalScore += *score++;
+
+    VDP_drawText("200 x 8KB VRAM fill", 2, y++);
+    i = 200;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        DMA_doVRamFill(vramAddr, DMA_BUF_SIZE, 0, 1);
+        DMA_waitCompletion();
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(200 * DMA_BUF_SIZE, end - start, y++) / 8;
+    globalScore += *score++;
+
+    VDP_drawText("200 x 8KB VRAM copy", 2, y++);
+    i = 200;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        DMA_doVRamCopy(vramAddr, vramAddr + DMA_BUF_SIZE, DMA_BUF_SIZE, 1);
+        DMA_waitCompletion();
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(200 * DMA_BUF_SIZE, end - start, y++) / 8;
+    globalScore += *score++;
+
+    // Z80 BUS is requested / released around each DMA (HALT_Z80_ON_DMA)
+    VDP_drawText("4000 x 256B VRAM (Z80 BUS request)", 2, y++);
+    i = 4000;
+    start = getTimeAsFix32(FALSE);
+    while(i--) DMA_doDma(DMA_VRAM, buffer, vramAddr, 128, 2);
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(4000 * 256, end - start, y++) / 8;
+    globalScore += *score++;
+
+    // Z80 BUS already taken --> no request
+    VDP_drawText("4000 x 256B VRAM (Z80 BUS kept)", 2, y++);
+    Z80_requestBus(TRUE);
+    i = 4000;
+    start = getTimeAsFix32(FALSE);
+    while(i--) DMA_doDma(DMA_VRAM, buffer, vramAddr, 128, 2);
+    end = getTimeAsFix32(FALSE);
+    Z80_releaseBus();
+    *score = displayResult(4000 * 256, end - start, y++) / 8;
+    globalScore += *score++;
+
+    VDP_setEnable(TRUE);
+    // restore palette (CRAM test)
+    PAL_setColor(15, 0xEEE);
+    BENCH_WAIT(5000);
+    VDP_clearPlane(BG_A, TRUE);
+    y = 1;
+
+    VDP_drawText("VRAM bytes per VBlank (H40)", 2, y++);
+    *score = displayResultVBlank(doVBlankDmaTest(buffer), "bytes per VBlank", y++) / 8;
+    globalScore += *score++;
+
+    VDP_drawText("VRAM bytes per VBlank (H32)", 2, y++);
+    VDP_setScreenWidth256();
+    *score = displayResultVBlank(doVBlankDmaTest(buffer), "bytes per VBlank", y++) / 8;
+    VDP_setScreenWidth320();
+    globalScore += *score++;
+    y++;
+
+    // VBlank queue flush with XGM driver loaded (Z80 BUS protection and optional delay)
+    Z80_loadDriver(Z80_DRIVER_XGM, TRUE);
+
+    VDP_drawText("4KB queue flush (XGM, no delay)", 2, y++);
+    XGM_setForceDelayDMA(FALSE);
+    *score = displayResultVBlank(doVBlankFlushTest(), "bytes per scanline", y++);
+    globalScore += *score++;
+
+    VDP_drawText("4KB queue flush (XGM, force delay)", 2, y++);
+    XGM_setForceDelayDMA(TRUE);
+    *score = displayResultVBlank(doVBlankFlushTest(), "bytes per scanline", y++);
+    globalScore += *score++;
+
+    XGM_setForceDelayDMA(FALSE);
+    Z80_unloadDriver();
+
+    BENCH_WAIT(5000);
+    VDP_clearPlane(BG_A, TRUE);
+
+    MEM_free(buffer);
+
+    return globalScore;
+}
+
+
+// returns VRAM bytes transferable in a single VBlank (measured with display enabled)
+static u32 doVBlankDmaTest(u16* buffer)
+{
+    const u32 vblankLines = (IS_PAL_SYSTEM ? 313 : 262) - screenHeight;
+    u32 ticks;
+    u16 i;
+
+    ticks = 0;
+    i = VBLANK_FRAME;
+    while(i--)
+    {
+        u32 t;
+
+        VDP_waitVSync();
+        t = getHVTick();
+        DMA_doDma(DMA_VRAM, buffer, TILE_USER, VBLANK_SIZE / 2, 2);
+        ticks += getHVTick() - t;
+    }
+
+    // bytes per VBlank = bytes per tick * VBlank ticks
+    return ((u32) VBLANK_SIZE * VBLANK_FRAME * vblankLines * getHVTickPerLine()) / ticks;
+}
+
+// returns VBlank process throughput (bytes per scanline) for a queued VRAM transfer
+static u32 doVBlankFlushTest(void)
+{
+    u32 ticks;
+    u16 i;
+
+    SYS_setVIntCallback(vintCB);
+
+    ticks = 0;
+    i = VBLANK_FRAME;
+    while(i--)
+    {
+        DMA_queueDma(DMA_VRAM, (void*) 0, TILE_USER, VBLANK_SIZE / 2, 2);
+        SYS_doVBlankProcess();
+        ticks += getHVTick() - vintTick;
+    }
+
+    SYS_setVIntCallback(NULL);
+
+    return ((u32) VBLANK_SIZE * VBLANK_FRAME * getHVTickPerLine()) / ticks;
+}
+
+static void vintCB(void)
+{
+    vintTick = getHVTick();
+}
+
+static u32 displayResult(u32 bytes, fix32 time, u16 y)
+{
+    char timeStr[32];
+    char speedStr[32];
+    char str[64];
+    fix32 speedKb;
+
+    fix32ToStr(time, timeStr, 2);
+    speedKb = intToFix32(bytes / 4096);
+    // get speed in Kb/s
+    speedKb = fix32Div(speedKb, time);
+    // put it in speedStr
+    fix32ToStr(speedKb * 4, speedStr, 2);
+
+    strcpy(str, "Elapsed time = ");
+    strcat(str, timeStr);
+    strcat(str, "s (");
+    strcat(str, speedStr);
+    strcat(str, " Kb/s)");
+
+    // display test string
+    VDP_drawText(str, 3, y);
+
+    return fix32ToInt(speedKb * 4);
+}
+
+static u32 displayResultOp(u32 op, fix32 time, u16 y)
+{
+    char timeStr[32];
+    char speedStr[32];
+    char str[64];
+    fix32 speedKop;
+
+    fix32ToStr(time, timeStr, 2);
+    speedKop = intToFix32(op / 1024);
+    // get speed in Kop/s (queued entry per second)
+    speedKop = fix32Div(speedKop, time);
+    // put it in speedStr
+    fix32ToStr(speedKop, speedStr, 2);
+
+    strcpy(str, "Elapsed time = ");
+    strcat(str, timeStr);
+    strcat(str, "s (");
+    strcat(str, speedStr);
+    strcat(str, " Kop/s)");
+
+    // display test string
+    VDP_drawText(str, 3, y);
+
+    return fix32ToInt(speedKop * 16);
+}
+
+static u32 displayResultVBlank(u32 value, const char* unit, u16 y)
+{
+    char str[64];
+
+    sprintf(str, "%lu %s", value, unit);
+
+    // display test string
+    VDP_drawText(str, 3, y);
+
+    return value;
+}
@@ -1,13 +1,20 @@
 #include <genesis.h>
+#include <kdebug.h>
 
+#include "main.h"
 #include "gfx.h"
 
 
 #define SGDK_BENCHMARK      "SGDK benchmark v1.4"
 
-#define MAX_TEST            9
+#define MAX_TEST            18
 #define MAX_SUBTEST         16
 
+// headless result record (SRAM and KDebug log), see tools/benchcmp
+#define RESULT_MAGIC        0x5347424E
+#define RESULT_VERSION      1
+#define RESULT_SRAM_OFFSET  0
+
 
 // end of bss
 extern u32 _bend;
@@ -17,6 +24,20 @@ u16 detailledScores[MAX_TEST][MAX_SUBTEST];
 u16 scores[MAX_TEST];
 
 
+// headless result record (stored as is in SRAM, big endian)
+typedef struct
+{
+    u32 magic;
+    u16 version;
+    u16 numTest;
+    u16 numSubTest;
+    u16 checksum;
+    u32 globalScore;
+    u16 scores[MAX_TEST];
+    u16 detailledScores[MAX_TEST][MAX_SUBTEST];
+} BenchResult;
+
+
 // extern
 u16 executeMemsetTest(u16 *scores);
 u16 executeMemcpyTest(u16 *scores);
@@ -24,9 +45,18 @@ u16 executeMemAllocTest(u16 *scores);
 u16 executeVRamAllocTest(u16 *scores);
 u16 executeMathsBasicTest(u16 *scores);
 u16 executeMathsAdvTest(u16 *scores);
+u16 executeMathsFuncTest(u16 *scores);
 u16 executeBGTest(u16 *scores);
 u16 executeBMPTest(u16 *scores);
 u16 executeSpritesTest(u16 *scores);
+u16 executeSortTest(u16 *scores);
+u16 executeDMATest(u16 *scores);
+u16 executeMapTest(u16 *scores);
+u16 executeSpriteScaleTest(u16 *scores);
+u16 executePackTest(u16 *scores);
+u16 executeSoundTest(u16 *scores);
+u16 executeAllocTraceTest(u16 *scores);
+u16 executeCollisionTest(u16 *scores);
 
 
 // forward
@@ -34,6 +64,7 @@ static void showIntroScreen();
 static void preTest(char *title, s16 num);
 static void postTest(char *title, u16 score, s16 num);
 static void postResume(u32 score);
+static void saveResult(u32 score);
 
 
 int main()
@@ -94,6 +125,13 @@ int main()
         globalScore += score;
         testNum++;
 
+        preTest("Maths functions test", testNum);
+        score = executeMathsFuncTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Maths functions test", score, testNum);
+        globalScore += score;
+        testNum++;
+
         preTest("VDP background test", testNum);
         score = executeBGTest(detailledScores[testNum]);
         scores[testNum] = score;
@@ -115,8 +153,71 @@ int main()
         globalScore += score;
         testNum++;
 
+        preTest("Sort test", testNum);
+        score = executeSortTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Sort test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("DMA test", testNum);
+        score = executeDMATest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("DMA test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("Map scroll test", testNum);
+        score = executeMapTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Map scroll test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("Sprite scaling test", testNum);
+        score = executeSpriteScaleTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Sprite scaling test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("Unpack test", testNum);
+        score = executePackTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Unpack test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("Sound driver test", testNum);
+        score = executeSoundTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Sound driver test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("Allocator trace test", testNum);
+        score = executeAllocTraceTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Allocator trace test", score, testNum);
+        globalScore += score;
+        testNum++;
+
+        preTest("Collision test", testNum);
+        score = executeCollisionTest(detailledScores[testNum]);
+        scores[testNum] = score;
+        postTest("Collision test", score, testNum);
+        globalScore += score;
+        testNum++;
+
         postResume(globalScore);
 
+#if (BENCH_HEADLESS != 0)
+        saveResult(globalScore);
+        // stop emulator (Gens KMod) or just stay on result screen
+        KDebug_Halt();
+        while(TRUE) SYS_doVBlankProcess();
+#endif
+
         JOY_waitPress(JOY_1, BUTTON_START);
         // fade text
         PAL_fadeOut(15, 15, 30, FALSE);
@@ -156,12 +257,19 @@ static void showIntroScreen()
 
     // display test string
     VDP_drawText(SGDK_BENCHMARK, 10, 14);
+
+#if (BENCH_HEADLESS != 0)
+    VDP_drawText("Headless mode", 10, 16);
+#else
     VDP_drawText("Press START to begin", 10, 16);
+#endif
 
     // fade text color to white
     PAL_fadeIn(15, 15, &col, 30, FALSE);
     // wait for Start button pressed
+#if (BENCH_HEADLESS == 0)
     JOY_waitPress(JOY_1, BUTTON_START);
+#endif
     // fade text
     PAL_fadeOut(15, 15, 30, FALSE);
     // clear text
@@ -187,7 +295,7 @@ static void preTest(char *title, s16 num)
     // fade text color to white
     PAL_fadeIn(15, 15, &col, 30, FALSE);
     // wait 3s
-    waitMs(3000);
+    BENCH_WAIT(3000);
     // fade text
     PAL_fadeOut(15, 15, 30, FALSE);
     // clear text
@@ -215,7 +323,7 @@ static void postTest(char *title, u16 score, s16 num)
     // fade text color to white
     PAL_fadeIn(15, 15, &col, 30, FALSE);
     // wait 5s
-    waitMs(5000);
+    BENCH_WAIT(5000);
     // fade text
     PAL_fadeOut(15, 15, 30, FALSE);
     // clear text
@@ -240,36 +348,104 @@ static void postResume(u32 score)
     VDP_drawText(str, 1, 1);
 
     testNum = 0;
-    y = 4;
+    y = 3;
     sprintf(str, "Memory set score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "Memory copy score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "Memory alloc/release score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "VRAM alloc/release score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "Maths basic score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "Maths advanced score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
+    sprintf(str, "Maths functions score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
     sprintf(str, "VDP background score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "Bitmap mode score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
-    y += 2;
+    y++;
     sprintf(str, "Sprite mode score = %d", scores[testNum++]);
     VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Sort score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "DMA score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Map scroll score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Sprite scaling score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Unpack score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Sound driver score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Allocator trace score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
+    y++;
+    sprintf(str, "Collision score = %d", scores[testNum++]);
+    VDP_drawText(str, 4, y);
 
-    VDP_drawText(" PRESS START TO RESTART ALL TESTS", 1, 24);
+    VDP_drawText(" PRESS START TO RESTART ALL TESTS", 1, 27);
 
     // fade text color to white
     PAL_fadeIn(15, 15, &col, 30, FALSE);
 }
+
+static void saveResult(u32 score)
+{
+    char str[128];
+    BenchResult result;
+    const u16* src;
+    u16 checksum;
+    u16 i, j;
+
+    memset(&result, 0, sizeof(result));
+    result.magic = RESULT_MAGIC;
+    result.version = RESULT_VERSION;
+    result.numTest = MAX_TEST;
+    result.numSubTest = MAX_SUBTEST;
+    result.globalScore = score;
+    memcpy(result.scores, scores, sizeof(scores));
+    memcpy(result.detailledScores, detailledScores, sizeof(detailledScores));
+
+    // checksum = sum of all words following the checksum field
+    checksum = 0;
+    src = (const u16*) &result.globalScore;
+    i = ((const u8*) (&result + 1) - (const u8*) src) / 2;
+    while(i--) checksum += *src++;
+    result.checksum = checksum;
+
+    SRAM_enable();
+    SRAM_write(RESULT_SRAM_OFFSET, &result, sizeof(result));
+    SRAM_disable();
+
+    // KDebug log: one line per test (test index, score and sub test scores)
+    sprintf(str, "#BENCH %d %d %d %lu", RESULT_VERSION, MAX_TEST, MAX_SUBTEST, score);
+    KDebug_Alert(str);
+    for(i = 0; i < MAX_TEST; i++)
+    {
+        char* dst = str;
+
+        dst += sprintf(dst, "#BENCH T%d %d", i, scores[i]);
+        for(j = 0; j < MAX_SUBTEST; j++) dst += sprintf(dst, " %d", detailledScores[i][j]);
+        KDebug_Alert(str);
+    }
+}
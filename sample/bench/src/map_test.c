@@ -0,0 +1,283 @@
+#include <genesis.h>
+
+#include "main.h"
+
+
+// map size in block (128x128 pixels block, power of 2 for wrapping)
+#define MAP_W               64
+#define MAP_H               16
+// number of unique block (blocks content doesn't change the decoding cost)
+#define MAP_NUM_BLOCK       16
+// number of tile used by metatiles
+#define MAP_NUM_TILE        16
+// number of frame per scroll test
+#define MAP_FRAME           32
+// number of teleport (full redraw)
+#define MAP_TELEPORT        8
+
+// 68000 cycles per scanline
+#define CYCLES_PER_LINE     488
+
+
+// forward
+static MapDefinition* createMapDefinition(bool mti16, bool bi16);
+static void releaseMapDefinition(MapDefinition* mapDef);
+static u32 doScroll(Map* map, s16 dx, s16 dy, u32* prepCycles);
+static u32 doTeleport(Map* map, u32* prepCycles);
+static void prepareColumnCB(Map *map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height);
+static void prepareRowCB(Map *map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width);
+static u16 getScore(u32 cycles);
+static void displayResult(char* title, u32* cycles, u16 y);
+
+
+// original prepare callbacks (wrapped to measure their time)
+static void (*prepareColumn)(Map *map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height);
+static void (*prepareRow)(Map *map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width);
+// time spent in prepare callbacks (in HV tick)
+static u32 prepTicks;
+
+
+u16 executeMapTest(u16 *scores)
+{
+    // H speeds, V speeds, diagonal
+    static const s16 speeds[] = { 1, 4, 16 };
+    static char* const names[4] = { "MTI8 BI8", "MTI8 BI16", "MTI16 BI8", "MTI16 BI16" };
+    u32 update[4];
+    u32 prep[4];
+    u32 prepCycles;
+    u16 f, i;
+    u16 y;
+    u16 *score;
+    u16 globalScore;
+
+    score = scores;
+    globalScore = 0;
+
+    // some tiles so the map is visible
+    for(i = 0; i < MAP_NUM_TILE; i++)
+        VDP_fillTileData((i << 4) | i, TILE_USER_INDEX + i, 1, TRUE);
+
+    y = 0;
+    VDP_drawText("Executing map scroll tests...", 1, y++);
+    VDP_drawText("cycles per frame: H, V, diagonal, teleport", 1, y++);
+    y++;
+
+    for(f = 0; f < 4; f++)
+    {
+        MapDefinition* mapDef = createMapDefinition(f & 2, f & 1);
+        Map* map;
+
+        VDP_drawText(names[f], 2, y++);
+
+        map = MAP_create(mapDef, BG_B, TILE_ATTR_FULL(PAL0, FALSE, FALSE, FALSE, TILE_USER_INDEX));
+        // wrap prepare callbacks
+        prepareColumn = map->prepareMapDataColumnCB;
+        prepareRow = map->prepareMapDataRowCB;
+        map->prepareMapDataColumnCB = prepareColumnCB;
+        map->prepareMapDataRowCB = prepareRowCB;
+
+        // initial draw
+        MAP_scrollTo(map, 0, 256);
+        SYS_doVBlankProcess();
+
+        // horizontal (1 to 16 px per frame)
+        update[0] = 0;
+        prep[0] = 0;
+        for(i = 0; i < 3; i++)
+        {
+            update[0] += doScroll(map, speeds[i], 0, &prepCycles) / 3;
+            prep[0] += prepCycles / 3;
+        }
+        // vertical (1 to 16 px per frame)
+        update[1] = 0;
+        prep[1] = 0;
+        for(i = 0; i < 3; i++)
+        {
+            update[1] += doScroll(map, 0, speeds[i], &prepCycles) / 3;
+            prep[1] += prepCycles / 3;
+        }
+        // diagonal
+        update[2] = doScroll(map, 8, 8, &prep[2]);
+        // teleport with forced redraw
+        update[3] = doTeleport(map, &prep[3]);
+
+        MAP_release(map);
+        releaseMapDefinition(mapDef);
+
+        displayResult("update", update, y++);
+        displayResult("prepare", prep, y++);
+
+        for(i = 0; i < 4; i++)
+        {
+            *score = getScore(update[i]);
+            globalScore += *score++ / 4;
+        }
+    }
+
+    VDP_drawText("score = 10000000 / update cycles", 1, y + 1);
+
+    BENCH_WAIT(5000);
+
+    VDP_clearPlane(BG_B, TRUE);
+    VDP_setHorizontalScroll(BG_B, 0);
+    VDP_setVerticalScroll(BG_B, 0);
+    VDP_clearPlane(BG_A, TRUE);
+
+    return globalScore;
+}
+
+
+static MapDefinition* createMapDefinition(bool mti16, bool bi16)
+{
+    MapDefinition* result = MEM_alloc(sizeof(MapDefinition));
+    const u16 numMetaTile = mti16 ? 512 : 256;
+    u16* metaTiles;
+    u16 i;
+
+    result->w = MAP_W;
+    result->h = MAP_H;
+    result->hp = MAP_H;
+    result->compression = COMPRESSION_NONE;
+    result->numMetaTile = numMetaTile;
+    // block index width only depends on number of block: declare more than 256 blocks to get 16 bit indexes
+    // (only MAP_NUM_BLOCK blocks are really used and allocated)
+    result->numBlock = bi16 ? 512 : MAP_NUM_BLOCK;
+
+    metaTiles = MEM_alloc(numMetaTile * 4 * 2);
+    for(i = 0; i < numMetaTile * 4; i++)
+    {
+        // some flipped tiles
+        metaTiles[i] = (random() % MAP_NUM_TILE) | ((i & 0x10) ? TILE_ATTR_HFLIP_MASK : 0);
+    }
+    result->metaTiles = metaTiles;
+
+    if (mti16)
+    {
+        u16* blocks = MEM_alloc(MAP_NUM_BLOCK * 64 * 2);
+        for(i = 0; i < MAP_NUM_BLOCK * 64; i++) blocks[i] = random() % numMetaTile;
+        result->blocks = blocks;
+    }
+    else
+    {
+        u8* blocks = MEM_alloc(MAP_NUM_BLOCK * 64);
+        for(i = 0; i < MAP_NUM_BLOCK * 64; i++) blocks[i] = random() % numMetaTile;
+        result->blocks = blocks;
+    }
+
+    if (bi16)
+    {
+        u16* blockIndexes = MEM_alloc(MAP_W * MAP_H * 2);
+        for(i = 0; i < MAP_W * MAP_H; i++) blockIndexes[i] = random() % MAP_NUM_BLOCK;
+        result->blockIndexes = blockIndexes;
+    }
+    else
+    {
+        u8* blockIndexes = MEM_alloc(MAP_W * MAP_H);
+        for(i = 0; i < MAP_W * MAP_H; i++) blockIndexes[i] = random() % MAP_NUM_BLOCK;
+        result->blockIndexes = blockIndexes;
+    }
+
+    result->blockRowOffsets = MEM_alloc(MAP_H * 2);
+    for(i = 0; i < MAP_H; i++) result->blockRowOffsets[i] = i * MAP_W;
+
+    return result;
+}
+
+static void releaseMapDefinition(MapDefinition* mapDef)
+{
+    MEM_free(mapDef->blockRowOffsets);
+    MEM_free(mapDef->blockIndexes);
+    MEM_free(mapDef->blocks);
+    MEM_free(mapDef->metaTiles);
+    MEM_free(mapDef);
+}
+
+// returns average MAP_scrollTo(..) cycles per frame (prepare callbacks cycles in prepCycles)
+static u32 doScroll(Map* map, s16 dx, s16 dy, u32* prepCycles)
+{
+    u32 x = map->posX;
+    u32 y = map->posY;
+    u32 ticks;
+    u16 i;
+
+    ticks = 0;
+    prepTicks = 0;
+    i = MAP_FRAME;
+    while(i--)
+    {
+        u32 t;
+
+        x += dx;
+        y += dy;
+
+        t = getHVTick();
+        MAP_scrollTo(map, x, y);
+        ticks += getHVTick() - t;
+
+        SYS_doVBlankProcess();
+    }
+
+    *prepCycles = (prepTicks * CYCLES_PER_LINE) / (getHVTickPerLine() * MAP_FRAME);
+
+    return (ticks * CYCLES_PER_LINE) / (getHVTickPerLine() * MAP_FRAME);
+}
+
+static u32 doTeleport(Map* map, u32* prepCycles)
+{
+    u32 ticks;
+    u16 i;
+
+    ticks = 0;
+    prepTicks = 0;
+    i = MAP_TELEPORT;
+    while(i--)
+    {
+        const u32 x = random() % ((MAP_W * 128) - 320);
+        const u32 y = random() % ((MAP_H * 128) - 224);
+        u32 t;
+
+        t = getHVTick();
+        MAP_scrollToEx(map, x, y, TRUE);
+        ticks += getHVTick() - t;
+
+        SYS_doVBlankProcess();
+    }
+
+    *prepCycles = (prepTicks * CYCLES_PER_LINE) / (getHVTickPerLine() * MAP_TELEPORT);
+
+    return (ticks * CYCLES_PER_LINE) / (getHVTickPerLine() * MAP_TELEPORT);
+}
+
+static void prepareColumnCB(Map *map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height)
+{
+    const u32 t = getHVTick();
+
+    prepareColumn(map, bufCol1, bufCol2, xm, ym, height);
+    prepTicks += getHVTick() - t;
+}
+
+static void prepareRowCB(Map *map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width)
+{
+    const u32 t = getHVTick();
+
+    prepareRow(map, bufRow1, bufRow2, xm, ym, width);
+    prepTicks += getHVTick() - t;
+}
+
+static u16 getScore(u32 cycles)
+{
+    // keep test score in range
+    if (cycles < 1000) return 10000;
+
+    return 10000000 / cycles;
+}
+
+static void displayResult(char* title, u32* cycles, u16 y)
+{
+    char str[40];
+
+    sprintf(str, "%-8s %6lu %6lu %6lu %6lu", title, cycles[0], cycles[1], cycles[2], cycles[3]);
+
+    // display test string
+    VDP_drawText(str, 3, y);
+}
@@ -390,7 +390,7 @@ u16 executeMathsBasicTest(u16 *scores)
     y++;
 
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(buffer);
@@ -631,7 +631,7 @@ u16 executeMathsAdvTest(u16 *scores)
     y++;
 
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(src_3D);
@@ -642,6 +642,125 @@ u16 executeMathsAdvTest(u16 *scores)
 }
 
 
+u16 executeMathsFuncTest(u16 *scores)
+{
+    char str[40];
+    fix32 start;
+    fix32 end;
+    u16 i;
+    u16 y;
+    u16 acc;        // results accumulator so calls aren't optimized away
+    u16 *score;
+    u16 globalScore;
+    u16 maxErr;
+    V2f16 *vects;
+
+    vects = MEM_alloc(1024 * sizeof(V2f16));
+
+    // random vectors (fix16 range)
+    for(i = 0; i < 1024; i++)
+    {
+        vects[i].x = (random() & 0x3FFF) - 0x2000;
+        vects[i].y = (random() & 0x3FFF) - 0x2000;
+    }
+
+    score = scores;
+    globalScore = 0;
+    acc = 0;
+
+    y = 0;
+    VDP_drawText("Executing maths functions tests...", 1, y++);
+    y++;
+
+    VDP_drawText("20480 atan2 (interpolated table)", 2, y++);
+    i = 20;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        for(u16 j = 0; j < 1024; j++)
+            acc += fix16Atan2(vects[j].y, vects[j].x);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(20480, end - start, y++, acc);
+    globalScore += *score++;
+
+    // accuracy: angle of (cos(a), sin(a)) should give back a
+    maxErr = 0;
+    for(i = 0; i < 1024; i++)
+    {
+        s16 err = (fix32Atan2(sinFix32(i), cosFix32(i)) - i) & 1023;
+
+        if (err > 512) err = 1024 - err;
+        if (err > maxErr) maxErr = err;
+    }
+    sprintf(str, "Max error = %d / 1024", maxErr);
+    VDP_drawText(str, 3, y++);
+    y++;
+
+    VDP_drawText("20480 exact distance (fix16Dist)", 2, y++);
+    i = 20;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        for(u16 j = 0; j < 1024; j++)
+            acc += fix16Dist(vects[j].x, vects[j].y);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(20480, end - start, y++, acc);
+    globalScore += *score++;
+    y++;
+
+    VDP_drawText("20480 approx. distance (octagonal)", 2, y++);
+    i = 20;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        for(u16 j = 0; j < 1024; j++)
+            acc += fix16ApproxDist(vects[j].x, vects[j].y);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(20480, end - start, y++, acc);
+    globalScore += *score++;
+
+    // accuracy against exact distance (in 1/1000)
+    maxErr = 0;
+    for(i = 0; i < 1024; i++)
+    {
+        const s16 ref = fix16Dist(vects[i].x, vects[i].y);
+        const s16 err = abs(fix16ApproxDist(vects[i].x, vects[i].y) - ref);
+
+        if (ref > 64)
+        {
+            const u16 e = divu(mulu(err, 1000), ref);
+            if (e > maxErr) maxErr = e;
+        }
+    }
+    sprintf(str, "Max error = %d / 1000", maxErr);
+    VDP_drawText(str, 3, y++);
+    y++;
+
+    VDP_drawText("20480 sqrt (getSqrtInt)", 2, y++);
+    i = 20;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        for(u16 j = 0; j < 1024; j++)
+            acc += getSqrtInt(muls(vects[j].x, vects[j].y) & 0x7FFFFFFF);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(20480, end - start, y++, acc);
+    globalScore += *score++;
+    y++;
+
+    BENCH_WAIT(5000);
+    VDP_clearPlane(BG_A, TRUE);
+
+    MEM_free(vects);
+
+    return globalScore;
+}
+
+
 static u32 displayResult(u32 op, fix32 time, u16 y, u32 dirty)
 {
     char timeStr[32];
@@ -102,7 +102,7 @@ u16 executeMemsetTest(u16 *scores)
     globalScore += *score++;
     y++;
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(buffer);
@@ -208,7 +208,7 @@ u16 executeMemcpyTest(u16 *scores)
     globalScore += *score++;
     y++;
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(buffer);
@@ -382,7 +382,7 @@ u16 executeMemAllocTest(u16 *scores)
     globalScore += *score++;
     y++;
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(allocs);
@@ -593,7 +593,7 @@ u16 executeVRamAllocTest(u16 *scores)
     globalScore += *score++;
     y++;
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     VDP_clearPlane(BG_A, TRUE);
 
     MEM_free(allocs);
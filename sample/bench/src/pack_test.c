@@ -0,0 +1,130 @@
+#include <genesis.h>
+
+#include "main.h"
+#include "pack_res.h"
+
+
+// number of data type and codec (memcpy + APLIB, LZ4W, DLZ)
+#define NUM_DATA            4
+#define NUM_CODEC           4
+// number of unpack per measure
+#define PACK_ITER           4
+// destination buffer size (biggest raw data)
+#define PACK_BUF_SIZE       8192
+
+// 68000 cycles per scanline
+#define CYCLES_PER_LINE     488
+
+
+typedef struct
+{
+    const char* name;
+    const u8* data[NUM_CODEC];
+    u16 size[NUM_CODEC];
+} PackData;
+
+
+// forward
+static u32 doUnpack(u16 codec, const PackData* data, u8* dest);
+static void displayResult(const PackData* data, u16 codec, u32 bytesPerFrame, u16 y);
+
+
+static const char* const codecNames[NUM_CODEC] = { "NONE", "APLIB", "LZ4W", "DLZ" };
+static const u16 codecs[NUM_CODEC] = { COMPRESSION_NONE, COMPRESSION_APLIB, COMPRESSION_LZ4W, COMPRESSION_DLZ };
+
+// data[0] is raw data, rescomp keeps raw data when compression isn't valuable (packed size = raw size)
+static const PackData packDatas[NUM_DATA] =
+{
+    { "tiles", { tiles_raw, tiles_ap, tiles_lz4w, tiles_dlz }, { sizeof(tiles_raw), sizeof(tiles_ap), sizeof(tiles_lz4w), sizeof(tiles_dlz) } },
+    { "map", { map_raw, map_ap, map_lz4w, map_dlz }, { sizeof(map_raw), sizeof(map_ap), sizeof(map_lz4w), sizeof(map_dlz) } },
+    { "bitmap", { bmp_raw, bmp_ap, bmp_lz4w, bmp_dlz }, { sizeof(bmp_raw), sizeof(bmp_ap), sizeof(bmp_lz4w), sizeof(bmp_dlz) } },
+    { "pcm", { pcm_raw, pcm_ap, pcm_lz4w, pcm_dlz }, { sizeof(pcm_raw), sizeof(pcm_ap), sizeof(pcm_lz4w), sizeof(pcm_dlz) } }
+};
+
+
+u16 executePackTest(u16 *scores)
+{
+    u16 d, c;
+    u16 y;
+    u8 *buffer;
+    u16 *score;
+    u16 globalScore;
+
+    buffer = MEM_alloc(PACK_BUF_SIZE);
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing unpack tests...", 1, y++);
+    VDP_drawText("data   codec   size ratio bytes/frame", 1, y++);
+
+    for(d = 0; d < NUM_DATA; d++)
+    {
+        const PackData* data = &packDatas[d];
+
+        for(c = 0; c < NUM_CODEC; c++)
+        {
+            u32 bytesPerFrame;
+
+            // not packed by rescomp (compression not valuable) --> no measure
+            if ((c != 0) && (data->size[c] >= data->size[0])) bytesPerFrame = 0;
+            else bytesPerFrame = doUnpack(c, data, buffer);
+
+            displayResult(data, c, bytesPerFrame, y++);
+
+            *score = bytesPerFrame / 8;
+            globalScore += *score++ / 4;
+        }
+    }
+
+    VDP_drawText("score = bytes per frame / 8", 1, y + 1);
+
+    BENCH_WAIT(5000);
+
+    VDP_clearPlane(BG_A, TRUE);
+
+    MEM_free(buffer);
+
+    return globalScore;
+}
+
+
+// returns unpacked bytes per frame
+static u32 doUnpack(u16 codec, const PackData* data, u8* dest)
+{
+    const u32 frameCycles = (IS_PAL_SYSTEM ? 313 : 262) * CYCLES_PER_LINE;
+    const u16 size = data->size[0];
+    u32 ticks;
+    u32 cycles;
+    u16 i;
+
+    ticks = getHVTick();
+    i = PACK_ITER;
+    while(i--)
+    {
+        // memcpy is the reference
+        if (codec == 0) memcpy(dest, data->data[0], size);
+        else unpack(codecs[codec], (u8*) data->data[codec], dest);
+    }
+    ticks = getHVTick() - ticks;
+
+    cycles = (ticks * CYCLES_PER_LINE) / (getHVTickPerLine() * PACK_ITER);
+    if (cycles == 0) cycles = 1;
+
+    return ((u32) size * frameCycles) / cycles;
+}
+
+static void displayResult(const PackData* data, u16 codec, u32 bytesPerFrame, u16 y)
+{
+    char str[48];
+    const u16 size = data->size[codec];
+
+    if (bytesPerFrame == 0)
+        sprintf(str, "%-6s %-5s not packed", data->name, codecNames[codec]);
+    else
+        sprintf(str, "%-6s %-5s %6u %4u%% %6lu", data->name, codecNames[codec], size, (u16) (((u32) size * 100) / data->size[0]), bytesPerFrame);
+
+    // display test string
+    VDP_drawText(str, 1, y);
+}
@@ -0,0 +1,327 @@
+#include <genesis.h>
+
+#include "main.h"
+#include "snd_res.h"
+
+
+// tested drivers (Z80_DRIVER_NULL is the reference)
+#define NUM_DRIVER          4
+// compute workload: number of pass over ROM data
+#define COMPUTE_PASS        16
+// DMA workload: number of 8 KB transfer (display off)
+#define DMA_PASS            32
+#define DMA_BUF_SIZE        8192
+// DMA load per frame during playback test (in byte)
+#define DMA_FRAME_SIZE      16384
+// Z80 load not reported by the driver (PCM driver)
+#define LOAD_NA             0xFFFFFFFF
+
+
+// forward
+static void startSound(u16 driver, bool loop);
+static void stopSound(u16 driver);
+static bool isPlaying(u16 driver);
+static u32 doCompute(void);
+static u32 doDma(u16* buffer);
+static u32 doPlayback(u16 driver, u16* buffer, bool dmaLoad, u32* z80Load);
+static u32 getZ80Load(u16 driver);
+static u16 getRatio(u32 ref, u32 value);
+static void displayResult(const char* name, u16* values, u32 z80Load, u16 y);
+
+
+static const char* const driverNames[NUM_DRIVER] = { "PCM", "2ADPCM", "4PCM", "XGM" };
+static const u16 drivers[NUM_DRIVER] = { Z80_DRIVER_PCM, Z80_DRIVER_2ADPCM, Z80_DRIVER_4PCM, Z80_DRIVER_XGM };
+
+// workload checksum (so compiler can't remove it)
+static u32 checksum;
+
+
+u16 executeSoundTest(u16 *scores)
+{
+    u32 refCompute;
+    u32 refDma;
+    u32 z80Load;
+    u16 values[3];
+    u16 d;
+    u16 y;
+    u16 *buffer;
+    u16 *score;
+    u16 globalScore;
+
+    buffer = MEM_alloc(DMA_BUF_SIZE);
+    memset(buffer, 0, DMA_BUF_SIZE);
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing sound driver tests...", 1, y++);
+    VDP_drawText("throughput in % (100 = no loss)", 1, y++);
+    y++;
+    VDP_drawText("driver   68K   DMA  play  Z80", 2, y++);
+
+    // reference (Z80 idle)
+    Z80_loadDriver(Z80_DRIVER_NULL, TRUE);
+    refCompute = doCompute();
+    SYS_doVBlankProcess();
+    VDP_setEnable(FALSE);
+    refDma = doDma(buffer);
+    VDP_setEnable(TRUE);
+
+    for(d = 0; d < NUM_DRIVER; d++)
+    {
+        const u16 driver = drivers[d];
+        u32 idleFrames;
+        u32 loadFrames;
+
+        Z80_loadDriver(driver, TRUE);
+
+        // 68K compute and DMA workloads while playing (looped sample)
+        startSound(driver, TRUE);
+        values[0] = getRatio(refCompute, doCompute());
+        SYS_doVBlankProcess();
+        VDP_setEnable(FALSE);
+        values[1] = getRatio(refDma, doDma(buffer));
+        VDP_setEnable(TRUE);
+        stopSound(driver);
+        SYS_doVBlankProcess();
+
+        // playback duration without then with DMA load (Z80 is halted during DMA)
+        idleFrames = doPlayback(driver, buffer, FALSE, &z80Load);
+        loadFrames = doPlayback(driver, buffer, TRUE, &z80Load);
+        values[2] = getRatio(idleFrames, loadFrames);
+
+        displayResult(driverNames[d], values, z80Load, y++);
+
+        *score = values[0];
+        globalScore += *score++ / 8;
+        *score = values[1];
+        globalScore += *score++ / 8;
+        *score = values[2];
+        globalScore += *score++ / 8;
+    }
+
+    Z80_loadDriver(Z80_DRIVER_DEFAULT, TRUE);
+
+    y++;
+    VDP_drawText("68K = compute workload", 1, y++);
+    VDP_drawText("DMA = display off DMA workload", 1, y++);
+    VDP_drawText("play = PCM speed under DMA load", 1, y++);
+    VDP_drawText("Z80 = XGM driver load % (DMA wait)", 1, y++);
+    VDP_drawText("score = throughput in 0.01%", 1, y + 1);
+
+    BENCH_WAIT(5000);
+
+    VDP_clearPlane(BG_A, TRUE);
+
+    MEM_free(buffer);
+
+    return globalScore;
+}
+
+
+static void startSound(u16 driver, bool loop)
+{
+    switch(driver)
+    {
+        case Z80_DRIVER_PCM:
+            SND_startPlay_PCM(snd_pcm, sizeof(snd_pcm), SOUND_RATE_16000, SOUND_PAN_CENTER, loop);
+            break;
+
+        case Z80_DRIVER_2ADPCM:
+            SND_startPlay_2ADPCM(snd_adpcm, sizeof(snd_adpcm), SOUND_PCM_CH1, loop);
+            SND_startPlay_2ADPCM(snd_adpcm, sizeof(snd_adpcm), SOUND_PCM_CH2, loop);
+            break;
+
+        case Z80_DRIVER_4PCM:
+            SND_startPlay_4PCM(snd_pcm4, sizeof(snd_pcm4), SOUND_PCM_CH1, loop);
+            SND_startPlay_4PCM(snd_pcm4, sizeof(snd_pcm4), SOUND_PCM_CH2, loop);
+            SND_startPlay_4PCM(snd_pcm4, sizeof(snd_pcm4), SOUND_PCM_CH3, loop);
+            SND_startPlay_4PCM(snd_pcm4, sizeof(snd_pcm4), SOUND_PCM_CH4, loop);
+            break;
+
+        case Z80_DRIVER_XGM:
+            // XGM doesn't support PCM loop, we just use the 4 channels
+            XGM_setPCM(64, snd_xgm, sizeof(snd_xgm));
+            XGM_startPlayPCM(64, 1, SOUND_PCM_CH1);
+            XGM_startPlayPCM(64, 1, SOUND_PCM_CH2);
+            XGM_startPlayPCM(64, 1, SOUND_PCM_CH3);
+            XGM_startPlayPCM(64, 1, SOUND_PCM_CH4);
+            break;
+    }
+}
+
+static void stopSound(u16 driver)
+{
+    switch(driver)
+    {
+        case Z80_DRIVER_PCM:
+            SND_stopPlay_PCM();
+            break;
+
+        case Z80_DRIVER_2ADPCM:
+            SND_stopPlay_2ADPCM(SOUND_PCM_CH1);
+            SND_stopPlay_2ADPCM(SOUND_PCM_CH2);
+            break;
+
+        case Z80_DRIVER_4PCM:
+            SND_stopPlay_4PCM(SOUND_PCM_CH1);
+            SND_stopPlay_4PCM(SOUND_PCM_CH2);
+            SND_stopPlay_4PCM(SOUND_PCM_CH3);
+            SND_stopPlay_4PCM(SOUND_PCM_CH4);
+            break;
+
+        case Z80_DRIVER_XGM:
+            XGM_stopPlayPCM(SOUND_PCM_CH1);
+            XGM_stopPlayPCM(SOUND_PCM_CH2);
+            XGM_stopPlayPCM(SOUND_PCM_CH3);
+            XGM_stopPlayPCM(SOUND_PCM_CH4);
+            break;
+    }
+}
+
+static bool isPlaying(u16 driver)
+{
+    switch(driver)
+    {
+        case Z80_DRIVER_PCM:
+            return SND_isPlaying_PCM();
+
+        case Z80_DRIVER_2ADPCM:
+            return SND_isPlaying_2ADPCM(SOUND_PCM_CH1_MSK);
+
+        case Z80_DRIVER_4PCM:
+            return SND_isPlaying_4PCM(SOUND_PCM_CH1_MSK);
+
+        case Z80_DRIVER_XGM:
+            return XGM_isPlayingPCM(SOUND_PCM_CH1_MSK);
+    }
+
+    return FALSE;
+}
+
+// returns HV ticks for a fixed bus intensive 68K workload (ROM reads + arithmetic)
+static u32 doCompute()
+{
+    const u32* src;
+    u32 ticks;
+    u32 sum;
+    u16 i, j;
+
+    sum = 0;
+    ticks = getHVTick();
+    for(i = 0; i < COMPUTE_PASS; i++)
+    {
+        src = (const u32*) snd_pcm4;
+        j = 2048;
+        while(j--)
+        {
+            const u32 v = *src++;
+            sum += (v >> 3) ^ (sum << 1);
+        }
+    }
+    ticks = getHVTick() - ticks;
+    checksum += sum;
+
+    return ticks;
+}
+
+// returns HV ticks for a fixed DMA workload (display should be disabled)
+static u32 doDma(u16* buffer)
+{
+    u32 ticks;
+    u16 i;
+
+    ticks = getHVTick();
+    i = DMA_PASS;
+    while(i--) DMA_doDma(DMA_VRAM, buffer, TILE_USER, DMA_BUF_SIZE / 2, 2);
+    ticks = getHVTick() - ticks;
+
+    return ticks;
+}
+
+// returns number of frame to play the reference sample (with optional DMA load)
+static u32 doPlayback(u16 driver, u16* buffer, bool dmaLoad, u32* z80Load)
+{
+    u32 frames;
+    u16 i;
+
+    startSound(driver, FALSE);
+    // let driver start playing
+    for(i = 0; i < 4; i++)
+    {
+        SYS_doVBlankProcess();
+        getZ80Load(driver);
+    }
+
+    frames = 0;
+    // 10 seconds timeout
+    while(isPlaying(driver) && (frames < 600))
+    {
+        if (dmaLoad)
+        {
+            // active display DMA is slow, disable display during transfer
+            VDP_setEnable(FALSE);
+            for(i = 0; i < (DMA_FRAME_SIZE / DMA_BUF_SIZE); i++)
+                DMA_doDma(DMA_VRAM, buffer, TILE_USER, DMA_BUF_SIZE / 2, 2);
+            VDP_setEnable(TRUE);
+        }
+
+        // Z80 load should be read each frame (XGM load is a mean over 32 frames)
+        *z80Load = getZ80Load(driver);
+
+        SYS_doVBlankProcess();
+        frames++;
+    }
+
+    stopSound(driver);
+
+    return frames;
+}
+
+// returns Z80 load reported by the driver (low 16 bits) and DMA wait part (high 16 bits, XGM only)
+static u32 getZ80Load(u16 driver)
+{
+    switch(driver)
+    {
+        case Z80_DRIVER_2ADPCM:
+            return SND_getCPULoad_2ADPCM();
+
+        case Z80_DRIVER_4PCM:
+            return SND_getCPULoad_4PCM();
+
+        case Z80_DRIVER_XGM:
+            return XGM_getCPULoad();
+
+        default:
+            return LOAD_NA;
+    }
+}
+
+// returns ref / value ratio in 0.01% unit (10000 = same)
+static u16 getRatio(u32 ref, u32 value)
+{
+    if (value <= ref) return 10000;
+
+    return (ref * 100) / (value / 100);
+}
+
+static void displayResult(const char* name, u16* values, u32 z80Load, u16 y)
+{
+    char str[48];
+
+    if (z80Load == LOAD_NA)
+        sprintf(str, "%-6s %3u.%u %3u.%u %3u.%u   -", name,
+                values[0] / 100, (values[0] % 100) / 10,
+                values[1] / 100, (values[1] % 100) / 10,
+                values[2] / 100, (values[2] % 100) / 10);
+    else
+        sprintf(str, "%-6s %3u.%u %3u.%u %3u.%u %3u(%u)", name,
+                values[0] / 100, (values[0] % 100) / 10,
+                values[1] / 100, (values[1] % 100) / 10,
+                values[2] / 100, (values[2] % 100) / 10,
+                (u16) (z80Load & 0xFFFF), (u16) (z80Load >> 16));
+
+    // display test string
+    VDP_drawText(str, 2, y);
+}
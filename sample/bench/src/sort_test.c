@@ -0,0 +1,208 @@
+#include <genesis.h>
+
+#include "main.h"
+
+
+#define SORT_LEN        256
+
+
+typedef struct
+{
+    s16 key;
+    u16 index;
+} SortObject;
+
+
+// forward
+static void fillRandom(u16 *keys, SortObject *objs, void **ptrs);
+static void fillNearlySorted(u16 *keys, SortObject *objs, void **ptrs);
+static s16 compareObject(void *o1, void *o2);
+static u32 displayResult(u32 op, fix32 time, u16 y);
+
+
+u16 executeSortTest(u16 *scores)
+{
+    fix32 start;
+    fix32 end;
+    u16 i;
+    u16 y;
+    u16 *keys;
+    u16 *work;
+    SortObject *objs;
+    void **ptrs;
+    void **srcPtrs;
+    void *tmp;
+    u16 *score;
+    u16 globalScore;
+
+    keys = MEM_alloc(SORT_LEN * sizeof(u16));
+    work = MEM_alloc(SORT_LEN * sizeof(u16));
+    objs = MEM_alloc(SORT_LEN * sizeof(SortObject));
+    ptrs = MEM_alloc(SORT_LEN * sizeof(void*));
+    srcPtrs = MEM_alloc(SORT_LEN * sizeof(void*));
+    tmp = MEM_alloc(SORT_LEN * 6);
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing sort tests...", 1, y++);
+    y++;
+
+    fillRandom(keys, objs, srcPtrs);
+
+    VDP_drawText("100 x qsort (callback) 256 random", 2, y++);
+    i = 100;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        memcpy(ptrs, srcPtrs, SORT_LEN * sizeof(void*));
+        qsort(ptrs, SORT_LEN, compareObject);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(100 * SORT_LEN, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    VDP_drawText("100 x qsort_u16 256 random", 2, y++);
+    i = 100;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        memcpy(ptrs, srcPtrs, SORT_LEN * sizeof(void*));
+        memcpy(work, keys, SORT_LEN * sizeof(u16));
+        qsort_u16(work, 0, SORT_LEN - 1);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(100 * SORT_LEN, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    VDP_drawText("100 x radixsort_u16 256 random", 2, y++);
+    i = 100;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        memcpy(ptrs, srcPtrs, SORT_LEN * sizeof(void*));
+        memcpy(work, keys, SORT_LEN * sizeof(u16));
+        radixsort_u16(work, ptrs, SORT_LEN, tmp);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(100 * SORT_LEN, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    VDP_drawText("100 x radixsort_u8 256 random", 2, y++);
+    i = 100;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        memcpy(ptrs, srcPtrs, SORT_LEN * sizeof(void*));
+        memcpy(work, keys, SORT_LEN);
+        radixsort_u8((u8*) work, ptrs, SORT_LEN, tmp);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(100 * SORT_LEN, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    fillNearlySorted(keys, objs, srcPtrs);
+
+    VDP_drawText("100 x qsort (callback) 256 nearly sorted", 2, y++);
+    i = 100;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        memcpy(ptrs, srcPtrs, SORT_LEN * sizeof(void*));
+        qsort(ptrs, SORT_LEN, compareObject);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(100 * SORT_LEN, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    VDP_drawText("100 x insertsort_s16 256 nearly sorted", 2, y++);
+    i = 100;
+    start = getTimeAsFix32(FALSE);
+    while(i--)
+    {
+        memcpy(ptrs, srcPtrs, SORT_LEN * sizeof(void*));
+        memcpy(work, keys, SORT_LEN * sizeof(u16));
+        insertsort_s16((s16*) work, ptrs, SORT_LEN);
+    }
+    end = getTimeAsFix32(FALSE);
+    *score = displayResult(100 * SORT_LEN, end - start, y++);
+    globalScore += *score++;
+    y++;
+
+    BENCH_WAIT(5000);
+    VDP_clearPlane(BG_A, TRUE);
+
+    MEM_free(tmp);
+    MEM_free(srcPtrs);
+    MEM_free(ptrs);
+    MEM_free(objs);
+    MEM_free(work);
+    MEM_free(keys);
+
+    return globalScore;
+}
+
+
+static void fillRandom(u16 *keys, SortObject *objs, void **ptrs)
+{
+    for(u16 i = 0; i < SORT_LEN; i++)
+    {
+        const u16 key = random() & 0x7FFF;
+
+        keys[i] = key;
+        objs[i].key = key;
+        objs[i].index = i;
+        ptrs[i] = &objs[i];
+    }
+}
+
+static void fillNearlySorted(u16 *keys, SortObject *objs, void **ptrs)
+{
+    for(u16 i = 0; i < SORT_LEN; i++)
+    {
+        // mostly increasing with small local disorder (as objects sorted by Y from previous frame)
+        const u16 key = (i * 4) + (random() & 7);
+
+        keys[i] = key;
+        objs[i].key = key;
+        objs[i].index = i;
+        ptrs[i] = &objs[i];
+    }
+}
+
+static s16 compareObject(void *o1, void *o2)
+{
+    return ((SortObject*) o1)->key - ((SortObject*) o2)->key;
+}
+
+static u32 displayResult(u32 op, fix32 time, u16 y)
+{
+    char timeStr[32];
+    char speedStr[32];
+    char str[64];
+    fix32 speedKop;
+
+    fix32ToStr(time, timeStr, 2);
+    speedKop = intToFix32(op / 1024);
+    // get speed in Kop/s (sorted element per second)
+    speedKop = fix32Div(speedKop, time);
+    // put it in speedStr
+    fix32ToStr(speedKop, speedStr, 2);
+
+    strcpy(str, "Elapsed time = ");
+    strcat(str, timeStr);
+    strcat(str, "s (");
+    strcat(str, speedStr);
+    strcat(str, " Kop/s)");
+
+    // display test string
+    VDP_drawText(str, 3, y);
+
+    return fix32ToInt(speedKop);
+}
@@ -0,0 +1,182 @@
+#include <genesis.h>
+
+#include "main.h"
+#include "spr_res.h"
+
+
+#define MAX_SPRITE          80
+// number of measured frame per point
+#define SCALE_FRAME         32
+// number of sprite count points and scenarios
+#define NUM_COUNT           4
+#define NUM_SCENARIO        4
+
+// 68000 cycles per scanline
+#define CYCLES_PER_LINE     488
+
+// scenarios
+#define SCN_STATIC          0
+#define SCN_ANIM            1
+#define SCN_ANIM_PRELOAD    2
+#define SCN_ANIM_DEPTH      3
+
+
+// forward
+static void doScaleTest(u16 numSprite, u16 scenario, u32* cycles, u32* bytes);
+static u16 getScore(u32 cycles);
+static void displayResult(u16 numSprite, u32* values, u16 y);
+
+
+static Sprite* sprites[MAX_SPRITE];
+static u16 tileIndexes[16];
+
+
+u16 executeSpriteScaleTest(u16 *scores)
+{
+    static const u16 counts[NUM_COUNT] = { 1, 20, 40, 80 };
+    u32 cycles[NUM_COUNT][NUM_SCENARIO];
+    u32 bytes[NUM_COUNT][NUM_SCENARIO];
+    u16 c, s;
+    u16 i, ind;
+    u16 y;
+    u16 *score;
+    u16 globalScore;
+
+    score = scores;
+    globalScore = 0;
+
+    y = 0;
+    VDP_drawText("Executing sprite scaling tests...", 1, y++);
+
+    SYS_disableInts();
+    SPR_init();
+    // preload animation tilesets (for preloaded scenario)
+    ind = TILE_USER_INDEX;
+    for(i = 0; i < flare_small.animations[0]->numFrame; i++)
+    {
+        TileSet* tileset = flare_small.animations[0]->frames[i]->tileset;
+
+        VDP_loadTileSet(tileset, ind, TRUE);
+        tileIndexes[i] = ind;
+        ind += tileset->numTile;
+    }
+    PAL_setPalette(PAL1, flare_small.palette->data, CPU);
+    SYS_enableInts();
+
+    for(c = 0; c < NUM_COUNT; c++)
+    {
+        for(s = 0; s < NUM_SCENARIO; s++)
+        {
+            doScaleTest(counts[c], s, &cycles[c][s], &bytes[c][s]);
+
+            *score = getScore(cycles[c][s]);
+            globalScore += *score++ / 4;
+        }
+    }
+
+    SPR_end();
+    VDP_clearPlane(BG_A, TRUE);
+
+    y = 1;
+    VDP_drawText("SPR_update cycles per frame", 1, y++);
+    VDP_drawText("num static  anim  prel depth", 2, y++);
+    for(c = 0; c < NUM_COUNT; c++)
+        displayResult(counts[c], cycles[c], y++);
+    y++;
+    VDP_drawText("DMA bytes per frame", 1, y++);
+    VDP_drawText("num static  anim  prel depth", 2, y++);
+    for(c = 0; c < NUM_COUNT; c++)
+        displayResult(counts[c], bytes[c], y++);
+    y++;
+    VDP_drawText("anim = auto VRAM alloc + upload", 1, y++);
+    VDP_drawText("prel = preloaded tiles", 1, y++);
+    VDP_drawText("depth = anim + 25% setDepth/frame", 1, y++);
+    VDP_drawText("        + AUTO_SLOW visibility", 1, y++);
+    VDP_drawText("score = 10000000 / update cycles", 1, y + 1);
+
+    BENCH_WAIT(5000);
+
+    VDP_clearPlane(BG_A, TRUE);
+
+    return globalScore;
+}
+
+
+// measure average SPR_update() cycles and queued DMA bytes per frame for given point
+static void doScaleTest(u16 numSprite, u16 scenario, u32* cycles, u32* bytes)
+{
+    const u16 flags = SPR_FLAG_AUTO_VISIBILITY | SPR_FLAG_FAST_AUTO_VISIBILITY | SPR_FLAG_AUTO_SPRITE_ALLOC |
+        ((scenario == SCN_ANIM_PRELOAD) ? 0 : (SPR_FLAG_AUTO_VRAM_ALLOC | SPR_FLAG_AUTO_TILE_UPLOAD));
+    u32 ticks;
+    u32 dmaBytes;
+    u16 f, i;
+
+    for(i = 0; i < numSprite; i++)
+    {
+        Sprite* spr = SPR_addSpriteEx(&flare_small, (i * 37) % 304, (i * 23) % 208,
+            TILE_ATTR(PAL1, FALSE, FALSE, FALSE), 0, flags);
+
+        if (scenario == SCN_ANIM_PRELOAD) SPR_setVRAMTileIndex(spr, tileIndexes[0]);
+        else if (scenario == SCN_ANIM_DEPTH) SPR_setVisibility(spr, AUTO_SLOW);
+        sprites[i] = spr;
+    }
+
+    // initial upload (not measured)
+    SPR_update();
+    SYS_doVBlankProcess();
+
+    ticks = 0;
+    dmaBytes = 0;
+    for(f = 0; f < SCALE_FRAME; f++)
+    {
+        u32 t;
+
+        for(i = 0; i < numSprite; i++)
+        {
+            Sprite* spr = sprites[i];
+
+            // small movement so position is always updated
+            SPR_setPosition(spr, ((i * 37) % 304) + (f & 1), (i * 23) % 208);
+
+            if (scenario == SCN_ANIM_PRELOAD)
+                SPR_setVRAMTileIndex(spr, tileIndexes[(f + i) % flare_small.animations[0]->numFrame]);
+            else if (scenario != SCN_STATIC)
+                SPR_nextFrame(spr);
+            // depth churn over 1/4 of the sprites per frame
+            if ((scenario == SCN_ANIM_DEPTH) && (((f + i) & 3) == 0))
+                SPR_setDepth(spr, random() & 0xFF);
+        }
+
+        t = getHVTick();
+        SPR_update();
+        ticks += getHVTick() - t;
+        // data queued by sprite engine (tiles + sprite table)
+        dmaBytes += DMA_getQueueTransferSize();
+
+        SYS_doVBlankProcess();
+    }
+
+    SPR_reset();
+    SYS_doVBlankProcess();
+
+    *cycles = (ticks * CYCLES_PER_LINE) / (getHVTickPerLine() * SCALE_FRAME);
+    *bytes = dmaBytes / SCALE_FRAME;
+}
+
+static u16 getScore(u32 cycles)
+{
+    // keep test score in range
+    if (cycles < 1000) return 10000;
+
+    return 10000000 / cycles;
+}
+
+static void displayResult(u16 numSprite, u32* values, u16 y)
+{
+    char str[40];
+
+    sprintf(str, "%3d %6lu%6lu%6lu%6lu", numSprite, values[0], values[1], values[2], values[3]);
+
+    // display test string
+    VDP_drawText(str, 2, y);
+}
@@ -1,5 +1,6 @@
 #include <genesis.h>
 
+#include "main.h"
 #include "gfx.h"
 #include "spr_res.h"
 
@@ -65,7 +66,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("40 sprites 16x16 (all dynamic)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -104,7 +105,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("40 sprites 16x16 (streamed animation)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -143,7 +144,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("40 sprites 16x16 (preloaded animation)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -196,7 +197,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("80 sprites 16x16 (streamed animation)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -237,7 +238,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("80 sprites 16x16 (preloaded animation)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -290,7 +291,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("40 sprites 32x32 (streamed)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -331,7 +332,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("40 sprites 32x32 (preloaded)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -384,7 +385,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("Donut animation (streamed)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -405,7 +406,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("Donut animation (preloaded)", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -437,7 +438,7 @@ u16 executeSpritesTest(u16 *scores)
     VDP_drawText("Big sprites test...", 1, 2);
     SYS_enableInts();
 
-    waitMs(5000);
+    BENCH_WAIT(5000);
     SYS_disableInts();
     VDP_clearPlane(BG_A, TRUE);
     SYS_enableInts();
@@ -71,7 +71,7 @@ static void fastStarFieldFX()
     }
 
     /* Setup the sprites */
-    SPR_initEx(0);
+    SPR_initWithFlags(0, SPR_ENGINE_FLAG_DEFERRED_DEPTH_SORT);
 
     s = 0;
     for(i = 0; i < MAX_DONUT; i++)
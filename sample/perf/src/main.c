@@ -0,0 +1,246 @@
+#include <genesis.h>
+#include <kdebug.h>
+
+
+// number of measure per routine (lowest one is kept)
+#define PERF_PASS           3
+// 68000 cycles per scanline
+#define CYCLES_PER_LINE     488
+
+#define BUF_SIZE            2048
+
+
+typedef struct
+{
+    const char* name;
+    void (*init)(void);
+    void (*run)(void);
+    void (*end)(void);
+} PerfTest;
+
+
+// forward
+static u32 measure(const PerfTest* test);
+static void initData(void);
+static void initBmp(void);
+static void endBmp(void);
+static void runEmpty(void);
+static void runMemcpy(void);
+static void runFastMemcpy(void);
+static void runMemset(void);
+static void runFix16Mul(void);
+static void runFix16Div(void);
+static void runSinFix16(void);
+static void runRandom(void);
+static void runMemAlloc(void);
+static void runTileMapRect(void);
+static void runLoadTile(void);
+static void runBmpLine(void);
+
+
+// routine list, name is the baseline key so don't rename without updating the baseline file
+static const PerfTest tests[] =
+{
+    { "memcpy_1k", initData, runMemcpy, NULL },
+    { "fastMemcpy_1k", initData, runFastMemcpy, NULL },
+    { "memset_1k", initData, runMemset, NULL },
+    { "fix16Mul_256", initData, runFix16Mul, NULL },
+    { "fix16Div_256", initData, runFix16Div, NULL },
+    { "sinFix16_256", initData, runSinFix16, NULL },
+    { "random_256", initData, runRandom, NULL },
+    { "MEM_alloc_free_32", initData, runMemAlloc, NULL },
+    { "VDP_setTileMapDataRect_40x25", initData, runTileMapRect, NULL },
+    { "VDP_loadTileData_64", initData, runLoadTile, NULL },
+    { "BMP_drawLine_16", initBmp, runBmpLine, endBmp },
+};
+
+static u8* src;
+static u8* dst;
+static vs32 result;
+// measure overhead
+static u32 overhead;
+
+
+int main(bool hard)
+{
+    static const PerfTest empty = { "empty", NULL, runEmpty, NULL };
+    char str[64];
+    u16 i;
+
+    src = MEM_alloc(BUF_SIZE);
+    dst = MEM_alloc(BUF_SIZE);
+
+    VDP_drawText("SGDK routine cycle count", 1, 1);
+
+    overhead = 0;
+    overhead = measure(&empty);
+
+    for(i = 0; i < sizeof(tests) / sizeof(PerfTest); i++)
+    {
+        const PerfTest* test = &tests[i];
+        const u32 cycles = measure(test);
+
+        // parsed by perfcheck tool
+        sprintf(str, "#PERF %s %lu", test->name, cycles);
+        KDebug_Alert(str);
+
+        sprintf(str, "%-28s %7lu", test->name, cycles);
+        VDP_drawText(str, 1, 3 + i);
+    }
+
+    KDebug_Alert("#PERF END");
+    // stop emulator (exit on KDebug halt) or just stay on result screen
+    KDebug_Halt();
+
+    while(TRUE) SYS_doVBlankProcess();
+
+    return 0;
+}
+
+
+// returns lowest 68000 cycles count of test routine (minus measure overhead)
+static u32 measure(const PerfTest* test)
+{
+    u32 best;
+    u16 i;
+
+    best = 0xFFFFFFFF;
+    for(i = 0; i < PERF_PASS; i++)
+    {
+        u32 t;
+        u32 cycles;
+
+        if (test->init) test->init();
+        // start just after VInt so it doesn't interrupt the measure (routines are shorter than a frame)
+        SYS_doVBlankProcess();
+
+        t = getHVTick();
+        test->run();
+        t = getHVTick() - t;
+
+        if (test->end) test->end();
+
+        cycles = (t * CYCLES_PER_LINE) / getHVTickPerLine();
+        if (cycles < best) best = cycles;
+    }
+
+    return (best > overhead) ? (best - overhead) : 0;
+}
+
+
+static void initData()
+{
+    u16 i;
+
+    // always same data
+    setRandomSeed(0x1234);
+    for(i = 0; i < BUF_SIZE; i++) src[i] = random();
+}
+
+static void initBmp()
+{
+    initData();
+    BMP_init(FALSE, BG_A, PAL0, FALSE);
+}
+
+static void endBmp()
+{
+    BMP_end();
+    VDP_clearPlane(BG_A, TRUE);
+    VDP_drawText("SGDK routine cycle count", 1, 1);
+}
+
+static void runEmpty()
+{
+
+}
+
+static void runMemcpy()
+{
+    memcpy(dst, src, 1024);
+}
+
+static void runFastMemcpy()
+{
+    fastMemcpy(dst, src, 1024);
+}
+
+static void runMemset()
+{
+    memset(dst, 0x5A, 1024);
+}
+
+static void runFix16Mul()
+{
+    const fix16* s = (const fix16*) src;
+    fix16 r = 0;
+    u16 i;
+
+    for(i = 0; i < 256; i++) r += fix16Mul(s[i], s[i + 1]);
+    result = r;
+}
+
+static void runFix16Div()
+{
+    const fix16* s = (const fix16*) src;
+    fix16 r = 0;
+    u16 i;
+
+    // avoid division by zero
+    for(i = 0; i < 256; i++) r += fix16Div(s[i] & 0x3FF, s[i + 1] | 1);
+    result = r;
+}
+
+static void runSinFix16()
+{
+    const u16* s = (const u16*) src;
+    fix16 r = 0;
+    u16 i;
+
+    for(i = 0; i < 256; i++) r += sinFix16(s[i]);
+    result = r;
+}
+
+static void runRandom()
+{
+    u16 r = 0;
+    u16 i;
+
+    for(i = 0; i < 256; i++) r ^= random();
+    result = r;
+}
+
+static void runMemAlloc()
+{
+    void* ptrs[32];
+    u16 i;
+
+    for(i = 0; i < 32; i++) ptrs[i] = MEM_alloc(16 + (i * 8));
+    for(i = 0; i < 32; i++) MEM_free(ptrs[i]);
+}
+
+static void runTileMapRect()
+{
+    VDP_setTileMapDataRect(BG_B, (const u16*) src, 0, 0, 40, 25, 40, CPU);
+}
+
+static void runLoadTile()
+{
+    VDP_loadTileData((const u32*) src, TILE_USER_INDEX, 64, CPU);
+}
+
+static void runBmpLine()
+{
+    Line l;
+    u16 i;
+
+    l.col = 0x11;
+    for(i = 0; i < 16; i++)
+    {
+        l.pt1.x = i * 16;
+        l.pt1.y = 0;
+        l.pt2.x = 255 - (i * 16);
+        l.pt2.y = 159;
+        BMP_drawLine(&l);
+    }
+}
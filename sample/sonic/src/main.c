@@ -105,8 +105,8 @@ int main(u16 hard)
     }
 
     // release maps
-    MEM_free(bga);
-    MEM_free(bgb);
+    MAP_release(bga);
+    MAP_release(bgb);
 
     return 0;
 }
@@ -0,0 +1,81 @@
+#include "config.h"
+#include "types.h"
+
+#include "arena.h"
+
+#include "memory.h"
+#include "tools.h"
+
+
+// frame arena (reset on VBlank process)
+Arena* frameArena;
+
+
+Arena* ARENA_create(u16 size)
+{
+    // allocate arena structure and memory at once
+    Arena* result = MEM_alloc(sizeof(Arena) + size);
+
+    // error on allocation --> return NULL
+    if (result == NULL) return NULL;
+
+    result->start = (u8*) (result + 1);
+    result->end = result->start + size;
+    result->current = result->start;
+
+    return result;
+}
+
+void ARENA_destroy(Arena* arena)
+{
+    // was the frame arena ? --> clear it
+    if (frameArena == arena) frameArena = NULL;
+
+    MEM_free(arena);
+}
+
+void* ARENA_alloc(Arena* arena, u16 size)
+{
+    u8* result = arena->current;
+    // 2 bytes aligned
+    u8* next = result + ((size + 1) & 0xFFFE);
+
+    // not enough space left
+    if (next > arena->end)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("ARENA_alloc(", size, ") failed: not enough space left in arena - free = ", ARENA_getFree(arena));
+#endif
+
+        return NULL;
+    }
+
+    arena->current = next;
+
+    return result;
+}
+
+void ARENA_reset(Arena* arena)
+{
+    arena->current = arena->start;
+}
+
+void* ARENA_mark(Arena* arena)
+{
+    return arena->current;
+}
+
+void ARENA_rewind(Arena* arena, void* mark)
+{
+    arena->current = mark;
+}
+
+u16 ARENA_getFree(Arena* arena)
+{
+    return arena->end - arena->current;
+}
+
+void ARENA_setFrameArena(Arena* arena)
+{
+    frameArena = arena;
+}
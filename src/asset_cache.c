@@ -0,0 +1,313 @@
+#include "config.h"
+#include "types.h"
+
+#include "asset_cache.h"
+
+#include "memory.h"
+#include "mapper.h"
+#include "maths.h"
+#include "tools.h"
+#include "sys.h"
+
+
+typedef struct
+{
+    const void* src;
+    void* data;
+    u16 size;
+    u16 refCount;
+    u32 lastUse;
+} CacheEntry;
+
+
+static CacheEntry entries[ASSETCACHE_MAX_ENTRY];
+static u16 numEntry;
+static u16 totalSize;
+static u16 budget;
+static u32 useStamp;
+
+
+static void* getEntry(const void* src);
+static void* allocEntry(u32 size);
+static void addEntry(const void* src, void* data, u16 size);
+static u16 evictEntry(u16 minSize);
+static bool reclaim(u16 size);
+
+
+void ASSETCACHE_init(u16 maxSize)
+{
+    ASSETCACHE_end();
+
+    budget = maxSize;
+    useStamp = 0;
+
+    MEM_setReclaimCallback(reclaim);
+}
+
+void ASSETCACHE_end()
+{
+    MEM_setReclaimCallback(NULL);
+
+    for(u16 i = 0; i < numEntry; i++)
+        MEM_free(entries[i].data);
+
+    numEntry = 0;
+    totalSize = 0;
+}
+
+const TileSet* ASSETCACHE_getTileSet(const TileSet* src)
+{
+    // nothing to unpack
+    if (src->compression == COMPRESSION_NONE) return src;
+
+    TileSet* result = getEntry(src);
+    if (result) return result;
+
+    const u32 size = sizeof(TileSet) + (src->numTile * 32);
+    result = allocEntry(size);
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("ASSETCACHE_getTileSet(..) failed: cannot allocate entry, numTile = ", src->numTile);
+#endif
+        return NULL;
+    }
+
+    result->tiles = (u32*) &result[1];
+    unpackTileSet(src, result);
+    addEntry(src, result, size);
+
+    return result;
+}
+
+const TileMap* ASSETCACHE_getTileMap(const TileMap* src)
+{
+    // nothing to unpack
+    if (src->compression == COMPRESSION_NONE) return src;
+
+    TileMap* result = getEntry(src);
+    if (result) return result;
+
+    const u32 size = sizeof(TileMap) + (mulu(src->w, src->h) * 2);
+    result = allocEntry(size);
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("ASSETCACHE_getTileMap(..) failed: cannot allocate entry, w = ", src->w, " h = ", src->h);
+#endif
+        return NULL;
+    }
+
+    result->tilemap = (u16*) &result[1];
+    unpackTileMap(src, result);
+    addEntry(src, result, size);
+
+    return result;
+}
+
+const MapDefinition* ASSETCACHE_getMapDefinition(const MapDefinition* src)
+{
+    const u16 compression = src->compression;
+    const bool stream = (compression & MAP_BLOCKS_STREAM) != 0;
+    // streamed blocks are unpacked on demand by the map block cache
+    const u16 metaTilesComp = compression & 0xF;
+    const u16 blocksComp = stream?COMPRESSION_NONE:((compression >> 4) & 0xF);
+    const u16 blockIndexesComp = (compression >> 8) & 0xF;
+
+    // nothing to unpack
+    if ((metaTilesComp == COMPRESSION_NONE) && (blocksComp == COMPRESSION_NONE) && (blockIndexesComp == COMPRESSION_NONE)) return src;
+
+    MapDefinition* result = getEntry(src);
+    if (result) return result;
+
+    const u32 metaTilesSize = src->numMetaTile * 2 * 4;
+    const u32 blocksSize = src->numBlock * 64 * ((src->numMetaTile > 256)?2:1);
+    const u32 blockIndexesSize = mulu(src->w, src->hp) * ((src->numBlock > 256)?2:1);
+    u32 size = sizeof(MapDefinition);
+
+    // only compressed parts are stored in the entry (keep even size for u16 access)
+    if (metaTilesComp != COMPRESSION_NONE) size += metaTilesSize;
+    if (blocksComp != COMPRESSION_NONE) size += (blocksSize + 1) & ~1;
+    if (blockIndexesComp != COMPRESSION_NONE) size += blockIndexesSize;
+
+    result = allocEntry(size);
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("ASSETCACHE_getMapDefinition(..) failed: cannot allocate entry, w = ", src->w, " h = ", src->h);
+#endif
+        return NULL;
+    }
+
+    u8* dst = (u8*) &result[1];
+
+    *result = *src;
+    // only streamed blocks remain packed
+    result->compression = stream?(compression & (MAP_BLOCKS_STREAM | 0xF0)):COMPRESSION_NONE;
+
+    if (metaTilesComp != COMPRESSION_NONE)
+    {
+        unpack(metaTilesComp, (u8*) FAR_SAFE(src->metaTiles, metaTilesSize), dst);
+        result->metaTiles = (u16*) dst;
+        dst += metaTilesSize;
+    }
+    if (blocksComp != COMPRESSION_NONE)
+    {
+        unpack(blocksComp, (u8*) FAR_SAFE(src->blocks, blocksSize), dst);
+        result->blocks = dst;
+        dst += (blocksSize + 1) & ~1;
+    }
+    if (blockIndexesComp != COMPRESSION_NONE)
+    {
+        unpack(blockIndexesComp, (u8*) FAR_SAFE(src->blockIndexes, blockIndexesSize), dst);
+        result->blockIndexes = dst;
+    }
+
+    addEntry(src, result, size);
+
+    return result;
+}
+
+void ASSETCACHE_release(const void* src)
+{
+    CacheEntry* entry = entries;
+    u16 i = numEntry;
+
+    while(i--)
+    {
+        if (entry->src == src)
+        {
+            if (entry->refCount) entry->refCount--;
+            return;
+        }
+
+        entry++;
+    }
+}
+
+u16 ASSETCACHE_evict(u16 size)
+{
+    u16 res = 0;
+
+    while(res < size)
+    {
+        const u16 released = evictEntry(0);
+
+        // no more unused entry
+        if (!released) break;
+
+        res += released;
+    }
+
+    return res;
+}
+
+void ASSETCACHE_flush()
+{
+    while(evictEntry(0));
+}
+
+u16 ASSETCACHE_getSize()
+{
+    return totalSize;
+}
+
+
+// find cached entry for given source, reference it and return its data (NULL if not in cache)
+static void* getEntry(const void* src)
+{
+    CacheEntry* entry = entries;
+    u16 i = numEntry;
+
+    while(i--)
+    {
+        if (entry->src == src)
+        {
+            entry->refCount++;
+            entry->lastUse = ++useStamp;
+            return entry->data;
+        }
+
+        entry++;
+    }
+
+    return NULL;
+}
+
+static void* allocEntry(u32 size)
+{
+    // MEM_alloc(..) is limited to 64 KB
+    if (size > 0xFFF0) return NULL;
+
+    // make room in cache budget
+    if (budget)
+    {
+        if (size > budget) return NULL;
+
+        while ((totalSize + size) > budget)
+            if (!evictEntry(0)) return NULL;
+    }
+    // make room in entry table
+    if ((numEntry >= ASSETCACHE_MAX_ENTRY) && !evictEntry(0)) return NULL;
+
+    // reclaim callback may evict other unused entries here if heap is full
+    return MEM_alloc(size);
+}
+
+static void addEntry(const void* src, void* data, u16 size)
+{
+    CacheEntry* entry = &entries[numEntry++];
+
+    entry->src = src;
+    entry->data = data;
+    entry->size = size;
+    entry->refCount = 1;
+    entry->lastUse = ++useStamp;
+
+    totalSize += size;
+}
+
+// evict least recently used unreferenced entry, preferring one of at least minSize bytes, returns released size
+static u16 evictEntry(u16 minSize)
+{
+    CacheEntry* entry = entries;
+    s16 best = -1;
+    s16 bestLarge = -1;
+
+    for(u16 i = 0; i < numEntry; i++, entry++)
+    {
+        if (entry->refCount) continue;
+
+        if ((best == -1) || (entry->lastUse < entries[best].lastUse)) best = i;
+        if ((entry->size >= minSize) && ((bestLarge == -1) || (entry->lastUse < entries[bestLarge].lastUse))) bestLarge = i;
+    }
+
+    // a large enough block gives a better chance to satisfy the allocation
+    if (bestLarge != -1) best = bestLarge;
+    // nothing to evict
+    if (best == -1) return 0;
+
+    entry = &entries[best];
+    const u16 res = entry->size;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+    KLog_U2("ASSETCACHE - evict entry #", best, " size = ", res);
+#endif
+
+    MEM_free(entry->data);
+    totalSize -= res;
+
+    // keep table compact
+    *entry = entries[--numEntry];
+
+    return res;
+}
+
+// MEM_alloc(..) reclaim callback
+static bool reclaim(u16 size)
+{
+    return evictEntry(size) != 0;
+}
@@ -0,0 +1,178 @@
+#include "config.h"
+#include "types.h"
+
+#include "asset_dir.h"
+
+#include "memory.h"
+#include "mapper.h"
+#include "pal.h"
+#include "vdp_bg.h"
+#include "map.h"
+#include "bmp.h"
+#include "tools.h"
+#include "sys.h"
+
+
+u32 ASSETDIR_hash(const char* id)
+{
+    const u8* s = (const u8*) id;
+    u32 h = 0x811C9DC5;
+    u8 c;
+
+    // FNV-1a, multiply by FNV prime (0x01000193) using shifts (faster than 32 bit multiply on 68000)
+    while((c = *s++))
+    {
+        h ^= c;
+        h += (h << 1) + (h << 4) + (h << 7) + (h << 8) + (h << 24);
+    }
+
+    return h;
+}
+
+const AssetEntry* ASSETDIR_find(const AssetDirectory* dir, u32 id)
+{
+    const AssetEntry* entries = dir->entries;
+    const u16 mask = dir->mask;
+    u16 slot = id & mask;
+    // table is never full (load factor <= 50%) but be safe
+    u16 remaining = mask + 1;
+
+    while(remaining--)
+    {
+        const AssetEntry* entry = &entries[slot];
+
+        // empty slot --> not found
+        if (entry->data == NULL) return NULL;
+        if (entry->hash == id) return entry;
+
+        // linear probing
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+const AssetEntry* ASSETDIR_findByName(const AssetDirectory* dir, const char* name)
+{
+    return ASSETDIR_find(dir, ASSETDIR_hash(name));
+}
+
+const void* ASSETDIR_get(const AssetDirectory* dir, u32 id, u16 type)
+{
+    const AssetEntry* entry = ASSETDIR_find(dir, id);
+
+    if (entry == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("ASSETDIR_get(..) warning: asset not found, id = ", id);
+#endif
+        return NULL;
+    }
+    if ((type != ASSET_TYPE_ANY) && (entry->type != type))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U2("ASSETDIR_get(..) warning: wrong asset type, expected ", type, " but found ", entry->type);
+#endif
+        return NULL;
+    }
+
+    return entry->data;
+}
+
+u16 ASSETDIR_getBank(const AssetEntry* entry)
+{
+    const void* data = entry->data;
+
+    switch(entry->type)
+    {
+        case ASSET_TYPE_PALETTE:
+            data = ((const Palette*) data)->data;
+            break;
+
+        case ASSET_TYPE_TILESET:
+            data = ((const TileSet*) data)->tiles;
+            break;
+
+        case ASSET_TYPE_TILEMAP:
+            data = ((const TileMap*) data)->tilemap;
+            break;
+
+        case ASSET_TYPE_MAP:
+            data = ((const MapDefinition*) data)->blockIndexes;
+            break;
+
+        case ASSET_TYPE_IMAGE:
+            data = ((const Image*) data)->tileset->tiles;
+            break;
+
+        case ASSET_TYPE_BITMAP:
+            data = ((const Bitmap*) data)->image;
+            break;
+    }
+
+    return ((u32) data) / BANK_SIZE;
+}
+
+void* ASSETDIR_loadData(const AssetDirectory* dir, u32 id, void* dest)
+{
+    const AssetEntry* entry = ASSETDIR_find(dir, id);
+
+    if ((entry == NULL) || (entry->type != ASSET_TYPE_BIN))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("ASSETDIR_loadData(..) failed: BIN asset not found, id = ", id);
+#endif
+        return NULL;
+    }
+
+    const u32 size = entry->size;
+
+    // memcpy / MEM_alloc are limited to 64 KB
+    if (size > 0xFFF0)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("ASSETDIR_loadData(..) failed: asset too large, size = ", size);
+#endif
+        return NULL;
+    }
+
+    void* result = dest?dest:MEM_alloc(size);
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("ASSETDIR_loadData(..) failed: not enough memory, size = ", size);
+#endif
+        return NULL;
+    }
+
+    // packed data is never larger than unpacked data so using unpacked size is safe for bank mapping
+    if (entry->compression != COMPRESSION_NONE)
+        unpack(entry->compression, (u8*) FAR_SAFE(entry->data, size), (u8*) result);
+    else
+        memcpy(result, FAR_SAFE(entry->data, size), size);
+
+    return result;
+}
+
+bool ASSETDIR_loadTileSet(const AssetDirectory* dir, u32 id, u16 index, TransferMethod tm)
+{
+    const TileSet* tileset = ASSETDIR_get(dir, id, ASSET_TYPE_TILESET);
+
+    if (tileset == NULL) return FALSE;
+
+    // VDP_loadTileSet(..) handles unpacking and bank switching
+    return VDP_loadTileSet(tileset, index, tm);
+}
+
+bool ASSETDIR_loadPalette(const AssetDirectory* dir, u32 id, u16 numPal, TransferMethod tm)
+{
+    const Palette* pal = ASSETDIR_get(dir, id, ASSET_TYPE_PALETTE);
+
+    if (pal == NULL) return FALSE;
+
+    // palette data are never far
+    PAL_setPalette(numPal, pal->data, tm);
+
+    return TRUE;
+}
@@ -0,0 +1,507 @@
+#include "config.h"
+#include "types.h"
+
+#include "async_load.h"
+
+#include "job.h"
+#include "dma.h"
+#include "vdp.h"
+#include "pal.h"
+#include "memory.h"
+#include "mapper.h"
+#include "timer.h"
+#include "tools.h"
+
+
+// loaded resource type
+#define TYPE_TILESET        0
+#define TYPE_MAP            1
+
+// map unpack steps
+#define MAP_STEP_METATILES  0
+#define MAP_STEP_BLOCKS     1
+#define MAP_STEP_INDEXES    2
+#define MAP_STEP_CREATE     3
+
+// estimated unpack cost (in scanline) for the given size, LZ4W C streaming decoder is about 16 cycles per byte so
+// 1 scanline (488 cycles) every 32 bytes (also used as rough estimation for other compressions)
+#define UNPACK_COST(size)   (((size) >> 5) + 1)
+
+
+static AsyncLoad loads[ALOAD_MAX_LOAD];
+static u16 unpackChunk = ALOAD_UNPACK_CHUNK;
+static u16 dmaPerFrame = ALOAD_DMA_PER_FRAME;
+
+
+// forward
+static AsyncLoad* allocLoad(u16 type, AsyncLoadCallback* callback, void* data);
+static AsyncLoad* startTiles(AsyncLoad* load, const TileSet* tileset, u16 index);
+static void tilesJob(void* data);
+static void mapJob(void* data);
+static bool setMapSection(AsyncLoad* load);
+static bool unpackStep(AsyncLoad* load);
+static u16 getUnpackCost(const AsyncLoad* load);
+static bool isTransferPending(const AsyncLoad* load);
+static void endLoad(AsyncLoad* load, u16 state);
+static void releaseData(AsyncLoad* load);
+
+
+void ALOAD_setBudget(u16 chunk, u16 dma)
+{
+    // keep word aligned
+    unpackChunk = max(chunk & ~1, 32);
+    dmaPerFrame = max(dma & ~1, 32);
+}
+
+
+AsyncLoad* ALOAD_loadTileSet(const TileSet* tileset, u16 index, AsyncLoadCallback* callback, void* data)
+{
+    AsyncLoad* load = allocLoad(TYPE_TILESET, callback, data);
+
+    if (load == NULL) return NULL;
+
+    return startTiles(load, tileset, index);
+}
+
+AsyncLoad* ALOAD_drawImage(VDPPlane plane, const Image* image, u16 basetile, u16 x, u16 y, bool loadpal, AsyncLoadCallback* callback, void* data)
+{
+    AsyncLoad* load = allocLoad(TYPE_TILESET, callback, data);
+
+    if (load == NULL) return NULL;
+
+    // tilemap and palette are set once tiles are loaded
+    load->image = image;
+    load->plane = plane;
+    load->basetile = basetile;
+    load->x = x;
+    load->y = y;
+    load->loadpal = loadpal;
+
+    return startTiles(load, image->tileset, basetile & TILE_INDEX_MASK);
+}
+
+AsyncLoad* ALOAD_createMap(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile, AsyncLoadCallback* callback, void* data)
+{
+    AsyncLoad* load = allocLoad(TYPE_MAP, callback, data);
+
+    if (load == NULL) return NULL;
+
+    const u16 compression = mapDef->compression;
+    // streamed blocks are unpacked on demand by the map block cache
+    const bool stream = (compression & MAP_BLOCKS_STREAM) != 0;
+    const u16 metaTilesComp = compression & 0xF;
+    const u16 blocksComp = stream?COMPRESSION_NONE:((compression >> 4) & 0xF);
+    const u16 blockIndexesComp = (compression >> 8) & 0xF;
+
+    load->mapDef = mapDef;
+    load->plane = plane;
+    load->basetile = baseTile;
+    load->step = MAP_STEP_METATILES;
+
+    // something to unpack ? --> allocate unpacked definition (same layout as ASSETCACHE_getMapDefinition(..))
+    if ((metaTilesComp != COMPRESSION_NONE) || (blocksComp != COMPRESSION_NONE) || (blockIndexesComp != COMPRESSION_NONE))
+    {
+        const u32 metaTilesSize = mapDef->numMetaTile * 2 * 4;
+        const u32 blocksSize = mapDef->numBlock * 64 * ((mapDef->numMetaTile > 256)?2:1);
+        const u32 blockIndexesSize = mulu(mapDef->w, mapDef->hp) * ((mapDef->numBlock > 256)?2:1);
+        u32 size = sizeof(MapDefinition);
+
+        // only compressed parts are stored (keep even size for u16 access)
+        if (metaTilesComp != COMPRESSION_NONE) size += metaTilesSize;
+        if (blocksComp != COMPRESSION_NONE) size += (blocksSize + 1) & ~1;
+        if (blockIndexesComp != COMPRESSION_NONE) size += blockIndexesSize;
+
+        MapDefinition* def = MEM_alloc(size);
+
+        if (def == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U2("ALOAD_createMap(..) failed: not enough memory, w = ", mapDef->w, " h = ", mapDef->h);
+#endif
+            load->state = ALOAD_STATE_FREE;
+            return NULL;
+        }
+
+        u8* dst = (u8*) &def[1];
+
+        *def = *mapDef;
+        // only streamed blocks remain packed
+        def->compression = stream?(compression & (MAP_BLOCKS_STREAM | 0xF0)):COMPRESSION_NONE;
+
+        if (metaTilesComp != COMPRESSION_NONE)
+        {
+            def->metaTiles = (u16*) dst;
+            dst += metaTilesSize;
+        }
+        if (blocksComp != COMPRESSION_NONE)
+        {
+            def->blocks = dst;
+            dst += (blocksSize + 1) & ~1;
+        }
+        if (blockIndexesComp != COMPRESSION_NONE) def->blockIndexes = dst;
+
+        load->unpackedDef = def;
+
+        if (!setMapSection(load))
+        {
+            MEM_free(def);
+            load->state = ALOAD_STATE_FREE;
+            return NULL;
+        }
+    }
+    // nothing to unpack --> just create the map
+    else load->step = MAP_STEP_CREATE;
+
+    if (!JOB_push(mapJob, load, getUnpackCost(load)))
+    {
+        releaseData(load);
+        if (load->unpackedDef) MEM_free(load->unpackedDef);
+        load->state = ALOAD_STATE_FREE;
+        return NULL;
+    }
+
+    return load;
+}
+
+
+u16 ALOAD_getState(const AsyncLoad* load)
+{
+    return load->state;
+}
+
+bool ALOAD_isDone(const AsyncLoad* load)
+{
+    return (load->state == ALOAD_STATE_DONE) || (load->state == ALOAD_STATE_FAILED);
+}
+
+Map* ALOAD_getMap(const AsyncLoad* load)
+{
+    return (load->state == ALOAD_STATE_DONE)?load->map:NULL;
+}
+
+void ALOAD_release(AsyncLoad* load)
+{
+    // in progress --> the pending job releases it once queued transfers are done
+    if (load->state == ALOAD_STATE_PENDING)
+    {
+        load->state = ALOAD_STATE_CANCELED;
+        return;
+    }
+    if (load->state == ALOAD_STATE_CANCELED) return;
+
+    if (load->unpackedDef) MEM_free(load->unpackedDef);
+    load->unpackedDef = NULL;
+    load->state = ALOAD_STATE_FREE;
+}
+
+
+static AsyncLoad* allocLoad(u16 type, AsyncLoadCallback* callback, void* data)
+{
+    AsyncLoad* load = loads;
+    u16 i = ALOAD_MAX_LOAD;
+
+    while(i--)
+    {
+        if (load->state == ALOAD_STATE_FREE)
+        {
+            memset(load, 0, sizeof(AsyncLoad));
+            load->state = ALOAD_STATE_PENDING;
+            load->type = type;
+            load->callback = callback;
+            load->data = data;
+            // no DMA done yet
+            load->frame = vtimer - 1;
+
+            return load;
+        }
+
+        load++;
+    }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    KLog_U1("ALOAD_xxx(..) failed: max number of load reached = ", ALOAD_MAX_LOAD);
+#endif
+
+    return NULL;
+}
+
+static AsyncLoad* startTiles(AsyncLoad* load, const TileSet* tileset, u16 index)
+{
+    const u32 size = tileset->numTile * 32;
+
+    load->compression = tileset->compression;
+    load->size = size;
+    load->vramAddr = index * 32;
+    // keep bank(s) mapped until done (packed size is lower than unpacked size)
+    load->src = (const u8*) FAR_ACQUIRE(tileset->tiles, size);
+
+    if (load->src == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("ALOAD_loadTileSet(..) failed: cannot map tileset data (too many pinned bank regions)");
+#endif
+        load->state = ALOAD_STATE_FREE;
+        return NULL;
+    }
+
+    // not compressed --> DMA directly from ROM
+    if (load->compression == COMPRESSION_NONE) load->unpacked = size;
+    else
+    {
+        load->dest = MEM_alloc(size);
+
+        if (load->dest == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("ALOAD_loadTileSet(..) failed: not enough memory, numTile = ", tileset->numTile);
+#endif
+            releaseData(load);
+            load->state = ALOAD_STATE_FREE;
+            return NULL;
+        }
+
+        if (load->compression == COMPRESSION_LZ4W) LZ4W_initStream(&load->stream, load->src, load->dest);
+    }
+
+    if (!JOB_push(tilesJob, load, getUnpackCost(load)))
+    {
+        releaseData(load);
+        load->state = ALOAD_STATE_FREE;
+        return NULL;
+    }
+
+    return load;
+}
+
+
+static void tilesJob(void* data)
+{
+    AsyncLoad* load = data;
+
+    if (load->state == ALOAD_STATE_CANCELED)
+    {
+        // wait for transfers from our buffer being done
+        if (isTransferPending(load)) JOB_pushNextFrame(tilesJob, load, 1);
+        else
+        {
+            releaseData(load);
+            load->state = ALOAD_STATE_FREE;
+        }
+        return;
+    }
+
+    // all tiles sent and transferred ? --> done
+    if ((load->sent == load->size) && !isTransferPending(load))
+    {
+        const Image* image = load->image;
+        u16 state = ALOAD_STATE_DONE;
+
+        if (image)
+        {
+            const TileMap* tilemap = image->tilemap;
+            const u16 basetile = load->basetile;
+
+            // same as VDP_drawImageEx(..)
+            if (!VDP_setTileMapEx(load->plane, tilemap, basetile, load->x, load->y, 0, 0, tilemap->w, tilemap->h, CPU))
+                state = ALOAD_STATE_FAILED;
+            else if (load->loadpal) PAL_setPaletteColors((basetile >> 9) & 0x30, image->palette, CPU);
+        }
+
+        endLoad(load, state);
+        return;
+    }
+
+    // unpack next chunk
+    if (load->unpacked < load->size) unpackStep(load);
+
+    // new frame ? --> reset DMA budget
+    const u16 frame = vtimer;
+    if (load->frame != frame)
+    {
+        load->frame = frame;
+        load->frameSent = 0;
+    }
+
+    // queue available tiles within frame budget
+    u32 len = load->unpacked - load->sent;
+    const u16 remain = dmaPerFrame - load->frameSent;
+
+    if (len > remain) len = remain;
+
+    if (len)
+    {
+        const u8* from = (load->dest?load->dest:load->src) + load->sent;
+
+        if (DMA_queueDma(DMA_VRAM, (void*) from, load->vramAddr + load->sent, len >> 1, 2))
+        {
+            load->sent += len;
+            load->frameSent += len;
+        }
+    }
+
+    // more to unpack --> continue on this frame if there is enough time
+    if (load->unpacked < load->size) JOB_push(tilesJob, load, getUnpackCost(load));
+    // only DMA remaining (or waiting for last transfer) --> next frame
+    else JOB_pushNextFrame(tilesJob, load, 1);
+}
+
+static void mapJob(void* data)
+{
+    AsyncLoad* load = data;
+
+    if (load->state == ALOAD_STATE_CANCELED)
+    {
+        releaseData(load);
+        if (load->unpackedDef) MEM_free(load->unpackedDef);
+        load->unpackedDef = NULL;
+        load->state = ALOAD_STATE_FREE;
+        return;
+    }
+
+    if (load->step < MAP_STEP_CREATE)
+    {
+        // section done ? --> next one
+        if (unpackStep(load))
+        {
+            load->step++;
+
+            if (!setMapSection(load))
+            {
+                endLoad(load, ALOAD_STATE_FAILED);
+                return;
+            }
+        }
+
+        JOB_push(mapJob, load, getUnpackCost(load));
+        return;
+    }
+
+    load->map = MAP_create(load->unpackedDef?load->unpackedDef:load->mapDef, load->plane, load->basetile);
+    endLoad(load, load->map?ALOAD_STATE_DONE:ALOAD_STATE_FAILED);
+}
+
+
+// prepare unpacking of the next compressed map section (from current step)
+static bool setMapSection(AsyncLoad* load)
+{
+    const MapDefinition* mapDef = load->mapDef;
+    const MapDefinition* def = load->unpackedDef;
+    const u16 compression = mapDef->compression;
+
+    while(load->step < MAP_STEP_CREATE)
+    {
+        const void* src;
+        void* dst;
+        u16 comp;
+        u32 size;
+
+        switch(load->step)
+        {
+            case MAP_STEP_METATILES:
+                comp = compression & 0xF;
+                src = mapDef->metaTiles;
+                dst = def->metaTiles;
+                size = mapDef->numMetaTile * 2 * 4;
+                break;
+
+            case MAP_STEP_BLOCKS:
+                comp = (compression & MAP_BLOCKS_STREAM)?COMPRESSION_NONE:((compression >> 4) & 0xF);
+                src = mapDef->blocks;
+                dst = def->blocks;
+                size = mapDef->numBlock * 64 * ((mapDef->numMetaTile > 256)?2:1);
+                break;
+
+            default:
+                comp = (compression >> 8) & 0xF;
+                src = mapDef->blockIndexes;
+                dst = def->blockIndexes;
+                size = mulu(mapDef->w, mapDef->hp) * ((mapDef->numBlock > 256)?2:1);
+                break;
+        }
+
+        // not compressed --> nothing to do
+        if (comp == COMPRESSION_NONE)
+        {
+            load->step++;
+            continue;
+        }
+
+        load->compression = comp;
+        load->size = size;
+        load->unpacked = 0;
+        load->dest = dst;
+        // keep bank(s) mapped until section is unpacked
+        load->src = FAR_ACQUIRE(src, size);
+
+        if (load->src == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog("ALOAD_createMap(..) failed: cannot map map data (too many pinned bank regions)");
+#endif
+            return FALSE;
+        }
+
+        if (comp == COMPRESSION_LZ4W) LZ4W_initStream(&load->stream, load->src, load->dest);
+
+        return TRUE;
+    }
+
+    return TRUE;
+}
+
+// unpack next chunk of current data, returns TRUE when all data is unpacked
+static bool unpackStep(AsyncLoad* load)
+{
+    if (load->compression == COMPRESSION_LZ4W)
+    {
+        load->unpacked += LZ4W_unpackChunk(&load->stream, unpackChunk);
+        if (!LZ4W_isStreamDone(&load->stream)) return FALSE;
+    }
+    // can't be unpacked by parts
+    else unpack(load->compression, (u8*) load->src, load->dest);
+
+    load->unpacked = load->size;
+    // packed data isn't needed anymore
+    FAR_RELEASE(load->src, load->size);
+    load->src = NULL;
+
+    return TRUE;
+}
+
+static u16 getUnpackCost(const AsyncLoad* load)
+{
+    const u32 remain = load->size - load->unpacked;
+
+    // nothing to unpack
+    if (remain == 0) return 1;
+    // LZ4W chunk
+    if (load->compression == COMPRESSION_LZ4W) return UNPACK_COST(min(remain, unpackChunk));
+
+    // whole data at once: clamped to the screen height so a large unpack is accepted as an oversized job (done on
+    // first VBlank wait of next frame, overrunning it) instead of never fitting
+    return min(UNPACK_COST(remain), VDP_getScreenHeight());
+}
+
+static bool isTransferPending(const AsyncLoad* load)
+{
+    // something was queued on this frame ? --> DMA queue isn't yet flushed
+    return (load->frame == (u16) vtimer) && load->frameSent;
+}
+
+static void endLoad(AsyncLoad* load, u16 state)
+{
+    releaseData(load);
+    load->state = state;
+
+    if (load->callback) load->callback(load, load->data);
+}
+
+static void releaseData(AsyncLoad* load)
+{
+    if (load->src) FAR_RELEASE(load->src, load->size);
+    load->src = NULL;
+
+    // tiles unpack buffer (map sections are unpacked in the unpacked definition)
+    if ((load->type == TYPE_TILESET) && load->dest) MEM_free(load->dest);
+    load->dest = NULL;
+}
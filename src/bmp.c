@@ -21,6 +21,8 @@
 
 #define BMP_FLAG_DOUBLEBUFFER   (1 << 0)
 #define BMP_FLAG_COPYBUFFER     (1 << 1)
+#define BMP_FLAG_DIRTYBLIT      (1 << 2)
+#define BMP_FLAG_TILELAYOUT     (1 << 3)
 
 #define BMP_STAT_FLIPPING       (1 << 0)
 #define BMP_STAT_BLITTING       (1 << 1)
@@ -28,23 +30,28 @@
 
 #define HAS_DOUBLEBUFFER        (flag & BMP_FLAG_DOUBLEBUFFER)
 #define HAS_BUFFERCOPY          (flag & BMP_FLAG_COPYBUFFER)
+#define HAS_DIRTYBLIT           (flag & BMP_FLAG_DIRTYBLIT)
+#define HAS_TILELAYOUT          (flag & BMP_FLAG_TILELAYOUT)
 
 #define READ_IS_FB0             (bmp_buffer_read == bmp_buffer_0)
 #define READ_IS_FB1             (bmp_buffer_read == bmp_buffer_1)
 #define WRITE_IS_FB0            (bmp_buffer_write == bmp_buffer_0)
 #define WRITE_IS_FB1            (bmp_buffer_write == bmp_buffer_1)
 
-#define GET_YOFFSET             ((HAS_DOUBLEBUFFER && READ_IS_FB1)?((BMP_PLANE_HEIGHT / 2) + 4):4)
+#define GET_YOFFSET             ((HAS_DOUBLEBUFFER && READ_IS_FB1)?((BMP_PLANE_HEIGHT / 2) + tileYOffset):tileYOffset)
 
 #define BMP_PLANE_ADDR          (*bmp_plane_addr)
 
 #define BMP_FB0_TILEMAP_BASE    BMP_PLANE_ADDR
 #define BMP_FB1_TILEMAP_BASE    (BMP_PLANE_ADDR + ((BMP_PLANE_WIDTH * (BMP_PLANE_HEIGHT / 2)) * 2))
-#define BMP_FB_TILEMAP_OFFSET   (((BMP_PLANE_WIDTH * BMP_TILE_YOFFSET) + BMP_TILE_XOFFSET) * 2)
+#define BMP_FB_TILEMAP_OFFSET   (((BMP_PLANE_WIDTH * tileYOffset) + tileXOffset) * 2)
 
 
 #define NTSC_TILES_BW           7
 #define PAL_TILES_BW            10
+// DMA transfer of tile ordered buffer is about twice faster than CPU conversion
+#define NTSC_TILES_BW_DMA       14
+#define PAL_TILES_BW_DMA        20
 
 
 // we don't want to share them
@@ -60,6 +67,22 @@ static u8 *bmp_buffer_1;
 VDPPlane bmp_plan;
 u16 *bmp_plane_addr;
 
+// dirty tile row tracking: rows modified in write buffer since last flip
+static u8 drawRows[BMP_TILE_HEIGHT];
+// rows where RAM buffer [b] may differ from VRAM buffer [v]
+static u32 staleRows[2][2];
+
+// view size (in tile) and position (in tile) on screen
+static u16 tileW;
+static u16 tileH;
+static u16 tileXOffset;
+static u16 tileYOffset;
+// view size in pixel
+static u16 viewW;
+static u16 viewH;
+// tile row size in byte (tile ordered layout)
+static u16 rowSize;
+
 // internals
 static u16 flag;
 static u16 pal;
@@ -71,19 +94,48 @@ static vs16 phase;
 // ASM methods
 extern void clearBitmapBuffer(u8 *bmp_buffer);
 extern void copyBitmapBuffer(u8 *src, u8 *dst);
+extern void BMP_setPixelsFastA_V2D(const Vect2D_u16 *crd, u8 col, u16 num);
+extern void BMP_setPixelsA_V2D(const Vect2D_u16 *crd, u8 col, u16 num);
+extern void BMP_setPixelsFastA(const Pixel *pixels, u16 num);
+extern void BMP_setPixelsA(const Pixel *pixels, u16 num);
+extern void BMP_drawLineA(Line *l);
+extern u16 BMP_drawPolygonA(const Vect2D_s16 *pts, u16 num, u8 col);
+extern void BMP_fillSpanA(u16 x0, u16 x1, u16 y, u8 col);
+extern void BMP_copySpanA(const u8 *src, u16 srcX, u16 x, u16 y, u16 len);
+extern void BMP_scaleLineA(const u8 *src, u8 *dst, const u16 *cols, u16 num, u16 swap);
 
 static void doFlip();
 static void flipBuffer();
 static void initTilemap(u16 index);
 static void clearVRAMBuffer(u16 index);
 static u16 doBlit();
+static u32 getBlitRows();
+static void markRows(s16 y0, s16 y1);
+static u16 getOffset(u16 x, u16 y);
+static void fillSpanTile(u16 x0, u16 x1, u16 y, u8 col);
+static void copySpanTile(const u8 *src, u16 srcX, u16 x, u16 y, u16 len);
+static void drawLineTile(const Line *l);
+static u16 drawPolygonTile(const Vect2D_s16 *pts, u16 num, u8 col);
+static void fillScaleTable(u16 *table, u16 srcSize, u16 dstSize, u16 mirror);
 static void drawLine_old(u16 x1, u16 y1, s16 dx, s16 dy, s16 step_x, s16 step_y, u8 col);
 static HINTERRUPT_CALLBACK hint();
 
 
 void BMP_init(u16 double_buffer, VDPPlane plane, u16 palette, u16 priority)
+{
+    BMP_initEx(double_buffer, plane, palette, priority, BMP_TILE_WIDTH, BMP_TILE_HEIGHT, FALSE);
+}
+
+void BMP_initEx(u16 double_buffer, VDPPlane plane, u16 palette, u16 priority, u16 tileWidth, u16 tileHeight, u16 tileLayout)
 {
     flag = (double_buffer) ? BMP_FLAG_DOUBLEBUFFER : 0;
+    if (tileLayout) flag |= BMP_FLAG_TILELAYOUT;
+    // view can't be larger than bitmap buffer
+    tileW = clamp(tileWidth, 1, BMP_TILE_WIDTH);
+    tileH = clamp(tileHeight, 1, BMP_TILE_HEIGHT);
+    viewW = tileW << BMP_XPIXPERTILE_SFT;
+    viewH = tileH << BMP_YPIXPERTILE_SFT;
+    rowSize = tileW * 32;
     bmp_plan = plane;
     pal = palette & 3;
     prio = priority & 1;
@@ -171,10 +223,12 @@ void BMP_reset()
     VDP_setHIntCounter(255);
 
     // allocate bitmap buffer if needed
+    const u16 tag = MEM_setTag(MEM_TAG_BMP);
     if (!bmp_buffer_0)
         bmp_buffer_0 = MEM_alloc(BMP_PITCH * BMP_HEIGHT * sizeof(u8));
     if (!bmp_buffer_1)
         bmp_buffer_1 = MEM_alloc(BMP_PITCH * BMP_HEIGHT * sizeof(u8));
+    MEM_setTag(tag);
 
     // need 64x64 cells sized plane
     VDP_setPlaneSize(64, 64, TRUE);
@@ -186,6 +240,10 @@ void BMP_reset()
     // clear plane (complete tilemap)
     VDP_clearPlane(bmp_plan, TRUE);
 
+    // center view on screen
+    tileXOffset = ((screenWidth >> 3) - tileW) >> 1;
+    tileYOffset = ((screenHeight >> 3) - tileH) >> 1;
+
     // reset state and phase
     state = 0;
     phase = -1;
@@ -207,11 +265,15 @@ void BMP_reset()
     clearBitmapBuffer(bmp_buffer_0);
     clearBitmapBuffer(bmp_buffer_1);
 
+    // RAM and VRAM buffers are all cleared
+    memset(drawRows, 0, sizeof(drawRows));
+    memset(staleRows, 0, sizeof(staleRows));
+
     // set back vertical scroll to 0
     VDP_setVerticalScroll(bmp_plan, 0);
 
     // prepare hint for extended blank on next frame
-    VDP_setHIntCounter(((screenHeight - BMP_HEIGHT) >> 1) - 1);
+    VDP_setHIntCounter(((screenHeight - viewH) >> 1) - 1);
     // enabled bitmap interrupt processing
     SYS_setHIntCallback(hint);
     VBlankProcess |= PROCESS_BITMAP_TASK;
@@ -235,6 +297,37 @@ void BMP_setBufferCopy(u16 value)
     else flag &= ~BMP_FLAG_COPYBUFFER;
 }
 
+void BMP_setDirtyBlit(u16 value)
+{
+    if (value)
+    {
+        // rows weren't tracked until now --> consider all VRAM buffers as stale
+        if (!HAS_DIRTYBLIT) memset(staleRows, 0xFF, sizeof(staleRows));
+        flag |= BMP_FLAG_DIRTYBLIT;
+    }
+    else flag &= ~BMP_FLAG_DIRTYBLIT;
+}
+
+void BMP_markDirty(u16 y, u16 h)
+{
+    if (h) markRows(y, (y + h) - 1);
+}
+
+u16 BMP_getWidth()
+{
+    return viewW;
+}
+
+u16 BMP_getHeight()
+{
+    return viewH;
+}
+
+u16 BMP_isTileLayout()
+{
+    return HAS_TILELAYOUT?TRUE:FALSE;
+}
+
 
 u16 BMP_hasFlipRequestPending()
 {
@@ -333,19 +426,20 @@ void BMP_showFPS(u16 float_display)
 void BMP_clear()
 {
     clearBitmapBuffer(bmp_buffer_write);
+    memset(drawRows, 1, sizeof(drawRows));
 }
 
 
 u8* BMP_getWritePointer(u16 x, u16 y)
 {
-    const u16 off = (y * BMP_PITCH) + (x >> 1);
+    const u16 off = getOffset(x, y);
     // return write address
     return bmp_buffer_write + off;
 }
 
 u8* BMP_getReadPointer(u16 x, u16 y)
 {
-    const u16 off = (y * BMP_PITCH) + (x >> 1);
+    const u16 off = getOffset(x, y);
     // return read address
     return bmp_buffer_read + off;
 }
@@ -353,7 +447,7 @@ u8* BMP_getReadPointer(u16 x, u16 y)
 // inlining allow C functions to perform better than assembly methods
 inline u8 BMP_getPixelFast(u16 x, u16 y)
 {
-    const u16 off = (y * BMP_PITCH) + (x >> 1);
+    const u16 off = getOffset(x, y);
     u8* dst = bmp_buffer_write + off;
 
     if (x & 1) return *dst >> 4;
@@ -364,7 +458,7 @@ inline u8 BMP_getPixelFast(u16 x, u16 y)
 inline u8 BMP_getPixel(u16 x, u16 y)
 {
     // pixel in screen ?
-    if ((x < BMP_WIDTH) && (y < BMP_HEIGHT)) return BMP_getPixelFast(x, y);
+    if ((x < viewW) && (y < viewH)) return BMP_getPixelFast(x, y);
 
     return 0;
 }
@@ -372,18 +466,222 @@ inline u8 BMP_getPixel(u16 x, u16 y)
 // inlining allow C functions to perform better than assembly methods
 inline void BMP_setPixelFast(u16 x, u16 y, u8 col)
 {
-    const u16 off = (y * BMP_PITCH) + (x >> 1);
+    const u16 off = getOffset(x, y);
     u8* dst = bmp_buffer_write + off;
 
     if (x & 1) *dst = (*dst & 0xF0) | (col & 0x0F);
     else *dst = (*dst & 0x0F) | (col & 0xF0);
+
+    drawRows[y >> BMP_YPIXPERTILE_SFT] = 1;
 }
 
 // inlining allow C functions to perform better than assembly methods
 inline void BMP_setPixel(u16 x, u16 y, u8 col)
 {
     // pixel in screen ?
-    if ((x < BMP_WIDTH) && (y < BMP_HEIGHT)) BMP_setPixelFast(x, y, col);
+    if ((x < viewW) && (y < viewH)) BMP_setPixelFast(x, y, col);
+}
+
+void BMP_setPixelsFast_V2D(const Vect2D_u16 *crd, u8 col, u16 num)
+{
+    const Vect2D_u16 *c = crd;
+    u16 i = num;
+
+    // assembly methods only support linear layout
+    if (HAS_TILELAYOUT)
+    {
+        while(i--)
+        {
+            BMP_setPixelFast(c->x, c->y, col);
+            c++;
+        }
+        return;
+    }
+
+    while(i--)
+        drawRows[(c++)->y >> BMP_YPIXPERTILE_SFT] = 1;
+
+    BMP_setPixelsFastA_V2D(crd, col, num);
+}
+
+void BMP_setPixels_V2D(const Vect2D_u16 *crd, u8 col, u16 num)
+{
+    const Vect2D_u16 *c = crd;
+    u16 i = num;
+
+    if (HAS_TILELAYOUT)
+    {
+        while(i--)
+        {
+            BMP_setPixel(c->x, c->y, col);
+            c++;
+        }
+        return;
+    }
+
+    while(i--)
+    {
+        const u16 y = (c++)->y;
+        if (y < BMP_HEIGHT) drawRows[y >> BMP_YPIXPERTILE_SFT] = 1;
+    }
+
+    BMP_setPixelsA_V2D(crd, col, num);
+}
+
+void BMP_setPixelsFast(const Pixel *pixels, u16 num)
+{
+    const Pixel *p = pixels;
+    u16 i = num;
+
+    if (HAS_TILELAYOUT)
+    {
+        while(i--)
+        {
+            BMP_setPixelFast(p->pt.x, p->pt.y, p->col);
+            p++;
+        }
+        return;
+    }
+
+    while(i--)
+        drawRows[(p++)->pt.y >> BMP_YPIXPERTILE_SFT] = 1;
+
+    BMP_setPixelsFastA(pixels, num);
+}
+
+void BMP_setPixels(const Pixel *pixels, u16 num)
+{
+    const Pixel *p = pixels;
+    u16 i = num;
+
+    if (HAS_TILELAYOUT)
+    {
+        while(i--)
+        {
+            BMP_setPixel(p->pt.x, p->pt.y, p->col);
+            p++;
+        }
+        return;
+    }
+
+    while(i--)
+    {
+        const u16 y = (p++)->pt.y;
+        if (y < BMP_HEIGHT) drawRows[y >> BMP_YPIXPERTILE_SFT] = 1;
+    }
+
+    BMP_setPixelsA(pixels, num);
+}
+
+void BMP_drawLine(Line *l)
+{
+    const s16 y1 = l->pt1.y;
+    const s16 y2 = l->pt2.y;
+
+    if (y1 < y2) markRows(y1, y2);
+    else markRows(y2, y1);
+
+    if (HAS_TILELAYOUT) drawLineTile(l);
+    else BMP_drawLineA(l);
+}
+
+u16 BMP_drawPolygon(const Vect2D_s16 *pts, u16 num, u8 col)
+{
+    if (!num) return 0;
+
+    const Vect2D_s16 *p = pts;
+    s16 ymin = p->y;
+    s16 ymax = ymin;
+    u16 i = num - 1;
+
+    while(i--)
+    {
+        const s16 y = (++p)->y;
+
+        if (y < ymin) ymin = y;
+        else if (y > ymax) ymax = y;
+    }
+
+    if (HAS_TILELAYOUT)
+    {
+        if (!drawPolygonTile(pts, num, col)) return 0;
+    }
+    else if (!BMP_drawPolygonA(pts, num, col)) return 0;
+
+    markRows(ymin, ymax);
+
+    return 1;
+}
+
+void BMP_fillSpan(s16 x0, s16 x1, s16 y, u8 col)
+{
+    // clip
+    if ((y < 0) || (y >= (s16) viewH)) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 >= (s16) viewW) x1 = viewW - 1;
+    if (x0 > x1) return;
+
+    drawRows[y >> BMP_YPIXPERTILE_SFT] = 1;
+
+    if (HAS_TILELAYOUT) fillSpanTile(x0, x1, y, col);
+    else BMP_fillSpanA(x0, x1, y, col);
+}
+
+void BMP_fillRect(s16 x, s16 y, s16 w, s16 h, u8 col)
+{
+    s16 x1 = (x + w) - 1;
+    s16 y1 = (y + h) - 1;
+
+    // clip
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 >= (s16) viewW) x1 = viewW - 1;
+    if (y1 >= (s16) viewH) y1 = viewH - 1;
+    if ((x > x1) || (y > y1)) return;
+
+    markRows(y, y1);
+
+    if (HAS_TILELAYOUT)
+    {
+        while(y <= y1) fillSpanTile(x, x1, y++, col);
+    }
+    else
+    {
+        while(y <= y1) BMP_fillSpanA(x, x1, y++, col);
+    }
+}
+
+void BMP_copySpan(const u8 *src, u16 srcX, s16 x, s16 y, s16 len)
+{
+    // clip
+    if ((y < 0) || (y >= (s16) viewH)) return;
+    if (x < 0)
+    {
+        len += x;
+        srcX -= x;
+        x = 0;
+    }
+    if ((x + len) > (s16) viewW) len = viewW - x;
+    if (len <= 0) return;
+
+    drawRows[y >> BMP_YPIXPERTILE_SFT] = 1;
+
+    if (HAS_TILELAYOUT) copySpanTile(src, srcX, x, y, len);
+    else BMP_copySpanA(src, srcX, x, y, len);
+}
+
+u16 BMP_drawBitmapSpan(const Bitmap *bitmap, u16 srcX, u16 srcY, s16 x, s16 y, s16 len)
+{
+    const u16 wb = bitmap->w >> 1;
+
+    // only raw bitmap can be accessed randomly
+    if ((bitmap->compression != COMPRESSION_NONE) || (srcY >= bitmap->h)) return FALSE;
+    // clip to bitmap line
+    if ((srcX + len) > bitmap->w) len = bitmap->w - srcX;
+
+    BMP_copySpan((u8*) FAR_SAFE(bitmap->image + mulu(srcY, wb), wb), srcX, x, y, len);
+
+    return TRUE;
 }
 
 // obsolete: replaced by assembly function
@@ -1079,6 +1377,20 @@ void BMP_drawBitmapData(const u8 *image, u16 x, u16 y, u16 w, u16 h, u32 pitch)
     const u8 *src;
     u8 *dst;
 
+    // tile ordered layout --> copy line by line
+    if (HAS_TILELAYOUT)
+    {
+        src = image;
+
+        for(u16 i = 0; i < h; i++)
+        {
+            BMP_copySpan(src, 0, x, y + i, w);
+            src += pitch;
+        }
+
+        return;
+    }
+
     // limit bitmap size if larger than bitmap screen
     if ((w + x) > BMP_WIDTH) adj_w = (BMP_WIDTH - (w + x)) >> 1;
     else adj_w = w >> 1;
@@ -1086,6 +1398,8 @@ void BMP_drawBitmapData(const u8 *image, u16 x, u16 y, u16 w, u16 h, u32 pitch)
     if ((h + y) > BMP_HEIGHT) adj_h = BMP_HEIGHT - (h + y);
     else adj_h = h;
 
+    markRows(y, (y + h) - 1);
+
     // prepare source and destination
     src = image;
     dst = BMP_getWritePointer(x, y);
@@ -1134,6 +1448,9 @@ u16 BMP_drawBitmapScaled(const Bitmap *bitmap, u16 x, u16 y, u16 w, u16 h, u16 l
 {
     u16 bmp_wb, bmp_h;
 
+    // scaling works directly on linear buffer
+    if (HAS_TILELAYOUT) return FALSE;
+
     // get the image width in byte
     bmp_wb = bitmap->w >> 1;
     // get the image height
@@ -1152,6 +1469,8 @@ u16 BMP_drawBitmapScaled(const Bitmap *bitmap, u16 x, u16 y, u16 w, u16 h, u16 l
     else
         BMP_scale(FAR_SAFE(bitmap->image, mulu(w, h) / 2), bmp_wb, bmp_h, bmp_wb, BMP_getWritePointer(x, y), w >> 1, h, BMP_PITCH);
 
+    if (h) markRows(y, (y + h) - 1);
+
     // load the palette
     if (loadpal)
     {
@@ -1162,6 +1481,100 @@ u16 BMP_drawBitmapScaled(const Bitmap *bitmap, u16 x, u16 y, u16 w, u16 h, u16 l
     return TRUE;
 }
 
+BitmapScale* BMP_createScale(u16 srcW, u16 srcH, u16 dstW, u16 dstH, u16 flags)
+{
+    const u16 dstWB = dstW >> 1;
+    BitmapScale *result = MEM_alloc(sizeof(BitmapScale) + ((dstWB + dstH) * 2));
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("BMP_createScale(..) failed: not enough memory, dstW = ", dstW, " dstH = ", dstH);
+#endif
+        return NULL;
+    }
+
+    result->srcW = srcW;
+    result->srcH = srcH;
+    result->dstW = dstWB << 1;
+    result->dstH = dstH;
+    result->flags = flags;
+    result->cols = (u16*) &result[1];
+    result->rows = result->cols + dstWB;
+
+    // 2 pixels per byte
+    if (dstWB) fillScaleTable(result->cols, srcW >> 1, dstWB, flags & BMP_SCALE_HFLIP);
+    if (dstH) fillScaleTable(result->rows, srcH, dstH, flags & BMP_SCALE_VFLIP);
+
+    return result;
+}
+
+void BMP_releaseScale(BitmapScale *scale)
+{
+    MEM_free(scale);
+}
+
+u16 BMP_drawBitmapScaledEx(const Bitmap *bitmap, s16 x, s16 y, const BitmapScale *scale)
+{
+    // work directly on linear buffer
+    if (HAS_TILELAYOUT) return FALSE;
+    // descriptor would read outside bitmap
+    if ((bitmap->w < scale->srcW) || (bitmap->h < scale->srcH)) return FALSE;
+
+    const u16 srcWB = bitmap->w >> 1;
+    const u16 *cols = scale->cols;
+    const u16 *rows = scale->rows;
+    s16 xb = x >> 1;
+    s16 wb = scale->dstW >> 1;
+    s16 h = scale->dstH;
+
+    // clip
+    if (xb < 0)
+    {
+        cols -= xb;
+        wb += xb;
+        xb = 0;
+    }
+    if ((xb + wb) > (s16) (viewW >> 1)) wb = (viewW >> 1) - xb;
+    if (y < 0)
+    {
+        rows -= y;
+        h += y;
+        y = 0;
+    }
+    if ((y + h) > (s16) viewH) h = viewH - y;
+    if ((wb <= 0) || (h <= 0)) return TRUE;
+
+    Bitmap *b = NULL;
+    const u8 *image;
+
+    // compressed bitmap ?
+    if (bitmap->compression != COMPRESSION_NONE)
+    {
+        b = unpackBitmap(bitmap, NULL);
+
+        if (b == NULL) return FALSE;
+
+        image = b->image;
+    }
+    else image = FAR_SAFE(bitmap->image, mulu(bitmap->w, bitmap->h) / 2);
+
+    const u16 swap = scale->flags & BMP_SCALE_HFLIP;
+    u8 *dst = bmp_buffer_write + (y * BMP_PITCH) + xb;
+
+    markRows(y, (y + h) - 1);
+
+    while(h--)
+    {
+        BMP_scaleLineA(image + mulu(*rows++, srcWB), dst, cols, wb, swap);
+        dst += BMP_PITCH;
+    }
+
+    if (b) MEM_free(b);
+
+    return TRUE;
+}
+
 void BMP_loadBitmapData(const u8 *image, u16 x, u16 y, u16 w, u16 h, u32 pitch)
 {
     BMP_drawBitmapData(image, x, y, w, h, pitch);
@@ -1252,7 +1665,7 @@ static HINTERRUPT_CALLBACK hint()
     {
         const u16 vcnt = GET_VCOUNTER;
         const u16 scrh = screenHeight;
-        const u16 vborder = (scrh - BMP_HEIGHT) >> 1;
+        const u16 vborder = (scrh - viewH) >> 1;
 
         // enable VDP
         VDP_setEnable(1);
@@ -1272,7 +1685,7 @@ static HINTERRUPT_CALLBACK hint()
         // disable VDP
         VDP_setEnable(0);
         // prepare hint to re enable VDP
-        VDP_setHIntCounter(((screenHeight - BMP_HEIGHT) >> 1) - 1);
+        VDP_setHIntCounter(((screenHeight - viewH) >> 1) - 1);
         // update phase
         phase = 3;
 
@@ -1313,7 +1726,7 @@ static void initTilemap(u16 index)
     plctrl = (u32 *) GFX_CTRL_PORT;
     pwdata = (u16 *) GFX_DATA_PORT;
 
-    i = BMP_TILE_HEIGHT;
+    i = tileH;
 
     while(i--)
     {
@@ -1321,19 +1734,9 @@ static void initTilemap(u16 index)
         *plctrl = GFX_WRITE_VRAM_ADDR(addr_tilemap);
 
         // write tilemap line to VDP
-        j = BMP_TILE_WIDTH >> 3;
+        j = tileW;
 
-        while(j--)
-        {
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-            *pwdata = tile_ind++;
-        }
+        while(j--) *pwdata = tile_ind++;
 
         addr_tilemap += BMP_PLANE_WIDTH * 2;
     }
@@ -1348,6 +1751,16 @@ static void clearVRAMBuffer(u16 index)
 
 static void flipBuffer()
 {
+    const u16 w = WRITE_IS_FB0?0:1;
+    u32 rows = 0;
+
+    // rows modified in write buffer since last flip make it (possibly) differ from both VRAM buffers
+    for(s16 i = BMP_TILE_HEIGHT - 1; i >= 0; i--)
+        rows = (rows << 1) | drawRows[i];
+    memset(drawRows, 0, sizeof(drawRows));
+    staleRows[w][0] |= rows;
+    staleRows[w][1] |= rows;
+
     if (READ_IS_FB0)
     {
         bmp_buffer_read = bmp_buffer_1;
@@ -1361,7 +1774,263 @@ static void flipBuffer()
 
     // we want buffer preservation ?
     if (HAS_BUFFERCOPY)
+    {
         copyBitmapBuffer(bmp_buffer_read, bmp_buffer_write);
+
+        // write buffer content is now the same as read buffer
+        staleRows[w ^ 1][0] = staleRows[w][0];
+        staleRows[w ^ 1][1] = staleRows[w][1];
+    }
+}
+
+// returns rows to transfer for read buffer blit and update stale rows state
+static u32 getBlitRows()
+{
+    const u16 r = READ_IS_FB0?0:1;
+    const u16 v = (HAS_DOUBLEBUFFER && READ_IS_FB1)?1:0;
+    const u32 rows = staleRows[r][v];
+
+    // VRAM buffer will contain read buffer so other RAM buffer differs from it where it differed from read buffer
+    staleRows[r ^ 1][v] |= rows;
+    staleRows[r][v] = 0;
+
+    // rows outside view are never transferred
+    const u32 mask = (1 << tileH) - 1;
+
+    // dirty blit disabled --> transfer all rows
+    if (!HAS_DIRTYBLIT) return mask;
+
+    return rows & mask;
+}
+
+static void markRows(s16 y0, s16 y1)
+{
+    // clip
+    if (y0 < 0) y0 = 0;
+    if (y1 >= BMP_HEIGHT) y1 = BMP_HEIGHT - 1;
+    if (y0 > y1) return;
+
+    memset(&drawRows[y0 >> BMP_YPIXPERTILE_SFT], 1, ((y1 >> BMP_YPIXPERTILE_SFT) - (y0 >> BMP_YPIXPERTILE_SFT)) + 1);
+}
+
+// byte offset of pixel in bitmap buffer
+static u16 getOffset(u16 x, u16 y)
+{
+    // tile ordered: tile row, tile then tile line
+    if (HAS_TILELAYOUT) return ((y >> BMP_YPIXPERTILE_SFT) * rowSize) + ((x >> BMP_XPIXPERTILE_SFT) << 5) + ((y & BMP_YPIXPERTILE_MASK) << 2) + ((x & BMP_XPIXPERTILE_MASK) >> 1);
+
+    return (y * BMP_PITCH) + (x >> 1);
+}
+
+// source index for each destination index (error accumulation stepping, same as BMP_scale(..))
+static void fillScaleTable(u16 *table, u16 srcSize, u16 dstSize, u16 mirror)
+{
+    const u16 q = divu(srcSize, dstSize);
+    const u16 r = modu(srcSize, dstSize);
+    u16 *d = mirror?(table + (dstSize - 1)):table;
+    const s16 step = mirror?-1:1;
+    u16 pos = 0;
+    u16 e = 0;
+    u16 i = dstSize;
+
+    while(i--)
+    {
+        *d = pos;
+        d += step;
+
+        pos += q;
+        if ((e += r) >= dstSize)
+        {
+            e -= dstSize;
+            pos++;
+        }
+    }
+}
+
+static void fillSpanTile(u16 x0, u16 x1, u16 y, u8 col)
+{
+    // tile line base
+    u8 *base = bmp_buffer_write + ((y >> BMP_YPIXPERTILE_SFT) * rowSize) + ((y & BMP_YPIXPERTILE_MASK) << 2);
+    u8 *d;
+
+    // odd first pixel (low nibble)
+    if (x0 & 1)
+    {
+        d = base + ((x0 >> 3) << 5) + ((x0 & 7) >> 1);
+        *d = (*d & 0xF0) | (col & 0x0F);
+        x0++;
+    }
+    // even last pixel (high nibble)
+    if (!(x1 & 1))
+    {
+        d = base + ((x1 >> 3) << 5) + ((x1 & 7) >> 1);
+        *d = (*d & 0x0F) | (col & 0xF0);
+        x1--;
+    }
+    if ((s16) x0 > (s16) x1) return;
+
+    const u32 col32 = col * 0x01010101;
+    const u16 be = x1 >> 1;
+    u16 b = x0 >> 1;
+
+    // full bytes, whole tile line written at once when possible
+    while(b <= be)
+    {
+        d = base + ((b >> 2) << 5) + (b & 3);
+
+        if (!(b & 3) && ((b + 3) <= be))
+        {
+            *(u32*) d = col32;
+            b += 4;
+        }
+        else
+        {
+            *d = col;
+            b++;
+        }
+    }
+}
+
+static void copySpanTile(const u8 *src, u16 srcX, u16 x, u16 y, u16 len)
+{
+    while(len--)
+    {
+        const u8 s = src[srcX >> 1];
+
+        // same nibble convention as linear buffer
+        BMP_setPixelFast(x++, y, (srcX++ & 1)?(s & 0x0F):(s >> 4));
+    }
+}
+
+static void drawLineTile(const Line *l)
+{
+    s16 x = l->pt1.x;
+    s16 y = l->pt1.y;
+    const s16 x2 = l->pt2.x;
+    const s16 y2 = l->pt2.y;
+    const s16 dx = abs(x2 - x);
+    const s16 dy = -abs(y2 - y);
+    const s16 sx = (x < x2)?1:-1;
+    const s16 sy = (y < y2)?1:-1;
+    const u8 col = l->col;
+    s16 err = dx + dy;
+
+    while(TRUE)
+    {
+        BMP_setPixelFast(x, y, col);
+
+        if ((x == x2) && (y == y2)) return;
+
+        const s16 e2 = err << 1;
+
+        if (e2 >= dy)
+        {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx)
+        {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+static u16 drawPolygonTile(const Vect2D_s16 *pts, u16 num, u8 col)
+{
+    s16 left[BMP_HEIGHT];
+    s16 right[BMP_HEIGHT];
+    s16 ymin = pts[0].y;
+    s16 ymax = ymin;
+
+    for(u16 i = 1; i < num; i++)
+    {
+        const s16 y = pts[i].y;
+
+        if (y < ymin) ymin = y;
+        else if (y > ymax) ymax = y;
+    }
+
+    // clip
+    if ((ymax < 0) || (ymin >= (s16) viewH)) return 0;
+    if (ymin < 0) ymin = 0;
+    if (ymax >= (s16) viewH) ymax = viewH - 1;
+
+    for(s16 y = ymin; y <= ymax; y++)
+    {
+        left[y] = 32767;
+        right[y] = -32768;
+    }
+
+    // walk edges (integer DDA) to get lines extent
+    for(u16 i = 0; i < num; i++)
+    {
+        const Vect2D_s16 *p0 = &pts[i];
+        const Vect2D_s16 *p1 = &pts[(i + 1 < num)?(i + 1):0];
+
+        // always from top to bottom
+        if (p0->y > p1->y)
+        {
+            const Vect2D_s16 *t = p0;
+            p0 = p1;
+            p1 = t;
+        }
+
+        const s16 dy = p1->y - p0->y;
+        const s16 dx = p1->x - p0->x;
+        const s16 yend = min(p1->y, ymax);
+        s16 x = p0->x;
+        s16 q = 0;
+        s16 r = 0;
+        s16 sr = 1;
+        s16 e = 0;
+
+        if (dy)
+        {
+            q = divs(dx, dy);
+            r = dx - (q * dy);
+            if (r < 0)
+            {
+                r = -r;
+                sr = -1;
+            }
+        }
+
+        for(s16 y = p0->y; y <= yend; y++)
+        {
+            if (y >= ymin)
+            {
+                const s16 xl = dy?x:min(x, p1->x);
+                const s16 xr = dy?x:max(x, p1->x);
+
+                if (xl < left[y]) left[y] = xl;
+                if (xr > right[y]) right[y] = xr;
+            }
+
+            x += q;
+            if ((e += r) >= dy)
+            {
+                e -= dy;
+                x += sr;
+            }
+        }
+    }
+
+    u16 res = 0;
+
+    for(s16 y = ymin; y <= ymax; y++)
+    {
+        const s16 xl = max(left[y], 0);
+        const s16 xr = min(right[y], (s16) (viewW - 1));
+
+        if (xl <= xr)
+        {
+            fillSpanTile(xl, xr, y, col);
+            res = 1;
+        }
+    }
+
+    return res;
 }
 
 static void doFlip()
@@ -1431,6 +2100,8 @@ static void doFlip()
 static u16 doBlit()
 {
     static u16 pos_i;
+    // remaining rows to transfer (bit 0 = row pos_i)
+    static u32 rows;
     vu32 *plctrl;
     vu32 *pldata;
     u32 *src;
@@ -1446,62 +2117,106 @@ static u16 doBlit()
     else
         addr_tile = BMP_FB0_ADDR;
 
-    /* point to vdp ctrl port */
-    plctrl = (u32 *) GFX_CTRL_PORT;
-
-    // previous blit not completed ?
-    if (state & BMP_STAT_BLITTING)
+    // start blit ?
+    if (!(state & BMP_STAT_BLITTING))
     {
-        // adjust tile address
-        addr_tile += pos_i * BMP_TILE_WIDTH * 32;
-        // adjust src pointer
-        src += pos_i * (BMP_YPIXPERTILE * (BMP_PITCH / 4));
-
-        // set destination address for tile
-        *plctrl = GFX_WRITE_VRAM_ADDR(addr_tile);
-    }
-    else
-    {
-        // start blit
         state |= BMP_STAT_BLITTING;
         pos_i = 0;
-
-        // set destination address for tile
-        *plctrl = GFX_WRITE_VRAM_ADDR(addr_tile);
+        rows = getBlitRows();
     }
 
-    const u16 remain = BMP_TILE_HEIGHT - pos_i;
+    // adjust tile address
+    addr_tile += pos_i * rowSize;
 
-    if (IS_PAL_SYSTEM)
+    // tile ordered layout: buffer rows are already in VRAM format
+    if (HAS_TILELAYOUT)
     {
-        if (remain < PAL_TILES_BW) i = remain;
-        else i = PAL_TILES_BW;
+        // max number of tile transfered per blank
+        if (IS_PAL_SYSTEM) i = PAL_TILES_BW_DMA * BMP_TILE_WIDTH;
+        else i = NTSC_TILES_BW_DMA * BMP_TILE_WIDTH;
+
+        while((i >= tileW) && rows)
+        {
+            u16 n = 0;
+
+            // consecutive modified rows are contiguous in both buffer and VRAM --> single transfer
+            while((rows & 1) && (i >= tileW))
+            {
+                rows >>= 1;
+                i -= tileW;
+                n++;
+            }
+
+            if (n)
+            {
+                DMA_doDma(DMA_VRAM, bmp_buffer_read + (pos_i * rowSize), addr_tile, (n * rowSize) / 2, 2);
+                pos_i += n;
+                addr_tile += n * rowSize;
+            }
+            else
+            {
+                rows >>= 1;
+                pos_i++;
+                addr_tile += rowSize;
+            }
+        }
     }
     else
     {
-        if (remain < NTSC_TILES_BW) i = remain;
-        else i = NTSC_TILES_BW;
-    }
+        // adjust src pointer
+        src += pos_i * (BMP_YPIXPERTILE * (BMP_PITCH / 4));
 
-    // save position
-    pos_i += i;
+        // max number of tile transfered per blank
+        if (IS_PAL_SYSTEM) i = PAL_TILES_BW * BMP_TILE_WIDTH;
+        else i = NTSC_TILES_BW * BMP_TILE_WIDTH;
 
-    /* point to vdp data port */
-    pldata = (u32 *) GFX_DATA_PORT;
+        /* point to vdp ctrl port */
+        plctrl = (u32 *) GFX_CTRL_PORT;
+        /* point to vdp data port */
+        pldata = (u32 *) GFX_DATA_PORT;
 
-    while(i--)
-    {
-        // send it to VRAM
-        TRANSFER8(0)
-        TRANSFER8(1)
-        TRANSFER8(2)
-        TRANSFER8(3)
+        // unmodified rows are skipped
+        while((i >= tileW) && rows)
+        {
+            if (rows & 1)
+            {
+                // set destination address for tile
+                *plctrl = GFX_WRITE_VRAM_ADDR(addr_tile);
+
+                // send it to VRAM
+                if (tileW == BMP_TILE_WIDTH)
+                {
+                    TRANSFER8(0)
+                    TRANSFER8(1)
+                    TRANSFER8(2)
+                    TRANSFER8(3)
+                }
+                else
+                {
+                    u32 *s = src;
+                    u16 j = tileW;
+
+                    while(j--)
+                    {
+                        TRANSFER(0)
+                        src++;
+                    }
+
+                    src = s;
+                }
+
+                i -= tileW;
+            }
 
-        src += (8 * BMP_PITCH) / 4;
+            rows >>= 1;
+            pos_i++;
+            src += (8 * BMP_PITCH) / 4;
+            addr_tile += rowSize;
+        }
     }
 
     // blit not yet done
-    if (pos_i < BMP_TILE_HEIGHT) return 0;
+    if (rows) return 0;
 
     // blit done
     state &= ~BMP_STAT_BLITTING;
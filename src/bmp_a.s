@@ -177,7 +177,7 @@ func BMP_setPixelA
     rts
 
 
-func BMP_setPixelsFast_V2D
+func BMP_setPixelsFastA_V2D
     move.l  4(%sp),%a0                      // a0 = crd
     move.b  11(%sp),%d1                     // d1 = col
     move.w  14(%sp),%d0                     // d0 = num
@@ -230,7 +230,7 @@ func BMP_setPixelsFast_V2D
     rts
 
 
-func BMP_setPixels_V2D
+func BMP_setPixelsA_V2D
     move.l  4(%sp),%a0                      // a0 = crd
     move.b  11(%sp),%d1                     // d1 = col
     move.w  14(%sp),%d0                     // d0 = num
@@ -297,7 +297,7 @@ func BMP_setPixels_V2D
     rts
 
 
-func BMP_setPixelsFast
+func BMP_setPixelsFastA
     move.l  4(%sp),%a0                      // a0 = pixels
     move.w  10(%sp),%d0                     // d0 = num
     subq.w  #1,%d0
@@ -349,7 +349,7 @@ func BMP_setPixelsFast
     rts
 
 
-func BMP_setPixels
+func BMP_setPixelsA
     move.l  4(%sp),%a0                      // a0 = pixels
     move.w  10(%sp),%d0                     // d0 = num
     subq.w  #1,%d0
@@ -570,7 +570,7 @@ func BMP_clipLine
     rts
 
 
-func BMP_drawLine
+func BMP_drawLineA
     movem.l %d2-%d7/%a2-%a5,-(%sp)
 
     move.l  44(%sp),%a0     // a0 = &line
@@ -1982,7 +1982,7 @@ fillEdgeFast:
     // a3 = rightEdge
     // a4 = free use
 
-func BMP_drawPolygon
+func BMP_drawPolygonA
     movm.l %d2-%d7/%a2-%a6,-(%sp)
 
     move.l 48(%sp),%a0      // a0 = pt = &pts[0]
@@ -3475,3 +3475,231 @@ func BMP_drawPolygon
     moveq #1,%d0
     movm.l (%sp)+,%d2-%d7/%a2-%a6
     rts
+
+
+// void BMP_fillSpanA(u16 x0, u16 x1, u16 y, u8 col): fill pixels [x0, x1] of line y (no bounds check, x0 <= x1)
+func BMP_fillSpanA
+    movm.l  %d2-%d4,-(%sp)
+
+    move.w  18(%sp),%d0                     // d0 = x0
+    move.w  22(%sp),%d1                     // d1 = x1
+    move.w  26(%sp),%d2                     // d2 = y
+    move.b  31(%sp),%d3                     // d3.b = col
+
+    move.l  bmp_buffer_write,%a0
+    lsl.w   #7,%d2
+    add.w   %d2,%a0                         // a0 = line = &bmp_buffer_write[y * BMP_PITCH]
+
+    btst    #0,%d0
+    jeq     .fsp_x0_even                    // if (x0 & 1)
+                                            // {
+    move.w  %d0,%d2
+    lsr.w   #1,%d2
+    lea     (%a0,%d2.w),%a1                 //   a1 = dst = &line[x0 >> 1]
+    moveq   #-16,%d2
+    and.b   (%a1),%d2
+    moveq   #15,%d4
+    and.b   %d3,%d4
+    or.b    %d4,%d2
+    move.b  %d2,(%a1)                       //   *dst = (*dst & 0xF0) | (col & 0x0F)
+    addq.w  #1,%d0                          //   x0++
+                                            // }
+.fsp_x0_even:
+    btst    #0,%d1
+    jne     .fsp_x1_odd                     // if (!(x1 & 1))
+                                            // {
+    move.w  %d1,%d2
+    lsr.w   #1,%d2
+    lea     (%a0,%d2.w),%a1                 //   a1 = dst = &line[x1 >> 1]
+    moveq   #15,%d2
+    and.b   (%a1),%d2
+    moveq   #-16,%d4
+    and.b   %d3,%d4
+    or.b    %d4,%d2
+    move.b  %d2,(%a1)                       //   *dst = (*dst & 0x0F) | (col & 0xF0)
+    subq.w  #1,%d1                          //   x1--
+                                            // }
+.fsp_x1_odd:
+    sub.w   %d0,%d1
+    jlt     .fsp_end                        // no more pixel
+    addq.w  #1,%d1
+    lsr.w   #1,%d1                          // d1 = n = number of full byte
+
+    lsr.w   #1,%d0
+    lea     (%a0,%d0.w),%a1                 // a1 = dst = &line[x0 >> 1]
+
+    move.b  %d3,%d2
+    lsl.w   #8,%d3
+    move.b  %d2,%d3
+    move.w  %d3,%d2
+    swap    %d3
+    move.w  %d2,%d3                         // d3 = col col col col
+
+    btst    #0,%d0
+    jeq     .fsp_aligned                    // dst not word aligned ?
+    move.b  %d3,(%a1)+                      //   align it
+    subq.w  #1,%d1
+
+.fsp_aligned:
+    move.w  %d1,%d2
+    lsr.w   #4,%d2                          // d2 = number of 16 bytes block
+    jra     .fsp_block_start
+
+.fsp_block_loop:
+    move.l  %d3,(%a1)+
+    move.l  %d3,(%a1)+
+    move.l  %d3,(%a1)+
+    move.l  %d3,(%a1)+
+.fsp_block_start:
+    dbra    %d2,.fsp_block_loop
+
+    btst    #3,%d1
+    jeq     .fsp_04
+    move.l  %d3,(%a1)+
+    move.l  %d3,(%a1)+
+.fsp_04:
+    btst    #2,%d1
+    jeq     .fsp_02
+    move.l  %d3,(%a1)+
+.fsp_02:
+    btst    #1,%d1
+    jeq     .fsp_01
+    move.w  %d3,(%a1)+
+.fsp_01:
+    btst    #0,%d1
+    jeq     .fsp_end
+    move.b  %d3,(%a1)
+
+.fsp_end:
+    movm.l  (%sp)+,%d2-%d4
+    rts
+
+
+// void BMP_copySpanA(const u8 *src, u16 srcX, u16 x, u16 y, u16 len): copy len pixels from 4bpp src line (starting at pixel srcX)
+// to pixel x of line y (no bounds check)
+func BMP_copySpanA
+    movm.l  %d2-%d4,-(%sp)
+
+    move.l  16(%sp),%a1                     // a1 = src
+    move.w  22(%sp),%d0                     // d0 = srcX
+    move.w  26(%sp),%d1                     // d1 = x
+    move.w  30(%sp),%d2                     // d2 = y
+    move.w  34(%sp),%d3                     // d3 = len
+    jeq     .csp_end
+
+    move.l  bmp_buffer_write,%a0
+    lsl.w   #7,%d2
+    add.w   %d2,%a0
+    move.w  %d1,%d2
+    lsr.w   #1,%d2
+    add.w   %d2,%a0                         // a0 = dst = &bmp_buffer_write[(y * BMP_PITCH) + (x >> 1)]
+    move.w  %d0,%d2
+    lsr.w   #1,%d2
+    add.w   %d2,%a1                         // a1 = s = &src[srcX >> 1]
+
+    btst    #0,%d1
+    jeq     .csp_x_even                     // if (x & 1)
+                                            // {
+    move.b  (%a1),%d2
+    btst    #0,%d0
+    jne     .csp_01                         //   src pixel in high nibble ?
+    lsr.b   #4,%d2                          //     move it to low nibble
+.csp_01:
+    and.b   #0x0F,%d2
+    moveq   #-16,%d4
+    and.b   (%a0),%d4
+    or.b    %d4,%d2
+    move.b  %d2,(%a0)+                      //   *dst++ = (*dst & 0xF0) | pixel
+    btst    #0,%d0
+    jeq     .csp_02
+    addq.l  #1,%a1                          //   src pixel was in low nibble --> next byte
+.csp_02:
+    addq.w  #1,%d0                          //   srcX++
+    subq.w  #1,%d3                          //   len--
+    jeq     .csp_end
+                                            // }
+.csp_x_even:
+    move.w  %d3,%d1
+    lsr.w   #1,%d1                          // d1 = number of full dst byte
+    btst    #0,%d0
+    jne     .csp_shift                      // src and dst not nibble aligned ?
+
+    // same alignment: straight byte copy
+    jra     .csp_copy_start
+
+.csp_copy_loop:
+    move.b  (%a1)+,(%a0)+
+.csp_copy_start:
+    dbra    %d1,.csp_copy_loop
+
+    btst    #0,%d3
+    jeq     .csp_end                        // last pixel (high nibble) ?
+    moveq   #-16,%d2
+    and.b   (%a1),%d2
+    moveq   #15,%d4
+    and.b   (%a0),%d4
+    or.b    %d4,%d2
+    move.b  %d2,(%a0)                       //   *dst = (*dst & 0x0F) | (*s & 0xF0)
+    jra     .csp_end
+
+.csp_shift:
+    // different alignment: dst byte = (s[0] << 4) | (s[1] >> 4)
+    move.b  (%a1)+,%d2                      // d2 = current src byte
+    jra     .csp_shift_start
+
+.csp_shift_loop:
+    move.b  (%a1)+,%d4                      // d4 = next src byte
+    lsl.b   #4,%d2
+    move.b  %d4,%d0
+    lsr.b   #4,%d0
+    or.b    %d0,%d2
+    move.b  %d2,(%a0)+
+    move.b  %d4,%d2                         // current = next
+.csp_shift_start:
+    dbra    %d1,.csp_shift_loop
+
+    btst    #0,%d3
+    jeq     .csp_end                        // last pixel (low nibble of current src byte) ?
+    lsl.b   #4,%d2
+    moveq   #15,%d4
+    and.b   (%a0),%d4
+    or.b    %d4,%d2
+    move.b  %d2,(%a0)                       //   *dst = (*dst & 0x0F) | (pixel << 4)
+
+.csp_end:
+    movm.l  (%sp)+,%d2-%d4
+    rts
+
+
+// void BMP_scaleLineA(const u8 *src, u8 *dst, const u16 *cols, u16 num, u16 swap): dst[i] = src[cols[i]] (nibbles swapped if swap)
+func BMP_scaleLineA
+    movm.l  %d2/%a2,-(%sp)
+
+    move.l  12(%sp),%a0                     // a0 = src
+    move.l  16(%sp),%a1                     // a1 = dst
+    move.l  20(%sp),%a2                     // a2 = cols
+    move.w  26(%sp),%d1                     // d1 = num
+    jeq     .scl_end
+    subq.w  #1,%d1
+
+    tst.w   30(%sp)
+    jne     .scl_swap
+
+.scl_loop:                                  // do {
+    move.w  (%a2)+,%d0
+    move.b  (%a0,%d0.w),(%a1)+              //   *dst++ = src[*cols++]
+    dbra    %d1,.scl_loop                   // } while(num--)
+
+    movm.l  (%sp)+,%d2/%a2
+    rts
+
+.scl_swap:                                  // do {
+    move.w  (%a2)+,%d0
+    move.b  (%a0,%d0.w),%d2
+    rol.b   #4,%d2                          //   mirror the 2 pixels
+    move.b  %d2,(%a1)+                      //   *dst++ = swap(src[*cols++])
+    dbra    %d1,.scl_swap                   // } while(num--)
+
+.scl_end:
+    movm.l  (%sp)+,%d2/%a2
+    rts
@@ -0,0 +1,408 @@
+#include "config.h"
+#include "types.h"
+
+#include "bmp_span.h"
+
+#include "bmp.h"
+#include "maths.h"
+#include "memory.h"
+#include "tools.h"
+
+
+typedef struct
+{
+    u16 firstPt;
+    u16 numPt;
+    s16 depth;
+    u16 col;
+} SpanPoly;
+
+
+// submitted polygons
+static SpanPoly* polys = NULL;
+static u16* order;
+static Vect2D_s16* points;
+static u16 maxPoly;
+static u16 maxPoint;
+static u16 numPoly;
+static u16 numPoint;
+
+// drawn spans (s-buffer), one sorted list per bitmap line (node index + 1, 0 = end of list)
+static s16* spanX0;
+static s16* spanX1;
+static u16* spanNext;
+static u16 lineHead[BMP_HEIGHT];
+static u16 maxSpan;
+static u16 numSpan;
+static u16 freeSpan;
+
+// current polygon extents
+static s16 lineLeft[BMP_HEIGHT];
+static s16 lineRight[BMP_HEIGHT];
+
+
+static void sortPolys(void);
+static bool computeExtents(const SpanPoly* poly, s16* ymin, s16* ymax);
+static void addEdge(const Vect2D_s16* p0, const Vect2D_s16* p1);
+static u16 drawSpan(s16 y, s16 xl, s16 xr, u8 col);
+static u16 allocSpan(void);
+static void releaseSpan(u16 node);
+
+
+bool SPAN_init(u16 maxP, u16 maxPt, u16 maxS)
+{
+    SPAN_end();
+
+    polys = MEM_alloc((maxP * (sizeof(SpanPoly) + 2)) + (maxPt * sizeof(Vect2D_s16)) + (maxS * 6));
+
+    if (polys == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U3("SPAN_init(..) failed: not enough memory, maxPoly = ", maxP, " maxPoint = ", maxPt, " maxSpan = ", maxS);
+#endif
+        return FALSE;
+    }
+
+    maxPoly = maxP;
+    maxPoint = maxPt;
+    maxSpan = maxS;
+    points = (Vect2D_s16*) &polys[maxP];
+    spanX0 = (s16*) &points[maxPt];
+    spanX1 = spanX0 + maxS;
+    spanNext = (u16*) (spanX1 + maxS);
+    order = spanNext + maxS;
+
+    SPAN_clear();
+
+    return TRUE;
+}
+
+void SPAN_end()
+{
+    if (polys == NULL) return;
+
+    MEM_free(polys);
+    polys = NULL;
+}
+
+void SPAN_clear()
+{
+    numPoly = 0;
+    numPoint = 0;
+}
+
+bool SPAN_addPolygon(const Vect2D_s16 *pts, u16 num, u8 col, s16 depth)
+{
+    if ((numPoly >= maxPoly) || ((numPoint + num) > maxPoint))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U2("SPAN_addPolygon(..) warning: too many polygons, numPoly = ", numPoly, " numPoint = ", numPoint);
+#endif
+        return FALSE;
+    }
+    // not a polygon
+    if (num < 3) return TRUE;
+
+    SpanPoly* poly = &polys[numPoly++];
+
+    poly->firstPt = numPoint;
+    poly->numPt = num;
+    poly->depth = depth;
+    poly->col = col;
+
+    memcpy(&points[numPoint], pts, num * sizeof(Vect2D_s16));
+    numPoint += num;
+
+    return TRUE;
+}
+
+u16 SPAN_addFaces(const Vect2D_s16 *pts, const u16 *indexes, u16 vertPerFace, u16 numFace, const u8 *cols, const s16 *depths, bool cull)
+{
+    Vect2D_s16 v[16];
+    const u16* ind = indexes;
+    u16 res = 0;
+
+    if (vertPerFace > 16) return 0;
+
+    for(u16 f = 0; f < numFace; f++)
+    {
+        for(u16 i = 0; i < vertPerFace; i++)
+            v[i] = pts[*ind++];
+
+        if (cull && BMP_isPolygonCulled(v, vertPerFace)) continue;
+        if (!SPAN_addPolygon(v, vertPerFace, cols[f], depths[f])) break;
+
+        res++;
+    }
+
+    return res;
+}
+
+u16 SPAN_render()
+{
+    u16 res = 0;
+
+    // clear s-buffer
+    memset(lineHead, 0, sizeof(lineHead));
+    numSpan = 0;
+    freeSpan = 0;
+
+    // front to back
+    sortPolys();
+
+    for(u16 i = 0; i < numPoly; i++)
+    {
+        const SpanPoly* poly = &polys[order[i]];
+        s16 ymin, ymax;
+
+        // outside bitmap ?
+        if (!computeExtents(poly, &ymin, &ymax)) continue;
+
+        for(s16 y = ymin; y <= ymax; y++)
+            res += drawSpan(y, lineLeft[y], lineRight[y], poly->col);
+
+        BMP_markDirty(ymin, (ymax - ymin) + 1);
+    }
+
+    SPAN_clear();
+
+    return res;
+}
+
+
+static void sortPolys()
+{
+    // insertion sort on depth (polygon list is short and often already almost sorted from one frame to another)
+    for(u16 i = 0; i < numPoly; i++)
+    {
+        const s16 d = polys[i].depth;
+        u16 j = i;
+
+        while(j && (polys[order[j - 1]].depth > d))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = i;
+    }
+}
+
+static bool computeExtents(const SpanPoly* poly, s16* ymin, s16* ymax)
+{
+    const Vect2D_s16* pts = &points[poly->firstPt];
+    const u16 num = poly->numPt;
+    s16 y0 = pts[0].y;
+    s16 y1 = y0;
+    s16 xmin = pts[0].x;
+    s16 xmax = xmin;
+
+    for(u16 i = 1; i < num; i++)
+    {
+        const s16 x = pts[i].x;
+        const s16 y = pts[i].y;
+
+        if (y < y0) y0 = y;
+        else if (y > y1) y1 = y;
+        if (x < xmin) xmin = x;
+        else if (x > xmax) xmax = x;
+    }
+
+    // clip to bitmap
+    if ((y1 < 0) || (y0 >= BMP_HEIGHT) || (xmax < 0) || (xmin >= BMP_WIDTH)) return FALSE;
+    if (y0 < 0) y0 = 0;
+    if (y1 >= BMP_HEIGHT) y1 = BMP_HEIGHT - 1;
+
+    for(s16 y = y0; y <= y1; y++)
+    {
+        lineLeft[y] = 32767;
+        lineRight[y] = -32768;
+    }
+
+    for(u16 i = 0; i < num; i++)
+        addEdge(&pts[i], &pts[(i + 1 < num)?(i + 1):0]);
+
+    *ymin = y0;
+    *ymax = y1;
+
+    return TRUE;
+}
+
+static void addEdge(const Vect2D_s16* p0, const Vect2D_s16* p1)
+{
+    // always walk edge from top to bottom so a shared edge gives the same pixels for both polygons
+    if (p0->y > p1->y)
+    {
+        const Vect2D_s16* t = p0;
+        p0 = p1;
+        p1 = t;
+    }
+
+    s16 y = p0->y;
+    s16 yend = p1->y;
+    const s16 dy = yend - y;
+    const s16 dx = p1->x - p0->x;
+    s16 x = p0->x;
+    s16 q, r, e, sr;
+
+    if (dy)
+    {
+        q = divs(dx, dy);
+        r = dx - (q * dy);
+    }
+    else
+    {
+        q = 0;
+        r = 0;
+    }
+
+    // remainder step direction
+    if (r < 0)
+    {
+        r = -r;
+        sr = -1;
+    }
+    else sr = 1;
+
+    e = 0;
+
+    // clip bottom (lines above bitmap are skipped in loop)
+    if (yend >= BMP_HEIGHT) yend = BMP_HEIGHT - 1;
+
+    while(y <= yend)
+    {
+        if (y >= 0)
+        {
+            s16 xl = x;
+            s16 xr = x;
+
+            // horizontal edge: whole edge belongs to the line
+            if (!dy) xr = p1->x;
+            if (xl > xr)
+            {
+                xl = xr;
+                xr = x;
+            }
+
+            if (xl < lineLeft[y]) lineLeft[y] = xl;
+            if (xr > lineRight[y]) lineRight[y] = xr;
+        }
+
+        x += q;
+        e += r;
+        if (e >= dy)
+        {
+            e -= dy;
+            x += sr;
+        }
+
+        y++;
+    }
+}
+
+// draw visible part of span [xl, xr] on line y and add it to the s-buffer, returns number of filled spans
+static u16 drawSpan(s16 y, s16 xl, s16 xr, u8 col)
+{
+    u16* link;
+    u16 n;
+    s16 cur;
+    u16 res = 0;
+
+    // clip
+    if (xl < 0) xl = 0;
+    if (xr >= BMP_WIDTH) xr = BMP_WIDTH - 1;
+    if (xl > xr) return 0;
+
+    // fill pixels not yet covered
+    cur = xl;
+    n = lineHead[y];
+    while(n && (cur <= xr))
+    {
+        const s16 a = spanX0[n - 1];
+        const s16 b = spanX1[n - 1];
+
+        if (a > xr) break;
+        if (b >= cur)
+        {
+            if (a > cur)
+            {
+                BMP_fillSpan(cur, a - 1, y, col);
+                res++;
+            }
+
+            cur = b + 1;
+        }
+
+        n = spanNext[n - 1];
+    }
+    if (cur <= xr)
+    {
+        BMP_fillSpan(cur, xr, y, col);
+        res++;
+    }
+
+    // nothing drawn --> s-buffer unchanged
+    if (!res) return 0;
+
+    // merge [xl, xr] in the sorted span list of the line
+    link = &lineHead[y];
+    while((n = *link) && (spanX1[n - 1] < (xl - 1))) link = &spanNext[n - 1];
+
+    // no touching span --> insert a new one
+    if (!n || (spanX0[n - 1] > (xr + 1)))
+    {
+        const u16 node = allocSpan();
+
+        // s-buffer full: farther polygons may overdraw this span
+        if (!node) return res;
+
+        spanX0[node - 1] = xl;
+        spanX1[node - 1] = xr;
+        spanNext[node - 1] = n;
+        *link = node;
+
+        return res;
+    }
+
+    // extend touching span and absorb following ones
+    if (xl < spanX0[n - 1]) spanX0[n - 1] = xl;
+    if (xr > spanX1[n - 1]) spanX1[n - 1] = xr;
+
+    u16 next;
+    while((next = spanNext[n - 1]) && (spanX0[next - 1] <= (spanX1[n - 1] + 1)))
+    {
+        if (spanX1[next - 1] > spanX1[n - 1]) spanX1[n - 1] = spanX1[next - 1];
+        spanNext[n - 1] = spanNext[next - 1];
+        releaseSpan(next);
+    }
+
+    return res;
+}
+
+static u16 allocSpan()
+{
+    const u16 node = freeSpan;
+
+    // reuse released node
+    if (node)
+    {
+        freeSpan = spanNext[node - 1];
+        return node;
+    }
+
+    if (numSpan >= maxSpan)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("SPAN_render() warning: span buffer is full, maxSpan = ", maxSpan);
+#endif
+        return 0;
+    }
+
+    return ++numSpan;
+}
+
+static void releaseSpan(u16 node)
+{
+    spanNext[node - 1] = freeSpan;
+    freeSpan = node;
+}
@@ -1,3 +1,4 @@
+#include "config.h"
 #include "task_cst.h"
 
 .section .text.keepboot
@@ -271,12 +272,23 @@ no_user_task:
         movem.l %d0-%d1/%a0-%a1,-(%sp)
         ori.w   #0x0001, intTrace           /* in V-Int */
         addq.l  #1, vtimer                  /* increment frame counter (more a vint counter) */
+#if (ENABLE_TRACE != 0)
+        jsr     _trace_vint_start           /* trace frame and V-Int begin */
+#endif
         btst    #3, VBlankProcess+1         /* PROCESS_XGM_TASK ? (use VBlankProcess+1 as btst is a byte operation) */
         beq.s   no_xgm_task
 
         jsr     XGM_doVBlankProcess         /* do XGM vblank task */
 
 no_xgm_task:
+#if (MODULE_FRACTAL != 0)
+        btst    #2, VBlankProcess           /* PROCESS_FRACTAL_TASK ? (bit 10 so use high byte of VBlankProcess) */
+        beq.s   no_fractal_task
+
+        jsr     Fractal_doVBlankProcess     /* do Fractal vblank task */
+
+no_fractal_task:
+#endif
         btst    #1, VBlankProcess+1         /* PROCESS_BITMAP_TASK ? (use VBlankProcess+1 as btst is a byte operation) */
         beq.s   no_bmp_task
 
@@ -285,6 +297,9 @@ no_xgm_task:
 no_bmp_task:
         move.l  vintCB, %a0                 /* load user callback */
         jsr    (%a0)                        /* call user callback */
+#if (ENABLE_TRACE != 0)
+        jsr     _trace_vint_end             /* trace V-Int end */
+#endif
         andi.w  #0xFFFE, intTrace           /* out V-Int */
         movem.l (%sp)+,%d0-%d1/%a0-%a1
         rte
@@ -0,0 +1,345 @@
+#include "config.h"
+#include "types.h"
+
+#include "collision.h"
+
+#include "memory.h"
+#include "tools.h"
+
+
+// body bounding box left edge bias so it can be sorted as unsigned (sort key = biased X << 16 | body index)
+#define KEY_BIAS        0x8000
+
+
+static ColBody* bodies = NULL;
+static u32* keys;
+static u16 maxBodies;
+static u16 numBodies;
+
+
+// mask rows overlap test (collision_a.s)
+extern bool COL_testRowsA(const u32* a, const u32* b, u16 num, s16 shift);
+
+// forward
+static ColBody* addBody(u16 type, s16 x, s16 y, u16 w, u16 h, u16 layer, u16 mask, void* data);
+static bool testBoxCircle(const ColBody* box, const ColBody* circle);
+static const u32* getMaskRows(const CollisionMask* mask, u16 flip);
+
+
+bool COL_init(u16 maxBody)
+{
+    COL_end();
+
+    // allocate bodies and sort keys at once
+    bodies = MEM_alloc(maxBody * (sizeof(ColBody) + sizeof(u32)));
+
+    if (bodies == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("COL_init(..) failed: not enough memory, maxBody = ", maxBody);
+#endif
+        return FALSE;
+    }
+
+    keys = (u32*) (bodies + maxBody);
+    maxBodies = maxBody;
+    numBodies = 0;
+
+    return TRUE;
+}
+
+void COL_end()
+{
+    if (bodies) MEM_free(bodies);
+    bodies = NULL;
+    maxBodies = 0;
+    numBodies = 0;
+}
+
+
+void COL_clear()
+{
+    numBodies = 0;
+}
+
+u16 COL_getNumBody()
+{
+    return numBodies;
+}
+
+
+ColBody* COL_addBox(s16 x, s16 y, u16 w, u16 h, u16 layer, u16 mask, void* data)
+{
+    return addBody(COLLISION_TYPE_BOX, x, y, w, h, layer, mask, data);
+}
+
+ColBody* COL_addCircle(s16 x, s16 y, u16 ray, u16 layer, u16 mask, void* data)
+{
+    return addBody(COLLISION_TYPE_CIRCLE, x - ray, y - ray, ray * 2, ray * 2, layer, mask, data);
+}
+
+ColBody* COL_addSprite(const Sprite* sprite, bool attack, u16 layer, u16 mask, void* data)
+{
+    const AnimationFrame* frame = sprite->frame;
+    const Collision* col;
+
+    if ((frame == NULL) || ((col = frame->collision) == NULL)) return NULL;
+
+    const u16 type = attack ? col->typeAttack : col->typeHit;
+    const SpriteDefinition* def = sprite->definition;
+    const u16 attr = sprite->attribut;
+    // sprite position is offseted by 0x80 (VDP position)
+    const s16 sx = sprite->x - 0x80;
+    const s16 sy = sprite->y - 0x80;
+
+    if (type == COLLISION_TYPE_BOX)
+    {
+        const BoxCollision* box = attack ? &col->attack.box : &col->hit.box;
+        s16 x = box->x;
+        s16 y = box->y;
+
+        // flip box inside frame cell
+        if (attr & TILE_ATTR_HFLIP_MASK) x = def->w - (x + box->w);
+        if (attr & TILE_ATTR_VFLIP_MASK) y = def->h - (y + box->h);
+
+        return addBody(COLLISION_TYPE_BOX, sx + x, sy + y, box->w, box->h, layer, mask, data);
+    }
+    if (type == COLLISION_TYPE_CIRCLE)
+    {
+        const CircleCollision* circle = attack ? &col->attack.circle : &col->hit.circle;
+        const u16 ray = circle->ray;
+        s16 x = circle->x;
+        s16 y = circle->y;
+
+        // flip center inside frame cell
+        if (attr & TILE_ATTR_HFLIP_MASK) x = def->w - x;
+        if (attr & TILE_ATTR_VFLIP_MASK) y = def->h - y;
+
+        return addBody(COLLISION_TYPE_CIRCLE, (sx + x) - ray, (sy + y) - ray, ray * 2, ray * 2, layer, mask, data);
+    }
+
+    return NULL;
+}
+
+
+bool COL_testBodies(const ColBody* a, const ColBody* b)
+{
+    // bounding boxes test
+    if ((a->x >= (b->x + (s16) b->w)) || (b->x >= (a->x + (s16) a->w))) return FALSE;
+    if ((a->y >= (b->y + (s16) b->h)) || (b->y >= (a->y + (s16) a->h))) return FALSE;
+
+    if (a->type == COLLISION_TYPE_CIRCLE)
+    {
+        // circle / box
+        if (b->type != COLLISION_TYPE_CIRCLE) return testBoxCircle(b, a);
+
+        // circle / circle (bounding box position + ray = center)
+        const s16 ra = a->w >> 1;
+        const s16 rb = b->w >> 1;
+        const s16 dx = (a->x + ra) - (b->x + rb);
+        const s16 dy = (a->y + ra) - (b->y + rb);
+        const s16 r = ra + rb;
+
+        // 16x16 bits multiplications
+        return (((s32) dx * dx) + ((s32) dy * dy)) < ((s32) r * r);
+    }
+
+    // box / circle
+    if (b->type == COLLISION_TYPE_CIRCLE) return testBoxCircle(a, b);
+
+    // box / box (bounding boxes overlap)
+    return TRUE;
+}
+
+u16 COL_getPairs(ColPair* pairs, u16 maxPair)
+{
+    const u16 num = numBodies;
+    ColPair* pair = pairs;
+    u16 remain = maxPair;
+
+    if (num < 2) return 0;
+
+    // sort bodies on their left edge
+    for(u16 i = 0; i < num; i++)
+        keys[i] = ((u32) (u16) (bodies[i].x + KEY_BIAS) << 16) | i;
+    qsort_u32(keys, 0, num - 1);
+
+    // sweep: only bodies starting before the current body right edge can overlap it
+    for(u16 i = 0; i < num; i++)
+    {
+        ColBody* a = &bodies[keys[i] & 0xFFFF];
+        const u16 maxKey = (u16) (a->x + (s16) a->w + KEY_BIAS);
+        const u16 layer = a->layer;
+        const u16 mask = a->mask;
+
+        for(u16 j = i + 1; (j < num) && ((keys[j] >> 16) < maxKey); j++)
+        {
+            ColBody* b = &bodies[keys[j] & 0xFFFF];
+
+            // layers check first (cheap)
+            if (mask & b->layer)
+            {
+                if (!COL_testBodies(a, b)) continue;
+
+                pair->a = a;
+                pair->b = b;
+            }
+            else if (b->mask & layer)
+            {
+                if (!COL_testBodies(a, b)) continue;
+
+                pair->a = b;
+                pair->b = a;
+            }
+            else continue;
+
+            pair++;
+
+            // pair array is full
+            if (--remain == 0)
+            {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+                KLog_U1("COL_getPairs(..) warning: pair array is full, maxPair = ", maxPair);
+#endif
+                return maxPair;
+            }
+        }
+    }
+
+    return maxPair - remain;
+}
+
+
+bool COL_testMasks(const CollisionMask* a, u16 flipA, s16 ax, s16 ay, const CollisionMask* b, u16 flipB, s16 bx, s16 by)
+{
+    // keep A on the left
+    if (bx < ax)
+    {
+        const CollisionMask* m = a; a = b; b = m;
+        const u16 f = flipA; flipA = flipB; flipB = f;
+        s16 t = ax; ax = bx; bx = t;
+        t = ay; ay = by; by = t;
+    }
+
+    const s16 dx = bx - ax;
+    // no horizontal overlap
+    if (dx >= a->w) return FALSE;
+
+    // vertical overlap
+    const s16 y0 = max(ay, by);
+    const s16 y1 = min(ay + a->h, by + b->h);
+    if (y0 >= y1) return FALSE;
+
+    const u16 num = y1 - y0;
+    const u16 ha = a->h;
+    const u16 hb = b->h;
+    const u16 numColA = a->numCol;
+    const u16 numColB = b->numCol;
+    // A column 'c' faces B column 'c - q' (B >> s) and B column 'c - q - 1' (B << (32 - s))
+    const u16 q = dx >> 5;
+    const u16 s = dx & 31;
+    // first overlapping row in each column
+    const u32* rowsA = getMaskRows(a, flipA) + (y0 - ay);
+    const u32* rowsB = getMaskRows(b, flipB) + (y0 - by);
+
+    for(u16 ca = q; ca < numColA; ca++)
+    {
+        const u16 cb = ca - q;
+        const u32* ra = rowsA + (ca * ha);
+
+        if ((cb < numColB) && COL_testRowsA(ra, rowsB + (cb * hb), num, s)) return TRUE;
+        if (s && cb && ((cb - 1) < numColB) && COL_testRowsA(ra, rowsB + ((cb - 1) * hb), num, s - 32)) return TRUE;
+    }
+
+    return FALSE;
+}
+
+bool COL_testSpriteMasks(const Sprite* a, const Sprite* b)
+{
+    const AnimationFrame* frameA = a->frame;
+    const AnimationFrame* frameB = b->frame;
+    const CollisionMask* maskA;
+    const CollisionMask* maskB;
+
+    // no mask ? keep broadphase result
+    if ((frameA == NULL) || (frameB == NULL)) return TRUE;
+    if (((maskA = frameA->mask) == NULL) || ((maskB = frameB->mask) == NULL)) return TRUE;
+
+    const SpriteDefinition* defA = a->definition;
+    const SpriteDefinition* defB = b->definition;
+    const u16 flipA = (a->attribut >> TILE_ATTR_HFLIP_SFT) & 3;
+    const u16 flipB = (b->attribut >> TILE_ATTR_HFLIP_SFT) & 3;
+    // sprite position is offseted by 0x80 (VDP position)
+    s16 ax = a->x - 0x80;
+    s16 ay = a->y - 0x80;
+    s16 bx = b->x - 0x80;
+    s16 by = b->y - 0x80;
+
+    // flip mask area inside frame cell
+    ax += (flipA & 1) ? defA->w - (maskA->x + maskA->w) : maskA->x;
+    ay += (flipA & 2) ? defA->h - (maskA->y + maskA->h) : maskA->y;
+    bx += (flipB & 1) ? defB->w - (maskB->x + maskB->w) : maskB->x;
+    by += (flipB & 2) ? defB->h - (maskB->y + maskB->h) : maskB->y;
+
+    return COL_testMasks(maskA, flipA, ax, ay, maskB, flipB, bx, by);
+}
+
+
+static ColBody* addBody(u16 type, s16 x, s16 y, u16 w, u16 h, u16 layer, u16 mask, void* data)
+{
+    if (numBodies >= maxBodies)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("COL_addXXX(..) failed: max number of body reached = ", maxBodies);
+#endif
+        return NULL;
+    }
+
+    ColBody* body = &bodies[numBodies++];
+
+    body->x = x;
+    body->y = y;
+    body->w = w;
+    body->h = h;
+    body->type = type;
+    body->layer = layer;
+    body->mask = mask;
+    body->data = data;
+
+    return body;
+}
+
+static bool testBoxCircle(const ColBody* box, const ColBody* circle)
+{
+    const s16 r = circle->w >> 1;
+    const s16 cx = circle->x + r;
+    const s16 cy = circle->y + r;
+    s16 dx;
+    s16 dy;
+
+    // distance from circle center to nearest box point
+    if (cx < box->x) dx = box->x - cx;
+    else if (cx >= (box->x + (s16) box->w)) dx = (cx - (box->x + (s16) box->w)) + 1;
+    else dx = 0;
+    if (cy < box->y) dy = box->y - cy;
+    else if (cy >= (box->y + (s16) box->h)) dy = (cy - (box->y + (s16) box->h)) + 1;
+    else dy = 0;
+
+    return (((s32) dx * dx) + ((s32) dy * dy)) < ((s32) r * r);
+}
+
+static const u32* getMaskRows(const CollisionMask* mask, u16 flip)
+{
+    const u32* rows = mask->rows[flip];
+
+    // flip variant not exported --> use unflipped mask
+    if (rows == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("COL_testMasks(..) warning: mask flip variant not available (use MASK_FLIP collision), flip = ", flip);
+#endif
+        return mask->rows[0];
+    }
+
+    return rows;
+}
@@ -0,0 +1,42 @@
+#include "asm_mac.i"
+
+// bool COL_testRowsA(const u32* a, const u32* b, u16 num, s16 shift)
+// test a[i] & (b[i] >> shift) (b[i] << -shift when shift < 0) for i in [0..num-1], returns TRUE on first overlap
+func COL_testRowsA
+    move.l  %d2,-(%sp)
+
+    move.l  8(%sp),%a0                      // a0 = a
+    move.l  12(%sp),%a1                     // a1 = b
+    move.w  18(%sp),%d0                     // d0 = num
+    jeq     .ctr_none
+    subq.w  #1,%d0
+    move.w  22(%sp),%d1                     // d1 = shift
+    jmi     .ctr_left
+
+.ctr_right:                                 // do {
+    move.l  (%a1)+,%d2
+    lsr.l   %d1,%d2
+    and.l   (%a0)+,%d2                      //   overlap = a & (b >> shift)
+    dbne    %d0,.ctr_right                  // } while(!overlap && num--)
+    jne     .ctr_hit
+    jra     .ctr_none
+
+.ctr_left:
+    neg.w   %d1                             // d1 = -shift
+
+.ctr_left_loop:                             // do {
+    move.l  (%a1)+,%d2
+    lsl.l   %d1,%d2
+    and.l   (%a0)+,%d2                      //   overlap = a & (b << -shift)
+    dbne    %d0,.ctr_left_loop              // } while(!overlap && num--)
+    jne     .ctr_hit
+
+.ctr_none:
+    moveq   #0,%d0
+    move.l  (%sp)+,%d2
+    rts
+
+.ctr_hit:
+    moveq   #1,%d0
+    move.l  (%sp)+,%d2
+    rts
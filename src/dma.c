@@ -9,23 +9,109 @@
 #include "kdebug.h"
 #include "tools.h"
 #include "timer.h"
+#include "profiler.h"
 
 
 //#define DMA_DEBUG
 
 #define DMA_AUTOFLUSH               1
 #define DMA_OVERCAPACITY_IGNORE     2
+#define DMA_DOUBLEBUFFER            4
+#define DMA_AUTOCAPACITY            8
 
+// VBlank lines kept for V-Int processing when computing DMA capacity
+#define CAPACITY_MARGIN_LINES       3
+
+// queue entry flags
+#define ENTRY_PRIORITY_MASK         0x03
+#define ENTRY_VDP_OP                0x04
+#define ENTRY_BLOCKS_DESC           0x08
+#define ENTRY_BLOCKS                0x10
+#define ENTRY_MIDFRAME              0x20
+#define ENTRY_SELECTED              0x40
+#define ENTRY_DEFERRED              0x80
+
+#define HINT_FLUSH_BLANK            0x01
+#define HINT_FLUSH_BLANKED          0x02
+
+// number of block transfers expanded at once
+#define BLOCK_BATCH_SIZE            8
+
+#if (ENABLE_DMA_STATS != 0)
+#define STAT_INC(field)             stats.field++
+#else
+#define STAT_INC(field)
+#endif
+
+
+// block transfer descriptor (stored in the queue entry following the first block transfer)
+typedef struct
+{
+    u16 num;
+    u16 fromStride;
+    u16 toStride;
+    u16 unused[5];
+} DMABlockDesc;
+
+// queued VRAM fill / copy operation (stored in place of a DMA transfer entry)
+#define VDP_OP_FILL                 0
+#define VDP_OP_COPY                 1
+#define VDP_OP_FENCE                2
+#define VDP_OP_CPU                  3
+
+typedef struct
+{
+    u16 type;
+    u16 from;
+    u16 to;
+    u16 len;
+    s16 step;
+    u16 value;
+    u16 unused[2];
+} DMAVDPOp;
+
+// queued CPU copy (stored in place of a DMA transfer entry)
+typedef struct
+{
+    u16 type;
+    u16 location;
+    u16 to;
+    u16 len;
+    s16 step;
+    u16 unused;
+    void* from;
+} DMACPUOp;
+
+// queued fence (stored in place of a DMA transfer entry)
+typedef struct
+{
+    u16 type;
+    u16 id;
+    DMACallback* callback;
+    u32 unused[2];
+} DMAFence;
 
 // we don't want to share it
 extern vu16 VBlankProcess;
 
 // DMA queue (initialized on reset)
 DMAOpInfo *dmaQueues;
+// DMA queue entry flags (priority...), allocated along queue
+static u8 *queueFlags;
 
 // DMA data buffer (initialized on reset)
 u16* dmaDataBuffer;
+
+#if (ENABLE_DMA_STATIC_MEMORY != 0)
+// DMA queue and buffer in static RAM region
+static DMAOpInfo staticQueue[DMA_QUEUE_SIZE_STATIC] RAM_REGION;
+static u8 staticQueueFlags[DMA_QUEUE_SIZE_STATIC] RAM_REGION;
+static u16 staticDataBuffer[DMA_BUFFER_SIZE_STATIC / 2] RAM_REGION;
+#endif
 static u16* nextDataBuffer;
+// DMA data buffer bank currently filled (whole buffer if double buffering is disabled)
+static u16* fillBuffer;
+static u16* fillBufferEnd;
 
 // DMA queue settings
 static u16 queueSize;
@@ -39,9 +125,60 @@ static u16 dataBufferSize;
 static u16 queueIndex;
 static u16 queueIndexLimit;
 static u16 queueTransferSize;
+// priority for next queued transfers
+static u16 queuePriority;
+// flags for next queued entries (priority + mid frame)
+static u8 entryFlags;
+// number of transfers merged into previous entry (since last flush)
+static u16 queueMergeCount;
+// maximum transfer length done through the CPU for TRANSFER_AUTO
+static u16 autoCPULen;
+
+// mid frame transfers pending for H-Int flush: [midFrameIndex, midFrameEnd[
+static vu16 midFrameIndex;
+static u16 midFrameEnd;
+// size transferred by mid frame flush since last VBlank flush
+static vu16 midFrameDrained;
+// H-Int flush settings
+static u16 hIntLine;
+static vu16 hIntFlag;
+
+// last queued and last completed fence id
+static u16 fenceId;
+static vu16 completedFence;
+
+#if (ENABLE_DMA_STATS != 0)
+static DMAStats stats;
+#endif
 
 // do not share (assembly methods)
-extern void flushQueue(u16 num);
+extern void flushQueue(DMAOpInfo* info, u16 num);
+
+// forward
+static void flushEntries(DMAOpInfo* info, u16 num);
+static void flushRawEntries(DMAOpInfo* info, u16 num);
+static void flushBlocks(const DMAOpInfo* info);
+static void flushVDPOp(const DMAOpInfo* info);
+static bool queueVDPOp(u16 type, u16 from, u16 to, u16 len, s16 step, u8 value);
+static bool queueCPUCopy(u8 location, void* from, u16 to, u16 len, u16 step);
+static u16 getEntryDest(const DMAOpInfo* info);
+static void setEntryAddress(DMAOpInfo* info, u32 from, u16 to);
+static void flushSelectedEntries(void);
+static bool isFence(const DMAOpInfo* info, u8 f);
+static u16 getEntrySize(const DMAOpInfo* info);
+static DMAOpInfo* getFreeEntry(void);
+static bool checkCapacity(void);
+static bool mergeWithLastEntry(u8 location, u32 fromAddr, u16 to, u16 len, u16 step);
+static void removeDrainedEntries(void);
+static void advanceEntry(DMAOpInfo* info, u16 len);
+static HINTERRUPT_CALLBACK hIntFlush(void);
+static u16 computeCapacity(u16 elapsedLines);
+static void resetBufferBank(void);
+static void swapBufferBank(void);
+#if (ENABLE_DMA_STATS != 0)
+static void updateStats(void);
+static void updateOverrunStats(void);
+#endif
 
 
 void DMA_init()
@@ -51,38 +188,76 @@ void DMA_init()
 
 void DMA_initEx(u16 size, u16 capacity, u16 bufferSize)
 {
+    // tag DMA allocations
+    const u16 tag = MEM_setTag(MEM_TAG_DMA);
+
     // -1/65535 means no limit
     maxTransferPerFrame = capacity;
     // auto flush is enabled by default
     flag = DMA_AUTOFLUSH;
     VBlankProcess |= PROCESS_DMA_TASK;
+    autoCPULen = DMA_AUTO_CPU_LEN_DEFAULT;
 
-    // release buffers first
-    if (dmaQueues)
+#if (ENABLE_DMA_STATIC_MEMORY != 0)
+    // define queue size (limited to static queue)
+    if (size) queueSize = min(DMA_QUEUE_SIZE_STATIC, max(DMA_QUEUE_SIZE_MIN, size));
+    else queueSize = min(DMA_QUEUE_SIZE_STATIC, DMA_QUEUE_SIZE_DEFAULT);
+
+    // use static DMA queue
+    dmaQueues = staticQueue;
+    queueFlags = staticQueueFlags;
+#else
+    // define queue size
+    const u16 newQueueSize = size ? max(DMA_QUEUE_SIZE_MIN, size) : DMA_QUEUE_SIZE_DEFAULT;
+    // define data buffer size (in words)
+    const u16 newBufferSize = max(DMA_BUFFER_SIZE_MIN, bufferSize ? bufferSize : (IS_PAL_SYSTEM ? DMA_BUFFER_SIZE_PAL_LOW : DMA_BUFFER_SIZE_NTSC)) / 2;
+    bool released = FALSE;
+
+    // release buffers first (only if size changed, we keep them otherwise to avoid useless free / pack / alloc)
+    if (dmaQueues && (newQueueSize != queueSize))
     {
         MEM_free(dmaQueues);
+        MEM_free(queueFlags);
         dmaQueues = NULL;
+        queueFlags = NULL;
+        released = TRUE;
     }
-    if (dmaDataBuffer)
+    if (dmaDataBuffer && (newBufferSize != dataBufferSize))
     {
         MEM_free(dmaDataBuffer);
         dmaDataBuffer = NULL;
+        released = TRUE;
     }
 
     // try to pack memory free blocks (help to avoid memory fragmentation)
-    MEM_pack();
+    if (released) MEM_pack();
 
-    // define queue size
-    if (size) queueSize = max(DMA_QUEUE_SIZE_MIN, size);
-    else queueSize = DMA_QUEUE_SIZE_DEFAULT;
+    queueSize = newQueueSize;
 
     // allocate DMA queue
-    dmaQueues = MEM_alloc(queueSize * sizeof(DMAOpInfo));
+    if (!dmaQueues)
+    {
+        dmaQueues = MEM_alloc(queueSize * sizeof(DMAOpInfo));
+        queueFlags = MEM_alloc(queueSize * sizeof(u8));
+    }
+#endif
+    // default priority
+    queuePriority = DMA_PRIORITY_NORMAL;
+    entryFlags = queuePriority;
+    hIntLine = 0;
+    hIntFlag = 0;
+    fenceId = 0;
+    completedFence = 0;
+#if (ENABLE_DMA_STATS != 0)
+    DMA_resetStats();
+#endif
 
     // define DMA data buffer size (in words)
     // this actually clear the DMA queue
     if (bufferSize) DMA_setBufferSize(bufferSize);
     else DMA_setBufferSizeToDefault();
+
+    MEM_setTag(tag);
 }
 
 bool DMA_getAutoFlush()
@@ -111,12 +286,24 @@ u16 DMA_getMaxQueueSize()
 
 void DMA_setMaxQueueSize(u16 value)
 {
+#if (ENABLE_DMA_STATIC_MEMORY != 0)
+    // static queue, just limit the size
+    queueSize = min(DMA_QUEUE_SIZE_STATIC, max(DMA_QUEUE_SIZE_MIN, value));
+#else
     queueSize = max(DMA_QUEUE_SIZE_MIN, value);
 
     // already allocated ?
-    if (dmaQueues) MEM_free(dmaQueues);
+    if (dmaQueues)
+    {
+        MEM_free(dmaQueues);
+        MEM_free(queueFlags);
+    }
     // allocate DMA queue
+    const u16 tag = MEM_setTag(MEM_TAG_DMA);
     dmaQueues = MEM_alloc(queueSize * sizeof(DMAOpInfo));
+    queueFlags = MEM_alloc(queueSize * sizeof(u8));
+    MEM_setTag(tag);
+#endif
 
     // reset queue
     DMA_clearQueue();
@@ -143,6 +330,44 @@ void DMA_setMaxTransferSizeToDefault()
     DMA_setMaxTransferSize(IS_PAL_SYSTEM ? DMA_TRANSFER_CAPACITY_PAL_LOW : DMA_TRANSFER_CAPACITY_NTSC);
 }
 
+bool DMA_getAutoCapacity()
+{
+    return (flag & DMA_AUTOCAPACITY) ? TRUE : FALSE;
+}
+
+void DMA_setAutoCapacity(bool value)
+{
+    if (value)
+    {
+        flag |= DMA_AUTOCAPACITY;
+        maxTransferPerFrame = computeCapacity(0);
+    }
+    else flag &= ~DMA_AUTOCAPACITY;
+}
+
+u16 DMA_getVBlankCapacity()
+{
+    return computeCapacity(0);
+}
+
+u16 DMA_getRemainingCapacity()
+{
+    return (queueTransferSize >= maxTransferPerFrame) ? 0 : (maxTransferPerFrame - queueTransferSize);
+}
+
+static u16 computeCapacity(u16 elapsedLines)
+{
+    const u16 scrHeight = VDP_getScreenHeight();
+    // number of blank lines per frame (262 lines on NTSC and 313 lines on PAL)
+    const u16 blankLines = (IS_PAL_SYSTEM ? 313 : 262) - scrHeight;
+    const u16 perLine = (VDP_getScreenWidth() == 320) ? DMA_LINE_CAPACITY_BLANK_H40 : DMA_LINE_CAPACITY_BLANK_H32;
+    const u16 used = elapsedLines + CAPACITY_MARGIN_LINES;
+
+    if (used >= blankLines) return perLine;
+
+    return mulu(blankLines - used, perLine);
+}
+
 u16 DMA_getBufferSize()
 {
     return dataBufferSize * 2;
@@ -150,119 +375,942 @@ u16 DMA_getBufferSize()
 
 void DMA_setBufferSize(u16 value)
 {
-    dataBufferSize = max(DMA_BUFFER_SIZE_MIN, value) / 2;
+#if (ENABLE_DMA_STATIC_MEMORY != 0)
+    // static buffer, just limit the size
+    dataBufferSize = min(DMA_BUFFER_SIZE_STATIC, max(DMA_BUFFER_SIZE_MIN, value)) / 2;
+    dmaDataBuffer = staticDataBuffer;
+#else
+    const u16 newSize = max(DMA_BUFFER_SIZE_MIN, value) / 2;
 
-    // already allocated ?
-    if (dmaDataBuffer) MEM_free(dmaDataBuffer);
-    // allocate DMA data buffer
-    if (dataBufferSize)
-        dmaDataBuffer = MEM_alloc(dataBufferSize * sizeof(u16));
-    else
-        dmaDataBuffer = NULL;
+    // not yet allocated or size changed ? (keep current buffer otherwise)
+    if (!dmaDataBuffer || (newSize != dataBufferSize))
+    {
+        // already allocated ?
+        if (dmaDataBuffer) MEM_free(dmaDataBuffer);
+
+        dataBufferSize = newSize;
+        // allocate DMA data buffer
+        if (dataBufferSize)
+        {
+            const u16 tag = MEM_setTag(MEM_TAG_DMA);
+            dmaDataBuffer = MEM_alloc(dataBufferSize * sizeof(u16));
+            MEM_setTag(tag);
+        }
+        else
+            dmaDataBuffer = NULL;
+    }
+#endif
+
+    resetBufferBank();
+    // reset queue
+    DMA_clearQueue();
+}
+
+bool DMA_getDoubleBuffer()
+{
+    return (flag & DMA_DOUBLEBUFFER) ? TRUE : FALSE;
+}
 
+void DMA_setDoubleBuffer(bool value)
+{
+    if (value) flag |= DMA_DOUBLEBUFFER;
+    else flag &= ~DMA_DOUBLEBUFFER;
+
+    resetBufferBank();
     // reset queue
     DMA_clearQueue();
 }
 
+static void resetBufferBank()
+{
+    fillBuffer = dmaDataBuffer;
+    // use first half of buffer in double buffer mode
+    if (flag & DMA_DOUBLEBUFFER) fillBufferEnd = dmaDataBuffer + (dataBufferSize / 2);
+    else fillBufferEnd = dmaDataBuffer + dataBufferSize;
+}
+
+static void swapBufferBank()
+{
+    if (!(flag & DMA_DOUBLEBUFFER)) return;
+
+    // first bank --> second bank
+    if (fillBuffer == dmaDataBuffer)
+    {
+        fillBuffer = fillBufferEnd;
+        fillBufferEnd = dmaDataBuffer + dataBufferSize;
+    }
+    // second bank --> first bank
+    else
+    {
+        fillBufferEnd = fillBuffer;
+        fillBuffer = dmaDataBuffer;
+    }
+}
+
 void DMA_setBufferSizeToDefault()
 {
     DMA_setBufferSize(IS_PAL_SYSTEM ? DMA_BUFFER_SIZE_PAL_LOW : DMA_BUFFER_SIZE_NTSC);
 }
 
-bool DMA_getIgnoreOverCapacity()
+bool DMA_getIgnoreOverCapacity()
+{
+    return (flag & DMA_OVERCAPACITY_IGNORE) ? TRUE : FALSE;
+}
+
+void DMA_setIgnoreOverCapacity(bool value)
+{
+    if (value) flag |= DMA_OVERCAPACITY_IGNORE;
+    else flag &= ~DMA_OVERCAPACITY_IGNORE;
+}
+
+u16 DMA_getQueuePriority()
+{
+    return queuePriority;
+}
+
+u16 DMA_setQueuePriority(u16 value)
+{
+    const u16 result = queuePriority;
+
+    queuePriority = value & ENTRY_PRIORITY_MASK;
+    entryFlags = (entryFlags & ENTRY_MIDFRAME) | queuePriority;
+
+    return result;
+}
+
+bool DMA_getMidFrameTransfer()
+{
+    return (entryFlags & ENTRY_MIDFRAME) ? TRUE : FALSE;
+}
+
+void DMA_setMidFrameTransfer(bool value)
+{
+    if (value) entryFlags |= ENTRY_MIDFRAME;
+    else entryFlags &= ~ENTRY_MIDFRAME;
+}
+
+void DMA_clearQueue()
+{
+    queueIndex = 0;
+    queueIndexLimit = 0;
+    queueTransferSize = 0;
+    queueMergeCount = 0;
+    midFrameEnd = 0;
+    midFrameIndex = 0;
+    midFrameDrained = 0;
+
+    // reset DMA data buffer pointer
+    nextDataBuffer = fillBuffer;
+    // no more pending fence
+    completedFence = fenceId;
+}
+
+void DMA_flushQueue()
+{
+    u8 autoInc;
+#if (ENABLE_DMA_STATS != 0)
+    // flush started in VBlank ? --> we can measure overrun
+    const bool inVBlank = GET_VDP_STATUS(VDP_VBLANK_FLAG) ? TRUE : FALSE;
+#endif
+
+#ifdef DMA_DEBUG
+    KLog_U3("DMA_flushQueue: queueIndexLimit=", queueIndexLimit, " queueIndex=", queueIndex, " queueTransferSize=", queueTransferSize);
+#endif
+
+    PROF_begin(PROF_ZONE_DMA);
+
+    // H-Int flush using display blanking ? --> restore display and H-Int line for this frame
+    if (hIntFlag & HINT_FLUSH_BLANK)
+    {
+        if (hIntFlag & HINT_FLUSH_BLANKED) VDP_setEnable(TRUE);
+        hIntFlag &= ~HINT_FLUSH_BLANKED;
+        VDP_setHIntCounter(hIntLine - 1);
+    }
+
+    // remove transfers already done by mid frame flush
+    removeDrainedEntries();
+
+    // automatic capacity ? --> use VBlank lines left for this flush
+    if (flag & DMA_AUTOCAPACITY)
+    {
+        const u16 vcnt = GET_VCOUNTER;
+        const u16 scrHeight = VDP_getScreenHeight();
+
+        maxTransferPerFrame = computeCapacity(((vcnt >= scrHeight) && GET_VDP_STATUS(VDP_VBLANK_FLAG)) ? (vcnt - scrHeight) : 0);
+    }
+
+#if (ENABLE_DMA_STATS != 0)
+    updateStats();
+#endif
+
+    // save autoInc
+    autoInc = VDP_getAutoInc();
+
+    // limit reached ? --> select transfers by priority (not compiled when capacity handling is disabled)
+    if ((ENABLE_DMA_CAPACITY_LIMIT != 0) && (queueTransferSize > maxTransferPerFrame))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U3_("DMA_flushQueue(..) warning: frame #", vtimer, " - transfer size is above ", maxTransferPerFrame, " bytes (", queueTransferSize, "), some transfers may be ignored or delayed.");
+#endif
+
+        flushSelectedEntries();
+    }
+    else
+    {
+        flushEntries(dmaQueues, queueIndex);
+        // producers can now fill the other bank (double buffer mode)
+        swapBufferBank();
+        // can clear the queue now
+        DMA_clearQueue();
+    }
+
+    // restore autoInc
+    VDP_setAutoInc(autoInc);
+
+#if (ENABLE_DMA_STATS != 0)
+    if (inVBlank) updateOverrunStats();
+#endif
+
+    // automatic capacity ? --> whole VBlank capacity for next frame (video mode may have changed)
+    if (flag & DMA_AUTOCAPACITY) maxTransferPerFrame = computeCapacity(0);
+
+    PROF_end(PROF_ZONE_DMA);
+}
+
+#if (ENABLE_DMA_STATS != 0)
+const DMAStats* DMA_getStats()
+{
+    return &stats;
+}
+
+void DMA_resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+static void updateStats()
+{
+    const u16 bufferUsed = (u32) nextDataBuffer - (u32) fillBuffer;
+
+    stats.frames++;
+    stats.bytes = queueTransferSize;
+    stats.totalBytes += queueTransferSize;
+    if (queueTransferSize > stats.peakBytes) stats.peakBytes = queueTransferSize;
+    stats.entries = queueIndex;
+    if (queueIndex > stats.peakEntries) stats.peakEntries = queueIndex;
+    stats.merged += queueMergeCount;
+    if (bufferUsed > stats.peakBuffer) stats.peakBuffer = bufferUsed;
+}
+
+static void updateOverrunStats()
+{
+    const u16 vcnt = GET_VCOUNTER;
+    u16 bin;
+
+    // still in VBlank (or in first scanlines) --> no overrun
+    if ((vcnt >= VDP_getScreenHeight()) || (vcnt <= 2)) bin = 0;
+    else if (vcnt < 8) bin = 1;
+    else if (vcnt < 16) bin = 2;
+    else if (vcnt < 32) bin = 3;
+    else if (vcnt < 64) bin = 4;
+    else bin = 5;
+
+    stats.overrun[bin]++;
+    stats.lastOverrun = bin ? vcnt : 0;
+    if (stats.lastOverrun > stats.peakOverrun) stats.peakOverrun = stats.lastOverrun;
+}
+#endif  // ENABLE_DMA_STATS
+
+static void flushEntries(DMAOpInfo* info, u16 num)
+{
+    const u8* flags = &queueFlags[info - dmaQueues];
+    DMAOpInfo* start = info;
+    u16 n = 0;
+
+    while(num--)
+    {
+        // block transfer ? --> flush pending entries then expand it
+        if (*flags & ENTRY_BLOCKS)
+        {
+            flushRawEntries(start, n);
+            flushBlocks(info);
+
+            // skip descriptor entry
+            info += 2;
+            flags += 2;
+            if (num) num--;
+            start = info;
+            n = 0;
+        }
+        // VRAM fill / copy ?
+        else if (*flags & ENTRY_VDP_OP)
+        {
+            flushRawEntries(start, n);
+            flushVDPOp(info);
+
+            info++;
+            flags++;
+            start = info;
+            n = 0;
+        }
+        else
+        {
+            info++;
+            flags++;
+            n++;
+        }
+    }
+
+    flushRawEntries(start, n);
+}
+
+static void flushBlocks(const DMAOpInfo* info)
+{
+    const DMABlockDesc* desc = (const DMABlockDesc*) (info + 1);
+    DMAOpInfo blocks[BLOCK_BATCH_SIZE];
+    u32 from = ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
+    u16 to = getEntryDest(info);
+    u16 remaining = desc->num;
+
+    while(remaining)
+    {
+        const u16 n = min(remaining, BLOCK_BATCH_SIZE);
+        DMAOpInfo* block = blocks;
+
+        for(u16 i = 0; i < n; i++)
+        {
+            *block = *info;
+            setEntryAddress(block, from, to);
+            from += desc->fromStride;
+            to += desc->toStride;
+            block++;
+        }
+
+        flushRawEntries(blocks, n);
+        remaining -= n;
+    }
+}
+
+static void flushVDPOp(const DMAOpInfo* info)
+{
+    const DMAVDPOp* op = (const DMAVDPOp*) info;
+
+    // fence --> all previous transfers are done
+    if (op->type == VDP_OP_FENCE)
+    {
+        const DMAFence* fence = (const DMAFence*) info;
+
+        completedFence = fence->id;
+        if (fence->callback) fence->callback(fence->id);
+
+        return;
+    }
+    // CPU copy --> no DMA to wait for
+    if (op->type == VDP_OP_CPU)
+    {
+        const DMACPUOp* cpu = (const DMACPUOp*) info;
+
+        DMA_doCPUCopy(cpu->location, cpu->from, cpu->to, cpu->len, cpu->step);
+
+        return;
+    }
+
+    if (op->type == VDP_OP_FILL) DMA_doVRamFill(op->to, op->len, op->value, op->step);
+    else DMA_doVRamCopy(op->from, op->to, op->len, op->step);
+
+    // we need to wait for completion before next VDP access
+    VDP_waitDMACompletion();
+}
+
+static void flushRawEntries(DMAOpInfo* info, u16 num)
+{
+    if (!num) return;
+
+#if (DMA_DISABLED != 0)
+    // DMA disabled --> replace with software copy
+    u16 i = num;
+
+    while(i--)
+    {
+        u16 len = (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
+        s16 step = info->regAddrMStep & 0xFF;
+        u32 from = ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
+        // replace DMA command by WRITE command
+        u32 cmd = info->regCtrlWrite & ~0x80;
+
+        // software copy
+        DMA_doCPUCopyDirect(cmd, (void*) from, len, step);
+
+        // next
+        info++;
+    }
+#else
+
+#if (HALT_Z80_ON_DMA != 0)
+    bool busTaken = Z80_isBusTaken();
+    // disable Z80 before processing DMA
+    if (!busTaken) Z80_requestBus(FALSE);
+#endif  // HALT_Z80_ON_DMA
+
+    flushQueue(info, num);
+
+#if (HALT_Z80_ON_DMA != 0)
+    // re-enable Z80 after all DMA
+    if (!busTaken) Z80_releaseBus();
+#endif  // HALT_Z80_ON_DMA
+
+#endif  // DMA_DISABLED
+}
+
+static void flushSelectedEntries()
+{
+    const bool ignore = (flag & DMA_OVERCAPACITY_IGNORE) ? TRUE : FALSE;
+    DMAOpInfo* info;
+    u8* flags;
+    u16 num;
+    u16 size;
+    u16 remaining;
+    u16 newIndex;
+    u16 newTransferSize;
+    u16* bufferEnd;
+
+    // select transfers to do: high priority transfers are always done
+    remaining = maxTransferPerFrame;
+    flags = queueFlags;
+    info = dmaQueues;
+    num = queueIndex;
+    while(num--)
+    {
+        // fences are selected once all transfers are selected (see below)
+        if (((*flags & ENTRY_PRIORITY_MASK) == DMA_PRIORITY_HIGH) && !isFence(info, *flags))
+        {
+            *flags |= ENTRY_SELECTED;
+            size = getEntrySize(info);
+            remaining = (size > remaining) ? 0 : (remaining - size);
+        }
+
+        flags++;
+        info++;
+    }
+
+    // then normal and low priority transfers in queue order, stop on first one not fitting in remaining capacity
+    for(u16 prio = DMA_PRIORITY_NORMAL; prio <= DMA_PRIORITY_LOW; prio++)
+    {
+        bool full = FALSE;
+
+        flags = queueFlags;
+        info = dmaQueues;
+        num = queueIndex;
+        while(num--)
+        {
+            if (((*flags & ENTRY_PRIORITY_MASK) == prio) && !isFence(info, *flags))
+            {
+                size = getEntrySize(info);
+
+                if (!full && (size <= remaining))
+                {
+                    *flags |= ENTRY_SELECTED;
+                    remaining -= size;
+                }
+                else
+                {
+                    full = TRUE;
+
+                    // low priority and mid frame transfers are delayed, normal priority transfers are done anyway if we don't ignore over capacity
+                    if ((prio == DMA_PRIORITY_LOW) || (*flags & ENTRY_MIDFRAME)) *flags |= ENTRY_DEFERRED;
+                    else if (!ignore) *flags |= ENTRY_SELECTED;
+                }
+            }
+
+            flags++;
+            info++;
+        }
+    }
+
+    // fences are never ignored but they are delayed (whatever their priority) as soon as a previous transfer is delayed
+    {
+        bool deferred = FALSE;
+
+        flags = queueFlags;
+        info = dmaQueues;
+        num = queueIndex;
+        while(num--)
+        {
+            if (isFence(info, *flags)) *flags |= deferred ? ENTRY_DEFERRED : ENTRY_SELECTED;
+            else if (*flags & ENTRY_DEFERRED) deferred = TRUE;
+
+            flags++;
+            info++;
+        }
+    }
+
+    // flush selected transfers (by contiguous block to preserve queue order)
+    flags = queueFlags;
+    info = dmaQueues;
+    num = 0;
+    for(u16 i = 0; i < queueIndex; i++)
+    {
+        if (*flags++ & ENTRY_SELECTED) num++;
+        else
+        {
+            flushEntries(info, num);
+            info += num + 1;
+            num = 0;
+        }
+    }
+    flushEntries(info, num);
+
+    // producers can now fill the other bank (double buffer mode)
+    swapBufferBank();
+
+    // now keep delayed transfers for next flush (compact them at beginning of queue)
+    newIndex = 0;
+    newTransferSize = 0;
+    midFrameEnd = 0;
+    bufferEnd = fillBuffer;
+    flags = queueFlags;
+    info = dmaQueues;
+    for(u16 i = 0; i < queueIndex; i++)
+    {
+        const u8 f = *flags++;
+
+        if (f & ENTRY_DEFERRED)
+        {
+            // descriptor and VRAM fill / copy entries don't use source data
+            if (!(f & (ENTRY_BLOCKS_DESC | ENTRY_VDP_OP)))
+            {
+                const u32 from = ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
+                u16 len = (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
+                u16* end;
+
+                STAT_INC(delayed);
+
+                // block transfer --> get end of last block
+                if (f & ENTRY_BLOCKS)
+                {
+                    const DMABlockDesc* desc = (const DMABlockDesc*) (info + 1);
+                    len += ((desc->num - 1) * desc->fromStride) >> 1;
+                }
+
+                end = ((u16*) from) + len;
+
+                // source is located in the DMA temporary buffer bank we will fill ? --> need to preserve it
+                if (((u16*) from >= fillBuffer) && (end <= fillBufferEnd) && (end > bufferEnd))
+                    bufferEnd = end;
+            }
+
+            // leading mid frame transfers can be flushed during active display (preserve queue order)
+            if ((f & ENTRY_MIDFRAME) && (midFrameEnd == newIndex)) midFrameEnd++;
+
+            newTransferSize += getEntrySize(info);
+            dmaQueues[newIndex] = *info;
+            queueFlags[newIndex] = f & (ENTRY_PRIORITY_MASK | ENTRY_VDP_OP | ENTRY_MIDFRAME | ENTRY_BLOCKS | ENTRY_BLOCKS_DESC);
+            newIndex++;
+        }
+#if (ENABLE_DMA_STATS != 0)
+        // transfer ignored
+        else if (!(f & (ENTRY_SELECTED | ENTRY_BLOCKS_DESC))) stats.dropped++;
+#endif
+
+        info++;
+    }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+    if (newIndex) KLog_U2("DMA_flushQueue(..) warning: ", newIndex, " low priority / mid frame transfer(s) delayed - size = ", newTransferSize);
+#endif
+
+    // reset queue state keeping delayed transfers
+    queueIndex = newIndex;
+    queueIndexLimit = 0;
+    queueTransferSize = newTransferSize;
+    queueMergeCount = 0;
+    midFrameIndex = 0;
+    midFrameDrained = 0;
+    // preserve temporary data of delayed transfers
+    nextDataBuffer = bufferEnd;
+}
+
+static bool isFence(const DMAOpInfo* info, u8 f)
+{
+    return ((f & ENTRY_VDP_OP) && (((const DMAVDPOp*) info)->type == VDP_OP_FENCE)) ? TRUE : FALSE;
+}
+
+static u16 getEntrySize(const DMAOpInfo* info)
+{
+    const u8 f = queueFlags[info - dmaQueues];
+    u16 len;
+
+    // block transfer descriptor --> size is counted on first entry
+    if (f & ENTRY_BLOCKS_DESC) return 0;
+    // VRAM fill / copy (copy does both read and write)
+    if (f & ENTRY_VDP_OP)
+    {
+        const DMAVDPOp* op = (const DMAVDPOp*) info;
+
+        if (op->type == VDP_OP_FENCE) return 0;
+        // CPU copy is about twice slower than DMA (CRAM and VSRAM transfers are still counted for half)
+        if (op->type == VDP_OP_CPU) return (((const DMACPUOp*) info)->location == DMA_VRAM) ? (op->len << 2) : (op->len << 1);
+        return (op->type == VDP_OP_COPY) ? (op->len << 1) : op->len;
+    }
+
+    len = (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
+    // block transfer --> total size
+    if (f & ENTRY_BLOCKS) len *= ((const DMABlockDesc*) (info + 1))->num;
+
+    // VRAM transfer ? (CRAM and VSRAM transfers are only counted for half)
+    if ((info->regCtrlWrite & 0xC0000010) == 0x40000000) return len << 1;
+
+    return len;
+}
+
+static DMAOpInfo* getFreeEntry()
+{
+    // queue is full ?
+    if (queueIndex >= queueSize)
+    {
+        // not a low priority transfer ? --> try to evict the last low priority transfer
+        if (queuePriority != DMA_PRIORITY_LOW)
+        {
+            u16 i = queueIndex;
+
+            // don't touch pending mid frame transfers (can be processed by H-Int)
+            while(i-- > midFrameEnd)
+            {
+                // fences are never evicted (their waiters would never complete)
+                if (((queueFlags[i] & ENTRY_PRIORITY_MASK) == DMA_PRIORITY_LOW) && !isFence(&dmaQueues[i], queueFlags[i]))
+                {
+                    u16 num = 1;
+
+                    // block transfer descriptor --> evict the whole block transfer
+                    if (queueFlags[i] & ENTRY_BLOCKS_DESC)
+                    {
+                        i--;
+                        num = 2;
+                    }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+                    KLog_U2("DMA_queueDma(..) warning: queue is full, low priority transfer #", i, " evicted on frame #", vtimer);
+#endif
+
+                    queueTransferSize -= getEntrySize(&dmaQueues[i]);
+                    queueIndex -= num;
+                    STAT_INC(dropped);
+
+                    // shift next entries
+                    for(u16 j = i; j < queueIndex; j++)
+                    {
+                        dmaQueues[j] = dmaQueues[j + num];
+                        queueFlags[j] = queueFlags[j + num];
+                    }
+
+                    // limit index may be invalid now
+                    queueIndexLimit = 0;
+
+                    break;
+                }
+            }
+        }
+
+        // still full --> error
+        if (queueIndex >= queueSize)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KDebug_Alert("DMA_queueDma(..) failed: queue is full ! Try to increase queue size using DMA_setMaxQueueSize(..)");
+#endif
+
+            STAT_INC(dropped);
+            return NULL;
+        }
+    }
+
+    // set entry priority
+    queueFlags[queueIndex] = entryFlags;
+
+    return &dmaQueues[queueIndex];
+}
+
+static bool checkCapacity()
+{
+    // capacity handling disabled (see config.h) --> all transfers are done
+    if (ENABLE_DMA_CAPACITY_LIMIT == 0) return TRUE;
+
+    // we are above the defined limit ?
+    if (queueTransferSize > maxTransferPerFrame)
+    {
+        // first time we reach the limit ? store index where to stop transfer
+        if (queueIndexLimit == 0)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+            KLog_S4("DMA_queueDma(..) warning: transfer size limit raised on transfer #", queueIndex - 1, " on frame #", vtimer, ", current size = ", queueTransferSize, "  max allowed = ", maxTransferPerFrame);
+#endif
+
+            // store limit index
+            queueIndexLimit = queueIndex - 1;
+
+#ifdef DMA_DEBUG
+            KLog_U1("  Queue index limit set at ", queueIndexLimit);
+#endif
+        }
+
+        // return FALSE if transfer will be ignored (high priority transfers are always done and low priority ones are delayed)
+        if (queuePriority == DMA_PRIORITY_NORMAL)
+            return (flag & DMA_OVERCAPACITY_IGNORE) ? FALSE : TRUE;
+    }
+
+    return TRUE;
+}
+
+static bool mergeWithLastEntry(u8 location, u32 fromAddr, u16 to, u16 len, u16 step)
+{
+    DMAOpInfo *info;
+    u32 prevFrom;
+    u32 ctrl;
+    u16 prevLen;
+    u16 size;
+
+    // nothing to merge with (or pending mid frame transfer which can be processed by H-Int)
+    if (queueIndex <= midFrameEnd) return FALSE;
+
+    info = &dmaQueues[queueIndex - 1];
+
+    // different priority / mid frame setting ?
+    if (queueFlags[queueIndex - 1] != entryFlags) return FALSE;
+    // different step ?
+    if ((info->regAddrMStep & 0xFF) != step) return FALSE;
+
+    prevLen = (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
+    // merged length doesn't fit in DMA length registers ?
+    if (((u32) prevLen + len) > 0xFFFF) return FALSE;
+
+    prevFrom = ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
+    fromAddr &= 0xFFFFFE;
+    // source isn't contiguous ?
+    if ((prevFrom + (prevLen << 1)) != fromAddr) return FALSE;
+    // merged transfer would cross a 128 KB bank (DMA works on 64 KW bank)
+    if ((prevFrom ^ (fromAddr + (len << 1) - 1)) & 0xFE0000) return FALSE;
+
+    // compute control word the new transfer would have if it started with previous one
+    to -= prevLen * step;
+    switch(location)
+    {
+    case DMA_VRAM:
+        ctrl = GFX_DMA_VRAM_ADDR((u32)to);
+        size = len << 1;
+        break;
+
+    case DMA_CRAM:
+        ctrl = GFX_DMA_CRAM_ADDR((u32)to);
+        size = len;
+        break;
+
+    case DMA_VSRAM:
+        ctrl = GFX_DMA_VSRAM_ADDR((u32)to);
+        size = len;
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    // destination isn't contiguous ?
+    if (info->regCtrlWrite != ctrl) return FALSE;
+    // don't merge above capacity limit (let normal path handle the limit)
+    if (((u32) queueTransferSize + size) > maxTransferPerFrame) return FALSE;
+
+    // extend previous transfer
+    prevLen += len;
+    info->regLenL = 0x9300 + (prevLen & 0xFF);
+    info->regLenH = 0x9400 + ((prevLen >> 8) & 0xFF);
+
+    queueTransferSize += size;
+    queueMergeCount++;
+
+#ifdef DMA_DEBUG
+    KLog_U3("DMA_queueDma: merged with transfer #", queueIndex - 1, " new len=", prevLen, " new queueTransferSize=", queueTransferSize);
+#endif
+
+    return TRUE;
+}
+
+static void removeDrainedEntries()
+{
+    const u16 num = midFrameIndex;
+
+    // remove size transferred by mid frame flush (including partial transfer)
+    queueTransferSize -= midFrameDrained;
+
+    if (num)
+    {
+        queueIndex -= num;
+
+        for(u16 i = 0; i < queueIndex; i++)
+        {
+            dmaQueues[i] = dmaQueues[i + num];
+            queueFlags[i] = queueFlags[i + num];
+        }
+
+        // limit index may be invalid now
+        queueIndexLimit = 0;
+    }
+
+    midFrameIndex = 0;
+    midFrameEnd = 0;
+    midFrameDrained = 0;
+}
+
+static u16 getEntryDest(const DMAOpInfo* info)
 {
-    return (flag & DMA_OVERCAPACITY_IGNORE) ? TRUE : FALSE;
+    const u32 ctrl = info->regCtrlWrite;
+
+    // VRAM
+    if ((ctrl & 0xC0000010) == 0x40000000) return ((ctrl >> 16) & 0x3FFF) | ((ctrl & 3) << 14);
+    // CRAM
+    if ((ctrl & 0xC0000000) == 0xC0000000) return (ctrl >> 16) & 0x7F;
+    // VSRAM
+    return (ctrl >> 16) & 0x3F;
 }
 
-void DMA_setIgnoreOverCapacity(bool value)
+static void setEntryAddress(DMAOpInfo* info, u32 from, u16 to)
 {
-    if (value) flag |= DMA_OVERCAPACITY_IGNORE;
-    else flag &= ~DMA_OVERCAPACITY_IGNORE;
+    const u32 ctrl = info->regCtrlWrite;
+
+    info->regAddrMStep = (info->regAddrMStep & 0xFF00FFFF) + ((from << 7) & 0xFF0000);
+    info->regAddrHAddrL = 0x97009500 + ((from >> 1) & 0x7F00FF);
+
+    // VRAM
+    if ((ctrl & 0xC0000010) == 0x40000000) info->regCtrlWrite = GFX_DMA_VRAM_ADDR((u32)to);
+    // CRAM
+    else if ((ctrl & 0xC0000000) == 0xC0000000) info->regCtrlWrite = GFX_DMA_CRAM_ADDR((u32)to);
+    // VSRAM
+    else info->regCtrlWrite = GFX_DMA_VSRAM_ADDR((u32)to);
 }
 
-void DMA_clearQueue()
+static void advanceEntry(DMAOpInfo* info, u16 len)
 {
-    queueIndex = 0;
-    queueIndexLimit = 0;
-    queueTransferSize = 0;
+    const u16 step = info->regAddrMStep & 0xFF;
+    const u16 newLen = ((info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8)) - len;
+    const u32 from = (((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1)) + (len << 1);
 
-    // reset DMA data buffer pointer
-    nextDataBuffer = dmaDataBuffer;
+    info->regLenL = 0x9300 + (newLen & 0xFF);
+    info->regLenH = 0x9400 + ((newLen >> 8) & 0xFF);
+    setEntryAddress(info, from, getEntryDest(info) + (len * step));
+}
 
+u16 DMA_getMidFramePending()
+{
+    return midFrameEnd - midFrameIndex;
 }
 
-void DMA_flushQueue()
+u16 DMA_flushQueueMidFrame(u16 maxSize)
 {
-    u16 i;
+    u16 done;
     u8 autoInc;
 
-    // default
-    i = queueIndex;
+    // nothing to do
+    if (midFrameIndex >= midFrameEnd) return 0;
+
+    // save autoInc
+    autoInc = VDP_getAutoInc();
 
-    // limit reached ?
-    if (queueIndexLimit)
+    done = 0;
+    while(midFrameIndex < midFrameEnd)
     {
-        // we choose to ignore over capacity transfers ?
-        if (flag & DMA_OVERCAPACITY_IGNORE)
+        DMAOpInfo* info = &dmaQueues[midFrameIndex];
+        const u16 size = getEntrySize(info);
+        const u16 remaining = maxSize - done;
+
+        // whole transfer fits
+        if (size <= remaining)
         {
-            i = queueIndexLimit;
+            // block transfer use 2 entries
+            const u16 num = (queueFlags[midFrameIndex] & ENTRY_BLOCKS) ? 2 : 1;
 
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
-            KLog_U3_("DMA_flushQueue(..) warning: frame #", vtimer, " - transfer size is above ", maxTransferPerFrame, " bytes (", queueTransferSize, "), some transfers are ignored.");
-#endif
+            flushEntries(info, num);
+            done += size;
+            midFrameIndex += num;
+        }
+        // block transfers and VRAM fill / copy can't be split
+        else if (queueFlags[midFrameIndex] & (ENTRY_BLOCKS | ENTRY_VDP_OP)) break;
+        // partial transfer
+        else
+        {
+            DMAOpInfo part;
+            // VRAM size is in byte while other ones are counted for half
+            const u16 len = ((info->regCtrlWrite & 0xC0000010) == 0x40000000) ? (remaining >> 1) : remaining;
+
+            if (len)
+            {
+                part = *info;
+                part.regLenL = 0x9300 + (len & 0xFF);
+                part.regLenH = 0x9400 + ((len >> 8) & 0xFF);
+                flushRawEntries(&part, 1);
+
+                // remaining part is done later
+                advanceEntry(info, len);
+                STAT_INC(truncated);
+                done += size - getEntrySize(info);
+            }
+
+            break;
         }
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
-        else KLog_U3_("DMA_flushQueue(..) warning: frame #", vtimer, " - transfer size is above ", maxTransferPerFrame, " bytes (", queueTransferSize, ").");
-#endif
     }
 
-#ifdef DMA_DEBUG
-    KLog_U3("DMA_flushQueue: queueIndexLimit=", queueIndexLimit, " queueIndex=", queueIndex, " i=", i);
-#endif
+    midFrameDrained += done;
 
-    // save autoInc
-    autoInc = VDP_getAutoInc();
+    // restore autoInc
+    VDP_setAutoInc(autoInc);
 
-#if (DMA_DISABLED != 0)
-    // DMA disabled --> replace with software copy
+    return done;
+}
 
-    DMAOpInfo *info = dmaQueues;
+static HINTERRUPT_CALLBACK hIntFlush()
+{
+    const u16 scrWidth = VDP_getScreenWidth();
+    u16 size;
 
-    while(i--)
+    // display blanking mode ? --> disable display until VBlank
+    if (hIntFlag & HINT_FLUSH_BLANK)
     {
-        u16 len = (info->regLenL & 0xFF) | ((info->regLenH & 0xFF) << 8);
-        s16 step = info->regAddrMStep & 0xFF;
-        u32 from = ((info->regAddrMStep & 0xFF0000) >> 7) | ((info->regAddrHAddrL & 0x7F00FF) << 1);
-        // replace DMA command by WRITE command
-        u32 cmd = info->regCtrlWrite & ~0x80;
+        // already done for this frame
+        if (hIntFlag & HINT_FLUSH_BLANKED) return;
 
-        // software copy
-        DMA_doCPUCopyDirect(cmd, (void*) from, len, step);
+        VDP_setEnable(FALSE);
+        // no more H-Int for this frame
+        VDP_setHIntCounter(0xFF);
+        hIntFlag |= HINT_FLUSH_BLANKED;
 
-        // next
-        info++;
+        size = (VDP_getScreenHeight() - hIntLine) * ((scrWidth == 320) ? DMA_LINE_CAPACITY_BLANK_H40 : DMA_LINE_CAPACITY_BLANK_H32);
     }
-#else
+    // transfer what fit in active display line slots since last H-Int
+    else size = hIntLine * ((scrWidth == 320) ? DMA_LINE_CAPACITY_ACTIVE_H40 : DMA_LINE_CAPACITY_ACTIVE_H32);
 
-#if (HALT_Z80_ON_DMA != 0)
-    bool busTaken = Z80_isBusTaken();
-    // disable Z80 before processing DMA
-    if (!busTaken) Z80_requestBus(FALSE);
-#endif  // HALT_Z80_ON_DMA
+    DMA_flushQueueMidFrame(size);
+}
 
-    flushQueue(i);
+void DMA_setHIntFlush(u16 line, bool blank)
+{
+    SYS_disableInts();
 
-#if (HALT_Z80_ON_DMA != 0)
-    // re-enable Z80 after all DMA
-    if (!busTaken) Z80_releaseBus();
-#endif  // HALT_Z80_ON_DMA
+    // restore display if needed
+    if (hIntFlag & HINT_FLUSH_BLANKED) VDP_setEnable(TRUE);
 
-#endif  // DMA_DISABLED
+    hIntLine = line;
 
-    // can clear the queue now
-    DMA_clearQueue();
-    // restore autoInc
-    VDP_setAutoInc(autoInc);
+    if (line)
+    {
+        hIntFlag = blank ? HINT_FLUSH_BLANK : 0;
+        VDP_setHIntCounter(line - 1);
+        SYS_setHIntCallback(hIntFlush);
+        VDP_setHInterrupt(TRUE);
+    }
+    else
+    {
+        hIntFlag = 0;
+        VDP_setHInterrupt(FALSE);
+        SYS_setHIntCallback(NULL);
+    }
+
+    SYS_enableInts();
 }
 
 //static void flushQueue(u16 num)
@@ -317,6 +1365,11 @@ u16 DMA_getQueueSize()
     return queueIndex;
 }
 
+u16 DMA_getQueueMergeCount()
+{
+    return queueMergeCount;
+}
+
 u16 DMA_getQueueTransferSize()
 {
     return queueTransferSize;
@@ -340,23 +1393,57 @@ bool DMA_transfer(TransferMethod tm, u8 location, void* from, u16 to, u16 len, u
 
         case DMA_QUEUE_COPY:
             return DMA_copyAndQueueDma(location, from, to, len, step);
+
+        case TRANSFER_AUTO:
+            // large transfer --> DMA queue
+            if (len > autoCPULen) return DMA_queueDma(location, from, to, len, step);
+            // small transfer which can be done now --> CPU immediate
+            if (DMA_getAutoTransferMethod(len) == CPU)
+            {
+                DMA_doCPUCopy(location, from, to, len, step);
+                return TRUE;
+            }
+            // otherwise CPU copy done on next VBlank (keep transfer order)
+            return queueCPUCopy(location, from, to, len, step);
     }
 }
 
+TransferMethod DMA_getAutoTransferMethod(u16 len)
+{
+    if (len > autoCPULen) return DMA_QUEUE;
+    // pending queued transfers may overwrite it
+    if (queueIndex) return DMA_QUEUE;
+    // VBlank flag is also set when display is disabled
+    if (GET_VDP_STATUS(VDP_VBLANK_FLAG)) return CPU;
+
+    return DMA_QUEUE;
+}
+
+u16 DMA_getAutoCPULen()
+{
+    return autoCPULen;
+}
+
+void DMA_setAutoCPULen(u16 value)
+{
+    autoCPULen = value;
+}
+
 void* DMA_allocateTemp(u16 len)
 {
     u16* result = nextDataBuffer;
 
     nextDataBuffer += len;
 
-    if (nextDataBuffer > (dmaDataBuffer + dataBufferSize))
+    if (nextDataBuffer > fillBufferEnd)
     {
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-        KLog_U2_("DMA_allocateTemp(..) failed: buffer over capacity (", (u32) nextDataBuffer - (u32) dmaDataBuffer, " raised, max capacity = ", DMA_getBufferSize(), ")");
+        KLog_U2_("DMA_allocateTemp(..) failed: buffer over capacity (", (u32) nextDataBuffer - (u32) fillBuffer, " raised, max capacity = ", (u32) fillBufferEnd - (u32) fillBuffer, ")");
 #endif
 
         // failed --> revert allocation
         DMA_releaseTemp(len);
+        STAT_INC(bufferFull);
 
         // error
         return NULL;
@@ -371,6 +1458,17 @@ void DMA_releaseTemp(u16 len)
     nextDataBuffer -= len;
 }
 
+void* DMA_reserveQueueDma(u16 len)
+{
+    return DMA_allocateTemp(len);
+}
+
+bool DMA_commitQueueDma(u8 location, void* buffer, u16 to, u16 len, u16 step)
+{
+    // we can use FAST version as source is always located in RAM
+    return DMA_queueDmaFast(location, buffer, to, len, step);
+}
+
 bool DMA_canQueue(u8 location, u16 len)
 {
     u16 nextSize = queueTransferSize + (len << ((location == DMA_VRAM)?1:0));
@@ -387,7 +1485,7 @@ void* DMA_allocateAndQueueDma(u8 location, u16 to, u16 len, u16 step)
     if (result == NULL) return result;
 
 #ifdef DMA_DEBUG
-    KLog_U3_("DMA_allocateAndQueueDma: allocate ", 2 * len, " bytes - current allocated = ", (u32) nextDataBuffer - (u32) dmaDataBuffer, " on ", DMA_getBufferSize(), " availaible");
+    KLog_U3_("DMA_allocateAndQueueDma: allocate ", 2 * len, " bytes - current allocated = ", (u32) nextDataBuffer - (u32) fillBuffer, " on ", (u32) fillBufferEnd - (u32) fillBuffer, " availaible");
 #endif
 
     // try to queue the DMA transfer (we can use FAST version as source is always located in RAM)
@@ -411,7 +1509,7 @@ bool DMA_copyAndQueueDma(u8 location, void* from, u16 to, u16 len, u16 step)
     if (buffer == NULL) return FALSE;
 
 #ifdef DMA_DEBUG
-    KLog_U3_("DMA_copyAndQueueDma: allocate ", 2 * len, " bytes - current allocated = ", (u32) nextDataBuffer - (u32) dmaDataBuffer, " on ", DMA_getBufferSize(), " availaible");
+    KLog_U3_("DMA_copyAndQueueDma: allocate ", 2 * len, " bytes - current allocated = ", (u32) nextDataBuffer - (u32) fillBuffer, " on ", (u32) fillBufferEnd - (u32) fillBuffer, " availaible");
 #endif
 
     // do copy to temporal buffer (as from buffer may be modified in between)
@@ -437,17 +1535,6 @@ bool DMA_queueDma(u8 location, void* from, u16 to, u16 len, u16 step)
     DMAOpInfo *info;
     u16 newLen;
 
-    // queue is full --> error
-    if (queueIndex >= queueSize)
-    {
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-        KDebug_Alert("DMA_queueDma(..) failed: queue is full ! Try to increase queue size using DMA_setMaxQueueSize(..)");
-#endif
-
-        // return FALSE as transfer will be ignored
-        return FALSE;
-    }
-
     // DMA works on 64 KW bank
     fromAddr = (u32) from;
     bankLimitB = 0x20000 - (fromAddr & 0x1FFFF);
@@ -462,8 +1549,13 @@ bool DMA_queueDma(u8 location, void* from, u16 to, u16 len, u16 step)
     // ok, use normal len
     else newLen = len;
 
+    // contiguous with previous transfer ? --> just extend it
+    if (mergeWithLastEntry(location, fromAddr, to, newLen, step)) return TRUE;
+
     // get DMA info structure and pass to next one
-    info = &dmaQueues[queueIndex];
+    info = getFreeEntry();
+    // queue is full --> error
+    if (info == NULL) return FALSE;
 
     // $13:len L  $14:len H (DMA length in word)
     info->regLenL = 0x9300 + (newLen & 0xFF);
@@ -511,29 +1603,7 @@ bool DMA_queueDma(u8 location, void* from, u16 to, u16 len, u16 step)
     KLog_U2("  Queue index=", queueIndex, " new queueTransferSize=", queueTransferSize);
 #endif
 
-    // we are above the defined limit ?
-    if (queueTransferSize > maxTransferPerFrame)
-    {
-        // first time we reach the limit ? store index where to stop transfer
-        if (queueIndexLimit == 0)
-        {
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
-            KLog_S4("DMA_queueDma(..) warning: transfer size limit raised for transfer #", queueIndex - 1, " on frame #", vtimer, ", current size = ", queueTransferSize, "  max allowed = ", maxTransferPerFrame);
-#endif
-
-            // store limit index
-            queueIndexLimit = queueIndex - 1;
-
-#ifdef DMA_DEBUG
-            KLog_U1("  Queue index limit set at ", queueIndexLimit);
-#endif
-        }
-
-        // return FALSE if transfer will be ignored
-        return (flag & DMA_OVERCAPACITY_IGNORE) ? FALSE : TRUE;
-    }
-
-    return TRUE;
+    return checkCapacity();
 }
 
 bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 step)
@@ -541,21 +1611,15 @@ bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 step)
     u32 fromAddr;
     DMAOpInfo *info;
 
-    // queue is full --> error
-    if (queueIndex >= queueSize)
-    {
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-        KDebug_Alert("DMA_queueDma(..) failed: queue is full ! Try to increase queue size using DMA_setMaxQueueSize(..)");
-#endif
-
-        // return FALSE as transfer will be ignored
-        return FALSE;
-    }
-
     fromAddr = (u32) from;
 
+    // contiguous with previous transfer ? --> just extend it
+    if (mergeWithLastEntry(location, fromAddr, to, len, step)) return TRUE;
+
     // get DMA info structure and pass to next one
-    info = &dmaQueues[queueIndex];
+    info = getFreeEntry();
+    // queue is full --> error
+    if (info == NULL) return FALSE;
 
     // $13:len L  $14:len H (DMA length in word)
     info->regLenL = 0x9300 + (len & 0xFF);
@@ -603,31 +1667,223 @@ bool DMA_queueDmaFast(u8 location, void* from, u16 to, u16 len, u16 step)
     KLog_U2("  Queue index=", queueIndex, " new queueTransferSize=", queueTransferSize);
 #endif
 
-    // we are above the defined limit ?
-    if (queueTransferSize > maxTransferPerFrame)
+    return checkCapacity();
+}
+
+bool DMA_queueDmaBlocks(u8 location, void* from, u16 to, u16 len, u16 step, u16 num, u16 fromStride, u16 toStride)
+{
+    u32 fromAddr;
+    u32 lastAddr;
+    DMAOpInfo *info;
+    DMABlockDesc *desc;
+    u16 size;
+
+    if (num == 0) return TRUE;
+
+    fromAddr = (u32) from;
+    lastAddr = fromAddr + mulu(num - 1, fromStride) + (len << 1) - 1;
+
+    // single block, blocks crossing a 128 KB bank or not enough room for 2 entries ? --> use simple transfers
+    if ((num == 1) || ((fromAddr ^ lastAddr) & 0xFE0000) || ((queueIndex + 2) > queueSize))
     {
-        // first time we reach the limit ? store index where to stop transfer
-        if (queueIndexLimit == 0)
+        bool result = TRUE;
+
+        while(num--)
         {
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
-            KLog_S4("DMA_queueDma(..) warning: transfer size limit raised on transfer #", queueIndex - 1, " on frame #", vtimer, ", current size = ", queueTransferSize, "  max allowed = ", maxTransferPerFrame);
-#endif
+            result &= DMA_queueDma(location, (void*) fromAddr, to, len, step);
+            fromAddr += fromStride;
+            to += toStride;
+        }
 
-            // store limit index
-            queueIndexLimit = queueIndex - 1;
+        return result;
+    }
+
+    // first block transfer (give destination type)
+    info = getFreeEntry();
+    // $13:len L  $14:len H (DMA length in word)
+    info->regLenL = 0x9300 + (len & 0xFF);
+    info->regLenH = 0x9400 + ((len >> 8) & 0xFF);
+    // $16:M  $f:step (DMA address M and Step register)
+    info->regAddrMStep = 0x96008F00 + ((fromAddr << 7) & 0xFF0000) + step;
+    // $17:H  $15:L (DMA address H & L)
+    info->regAddrHAddrL = 0x97009500 + ((fromAddr >> 1) & 0x7F00FF);
+
+    size = mulu(num, len);
+    switch(location)
+    {
+    default:
+    case DMA_VRAM:
+        info->regCtrlWrite = GFX_DMA_VRAM_ADDR((u32)to);
+        // keep trace of transferred size
+        size <<= 1;
+        break;
+
+    case DMA_CRAM:
+        info->regCtrlWrite = GFX_DMA_CRAM_ADDR((u32)to);
+        break;
+
+    case DMA_VSRAM:
+        info->regCtrlWrite = GFX_DMA_VSRAM_ADDR((u32)to);
+        break;
+    }
 
 #ifdef DMA_DEBUG
-            KLog_U1("  Queue index limit set at ", queueIndexLimit);
+    KLog_U4("DMA_queueDmaBlocks: from=", fromAddr, " to=", to, " len=", len, " num=", num);
 #endif
-        }
 
-        // return FALSE if transfer will be ignored
-        return (flag & DMA_OVERCAPACITY_IGNORE) ? FALSE : TRUE;
+    queueFlags[queueIndex] |= ENTRY_BLOCKS;
+    queueIndex++;
+
+    // then blocks descriptor
+    desc = (DMABlockDesc*) getFreeEntry();
+    desc->num = num;
+    desc->fromStride = fromStride;
+    desc->toStride = toStride;
+    queueFlags[queueIndex] |= ENTRY_BLOCKS_DESC;
+    queueIndex++;
+
+    queueTransferSize += size;
+
+    return checkCapacity();
+}
+
+bool DMA_queueCompressed(u8 location, const void* from, u16 to, u16 len, u16 compression)
+{
+    u16* buffer;
+
+    // not compressed --> simple transfer
+    if (compression == COMPRESSION_NONE) return DMA_queueDma(location, (void*) from, to, len, 2);
+
+    // unpack directly in DMA temporary buffer
+    buffer = DMA_reserveQueueDma(len);
+    if (buffer)
+    {
+        unpack(compression, (u8*) from, (u8*) buffer);
+
+        if (DMA_commitQueueDma(location, buffer, to, len, 2)) return TRUE;
+
+        // failed --> release allocation
+        DMA_releaseTemp(len);
+        // error
+        return FALSE;
     }
 
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+    KLog_U1("DMA_queueCompressed(..) warning: DMA temporary buffer too small, unpacking in heap and transferring immediately - size = ", len * 2);
+#endif
+
+    // not enough space in DMA temporary buffer --> unpack in heap and transfer now
+    buffer = MEM_alloc(len * 2);
+    if (buffer == NULL) return FALSE;
+
+    unpack(compression, (u8*) from, (u8*) buffer);
+    DMA_doDma(location, buffer, to, len, 2);
+    MEM_free(buffer);
+
     return TRUE;
 }
 
+bool DMA_queueVRamFill(u16 to, u16 len, u8 value, s16 step)
+{
+    return queueVDPOp(VDP_OP_FILL, 0, to, len, step, value);
+}
+
+bool DMA_queueVRamCopy(u16 from, u16 to, u16 len, s16 step)
+{
+    return queueVDPOp(VDP_OP_COPY, from, to, len, step, 0);
+}
+
+u16 DMA_queueFence(DMACallback* callback)
+{
+    DMAFence* fence;
+
+    // get DMA info structure and pass to next one
+    fence = (DMAFence*) getFreeEntry();
+    // queue is full --> error
+    if (fence == NULL) return 0;
+
+    // 0 is reserved (no fence)
+    if (++fenceId == 0) fenceId = 1;
+
+    fence->type = VDP_OP_FENCE;
+    fence->id = fenceId;
+    fence->callback = callback;
+    queueFlags[queueIndex] |= ENTRY_VDP_OP;
+    // pass to next index
+    queueIndex++;
+
+    return fenceId;
+}
+
+u16 DMA_getCompletedFence()
+{
+    return completedFence;
+}
+
+bool DMA_isFenceDone(u16 id)
+{
+    // handle id wrapping
+    return ((s16) (completedFence - id) >= 0) ? TRUE : FALSE;
+}
+
+static bool queueVDPOp(u16 type, u16 from, u16 to, u16 len, s16 step, u8 value)
+{
+    DMAVDPOp* op;
+
+    // get DMA info structure and pass to next one
+    op = (DMAVDPOp*) getFreeEntry();
+    // queue is full --> error
+    if (op == NULL) return FALSE;
+
+    op->type = type;
+    op->from = from;
+    op->to = to;
+    op->len = len;
+    op->step = step;
+    op->value = value;
+    queueFlags[queueIndex] |= ENTRY_VDP_OP;
+
+#ifdef DMA_DEBUG
+    KLog_U4("DMA_queueVRam: type=", type, " from=", from, " to=", to, " len=", len);
+#endif
+
+    // keep trace of transferred size (copy is slower as it does both read and write)
+    queueTransferSize += getEntrySize((DMAOpInfo*) op);
+    // pass to next index
+    queueIndex++;
+
+    return checkCapacity();
+}
+
+static bool queueCPUCopy(u8 location, void* from, u16 to, u16 len, u16 step)
+{
+    DMACPUOp* op;
+
+    // get DMA info structure and pass to next one
+    op = (DMACPUOp*) getFreeEntry();
+    // queue is full --> error
+    if (op == NULL) return FALSE;
+
+    op->type = VDP_OP_CPU;
+    op->location = location;
+    op->from = from;
+    op->to = to;
+    op->len = len;
+    op->step = step;
+    queueFlags[queueIndex] |= ENTRY_VDP_OP;
+
+#ifdef DMA_DEBUG
+    KLog_U4("DMA_queueCPUCopy: loc=", location, " from=", (u32) from, " to=", to, " len=", len);
+#endif
+
+    // keep trace of transferred size
+    queueTransferSize += getEntrySize((DMAOpInfo*) op);
+    // pass to next index
+    queueIndex++;
+
+    return checkCapacity();
+}
+
 void DMA_doDma(u8 location, void* from, u16 to, u16 len, s16 step)
 {
 #if (DMA_DISABLED != 0)
@@ -2,10 +2,10 @@
 #include "asm_mac.i"
 
 func flushQueue
-	move.w 6(%sp),%d0
+	move.w 10(%sp),%d0
     jeq     .fq_end
 
-	move.l dmaQueues,%a0
+	move.l 4(%sp),%a0
 	move.l #0xC00004,%a1
 
 	subq.w #1,%d0           // prepare for dbra
@@ -0,0 +1,64 @@
+#include "config.h"
+#include "types.h"
+
+#include "entity.h"
+
+
+// forward
+static void spawnBuckets(EntitySpawner* spawner, u16 from, u16 to);
+
+
+void ENTITY_initSpawner(EntitySpawner* spawner, const EntityTable* table, EntitySpawnCallback* onSpawn)
+{
+    spawner->table = table;
+    spawner->left = -1;
+    spawner->right = -1;
+    spawner->onSpawn = onSpawn;
+}
+
+void ENTITY_updateSpawner(EntitySpawner* spawner, u16 viewX, u16 viewW)
+{
+    const EntityTable* table = spawner->table;
+    const u16 shift = table->bucketShift;
+    const s16 b0 = viewX >> shift;
+    s16 b1 = ((u32) viewX + viewW - 1) >> shift;
+
+    // clip to table
+    if (b1 >= (s16) table->numBucket) b1 = table->numBucket - 1;
+
+    // nothing visible
+    if ((viewW == 0) || (b0 > b1))
+    {
+        spawner->left = -1;
+        spawner->right = -1;
+        return;
+    }
+
+    const s16 left = spawner->left;
+    const s16 right = spawner->right;
+
+    // no overlap with previous visible buckets --> spawn all
+    if ((left == -1) || (b1 < left) || (b0 > right)) spawnBuckets(spawner, b0, b1);
+    else
+    {
+        // newly visible buckets on left and right sides
+        if (b0 < left) spawnBuckets(spawner, b0, left - 1);
+        if (b1 > right) spawnBuckets(spawner, right + 1, b1);
+    }
+
+    spawner->left = b0;
+    spawner->right = b1;
+}
+
+
+static void spawnBuckets(EntitySpawner* spawner, u16 from, u16 to)
+{
+    const EntityTable* table = spawner->table;
+    EntitySpawnCallback* onSpawn = spawner->onSpawn;
+    // buckets are contiguous in entity table
+    u16 ind = table->buckets[from];
+    const u16 end = table->buckets[to + 1];
+    const EntityDef* entity = &table->entities[ind];
+
+    while(ind < end) onSpawn(entity++, ind++);
+}
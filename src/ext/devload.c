@@ -0,0 +1,205 @@
+#include "config.h"
+#include "types.h"
+
+#if (MODULE_DEVLOAD != 0)
+
+#include "ext/devload.h"
+
+#include "ext/everdrive.h"
+#include "ext/fat16.h"
+
+#include "vdp.h"
+#include "pal.h"
+#include "memory.h"
+#include "string.h"
+#include "tools.h"
+
+
+// asset directory
+static Fat16Dir dir;
+static Fat16File file;
+static char dirPath[12];
+static bool ready = FALSE;
+
+
+static bool openDir(void);
+static Fat16Record* findFile(const char* name);
+static bool isLongNameEqual(const u8* longName, const char* name);
+static bool isShortNameEqual(const u8* shortName, const char* name);
+
+
+bool DEVLOAD_init(const char* dirName)
+{
+    if (dirName) strncpy(dirPath, dirName, sizeof(dirPath) - 1);
+    else dirPath[0] = 0;
+    dirPath[sizeof(dirPath) - 1] = 0;
+
+    ready = FALSE;
+
+    // SD card with FAT16 file system ?
+    if (fat16Init() != 0)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog("DEVLOAD_init(..) warning: SD card not available, ROM resources will be used");
+#endif
+        return FALSE;
+    }
+
+    return DEVLOAD_refresh();
+}
+
+bool DEVLOAD_refresh()
+{
+    ready = openDir();
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+    if (!ready) kprintf("DEVLOAD warning: cannot open asset directory '%s', ROM resources will be used", dirPath);
+#endif
+
+    return ready;
+}
+
+bool DEVLOAD_exists(const char* name)
+{
+    return findFile(name) != NULL;
+}
+
+bool DEVLOAD_loadTileSet(const TileSet* tileset, const char* name, u16 index, TransferMethod tm)
+{
+    Fat16Record* rec = findFile(name);
+
+    if (rec && (rec->size >= 32) && (fat16OpenFile(rec, &file) == 0))
+    {
+        const u32 size = rec->size & ~31;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        if (size > (tileset->numTile * 32))
+            kprintf("DEVLOAD warning: '%s' file contains %ld tiles (%d in ROM tileset), check VRAM allocation", name, size / 32, tileset->numTile);
+#endif
+
+        // stream tiles to VRAM
+        if (fat16ReadFileToVRAM(&file, index * 32, size) == 0) return TRUE;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        kprintf("DEVLOAD error: failed to read '%s' file, using ROM resource", name);
+#endif
+    }
+
+    // fallback to ROM
+    return VDP_loadTileSet(tileset, index, tm);
+}
+
+void DEVLOAD_setPalette(u16 index, const Palette* pal, const char* name, TransferMethod tm)
+{
+    Fat16Record* rec = findFile(name);
+
+    if (rec && (rec->size >= 2) && (fat16OpenFile(rec, &file) == 0))
+    {
+        u16 colors[64];
+        const u16 count = min(rec->size / 2, (u32) (64 - index));
+
+        if (fat16ReadFile(&file, (u8*) colors, count * 2) == 0)
+        {
+            PAL_setColors(index, colors, count, (tm == DMA_QUEUE)?DMA_QUEUE_COPY:tm);
+            return;
+        }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        kprintf("DEVLOAD error: failed to read '%s' file, using ROM resource", name);
+#endif
+    }
+
+    // fallback to ROM
+    PAL_setColors(index, pal->data, pal->length, tm);
+}
+
+
+static bool openDir()
+{
+    // root directory
+    if (fat16OpenDir(0, &dir) != 0) return FALSE;
+    if (!dirPath[0]) return TRUE;
+
+    for(u16 i = 0; i < dir.size; i++)
+    {
+        Fat16Record* rec = &dir.records[i];
+
+        if ((rec->flags & FAT16_TYPE_DIR) && (isLongNameEqual(rec->long_name, dirPath) || isShortNameEqual(rec->name, dirPath)))
+            return fat16OpenDir(rec->entry, &dir) == 0;
+    }
+
+    return FALSE;
+}
+
+static Fat16Record* findFile(const char* name)
+{
+    char fileName[40];
+
+    if (!ready) return NULL;
+
+    // "<name>.bin"
+    const u16 len = min(strlen(name), sizeof(fileName) - 5);
+    memcpy(fileName, name, len);
+    strcpy(fileName + len, ".bin");
+
+    for(u16 i = 0; i < dir.size; i++)
+    {
+        Fat16Record* rec = &dir.records[i];
+
+        if (rec->flags & FAT16_TYPE_DIR) continue;
+        if (isLongNameEqual(rec->long_name, fileName)) return rec;
+    }
+
+    // 8.3 name fallback (8 first characters + BIN)
+    fileName[min(len, 8)] = 0;
+
+    for(u16 i = 0; i < dir.size; i++)
+    {
+        Fat16Record* rec = &dir.records[i];
+
+        if (rec->flags & FAT16_TYPE_DIR) continue;
+        if (isShortNameEqual(rec->name, fileName) && (rec->name[8] == 'B') && (rec->name[9] == 'I') && (rec->name[10] == 'N')) return rec;
+    }
+
+    return NULL;
+}
+
+static char toUpper(char c)
+{
+    if ((c >= 'a') && (c <= 'z')) return c - ('a' - 'A');
+
+    return c;
+}
+
+static bool isLongNameEqual(const u8* longName, const char* name)
+{
+    u16 i = 0;
+
+    while(name[i])
+    {
+        if ((i >= 38) || (toUpper(longName[i]) != toUpper(name[i]))) return FALSE;
+        i++;
+    }
+
+    // end of long name (0 terminated then 0xFF padded)
+    return (i == 38) || (longName[i] == 0) || (longName[i] == 0xFF);
+}
+
+static bool isShortNameEqual(const u8* shortName, const char* name)
+{
+    u16 i = 0;
+
+    // 8 characters name part (space padded)
+    while(i < 8)
+    {
+        const char c = name[i];
+
+        if (!c || (c == '.')) break;
+        if (shortName[i] != toUpper(c)) return FALSE;
+        i++;
+    }
+
+    return (i == 8) || (shortName[i] == ' ');
+}
+
+#endif // MODULE_DEVLOAD
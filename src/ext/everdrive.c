@@ -1,3 +1,4 @@
+#include "config.h"
 #include "types.h"
 
 #include "ext/everdrive.h"
@@ -9,7 +10,9 @@
 /** MMC/SD card SPI mode commands **/
 #define CMD0  0x40    // software reset
 #define CMD1  0x41    // brings card out of idle state
+#define CMD12 0x4C    // stop transmission
 #define CMD17 0x51    // read single block
+#define CMD18 0x52    // read multiple block
 #define CMD24 0x58    // writes a single block
 
 
@@ -211,6 +214,101 @@ u8 evd_mmcRdBlock(u32 mmc_addr, u8 *stor) {
     return 0;
 }
 
+u8 evd_mmcRdBlocks(u32 mmc_addr, u8 *stor, u16 num) {
+
+    u16 i = 0;
+    u16 *stor16 = (u16 *) stor;
+
+    if (num == 0) return 0;
+    if (num == 1) return evd_mmcRdBlock(mmc_addr, stor);
+
+    if (evd_mmcCmd(CMD18, mmc_addr) != 0) {
+        SS_ON;
+        for (;;) {
+
+            SPI_PORT = 0xff;
+            SPI_BUSY;
+
+
+            if ((SPI_PORT & 0xff) == 0) {
+                break;
+            }
+
+            // multiple block read not supported --> read block by block
+            if (i++ == 65535) {
+                SS_OFF;
+
+                while (num--) {
+                    if (evd_mmcRdBlock(mmc_addr, (u8 *) stor16) != 0) return 1;
+                    mmc_addr += 512;
+                    stor16 += 256;
+                }
+
+                return 0;
+            }
+        }
+    }
+
+    SS_ON;
+
+    while (num--) {
+
+        // wait for data token of each block
+        i = 0;
+
+        for (;;) {
+
+            SPI_PORT = 0xff;
+            SPI_BUSY;
+            if ((SPI_PORT & 0xff) == 0xfe)break;
+
+            if (i++ == 65535) {
+                SS_OFF;
+                return 2;
+            }
+        }
+
+        CFGS(_SPI16);
+
+
+        for (i = 0; i < 256; i++) {
+
+            SPI_PORT = 0xffff;
+            SPI_BUSY;
+            *stor16++ = SPI_PORT;
+        }
+
+        CFGC(_SPI16);
+
+
+        // skip CRC
+        SPI_PORT = 0xff;
+        SPI_BUSY;
+        SPI_PORT = 0xff;
+        SPI_BUSY;
+    }
+
+    SS_OFF;
+
+    // stop transmission then wait end of busy state
+    evd_mmcCmd(CMD12, 0);
+
+    SS_ON;
+    i = 0;
+    for (;;) {
+        SPI_PORT = 0xff;
+        SPI_BUSY;
+        if ((SPI_PORT & 0xff) == 0xff)break;
+        if (i++ == 65535) {
+            SS_OFF;
+            return 3;
+        }
+    }
+    SS_OFF;
+
+    return 0;
+}
+
 void evd_eprEraseBlock(u32 rom_addr) {
 
     u16 i;
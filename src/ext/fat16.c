@@ -1,8 +1,12 @@
+#include "config.h"
 #include "types.h"
 
 #include "ext/fat16.h"
 #include "ext/everdrive.h"
 
+#include "dma.h"
+#include "memory.h"
+
 
 #if (MODULE_FAT16 != 0)
 
@@ -13,6 +17,9 @@ u8 fat16GetDirClustersNum(u16 *num, u32 entry);
 u8 fat16GetFatTableRecord(u16 cluster, u16 *val);
 u8 fat16SetFatTableRecord(u16 cluster, u16 val);
 u8 fat16ApplyFatTableChange();
+u8 fat16GetFatTableSector(u8 req_sector, u16 **buff);
+u8 fat16WriteFatTableSector(u16 index);
+u8 fat16ReadSectors(Fat16File *file, u8 *dst, u32 num, u16 max);
 
 volatile u8 *sector_buff;
 
@@ -21,9 +28,12 @@ Fat16PBR fat16_pbr;
 u8 fat16_buff[1024];
 u32 fat16_fat_base;
 u32 fat16_root_base;
-u16 fat16_fat_table_buff[256];
-u8 fat16_current_fat_table_sector;
-u8 fat16_fat_table_buff_changed;
+// FAT sectors cache (LRU)
+u16 fat16_fat_cache[FAT16_FAT_CACHE_SIZE][256];
+u16 fat16_fat_cache_sector[FAT16_FAT_CACHE_SIZE];
+u16 fat16_fat_cache_use[FAT16_FAT_CACHE_SIZE];
+u8 fat16_fat_cache_changed[FAT16_FAT_CACHE_SIZE];
+u16 fat16_fat_cache_stamp;
 u32 fat16_data_start;
 u16 cluster_size;
 
@@ -96,7 +106,7 @@ int fat16LoadPbr() {
 
 u8 fat16Init() {
 
-    //u16 i;
+    u16 i;
     if (evd_mmcInit() != 0)return 1;
     if (fat16LoadPbr() != 0)return 2;
 
@@ -104,9 +114,14 @@ u8 fat16Init() {
 
     fat16_root_base = fat16_fat_base + fat16_pbr.sectors_per_fat * fat16_pbr.byte_per_sector * fat16_pbr.fat_copys;
 
-    if (evd_mmcRdBlock(fat16_fat_base, (u8 *) fat16_fat_table_buff) != 0)return 3;
-    fat16_current_fat_table_sector = 0;
-    fat16_fat_table_buff_changed = 0;
+    u16 *fat;
+    for (i = 0; i < FAT16_FAT_CACHE_SIZE; i++) {
+        fat16_fat_cache_sector[i] = 0xffff;
+        fat16_fat_cache_use[i] = 0;
+        fat16_fat_cache_changed[i] = 0;
+    }
+    fat16_fat_cache_stamp = 0;
+    if (fat16GetFatTableSector(0, &fat) != 0)return 3;
     fat16_data_start = fat16_root_base + 16384;
     cluster_size = fat16_pbr.byte_per_sector * fat16_pbr.sector_per_cluster;
 
@@ -308,6 +323,117 @@ u8 fat16ReadNextSector(Fat16File *file) {
     return 0;
 }
 
+u8 fat16ReadSectors(Fat16File *file, u8 *dst, u32 num, u16 max) {
+
+    u16 spc = fat16_pbr.sector_per_cluster;
+    u32 run;
+    u16 cluster;
+    u16 next;
+
+    while (num) {
+
+        if (file->sector == spc) {
+            if (fat16GetFatTableRecord(file->cluster, &file->cluster) != 0)return 2;
+            file->sector = 0;
+            file->addr_buff = (file->cluster - 2) * cluster_size + fat16_data_start;
+        }
+
+        // prefetch cluster chain: extend the read over following contiguous clusters
+        run = spc - file->sector;
+        cluster = file->cluster;
+        while (run < num && run < max) {
+            if (fat16GetFatTableRecord(cluster, &next) != 0)return 2;
+            if (next != cluster + 1)break;
+            cluster = next;
+            run += spc;
+        }
+
+        if (run > num)run = num;
+        if (run > max)run = max;
+
+        if (evd_mmcRdBlocks(file->addr_buff, dst, run) != 0)return 3;
+
+        dst += run << 9;
+        num -= run;
+        file->pos += run << 9;
+        file->addr_buff += run << 9;
+
+        // clusters are contiguous here
+        file->sector += run;
+        while (file->sector > spc) {
+            file->sector -= spc;
+            file->cluster++;
+        }
+    }
+
+    return 0;
+}
+
+u8 fat16ReadFile(Fat16File *file, u8 *dst, u32 len) {
+
+    u32 remain = file->record->size - file->pos;
+    u16 rest;
+
+    if (file->pos >= file->record->size)return 1;
+    if (len > remain)len = remain;
+
+    // odd destination --> go through sector buffer
+    if ((u32) dst & 1) {
+        while (len) {
+            rest = len > 512 ? 512 : len;
+            if (fat16ReadNextSector(file) != 0)return 2;
+            memcpy(dst, file->sectror_buff, rest);
+            dst += rest;
+            len -= rest;
+        }
+
+        return 0;
+    }
+
+    // full sectors directly in destination (multiple block read)
+    if (fat16ReadSectors(file, dst, len >> 9, 128) != 0)return 3;
+
+    // last partial sector
+    rest = len & 511;
+    if (rest) {
+        if (fat16ReadNextSector(file) != 0)return 4;
+        memcpy(dst + (len & ~511), file->sectror_buff, rest);
+    }
+
+    return 0;
+}
+
+u8 fat16ReadFileToVRAM(Fat16File *file, u16 vram_addr, u32 len) {
+
+    u32 remain = file->record->size - file->pos;
+    u32 num;
+    u16 rest;
+
+    if (file->pos >= file->record->size)return 1;
+    if (len > remain)len = remain;
+
+    num = len >> 9;
+
+    // 2 sectors at once through fat16_buff
+    while (num) {
+        u16 n = num > 2 ? 2 : num;
+
+        if (fat16ReadSectors(file, fat16_buff, n, n) != 0)return 2;
+        DMA_doDma(DMA_VRAM, fat16_buff, vram_addr, n << 8, 2);
+        vram_addr += n << 9;
+        num -= n;
+    }
+
+    // last partial sector
+    rest = len & 511;
+    if (rest) {
+        if (fat16ReadNextSector(file) != 0)return 3;
+        DMA_doDma(DMA_VRAM, file->sectror_buff, vram_addr, (rest + 1) >> 1, 2);
+    }
+
+    return 0;
+}
+
 u8 fat16DeleteRecord(Fat16Record *rec) {
 
     u16 cluster = rec->entry;
@@ -360,32 +486,76 @@ u8 fat16DeleteRecord(Fat16Record *rec) {
     return 10;
 }
 
-u8 fat16GetFatTableRecord(u16 cluster, u16 *val) {
+u8 fat16GetFatTableSector(u8 req_sector, u16 **buff) {
 
-    //u16 i;
-    u8 req_sector = cluster >> 8;
-    if (req_sector != fat16_current_fat_table_sector) {
+    u16 i;
+    u16 lru = 0;
+    u16 age;
+    u16 max_age = 0;
+
+    for (i = 0; i < FAT16_FAT_CACHE_SIZE; i++) {
+
+        if (fat16_fat_cache_sector[i] == req_sector) {
+            fat16_fat_cache_use[i] = ++fat16_fat_cache_stamp;
+            *buff = fat16_fat_cache[i];
+            return 0;
+        }
 
-        if (fat16_fat_table_buff_changed) {
-            if (fat16ApplyFatTableChange() != 0)return 1;
+        // least recently used entry (empty entries first)
+        age = fat16_fat_cache_stamp - fat16_fat_cache_use[i];
+        if (fat16_fat_cache_sector[i] == 0xffff)age = 0xffff;
+        if (age >= max_age) {
+            max_age = age;
+            lru = i;
         }
+    }
 
-        if (evd_mmcRdBlock(fat16_fat_base + (req_sector << 9), (u8 *) fat16_fat_table_buff) != 0)return 2;
-        //for(i = 0; i < 256;i++)fat16_fat_table_buff[i] = fat16_fat_cache[(req_sector << 9) + i];
-        fat16_current_fat_table_sector = req_sector;
+    if (fat16_fat_cache_changed[lru]) {
+        if (fat16WriteFatTableSector(lru) != 0)return 1;
     }
-    *val = fat16_fat_table_buff[cluster & 0xff];
-    //*val = fat16_fat_cache[cluster];
+
+    if (evd_mmcRdBlock(fat16_fat_base + (req_sector << 9), (u8 *) fat16_fat_cache[lru]) != 0) {
+        fat16_fat_cache_sector[lru] = 0xffff;
+        return 2;
+    }
+
+    fat16_fat_cache_sector[lru] = req_sector;
+    fat16_fat_cache_use[lru] = ++fat16_fat_cache_stamp;
+    *buff = fat16_fat_cache[lru];
+
+    return 0;
+}
+
+u8 fat16WriteFatTableSector(u16 index) {
+
+    u32 addr = fat16_fat_base + (fat16_fat_cache_sector[index] << 9);
+
+    if (evd_mmcWrBlock(addr, (u8 *) fat16_fat_cache[index]) != 0)return 1;
+    if (evd_mmcWrBlock(addr + (fat16_pbr.sectors_per_fat << 9), (u8 *) fat16_fat_cache[index]) != 0)return 2;
+    fat16_fat_cache_changed[index] = 0;
+
+    return 0;
+}
+
+u8 fat16GetFatTableRecord(u16 cluster, u16 *val) {
+
+    u16 *fat;
+
+    if (fat16GetFatTableSector(cluster >> 8, &fat) != 0)return 2;
+
+    *val = fat[cluster & 0xff];
     *val = *val >> 8 | *val << 8;
     return 0;
 }
 
 u8 fat16ApplyFatTableChange() {
 
-    if (fat16_fat_table_buff_changed) {
-        if (evd_mmcWrBlock(fat16_fat_base + (fat16_current_fat_table_sector << 9), (u8 *) fat16_fat_table_buff) != 0)return 1;
-        if (evd_mmcWrBlock(fat16_fat_base + (fat16_current_fat_table_sector << 9) + (fat16_pbr.sectors_per_fat << 9), (u8 *) fat16_fat_table_buff) != 0)return 2;
-        fat16_fat_table_buff_changed = 0;
+    u16 i;
+
+    for (i = 0; i < FAT16_FAT_CACHE_SIZE; i++) {
+        if (fat16_fat_cache_changed[i]) {
+            if (fat16WriteFatTableSector(i) != 0)return 1;
+        }
     }
 
     return 0;
@@ -393,21 +563,18 @@ u8 fat16ApplyFatTableChange() {
 
 u8 fat16SetFatTableRecord(u16 cluster, u16 val) {
 
-    u8 req_sector = cluster >> 8;
+    u16 *fat;
+    u16 i;
 
-    if (req_sector != fat16_current_fat_table_sector) {
+    if (fat16GetFatTableSector(cluster >> 8, &fat) != 0)return 2;
 
-        if (fat16_fat_table_buff_changed) {
-            if (fat16ApplyFatTableChange() != 0)return 1;
-        }
+    fat[cluster & 0xff] = val >> 8 | val << 8;
 
-        if (evd_mmcRdBlock(fat16_fat_base + (req_sector << 9), (u8 *) fat16_fat_table_buff) != 0)return 2;
-        fat16_current_fat_table_sector = req_sector;
+    // mark cache entry as changed
+    for (i = 0; i < FAT16_FAT_CACHE_SIZE; i++) {
+        if (fat16_fat_cache[i] == fat)fat16_fat_cache_changed[i] = 1;
     }
 
-    fat16_fat_table_buff[cluster & 0xff] = val >> 8 | val << 8;
-    fat16_fat_table_buff_changed = 1;
-
     return 0;
 }
 
@@ -5,6 +5,20 @@
 
 #if (MODULE_FRACTAL != 0)
 
+#include "sys.h"
+#include "vdp.h"
+#include "z80_ctrl.h"
+
+
+// allow to access it without "public" share
+extern vu16 VBlankProcess;
+extern s16 currentDriver;
+
+// CPU load calculation (in scanline)
+static u16 loadTab[FRACTAL_LOAD_FRAME_NUM];
+static u16 loadInd = 0;
+static u16 loadSum = 0;
+
 #ifdef __INTELLISENSE__
     #pragma diag_suppress 1118
 #endif
@@ -17,6 +31,18 @@ void Fractal_Init(void (*decompressFunction)(u8* source, u8* destination)) {
 		: "di" (decompressFunction)
 		: "a0", "a1", "d0", "d1", "d2", "d3", "cc", "memory"
 	);
+
+	// Fractal is now the current driver (it uploaded its own Z80 program)
+	currentDriver = Z80_DRIVER_FRACTAL;
+	// set Fractal task on VInt
+	VBlankProcess = (VBlankProcess & ~PROCESS_XGM_TASK) | PROCESS_FRACTAL_TASK;
+	// bus protection signal address (0 = not supported by Z80 driver)
+	Z80_useBusProtection(FRACTAL_Z80_PROTECT_ADDR);
+
+	// reset load calculation
+	for (u16 i = 0; i < FRACTAL_LOAD_FRAME_NUM; i++) loadTab[i] = 0;
+	loadInd = 0;
+	loadSum = 0;
 }
 
 void Fractal_Decompress(u8* source, u8* destination) {
@@ -45,6 +71,25 @@ void Fractal_Update() {
 	);
 }
 
+// VInt processing for Fractal driver
+void Fractal_doVBlankProcess() {
+	const u16 start = GET_VCOUNTER;
+
+	Fractal_Update();
+
+	// elapsed scanlines (V counter is 8 bits so it's only an estimation across the VBlank jump)
+	const u16 lines = (GET_VCOUNTER - start) & 0xFF;
+
+	loadSum += lines - loadTab[loadInd];
+	loadTab[loadInd] = lines;
+	loadInd = (loadInd + 1) & (FRACTAL_LOAD_FRAME_NUM - 1);
+}
+
+u16 Fractal_GetCPULoad() {
+	// percent of frame scanlines
+	return (((u32) loadSum) * 100) / (FRACTAL_LOAD_FRAME_NUM * (IS_PAL_SYSTEM?313:262));
+}
+
 void Fractal_Queue(u16 sound) {
 	asm volatile (
 		"move.w	%0,%%d0\n\t"
@@ -0,0 +1,266 @@
+/************************************************************************//**
+ * \brief HTTP download to SRAM or MegaWiFi flash.
+ *
+ * \author Stephane Dallongeville
+ * \date 10/2026
+ ****************************************************************************/
+#include "config.h"
+#include "types.h"
+#include "string.h"
+#include "memory.h"
+#include "sram.h"
+#include "task.h"
+
+
+#if (MODULE_MEGAWIFI != 0)
+
+#include "ext/mw/megawifi.h"
+#include "ext/mw/http_dl.h"
+
+#define UNUSED_PARAM(x)		(void)x
+
+/// Chunk state
+struct chunk {
+	char *data;		///< Chunk buffer
+	uint16_t len;		///< Received bytes
+};
+
+/// Module data (only valid during dl_http_get())
+static struct {
+	struct dl_req *req;	///< Current request
+	struct chunk chunk[2];	///< Double buffer
+	uint8_t cur;		///< Chunk being written
+	uint8_t recv_done;	///< Asynchronous reception completed
+	uint8_t overflow;	///< Data lost while writing to flash
+	uint16_t recv_len;	///< Length of the last received frame
+} dl;
+
+static void recv_cb(enum lsd_status stat, uint8_t ch, char *data,
+		uint16_t len, void *ctx)
+{
+	UNUSED_PARAM(data);
+	UNUSED_PARAM(ctx);
+
+	if (LSD_STAT_COMPLETE == stat && MW_HTTP_CH == ch) {
+		dl.recv_len = len;
+		dl.recv_done = TRUE;
+		TSK_superPost(TRUE);
+	}
+}
+
+/// Network data received while a flash command runs: queue in next chunk
+static void cmd_data_cb(enum lsd_status stat, uint8_t ch, char *data,
+		uint16_t len, void *ctx)
+{
+	struct chunk *next = &dl.chunk[dl.cur ^ 1];
+
+	UNUSED_PARAM(ctx);
+
+	if (LSD_STAT_COMPLETE != stat || MW_HTTP_CH != ch) {
+		return;
+	}
+	if (next->len + len > dl.req->buf_len) {
+		dl.overflow = TRUE;
+		return;
+	}
+	memcpy(next->data + next->len, data, len);
+	next->len += len;
+}
+
+/// Starts receiving into the end of the given chunk
+static void recv_start(struct chunk *c)
+{
+	dl.recv_done = FALSE;
+	mw_recv(c->data + c->len, dl.req->buf_len - c->len, NULL, recv_cb);
+}
+
+/// Waits for the reception started with recv_start()
+static int16_t recv_wait(struct chunk *c)
+{
+	if (!dl.recv_done && TSK_superPend(dl.req->tout_frames)) {
+		return DL_ERR_RECV;
+	}
+	c->len += dl.recv_len;
+
+	return 0;
+}
+
+static int16_t flash_write(uint32_t pos, char *data, uint16_t len)
+{
+	const uint16_t max = MW_CMD_MAX_BUFLEN - sizeof(uint32_t);
+
+	while (len) {
+		const uint32_t addr = dl.req->addr + pos;
+		uint16_t piece = DL_FLASH_SECT_LEN - (addr % DL_FLASH_SECT_LEN);
+
+		// Entering a new sector (resumed partial sector is already
+		// erased)
+		if (addr % DL_FLASH_SECT_LEN == 0 &&
+				mw_flash_sector_erase(addr / DL_FLASH_SECT_LEN)) {
+			return DL_ERR_WRITE;
+		}
+		if (piece > max) {
+			piece = max;
+		}
+		if (piece > len) {
+			piece = len;
+		}
+		if (mw_flash_write(addr, (uint8_t*)data, piece)) {
+			return DL_ERR_WRITE;
+		}
+		data += piece;
+		pos += piece;
+		len -= piece;
+	}
+
+	return 0;
+}
+
+static int16_t chunk_write(struct chunk *c)
+{
+	struct dl_req *req = dl.req;
+	int16_t err = 0;
+
+	if (DL_TARGET_SRAM == req->target) {
+		SRAM_enable();
+		SRAM_write(req->addr + req->offset, c->data, c->len);
+		SRAM_disable();
+	} else {
+		err = flash_write(req->offset, c->data, c->len);
+	}
+	if (err) {
+		return err;
+	}
+
+	req->offset += c->len;
+	c->len = 0;
+
+	if (req->progress && !req->progress(req->offset, req->total,
+				req->ctx)) {
+		return DL_ERR_ABORTED;
+	}
+
+	return 0;
+}
+
+static int16_t http_start(struct dl_req *req)
+{
+	char range[24] = "bytes=";
+	uint32_t len;
+	int16_t status;
+
+	if (mw_http_url_set(req->url) ||
+			mw_http_method_set(MW_HTTP_METHOD_GET)) {
+		return MW_ERR;
+	}
+	mw_http_header_del("Range");
+	if (req->offset) {
+		uintToStr(req->offset, range + 6, 1);
+		strcat(range, "-");
+		if (mw_http_header_add("Range", range)) {
+			return MW_ERR;
+		}
+	}
+	if (mw_http_open(0)) {
+		return MW_ERR;
+	}
+
+	status = mw_http_finish(&len, req->tout_frames);
+	if (206 == status) {
+		req->total = req->offset + len;
+	} else if (200 == status) {
+		// Range not supported, restart from the beginning
+		req->offset = 0;
+		req->total = len;
+	}
+
+	return status;
+}
+
+int16_t dl_http_get(struct dl_req *req)
+{
+	const bool flash = DL_TARGET_FLASH == req->target;
+	struct chunk *c;
+	bool pending;
+	int16_t status;
+	int16_t err = 0;
+
+	if (!req->url || !req->buf || !req->buf_len || (req->buf_len & 1) ||
+			(flash && (req->buf_len < DL_FLASH_MIN_BUF_LEN ||
+				   req->addr % DL_FLASH_SECT_LEN))) {
+		return DL_ERR_PARAM;
+	}
+
+	status = http_start(req);
+	if (status != 200 && status != 206) {
+		return status;
+	}
+
+	memset(&dl, 0, sizeof(dl));
+	dl.req = req;
+	dl.chunk[0].data = req->buf;
+	dl.chunk[1].data = req->buf + req->buf_len;
+	if (flash) {
+		mw_cmd_data_cb_set(cmd_data_cb);
+	}
+
+	c = &dl.chunk[0];
+	pending = req->offset < req->total;
+	if (pending) {
+		recv_start(c);
+	}
+	while (req->offset < req->total) {
+		struct chunk *next = &dl.chunk[dl.cur ^ 1];
+
+		if (pending) {
+			err = recv_wait(c);
+			if (!err && !dl.recv_len) {
+				// Server closed the connection
+				err = DL_ERR_RECV;
+			}
+			if (err) {
+				break;
+			}
+		}
+		// Fill the chunk before writing it (unless body is complete)
+		if (c->len < req->buf_len && c->len < req->total - req->offset) {
+			recv_start(c);
+			pending = TRUE;
+			continue;
+		}
+
+		// In SRAM case, next chunk is received while writing this one.
+		// Flash commands receive data by themselves (see cmd_data_cb)
+		pending = !flash && c->len < req->total - req->offset;
+		if (pending) {
+			recv_start(next);
+		}
+		err = chunk_write(c);
+		if (!err && dl.overflow) {
+			err = DL_ERR_OVERFLOW;
+		}
+		if (err) {
+			break;
+		}
+
+		dl.cur ^= 1;
+		c = next;
+		if (flash && req->offset < req->total) {
+			// Data queued while writing may already fill the chunk
+			pending = c->len < req->buf_len &&
+				c->len < req->total - req->offset;
+			if (pending) {
+				recv_start(c);
+			}
+		}
+	}
+
+	if (flash) {
+		mw_cmd_data_cb_set(NULL);
+	}
+	mw_http_cleanup();
+
+	return err ? err : status;
+}
+
+#endif // MODULE_MEGAWIFI
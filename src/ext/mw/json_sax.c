@@ -0,0 +1,310 @@
+/************************************************************************//**
+ * \brief Incremental (SAX-style) JSON parser.
+ *
+ * \author Stephane Dallongeville
+ * \date 10/2026
+ ****************************************************************************/
+
+#include "config.h"
+#include "types.h"
+#include "string.h"
+#include "memory.h"
+
+
+#if (MODULE_MEGAWIFI != 0)
+
+#include "ext/mw/json_sax.h"
+
+/// Parser states
+enum sax_state {
+	SAX_VALUE = 0,		///< Waiting for a value
+	SAX_VALUE_OR_END,	///< Waiting for a value or array end
+	SAX_KEY_OR_END,		///< Waiting for a key or object end
+	SAX_KEY,		///< Waiting for a key
+	SAX_COLON,		///< Waiting for ':' after key
+	SAX_COMMA_OR_END,	///< Waiting for ',' or object/array end
+	SAX_STRING,		///< Inside a string
+	SAX_STRING_ESC,		///< Escape sequence in a string
+	SAX_PRIMITIVE,		///< Inside a number / true / false / null
+	SAX_DONE,		///< Root element complete
+	SAX_STOP		///< Stopped (callback request or error)
+};
+
+/// Key passed to callbacks for the current value
+#define cur_key(p)	((p)->depth && (p)->stack[(p)->depth - 1] ? \
+		(p)->key : NULL)
+
+static inline bool is_space(char c)
+{
+	return ' ' == c || '\t' == c || '\n' == c || '\r' == c;
+}
+
+static inline bool is_primitive(char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+		'-' == c || '+' == c || '.' == c || 'E' == c;
+}
+
+static void add_char(struct json_sax *p, char c)
+{
+	if (p->in_key) {
+		if (p->key_len < JSON_SAX_MAX_KEY) {
+			p->key[p->key_len++] = c;
+		}
+	} else if (p->val_len < JSON_SAX_MAX_VALUE) {
+		p->val[p->val_len++] = c;
+	}
+}
+
+static enum json_sax_status emit(struct json_sax *p, enum json_sax_event ev,
+		const char *key, const char *value)
+{
+	if (p->cb(ev, key, value, p->depth, p->ctx)) {
+		p->state = SAX_STOP;
+		return JSON_SAX_STOP;
+	}
+
+	return JSON_SAX_OK;
+}
+
+/// Value complete: wait for next item, or done if it was the root
+static void value_end(struct json_sax *p)
+{
+	p->state = p->depth ? SAX_COMMA_OR_END : SAX_DONE;
+}
+
+static enum json_sax_status push(struct json_sax *p, uint8_t obj)
+{
+	const enum json_sax_event ev = obj ? JSON_SAX_EV_OBJ_START :
+		JSON_SAX_EV_ARR_START;
+
+	if (p->depth >= JSON_SAX_MAX_DEPTH) {
+		p->state = SAX_STOP;
+		return JSON_SAX_ERR_DEPTH;
+	}
+
+	if (emit(p, ev, cur_key(p), NULL)) {
+		return JSON_SAX_STOP;
+	}
+	p->stack[p->depth++] = obj;
+	p->state = obj ? SAX_KEY_OR_END : SAX_VALUE_OR_END;
+
+	return JSON_SAX_OK;
+}
+
+static enum json_sax_status pop(struct json_sax *p, uint8_t obj)
+{
+	if (!p->depth || p->stack[p->depth - 1] != obj) {
+		p->state = SAX_STOP;
+		return JSON_SAX_ERR_SYNTAX;
+	}
+
+	p->depth--;
+	if (emit(p, obj ? JSON_SAX_EV_OBJ_END : JSON_SAX_EV_ARR_END,
+				NULL, NULL)) {
+		return JSON_SAX_STOP;
+	}
+	value_end(p);
+
+	return JSON_SAX_OK;
+}
+
+static enum json_sax_status value_start(struct json_sax *p, char c)
+{
+	switch (c) {
+	case '{':
+		return push(p, TRUE);
+
+	case '[':
+		return push(p, FALSE);
+
+	case '"':
+		p->in_key = FALSE;
+		p->val_len = 0;
+		p->state = SAX_STRING;
+		return JSON_SAX_OK;
+
+	default:
+		if (!is_primitive(c)) {
+			p->state = SAX_STOP;
+			return JSON_SAX_ERR_SYNTAX;
+		}
+		p->in_key = FALSE;
+		p->val_len = 0;
+		add_char(p, c);
+		p->state = SAX_PRIMITIVE;
+		return JSON_SAX_OK;
+	}
+}
+
+static enum json_sax_status string_end(struct json_sax *p)
+{
+	if (p->in_key) {
+		p->key[p->key_len] = '\0';
+		p->state = SAX_COLON;
+		return JSON_SAX_OK;
+	}
+
+	p->val[p->val_len] = '\0';
+	if (emit(p, JSON_SAX_EV_STRING, cur_key(p), p->val)) {
+		return JSON_SAX_STOP;
+	}
+	value_end(p);
+
+	return JSON_SAX_OK;
+}
+
+static char unescape(char c)
+{
+	switch (c) {
+	case 'n': return '\n';
+	case 't': return '\t';
+	case 'r': return '\r';
+	case 'b': return '\b';
+	case 'f': return '\f';
+	default:  return c;	// '"', '\\' and '/'
+	}
+}
+
+/// Processes one character, returns FALSE if it has to be processed again
+static bool process_char(struct json_sax *p, char c,
+		enum json_sax_status *stat)
+{
+	*stat = JSON_SAX_OK;
+
+	switch (p->state) {
+	case SAX_STRING:
+		if (p->skip) {
+			p->skip--;
+		} else if ('\\' == c) {
+			p->state = SAX_STRING_ESC;
+		} else if ('"' == c) {
+			*stat = string_end(p);
+		} else {
+			add_char(p, c);
+		}
+		return TRUE;
+
+	case SAX_STRING_ESC:
+		if ('u' == c) {
+			// Unicode characters are not supported
+			add_char(p, '?');
+			p->skip = 4;
+		} else {
+			add_char(p, unescape(c));
+		}
+		p->state = SAX_STRING;
+		return TRUE;
+
+	case SAX_PRIMITIVE:
+		if (is_primitive(c)) {
+			add_char(p, c);
+			return TRUE;
+		}
+		p->val[p->val_len] = '\0';
+		if (emit(p, JSON_SAX_EV_PRIMITIVE, cur_key(p), p->val)) {
+			*stat = JSON_SAX_STOP;
+			return TRUE;
+		}
+		value_end(p);
+		// Terminating character belongs to the next token
+		return FALSE;
+
+	default:
+		break;
+	}
+
+	if (is_space(c)) {
+		return TRUE;
+	}
+
+	switch (p->state) {
+	case SAX_VALUE_OR_END:
+		if (']' == c) {
+			*stat = pop(p, FALSE);
+			break;
+		}
+		// fallthrough
+	case SAX_VALUE:
+		*stat = value_start(p, c);
+		break;
+
+	case SAX_KEY_OR_END:
+		if ('}' == c) {
+			*stat = pop(p, TRUE);
+			break;
+		}
+		// fallthrough
+	case SAX_KEY:
+		if ('"' == c) {
+			p->in_key = TRUE;
+			p->key_len = 0;
+			p->state = SAX_STRING;
+		} else {
+			p->state = SAX_STOP;
+			*stat = JSON_SAX_ERR_SYNTAX;
+		}
+		break;
+
+	case SAX_COLON:
+		if (':' == c) {
+			p->state = SAX_VALUE;
+		} else {
+			p->state = SAX_STOP;
+			*stat = JSON_SAX_ERR_SYNTAX;
+		}
+		break;
+
+	case SAX_COMMA_OR_END:
+		if (',' == c) {
+			p->state = p->stack[p->depth - 1] ? SAX_KEY : SAX_VALUE;
+		} else if ('}' == c || ']' == c) {
+			*stat = pop(p, '}' == c);
+		} else {
+			p->state = SAX_STOP;
+			*stat = JSON_SAX_ERR_SYNTAX;
+		}
+		break;
+
+	default:
+		// Trailing data after the root element is ignored
+		break;
+	}
+
+	return TRUE;
+}
+
+void json_sax_init(struct json_sax *p, json_sax_cb cb, void *ctx)
+{
+	memset(p, 0, sizeof(struct json_sax));
+	p->cb = cb;
+	p->ctx = ctx;
+	p->state = SAX_VALUE;
+}
+
+enum json_sax_status json_sax_feed(struct json_sax *p, const char *data,
+		uint16_t len)
+{
+	enum json_sax_status stat = JSON_SAX_OK;
+	uint16_t i = 0;
+
+	while (i < len && p->state < SAX_DONE) {
+		if (process_char(p, data[i], &stat)) {
+			i++;
+		}
+		if (stat != JSON_SAX_OK) {
+			return stat;
+		}
+	}
+
+	if (SAX_DONE == p->state) {
+		return JSON_SAX_DONE;
+	}
+	if (SAX_STOP == p->state) {
+		return JSON_SAX_STOP;
+	}
+
+	return JSON_SAX_OK;
+}
+
+#endif // MODULE_MEGAWIFI
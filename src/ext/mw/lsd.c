@@ -6,15 +6,21 @@
  * \author Jesus Alonso (doragasu)
  * \date   2016
  * \todo   Implement UART RTS/CTS handshaking.
- * \todo   Current implementation uses polling. Unfortunately as the Genesis/
- *         Megadrive does not have an interrupt pin on the cart, implementing
- *         more efficient data transmission techniques will be tricky.
+ * \note   Default implementation uses polling as the Genesis/Megadrive does
+ *         not have an interrupt pin on the cart. When MEGAWIFI_UART_INT is
+ *         set, the UART is serviced from the External interrupt (requires
+ *         routing the UART INT line to a controller port TH pin) and data
+ *         goes through RX/TX ring buffers.
  * \todo   Proper implementation of error handling.
  ****************************************************************************/
 #include "config.h"
 #include "types.h"
 #include "string.h"
 #include "memory.h"
+#if (MEGAWIFI_UART_INT != 0)
+#include "sys.h"
+#include "vdp.h"
+#endif
 
 
 #if (MODULE_MEGAWIFI != 0)
@@ -29,6 +35,17 @@
 /// Start of data in the buffer (skips STX and LEN fields).
 #define LSD_BUF_DATA_START 		3
 
+#if (MEGAWIFI_UART_INT != 0)
+/// Length of the RX and TX ring buffers (must be a power of 2)
+#define LSD_RING_LEN		256
+/// Ring buffer index mask
+#define LSD_RING_MASK		(LSD_RING_LEN - 1)
+/// Ring buffer used bytes
+#define ring_used(r)		((uint16_t)((r).head - (r).tail) & LSD_RING_MASK)
+/// Ring buffer free bytes (one slot is kept empty)
+#define ring_free(r)		(LSD_RING_MASK - ring_used(r))
+#endif
+
 /// Allowed states for the reception state machine.
 enum recv_state {
 	LSD_RECV_ERROR = -1,	///< An error has occurred
@@ -77,16 +94,120 @@ struct recv_data {
 	uint8_t ch;		///< Reception channel
 };
 
+/// Receive buffer pool
+struct pool_data {
+	char *mem;		///< Pool memory
+	uint16_t buf_len;	///< Length of each buffer
+	uint8_t num;		///< Number of buffers
+	uint8_t free;		///< Free buffers bitmap
+	uint8_t active;		///< Reception to pool buffers enabled
+	uint8_t cur;		///< Buffer used by current reception
+	void *ctx;		///< Reception context
+	lsd_recv_cb cb;		///< Reception callback
+};
+
 /// Local data required by the module.
 struct lsd_data {
 	struct send_data tx;
 	struct recv_data rx;
+	struct pool_data pool;
 	uint8_t ch_enable[LSD_MAX_CH];
 };
 
 /// Module global data
 static struct lsd_data d = {};
 
+#if (MEGAWIFI_UART_INT != 0)
+/// Ring buffer, head is written by the producer and tail by the consumer
+struct ring {
+	volatile uint16_t head;		///< Write position
+	volatile uint16_t tail;		///< Read position
+	uint8_t buf[LSD_RING_LEN];	///< Data
+};
+
+/// Received data (filled from interrupt)
+static struct ring rx_ring;
+/// Data to send (drained from interrupt)
+static struct ring tx_ring;
+
+static void uart_isr(void)
+{
+	uint16_t head, tail;
+
+	// RX: drain the UART FIFO while there is room in the ring
+	head = rx_ring.head;
+	tail = rx_ring.tail;
+	while (uart_rx_ready()) {
+		const uint16_t next = (head + 1) & LSD_RING_MASK;
+
+		if (next == tail) {
+			// Ring full: stop RX interrupt, auto RTS throttles the
+			// sender until lsd_process() frees some room
+			uart_clr_bits(IER, UART_IER__RX);
+			break;
+		}
+		rx_ring.buf[head] = uart_getc();
+		head = next;
+	}
+	rx_ring.head = head;
+
+	// TX: refill the whole UART FIFO at once
+	if (uart_tx_ready()) {
+		head = tx_ring.head;
+		tail = tx_ring.tail;
+		for (int16_t i = UART_TX_FIFO_LEN; i && (tail != head); i--) {
+			uart_putc(tx_ring.buf[tail]);
+			tail = (tail + 1) & LSD_RING_MASK;
+		}
+		tx_ring.tail = tail;
+
+		// Nothing more to send
+		if (tail == head) {
+			uart_clr_bits(IER, UART_IER__THRE);
+		}
+	}
+}
+
+static inline void lsd_putc(uint8_t c)
+{
+	const uint16_t head = tx_ring.head;
+
+	tx_ring.buf[head] = c;
+	tx_ring.head = (head + 1) & LSD_RING_MASK;
+}
+#else
+#define lsd_putc(c)	uart_putc(c)
+#endif
+
+/// Reads UART RX FIFO while data is available, see lsd_a.s
+extern uint16_t lsd_fifo_read(char *dst, uint16_t max);
+
+/// Restarts reception on a free pool buffer (if any)
+static void pool_rearm(void)
+{
+	if (!d.pool.active || (d.rx.stat != LSD_RECV_IDLE &&
+				d.rx.stat != LSD_RECV_PARTIAL)) {
+		return;
+	}
+
+	for (uint8_t i = 0; i < d.pool.num; i++) {
+		if (d.pool.free & (1<<i)) {
+			d.pool.free &= ~(1<<i);
+			d.pool.cur = i;
+			d.rx.buf = d.pool.mem + i * d.pool.buf_len;
+			d.rx.max = d.pool.buf_len;
+			if (LSD_RECV_IDLE == d.rx.stat) {
+				d.rx.stat = LSD_RECV_STX;
+			} else {
+				d.rx.pos = 0;
+				d.rx.stat = LSD_RECV_DATA;
+			}
+			return;
+		}
+	}
+	// No free buffer: reception resumes on lsd_pool_release()
+}
+
 static void recv_error(enum lsd_status stat)
 {
 //	d.rx.stat = LSD_RECV_ERROR;
@@ -94,6 +215,10 @@ static void recv_error(enum lsd_status stat)
 	if (d.rx.cb) {
 		d.rx.cb(stat, 0, NULL, 0, d.rx.ctx);
 	}
+	// Pool buffer is still owned, wait for next frame on it
+	if (d.pool.active && LSD_RECV_IDLE == d.rx.stat) {
+		d.rx.stat = LSD_RECV_STX;
+	}
 }
 
 static void recv_complete(void)
@@ -102,11 +227,12 @@ static void recv_complete(void)
 		d.rx.cb(LSD_STAT_COMPLETE, d.rx.ch, d.rx.buf,
 				d.rx.pos, d.rx.ctx);
 	}
+	// Buffer was handed to the callback, continue on next one
+	pool_rearm();
 }
 
-static void recv_add(uint8_t recv)
+static void recv_check(void)
 {
-	d.rx.buf[d.rx.pos++] = recv;
 	if (d.rx.pos >= d.rx.frame_len) {
 		d.rx.stat = LSD_RECV_ETX;
 	} else if (d.rx.pos >= d.rx.max) {
@@ -118,9 +244,28 @@ static void recv_add(uint8_t recv)
 	}
 }
 
-static void process_recv(void)
+static void recv_add(uint8_t recv)
+{
+	d.rx.buf[d.rx.pos++] = recv;
+	recv_check();
+}
+
+#if (MEGAWIFI_UART_INT == 0)
+/// Copies payload directly from the UART FIFO
+static void recv_burst(void)
+{
+	int16_t max = d.rx.frame_len;
+
+	if (max > d.rx.max) {
+		max = d.rx.max;
+	}
+	d.rx.pos += lsd_fifo_read(d.rx.buf + d.rx.pos, max - d.rx.pos);
+	recv_check();
+}
+#endif
+
+static void process_recv(uint8_t recv)
 {
-	uint8_t recv = uart_getc();
 
 	switch (d.rx.stat) {
 	case LSD_RECV_STX:	// Wait for STX to arrive
@@ -190,29 +335,29 @@ static void process_send(void)
 {
 	switch (d.tx.stat) {
 	case LSD_SEND_STX:
-		uart_putc(LSD_STX_ETX);
+		lsd_putc(LSD_STX_ETX);
 		d.tx.stat = LSD_SEND_CH_LENH;
 		break;
 
 	case LSD_SEND_CH_LENH:
-		uart_putc((d.tx.ch<<4) | (d.tx.total>>8));
+		lsd_putc((d.tx.ch<<4) | (d.tx.total>>8));
 		d.tx.stat = LSD_SEND_LEN;
 		break;
 
 	case LSD_SEND_LEN:
-		uart_putc(d.tx.total & 0xFF);
+		lsd_putc(d.tx.total & 0xFF);
 		d.tx.stat = LSD_SEND_DATA;
 		break;
 
 	case LSD_SEND_DATA:
-		uart_putc(d.tx.buf[d.tx.pos++]);
+		lsd_putc(d.tx.buf[d.tx.pos++]);
 		if (d.tx.pos >= d.tx.total) {
 			d.tx.stat = LSD_SEND_ETX;
 		}
 		break;
 
 	case LSD_SEND_ETX:
-		uart_putc(LSD_STX_ETX);
+		lsd_putc(LSD_STX_ETX);
 		send_complete();
 		break;
 	default:
@@ -220,6 +365,45 @@ static void process_send(void)
 	}
 }
 
+#if (MEGAWIFI_UART_INT != 0)
+void lsd_process(void)
+{
+	int active;
+
+	do {
+		active = FALSE;
+		// Only ring buffers are accessed here, the UART is serviced
+		// from the External interrupt
+		while (d.rx.stat > LSD_RECV_IDLE && ring_used(rx_ring)) {
+			const uint16_t tail = rx_ring.tail;
+
+			active = TRUE;
+			process_recv(rx_ring.buf[tail]);
+			rx_ring.tail = (tail + 1) & LSD_RING_MASK;
+		}
+		if (d.tx.stat > LSD_SEND_IDLE && ring_free(tx_ring)) {
+			active = TRUE;
+			while (d.tx.stat > LSD_SEND_IDLE && ring_free(tx_ring)) {
+				process_send();
+			}
+		}
+	} while(active);
+
+	// Interrupt handler also modifies IER shadow register
+	SYS_disableInts();
+	// Resume reception if it was stopped on full ring
+	if (!(uart_get(IER) & UART_IER__RX) &&
+			ring_free(rx_ring) >= UART_TX_FIFO_LEN) {
+		uart_set_bits(IER, UART_IER__RX);
+	}
+	// Pending TX data: THRE interrupt triggers as soon as it is enabled
+	// if the UART FIFO is empty
+	if (!(uart_get(IER) & UART_IER__THRE) && ring_used(tx_ring)) {
+		uart_set_bits(IER, UART_IER__THRE);
+	}
+	SYS_enableInts();
+}
+#else
 void lsd_process(void)
 {
 	int active;
@@ -229,7 +413,11 @@ void lsd_process(void)
 		if (d.rx.stat > LSD_RECV_IDLE && uart_rx_ready()) {
 			active = TRUE;
 			while (d.rx.stat > LSD_RECV_IDLE && uart_rx_ready()) {
-				process_recv();
+				if (LSD_RECV_DATA == d.rx.stat) {
+					recv_burst();
+				} else {
+					process_recv(uart_getc());
+				}
 			}
 		}
 		if (d.tx.stat > LSD_SEND_IDLE && uart_tx_ready()) {
@@ -241,6 +429,7 @@ void lsd_process(void)
 		}
 	} while(active);
 }
+#endif
 
 void lsd_init(void)
 {
@@ -248,6 +437,19 @@ void lsd_init(void)
 	memset(&d, 0, sizeof(struct lsd_data));
 	d.rx.stat = LSD_RECV_IDLE;
 	lsd_line_sync();
+#if (MEGAWIFI_UART_INT != 0)
+	rx_ring.head = rx_ring.tail = 0;
+	tx_ring.head = tx_ring.tail = 0;
+	SYS_setExtIntCallback(uart_isr);
+	VDP_setExtInterrupt(TRUE);
+	// RX data available interrupt triggers on 14 bytes FIFO level (or
+	// timeout), THRE interrupt is only enabled while there is data to send
+	uart_set(IER, UART_IER__RX);
+#else
+	// INT line is not connected, RX interrupt is only enabled so ISR
+	// reports the FIFO trigger level for burst reads (lsd_fifo_read)
+	uart_set(IER, UART_IER__RX);
+#endif
 }
 
 int lsd_ch_enable(uint8_t ch)
@@ -301,6 +503,11 @@ enum lsd_status lsd_recv(char *buf, int16_t len, void *ctx, lsd_recv_cb recv_cb)
 		return LSD_STAT_ERR_FRAME_TOO_LONG;
 	}
 
+	// Caller buffer reception stops pool reception
+	if (d.pool.active) {
+		lsd_recv_pool_stop();
+	}
+
 	if (LSD_RECV_IDLE == d.rx.stat) {
 		d.rx.stat = LSD_RECV_STX;
 	} else if (LSD_RECV_PARTIAL == d.rx.stat) {
@@ -316,6 +523,68 @@ enum lsd_status lsd_recv(char *buf, int16_t len, void *ctx, lsd_recv_cb recv_cb)
 	return LSD_STAT_BUSY;
 }
 
+int lsd_pool_init(char *mem, uint16_t buf_len, uint8_t num)
+{
+	if (!mem || !buf_len || !num || num > LSD_POOL_MAX_BUFS ||
+			buf_len > LSD_MAX_LEN + 1) {
+		return LSD_STAT_ERROR;
+	}
+
+	lsd_recv_pool_stop();
+	d.pool.mem = mem;
+	d.pool.buf_len = buf_len;
+	d.pool.num = num;
+	d.pool.free = (1<<num) - 1;
+
+	return LSD_STAT_COMPLETE;
+}
+
+enum lsd_status lsd_recv_pool(void *ctx, lsd_recv_cb recv_cb)
+{
+	if (!d.pool.num) {
+		return LSD_STAT_ERROR;
+	}
+	if (d.rx.stat > LSD_RECV_IDLE && !d.pool.active) {
+		return LSD_STAT_ERR_IN_PROGRESS;
+	}
+
+	d.pool.ctx = ctx;
+	d.pool.cb = recv_cb;
+	d.rx.cb = recv_cb;
+	d.rx.ctx = ctx;
+	d.pool.active = TRUE;
+	pool_rearm();
+
+	return LSD_STAT_BUSY;
+}
+
+void lsd_recv_pool_stop(void)
+{
+	if (!d.pool.active) {
+		return;
+	}
+
+	d.pool.active = FALSE;
+	// Give back the buffer of the reception in progress
+	if (d.rx.stat > LSD_RECV_IDLE) {
+		d.pool.free |= 1<<d.pool.cur;
+		d.rx.stat = LSD_RECV_IDLE;
+	}
+}
+
+void lsd_pool_release(char *buf)
+{
+	const uint16_t i = (uint16_t)(buf - d.pool.mem) / d.pool.buf_len;
+
+	if (buf < d.pool.mem || i >= d.pool.num) {
+		return;
+	}
+
+	d.pool.free |= 1<<i;
+	// Reception was waiting for a free buffer
+	pool_rearm();
+}
+
 enum lsd_status lsd_send_sync(uint8_t ch, const char *data, int16_t len)
 {
 	enum lsd_status stat;
@@ -0,0 +1,52 @@
+#include "asm_mac.i"
+
+
+// 16C550 UART registers (see 16c550.h)
+#define UART_RHR    0xA130C1
+#define UART_ISR    4
+#define UART_LSR    10
+
+// RX FIFO trigger level (see uart_init())
+#define UART_RX_TRIG    14
+
+
+// uint16_t lsd_fifo_read(char *dst, uint16_t max)
+// ------------------------------------------------
+// Read UART RX FIFO to dst while data is available (up to max bytes), returns number of read bytes.
+// While FIFO is above the trigger level (RX data available interrupt pending in ISR) a full trigger level
+// block is read without checking LSR.
+func lsd_fifo_read
+    move.l  4(%sp),%a0              // a0 = dst
+    move.w  10(%sp),%d1             // d1 = max
+    lea     UART_RHR,%a1            // a1 = UART base
+
+.lsd_fifo_burst:
+    cmp.w   #UART_RX_TRIG,%d1
+    bcs.s   .lsd_fifo_byte
+
+    moveq   #0x0F,%d0
+    and.b   UART_ISR(%a1),%d0
+    cmp.b   #0x04,%d0               // RX data available (not timeout) ?
+    bne.s   .lsd_fifo_byte
+
+    .rept UART_RX_TRIG
+    move.b  (%a1),(%a0)+
+    .endr
+
+    sub.w   #UART_RX_TRIG,%d1
+    bra.s   .lsd_fifo_burst
+
+.lsd_fifo_byte:
+    subq.w  #1,%d1
+    bcs.s   .lsd_fifo_end
+
+.lsd_fifo_byte_loop:
+    btst    #0,UART_LSR(%a1)        // RX data ready ?
+    beq.s   .lsd_fifo_end
+    move.b  (%a1),(%a0)+
+    dbra    %d1,.lsd_fifo_byte_loop
+
+.lsd_fifo_end:
+    move.l  %a0,%d0
+    sub.l   4(%sp),%d0              // d0 = number of read bytes
+    rts
@@ -0,0 +1,298 @@
+/************************************************************************//**
+ * \brief Rollback netplay input channel for MegaWiFi.
+ *
+ * \author Stephane Dallongeville
+ * \date 10/2026
+ ****************************************************************************/
+#include "config.h"
+#include "types.h"
+#include "string.h"
+#include "memory.h"
+#include "timer.h"
+
+
+#if (MODULE_MEGAWIFI != 0)
+
+#include "ext/mw/megawifi.h"
+#include "ext/mw/netplay.h"
+
+#define UNUSED_PARAM(x)		(void)x
+
+/// Input ring index mask
+#define NP_INPUT_MASK		(NP_INPUT_BUF_LEN - 1)
+/// Packet identifier
+#define NP_MAGIC		0x4E
+
+/// Netplay packet, inputs of frames [first, first + num)
+struct np_packet {
+	uint16_t first;		///< Frame of the first input
+	uint16_t ack;		///< Last contiguous frame received from peer
+	uint16_t stamp;		///< Sender timestamp
+	uint16_t echo;		///< Last timestamp received from peer
+	uint8_t magic;		///< Packet identifier
+	uint8_t num;		///< Number of inputs
+	uint16_t input[NP_INPUT_REDUNDANCY];	///< Joypad states
+};
+
+/// Packet header length
+#define NP_HDR_LEN		(sizeof(struct np_packet) - \
+		NP_INPUT_REDUNDANCY * sizeof(uint16_t))
+
+/// Module data
+static struct {
+	struct np_callbacks cb;		///< Game callbacks
+	struct np_stats stats;		///< Statistics
+	uint16_t local_in[NP_INPUT_BUF_LEN];	///< Local input ring
+	uint16_t remote_in[NP_INPUT_BUF_LEN];	///< Remote input ring
+	uint16_t cur;			///< Frame to advance
+	uint16_t local_last;		///< Last frame with local input
+	uint16_t remote_last;		///< Last contiguous remote frame
+	uint16_t peer_ack;		///< Last local frame acked by peer
+	uint16_t peer_stamp;		///< Last timestamp received
+	uint16_t rollback;		///< First mispredicted frame
+	uint8_t rollback_pending;	///< Rollback needed
+	uint8_t ch;			///< UDP socket channel
+	uint8_t delay;			///< Input delay
+	uint8_t active;			///< Session started
+	volatile uint8_t tx_busy;	///< Packet send in progress
+	struct np_packet tx;		///< Send buffer
+	struct np_packet rx;		///< Receive buffer
+} np = {};
+
+static void recv_cb(enum lsd_status stat, uint8_t ch, char *data,
+		uint16_t len, void *ctx);
+
+static void send_cb(enum lsd_status stat, void *ctx)
+{
+	UNUSED_PARAM(stat);
+	UNUSED_PARAM(ctx);
+
+	np.tx_busy = FALSE;
+}
+
+static void recv_start(void)
+{
+	lsd_recv((char*)&np.rx, sizeof(struct np_packet), NULL, recv_cb);
+}
+
+static void mark_rollback(uint16_t frame)
+{
+	if (!np.rollback_pending || (int16_t)(frame - np.rollback) < 0) {
+		np.rollback = frame;
+		np.rollback_pending = TRUE;
+	}
+}
+
+static void process_packet(const struct np_packet *pkt, uint16_t len)
+{
+	uint16_t frame;
+	uint16_t num;
+
+	if (len < NP_HDR_LEN || pkt->magic != NP_MAGIC ||
+			pkt->num > NP_INPUT_REDUNDANCY) {
+		return;
+	}
+
+	if (pkt->echo) {
+		np.stats.rtt = (uint16_t)getTick() - pkt->echo;
+	}
+	np.peer_stamp = pkt->stamp;
+	if ((int16_t)(pkt->ack - np.peer_ack) > 0) {
+		np.peer_ack = pkt->ack;
+	}
+
+	num = (len - NP_HDR_LEN) / sizeof(uint16_t);
+	if (num > pkt->num) {
+		num = pkt->num;
+	}
+	frame = pkt->first;
+	for (uint16_t i = 0; i < num; i++, frame++) {
+		// Only accept next contiguous frame (older ones are duplicates)
+		if ((uint16_t)(frame - np.remote_last) != 1) {
+			continue;
+		}
+		// Keep room in the ring for the frames we may roll back to
+		if ((int16_t)(frame - np.cur) >=
+				NP_INPUT_BUF_LEN - NP_MAX_ROLLBACK) {
+			break;
+		}
+
+		const uint16_t idx = frame & NP_INPUT_MASK;
+		const uint16_t input = pkt->input[i];
+
+		// Frame already simulated with a wrong prediction
+		if ((int16_t)(frame - np.cur) < 0 &&
+				np.remote_in[idx] != input) {
+			mark_rollback(frame);
+		}
+		np.remote_in[idx] = input;
+		np.remote_last = frame;
+	}
+}
+
+static void recv_cb(enum lsd_status stat, uint8_t ch, char *data,
+		uint16_t len, void *ctx)
+{
+	UNUSED_PARAM(ctx);
+
+	if (!np.active) {
+		return;
+	}
+	if (LSD_STAT_COMPLETE == stat && ch == np.ch) {
+		process_packet((const struct np_packet*)data, len);
+	}
+	recv_start();
+}
+
+static void send_packet(void)
+{
+	uint16_t first;
+	int16_t num;
+
+	// Previous packet still being sent, next one carries the inputs
+	if (np.tx_busy) {
+		np.stats.lost++;
+		return;
+	}
+
+	first = np.peer_ack + 1;
+	// Do not send inputs already overwritten in the ring
+	if ((int16_t)(np.local_last - first) >= NP_INPUT_BUF_LEN) {
+		first = np.local_last - NP_INPUT_BUF_LEN + 1;
+	}
+	num = (int16_t)(np.local_last - first) + 1;
+	if (num < 0) {
+		num = 0;
+	} else if (num > NP_INPUT_REDUNDANCY) {
+		num = NP_INPUT_REDUNDANCY;
+	}
+
+	np.tx.first = first;
+	np.tx.ack = np.remote_last;
+	np.tx.stamp = getTick();
+	np.tx.echo = np.peer_stamp;
+	np.tx.magic = NP_MAGIC;
+	np.tx.num = num;
+	for (int16_t i = 0; i < num; i++) {
+		np.tx.input[i] = np.local_in[(first + i) & NP_INPUT_MASK];
+	}
+
+	np.tx_busy = TRUE;
+	if (lsd_send(np.ch, (const char*)&np.tx, NP_HDR_LEN +
+				num * sizeof(uint16_t), NULL, send_cb) !=
+			LSD_STAT_BUSY) {
+		np.tx_busy = FALSE;
+		np.stats.lost++;
+	}
+}
+
+/// Predicted remote input: last known one is repeated
+static inline uint16_t predict(void)
+{
+	return np.remote_in[np.remote_last & NP_INPUT_MASK];
+}
+
+static void rollback(void)
+{
+	uint16_t frame = np.rollback;
+
+	np.rollback_pending = FALSE;
+	np.stats.rollbacks++;
+	np.cb.load(frame, np.cb.ctx);
+
+	while (frame != np.cur) {
+		const uint16_t idx = frame & NP_INPUT_MASK;
+
+		// Predict again with latest known input
+		if ((int16_t)(frame - np.remote_last) > 0) {
+			np.remote_in[idx] = predict();
+		}
+		if (frame != np.rollback) {
+			np.cb.save(frame, np.cb.ctx);
+		}
+		np.cb.advance(np.local_in[idx], np.remote_in[idx], np.cb.ctx);
+		np.stats.rollback_frames++;
+		frame++;
+	}
+}
+
+enum np_status np_init(uint8_t ch, const struct np_callbacks *cb,
+		uint8_t delay)
+{
+	if (!cb || !cb->save || !cb->load || !cb->advance ||
+			ch > MW_MAX_SOCK || delay > NP_MAX_DELAY) {
+		return NP_STAT_ERR_PARAM;
+	}
+
+	memset(&np, 0, sizeof(np));
+	np.cb = *cb;
+	np.ch = ch;
+	np.delay = delay;
+	// Inputs of the first delay frames are implicitly known (0)
+	np.local_last = delay - 1;
+	np.remote_last = delay - 1;
+	np.peer_ack = delay - 1;
+	np.active = TRUE;
+
+	recv_start();
+
+	return NP_STAT_OK;
+}
+
+void np_end(void)
+{
+	np.active = FALSE;
+}
+
+enum np_status np_frame(uint16_t local_input, uint16_t *local_out,
+		uint16_t *remote_out)
+{
+	uint16_t idx;
+
+	if (!np.active) {
+		return NP_STAT_ERROR;
+	}
+
+	// Receive pending packets (and complete pending send)
+	mw_process();
+
+	// Peer too far behind, wait for it
+	if ((int16_t)(np.cur - np.remote_last) > NP_MAX_ROLLBACK) {
+		np.stats.waits++;
+		send_packet();
+		return NP_STAT_WAIT;
+	}
+
+	if (np.rollback_pending) {
+		rollback();
+	}
+
+	np.local_last = np.cur + np.delay;
+	np.local_in[np.local_last & NP_INPUT_MASK] = local_input;
+
+	idx = np.cur & NP_INPUT_MASK;
+	if ((int16_t)(np.cur - np.remote_last) > 0) {
+		np.remote_in[idx] = predict();
+	}
+
+	np.cb.save(np.cur, np.cb.ctx);
+	send_packet();
+
+	*local_out = np.local_in[idx];
+	*remote_out = np.remote_in[idx];
+	np.cur++;
+
+	return NP_STAT_OK;
+}
+
+uint16_t np_frame_get(void)
+{
+	return np.cur;
+}
+
+const struct np_stats *np_stats_get(void)
+{
+	return &np.stats;
+}
+
+#endif // MODULE_MEGAWIFI
@@ -0,0 +1,143 @@
+#include "config.h"
+#include "types.h"
+
+#include "hud.h"
+
+#include "vdp.h"
+#include "memory.h"
+#include "tools.h"
+
+
+static TextLayer* layer = NULL;
+static HudWidget widgets[HUD_WIDGET_MAX];
+static u16 numWidget;
+
+
+static void drawWidget(HudWidget* w);
+
+
+bool HUD_init(bool bottom, u16 height, u16 basetile)
+{
+    HUD_end();
+
+    const u16 y = bottom?((screenHeight / 8) - height):0;
+
+    layer = TEXT_create(WINDOW, basetile, 0, y, screenWidth / 8, height);
+    if (layer == NULL) return FALSE;
+
+    numWidget = 0;
+
+    // window only defined by vertical position
+    VDP_setWindowHPos(FALSE, 0);
+    VDP_setWindowVPos(bottom, y + (bottom?0:height));
+
+    return TRUE;
+}
+
+void HUD_end()
+{
+    if (layer == NULL) return;
+
+    // hide window
+    VDP_setWindowVPos(FALSE, 0);
+
+    TEXT_release(layer);
+    layer = NULL;
+}
+
+TextLayer* HUD_getLayer()
+{
+    return layer;
+}
+
+s16 HUD_addNumber(u16 x, u16 y, u16 digits)
+{
+    if (numWidget >= HUD_WIDGET_MAX)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("HUD_addNumber(..) failed: max number of widget reached = ", HUD_WIDGET_MAX);
+#endif
+        return -1;
+    }
+
+    HudWidget* w = &widgets[numWidget];
+
+    w->type = HUD_NUMBER;
+    w->x = x;
+    w->y = y;
+    w->len = digits;
+    w->value = 0;
+    drawWidget(w);
+
+    return numWidget++;
+}
+
+s16 HUD_addMeter(u16 x, u16 y, u16 len, u16 tile, u16 steps, u32 max)
+{
+    if (numWidget >= HUD_WIDGET_MAX)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("HUD_addMeter(..) failed: max number of widget reached = ", HUD_WIDGET_MAX);
+#endif
+        return -1;
+    }
+
+    HudWidget* w = &widgets[numWidget];
+
+    w->type = HUD_METER;
+    w->x = x;
+    w->y = y;
+    w->len = min(len, 64);
+    w->tile = tile;
+    w->steps = steps;
+    w->max = max;
+    w->value = 0;
+    drawWidget(w);
+
+    return numWidget++;
+}
+
+void HUD_setValue(s16 id, u32 value)
+{
+    if ((id < 0) || (id >= numWidget)) return;
+
+    HudWidget* w = &widgets[id];
+
+    // unchanged --> nothing to do
+    if (w->value == value) return;
+
+    w->value = value;
+    drawWidget(w);
+}
+
+u16 HUD_update()
+{
+    return TEXT_update(layer);
+}
+
+
+static void drawWidget(HudWidget* w)
+{
+    if (w->type == HUD_NUMBER)
+    {
+        TEXT_drawUInt(layer, w->value, w->x, w->y, w->len);
+        return;
+    }
+
+    u16 data[64];
+    const u16 steps = w->steps;
+    const u16 base = layer->basetile + w->tile;
+    const u32 value = min(w->value, w->max);
+    // filled units (steps per cell)
+    u32 fill = w->max?((value * (w->len * steps)) / w->max):0;
+
+    for(u16 i = 0; i < w->len; i++)
+    {
+        const u16 f = min(fill, steps);
+
+        data[i] = base + f;
+        fill -= f;
+    }
+
+    TEXT_setTiles(layer, data, w->x, w->y, w->len);
+}
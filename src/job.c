@@ -0,0 +1,117 @@
+#include "config.h"
+#include "types.h"
+
+#include "job.h"
+
+#include "vdp.h"
+#include "sys.h"
+#include "timer.h"
+#include "tools.h"
+
+
+typedef struct
+{
+    JobCallback* fn;
+    void* data;
+    u16 cost;
+    // first frame the job can be executed on
+    u16 frame;
+} Job;
+
+
+static Job jobs[JOB_QUEUE_SIZE];
+static u16 jobRead = 0;
+static u16 jobWrite = 0;
+// frame of the last JOB_process() call (oversized jobs only run on first call of a frame)
+static u16 processFrame = 0;
+
+
+// forward
+static bool pushJob(JobCallback* fn, void* data, u16 cost, u16 frame);
+
+
+bool JOB_push(JobCallback* fn, void* data, u16 cost)
+{
+    return pushJob(fn, data, cost, vtimer);
+}
+
+bool JOB_pushNextFrame(JobCallback* fn, void* data, u16 cost)
+{
+    return pushJob(fn, data, cost, vtimer + 1);
+}
+
+void JOB_clear()
+{
+    jobRead = jobWrite;
+}
+
+u16 JOB_getNumPending()
+{
+    return (jobWrite - jobRead) & (JOB_QUEUE_SIZE - 1);
+}
+
+u16 JOB_process()
+{
+    const u16 scrHeight = VDP_getScreenHeight();
+    // first wait for VBlank of this frame ? --> accept a single oversized job
+    bool oversizedOk = processFrame != (u16) vtimer;
+    u16 res = 0;
+
+    processFrame = vtimer;
+
+    while(jobRead != jobWrite)
+    {
+        // in VBlank --> no more time
+        if (GET_VDP_STATUS(VDP_VBLANK_FLAG)) break;
+
+        const u16 vcnt = GET_VCOUNTER;
+        // safety for V-Counter value outside active area
+        if (vcnt >= scrHeight) break;
+
+        Job* job = &jobs[jobRead];
+        const u16 cost = job->cost;
+
+        // not yet allowed (frame counter wrapping safe)
+        if ((s16) (job->frame - (u16) vtimer) > 0) break;
+
+        // doesn't fit (a job which can never fit is accepted on first call of the frame and overruns it)
+        if (cost > (scrHeight - vcnt))
+        {
+            if ((cost < scrHeight) || !oversizedOk) break;
+            oversizedOk = FALSE;
+        }
+
+        // remove it first so the job can push new jobs
+        jobRead = (jobRead + 1) & (JOB_QUEUE_SIZE - 1);
+        job->fn(job->data);
+        res++;
+    }
+
+    return res;
+}
+
+
+static bool pushJob(JobCallback* fn, void* data, u16 cost, u16 frame)
+{
+    const u16 next = (jobWrite + 1) & (JOB_QUEUE_SIZE - 1);
+
+    if (next == jobRead)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog("JOB_push(..) warning: job queue is full");
+#endif
+        return FALSE;
+    }
+
+    Job* job = &jobs[jobWrite];
+
+    job->fn = fn;
+    job->data = data;
+    // at least 1 scanline
+    job->cost = cost?cost:1;
+    job->frame = frame;
+
+    jobWrite = next;
+
+    return TRUE;
+}
@@ -8,6 +8,9 @@
 #include "sys.h"
 #include "vdp.h"
 #include "z80_ctrl.h"
+#include "profiler.h"
+#include "sram.h"
+#include "tools.h"
 
 
 #define JOY_TYPE_SHIFT          12
@@ -31,12 +34,41 @@ static u16 gport;
 
 static JoyEventCallback *joyEventCB;
 
+// input history (state changes) for JOY_1 / JOY_2
+static u16 histState[JOY_HISTORY_JOY_NUM][JOY_HISTORY_SIZE];
+static u16 histFrame[JOY_HISTORY_JOY_NUM][JOY_HISTORY_SIZE];
+static u16 histIndex[JOY_HISTORY_JOY_NUM];
+
+// input record / playback
+static u16 replayMode;
+static u32 replayFrame;
+static u16 *recBuffer;
+static u16 recSize;
+static u16 *recEntry;
+static const u16 *playEntry;
+static u32 playRemain;
+static u16 playFrames;
+
+
+static void updateState(u16 joy, u16 val);
+static void recordHistory(u16 joy, u16 state);
+static void recordFrame(u16 state1, u16 state2);
+static void playFrame(void);
+static u16 getRecordSize(void);
+
 
 void JOY_init()
 {
     /* Reset controller state change event callback */
     joyEventCB = NULL;
 
+    /* Reset input history */
+    JOY_clearHistory();
+
+    /* No input record or playback */
+    replayMode = JOY_REPLAY_OFF;
+    recBuffer = NULL;
+
     /* Then perform controller port reset and peripheral detection */
     JOY_reset();
 }
@@ -1143,13 +1175,23 @@ static u16 readTrackball(u16 port)
 
 void JOY_update()
 {
-    u16 val;
-    u16 newstate;
-    u16 change;
+    u16 val1, val2;
+    u16 support1, support2;
 #if (HALT_Z80_ON_IO == 1)
     u16 z80state;
 #endif
 
+    support1 = portSupport[PORT_1];
+    support2 = portSupport[PORT_2];
+
+    /* nothing to read */
+    if ((support1 == JOY_SUPPORT_OFF) && (support2 == JOY_SUPPORT_OFF) && (replayMode == JOY_REPLAY_OFF)) return;
+
+    PROF_begin(PROF_ZONE_JOY);
+
+    val1 = 0xFFFF;
+    val2 = 0xFFFF;
+
     /* disable ints */
     SYS_disableInts();
 
@@ -1157,45 +1199,23 @@ void JOY_update()
     z80state = Z80_getAndRequestBus(TRUE);
 #endif
 
-    switch (portSupport[PORT_1])
+    /* only IO accesses are done while Z80 is halted, state update and events are processed after */
+    switch (support1)
     {
-        case JOY_SUPPORT_OFF:
-            break;
-
         case JOY_SUPPORT_3BTN:
-            val = read3Btn(PORT_1);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_1] ^ newstate;
-            joyType[JOY_1] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_1] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_1, change, newstate);
+            val1 = read3Btn(PORT_1);
             break;
 
         case JOY_SUPPORT_6BTN:
-            val = read6Btn(PORT_1);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_1] ^ newstate;
-            joyType[JOY_1] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_1] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_1, change, newstate);
+            val1 = read6Btn(PORT_1);
             break;
 
         case JOY_SUPPORT_MOUSE:
-            val = readMouse(PORT_1);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_1] ^ newstate;
-            joyType[JOY_1] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_1] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_1, change, newstate);
+            val1 = readMouse(PORT_1);
             break;
 
         case JOY_SUPPORT_TRACKBALL:
-            val = readTrackball(PORT_1);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_1] ^ newstate;
-            joyType[JOY_1] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_1] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_1, change, newstate);
+            val1 = readTrackball(PORT_1);
             break;
 
         case JOY_SUPPORT_TEAMPLAYER:
@@ -1217,45 +1237,22 @@ void JOY_update()
             break;
     }
 
-    switch (portSupport[PORT_2])
+    switch (support2)
     {
-        case JOY_SUPPORT_OFF:
-            break;
-
         case JOY_SUPPORT_3BTN:
-            val = read3Btn(PORT_2);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_2] ^ newstate;
-            joyType[JOY_2] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_2] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_2, change, newstate);
+            val2 = read3Btn(PORT_2);
             break;
 
         case JOY_SUPPORT_6BTN:
-            val = read6Btn(PORT_2);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_2] ^ newstate;
-            joyType[JOY_2] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_2] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_2, change, newstate);
+            val2 = read6Btn(PORT_2);
             break;
 
         case JOY_SUPPORT_MOUSE:
-            val = readMouse(PORT_2);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_2] ^ newstate;
-            joyType[JOY_2] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_2] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_2, change, newstate);
+            val2 = readMouse(PORT_2);
             break;
 
         case JOY_SUPPORT_TRACKBALL:
-            val = readTrackball(PORT_2);
-            newstate = val & BUTTON_ALL;
-            change = joyState[JOY_2] ^ newstate;
-            joyType[JOY_2] = val >> JOY_TYPE_SHIFT;
-            joyState[JOY_2] = newstate;
-            if ((joyEventCB) && (change)) joyEventCB(JOY_2, change, newstate);
+            val2 = readTrackball(PORT_2);
             break;
 
         case JOY_SUPPORT_TEAMPLAYER:
@@ -1277,6 +1274,300 @@ void JOY_update()
     if (!z80state) Z80_releaseBus();
 #endif
 
+    /* input playback replaces JOY_1 / JOY_2 states */
+    if (replayMode == JOY_REPLAY_PLAY) playFrame();
+    else
+    {
+        /* pad / mouse / trackball state update */
+        if (val1 != 0xFFFF) updateState(JOY_1, val1);
+        if (val2 != 0xFFFF) updateState(JOY_2, val2);
+
+        if (replayMode == JOY_REPLAY_RECORD) recordFrame(joyState[JOY_1], joyState[JOY_2]);
+    }
+
+    /* store state changes in input history */
+    recordHistory(JOY_1, joyState[JOY_1]);
+    recordHistory(JOY_2, joyState[JOY_2]);
+
     /* restore ints */
     SYS_enableInts();
+
+    PROF_end(PROF_ZONE_JOY);
+}
+
+void JOY_sample()
+{
+    u16 port;
+
+    /* states come from input playback */
+    if (replayMode == JOY_REPLAY_PLAY) return;
+
+    for(port = PORT_1; port <= PORT_2; port++)
+    {
+        const u8 support = portSupport[port];
+
+        /* only for joypad (single TH cycle so it doesn't disturb 6 button pad if done far enough from JOY_update()) */
+        if ((support == JOY_SUPPORT_3BTN) || (support == JOY_SUPPORT_6BTN))
+        {
+            /* keep 6 buttons part from last full read */
+            const u16 state = (joyState[port] & ~(BUTTON_DIR | BUTTON_A | BUTTON_B | BUTTON_C | BUTTON_START)) | (read3Btn(port) & 0x00FF);
+
+            recordHistory(port, state);
+        }
+    }
+}
+
+void JOY_clearHistory()
+{
+    memset(histState, 0, sizeof(histState));
+    memset(histFrame, 0, sizeof(histFrame));
+    memset(histIndex, 0, sizeof(histIndex));
+}
+
+u16 JOY_getHistory(u16 joy, u16 index, u16 *frame)
+{
+    if ((joy >= JOY_HISTORY_JOY_NUM) || (index >= JOY_HISTORY_SIZE)) return 0;
+
+    const u16 i = (histIndex[joy] - index) & (JOY_HISTORY_SIZE - 1);
+
+    if (frame) *frame = histFrame[joy][i];
+
+    return histState[joy][i];
+}
+
+bool JOY_matchSequence(u16 joy, const u16 *seq, u16 len, u16 maxFrames)
+{
+    if ((joy >= JOY_HISTORY_JOY_NUM) || !len) return FALSE;
+
+    const u16* states = histState[joy];
+    const u16* frames = histFrame[joy];
+    const u16 now = vtimer;
+    u16 ind = histIndex[joy];
+    s16 k = len - 1;
+    u16 n = JOY_HISTORY_SIZE;
+
+    /* scan history from newest to oldest, intermediate states are ignored */
+    while(n--)
+    {
+        const u16 state = states[ind];
+        const u16 elem = seq[k];
+
+        /* too old */
+        if ((u16) (now - frames[ind]) > maxFrames) break;
+
+        /* buttons must be pressed and direction must match exactly (if any) */
+        if (((state & elem) == elem) && (!(elem & BUTTON_DIR) || ((state & BUTTON_DIR) == (elem & BUTTON_DIR))))
+        {
+            if (--k < 0) return TRUE;
+        }
+        /* last element must be matched by current state */
+        else if (k == (len - 1)) return FALSE;
+
+        ind = (ind - 1) & (JOY_HISTORY_SIZE - 1);
+    }
+
+    return FALSE;
+}
+
+
+void JOY_startRecord(u16 *buffer, u16 size, u16 seed)
+{
+    JOY_stopPlayback();
+    JOY_stopRecord();
+
+    if (size < (JOY_RECORD_HEADER_SIZE + JOY_RECORD_ENTRY_SIZE))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("JOY_startRecord(..) failed: buffer is too small, size = ", size);
+#endif
+        return;
+    }
+
+    /* header: magic, seed, number of entry */
+    buffer[0] = JOY_RECORD_MAGIC;
+    buffer[1] = seed;
+    buffer[2] = 0;
+    buffer[3] = 0;
+
+    recBuffer = buffer;
+    recSize = size;
+    recEntry = NULL;
+    replayFrame = 0;
+    replayMode = JOY_REPLAY_RECORD;
+
+    if (seed) setRandomSeed(seed);
+}
+
+u16 JOY_stopRecord()
+{
+    if (replayMode == JOY_REPLAY_RECORD) replayMode = JOY_REPLAY_OFF;
+
+    return getRecordSize();
+}
+
+u16 JOY_saveRecord(u32 offset)
+{
+    const u16 size = getRecordSize();
+
+    if (size == 0) return 0;
+
+    SRAM_enable();
+    SRAM_write(offset, recBuffer, size * 2);
+    SRAM_disable();
+
+    return size;
+}
+
+u16 JOY_loadRecord(u32 offset, u16 *buffer, u16 size)
+{
+    u32 numEntry;
+    u32 total;
+
+    SRAM_enableRO();
+
+    /* check header */
+    if (SRAM_readWord(offset) != JOY_RECORD_MAGIC)
+    {
+        SRAM_disable();
+        return 0;
+    }
+
+    numEntry = ((u32) SRAM_readWord(offset + 4) << 16) | SRAM_readWord(offset + 6);
+    total = JOY_RECORD_HEADER_SIZE + (numEntry * JOY_RECORD_ENTRY_SIZE);
+
+    /* doesn't fit in buffer (or in a single SRAM read) */
+    if ((total > size) || (total > 0x7FFF))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("JOY_loadRecord(..) failed: record size = ", total, " buffer size = ", size);
+#endif
+        SRAM_disable();
+        return 0;
+    }
+
+    SRAM_read(offset, buffer, total * 2);
+    SRAM_disable();
+
+    return total;
+}
+
+bool JOY_startPlayback(const u16 *data)
+{
+    if (data[0] != JOY_RECORD_MAGIC) return FALSE;
+
+    JOY_stopRecord();
+
+    playEntry = &data[JOY_RECORD_HEADER_SIZE];
+    playRemain = ((u32) data[2] << 16) | data[3];
+    playFrames = playRemain ? playEntry[0] : 0;
+    replayFrame = 0;
+    replayMode = JOY_REPLAY_PLAY;
+
+    /* same random sequence as during record */
+    if (data[1]) setRandomSeed(data[1]);
+
+    return TRUE;
+}
+
+void JOY_stopPlayback()
+{
+    if (replayMode == JOY_REPLAY_PLAY) replayMode = JOY_REPLAY_OFF;
+}
+
+u16 JOY_getReplayMode()
+{
+    return replayMode;
+}
+
+u32 JOY_getReplayFrame()
+{
+    return replayFrame;
+}
+
+
+static void recordFrame(u16 state1, u16 state2)
+{
+    u16 *entry = recEntry;
+
+    /* same states ? --> extend current entry */
+    if (entry && (entry[0] != 0xFFFF) && (entry[1] == state1) && (entry[2] == state2)) entry[0]++;
+    else
+    {
+        entry = entry ? (entry + JOY_RECORD_ENTRY_SIZE) : (recBuffer + JOY_RECORD_HEADER_SIZE);
+
+        /* buffer full --> stop recording */
+        if ((entry + JOY_RECORD_ENTRY_SIZE) > (recBuffer + recSize))
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+            KLog_U1("JOY_update() warning: input record buffer is full, record stopped at frame ", replayFrame);
+#endif
+            replayMode = JOY_REPLAY_OFF;
+            return;
+        }
+
+        entry[0] = 1;
+        entry[1] = state1;
+        entry[2] = state2;
+        recEntry = entry;
+
+        /* update number of entry in header */
+        const u32 numEntry = (((u32) recBuffer[2] << 16) | recBuffer[3]) + 1;
+        recBuffer[2] = numEntry >> 16;
+        recBuffer[3] = numEntry;
+    }
+
+    replayFrame++;
+}
+
+static void playFrame()
+{
+    /* end of record --> back to controller ports */
+    if (playRemain == 0)
+    {
+        replayMode = JOY_REPLAY_OFF;
+        return;
+    }
+
+    /* keep controller type */
+    updateState(JOY_1, (joyType[JOY_1] << JOY_TYPE_SHIFT) | playEntry[1]);
+    updateState(JOY_2, (joyType[JOY_2] << JOY_TYPE_SHIFT) | playEntry[2]);
+
+    /* next entry */
+    if (--playFrames == 0)
+    {
+        playEntry += JOY_RECORD_ENTRY_SIZE;
+        if (--playRemain) playFrames = playEntry[0];
+    }
+
+    replayFrame++;
+}
+
+static u16 getRecordSize()
+{
+    if (recBuffer == NULL) return 0;
+
+    return JOY_RECORD_HEADER_SIZE + (((((u32) recBuffer[2]) << 16) | recBuffer[3]) * JOY_RECORD_ENTRY_SIZE);
+}
+
+static void updateState(u16 joy, u16 val)
+{
+    const u16 newstate = val & BUTTON_ALL;
+    const u16 change = joyState[joy] ^ newstate;
+
+    joyType[joy] = val >> JOY_TYPE_SHIFT;
+    joyState[joy] = newstate;
+    if ((joyEventCB) && (change)) joyEventCB(joy, change, newstate);
+}
+
+static void recordHistory(u16 joy, u16 state)
+{
+    u16 ind = histIndex[joy];
+
+    /* no change */
+    if (histState[joy][ind] == state) return;
+
+    ind = (ind + 1) & (JOY_HISTORY_SIZE - 1);
+    histState[joy][ind] = state;
+    histFrame[joy][ind] = vtimer;
+    histIndex[joy] = ind;
 }
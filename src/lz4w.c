@@ -0,0 +1,235 @@
+#include "config.h"
+#include "types.h"
+
+#include "lz4w.h"
+
+#include "maths.h"
+#include "tools.h"
+
+
+// operation to do once segment literals are copied
+#define OP_NONE         0
+#define OP_MATCH        1
+#define OP_LONG_MATCH   2
+#define OP_END          3
+#define OP_DONE         4
+
+
+void LZ4W_initStream(LZ4WStream* stream, const u8* src, u8* dest)
+{
+    stream->src = (const u16*) src;
+    stream->dst = (u16*) dest;
+    stream->dstStart = dest;
+    stream->ref = NULL;
+    stream->lit = 0;
+    stream->mat = 0;
+    stream->len = 0;
+    stream->off = 0;
+    stream->op = OP_NONE;
+}
+
+u16 LZ4W_unpackChunk(LZ4WStream* stream, u16 maxOut)
+{
+    const u16* src = stream->src;
+    u16* dst = stream->dst;
+    u16* const start = dst;
+    // budget in word (0 = no limit)
+    u16 budget = maxOut ? ((maxOut + 1) >> 1) : 0xFFFF;
+    u16 last = 0;
+
+    while(budget)
+    {
+        // pending literals
+        if (stream->lit)
+        {
+            u16 n = min(stream->lit, budget);
+
+            stream->lit -= n;
+            budget -= n;
+            while(n--) *dst++ = *src++;
+            continue;
+        }
+        // pending match (always word per word as source and destination can overlap)
+        if (stream->mat)
+        {
+            const u16* ref = stream->ref;
+            u16 n = min(stream->mat, budget);
+
+            stream->mat -= n;
+            budget -= n;
+            while(n--) *dst++ = *ref++;
+            stream->ref = ref;
+            continue;
+        }
+
+        // literals done, start match if any
+        if (stream->op == OP_MATCH)
+        {
+            // match offset is relative to destination
+            stream->ref = dst - stream->off;
+            stream->mat = stream->len;
+            stream->op = OP_NONE;
+            continue;
+        }
+        if (stream->op == OP_LONG_MATCH)
+        {
+            // get long offset (already negated), bit 15 contains ROM source info
+            const u16 value = *src++;
+            const s16 offset = ((s16) (value << 1)) >> 1;
+
+            // ROM source: match offset is relative to packed data
+            if (value & 0x8000) stream->ref = src + (offset - 1);
+            else stream->ref = dst + (offset - 1);
+            stream->mat = stream->len;
+            stream->op = OP_NONE;
+            continue;
+        }
+        if (stream->op == OP_END)
+        {
+            const u16 value = *src++;
+
+            // need to copy a last byte ?
+            if (value & 0x8000)
+            {
+                *((u8*) dst) = value;
+                last = 1;
+            }
+            stream->op = OP_DONE;
+        }
+        if (stream->op == OP_DONE) break;
+
+        // get next segment
+        const u16 seg = *src++;
+        const u16 mat = (seg >> 8) & 0xF;
+        const u16 off = seg & 0xFF;
+
+        stream->lit = seg >> 12;
+
+        if (mat)
+        {
+            stream->len = mat + 1;
+            stream->off = off + 1;
+            stream->op = OP_MATCH;
+        }
+        // long match (offset field contains length)
+        else if (off)
+        {
+            stream->len = off + 2;
+            stream->op = OP_LONG_MATCH;
+        }
+        // empty segment --> end
+        else if (!stream->lit) stream->op = OP_END;
+    }
+
+    stream->src = src;
+    stream->dst = dst;
+
+    return ((dst - start) * 2) + last;
+}
+
+bool LZ4W_isStreamDone(const LZ4WStream* stream)
+{
+    return (stream->op == OP_DONE);
+}
+
+u32 LZ4W_getStreamSize(const LZ4WStream* stream)
+{
+    const u32 size = (u32) ((u8*) stream->dst - stream->dstStart);
+
+    // last byte isn't counted in dst position
+    if ((stream->op == OP_DONE) && (stream->src[-1] & 0x8000)) return size + 1;
+
+    return size;
+}
+
+u32 LZ4W_getInfo(const u8* src, u32* packedSize, u16* margin)
+{
+    const u16* s = (const u16*) src;
+    // written size minus read size (in word), in-place needs output to never go past input position
+    s32 delta = 0;
+    s32 maxDelta = 0;
+    u32 size = 0;
+
+    while(TRUE)
+    {
+        const u16 seg = *s++;
+        const u16 lit = seg >> 12;
+        const u16 mat = (seg >> 8) & 0xF;
+        const u16 off = seg & 0xFF;
+        u16 len;
+
+        // end ?
+        if (!seg) break;
+
+        // literals don't change delta but segment header does
+        s += lit;
+        size += lit;
+        delta--;
+
+        if (mat) len = mat + 1;
+        else if (off)
+        {
+            // long match offset word
+            s++;
+            delta--;
+            len = off + 2;
+        }
+        else len = 0;
+
+        size += len;
+        delta += len;
+        if (delta > maxDelta) maxDelta = delta;
+    }
+
+    // last byte
+    const u16 last = (*s++ & 0x8000) ? 1 : 0;
+    const u32 packed = (u32) ((const u8*) s - src);
+    const u32 unpacked = (size * 2) + last;
+
+    if (packedSize) *packedSize = packed;
+    // margin = max(written - read) - (unpacked - packed), rounded to word and + 2 for the final word
+    if (margin)
+    {
+        const s32 m = (maxDelta * 2) - (s32) (size * 2) + (s32) packed;
+        *margin = (m > 0) ? ((m + 1) & ~1) + 2 : 2;
+    }
+
+    return unpacked;
+}
+
+const u8* LZ4W_prepareInPlace(const u8* src, u8* dest, u32 destSize)
+{
+    u32 packed;
+    u16 margin;
+    const u32 unpacked = LZ4W_getInfo(src, &packed, &margin);
+
+    // word aligned location at end of destination buffer
+    u16* d = (u16*) (dest + ((destSize - packed) & ~1));
+
+    // not enough space
+    if ((destSize < packed) || ((u8*) d < (dest + (unpacked & ~1) + margin - packed)))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U3("LZ4W_prepareInPlace(..) failed: destination buffer too small, size = ", destSize, " unpacked = ", unpacked, " margin = ", margin);
+#endif
+        return NULL;
+    }
+
+    const u16* s = (const u16*) src;
+    u16* result = d;
+    u32 n = packed >> 1;
+
+    // source may already be in destination buffer (copy backward in that case)
+    if ((u8*) d > src)
+    {
+        s += n;
+        d += n;
+        while(n--) *--d = *--s;
+    }
+    else
+    {
+        while(n--) *d++ = *s++;
+    }
+
+    return (const u8*) result;
+}
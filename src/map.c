@@ -8,6 +8,8 @@
 #include "vdp_tile.h"
 #include "memory.h"
 #include "tools.h"
+#include "timer.h"
+#include "profiler.h"
 
 
 //#define MAP_DEBUG
@@ -17,11 +19,46 @@
 // we don't want to share it
 extern vu16 VBlankProcess;
 
+#if (ENABLE_MAP_STATS != 0)
+#define STAT_ADD(field, value)          stats.field += (value)
+#else
+#define STAT_ADD(field, value)
+#endif
+
+// metatile coordinates masks
+#define MAP_MASK_X(map)                 ((((map)->wMask) << 3) | 7)
+#define MAP_MASK_Y(map)                 ((((map)->hMask) << 3) | 7)
+// overlay contains modifications ?
+#define HAS_OVERLAY(map)                (((map)->overlay != NULL) && ((map)->overlay->num != 0))
+
+// plane column (row) already contains valid data for the current view rows (columns) ?
+#define IS_COLUMN_VALID(map, c, yt)     (((c) >= (map)->colLo) && ((c) < (map)->colHi) && ((map)->rowLo <= (yt)) && ((map)->rowHi >= ((yt) + 16)))
+#define IS_ROW_VALID(map, r, xt)        (((r) >= (map)->rowLo) && ((r) < (map)->rowHi) && ((map)->colLo <= (xt)) && ((map)->colHi >= ((xt) + 21)))
+
 
 // forward
-static void updateMap(Map *map, s16 xt, s16 yt);
+static bool updateMap(Map *map, s16 xt, s16 yt);
+static bool updateMapH(Map *map, s16 xt, s16 yt);
+static bool updateMapV(Map *map, s16 xt, s16 yt);
+static void prefetchMap(Map *map, s16 dx, s16 dy);
+static bool extendWindow(s16 *lo, s16 *hi, s16 v, s16 maxSize);
+static MapOverlayEntry* findOverlayEntry(MapOverlay* overlay, u16 x, u16 y);
+static void patchColumn(Map* map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height);
+static void patchRow(Map* map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width);
+#if (ENABLE_MAP_STATS != 0)
+static void beginStatsFrame(Map* map, u32 x, u32 y);
+static u16 getStatsTime(u16 start);
+
+static MapStats stats;
+// frame (vtimer) of current stats
+static u32 statsFrame;
+// view position of current stats frame
+static u32 statsX;
+static u32 statsY;
+#endif
 static void setMapColumn(Map *map, u16 column, u16 x, u16 y);
 static void setMapRow(Map *map, u16 row, u16 x, u16 y);
+static void prepareColumn(Map *map, u16 *bufCol1, u16 *bufCol2, u16 x, u16 y);
 
 static void prepareMapDataColumn(Map* map, u16* bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height);
 static void prepareMapDataColumn_MTI8_BI8(Map* map, u16* bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height);
@@ -53,10 +90,26 @@ static void getMetaTilemapRect_MTI8_BI16(Map* map, u16 x, u16 y, u16 w, u16 h, u
 static void getMetaTilemapRect_MTI16_BI8(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest);
 static void getMetaTilemapRect_MTI16_BI16(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest);
 
+static void unpackPatchBlock(MapBlockCache* cache, u16 blockInd, u8* dst);
+static void* getStreamBlock(Map* map, u16 blockGridIndex);
+static void prepareMapDataColumn_Stream(Map* map, u16* bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height);
+static void prepareMapDataRow_Stream(Map* map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width);
+static u16 getMetaTile_Stream(Map* map, u16 x, u16 y);
+static void getMetaTilemapRect_Stream(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest);
+
+static u32 getBlocksSize(const MapDefinition* mapDef);
+static u32 getBlockIndexesSize(const MapDefinition* mapDef);
+static void releaseFarData(Map* map);
+
 
 Map* MAP_create(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile)
 {
-    Map* result = allocateMap(mapDef);
+    return MAP_createEx(mapDef, plane, baseTile, MAP_SCROLL_HV, MAP_BLOCK_CACHE_SIZE_DEFAULT);
+}
+
+Map* MAP_createEx(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile, u16 mode, u16 blockCacheSize)
+{
+    Map* result = allocateMapEx(mapDef, max(blockCacheSize, MAP_BLOCK_CACHE_SIZE_MIN));
 
     if (result == NULL) return result;
 
@@ -74,25 +127,54 @@ Map* MAP_create(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile)
     comp = compression & 0xF;
     // metaTiles are compressed ?
     if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->metaTiles, mapDef->numMetaTile * 2 * 4), (u8*) result->metaTiles);
-    // init FAR pointer
-    else result->metaTiles = FAR_SAFE(mapDef->metaTiles, mapDef->numMetaTile * 2 * 4);
+    // init FAR pointer (pinned until MAP_release(..))
+    else result->metaTiles = FAR_ACQUIRE(mapDef->metaTiles, mapDef->numMetaTile * 2 * 4);
 
     // get blocks data compression
     comp = (compression >> 4) & 0xF;
+    // streamed blocks ?
+    if (compression & MAP_BLOCKS_STREAM)
+    {
+        MapBlockCache* cache = result->blockCache;
+
+        cache->compression = comp;
+        cache->wideIndex = (mapDef->numBlock > 256);
+        cache->patch = (compression & MAP_BLOCKS_PATCH) != 0;
+        cache->stamp = 0;
+        cache->misses = 0;
+        // pointers to packed blocks (pinned until MAP_release(..))
+        cache->blockData = FAR_ACQUIRE(mapDef->blocks, mapDef->numBlock * 4);
+        // mark all slots as empty
+        memsetU16(cache->ids, 0xFFFF, cache->size);
+        memsetU16(cache->stamps, 0, cache->size);
+    }
     // blocks data are compressed ?
-    if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->blocks, mapDef->numBlock * 64 * ((mapDef->numMetaTile > 256)?2:1)), (u8*) result->blocks);
-    // init FAR pointer
-    else result->blocks = FAR_SAFE(mapDef->blocks, mapDef->numBlock * 64 * ((mapDef->numMetaTile > 256)?2:1));
+    else if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->blocks, getBlocksSize(mapDef)), (u8*) result->blocks);
+    // init FAR pointer (pinned until MAP_release(..))
+    else result->blocks = FAR_ACQUIRE(mapDef->blocks, getBlocksSize(mapDef));
 
     // get blocks indexes data compression
     comp = (compression >> 8) & 0xF;
     // blocks indexes data are compressed ?
-    if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->blockIndexes, mulu(mapDef->w, mapDef->hp) * ((mapDef->numBlock > 256)?2:1)), (u8*) result->blockIndexes);
-    // init FAR pointer
-    else result->blockIndexes = FAR_SAFE(mapDef->blockIndexes, mapDef->w * mapDef->hp * ((mapDef->numBlock > 256)?2:1));
+    if (comp != COMPRESSION_NONE) unpack(comp, (u8*) FAR_SAFE(mapDef->blockIndexes, getBlockIndexesSize(mapDef)), (u8*) result->blockIndexes);
+    // init FAR pointer (pinned until MAP_release(..))
+    else result->blockIndexes = FAR_ACQUIRE(mapDef->blockIndexes, getBlockIndexesSize(mapDef));
 
-    // init FAR pointer
-    result->blockRowOffsets = FAR_SAFE(mapDef->blockRowOffsets, mapDef->h * 2);
+    // init FAR pointer (pinned until MAP_release(..))
+    result->blockRowOffsets = FAR_ACQUIRE(mapDef->blockRowOffsets, mapDef->h * 2);
+    result->mapDef = mapDef;
+
+#if (ENABLE_BANK_SWITCH != 0)
+    // not enough bank regions to keep all map data mapped ?
+    if (!result->metaTiles || !result->blockIndexes || !result->blockRowOffsets || !((compression & MAP_BLOCKS_STREAM)?(void*) result->blockCache->blockData:result->blocks))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("MAP_create(..) failed: cannot map all map data (too many pinned bank regions)");
+#endif
+        MAP_release(result);
+        return NULL;
+    }
+#endif
 
     // init base parameters
     result->plane = plane;
@@ -101,9 +183,44 @@ Map* MAP_create(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile)
     // mark for init
     result->planeWidthMask = 0;
     result->planeHeightMask = 0;
+    // no look-ahead by default, empty valid area
+    result->prefetchCol = 0;
+    result->prefetchRow = 0;
+    result->colLo = 0;
+    result->colHi = 0;
+    result->rowLo = 0;
+    result->rowHi = 0;
+    result->metaTileAttr = NULL;
+    result->overlay = NULL;
+    result->scrollMode = mode;
+    result->tileCache = NULL;
+
+    // trimmed update for single direction scrolling
+    switch(mode)
+    {
+        case MAP_SCROLL_H_ONLY:
+            result->updateMapCB = &updateMapH;
+            break;
+
+        case MAP_SCROLL_V_ONLY:
+            result->updateMapCB = &updateMapV;
+            break;
+
+        default:
+            result->updateMapCB = &updateMap;
+            break;
+    }
 
     // prepare function pointers
-    if (mapDef->numMetaTile > 256)
+    if (result->blockCache != NULL)
+    {
+        // streamed blocks (generic methods)
+        result->prepareMapDataColumnCB = &prepareMapDataColumn_Stream;
+        result->prepareMapDataRowCB = &prepareMapDataRow_Stream;
+        result->getMetaTileCB = &getMetaTile_Stream;
+        result->getMetaTilemapRectCB = &getMetaTilemapRect_Stream;
+    }
+    else if (mapDef->numMetaTile > 256)
     {
         // 16 bit for metatile index
         if (mapDef->numBlock > 256)
@@ -191,7 +308,7 @@ Map* MAP_create(const MapDefinition* mapDef, VDPPlane plane, u16 baseTile)
     return result;
 }
 
-void MAP_scrollToEx(Map* map, u32 x, u32 y, bool forceRedraw)
+static bool prepareScroll(Map* map, u32 x, u32 y, bool forceRedraw)
 {
     bool redraw;
 
@@ -208,74 +325,239 @@ void MAP_scrollToEx(Map* map, u32 x, u32 y, bool forceRedraw)
 
     if (redraw)
     {
+        // horizontal only map --> force full map update using column updates
+        if (map->scrollMode == MAP_SCROLL_H_ONLY)
+        {
+            map->posX = x - (21 * 16);
+            map->posY = y;
+        }
         // force full map update using row updates
-        map->posX = x;
-        map->posY = y - 256;
+        else
+        {
+            map->posX = x;
+            map->posY = y - 256;
+        }
         map->lastXT = map->posX >> 4;
         map->lastYT = map->posY >> 4;
+        // plane content isn't valid anymore
+        map->colLo = map->colHi = 0;
+        map->rowLo = map->rowHi = 0;
+    }
+
+    // update map, use idle frame to prepare map data ahead
+    if (!map->updateMapCB(map, x >> 4, y >> 4) && (map->prefetchCol || map->prefetchRow))
+        prefetchMap(map, x - map->posX, y - map->posY);
+
+    return redraw;
+}
+
+static void setScrollX(Map* map, u32 x)
+{
+    u16 len;
+
+    switch(VDP_getHorizontalScrollingMode())
+    {
+        case HSCROLL_PLANE:
+            VDP_setHorizontalScrollVSync(map->plane, -x);
+            break;
+
+        case HSCROLL_TILE:
+            // important to set scroll for all tile
+            len = screenHeight / 8;
+            memsetU16(map->hScrollTable, -x, len);
+            VDP_setHorizontalScrollTile(map->plane, 0, (s16*) map->hScrollTable, len, DMA_QUEUE);
+            break;
+
+        case HSCROLL_LINE:
+            // important to set scroll for all line
+            len = screenHeight;
+            memsetU16(map->hScrollTable, -x, len);
+            VDP_setHorizontalScrollLine(map->plane, 0, (s16*) map->hScrollTable, len, DMA_QUEUE);
+            break;
+    }
+
+    // store X position
+    map->posX = x;
+}
+
+static void setScrollY(Map* map, u32 y)
+{
+    // interlaced mode 2: map uses 8x16 tiles so map coordinates are in field line unit while vertical scroll is in frame line unit
+    const u16 vy = (VDP_getScanMode() == INTERLACED_MODE2)?(y << 1):y;
+
+    switch(VDP_getVerticalScrollingMode())
+    {
+        case VSCROLL_PLANE:
+            VDP_setVerticalScrollVSync(map->plane, vy);
+            break;
+
+        case VSCROLL_COLUMN:
+            // important to set scroll for all column
+            memsetU16(map->vScrollTable, vy, 20);
+            VDP_setVerticalScrollTile(map->plane, 0, (s16*) map->vScrollTable, 20, DMA_QUEUE);
+            break;
     }
 
-    // update map
-    updateMap(map, x >> 4, y >> 4);
+    // store Y position
+    map->posY = y;
+}
+
+void MAP_scrollToEx(Map* map, u32 x, u32 y, bool forceRedraw)
+{
+#if (ENABLE_MAP_STATS != 0)
+    beginStatsFrame(map, x, y);
+#endif
+    PROF_begin(PROF_ZONE_MAP);
+
+    const bool redraw = prepareScroll(map, x, y, forceRedraw);
 
     // X scrolling changed ?
-    if (redraw || (map->posX != x))
+    if (redraw || (map->posX != x)) setScrollX(map, x);
+    // Y scrolling changed ?
+    if (redraw || (map->posY != y)) setScrollY(map, y);
+
+    PROF_end(PROF_ZONE_MAP);
+}
+
+void MAP_scrollTo(Map* map, u32 x, u32 y)
+{
+    MAP_scrollToEx(map, x, y, FALSE);
+}
+
+void MAP_setPrefetch(Map* map, u16 columns, u16 rows)
+{
+    // no look-ahead in fixed direction
+    map->prefetchCol = (map->scrollMode == MAP_SCROLL_V_ONLY)?0:columns;
+    map->prefetchRow = (map->scrollMode == MAP_SCROLL_H_ONLY)?0:rows;
+}
+
+
+void MAP_initGroup(MapGroup* group)
+{
+    group->num = 0;
+}
+
+bool MAP_addToGroup(MapGroup* group, Map* map, fix16 ratioX, fix16 ratioY)
+{
+    const u16 num = group->num;
+
+    if (num >= MAP_GROUP_MAX)
     {
-        u16 len;
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("MAP_addToGroup(..) failed: group is full, max map = ", MAP_GROUP_MAX);
+#endif
+        return FALSE;
+    }
 
-        switch(VDP_getHorizontalScrollingMode())
-        {
-            case HSCROLL_PLANE:
-                VDP_setHorizontalScrollVSync(map->plane, -x);
-                break;
+    group->maps[num] = map;
+    group->ratioX[num] = ratioX;
+    group->ratioY[num] = ratioY;
+    group->num = num + 1;
 
-            case HSCROLL_TILE:
-                // important to set scroll for all tile
-                len = screenHeight / 8;
-                memsetU16(map->hScrollTable, -x, len);
-                VDP_setHorizontalScrollTile(map->plane, 0, (s16*) map->hScrollTable, len, DMA_QUEUE);
-                break;
+    return TRUE;
+}
 
-            case HSCROLL_LINE:
-                // important to set scroll for all line
-                len = screenHeight;
-                memsetU16(map->hScrollTable, -x, len);
-                VDP_setHorizontalScrollLine(map->plane, 0, (s16*) map->hScrollTable, len, DMA_QUEUE);
-                break;
-        }
+void MAP_scrollGroupTo(MapGroup* group, u32 x, u32 y)
+{
+    MAP_scrollGroupToEx(group, x, y, FALSE);
+}
+
+void MAP_scrollGroupToEx(MapGroup* group, u32 x, u32 y, bool forceRedraw)
+{
+    const u16 num = group->num;
+    u32 posX[MAP_GROUP_MAX];
+    u32 posY[MAP_GROUP_MAX];
+    bool changedX[MAP_GROUP_MAX];
+    bool changedY[MAP_GROUP_MAX];
+    u16 i;
+
+    // update all maps first (column / row updates are queued together)
+    for(i = 0; i < num; i++)
+    {
+        Map* map = group->maps[i];
+        const u32 px = (x * (u32) group->ratioX[i]) >> FIX16_FRAC_BITS;
+        const u32 py = (y * (u32) group->ratioY[i]) >> FIX16_FRAC_BITS;
 
-        // store X position
-        map->posX = x;
+#if (ENABLE_MAP_STATS != 0)
+        beginStatsFrame(map, px, py);
+#endif
+        const bool redraw = prepareScroll(map, px, py, forceRedraw);
+
+        posX[i] = px;
+        posY[i] = py;
+        changedX[i] = redraw || (map->posX != px);
+        changedY[i] = redraw || (map->posY != py);
     }
-    // Y scrolling changed ?
-    if (redraw || (map->posY != y))
+
+    // BG_A and BG_B scroll entries are interleaved in line / column scroll tables so we can use a single DMA for both
+    const bool merge = (num == 2) && (group->maps[0]->plane != group->maps[1]->plane);
+    // BG_A map index
+    const u16 ia = (group->maps[0]->plane == BG_A)?0:1;
+
+    if (merge && (changedX[0] || changedX[1]) && (VDP_getHorizontalScrollingMode() == HSCROLL_LINE))
     {
-        switch(VDP_getVerticalScrollingMode())
+        const u16 len = screenHeight;
+        u16* buf = DMA_allocateTemp(len * 2);
+
+        if (buf)
         {
-            case VSCROLL_PLANE:
-                VDP_setVerticalScrollVSync(map->plane, y);
-                break;
+            const u16 va = -posX[ia];
+            const u16 vb = -posX[ia ^ 1];
+            u16* dst = buf;
+
+            i = len;
+            while(i--)
+            {
+                *dst++ = va;
+                *dst++ = vb;
+            }
+
+            DMA_queueDmaFast(DMA_VRAM, buf, VDP_HSCROLL_TABLE, len * 2, 2);
 
-            case VSCROLL_COLUMN:
-                // important to set scroll for all column
-                memsetU16(map->vScrollTable, y, 20);
-                VDP_setVerticalScrollTile(map->plane, 0, (s16*) map->vScrollTable, 20, DMA_QUEUE);
-                break;
+            group->maps[0]->posX = posX[0];
+            group->maps[1]->posX = posX[1];
+            changedX[0] = changedX[1] = FALSE;
         }
+    }
+    if (merge && (changedY[0] || changedY[1]) && (VDP_getVerticalScrollingMode() == VSCROLL_COLUMN))
+    {
+        const u16 len = 20;
+        u16* buf = DMA_allocateTemp(len * 2);
+
+        if (buf)
+        {
+            const u16 va = posY[ia];
+            const u16 vb = posY[ia ^ 1];
+            u16* dst = buf;
+
+            i = len;
+            while(i--)
+            {
+                *dst++ = va;
+                *dst++ = vb;
+            }
+
+            DMA_queueDmaFast(DMA_VSRAM, buf, 0, len * 2, 2);
 
-        // store Y position
-        map->posY = y;
+            group->maps[0]->posY = posY[0];
+            group->maps[1]->posY = posY[1];
+            changedY[0] = changedY[1] = FALSE;
+        }
     }
-}
 
-void MAP_scrollTo(Map* map, u32 x, u32 y)
-{
-    MAP_scrollToEx(map, x, y, FALSE);
+    // remaining scroll updates
+    for(i = 0; i < num; i++)
+    {
+        Map* map = group->maps[i];
+
+        if (changedX[i]) setScrollX(map, posX[i]);
+        if (changedY[i]) setScrollY(map, posY[i]);
+    }
 }
 
 
 // xt, yt are in *meta* tile position
-static void updateMap(Map* map, s16 xt, s16 yt)
+static bool updateMap(Map* map, s16 xt, s16 yt)
 {
     s16 cxt = map->lastXT;
     s16 cyt = map->lastYT;
@@ -283,7 +565,7 @@ static void updateMap(Map* map, s16 xt, s16 yt)
     s16 deltaY = yt - cyt;
 
     // no update --> exit
-    if ((deltaX == 0) && (deltaY == 0)) return;
+    if ((deltaX == 0) && (deltaY == 0)) return FALSE;
 
 #ifdef MAP_DEBUG
     KLog_S4("updateMap xt=", xt, " yt=", yt, " deltaX=", deltaX, " deltaY=", deltaY);
@@ -330,7 +612,8 @@ static void updateMap(Map* map, s16 xt, s16 yt)
         // need to update map column on right
         while(deltaX--)
         {
-            setMapColumn(map, cxt & map->planeWidthMask, cxt, yt);
+            // not already prepared ?
+            if (!IS_COLUMN_VALID(map, cxt, yt)) setMapColumn(map, cxt & map->planeWidthMask, cxt, yt);
             cxt++;
         }
     }
@@ -340,7 +623,8 @@ static void updateMap(Map* map, s16 xt, s16 yt)
         while(deltaX++)
         {
             cxt--;
-            setMapColumn(map, cxt & map->planeWidthMask, cxt, yt);
+            // not already prepared ?
+            if (!IS_COLUMN_VALID(map, cxt, yt)) setMapColumn(map, cxt & map->planeWidthMask, cxt, yt);
         }
     }
 
@@ -352,7 +636,8 @@ static void updateMap(Map* map, s16 xt, s16 yt)
         // need to update map row on bottom
         while(deltaY--)
         {
-            setMapRow(map, cyt & map->planeHeightMask, xt, cyt);
+            // not already prepared ?
+            if (!IS_ROW_VALID(map, cyt, xt)) setMapRow(map, cyt & map->planeHeightMask, xt, cyt);
             cyt++;
         }
     }
@@ -362,12 +647,218 @@ static void updateMap(Map* map, s16 xt, s16 yt)
         while(deltaY++)
         {
             cyt--;
-            setMapRow(map, cyt & map->planeHeightMask, xt, cyt);
+            // not already prepared ?
+            if (!IS_ROW_VALID(map, cyt, xt)) setMapRow(map, cyt & map->planeHeightMask, xt, cyt);
+        }
+    }
+
+    // visible area is always valid here, make sure valid area contains it
+    if ((map->colLo > xt) || (map->colHi < (xt + 21)) || (map->rowLo > yt) || (map->rowHi < (yt + 16)))
+    {
+        map->colLo = xt;
+        map->colHi = xt + 21;
+        map->rowLo = yt;
+        map->rowHi = yt + 16;
+    }
+
+    map->lastXT = xt;
+    map->lastYT = yt;
+
+    return TRUE;
+}
+
+// horizontal only scrolling: row (yt) stays fixed at lastYT
+static bool updateMapH(Map* map, s16 xt, s16 yt)
+{
+    s16 cxt = map->lastXT;
+    s16 deltaX = xt - cxt;
+    const s16 fyt = map->lastYT;
+
+    // no update --> exit
+    if (deltaX == 0) return FALSE;
+
+#ifdef MAP_DEBUG
+    KLog_S2("updateMapH xt=", xt, " deltaX=", deltaX);
+#endif
+
+    // clip to 21 metatiles column max (full screen update)
+    if (deltaX > 21)
+    {
+        cxt += deltaX - 21;
+        deltaX = 21;
+    }
+    else if (deltaX < -21)
+    {
+        cxt += deltaX + 21;
+        deltaX = -21;
+    }
+
+    if (deltaX > 0)
+    {
+        // update on right
+        cxt += 21;
+
+        while(deltaX--)
+        {
+            if (!IS_COLUMN_VALID(map, cxt, fyt)) setMapColumn(map, cxt & map->planeWidthMask, cxt, fyt);
+            cxt++;
+        }
+    }
+    else
+    {
+        // update on left
+        while(deltaX++)
+        {
+            cxt--;
+            if (!IS_COLUMN_VALID(map, cxt, fyt)) setMapColumn(map, cxt & map->planeWidthMask, cxt, fyt);
         }
     }
 
+    // visible area is always valid here, make sure valid area contains it
+    if ((map->colLo > xt) || (map->colHi < (xt + 21)))
+    {
+        map->colLo = xt;
+        map->colHi = xt + 21;
+        map->rowLo = fyt;
+        map->rowHi = fyt + 16;
+    }
+
     map->lastXT = xt;
+
+    return TRUE;
+}
+
+// vertical only scrolling: column (xt) stays fixed at lastXT
+static bool updateMapV(Map* map, s16 xt, s16 yt)
+{
+    s16 cyt = map->lastYT;
+    s16 deltaY = yt - cyt;
+    const s16 fxt = map->lastXT;
+
+    // no update --> exit
+    if (deltaY == 0) return FALSE;
+
+#ifdef MAP_DEBUG
+    KLog_S2("updateMapV yt=", yt, " deltaY=", deltaY);
+#endif
+
+    // clip to 16 metatiles row max (full screen update)
+    if (deltaY > 16)
+    {
+        cyt += deltaY - 16;
+        deltaY = 16;
+    }
+    else if (deltaY < -16)
+    {
+        cyt += deltaY + 16;
+        deltaY = -16;
+    }
+
+    if (deltaY > 0)
+    {
+        // update on bottom
+        cyt += 16;
+
+        while(deltaY--)
+        {
+            if (!IS_ROW_VALID(map, cyt, fxt)) setMapRow(map, cyt & map->planeHeightMask, fxt, cyt);
+            cyt++;
+        }
+    }
+    else
+    {
+        // update on top
+        while(deltaY++)
+        {
+            cyt--;
+            if (!IS_ROW_VALID(map, cyt, fxt)) setMapRow(map, cyt & map->planeHeightMask, fxt, cyt);
+        }
+    }
+
+    // visible area is always valid here, make sure valid area contains it
+    if ((map->rowLo > yt) || (map->rowHi < (yt + 16)))
+    {
+        map->colLo = fxt;
+        map->colHi = fxt + 21;
+        map->rowLo = yt;
+        map->rowHi = yt + 16;
+    }
+
     map->lastYT = yt;
+
+    return TRUE;
+}
+
+static void prefetchMap(Map* map, s16 dx, s16 dy)
+{
+    const s16 xt = map->lastXT;
+    const s16 yt = map->lastYT;
+
+    // prepare in main moving direction
+    if (map->prefetchCol && dx && (abs(dx) >= abs(dy)))
+    {
+        // limit look-ahead to hidden part of plane
+        const s16 ahead = min((s16) map->prefetchCol, (s16) (map->planeWidthMask + 1) - 21);
+
+        if (ahead <= 0) return;
+
+        // prepare next column on right
+        if (dx > 0)
+        {
+            const s16 c = map->colHi;
+            if (c < (xt + 21 + ahead)) setMapColumn(map, c & map->planeWidthMask, c, yt);
+        }
+        // prepare next column on left
+        else
+        {
+            const s16 c = map->colLo - 1;
+            if (c >= (xt - ahead)) setMapColumn(map, c & map->planeWidthMask, c, yt);
+        }
+    }
+    else if (map->prefetchRow && dy)
+    {
+        // limit look-ahead to hidden part of plane
+        const s16 ahead = min((s16) map->prefetchRow, (s16) (map->planeHeightMask + 1) - 16);
+
+        if (ahead <= 0) return;
+
+        // prepare next row on bottom
+        if (dy > 0)
+        {
+            const s16 r = map->rowHi;
+            if (r < (yt + 16 + ahead)) setMapRow(map, r & map->planeHeightMask, xt, r);
+        }
+        // prepare next row on top
+        else
+        {
+            const s16 r = map->rowLo - 1;
+            if (r >= (yt - ahead)) setMapRow(map, r & map->planeHeightMask, xt, r);
+        }
+    }
+}
+
+// extend [lo, hi[ window with v, return FALSE if v isn't contiguous to window
+static bool extendWindow(s16 *lo, s16 *hi, s16 v, s16 maxSize)
+{
+    // already in window
+    if ((v >= *lo) && (v < *hi)) return TRUE;
+
+    if (v == *hi)
+    {
+        (*hi)++;
+        // v overwrote the first entry of window (plane wrapping)
+        if ((*hi - *lo) > maxSize) (*lo)++;
+        return TRUE;
+    }
+    if (v == (*lo - 1))
+    {
+        (*lo)--;
+        // v overwrote the last entry of window (plane wrapping)
+        if ((*hi - *lo) > maxSize) (*hi)--;
+        return TRUE;
+    }
+
+    return FALSE;
 }
 
 static void setMapColumn(Map *map, u16 column, u16 x, u16 y)
@@ -381,9 +872,11 @@ static void setMapColumn(Map *map, u16 column, u16 x, u16 y)
 #endif
 
     const u16 ph = planeHeight;
+    // 128 tiles wide plane: column step (256 bytes) doesn't fit in VDP auto increment
+    const bool wide = (planeWidth == 128);
 
-    // allocate temp buffer for tilemap
-    u16* buf = DMA_allocateTemp(ph * 2);
+    // allocate temp buffer for tilemap (wide plane also rewrites the column 64 tiles apart)
+    u16* buf = DMA_allocateTemp(wide?(ph * 4):(ph * 2));
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
     if (!buf)
@@ -393,6 +886,59 @@ static void setMapColumn(Map *map, u16 column, u16 x, u16 y)
     }
 #endif
 
+    // update valid area: column x now valid for rows [y, y + 16[
+    {
+        const s16 lo = max(map->rowLo, (s16) y);
+        const s16 hi = min(map->rowHi, (s16) (y + 16));
+
+        if ((lo < hi) && extendWindow(&map->colLo, &map->colHi, x, map->planeWidthMask + 1))
+        {
+            map->rowLo = lo;
+            map->rowHi = hi;
+        }
+        else
+        {
+            map->colLo = x;
+            map->colHi = x + 1;
+            map->rowLo = y;
+            map->rowHi = y + 16;
+        }
+    }
+
+    STAT_ADD(columns, 1);
+    STAT_ADD(totalColumns, 1);
+
+    if (wide)
+    {
+        // partner column uses same VRAM column slots (half a plane apart), take the one in valid area if any
+        const u16 xp = ((x >= 32) && ((s16) (x - 32) >= map->colLo) && ((s16) (x - 32) < map->colHi))?(x - 32):(x + 32);
+        const u16 xa = (column & 32)?xp:x;
+        const u16 xb = (column & 32)?x:xp;
+        const u16 vramAddr = ((map->plane == BG_A)?VDP_BG_A:VDP_BG_B) + ((column & 31) * 4);
+        u16 tmp[4][64];
+
+        // queue DMA (first column of both slots, interleaved with 128 bytes step)
+        DMA_queueDmaFast(DMA_VRAM, buf, vramAddr + 0, ph * 2, 128);
+        // queue DMA (second column of both slots)
+        DMA_queueDmaFast(DMA_VRAM, buf + (ph * 2), vramAddr + 2, ph * 2, 128);
+
+        prepareColumn(map, tmp[0], tmp[1], xa, y);
+        prepareColumn(map, tmp[2], tmp[3], xb, y);
+
+        // interleave
+        u16* dst1 = buf;
+        u16* dst2 = buf + (ph * 2);
+        for(u16 i = 0; i < ph; i++)
+        {
+            *dst1++ = tmp[0][i];
+            *dst1++ = tmp[2][i];
+            *dst2++ = tmp[1][i];
+            *dst2++ = tmp[3][i];
+        }
+
+        return;
+    }
+
     // VRAM destination address
     const u16 vramAddr = ((map->plane == BG_A)?VDP_BG_A:VDP_BG_B) + (column * 4);
     // get plane width * 2
@@ -408,6 +954,11 @@ static void setMapColumn(Map *map, u16 column, u16 x, u16 y)
     KLog_S1("setMapColumn - DMA queue operations duration=", end - start);
 #endif
 
+    prepareColumn(map, buf, buf + ph, x, y);
+}
+
+static void prepareColumn(Map *map, u16 *bufCol1, u16 *bufCol2, u16 x, u16 y)
+{
     // 16 metatile = 32 tiles = 256 pixels (full screen height + 16 pixels)
     const u16 h = 16;
     // clip Y against plane size
@@ -421,12 +972,12 @@ static void setMapColumn(Map *map, u16 column, u16 x, u16 y)
         const u16 h1 = ph2 - yAdj;
 
         // prepare first part of column data
-        prepareMapDataColumn(map, buf + (yAdj * 2), buf + (yAdj * 2) + ph, x, y, h1);
+        prepareMapDataColumn(map, bufCol1 + (yAdj * 2), bufCol2 + (yAdj * 2), x, y, h1);
         // prepare second part of column data
-        prepareMapDataColumn(map, buf, buf + ph, x, y + h1, h - h1);
+        prepareMapDataColumn(map, bufCol1, bufCol2, x, y + h1, h - h1);
     }
     // no split needed
-    else prepareMapDataColumn(map, buf + (yAdj * 2), buf + (yAdj * 2) + ph, x, y, h);
+    else prepareMapDataColumn(map, bufCol1 + (yAdj * 2), bufCol2 + (yAdj * 2), x, y, h);
 }
 
 static void setMapRow(Map *map, u16 row, u16 x, u16 y)
@@ -452,25 +1003,45 @@ static void setMapRow(Map *map, u16 row, u16 x, u16 y)
     }
 #endif
 
-    // VRAM destination address
-    const u16 vramAddr = ((map->plane == BG_A)?VDP_BG_A:VDP_BG_B) + (row << (planeWidthSft + 2));
+    // update valid area: row y now valid for columns [x, x + 21[
+    {
+        const s16 lo = max(map->colLo, (s16) x);
+        const s16 hi = min(map->colHi, (s16) (x + 21));
 
-    // queue DMA (first row)
-    DMA_queueDmaFast(DMA_VRAM, buf, vramAddr + (pw * 0), pw, 2);
-    // queue DMA (second row)
-    DMA_queueDmaFast(DMA_VRAM, buf + pw, vramAddr + (pw * 2), pw, 2);
+        if ((lo < hi) && extendWindow(&map->rowLo, &map->rowHi, y, map->planeHeightMask + 1))
+        {
+            map->colLo = lo;
+            map->colHi = hi;
+        }
+        else
+        {
+            map->rowLo = y;
+            map->rowHi = y + 1;
+            map->colLo = x;
+            map->colHi = x + 21;
+        }
+    }
+
+    STAT_ADD(rows, 1);
+    STAT_ADD(totalRows, 1);
+
+    // VRAM destination address
+    const u16 vramAddr = ((map->plane == BG_A)?VDP_BG_A:VDP_BG_B) + (row << (planeWidthSft + 2));
+
+    // queue DMA (both rows are contiguous in VRAM so a single transfer is enough)
+    DMA_queueDmaFast(DMA_VRAM, buf, vramAddr, pw * 2, 2);
 
 #ifdef MAP_PROFIL
     u16 end = GET_VCOUNTER;
     KLog_S1("setMapRow - DMA queue operations duration=", end - start);
 #endif
 
-    // 21 metatile = 42 tiles = 336 pixels (full screen width + 16 pixels)
-    u16 w = 21;
-    // clip X against plane size
-    const u16 xAdj = x & map->planeWidthMask;
     // get plane width
     const u16 pw2 = map->planeWidthMask + 1;
+    // 21 metatile = 42 tiles = 336 pixels (full screen width + 16 pixels), clipped to plane width (32 tiles plane)
+    const u16 w = min(21, pw2);
+    // clip X against plane size
+    const u16 xAdj = x & map->planeWidthMask;
 
     // larger than plane width ? --> need to split
     if ((xAdj + w) > pw2)
@@ -488,11 +1059,24 @@ static void setMapRow(Map *map, u16 row, u16 x, u16 y)
 
 static void prepareMapDataColumn(Map *map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height)
 {
-#ifdef MAP_PROFIL
+#if defined(MAP_PROFIL) || (ENABLE_MAP_STATS != 0)
     u16 start = GET_VCOUNTER;
 #endif
 
     map->prepareMapDataColumnCB(map, bufCol1, bufCol2, xm, ym, height);
+    // apply metatile modifications
+    if (HAS_OVERLAY(map)) patchColumn(map, bufCol1, bufCol2, xm, ym, height);
+    // remap logical tiles to VRAM tile cache
+    if (map->tileCache)
+    {
+        TILECACHE_remapTilemap(map->tileCache, bufCol1, height * 2);
+        TILECACHE_remapTilemap(map->tileCache, bufCol2, height * 2);
+    }
+
+    STAT_ADD(tiles, height * 4);
+#if (ENABLE_MAP_STATS != 0)
+    STAT_ADD(time, getStatsTime(start));
+#endif
 
 #ifdef MAP_PROFIL
     u16 end = GET_VCOUNTER;
@@ -502,11 +1086,24 @@ static void prepareMapDataColumn(Map *map, u16 *bufCol1, u16 *bufCol2, u16 xm, u
 
 static void prepareMapDataRow(Map* map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width)
 {
-#ifdef MAP_PROFIL
+#if defined(MAP_PROFIL) || (ENABLE_MAP_STATS != 0)
     u16 start = GET_VCOUNTER;
 #endif
 
     map->prepareMapDataRowCB(map, bufRow1, bufRow2, xm, ym, width);
+    // apply metatile modifications
+    if (HAS_OVERLAY(map)) patchRow(map, bufRow1, bufRow2, xm, ym, width);
+    // remap logical tiles to VRAM tile cache
+    if (map->tileCache)
+    {
+        TILECACHE_remapTilemap(map->tileCache, bufRow1, width * 2);
+        TILECACHE_remapTilemap(map->tileCache, bufRow2, width * 2);
+    }
+
+    STAT_ADD(tiles, width * 4);
+#if (ENABLE_MAP_STATS != 0)
+    STAT_ADD(time, getStatsTime(start));
+#endif
 
 #ifdef MAP_PROFIL
     u16 end = GET_VCOUNTER;
@@ -1508,21 +2105,599 @@ static void prepareMapDataRowEx_MTI16_BI16(Map* map, u16 *bufRow1, u16 *bufRow2,
 }
 
 
+static void unpackPatchBlock(MapBlockCache* cache, u16 blockInd, u8* dst)
+{
+    const u16 size = cache->blockSize;
+    // header + full block or patch list (max patch list size is a full block)
+    u16* src = FAR_SAFE(cache->blockData[blockInd], size + 4);
+    const u16 base = *src;
+
+    // full block
+    if (base == 0xFFFF)
+    {
+        memcpy(dst, src + 1, size);
+        return;
+    }
+
+    // copy base block (always a full block)
+    memcpy(dst, (u16*) FAR_SAFE(cache->blockData[base], size + 2) + 1, size);
+
+    // base block can use another bank --> get patch data again
+    src = (u16*) FAR_SAFE(cache->blockData[blockInd], size + 4) + 1;
+    u16 num = *src++;
+
+    // 16 bit metatile index
+    if (size > (8 * 8))
+    {
+        u16* d = (u16*) dst;
+
+        while(num--)
+        {
+            const u16 off = *src++;
+            d[off] = *src++;
+        }
+    }
+    else
+    {
+        while(num--)
+        {
+            const u16 v = *src++;
+            dst[v >> 8] = v;
+        }
+    }
+}
+
+static void* getStreamBlock(Map* map, u16 blockGridIndex)
+{
+    MapBlockCache* cache = map->blockCache;
+    u16* ids = cache->ids;
+    u16* stamps = cache->stamps;
+    u16 blockInd;
+
+    // get block index
+    if (cache->wideIndex) blockInd = ((u16*) map->blockIndexes)[blockGridIndex];
+    else blockInd = ((u8*) map->blockIndexes)[blockGridIndex];
+
+    u16 stamp = ++cache->stamp;
+
+    // stamp wrapped --> reset all stamps
+    if (stamp == 0)
+    {
+        memsetU16(stamps, 0, cache->size);
+        stamp = cache->stamp = 1;
+    }
+
+    u16 i = cache->size;
+    u16 lru = 0;
+    u16 minStamp = 0xFFFF;
+
+    while(i--)
+    {
+        // already in cache ?
+        if (ids[i] == blockInd)
+        {
+            stamps[i] = stamp;
+            return cache->data + mulu(i, cache->blockSize);
+        }
+
+        // least recently used slot
+        if (stamps[i] < minStamp)
+        {
+            minStamp = stamps[i];
+            lru = i;
+        }
+    }
+
+    // not in cache --> unpack block in least recently used slot
+    const u16 size = cache->blockSize;
+    u8* dst = cache->data + mulu(lru, size);
+    u8* src = FAR_SAFE(cache->blockData[blockInd], size);
+
+    if (cache->patch) unpackPatchBlock(cache, blockInd, dst);
+    else if (cache->compression != COMPRESSION_NONE) unpack(cache->compression, src, dst);
+    else memcpy(dst, src, size);
+
+    ids[lru] = blockInd;
+    stamps[lru] = stamp;
+    cache->misses++;
+
+#ifdef MAP_DEBUG
+    KLog_U2("getStreamBlock - unpack block #", blockInd, " in slot ", lru);
+#endif
+
+    return dst;
+}
+
+static void prepareMapDataColumn_Stream(Map* map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height)
+{
+    // we can add both base index and base palette
+    const u16 baseAttr = map->baseTile;
+    // 16 bit for metatile index ?
+    const bool mti16 = map->blockCache->blockSize > (8 * 8);
+
+    u16 *d1 = bufCol1;
+    u16 *d2 = bufCol2;
+    // number of metatile to decode
+    u16 h = height;
+
+    // block X position
+    const u16 xb = (xm / 8) & map->wMask;
+    // block Y position
+    u16 yb = (ym / 8) & map->hMask;
+    // get first block data pointer
+    void* block = getStreamBlock(map, map->blockRowOffsets[yb] + xb);
+    // internal block fixed offset (will never change)
+    const u16 blockFixedOffset = xm & 7;
+    // start y position inside block
+    u16 yi = ym & 7;
+
+    u16* metaTiles = map->metaTiles;
+
+    // remain metatile ?
+    while(h--)
+    {
+        const u16 off = (yi * 8) + blockFixedOffset;
+        // get metatile index
+        const u16 metaTileInd = mti16?(((u16*) block)[off] & TILE_INDEX_MASK):((u8*) block)[off];
+        // get metatile pointeur
+        u16* metaTile = &metaTiles[2 * 2 * metaTileInd];
+
+        // copy tiles attribute
+        *d1++ = *metaTile++ + baseAttr;
+        *d2++ = *metaTile++ + baseAttr;
+        *d1++ = *metaTile++ + baseAttr;
+        *d2++ = *metaTile + baseAttr;
+
+        // next metatile
+        yi++;
+        // new block ?
+        if (yi == 8)
+        {
+            yi = 0;
+            // next row
+            yb = (yb + 1) & map->hMask;
+            // get block data pointer
+            block = getStreamBlock(map, map->blockRowOffsets[yb] + xb);
+        }
+    }
+}
+
+static void prepareMapDataRow_Stream(Map* map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width)
+{
+    // we can add both base index and base palette
+    const u16 baseAttr = map->baseTile;
+    // 16 bit for metatile index ?
+    const bool mti16 = map->blockCache->blockSize > (8 * 8);
+
+    u16 *d1 = bufRow1;
+    u16 *d2 = bufRow2;
+    // number of metatile to decode
+    u16 w = width;
+
+    // block X position
+    u16 xb = (xm / 8) & map->wMask;
+    // base block grid index
+    const u16 baseBlockGridIndex = map->blockRowOffsets[(ym / 8) & map->hMask];
+    // get first block data pointer
+    void* block = getStreamBlock(map, baseBlockGridIndex + xb);
+    // internal block fixed offset (will never change)
+    const u16 blockFixedOffset = (ym & 7) * 8;
+    // start x position inside block
+    u16 xi = xm & 7;
+
+    u16* metaTiles = map->metaTiles;
+
+    // remain metatile ?
+    while(w--)
+    {
+        const u16 off = blockFixedOffset + xi;
+        // get metatile index
+        const u16 metaTileInd = mti16?(((u16*) block)[off] & TILE_INDEX_MASK):((u8*) block)[off];
+        // get metatile pointeur
+        u16* metaTile = &metaTiles[2 * 2 * metaTileInd];
+
+        // copy tiles attribute
+        *d1++ = *metaTile++ + baseAttr;
+        *d1++ = *metaTile++ + baseAttr;
+        *d2++ = *metaTile++ + baseAttr;
+        *d2++ = *metaTile + baseAttr;
+
+        // next metatile
+        xi++;
+        // new block ?
+        if (xi == 8)
+        {
+            xi = 0;
+            // next column
+            xb = (xb + 1) & map->wMask;
+            // get block data pointer
+            block = getStreamBlock(map, baseBlockGridIndex + xb);
+        }
+    }
+}
+
+static u16 getMetaTile_Stream(Map* map, u16 x, u16 y)
+{
+    u16 xb = (x / 8) & map->wMask;
+    u16 yb = (y / 8) & map->hMask;
+    void* block = getStreamBlock(map, map->blockRowOffsets[yb] + xb);
+    u16 off = ((y & 7) * 8) + (x & 7);
+
+    if (map->blockCache->blockSize > (8 * 8)) return ((u16*) block)[off];
+    return ((u8*) block)[off];
+}
+
+static void getMetaTilemapRect_Stream(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest)
+{
+    u16* d = dest;
+    u16 yi = y;
+    u16 hi = h;
+
+    // simple version, cache hits make it fast enough
+    while(hi--)
+    {
+        u16 xi = x;
+        u16 wi = w;
+
+        while(wi--) *d++ = getMetaTile_Stream(map, xi++, yi);
+
+        yi++;
+    }
+}
+
+
+#if (ENABLE_MAP_STATS != 0)
+const MapStats* MAP_getStats()
+{
+    return &stats;
+}
+
+void MAP_resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+    statsFrame = vtimer;
+}
+
+void MAP_logStats()
+{
+    KLog_U4("MAP stats - frames=", stats.frames, " columns=", stats.totalColumns, " rows=", stats.totalRows, " last frame tiles=", stats.tiles);
+    KLog_U4("MAP stats - worst frame #", stats.peakFrame, " tiles=", stats.peakTiles, " columns=", stats.peakColumns, " rows=", stats.peakRows);
+    KLog_U3("MAP stats - worst frame time (scanlines)=", stats.peakTime, " at x=", stats.peakX, " y=", stats.peakY);
+}
+
+static void beginStatsFrame(Map* map, u32 x, u32 y)
+{
+    const u32 frame = vtimer;
+
+    // new frame ? --> update worst frame and reset per frame counters
+    if (frame != statsFrame)
+    {
+        if (stats.tiles)
+        {
+            stats.frames++;
+
+            if (stats.tiles > stats.peakTiles)
+            {
+                stats.peakTiles = stats.tiles;
+                stats.peakColumns = stats.columns;
+                stats.peakRows = stats.rows;
+                stats.peakFrame = statsFrame;
+                stats.peakX = statsX;
+                stats.peakY = statsY;
+            }
+            if (stats.time > stats.peakTime) stats.peakTime = stats.time;
+        }
+
+        stats.columns = 0;
+        stats.rows = 0;
+        stats.tiles = 0;
+        stats.time = 0;
+        statsFrame = frame;
+    }
+
+    statsX = x;
+    statsY = y;
+}
+
+static u16 getStatsTime(u16 start)
+{
+    const s16 delta = GET_VCOUNTER - start;
+
+    // V counter wrapped (new frame)
+    return (delta < 0)?(delta + 256):delta;
+}
+#endif  // ENABLE_MAP_STATS
+
+
+bool MAP_createOverlay(Map* map, u16 size)
+{
+    // keep hash table at most half full
+    const u16 len = getNextPow2(size) * 2;
+
+    MAP_releaseOverlay(map);
+
+    MapOverlay* overlay = MEM_alloc(sizeof(MapOverlay) + (len * sizeof(MapOverlayEntry)));
+
+    if (overlay == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("MAP_createOverlay(..) failed: not enough memory for overlay size ", size);
+#endif
+        return FALSE;
+    }
+
+    overlay->size = size;
+    overlay->mask = len - 1;
+    overlay->entries = (MapOverlayEntry*) (overlay + 1);
+    map->overlay = overlay;
+
+    MAP_clearOverlay(map);
+
+    return TRUE;
+}
+
+void MAP_release(Map* map)
+{
+    if (map == NULL) return;
+
+    // unpin far data
+    releaseFarData(map);
+    MAP_releaseOverlay(map);
+    MEM_free(map);
+}
+
+static u32 getBlocksSize(const MapDefinition* mapDef)
+{
+    return mapDef->numBlock * 64 * ((mapDef->numMetaTile > 256)?2:1);
+}
+
+static u32 getBlockIndexesSize(const MapDefinition* mapDef)
+{
+    return mulu(mapDef->w, mapDef->hp) * ((mapDef->numBlock > 256)?2:1);
+}
+
+static void releaseFarData(Map* map)
+{
+#if (ENABLE_BANK_SWITCH != 0)
+    const MapDefinition* mapDef = map->mapDef;
+
+    // unpacked data are in RAM so releasing them does nothing
+    FAR_RELEASE(map->metaTiles, mapDef->numMetaTile * 2 * 4);
+    if (map->blockCache) FAR_RELEASE(map->blockCache->blockData, mapDef->numBlock * 4);
+    else FAR_RELEASE(map->blocks, getBlocksSize(mapDef));
+    FAR_RELEASE(map->blockIndexes, getBlockIndexesSize(mapDef));
+    FAR_RELEASE(map->blockRowOffsets, mapDef->h * 2);
+#endif
+}
+
+void MAP_releaseOverlay(Map* map)
+{
+    if (map->overlay)
+    {
+        MEM_free(map->overlay);
+        map->overlay = NULL;
+    }
+}
+
+void MAP_clearOverlay(Map* map)
+{
+    MapOverlay* overlay = map->overlay;
+
+    if (overlay == NULL) return;
+
+    MapOverlayEntry* entry = overlay->entries;
+    u16 i = overlay->mask + 1;
+
+    while(i--)
+    {
+        entry->x = 0xFFFF;
+        entry++;
+    }
+
+    overlay->num = 0;
+}
+
+bool MAP_setMetaTile(Map* map, u16 x, u16 y, u16 value)
+{
+    MapOverlay* overlay = map->overlay;
+
+    if (overlay == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("MAP_setMetaTile(..) failed: overlay not allocated (see MAP_createOverlay(..))");
+#endif
+        return FALSE;
+    }
+
+    const u16 xm = x & MAP_MASK_X(map);
+    const u16 ym = y & MAP_MASK_Y(map);
+    MapOverlayEntry* entry = findOverlayEntry(overlay, xm, ym);
+
+    // new entry ?
+    if (entry->x == 0xFFFF)
+    {
+        if (overlay->num >= overlay->size)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("MAP_setMetaTile(..) failed: overlay is full, max = ", overlay->size);
+#endif
+            return FALSE;
+        }
+
+        entry->x = xm;
+        entry->y = ym;
+        overlay->num++;
+    }
+
+    entry->value = value;
+
+    // not yet displayed
+    if (map->planeWidthMask == 0) return TRUE;
+
+    // metatile currently in plane ? (plane area position can differ from map position because of map wrapping)
+    const u16 dx = (xm - map->colLo) & MAP_MASK_X(map);
+    const u16 dy = (ym - map->rowLo) & MAP_MASK_Y(map);
+
+    if ((dx < (u16) (map->colHi - map->colLo)) && (dy < (u16) (map->rowHi - map->rowLo)))
+    {
+        u16* buf = DMA_allocateTemp(2 * 2);
+
+        if (buf)
+        {
+            const u16 baseAttr = map->baseTile;
+            const u16* metaTile = &map->metaTiles[2 * 2 * (value & TILE_INDEX_MASK)];
+            // plane tile position
+            const u16 tx = ((map->colLo + dx) & map->planeWidthMask) * 2;
+            const u16 ty = ((map->rowLo + dy) & map->planeHeightMask) * 2;
+            const u16 vramAddr = ((map->plane == BG_A)?VDP_BG_A:VDP_BG_B) + (((ty << planeWidthSft) + tx) * 2);
+
+            buf[0] = metaTile[0] + baseAttr;
+            buf[1] = metaTile[1] + baseAttr;
+            buf[2] = metaTile[2] + baseAttr;
+            buf[3] = metaTile[3] + baseAttr;
+            // remap logical tiles to VRAM tile cache
+            if (map->tileCache) TILECACHE_remapTilemap(map->tileCache, buf, 4);
+
+            // queue DMA (first and second tile row)
+            DMA_queueDmaFast(DMA_VRAM, buf + 0, vramAddr, 2, 2);
+            DMA_queueDmaFast(DMA_VRAM, buf + 2, vramAddr + (planeWidth * 2), 2, 2);
+        }
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        else KLog("MAP_setMetaTile(..) failed to update plane: DMA temporary buffer is full");
+#endif
+    }
+
+    return TRUE;
+}
+
+// return entry for given (masked) position, or empty entry where it should be inserted
+void MAP_setTileCache(Map* map, TileCache* cache)
+{
+    map->tileCache = cache;
+}
+
+static MapOverlayEntry* findOverlayEntry(MapOverlay* overlay, u16 x, u16 y)
+{
+    const u16 mask = overlay->mask;
+    MapOverlayEntry* entries = overlay->entries;
+    u16 ind = (x ^ (y << 4) ^ (y >> 4)) & mask;
+
+    while(TRUE)
+    {
+        MapOverlayEntry* entry = &entries[ind];
+
+        if ((entry->x == 0xFFFF) || ((entry->x == x) && (entry->y == y))) return entry;
+        // linear probing
+        ind = (ind + 1) & mask;
+    }
+}
+
+static void patchColumn(Map* map, u16 *bufCol1, u16 *bufCol2, u16 xm, u16 ym, u16 height)
+{
+    const u16 baseAttr = map->baseTile;
+    const u16 maskY = MAP_MASK_Y(map);
+    const u16 x = xm & MAP_MASK_X(map);
+    const u16 y = ym & maskY;
+    MapOverlayEntry* entry = map->overlay->entries;
+    u16 i = map->overlay->mask + 1;
+
+    while(i--)
+    {
+        if (entry->x == x)
+        {
+            const u16 dy = (entry->y - y) & maskY;
+
+            if (dy < height)
+            {
+                const u16* metaTile = &map->metaTiles[2 * 2 * (entry->value & TILE_INDEX_MASK)];
+
+                bufCol1[(dy * 2) + 0] = metaTile[0] + baseAttr;
+                bufCol2[(dy * 2) + 0] = metaTile[1] + baseAttr;
+                bufCol1[(dy * 2) + 1] = metaTile[2] + baseAttr;
+                bufCol2[(dy * 2) + 1] = metaTile[3] + baseAttr;
+            }
+        }
+
+        entry++;
+    }
+}
+
+static void patchRow(Map* map, u16 *bufRow1, u16 *bufRow2, u16 xm, u16 ym, u16 width)
+{
+    const u16 baseAttr = map->baseTile;
+    const u16 maskX = MAP_MASK_X(map);
+    const u16 x = xm & maskX;
+    const u16 y = ym & MAP_MASK_Y(map);
+    MapOverlayEntry* entry = map->overlay->entries;
+    u16 i = map->overlay->mask + 1;
+
+    while(i--)
+    {
+        if ((entry->x != 0xFFFF) && (entry->y == y))
+        {
+            const u16 dx = (entry->x - x) & maskX;
+
+            if (dx < width)
+            {
+                const u16* metaTile = &map->metaTiles[2 * 2 * (entry->value & TILE_INDEX_MASK)];
+
+                bufRow1[(dx * 2) + 0] = metaTile[0] + baseAttr;
+                bufRow1[(dx * 2) + 1] = metaTile[1] + baseAttr;
+                bufRow2[(dx * 2) + 0] = metaTile[2] + baseAttr;
+                bufRow2[(dx * 2) + 1] = metaTile[3] + baseAttr;
+            }
+        }
+
+        entry++;
+    }
+}
+
+
 u16 MAP_getMetaTile(Map* map, u16 x, u16 y)
 {
+    if (HAS_OVERLAY(map))
+    {
+        MapOverlayEntry* entry = findOverlayEntry(map->overlay, x & MAP_MASK_X(map), y & MAP_MASK_Y(map));
+        if (entry->x != 0xFFFF) return entry->value;
+    }
+
     return map->getMetaTileCB(map, x, y);
 }
 
 u16 MAP_getTile(Map* map, u16 x, u16 y)
 {
-    u16 metaTileInd = map->getMetaTileCB(map, x / 2, y / 2) & TILE_INDEX_MASK;
+    u16 metaTileInd = MAP_getMetaTile(map, x / 2, y / 2) & TILE_INDEX_MASK;
     u16* metaTile = &map->metaTiles[2 * 2 * metaTileInd];
     return metaTile[((y & 1) * 2) + (x & 1)];
 }
 
 void MAP_getMetaTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, u16* dest)
 {
-    return map->getMetaTilemapRectCB(map, x, y, w, h, dest);
+    map->getMetaTilemapRectCB(map, x, y, w, h, dest);
+
+    // apply metatile modifications
+    if (HAS_OVERLAY(map))
+    {
+        const u16 maskX = MAP_MASK_X(map);
+        const u16 maskY = MAP_MASK_Y(map);
+        const u16 xm = x & maskX;
+        const u16 ym = y & maskY;
+        MapOverlayEntry* entry = map->overlay->entries;
+        u16 i = map->overlay->mask + 1;
+
+        while(i--)
+        {
+            if (entry->x != 0xFFFF)
+            {
+                const u16 dx = (entry->x - xm) & maskX;
+                const u16 dy = (entry->y - ym) & maskY;
+
+                if ((dx < w) && (dy < h)) dest[(dy * w) + dx] = entry->value;
+            }
+
+            entry++;
+        }
+    }
 }
 
 void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16* dest)
@@ -1538,8 +2713,8 @@ void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16*
 
         // secondary destination
         u16 *d2 = dest + (h * 2);
-        // get map col update function pointer
-        void (*updateCol)(Map *map, u16 *d1, u16 *d2, u16 xm, u16 ym, u16 h) = map->prepareMapDataColumnCB;
+        // get map col update function pointer (wrapper if we need to apply metatile modifications)
+        void (*updateCol)(Map *map, u16 *d1, u16 *d2, u16 xm, u16 ym, u16 h) = HAS_OVERLAY(map)?&prepareMapDataColumn:map->prepareMapDataColumnCB;
 
         while(wi--)
         {
@@ -1559,8 +2734,8 @@ void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16*
 
         // secondary destination
         u16 *d2 = dest + (w * 2);
-        // get map row update function pointer
-        void (*updateRow)(Map *map, u16 *d1, u16 *d2, u16 xm, u16 ym, u16 h) = map->prepareMapDataRowCB;
+        // get map row update function pointer (wrapper if we need to apply metatile modifications)
+        void (*updateRow)(Map *map, u16 *d1, u16 *d2, u16 xm, u16 ym, u16 h) = HAS_OVERLAY(map)?&prepareMapDataRow:map->prepareMapDataRowCB;
 
         while(hi--)
         {
@@ -1575,6 +2750,136 @@ void MAP_getTilemapRect(Map* map, u16 x, u16 y, u16 w, u16 h, bool column, u16*
 }
 
 
+void MAP_setMetaTileAttributes(Map* map, const u8* attributes)
+{
+    map->metaTileAttr = attributes;
+}
+
+// metatile index at given metatile position (direct access for MTI8_BI8 layout)
+static inline u16 getMetaTileIndex(Map* map, u16 x, u16 y, bool direct)
+{
+    if (direct)
+    {
+        const u8* block = &((u8*) map->blocks)[8 * 8 * ((u8*) map->blockIndexes)[map->blockRowOffsets[(y / 8) & map->hMask] + ((x / 8) & map->wMask)]];
+        return block[((y & 7) * 8) + (x & 7)];
+    }
+
+    return MAP_getMetaTile(map, x, y) & TILE_INDEX_MASK;
+}
+
+u8 MAP_getMetaTileAttribute(Map* map, u16 x, u16 y)
+{
+    return map->metaTileAttr[getMetaTileIndex(map, x, y, (map->getMetaTileCB == &getMetaTile_MTI8_BI8) && !HAS_OVERLAY(map))];
+}
+
+void MAP_getPointsAttribute(Map* map, const Vect2D_u16* points, u16 num, u8* dest)
+{
+    const u8* attr = map->metaTileAttr;
+    const Vect2D_u16* p = points;
+    u8* d = dest;
+    u16 i = num;
+
+    if ((map->getMetaTileCB == &getMetaTile_MTI8_BI8) && !HAS_OVERLAY(map))
+    {
+        while(i--)
+        {
+            *d++ = attr[getMetaTileIndex(map, p->x >> 4, p->y >> 4, TRUE)];
+            p++;
+        }
+    }
+    else
+    {
+        while(i--)
+        {
+            *d++ = attr[getMetaTileIndex(map, p->x >> 4, p->y >> 4, FALSE)];
+            p++;
+        }
+    }
+}
+
+u32 MAP_testPoints(Map* map, const Vect2D_u16* points, u16 num, u8 mask)
+{
+    const u8* attr = map->metaTileAttr;
+    const bool direct = (map->getMetaTileCB == &getMetaTile_MTI8_BI8) && !HAS_OVERLAY(map);
+    const Vect2D_u16* p = points;
+    u32 result = 0;
+    u32 bit = 1;
+    u16 i = min(num, 32);
+
+    while(i--)
+    {
+        if (attr[getMetaTileIndex(map, p->x >> 4, p->y >> 4, direct)] & mask) result |= bit;
+        bit <<= 1;
+        p++;
+    }
+
+    return result;
+}
+
+u32 MAP_testRect(Map* map, u16 x, u16 y, u16 w, u16 h, u8 mask)
+{
+    const u8* attr = map->metaTileAttr;
+    u32 result = 0;
+    u32 bit = 1;
+
+    // direct access path, walk blocks
+    if ((map->getMetaTileCB == &getMetaTile_MTI8_BI8) && !HAS_OVERLAY(map))
+    {
+        u8* blockIndexes = map->blockIndexes;
+        u8* blocks = map->blocks;
+        u16 yi = y;
+        u16 hi = h;
+
+        while(hi--)
+        {
+            const u16 rowOffset = map->blockRowOffsets[(yi / 8) & map->hMask];
+            const u16 yOffset = (yi & 7) * 8;
+            u16 xb = (x / 8) & map->wMask;
+            u16 xi = x & 7;
+            u8* block = &blocks[8 * 8 * blockIndexes[rowOffset + xb]] + yOffset;
+            u16 wi = w;
+
+            while(wi--)
+            {
+                if (attr[block[xi]] & mask) result |= bit;
+                bit <<= 1;
+
+                // new block ?
+                if (++xi == 8)
+                {
+                    xi = 0;
+                    xb = (xb + 1) & map->wMask;
+                    block = &blocks[8 * 8 * blockIndexes[rowOffset + xb]] + yOffset;
+                }
+            }
+
+            yi++;
+        }
+    }
+    else
+    {
+        u16 yi = y;
+        u16 hi = h;
+
+        while(hi--)
+        {
+            u16 xi = x;
+            u16 wi = w;
+
+            while(wi--)
+            {
+                if (attr[MAP_getMetaTile(map, xi++, yi) & TILE_INDEX_MASK] & mask) result |= bit;
+                bit <<= 1;
+            }
+
+            yi++;
+        }
+    }
+
+    return result;
+}
+
+
 static u16 getMetaTile_MTI8_BI8(Map* map, u16 x, u16 y)
 {
     u8* blockIndexes = map->blockIndexes;
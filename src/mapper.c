@@ -5,6 +5,7 @@
 #include "sprite_eng.h"
 #include "bmp.h"
 
+#include "memory.h"
 #include "tools.h"
 
 #include "mapper.h"
@@ -12,9 +13,54 @@
 
 #define NUM_BANK        8
 
+// first region used as bank window for FAR data access
+#define FIRST_REGION    BANK_SWITCH_FIRST_REGION
+// start address of FAR data area
+#define FAR_START       (FIRST_REGION * BANK_SIZE)
+
 
 static u16 banks[NUM_BANK] = {0, 1, 2, 3, 4, 5, 6, 7};
-static u16 reg = 0;
+// bank window cache (only FIRST_REGION to 7 entries are used)
+static u16 refCounts[NUM_BANK];
+static u16 vblankRefs[NUM_BANK];
+static u16 lastUses[NUM_BANK];
+static u16 useStamp;
+// reserved regions (bit mask), not used by FAR data access
+static u16 locked = 0;
+// bank switch statistics
+static u16 frameSwitch;
+static u16 lastFrameSwitch;
+static u32 totalSwitch;
+
+
+// called at library init
+void BANK_init()
+{
+    // back to default mapping
+    for(u16 i = 1; i < NUM_BANK; i++) SYS_setBank(i, i);
+
+    memsetU16(refCounts, 0, NUM_BANK);
+    memsetU16(vblankRefs, 0, NUM_BANK);
+    memsetU16(lastUses, 0, NUM_BANK);
+    useStamp = 0;
+    locked = 0;
+    frameSwitch = 0;
+    lastFrameSwitch = 0;
+    totalSwitch = 0;
+}
+
+// called from SYS_doVBlankProcess() once DMA queue has been flushed
+void BANK_doVBlankProcess()
+{
+    for(u16 i = FIRST_REGION; i < NUM_BANK; i++)
+    {
+        refCounts[i] -= vblankRefs[i];
+        vblankRefs[i] = 0;
+    }
+
+    lastFrameSwitch = frameSwitch;
+    frameSwitch = 0;
+}
 
 
 u16 SYS_getBank(u16 regionIndex)
@@ -22,6 +68,15 @@ u16 SYS_getBank(u16 regionIndex)
     return banks[regionIndex];
 }
 
+void SYS_lockBank(u16 regionIndex, bool lock)
+{
+    if ((regionIndex >= FIRST_REGION) && (regionIndex < NUM_BANK))
+    {
+        if (lock) locked |= 1 << regionIndex;
+        else locked &= ~(1 << regionIndex);
+    }
+}
+
 void SYS_setBank(u16 regionIndex, u16 bankIndex)
 {
     // check we are in valid region (region 0 is not switchable)
@@ -32,6 +87,9 @@ void SYS_setBank(u16 regionIndex, u16 bankIndex)
         // store it so we can read it later
         banks[regionIndex] = bankIndex;
 
+        frameSwitch++;
+        totalSwitch++;
+
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
         KLog_U2("Region #", regionIndex, " set to bank ", bankIndex);
 #endif
@@ -42,111 +100,162 @@ void SYS_setBank(u16 regionIndex, u16 bankIndex)
 #endif
 }
 
+u16 SYS_getBankSwitchCount()
+{
+    return lastFrameSwitch;
+}
+
+u32 SYS_getBankSwitchTotal()
+{
+    return totalSwitch;
+}
+
 
 static bool needBankSwitch(u32 addr)
 {
-    const u16 mask = (addr >> 16) & 0xFFF0;
-    return (mask >= 0x0030) && (mask < 0xE0E0);
+    return (addr >= FAR_START) && (addr < 0xE0E00000);
 }
 
-static u32 setBank(u32 addr)
+// region can be remapped ?
+static bool isFree(u16 region)
 {
-    // get 512 KB bank index
-    const u16 bankIndex = (addr >> 19) & 0x3F;
+    return !(refCounts[region] || (locked & (1 << region)));
+}
 
-    // check if bank is already set ?
-    if (banks[6] == bankIndex)
+static void touch(u16 region)
+{
+    lastUses[region] = ++useStamp;
+}
+
+// returns region mapping the given bank (remap the least recently used region if needed), -1 if all regions are pinned
+static s16 getRegion(u16 bankIndex)
+{
+    s16 best = -1;
+    u16 bestAge = 0;
+
+    for(u16 i = FIRST_REGION; i < NUM_BANK; i++)
     {
-        reg = 1;
-        return 0x300000;
+        // already mapped
+        if (banks[i] == bankIndex)
+        {
+            touch(i);
+            return i;
+        }
+
+        if (isFree(i))
+        {
+            const u16 age = useStamp - lastUses[i];
+
+            if ((best == -1) || (age >= bestAge))
+            {
+                best = i;
+                bestAge = age;
+            }
+        }
     }
-    if (banks[7] == bankIndex)
+
+    if (best != -1)
     {
-        reg = 0;
-        return 0x380000;
+        SYS_setBank(best, bankIndex);
+        touch(best);
     }
 
-    if (reg)    // use region 7
-    {
-        // set bank
-        SYS_setBank(7, bankIndex);
-        // next time we will use other region
-        reg = 0;
+    return best;
+}
 
-        // return bank address
-        return 0x380000;
-    }
-    else        // use region 6
+// returns first of 2 consecutive regions mapping the given bank and the next one, -1 if not possible
+static s16 getRegions(u16 bankIndex)
+{
+    s16 best = -1;
+    u16 bestAge = 0;
+
+    for(u16 i = FIRST_REGION; i < (NUM_BANK - 1); i++)
     {
-        // set bank
-        SYS_setBank(6, bankIndex);
-        // next time we will use other region
-        reg = 1;
+        const bool set0 = (banks[i + 0] == bankIndex + 0);
+        const bool set1 = (banks[i + 1] == bankIndex + 1);
+
+        // already mapped
+        if (set0 && set1)
+        {
+            best = i;
+            break;
+        }
+
+        if ((set0 || isFree(i + 0)) && (set1 || isFree(i + 1)))
+        {
+            // age of the most recently used region of the pair
+            const u16 age = min((u16) (useStamp - lastUses[i + 0]), (u16) (useStamp - lastUses[i + 1]));
+
+            if ((best == -1) || (age >= bestAge))
+            {
+                best = i;
+                bestAge = age;
+            }
+        }
+    }
 
-        // return bank address
-        return 0x300000;
+    if (best != -1)
+    {
+        if (banks[best + 0] != bankIndex + 0) SYS_setBank(best + 0, bankIndex + 0);
+        if (banks[best + 1] != bankIndex + 1) SYS_setBank(best + 1, bankIndex + 1);
+        touch(best + 0);
+        touch(best + 1);
     }
+
+    return best;
 }
 
-static u32 setBankEx(u32 addr, bool high)
+// returns mapped address of given far data block (can cross 1 bank), 0 if it can't be mapped
+static u32 mapData(u32 addr, bool crossing)
 {
     // get 512 KB bank index
     const u16 bankIndex = (addr >> 19) & 0x3F;
-    const u16 bank = high?1:0;
+    s16 region;
 
-    // check if bank is already set ?
-    if (banks[6 + bank] == bankIndex)
+    if (crossing)
     {
-        reg = 1 - bank;
-        return high?0x380000:0x300000;
+        // special case of data starting just before FAR area (direct access) ?
+        if (bankIndex == (FIRST_REGION - 1))
+        {
+            // first region should map its default bank
+            if ((banks[FIRST_REGION] != FIRST_REGION) && !isFree(FIRST_REGION)) region = -1;
+            else
+            {
+                if (banks[FIRST_REGION] != FIRST_REGION) SYS_setBank(FIRST_REGION, FIRST_REGION);
+                touch(FIRST_REGION);
+                // direct address
+                return addr;
+            }
+        }
+        else region = getRegions(bankIndex);
     }
+    else region = getRegion(bankIndex);
 
-    if (high)    // use region 7
-    {
-        // set bank
-        SYS_setBank(7, bankIndex);
-        // next time we will use other region
-        reg = 0;
-        // bank 6 point on same bank ? --> force reset so we will stay on bank 7 for this region
-        if (banks[6] == bankIndex) banks[6] = 0;
-
-        // return bank address
-        return 0x380000;
-    }
-    else        // use region 6
+    if (region == -1)
     {
-        // set bank
-        SYS_setBank(6, bankIndex);
-        // next time we will use other region
-        reg = 1;
-        // bank 7 point on same bank ? --> force reset so we will stay on bank 6 for this region
-        if (banks[7] == bankIndex) banks[7] = 0;
-
-        // return bank address
-        return 0x300000;
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("Error: cannot map far data, all bank regions are in use, bank = ", bankIndex, " crossing = ", crossing);
+#endif
+        return 0;
     }
+
+    return (region * BANK_SIZE) + (addr & BANK_IN_MASK);
 }
 
-static u32 setBanks(u32 addr)
+// change pin counter of regions used by the given mapped data
+static void pinData(u32 mappedAddr, u32 size, s16 inc)
 {
-    // get 512 KB bank index
-    const u16 bankIndex = (addr >> 19) & 0x3F;
+    u16 region = mappedAddr >> 19;
+    const u16 last = (mappedAddr + (size - 1)) >> 19;
+
+    // start with first region of FAR area
+    if (region < FIRST_REGION) region = FIRST_REGION;
 
-    // special case of 0x28xxxx-0x3xxxxx range ?
-    if (bankIndex == 5)
+    while(region <= last)
     {
-        // only set second bank
-        SYS_setBank(6, 6);
-        // return bank address
-        return 0x280000;
+        refCounts[region] += inc;
+        region++;
     }
-
-    // set the 2 banks as we have data crossing banks
-    SYS_setBank(6, bankIndex + 0);
-    SYS_setBank(7, bankIndex + 1);
-
-    // return bank address
-    return 0x300000;
 }
 
 void* SYS_getFarData(void* data)
@@ -158,7 +267,7 @@ void* SYS_getFarData(void* data)
     if (!needBankSwitch(addr)) return data;
 
     // set bank and get mapped address
-    const u32 mappedAddr = setBank(addr) + (addr & BANK_IN_MASK);
+    const u32 mappedAddr = mapData(addr, FALSE);
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
     kprintf("Data at %8lX accessed through bank switch from %8lX", addr, mappedAddr);
@@ -176,8 +285,19 @@ void* SYS_getFarDataEx(void* data, bool high)
     // don't require bank switch --> return direct pointer
     if (!needBankSwitch(addr)) return data;
 
-    // set bank and get mapped address
-    const u32 mappedAddr = setBankEx(addr, high) + (addr & BANK_IN_MASK);
+    const u16 region = high?7:6;
+    // get 512 KB bank index
+    const u16 bankIndex = (addr >> 19) & 0x3F;
+    u32 mappedAddr;
+
+    // requested region is pinned / reserved --> let the cache choose one
+    if ((banks[region] != bankIndex) && !isFree(region)) mappedAddr = mapData(addr, FALSE);
+    else
+    {
+        if (banks[region] != bankIndex) SYS_setBank(region, bankIndex);
+        touch(region);
+        mappedAddr = (region * BANK_SIZE) + (addr & BANK_IN_MASK);
+    }
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
     kprintf("Data at %8lX accessed through bank switch from %8lX", addr, mappedAddr);
@@ -213,7 +333,7 @@ void* SYS_getFarDataSafe(void* data, u32 size)
         if (!needBankSwitch(end)) return data;
 
         // set bank and get mapped address
-        const u32 mappedAddr = setBanks(start) + (start & BANK_IN_MASK);
+        const u32 mappedAddr = mapData(start, TRUE);
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
         kprintf("Data at %8lX:%8lX accessed through bank switch from %8lX", start, end, mappedAddr);
@@ -239,7 +359,7 @@ void* SYS_getFarDataSafeEx(void* data, u32 size, bool high)
         if (!needBankSwitch(end)) return data;
 
         // set bank and get mapped address
-        const u32 mappedAddr = setBanks(start) + (start & BANK_IN_MASK);
+        const u32 mappedAddr = mapData(start, TRUE);
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
         kprintf("Data at %8lX:%8lX accessed through bank switch from %8lX", start, end, mappedAddr);
@@ -252,3 +372,84 @@ void* SYS_getFarDataSafeEx(void* data, u32 size, bool high)
     // use the simpler method
     return SYS_getFarDataEx(data, high);
 }
+
+void* SYS_acquireFarData(void* data, u32 size)
+{
+    const u32 start = (u32) data;
+    const u32 end = start + (size - 1);
+
+    // don't require bank switch (better to test on end address) --> return direct pointer
+    if (!needBankSwitch(end)) return data;
+
+    // get mapped address
+    const u32 mappedAddr = mapData(start, isCrossingBank(start, end));
+
+    // pin used region(s) so they can't be remapped until released
+    if (mappedAddr) pinData(mappedAddr, size, 1);
+
+    return (void*) mappedAddr;
+}
+
+void SYS_releaseFarData(void* data, u32 size)
+{
+    const u32 addr = (u32) data;
+
+    // not mapped through bank region
+    if (!needBankSwitch(addr + (size - 1))) return;
+
+    pinData(addr, size, -1);
+}
+
+bool SYS_mapBankGroup(const BankGroup* group)
+{
+    const void* const * bank = group->banks;
+    u16 used = 0;
+    u16 i = group->numBank;
+    bool result = TRUE;
+
+    while(i--)
+    {
+        const u32 addr = (u32) *bank++;
+
+        // direct access
+        if (!needBankSwitch(addr)) continue;
+
+        const s16 region = getRegion((addr >> 19) & 0x3F);
+
+        if (region == -1)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+            KLog_U1("Warning: SYS_mapBankGroup(..) cannot map all banks of group, all regions are in use, bank = ", (addr >> 19) & 0x3F);
+#endif
+            result = FALSE;
+            break;
+        }
+
+        // temporary pin so next banks of the group can't remap it
+        if (!(used & (1 << region))) refCounts[region]++;
+        used |= 1 << region;
+    }
+
+    // release temporary pins
+    for(i = FIRST_REGION; i < NUM_BANK; i++)
+        if (used & (1 << i)) refCounts[i]--;
+
+    return result;
+}
+
+void SYS_releaseFarDataOnVBlank(void* data, u32 size)
+{
+    const u32 addr = (u32) data;
+
+    // not mapped through bank region
+    if (!needBankSwitch(addr + (size - 1))) return;
+
+    u16 region = addr >> 19;
+    const u16 last = (addr + (size - 1)) >> 19;
+
+    // start with first region of FAR area
+    if (region < FIRST_REGION) region = FIRST_REGION;
+
+    // real release done from SYS_doVBlankProcess() (after DMA queue flush)
+    while(region <= last) vblankRefs[region++]++;
+}
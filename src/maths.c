@@ -7,6 +7,25 @@
 #include "vdp.h"
 
 
+// atan(i / 64) for i = 0..64, in 1/16 of angle unit (1024 units per turn)
+static const u16 atantab[65] =
+{
+       0,   41,   81,  122,  163,  203,  244,  284,
+     324,  364,  404,  444,  483,  523,  562,  600,
+     639,  677,  715,  753,  790,  827,  863,  900,
+     936,  971, 1006, 1041, 1075, 1109, 1143, 1176,
+    1209, 1241, 1273, 1305, 1336, 1367, 1397, 1427,
+    1457, 1486, 1514, 1543, 1571, 1598, 1625, 1652,
+    1678, 1704, 1729, 1754, 1779, 1804, 1828, 1851,
+    1874, 1897, 1920, 1942, 1964, 1985, 2007, 2027,
+    2048
+};
+
+
+static u16 getAtan2(s32 y, s32 x);
+static u16 getAtanRatio(u16 n, u16 d);
+
+
 u32 mulu(u16 op1, u16 op2)
 {
     return op1 * op2;
@@ -293,4 +312,93 @@ u32 getNextPow2(u32 value)
     result |= result >> 16;
 
     return result + 1;
-}
\ No newline at end of file
+}
+
+
+u16 getSqrtInt(u32 value)
+{
+    u32 v = value;
+    u32 res = 0;
+    u32 bit = 1UL << 30;
+
+    while(bit > v) bit >>= 2;
+
+    // bit by bit (2 bits of value per result bit)
+    while(bit)
+    {
+        const u32 t = res + bit;
+
+        res >>= 1;
+        if (v >= t)
+        {
+            v -= t;
+            res += bit;
+        }
+
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+fix16 fix16Dist(fix16 dx, fix16 dy)
+{
+    // square has 12 bits of fractional part so its sqrt has 6 (fix16)
+    return getSqrtInt((u32) muls(dx, dx) + (u32) muls(dy, dy));
+}
+
+fix16 fix16ApproxDist(fix16 dx, fix16 dy)
+{
+    // same scale for input and output
+    return getApproximatedDistance(dx, dy);
+}
+
+u16 fix16Atan2(fix16 y, fix16 x)
+{
+    return getAtan2(y, x);
+}
+
+u16 fix32Atan2(fix32 y, fix32 x)
+{
+    return getAtan2(y, x);
+}
+
+
+static u16 getAtan2(s32 y, s32 x)
+{
+    u32 ax = abs(x);
+    u32 ay = abs(y);
+    u16 a;
+
+    if (!(ax | ay)) return 0;
+
+    // ratio is computed with a 32/16 division so keep values 16 bits
+    while((ax | ay) > 0xFFFF)
+    {
+        ax >>= 1;
+        ay >>= 1;
+    }
+
+    // first octant then mirror
+    if (ay <= ax) a = getAtanRatio(ay, ax);
+    else a = 256 - getAtanRatio(ax, ay);
+
+    if (x < 0) a = 512 - a;
+    if (y < 0) a = 1024 - a;
+
+    return a & 1023;
+}
+
+// returns atan(n / d) with n <= d, d != 0
+static u16 getAtanRatio(u16 n, u16 d)
+{
+    // 6 bits table index + 4 bits interpolation
+    const u16 r = divu((u32) n << 10, d);
+    const u16 i = r >> 4;
+    const u16 f = r & 15;
+    u16 v = atantab[i];
+
+    if (f) v += ((atantab[i + 1] - v) * f) >> 4;
+
+    return (v + 8) >> 4;
+}
@@ -5,10 +5,21 @@
 #include "maths3D.h"
 
 #include "bmp.h"
+#include "bmp_span.h"
+#include "memory.h"
 
 
 Context3D context3D;
 
+// vertex cache stamp for M3D_renderMesh(..)
+static u16 meshStamp = 0;
+
+
+static s32 getPlaneDist(const V3f16* v, u16 plane);
+static void getIntersection(const V3f16* p0, const V3f16* p1, s32 d0, s32 d1, V3f16* dest);
+static u16 clipPlane(const V3f16* src, u16 num, V3f16* dest, u16 plane);
+static u16 clipPolygon(const V3f16* src, u16 num, V3f16* dest, u16 code);
+
 
 void M3D_reset()
 {
@@ -18,6 +29,8 @@ void M3D_reset()
     M3D_setViewport(BMP_WIDTH, BMP_HEIGHT);
     // default camera distance
     context3D.camDist = FIX16(20);
+    // default near clip plane
+    context3D.nearZ = FIX16(1);
 
     context3D.light.x = FIX16(1);
     context3D.light.y = FIX16(0);
@@ -47,6 +60,16 @@ void M3D_setCamDistance(fix16 value)
     context3D.camDist = value;
 }
 
+void M3D_setNearClip(fix16 value)
+{
+    context3D.nearZ = value;
+}
+
+fix16 M3D_getNearClip()
+{
+    return context3D.nearZ;
+}
+
 void M3D_setLightXYZ(fix16 x, fix16 y, fix16 z)
 {
     context3D.light.x = x;
@@ -375,6 +398,291 @@ void M3D_rotateInv(Transformation3D* t, const V3f16* src, V3f16* dest)
     dest->z = ((sx * t->matInv.c.x) + (sy * t->matInv.c.y) + (sz * t->matInv.c.z)) >> FIX16_FRAC_BITS;
 }
 
+u16 M3D_getClipCode(const V3f16* v)
+{
+    const s16 zi = context3D.camDist + v->z;
+    // projected offset is (camDist * x) / (4 * zi), see M3D_project_s16(..)
+    const s32 px = (s32) context3D.camDist * v->x;
+    const s32 py = (s32) context3D.camDist * v->y;
+    const s32 w = (s32) (context3D.viewport.x << 1) * zi;
+    const s32 h = (s32) (context3D.viewport.y << 1) * zi;
+    u16 res = 0;
+
+    if (zi < context3D.nearZ) res |= M3D_CLIP_NEAR;
+    if (px < -w) res |= M3D_CLIP_LEFT;
+    else if (px > w) res |= M3D_CLIP_RIGHT;
+    if (py > h) res |= M3D_CLIP_TOP;
+    else if (py < -h) res |= M3D_CLIP_BOTTOM;
+
+    return res;
+}
+
+u16 M3D_clipPolygon(const V3f16* src, u16 num, V3f16* dest)
+{
+    u16 codeOr = 0;
+    u16 codeAnd = 0xFFFF;
+
+    if ((num < 3) || (num > M3D_CLIP_MAXVERTEX)) return 0;
+
+    for(u16 i = 0; i < num; i++)
+    {
+        const u16 code = M3D_getClipCode(&src[i]);
+
+        codeOr |= code;
+        codeAnd &= code;
+    }
+
+    // all vertices outside the same plane
+    if (codeAnd) return 0;
+
+    return clipPolygon(src, num, dest, codeOr);
+}
+
+u16 M3D_renderMesh(Transformation3D* t, const Mesh3D* mesh, MeshVertex3D* cache, u16 col)
+{
+    V2s16 v[M3D_CLIP_MAXVERTEX + 5];
+    V3f16 poly[M3D_CLIP_MAXVERTEX];
+    V3f16 clipped[M3D_CLIP_MAXVERTEX + 5];
+    const u16 vpf = mesh->vertPerFace;
+    const u16* ind = mesh->indexes;
+    const V3f16* norm = mesh->normals;
+    const bool light = context3D.lightEnabled && (norm != NULL);
+    u16 res = 0;
+
+    if (vpf > M3D_CLIP_MAXVERTEX) return 0;
+    if (t->rebuildMat) M3D_buildMat3D(t);
+
+    // new stamp invalidates all cache entries (clear cache on wrap)
+    if (++meshStamp == 0)
+    {
+        memset(cache, 0, mesh->numVertex * sizeof(MeshVertex3D));
+        meshStamp = 1;
+    }
+
+    const u16 stamp = meshStamp;
+    const M3f16* mat = &t->mat;
+    const Translation3D* trans = t->translation;
+    const s16 cx = context3D.viewport.x >> 1;
+    const s16 cy = context3D.viewport.y >> 1;
+    const fix16 camDist = context3D.camDist;
+    // camDist << (6 + 4), see M3D_project_s16(..)
+    const s32 camScale = ((s32) camDist) << 10;
+
+    for(u16 f = 0; f < mesh->numFace; f++)
+    {
+        s32 depth = 0;
+        u16 codeOr = 0;
+        u16 codeAnd = 0xFFFF;
+        u16 num = vpf;
+
+        for(u16 i = 0; i < vpf; i++)
+        {
+            const u16 vi = *ind++;
+            MeshVertex3D* c = &cache[vi];
+
+            // not yet transformed in this render ?
+            if (c->stamp != stamp)
+            {
+                const V3f16* s = &mesh->vertices[vi];
+                const fix16 sx = s->x;
+                const fix16 sy = s->y;
+                const fix16 sz = s->z;
+
+                const fix16 x = ((sx * mat->a.x) + (sy * mat->a.y) + (sz * mat->a.z)) >> FIX16_FRAC_BITS;
+                const fix16 y = ((sx * mat->b.x) + (sy * mat->b.y) + (sz * mat->b.z)) >> FIX16_FRAC_BITS;
+                const fix16 z = ((sx * mat->c.x) + (sy * mat->c.y) + (sz * mat->c.z)) >> FIX16_FRAC_BITS;
+                const fix16 tx = x + trans->x;
+                const fix16 ty = y + trans->y;
+                const fix16 tz = z + trans->z;
+                const s16 zi = camDist + tz;
+
+                c->pos.x = tx;
+                c->pos.y = ty;
+                c->pos.z = tz;
+                c->clip = M3D_getClipCode(&c->pos);
+
+                // not closer than near plane --> safe to project
+                if (!(c->clip & M3D_CLIP_NEAR))
+                {
+                    const s16 scale = divs(camScale, zi);
+
+                    c->pt.x = cx + (((s32) scale * tx) >> 12);
+                    c->pt.y = cy - (((s32) scale * ty) >> 12);
+                }
+                else
+                {
+                    c->pt.x = cx;
+                    c->pt.y = cy;
+                }
+
+                c->stamp = stamp;
+            }
+
+            v[i] = c->pt;
+            poly[i] = c->pos;
+            depth += c->pos.z;
+            codeOr |= c->clip;
+            codeAnd &= c->clip;
+        }
+
+        // totally outside view frustum ?
+        if (codeAnd)
+        {
+            if (norm) norm++;
+            continue;
+        }
+        // crossing view frustum --> clip then project
+        if (codeOr)
+        {
+            num = clipPolygon(poly, vpf, clipped, codeOr);
+
+            if (num < 3)
+            {
+                if (norm) norm++;
+                continue;
+            }
+
+            M3D_project_s16(clipped, v, num);
+        }
+
+        // back faced ?
+        if (BMP_isPolygonCulled(v, num))
+        {
+            if (norm) norm++;
+            continue;
+        }
+
+        u16 c = col;
+
+        // lighting for visible face only
+        if (light)
+        {
+            const fix16 dp = fix16Mul(t->lightInv.x, norm->x) + fix16Mul(t->lightInv.y, norm->y) + fix16Mul(t->lightInv.z, norm->z);
+
+            if (dp > 0) c += dp >> (FIX16_FRAC_BITS - 2);
+        }
+        if (norm) norm++;
+
+        c &= 0x0F;
+        // depth = mean Z
+        if (!SPAN_addPolygon(v, num, (c << 4) | c, divs(depth, vpf))) break;
+
+        res++;
+    }
+
+    return res;
+}
+
+
+// signed distance of transformed vertex to frustum plane (M3D_CLIP_XXX bit index), vertex is inside if >= 0
+static s32 getPlaneDist(const V3f16* v, u16 plane)
+{
+    const s16 zi = context3D.camDist + v->z;
+
+    switch(plane)
+    {
+        default:
+            return zi - context3D.nearZ;
+
+        case 1:
+            return ((s32) (context3D.viewport.x << 1) * zi) + ((s32) context3D.camDist * v->x);
+
+        case 2:
+            return ((s32) (context3D.viewport.x << 1) * zi) - ((s32) context3D.camDist * v->x);
+
+        case 3:
+            return ((s32) (context3D.viewport.y << 1) * zi) - ((s32) context3D.camDist * v->y);
+
+        case 4:
+            return ((s32) (context3D.viewport.y << 1) * zi) + ((s32) context3D.camDist * v->y);
+    }
+}
+
+static void getIntersection(const V3f16* p0, const V3f16* p1, s32 d0, s32 d1, V3f16* dest)
+{
+    // always interpolate from inside vertex so shared edges give the same point
+    if (d0 < 0)
+    {
+        const V3f16* p = p0;
+        const s32 d = d0;
+
+        p0 = p1;
+        p1 = p;
+        d0 = d1;
+        d1 = d;
+    }
+
+    // t = d0 / (d0 - d1) in [0, 1[, reduce precision so divisor fits in 16 bits
+    s32 n = d0;
+    s32 den = d0 - d1;
+
+    while(den > 0x7FFF)
+    {
+        n >>= 1;
+        den >>= 1;
+    }
+
+    dest->x = p0->x + divs((s32) (s16) (p1->x - p0->x) * n, den);
+    dest->y = p0->y + divs((s32) (s16) (p1->y - p0->y) * n, den);
+    dest->z = p0->z + divs((s32) (s16) (p1->z - p0->z) * n, den);
+}
+
+// clip polygon against a single plane (one Sutherland-Hodgman pass), a convex polygon gets at most one more vertex
+static u16 clipPlane(const V3f16* src, u16 num, V3f16* dest, u16 plane)
+{
+    const V3f16* prev = &src[num - 1];
+    s32 dPrev = getPlaneDist(prev, plane);
+    V3f16* d = dest;
+
+    for(u16 i = 0; i < num; i++)
+    {
+        const V3f16* cur = &src[i];
+        const s32 dCur = getPlaneDist(cur, plane);
+
+        // edge crosses plane --> add intersection
+        if ((dPrev >= 0) != (dCur >= 0)) getIntersection(prev, cur, dPrev, dCur, d++);
+        if (dCur >= 0) *d++ = *cur;
+
+        prev = cur;
+        dPrev = dCur;
+    }
+
+    return d - dest;
+}
+
+// clip polygon against planes set in code (at most 5 more vertices)
+static u16 clipPolygon(const V3f16* src, u16 num, V3f16* dest, u16 code)
+{
+    V3f16 tmp[M3D_CLIP_MAXVERTEX + 5];
+    const V3f16* s = src;
+    u16 n = num;
+    u16 pass = 0;
+
+    // count passes so the last one writes in dest
+    for(u16 c = code; c; c >>= 1) pass += c & 1;
+
+    if (!pass)
+    {
+        memcpy(dest, src, num * sizeof(V3f16));
+        return num;
+    }
+
+    for(u16 plane = 0; plane < 5; plane++)
+    {
+        if (!(code & (1 << plane))) continue;
+
+        V3f16* d = (--pass & 1)?tmp:dest;
+
+        n = clipPlane(s, n, d, plane);
+        if (n < 3) return 0;
+
+        s = d;
+    }
+
+    return n;
+}
+
+
 //void M3D_transform_old(Transformation3D* t, const V3f16* src, V3f16* dest, u16 numv)
 //{
 //    fix16 *s;
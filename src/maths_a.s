@@ -0,0 +1,315 @@
+#include "asm_mac.i"
+
+// void fix16AddArray(const fix16 *src1, const fix16 *src2, fix16 *dest, u16 num): dest[i] = src1[i] + src2[i]
+func fix16AddArray
+    movm.l  %d2/%a2,-(%sp)
+
+    move.l  12(%sp),%a0                     // a0 = src1
+    move.l  16(%sp),%a1                     // a1 = src2
+    move.l  20(%sp),%a2                     // a2 = dest
+    move.w  26(%sp),%d1
+    move.w  %d1,%d0
+    and.w   #3,%d0                          // d0 = num & 3
+    lsr.w   #2,%d1                          // d1 = num / 4
+    jra     .f16a_rem_start
+
+.f16a_rem_loop:
+    move.w  (%a0)+,%d2
+    add.w   (%a1)+,%d2
+    move.w  %d2,(%a2)+
+.f16a_rem_start:
+    dbra    %d0,.f16a_rem_loop
+    jra     .f16a_start
+
+.f16a_loop:
+    move.w  (%a0)+,%d2
+    add.w   (%a1)+,%d2
+    move.w  %d2,(%a2)+
+    move.w  (%a0)+,%d2
+    add.w   (%a1)+,%d2
+    move.w  %d2,(%a2)+
+    move.w  (%a0)+,%d2
+    add.w   (%a1)+,%d2
+    move.w  %d2,(%a2)+
+    move.w  (%a0)+,%d2
+    add.w   (%a1)+,%d2
+    move.w  %d2,(%a2)+
+.f16a_start:
+    dbra    %d1,.f16a_loop
+
+    movm.l  (%sp)+,%d2/%a2
+    rts
+
+
+// void fix32AddArray(const fix32 *src1, const fix32 *src2, fix32 *dest, u16 num): dest[i] = src1[i] + src2[i]
+func fix32AddArray
+    movm.l  %d2/%a2,-(%sp)
+
+    move.l  12(%sp),%a0                     // a0 = src1
+    move.l  16(%sp),%a1                     // a1 = src2
+    move.l  20(%sp),%a2                     // a2 = dest
+    move.w  26(%sp),%d1
+    move.w  %d1,%d0
+    and.w   #3,%d0                          // d0 = num & 3
+    lsr.w   #2,%d1                          // d1 = num / 4
+    jra     .f32a_rem_start
+
+.f32a_rem_loop:
+    move.l  (%a0)+,%d2
+    add.l   (%a1)+,%d2
+    move.l  %d2,(%a2)+
+.f32a_rem_start:
+    dbra    %d0,.f32a_rem_loop
+    jra     .f32a_start
+
+.f32a_loop:
+    move.l  (%a0)+,%d2
+    add.l   (%a1)+,%d2
+    move.l  %d2,(%a2)+
+    move.l  (%a0)+,%d2
+    add.l   (%a1)+,%d2
+    move.l  %d2,(%a2)+
+    move.l  (%a0)+,%d2
+    add.l   (%a1)+,%d2
+    move.l  %d2,(%a2)+
+    move.l  (%a0)+,%d2
+    add.l   (%a1)+,%d2
+    move.l  %d2,(%a2)+
+.f32a_start:
+    dbra    %d1,.f32a_loop
+
+    movm.l  (%sp)+,%d2/%a2
+    rts
+
+
+// void fix16MulScalarArray(const fix16 *src, fix16 scalar, fix16 *dest, u16 num): dest[i] = src[i] * scalar
+func fix16MulScalarArray
+    movm.l  %d2-%d3,-(%sp)
+
+    move.l  12(%sp),%a0                     // a0 = src
+    move.w  18(%sp),%d3                     // d3 = scalar
+    move.l  20(%sp),%a1                     // a1 = dest
+    move.w  26(%sp),%d1
+    move.w  %d1,%d0
+    and.w   #3,%d0                          // d0 = num & 3
+    lsr.w   #2,%d1                          // d1 = num / 4
+    jra     .f16m_rem_start
+
+.f16m_rem_loop:
+    move.w  (%a0)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    move.w  %d2,(%a1)+
+.f16m_rem_start:
+    dbra    %d0,.f16m_rem_loop
+    jra     .f16m_start
+
+.f16m_loop:
+    move.w  (%a0)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    move.w  %d2,(%a1)+
+    move.w  (%a0)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    move.w  %d2,(%a1)+
+    move.w  (%a0)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    move.w  %d2,(%a1)+
+    move.w  (%a0)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    move.w  %d2,(%a1)+
+.f16m_start:
+    dbra    %d1,.f16m_loop
+
+    movm.l  (%sp)+,%d2-%d3
+    rts
+
+
+// void V2f16IntegrateArray(V2f16 *pos, const V2f16 *vel, fix16 dt, u16 num): pos[i] += vel[i] * dt
+func V2f16IntegrateArray
+    movm.l  %d2-%d3,-(%sp)
+
+    move.l  12(%sp),%a0                     // a0 = pos
+    move.l  16(%sp),%a1                     // a1 = vel
+    move.w  22(%sp),%d3                     // d3 = dt
+    move.w  26(%sp),%d1
+    move.w  %d1,%d0
+    and.w   #3,%d0                          // d0 = num & 3
+    lsr.w   #2,%d1                          // d1 = num / 4
+    jra     .v2i_rem_start
+
+.v2i_rem_loop:
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.x += vel.x * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.y += vel.y * dt
+.v2i_rem_start:
+    dbra    %d0,.v2i_rem_loop
+    jra     .v2i_start
+
+.v2i_loop:
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.x += vel.x * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.y += vel.y * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.x += vel.x * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.y += vel.y * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.x += vel.x * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.y += vel.y * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.x += vel.x * dt
+    move.w  (%a1)+,%d2
+    muls.w  %d3,%d2
+    asr.l   #6,%d2
+    add.w   %d2,(%a0)+                      //   pos.y += vel.y * dt
+.v2i_start:
+    dbra    %d1,.v2i_loop
+
+    movm.l  (%sp)+,%d2-%d3
+    rts
+
+
+// void V2f16DotArray(const V2f16 *v1, const V2f16 *v2, fix32 *dest, u16 num): dest[i] = v1[i] . v2[i]
+func V2f16DotArray
+    movm.l  %d2-%d3/%a2,-(%sp)
+
+    move.l  16(%sp),%a0                     // a0 = v1
+    move.l  20(%sp),%a1                     // a1 = v2
+    move.l  24(%sp),%a2                     // a2 = dest
+    move.w  30(%sp),%d1
+    move.w  %d1,%d0
+    and.w   #3,%d0                          // d0 = num & 3
+    lsr.w   #2,%d1                          // d1 = num / 4
+    jra     .v2d_rem_start
+
+.v2d_rem_loop:
+    move.w  (%a0)+,%d2
+    muls.w  (%a1)+,%d2
+    move.w  (%a0)+,%d3
+    muls.w  (%a1)+,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a2)+
+.v2d_rem_start:
+    dbra    %d0,.v2d_rem_loop
+    jra     .v2d_start
+
+.v2d_loop:
+    move.w  (%a0)+,%d2
+    muls.w  (%a1)+,%d2
+    move.w  (%a0)+,%d3
+    muls.w  (%a1)+,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a2)+
+    move.w  (%a0)+,%d2
+    muls.w  (%a1)+,%d2
+    move.w  (%a0)+,%d3
+    muls.w  (%a1)+,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a2)+
+    move.w  (%a0)+,%d2
+    muls.w  (%a1)+,%d2
+    move.w  (%a0)+,%d3
+    muls.w  (%a1)+,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a2)+
+    move.w  (%a0)+,%d2
+    muls.w  (%a1)+,%d2
+    move.w  (%a0)+,%d3
+    muls.w  (%a1)+,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a2)+
+.v2d_start:
+    dbra    %d1,.v2d_loop
+
+    movm.l  (%sp)+,%d2-%d3/%a2
+    rts
+
+
+// void V2f16LengthSqArray(const V2f16 *v, fix32 *dest, u16 num): dest[i] = (v[i].x * v[i].x) + (v[i].y * v[i].y)
+func V2f16LengthSqArray
+    movm.l  %d2-%d3,-(%sp)
+
+    move.l  12(%sp),%a0                     // a0 = v
+    move.l  16(%sp),%a1                     // a1 = dest
+    move.w  22(%sp),%d1
+    move.w  %d1,%d0
+    and.w   #3,%d0                          // d0 = num & 3
+    lsr.w   #2,%d1                          // d1 = num / 4
+    jra     .v2l_rem_start
+
+.v2l_rem_loop:
+    move.w  (%a0)+,%d2
+    muls.w  %d2,%d2
+    move.w  (%a0)+,%d3
+    muls.w  %d3,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a1)+
+.v2l_rem_start:
+    dbra    %d0,.v2l_rem_loop
+    jra     .v2l_start
+
+.v2l_loop:
+    move.w  (%a0)+,%d2
+    muls.w  %d2,%d2
+    move.w  (%a0)+,%d3
+    muls.w  %d3,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a1)+
+    move.w  (%a0)+,%d2
+    muls.w  %d2,%d2
+    move.w  (%a0)+,%d3
+    muls.w  %d3,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a1)+
+    move.w  (%a0)+,%d2
+    muls.w  %d2,%d2
+    move.w  (%a0)+,%d3
+    muls.w  %d3,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a1)+
+    move.w  (%a0)+,%d2
+    muls.w  %d2,%d2
+    move.w  (%a0)+,%d3
+    muls.w  %d3,%d3
+    add.l   %d3,%d2
+    asr.l   #2,%d2                          //   12 to 10 bits fractional part (fix32)
+    move.l  %d2,(%a1)+
+.v2l_start:
+    dbra    %d1,.v2l_loop
+
+    movm.l  (%sp)+,%d2-%d3
+    rts
@@ -12,9 +12,17 @@
 
 #define USED        1
 
+// small block allocator size classes: 8, 16, 32, 64 and 128 bytes
+#define SMALL_CLASS_NUM         5
+#define SMALL_CLASS_MIN_SIZE    8
+#define SMALL_CLASS_MAX_SIZE    128
+
 
 // end of bss segment --> start of heap
 extern u32 _bend;
+// static RAM region --> end of heap
+extern u32 _ramregion;
+extern u32 _eramregion;
 
 /*
  * When memory is initialized HEAP point to first bloc as well than FREE.
@@ -149,10 +157,53 @@ extern u32 _bend;
  // forward
 static u16* pack(u16 nsize);
 static u16* packEx(u32 addr, u16 nsize);
+static u16 getSmallClass(u16 size);
+static void releaseSmallBlocks(void);
+#if (ENABLE_MEM_TRACE != 0)
+static void traceAlloc(void* ptr);
+static void traceFree(void* ptr);
+#endif
 
 static u16* free;
 static u16* heap;
 
+// small block allocator: free lists per size class (blocks remain marked as used in heap)
+static bool smallAlloc;
+static u16* smallFree[SMALL_CLASS_NUM];
+// memory (in bytes) retained in small block free lists
+static u16 smallCached;
+
+// incremental pack position (always point on a block header)
+static u16* packPos;
+// number of blocks to coalesce per frame in auto pack mode (0 = disabled)
+static u16 autoPack;
+
+// current allocation tag
+static u16 memTag;
+
+// memory reclaim callback (cached data release)
+static MemReclaimCallback* reclaimCB;
+static bool reclaiming;
+
+#if (ENABLE_MEM_TRACE != 0)
+typedef struct
+{
+    void* ptr;
+    u16 tag;
+} TraceBlock;
+
+// tracked allocated blocks
+static TraceBlock traceBlocks[MEM_TRACE_MAX_BLOCK];
+static u16 traceNum;
+// blocks we couldn't track (table full)
+static u16 traceLost;
+static u16 traceAllocated;
+static u16 tracePeak;
+static u16 traceMinLargest;
+static u16 tagAllocated[MEM_TAG_NUM];
+static u16 tagPeak[MEM_TAG_NUM];
+#endif
+
 void MEM_init()
 {
     u32 h;
@@ -166,13 +217,23 @@ void MEM_init()
     h <<= 1;
 
     // define available memory (sizeof(u16) is the memory reserved to indicate heap end)
-    len = MEMORY_HIGH - (h + sizeof(u16));
+    // heap stops at static RAM region
+    len = min(MEMORY_HIGH, (u32) &_ramregion) - (h + sizeof(u16));
 
 #if (MODULE_FRACTAL != 0)
-    // reserve fixed block of memory for Fractal sound driver in high memory area
-    len -= sizeof(Fractal_Data);
-    // align on word
-    len &= 0xFFFE;
+    // static RAM region is empty or right below Fractal memory ? --> reserve fixed block of memory for Fractal sound driver in high memory area
+    if ((u32) &_eramregion > FRACTAL_MEMORY)
+    {
+        len -= sizeof(Fractal_Data);
+        // align on word
+        len &= 0xFFFE;
+    }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    // static RAM region overlaps Fractal memory
+    if (((u32) &_ramregion != (u32) &_eramregion) && ((u32) &_eramregion > FRACTAL_MEMORY))
+        kprintf("MEM_init: static RAM region overlaps Fractal memory, use --defsym=__ramregion_top=%lx", (u32) FRACTAL_MEMORY);
+#endif
 #endif
 
     // define heap
@@ -189,6 +250,104 @@ void MEM_init()
 
     // mark end of heap memory
     heap[len >> 1] = 0;
+
+    // small block allocator disabled by default
+    smallAlloc = FALSE;
+    for(u16 i = 0; i < SMALL_CLASS_NUM; i++) smallFree[i] = NULL;
+    smallCached = 0;
+
+    // incremental pack starts from heap, auto pack disabled by default
+    packPos = heap;
+    autoPack = 0;
+
+    reclaimCB = NULL;
+    reclaiming = FALSE;
+
+    memTag = MEM_TAG_USER;
+#if (ENABLE_MEM_TRACE != 0)
+    traceNum = 0;
+    traceLost = 0;
+    traceAllocated = 0;
+    for(u16 i = 0; i < MEM_TAG_NUM; i++) tagAllocated[i] = 0;
+    MEM_resetTrace();
+#endif
+}
+
+u16 MEM_setTag(u16 tag)
+{
+    const u16 prev = memTag;
+
+    memTag = tag & (MEM_TAG_NUM - 1);
+
+    return prev;
+}
+
+u16 MEM_getTag()
+{
+    return memTag;
+}
+
+bool MEM_getSmallAllocator()
+{
+    return smallAlloc;
+}
+
+void MEM_setSmallAllocator(bool value)
+{
+    // disabled --> give back cached blocks to heap
+    if (!value) releaseSmallBlocks();
+
+    smallAlloc = value;
+}
+
+u16 MEM_getSmallCached()
+{
+    return smallCached;
+}
+
+static u16 getSmallClass(u16 size)
+{
+    u16 cls = 0;
+    u16 csize = SMALL_CLASS_MIN_SIZE;
+
+    while(csize < size)
+    {
+        csize <<= 1;
+        cls++;
+    }
+
+    return cls;
+}
+
+static void releaseSmallBlocks()
+{
+    for(u16 i = 0; i < SMALL_CLASS_NUM; i++)
+    {
+        u16* p = smallFree[i];
+
+        while(p)
+        {
+            u16* next = *(u16**) p;
+
+            // mark block as no more used
+            p[-1] &= ~USED;
+            p = next;
+        }
+
+        smallFree[i] = NULL;
+    }
+
+    smallCached = 0;
+}
+
+u32 MEM_getRegionStart()
+{
+    return (u32) &_ramregion;
+}
+
+u16 MEM_getRegionSize()
+{
+    return (u32) &_eramregion - (u32) &_ramregion;
 }
 
 u16 MEM_getFree()
@@ -210,7 +369,8 @@ u16 MEM_getFree()
         b += bsize >> 1;
     }
 
-    return res;
+    // small block allocator cached blocks are available too
+    return res + smallCached;
 }
 
 u16 MEM_getLargestFreeBlock()
@@ -261,7 +421,8 @@ u16 MEM_getAllocated()
         b += bsize >> 1;
     }
 
-    return res;
+    // small block allocator cached blocks aren't really allocated
+    return res - smallCached;
 }
 
 void* MEM_alloc(u16 size)
@@ -273,6 +434,29 @@ void* MEM_alloc(u16 size)
     if (size == 0)
         return 0;
 
+    // small block allocator ?
+    if (smallAlloc && (size <= SMALL_CLASS_MAX_SIZE))
+    {
+        const u16 cls = getSmallClass(size);
+
+        p = smallFree[cls];
+        // cached block available ? --> use it
+        if (p)
+        {
+            smallFree[cls] = *(u16**) p;
+            smallCached -= (SMALL_CLASS_MIN_SIZE << cls) + sizeof(u16);
+
+#if (ENABLE_MEM_TRACE != 0)
+            traceAlloc(p);
+#endif
+
+            return p;
+        }
+
+        // allocate whole class size so block can be recycled
+        size = SMALL_CLASS_MIN_SIZE << cls;
+    }
+
     // 2 bytes aligned
     adjsize = (size + sizeof(u16) + 1) & 0xFFFE;
 
@@ -280,6 +464,26 @@ void* MEM_alloc(u16 size)
     {
         p = pack(adjsize);
 
+        // not enough memory but we have cached small blocks ? --> release them and retry
+        if ((p == NULL) && smallCached)
+        {
+            releaseSmallBlocks();
+            p = pack(adjsize);
+        }
+
+        // still not enough memory ? --> let reclaim callback release memory and retry while it can
+        while ((p == NULL) && reclaimCB && !reclaiming)
+        {
+            reclaiming = TRUE;
+            const bool released = reclaimCB(adjsize);
+            reclaiming = FALSE;
+
+            if (!released) break;
+
+            if (smallCached) releaseSmallBlocks();
+            p = pack(adjsize);
+        }
+
         // no enough memory
         if (p == NULL)
         {
@@ -321,6 +525,10 @@ void* MEM_alloc(u16 size)
     // set block size, mark as used and point to free region
     *p++ = adjsize | USED;
 
+#if (ENABLE_MEM_TRACE != 0)
+    traceAlloc(p);
+#endif
+
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
     kprintf("MEM_alloc(%d) success: %lx - remaining = %d", size, (u32) p, MEM_getFree());
 #endif
@@ -383,6 +591,10 @@ void* MEM_allocAt(u32 addr, u16 size)
     // set block size, mark as used and point to free region
     *p++ = adjsize | USED;
 
+#if (ENABLE_MEM_TRACE != 0)
+    traceAlloc(p);
+#endif
+
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
     kprintf("MEM_allocEx(%8lx, %d) success: %lx - remaining = %d", addr, size, (u32) p, MEM_getFree());
 #endif
@@ -405,6 +617,28 @@ void MEM_free(void *ptr)
         }
 #endif
 
+#if (ENABLE_MEM_TRACE != 0)
+        traceFree(ptr);
+#endif
+
+        // small block allocator ?
+        if (smallAlloc)
+        {
+            const u16 bsize = (((u16*)ptr)[-1] & ~USED) - sizeof(u16);
+
+            // size class block ? --> put it in free list
+            if ((bsize >= SMALL_CLASS_MIN_SIZE) && (bsize <= SMALL_CLASS_MAX_SIZE) && !(bsize & (bsize - 1)))
+            {
+                const u16 cls = getSmallClass(bsize);
+
+                *(u16**) ptr = smallFree[cls];
+                smallFree[cls] = ptr;
+                smallCached += bsize + sizeof(u16);
+
+                return;
+            }
+        }
+
         // mark block as no more used
         ((u16*)ptr)[-1] &= ~USED;
 
@@ -421,6 +655,11 @@ void MEM_pack()
     u16 bsize, psize;
     bool first;
 
+    // give back cached small blocks so they can be packed
+    releaseSmallBlocks();
+    // block headers will be cleared --> restart incremental pack from heap
+    packPos = heap;
+
     b = heap;
     best = b;
     bsize = 0;
@@ -466,6 +705,165 @@ void MEM_pack()
     if (bsize != 0) *best = bsize;
 }
 
+u16 MEM_packStep(u16 maxBlocks)
+{
+    u16 *b;
+    u16 bsize, psize;
+    u16 merged;
+
+    b = packPos;
+    merged = 0;
+
+    while (merged < maxBlocks)
+    {
+        bsize = *b;
+
+        // end of heap --> restart from heap on next call
+        if (bsize == 0)
+        {
+            packPos = heap;
+            return merged;
+        }
+
+        // memory block is used --> point to next memory block
+        if (bsize & USED)
+        {
+            b += bsize >> 1;
+            continue;
+        }
+
+        u16 *next = b + (bsize >> 1);
+
+        // collapse following free blocks into this one
+        while ((merged < maxBlocks) && (psize = *next) && !(psize & USED))
+        {
+            // next free block was collapsed --> use current one
+            if (free == next) free = b;
+
+            bsize += psize;
+            next += psize >> 1;
+            merged++;
+        }
+
+        // store packed free size
+        *b = bsize;
+
+        // not done with this block ? --> continue on it next time
+        if (merged >= maxBlocks) break;
+
+        b = next;
+    }
+
+    // remember position for next call
+    packPos = b;
+
+    return merged;
+}
+
+u16 MEM_getAutoPack()
+{
+    return autoPack;
+}
+
+void MEM_setAutoPack(u16 maxBlocks)
+{
+    autoPack = maxBlocks;
+}
+
+void MEM_setReclaimCallback(MemReclaimCallback* cb)
+{
+    reclaimCB = cb;
+}
+
+#if (ENABLE_MEM_TRACE != 0)
+
+static void traceAlloc(void* ptr)
+{
+    const u16 bsize = ((u16*) ptr)[-1] & ~USED;
+    const u16 tag = memTag;
+
+    if (traceNum < MEM_TRACE_MAX_BLOCK)
+    {
+        TraceBlock* block = &traceBlocks[traceNum++];
+
+        block->ptr = ptr;
+        block->tag = tag;
+    }
+    else traceLost++;
+
+    // update watermarks
+    traceAllocated += bsize;
+    if (traceAllocated > tracePeak) tracePeak = traceAllocated;
+    tagAllocated[tag] += bsize;
+    if (tagAllocated[tag] > tagPeak[tag]) tagPeak[tag] = tagAllocated[tag];
+
+    const u16 largest = MEM_getLargestFreeBlock();
+    if (largest < traceMinLargest) traceMinLargest = largest;
+}
+
+static void traceFree(void* ptr)
+{
+    const u16 bsize = ((u16*) ptr)[-1] & ~USED;
+    TraceBlock* block = traceBlocks;
+    u16 i = traceNum;
+
+    traceAllocated -= bsize;
+
+    while(i--)
+    {
+        if (block->ptr == ptr)
+        {
+            tagAllocated[block->tag] -= bsize;
+            // remove it (replace with last one)
+            *block = traceBlocks[--traceNum];
+            return;
+        }
+
+        block++;
+    }
+}
+
+u16 MEM_getPeakAllocated()
+{
+    return tracePeak;
+}
+
+u16 MEM_getMinLargestFreeBlock()
+{
+    return traceMinLargest;
+}
+
+u16 MEM_getTagAllocated(u16 tag)
+{
+    return tagAllocated[tag & (MEM_TAG_NUM - 1)];
+}
+
+u16 MEM_getTagPeakAllocated(u16 tag)
+{
+    return tagPeak[tag & (MEM_TAG_NUM - 1)];
+}
+
+void MEM_resetTrace()
+{
+    tracePeak = traceAllocated;
+    traceMinLargest = MEM_getLargestFreeBlock();
+    for(u16 i = 0; i < MEM_TAG_NUM; i++) tagPeak[i] = tagAllocated[i];
+}
+
+void MEM_dumpTrace()
+{
+    KLog("Memory trace:");
+    KLog_U3("  allocated = ", traceAllocated, " - peak = ", tracePeak, " - min largest free block = ", traceMinLargest);
+    if (traceLost) KLog_U1("  untracked blocks = ", traceLost);
+
+    for(u16 i = 0; i < MEM_TAG_NUM; i++)
+    {
+        if (tagPeak[i]) KLog_U3("  tag ", i, ": allocated = ", tagAllocated[i], " - peak = ", tagPeak[i]);
+    }
+}
+
+#endif
+
 
 void MEM_dump()
 {
@@ -525,10 +923,34 @@ void MEM_dump()
         KDebug_Alert("");
     }
 
+    KDebug_Alert(" Small blocks cache:");
+
+    for(u16 i = 0; i < SMALL_CLASS_NUM; i++)
+    {
+        u16* p = smallFree[i];
+        u16 num = 0;
+
+        while(p)
+        {
+            num++;
+            p = *(u16**) p;
+        }
+
+        strcpy(str, "    ");
+        intToStr(SMALL_CLASS_MIN_SIZE << i, strNum, 0);
+        strcat(str, strNum);
+        strcat(str, " bytes: ");
+        intToStr(num, strNum, 0);
+        strcat(str, strNum);
+        KDebug_Alert(str);
+    }
+
     KDebug_Alert("Total used:");
-    KDebug_AlertNumber(memused);
+    KDebug_AlertNumber(memused - smallCached);
     KDebug_Alert("Total free:");
     KDebug_AlertNumber(memfree);
+    KDebug_Alert("Total cached:");
+    KDebug_AlertNumber(smallCached);
 }
 
 /*
@@ -540,6 +962,9 @@ static u16* pack(u16 nsize)
     u16 *best;
     u16 bsize, psize;
 
+    // block headers will be cleared --> restart incremental pack from heap
+    packPos = heap;
+
     b = heap;
     best = b;
     bsize = 0;
@@ -600,6 +1025,9 @@ static u16* packEx(u32 addr, u16 nsize)
     u16 *best;
     u16 bsize, psize;
 
+    // block headers will be cleared --> restart incremental pack from heap
+    packPos = heap;
+
     b = heap;
     best = b;
     bsize = 0;
@@ -0,0 +1,165 @@
+#include "config.h"
+#include "types.h"
+
+#include "mode7.h"
+
+#include "maths.h"
+#include "memory.h"
+#include "mapper.h"
+#include "tools.h"
+
+
+// ASM method
+extern void M7_drawSpanA(u8 *dst, const u8 *tex, u16 u, u16 v, s16 du, s16 dv, u16 num, u16 sft);
+
+
+// texture
+static const u8 *tex = NULL;
+static Bitmap *unpacked;
+// log2 of texture size
+static u16 texSft;
+
+// perspective tables, indexed by distance to horizon (in line)
+// u / v are 16 bits texture coordinates where the whole 16 bits range map to texture size
+static u32 *zTab;
+static s16 *stepTab;
+
+static u16 horizonLine;
+static u16 camU;
+static u16 camV;
+static u16 camAngle;
+
+
+bool M7_init(const Bitmap *texture, u16 horizon, u16 height, u16 focal)
+{
+    M7_end();
+
+    const u16 w = texture->w;
+
+    // square power of 2 texture only
+    if ((w != texture->h) || ((w != 64) && (w != 128) && (w != 256)))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("M7_init(..) failed: unsupported texture size, w = ", w, " h = ", texture->h);
+#endif
+        return FALSE;
+    }
+
+    zTab = MEM_alloc(BMP_HEIGHT * (4 + 2));
+
+    if (zTab == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("M7_init(..) failed: not enough memory");
+#endif
+        return FALSE;
+    }
+
+    stepTab = (s16*) &zTab[BMP_HEIGHT];
+    unpacked = NULL;
+
+    if (texture->compression != COMPRESSION_NONE)
+    {
+        unpacked = unpackBitmap(texture, NULL);
+
+        if (unpacked == NULL)
+        {
+            MEM_free(zTab);
+            return FALSE;
+        }
+
+        tex = unpacked->image;
+    }
+    else tex = FAR_SAFE(texture->image, mulu(w, w) / 2);
+
+    texSft = getLog2Int(w);
+    camU = 0;
+    camV = 0;
+    camAngle = 0;
+
+    M7_setView(horizon, height, focal);
+
+    return TRUE;
+}
+
+void M7_end()
+{
+    if (tex == NULL) return;
+
+    if (unpacked) MEM_free(unpacked);
+    MEM_free(zTab);
+    tex = NULL;
+}
+
+void M7_setView(u16 horizon, u16 height, u16 focal)
+{
+    if (tex == NULL) return;
+
+    const u32 h = (u32) height << (16 - texSft);
+
+    horizonLine = horizon;
+
+    // line r below horizon: distance = height * focal / r, texture step per pixel = distance / focal
+    for(u16 r = 1; r < BMP_HEIGHT; r++)
+    {
+        u32 step = h / r;
+
+        // keep step in 16 bits (lines close to horizon are noise anyway)
+        if (step > 32767) step = 32767;
+
+        stepTab[r] = step;
+        // keep room for the rotation product
+        zTab[r] = min(step * focal, 0x01FFFFFF);
+    }
+
+    zTab[0] = 0;
+    stepTab[0] = 0;
+}
+
+void M7_setCamera(fix32 x, fix32 y, u16 angle)
+{
+    // texel (fix32) to 16 bits texture coordinate (wrapped)
+    const u16 sft = texSft - (16 - FIX32_FRAC_BITS);
+
+    camU = x >> sft;
+    camV = y >> sft;
+    camAngle = angle;
+}
+
+u16 M7_render()
+{
+    if ((tex == NULL) || BMP_isTileLayout()) return 0;
+
+    const u16 w = BMP_getWidth();
+    const u16 hw = w >> 1;
+    const s16 s = sinFix16(camAngle);
+    const s16 c = cosFix16(camAngle);
+    s16 y = horizonLine + 1;
+    const s16 yend = BMP_getHeight();
+    u16 res = 0;
+
+    if (y >= yend) return 0;
+
+    u8 *dst = BMP_getWritePointer(0, y);
+
+    for(u16 r = 1; y < yend; r++, y++)
+    {
+        const s32 z = zTab[r];
+        const s16 st = stepTab[r];
+        // right vector = (-sin, cos)
+        const s16 du = (st * -s) >> FIX16_FRAC_BITS;
+        const s16 dv = (st * c) >> FIX16_FRAC_BITS;
+        // line center point then go back to left pixel
+        const u16 u = (camU + ((z * c) >> FIX16_FRAC_BITS)) - (du * hw);
+        const u16 v = (camV + ((z * s) >> FIX16_FRAC_BITS)) - (dv * hw);
+
+        M7_drawSpanA(dst, tex, u, v, du, dv, hw, texSft);
+
+        dst += BMP_PITCH;
+        res++;
+    }
+
+    BMP_markDirty(horizonLine + 1, res);
+
+    return res;
+}
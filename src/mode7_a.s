@@ -0,0 +1,74 @@
+#include "asm_mac.i"
+
+// void M7_drawSpanA(u8 *dst, const u8 *tex, u16 u, u16 v, s16 du, s16 dv, u16 num, u16 sft)
+// sample num * 2 pixels along (u, v) + i * (du, dv) in the 4bpp square texture of size (1 << sft) and write them in dst
+func M7_drawSpanA
+    movm.l  %d2-%d7/%a2-%a3,-(%sp)
+
+    move.l  36(%sp),%a0                     // a0 = dst
+    move.l  40(%sp),%a1                     // a1 = tex
+    move.w  46(%sp),%d1                     // d1 = u
+    move.w  50(%sp),%d2                     // d2 = v
+    move.w  54(%sp),%a2                     // a2 = du
+    move.w  58(%sp),%a3                     // a3 = dv
+    move.w  62(%sp),%d7                     // d7 = num
+    jeq     .m7_end
+    subq.w  #1,%d7
+
+    moveq   #16,%d5
+    sub.w   66(%sp),%d5                     // d5 = 16 - sft (coordinate to texel shift)
+    move.w  66(%sp),%d6
+    subq.w  #1,%d6                          // d6 = sft - 1 (texel row to byte offset shift)
+
+.m7_loop:                                   // do {
+    move.w  %d2,%d0
+    lsr.w   %d5,%d0
+    lsl.w   %d6,%d0                         //   d0 = texture row offset
+    move.w  %d1,%d3
+    lsr.w   %d5,%d3
+    lsr.w   #1,%d3                          //   d3 = byte in row, C = odd texel
+    jcs     .m7_p0_odd
+
+    add.w   %d3,%d0
+    moveq   #-16,%d4
+    and.b   (%a1,%d0.w),%d4                 //   d4 = first pixel in high nibble
+    jra     .m7_p1
+
+.m7_p0_odd:
+    add.w   %d3,%d0
+    move.b  (%a1,%d0.w),%d4
+    lsl.b   #4,%d4                          //   d4 = first pixel in high nibble
+
+.m7_p1:
+    add.w   %a2,%d1                         //   u += du
+    add.w   %a3,%d2                         //   v += dv
+
+    move.w  %d2,%d0
+    lsr.w   %d5,%d0
+    lsl.w   %d6,%d0                         //   d0 = texture row offset
+    move.w  %d1,%d3
+    lsr.w   %d5,%d3
+    lsr.w   #1,%d3                          //   d3 = byte in row, C = odd texel
+    jcs     .m7_p1_odd
+
+    add.w   %d3,%d0
+    move.b  (%a1,%d0.w),%d3
+    lsr.b   #4,%d3                          //   d3 = second pixel in low nibble
+    jra     .m7_p2
+
+.m7_p1_odd:
+    add.w   %d3,%d0
+    moveq   #15,%d3
+    and.b   (%a1,%d0.w),%d3                 //   d3 = second pixel in low nibble
+
+.m7_p2:
+    or.b    %d3,%d4
+    move.b  %d4,(%a0)+                      //   *dst++ = pixels
+
+    add.w   %a2,%d1                         //   u += du
+    add.w   %a3,%d2                         //   v += dv
+    dbra    %d7,.m7_loop                    // } while(num--)
+
+.m7_end:
+    movm.l  (%sp)+,%d2-%d7/%a2-%a3
+    rts
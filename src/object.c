@@ -6,11 +6,49 @@
 #include "object.h"
 
 #include "memory.h"
+#include "vdp.h"
 #include "tools.h"
 
 
+// activation entry (object bounds)
+typedef struct
+{
+    s16 x;
+    s16 y;
+    u16 w;
+    u16 h;
+    Object* obj;
+    ObjectCallback* sleep;
+    ObjectCallback* wake;
+} ActEntry;
+
+
 // forward
 static void dummyObjectMethod(Object* obj);
+static void buildTypeOrder(void);
+static ActEntry* findEntry(Object* obj);
+static void removeEntry(Object* obj);
+static void sleepEntry(ActEntry* entry);
+static void wakeEntry(ActEntry* entry);
+
+
+// batch update method and priority per object type
+static ObjectBatchCallback* typeUpdates[OBJ_MAX_TYPE];
+static u16 typePriorities[OBJ_MAX_TYPE];
+// object types sorted by priority
+static u8 typeOrder[OBJ_MAX_TYPE];
+static bool typeOrderValid;
+
+// activation entries sorted on bounds X
+static ActEntry* actEntries = NULL;
+static u16 actMax;
+static u16 actNum;
+static u16 actMargin;
+// maximum bounds width (entries starting before 'area left - actMaxW' can't be visible)
+static u16 actMaxW;
+// entries outside [actLo, actHi[ are sleeping
+static u16 actLo;
+static u16 actHi;
 
 
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
@@ -39,6 +77,11 @@ Pool* OBJ_createObjectPool(u16 size, u16 objectSize)
     return POOL_create(size, objectSize);
 }
 
+Pool* OBJ_createDenseObjectPool(u16 size, u16 objectSize)
+{
+    return POOL_createDense(size, objectSize);
+}
+
 
 Object* OBJ_create(Pool* pool)
 {
@@ -61,6 +104,9 @@ void OBJ_release(Pool* pool, Object* obj, bool maintainCoherency)
 {
     if (!checkValid(obj, "OBJ_release")) return;
 
+    // unregister bounds
+    if (obj->internalState & OBJ_ACTIVATION) removeEntry(obj);
+
     POOL_release(pool, obj, maintainCoherency);
 }
 
@@ -91,16 +137,401 @@ void OBJ_setEndMethod(Object* obj, ObjectCallback* endMethod)
 
 void OBJ_updateAll(Pool* pool)
 {
+    // dense pool ?
+    if (pool->allocStack == NULL)
+    {
+        const u16 os = pool->objectSize;
+        u16 num = POOL_getNumAllocated(pool);
+        // start from last object (release moves last object in place of the released one)
+        u8* object = (u8*) POOL_getFirstObject(pool) + (num * os);
+
+        while(num--)
+        {
+            object -= os;
+            if (!(((Object*) object)->internalState & OBJ_SLEEPING)) ((Object*) object)->update((Object*) object);
+        }
+
+        return;
+    }
+
     Object** objects = (Object**) POOL_getFirst(pool);
     u16 num = POOL_getNumAllocated(pool);
 
     while(num--)
     {
         Object* object = *objects++;
-        object->update(object);
+        if (!(object->internalState & OBJ_SLEEPING)) object->update(object);
+    }
+}
+
+
+void OBJ_updateAllByType(Pool* pool)
+{
+    u16 num = POOL_getNumAllocated(pool);
+
+    if (num == 0) return;
+
+    // last bucket is for types without batch update method
+    u16 counts[OBJ_MAX_TYPE + 1];
+    Object** dst[OBJ_MAX_TYPE + 1];
+    Object* objects[num];
+    Object* sorted[num];
+    Object** obj;
+    u16 i;
+
+    if (!typeOrderValid) buildTypeOrder();
+
+    // get all awake objects
+    obj = objects;
+    if (pool->allocStack == NULL)
+    {
+        const u16 os = pool->objectSize;
+        u8* object = POOL_getFirstObject(pool);
+
+        i = num;
+        while(i--)
+        {
+            if (!(((Object*) object)->internalState & OBJ_SLEEPING)) *obj++ = (Object*) object;
+            object += os;
+        }
+    }
+    else
+    {
+        Object** src = (Object**) POOL_getFirst(pool);
+
+        i = num;
+        while(i--)
+        {
+            Object* object = *src++;
+            if (!(object->internalState & OBJ_SLEEPING)) *obj++ = object;
+        }
+    }
+    num = obj - objects;
+
+    // count objects per type
+    memset(counts, 0, sizeof(counts));
+    obj = objects;
+    i = num;
+    while(i--)
+    {
+        const u16 type = (*obj++)->type;
+        counts[(type < OBJ_MAX_TYPE)?type:OBJ_MAX_TYPE]++;
+    }
+
+    // compute bucket positions in priority order
+    obj = sorted;
+    for(i = 0; i < OBJ_MAX_TYPE; i++)
+    {
+        const u16 type = typeOrder[i];
+
+        dst[type] = obj;
+        obj += counts[type];
+    }
+    dst[OBJ_MAX_TYPE] = obj;
+
+    // distribute objects in buckets
+    obj = objects;
+    i = num;
+    while(i--)
+    {
+        Object* object = *obj++;
+        const u16 type = object->type;
+
+        *dst[(type < OBJ_MAX_TYPE)?type:OBJ_MAX_TYPE]++ = object;
+    }
+
+    // then update each bucket
+    obj = sorted;
+    for(i = 0; i <= OBJ_MAX_TYPE; i++)
+    {
+        const u16 type = (i < OBJ_MAX_TYPE)?typeOrder[i]:OBJ_MAX_TYPE;
+        u16 cnt = counts[type];
+
+        if (cnt == 0) continue;
+
+        ObjectBatchCallback* batchUpdate = (type < OBJ_MAX_TYPE)?typeUpdates[type]:NULL;
+
+        // single call for all objects of this type
+        if (batchUpdate != NULL)
+        {
+            batchUpdate(obj, cnt);
+            obj += cnt;
+        }
+        else
+        {
+            while(cnt--)
+            {
+                Object* object = *obj++;
+                object->update(object);
+            }
+        }
+    }
+}
+
+void OBJ_setTypeUpdateMethod(u16 type, ObjectBatchCallback* updateMethod, u16 priority)
+{
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    if (type >= OBJ_MAX_TYPE)
+    {
+        kprintf("OBJ_setTypeUpdateMethod: type %d is above OBJ_MAX_TYPE !", type);
+        return;
+    }
+#endif
+
+    typeUpdates[type] = updateMethod;
+    typePriorities[type] = priority;
+    // need to rebuild type order
+    typeOrderValid = FALSE;
+}
+
+
+bool OBJ_initActivation(u16 maxObject, u16 margin)
+{
+    OBJ_endActivation();
+
+    actEntries = MEM_alloc(maxObject * sizeof(ActEntry));
+
+    if (actEntries == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("OBJ_initActivation(..) failed: not enough memory, maxObject = ", maxObject);
+#endif
+        return FALSE;
+    }
+
+    actMax = maxObject;
+    actNum = 0;
+    actMargin = margin;
+    actMaxW = 0;
+    actLo = 0;
+    actHi = 0;
+
+    return TRUE;
+}
+
+void OBJ_endActivation()
+{
+    if (actEntries == NULL) return;
+
+    // objects don't have registered bounds anymore
+    ActEntry* entry = actEntries;
+    u16 i = actNum;
+    while(i--) (entry++)->obj->internalState &= ~OBJ_ACTIVATION;
+
+    MEM_free(actEntries);
+    actEntries = NULL;
+    actMax = 0;
+    actNum = 0;
+}
+
+void OBJ_setActivationMargin(u16 margin)
+{
+    actMargin = margin;
+}
+
+bool OBJ_setBounds(Object* obj, s16 x, s16 y, u16 w, u16 h)
+{
+    if (!checkValid(obj, "OBJ_setBounds")) return FALSE;
+
+    ActEntry* entry;
+    u16 ind;
+
+    if (obj->internalState & OBJ_ACTIVATION) entry = findEntry(obj);
+    else
+    {
+        if (actNum >= actMax)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("OBJ_setBounds(..) failed: activation system not initialized or full, maxObject = ", actMax);
+#endif
+            return FALSE;
+        }
+
+        // add at end (sorted below)
+        entry = &actEntries[actNum++];
+        entry->obj = obj;
+        entry->sleep = NULL;
+        entry->wake = NULL;
+        obj->internalState |= OBJ_ACTIVATION;
+    }
+
+    entry->x = x;
+    entry->y = y;
+    entry->w = w;
+    entry->h = h;
+    if (w > actMaxW) actMaxW = w;
+
+    // keep entries sorted on X (insertion)
+    const ActEntry e = *entry;
+    const u16 from = entry - actEntries;
+
+    ind = from;
+    while((ind > 0) && (actEntries[ind - 1].x > x))
+    {
+        actEntries[ind] = actEntries[ind - 1];
+        ind--;
+    }
+    while((ind < (actNum - 1)) && (actEntries[ind + 1].x < x))
+    {
+        actEntries[ind] = actEntries[ind + 1];
+        ind++;
+    }
+    actEntries[ind] = e;
+
+    // process moved entries on next update (object may be awake outside the current window)
+    actLo = min(actLo, min(from, ind));
+    actHi = max(actHi, max(from, ind) + 1);
+
+    return TRUE;
+}
+
+void OBJ_setSleepMethods(Object* obj, ObjectCallback* sleepMethod, ObjectCallback* wakeMethod)
+{
+    if (!checkValid(obj, "OBJ_setSleepMethods")) return;
+
+    ActEntry* entry = findEntry(obj);
+
+    if (entry == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        kprintf("OBJ_setSleepMethods: object %p doesn't have registered bounds !", obj);
+#endif
+        return;
     }
+
+    entry->sleep = sleepMethod;
+    entry->wake = wakeMethod;
+}
+
+bool OBJ_isSleeping(Object* obj)
+{
+    return (obj->internalState & OBJ_SLEEPING) != 0;
 }
 
+void OBJ_updateActivation(const Map* map)
+{
+    OBJ_updateActivationEx(map->posX, map->posY);
+}
+
+void OBJ_updateActivationEx(s16 camX, s16 camY)
+{
+    const u16 num = actNum;
+
+    if (num == 0) return;
+
+    const s16 left = camX - actMargin;
+    const s16 right = camX + screenWidth + actMargin;
+    const s16 top = camY - actMargin;
+    const s16 bottom = camY + screenHeight + actMargin;
+    // entries starting before that can't reach the activation area
+    const s16 minX = left - actMaxW;
+    u16 lo = actLo;
+    u16 hi = actHi;
+
+    // move window on sorted entries (camera usually moves by a few pixels)
+    if (lo > num) lo = num;
+    while((lo > 0) && (actEntries[lo - 1].x >= minX)) lo--;
+    while((lo < num) && (actEntries[lo].x < minX)) lo++;
+    if (hi < lo) hi = lo;
+    if (hi > num) hi = num;
+    while((hi > lo) && (actEntries[hi - 1].x >= right)) hi--;
+    while((hi < num) && (actEntries[hi].x < right)) hi++;
+
+    // entries leaving the window go to sleep
+    ActEntry* entry = &actEntries[min(lo, actLo)];
+    for(u16 i = min(lo, actLo); i < lo; i++, entry++) sleepEntry(entry);
+    entry = &actEntries[hi];
+    for(u16 i = hi; i < min(actHi, num); i++, entry++) sleepEntry(entry);
+
+    // full bounds test inside the window
+    entry = &actEntries[lo];
+    for(u16 i = lo; i < hi; i++, entry++)
+    {
+        if (((entry->x + (s16) entry->w) > left) && (entry->y < bottom) && ((entry->y + (s16) entry->h) > top))
+            wakeEntry(entry);
+        else
+            sleepEntry(entry);
+    }
+
+    actLo = lo;
+    actHi = hi;
+}
+
+
+static ActEntry* findEntry(Object* obj)
+{
+    ActEntry* entry = actEntries;
+    u16 i = actNum;
+
+    while(i--)
+    {
+        if (entry->obj == obj) return entry;
+        entry++;
+    }
+
+    return NULL;
+}
+
+static void removeEntry(Object* obj)
+{
+    ActEntry* entry = findEntry(obj);
+
+    obj->internalState &= ~(OBJ_ACTIVATION | OBJ_SLEEPING);
+    if (entry == NULL) return;
+
+    const u16 ind = entry - actEntries;
+    u16 i = --actNum - ind;
+
+    // keep sorted order
+    while(i--)
+    {
+        *entry = *(entry + 1);
+        entry++;
+    }
+    if (ind < actLo) actLo--;
+    if (ind < actHi) actHi--;
+}
+
+static void sleepEntry(ActEntry* entry)
+{
+    Object* obj = entry->obj;
+
+    if (obj->internalState & OBJ_SLEEPING) return;
+
+    if (entry->sleep) entry->sleep(obj);
+    obj->internalState |= OBJ_SLEEPING;
+}
+
+static void wakeEntry(ActEntry* entry)
+{
+    Object* obj = entry->obj;
+
+    if (!(obj->internalState & OBJ_SLEEPING)) return;
+
+    obj->internalState &= ~OBJ_SLEEPING;
+    if (entry->wake) entry->wake(obj);
+}
+
+
+static void buildTypeOrder()
+{
+    // insertion sort on priority (keep type order for same priority)
+    for(u16 i = 0; i < OBJ_MAX_TYPE; i++)
+    {
+        const u16 prio = typePriorities[i];
+        u16 j = i;
+
+        while((j > 0) && (typePriorities[typeOrder[j - 1]] > prio))
+        {
+            typeOrder[j] = typeOrder[j - 1];
+            j--;
+        }
+
+        typeOrder[j] = i;
+    }
+
+    typeOrderValid = TRUE;
+}
 
 static void dummyObjectMethod(Object* obj)
 {
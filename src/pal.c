@@ -17,6 +17,12 @@
 #define PALETTEFADE_FRACBITS    8
 #define PALETTEFADE_ROUND_VAL   ((1 << (PALETTEFADE_FRACBITS - 1)) - 1)
 
+// fade channel packed color: R, G, B stored as 3.7 fixed point in 10 bits fields (R at bit 0, G at bit 10, B at bit 20)
+// so a single 32 bit add steps the 3 components (each field always stays in [0, 1024[ during interpolation)
+#define PACKED_FROM_COLOR(c)    ((((u32) ((c) & VDPPALETTE_REDMASK)) << 6) | (((u32) ((c) & VDPPALETTE_GREENMASK)) << 12) | (((u32) ((c) & VDPPALETTE_BLUEMASK)) << 18))
+#define PACKED_TO_COLOR(p)      ((((p) >> 6) & VDPPALETTE_REDMASK) | (((p) >> 12) & VDPPALETTE_GREENMASK) | (((p) >> 18) & VDPPALETTE_BLUEMASK))
+#define PACKED_ROUND_VAL        ((63 << 0) | (63 << 10) | (63 << 20))
+
 
 // we don't want to share them
 extern vu16 VBlankProcess;
@@ -200,14 +206,33 @@ static u16 fadeInd;
 static u16 fadeSize;
 static s16 fadeCounter;
 
+// palette buffer (all palette writes collected and uploaded once per frame)
+static u16 palBuffer[64];
+static bool palBuffered = FALSE;
+// modified range [palDirtyLo, palDirtyHi[
+static u16 palDirtyLo = 64;
+static u16 palDirtyHi = 0;
+
+// fade channels (colors indexed by absolute color index, channels use separate ranges)
+static u16 chanFrom[PAL_FADE_CHANNEL_MAX];
+static u16 chanSize[PAL_FADE_CHANNEL_MAX];
+static s16 chanCounter[PAL_FADE_CHANNEL_MAX];
+static u16 chanActive = 0;
+static u32 chanValue[64];
+static u32 chanStep[64];
+static u16 chanEnd[64];
+
 
 // forward
 static void setFadePalette(u16 ind, const u16 *src, u16 len, bool forceWaitVBlank);
 static bool doFadeStepInternal(bool forceWaitVBlank);
+static void setBufferColors(u16 index, const u16* pal, u16 count);
 
 
 u16 PAL_getColor(u16 index)
 {
+    if (palBuffered) return palBuffer[index];
+
     const u16 addr = index * 2;
 
     *((vu32*) GFX_CTRL_PORT) = GFX_READ_CRAM_ADDR((u32)addr);
@@ -217,6 +242,12 @@ u16 PAL_getColor(u16 index)
 
 void PAL_getColors(u16 index, u16* dest, u16 count)
 {
+    if (palBuffered)
+    {
+        memcpy(dest, &palBuffer[index], count * 2);
+        return;
+    }
+
     VDP_setAutoInc(2);
 
     const u16 addr = index * 2;
@@ -247,6 +278,12 @@ void PAL_getColors(u16 index, u16* dest, u16 count)
 
 void PAL_getPalette(u16 numPal, u16* dest)
 {
+    if (palBuffered)
+    {
+        memcpy(dest, &palBuffer[numPal * 16], 16 * 2);
+        return;
+    }
+
     VDP_setAutoInc(2);
 
     const u16 addr = numPal * (16 * 2);
@@ -267,6 +304,12 @@ void PAL_getPalette(u16 numPal, u16* dest)
 
 void PAL_setColor(u16 index, u16 value)
 {
+    if (palBuffered)
+    {
+        setBufferColors(index, &value, 1);
+        return;
+    }
+
     const u16 addr = index * 2;
 
     *((vu32*) GFX_CTRL_PORT) = GFX_WRITE_CRAM_ADDR((u32)addr);
@@ -275,7 +318,8 @@ void PAL_setColor(u16 index, u16 value)
 
 void PAL_setColors(u16 index, const u16* pal, u16 count, TransferMethod tm)
 {
-    DMA_transfer(tm, DMA_CRAM, (void*) pal, index * 2, count, 2);
+    if (palBuffered) setBufferColors(index, pal, count);
+    else DMA_transfer(tm, DMA_CRAM, (void*) pal, index * 2, count, 2);
 }
 
 void PAL_setPaletteColors(u16 index, const Palette* pal, TransferMethod tm)
@@ -305,6 +349,14 @@ void PAL_setPaletteDMA(u16 numPal, const u16* pal)
 
 static void setFadePalette(u16 ind, const u16 *src, u16 len, bool forceWaitVBlank)
 {
+    // buffered --> set fade palette in buffer then wait VBlank so it's uploaded
+    if (palBuffered)
+    {
+        setBufferColors(ind, src, len);
+        if (forceWaitVBlank) SYS_doVBlankProcess();
+        return;
+    }
+
     // be sure that we are during vblank
     if (forceWaitVBlank) SYS_doVBlankProcess();
 
@@ -529,6 +581,190 @@ void PAL_fadeInAll(const u16* pal, u16 numFrame, bool async)
 }
 
 
+void PAL_setBuffered(bool value)
+{
+    if (value == palBuffered) return;
+
+    if (value)
+    {
+        // init buffer from current CRAM content
+        PAL_getColors(0, palBuffer, 64);
+        palDirtyLo = 64;
+        palDirtyHi = 0;
+        palBuffered = TRUE;
+    }
+    else
+    {
+        palBuffered = FALSE;
+        VBlankProcess &= ~PROCESS_PALETTE_TASK;
+
+        // pending modifications ? --> upload them (buffer is static so DMA queue is safe)
+        if (palDirtyLo < palDirtyHi)
+            DMA_queueDma(DMA_CRAM, &palBuffer[palDirtyLo], palDirtyLo * 2, palDirtyHi - palDirtyLo, 2);
+    }
+}
+
+bool PAL_isBuffered()
+{
+    return palBuffered;
+}
+
+// called from SYS_doVBlankProcess() to upload modified range of palette buffer
+void PAL_doVBlankProcess()
+{
+    const u16 lo = palDirtyLo;
+    const u16 hi = palDirtyHi;
+
+    if (lo < hi) DMA_doDma(DMA_CRAM, &palBuffer[lo], lo * 2, hi - lo, 2);
+
+    palDirtyLo = 64;
+    palDirtyHi = 0;
+}
+
+static void setBufferColors(u16 index, const u16* pal, u16 count)
+{
+    u16* dst = &palBuffer[index];
+    s16 first = -1;
+    u16 last = 0;
+
+    // only track changed colors
+    for(u16 i = 0; i < count; i++)
+    {
+        const u16 v = pal[i];
+
+        if (dst[i] != v)
+        {
+            dst[i] = v;
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+
+    // nothing changed
+    if (first < 0) return;
+
+    first += index;
+    last += index + 1;
+
+    if (first < palDirtyLo) palDirtyLo = first;
+    if (last > palDirtyHi) palDirtyHi = last;
+
+    VBlankProcess |= PROCESS_PALETTE_TASK;
+}
+
+
+bool PAL_fadeChannel(u16 channel, u16 fromCol, u16 toCol, const u16* pal, u16 mode, u16 numFrame)
+{
+    // can't do a fade on 0 frame !
+    if ((numFrame == 0) || (channel >= PAL_FADE_CHANNEL_MAX)) return FALSE;
+
+    const u16 size = (toCol - fromCol) + 1;
+    u16 src[64];
+
+    // source is always current palette
+    PAL_getColors(fromCol, src, size);
+
+    u16* end = &chanEnd[fromCol];
+
+    // compute end palette from fade mode
+    switch(mode)
+    {
+        case PAL_FADE_TO_PALETTE:
+            memcpy(end, pal, size * 2);
+            break;
+
+        case PAL_FADE_TO_BLACK:
+            memsetU16(end, 0, size);
+            break;
+
+        case PAL_FADE_TO_WHITE:
+            memsetU16(end, VDPPALETTE_COLORMASK, size);
+            break;
+
+        case PAL_FADE_TO_SHADOW:
+            // half intensity (same as VDP shadow mode)
+            for(u16 i = 0; i < size; i++) end[i] = (src[i] >> 1) & VDPPALETTE_COLORMASK;
+            break;
+    }
+
+    // precompute packed start values and steps
+    u32* value = &chanValue[fromCol];
+    u32* step = &chanStep[fromCol];
+
+    for(u16 i = 0; i < size; i++)
+    {
+        const u16 s = src[i];
+        const u16 d = end[i];
+
+        *value++ = PACKED_FROM_COLOR(s) + PACKED_ROUND_VAL;
+        // 3.7 fixed point components
+        *step++ = divs((s16) ((d & VDPPALETTE_REDMASK) - (s & VDPPALETTE_REDMASK)) << 6, numFrame) +
+                (divs((s16) ((d & VDPPALETTE_GREENMASK) - (s & VDPPALETTE_GREENMASK)) << 2, numFrame) * (s32) 1024) +
+                (divs((s16) (((d & VDPPALETTE_BLUEMASK) - (s & VDPPALETTE_BLUEMASK)) >> 2), numFrame) * (s32) (1024 * 1024));
+    }
+
+    chanFrom[channel] = fromCol;
+    chanSize[channel] = size;
+    chanCounter[channel] = numFrame;
+    chanActive |= 1 << channel;
+    VBlankProcess |= PROCESS_PALETTE_FADE_CHANNEL;
+
+    return TRUE;
+}
+
+void PAL_stopFadeChannel(u16 channel)
+{
+    chanActive &= ~(1 << channel);
+}
+
+bool PAL_isFadingChannel(u16 channel)
+{
+    return (chanActive & (1 << channel))?TRUE:FALSE;
+}
+
+// called from SYS_doVBlankProcess(), returns FALSE when all fade channels are done
+bool PAL_doFadeChannelStep()
+{
+    u16 cols[64];
+
+    for(u16 ch = 0; ch < PAL_FADE_CHANNEL_MAX; ch++)
+    {
+        if (!(chanActive & (1 << ch))) continue;
+
+        const u16 from = chanFrom[ch];
+        const u16 size = chanSize[ch];
+
+        // not yet done ?
+        if (--chanCounter[ch] >= 0)
+        {
+            u32* value = &chanValue[from];
+            const u32* step = &chanStep[from];
+            u16* dst = cols;
+            u16 i = size;
+
+            // output current value and step (one add for the 3 components)
+            while(i--)
+            {
+                const u32 v = *value;
+
+                *dst++ = PACKED_TO_COLOR(v);
+                *value++ = v + *step++;
+            }
+
+            PAL_setColors(from, cols, size, (size > 16)?DMA:CPU);
+        }
+        else
+        {
+            // last step --> set exact end palette
+            PAL_setColors(from, &chanEnd[from], size, (size > 16)?DMA:CPU);
+            chanActive &= ~(1 << ch);
+        }
+    }
+
+    return chanActive?TRUE:FALSE;
+}
+
+
 bool PAL_isDoingFade()
 {
     return (VBlankProcess & PROCESS_PALETTE_FADING)?TRUE:FALSE;
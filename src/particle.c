@@ -0,0 +1,252 @@
+#include "config.h"
+#include "types.h"
+
+#include "particle.h"
+
+#include "memory.h"
+#include "maths.h"
+#include "vdp.h"
+#include "vdp_spr.h"
+#include "sprite_eng.h"
+#include "tools.h"
+
+
+// off screen margin (in pixel) before particle is removed
+#define SCREEN_MARGIN   16
+
+
+// forward
+static void removeParticle(ParticleSystem* ps, u16 ind);
+
+
+ParticleSystem* PARTICLE_createSystem(u16 maxParticle, u16 maxEmitter, u16 attribut, u8 size)
+{
+    // allocate system and particle arrays at once: 5 words arrays and a byte array
+    ParticleSystem* result = MEM_alloc(sizeof(ParticleSystem) + (maxParticle * ((5 * sizeof(u16)) + sizeof(u8))));
+
+    // error on allocation --> return NULL
+    if (result == NULL) return NULL;
+
+    result->emitters = POOL_create(maxEmitter, sizeof(ParticleEmitter));
+    // can't allocate ? --> release and return NULL
+    if (result->emitters == NULL)
+    {
+        MEM_free(result);
+        return NULL;
+    }
+
+    // allocate raw sprites (hidden)
+    const s16 ind = SPR_allocateRawSprites(maxParticle);
+    // not enough raw sprites ? --> release and return NULL
+    if (ind == -1)
+    {
+        POOL_destroy(result->emitters);
+        MEM_free(result);
+        return NULL;
+    }
+
+    // set arrays
+    result->x = (fix16*) (result + 1);
+    result->y = result->x + maxParticle;
+    result->vx = result->y + maxParticle;
+    result->vy = result->vx + maxParticle;
+    result->life = (u16*) (result->vy + maxParticle);
+    result->sprites = (u8*) (result->life + maxParticle);
+
+    result->maxParticle = maxParticle;
+    result->numParticle = 0;
+    result->gravity = 0;
+    result->attribut = attribut;
+    result->size = size;
+    result->rawIndex = ind;
+
+    // store VDP sprite indexes (raw sprites are not necessarily contiguous) so update can write them directly
+    u8* spr = result->sprites;
+    for(u16 i = 0; i < maxParticle; i++)
+    {
+        const u16 vdpInd = SPR_getRawSpriteIndex(ind + i);
+
+        *spr++ = vdpInd;
+        // don't touch link (managed by the sprite engine)
+        vdpSpriteCache[vdpInd].size = size;
+        vdpSpriteCache[vdpInd].attribut = attribut;
+    }
+
+    // upload size and attribut
+    SPR_setRawSpritesDirty(ind, maxParticle);
+
+    return result;
+}
+
+void PARTICLE_releaseSystem(ParticleSystem* ps)
+{
+    // release raw sprites
+    SPR_releaseRawSprites(ps->rawIndex, ps->maxParticle);
+    POOL_destroy(ps->emitters);
+    MEM_free(ps);
+}
+
+void PARTICLE_clear(ParticleSystem* ps)
+{
+    ps->numParticle = 0;
+    SPR_hideRawSprites(ps->rawIndex, ps->maxParticle);
+}
+
+void PARTICLE_setGravity(ParticleSystem* ps, fix16 value)
+{
+    ps->gravity = value;
+}
+
+
+ParticleEmitter* PARTICLE_addEmitter(ParticleSystem* ps, fix16 x, fix16 y, fix16 vx, fix16 vy, fix16 spreadX, fix16 spreadY, fix16 rate, u16 life)
+{
+    ParticleEmitter* result = POOL_allocate(ps->emitters);
+
+    if (result == NULL) return NULL;
+
+    result->x = x;
+    result->y = y;
+    result->vx = vx;
+    result->vy = vy;
+    result->spreadX = spreadX;
+    result->spreadY = spreadY;
+    result->rate = rate;
+    result->accum = 0;
+    result->life = life;
+    result->active = TRUE;
+
+    return result;
+}
+
+void PARTICLE_removeEmitter(ParticleSystem* ps, ParticleEmitter* emitter)
+{
+    // keep coherency as we iterate over emitters
+    POOL_release(ps->emitters, emitter, TRUE);
+}
+
+
+bool PARTICLE_emit(ParticleSystem* ps, fix16 x, fix16 y, fix16 vx, fix16 vy, u16 life)
+{
+    const u16 ind = ps->numParticle;
+
+    // no more available particle
+    if (ind >= ps->maxParticle) return FALSE;
+
+    ps->x[ind] = x;
+    ps->y[ind] = y;
+    ps->vx[ind] = vx;
+    ps->vy[ind] = vy;
+    ps->life[ind] = life;
+    ps->numParticle = ind + 1;
+
+    return TRUE;
+}
+
+static fix16 getSpread(fix16 spread)
+{
+    if (spread == 0) return 0;
+
+    // random value in [-spread, spread]
+    return (fix16) (modu(random(), (spread * 2) + 1)) - spread;
+}
+
+void PARTICLE_update(ParticleSystem* ps)
+{
+    // sprites above that are already hidden
+    const u16 lastNum = ps->numParticle;
+
+    // emit new particles
+    ParticleEmitter** emitters = (ParticleEmitter**) POOL_getFirst(ps->emitters);
+    u16 num = POOL_getNumAllocated(ps->emitters);
+
+    while(num--)
+    {
+        ParticleEmitter* emitter = *emitters++;
+
+        if (!emitter->active) continue;
+
+        fix16 accum = emitter->accum + emitter->rate;
+
+        while(accum >= FIX16(1))
+        {
+            if (!PARTICLE_emit(ps, emitter->x, emitter->y, emitter->vx + getSpread(emitter->spreadX),
+                               emitter->vy + getSpread(emitter->spreadY), emitter->life))
+            {
+                // system is full --> drop remaining
+                accum &= FIX16(1) - 1;
+                break;
+            }
+
+            accum -= FIX16(1);
+        }
+
+        emitter->accum = accum;
+    }
+
+    // particle bounds (in fix16)
+    const fix16 minX = FIX16(-SCREEN_MARGIN);
+    const fix16 minY = FIX16(-(SCREEN_MARGIN * 4));
+    const fix16 maxX = FIX16(screenWidth + SCREEN_MARGIN);
+    const fix16 maxY = FIX16(screenHeight + SCREEN_MARGIN);
+    const fix16 gravity = ps->gravity;
+    fix16* px = ps->x;
+    fix16* py = ps->y;
+    fix16* pvx = ps->vx;
+    fix16* pvy = ps->vy;
+    u16* plife = ps->life;
+    u16 i = 0;
+
+    // update particles (dead particle is replaced by the last one so we don't move forward in that case)
+    while(i < ps->numParticle)
+    {
+        const u16 life = plife[i];
+
+        if (life == 0)
+        {
+            removeParticle(ps, i);
+            continue;
+        }
+
+        const fix16 vy = pvy[i] + gravity;
+        const fix16 x = px[i] + pvx[i];
+        const fix16 y = py[i] + vy;
+
+        // offscreen ? --> remove
+        if ((x < minX) || (x > maxX) || (y < minY) || (y > maxY))
+        {
+            removeParticle(ps, i);
+            continue;
+        }
+
+        px[i] = x;
+        py[i] = y;
+        pvy[i] = vy;
+        plife[i] = life - 1;
+
+        // write VDP sprite position
+        VDPSprite* spr = &vdpSpriteCache[ps->sprites[i]];
+        spr->x = fix16ToInt(x) + 0x80;
+        spr->y = fix16ToInt(y) + 0x80;
+
+        i++;
+    }
+
+    const u16 alive = ps->numParticle;
+
+    // upload alive particles and hide sprites of removed ones
+    SPR_setRawSpritesDirty(ps->rawIndex, alive);
+    if (lastNum > alive) SPR_hideRawSprites(ps->rawIndex + alive, lastNum - alive);
+}
+
+static void removeParticle(ParticleSystem* ps, u16 ind)
+{
+    const u16 last = --ps->numParticle;
+
+    // move last particle here (keep particles contiguous)
+    ps->x[ind] = ps->x[last];
+    ps->y[ind] = ps->y[last];
+    ps->vx[ind] = ps->vx[last];
+    ps->vy[ind] = ps->vy[last];
+    ps->life[ind] = ps->life[last];
+}
+
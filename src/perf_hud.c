@@ -0,0 +1,197 @@
+#include "config.h"
+#include "types.h"
+
+#include "perf_hud.h"
+
+#include "sys.h"
+#include "memory.h"
+#include "vdp.h"
+#include "dma.h"
+#include "spr_text.h"
+#include "sprite_eng.h"
+#include "xgm.h"
+#include "z80_ctrl.h"
+#include "string.h"
+#include "tools.h"
+
+
+// counter lines
+#define LINE_CPU        0
+#define LINE_DMA_QUEUE  1
+#define LINE_DMA_FLUSH  2
+#define LINE_OVERRUN    3
+#define LINE_SPR        4
+#define LINE_HEAP       5
+#define LINE_BLOCK      6
+#define LINE_VRAM       7
+#define LINE_XGM        8
+
+
+static const char* const labels[PERFHUD_NUM_LINE] =
+{
+    "CPU  ", "DMAQ ", "DMAF ", "VBO  ", "SPR  ", "HEAP ", "BLK  ", "VRAM ", "XGM  "
+};
+
+static SprText* lines[PERFHUD_NUM_LINE];
+static bool visible;
+// next line to refresh (round robin)
+static u16 current;
+// last XGM load (should be read on each frame)
+static u16 xgmLoad;
+
+
+// forward
+static void refreshLine(u16 line);
+
+
+bool PERFHUD_init(s16 x, s16 y, u16 attribut)
+{
+    PERFHUD_end();
+
+    for(u16 i = 0; i < PERFHUD_NUM_LINE; i++)
+    {
+        SprText* t = SPRTEXT_create(PERFHUD_LINE_LEN, attribut);
+
+        // not enough memory, raw sprite or tile --> release and return FALSE
+        if (t == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog("PERFHUD_init(..) failed: can't create sprite text (check SPRTEXT_init(..) tile area and SPR_reserveRawSprites(..)).");
+#endif
+            PERFHUD_end();
+            return FALSE;
+        }
+
+        SPRTEXT_setPosition(t, x, y + (i * 8));
+        SPRTEXT_setText(t, labels[i]);
+
+        lines[i] = t;
+    }
+
+    visible = TRUE;
+    current = 0;
+    xgmLoad = 0;
+
+    return TRUE;
+}
+
+void PERFHUD_end()
+{
+    // not initialized
+    if (lines[0] == NULL) return;
+
+    for(u16 i = 0; i < PERFHUD_NUM_LINE; i++)
+    {
+        if (lines[i])
+        {
+            // released sprites are hidden
+            SPRTEXT_release(lines[i]);
+            lines[i] = NULL;
+        }
+    }
+}
+
+
+void PERFHUD_setVisible(bool value)
+{
+    if (lines[0] == NULL) return;
+    if (visible == value) return;
+
+    for(u16 i = 0; i < PERFHUD_NUM_LINE; i++) SPRTEXT_setVisible(lines[i], value);
+
+    visible = value;
+}
+
+bool PERFHUD_isVisible()
+{
+    return (lines[0] != NULL) && visible;
+}
+
+void PERFHUD_toggle()
+{
+    PERFHUD_setVisible(!visible);
+}
+
+
+void PERFHUD_update()
+{
+    if ((lines[0] == NULL) || !visible) return;
+
+    // XGM load is a mean computed over 32 frames, it needs to be read on each frame
+    if (Z80_getLoadedDriver() == Z80_DRIVER_XGM) xgmLoad = XGM_getCPULoad();
+
+    // modified sprites are uploaded by SPR_update()
+    refreshLine(current);
+    if (++current >= PERFHUD_NUM_LINE) current = 0;
+}
+
+
+static void refreshLine(u16 line)
+{
+    SprText* t = lines[line];
+    char str[PERFHUD_LINE_LEN + 8];
+    char* s = strPutStr(str, labels[line]);
+#if (ENABLE_DMA_STATS != 0)
+    const DMAStats* stats = DMA_getStats();
+#endif
+
+    switch(line)
+    {
+        case LINE_CPU:
+            s = strPutUInt16(s, SYS_getCPULoad(), 1);
+            strPutStr(s, "%");
+            break;
+
+        case LINE_DMA_QUEUE:
+            strPutUInt16(s, DMA_getQueueTransferSize(), 1);
+            break;
+
+        case LINE_DMA_FLUSH:
+#if (ENABLE_DMA_STATS != 0)
+            strPutUInt16(s, stats->bytes, 1);
+#else
+            strPutStr(s, "-");
+#endif
+            break;
+
+        case LINE_OVERRUN:
+#if (ENABLE_DMA_STATS != 0)
+            s = strPutUInt16(s, stats->lastOverrun, 1);
+            s = strPutStr(s, "/");
+            strPutUInt16(s, stats->peakOverrun, 1);
+#else
+            strPutStr(s, "-");
+#endif
+            break;
+
+        case LINE_SPR:
+            // sub tick to scanline (~5 sub ticks per scanline)
+            if (SPR_isInitialized()) strPutUInt16(s, SPR_getUpdateTime() / 5, 1);
+            else strPutStr(s, "-");
+            break;
+
+        case LINE_HEAP:
+            strPutUInt16(s, MEM_getFree(), 1);
+            break;
+
+        case LINE_BLOCK:
+            strPutUInt16(s, MEM_getLargestFreeBlock(), 1);
+            break;
+
+        case LINE_VRAM:
+            if (SPR_isInitialized()) strPutUInt16(s, SPR_getFreeVRAM(), 1);
+            else strPutStr(s, "-");
+            break;
+
+        case LINE_XGM:
+            if (Z80_getLoadedDriver() == Z80_DRIVER_XGM)
+            {
+                s = strPutUInt16(s, xgmLoad, 1);
+                strPutStr(s, "%");
+            }
+            else strPutStr(s, "-");
+            break;
+    }
+
+    SPRTEXT_setText(t, str);
+}
@@ -49,6 +49,38 @@ Pool* POOL_create(u16 size, u16 objectSize)
     return result;
 }
 
+Pool* POOL_createDense(u16 size, u16 objectSize)
+{
+    // create the pool
+    Pool* result = MEM_alloc(sizeof(Pool));
+
+    // error on allocation --> return NULL
+    if (result == NULL) return NULL;
+
+    // allocate bank
+    result->bank = MEM_alloc(size * objectSize);
+    // can't allocate ? --> and return NULL
+    if (result->bank == NULL)
+    {
+        // release pool
+        MEM_free(result);
+
+        // and return NULL
+        return NULL;
+    }
+
+    // no alloc stack for dense pool
+    result->allocStack = NULL;
+    result->free = NULL;
+    // set size
+    result->size = size;
+    result->objectSize = objectSize;
+
+    POOL_reset(result, TRUE);
+
+    return result;
+}
+
 void POOL_reset(Pool* pool, bool clear)
 {
     u16 i;
@@ -60,6 +92,11 @@ void POOL_reset(Pool* pool, bool clear)
     if (clear)
         memset(pool->bank, 0, pool->size * pool->objectSize);
 
+    // no allocated object
+    pool->num = 0;
+    // dense pool ? --> done
+    if (pool->allocStack == NULL) return;
+
     // reset allocation stack
     s = pool->allocStack;
     d = pool->bank;
@@ -106,6 +143,23 @@ void POOL_destroy(Pool* pool)
 
 void* POOL_allocate(Pool* pool)
 {
+    // dense pool ?
+    if (pool->allocStack == NULL)
+    {
+        // pool is empty ?
+        if (pool->num >= pool->size)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog("POOL_allocate(): failed - no more available object !");
+#endif
+
+            return NULL;
+        }
+
+        // first free object is just after last allocated one
+        return (u8*) pool->bank + (pool->num++ * pool->objectSize);
+    }
+
     // pool is empty ?
     if (pool->free == pool->allocStack)
     {
@@ -131,13 +185,25 @@ void POOL_release(Pool* pool, void* obj, bool maintainCoherency)
     }
 
     // above
-    if (pool->free >= &pool->allocStack[pool->size])
+    if ((pool->allocStack == NULL)?(pool->num == 0):(pool->free >= &pool->allocStack[pool->size]))
     {
         KLog("POOL_release(): failed - pool doesn't contain any object !");
         return;
     }
 #endif
 
+    // dense pool ?
+    if (pool->allocStack == NULL)
+    {
+        const u16 os = pool->objectSize;
+        // last allocated object
+        void* lastObj = (u8*) pool->bank + (--pool->num * os);
+
+        // move it in place of the released one to keep allocated objects contiguous
+        if (lastObj != obj) memcpy(obj, lastObj, os);
+        return;
+    }
+
     // get previous
     void* prevObj = *pool->free;
 
@@ -170,11 +236,17 @@ void POOL_release(Pool* pool, void* obj, bool maintainCoherency)
 
 u16 POOL_getFree(Pool* pool)
 {
+    // dense pool
+    if (pool->allocStack == NULL) return pool->size - pool->num;
+
     return pool->free - pool->allocStack;
 }
 
 u16 POOL_getNumAllocated(Pool* pool)
 {
+    // dense pool
+    if (pool->allocStack == NULL) return pool->num;
+
     return pool->size - POOL_getFree(pool);
 }
 
@@ -184,8 +256,32 @@ void** POOL_getFirst(Pool* pool)
     return pool->free;
 }
 
+void* POOL_getFirstObject(Pool* pool)
+{
+    // allocated objects start at beginning of bank
+    return pool->bank;
+}
+
 s16 POOL_find(Pool* pool, void* object)
 {
+    // dense pool ? --> direct index computation
+    if (pool->allocStack == NULL)
+    {
+        const u8* first = pool->bank;
+        const u16 os = pool->objectSize;
+
+        // not in allocated objects --> not found
+        if (((u8*) object < first) || ((u8*) object >= (first + (pool->num * os)))) return -1;
+
+        const u16 offset = (u8*) object - first;
+        const u16 ind = offset / os;
+
+        // not aligned on object --> not found
+        if ((ind * os) != offset) return -1;
+
+        return ind;
+    }
+
     void** s = pool->free;
     u16 i = POOL_getNumAllocated(pool);
 
@@ -0,0 +1,232 @@
+#include "config.h"
+#include "types.h"
+
+#include "profiler.h"
+
+#if (ENABLE_PROFILER != 0)
+
+#include "timer.h"
+#include "vdp.h"
+#include "vdp_bg.h"
+#include "maths.h"
+#include "memory.h"
+#include "string.h"
+#include "tools.h"
+
+
+// bar graph length (in character) for a full frame
+#define BAR_LEN     16
+
+
+static ProfZone zones[PROF_MAX_ZONE];
+// zone stack
+static u8 stackId[PROF_MAX_DEPTH];
+static u32 stackStart[PROF_MAX_DEPTH];
+static u16 stackLevel;
+static u16 winFrames;
+
+
+static u16 getFrameTime(void);
+
+
+// called from internal_reset()
+void PROF_init()
+{
+    for(u16 i = 0; i < PROF_MAX_ZONE; i++) zones[i].name = NULL;
+
+    zones[PROF_ZONE_VBLANK].name = "VBlank";
+    zones[PROF_ZONE_DMA].name = "DMA";
+    zones[PROF_ZONE_SPRITE].name = "Sprite";
+    zones[PROF_ZONE_MAP].name = "Map";
+    zones[PROF_ZONE_JOY].name = "Joy";
+
+    PROF_reset();
+}
+
+void PROF_reset()
+{
+    for(u16 i = 0; i < PROF_MAX_ZONE; i++)
+    {
+        ProfZone* zone = &zones[i];
+        const char* name = zone->name;
+
+        memset(zone, 0, sizeof(ProfZone));
+        zone->name = name;
+        zone->parent = PROF_NO_PARENT;
+        zone->winMin = 0xFFFF;
+    }
+
+    stackLevel = 0;
+    winFrames = 0;
+}
+
+void PROF_setZoneName(u16 id, const char* name)
+{
+    if (id < PROF_MAX_ZONE) zones[id].name = name;
+}
+
+void PROF_beginZone(u16 id)
+{
+    if ((id >= PROF_MAX_ZONE) || (stackLevel >= PROF_MAX_DEPTH))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U2("PROF_begin(..) warning: invalid zone or max depth reached, id = ", id, " depth = ", stackLevel);
+#endif
+        return;
+    }
+
+    ProfZone* zone = &zones[id];
+
+    // first time we see this zone --> get hierarchy
+    if (!zone->frameCalls && !zone->winSum && !zone->calls)
+    {
+        zone->parent = stackLevel?stackId[stackLevel - 1]:PROF_NO_PARENT;
+        zone->depth = stackLevel;
+    }
+
+    stackId[stackLevel] = id;
+    stackStart[stackLevel] = getSubTick();
+    stackLevel++;
+
+#if (ENABLE_TRACE != 0)
+    TRACE_begin(id);
+#endif
+}
+
+void PROF_endZone(u16 id)
+{
+    const u32 end = getSubTick();
+
+    // unbalanced begin / end
+    if (!stackLevel || (stackId[stackLevel - 1] != id))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("PROF_end(..) warning: zone wasn't the last started one, id = ", id);
+#endif
+        return;
+    }
+
+    stackLevel--;
+
+#if (ENABLE_TRACE != 0)
+    TRACE_end(id);
+#endif
+
+    ProfZone* zone = &zones[id];
+    const u32 t = zone->frameTime + (end - stackStart[stackLevel]);
+
+    zone->frameTime = min(t, 0xFFFF);
+    zone->frameCalls++;
+}
+
+void PROF_endFrame()
+{
+    const bool endWin = ++winFrames >= PROF_FRAME_WINDOW;
+
+    for(u16 i = 0; i < PROF_MAX_ZONE; i++)
+    {
+        ProfZone* zone = &zones[i];
+        const u16 t = zone->frameTime;
+
+        if (t < zone->winMin) zone->winMin = t;
+        if (t > zone->winMax) zone->winMax = t;
+        zone->winSum += t;
+        zone->calls = zone->frameCalls;
+        zone->frameTime = 0;
+        zone->frameCalls = 0;
+
+        if (endWin)
+        {
+            zone->min = zone->winMin;
+            zone->max = zone->winMax;
+            zone->avg = zone->winSum / PROF_FRAME_WINDOW;
+            zone->winMin = 0xFFFF;
+            zone->winMax = 0;
+            zone->winSum = 0;
+        }
+    }
+
+    if (endWin) winFrames = 0;
+}
+
+const ProfZone* PROF_getZone(u16 id)
+{
+    if (id >= PROF_MAX_ZONE) return NULL;
+
+    return &zones[id];
+}
+
+u16 PROF_draw(u16 x, u16 y)
+{
+    char str[40];
+    const u16 frameTime = getFrameTime();
+    u16 line = y;
+
+    for(u16 i = 0; i < PROF_MAX_ZONE; i++)
+    {
+        const ProfZone* zone = &zones[i];
+
+        // zone not used
+        if (!zone->max && !zone->calls) continue;
+
+        char* s = str;
+        u16 len;
+
+        // indent following hierarchy
+        for(u16 d = 0; d < zone->depth; d++) *s++ = ' ';
+        // name (8 characters max)
+        len = 0;
+        if (zone->name)
+            while(zone->name[len] && (len < 8)) *s++ = zone->name[len++];
+        else
+        {
+            *s++ = '#';
+            len = uintToStr(i, s, 1);
+            s += len++;
+        }
+        while(len++ < (9 - zone->depth)) *s++ = ' ';
+
+        // bar graph
+        u16 bar = divu(zone->avg * BAR_LEN, frameTime);
+        if (bar > BAR_LEN) bar = BAR_LEN;
+        for(u16 b = 0; b < BAR_LEN; b++) *s++ = (b < bar)?'=':'.';
+        *s++ = ' ';
+        // average in % of frame
+        s += uintToStr(divu(zone->avg * 100, frameTime), s, 3);
+        *s++ = '%';
+        *s = 0;
+
+        VDP_drawText(str, x, line++);
+    }
+
+    return line - y;
+}
+
+void PROF_log()
+{
+    char str[32];
+
+    for(u16 i = 0; i < PROF_MAX_ZONE; i++)
+    {
+        const ProfZone* zone = &zones[i];
+
+        // zone not used
+        if (!zone->max && !zone->calls) continue;
+
+        strcpy(str, "PROF ");
+        if (zone->name) strcat(str, zone->name);
+        else uintToStr(i, str + 5, 1);
+        strcat(str, " avg=");
+
+        KLog_U4(str, zone->avg, " min=", zone->min, " max=", zone->max, " calls=", zone->calls);
+    }
+}
+
+
+static u16 getFrameTime()
+{
+    // sub ticks per frame
+    return IS_PAL_SYSTEM?(256 * 6):(256 * 5);
+}
+
+#endif  // ENABLE_PROFILER
@@ -6,6 +6,11 @@
 #include "vdp.h"
 
 
+// shadow of envelope and tone registers (0xFF / 0xFFFF = unknown)
+static u8 envShadow[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+static u16 toneShadow[4] = { 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF };
+
+
 void PSG_reset()
 {
     vu8 *pb;
@@ -21,6 +26,9 @@ void PSG_reset()
 
         // set envelope to silent
         *pb = 0x90 | (i << 5) | 0x0F;
+
+        toneShadow[i] = 0;
+        envShadow[i] = 0x0F;
     }
 }
 
@@ -44,6 +52,18 @@ void PSG_setEnvelope(u8 channel, u8 value)
 
     pb = (u8*) PSG_PORT;
     *pb = 0x90 | ((channel & 3) << 5) | (value & 0xF);
+
+    envShadow[channel & 3] = value & 0xF;
+}
+
+bool PSG_setEnvelopeCached(u8 channel, u8 value)
+{
+    // redundant write
+    if (envShadow[channel & 3] == (value & 0xF)) return FALSE;
+
+    PSG_setEnvelope(channel, value);
+
+    return TRUE;
 }
 
 void PSG_setTone(u8 channel, u16 value)
@@ -53,6 +73,23 @@ void PSG_setTone(u8 channel, u16 value)
     pb = (u8*) PSG_PORT;
     *pb = 0x80 | ((channel & 3) << 5) | (value & 0xF);
     *pb = (value >> 4) & 0x3F;
+
+    toneShadow[channel & 3] = value & 0x3FF;
+}
+
+bool PSG_setToneCached(u8 channel, u16 value)
+{
+    const u16 old = toneShadow[channel & 3];
+    const u16 v = value & 0x3FF;
+
+    // redundant write
+    if (old == v) return FALSE;
+
+    // only low part changed (and high part is known) --> single byte write
+    if ((old != 0xFFFF) && !((old ^ v) & 0x3F0)) PSG_setToneLow(channel, v);
+    else PSG_setTone(channel, v);
+
+    return TRUE;
 }
 
 void PSG_setToneLow(u8 channel, u8 value)
@@ -61,6 +98,19 @@ void PSG_setToneLow(u8 channel, u8 value)
 
     pb = (u8*) PSG_PORT;
     *pb = 0x80 | ((channel & 3) << 5) | (value & 0xF);
+
+    // update low part of known tone
+    if (toneShadow[channel & 3] != 0xFFFF)
+        toneShadow[channel & 3] = (toneShadow[channel & 3] & 0x3F0) | (value & 0xF);
+}
+
+void PSG_resetShadow()
+{
+    for (u16 i = 0; i < 4; i++)
+    {
+        envShadow[i] = 0xFF;
+        toneShadow[i] = 0xFFFF;
+    }
 }
 
 void PSG_setFrequency(u8 channel, u16 value)
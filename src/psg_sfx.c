@@ -0,0 +1,144 @@
+#include "config.h"
+#include "types.h"
+
+#include "psg_sfx.h"
+
+#include "psg.h"
+#include "z80_ctrl.h"
+#include "sys.h"
+#include "tools.h"
+
+
+// maximum number of commands executed per channel and per frame (protect against stream without wait)
+#define MAX_CMD_PER_FRAME   32
+
+
+// we don't want to share it
+extern vu16 VBlankProcess;
+
+
+typedef struct
+{
+    const u8* start;
+    const u8* cur;
+    u16 wait;
+    u16 priority;
+} PsgSfxChannel;
+
+
+// current stream for each channel (NULL = free)
+static PsgSfxChannel channels[4];
+
+
+bool PSGSFX_play(const u8* data, u16 channel, u16 priority)
+{
+    PsgSfxChannel* c = &channels[channel & 3];
+
+    // higher priority stream currently playing
+    if (c->cur && (c->priority > priority)) return FALSE;
+
+    c->start = data;
+    c->cur = data;
+    c->wait = 0;
+    c->priority = priority;
+
+    // music driver may have written to PSG behind our back so shadow can't be trusted
+    PSG_resetShadow();
+
+    // enable sequencer task
+    VBlankProcess |= PROCESS_PSG_SFX_TASK;
+
+    return TRUE;
+}
+
+void PSGSFX_stop(u16 channel)
+{
+    PsgSfxChannel* c = &channels[channel & 3];
+
+    if (!c->cur) return;
+
+    c->cur = NULL;
+    PSG_setEnvelope(channel & 3, PSG_ENVELOPE_MIN);
+}
+
+void PSGSFX_stopAll()
+{
+    for(u16 ch = 0; ch < 4; ch++) PSGSFX_stop(ch);
+}
+
+bool PSGSFX_isPlaying(u16 channel)
+{
+    return channels[channel & 3].cur != NULL;
+}
+
+
+// called once per frame from SYS_doVBlankProcess(), returns FALSE when no more stream to play
+bool PSGSFX_doVBlankProcess()
+{
+    bool busChecked = FALSE;
+    bool releaseBus = FALSE;
+    bool active = FALSE;
+
+    for(u16 ch = 0; ch < 4; ch++)
+    {
+        PsgSfxChannel* c = &channels[ch];
+        const u8* p = c->cur;
+
+        if (!p) continue;
+
+        // still waiting
+        if (c->wait)
+        {
+            c->wait--;
+            active = TRUE;
+            continue;
+        }
+
+        // XGM driver also writes to PSG: prevent Z80 from interleaving its writes with 2 bytes tone writes
+        if (!busChecked)
+        {
+            busChecked = TRUE;
+            // only release the bus if we took it
+            if (Z80_getLoadedDriver() == Z80_DRIVER_XGM) releaseBus = !Z80_getAndRequestBus(TRUE);
+        }
+
+        u16 cnt = MAX_CMD_PER_FRAME;
+
+        while(cnt--)
+        {
+            const u8 cmd = *p++;
+
+            if (cmd < PSGSFX_TONE) PSG_setEnvelopeCached(ch, cmd);
+            else if (cmd < PSGSFX_NOISE) PSG_setToneCached(ch, ((cmd & 3) << 8) | *p++);
+            else if (cmd < PSGSFX_WAIT)
+            {
+                if (ch == 3) PSG_setNoise((cmd >> 2) & 1, cmd & 3);
+            }
+            else if (cmd < PSGSFX_WAIT_LONG)
+            {
+                c->wait = cmd & 0x3F;
+                break;
+            }
+            else if (cmd == PSGSFX_WAIT_LONG)
+            {
+                c->wait = *p++;
+                break;
+            }
+            else if (cmd == PSGSFX_LOOP) p = c->start;
+            else
+            {
+                // end of stream (or unknown command)
+                PSG_setEnvelope(ch, PSG_ENVELOPE_MIN);
+                p = NULL;
+                break;
+            }
+        }
+
+        c->cur = p;
+        if (p) active = TRUE;
+    }
+
+    if (releaseBus) Z80_releaseBus();
+
+    return active;
+}
@@ -0,0 +1,318 @@
+#include "config.h"
+#include "types.h"
+
+#include "raster.h"
+
+#include "sys.h"
+#include "vdp.h"
+#include "memory.h"
+#include "tools.h"
+
+
+// an operation (control port long write followed by an optional data word write)
+typedef struct
+{
+    u32 ctrl;
+    u16 data;
+    u16 hasData;
+} RasterOp;
+
+// a table (ops sorted by line and H-Int events)
+typedef struct
+{
+    u16 numOp;
+    u16 numEvent;
+    RasterOp* ops;
+    u16* opLine;
+    // H-Int counter line of event, first op and op count (event 0 is operations of line 0, done in VBlank)
+    u8 eventLine[256];
+    u16 eventOp[256];
+    u8 eventNum[256];
+} RasterTable;
+
+
+// we don't want to share them
+extern vu16 VBlankProcess;
+
+static RasterTable* tables[3] = {NULL, NULL, NULL};
+// table being built
+static RasterTable* back;
+// active table
+static RasterTable* front;
+// committed table waiting for next VBlank
+static RasterTable* next;
+static volatile bool pending;
+static u16 maxOp;
+// next event processed by H-Int
+static u16 event;
+
+
+// forward
+static bool addOp(u16 line, u32 ctrl, u16 data, u16 hasData);
+static void buildEvents(RasterTable* table);
+static void copyTable(RasterTable* dst, const RasterTable* src);
+static void doOps(const RasterTable* table, u16 ev);
+static HINTERRUPT_CALLBACK hIntRaster(void);
+
+
+bool RASTER_init(u16 num)
+{
+    RASTER_end();
+
+    for(u16 i = 0; i < 3; i++)
+    {
+        RasterTable* t = MEM_alloc(sizeof(RasterTable) + (num * (sizeof(RasterOp) + 2)));
+
+        if (t == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("RASTER_init(..) failed: not enough memory, maxOp = ", num);
+#endif
+            RASTER_end();
+            return FALSE;
+        }
+
+        t->ops = (RasterOp*) &t[1];
+        t->opLine = (u16*) (t->ops + num);
+        t->numOp = 0;
+        t->numEvent = 0;
+        tables[i] = t;
+    }
+
+    maxOp = num;
+    back = tables[0];
+    front = tables[1];
+    next = tables[2];
+    pending = FALSE;
+    event = 0;
+
+    VBlankProcess |= PROCESS_RASTER_TASK;
+
+    return TRUE;
+}
+
+void RASTER_end()
+{
+    SYS_disableInts();
+
+    // raster engine was enabled ?
+    if (VBlankProcess & PROCESS_RASTER_TASK)
+    {
+        VBlankProcess &= ~PROCESS_RASTER_TASK;
+        VDP_setHInterrupt(FALSE);
+        SYS_setHIntCallback(NULL);
+    }
+
+    SYS_enableInts();
+
+    for(u16 i = 0; i < 3; i++)
+    {
+        if (tables[i]) MEM_free(tables[i]);
+        tables[i] = NULL;
+    }
+}
+
+void RASTER_clear()
+{
+    back->numOp = 0;
+}
+
+bool RASTER_addColor(u16 line, u16 index, u16 value)
+{
+    return addOp(line, GFX_WRITE_CRAM_ADDR((u32) (index * 2)), value, TRUE);
+}
+
+bool RASTER_addColors(u16 line, u16 index, const u16* colors, u16 num)
+{
+    for(u16 i = 0; i < num; i++)
+        if (!RASTER_addColor(line, index + i, colors[i])) return FALSE;
+
+    return TRUE;
+}
+
+bool RASTER_addRegister(u16 line, u16 reg, u8 value)
+{
+    const u32 w = 0x8000 | ((reg & 0x1F) << 8) | value;
+
+    // register write done twice in the long write (harmless)
+    return addOp(line, (w << 16) | w, 0, FALSE);
+}
+
+bool RASTER_addVScroll(u16 line, VDPPlane plane, s16 value)
+{
+    return addOp(line, GFX_WRITE_VSRAM_ADDR((u32) ((plane == BG_B)?2:0)), value, TRUE);
+}
+
+void RASTER_commit()
+{
+    buildEvents(back);
+
+    // VBlank doesn't touch next table while not pending (previous pending table is replaced if not yet used)
+    pending = FALSE;
+    copyTable(next, back);
+    // swap on next VBlank
+    pending = TRUE;
+}
+
+// called from SYS_doVBlankProcess()
+bool RASTER_doVBlankProcess()
+{
+    if (pending)
+    {
+        RasterTable* t = front;
+
+        front = next;
+        next = t;
+        pending = FALSE;
+    }
+
+    const RasterTable* t = front;
+
+    // line 0 operations
+    doOps(t, 0);
+
+    if (t->numEvent > 1)
+    {
+        // first 2 H-Int are done at fixed line 0 and 1 (counter is reloaded from register at each interrupt
+        // so a new counter value only applies from the interrupt after next one)
+        event = 1;
+        VDP_setHIntCounter(0);
+        SYS_setHIntCallback(hIntRaster);
+        VDP_setHInterrupt(TRUE);
+    }
+    else VDP_setHInterrupt(FALSE);
+
+    return TRUE;
+}
+
+
+static bool addOp(u16 line, u32 ctrl, u16 data, u16 hasData)
+{
+    RasterTable* t = back;
+    const u16 num = t->numOp;
+
+    if ((num >= maxOp) || (line >= 256))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("RASTER - addOp(..) failed: table full or invalid line, numOp = ", num, " line = ", line);
+#endif
+        return FALSE;
+    }
+
+    // count operations for this line
+    u16 cnt = 0;
+    for(u16 i = 0; i < num; i++)
+        if (t->opLine[i] == line) cnt++;
+
+    if (cnt >= RASTER_LINE_MAX_OP)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("RASTER - addOp(..) warning: too many operations for line ", line);
+#endif
+        return FALSE;
+    }
+
+    // insert sorted by line (stable)
+    u16 i = num;
+    while(i && (t->opLine[i - 1] > line))
+    {
+        t->ops[i] = t->ops[i - 1];
+        t->opLine[i] = t->opLine[i - 1];
+        i--;
+    }
+
+    t->ops[i].ctrl = ctrl;
+    t->ops[i].data = data;
+    t->ops[i].hasData = hasData;
+    t->opLine[i] = line;
+    t->numOp = num + 1;
+
+    return TRUE;
+}
+
+static void buildEvents(RasterTable* t)
+{
+    const u16 num = t->numOp;
+    u16 ev;
+    u16 i;
+
+    // event 0 = line 0 (VBlank), event 1 / 2 = H-Int at counter line 0 / 1 (visible from line 1 / 2)
+    for(ev = 0; ev < 3; ev++)
+    {
+        t->eventLine[ev] = (ev > 0)?(ev - 1):0;
+        t->eventOp[ev] = 0;
+        t->eventNum[ev] = 0;
+    }
+    t->numEvent = 3;
+
+    i = 0;
+    while(i < num)
+    {
+        const u16 line = t->opLine[i];
+        const u16 start = i;
+
+        while((i < num) && (t->opLine[i] == line)) i++;
+
+        // line <= 2 --> fixed events
+        if (line <= 2) ev = line;
+        else
+        {
+            ev = t->numEvent++;
+            t->eventLine[ev] = line - 1;
+        }
+
+        t->eventOp[ev] = start;
+        t->eventNum[ev] = i - start;
+    }
+
+    // only line 0 operations ? --> no H-Int needed
+    if ((num == 0) || (t->opLine[num - 1] == 0)) t->numEvent = 1;
+}
+
+static void copyTable(RasterTable* dst, const RasterTable* src)
+{
+    const u16 numEvent = src->numEvent;
+
+    dst->numOp = src->numOp;
+    dst->numEvent = numEvent;
+    memcpy(dst->ops, src->ops, src->numOp * sizeof(RasterOp));
+    memcpy(dst->opLine, src->opLine, src->numOp * 2);
+    memcpy(dst->eventLine, src->eventLine, numEvent);
+    memcpy(dst->eventOp, src->eventOp, numEvent * 2);
+    memcpy(dst->eventNum, src->eventNum, numEvent);
+}
+
+static void doOps(const RasterTable* t, u16 ev)
+{
+    vu32* pl = (vu32*) GFX_CTRL_PORT;
+    vu16* pw = (vu16*) GFX_DATA_PORT;
+    const RasterOp* op = &t->ops[t->eventOp[ev]];
+    u16 n = t->eventNum[ev];
+
+    while(n--)
+    {
+        *pl = op->ctrl;
+        if (op->hasData) *pw = op->data;
+        op++;
+    }
+}
+
+static HINTERRUPT_CALLBACK hIntRaster()
+{
+    const RasterTable* t = front;
+    const u16 ev = event;
+
+    if (ev >= t->numEvent) return;
+
+    doOps(t, ev);
+
+    // program interval between next event and the one after (applies on next counter reload)
+    const u16 next = ev + 2;
+
+    if (next < t->numEvent)
+        *((vu16*) GFX_CTRL_PORT) = 0x8A00 | (u8) (t->eventLine[next] - t->eventLine[next - 1] - 1);
+    else
+        *((vu16*) GFX_CTRL_PORT) = 0x8AFF;
+
+    event = ev + 1;
+}
@@ -0,0 +1,213 @@
+#include "config.h"
+#include "types.h"
+
+#include "sfx.h"
+
+#include "sound.h"
+#include "xgm.h"
+#include "z80_ctrl.h"
+#include "timer.h"
+#include "sys.h"
+#include "tools.h"
+
+
+// sample byte played per frame (NTSC, PAL)
+#define XGM_BYTE_PER_FRAME_NTSC     (14000 / 60)
+#define XGM_BYTE_PER_FRAME_PAL      (14000 / 50)
+#define PCM4_BYTE_PER_FRAME_NTSC    (16000 / 60)
+#define PCM4_BYTE_PER_FRAME_PAL     (16000 / 50)
+
+
+typedef struct
+{
+    s16 sfx;
+    u16 priority;
+    u32 start;
+    u32 end;
+} SfxChannel;
+
+
+static SfxDef sfxs[SFX_MAX];
+static SfxChannel channels[4];
+static u16 numSfx;
+static u16 sfxDriver;
+static u16 firstCh;
+static u16 numCh;
+
+
+static s16 findChannel(u16 priority, u32 frame);
+static void stopChannel(u16 ch);
+
+
+bool SFX_init(u16 driver, u16 firstChannel, u16 numChannel)
+{
+    if (((driver != Z80_DRIVER_XGM) && (driver != Z80_DRIVER_4PCM)) || !numChannel || ((firstChannel + numChannel) > 4))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U3("SFX_init(..) failed: incorrect parameter, driver = ", driver, " firstChannel = ", firstChannel, " numChannel = ", numChannel);
+#endif
+        return FALSE;
+    }
+
+    sfxDriver = driver;
+    firstCh = firstChannel;
+    numCh = numChannel;
+    numSfx = 0;
+
+    for(u16 i = 0; i < 4; i++)
+    {
+        channels[i].sfx = -1;
+        channels[i].end = 0;
+    }
+
+    // load the driver if not already done
+    Z80_loadDriver(driver, TRUE);
+
+    // batch SFX commands (single Z80 bus request per frame)
+    if (driver == Z80_DRIVER_XGM) XGM_setCommandQueue(TRUE);
+
+    return TRUE;
+}
+
+s16 SFX_add(const u8 *sample, u32 len, u16 priority, u16 cooldown)
+{
+    if (numSfx >= SFX_MAX)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("SFX_add(..) failed: max number of SFX reached = ", SFX_MAX);
+#endif
+        return -1;
+    }
+
+    SfxDef* sfx = &sfxs[numSfx];
+    u32 bpf;
+
+    if (sfxDriver == Z80_DRIVER_XGM)
+    {
+        bpf = IS_PAL_SYSTEM?XGM_BYTE_PER_FRAME_PAL:XGM_BYTE_PER_FRAME_NTSC;
+        // register sample in the XGM sample id table
+        XGM_setPCM(SFX_XGM_BASE_ID + numSfx, sample, len);
+    }
+    else bpf = IS_PAL_SYSTEM?PCM4_BYTE_PER_FRAME_PAL:PCM4_BYTE_PER_FRAME_NTSC;
+
+    sfx->sample = sample;
+    sfx->len = len;
+    // round up (done once so we can afford the division)
+    sfx->duration = min((len + (bpf - 1)) / bpf, 0xFFFF);
+    sfx->priority = priority & 0xF;
+    sfx->cooldown = cooldown;
+    // so it can be played right now
+    sfx->lastFrame = vtimer - (cooldown + 1);
+
+    return numSfx++;
+}
+
+void SFX_clear()
+{
+    SFX_stopAll();
+    numSfx = 0;
+}
+
+s16 SFX_play(s16 id)
+{
+    if ((id < 0) || (id >= numSfx)) return -1;
+
+    SfxDef* sfx = &sfxs[id];
+    const u32 frame = vtimer;
+    const u32 elapsed = frame - sfx->lastFrame;
+
+    // already started in this frame (coalesce) or cooldown not elapsed
+    if (!elapsed || (elapsed < sfx->cooldown)) return -1;
+
+    const s16 ch = findChannel(sfx->priority, frame);
+
+    // no channel available for this priority
+    if (ch < 0) return -1;
+
+    if (sfxDriver == Z80_DRIVER_XGM)
+        XGM_startPlayPCM(SFX_XGM_BASE_ID + id, sfx->priority, ch);
+    else
+        SND_startPlay_4PCM(sfx->sample, sfx->len, ch, FALSE);
+
+    SfxChannel* c = &channels[ch];
+
+    c->sfx = id;
+    c->priority = sfx->priority;
+    c->start = frame;
+    c->end = frame + sfx->duration;
+    sfx->lastFrame = frame;
+
+    return ch;
+}
+
+void SFX_stop(s16 id)
+{
+    const u32 frame = vtimer;
+
+    for(u16 ch = firstCh; ch < (firstCh + numCh); ch++)
+    {
+        SfxChannel* c = &channels[ch];
+
+        if ((c->sfx == id) && ((s32) (c->end - frame) > 0)) stopChannel(ch);
+    }
+}
+
+void SFX_stopAll()
+{
+    const u32 frame = vtimer;
+
+    for(u16 ch = firstCh; ch < (firstCh + numCh); ch++)
+    {
+        SfxChannel* c = &channels[ch];
+
+        if ((c->sfx != -1) && ((s32) (c->end - frame) > 0)) stopChannel(ch);
+    }
+}
+
+bool SFX_isPlaying(s16 id)
+{
+    const u32 frame = vtimer;
+
+    for(u16 ch = firstCh; ch < (firstCh + numCh); ch++)
+    {
+        SfxChannel* c = &channels[ch];
+
+        if ((c->sfx == id) && ((s32) (c->end - frame) > 0)) return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+static s16 findChannel(u16 priority, u32 frame)
+{
+    s16 best = -1;
+    u16 bestPrio = 0xFFFF;
+    u32 bestStart = 0;
+
+    for(u16 ch = firstCh; ch < (firstCh + numCh); ch++)
+    {
+        SfxChannel* c = &channels[ch];
+
+        // free channel (estimated)
+        if ((c->sfx == -1) || ((s32) (c->end - frame) <= 0)) return ch;
+
+        // stealing candidate: lowest priority then oldest one
+        if ((c->priority <= priority) && ((c->priority < bestPrio) || ((c->priority == bestPrio) && ((s32) (c->start - bestStart) < 0))))
+        {
+            best = ch;
+            bestPrio = c->priority;
+            bestStart = c->start;
+        }
+    }
+
+    return best;
+}
+
+static void stopChannel(u16 ch)
+{
+    if (sfxDriver == Z80_DRIVER_XGM) XGM_stopPlayPCM(ch);
+    else SND_stopPlay_4PCM(ch);
+
+    channels[ch].sfx = -1;
+}
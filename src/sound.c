@@ -14,6 +14,11 @@
 #include "xgm.h"
 
 
+// forward
+static void setNumChannel(const u16 driver, const u16 num);
+static u16 getCPULoad(const u16 driver);
+
+
 // Z80_DRIVER_PCM
 // single channel 8 bits signed sample driver
 ///////////////////////////////////////////////////////////////
@@ -220,6 +225,16 @@ void SND_stopPlay_2ADPCM(const u16 channel)
     Z80_releaseBus();
 }
 
+void SND_setNumChannel_2ADPCM(const u16 num)
+{
+    setNumChannel(Z80_DRIVER_2ADPCM, num);
+}
+
+u16 SND_getCPULoad_2ADPCM()
+{
+    return getCPULoad(Z80_DRIVER_2ADPCM);
+}
+
 
 // Z80_DRIVER_4PCM
 // 4 channels 8 bits signed sample driver with volume support
@@ -369,6 +384,71 @@ u8 SND_getVolume_4PCM(const u16 channel)
     return volume;
 }
 
+void SND_setNumChannel_4PCM(const u16 num)
+{
+    setNumChannel(Z80_DRIVER_4PCM, num);
+}
+
+u16 SND_getCPULoad_4PCM()
+{
+    return getCPULoad(Z80_DRIVER_4PCM);
+}
+
+
+// 2ADPCM / 4PCM drivers common
+///////////////////////////////////////////////////////////////
+
+static void setNumChannel(const u16 driver, const u16 num)
+{
+    vu8 *pb;
+
+    // load the appropriate driver if not already done
+    Z80_loadDriver(driver, TRUE);
+
+    Z80_requestBus(TRUE);
+
+    // point to Z80 number of mixed channel parameter
+    pb = (u8 *) (Z80_DRV_PARAMS + 0x2C);
+    // 0 = all channels
+    *pb = num;
+
+    Z80_releaseBus();
+}
+
+static u16 getCPULoad(const u16 driver)
+{
+    vu8 *pb;
+    u32 idle;
+    u32 total;
+
+    // nothing to do (driver should be loaded here)
+    if (Z80_getLoadedDriver() != driver)
+        return 0;
+
+    SYS_disableInts();
+    bool busTaken = Z80_getAndRequestBus(TRUE);
+
+    // point to Z80 free sample slot counter
+    pb = (u8 *) (Z80_DRV_PARAMS + 0x2E);
+
+    // get free slots and output buffers (256 sample slots each)
+    idle = pb[0] + (pb[1] << 8);
+    total = (pb[2] + (pb[3] << 8)) << 8;
+    // and reset them
+    pb[0] = 0;
+    pb[1] = 0;
+    pb[2] = 0;
+    pb[3] = 0;
+
+    if (!busTaken) Z80_releaseBus();
+    SYS_enableInts();
+
+    // no buffer done since last call
+    if (idle >= total) return 0;
+
+    return 100 - ((idle * 100) / total);
+}
+
 
 // Z80_DRIVER_XGM
 // XGM driver
@@ -0,0 +1,240 @@
+#include "config.h"
+#include "types.h"
+
+#include "spr_text.h"
+
+#include "memory.h"
+#include "vdp.h"
+#include "vdp_spr.h"
+#include "sprite_eng.h"
+#include "dma.h"
+#include "string.h"
+#include "tools.h"
+
+#include "libres.h"
+
+
+// number of character per sprite (4x1 sprite)
+#define CHAR_PER_SPR    4
+
+
+// shared font tile cache
+static TileSet* fontCache = NULL;
+static const TileSet* fontSrc;
+// reserved VRAM tile area
+static u16 baseTile;
+static u16 numBlock;
+static bool blockUsed[SPRTEXT_MAX_BLOCK];
+
+
+// forward
+static s16 allocBlock(void);
+static void updateSprites(SprText* t);
+
+
+bool SPRTEXT_init(const TileSet* font, u16 tileIndex, u16 numTile)
+{
+    SPRTEXT_end();
+
+    fontSrc = font?font:&font_default;
+
+    // unpack font once so characters can be uploaded from RAM
+    if (fontSrc->compression != COMPRESSION_NONE)
+    {
+        fontCache = unpackTileSet(fontSrc, NULL);
+
+        if (fontCache == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("SPRTEXT_init(..) failed: not enough memory to unpack font, numTile = ", fontSrc->numTile);
+#endif
+            return FALSE;
+        }
+
+        fontSrc = fontCache;
+    }
+
+    baseTile = tileIndex;
+    numBlock = min(numTile / CHAR_PER_SPR, SPRTEXT_MAX_BLOCK);
+    for(u16 i = 0; i < SPRTEXT_MAX_BLOCK; i++) blockUsed[i] = FALSE;
+
+    return TRUE;
+}
+
+void SPRTEXT_end()
+{
+    if (fontCache) MEM_free(fontCache);
+    fontCache = NULL;
+    numBlock = 0;
+}
+
+
+SprText* SPRTEXT_create(u16 maxLen, u16 attribut)
+{
+    const u16 numSprite = (maxLen + (CHAR_PER_SPR - 1)) / CHAR_PER_SPR;
+    // allocate text, block index array and text buffer at once
+    SprText* result = MEM_alloc(sizeof(SprText) + numSprite + maxLen + 1);
+
+    // error on allocation --> return NULL
+    if (result == NULL) return NULL;
+
+    result->blocks = (u8*) (result + 1);
+    result->text = (char*) (result->blocks + numSprite);
+
+    // reserve VRAM tile blocks
+    for(u16 i = 0; i < numSprite; i++)
+    {
+        const s16 block = allocBlock();
+
+        // not enough VRAM tile ? --> release and return NULL
+        if (block == -1)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("SPRTEXT_create(..) failed: not enough tile in reserved VRAM area, maxLen = ", maxLen);
+#endif
+            while(i--) blockUsed[result->blocks[i]] = FALSE;
+            MEM_free(result);
+            return NULL;
+        }
+
+        result->blocks[i] = block;
+    }
+
+    // allocate raw sprites (hidden so text is initially empty)
+    const s16 ind = SPR_allocateRawSprites(numSprite);
+    // not enough raw sprites ? --> release and return NULL
+    if (ind == -1)
+    {
+        for(u16 i = 0; i < numSprite; i++) blockUsed[result->blocks[i]] = FALSE;
+        MEM_free(result);
+        return NULL;
+    }
+
+    result->maxLen = maxLen;
+    result->len = 0;
+    result->x = 0;
+    result->y = 0;
+    result->attribut = attribut & ~TILE_INDEX_MASK;
+    result->visible = TRUE;
+    result->numSprite = numSprite;
+    result->rawIndex = ind;
+    memset(result->text, 0, maxLen + 1);
+
+    return result;
+}
+
+void SPRTEXT_release(SprText* t)
+{
+    SPR_releaseRawSprites(t->rawIndex, t->numSprite);
+    for(u16 i = 0; i < t->numSprite; i++) blockUsed[t->blocks[i]] = FALSE;
+    MEM_free(t);
+}
+
+
+void SPRTEXT_setText(SprText* t, const char* str)
+{
+    const u16 maxLen = t->maxLen;
+    char* text = t->text;
+    u16 len = 0;
+
+    for(u16 i = 0; i < maxLen; i++)
+    {
+        const char c = *str;
+
+        if (c) str++;
+        else if (!text[i] && (i >= t->len)) break;
+
+        // character changed --> upload its tile
+        if (c != text[i])
+        {
+            text[i] = c;
+
+            if (c)
+            {
+                const u8 uc = c;
+                // out of font characters are drawn as space
+                const u16 glyph = ((uc >= 32) && (uc < 128))?(uc - 32):0;
+                const u16 tile = baseTile + (t->blocks[i / CHAR_PER_SPR] * CHAR_PER_SPR) + (i & (CHAR_PER_SPR - 1));
+
+                DMA_queueDma(DMA_VRAM, (void*) (fontSrc->tiles + (glyph * 8)), tile * TILE_SIZE, TILE_SIZE / 2, 2);
+            }
+        }
+
+        if (c) len = i + 1;
+    }
+
+    // sprite sizes change only if length changed
+    if (len != t->len)
+    {
+        t->len = len;
+        if (t->visible) updateSprites(t);
+    }
+}
+
+void SPRTEXT_setUInt(SprText* t, u32 value, u16 minsize)
+{
+    char str[16];
+
+    uintToStr(value, str, minsize);
+    SPRTEXT_setText(t, str);
+}
+
+void SPRTEXT_setInt(SprText* t, s32 value, u16 minsize)
+{
+    char str[16];
+
+    intToStr(value, str, minsize);
+    SPRTEXT_setText(t, str);
+}
+
+void SPRTEXT_setPosition(SprText* t, s16 x, s16 y)
+{
+    t->x = x;
+    t->y = y;
+    if (t->visible) updateSprites(t);
+}
+
+void SPRTEXT_setVisible(SprText* t, bool value)
+{
+    t->visible = value;
+    if (value) updateSprites(t);
+    else SPR_hideRawSprites(t->rawIndex, t->numSprite);
+}
+
+
+static s16 allocBlock()
+{
+    for(u16 i = 0; i < numBlock; i++)
+    {
+        if (!blockUsed[i])
+        {
+            blockUsed[i] = TRUE;
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void updateSprites(SprText* t)
+{
+    const u16 attr = t->attribut + baseTile;
+    const s16 y = t->y;
+    s16 x = t->x;
+    u16 remain = t->len;
+    u16 n = 0;
+
+    while(remain)
+    {
+        const u16 w = min(remain, CHAR_PER_SPR);
+
+        SPR_setRawSprite(t->rawIndex + n, x, y, SPRITE_SIZE(w, 1), attr + (t->blocks[n] * CHAR_PER_SPR));
+
+        x += CHAR_PER_SPR * 8;
+        remain -= w;
+        n++;
+    }
+
+    // hide unused sprites
+    SPR_hideRawSprites(t->rawIndex + n, t->numSprite - n);
+}
@@ -16,6 +16,7 @@
 #include "kdebug.h"
 #include "string.h"
 #include "timer.h"
+#include "profiler.h"
 
 
 //#define SPR_DEBUG
@@ -37,6 +38,11 @@
 #define VISIBILITY_OFF                      0x0000
 
 #define ALLOCATED                           0x8000
+// sprite VRAM tiles are allocated from the shared frame tiles cache
+#define SHARED_TILES                        0x0020
+#define DEFERRED_FRAME_UPDATE               0x0040
+// frame update keeps current timer (rotation / scale variant change)
+#define KEEP_FRAME_TIMER                    0x0080
 
 #define NEED_ST_POS_UPDATE                  0x0001
 #define NEED_ST_ALL_UPDATE                  0x0002
@@ -47,6 +53,55 @@
 
 #define NEED_UPDATE                         0x001F
 
+// library profile (see config.h): compiled out features have their flags set to 0 so they are ignored
+#if (ENABLE_SPR_AUTO_VRAM_ALLOC == 0)
+#undef SPR_FLAG_AUTO_VRAM_ALLOC
+#define SPR_FLAG_AUTO_VRAM_ALLOC            0
+// shared frame tiles require auto VRAM allocation
+#undef SHARED_TILES
+#define SHARED_TILES                        0
+#endif
+#if (ENABLE_SPR_AUTO_SPRITE_ALLOC == 0)
+#undef SPR_FLAG_AUTO_SPRITE_ALLOC
+#define SPR_FLAG_AUTO_SPRITE_ALLOC          0
+#endif
+#if (ENABLE_SPR_AUTO_VISIBILITY == 0)
+#undef SPR_FLAG_AUTO_VISIBILITY
+#define SPR_FLAG_AUTO_VISIBILITY            0
+#undef SPR_FLAG_FAST_AUTO_VISIBILITY
+#define SPR_FLAG_FAST_AUTO_VISIBILITY       0
+#undef NEED_VISIBILITY_UPDATE
+#define NEED_VISIBILITY_UPDATE              0
+#endif
+
+#if (ENABLE_SPR_HOT_SCAN != 0)
+// number of long word of packed hot flags (4 sprite slots per long word)
+#define HOT_SCAN_SIZE                       ((MAX_SPRITE + 3) / 4)
+// sprite may need processing in SPR_update() (set conservatively, cleared by SPR_update() once the sprite is idle)
+#define SET_HOT(sprite)                     ((u8*) spriteHot)[(sprite)->slot] = 1
+#else
+#define SET_HOT(sprite)
+#endif
+
+// unused prefetched frame tiles are discarded after this number of frame
+#define PREFETCH_TIMEOUT                    256
+// shared frame tiles entries: one per sprite + one as a frame change acquires new tiles before releasing old ones
+#define MAX_SHARED_TILES                    (MAX_SPRITE + 1)
+
+
+/**
+ * Prefetched (unpacked) frame tiles slot (see SPR_setFramePrefetch(..))
+ */
+typedef struct
+{
+    const TileSet* tileset;
+    u8* buffer;
+    u32 time;
+    // DMA fence queued after the last transfer from buffer (0 if not yet queued)
+    u16 fence;
+    bool used;
+} PrefetchSlot;
+
 
 // shared from vdp_spr.c unit
 extern void logVDPSprite(u16 index);
@@ -59,6 +114,7 @@ static Sprite* allocateSprite(u16 head);
 static bool releaseSprite(Sprite* sprite);
 
 static void setVDPSpriteIndex(Sprite* sprite, u16 ind, u16 num);
+static bool updateSprite(Sprite* sprite);
 static u16 updateVisibility(Sprite* sprite, u16 status);
 static u16 setVisibility(Sprite* sprite, u16 visibility);
 static u16 updateFrame(Sprite* sprite, u16 status);
@@ -67,14 +123,49 @@ static void updateSpriteTableAll(Sprite* sprite);
 static void updateSpriteTablePos(Sprite* sprite);
 static void updateSpriteTableHide(Sprite* sprite);
 
+static void setDirtyVDPSprites(u16 min, u16 max);
+static void setDirtyVDPSprite(VDPSprite* vdpSprite);
+static void linkHead(u8 link);
+
+static void defragVRAMStep(u16 maxTile);
+
+static bool isOverBudget(u16 size);
+static u16 deferFrameUpdate(Sprite* sprite, u16 status);
+static void updateDeferredFrames(void);
+
+static s16 acquireSharedTiles(const TileSet* tileset, bool delayed);
+static void releaseSharedTiles(u16 vramIndex);
+
+static bool hasBaseTiles(const SpriteDefinition* spriteDef);
+static void setAnimVariant(Sprite* sprite, u16 anim, u16 scale, u16 rot);
 static void loadTiles(Sprite* sprite);
+static bool loadTileSet(const TileSet* tileset, u16 vramIndex);
+static bool loadTileDelta(const TileSet* tileset, const TileDelta* delta, u16 vramIndex);
+static void releasePrefetchSlots(void);
+static PrefetchSlot* getPrefetchSlot(const TileSet* tileset);
+static PrefetchSlot* getFreePrefetchSlot(void);
 static Sprite* sortSprite(Sprite* sprite);
+static void sortSprites(void);
+static void relinkSprites(void);
+static u16 computeLineLoad(void);
+static void rotateSprites(u16 num);
 static void moveAfter(Sprite* pos, Sprite* sprite);
 static u16 getSpriteIndex(Sprite* sprite);
 static void logSprite(Sprite* sprite);
 
 // starter VDP sprite - never visible (used for sprite sorting)
 static VDPSprite* starter;
+// reserved VDP sprite (first of the list), starter is moved to the last overlay sprite when an overlay is set
+static VDPSprite* headSprite;
+// last overlay VDP sprite (headSprite if no overlay)
+static VDPSprite* overlayLast;
+
+// raw VDP sprites (reserved for direct use, linked between overlay and engine sprites)
+static u8 rawSprites[MAX_VDP_SPRITE];
+static u16 numRawSprite;
+static u16 numRawLinked;
+// raw sprites allocated with SPR_allocateRawSprites(..)
+static bool rawUsed[MAX_VDP_SPRITE];
 
 // pool of Sprite objects
 Pool* spritesPool;
@@ -89,6 +180,63 @@ static VRAMRegion vram;
 // size of VRAM allocated for Sprite Engine
 u16 spriteVramSize;
 
+// sprite engine settings (see SPR_ENGINE_FLAG_xxx)
+static u16 engineFlags;
+// maximum number of tile moved by incremental VRAM defragmentation per frame (0 = disabled)
+static u16 defragVRAMBudget;
+// VRAM fragmentation level (in %) from which incremental VRAM defragmentation is done
+static u16 defragVRAMThreshold;
+// set when a sprite depth changed and sprite list need to be sorted (deferred depth sort only)
+static bool needDepthSort;
+
+// SPR_update() budget (0 = unlimited) and current frame usage
+static u16 dmaBudget;
+static u16 cpuBudget;
+static u16 dmaUsed;
+static u32 updateStartTime;
+// time spent in last SPR_update() call (in sub tick)
+static u16 updateTime;
+// sprites which had their frame update delayed (processed first on next SPR_update() call)
+static Sprite* deferredSprites[MAX_SPRITE];
+static u16 numDeferredSprites;
+
+#if (ENABLE_SPR_HOT_SCAN != 0)
+// packed hot flags indexed by sprite pool slot, scanned by SPR_update() so idle sprites are never dereferenced
+static u32 spriteHot[HOT_SCAN_SIZE];
+#endif
+
+// prefetched frame tiles slots (only allocated if frame prefetch is enabled)
+static PrefetchSlot* prefetchSlots;
+static u16 numPrefetchSlot;
+static u16 prefetchSlotSize;
+
+/**
+ * Shared frame tiles cache entry (see SPR_ENGINE_FLAG_SHARED_FRAME_TILES)
+ */
+typedef struct
+{
+    const TileSet* tileset;
+    u16 vramIndex;
+    u16 refCount;
+} SharedTiles;
+
+// shared frame tiles cache (only allocated if SPR_ENGINE_FLAG_SHARED_FRAME_TILES is set)
+static SharedTiles* sharedTiles;
+static u16 numSharedTiles;
+
+// flicker scheduler data (only allocated if SPR_ENGINE_FLAG_FLICKER_SCHEDULER is set)
+// per scanline sprite / pixel count (+1 entry for computation)
+static u8* lineSprites;
+static s16* linePixels;
+static SpriteLineStats lineStats;
+// current rotation of hardware sprite link order
+static u16 rotation;
+static bool rotated;
+
+// range of VDP sprites modified since last upload (empty if dirtyVDPSpriteMin > dirtyVDPSpriteMax)
+static s16 dirtyVDPSpriteMin;
+static s16 dirtyVDPSpriteMax;
+
 #ifdef SPR_PROFIL
 
 #define PROFIL_ALLOCATE_SPRITE          0
@@ -116,7 +264,7 @@ static u32 profil_time[20];
 #endif
 
 
-void SPR_initEx(u16 vramSize)
+void SPR_initWithFlags(u16 vramSize, u16 flags)
 {
     u16 index;
     u16 size;
@@ -124,6 +272,9 @@ void SPR_initEx(u16 vramSize)
     // end it first (if initialized)
     SPR_end();
 
+    // tag sprite engine allocations
+    const u16 tag = MEM_setTag(MEM_TAG_SPRITE);
+
     // create sprites object pool
     spritesPool = POOL_create(MAX_SPRITE, sizeof(Sprite));
 
@@ -133,12 +284,31 @@ void SPR_initEx(u16 vramSize)
 
     // and create a VRAM region for sprite tile allocation
     VRAM_createRegion(&vram, index, size);
+    if (flags & SPR_ENGINE_FLAG_VRAM_BEST_FIT) VRAM_setPolicy(&vram, VRAM_POLICY_BEST_FIT);
     // store allocated VRAM size to let SGDK know about it
     spriteVramSize = size;
 
     // need to update user tile max index
     updateUserTileMaxIndex();
 
+    // store engine settings
+    engineFlags = flags;
+    defragVRAMBudget = 0;
+    defragVRAMThreshold = 0;
+    dmaBudget = 0;
+    cpuBudget = 0;
+    // allocate shared frame tiles cache if needed
+    if (flags & SPR_ENGINE_FLAG_SHARED_FRAME_TILES)
+        sharedTiles = MEM_alloc(MAX_SHARED_TILES * sizeof(SharedTiles));
+    // allocate scanline load buffers if needed (max screen height is 240)
+    if (flags & SPR_ENGINE_FLAG_FLICKER_SCHEDULER)
+    {
+        lineSprites = MEM_alloc((240 + 1) * sizeof(u8));
+        linePixels = MEM_alloc((240 + 1) * sizeof(s16));
+    }
+
+    MEM_setTag(tag);
+
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
     KLog("Sprite engine initialized !");
     KLog_U2_("  VRAM region: [", index, " - ", index + (size - 1), "]");
@@ -148,9 +318,14 @@ void SPR_initEx(u16 vramSize)
     SPR_reset();
 }
 
+void SPR_initEx(u16 vramSize)
+{
+    SPR_initWithFlags(vramSize, 0);
+}
+
 void SPR_init()
 {
-    SPR_initEx(420);
+    SPR_initWithFlags(420, 0);
 }
 
 void SPR_end()
@@ -164,6 +339,19 @@ void SPR_end()
         // release memory
         POOL_destroy(spritesPool);
         spritesPool = NULL;
+        if (sharedTiles)
+        {
+            MEM_free(sharedTiles);
+            sharedTiles = NULL;
+        }
+        if (lineSprites)
+        {
+            MEM_free(lineSprites);
+            MEM_free(linePixels);
+            lineSprites = NULL;
+            linePixels = NULL;
+        }
+        releasePrefetchSlots();
         VRAM_releaseRegion(&vram);
         spriteVramSize = 0;
 
@@ -192,6 +380,21 @@ void SPR_reset()
     // no active sprites
     firstSprite = NULL;
     lastSprite = NULL;
+#if (ENABLE_SPR_HOT_SCAN != 0)
+    memset(spriteHot, 0, sizeof(spriteHot));
+#endif
+    needDepthSort = FALSE;
+    // no delayed frame update
+    numDeferredSprites = 0;
+    // no prefetched frame tiles
+    for(u16 i = 0; i < numPrefetchSlot; i++)
+        prefetchSlots[i].tileset = NULL;
+    // no shared frame tiles
+    numSharedTiles = 0;
+    // no rotation
+    rotation = 0;
+    rotated = FALSE;
+    memset(&lineStats, 0, sizeof(lineStats));
 
     // clear VRAM region
     VRAM_clearRegion(&vram);
@@ -200,9 +403,18 @@ void SPR_reset()
 
     // we reserve sprite 0 for sorting (cannot be used for display)
     starter = &vdpSpriteCache[VDP_allocateSprites(1)];
+    // no overlay
+    headSprite = starter;
+    overlayLast = starter;
+    // no raw sprites
+    numRawSprite = 0;
+    numRawLinked = 0;
     // hide it (should be already done by VDP_resetSprites)
     starter->y = 0;
 
+    // VDP sprite table need to be fully uploaded
+    setDirtyVDPSprites(0, MAX_VDP_SPRITE - 1);
+
 #ifdef SPR_PROFIL
     memset(profil_time, 0, sizeof(profil_time));
 #endif // SPR_PROFIL
@@ -235,6 +447,11 @@ static Sprite* allocateSprite(u16 head)
     KLog_U1("allocateSprite(): success - allocating sprite at pos ", spritesPool->free[-1] - spritesPool->bank);
 #endif // LIB_DEBUG
 
+#if (ENABLE_SPR_HOT_SCAN != 0)
+    // pool slot (index of hot flag)
+    result->slot = result - (Sprite*) spritesPool->bank;
+#endif
+
     if (head)
     {
         // add the new sprite at the beginning of the chained list
@@ -280,6 +497,11 @@ static bool releaseSprite(Sprite* sprite)
         // release sprite (we don't need stack coherency here as we don't use stack iteration)
         POOL_release(spritesPool, sprite, FALSE);
 
+#if (ENABLE_SPR_HOT_SCAN != 0)
+        // released sprite should not be processed anymore
+        ((u8*) spriteHot)[sprite->slot] = 0;
+#endif
+
         // remove sprite from chained list
         prev = sprite->prev;
         next = sprite->next;
@@ -308,9 +530,28 @@ static bool releaseSprite(Sprite* sprite)
             // update last sprite
             lastSprite = prev;
         }
+        setDirtyVDPSprite(lastVDPSprite);
+
+        // remove it from delayed frame update list
+        if (sprite->status & DEFERRED_FRAME_UPDATE)
+        {
+            Sprite** s = deferredSprites;
+            u16 i = numDeferredSprites;
+
+            while(i--)
+            {
+                if (*s == sprite)
+                {
+                    // replace by last one
+                    *s = deferredSprites[--numDeferredSprites];
+                    break;
+                }
+                s++;
+            }
+        }
 
         // not anymore allocated
-        sprite->status &= ~ALLOCATED;
+        sprite->status &= ~(ALLOCATED | DEFERRED_FRAME_UPDATE);
 
         END_PROFIL(PROFIL_RELEASE_SPRITE)
 
@@ -360,6 +601,7 @@ Sprite* SPR_addSpriteEx(const SpriteDefinition* spriteDef, s16 x, s16 y, u16 att
     }
 
     sprite->status = ALLOCATED | (flag & SPR_FLAG_MASK);
+    SET_HOT(sprite);
 
 #ifdef SPR_DEBUG
     KLog_U2("SPR_addSpriteEx: added sprite #", getSpriteIndex(sprite), " - internal position = ", sprite - spritesBank);
@@ -376,9 +618,12 @@ Sprite* SPR_addSpriteEx(const SpriteDefinition* spriteDef, s16 x, s16 y, u16 att
 //    FIXME: not needed
 //    sprite->animation = NULL;
     sprite->frame = NULL;
+    sprite->lastTileset = NULL;
+    sprite->lastBaseTileset = NULL;
 
     sprite->animInd = -1;
     sprite->frameInd = -1;
+    sprite->clock = NULL;
 //    sprite->seqInd = -1;
 
     sprite->x = x + 0x80;
@@ -415,8 +660,15 @@ Sprite* SPR_addSpriteEx(const SpriteDefinition* spriteDef, s16 x, s16 y, u16 att
     // set the VDP Sprite index for this sprite and do attached operation
     setVDPSpriteIndex(sprite, ind, numVDPSprite);
 
+    // use shared frame tiles ? --> VRAM is allocated on frame update (not possible with animation base tiles)
+    if (sharedTiles && !hasBaseTiles(spriteDef) && (flag & SPR_FLAG_AUTO_VRAM_ALLOC) && (flag & SPR_FLAG_AUTO_TILE_UPLOAD))
+    {
+        sprite->status |= SHARED_TILES;
+        // no VRAM tiles yet (index 0 is never part of sprite VRAM region)
+        sprite->attribut = attribut & TILE_ATTR_MASK;
+    }
     // auto VRAM alloc enabled ?
-    if (flag & SPR_FLAG_AUTO_VRAM_ALLOC)
+    else if (flag & SPR_FLAG_AUTO_VRAM_ALLOC)
     {
         // allocate VRAM
         ind = VRAM_alloc(&vram, spriteDef->maxNumTile);
@@ -514,8 +766,15 @@ void SPR_releaseSprite(Sprite* sprite)
         KLog_U3("  released ", sprite->definition->maxNumSprite, " VDP sprite(s) at ", sprite->VDPSpriteIndex, ", remaining VDP sprite = ", VDP_getAvailableSprites());
 #endif // SPR_DEBUG
     }
+    // shared frame tiles --> release reference on current frame tiles
+    if (status & SHARED_TILES)
+    {
+        const u16 vramIndex = sprite->attribut & TILE_INDEX_MASK;
+
+        if (vramIndex) releaseSharedTiles(vramIndex);
+    }
     // auto VRAM alloc enabled --> release VRAM area allocated for this sprite
-    if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
+    else if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
     {
         VRAM_free(&vram, sprite->attribut & TILE_INDEX_MASK);
 
@@ -537,6 +796,7 @@ void SPR_defragVRAM()
     START_PROFIL
 
     Sprite* sprite;
+    u16 newSharedIndexes[MAX_SPRITE];
 
     // release VRAM region
     VRAM_releaseRegion(&vram);
@@ -544,6 +804,11 @@ void SPR_defragVRAM()
     MEM_pack();
     // and re-create it (useful if TILE_FONT_INDEX changed, when we modify plane size for instance)
     VRAM_createRegion(&vram, TILE_FONT_INDEX - spriteVramSize, spriteVramSize);
+    if (engineFlags & SPR_ENGINE_FLAG_VRAM_BEST_FIT) VRAM_setPolicy(&vram, VRAM_POLICY_BEST_FIT);
+
+    // re-allocate shared frame tiles first (can't fail here)
+    for(u16 i = 0; i < numSharedTiles; i++)
+        newSharedIndexes[i] = VRAM_alloc(&vram, sharedTiles[i].tileset->numTile);
 
     // iterate over all sprites to re-allocate auto allocated VRAM
     sprite = firstSprite;
@@ -551,8 +816,35 @@ void SPR_defragVRAM()
     {
         u16 status = sprite->status;
 
+        // sprite is using shared frame tiles ?
+        if (status & SHARED_TILES)
+        {
+            const u16 attr = sprite->attribut;
+            const u16 oldInd = attr & TILE_INDEX_MASK;
+
+            if (oldInd)
+            {
+                // find the shared entry and get its new VRAM index
+                for(u16 i = 0; i < numSharedTiles; i++)
+                {
+                    if (sharedTiles[i].vramIndex == oldInd)
+                    {
+                        const u16 ind = newSharedIndexes[i];
+
+                        // VRAM allocation changed ? --> need to update VDP sprite table
+                        if (ind != oldInd)
+                        {
+                            sprite->attribut = ind | (attr & TILE_ATTR_MASK);
+                            sprite->status = status | NEED_ST_ALL_UPDATE;
+                            SET_HOT(sprite);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
         // sprite is using auto VRAM allocation ?
-        if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
+        else if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
         {
             // re-allocate VRAM for this sprite (can't fail here)
             const u16 ind = VRAM_alloc(&vram, sprite->definition->maxNumTile);
@@ -563,6 +855,9 @@ void SPR_defragVRAM()
             {
                 // set VRAM index and preserve previous attributs
                 sprite->attribut = ind | (attr & TILE_ATTR_MASK);
+                // nothing uploaded at new location
+                sprite->lastTileset = NULL;
+                sprite->lastBaseTileset = NULL;
 
                 // need to update VDP sprite table
                 status |= NEED_ST_ALL_UPDATE;
@@ -571,6 +866,7 @@ void SPR_defragVRAM()
                     status |= NEED_TILES_UPLOAD;
 
                 sprite->status = status;
+                SET_HOT(sprite);
             }
         }
 
@@ -578,6 +874,191 @@ void SPR_defragVRAM()
         sprite = sprite->next;
     }
 
+    // update shared frame tiles and re-upload them if needed (only once per shared entry)
+    for(u16 i = 0; i < numSharedTiles; i++)
+    {
+        SharedTiles* entry = &sharedTiles[i];
+        const u16 ind = newSharedIndexes[i];
+
+        if (entry->vramIndex != ind)
+        {
+            entry->vramIndex = ind;
+            loadTileSet(entry->tileset, ind);
+        }
+    }
+
+    END_PROFIL(PROFIL_VRAM_DEFRAG)
+}
+
+void SPR_setDefragVRAMBudget(u16 value)
+{
+    defragVRAMBudget = value;
+}
+
+void SPR_setDefragVRAMThreshold(u16 value)
+{
+    defragVRAMThreshold = value;
+}
+
+u16 SPR_getVRAMFragmentation()
+{
+    return VRAM_getFragmentation(&vram);
+}
+
+u16 SPR_getFreeVRAM()
+{
+    return VRAM_getFree(&vram);
+}
+
+void SPR_setUpdateBudget(u16 dmaSize, u16 cpuTime)
+{
+    dmaBudget = dmaSize;
+    cpuBudget = cpuTime;
+}
+
+static bool isOverBudget(u16 size)
+{
+    // DMA budget exceeded ? (always accept at least one frame update)
+    if (dmaBudget && dmaUsed && ((dmaUsed + size) > dmaBudget))
+        return TRUE;
+    // DMA queue capacity (computed by DMA automatic capacity) exceeded ?
+    if (dmaUsed && DMA_getAutoCapacity() && (size > DMA_getRemainingCapacity()))
+        return TRUE;
+    // CPU budget exceeded ?
+    if (cpuBudget && ((getSubTick() - updateStartTime) > cpuBudget))
+        return TRUE;
+
+    return FALSE;
+}
+
+static u16 deferFrameUpdate(Sprite* sprite, u16 status)
+{
+    // not yet in delayed frame update list ? --> add it
+    if (!(status & DEFERRED_FRAME_UPDATE))
+    {
+        deferredSprites[numDeferredSprites++] = sprite;
+        status |= DEFERRED_FRAME_UPDATE;
+    }
+
+    return status;
+}
+
+static void updateDeferredFrames()
+{
+    Sprite** sprites = deferredSprites;
+    const u16 num = numDeferredSprites;
+
+    // sort by priority: visible sprites first then by depth (insertion sort, list is small)
+    for(u16 i = 1; i < num; i++)
+    {
+        Sprite* sprite = sprites[i];
+        const bool visible = (sprite->visibility != 0);
+        const s16 depth = sprite->depth;
+        s16 j = i - 1;
+
+        while(j >= 0)
+        {
+            Sprite* s = sprites[j];
+            const bool sVisible = (s->visibility != 0);
+
+            // already well ordered ? --> stop here
+            if ((sVisible && !visible) || ((sVisible == visible) && (s->depth <= depth)))
+                break;
+
+            sprites[j + 1] = s;
+            j--;
+        }
+
+        sprites[j + 1] = sprite;
+    }
+
+    // list is rebuilt with sprites we still can't update
+    numDeferredSprites = 0;
+
+    for(u16 i = 0; i < num; i++)
+    {
+        Sprite* sprite = sprites[i];
+        u16 status = sprite->status & ~DEFERRED_FRAME_UPDATE;
+
+        // still need frame update ? (can be changed or done in between)
+        if (status & NEED_FRAME_UPDATE)
+            status = updateFrame(sprite, status);
+
+        sprite->status = status;
+        SET_HOT(sprite);
+    }
+}
+
+static void defragVRAMStep(u16 maxTile)
+{
+    START_PROFIL
+
+    Sprite* sprite;
+    u16 remaining = maxTile;
+    u16 from;
+    s16 to;
+
+    // move blocks until budget is exhausted or nothing can be moved anymore
+    while(remaining && ((to = VRAM_moveDown(&vram, remaining, &from)) != -1))
+    {
+        u16 numTile = 0;
+
+        // block owned by a shared frame tiles entry ?
+        for(u16 i = 0; i < numSharedTiles; i++)
+        {
+            SharedTiles* entry = &sharedTiles[i];
+
+            if (entry->vramIndex == from)
+            {
+                entry->vramIndex = to;
+                numTile = entry->tileset->numTile;
+                break;
+            }
+        }
+
+        // update all sprites using this block
+        sprite = firstSprite;
+        while(sprite)
+        {
+            u16 status = sprite->status;
+            const u16 attr = sprite->attribut;
+
+            if ((status & SPR_FLAG_AUTO_VRAM_ALLOC) && ((attr & TILE_INDEX_MASK) == from))
+            {
+                // dedicated block --> only one owner
+                if (!(status & SHARED_TILES))
+                    numTile = sprite->definition->maxNumTile;
+
+                // set VRAM index and preserve previous attributs
+                sprite->attribut = to | (attr & TILE_ATTR_MASK);
+                // need to update VDP sprite table
+                sprite->status = status | NEED_ST_ALL_UPDATE;
+                SET_HOT(sprite);
+
+                if (!(status & SHARED_TILES)) break;
+            }
+
+            // next sprite
+            sprite = sprite->next;
+        }
+
+        // copy tile data to new location during VBlank, before sprite table update (new and old locations never overlap)
+        const u16 prio = DMA_setQueuePriority(DMA_PRIORITY_HIGH);
+        if (!DMA_queueVRamCopy(from * 32, to * 32, numTile * 32, 1))
+        {
+            // queue is full --> do it now
+            DMA_doVRamCopy(from * 32, to * 32, numTile * 32, 1);
+            DMA_waitCompletion();
+        }
+        DMA_setQueuePriority(prio);
+
+#ifdef SPR_DEBUG
+        KLog_U3("defragVRAMStep: moved ", numTile, " tiles from ", from, " to ", to);
+#endif // SPR_DEBUG
+
+        remaining -= numTile;
+    }
+
     END_PROFIL(PROFIL_VRAM_DEFRAG)
 }
 
@@ -694,8 +1175,8 @@ bool SPR_setDefinition(Sprite* sprite, const SpriteDefinition* spriteDef)
 
     const u16 newNumTile = spriteDef->maxNumTile;
 
-    // auto VRAM alloc enabled --> realloc VRAM tile area
-    if ((status & SPR_FLAG_AUTO_VRAM_ALLOC) && (sprite->definition->maxNumTile != newNumTile))
+    // auto VRAM alloc enabled --> realloc VRAM tile area (not needed for shared frame tiles as it's done on frame update)
+    if ((status & SPR_FLAG_AUTO_VRAM_ALLOC) && !(status & SHARED_TILES) && (sprite->definition->maxNumTile != newNumTile))
     {
         // we release previous allocated VRAM
         VRAM_free(&vram, sprite->attribut & TILE_INDEX_MASK);
@@ -721,6 +1202,8 @@ bool SPR_setDefinition(Sprite* sprite, const SpriteDefinition* spriteDef)
 //    FIXME: not needed
 //    sprite->animation = NULL;
     sprite->frame = NULL;
+    sprite->lastTileset = NULL;
+    sprite->lastBaseTileset = NULL;
     sprite->animInd = -1;
     sprite->frameInd = -1;
 //    sprite->seqInd = -1;
@@ -769,6 +1252,52 @@ void SPR_setPosition(Sprite* sprite, s16 x, s16 y)
             status |= NEED_VISIBILITY_UPDATE;
 
         sprite->status = status | NEED_ST_POS_UPDATE;
+        SET_HOT(sprite);
+    }
+
+    END_PROFIL(PROFIL_SET_ATTRIBUTE)
+}
+
+void SPR_setPositions(Sprite** sprites, const Vect2D_s16* positions, u16 num)
+{
+    SPR_setPositionsEx(sprites, &positions->x, sizeof(Vect2D_s16), num);
+}
+
+void SPR_setPositionsEx(Sprite** sprites, const s16* positions, u16 stride, u16 num)
+{
+    START_PROFIL
+
+    const u8* src = (const u8*) positions;
+    Sprite** spr = sprites;
+    u16 i = num;
+
+    while(i--)
+    {
+        Sprite* sprite = *spr++;
+        const s16* pos = (const s16*) src;
+        const s16 newx = pos[0] + 0x80;
+        const s16 newy = pos[1] + 0x80;
+
+        // next position
+        src += stride;
+
+        if (!isSpriteValid(sprite, "SPR_setPositionsEx"))
+            continue;
+
+        if ((sprite->x != newx) || (sprite->y != newy))
+        {
+            u16 status = sprite->status;
+
+            sprite->x = newx;
+            sprite->y = newy;
+
+            // need to recompute visibility if auto visibility is enabled
+            if (status & SPR_FLAG_AUTO_VISIBILITY)
+                status |= NEED_VISIBILITY_UPDATE;
+
+            sprite->status = status | NEED_ST_POS_UPDATE;
+            SET_HOT(sprite);
+        }
     }
 
     END_PROFIL(PROFIL_SET_ATTRIBUTE)
@@ -800,6 +1329,7 @@ void SPR_setHFlip(Sprite* sprite, bool value)
                 sprite->status |= NEED_VISIBILITY_UPDATE | NEED_ST_ALL_UPDATE;
             else
                 sprite->status |= NEED_ST_ALL_UPDATE;
+            SET_HOT(sprite);
         }
     }
     else
@@ -819,6 +1349,7 @@ void SPR_setHFlip(Sprite* sprite, bool value)
                 sprite->status |= NEED_VISIBILITY_UPDATE | NEED_ST_ALL_UPDATE;
             else
                 sprite->status |= NEED_ST_ALL_UPDATE;
+            SET_HOT(sprite);
         }
     }
 
@@ -851,6 +1382,7 @@ void SPR_setVFlip(Sprite* sprite, bool value)
                 sprite->status |= NEED_VISIBILITY_UPDATE | NEED_ST_ALL_UPDATE;
             else
                 sprite->status |= NEED_ST_ALL_UPDATE;
+            SET_HOT(sprite);
         }
     }
     else
@@ -870,6 +1402,7 @@ void SPR_setVFlip(Sprite* sprite, bool value)
                 sprite->status |= NEED_VISIBILITY_UPDATE | NEED_ST_ALL_UPDATE;
             else
                 sprite->status |= NEED_ST_ALL_UPDATE;
+            SET_HOT(sprite);
         }
     }
 
@@ -892,6 +1425,7 @@ void SPR_setPriority(Sprite* sprite, bool value)
         {
             sprite->attribut = attr & (~TILE_ATTR_PRIORITY_MASK);
             sprite->status |= NEED_ST_ALL_UPDATE;
+            SET_HOT(sprite);
 
 #ifdef SPR_DEBUG
             KLog_U1_("SPR_setPriorityAttribut: #", getSpriteIndex(sprite), " removed priority");
@@ -905,6 +1439,7 @@ void SPR_setPriority(Sprite* sprite, bool value)
         {
             sprite->attribut = attr | TILE_ATTR_PRIORITY_MASK;
             sprite->status |= NEED_ST_ALL_UPDATE;
+            SET_HOT(sprite);
 
 #ifdef SPR_DEBUG
             KLog_U1_("SPR_setPriorityAttribut: #", getSpriteIndex(sprite), " added priority");
@@ -935,6 +1470,7 @@ void SPR_setPalette(Sprite* sprite, u16 value)
         sprite->attribut = newAttribut;
         // need to update VDP sprite attribut field only
         sprite->status |= NEED_ST_ALL_UPDATE;
+        SET_HOT(sprite);
 
 #ifdef SPR_DEBUG
         KLog_U2("SPR_setPalette: #", getSpriteIndex(sprite), " palette=", value);
@@ -958,9 +1494,12 @@ void SPR_setDepth(Sprite* sprite, s16 value)
         KLog_U2("SPR_setDepth: #", getSpriteIndex(sprite), "  Depth=", value);
 #endif // SPR_DEBUG
 
-        // set depth and sort sprite (need to be done immediately to get consistent sort)
         sprite->depth = value;
-        sortSprite(sprite);
+
+        // deferred sort ? --> just mark sprite list as unsorted (done in SPR_update())
+        if (engineFlags & SPR_ENGINE_FLAG_DEFERRED_DEPTH_SORT) needDepthSort = TRUE;
+        // sort sprite (need to be done immediately to get consistent sort)
+        else sortSprite(sprite);
     }
 
     END_PROFIL(PROFIL_SET_ATTRIBUTE)
@@ -1015,6 +1554,7 @@ void SPR_setAnimAndFrame(Sprite* sprite, s16 anim, s16 frame)
 #endif // SPR_DEBUG
 
         sprite->status |= NEED_FRAME_UPDATE;
+        SET_HOT(sprite);
     }
 
     END_PROFIL(PROFIL_SET_ANIM_FRAME)
@@ -1050,6 +1590,7 @@ void SPR_setAnim(Sprite* sprite, s16 anim)
 #endif // SPR_DEBUG
 
         sprite->status |= NEED_FRAME_UPDATE;
+        SET_HOT(sprite);
     }
 
     END_PROFIL(PROFIL_SET_ANIM_FRAME)
@@ -1082,6 +1623,7 @@ void SPR_setFrame(Sprite* sprite, s16 frame)
 #endif // SPR_DEBUG
 
         sprite->status |= NEED_FRAME_UPDATE;
+        SET_HOT(sprite);
     }
 
     END_PROFIL(PROFIL_SET_ANIM_FRAME)
@@ -1095,10 +1637,15 @@ void SPR_nextFrame(Sprite* sprite)
         return;
 
     const Animation *anim = sprite->animation;
-    u16 frameInd = sprite->frameInd + 1;
+    u16 frameInd;
 
-    if (frameInd >= anim->numFrame)
-        frameInd = anim->loop;
+    // precomputed steps (loop already resolved)
+    if (anim->steps) frameInd = anim->steps[sprite->frameInd].next;
+    else
+    {
+        frameInd = sprite->frameInd + 1;
+        if (frameInd >= anim->numFrame) frameInd = anim->loop;
+    }
 
     // set new frame
     SPR_setFrame(sprite, frameInd);
@@ -1106,6 +1653,133 @@ void SPR_nextFrame(Sprite* sprite)
     END_PROFIL(PROFIL_SET_ANIM_FRAME)
 }
 
+void SPR_setAngle(Sprite* sprite, u16 angle)
+{
+    if (!isSpriteValid(sprite, "SPR_setAngle"))
+        return;
+
+    const SpriteDefinition* def = sprite->definition;
+    const u16 numRot = def->numRotation;
+
+    // no pre-rendered rotation
+    if (numRot <= 1) return;
+
+    const u16 numVar = numRot * max(1, def->numScale);
+    const u16 var = sprite->animInd % numVar;
+    // nearest rotation step
+    u16 rot = (mulu(angle & 1023, numRot) + 512) >> 10;
+    if (rot >= numRot) rot = 0;
+
+    setAnimVariant(sprite, sprite->animInd / numVar, var / numRot, rot);
+}
+
+void SPR_setScaleStep(Sprite* sprite, u16 step)
+{
+    if (!isSpriteValid(sprite, "SPR_setScaleStep"))
+        return;
+
+    const SpriteDefinition* def = sprite->definition;
+    const u16 numScale = def->numScale;
+
+    // no pre-rendered scaling
+    if (numScale <= 1) return;
+
+    const u16 numRot = max(1, def->numRotation);
+    const u16 numVar = numRot * numScale;
+    const u16 var = sprite->animInd % numVar;
+
+    setAnimVariant(sprite, sprite->animInd / numVar, min(step, numScale - 1), var % numRot);
+}
+
+void SPR_setBaseAnim(Sprite* sprite, s16 anim)
+{
+    if (!isSpriteValid(sprite, "SPR_setBaseAnim"))
+        return;
+
+    const SpriteDefinition* def = sprite->definition;
+    const u16 numVar = max(1, def->numRotation) * max(1, def->numScale);
+
+    // keep current variant
+    SPR_setAnim(sprite, (anim * numVar) + (sprite->animInd % numVar));
+}
+
+static void setAnimVariant(Sprite* sprite, u16 anim, u16 scale, u16 rot)
+{
+    START_PROFIL
+
+    const SpriteDefinition* def = sprite->definition;
+    const s16 newAnim = (((anim * max(1, def->numScale)) + scale) * max(1, def->numRotation)) + rot;
+
+    if (sprite->animInd != newAnim)
+    {
+        sprite->animInd = newAnim;
+        // variants have the same frame sequence --> keep current frame and timer
+        sprite->animation = def->animations[newAnim];
+
+#ifdef SPR_DEBUG
+        KLog_U3("SPR_setAnimVariant: #", getSpriteIndex(sprite), " anim=", newAnim, " frame=", sprite->frameInd);
+#endif // SPR_DEBUG
+
+        sprite->status |= NEED_FRAME_UPDATE | KEEP_FRAME_TIMER;
+        SET_HOT(sprite);
+    }
+
+    END_PROFIL(PROFIL_SET_ANIM_FRAME)
+}
+
+void SPR_initAnimationClock(AnimationClock* clock, const Animation* animation)
+{
+    clock->animation = animation;
+    clock->frameInd = 0;
+    clock->timer = animation->steps ? animation->steps[0].timer : animation->frames[0]->timer;
+}
+
+void SPR_updateAnimationClock(AnimationClock* clock)
+{
+    u16 timer = clock->timer;
+
+    // not animated or frame not yet elapsed
+    if (!timer || --timer)
+    {
+        clock->timer = timer;
+        return;
+    }
+
+    const Animation* anim = clock->animation;
+    u16 frameInd;
+
+    if (anim->steps)
+    {
+        const AnimationStep* step = &anim->steps[anim->steps[clock->frameInd].next];
+
+        frameInd = step - anim->steps;
+        timer = step->timer;
+    }
+    else
+    {
+        frameInd = clock->frameInd + 1;
+        if (frameInd >= anim->numFrame) frameInd = anim->loop;
+        timer = anim->frames[frameInd]->timer;
+    }
+
+    clock->frameInd = frameInd;
+    clock->timer = timer;
+}
+
+void SPR_setAnimationClock(Sprite* sprite, const AnimationClock* clock)
+{
+    if (!isSpriteValid(sprite, "SPR_setAnimationClock"))
+        return;
+
+    sprite->clock = clock;
+
+    // follow clock frame (timer is cleared so sprite doesn't do its own timing)
+    if (clock) SPR_setFrame(sprite, clock->frameInd);
+    // restart own timing from current frame
+    else if (sprite->frame) sprite->timer = sprite->frame->timer;
+    SET_HOT(sprite);
+}
+
 bool SPR_setVRAMTileIndex(Sprite* sprite, s16 value)
 {
     START_PROFIL
@@ -1117,15 +1791,31 @@ bool SPR_setVRAMTileIndex(Sprite* sprite, s16 value)
     u16 status = sprite->status;
     u16 oldAttribut = sprite->attribut;
 
+#if (ENABLE_SPR_AUTO_VRAM_ALLOC == 0)
+    if (value == -1)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("SPR_setVRAMTileIndex(..) failed: auto VRAM allocation is disabled in config.h");
+#endif
+        END_PROFIL(PROFIL_SET_VRAM_OR_SPRIND)
+
+        return FALSE;
+    }
+#endif
+
     if (status & SPR_FLAG_AUTO_VRAM_ALLOC)
     {
         // pass to manual allocation
         if (value != -1)
         {
-            // remove auto vram alloc flag
-            status &= ~SPR_FLAG_AUTO_VRAM_ALLOC;
             // release allocated VRAM first
-            VRAM_free(&vram, oldAttribut & TILE_INDEX_MASK);
+            if (status & SHARED_TILES)
+            {
+                if (oldAttribut & TILE_INDEX_MASK) releaseSharedTiles(oldAttribut & TILE_INDEX_MASK);
+            }
+            else VRAM_free(&vram, oldAttribut & TILE_INDEX_MASK);
+            // remove auto vram alloc flag
+            status &= ~(SPR_FLAG_AUTO_VRAM_ALLOC | SHARED_TILES);
             // set fixed VRAM index
             newInd = value;
 
@@ -1162,6 +1852,7 @@ bool SPR_setVRAMTileIndex(Sprite* sprite, s16 value)
             {
                 // save status and return FALSE
                 sprite->status = status;
+                SET_HOT(sprite);
 
                 END_PROFIL(PROFIL_SET_VRAM_OR_SPRIND)
 
@@ -1176,6 +1867,9 @@ bool SPR_setVRAMTileIndex(Sprite* sprite, s16 value)
     if ((oldAttribut & TILE_INDEX_MASK) != (u16) newInd)
     {
         sprite->attribut = (oldAttribut & TILE_ATTR_MASK) | newInd;
+        // nothing uploaded at new location
+        sprite->lastTileset = NULL;
+        sprite->lastBaseTileset = NULL;
         // need to update sprite table
         status |= NEED_ST_ALL_UPDATE;
         // auto tile upload enabled ? --> need to re upload tile to new location
@@ -1185,6 +1879,7 @@ bool SPR_setVRAMTileIndex(Sprite* sprite, s16 value)
 
     // save status
     sprite->status = status;
+    SET_HOT(sprite);
 
     END_PROFIL(PROFIL_SET_VRAM_OR_SPRIND)
 
@@ -1202,9 +1897,21 @@ bool SPR_setSpriteTableIndex(Sprite* sprite, s16 value)
     u16 status = sprite->status;
     u16 num = sprite->definition->maxNumSprite;
 
-    if (status & SPR_FLAG_AUTO_SPRITE_ALLOC)
+#if (ENABLE_SPR_AUTO_SPRITE_ALLOC == 0)
+    if (value == -1)
     {
-        // pass to manual allocation
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("SPR_setSpriteTableIndex(..) failed: auto VDP sprite allocation is disabled in config.h");
+#endif
+        END_PROFIL(PROFIL_SET_VRAM_OR_SPRIND)
+
+        return FALSE;
+    }
+#endif
+
+    if (status & SPR_FLAG_AUTO_SPRITE_ALLOC)
+    {
+        // pass to manual allocation
         if (value != -1)
         {
             // remove auto VDP sprite alloc flag
@@ -1247,6 +1954,7 @@ bool SPR_setSpriteTableIndex(Sprite* sprite, s16 value)
             {
                 // save status and return FALSE
                 sprite->status = status;
+                SET_HOT(sprite);
 
                 END_PROFIL(PROFIL_SET_VRAM_OR_SPRIND)
 
@@ -1268,6 +1976,7 @@ bool SPR_setSpriteTableIndex(Sprite* sprite, s16 value)
 
     // save status
     sprite->status = status;
+    SET_HOT(sprite);
 
     END_PROFIL(PROFIL_SET_VRAM_OR_SPRIND)
 
@@ -1331,6 +2040,7 @@ bool SPR_isVisible(Sprite* sprite, bool recompute)
                 status = updateFrame(sprite, status);
             // then do visibility update
             sprite->status = updateVisibility(sprite, status);
+            SET_HOT(sprite);
         }
     }
 
@@ -1346,6 +2056,11 @@ void SPR_setVisibility(Sprite* sprite, SpriteVisibility value)
 
     u16 status = sprite->status;
 
+#if (ENABLE_SPR_AUTO_VISIBILITY == 0)
+    // auto visibility compiled out --> always visible
+    if ((value == AUTO_FAST) || (value == AUTO_SLOW)) value = VISIBLE;
+#endif
+
     if (status & SPR_FLAG_AUTO_VISIBILITY)
     {
         switch(value)
@@ -1400,6 +2115,7 @@ void SPR_setVisibility(Sprite* sprite, SpriteVisibility value)
 
     // update status
     sprite->status = status;
+    SET_HOT(sprite);
 
     END_PROFIL(PROFIL_SET_VISIBILITY)
 }
@@ -1424,14 +2140,16 @@ void SPR_clear()
 {
     START_PROFIL
 
-    // save starter link
-    u8 linkSave = starter->link;
+    // save reserved sprite link (starter or overlay link)
+    u8 linkSave = headSprite->link;
 
     VDP_clearSprites();
     VDP_updateSprites(1, DMA_QUEUE_COPY);
 
-    // restore starter link
-    starter->link = linkSave;
+    // restore reserved sprite link
+    headSprite->link = linkSave;
+    // so it will be restored on next SPR_update()
+    setDirtyVDPSprite(headSprite);
 
     END_PROFIL(PROFIL_CLEAR)
 }
@@ -1439,6 +2157,7 @@ void SPR_clear()
 void SPR_update()
 {
     START_PROFIL
+    PROF_begin(PROF_ZONE_SPRITE);
 
     Sprite* sprite;
 
@@ -1446,101 +2165,329 @@ void SPR_update()
     KLog_U1("----------------- SPR_update:  sprite number = ", SPR_getNumActiveSprite());
 #endif // SPR_DEBUG
 
-#ifdef SPR_DEBUG
-    KLog_U1_("  Send sprites to DMA queue: ", highestVDPSpriteIndex + 1, " sprite(s) sent");
-#endif // SPR_DEBUG
+    // reset budget usage
+    dmaUsed = 0;
+    updateStartTime = getSubTick();
+
+    // incremental VRAM defragmentation (done first so tile uploads go to new locations)
+    if (defragVRAMBudget && (!defragVRAMThreshold || (VRAM_getFragmentation(&vram) >= defragVRAMThreshold)))
+        defragVRAMStep(defragVRAMBudget);
+    // process delayed frame updates first (by priority)
+    if (numDeferredSprites) updateDeferredFrames();
+    // sprite list need to be sorted first ?
+    if (needDepthSort) sortSprites();
+    // restore normal link order if flicker scheduler rotated it
+    if (rotated) relinkSprites();
+
+#if (ENABLE_SPR_HOT_SCAN != 0)
+    // scan packed hot flags (4 sprite slots at once) so idle sprites are skipped without being dereferenced
+    u32* hot = spriteHot;
+    u16 i = HOT_SCAN_SIZE;
+
+    sprite = (Sprite*) spritesPool->bank;
+    while(i--)
+    {
+        if (*hot)
+        {
+            u8* flag = (u8*) hot;
 
-    const u16 sprNum = highestVDPSpriteIndex + 1;
-    // send sprites to VRAM using DMA queue (better to do it before sprite tiles upload to avoid being ignored by DMA queue)
-    void* vdpSpriteTableCopy = DMA_allocateAndQueueDma(DMA_VRAM, VDP_SPRITE_TABLE, (sizeof(VDPSprite) * sprNum) / 2, 2);
+            for(u16 j = 0; j < 4; j++, flag++)
+            {
+                // sprite is now idle --> clear its hot flag
+                if (*flag && !updateSprite(&sprite[j])) *flag = 0;
+            }
+        }
 
-#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-    // DMA temporary buffer is full ? --> can't do sprite update
-    if (!vdpSpriteTableCopy)
-    {
-        KLog("SPR_update(): failed... DMA data buffer is full.");
-        return;
+        hot++;
+        sprite += 4;
     }
-#endif // LIB_DEBUG
-
+#else
     // iterate over all sprites
     sprite = firstSprite;
     while(sprite)
     {
-        u16 timer = sprite->timer;
+        updateSprite(sprite);
+        // next sprite
+        sprite = sprite->next;
+    }
+#endif // ENABLE_SPR_HOT_SCAN
 
-#ifdef SPR_DEBUG
-        char str1[32];
-        char str2[8];
+    // flicker scheduler enabled ?
+    if (lineSprites)
+    {
+        // compute scanline load and get worst sprite excess
+        const u16 excess = computeLineLoad();
 
-        intToHex(sprite->visibility, str2, 4);
-        strcpy(str1, " visibility = ");
-        strcat(str1, str2);
+        // some scanlines are exceeding VDP limit ? --> rotate sprites order so dropped sprites change on each frame
+        if (excess)
+        {
+            rotation += excess;
+            rotateSprites(rotation);
+        }
+    }
+
+    // limit dirty range to allocated VDP sprites
+    const s16 dirtyMax = min(dirtyVDPSpriteMax, highestVDPSpriteIndex);
+    const s16 dirtyMin = dirtyVDPSpriteMin;
 
-        KLog_U2_("  processing sprite pos #", getSpriteIndex(sprite), " - timer = ", timer, str1);
+    // VDP sprite table modified ?
+    if (dirtyMin <= dirtyMax)
+    {
+        const u16 sprNum = (dirtyMax - dirtyMin) + 1;
+
+#ifdef SPR_DEBUG
+        KLog_U2_("  Send sprites to DMA queue: ", sprNum, " sprite(s) sent from #", dirtyMin, "");
 #endif // SPR_DEBUG
 
-        // handle frame animation
-        if (timer)
+        const u16 len = (sizeof(VDPSprite) * sprNum) / 2;
+        // reserve DMA buffer first so transfer is only queued once data is complete
+        void* vdpSpriteTableCopy = DMA_reserveQueueDma(len);
+        bool done = FALSE;
+
+        if (vdpSpriteTableCopy)
         {
-            // timer elapsed --> next frame
-            if (--timer == 0) SPR_nextFrame(sprite);
-            // just update remaining timer
-            else sprite->timer = timer;
-        }
+            // TODO: maybe prevent using SPR_xxx methods between SPR_update() and SYS_doVBlankProcess() call
+            // so we don't need to do a copy of vdpSpriteCache here
 
-        u16 status = sprite->status;
+            // VDP sprite cache is now updated, copy modified part to the temporary cache copy we got from DMA queue buffer
+            memcpy(vdpSpriteTableCopy, &vdpSpriteCache[dirtyMin], sizeof(VDPSprite) * sprNum);
+
+            // send modified sprites to VRAM using DMA queue (high priority so it always survives a queue overflow)
+            const u16 prio = DMA_setQueuePriority(DMA_PRIORITY_HIGH);
+            done = DMA_commitQueueDma(DMA_VRAM, vdpSpriteTableCopy, VDP_SPRITE_TABLE + (dirtyMin * sizeof(VDPSprite)), len, 2);
+            DMA_setQueuePriority(prio);
+
+            // failed --> release buffer
+            if (!done) DMA_releaseTemp(len);
+        }
 
-        // trivial optimization
-        if (status & NEED_UPDATE)
+        // DMA temporary buffer or queue is full ? --> keep dirty range so we retry on next update
+        if (!done)
         {
-            // ! order is important !
-            if (status & NEED_FRAME_UPDATE)
-                status = updateFrame(sprite, status);
-            if (status & NEED_VISIBILITY_UPDATE)
-                status = updateVisibility(sprite, status);
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog("SPR_update(): failed to upload sprite table... DMA data buffer or queue is full.");
+#endif // LIB_DEBUG
+        }
+        else
+        {
+            // nothing more to upload
+            dirtyVDPSpriteMin = MAX_VDP_SPRITE;
+            dirtyVDPSpriteMax = -1;
+        }
+    }
+
+    updateTime = getSubTick() - updateStartTime;
+
+    PROF_end(PROF_ZONE_SPRITE);
+    END_PROFIL(PROFIL_UPDATE)
+}
+
+u16 SPR_getUpdateTime()
+{
+    return updateTime;
+}
+
+void SPR_setOverlaySprites(s16 first, s16 last)
+{
+    // first engine sprite
+    const u8 link = starter->link;
+
+    // remove overlay
+    if (first == -1) overlayLast = headSprite;
+    else
+    {
+        // overlay sprites are inserted between reserved sprite and raw / engine sprites
+        headSprite->link = first;
+        overlayLast = &vdpSpriteCache[last];
+        setDirtyVDPSprite(headSprite);
+    }
+
+    linkHead(link);
+}
+
+bool SPR_reserveRawSprites(u16 num)
+{
+    // first engine sprite
+    const u8 link = starter->link;
+    bool result = TRUE;
+
+    // release previous reservation
+    if (numRawSprite)
+    {
+        // restore allocation links
+        for(u16 i = 0; i < (numRawSprite - 1); i++)
+            vdpSpriteCache[rawSprites[i]].link = rawSprites[i + 1];
+
+        VDP_releaseSprites(rawSprites[0], numRawSprite);
+        numRawSprite = 0;
+        numRawLinked = 0;
+    }
+
+    // previous allocations are lost
+    memset(rawUsed, 0, sizeof(rawUsed));
 
-            // sprite not visible ?
-            if (!sprite->visibility)
+    if (num)
+    {
+        s16 ind = VDP_allocateSprites(num);
+
+        if (ind == -1)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("SPR_reserveRawSprites(..) failed: not enough free VDP sprite, num = ", num);
+#endif
+            result = FALSE;
+        }
+        else
+        {
+            // store indexes in allocation link order and hide them
+            for(u16 i = 0; i < num; i++)
             {
-                // need to update its visibility (done via pos Y) ?
-                if (status & NEED_ST_POS_UPDATE)
-                {
-                    // hide sprite
-                    updateSpriteTableHide(sprite);
-                    status &= ~NEED_ST_POS_UPDATE;
-                }
+                VDPSprite* vdpSprite = &vdpSpriteCache[ind];
+
+                rawSprites[i] = ind;
+                vdpSprite->y = 0;
+                setDirtyVDPSprite(vdpSprite);
+                ind = vdpSprite->link;
             }
-            // only if sprite is visible
-            else
+
+            numRawSprite = num;
+            numRawLinked = num;
+        }
+    }
+
+    linkHead(link);
+
+    return result;
+}
+
+u16 SPR_getNumRawSprite()
+{
+    return numRawSprite;
+}
+
+void SPR_setNumLinkedRawSprite(u16 num)
+{
+    if (num > numRawSprite)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U2("SPR_setNumLinkedRawSprite(..) warning: num = ", num, " is above reserved raw sprite number = ", numRawSprite);
+#endif
+        num = numRawSprite;
+    }
+
+    if (num != numRawLinked)
+    {
+        const u8 link = starter->link;
+
+        numRawLinked = num;
+        linkHead(link);
+    }
+}
+
+s16 SPR_getRawSpriteIndex(u16 ind)
+{
+    if (ind >= numRawSprite) return -1;
+
+    return rawSprites[ind];
+}
+
+void SPR_setRawSprite(u16 ind, s16 x, s16 y, u8 size, u16 attribut)
+{
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    if (ind >= numRawSprite)
+    {
+        KLog_U2("SPR_setRawSprite(..) failed: index ", ind, " is out of reserved raw sprite range - num = ", numRawSprite);
+        return;
+    }
+#endif
+
+    VDPSprite* vdpSprite = &vdpSpriteCache[rawSprites[ind]];
+
+    // don't touch link (managed by the sprite engine)
+    vdpSprite->y = y + 0x80;
+    vdpSprite->size = size;
+    vdpSprite->attribut = attribut;
+    vdpSprite->x = x + 0x80;
+
+    setDirtyVDPSprite(vdpSprite);
+}
+
+void SPR_setRawSpritePosition(u16 ind, s16 x, s16 y)
+{
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    if (ind >= numRawSprite)
+    {
+        KLog_U2("SPR_setRawSpritePosition(..) failed: index ", ind, " is out of reserved raw sprite range - num = ", numRawSprite);
+        return;
+    }
+#endif
+
+    VDPSprite* vdpSprite = &vdpSpriteCache[rawSprites[ind]];
+
+    vdpSprite->y = y + 0x80;
+    vdpSprite->x = x + 0x80;
+
+    setDirtyVDPSprite(vdpSprite);
+}
+
+void SPR_setRawSpritesDirty(u16 ind, u16 num)
+{
+    const u16 end = min(ind + num, numRawSprite);
+
+    for(u16 i = ind; i < end; i++)
+        setDirtyVDPSprite(&vdpSpriteCache[rawSprites[i]]);
+}
+
+void SPR_hideRawSprites(u16 ind, u16 num)
+{
+    const u16 end = min(ind + num, numRawSprite);
+
+    for(u16 i = ind; i < end; i++)
+    {
+        VDPSprite* vdpSprite = &vdpSpriteCache[rawSprites[i]];
+
+        // y = 0 is above screen, x should not be 0 to avoid sprite masking
+        vdpSprite->y = 0;
+        vdpSprite->x = 1;
+        setDirtyVDPSprite(vdpSprite);
+    }
+}
+
+s16 SPR_allocateRawSprites(u16 num)
+{
+    u16 free = 0;
+
+    if (num)
+    {
+        // find first free range large enough
+        for(u16 i = 0; i < numRawSprite; i++)
+        {
+            if (rawUsed[i]) free = 0;
+            else if (++free == num)
             {
-                if (status & NEED_TILES_UPLOAD)
-                    loadTiles(sprite);
+                const u16 ind = (i + 1) - num;
 
-                if (status & NEED_ST_ALL_UPDATE)
-                    updateSpriteTableAll(sprite);
-                else if (status & NEED_ST_POS_UPDATE)
-                    updateSpriteTablePos(sprite);
+                memset(&rawUsed[ind], TRUE, num);
+                SPR_hideRawSprites(ind, num);
 
-                // tiles upload and sprite table done
-                status &= ~(NEED_TILES_UPLOAD | NEED_ST_UPDATE);
+                return ind;
             }
-
-            // processes done !
-            sprite->status = status;
         }
-
-        // next sprite
-        sprite = sprite->next;
     }
 
-    // TODO: maybe prevent using SPR_xxx methods between SPR_update() and SYS_doVBlankProcess() call
-    // so we don't need to do a copy of vdpSpriteCache here
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    KLog_U2("SPR_allocateRawSprites(..) failed: no free range of ", num, " raw sprites - reserved = ", numRawSprite);
+#endif
+
+    return -1;
+}
 
-    // VDP sprite cache is now updated, copy it to the temporary cache copy we got from DMA queue buffer
-    memcpy(vdpSpriteTableCopy, vdpSpriteCache, sizeof(VDPSprite) * sprNum);
+void SPR_releaseRawSprites(u16 ind, u16 num)
+{
+    const u16 end = min(ind + num, numRawSprite);
 
-    END_PROFIL(PROFIL_UPDATE)
+    for(u16 i = ind; i < end; i++) rawUsed[i] = FALSE;
+    SPR_hideRawSprites(ind, num);
 }
 
 
@@ -1558,6 +2505,8 @@ void SPR_logProfil()
     KLog_U2x(4, "Update visibility=", profil_time[PROFIL_UPDATE_VISIBILITY], "  Update frame=", profil_time[PROFIL_UPDATE_FRAME]);
     KLog_U2x(4, "Update vdp_spr_ind=", profil_time[PROFIL_UPDATE_VDPSPRIND], "  Update vis spr table=", profil_time[PROFIL_UPDATE_VISTABLE]);
     KLog_U2x(4, "Update Sprite Table=", profil_time[PROFIL_UPDATE_SPRITE_TABLE], " Load Tiles=", profil_time[PROFIL_LOADTILES]);
+    if (lineSprites)
+        KLog_U4("Scanline overflow frames=", lineStats.overflowFrames, " last overflow lines=", lineStats.overflowLines, " max sprites per line=", lineStats.maxSprite, " at line ", lineStats.maxLine);
 
     // reset profil counters
     memset(profil_time, 0, sizeof(profil_time));
@@ -1603,17 +2552,39 @@ static void setVDPSpriteIndex(Sprite* sprite, u16 ind, u16 num)
 //        vdpSprite->y = 0;
 //    }
 
-    // get the last vdpSprite
+    // get the last vdpSprite and allocated VDP sprites index range
+    u16 indMin = ind;
+    u16 indMax = ind;
     vdpSprite = &vdpSpriteCache[ind];
     i = num - 1;
-    while(i--) vdpSprite = &vdpSpriteCache[vdpSprite->link];
+    while(i--)
+    {
+        const u16 link = vdpSprite->link;
+
+        if (link < indMin) indMin = link;
+        else if (link > indMax) indMax = link;
+        vdpSprite = &vdpSpriteCache[link];
+    }
+
+    sprite->VDPSpriteIndexMin = indMin;
+    sprite->VDPSpriteIndexMax = indMax;
+    // links have been modified by allocation
+    setDirtyVDPSprites(indMin, indMax);
 
     // adjust VDP sprites links
     spr = sprite->prev;
     // do we have a previous sprite ? --> set its next link to current sprite index
-    if (spr) spr->lastVDPSprite->link = ind;
+    if (spr)
+    {
+        spr->lastVDPSprite->link = ind;
+        setDirtyVDPSprite(spr->lastVDPSprite);
+    }
     // othrwise we set started link
-    else starter->link = ind;
+    else
+    {
+        starter->link = ind;
+        setDirtyVDPSprite(starter);
+    }
 
     spr = sprite->next;
     // do we have a next sprite ? --> set link on next sprite
@@ -1631,90 +2602,151 @@ static void setVDPSpriteIndex(Sprite* sprite, u16 ind, u16 num)
     END_PROFIL(PROFIL_UPDATE_VDPSPRIND)
 }
 
-static u16 updateVisibility(Sprite* sprite, u16 status)
+// process animation, frame, visibility and VDP sprite table update of a sprite, return FALSE if the sprite is idle
+// (no animation timer, not following a clock and nothing left to update)
+static bool updateSprite(Sprite* sprite)
 {
-    START_PROFIL
+    const AnimationClock* clock = sprite->clock;
 
-    u16 visibility;
-    const SpriteDefinition* sprDef = sprite->definition;
+    // following an animation clock which passed to another frame ?
+    if (clock && (sprite->frameInd != (s16) clock->frameInd)) SPR_setFrame(sprite, clock->frameInd);
+
+    u16 timer = sprite->timer;
 
-    // fast visibility computation ?
-    if (status & SPR_FLAG_FAST_AUTO_VISIBILITY)
+#ifdef SPR_DEBUG
+    char str1[32];
+    char str2[8];
+
+    intToHex(sprite->visibility, str2, 4);
+    strcpy(str1, " visibility = ");
+    strcat(str1, str2);
+
+    KLog_U2_("  processing sprite pos #", getSpriteIndex(sprite), " - timer = ", timer, str1);
+#endif // SPR_DEBUG
+
+    // handle frame animation
+    if (timer)
+    {
+        // timer elapsed --> next frame
+        if (--timer == 0) SPR_nextFrame(sprite);
+        // just update remaining timer
+        else sprite->timer = timer;
+    }
+
+    u16 status = sprite->status;
+
+    // trivial optimization
+    if (status & NEED_UPDATE)
     {
-        const s16 x = sprite->x - 0x80;
+        // ! order is important !
+        if (status & NEED_FRAME_UPDATE)
+            status = updateFrame(sprite, status);
+        if (status & NEED_VISIBILITY_UPDATE)
+            status = updateVisibility(sprite, status);
 
-        // compute global visibility for sprite
-        if (((x + sprDef->w) > (s16) 0) && (x < (s16) screenWidth))
-            visibility = VISIBILITY_ON;
+        // sprite not visible ?
+        if (!sprite->visibility)
+        {
+            // need to update its visibility (done via pos Y) ?
+            if (status & NEED_ST_POS_UPDATE)
+            {
+                // hide sprite
+                updateSpriteTableHide(sprite);
+                status &= ~NEED_ST_POS_UPDATE;
+            }
+        }
+        // only if sprite is visible
         else
-            visibility = VISIBILITY_OFF;
+        {
+            if (status & NEED_TILES_UPLOAD)
+                loadTiles(sprite);
+
+            if (status & NEED_ST_ALL_UPDATE)
+                updateSpriteTableAll(sprite);
+            else if (status & NEED_ST_POS_UPDATE)
+                updateSpriteTablePos(sprite);
+
+            // tiles upload and sprite table done
+            status &= ~(NEED_TILES_UPLOAD | NEED_ST_UPDATE);
+        }
+
+        // processes done !
+        sprite->status = status;
+    }
+
+    return (sprite->clock || sprite->timer || (sprite->status & NEED_UPDATE)) ? TRUE : FALSE;
+}
+
+static u16 updateVisibility(Sprite* sprite, u16 status)
+{
+    START_PROFIL
+
+    u16 visibility;
+    const AnimationFrame* frame = sprite->frame;
+    const u16 attr = sprite->attribut;
+    // frame bounding box (flip aware) relative to screen
+    const s16 bx = (sprite->x - 0x80) + ((attr & TILE_ATTR_HFLIP_MASK) ? frame->boundsXFlip : frame->boundsX);
+    const s16 by = (sprite->y - 0x80) + ((attr & TILE_ATTR_VFLIP_MASK) ? frame->boundsYFlip : frame->boundsY);
+    const s16 bw = frame->boundsW;
+    const s16 bh = frame->boundsH;
 
 #ifdef SPR_DEBUG
-        KLog_S1("  updateVisibility (fast): global x=", x);
-        KLog_S2("    frame w=", sprDef->w, " h=", sprDef->h);
+    KLog_S2("  updateVisibility: bounds x=", bx, " y=", by);
+    KLog_S2("    bounds w=", bw, " h=", bh);
 #endif // SPR_DEBUG
-    }
+
+    // bounding box is fully outside screen ? --> set all sprite to hidden
+    if (((bx + bw) <= 0) || (bx >= (s16) screenWidth) || ((by + bh) <= 0) || (by >= (s16) screenHeight))
+        visibility = VISIBILITY_OFF;
+    // fast visibility computation or bounding box is fully horizontally inside screen ? --> set all sprite visible
+    else if ((status & SPR_FLAG_FAST_AUTO_VISIBILITY) || ((bx >= 0) && ((bx + bw) <= (s16) screenWidth)))
+        visibility = VISIBILITY_ON;
     else
     {
-        AnimationFrame* frame = sprite->frame;
-
-        // attributes
-        u16 attr = sprite->attribut;
         // xmin relative to sprite pos
         const s16 xmin = 0x80 - sprite->x;
         // xmax relative to sprite pos
         const s16 xmax = screenWidth + xmin;
-        const s16 fw = sprDef->w;
+        u16 num = frame->numSprite;
+        // start from the last one
+        const FrameVDPSprite* frameSprite = &(frame->frameVDPSprites[num]);
+        visibility = 0;
 
 #ifdef SPR_DEBUG
-        KLog_S1("  updateVisibility (slow): global x=", sprite->x);
-        KLog_S1("    frame w=", fw);
-        KLog_S2("    xmin=", xmin, " xmax=", xmax);
+        KLog_S2("  updateVisibility (slow): xmin=", xmin, " xmax=", xmax);
 #endif // SPR_DEBUG
 
-        // sprite is fully visible ? --> set all sprite visible
-        if ((xmin <= 0) && (xmax >= fw)) visibility = VISIBILITY_ON;
-        // sprite is fully hidden ? --> set all sprite to hidden
-        else if ((xmax < 0) || ((xmin - fw) > 0)) visibility = VISIBILITY_OFF;
-        else
+        if (attr & TILE_ATTR_HFLIP_MASK)
         {
-            u16 num = frame->numSprite;
-            // start from the last one
-            FrameVDPSprite* frameSprite = &(frame->frameVDPSprites[num]);
-            visibility = 0;
-
-            if (attr & TILE_ATTR_HFLIP_MASK)
+            // H flip
+            while(num--)
             {
-                // H flip
-                while(num--)
-                {
-                    // next
-                    frameSprite--;
-                    visibility <<= 1;
+                // next
+                frameSprite--;
+                visibility <<= 1;
 
-                    s16 w = ((frameSprite->size & 0x0C) << 1) + 8;
-                    s16 x = frameSprite->offsetXFlip;
+                s16 w = ((frameSprite->size & 0x0C) << 1) + 8;
+                s16 x = frameSprite->offsetXFlip;
 
-                    // compute visibility
-                    if (((x + w) > xmin) && (x < xmax))
-                        visibility |= 1;
-                }
+                // compute visibility
+                if (((x + w) > xmin) && (x < xmax))
+                    visibility |= 1;
             }
-            else
+        }
+        else
+        {
+            while(num--)
             {
-                while(num--)
-                {
-                    // next
-                    frameSprite--;
-                    visibility <<= 1;
+                // next
+                frameSprite--;
+                visibility <<= 1;
 
-                    s16 w = ((frameSprite->size & 0x0C) << 1) + 8;
-                    s16 x = frameSprite->offsetX;
+                s16 w = ((frameSprite->size & 0x0C) << 1) + 8;
+                s16 x = frameSprite->offsetX;
 
-                    // compute visibility
-                    if (((x + w) > xmin) && (x < xmax))
-                        visibility |= 1;
-                }
+                // compute visibility
+                if (((x + w) > xmin) && (x < xmax))
+                    visibility |= 1;
             }
         }
     }
@@ -1756,16 +2788,49 @@ static u16 updateFrame(Sprite* sprite, u16 status)
 
     AnimationFrame* frame = sprite->animation->frames[sprite->frameInd];
 
+    // using shared frame tiles ?
+    if (status & SHARED_TILES)
+    {
+        const u16 attr = sprite->attribut;
+        const u16 oldInd = attr & TILE_INDEX_MASK;
+        // get VRAM tiles for the new frame (upload them if needed)
+        const s16 ind = acquireSharedTiles(frame->tileset, !(status & SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE));
+
+        // can't allocate or upload now ?
+        if (ind < 0)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+            KLog_U2("Warning: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer);
+#endif // LIB_DEBUG
+
+            // initial frame update ? --> better to set frame at least
+            if (sprite->frame == NULL)
+                sprite->frame = frame;
+
+            // delay frame update (when we will have enough VRAM / DMA capacity to do it)
+            return deferFrameUpdate(sprite, status);
+        }
+
+        // release previous frame tiles (done after acquire so we keep tiles shared with previous frame)
+        if (oldInd) releaseSharedTiles(oldInd);
+        // set new VRAM index
+        sprite->attribut = (attr & TILE_ATTR_MASK) | ind;
+    }
     // we need to transfert tiles data for this sprite and frame delay is not disabled ?
-    if ((status & (SPR_FLAG_AUTO_TILE_UPLOAD | SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE)) == SPR_FLAG_AUTO_TILE_UPLOAD)
+    else if ((status & (SPR_FLAG_AUTO_TILE_UPLOAD | SPR_FLAG_DISABLE_DELAYED_FRAME_UPDATE)) == SPR_FLAG_AUTO_TILE_UPLOAD)
     {
         // not enough DMA capacity to transfer sprite tile data ?
         const u16 dmaCapacity = DMA_getMaxTransferSize();
+        const TileSet* base = sprite->animation->baseTileset;
+        u16 size = frame->tileset->numTile * 32;
 
-        if (dmaCapacity && (DMA_getQueueTransferSize() + (frame->tileset->numTile * 32)) > dmaCapacity)
+        // animation base tiles need to be uploaded too
+        if (base && (base != sprite->lastBaseTileset)) size += base->numTile * 32;
+
+        if (dmaCapacity && (DMA_getQueueTransferSize() + size) > dmaCapacity)
         {
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
-            KLog_U4_("Warning: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer, " - exceeding DMA capacity: ", DMA_getQueueTransferSize(), " bytes already queued and require ", frame->tileset->numTile * 32, " more bytes");
+            KLog_U4_("Warning: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer, " - exceeding DMA capacity: ", DMA_getQueueTransferSize(), " bytes already queued and require ", size, " more bytes");
 #endif // LIB_DEBUG
 
             // initial frame update ? --> better to set frame at least
@@ -1773,8 +2838,26 @@ static u16 updateFrame(Sprite* sprite, u16 status)
                 sprite->frame = frame;
 
             // delay frame update (when we will have enough DMA capacity to do it)
-            return status;
+            return deferFrameUpdate(sprite, status);
+        }
+
+        // SPR_update() budget exhausted ?
+        if (isOverBudget(size))
+        {
+#ifdef SPR_DEBUG
+            KLog_U3("  updateFrame: sprite #", getSpriteIndex(sprite), " update delayed on frame #", vtimer, " - SPR_update() budget exhausted, used DMA = ", dmaUsed);
+#endif // SPR_DEBUG
+
+            // initial frame update ? --> better to set frame at least
+            if (sprite->frame == NULL)
+                sprite->frame = frame;
+
+            // delay frame update (next frame with higher priority)
+            return deferFrameUpdate(sprite, status);
         }
+
+        // consume DMA budget
+        dmaUsed += size;
     }
 
     // detect if we need to hide some VDP sprite
@@ -1791,8 +2874,11 @@ static u16 updateFrame(Sprite* sprite, u16 status)
     // set frame
     sprite->frame = frame;
 
-    // init timer for this frame
-    sprite->timer = frame->timer;
+    // init timer for this frame (animation clock does the timing for sprites following it), rotation / scale variant
+    // change keeps the running timer as variants share the same frame sequence
+    if (!(status & KEEP_FRAME_TIMER) || !sprite->timer) sprite->timer = sprite->clock ? 0 : frame->timer;
+    SET_HOT(sprite);
+    status &= ~KEEP_FRAME_TIMER;
 
     // frame change event handler defined ? --> call it
     if (sprite->onFrameChange)
@@ -1803,8 +2889,8 @@ static u16 updateFrame(Sprite* sprite, u16 status)
         status = sprite->status;
     }
 
-    // require tile data upload
-    if (status & SPR_FLAG_AUTO_TILE_UPLOAD)
+    // require tile data upload (already done for shared frame tiles)
+    if ((status & (SPR_FLAG_AUTO_TILE_UPLOAD | SHARED_TILES)) == SPR_FLAG_AUTO_TILE_UPLOAD)
         status |= NEED_TILES_UPLOAD;
     // require visibility update
     if (status & SPR_FLAG_AUTO_VISIBILITY)
@@ -1823,6 +2909,9 @@ static void updateSpriteTableAll(Sprite* sprite)
 {
     START_PROFIL
 
+    // VDP sprites of this sprite will be modified
+    setDirtyVDPSprites(sprite->VDPSpriteIndexMin, sprite->VDPSpriteIndexMax);
+
     AnimationFrame* frame;
     FrameVDPSprite* frameSprite;
     VDPSprite* vdpSprite;
@@ -1911,6 +3000,9 @@ static void updateSpriteTablePos(Sprite* sprite)
 {
     START_PROFIL
 
+    // VDP sprites of this sprite will be modified
+    setDirtyVDPSprites(sprite->VDPSpriteIndexMin, sprite->VDPSpriteIndexMax);
+
     AnimationFrame* frame;
     FrameVDPSprite* frameSprite;
     VDPSprite* vdpSprite;
@@ -1992,6 +3084,9 @@ static void updateSpriteTableHide(Sprite* sprite)
 {
     START_PROFIL
 
+    // VDP sprites of this sprite will be modified
+    setDirtyVDPSprites(sprite->VDPSpriteIndexMin, sprite->VDPSpriteIndexMax);
+
     VDPSprite* vdpSprite = &vdpSpriteCache[sprite->VDPSpriteIndex];
     // don't forget to hide sprites that were used by previous frame
     s16 num = sprite->frame->numSprite;
@@ -2015,24 +3110,114 @@ static void loadTiles(Sprite* sprite)
 {
     START_PROFIL
 
-    TileSet* tileset = sprite->frame->tileset;
-    u16 compression = tileset->compression;
-    u16 lenInWord = (tileset->numTile * 32) / 2;
-
-    // TODO: separate tileset per VDP sprite and only unpack/upload visible VDP sprite (using visibility) to VRAM
+    const AnimationFrame* frame = sprite->frame;
+    const TileSet* tileset = frame->tileset;
+    const TileDelta* delta = frame->tileDelta;
+    const TileSet* base = sprite->animation->baseTileset;
+    u16 vramIndex = sprite->attribut & TILE_INDEX_MASK;
+    bool done;
 
-    // need unpacking ?
-    if (compression != COMPRESSION_NONE)
+    // animation base tiles are stored first
+    if (base)
     {
-        // get buffer and send to DMA queue
-        u8* buf = DMA_allocateAndQueueDma(DMA_VRAM, (sprite->attribut & TILE_INDEX_MASK) * 32, lenInWord, 2);
+        // not yet uploaded ? (frame tiles may have overwritten them too)
+        if (base != sprite->lastBaseTileset)
+        {
+            sprite->lastBaseTileset = loadTileSet(base, vramIndex)?base:NULL;
+            // frame tiles were at another place
+            sprite->lastTileset = NULL;
+        }
+
+        vramIndex += base->numTile;
+    }
+    else sprite->lastBaseTileset = NULL;
+
+    // previous animation frame tiles still in VRAM ? --> only upload modified tiles
+    if (delta && (delta->from == sprite->lastTileset) && (tileset->compression == COMPRESSION_NONE))
+        done = loadTileDelta(tileset, delta, vramIndex);
+    // TODO: separate tileset per VDP sprite and only unpack/upload visible VDP sprite (using visibility) to VRAM
+    else
+        done = loadTileSet(tileset, vramIndex);
+
+    // VRAM content is unknown if upload failed
+    sprite->lastTileset = done?tileset:NULL;
+
+    END_PROFIL(PROFIL_LOADTILES)
+}
+
+static bool hasBaseTiles(const SpriteDefinition* spriteDef)
+{
+    Animation** anim = spriteDef->animations;
+    u16 n = spriteDef->numAnimation;
+
+    while(n--)
+        if ((*anim++)->baseTileset) return TRUE;
+
+    return FALSE;
+}
+
+static bool loadTileDelta(const TileSet* tileset, const TileDelta* delta, u16 vramIndex)
+{
+    const u16* run = delta->runs;
+    u16 n = delta->numRun;
+    bool result = TRUE;
+
+    while(n--)
+    {
+        const u16 first = *run++;
+        const u16 num = *run++;
+
+        // queue DMA operation to transfer modified tiles to VRAM
+        if (!DMA_queueDma(DMA_VRAM, FAR_SAFE(tileset->tiles + (first * 8), num * 32), (vramIndex + first) * 32, num * 16, 2))
+            result = FALSE;
+    }
+
+#ifdef SPR_DEBUG
+    KLog_U2("  loadTiles - tiles delta: numRun=", delta->numRun, " to=", vramIndex * 32);
+#endif // SPR_DEBUG
+
+    return result;
+}
+
+static bool loadTileSet(const TileSet* tileset, u16 vramIndex)
+{
+    u16 compression = tileset->compression;
+    u16 lenInWord = (tileset->numTile * 32) / 2;
+
+    // need unpacking ?
+    if (compression != COMPRESSION_NONE)
+    {
+        PrefetchSlot* slot = getPrefetchSlot(tileset);
+
+        // tiles already unpacked by SPR_prefetchFrames() ? --> transfer them directly
+        if (slot)
+        {
+            slot->time = vtimer;
+            slot->used = TRUE;
+            const bool result = DMA_queueDma(DMA_VRAM, slot->buffer, vramIndex * 32, lenInWord, 2);
+            // buffer can't be reused until the transfer is done (even if delayed), retried later if queue is full
+            slot->fence = DMA_queueFence(NULL);
+
+#ifdef SPR_DEBUG
+            KLog_U2("  loadTiles: use prefetched tileset, numTile= ", tileset->numTile, " to=", vramIndex * 32);
+#endif // SPR_DEBUG
+
+            return result;
+        }
+
+        // get buffer and send to DMA queue
+        u8* buf = DMA_allocateAndQueueDma(DMA_VRAM, vramIndex * 32, lenInWord, 2);
 
+        if (!buf)
+        {
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
-        if (!buf) KLog("  loadTiles: unpack tileset failed (DMA temporary buffer is full)");
-        else
+            KLog("  loadTiles: unpack tileset failed (DMA temporary buffer is full)");
 #endif
-            // unpack in temp buffer obtained from DMA queue
-            unpack(compression, (u8*) FAR_SAFE(tileset->tiles, tileset->numTile * 32), buf);
+            return FALSE;
+        }
+
+        // unpack in temp buffer obtained from DMA queue
+        unpack(compression, (u8*) FAR_SAFE(tileset->tiles, tileset->numTile * 32), buf);
 
 #ifdef SPR_DEBUG
         char str1[32];
@@ -2043,20 +3228,266 @@ static void loadTiles(Sprite* sprite)
         strcat(str1, str2);
 
         KLog_U1_("  loadTiles: unpack tileset, numTile= ", tileset->numTile, str1);
-        KLog_U2("    Queue DMA: to=", (sprite->attribut & TILE_INDEX_MASK) * 32, " size in word=", lenInWord);
+        KLog_U2("    Queue DMA: to=", vramIndex * 32, " size in word=", lenInWord);
 #endif // SPR_DEBUG
+
+        return TRUE;
     }
-    else
+
+    // just queue DMA operation to transfer tileset data to VRAM
+    const bool result = DMA_queueDma(DMA_VRAM, FAR_SAFE(tileset->tiles, tileset->numTile * 32), vramIndex * 32, lenInWord, 2);
+
+#ifdef SPR_DEBUG
+    KLog_U3("  loadTiles - queue DMA: from=", (u32) tileset->tiles, " to=", vramIndex * 32, " size in word=", lenInWord);
+#endif // SPR_DEBUG
+
+    return result;
+}
+
+bool SPR_setFramePrefetch(u16 numSlot, u16 slotSize)
+{
+    // release previous slots
+    releasePrefetchSlots();
+
+    // disable prefetch ?
+    if (!numSlot || !slotSize) return TRUE;
+
+    prefetchSlots = MEM_alloc(numSlot * sizeof(PrefetchSlot));
+    if (!prefetchSlots)
     {
-        // just queue DMA operation to transfer tileset data to VRAM
-        DMA_queueDma(DMA_VRAM, FAR_SAFE(tileset->tiles, tileset->numTile * 32), (sprite->attribut & TILE_INDEX_MASK) * 32, lenInWord, 2);
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("SPR_setFramePrefetch(): failed - not enough memory !");
+#endif // LIB_DEBUG
+
+        return FALSE;
+    }
+
+    // clear slots so partial allocation can be released on failure
+    memset(prefetchSlots, 0, numSlot * sizeof(PrefetchSlot));
+    numPrefetchSlot = numSlot;
+    prefetchSlotSize = slotSize;
+
+    for(u16 i = 0; i < numSlot; i++)
+    {
+        u8* buf = MEM_alloc(slotSize * 32);
+
+        if (!buf)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog("SPR_setFramePrefetch(): failed - not enough memory !");
+#endif // LIB_DEBUG
+
+            releasePrefetchSlots();
+            return FALSE;
+        }
+
+        prefetchSlots[i].buffer = buf;
+    }
+
+    return TRUE;
+}
+
+u16 SPR_prefetchFrames()
+{
+    Sprite* sprite;
+    u16 result = 0;
+
+    // prefetch not enabled
+    if (!numPrefetchSlot) return 0;
+
+    sprite = firstSprite;
+    while(sprite)
+    {
+        const Animation* anim = sprite->animation;
+
+        // animated sprite doing its own tile upload ?
+        if (anim && sprite->timer && (sprite->status & SPR_FLAG_AUTO_TILE_UPLOAD))
+        {
+            u16 frameInd;
+
+            if (anim->steps) frameInd = anim->steps[sprite->frameInd].next;
+            else
+            {
+                frameInd = sprite->frameInd + 1;
+                if (frameInd >= anim->numFrame) frameInd = anim->loop;
+            }
+
+            const TileSet* tileset = anim->frames[frameInd]->tileset;
+
+            // compressed tileset fitting in a slot and not yet prefetched ?
+            if (tileset && (tileset->compression != COMPRESSION_NONE) && (tileset->numTile <= prefetchSlotSize) && !getPrefetchSlot(tileset))
+            {
+                PrefetchSlot* slot = getFreePrefetchSlot();
+
+                // no more free slot
+                if (!slot) break;
+
+                // invalidate slot while unpacking (tileset pointer is set last)
+                slot->tileset = NULL;
+                unpack(tileset->compression, (u8*) FAR_SAFE(tileset->tiles, tileset->numTile * 32), slot->buffer);
+                slot->time = vtimer;
+                slot->used = FALSE;
+                slot->tileset = tileset;
 
 #ifdef SPR_DEBUG
-        KLog_U3("  loadTiles - queue DMA: from=", (u32) tileset->tiles, " to=", (sprite->attribut & TILE_INDEX_MASK) * 32, " size in word=", lenInWord);
+                KLog_U2("SPR_prefetchFrames: sprite #", getSpriteIndex(sprite), " prefetched frame ", frameInd);
 #endif // SPR_DEBUG
+
+                result++;
+            }
+        }
+
+        // next sprite
+        sprite = sprite->next;
     }
 
-    END_PROFIL(PROFIL_LOADTILES)
+    return result;
+}
+
+static void releasePrefetchSlots()
+{
+    if (prefetchSlots)
+    {
+        for(u16 i = 0; i < numPrefetchSlot; i++)
+        {
+            if (prefetchSlots[i].buffer) MEM_free(prefetchSlots[i].buffer);
+        }
+
+        MEM_free(prefetchSlots);
+        prefetchSlots = NULL;
+    }
+
+    numPrefetchSlot = 0;
+}
+
+static PrefetchSlot* getPrefetchSlot(const TileSet* tileset)
+{
+    PrefetchSlot* slot = prefetchSlots;
+    u16 i = numPrefetchSlot;
+
+    while(i--)
+    {
+        if (slot->tileset == tileset) return slot;
+        slot++;
+    }
+
+    return NULL;
+}
+
+static PrefetchSlot* getFreePrefetchSlot()
+{
+    PrefetchSlot* slot = prefetchSlots;
+    PrefetchSlot* result = NULL;
+    const u32 time = vtimer;
+    u16 i = numPrefetchSlot;
+
+    while(i--)
+    {
+        // empty slot --> use it
+        if (!slot->tileset) return slot;
+
+        // used slot no more referenced by DMA queue or unused slot timed out ? --> can be reused
+        if (slot->used)
+        {
+            // fence couldn't be queued (queue was full) ? --> queue it now, it still follows the buffer transfer
+            if (!slot->fence) slot->fence = DMA_queueFence(NULL);
+            else if (DMA_isFenceDone(slot->fence)) result = slot;
+        }
+        else if ((time - slot->time) >= PREFETCH_TIMEOUT) result = slot;
+
+        slot++;
+    }
+
+    return result;
+}
+
+static s16 acquireSharedTiles(const TileSet* tileset, bool delayed)
+{
+    SharedTiles* entry = sharedTiles;
+    u16 i = numSharedTiles;
+
+    // already in cache ? --> just add a reference
+    while(i--)
+    {
+        if (entry->tileset == tileset)
+        {
+            entry->refCount++;
+            return entry->vramIndex;
+        }
+
+        entry++;
+    }
+
+    // cache full (should not happen) --> error
+    if (numSharedTiles >= MAX_SHARED_TILES)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("acquireSharedTiles(): failed - shared frame tiles cache is full - num entry = ", numSharedTiles);
+#endif
+
+        return -1;
+    }
+
+    const u16 numTile = tileset->numTile;
+
+    // delayed frame update allowed and not enough DMA capacity to upload tiles now ? --> retry later
+    if (delayed)
+    {
+        const u16 dmaCapacity = DMA_getMaxTransferSize();
+
+        if (dmaCapacity && ((DMA_getQueueTransferSize() + (numTile * 32)) > dmaCapacity))
+            return -1;
+    }
+
+    // allocate VRAM for this tileset
+    const s16 ind = VRAM_alloc(&vram, numTile);
+
+    if (ind < 0)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("acquireSharedTiles(): failed to allocate VRAM for shared frame tiles - num tile = ", numTile);
+#endif
+
+        return -1;
+    }
+
+    // create new entry
+    entry = &sharedTiles[numSharedTiles++];
+    entry->tileset = tileset;
+    entry->vramIndex = ind;
+    entry->refCount = 1;
+
+    // upload tiles
+    loadTileSet(tileset, ind);
+
+    return ind;
+}
+
+static void releaseSharedTiles(u16 vramIndex)
+{
+    SharedTiles* entry = sharedTiles;
+    u16 i = numSharedTiles;
+
+    while(i--)
+    {
+        if (entry->vramIndex == vramIndex)
+        {
+            // last reference ? --> release VRAM and remove entry (replace by last one)
+            if (--entry->refCount == 0)
+            {
+                VRAM_free(&vram, vramIndex);
+                *entry = sharedTiles[--numSharedTiles];
+            }
+
+            return;
+        }
+
+        entry++;
+    }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    KLog_U1("releaseSharedTiles(): error - no shared frame tiles found at VRAM index ", vramIndex);
+#endif
 }
 
 static Sprite* sortSprite(Sprite* sprite)
@@ -2099,6 +3530,243 @@ static Sprite* sortSprite(Sprite* sprite)
     return prev;
 }
 
+static void sortSprites()
+{
+    START_PROFIL
+
+    Sprite* heads[16];
+    Sprite* tails[16];
+    Sprite* s;
+    Sprite* prev;
+    u16 keyAnd;
+    u16 keyOr;
+    u16 sft;
+
+    needDepthSort = FALSE;
+
+    // first pass: check if list is already sorted and get key bits in use
+    keyAnd = 0xFFFF;
+    keyOr = 0;
+    bool sorted = TRUE;
+    s = firstSprite;
+    prev = NULL;
+    while(s)
+    {
+        // use unsigned key (0x8000 bias) so negative depth are correctly ordered
+        const u16 key = s->depth ^ 0x8000;
+
+        keyAnd &= key;
+        keyOr |= key;
+        if (prev && (prev->depth > s->depth)) sorted = FALSE;
+
+        prev = s;
+        s = s->next;
+    }
+
+    // already sorted --> nothing to do
+    if (sorted)
+    {
+        END_PROFIL(PROFIL_SORT)
+        return;
+    }
+
+#ifdef SPR_DEBUG
+    KLog_U1("sortSprites: sorting sprite list, num sprite = ", SPR_getNumActiveSprite());
+#endif // SPR_DEBUG
+
+    // only bits which are different between sprites matter
+    const u16 keyDiff = keyAnd ^ keyOr;
+
+    // LSD radix sort (4 bits per pass) using bucket lists, stable so equal depth keep their current order
+    for(sft = 0; sft < 16; sft += 4)
+    {
+        // all sprites have same digit for this pass --> skip it
+        if (!((keyDiff >> sft) & 0xF)) continue;
+
+        memset(heads, 0, sizeof(heads));
+
+        // distribute sprites in buckets
+        s = firstSprite;
+        while(s)
+        {
+            Sprite* next = s->next;
+            const u16 digit = ((s->depth ^ 0x8000) >> sft) & 0xF;
+
+            s->next = NULL;
+            if (heads[digit]) tails[digit]->next = s;
+            else heads[digit] = s;
+            tails[digit] = s;
+
+            s = next;
+        }
+
+        // concatenate buckets
+        Sprite** link = &firstSprite;
+        for(u16 i = 0; i < 16; i++)
+        {
+            if (heads[i])
+            {
+                *link = heads[i];
+                link = &(tails[i]->next);
+            }
+        }
+    }
+
+    // rebuild backward links and VDP sprite links
+    relinkSprites();
+
+    END_PROFIL(PROFIL_SORT)
+}
+
+static void relinkSprites()
+{
+    VDPSprite* lastVDPSprite = starter;
+    Sprite* prev = NULL;
+    Sprite* s = firstSprite;
+
+    // rebuild backward links and VDP sprite links (only modified links are marked dirty)
+    while(s)
+    {
+        const u16 ind = s->VDPSpriteIndex;
+
+        s->prev = prev;
+        if (lastVDPSprite->link != ind)
+        {
+            lastVDPSprite->link = ind;
+            setDirtyVDPSprite(lastVDPSprite);
+        }
+        lastVDPSprite = s->lastVDPSprite;
+
+        prev = s;
+        s = s->next;
+    }
+    if (lastVDPSprite->link != 0)
+    {
+        lastVDPSprite->link = 0;
+        setDirtyVDPSprite(lastVDPSprite);
+    }
+    lastSprite = prev;
+
+    rotated = FALSE;
+}
+
+static u16 computeLineLoad()
+{
+    u8* const ls = lineSprites;
+    s16* const lp = linePixels;
+    const u16 h = screenHeight;
+    // VDP limits
+    const u16 maxSpr = (screenWidth == 320) ? 20 : 16;
+    const u16 maxPix = screenWidth;
+    u16 i;
+
+    // clear delta tables
+    memset(ls, 0, h + 1);
+    memset(lp, 0, (h + 1) * sizeof(s16));
+
+    // iterate over hardware sprites in link order (as the VDP does)
+    VDPSprite* vdpSprite = starter;
+    i = MAX_VDP_SPRITE;
+    while(vdpSprite->link && i--)
+    {
+        vdpSprite = &vdpSpriteCache[vdpSprite->link];
+
+        const u16 size = vdpSprite->size;
+        s16 top = vdpSprite->y - 0x80;
+        s16 bottom = top + ((size & 0x03) << 3) + 8;
+
+        // not on screen
+        if ((bottom <= 0) || (top >= (s16) h)) continue;
+        // clip
+        if (top < 0) top = 0;
+        if (bottom > (s16) h) bottom = h;
+
+        const s16 w = ((size & 0x0C) << 1) + 8;
+
+        // store as delta (line count is accumulated later)
+        ls[top]++;
+        ls[bottom]--;
+        lp[top] += w;
+        lp[bottom] -= w;
+    }
+
+    u16 overflowLines = 0;
+    u16 maxSprite = 0;
+    u16 maxPixel = 0;
+    u16 maxLine = 0;
+    u16 excess = 0;
+    u8 numSpr = 0;
+    s16 numPix = 0;
+
+    // accumulate and check limits
+    for(i = 0; i < h; i++)
+    {
+        numSpr += ls[i];
+        numPix += lp[i];
+        ls[i] = numSpr;
+
+        if (numSpr > maxSprite)
+        {
+            maxSprite = numSpr;
+            maxLine = i;
+        }
+        if ((u16) numPix > maxPixel) maxPixel = numPix;
+
+        if ((numSpr > maxSpr) || ((u16) numPix > maxPix))
+        {
+            overflowLines++;
+            // keep trace of worst number of sprites above the limit (at least 1)
+            if ((numSpr > maxSpr) && ((numSpr - maxSpr) > excess)) excess = numSpr - maxSpr;
+            else if (!excess) excess = 1;
+        }
+    }
+
+    lineStats.overflowLines = overflowLines;
+    lineStats.maxSprite = maxSprite;
+    lineStats.maxPixel = maxPixel;
+    lineStats.maxLine = maxLine;
+    lineStats.lineSprites = ls;
+    if (overflowLines) lineStats.overflowFrames++;
+
+    return excess;
+}
+
+static void rotateSprites(u16 num)
+{
+    const u16 numSprite = SPR_getNumActiveSprite();
+
+    // nothing to rotate
+    if (numSprite < 2) return;
+
+    num %= numSprite;
+    if (num == 0) return;
+
+    // find new first sprite
+    Sprite* prev = firstSprite;
+    while(--num) prev = prev->next;
+    Sprite* first = prev->next;
+
+    // link order becomes: first -> ... -> lastSprite -> firstSprite -> ... -> prev (Sprite list itself is unchanged)
+    starter->link = first->VDPSpriteIndex;
+    lastSprite->lastVDPSprite->link = firstSprite->VDPSpriteIndex;
+    prev->lastVDPSprite->link = 0;
+
+    setDirtyVDPSprite(starter);
+    setDirtyVDPSprite(lastSprite->lastVDPSprite);
+    setDirtyVDPSprite(prev->lastVDPSprite);
+
+    rotated = TRUE;
+}
+
+bool SPR_getLineStats(SpriteLineStats* stats)
+{
+    if (!lineSprites) return FALSE;
+
+    *stats = lineStats;
+
+    return TRUE;
+}
+
 static void moveAfter(Sprite* pos, Sprite* sprite)
 {
     Sprite* prev = sprite->prev;
@@ -2112,6 +3780,9 @@ static void moveAfter(Sprite* pos, Sprite* sprite)
     // we first remove the sprite from its current position
     if (prev)
     {
+        // previous sprite link will be modified
+        setDirtyVDPSprite(prev->lastVDPSprite);
+
         prev->next = next;
         if (next)
         {
@@ -2128,6 +3799,9 @@ static void moveAfter(Sprite* pos, Sprite* sprite)
     }
     else
     {
+        // starter link will be modified
+        setDirtyVDPSprite(starter);
+
         // 'next' become the first sprite
         firstSprite = next;
         if (next)
@@ -2157,6 +3831,7 @@ static void moveAfter(Sprite* pos, Sprite* sprite)
         // fix sprite link
         sprite->lastVDPSprite->link = pos->lastVDPSprite->link;
         pos->lastVDPSprite->link = sprite->VDPSpriteIndex;
+        setDirtyVDPSprite(pos->lastVDPSprite);
     }
     // or we insert before 'firstSprite' (become the new first sprite)
     else
@@ -2172,7 +3847,55 @@ static void moveAfter(Sprite* pos, Sprite* sprite)
         // fix sprite link
         sprite->lastVDPSprite->link = starter->link;
         starter->link = sprite->VDPSpriteIndex;
+        setDirtyVDPSprite(starter);
     }
+
+    // sprite link was modified
+    setDirtyVDPSprite(sprite->lastVDPSprite);
+}
+
+static void setDirtyVDPSprites(u16 min, u16 max)
+{
+    if ((s16) min < dirtyVDPSpriteMin) dirtyVDPSpriteMin = min;
+    if ((s16) max > dirtyVDPSpriteMax) dirtyVDPSpriteMax = max;
+}
+
+// rebuild overlay --> raw sprites --> engine sprites link chain (<i>link</i> = first engine sprite) and update starter
+static void linkHead(u8 link)
+{
+    VDPSprite* last = overlayLast;
+
+    if (numRawLinked)
+    {
+        last->link = rawSprites[0];
+        setDirtyVDPSprite(last);
+
+        last = &vdpSpriteCache[rawSprites[0]];
+        for(u16 i = 1; i < numRawLinked; i++)
+        {
+            const u8 next = rawSprites[i];
+
+            // only modified links are marked dirty
+            if (last->link != next)
+            {
+                last->link = next;
+                setDirtyVDPSprite(last);
+            }
+            last = &vdpSpriteCache[next];
+        }
+    }
+
+    // last sprite before engine sprites
+    starter = last;
+    starter->link = link;
+    setDirtyVDPSprite(starter);
+}
+
+static void setDirtyVDPSprite(VDPSprite* vdpSprite)
+{
+    const u16 ind = vdpSprite - vdpSpriteCache;
+
+    setDirtyVDPSprites(ind, ind);
 }
 
 static u16 getSpriteIndex(Sprite* sprite)
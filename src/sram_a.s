@@ -39,3 +39,125 @@ func SRAM_writeLong
     lea     (%a0,%d1.l),%a0
     movep.l %d0,0(%a0)
     rts
+
+// extern void SRAM_read(u32 offset, void* dst, u16 len);
+func SRAM_read
+    move.l  %d2,-(%sp)
+
+    move.l  8(%sp),%d0
+    add.l   %d0,%d0
+    lea     0x200001,%a0
+    lea     (%a0,%d0.l),%a0         // a0 = SRAM address
+    move.l  12(%sp),%a1             // a1 = destination
+    move.l  16(%sp),%d1             // d1 = len (values on stack are always long)
+
+    move.w  %a1,%d0
+    btst    #0,%d0
+    bne.s   .sram_read_byte         // odd destination --> byte copy only
+
+    move.w  %d1,%d0
+    lsr.w   #4,%d0                  // d0 = number of 16 bytes block
+    beq.s   .sram_read_long_init
+    subq.w  #1,%d0
+
+.sram_read_block:
+    movep.l 0(%a0),%d2
+    move.l  %d2,(%a1)+
+    movep.l 8(%a0),%d2
+    move.l  %d2,(%a1)+
+    movep.l 16(%a0),%d2
+    move.l  %d2,(%a1)+
+    movep.l 24(%a0),%d2
+    move.l  %d2,(%a1)+
+    lea     32(%a0),%a0
+    dbra    %d0,.sram_read_block
+
+.sram_read_long_init:
+    moveq   #12,%d0
+    and.w   %d1,%d0
+    lsr.w   #2,%d0                  // d0 = number of remaining long
+    beq.s   .sram_read_byte_init
+    subq.w  #1,%d0
+
+.sram_read_long:
+    movep.l 0(%a0),%d2
+    move.l  %d2,(%a1)+
+    addq.l  #8,%a0
+    dbra    %d0,.sram_read_long
+
+.sram_read_byte_init:
+    and.w   #3,%d1                  // d1 = number of remaining byte
+
+.sram_read_byte:
+    subq.w  #1,%d1
+    bcs.s   .sram_read_end
+
+.sram_read_byte_loop:
+    move.b  (%a0),(%a1)+
+    addq.l  #2,%a0
+    dbra    %d1,.sram_read_byte_loop
+
+.sram_read_end:
+    move.l  (%sp)+,%d2
+    rts
+
+// extern void SRAM_write(u32 offset, const void* src, u16 len);
+func SRAM_write
+    move.l  %d2,-(%sp)
+
+    move.l  8(%sp),%d0
+    add.l   %d0,%d0
+    lea     0x200001,%a0
+    lea     (%a0,%d0.l),%a0         // a0 = SRAM address
+    move.l  12(%sp),%a1             // a1 = source
+    move.l  16(%sp),%d1             // d1 = len (values on stack are always long)
+
+    move.w  %a1,%d0
+    btst    #0,%d0
+    bne.s   .sram_write_byte        // odd source --> byte copy only
+
+    move.w  %d1,%d0
+    lsr.w   #4,%d0                  // d0 = number of 16 bytes block
+    beq.s   .sram_write_long_init
+    subq.w  #1,%d0
+
+.sram_write_block:
+    move.l  (%a1)+,%d2
+    movep.l %d2,0(%a0)
+    move.l  (%a1)+,%d2
+    movep.l %d2,8(%a0)
+    move.l  (%a1)+,%d2
+    movep.l %d2,16(%a0)
+    move.l  (%a1)+,%d2
+    movep.l %d2,24(%a0)
+    lea     32(%a0),%a0
+    dbra    %d0,.sram_write_block
+
+.sram_write_long_init:
+    moveq   #12,%d0
+    and.w   %d1,%d0
+    lsr.w   #2,%d0                  // d0 = number of remaining long
+    beq.s   .sram_write_byte_init
+    subq.w  #1,%d0
+
+.sram_write_long:
+    move.l  (%a1)+,%d2
+    movep.l %d2,0(%a0)
+    addq.l  #8,%a0
+    dbra    %d0,.sram_write_long
+
+.sram_write_byte_init:
+    and.w   #3,%d1                  // d1 = number of remaining byte
+
+.sram_write_byte:
+    subq.w  #1,%d1
+    bcs.s   .sram_write_end
+
+.sram_write_byte_loop:
+    move.b  (%a1)+,(%a0)
+    addq.l  #2,%a0
+    dbra    %d1,.sram_write_byte_loop
+
+.sram_write_end:
+    move.l  (%sp)+,%d2
+    rts
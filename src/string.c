@@ -32,7 +32,6 @@ static const char digits[] =
 
 // FORWARD
 static u16 digits10(const u16 v);
-static u16 uint16ToStr(u16 value, char *str, u16 minsize);
 #if (ENABLE_NEWLIB == 0)
 static u16 skip_atoi(const char **s);
 #endif  // ENABLE_NEWLIB
@@ -183,8 +182,10 @@ u16 uintToStr(u32 value, char *str, u16 minsize)
     // need to split in 2 conversions ?
     if (value > 10000)
     {
-        const u16 v1 = value / (u16) 10000;
-        const u16 v2 = value % (u16) 10000;
+        // quotient always fit in 16 bit here so a single divu instruction is enough
+        const u32 qr = divmodu(value, 10000);
+        const u16 v1 = qr;
+        const u16 v2 = qr >> 16;
 
         len = uint16ToStr(v1, str, (minsize > 4)?(minsize - 4):1);
         len += uint16ToStr(v2, str + len, 4);
@@ -194,7 +195,7 @@ u16 uintToStr(u32 value, char *str, u16 minsize)
     return len;
 }
 
-static u16 uint16ToStr(u16 value, char *str, u16 minsize)
+u16 uint16ToStr(u16 value, char *str, u16 minsize)
 {
     u16 length;
     char *dst;
@@ -208,11 +209,11 @@ static u16 uint16ToStr(u16 value, char *str, u16 minsize)
 
     while (v >= 100)
     {
-        const u16 quot = v / 100;
-        const u16 remain = v % 100;
+        // quotient and remainder from a single divu instruction
+        const u32 qr = divmodu(v, 100);
+        const u16 i = (qr >> 16) * 2;
 
-        const u16 i = remain * 2;
-        v = quot;
+        v = qr;
 
         *--dst = digits[i + 1];
         *--dst = digits[i + 0];
@@ -277,6 +278,11 @@ u16 intToHex(u32 value, char *str, u16 minsize)
 }
 
 void fix32ToStr(fix32 value, char *str, u16 numdec)
+{
+    strPutFix32(str, value, numdec);
+}
+
+char* strPutFix32(char *str, fix32 value, u16 numdec)
 {
     char *dst = str;
     fix32 v = value;
@@ -299,13 +305,21 @@ void fix32ToStr(fix32 value, char *str, u16 numdec)
         // need to add ending '0'
         dst += len;
         while(len++ < numdec) *dst++ = '0';
-        // mark end here
-        *dst = 0;
     }
-    else dst[numdec] = 0;
+    else dst += numdec;
+
+    // mark end here
+    *dst = 0;
+
+    return dst;
 }
 
 void fix16ToStr(fix16 value, char *str, u16 numdec)
+{
+    strPutFix16(str, value, numdec);
+}
+
+char* strPutFix16(char *str, fix16 value, u16 numdec)
 {
     char *dst = str;
     fix16 v = value;
@@ -328,10 +342,47 @@ void fix16ToStr(fix16 value, char *str, u16 numdec)
         // need to add ending '0'
         dst += len;
         while(len++ < numdec) *dst++ = '0';
-        // mark end here
-        *dst = 0;
     }
-    else dst[numdec] = 0;
+    else dst += numdec;
+
+    // mark end here
+    *dst = 0;
+
+    return dst;
+}
+
+char* strPutMem(char *dst, const char *src, u16 len)
+{
+    while(len--) *dst++ = *src++;
+
+    return dst;
+}
+
+char* strPutStr(char *dst, const char *src)
+{
+    while((*dst = *src++)) dst++;
+
+    return dst;
+}
+
+char* strPutInt(char *dst, s32 value, u16 minsize)
+{
+    return dst + intToStr(value, dst, minsize);
+}
+
+char* strPutUInt(char *dst, u32 value, u16 minsize)
+{
+    return dst + uintToStr(value, dst, minsize);
+}
+
+char* strPutUInt16(char *dst, u16 value, u16 minsize)
+{
+    return dst + uint16ToStr(value, dst, minsize);
+}
+
+char* strPutHex(char *dst, u32 value, u16 minsize)
+{
+    return dst + intToHex(value, dst, minsize);
 }
 
 
@@ -351,6 +402,28 @@ static u16 digits10(const u16 v)
 }
 
 #if (ENABLE_NEWLIB == 0)
+// convert to decimal in tmp (at least 12 bytes) and return the string start
+static char* uintToDec(u32 value, char *tmp)
+{
+    // fast path: digit pairs and 16 bit divisions only
+    if (value <= 500000000)
+    {
+        uintToStr(value, tmp, 1);
+        return tmp;
+    }
+
+    char *s = &tmp[12];
+
+    *--s = 0;
+    while(value)
+    {
+        *--s = (value % 10) + 0x30;
+        value /= 10;
+    }
+
+    return s;
+}
+
 static u16 skip_atoi(const char **s)
 {
     u16 i = 0;
@@ -530,52 +603,17 @@ hexa_conv:
             continue;
 
         case 'u':
-            s = &tmp_buffer[12];
-            *--s = 0;
-            num = va_arg(args, u32);
-
-            if (!num)
-                *--s = '0';
-
-            while(num)
-            {
-                *--s = (num % 10) + 0x30;
-                num /= 10;
-            }
-
+            s = uintToDec(va_arg(args, u32), tmp_buffer);
             num = plus_sign = 0;
 
             break;
 
         case 'd':
         case 'i':
-            s = &tmp_buffer[12];
-            *--s = 0;
             i = va_arg(args, s32);
-
-            if (!i)
-                *--s = '0';
-
-            if (i < 0)
-            {
-                num = 1;
-
-                while(i)
-                {
-                    *--s = 0x30 - (i % 10);
-                    i /= 10;
-                }
-            }
-            else
-            {
-                num = 0;
-
-                while(i)
-                {
-                    *--s = (i % 10) + 0x30;
-                    i /= 10;
-                }
-            }
+            // num = negative flag
+            num = (i < 0);
+            s = uintToDec(num?-((u32) i):(u32) i, tmp_buffer);
 
             break;
 
@@ -21,6 +21,10 @@
 #include "dma.h"
 #include "sram.h"
 #include "sprite_eng.h"
+#include "arena.h"
+#include "profiler.h"
+#include "trace.h"
+#include "job.h"
 
 #include "tools.h"
 #include "kdebug.h"
@@ -64,8 +68,26 @@ extern u16 lastVCnt;
 // extern library callback function (we don't want to share them)
 extern void BMP_doVBlankProcess();
 extern void XGM_doVBlankProcess();
+extern void XGM_waitFrameProcessed(u16 maxSubTick);
+extern bool XGM_isHeavyFramePending();
+extern bool XGM_doStreamProcess();
+extern bool PSGSFX_doVBlankProcess();
+extern void PROF_init();
+extern void TRACE_init();
+#if (ENABLE_TRACE != 0)
+extern VoidCallback* traceHIntCB;
+extern void _hint_trace_caller();
+#endif
 extern bool MAP_doVBlankProcess();
 extern bool VDP_doVBlankScrollProcess();
+extern void PAL_doVBlankProcess();
+extern bool PAL_doFadeChannelStep();
+extern bool RASTER_doVBlankProcess();
+extern void VDP_doVBlankRegProcess();
+extern void BANK_init();
+extern void BANK_doVBlankProcess();
+
+extern u32 computeChecksumBlock(const u32* src, u16 num, u32 chk);
 
 // we don't want to share that method
 extern void MEM_init();
@@ -99,6 +121,14 @@ __attribute__((externally_visible)) VoidCallback *eintCB;
 // user VBlank callbacks
 VoidCallback *vblankCB;
 
+// V-Int and VBlank handler chains (single user callbacks are stored apart)
+static IntHandler vintHandlers[SYS_MAX_INT_HANDLER];
+static IntHandler vblankHandlers[SYS_MAX_INT_HANDLER];
+static u16 numVIntHandler;
+static u16 numVBlankHandler;
+static VoidCallback *userVIntCB;
+static VoidCallback *userVBlankCB;
+
 // exception state consumes 78 bytes of memory
 __attribute__((externally_visible)) u32 registerState[8+8];
 __attribute__((externally_visible)) u32 pcState;
@@ -122,6 +152,19 @@ static u16 cpuFrameLoad;
 static u32 frameCnt;
 static u32 lastSubTick;
 
+// frame pacing
+static u32 missedFrames;
+static u32 pacingFrame;
+static u16 pacingMaxTick;
+
+// background checksum verification
+static u32 chkAdr;
+static u32 chkValue;
+static u32 chkStep;
+static u16 chkCost;
+static u16 chkState = CHECKSUM_CHECK_NONE;
+static bool chkQueued = FALSE;
+
 
 static void addValueU8(char *dst, char *str, u8 value)
 {
@@ -300,11 +343,144 @@ static u16 showBusAddressErrorDump(u16 pos)
     return y;
 }
 
+#if (ENABLE_CRASH_DUMP != 0)
+
+static u16 dumpOffset;
+static u16 dumpChecksum;
+
+static void dumpU8(u8 value)
+{
+    SRAM_writeByte(CRASH_DUMP_SRAM_OFFSET + dumpOffset++, value);
+    dumpChecksum += value;
+}
+
+static void dumpU16(u16 value)
+{
+    dumpU8(value >> 8);
+    dumpU8(value);
+}
+
+static void dumpU32(u32 value)
+{
+    dumpU16(value >> 16);
+    dumpU16(value);
+}
+
+// write dump length and checksum so the dump is valid up to current offset
+static void commitCrashDump()
+{
+    const u16 sum = dumpChecksum;
+    const u16 len = dumpOffset;
+
+    // header isn't part of the checksum
+    dumpOffset = 6;
+    dumpU16(len);
+    dumpU16(sum);
+    dumpOffset = len;
+    dumpChecksum = sum;
+}
+
+static void saveCrashDump(u16 type)
+{
+    SRAM_enable();
+
+    // header (length and checksum are written on commit)
+    dumpOffset = 0;
+    dumpU32(CRASH_DUMP_MAGIC);
+    dumpU16(CRASH_DUMP_VERSION);
+    dumpOffset = 10;
+    dumpChecksum = 0;
+
+    // exception state
+    dumpU16(type);
+    dumpU32(pcState);
+    dumpU16(srState);
+    dumpU16(ext1State);
+    dumpU16(ext2State);
+    dumpU32(addrState);
+    for(u16 i = 0; i < 16; i++) dumpU32(registerState[i]);
+    // stack (only if stack pointer looks valid)
+    const u32 *sp = (u32*) registerState[15];
+    const bool spOk = (((u32) sp & 1) == 0) && ((u32) sp >= 0xFF0000) && ((u32) sp <= (0xFFFFFF - (24 * 4)));
+    for(u16 i = 0; i < 24; i++) dumpU32(spOk ? sp[i] : 0);
+    // first commit, what follows may rely on (possibly corrupted) internal states
+    commitCrashDump();
+
+    // performance state
+    dumpU32(vtimer);
+    dumpU32(missedFrames);
+    dumpU16(cpuFrameLoad);
+    dumpU16(LOAD_MEAN_FRAME_NUM);
+    // from oldest to newest
+    for(u16 i = 0; i < LOAD_MEAN_FRAME_NUM; i++) dumpU16(frameLoads[(frameLoadIndex + i) & (LOAD_MEAN_FRAME_NUM - 1)]);
+
+    // DMA queue statistics
+#if (ENABLE_DMA_STATS != 0)
+    const DMAStats* stats = DMA_getStats();
+
+    dumpU16(1);
+    dumpU32(stats->frames);
+    dumpU16(stats->peakBytes);
+    dumpU16(stats->peakEntries);
+    dumpU16(stats->dropped);
+    dumpU16(stats->delayed);
+    dumpU16(stats->truncated);
+    dumpU16(stats->bufferFull);
+    dumpU16(stats->peakBuffer);
+#else
+    dumpU16(0);
+#endif
+    commitCrashDump();
+
+    // profiler zones
+#if (ENABLE_PROFILER != 0)
+    dumpU16(PROF_MAX_ZONE);
+    for(u16 i = 0; i < PROF_MAX_ZONE; i++)
+    {
+        const ProfZone* zone = PROF_getZone(i);
+
+        dumpU16(zone->calls);
+        dumpU16(zone->avg);
+        dumpU16(zone->max);
+        dumpU16(zone->winMax);
+        dumpU16(zone->frameTime);
+    }
+#else
+    dumpU16(0);
+#endif
+    commitCrashDump();
+
+    // heap summary last as it requires to parse the heap
+    dumpU16(MEM_getFree());
+    dumpU16(MEM_getAllocated());
+    dumpU16(MEM_getLargestFreeBlock());
+#if (ENABLE_MEM_TRACE != 0)
+    dumpU16(MEM_getPeakAllocated());
+    dumpU16(MEM_getMinLargestFreeBlock());
+#else
+    dumpU16(0);
+    dumpU16(0);
+#endif
+    commitCrashDump();
+
+    SRAM_disable();
+}
+
+#else
+
+static void saveCrashDump(u16 type)
+{
+    // nothing to do
+}
+
+#endif // ENABLE_CRASH_DUMP
+
 
 // bus error default callback
 void _buserror_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_BUS_ERROR);
     VDP_init();
     VDP_drawText("BUS ERROR !", 10, 3);
 
@@ -317,6 +493,7 @@ void _buserror_callback()
 void _addresserror_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_ADDRESS_ERROR);
     VDP_init();
     VDP_drawText("ADDRESS ERROR !", 10, 3);
 
@@ -329,6 +506,7 @@ void _addresserror_callback()
 void _illegalinst_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_ILLEGAL_INST);
     VDP_init();
     VDP_drawText("ILLEGAL INSTRUCTION !", 7, 3);
 
@@ -341,6 +519,7 @@ void _illegalinst_callback()
 void _zerodivide_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_ZERO_DIVIDE);
     VDP_init();
     VDP_drawText("DIVIDE BY ZERO !", 10, 3);
 
@@ -353,6 +532,7 @@ void _zerodivide_callback()
 void _chkinst_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_CHK_INST);
     VDP_init();
     VDP_drawText("CHK INSTRUCTION EXCEPTION !", 5, 10);
 
@@ -365,6 +545,7 @@ void _chkinst_callback()
 void _trapvinst_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_TRAPV_INST);
     VDP_init();
     VDP_drawText("TRAPV INSTRUCTION EXCEPTION !", 5, 3);
 
@@ -377,6 +558,7 @@ void _trapvinst_callback()
 void _privilegeviolation_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_PRIVILEGE_VIOLATION);
     VDP_init();
     VDP_drawText("PRIVILEGE VIOLATION !", 5, 3);
 
@@ -401,6 +583,7 @@ void _line1x1x_callback()
 void _errorexception_callback()
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_ERROR_EXCEPTION);
     VDP_init();
     VDP_drawText("EXCEPTION ERROR !", 5, 3);
 
@@ -443,7 +626,7 @@ void _extint_dummy_callback()
 
 void _start_entry()
 {
-    u32 banklimit;
+    u32 banklimit;
     u16* src;
     u16* dst;
     u16 len;
@@ -464,16 +647,16 @@ void _start_entry()
     // convert to word
     len = (len + 1) / 2;
 
-    // get bank limit in word (bank size is 512KB)
-    banklimit = (0x80000 - (((u32)src) & 0x7FFFF)) >> 1;
-    // bank limit exceeded ?
-    if (len > banklimit)
-    {
-        // we first do the second bank part
+    // get bank limit in word (bank size is 512KB)
+    banklimit = (0x80000 - (((u32)src) & 0x7FFFF)) >> 1;
+    // bank limit exceeded ?
+    if (len > banklimit)
+    {
+        // we first do the second bank part
         memcpyU16(dst + banklimit, FAR(src + banklimit), len - banklimit);
-        // adjust len
-        len = banklimit;
-    }
+        // adjust len
+        len = banklimit;
+    }
     // initialize "initialized variables"
     memcpyU16(dst, FAR(src), len);
 
@@ -595,13 +778,16 @@ static void internal_reset()
     SRAM_disable();
 
 #if (ENABLE_BANK_SWITCH != 0)
-    // reset banks
-    u16 len = 8;
-    while(--len) SYS_setBank(len, len);
+    // reset banks and bank cache
+    BANK_init();
 #endif
 
     vblankCB = _vblank_dummy_callback;
     vintCB = _vint_dummy_callback;
+    userVBlankCB = _vblank_dummy_callback;
+    userVIntCB = _vint_dummy_callback;
+    numVIntHandler = 0;
+    numVBlankHandler = 0;
     // fast hint call (auto modified JMP instruction)
     hintCaller.jmpInst = 0x4EF9;                // JMP (xxx).L
     hintCaller.addr = _hint_dummy_callback;
@@ -621,6 +807,11 @@ static void internal_reset()
     frameCnt = 0;
     lastSubTick = 0;
 
+    // reset frame pacing
+    missedFrames = 0;
+    pacingFrame = vtimer;
+    pacingMaxTick = 4;
+
     // safe to check for DMA completion before dealing with VDP (this also clear internal VDP latch)
     // WARNING: it's important to not access the VDP too soon or you can lock the system (it's why we do it just here) !
     while(GET_VDP_STATUS(VDP_DMABUSY_FLAG));
@@ -630,6 +821,8 @@ static void internal_reset()
     // need to be reseted before first DMA_init()
     dmaQueues = NULL;
     dmaDataBuffer = NULL;
+    // frame arena memory is released by MEM_init()
+    frameArena = NULL;
     DMA_init();
     DMA_setMaxTransferSizeToDefault();
     VDP_init();
@@ -637,6 +830,12 @@ static void internal_reset()
     JOY_init();
     // reseting z80 also reset the ym2612
     Z80_init();
+#if (ENABLE_PROFILER != 0)
+    PROF_init();
+#endif
+#if (ENABLE_TRACE != 0)
+    TRACE_init();
+#endif
 
     // Sprite engine variables reset (we use to know if sprite engine is initialized)
     spritesPool = NULL;
@@ -655,6 +854,20 @@ bool SYS_doVBlankProcessEx(VBlankProcessTime processTime)
 {
     if (processTime != IMMEDIATELY)
     {
+        const u16 autoPack = MEM_getAutoPack();
+
+#if (ENABLE_KLOG_BUFFER != 0)
+        // end of frame: send buffered logs
+        KLog_flush();
+#endif
+#if (ENABLE_TRACE != 0)
+        // send trace events
+        TRACE_flush();
+#endif
+
+        // use idle time to pack memory (only if CPU load is low enough)
+        if (autoPack && (SYS_getCPULoad() < MEM_AUTO_PACK_MAX_CPU_LOAD)) MEM_packStep(autoPack);
+
         // wait for VBlank
         if (VDP_waitVBlank(processTime == ON_VBLANK_START))
         {
@@ -670,11 +883,24 @@ bool SYS_doVBlankProcessEx(VBlankProcessTime processTime)
         }
     }
 
+#if (ENABLE_PROFILER != 0)
+    // new profiler frame
+    PROF_endFrame();
+#endif
+    PROF_begin(PROF_ZONE_VBLANK);
+
     u16 vbp = VBlankProcess;
 #if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
     u16 vcnt = 0;
 #endif
 
+    // deferred VDP register writes (done first so mode changes apply to the whole frame)
+    if (vbp & PROCESS_VDP_REG_TASK)
+    {
+        VDP_doVBlankRegProcess();
+        vbp &= ~PROCESS_VDP_REG_TASK;
+    }
+
     // dma processing
     if (vbp & PROCESS_DMA_TASK)
     {
@@ -685,8 +911,8 @@ bool SYS_doVBlankProcessEx(VBlankProcessTime processTime)
         // enable bus protection for Z80 before flushing DMA
         Z80_enableBusProtection();
 
-        // delay enabled ? --> wait a bit to improve PCM playback (test on SOR2)
-        if ((currentDriver == Z80_DRIVER_XGM) && XGM_getForceDelayDMA()) waitSubTick(10);
+        // delay enabled or heavy music frame ? --> wait for Z80 to complete current frame (at most 10 subticks) to improve PCM playback (test on SOR2)
+        if ((currentDriver == Z80_DRIVER_XGM) && (XGM_getForceDelayDMA() || XGM_isHeavyFramePending())) XGM_waitFrameProcessed(10);
         DMA_flushQueue();
 
         // can disable bus protection
@@ -737,9 +963,51 @@ bool SYS_doVBlankProcessEx(VBlankProcessTime processTime)
 #endif
     }
 
+    // raster table swap, line 0 operations and H-Int setup
+    if (vbp & PROCESS_RASTER_TASK)
+    {
+        if (!RASTER_doVBlankProcess()) vbp &= ~PROCESS_RASTER_TASK;
+    }
+
+    // palette fade channels process
+    if (vbp & PROCESS_PALETTE_FADE_CHANNEL)
+    {
+        if (!PAL_doFadeChannelStep()) vbp &= ~PROCESS_PALETTE_FADE_CHANNEL;
+    }
+
+    // XGM PCM stream (next segment may need bank switch so it's done here and not in V-Int)
+    if (vbp & PROCESS_XGM_STREAM_TASK)
+    {
+        if (!XGM_doStreamProcess()) vbp &= ~PROCESS_XGM_STREAM_TASK;
+    }
+
+    // PSG SFX sequencer
+    if (vbp & PROCESS_PSG_SFX_TASK)
+    {
+        if (!PSGSFX_doVBlankProcess()) vbp &= ~PROCESS_PSG_SFX_TASK;
+    }
+
+    // palette buffer upload (done after fading so fade step is uploaded on same frame)
+    if (VBlankProcess & PROCESS_PALETTE_TASK)
+    {
+        PAL_doVBlankProcess();
+        VBlankProcess &= ~PROCESS_PALETTE_TASK;
+        vbp &= ~PROCESS_PALETTE_TASK;
+    }
+
     // store back
     VBlankProcess = vbp;
 
+    // frame temporary data can be released now (DMA queue was flushed)
+    if (frameArena) ARENA_reset(frameArena);
+
+#if (ENABLE_BANK_SWITCH != 0)
+    // far data released on VBlank can be unpinned now (DMA queue was flushed)
+    BANK_doVBlankProcess();
+#endif
+
+    PROF_end(PROF_ZONE_VBLANK);
+
     // user VBlank callback
     (*vblankCB)();
 
@@ -837,21 +1105,190 @@ void SYS_enableInts()
 #endif
 }
 
+static void runHandlers(IntHandler* handlers, u16 num, VoidCallback* userCB)
+{
+    IntHandler* h = handlers;
+    bool userDone = FALSE;
+    u16 i = num;
+
+    while(i--)
+    {
+        // user callback is called before first handler with order >= 0
+        if (!userDone && (h->order >= 0))
+        {
+            userCB();
+            userDone = TRUE;
+        }
+
+        const u32 start = getHVTick();
+        h->cb();
+        const u32 elapsed = getHVTick() - start;
+        const u16 t = (elapsed > 0xFFFF) ? 0xFFFF : elapsed;
+
+        h->time = t;
+        if (t > h->maxTime) h->maxTime = t;
+        if (h->budget && (t > h->budget)) h->overrun++;
+        h++;
+    }
+
+    if (!userDone) userCB();
+}
+
+static void runVIntHandlers()
+{
+    runHandlers(vintHandlers, numVIntHandler, userVIntCB);
+}
+
+static void runVBlankHandlers()
+{
+    runHandlers(vblankHandlers, numVBlankHandler, userVBlankCB);
+}
+
+static void updateCallbacks()
+{
+    // direct call when there is no handler
+    vintCB = numVIntHandler ? runVIntHandlers : userVIntCB;
+    vblankCB = numVBlankHandler ? runVBlankHandlers : userVBlankCB;
+}
+
+static bool addHandler(IntHandler* handlers, u16* num, VoidCallback* CB, s16 order, u16 budget)
+{
+    u16 n = *num;
+
+    if (n >= SYS_MAX_INT_HANDLER)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("SYS_addVIntHandler(..) / SYS_addVBlankHandler(..) failed: max number of handler reached = ", SYS_MAX_INT_HANDLER);
+#endif
+        return FALSE;
+    }
+
+    SYS_disableInts();
+
+    // keep handlers sorted by order (insert after handlers of same order)
+    IntHandler* h = &handlers[n];
+    while((h > handlers) && ((h - 1)->order > order))
+    {
+        *h = *(h - 1);
+        h--;
+    }
+
+    h->cb = CB;
+    h->order = order;
+    h->budget = budget;
+    h->time = 0;
+    h->maxTime = 0;
+    h->overrun = 0;
+    *num = n + 1;
+
+    updateCallbacks();
+
+    SYS_enableInts();
+
+    return TRUE;
+}
+
+static bool removeHandler(IntHandler* handlers, u16* num, VoidCallback* CB)
+{
+    const u16 n = *num;
+
+    for(u16 i = 0; i < n; i++)
+    {
+        if (handlers[i].cb == CB)
+        {
+            SYS_disableInts();
+
+            for(u16 j = i + 1; j < n; j++) handlers[j - 1] = handlers[j];
+            *num = n - 1;
+
+            updateCallbacks();
+
+            SYS_enableInts();
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
 void SYS_setVBlankCallback(VoidCallback *CB)
 {
-    if (CB) vblankCB = CB;
-    else vblankCB = _vblank_dummy_callback;
+    if (CB) userVBlankCB = CB;
+    else userVBlankCB = _vblank_dummy_callback;
+
+    updateCallbacks();
 }
 
 void SYS_setVIntCallback(VoidCallback *CB)
 {
-    if (CB) vintCB = CB;
-    else vintCB = _vint_dummy_callback;
+    if (CB) userVIntCB = CB;
+    else userVIntCB = _vint_dummy_callback;
+
+    updateCallbacks();
+}
+
+bool SYS_addVIntHandler(VoidCallback *CB, s16 order, u16 budget)
+{
+    return addHandler(vintHandlers, &numVIntHandler, CB, order, budget);
+}
+
+bool SYS_removeVIntHandler(VoidCallback *CB)
+{
+    return removeHandler(vintHandlers, &numVIntHandler, CB);
+}
+
+const IntHandler* SYS_getVIntHandlers(u16 *num)
+{
+    *num = numVIntHandler;
+    return vintHandlers;
+}
+
+bool SYS_addVBlankHandler(VoidCallback *CB, s16 order, u16 budget)
+{
+    return addHandler(vblankHandlers, &numVBlankHandler, CB, order, budget);
+}
+
+bool SYS_removeVBlankHandler(VoidCallback *CB)
+{
+    return removeHandler(vblankHandlers, &numVBlankHandler, CB);
+}
+
+const IntHandler* SYS_getVBlankHandlers(u16 *num)
+{
+    *num = numVBlankHandler;
+    return vblankHandlers;
+}
+
+void SYS_resetHandlerStats()
+{
+    SYS_disableInts();
+
+    for(u16 i = 0; i < SYS_MAX_INT_HANDLER; i++)
+    {
+        vintHandlers[i].time = 0;
+        vintHandlers[i].maxTime = 0;
+        vintHandlers[i].overrun = 0;
+        vblankHandlers[i].time = 0;
+        vblankHandlers[i].maxTime = 0;
+        vblankHandlers[i].overrun = 0;
+    }
+
+    SYS_enableInts();
 }
 
 void SYS_setHIntCallback(VoidCallback *CB)
 {
+#if (ENABLE_TRACE != 0)
+    // H-Int is traced by a wrapper calling the user callback
+    if (CB)
+    {
+        traceHIntCB = CB;
+        hintCaller.addr = _hint_trace_caller;
+    }
+#else
     if (CB) hintCaller.addr = CB;
+#endif
     else hintCaller.addr = _hint_dummy_callback;
 }
 
@@ -981,6 +1418,7 @@ bool addFrameLoad(u16 frameLoad, u32 vtime)
         // force frame load to 255
         v = ((deltaFrame - 1) << 8) + frameLoad;
         miss = TRUE;
+        missedFrames += deltaFrame - 1;
     }
     else
     {
@@ -1002,49 +1440,154 @@ u16 SYS_getCPULoad()
    return (cpuFrameLoad * ((u16) 100)) / (u16) (LOAD_MEAN_FRAME_NUM * 256);
 }
 
+u16 SYS_getLogicTickCount()
+{
+    const u32 frame = vtimer;
+    u32 ticks = frame - pacingFrame;
+
+    pacingFrame = frame;
 
-u16 SYS_computeChecksum()
+    // more than the allowed catch-up --> game slows down
+    if (ticks > pacingMaxTick) ticks = pacingMaxTick;
+
+    return ticks;
+}
+
+void SYS_resetLogicTick()
 {
-    u32 adr;
-    u32 chk;
+    pacingFrame = vtimer - 1;
+}
+
+void SYS_setMaxLogicTick(u16 value)
+{
+    pacingMaxTick = value?value:1;
+}
 
-    chk = 0;
-    for(adr = 0; adr < ROM_SIZE; adr += BANK_SIZE)
+u32 SYS_getMissedFrameCount()
+{
+    return missedFrames;
+}
+
+void SYS_resetMissedFrameCount()
+{
+    missedFrames = 0;
+}
+
+
+static u32 computeChecksum(u32 adr, u32 len, u32 chk)
+{
+    while(len)
     {
-        // dword x8 checksum
-        u16 len = BANK_SIZE / (4 * 8);
-        // get source pointer
-        u32* src = (u32 *) FAR(adr);
+        // don't cross bank boundary so the whole chunk is mapped at once
+        const u32 chunk = min(len, BANK_SIZE - (adr & BANK_IN_MASK));
 
-        while(len--)
-        {
-          chk ^= *src++;
-          chk ^= *src++;
-          chk ^= *src++;
-          chk ^= *src++;
-          chk ^= *src++;
-          chk ^= *src++;
-          chk ^= *src++;
-          chk ^= *src++;
-        }
+        // 64 bytes per block
+        chk = computeChecksumBlock((u32*) FAR_SAFE(adr, chunk), chunk / 64, chk);
+        adr += chunk;
+        len -= chunk;
     }
 
+    return chk;
+}
+
+static bool isChecksumOk(u32 chk)
+{
+    // pack 32 bit checksum on 16 bit
+    const u16 checksum = chk ^ (chk >> 16);
+
+    // remove checksum from it
+    return (checksum ^ rom_header.checksum) == rom_header.checksum;
+}
+
+static void checksumJob(void* data)
+{
+    const u32 len = min(chkStep, ROM_SIZE - chkAdr);
+
+    chkQueued = FALSE;
+    chkValue = computeChecksum(chkAdr, len, chkValue);
+    chkAdr += len;
+
+    // done ?
+    if (chkAdr >= ROM_SIZE)
+    {
+        chkState = isChecksumOk(chkValue)?CHECKSUM_CHECK_OK:CHECKSUM_CHECK_FAILED;
+        return;
+    }
+
+    // next chunk (retried from SYS_getChecksumCheckState() if the job queue is full)
+    chkQueued = JOB_push(checksumJob, data, chkCost);
+}
+
+u16 SYS_computeChecksum()
+{
+    const u32 chk = computeChecksum(0, ROM_SIZE, 0);
+
     // pack 32 bit checksum on 16 bit
     return chk ^ (chk >> 16);
 }
 
 bool SYS_isChecksumOk()
 {
-    u16 checksum = SYS_computeChecksum();
+    return isChecksumOk(computeChecksum(0, ROM_SIZE, 0));
+}
 
-    // remove checksum from it
-    return (checksum ^ rom_header.checksum) == rom_header.checksum;
+void SYS_startChecksumCheck(u16 kbPerJob)
+{
+    chkStep = ((u32) max(1, min(kbPerJob, CHECKSUM_CHECK_MAX_KB))) * 1024;
+    // ~10 scanlines per KB
+    chkCost = (chkStep / 1024) * 10;
+    chkAdr = 0;
+    chkValue = 0;
+    chkState = CHECKSUM_CHECK_RUNNING;
+    // restart from beginning if a check job is already pending
+    if (!chkQueued) chkQueued = JOB_push(checksumJob, NULL, chkCost);
+}
+
+u16 SYS_getChecksumCheckState()
+{
+    // job queue was full --> retry
+    if ((chkState == CHECKSUM_CHECK_RUNNING) && !chkQueued)
+        chkQueued = JOB_push(checksumJob, NULL, chkCost);
+
+    return chkState;
+}
+
+
+u16 SYS_hasCrashDump()
+{
+    u16 res = 0;
+
+    SRAM_enableRO();
+    if (SRAM_readLong(CRASH_DUMP_SRAM_OFFSET) == CRASH_DUMP_MAGIC)
+    {
+        // checksum validation
+        const u16 len = SRAM_readWord(CRASH_DUMP_SRAM_OFFSET + 6);
+        const u16 sum = SRAM_readWord(CRASH_DUMP_SRAM_OFFSET + 8);
+        u16 s = 0;
+
+        if ((len > 10) && (len <= 512))
+        {
+            for(u16 i = 10; i < len; i++) s += SRAM_readByte(CRASH_DUMP_SRAM_OFFSET + i);
+            if (s == sum) res = SRAM_readWord(CRASH_DUMP_SRAM_OFFSET + 10);
+        }
+    }
+    SRAM_disable();
+
+    return res;
+}
+
+void SYS_clearCrashDump()
+{
+    SRAM_enable();
+    SRAM_writeLong(CRASH_DUMP_SRAM_OFFSET, 0);
+    SRAM_disable();
 }
 
 
 void SYS_die(char *err)
 {
     SYS_setInterruptMaskLevel(7);
+    saveCrashDump(CRASH_DIE);
     VDP_init();
     VDP_drawText("A fatal error occured !", 2, 2);
     VDP_drawText("cannot continue...", 4, 3);
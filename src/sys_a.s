@@ -47,3 +47,39 @@ func SYS_getAndSetInterruptMaskLevel
     lsr.w   #8,%d0
     andi.w  #0x07,%d0                       // d0 = previous interrupt mask
     rts
+
+
+// u32 computeChecksumBlock(const u32* src, u16 num, u32 chk)
+// XOR <num> (> 0) blocks of 64 bytes into <chk> and return it
+func computeChecksumBlock
+    movem.l %d2-%d7,-(%sp)
+
+    move.l  28(%sp),%a0                     // a0 = src
+    move.w  34(%sp),%d1                     // d1 = num
+    move.l  36(%sp),%d0                     // d0 = chk
+    subq.w  #1,%d1
+
+.cb_loop:
+    movem.l (%a0)+,%d2-%d7                  // 6 longs
+    eor.l   %d2,%d0
+    eor.l   %d3,%d0
+    eor.l   %d4,%d0
+    eor.l   %d5,%d0
+    eor.l   %d6,%d0
+    eor.l   %d7,%d0
+    movem.l (%a0)+,%d2-%d7                  // 12 longs
+    eor.l   %d2,%d0
+    eor.l   %d3,%d0
+    eor.l   %d4,%d0
+    eor.l   %d5,%d0
+    eor.l   %d6,%d0
+    eor.l   %d7,%d0
+    movem.l (%a0)+,%d2-%d5                  // 16 longs
+    eor.l   %d2,%d0
+    eor.l   %d3,%d0
+    eor.l   %d4,%d0
+    eor.l   %d5,%d0
+    dbra    %d1,.cb_loop
+
+    movem.l (%sp)+,%d2-%d7
+    rts
@@ -128,4 +128,22 @@ _trap_0:
 
         // For the pending task to return 0
         moveq   #0, %d0
-        rte
\ No newline at end of file
+        rte
+
+
+/**
+ * Cooperative task context switch (used by the cooperative scheduler in
+ * task_coop.c, from user task only).
+ *  Saves non clobberable registers on current stack, stores the stack pointer
+ *  at the address given as first parameter and resumes the context saved on
+ *  the stack given as second parameter.
+ */
+func TSK_switchContext
+        move.l  4(%sp), %a0
+        move.l  8(%sp), %a1
+
+        movem.l %d2-%d7/%a2-%a6, -(%sp)
+        move.l  %sp, (%a0)
+        move.l  %a1, %sp
+        movem.l (%sp)+, %d2-%d7/%a2-%a6
+        rts
@@ -0,0 +1,223 @@
+#include "config.h"
+#include "types.h"
+
+#include "task.h"
+
+#include "sys.h"
+#include "memory.h"
+#include "timer.h"
+#include "tools.h"
+
+
+#define TASK_FREE       0
+#define TASK_READY      1
+// killed while running: slot and stack are released by the scheduler once the task switched back to it
+#define TASK_KILLED     2
+
+// saved registers (d2-d7/a2-a6) + return address
+#define CONTEXT_SIZE    ((11 + 1) * 4)
+
+
+typedef struct
+{
+    u32* sp;
+    void* stack;
+    TaskCallback* fn;
+    void* data;
+    u32 wake;
+    u16 stackSize;
+    u16 state;
+    u16 priority;
+} CoopTask;
+
+
+// implemented in task.s
+extern void TSK_switchContext(u32** save, u32* restore);
+
+static CoopTask tasks[TSK_MAX_TASK];
+// scheduler context
+static u32* schedSp;
+static s16 current;
+static u16 last;
+
+
+static void scheduler(void);
+static void taskEntry(void);
+
+
+void TSK_initScheduler()
+{
+    for(u16 i = 0; i < TSK_MAX_TASK; i++)
+    {
+        if (tasks[i].state != TASK_FREE) MEM_free(tasks[i].stack);
+        tasks[i].state = TASK_FREE;
+    }
+
+    current = -1;
+    last = 0;
+
+    // the scheduler is the user task
+    TSK_userSet(scheduler);
+}
+
+s16 TSK_create(TaskCallback* fn, void* data, u16 stackSize, u16 priority)
+{
+    CoopTask* t = tasks;
+    s16 id;
+
+    for(id = 0; id < TSK_MAX_TASK; id++, t++)
+        if (t->state == TASK_FREE) break;
+
+    if (id == TSK_MAX_TASK)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("TSK_create(..) failed: max number of task reached = ", TSK_MAX_TASK);
+#endif
+        return -1;
+    }
+
+    // keep stack aligned and large enough for the context
+    stackSize = (max(stackSize, TSK_MIN_STACK_LENGTH) + 3) & 0xFFFC;
+    t->stack = MEM_alloc(stackSize);
+
+    if (t->stack == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("TSK_create(..) failed: not enough memory for task stack, size = ", stackSize);
+#endif
+        return -1;
+    }
+
+    // build initial context: registers (cleared) then return address to task entry
+    u32* sp = (u32*) (((u8*) t->stack) + stackSize);
+    *--sp = (u32) taskEntry;
+    for(u16 i = 0; i < 11; i++) *--sp = 0;
+
+    t->sp = sp;
+    t->stackSize = stackSize;
+    t->fn = fn;
+    t->data = data;
+    t->wake = vtimer;
+    t->priority = priority;
+    t->state = TASK_READY;
+
+    return id;
+}
+
+void TSK_kill(s16 id)
+{
+    if ((id < 0) || (id >= TSK_MAX_TASK)) return;
+
+    CoopTask* t = &tasks[id];
+
+    // already dead
+    if (t->state != TASK_READY) return;
+
+    // current task ?
+    if (id == current)
+    {
+        u8 local;
+
+        // called from the task itself --> exit now
+        if ((&local >= (u8*) t->stack) && (&local < ((u8*) t->stack + t->stackSize))) TSK_exit();
+
+        // task was interrupted by V-Int and still runs on its stack: keep the slot until it yields to the scheduler
+        t->state = TASK_KILLED;
+        return;
+    }
+
+    MEM_free(t->stack);
+    t->state = TASK_FREE;
+}
+
+void TSK_exit()
+{
+    if (current < 0) return;
+
+    // scheduler releases the slot and the stack when we switch back to it
+    tasks[current].state = TASK_KILLED;
+    TSK_switchContext(&tasks[current].sp, schedSp);
+}
+
+void TSK_yield()
+{
+    // not called from a cooperative task
+    if (current < 0) return;
+
+    TSK_switchContext(&tasks[current].sp, schedSp);
+}
+
+void TSK_sleepFrames(u16 frames)
+{
+    if (current < 0) return;
+
+    tasks[current].wake = vtimer + frames;
+    TSK_yield();
+}
+
+s16 TSK_getCurrent()
+{
+    return current;
+}
+
+bool TSK_isAlive(s16 id)
+{
+    if ((id < 0) || (id >= TSK_MAX_TASK)) return FALSE;
+
+    return tasks[id].state == TASK_READY;
+}
+
+
+static void scheduler()
+{
+    while(TRUE)
+    {
+        const u32 frame = vtimer;
+        s16 best = -1;
+        u16 bestPrio = 0;
+        u16 ind = last;
+
+        // find highest priority ready task, round robin from last executed task for same priority
+        for(u16 i = 0; i < TSK_MAX_TASK; i++)
+        {
+            if (++ind >= TSK_MAX_TASK) ind = 0;
+
+            const CoopTask* t = &tasks[ind];
+
+            if ((t->state == TASK_READY) && ((s32) (frame - t->wake) >= 0) && ((best < 0) || (t->priority > bestPrio)))
+            {
+                best = ind;
+                bestPrio = t->priority;
+            }
+        }
+
+        // nothing to do --> wait for V-Int (supervisor task resumes there)
+        if (best < 0)
+        {
+            while(vtimer == frame);
+            continue;
+        }
+
+        last = best;
+        current = best;
+        TSK_switchContext(&schedSp, tasks[best].sp);
+        current = -1;
+
+        // task ended or killed ? --> we are off its stack now so it can be released
+        if (tasks[best].state == TASK_KILLED)
+        {
+            MEM_free(tasks[best].stack);
+            tasks[best].state = TASK_FREE;
+        }
+    }
+}
+
+static void taskEntry()
+{
+    CoopTask* t = &tasks[current];
+
+    t->fn(t->data);
+
+    // task function returned
+    TSK_exit();
+}
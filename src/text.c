@@ -0,0 +1,234 @@
+#include "config.h"
+#include "types.h"
+
+#include "text.h"
+
+#include "memory.h"
+#include "maths.h"
+#include "string.h"
+#include "dma.h"
+#include "tools.h"
+#include "sys.h"
+
+
+// clip to layer width
+#define CLIP_LEN(layer, x, len)     ((((x) + (len)) > (layer)->w)?((layer)->w - (x)):(len))
+
+
+static void setEntries(TextLayer* layer, const u16* src, u16 x, u16 y, u16 len);
+static u16 getDigits(u32 value, u16* dest);
+
+
+TextLayer* TEXT_create(VDPPlane plane, u16 basetile, u16 x, u16 y, u16 w, u16 h)
+{
+    // shadow + dirty ranges in one block
+    TextLayer* result = MEM_alloc(sizeof(TextLayer) + (w * h * 2) + (h * 2));
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("TEXT_create(..) failed: not enough memory, w = ", w, " h = ", h);
+#endif
+        return NULL;
+    }
+
+    result->plane = plane;
+    result->basetile = basetile;
+    result->x = x;
+    result->y = y;
+    result->w = w;
+    result->h = h;
+    result->shadow = (u16*) &result[1];
+    result->dirtyLo = (u8*) (result->shadow + (w * h));
+    result->dirtyHi = result->dirtyLo + h;
+
+    TEXT_clear(result);
+
+    return result;
+}
+
+void TEXT_release(TextLayer* layer)
+{
+    MEM_free(layer);
+}
+
+void TEXT_clear(TextLayer* layer)
+{
+    memsetU16(layer->shadow, layer->basetile, layer->w * layer->h);
+    // all rows fully modified
+    memset(layer->dirtyLo, 0, layer->h);
+    memset(layer->dirtyHi, layer->w, layer->h);
+}
+
+void TEXT_clearText(TextLayer* layer, u16 x, u16 y, u16 w)
+{
+    u16 data[128];
+
+    if ((x >= layer->w) || (y >= layer->h)) return;
+
+    const u16 len = min(CLIP_LEN(layer, x, w), 128);
+
+    memsetU16(data, layer->basetile, len);
+    setEntries(layer, data, x, y, len);
+}
+
+void TEXT_drawText(TextLayer* layer, const char* str, u16 x, u16 y)
+{
+    u16 data[128];
+    const u8 *s;
+    u16 *d;
+    u16 i, len;
+
+    if ((x >= layer->w) || (y >= layer->h)) return;
+
+    len = strlen(str);
+    len = min(CLIP_LEN(layer, x, len), 128);
+
+    const u16 base = layer->basetile + TILE_FONT_INDEX - 32;
+
+    // prepare the data
+    s = (const u8*) str;
+    d = data;
+    i = len;
+    while(i--) *d++ = base + *s++;
+
+    setEntries(layer, data, x, y, len);
+}
+
+void TEXT_setTiles(TextLayer* layer, const u16* data, u16 x, u16 y, u16 len)
+{
+    if ((x >= layer->w) || (y >= layer->h)) return;
+
+    setEntries(layer, data, x, y, CLIP_LEN(layer, x, len));
+}
+
+void TEXT_drawUInt(TextLayer* layer, u32 value, u16 x, u16 y, u16 minsize)
+{
+    u16 digits[16];
+    u16 data[16];
+    u16 *d;
+    u16 n, len;
+
+    if ((x >= layer->w) || (y >= layer->h)) return;
+
+    // digits in reverse order
+    n = getDigits(value, digits);
+
+    const u16 base = layer->basetile + TILE_FONT_INDEX + ('0' - 32);
+
+    d = data;
+    // padding
+    len = min(minsize, 16);
+    while(len-- > n) *d++ = base;
+    // digits
+    while(n--) *d++ = base + digits[n];
+
+    len = d - data;
+    setEntries(layer, data, x, y, CLIP_LEN(layer, x, len));
+}
+
+void TEXT_drawInt(TextLayer* layer, s32 value, u16 x, u16 y, u16 minsize)
+{
+    if (value < 0)
+    {
+        if ((x >= layer->w) || (y >= layer->h)) return;
+
+        const u16 minus = layer->basetile + TILE_FONT_INDEX + ('-' - 32);
+
+        setEntries(layer, &minus, x, y, 1);
+        TEXT_drawUInt(layer, -value, x + 1, y, minsize);
+    }
+    else TEXT_drawUInt(layer, value, x, y, minsize);
+}
+
+u16 TEXT_update(TextLayer* layer)
+{
+    const u16 w = layer->w;
+    u8* lo = layer->dirtyLo;
+    u8* hi = layer->dirtyHi;
+    u16* src = layer->shadow;
+    u16 addr = VDP_getPlaneAddress(layer->plane, layer->x, layer->y);
+    // get plane width * 2 (row step in VRAM)
+    const u16 rowStep = ((layer->plane == WINDOW)?windowWidth:planeWidth) * 2;
+    u16 num = 0;
+    u16 i = layer->h;
+
+    while(i--)
+    {
+        const u16 l = *lo;
+        const u16 h = *hi;
+
+        // modified row ? --> queue modified range directly from shadow
+        if (l < h)
+        {
+            DMA_queueDmaFast(DMA_VRAM, src + l, addr + (l * 2), h - l, 2);
+            num++;
+        }
+
+        *lo++ = w;
+        *hi++ = 0;
+        src += w;
+        addr += rowStep;
+    }
+
+    return num;
+}
+
+
+// copy entries in shadow and update dirty range of row (only for changed entries)
+static void setEntries(TextLayer* layer, const u16* src, u16 x, u16 y, u16 len)
+{
+    u16* dst = layer->shadow + (y * layer->w) + x;
+    s16 first = -1;
+    u16 last = 0;
+
+    for(u16 i = 0; i < len; i++)
+    {
+        const u16 v = src[i];
+
+        if (dst[i] != v)
+        {
+            dst[i] = v;
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+
+    // nothing changed
+    if (first < 0) return;
+
+    first += x;
+    last += x + 1;
+
+    if (first < layer->dirtyLo[y]) layer->dirtyLo[y] = first;
+    if (last > layer->dirtyHi[y]) layer->dirtyHi[y] = last;
+}
+
+// convert value to decimal digits (reverse order) using divu (32/16) only, returns number of digit
+static u16 getDigits(u32 value, u16* dest)
+{
+    u16* d = dest;
+    u32 v = value;
+
+    // 32 bit value: divide high and low word separately so quotient always fits in 16 bit
+    while(v > 0xFFFF)
+    {
+        const u32 rh = divmodu(v >> 16, 10);
+        const u32 rl = divmodu((rh & 0xFFFF0000) | (v & 0xFFFF), 10);
+
+        *d++ = rl >> 16;
+        v = (rh << 16) | (rl & 0xFFFF);
+    }
+
+    // 16 bit value: single divu per digit
+    u16 v16 = v;
+    do
+    {
+        const u32 r = divmodu(v16, 10);
+
+        *d++ = r >> 16;
+        v16 = r;
+    } while(v16);
+
+    return d - dest;
+}
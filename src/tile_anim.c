@@ -0,0 +1,158 @@
+#include "config.h"
+#include "types.h"
+
+#include "tile_anim.h"
+
+#include "memory.h"
+#include "mapper.h"
+#include "dma.h"
+#include "tools.h"
+#include "sys.h"
+
+
+// playing animations
+static TileAnimation* anims[TILEANIM_MAX];
+static u16 numAnim = 0;
+// first animation to process on next update (avoid starvation of last animations on budget overflow)
+static u16 startAnim = 0;
+// transfer budget per frame (0 = use remaining DMA capacity)
+static u16 budget = 0;
+
+
+TileAnimation* TILEANIM_create(const TileSet* frames, u16 vramIndex, u16 frameTiles, u16 frameDelay, const u8* timings)
+{
+    TileAnimation* result = MEM_alloc(sizeof(TileAnimation));
+
+    if (result == NULL) return NULL;
+
+    // DMA requires uncompressed tiles
+    if (frames->compression != COMPRESSION_NONE)
+    {
+        result->frames = unpackTileSet(frames, NULL);
+
+        // not enough memory --> release and return NULL
+        if (result->frames == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("TILEANIM_create(..) failed: not enough memory to unpack frames, numTile = ", frames->numTile);
+#endif
+            MEM_free(result);
+            return NULL;
+        }
+
+        result->allocated = TRUE;
+    }
+    else
+    {
+        result->frames = frames;
+        result->allocated = FALSE;
+    }
+
+    result->vramIndex = vramIndex;
+    result->frameTiles = frameTiles;
+    result->numFrame = frames->numTile / frameTiles;
+    result->frameDelay = frameDelay;
+    result->timings = timings;
+    result->frame = 0;
+    // first frame upload is pending
+    result->timer = 0;
+
+    return result;
+}
+
+void TILEANIM_release(TileAnimation* anim)
+{
+    TILEANIM_remove(anim);
+
+    if (anim->allocated) MEM_free((void*) anim->frames);
+    MEM_free(anim);
+}
+
+bool TILEANIM_add(TileAnimation* anim)
+{
+    if (numAnim >= TILEANIM_MAX)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("TILEANIM_add(..) failed: max number of animation reached = ", TILEANIM_MAX);
+#endif
+        return FALSE;
+    }
+
+    anims[numAnim++] = anim;
+
+    return TRUE;
+}
+
+void TILEANIM_remove(TileAnimation* anim)
+{
+    u16 i = numAnim;
+
+    while(i--)
+    {
+        if (anims[i] == anim)
+        {
+            // keep order so starvation protection still works
+            numAnim--;
+            for(u16 j = i; j < numAnim; j++) anims[j] = anims[j + 1];
+            if (startAnim >= numAnim) startAnim = 0;
+            return;
+        }
+    }
+}
+
+void TILEANIM_clear(void)
+{
+    numAnim = 0;
+    startAnim = 0;
+}
+
+void TILEANIM_setBudget(u16 value)
+{
+    budget = value;
+}
+
+u16 TILEANIM_update(void)
+{
+    s16 remaining = budget?budget:DMA_getRemainingCapacity();
+    u16 uploaded = 0;
+    bool overflow = FALSE;
+    u16 ind = startAnim;
+    u16 i = numAnim;
+
+    while(i--)
+    {
+        TileAnimation* anim = anims[ind];
+
+        // timer elapsed ? --> frame upload pending
+        if (anim->timer == 0 || --anim->timer == 0)
+        {
+            const u16 size = anim->frameTiles * 32;
+
+            // fit in budget ? (or no other upload done this frame so we always progress)
+            if (!overflow && ((remaining >= (s16) size) || (uploaded == 0)))
+            {
+                u32* tiles = anim->frames->tiles + (anim->frame * anim->frameTiles * 8);
+
+                DMA_queueDma(DMA_VRAM, FAR_SAFE(tiles, size), anim->vramIndex * 32, size / 2, 2);
+                remaining -= size;
+                uploaded++;
+
+                // next frame
+                anim->timer = anim->timings?anim->timings[anim->frame]:anim->frameDelay;
+                if (++anim->frame >= anim->numFrame) anim->frame = 0;
+            }
+            // no more budget --> next update will start from this animation
+            else if (!overflow)
+            {
+                overflow = TRUE;
+                startAnim = ind;
+            }
+        }
+
+        if (++ind >= numAnim) ind = 0;
+    }
+
+    if (!overflow) startAnim = 0;
+
+    return uploaded;
+}
@@ -0,0 +1,166 @@
+#include "config.h"
+#include "types.h"
+
+#include "tile_cache.h"
+
+#include "memory.h"
+#include "mapper.h"
+#include "dma.h"
+#include "tools.h"
+#include "timer.h"
+#include "sys.h"
+
+
+#define NO_ENTRY        0xFFFF
+
+
+static void touchSlot(TileCache* cache, u16 slot);
+
+
+TileCache* TILECACHE_create(const TileSet* tileset, u16 vramIndex, u16 numSlot)
+{
+    // tiles are transferred directly from ROM
+    if (tileset->compression != COMPRESSION_NONE)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("TILECACHE_create(..) failed: tileset should not be compressed");
+#endif
+        return NULL;
+    }
+
+    const u16 numTile = tileset->numTile;
+    // allocate everything in one block
+    TileCache* result = MEM_alloc(sizeof(TileCache) + ((numTile + (numSlot * 4)) * 2));
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("TILECACHE_create(..) failed: not enough memory, numTile = ", numTile);
+#endif
+        return NULL;
+    }
+
+    result->tiles = tileset->tiles;
+    result->numTile = numTile;
+    result->vramIndex = vramIndex;
+    result->numSlot = numSlot;
+    result->slots = (u16*) &result[1];
+    result->ids = result->slots + numTile;
+    result->prev = result->ids + numSlot;
+    result->next = result->prev + numSlot;
+    result->stamps = result->next + numSlot;
+
+    TILECACHE_clear(result);
+
+    return result;
+}
+
+void TILECACHE_release(TileCache* cache)
+{
+    MEM_free(cache);
+}
+
+void TILECACHE_clear(TileCache* cache)
+{
+    const u16 numSlot = cache->numSlot;
+
+    memsetU16(cache->slots, NO_ENTRY, cache->numTile);
+    memsetU16(cache->ids, NO_ENTRY, numSlot);
+    memsetU16(cache->stamps, 0, numSlot);
+
+    // LRU list in slot order (tail is slot 0, next victims are slot 1, 2...) so first uploads are contiguous (DMA merge)
+    for(u16 i = 0; i < numSlot; i++)
+    {
+        cache->prev[i] = i + 1;
+        // 0 - 1 = NO_ENTRY
+        cache->next[i] = i - 1;
+    }
+    cache->prev[numSlot - 1] = NO_ENTRY;
+    cache->head = numSlot - 1;
+    cache->tail = 0;
+
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->overflows = 0;
+}
+
+u16 TILECACHE_get(TileCache* cache, u16 id)
+{
+    const u16 frame = vtimer;
+    u16 slot = cache->slots[id];
+
+    // already in VRAM
+    if (slot != NO_ENTRY)
+    {
+        cache->hits++;
+        cache->stamps[slot] = frame;
+        touchSlot(cache, slot);
+
+        return cache->vramIndex + slot;
+    }
+
+    // evict least recently used slot
+    slot = cache->tail;
+
+    const u16 oldId = cache->ids[slot];
+
+    if (oldId != NO_ENTRY)
+    {
+        cache->slots[oldId] = NO_ENTRY;
+
+        // referenced in this frame ? --> cache is too small
+        if (cache->stamps[slot] == frame)
+        {
+            cache->overflows++;
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+            KLog_U2("TILECACHE_get(..) warning: evicting tile referenced in current frame, id = ", oldId, " numSlot = ", cache->numSlot);
+#endif
+        }
+    }
+
+    cache->ids[slot] = id;
+    cache->slots[id] = slot;
+    cache->stamps[slot] = frame;
+    cache->misses++;
+    touchSlot(cache, slot);
+
+    // upload tile (contiguous uploads are merged by DMA queue)
+    DMA_queueDma(DMA_VRAM, FAR_SAFE(cache->tiles + (id * 8), 32), (cache->vramIndex + slot) * 32, 16, 2);
+
+    return cache->vramIndex + slot;
+}
+
+void TILECACHE_remapTilemap(TileCache* cache, u16* tilemap, u16 num)
+{
+    u16* t = tilemap;
+    u16 i = num;
+
+    while(i--)
+    {
+        const u16 v = *t;
+        *t++ = (v & ~TILE_INDEX_MASK) | TILECACHE_get(cache, v & TILE_INDEX_MASK);
+    }
+}
+
+
+// move slot on LRU list head (most recently used)
+static void touchSlot(TileCache* cache, u16 slot)
+{
+    if (cache->head == slot) return;
+
+    u16* prev = cache->prev;
+    u16* next = cache->next;
+    const u16 p = prev[slot];
+    const u16 n = next[slot];
+
+    // unlink
+    if (p != NO_ENTRY) next[p] = n;
+    if (n != NO_ENTRY) prev[n] = p;
+    else cache->tail = p;
+
+    // insert on head
+    prev[slot] = NO_ENTRY;
+    next[slot] = cache->head;
+    prev[cache->head] = slot;
+    cache->head = slot;
+}
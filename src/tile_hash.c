@@ -0,0 +1,182 @@
+#include "config.h"
+#include "types.h"
+
+#include "tile_hash.h"
+
+#include "memory.h"
+#include "maths.h"
+#include "dma.h"
+#include "tools.h"
+#include "sys.h"
+
+
+static u32 hflipRow(u32 row);
+static u32 hashTile(const u32* tile);
+static bool isSameTile(const u32* t1, const u32* t2);
+static s16 findTile(TileHash* hash, const u32* tile, u32 h);
+static void getFlipped(const u32* tile, u32* dest, u16 flip);
+
+
+TileHash* TILEHASH_create(u16 vramIndex, u16 maxTile)
+{
+    // hash table at most half filled
+    const u16 size = getNextPow2(maxTile * 2);
+    TileHash* result = MEM_alloc(sizeof(TileHash) + (maxTile * (32 + 4)) + (size * 2));
+
+    if (result == NULL)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U1("TILEHASH_create(..) failed: not enough memory, maxTile = ", maxTile);
+#endif
+        return NULL;
+    }
+
+    result->vramIndex = vramIndex;
+    result->maxTile = maxTile;
+    result->mask = size - 1;
+    // keep tiles first for alignment
+    result->tiles = (u32*) &result[1];
+    result->hashes = result->tiles + (maxTile * 8);
+    result->table = (u16*) (result->hashes + maxTile);
+
+    TILEHASH_clear(result);
+
+    return result;
+}
+
+void TILEHASH_release(TileHash* hash)
+{
+    MEM_free(hash);
+}
+
+void TILEHASH_clear(TileHash* hash)
+{
+    hash->numTile = 0;
+    memsetU16(hash->table, 0, hash->mask + 1);
+}
+
+u16 TILEHASH_getTile(TileHash* hash, const u32* tile)
+{
+    u32 flipped[8];
+    u32 h;
+    s16 ind;
+
+    // original
+    h = hashTile(tile);
+    ind = findTile(hash, tile, h);
+    if (ind >= 0) return hash->vramIndex + ind;
+
+    // flipped variants (V, H, HV)
+    for(u16 flip = 1; flip < 4; flip++)
+    {
+        getFlipped(tile, flipped, flip);
+
+        ind = findTile(hash, flipped, hashTile(flipped));
+        if (ind >= 0) return (hash->vramIndex + ind) | ((flip & 1)?TILE_ATTR_VFLIP_MASK:0) | ((flip & 2)?TILE_ATTR_HFLIP_MASK:0);
+    }
+
+    // new tile
+    const u16 num = hash->numTile;
+
+    if (num >= hash->maxTile)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("TILEHASH_getTile(..) warning: dictionary is full, maxTile = ", hash->maxTile);
+#endif
+        return 0xFFFF;
+    }
+
+    u32* dst = hash->tiles + (num * 8);
+
+    memcpy(dst, tile, 32);
+    hash->hashes[num] = h;
+
+    // insert in hash table (linear probing)
+    u16 slot = h & hash->mask;
+    while(hash->table[slot]) slot = (slot + 1) & hash->mask;
+    hash->table[slot] = num + 1;
+
+    hash->numTile = num + 1;
+
+    // upload from our RAM copy (stays valid until DMA is done), consecutive new tiles are merged by DMA queue
+    DMA_queueDma(DMA_VRAM, dst, (hash->vramIndex + num) * 32, 16, 2);
+
+    return hash->vramIndex + num;
+}
+
+u16 TILEHASH_getTiles(TileHash* hash, const u32* tiles, u16 num, u16* dest)
+{
+    const u32* src = tiles;
+    u16* d = dest;
+
+    for(u16 i = 0; i < num; i++)
+    {
+        const u16 t = TILEHASH_getTile(hash, src);
+
+        if (t == 0xFFFF) return i;
+
+        *d++ = t;
+        src += 8;
+    }
+
+    return num;
+}
+
+
+static u32 hflipRow(u32 row)
+{
+    // swap nibbles in each byte
+    const u32 r = ((row & 0x0F0F0F0F) << 4) | ((row >> 4) & 0x0F0F0F0F);
+
+    // then reverse bytes
+    return (r >> 24) | ((r >> 8) & 0x0000FF00) | ((r << 8) & 0x00FF0000) | (r << 24);
+}
+
+static u32 hashTile(const u32* tile)
+{
+    u32 h = 0;
+
+    for(u16 i = 0; i < 8; i++)
+        h = ((h << 5) | (h >> 27)) ^ tile[i];
+
+    return h;
+}
+
+static bool isSameTile(const u32* t1, const u32* t2)
+{
+    for(u16 i = 0; i < 8; i++)
+        if (t1[i] != t2[i]) return FALSE;
+
+    return TRUE;
+}
+
+// returns tile entry or -1 if not found
+static s16 findTile(TileHash* hash, const u32* tile, u32 h)
+{
+    const u16 mask = hash->mask;
+    u16 slot = h & mask;
+    u16 e;
+
+    while((e = hash->table[slot]))
+    {
+        e--;
+
+        // same hash ? --> compare tile data
+        if ((hash->hashes[e] == h) && isSameTile(hash->tiles + (e * 8), tile)) return e;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return -1;
+}
+
+// flip bit 0 = vertical flip, bit 1 = horizontal flip
+static void getFlipped(const u32* tile, u32* dest, u16 flip)
+{
+    for(u16 i = 0; i < 8; i++)
+    {
+        const u32 row = tile[(flip & 1)?(7 - i):i];
+
+        dest[i] = (flip & 2)?hflipRow(row):row;
+    }
+}
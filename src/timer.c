@@ -8,9 +8,7 @@
 #include "sys.h"
 
 
-// TODO : use H counter for more accurate timer
-//
-// H Counter values
+// H Counter values (used by getHVTick())
 //
 // Description            32-cell         40-cell
 // ----------------------------------------------------------------------------
@@ -37,6 +35,10 @@ vu32 vtimer;
 
 static u32 timer[MAXTIMER];
 static u32 lastTick = 0;
+// HV clock state
+static u32 lastHVTick = 0;
+static u32 lastHVFrame = 0;
+static u16 lastHVLine = 0;
 
 
 // return elapsed time from console reset (1/76800 second based)
@@ -59,6 +61,103 @@ u32 getSubTick()
     return getSubTickInternal(GET_VDP_STATUS(VDP_VBLANK_FLAG), GET_VCOUNTER, vtimer);
 }
 
+u16 getHVTickPerLine()
+{
+    return (VDP_getScreenWidth() == 320)?211:171;
+}
+
+// return elapsed time from console reset (H counter unit based, see table above)
+u32 getHVTick()
+{
+    u32 frame;
+    u16 hv;
+    u16 blank;
+
+    // be sure vtimer matches HV counter value
+    do
+    {
+        frame = vtimer;
+        hv = GET_HVCOUNTER;
+        blank = GET_VDP_STATUS(VDP_VBLANK_FLAG);
+    } while(frame != vtimer);
+
+    const u16 hc = hv & 0xFF;
+    const u16 vc = hv >> 8;
+    const u16 scrH = VDP_getScreenHeight();
+    u16 hpl, h, lpf;
+    u16 line, line2;
+
+    // linear H position (remove H counter jump)
+    if (VDP_getScreenWidth() == 320)
+    {
+        hpl = 211;
+        h = (hc <= 0xB6)?hc:(hc - (0xE4 - 0xB7));
+    }
+    else
+    {
+        hpl = 171;
+        h = (hc <= 0x93)?hc:(hc - (0xE9 - 0x94));
+    }
+
+    // lines are counted from first active line, VBlank lines belong to the frame before V-Int
+    if (blank) frame--;
+
+    // second possible interpretation of V counter value (0xFFFF = none)
+    line2 = 0xFFFF;
+
+    if (IS_PAL_SYSTEM)
+    {
+        const u16 wrapEnd = (scrH == 240)?0x0A:0x02;
+        const u16 jumpStart = (scrH == 240)?0xD2:0xCA;
+
+        lpf = 313;
+
+        if (!blank) line = vc;
+        // V counter wrapped to 0 in VBlank
+        else if (vc <= wrapEnd) line = 256 + vc;
+        else
+        {
+            line = vc;
+            // V counter jumped back
+            if (vc >= jumpStart) line2 = (256 + wrapEnd + 1) + (vc - jumpStart);
+        }
+    }
+    else
+    {
+        lpf = 262;
+
+        if (!blank) line = vc;
+        else
+        {
+            // V counter jumped back (0xEA --> 0xE5)
+            if (vc > 0xEA) line = vc + 6;
+            else
+            {
+                line = vc;
+                if (vc >= 0xE5) line2 = vc + 6;
+            }
+        }
+    }
+
+    // ambiguous V counter value --> choose the one keeping the clock monotonic
+    if ((line2 != 0xFFFF) && (frame == lastHVFrame) && (line < lastHVLine)) line = line2;
+
+    u32 result = (frame * (u32) (lpf * hpl)) + (line * hpl) + h;
+
+    // V-Int not yet processed (interrupts disabled) --> fix
+    if (result < lastHVTick)
+    {
+        frame++;
+        result += lpf * hpl;
+    }
+
+    lastHVTick = result;
+    lastHVFrame = frame;
+    lastHVLine = line;
+
+    return result;
+}
+
 // return elapsed time from console reset (1/300 second based)
 u32 getTick()
 {
@@ -21,9 +21,33 @@ static Bitmap *allocateBitmapInternal(void *adr);
 static TileSet *allocateTileSetInternal(void *adr);
 static TileMap *allocateTileMapInternal(void *adr);
 
+// log record kind
+#define LOG_TEXT        0
+#define LOG_UINT        1
+#define LOG_INT         2
+#define LOG_FIX16       3
+#define LOG_FIX32       4
+
+// maximum number of character copied in the log buffer for a text not located in ROM
+#define LOG_TEXT_COPY_MAX   63
+// text stored in the log buffer (instead of a pointer) marker
+#define LOG_TEXT_COPY       0x80000000
+
+// forward
+static void logFormat(u16 kind, u16 param, u16 nt, u16 nv, char* const* t, const u32* v);
+static void logValues(u16 kind, u16 param, u16 nt, u16 nv, char* const* t, const u32* v);
+
 // internal
 u16 randbase;
 
+#if (ENABLE_KLOG_BUFFER != 0)
+// log record ring buffer
+static u32 logBuffer[KLOG_BUFFER_SIZE];
+static u16 logHead;
+static u16 logTail;
+static u16 logDropped;
+#endif
+
 
 void setRandomSeed(u16 seed)
 {
@@ -64,754 +88,575 @@ u16 kprintf(const char *fmt, ...)
     i = vsprintf(buffer, fmt, args);
     va_end(args);
 
-    KLog(buffer);
+    // buffer is on stack so never defer it
+    char* t = buffer;
+    logFormat(LOG_TEXT, 0, 1, 0, &t, NULL);
 
     return i;
 }
 
 
+// format a log record (texts interleaved with values) and send it to the debug port
+static void logFormat(u16 kind, u16 param, u16 nt, u16 nv, char* const* t, const u32* v)
+{
+    char str[256];
+    char* dst = str;
+
+    for(u16 i = 0; i < nt; i++)
+    {
+        dst = strPutStr(dst, t[i]);
+
+        if (i < nv)
+        {
+            switch(kind)
+            {
+                case LOG_UINT:
+                    dst = strPutUInt(dst, v[i], param);
+                    break;
+
+                case LOG_INT:
+                    dst = strPutInt(dst, (s32) v[i], param);
+                    break;
+
+                case LOG_FIX16:
+                    dst = strPutFix16(dst, (fix16) v[i], param);
+                    break;
+
+                case LOG_FIX32:
+                    dst = strPutFix32(dst, (fix32) v[i], param);
+                    break;
+            }
+        }
+    }
+
+    // empty string is not accepted by KDebug_Alert(..)
+    if (str[0] == 0) KDebug_Alert(" ");
+    else KDebug_Alert(str);
+}
+
+#if (ENABLE_KLOG_BUFFER != 0)
+
+// text located in ROM remains valid until flush so we only need to store its pointer
+static bool isROMText(const char* text)
+{
+    return ((u32) text) < ROM_END;
+}
+
+// return number of long word needed to store the given text in the log buffer
+static u16 getTextSize(const char* text, u16* len)
+{
+    if (isROMText(text))
+    {
+        *len = 0;
+        return 1;
+    }
+
+    u16 l = 0;
+    while((l < LOG_TEXT_COPY_MAX) && text[l]) l++;
+    *len = l;
+
+    // marker + characters (including null terminator)
+    return 1 + ((l + 4) >> 2);
+}
+
+static void logValues(u16 kind, u16 param, u16 nt, u16 nv, char* const* t, const u32* v)
+{
+    u16 len[5];
+    u16 size = 1 + nv;
+
+    for(u16 i = 0; i < nt; i++)
+        size += getTextSize(t[i], &len[i]);
+
+    // logging can happen in interrupt
+    const u16 intLevel = SYS_getAndSetInterruptMaskLevel(7);
+    const u16 used = (logHead - logTail) & (KLOG_BUFFER_SIZE - 1);
+
+    // not enough room --> drop record
+    if ((used + size) >= KLOG_BUFFER_SIZE)
+    {
+        logDropped++;
+        SYS_setInterruptMaskLevel(intLevel);
+        return;
+    }
+
+    u16 pos = logHead;
+
+    // record header: kind, number of text, number of value and format parameter
+    logBuffer[pos] = ((u32) kind << 24) | ((u32) nt << 20) | ((u32) nv << 16) | param;
+    pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+
+    for(u16 i = 0; i < nt; i++)
+    {
+        const char* src = t[i];
+        const u16 l = len[i];
+
+        if (isROMText(src))
+        {
+            // only text pointer is stored
+            logBuffer[pos] = (u32) src;
+            pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+        }
+        else
+        {
+            // text can be on stack or modified before flush --> copy it
+            logBuffer[pos] = LOG_TEXT_COPY | l;
+            pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+
+            for(u16 c = 0; c <= l; c += 4)
+            {
+                char* dst = (char*) &logBuffer[pos];
+
+                for(u16 j = 0; j < 4; j++)
+                    dst[j] = ((c + j) < l)?src[c + j]:0;
+
+                pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+            }
+        }
+
+        if (i < nv)
+        {
+            logBuffer[pos] = v[i];
+            pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+        }
+    }
+
+    logHead = pos;
+
+    SYS_setInterruptMaskLevel(intLevel);
+}
+
+void KLog_flush()
+{
+    char* t[5];
+    u32 v[4];
+    char texts[5][LOG_TEXT_COPY_MAX + 1];
+
+    while(logTail != logHead)
+    {
+        u16 pos = logTail;
+        const u32 header = logBuffer[pos];
+        const u16 nt = (header >> 20) & 0xF;
+        const u16 nv = (header >> 16) & 0xF;
+
+        pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+
+        for(u16 i = 0; i < nt; i++)
+        {
+            const u32 value = logBuffer[pos];
+            pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+
+            if (value & LOG_TEXT_COPY)
+            {
+                // text copied in buffer (may wrap so copy it back in a contiguous area)
+                const u16 l = value & 0xFF;
+                char* dst = texts[i];
+
+                for(u16 c = 0; c <= l; c += 4)
+                {
+                    const char* src = (const char*) &logBuffer[pos];
+
+                    for(u16 j = 0; j < 4; j++)
+                        if ((c + j) <= l) dst[c + j] = src[j];
+
+                    pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+                }
+
+                t[i] = dst;
+            }
+            else t[i] = (char*) value;
+
+            if (i < nv)
+            {
+                v[i] = logBuffer[pos];
+                pos = (pos + 1) & (KLOG_BUFFER_SIZE - 1);
+            }
+        }
+
+        // record is released only now as pushes in interrupt never touch it
+        logTail = pos;
+
+        logFormat(header >> 24, header & 0xFFFF, nt, nv, t, v);
+    }
+
+    if (logDropped)
+    {
+        t[0] = "KLog buffer full, records dropped: ";
+        v[0] = logDropped;
+        logDropped = 0;
+
+        logFormat(LOG_UINT, 1, 1, 1, t, v);
+    }
+}
+
+#else
+
+static void logValues(u16 kind, u16 param, u16 nt, u16 nv, char* const* t, const u32* v)
+{
+    logFormat(kind, param, nt, nv, t, v);
+}
+
+void KLog_flush()
+{
+    // nothing to do
+}
+
+#endif  // ENABLE_KLOG_BUFFER
+
 void KLog(char* text)
 {
-    if (*text == 0) KDebug_Alert(" ");
-    else KDebug_Alert(text);
+    logValues(LOG_TEXT, 0, 1, 0, &text, NULL);
 }
 
 void KLog_U1(char* t1, u32 v1)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
+    char* t[1] = {t1};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 1, 1, t, v);
 }
 
 void KLog_U1_(char* t1, u32 v1, char* t2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
+    char* t[2] = {t1, t2};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 2, 1, t, v);
 }
 
 void KLog_U2(char* t1, u32 v1, char* t2, u32 v2)
 {
-    char str[256];
-    char tmp[16];
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {v1, v2};
 
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, 1);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 2, 2, t, v);
 }
 
 void KLog_U2_(char* t1, u32 v1, char* t2, u32 v2, char* t3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[2] = {v1, v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 3, 2, t, v);
 }
 
 void KLog_U3(char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, 1);
-    strcat(str, tmp);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {v1, v2, v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 3, 3, t, v);
 }
 
 void KLog_U3_(char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3, char *t4)
 {
-    char str[256];
-    char tmp[16];
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[3] = {v1, v2, v3};
 
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t4);
-
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 4, 3, t, v);
 }
 
 void KLog_U4(char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3, char* t4, u32 v4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t4);
-    uintToStr(v4, tmp, 1);
-    strcat(str, tmp);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 4, 4, t, v);
 }
 
 void KLog_U4_(char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3, char* t4, u32 v4, char* t5)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t4);
-    uintToStr(v4, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t5);
+    char* t[5] = {t1, t2, t3, t4, t5};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, 1, 5, 4, t, v);
 }
 
 void KLog_U1x(u16 minSize, char* t1, u32 v1)
 {
-    char str[256];
-    char tmp[16];
+    char* t[1] = {t1};
+    const u32 v[1] = {v1};
 
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 1, 1, t, v);
 }
 
 void KLog_U1x_(u16 minSize, char* t1, u32 v1, char* t2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
+    char* t[2] = {t1, t2};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 2, 1, t, v);
 }
 
 void KLog_U2x(u16 minSize, char* t1, u32 v1, char* t2, u32 v2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, minSize);
-    strcat(str, tmp);
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {v1, v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 2, 2, t, v);
 }
 
 void KLog_U2x_(u16 minSize, char* t1, u32 v1, char* t2, u32 v2, char* t3)
 {
-    char str[256];
-    char tmp[16];
+    char* t[3] = {t1, t2, t3};
+    const u32 v[2] = {v1, v2};
 
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 3, 2, t, v);
 }
 
 void KLog_U3x(u16 minSize, char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, minSize);
-    strcat(str, tmp);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {v1, v2, v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 3, 3, t, v);
 }
 
 void KLog_U3x_(u16 minSize, char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3, char* t4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t4);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[3] = {v1, v2, v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 4, 3, t, v);
 }
 
 void KLog_U4x(u16 minSize, char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3, char* t4, u32 v4)
 {
-    char str[256];
-    char tmp[16];
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t4);
-    uintToStr(v4, tmp, minSize);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 4, 4, t, v);
 }
 
 void KLog_U4x_(u16 minSize, char* t1, u32 v1, char* t2, u32 v2, char* t3, u32 v3, char* t4, u32 v4, char* t5)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    uintToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    uintToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-    uintToStr(v3, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t4);
-    uintToStr(v4, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t5);
+    char* t[5] = {t1, t2, t3, t4, t5};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_UINT, minSize, 5, 4, t, v);
 }
 
 void KLog_S1(char* t1, s32 v1)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
+    char* t[1] = {t1};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 1, 1, t, v);
 }
 
 void KLog_S1_(char* t1, s32 v1, char* t2)
 {
-    char str[256];
-    char tmp[16];
+    char* t[2] = {t1, t2};
+    const u32 v[1] = {v1};
 
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 2, 1, t, v);
 }
 
 void KLog_S2(char* t1, s32 v1, char* t2, s32 v2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, 1);
-    strcat(str, tmp);
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {v1, v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 2, 2, t, v);
 }
 
 void KLog_S2_(char* t1, s32 v1, char* t2, s32 v2, char* t3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[2] = {v1, v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 3, 2, t, v);
 }
 
 void KLog_S3(char* t1, s32 v1, char* t2, s32 v2, char* t3, s32 v3)
 {
-    char str[256];
-    char tmp[16];
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {v1, v2, v3};
 
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    intToStr(v3, tmp, 1);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 3, 3, t, v);
 }
 
 void KLog_S3_(char* t1, s32 v1, char* t2, s32 v2, char* t3, s32 v3, char* t4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    intToStr(v3, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t4);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[3] = {v1, v2, v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 4, 3, t, v);
 }
 
 void KLog_S4(char* t1, s32 v1, char* t2, s32 v2, char* t3, s32 v3, char* t4, s32 v4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    intToStr(v3, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t4);
-    intToStr(v4, tmp, 1);
-    strcat(str, tmp);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 4, 4, t, v);
 }
 
 void KLog_S4_(char* t1, s32 v1, char* t2, s32 v2, char* t3, s32 v3, char* t4, s32 v4, char* t5)
 {
-    char str[256];
-    char tmp[16];
+    char* t[5] = {t1, t2, t3, t4, t5};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    strcpy(str, t1);
-    intToStr(v1, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t3);
-    intToStr(v3, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t4);
-    intToStr(v4, tmp, 1);
-    strcat(str, tmp);
-    strcat(str, t5);
-
-    KDebug_Alert(str);
+    logValues(LOG_INT, 1, 5, 4, t, v);
 }
 
 void KLog_S1x(u16 minSize, char* t1, s32 v1)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, minSize);
-    strcat(str, tmp);
+    char* t[1] = {t1};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, minSize, 1, 1, t, v);
 }
 
 void KLog_S2x(u16 minSize, char* t1, s32 v1, char* t2, s32 v2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, minSize);
-    strcat(str, tmp);
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {v1, v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, minSize, 2, 2, t, v);
 }
 
 void KLog_S3x(u16 minSize, char* t1, s32 v1, char* t2, s32 v2, char* t3, s32 v3)
 {
-    char str[256];
-    char tmp[16];
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {v1, v2, v3};
 
-    strcpy(str, t1);
-    intToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-    intToStr(v3, tmp, minSize);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_INT, minSize, 3, 3, t, v);
 }
 
 void KLog_S4x(u16 minSize, char* t1, s32 v1, char* t2, s32 v2, char* t3, s32 v3, char* t4, s32 v4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    intToStr(v1, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t2);
-    intToStr(v2, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t3);
-    intToStr(v3, tmp, minSize);
-    strcat(str, tmp);
-    strcat(str, t4);
-    intToStr(v4, tmp, minSize);
-    strcat(str, tmp);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_INT, minSize, 4, 4, t, v);
 }
 
 void KLog_f1(char* t1, fix16 v1)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, 2);
-    strcat(str, tmp);
+    char* t[1] = {t1};
+    const u32 v[1] = {(s32) v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, 2, 1, 1, t, v);
 }
 
 void KLog_f2(char* t1, fix16 v1, char* t2, fix16 v2)
 {
-    char str[256];
-    char tmp[16];
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {(s32) v1, (s32) v2};
 
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix16ToStr(v2, tmp, 2);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, 2, 2, 2, t, v);
 }
 
 void KLog_f3(char* t1, fix16 v1, char* t2, fix16 v2, char* t3, fix16 v3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix16ToStr(v2, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix16ToStr(v3, tmp, 2);
-    strcat(str, tmp);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {(s32) v1, (s32) v2, (s32) v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, 2, 3, 3, t, v);
 }
 
 void KLog_f4(char* t1, fix16 v1, char* t2, fix16 v2, char* t3, fix16 v3, char* t4, fix16 v4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix16ToStr(v2, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix16ToStr(v3, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t4);
-    fix16ToStr(v4, tmp, 2);
-    strcat(str, tmp);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {(s32) v1, (s32) v2, (s32) v3, (s32) v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, 2, 4, 4, t, v);
 }
 
 void KLog_f1x(s16 numDec, char* t1, fix16 v1)
 {
-    char str[256];
-    char tmp[16];
+    char* t[1] = {t1};
+    const u32 v[1] = {(s32) v1};
 
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, numDec, 1, 1, t, v);
 }
 
 void KLog_f2x(s16 numDec, char* t1, fix16 v1, char* t2, fix16 v2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix16ToStr(v2, tmp, numDec);
-    strcat(str, tmp);
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {(s32) v1, (s32) v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, numDec, 2, 2, t, v);
 }
 
 void KLog_f3x(s16 numDec, char* t1, fix16 v1, char* t2, fix16 v2, char* t3, fix16 v3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix16ToStr(v2, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix16ToStr(v3, tmp, numDec);
-    strcat(str, tmp);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {(s32) v1, (s32) v2, (s32) v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, numDec, 3, 3, t, v);
 }
 
 void KLog_f4x(s16 numDec, char* t1, fix16 v1, char* t2, fix16 v2, char* t3, fix16 v3, char* t4, fix16 v4)
 {
-    char str[256];
-    char tmp[16];
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {(s32) v1, (s32) v2, (s32) v3, (s32) v4};
 
-    strcpy(str, t1);
-    fix16ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix16ToStr(v2, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix16ToStr(v3, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t4);
-    fix16ToStr(v4, tmp, numDec);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_FIX16, numDec, 4, 4, t, v);
 }
 
 void KLog_F1(char* t1, fix32 v1)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, 2);
-    strcat(str, tmp);
+    char* t[1] = {t1};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, 2, 1, 1, t, v);
 }
 
 void KLog_F2(char* t1, fix32 v1, char* t2, fix32 v2)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix32ToStr(v2, tmp, 2);
-    strcat(str, tmp);
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {v1, v2};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, 2, 2, 2, t, v);
 }
 
 void KLog_F3(char* t1, fix32 v1, char* t2, fix32 v2, char* t3, fix32 v3)
 {
-    char str[256];
-    char tmp[16];
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {v1, v2, v3};
 
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix32ToStr(v2, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix32ToStr(v3, tmp, 2);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, 2, 3, 3, t, v);
 }
 
 void KLog_F4(char* t1, fix32 v1, char* t2, fix32 v2, char* t3, fix32 v3, char* t4, fix32 v4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix32ToStr(v2, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix32ToStr(v3, tmp, 2);
-    strcat(str, tmp);
-    strcat(str, t4);
-    fix32ToStr(v4, tmp, 2);
-    strcat(str, tmp);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, 2, 4, 4, t, v);
 }
 
 void KLog_F1x(s16 numDec, char* t1, fix32 v1)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
+    char* t[1] = {t1};
+    const u32 v[1] = {v1};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, numDec, 1, 1, t, v);
 }
 
 void KLog_F2x(s16 numDec, char* t1, fix32 v1, char* t2, fix32 v2)
 {
-    char str[256];
-    char tmp[16];
+    char* t[2] = {t1, t2};
+    const u32 v[2] = {v1, v2};
 
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix32ToStr(v2, tmp, numDec);
-    strcat(str, tmp);
-
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, numDec, 2, 2, t, v);
 }
 
 void KLog_F3x(s16 numDec, char* t1, fix32 v1, char* t2, fix32 v2, char* t3, fix32 v3)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix32ToStr(v2, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix32ToStr(v3, tmp, numDec);
-    strcat(str, tmp);
+    char* t[3] = {t1, t2, t3};
+    const u32 v[3] = {v1, v2, v3};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, numDec, 3, 3, t, v);
 }
 
 void KLog_F4x(s16 numDec, char* t1, fix32 v1, char* t2, fix32 v2, char* t3, fix32 v3, char* t4, fix32 v4)
 {
-    char str[256];
-    char tmp[16];
-
-    strcpy(str, t1);
-    fix32ToStr(v1, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t2);
-    fix32ToStr(v2, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t3);
-    fix32ToStr(v3, tmp, numDec);
-    strcat(str, tmp);
-    strcat(str, t4);
-    fix32ToStr(v4, tmp, numDec);
-    strcat(str, tmp);
+    char* t[4] = {t1, t2, t3, t4};
+    const u32 v[4] = {v1, v2, v3, v4};
 
-    KDebug_Alert(str);
+    logValues(LOG_FIX32, numDec, 4, 4, t, v);
 }
 
 
@@ -971,28 +816,37 @@ Image *allocateImage(const Image *image)
 }
 
 Map *allocateMap(const MapDefinition *mapDef)
+{
+    return allocateMapEx(mapDef, MAP_BLOCK_CACHE_SIZE_DEFAULT);
+}
+
+Map *allocateMapEx(const MapDefinition *mapDef, u16 blockCacheSize)
 {
     u16 baseSize = sizeof(Map);
     u16 metaTilesSize;
     u16 blocksSize;
     u16 blockIndexesSize;
+    u16 blockSize = 8 * 8;
+    const u16 compression = mapDef->compression;
+    const bool streamed = (compression & MAP_BLOCKS_STREAM) != 0;
+
+    if (mapDef->numMetaTile > 256) blockSize *= 2;
 
-    // need to allocate memory for packed data buffers
-    if (mapDef->compression != COMPRESSION_NONE)
+    // need to allocate memory for packed data buffers (direct reference is used otherwise)
+    if (compression & 0xF) metaTilesSize = mapDef->numMetaTile * 4 * 2;
+    else metaTilesSize = 0;
+
+    // streamed blocks --> only need block cache
+    if (streamed) blocksSize = sizeof(MapBlockCache) + (blockCacheSize * ((2 * sizeof(u16)) + blockSize));
+    else if (compression & 0xF0) blocksSize = mapDef->numBlock * blockSize;
+    else blocksSize = 0;
+
+    if (compression & 0xF00)
     {
-        metaTilesSize = mapDef->numMetaTile * 4 * 2;
-        blocksSize = mapDef->numBlock * 8 * 8;
-        if (mapDef->numMetaTile > 256) blocksSize *= 2;
         blockIndexesSize = mapDef->w * mapDef->hp;
         if (mapDef->numBlock > 256) blockIndexesSize *= 2;
     }
-    else
-    {
-        // can use direct reference
-        metaTilesSize = 0;
-        blocksSize = 0;
-        blockIndexesSize = 0;
-    }
+    else blockIndexesSize = 0;
 
     const void *adr = MEM_alloc(baseSize + metaTilesSize + blocksSize + blockIndexesSize);
 
@@ -1007,6 +861,22 @@ Map *allocateMap(const MapDefinition *mapDef)
         result->blocks = (void*) (adr + baseSize + metaTilesSize);
         // allocate blockIndexes buffer
         result->blockIndexes = (void*) (adr + baseSize + metaTilesSize + blocksSize);
+
+        if (streamed)
+        {
+            // blocks buffer receive block cache
+            MapBlockCache* cache = (MapBlockCache*) result->blocks;
+
+            cache->size = blockCacheSize;
+            cache->blockSize = blockSize;
+            cache->ids = (u16*) (cache + 1);
+            cache->stamps = cache->ids + blockCacheSize;
+            cache->data = (u8*) (cache->stamps + blockCacheSize);
+
+            result->blockCache = cache;
+            result->blocks = NULL;
+        }
+        else result->blockCache = NULL;
     }
 
     return result;
@@ -1139,11 +1009,44 @@ u32 unpack(u16 compression, u8 *src, u8 *dest)
         case COMPRESSION_LZ4W:
             return lz4w_unpack(src, dest);
 
+        case COMPRESSION_DLZ:
+            return dlz_unpack(src, dest);
+
+        case COMPRESSION_RLE:
+            return rle_unpack(src, dest);
+
         default:
             return 0;
     }
 }
 
+u32 rle_unpack(const u8 *src, u8 *dest)
+{
+    u8* dst = dest;
+    u16 com;
+
+    while((com = *src++))
+    {
+        // run
+        if (com & 0x80)
+        {
+            const u8 value = *src++;
+            u16 n = com - 126;
+
+            while(n--) *dst++ = value;
+        }
+        // literals
+        else
+        {
+            u16 n = com;
+
+            while(n--) *dst++ = *src++;
+        }
+    }
+
+    return dst - dest;
+}
+
 
 #define QSORT(type)                                     \
     u16 partition_##type(type *data, u16 p, u16 r)      \
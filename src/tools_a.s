@@ -115,6 +115,282 @@ partition:
     rts
 
 
+// ---------------------------------------------------------------
+// Counting sort (u8 keys) / radix sort (u16 keys) with payload
+// and insertion sort for nearly sorted data
+//
+// void radixsort_u8(u8* keys, void** values, u16 len, void* tmp);
+// void radixsort_u16(u16* keys, void** values, u16 len, void* tmp);
+// void insertsort_u16(u16* keys, void** values, u16 len);
+// void insertsort_s16(s16* keys, void** values, u16 len);
+// ---------------------------------------------------------------
+
+func radixsort_u8
+    movem.l %d2-%d6/%a2-%a5,-(%sp)
+
+    move.w  50(%sp),%d2             // d2 = len
+    jeq     .rs8_end
+
+    move.l  40(%sp),%a0             // a0 = keys
+    move.l  44(%sp),%a1             // a1 = values
+    move.l  52(%sp),%a3             // a3 = tmp values
+
+    lea     -512(%sp),%sp           // histogram (256 words) on stack
+    move.l  %sp,%a5
+
+    move.l  %a5,%a4                 // clear histogram
+    moveq   #0,%d0
+    moveq   #31,%d1
+.rs8_clr:
+    move.l  %d0,(%a4)+
+    move.l  %d0,(%a4)+
+    move.l  %d0,(%a4)+
+    move.l  %d0,(%a4)+
+    dbra    %d1,.rs8_clr
+
+    move.l  %a0,%a4                 // count keys
+    move.w  %d2,%d1
+    subq.w  #1,%d1
+.rs8_cnt:
+    moveq   #0,%d0
+    move.b  (%a4)+,%d0
+    add.w   %d0,%d0
+    addq.w  #1,0(%a5,%d0.w)
+    dbra    %d1,.rs8_cnt
+
+    move.l  %a5,%a4                 // histogram --> bucket start positions
+    moveq   #0,%d0
+    move.w  #255,%d1
+.rs8_sum:
+    move.w  (%a4),%d4
+    move.w  %d0,(%a4)+
+    add.w   %d4,%d0
+    dbra    %d1,.rs8_sum
+
+    move.l  %a0,%a4                 // scatter values in tmp
+    move.w  %d2,%d1
+    subq.w  #1,%d1
+.rs8_scat:
+    moveq   #0,%d0
+    move.b  (%a4)+,%d0
+    add.w   %d0,%d0                 // d0 = bucket offset
+    moveq   #0,%d6
+    move.w  0(%a5,%d0.w),%d6        // d6 = position
+    addq.w  #1,0(%a5,%d0.w)
+    add.l   %d6,%d6
+    add.l   %d6,%d6
+    move.l  (%a1)+,0(%a3,%d6.l)
+    dbra    %d1,.rs8_scat
+
+    move.l  %a0,%a4                 // rebuild keys from bucket end positions
+    move.l  %a5,%a2
+    moveq   #0,%d0                  // d0 = key
+    moveq   #0,%d3                  // d3 = previous bucket end
+    move.w  #255,%d1
+.rs8_key:
+    move.w  (%a2)+,%d4
+    move.w  %d4,%d6
+    sub.w   %d3,%d6                 // d6 = bucket size
+    move.w  %d4,%d3
+    jra     .rs8_fill_start
+.rs8_fill:
+    move.b  %d0,(%a4)+
+.rs8_fill_start:
+    dbra    %d6,.rs8_fill
+    addq.w  #1,%d0
+    dbra    %d1,.rs8_key
+
+    move.l  556(%sp),%a1            // copy back values
+    move.w  %d2,%d1
+    subq.w  #1,%d1
+.rs8_copy:
+    move.l  (%a3)+,(%a1)+
+    dbra    %d1,.rs8_copy
+
+    lea     512(%sp),%sp
+
+.rs8_end:
+    movem.l (%sp)+,%d2-%d6/%a2-%a5
+    rts
+
+
+func radixsort_u16
+    movem.l %d2-%d6/%a2-%a5,-(%sp)
+
+    move.w  50(%sp),%d2             // d2 = len
+    jeq     .rs16_end
+
+    move.l  40(%sp),%a0             // a0 = keys
+    move.l  44(%sp),%a1             // a1 = values
+    move.l  52(%sp),%a2             // a2 = tmp keys
+    moveq   #0,%d0
+    move.w  %d2,%d0
+    add.l   %d0,%d0
+    lea     0(%a2,%d0.l),%a3        // a3 = tmp values
+
+    lea     -512(%sp),%sp           // histogram (256 words) on stack
+    move.l  %sp,%a5
+
+    moveq   #0,%d5                  // low byte pass: keys --> tmp
+    bsr     rs16pass
+
+    move.l  %a2,%a0                 // high byte pass: tmp --> keys
+    move.l  %a3,%a1
+    move.l  552(%sp),%a2
+    move.l  556(%sp),%a3
+    moveq   #8,%d5
+    bsr     rs16pass
+
+    lea     512(%sp),%sp
+
+.rs16_end:
+    movem.l (%sp)+,%d2-%d6/%a2-%a5
+    rts
+
+// ---------------------------------------------------------------
+// Counting sort pass on u16 keys (stable)
+// a0 = src keys, a1 = src values
+// a2 = dst keys, a3 = dst values
+// a5 = histogram (256 words)
+// d2 = len (> 0), d5 = key shift (0 or 8)
+// ---------------------------------------------------------------
+rs16pass:
+    move.l  %a5,%a4                 // clear histogram
+    moveq   #0,%d0
+    moveq   #31,%d1
+.rs16_clr:
+    move.l  %d0,(%a4)+
+    move.l  %d0,(%a4)+
+    move.l  %d0,(%a4)+
+    move.l  %d0,(%a4)+
+    dbra    %d1,.rs16_clr
+
+    move.w  #0x1FE,%d3              // d3 = bucket offset mask
+
+    move.l  %a0,%a4                 // count keys
+    move.w  %d2,%d1
+    subq.w  #1,%d1
+.rs16_cnt:
+    move.w  (%a4)+,%d0
+    lsr.w   %d5,%d0
+    add.w   %d0,%d0
+    and.w   %d3,%d0
+    addq.w  #1,0(%a5,%d0.w)
+    dbra    %d1,.rs16_cnt
+
+    move.l  %a5,%a4                 // histogram --> bucket start positions
+    moveq   #0,%d0
+    move.w  #255,%d1
+.rs16_sum:
+    move.w  (%a4),%d4
+    move.w  %d0,(%a4)+
+    add.w   %d4,%d0
+    dbra    %d1,.rs16_sum
+
+    move.w  %d2,%d1                 // scatter keys and values
+    subq.w  #1,%d1
+.rs16_scat:
+    move.w  (%a0)+,%d4              // d4 = key
+    move.w  %d4,%d0
+    lsr.w   %d5,%d0
+    add.w   %d0,%d0
+    and.w   %d3,%d0                 // d0 = bucket offset
+    moveq   #0,%d6
+    move.w  0(%a5,%d0.w),%d6        // d6 = position
+    addq.w  #1,0(%a5,%d0.w)
+    add.l   %d6,%d6
+    move.w  %d4,0(%a2,%d6.l)
+    add.l   %d6,%d6
+    move.l  (%a1)+,0(%a3,%d6.l)
+    dbra    %d1,.rs16_scat
+
+    rts
+
+
+func insertsort_u16
+    movem.l %d2-%d4/%a2-%a3,-(%sp)
+
+    move.l  24(%sp),%d3             // d3 = keys
+    move.l  28(%sp),%a3             // a3 = values
+    move.w  34(%sp),%d2             // d2 = len
+    cmpi.w  #2,%d2
+    jcs     .isu_end
+
+    subq.w  #2,%d2                  // len - 1 iterations
+    move.l  %d3,%a2
+    addq.l  #2,%a2                  // a2 = &keys[1]
+    addq.l  #4,%a3                  // a3 = &values[1]
+
+.isu_loop:
+    move.w  (%a2)+,%d0              // d0 = key
+    move.l  (%a3)+,%d1              // d1 = value
+    lea     -2(%a2),%a0             // a0 = &keys[j]
+    lea     -4(%a3),%a1             // a1 = &values[j]
+
+.isu_shift:
+    cmpa.l  %d3,%a0                 // j = 0 ?
+    jeq     .isu_put
+    move.w  -2(%a0),%d4
+    cmp.w   %d0,%d4                 // keys[j-1] <= key ? (stable)
+    jls     .isu_put
+    move.w  %d4,(%a0)               // shift
+    subq.l  #2,%a0
+    move.l  -4(%a1),(%a1)
+    subq.l  #4,%a1
+    jra     .isu_shift
+
+.isu_put:
+    move.w  %d0,(%a0)
+    move.l  %d1,(%a1)
+    dbra    %d2,.isu_loop
+
+.isu_end:
+    movem.l (%sp)+,%d2-%d4/%a2-%a3
+    rts
+
+
+func insertsort_s16
+    movem.l %d2-%d4/%a2-%a3,-(%sp)
+
+    move.l  24(%sp),%d3             // d3 = keys
+    move.l  28(%sp),%a3             // a3 = values
+    move.w  34(%sp),%d2             // d2 = len
+    cmpi.w  #2,%d2
+    jcs     .iss_end
+
+    subq.w  #2,%d2                  // len - 1 iterations
+    move.l  %d3,%a2
+    addq.l  #2,%a2                  // a2 = &keys[1]
+    addq.l  #4,%a3                  // a3 = &values[1]
+
+.iss_loop:
+    move.w  (%a2)+,%d0              // d0 = key
+    move.l  (%a3)+,%d1              // d1 = value
+    lea     -2(%a2),%a0             // a0 = &keys[j]
+    lea     -4(%a3),%a1             // a1 = &values[j]
+
+.iss_shift:
+    cmpa.l  %d3,%a0                 // j = 0 ?
+    jeq     .iss_put
+    move.w  -2(%a0),%d4
+    cmp.w   %d0,%d4                 // keys[j-1] <= key ? (stable)
+    jle     .iss_put
+    move.w  %d4,(%a0)               // shift
+    subq.l  #2,%a0
+    move.l  -4(%a1),(%a1)
+    subq.l  #4,%a1
+    jra     .iss_shift
+
+.iss_put:
+    move.w  %d0,(%a0)
+    move.l  %d1,(%a1)
+    dbra    %d2,.iss_loop
+
+.iss_end:
+    movem.l (%sp)+,%d2-%d4/%a2-%a3
+    rts
+
+
 // -------------------------------------------------------------------------------------------------
 // Aplib decruncher for MC68000 "gcc version"
 // by MML 2010
@@ -3169,3 +3445,107 @@ lz4w_unpack_a:
 
     movem.l (%sp)+,%a2-%a4
     rts
+
+
+// ---------------------------------------------------------------------------
+// DLZ (delta LZ) unpacker for MC68000
+// by Stephane Dallongeville @2026
+//
+// word based commands (see DLZ packer for format details):
+// 00LLLLLL LLLLLLLL                    literal run (L+1 words)
+// 01LLLLLL DDDDDDDD                    delta run (L+1 words = previous word + D)
+// 10LLLLLL OOOOOOOO                    short match (L+2 words from O+1 words back)
+// 11LLLLLL LLLLLLLL OOOOOOOO OOOOOOOO  long match (L+2 words from O+1 words back)
+//
+// u32 dlz_unpack(const u8 *src, u8 *dest);  /* c prototype */
+// ---------------------------------------------------------------------------
+
+func dlz_unpack
+    move.l  4(%sp),%a0              // a0 = src
+    move.l  8(%sp),%a1              // a1 = dst
+
+    movem.l %d2-%d3/%a2-%a4,-(%sp)
+
+    move.l  %a1,%a3                 // a3 = dst start
+    move.l  (%a0)+,%d3              // d3 = unpacked size
+    move.l  %d3,%d0
+    bclr    #0,%d0
+    lea     (%a1,%d0.l),%a2         // a2 = end of word data
+
+.dlz_next:
+    cmp.l   %a2,%a1                 // done ?
+    jcc     .dlz_done
+
+    move.w  (%a0)+,%d0              // d0 = command
+    bmi.s   .dlz_match
+    btst    #14,%d0
+    bne.s   .dlz_delta
+
+.dlz_literal:
+    andi.w  #0x3FFF,%d0             // d0 = len - 1
+
+.dlz_lit_loop:
+    move.w  (%a0)+,(%a1)+
+    dbf     %d0,.dlz_lit_loop
+    bra.s   .dlz_next
+
+.dlz_delta:
+    move.w  %d0,%d2
+    ext.w   %d2                     // d2 = delta
+    lsr.w   #8,%d0
+    andi.w  #0x3F,%d0               // d0 = len - 1
+
+    moveq   #0,%d1                  // previous word is 0 at start
+    cmp.l   %a3,%a1
+    beq.s   .dlz_delta_loop
+    move.w  -2(%a1),%d1             // d1 = previous word
+
+.dlz_delta_loop:
+    add.w   %d2,%d1
+    move.w  %d1,(%a1)+
+    dbf     %d0,.dlz_delta_loop
+    bra.s   .dlz_next
+
+.dlz_match:
+    btst    #14,%d0
+    bne.s   .dlz_long_match
+
+    moveq   #0,%d2
+    move.b  %d0,%d2
+    addq.w  #1,%d2
+    add.w   %d2,%d2                 // d2 = match offset (in byte)
+    move.l  %a1,%a4
+    sub.l   %d2,%a4                 // a4 = match source
+
+    lsr.w   #8,%d0
+    andi.w  #0x3F,%d0
+    addq.w  #1,%d0                  // d0 = len - 1
+
+.dlz_copy:
+    move.w  (%a4)+,(%a1)+
+    dbf     %d0,.dlz_copy
+    bra.s   .dlz_next
+
+.dlz_long_match:
+    moveq   #0,%d2
+    move.w  (%a0)+,%d2
+    addq.l  #1,%d2
+    add.l   %d2,%d2                 // d2 = match offset (in byte)
+    move.l  %a1,%a4
+    sub.l   %d2,%a4                 // a4 = match source
+
+    andi.w  #0x3FFF,%d0
+    addq.w  #1,%d0                  // d0 = len - 1
+    bra.s   .dlz_copy
+
+.dlz_done:
+    btst    #0,%d3                  // need to copy a last byte ?
+    beq.s   .dlz_no_byte
+
+    move.b  (%a0),(%a1)+            // last byte is stored in upper byte of last word
+
+.dlz_no_byte:
+    move.l  %d3,%d0                 // return unpacked size
+
+    movem.l (%sp)+,%d2-%d3/%a2-%a4
+    rts
@@ -0,0 +1,152 @@
+#include "config.h"
+#include "types.h"
+
+#include "trace.h"
+
+#if (ENABLE_TRACE != 0)
+
+#include "sys.h"
+#include "vdp.h"
+#include "timer.h"
+#include "string.h"
+#include "kdebug.h"
+
+
+#define TRACE_MASK          (TRACE_BUFFER_SIZE - 1)
+// number of event per KDebug line
+#define LINE_EVENTS         16
+
+
+#if ((TRACE_BUFFER_SIZE & TRACE_MASK) != 0)
+#error "TRACE_BUFFER_SIZE should be a power of 2"
+#endif
+
+
+static struct
+{
+    u32 magic;
+    u16 size;
+    u16 pos;
+    u32 events[TRACE_BUFFER_SIZE];
+} buffer;
+
+TraceBuffer* const traceBuffer = (TraceBuffer*) &buffer;
+
+#if (TRACE_KDEBUG != 0)
+static u16 readPos;
+static u16 lost;
+#endif
+
+// user H-Int callback (called from _hint_trace_caller)
+__attribute__((externally_visible)) VoidCallback* traceHIntCB;
+
+
+static void push(u32 event);
+
+
+// called from internal_reset()
+void TRACE_init()
+{
+    buffer.magic = TRACE_MAGIC;
+    buffer.size = TRACE_BUFFER_SIZE;
+    buffer.pos = 0;
+#if (TRACE_KDEBUG != 0)
+    readPos = 0;
+    lost = 0;
+#endif
+}
+
+void TRACE_event(u16 type, u16 id)
+{
+    const u16 hv = GET_HVCOUNTER;
+
+    push((((u32) ((type << 14) | (id << 8) | (vtimer & 0xFF))) << 16) | hv);
+}
+
+void TRACE_extEvent(u16 id, u16 value)
+{
+    push((((u32) ((TRACE_EXT << 14) | (id << 8))) << 16) | value);
+}
+
+void TRACE_flush()
+{
+#if (TRACE_KDEBUG != 0)
+    // "#TRC " + 8 hex digits per event
+    char str[5 + (LINE_EVENTS * 8) + 1];
+    const u16 end = buffer.pos;
+    u16 pos = readPos;
+
+    if (lost)
+    {
+        char* dst = strPutStr(str, "#TRC ");
+        dst = strPutHex(dst, (((u32) ((TRACE_EXT << 14) | (TRACE_EXT_LOST << 8))) << 16) | lost, 8);
+        KDebug_Alert(str);
+        lost = 0;
+    }
+
+    while(pos != end)
+    {
+        char* dst = strPutStr(str, "#TRC ");
+        u16 n = LINE_EVENTS;
+
+        while(n-- && (pos != end))
+            dst = strPutHex(dst, buffer.events[pos++ & TRACE_MASK], 8);
+
+        KDebug_Alert(str);
+    }
+
+    readPos = pos;
+#endif
+}
+
+// called from V-Int handler (after frame counter increment)
+void _trace_vint_start()
+{
+    u16 config = IS_PAL_SYSTEM?1:0;
+
+    if (VDP_getScreenWidth() == 320) config |= 2;
+    if (VDP_getScreenHeight() == 240) config |= 4;
+
+    TRACE_extEvent(TRACE_EXT_FRAME, vtimer);
+    TRACE_extEvent(TRACE_EXT_CONFIG, config);
+    TRACE_event(TRACE_BEGIN, TRACE_ID_VINT);
+}
+
+void _trace_vint_end()
+{
+    TRACE_event(TRACE_END, TRACE_ID_VINT);
+}
+
+// called from _hint_trace_caller
+void _trace_hint_start()
+{
+    TRACE_event(TRACE_BEGIN, TRACE_ID_HINT);
+}
+
+void _trace_hint_end()
+{
+    TRACE_event(TRACE_END, TRACE_ID_HINT);
+}
+
+
+static void push(u32 event)
+{
+    // events can come from interrupts
+    const u16 mask = SYS_getAndSetInterruptMaskLevel(7);
+    const u16 pos = buffer.pos;
+
+#if (TRACE_KDEBUG != 0)
+    // not yet sent --> drop event
+    if ((u16) (pos - readPos) >= TRACE_BUFFER_SIZE) lost++;
+    else
+#endif
+    {
+        // RAM only mode keeps last events
+        buffer.events[pos & TRACE_MASK] = event;
+        buffer.pos = pos + 1;
+    }
+
+    SYS_setInterruptMaskLevel(mask);
+}
+
+#endif // ENABLE_TRACE
@@ -0,0 +1,24 @@
+#include "config.h"
+#include "asm_mac.i"
+
+#if (ENABLE_TRACE != 0)
+
+// H-Int entry point when trace is enabled (see SYS_setHIntCallback(..))
+// user callback is an interrupt function (ends with rte) so we build an exception frame to get control back
+func _hint_trace_caller
+    movem.l %d0-%d1/%a0-%a1,-(%sp)
+    jsr     _trace_hint_start
+    movem.l (%sp)+,%d0-%d1/%a0-%a1
+
+    pea     .hint_trace_ret(%pc)    // return address
+    move.w  %sr,-(%sp)              // and SR for rte
+    move.l  traceHIntCB,-(%sp)
+    rts                             // jump to user callback
+
+.hint_trace_ret:
+    movem.l %d0-%d1/%a0-%a1,-(%sp)
+    jsr     _trace_hint_end
+    movem.l (%sp)+,%d0-%d1/%a0-%a1
+    rte
+
+#endif
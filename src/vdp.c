@@ -14,31 +14,59 @@
 #include "timer.h"
 #include "sys.h"
 #include "task.h"
+#include "job.h"
 
 #include "font.h"
 #include "sprite_eng.h"
 
 
-#define WINDOW_DEFAULT          0xD000      // multiple of 0x1000 (0x0800 in H32)
+#define WINDOW_DEFAULT          VDP_WINDOW_DEFAULT  // multiple of 0x1000 (0x0800 in H32)
 #define HSCRL_DEFAULT           0xF000      // multiple of 0x0400
 #define SLIST_DEFAULT           0xF400      // multiple of 0x0400 (0x0200 in H32)
-#define APLAN_DEFAULT           0xE000      // multiple of 0x2000
-#define BPLAN_DEFAULT           0xC000      // multiple of 0x2000
+#define APLAN_DEFAULT           VDP_BG_A_DEFAULT    // multiple of 0x2000
+#define BPLAN_DEFAULT           VDP_BG_B_DEFAULT    // multiple of 0x2000
+
+// VRAM layout tables
+#define LAYOUT_BGA              0
+#define LAYOUT_BGB              1
+#define LAYOUT_WINDOW           2
+#define LAYOUT_SLIST            3
+#define LAYOUT_HSCRL            4
+#define LAYOUT_NUM_TABLE        5
+
+
+typedef struct
+{
+    u16 size;
+    u16 align;
+    u16 addr;
+} LayoutTable;
 
 
 // we don't want to share it
 extern u32 task_pc;
 // we don't want to share it
 extern bool addFrameLoad(u16 frameLoad, u32 vtime);
+// we don't want to share it
+extern vu16 VBlankProcess;
 
 // forward
 static void updateMapsAddress();
+static u16 placeTables(LayoutTable* tables, const u8* order, u16 num);
+static bool nextPermutation(u8* order, u16 num);
+static void updatePlaneRowOffset();
+static void updateWindowRowOffset();
+static void writeReg(u16 reg);
+static void writeRegNow(u16 reg);
 static bool computeFrameCPULoad(u16 blank, u16 vcnt, u32 vtime);
 u16 getAdjustedVCounterInternal(u16 blank, u16 vcnt);
 void updateUserTileMaxIndex();
 
 
 static u8 regValues[0x13];
+// deferred register writes
+static bool regDeferred;
+static u32 regDirty;
 
 u16 window_addr;
 u16 bga_addr;
@@ -57,6 +85,8 @@ u16 windowWidth;
 u16 planeWidthSft;
 u16 planeHeightSft;
 u16 windowWidthSft;
+u16 planeRowOffset[128];
+u16 windowRowOffset[32];
 
 u16 lastVCnt;
 
@@ -85,6 +115,8 @@ void VDP_init()
     planeWidthSft = 6;
     planeHeightSft = 5;
     windowWidthSft = 6;
+    updatePlaneRowOffset();
+    updateWindowRowOffset();
     lastVCnt = 0;
 
     regValues[0x00] = 0x04;
@@ -110,6 +142,9 @@ void VDP_init()
     // set registers
     pw = (u16 *) GFX_CTRL_PORT;
     for (i = 0x00; i < 0x13; i++) *pw = 0x8000 | (i << 8) | regValues[i];
+    // all registers written
+    regDeferred = FALSE;
+    regDirty = 0;
 
     maps_addr = 0;
     // update minimum address of all tilemap/table (default is plane B)
@@ -255,6 +290,7 @@ void VDP_setReg(u16 reg, u8 value)
                 windowWidth = 32;
                 windowWidthSft = 5;
             }
+            updateWindowRowOffset();
             break;
 
         case 0x0D:
@@ -295,13 +331,75 @@ void VDP_setReg(u16 reg, u8 value)
                 planeHeight = 32;
                 planeHeightSft = 5;
             }
+            updatePlaneRowOffset();
             break;
     }
 
-    if (reg < 0x13) regValues[reg] = v;
+    if (reg < 0x13)
+    {
+        regValues[reg] = v;
+
+        // auto increment and H-Int counter are always written immediately (used by transfer code and interrupts)
+        if ((reg == 0x0F) || (reg == 0x0A)) writeRegNow(reg);
+        else writeReg(reg);
+    }
+    else
+    {
+        // DMA registers are never deferred
+        pw = (u16 *) GFX_CTRL_PORT;
+        *pw = 0x8000 | (reg << 8) | v;
+    }
+}
+
+bool VDP_getRegDeferred()
+{
+    return regDeferred;
+}
+
+void VDP_setRegDeferred(bool value)
+{
+    // leaving deferred mode --> emit pending changes now
+    if (!value) VDP_flushRegs();
+
+    regDeferred = value;
+}
+
+u16 VDP_flushRegs()
+{
+    vu16 *pw;
+    u32 dirty;
+    u16 reg;
+    u16 num;
+
+    dirty = regDirty;
+    // nothing to do
+    if (!dirty) return 0;
+
+    regDirty = 0;
+    VBlankProcess &= ~PROCESS_VDP_REG_TASK;
 
     pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8000 | (reg << 8) | v;
+    reg = 0;
+    num = 0;
+    while(dirty)
+    {
+        if (dirty & 1)
+        {
+            *pw = 0x8000 | (reg << 8) | regValues[reg];
+            num++;
+        }
+
+        dirty >>= 1;
+        reg++;
+    }
+
+    return num;
+}
+
+// called from SYS_doVBlankProcess() to emit deferred register changes
+void VDP_doVBlankRegProcess()
+{
+    VDP_flushRegs();
 }
 
 bool VDP_getEnable()
@@ -311,13 +409,10 @@ bool VDP_getEnable()
 
 void VDP_setEnable(bool value)
 {
-    vu16 *pw;
-
     if (value) regValues[0x01] |= 0x40;
     else regValues[0x01] &= ~0x40;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8100 | regValues[0x01];
+    writeRegNow(0x01);
 }
 
 
@@ -334,26 +429,20 @@ u16 VDP_getScreenHeight()
 
 void VDP_setScreenHeight224()
 {
-    vu16 *pw;
-
     regValues[0x01] &= ~0x08;
     screenHeight = 224;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8100 | regValues[0x01];
+    writeReg(0x01);
 }
 
 void VDP_setScreenHeight240()
 {
-    vu16 *pw;
-
     if (IS_PAL_SYSTEM)
     {
         regValues[0x01] |= 0x08;
         screenHeight = 240;
 
-        pw = (u16 *) GFX_CTRL_PORT;
-        *pw = 0x8100 | regValues[0x01];
+        writeReg(0x01);
     }
 }
 
@@ -364,28 +453,24 @@ u16 VDP_getScreenWidth()
 
 void VDP_setScreenWidth256()
 {
-    vu16 *pw;
-
     regValues[0x0C] &= ~0x81;
     screenWidth = 256;
     windowWidth = 32;
     windowWidthSft = 5;
+    updateWindowRowOffset();
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8C00 | regValues[0x0C];
+    writeReg(0x0C);
 }
 
 void VDP_setScreenWidth320()
 {
-    vu16 *pw;
-
     regValues[0x0C] |= 0x81;
     screenWidth = 320;
     windowWidth = 64;
     windowWidthSft = 6;
+    updateWindowRowOffset();
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8C00 | regValues[0x0C];
+    writeReg(0x0C);
 }
 
 
@@ -401,7 +486,6 @@ u16 VDP_getPlaneHeight()
 
 void VDP_setPlaneSize(u16 w, u16 h, bool setupVram)
 {
-    vu16 *pw;
     u16 v = 0;
 
     if (w & 0x80)
@@ -459,9 +543,9 @@ void VDP_setPlaneSize(u16 w, u16 h, bool setupVram)
     }
 
     regValues[0x10] = v;
+    updatePlaneRowOffset();
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x9000 | regValues[0x10];
+    writeReg(0x10);
 
     if (setupVram)
     {
@@ -507,6 +591,110 @@ void VDP_setPlanSize(u16 w, u16 h)
     VDP_setPlaneSize(w, h, FALSE);
 }
 
+u16 VDP_setVRAMLayout(const VDPLayout* layout)
+{
+    LayoutTable tables[LAYOUT_NUM_TABLE];
+    LayoutTable best[LAYOUT_NUM_TABLE];
+    u8 order[LAYOUT_NUM_TABLE];
+    u16 bestLow = 0;
+
+    VDP_setPlaneSize(layout->planeWidth, layout->planeHeight, FALSE);
+
+    const bool h40 = (regValues[0x0C] & 0x81) != 0;
+    const u16 planeSize = (planeWidth * planeHeight) * 2;
+    // window table is always 32 rows (only visible rows are used, 30 at max)
+    const u16 windowRowSize = windowWidth * 2;
+    // window is placed on plane A if not used
+    const u16 num = layout->window?LAYOUT_NUM_TABLE:LAYOUT_NUM_TABLE - 1;
+
+    tables[LAYOUT_BGA].size = planeSize;
+    tables[LAYOUT_BGA].align = 0x2000;
+    tables[LAYOUT_BGB].size = planeSize;
+    tables[LAYOUT_BGB].align = 0x2000;
+    // 80 sprites in H40, 64 in H32
+    tables[LAYOUT_SLIST].size = h40?(80 * 8):(64 * 8);
+    tables[LAYOUT_SLIST].align = h40?0x400:0x200;
+    // one entry (4 bytes) per scanline (240 lines max), only the first entry is used in plane mode
+    tables[LAYOUT_HSCRL].size = (layout->hscrollMode == HSCROLL_PLANE)?4:(240 * 4);
+    tables[LAYOUT_HSCRL].align = 0x400;
+    tables[LAYOUT_WINDOW].size = windowRowSize * 30;
+    tables[LAYOUT_WINDOW].align = h40?0x1000:0x800;
+
+    // window is last so it's excluded from permutations when not used
+    order[0] = LAYOUT_BGA;
+    order[1] = LAYOUT_BGB;
+    order[2] = LAYOUT_SLIST;
+    order[3] = LAYOUT_HSCRL;
+    order[4] = LAYOUT_WINDOW;
+
+    // sort order by index so all permutations are visited
+    for(u16 i = 1; i < num; i++)
+    {
+        const u8 v = order[i];
+        u16 j = i;
+
+        while(j && (order[j - 1] > v))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = v;
+    }
+
+    // try all placement orders (120 at max) and keep the one giving the highest tables start address
+    do
+    {
+        const u16 low = placeTables(tables, order, num);
+
+        if (low > bestLow)
+        {
+            bestLow = low;
+            memcpy(best, tables, sizeof(tables));
+        }
+    } while(nextPermutation(order, num));
+
+    // should never happen
+    if (bestLow == 0)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("VDP_setVRAMLayout(..) failed: cannot place tables in VRAM");
+#endif
+        return 0;
+    }
+
+    bga_addr = best[LAYOUT_BGA].addr;
+    bgb_addr = best[LAYOUT_BGB].addr;
+    slist_addr = best[LAYOUT_SLIST].addr;
+    hscrl_addr = best[LAYOUT_HSCRL].addr;
+    // unused window shares plane A tilemap
+    window_addr = layout->window?best[LAYOUT_WINDOW].addr:bga_addr;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+    KLog_U3("VDP_setVRAMLayout(..): tables start = ", bestLow, " BGA = ", bga_addr, " BGB = ", bgb_addr);
+    KLog_U3("  window = ", window_addr, " sprite list = ", slist_addr, " hscroll = ", hscrl_addr);
+#endif
+
+    // clear tables area
+    DMA_doVRamFill(bestLow, 0x10000 - bestLow, 0, 1);
+    VDP_waitDMACompletion();
+
+    regValues[0x02] = bga_addr / 0x400;
+    regValues[0x03] = window_addr / 0x400;
+    regValues[0x04] = bgb_addr / 0x2000;
+    regValues[0x05] = slist_addr / 0x200;
+    regValues[0x0D] = hscrl_addr / 0x400;
+    writeReg(0x02);
+    writeReg(0x03);
+    writeReg(0x04);
+    writeReg(0x05);
+    writeReg(0x0D);
+
+    // move font and sprite engine VRAM region if needed
+    updateMapsAddress();
+
+    return TILE_FONT_INDEX - TILE_USER_INDEX;
+}
+
 u8 VDP_getVerticalScrollingMode()
 {
     return (regValues[0x0B] >> 2) & 1;
@@ -519,13 +707,10 @@ u8 VDP_getHorizontalScrollingMode()
 
 void VDP_setScrollingMode(u16 hscroll, u16 vscroll)
 {
-    vu16 *pw;
-
     regValues[0x0B] &= ~0x07;
     regValues[0x0B] |= ((vscroll & 1) << 2) | (hscroll & 3);
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8B00 | regValues[0x0B];
+    writeReg(0x0B);
 }
 
 
@@ -536,12 +721,9 @@ u8 VDP_getBackgroundColor()
 
 void VDP_setBackgroundColor(u8 value)
 {
-    vu16 *pw;
-
     regValues[0x07] = value & 0x3F;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8700 | regValues[0x07];
+    writeReg(0x07);
 }
 
 
@@ -568,13 +750,10 @@ u8 VDP_getDMAEnabled()
 
 void VDP_setDMAEnabled(u8 value)
 {
-    vu16 *pw;
-
     if (value) regValues[0x01] |= 0x10;
     else regValues[0x01] &= ~0x10;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8100 | regValues[0x01];
+    writeRegNow(0x01);
 }
 
 u8 VDP_getHVLatching()
@@ -584,46 +763,34 @@ u8 VDP_getHVLatching()
 
 void VDP_setHVLatching(u8 value)
 {
-    vu16 *pw;
-
     if (value) regValues[0x00] |= 0x02;
     else regValues[0x00] &= ~0x02;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8000 | regValues[0x00];
+    writeReg(0x00);
 }
 
 void VDP_setHInterrupt(u8 value)
 {
-    vu16 *pw;
-
     if (value) regValues[0x00] |= 0x10;
     else regValues[0x00] &= ~0x10;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8000 | regValues[0x00];
+    writeRegNow(0x00);
 }
 
 void VDP_setExtInterrupt(u8 value)
 {
-    vu16 *pw;
-
     if (value) regValues[0x0B] |= 0x08;
     else regValues[0x0B] &= ~0x08;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8B00 | regValues[0x0B];
+    writeReg(0x0B);
 }
 
 void VDP_setHilightShadow(u8 value)
 {
-    vu16 *pw;
-
     if (value) regValues[0x0C] |= 0x08;
     else regValues[0x0C] &= ~0x08;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8C00 | regValues[0x0C];
+    writeReg(0x0C);
 }
 
 
@@ -634,12 +801,9 @@ u8 VDP_getHIntCounter()
 
 void VDP_setHIntCounter(u8 value)
 {
-    vu16 *pw;
-
     regValues[0x0A] = value;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8A00 | regValues[0x0A];
+    writeRegNow(0x0A);
 }
 
 
@@ -686,28 +850,22 @@ u16 VDP_getHScrollTableAddress()
 
 void VDP_setBGAAddress(u16 value)
 {
-    vu16 *pw;
-
     bga_addr = value & 0xE000;
     updateMapsAddress();
 
     regValues[0x02] = bga_addr / 0x400;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8200 | regValues[0x02];
+    writeReg(0x02);
 }
 
 void VDP_setBGBAddress(u16 value)
 {
-    vu16 *pw;
-
     bgb_addr = value & 0xE000;
     updateMapsAddress();
 
     regValues[0x04] = bgb_addr / 0x2000;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8400 | regValues[0x04];
+    writeReg(0x04);
 }
 
 void VDP_setAPlanAddress(u16 value)
@@ -722,8 +880,6 @@ void VDP_setBPlanAddress(u16 value)
 
 void VDP_setWindowAddress(u16 value)
 {
-    vu16 *pw;
-
     // 40H mode
     if (regValues[0x0C] & 0x81) window_addr = value & 0xF000;
     // 32H mode
@@ -732,8 +888,7 @@ void VDP_setWindowAddress(u16 value)
 
     regValues[0x03] = window_addr / 0x400;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8300 | regValues[0x03];
+    writeReg(0x03);
 }
 
 void VDP_setWindowPlanAddress(u16 value)
@@ -743,8 +898,6 @@ void VDP_setWindowPlanAddress(u16 value)
 
 void VDP_setSpriteListAddress(u16 value)
 {
-    vu16 *pw;
-
     // 40H mode
     if (regValues[0x0C] & 0x81) slist_addr = value & 0xFC00;
     // 32H mode
@@ -753,27 +906,21 @@ void VDP_setSpriteListAddress(u16 value)
 
     regValues[0x05] = slist_addr / 0x200;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8500 | regValues[0x05];
+    writeReg(0x05);
 }
 
 void VDP_setHScrollTableAddress(u16 value)
 {
-    vu16 *pw;
-
     hscrl_addr = value & 0xFC00;
     updateMapsAddress();
 
     regValues[0x0D] = hscrl_addr / 0x400;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8D00 | regValues[0x0D];
+    writeReg(0x0D);
 }
 
 void VDP_setScanMode(u16 value)
 {
-    vu16 *pw;
-
     if (value == 0)
         // non-interlaced
         regValues[0x0C] &= ~0x06;
@@ -784,13 +931,26 @@ void VDP_setScanMode(u16 value)
         // interlace mode 2
         regValues[0x0C] |= 0x06;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x8C00 | regValues[0x0C];
+    writeReg(0x0C);
+}
+
+u16 VDP_getScanMode()
+{
+    switch(regValues[0x0C] & 0x06)
+    {
+        case 0x02:
+            return INTERLACED_MODE1;
+
+        case 0x06:
+            return INTERLACED_MODE2;
+
+        default:
+            return INTERLACED_NONE;
+    }
 }
 
 void VDP_setWindowHPos(u16 right, u16 pos)
 {
-    vu16 *pw;
     u16 v;
 
     v = pos & 0x7F;
@@ -798,13 +958,11 @@ void VDP_setWindowHPos(u16 right, u16 pos)
 
     regValues[0x11] = v;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x9100 | v;
+    writeReg(0x11);
 }
 
 void VDP_setWindowVPos(u16 down, u16 pos)
 {
-    vu16 *pw;
     u16 v;
 
     v = pos & 0x7F;
@@ -812,8 +970,7 @@ void VDP_setWindowVPos(u16 down, u16 pos)
 
     regValues[0x12] = v;
 
-    pw = (u16 *) GFX_CTRL_PORT;
-    *pw = 0x9200 | v;
+    writeReg(0x12);
 }
 
 
@@ -855,8 +1012,12 @@ bool VDP_waitVInt()
 
     // background user task ? --> switch to it (automatically switch back to front task on v-int)
     if (task_pc != NULL) TSK_userYield();
-    // otherwise we just wait for next VInt
-    else while (vtimer == t);
+    // otherwise we use remaining time for pending jobs then wait for next VInt
+    else
+    {
+        if (JOB_getNumPending()) JOB_process();
+        while (vtimer == t);
+    }
 
     return late;
 }
@@ -902,8 +1063,12 @@ bool VDP_waitVBlank(bool forceNext)
 
     // background user task ? --> switch to it (automatically switch back to front task on v-int)
     if (yield_to_user) TSK_userYield();
-    // otherwise we just wait end of active period
-    else while (!(*pw & VDP_VBLANK_FLAG));
+    // otherwise we use remaining time for pending jobs then wait end of active period
+    else
+    {
+        if (JOB_getNumPending()) JOB_process();
+        while (!(*pw & VDP_VBLANK_FLAG));
+    }
 
     return late;
 }
@@ -1029,3 +1194,128 @@ static void updateMapsAddress()
             SPR_defragVRAM();
     }
 }
+
+// place tables in given order, each at the highest free aligned location, returns lowest table address (0 if failed)
+static u16 placeTables(LayoutTable* tables, const u8* order, u16 num)
+{
+    u32 low = 0x10000;
+
+    for(u16 i = 0; i < num; i++)
+    {
+        LayoutTable* table = &tables[order[i]];
+        const u32 size = table->size;
+        s32 addr = -1;
+
+        // candidates: highest aligned address below VRAM end or below a placed table
+        for(u16 c = 0; c <= i; c++)
+        {
+            const u32 top = c?tables[order[c - 1]].addr:0x10000;
+
+            if (top < size) continue;
+
+            const u32 a = (top - size) & ~((u32) table->align - 1);
+
+            if ((s32) a <= addr) continue;
+
+            // check overlap with placed tables
+            u16 p;
+            for(p = 0; p < i; p++)
+            {
+                const LayoutTable* placed = &tables[order[p]];
+
+                if ((a < (placed->addr + (u32) placed->size)) && (placed->addr < (a + size))) break;
+            }
+
+            if (p == i) addr = a;
+        }
+
+        // no room left (tile area can't start at 0 anyway)
+        if (addr <= 0) return 0;
+
+        table->addr = addr;
+        if ((u32) addr < low) low = addr;
+    }
+
+    return low;
+}
+
+// next lexicographic permutation, returns FALSE when all permutations were visited
+static bool nextPermutation(u8* order, u16 num)
+{
+    s16 i = num - 2;
+
+    while((i >= 0) && (order[i] >= order[i + 1])) i--;
+    if (i < 0) return FALSE;
+
+    s16 j = num - 1;
+    while(order[j] <= order[i]) j--;
+
+    u8 t = order[i];
+    order[i] = order[j];
+    order[j] = t;
+
+    // reverse tail
+    for(j = num - 1, i++; i < j; i++, j--)
+    {
+        t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    return TRUE;
+}
+
+static void updatePlaneRowOffset()
+{
+    const u16 step = planeWidth * 2;
+    u16* dst = planeRowOffset;
+    u16 off = 0;
+    u16 i = planeHeight;
+
+    while(i--)
+    {
+        *dst++ = off;
+        off += step;
+    }
+}
+
+static void updateWindowRowOffset()
+{
+    const u16 step = windowWidth * 2;
+    u16* dst = windowRowOffset;
+    u16 off = 0;
+    u16 i = 32;
+
+    while(i--)
+    {
+        *dst++ = off;
+        off += step;
+    }
+}
+
+static void writeReg(u16 reg)
+{
+    vu16 *pw;
+
+    // deferred mode --> only mark register as modified, it will be written on next VBlank
+    if (regDeferred)
+    {
+        regDirty |= 1 << reg;
+        VBlankProcess |= PROCESS_VDP_REG_TASK;
+        return;
+    }
+
+    pw = (u16 *) GFX_CTRL_PORT;
+    *pw = 0x8000 | (reg << 8) | regValues[reg];
+}
+
+static void writeRegNow(u16 reg)
+{
+    vu16 *pw;
+
+    // pending value (if any) is written now
+    regDirty &= ~(1 << reg);
+
+    pw = (u16 *) GFX_CTRL_PORT;
+    *pw = 0x8000 | (reg << 8) | regValues[reg];
+}
@@ -30,6 +30,31 @@ static s16 vscroll[2];
 static u8 hscroll_update = 0;
 static u8 vscroll_update = 0;
 
+// scroll engine: pending (back) and uploaded (front) tables with dirty ranges
+#define SCROLL_LINES        240
+#define SCROLL_COLUMNS      20
+
+typedef struct
+{
+    s16 line[2][SCROLL_LINES];
+    s16 lineFront[2][SCROLL_LINES];
+    s16 column[2][SCROLL_COLUMNS];
+    s16 columnFront[2][SCROLL_COLUMNS];
+    // dirty ranges (min > max = not modified)
+    u16 lineMin[2];
+    u16 lineMax[2];
+    u16 columnMin[2];
+    u16 columnMax[2];
+} ScrollEngine;
+
+static ScrollEngine* scrollEngine = NULL;
+
+
+// forward
+static void setLine(u16 p, u16 line, s16 value);
+static void setColumn(u16 p, u16 column, s16 value);
+static void flushScrollEngine(void);
+
 
 void VDP_setHorizontalScroll(VDPPlane plane, s16 value)
 {
@@ -129,6 +154,212 @@ void VDP_setVerticalScrollTile(VDPPlane plane, u16 tile, s16* values, u16 len, T
     DMA_transfer(tm, DMA_VSRAM, values, addr, len, 4);
 }
 
+bool VDP_initScrollEngine(void)
+{
+    if (scrollEngine == NULL)
+    {
+        scrollEngine = MEM_alloc(sizeof(ScrollEngine));
+
+        if (scrollEngine == NULL)
+        {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog("VDP_initScrollEngine() failed: not enough memory");
+#endif
+            return FALSE;
+        }
+    }
+
+    // clear tables and force complete upload
+    memset(scrollEngine, 0, sizeof(ScrollEngine));
+    for(u16 p = 0; p < 2; p++)
+    {
+        scrollEngine->lineMin[p] = 0;
+        scrollEngine->lineMax[p] = SCROLL_LINES - 1;
+        scrollEngine->columnMin[p] = 0;
+        scrollEngine->columnMax[p] = SCROLL_COLUMNS - 1;
+    }
+
+    // add task for vblank process
+    VBlankProcess |= PROCESS_VDP_SCROLL_TASK;
+
+    return TRUE;
+}
+
+void VDP_releaseScrollEngine(void)
+{
+    if (scrollEngine)
+    {
+        MEM_free(scrollEngine);
+        scrollEngine = NULL;
+    }
+}
+
+s16* VDP_getLineScrollTable(VDPPlane plane)
+{
+    return scrollEngine->line[(plane == BG_B)?1:0];
+}
+
+void VDP_setLineScrollDirty(VDPPlane plane, u16 from, u16 len)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_LINES) - 1;
+
+    if (len == 0) return;
+
+    if (from < scrollEngine->lineMin[p]) scrollEngine->lineMin[p] = from;
+    if (to > scrollEngine->lineMax[p]) scrollEngine->lineMax[p] = to;
+    // add task for vblank process
+    VBlankProcess |= PROCESS_VDP_SCROLL_TASK;
+}
+
+void VDP_setLineScroll(VDPPlane plane, u16 from, u16 len, s16 value)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_LINES);
+
+    for(u16 i = from; i < to; i++) setLine(p, i, value);
+}
+
+void VDP_setLineScrollValues(VDPPlane plane, u16 from, const s16* values, u16 len)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_LINES);
+    const s16* src = values;
+
+    for(u16 i = from; i < to; i++) setLine(p, i, *src++);
+}
+
+void VDP_setLineScrollDoubled(VDPPlane plane, u16 from, const s16* values, u16 len)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_LINES);
+    const s16* src = values;
+
+    for(u16 i = from; i < to; i++)
+    {
+        setLine(p, i, *src);
+        // next value every 2 lines
+        if ((i - from) & 1) src++;
+    }
+}
+
+void VDP_setLineScrollWobble(VDPPlane plane, u16 from, u16 len, s16 base, fix16 amplitude, u16 phase, u16 freq)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_LINES);
+    u16 angle = phase;
+
+    for(u16 i = from; i < to; i++)
+    {
+        setLine(p, i, base + fix16ToInt(fix16Mul(amplitude, sinFix16(angle))));
+        angle += freq;
+    }
+}
+
+void VDP_setColumnScroll(VDPPlane plane, u16 from, u16 len, s16 value)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_COLUMNS);
+
+    for(u16 i = from; i < to; i++) setColumn(p, i, value);
+}
+
+void VDP_setColumnScrollValues(VDPPlane plane, u16 from, const s16* values, u16 len)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_COLUMNS);
+    const s16* src = values;
+
+    for(u16 i = from; i < to; i++) setColumn(p, i, *src++);
+}
+
+void VDP_setColumnScrollWobble(VDPPlane plane, u16 from, u16 len, s16 base, fix16 amplitude, u16 phase, u16 freq)
+{
+    const u16 p = (plane == BG_B)?1:0;
+    const u16 to = min(from + len, SCROLL_COLUMNS);
+    u16 angle = phase;
+
+    for(u16 i = from; i < to; i++)
+    {
+        setColumn(p, i, base + fix16ToInt(fix16Mul(amplitude, sinFix16(angle))));
+        angle += freq;
+    }
+}
+
+static void setLine(u16 p, u16 line, s16 value)
+{
+    ScrollEngine* se = scrollEngine;
+
+    se->line[p][line] = value;
+
+    // differs from uploaded value ? --> extend dirty range
+    if (se->lineFront[p][line] != value)
+    {
+        if (line < se->lineMin[p]) se->lineMin[p] = line;
+        if (line > se->lineMax[p]) se->lineMax[p] = line;
+        // add task for vblank process
+        VBlankProcess |= PROCESS_VDP_SCROLL_TASK;
+    }
+}
+
+static void setColumn(u16 p, u16 column, s16 value)
+{
+    ScrollEngine* se = scrollEngine;
+
+    se->column[p][column] = value;
+
+    // differs from uploaded value ? --> extend dirty range
+    if (se->columnFront[p][column] != value)
+    {
+        if (column < se->columnMin[p]) se->columnMin[p] = column;
+        if (column > se->columnMax[p]) se->columnMax[p] = column;
+        // add task for vblank process
+        VBlankProcess |= PROCESS_VDP_SCROLL_TASK;
+    }
+}
+
+static void flushScrollEngine(void)
+{
+    ScrollEngine* se = scrollEngine;
+    const bool tileMode = (VDP_getHorizontalScrollingMode() == HSCROLL_TILE);
+
+    for(u16 p = 0; p < 2; p++)
+    {
+        const u16 lmin = se->lineMin[p];
+        // tile mode only uses the first 32 entries (don't overflow hscroll table)
+        const u16 lmax = tileMode?min(se->lineMax[p], 31):se->lineMax[p];
+
+        if (lmin <= lmax)
+        {
+            const u16 len = (lmax - lmin) + 1;
+
+            // tile mode uses one entry every 8 lines
+            if (tileMode) DMA_doDma(DMA_VRAM, &se->line[p][lmin], VDP_HSCROLL_TABLE + (lmin * (4 * 8)) + (p * 2), len, 4 * 8);
+            else DMA_doDma(DMA_VRAM, &se->line[p][lmin], VDP_HSCROLL_TABLE + (lmin * 4) + (p * 2), len, 4);
+
+            // update front table
+            memcpy(&se->lineFront[p][lmin], &se->line[p][lmin], len * 2);
+            se->lineMin[p] = SCROLL_LINES;
+            se->lineMax[p] = 0;
+        }
+
+        const u16 cmin = se->columnMin[p];
+        const u16 cmax = se->columnMax[p];
+
+        if (cmin <= cmax)
+        {
+            const u16 len = (cmax - cmin) + 1;
+
+            DMA_doDma(DMA_VSRAM, &se->column[p][cmin], (cmin * 4) + (p * 2), len, 4);
+
+            // update front table
+            memcpy(&se->columnFront[p][cmin], &se->column[p][cmin], len * 2);
+            se->columnMin[p] = SCROLL_COLUMNS;
+            se->columnMax[p] = 0;
+        }
+    }
+}
+
 bool VDP_doVBlankScrollProcess()
 {
     vu16 *pw;
@@ -169,6 +400,9 @@ bool VDP_doVBlankScrollProcess()
     hscroll_update = 0;
     vscroll_update = 0;
 
+    // upload modified scroll engine ranges
+    if (scrollEngine) flushScrollEngine();
+
     // no more task
     return FALSE;
 }
@@ -23,6 +23,12 @@ static void setTileMapDataColumnEx(VDPPlane plane, const u16 *data, u16 basetile
 static void prepareTileMapDataColumn(u16* dest, u16 height, const u16 *data, u16 wm);
 static void prepareTileMapDataRowEx(u16* dest, u16 width, const u16* data, u16 basetile);
 static void prepareTileMapDataColumnEx(u16* dest, u16 height, const u16 *mapData, u16 basetile, u16 wm);
+static void loadTileDataFar(const u32 *data, u16 index, u16 num, TransferMethod tm);
+static void releaseFarData(const void *data, u32 size, TransferMethod tm);
+
+// asm fast path (vdp_tile_a.s), process 2 tiles at once using packed (32 bit) base attributes
+extern void setTileMapDataExA(const u16* src, u16 num, u32 baseinc, u32 baseor);
+extern void prepareTileMapDataExA(u16* dest, const u16* src, u16 num, u32 baseinc, u32 baseor);
 
 
 void VDP_loadTileData(const u32 *data, u16 index, u16 num, TransferMethod tm)
@@ -35,11 +41,46 @@ void VDP_loadFontData(const u32 *font, u16 length, TransferMethod tm)
     VDP_loadTileData(font, TILE_FONT_INDEX, length, tm);
 }
 
+void VDP_loadTileData8x16(const u32 *data, u16 index, u16 num, TransferMethod tm)
+{
+    // a 8x16 tile is 2 consecutive 8x8 tiles in VRAM
+    VDP_loadTileData(data, index << 1, num << 1, tm);
+}
+
+u16 VDP_loadTileSet8x16(const TileSet *tileset, u16 index, TransferMethod tm)
+{
+    return VDP_loadTileSet(tileset, index << 1, tm);
+}
+
+void VDP_convertTileData8x16(const u32 *src, u32 *dest, u16 w, u16 h)
+{
+    u32* d = dest;
+
+    for(u16 j = 0; j < (h >> 1); j++)
+    {
+        const u32* top = src + (j * w * 16);
+        const u32* bottom = top + (w * 8);
+
+        for(u16 i = 0; i < w; i++)
+        {
+            memcpy(d, top, 32);
+            memcpy(d + 8, bottom, 32);
+            d += 16;
+            top += 8;
+            bottom += 8;
+        }
+    }
+}
+
 u16 VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm)
 {
     // compressed tileset ?
     if (tileset->compression != COMPRESSION_NONE)
     {
+        // DMA queue (or auto as unpacked buffer is released here) --> unpack directly in DMA temporary buffer
+        if ((tm == DMA_QUEUE) || (tm == TRANSFER_AUTO))
+            return DMA_queueCompressed(DMA_VRAM, FAR_SAFE(tileset->tiles, tileset->numTile * 32), index * 32, tileset->numTile * 16, tileset->compression);
+
         // unpack first
         TileSet *t = unpackTileSet(tileset, NULL);
 
@@ -51,12 +92,31 @@ u16 VDP_loadTileSet(const TileSet *tileset, u16 index, TransferMethod tm)
         MEM_free(t);
     }
     else
-        // tiles
-        VDP_loadTileData(FAR_SAFE(tileset->tiles, tileset->numTile * 32), index, tileset->numTile, tm);
+        // tiles (directly from ROM)
+        loadTileDataFar(tileset->tiles, index, tileset->numTile, tm);
 
     return TRUE;
 }
 
+static void loadTileDataFar(const u32 *data, u16 index, u16 num, TransferMethod tm)
+{
+    const u32 size = num * 32;
+    // keep bank(s) mapped until transfer is done (data can cross a 512 KB bank, 128 KB DMA source boundaries are already handled by the DMA methods)
+    const u32* src = FAR_ACQUIRE(data, size);
+
+    if (src == NULL) return;
+
+    VDP_loadTileData(src, index, num, tm);
+    releaseFarData(src, size, tm);
+}
+
+static void releaseFarData(const void *data, u32 size, TransferMethod tm)
+{
+    // DMA_QUEUE (or auto) transfer --> data may be read on DMA queue flush so keep it mapped until then
+    if ((tm == DMA_QUEUE) || (tm == TRANSFER_AUTO)) FAR_RELEASE_VBLANK(data, size);
+    else FAR_RELEASE(data, size);
+}
+
 u16 VDP_loadFont(const TileSet *font, TransferMethod tm)
 {
     return VDP_loadTileSet(font, TILE_FONT_INDEX, tm);
@@ -83,16 +143,23 @@ u16 VDP_getPlaneAddress(VDPPlane plane, u16 x, u16 y)
     {
         default:
         case BG_A:
-            return VDP_BG_A + (((x & (planeWidth - 1)) + ((y & (planeHeight - 1)) << planeWidthSft)) * 2);
+            return VDP_BG_A + planeRowOffset[y & (planeHeight - 1)] + ((x & (planeWidth - 1)) * 2);
 
         case BG_B:
-            return VDP_BG_B + (((x & (planeWidth - 1)) + ((y & (planeHeight - 1)) << planeWidthSft)) * 2);
+            return VDP_BG_B + planeRowOffset[y & (planeHeight - 1)] + ((x & (planeWidth - 1)) * 2);
 
         case WINDOW:
-            return VDP_WINDOW + (((x & (windowWidth - 1)) + ((y & (32 - 1)) << windowWidthSft)) * 2);
+            return VDP_WINDOW + windowRowOffset[y & (32 - 1)] + ((x & (windowWidth - 1)) * 2);
     }
 }
 
+u32 VDP_getPlaneWriteCmd(VDPPlane plane, u16 x, u16 y)
+{
+    const u16 addr = VDP_getPlaneAddress(plane, x, y);
+
+    return GFX_WRITE_VRAM_ADDR((u32) addr);
+}
+
 
 void VDP_clearTileMap(u16 planeAddr, u16 ind, u16 num, bool wait)
 {
@@ -147,12 +214,9 @@ void VDP_setTileMapData(u16 planeAddr, const u16 *data, u16 ind, u16 num, u16 vr
 void VDP_setTileMapDataEx(u16 planeAddr, const u16 *data, u16 basetile, u16 ind, u16 num, u16 vramStep)
 {
     vu32 *plctrl;
-    vu16 *pwdata;
-    const u16 *src;
     u16 addr;
-    u16 baseinc;
-    u16 baseor;
-    u16 i;
+    u32 baseinc;
+    u32 baseor;
 
     VDP_setAutoInc(vramStep);
 
@@ -160,7 +224,6 @@ void VDP_setTileMapDataEx(u16 planeAddr, const u16 *data, u16 basetile, u16 ind,
 
     /* point to vdp port */
     plctrl = (u32 *) GFX_CTRL_PORT;
-    pwdata = (u16 *) GFX_DATA_PORT;
 
     *plctrl = GFX_WRITE_VRAM_ADDR((u32) addr);
 
@@ -169,18 +232,8 @@ void VDP_setTileMapDataEx(u16 planeAddr, const u16 *data, u16 basetile, u16 ind,
     // we can only do logical OR on priority and HV flip
     baseor = basetile & (TILE_ATTR_PRIORITY_MASK | TILE_ATTR_VFLIP_MASK | TILE_ATTR_HFLIP_MASK);
 
-    src = (u16*) data;
-    i = num >> 2;
-    while (i--)
-    {
-        *pwdata = baseor | (*src++ + baseinc);
-        *pwdata = baseor | (*src++ + baseinc);
-        *pwdata = baseor | (*src++ + baseinc);
-        *pwdata = baseor | (*src++ + baseinc);
-    }
-
-    i = num & 3;
-    while (i--) *pwdata = baseor | (*src++ + baseinc);
+    // packed version (2 tiles at once), palette addition is not allowed to overflow (already the case before)
+    setTileMapDataExA(data, num, (baseinc << 16) | baseinc, (baseor << 16) | baseor);
 }
 
 
@@ -285,6 +338,9 @@ void VDP_setTileMapDataRect(VDPPlane plane, const u16 *data, u16 x, u16 y, u16 w
     const u16* src = data;
     const u16 pw = (plane == WINDOW)?windowWidth:planeWidth;
 
+    // choose method once for the whole region
+    if (tm == TRANSFER_AUTO) tm = DMA_getAutoTransferMethod(mulu(w, h));
+
     // if plan width < 128 (we cannot do 256 bytes auto increment) and
     // if half less number of column than number of row --> we use column transfer
     if ((pw < 128) && (w < (h / 2)))
@@ -345,6 +401,30 @@ void VDP_setTileMapDataRect(VDPPlane plane, const u16 *data, u16 x, u16 y, u16 w
             w2 = 0;
         }
 
+        // DMA queue --> use block transfers (rows are only split on plane borders)
+        if (tm == DMA_QUEUE)
+        {
+            const u16 ph = (plane == WINDOW)?32:planeHeight;
+            const u16 yAdj = y & (ph - 1);
+            const u16 h1 = ((yAdj + h) > ph)?(ph - yAdj):h;
+            const u16 srcStride = wm * 2;
+            const u16 dstStride = pw * 2;
+
+            // first part
+            DMA_queueDmaBlocks(DMA_VRAM, (void*) src, VDP_getPlaneAddress(plane, xAdj, yAdj), w1, 2, h1, srcStride, dstStride);
+            if (w2 != 0) DMA_queueDmaBlocks(DMA_VRAM, (void*) (src + w1), VDP_getPlaneAddress(plane, 0, yAdj), w2, 2, h1, srcStride, dstStride);
+
+            // second part (wrapped on plane height)
+            if (h1 < h)
+            {
+                src += mulu(wm, h1);
+                DMA_queueDmaBlocks(DMA_VRAM, (void*) src, VDP_getPlaneAddress(plane, xAdj, 0), w1, 2, h - h1, srcStride, dstStride);
+                if (w2 != 0) DMA_queueDmaBlocks(DMA_VRAM, (void*) (src + w1), VDP_getPlaneAddress(plane, 0, 0), w2, 2, h - h1, srcStride, dstStride);
+            }
+
+            return;
+        }
+
         u16 row = y;
         u16 i = h;
 
@@ -366,6 +446,9 @@ void VDP_setTileMapDataRectEx(VDPPlane plane, const u16 *data, u16 basetile, u16
     const u16* src = data;
     const u16 pw = (plane == WINDOW)?windowWidth:planeWidth;
 
+    // choose method once for the whole region
+    if (tm == TRANSFER_AUTO) tm = DMA_getAutoTransferMethod(mulu(w, h));
+
     // if plan width < 128 (we cannot do 256 bytes auto increment) and
     // if half less number of column than number of row --> we use column transfer
     if ((pw < 128) && (w < (h / 2)))
@@ -452,6 +535,8 @@ static void setTileMapDataRowEx(VDPPlane plane, const u16 *data, u16 basetile, u
 {
     const u16 addr = VDP_getPlaneAddress(plane, x, row);
 
+    if (tm == TRANSFER_AUTO) tm = DMA_getAutoTransferMethod(w);
+
     if (tm >= DMA_QUEUE)
     {
         // get temp buffer and schedule DMA
@@ -537,6 +622,8 @@ static void setTileMapDataColumn(VDPPlane plane, const u16 *data, u16 column, u1
         KLog("setTileMapDataColumn(..) error: cannot be used when tilemap width is set to 128 !");
 #endif
 
+    if (tm == TRANSFER_AUTO) tm = DMA_getAutoTransferMethod(h);
+
     if (tm >= DMA_QUEUE)
     {
         // get temp buffer and schedule DMA
@@ -615,6 +702,8 @@ static void setTileMapDataColumnEx(VDPPlane plane, const u16 *data, u16 basetile
         KLog("setTileMapDataColumnEx(..) error: cannot be used when tilemap width is set to 128 !");
 #endif
 
+    if (tm == TRANSFER_AUTO) tm = DMA_getAutoTransferMethod(h);
+
     if (tm >= DMA_QUEUE)
     {
         // get temp buffer and schedule DMA
@@ -773,8 +862,17 @@ bool VDP_setTileMap(VDPPlane plane, const TileMap *tilemap, u16 x, u16 y, u16 w,
         MEM_free(m);
     }
     else
+    {
+        const u32 size = mulu(tilemap->w, h) * 2;
+        // keep bank(s) mapped until transfer is done
+        u16* data = (u16*) FAR_ACQUIRE(tilemap->tilemap + offset, size);
+
+        if (data == NULL) return FALSE;
+
         // tilemap
-        VDP_setTileMapDataRect(plane, (u16*) FAR_SAFE(tilemap->tilemap + offset, mulu(tilemap->w, h) * 2), x, y, w, h, tilemap->w, tm);
+        VDP_setTileMapDataRect(plane, data, x, y, w, h, tilemap->w, tm);
+        releaseFarData(data, size, tm);
+    }
 
     return TRUE;
 }
@@ -797,8 +895,17 @@ bool VDP_setTileMapEx(VDPPlane plane, const TileMap *tilemap, u16 basetile, u16
         MEM_free(m);
     }
     else
+    {
+        const u32 size = mulu(tilemap->w, h) * 2;
+        // keep bank(s) mapped until transfer is done
+        u16* data = (u16*) FAR_ACQUIRE(tilemap->tilemap + offset, size);
+
+        if (data == NULL) return FALSE;
+
         // tilemap
-        VDP_setTileMapDataRectEx(plane, (u16*) FAR_SAFE(tilemap->tilemap + offset, mulu(tilemap->w, h) * 2), basetile, xp, yp, w, h, tilemap->w, tm);
+        VDP_setTileMapDataRectEx(plane, data, basetile, xp, yp, w, h, tilemap->w, tm);
+        releaseFarData(data, size, tm);
+    }
 
     return TRUE;
 }
@@ -821,8 +928,17 @@ bool VDP_setTileMapRow(VDPPlane plane, const TileMap *tilemap, u16 row, u16 x, u
         MEM_free(m);
     }
     else
+    {
+        const u32 size = w * 2;
+        // keep bank(s) mapped until transfer is done
+        u16* data = (u16*) FAR_ACQUIRE(tilemap->tilemap + offset, size);
+
+        if (data == NULL) return FALSE;
+
         // tilemap
-        VDP_setTileMapDataRow(plane, (u16*) FAR_SAFE(tilemap->tilemap + offset, w * 2), row, x, w, tm);
+        VDP_setTileMapDataRow(plane, data, row, x, w, tm);
+        releaseFarData(data, size, tm);
+    }
 
     return TRUE;
 }
@@ -845,8 +961,17 @@ bool VDP_setTileMapRowEx(VDPPlane plane, const TileMap *tilemap, u16 basetile, u
         MEM_free(m);
     }
     else
+    {
+        const u32 size = w * 2;
+        // keep bank(s) mapped until transfer is done
+        u16* data = (u16*) FAR_ACQUIRE(tilemap->tilemap + offset, size);
+
+        if (data == NULL) return FALSE;
+
         // tilemap
-        VDP_setTileMapDataRowEx(plane, (u16*) FAR_SAFE(tilemap->tilemap + offset, w * 2), basetile, row, x, w, tm);
+        VDP_setTileMapDataRowEx(plane, data, basetile, row, x, w, tm);
+        releaseFarData(data, size, tm);
+    }
 
     return TRUE;
 }
@@ -871,8 +996,17 @@ bool VDP_setTileMapColumn(VDPPlane plane, const TileMap *tilemap, u16 column, u1
         MEM_free(m);
     }
     else
+    {
+        const u32 size = mulu(tilemap->w, h) * 2;
+        // keep bank(s) mapped until transfer is done
+        u16* data = (u16*) FAR_ACQUIRE(tilemap->tilemap + offset, size);
+
+        if (data == NULL) return FALSE;
+
         // tilemap
-        VDP_setTileMapDataColumn(plane, (u16*) FAR_SAFE(tilemap->tilemap + offset, mulu(tilemap->w, h) * 2), column, y, h, tilemap->w, tm);
+        VDP_setTileMapDataColumn(plane, data, column, y, h, tilemap->w, tm);
+        releaseFarData(data, size, tm);
+    }
 
     return TRUE;
 }
@@ -895,8 +1029,17 @@ bool VDP_setTileMapColumnEx(VDPPlane plane, const TileMap *tilemap, u16 basetile
         MEM_free(m);
     }
     else
+    {
+        const u32 size = mulu(tilemap->w, h) * 2;
+        // keep bank(s) mapped until transfer is done
+        u16* data = (u16*) FAR_ACQUIRE(tilemap->tilemap + offset, size);
+
+        if (data == NULL) return FALSE;
+
         // tilemap
-        VDP_setTileMapDataColumnEx(plane, (u16*) FAR_SAFE(tilemap->tilemap + offset, mulu(tilemap->w, h) * 2), basetile, column, y, h, tilemap->w, tm);
+        VDP_setTileMapDataColumnEx(plane, data, basetile, column, y, h, tilemap->w, tm);
+        releaseFarData(data, size, tm);
+    }
 
     return TRUE;
 }
@@ -943,27 +1086,12 @@ static void prepareTileMapDataColumn(u16* dest, u16 height, const u16 *data, u16
 static void prepareTileMapDataRowEx(u16* dest, u16 width, const u16* data, u16 basetile)
 {
     // we can increment both index and palette
-    const u16 baseinc = basetile & (TILE_INDEX_MASK | TILE_ATTR_PALETTE_MASK);
+    const u32 baseinc = basetile & (TILE_INDEX_MASK | TILE_ATTR_PALETTE_MASK);
     // we can only do logical OR on priority and HV flip
-    const u16 baseor = basetile & (TILE_ATTR_PRIORITY_MASK | TILE_ATTR_VFLIP_MASK | TILE_ATTR_HFLIP_MASK);
-
-    const u16* s = data;
-    u16* d = dest;
-    u16 i;
-
-    i = width >> 2;
-    // prepare map data for row update
-    while (i--)
-    {
-        *d++ = baseor | (*s++ + baseinc);
-        *d++ = baseor | (*s++ + baseinc);
-        *d++ = baseor | (*s++ + baseinc);
-        *d++ = baseor | (*s++ + baseinc);
-    }
+    const u32 baseor = basetile & (TILE_ATTR_PRIORITY_MASK | TILE_ATTR_VFLIP_MASK | TILE_ATTR_HFLIP_MASK);
 
-    i = width & 3;
-    // prepare map data for row update
-    while (i--) *d++ = baseor | (*s++ + baseinc);
+    // prepare map data for row update (2 tiles at once)
+    prepareTileMapDataExA(dest, data, width, (baseinc << 16) | baseinc, (baseor << 16) | baseor);
 }
 
 static void prepareTileMapDataColumnEx(u16* dest, u16 height, const u16 *data, u16 basetile, u16 wm)
@@ -66,3 +66,129 @@ func VDP_loadBMPTileData
 .L17:
     movm.l (%sp)+,#0x3c
     rts
+
+// void setTileMapDataExA(const u16* src, u16 num, u32 baseinc, u32 baseor)
+// write <num> tilemap entries to VDP data port (destination address and autoinc already set)
+// baseinc and baseor are packed (same value in both words) so we process 2 tiles per operation
+func setTileMapDataExA
+    movm.l %d2-%d4,-(%sp)
+
+    move.l 16(%sp),%a0                  // a0 = src
+    move.w 22(%sp),%d0                  // d0 = num
+    move.l 24(%sp),%d1                  // d1 = baseinc:baseinc
+    move.l 28(%sp),%d3                  // d3 = baseor:baseor
+    lea 0xC00000,%a1                    // a1 = VDP data port
+
+    move.w %d0,%d4
+    lsr.w #3,%d4                        // d4 = num / 8
+    jra .Lsd_check8
+
+.Lsd_loop8:
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)
+
+.Lsd_check8:
+    dbra %d4,.Lsd_loop8
+
+    move.w %d0,%d4
+    andi.w #7,%d4
+    lsr.w #1,%d4                        // d4 = remaining pairs
+    jra .Lsd_check2
+
+.Lsd_loop2:
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)
+
+.Lsd_check2:
+    dbra %d4,.Lsd_loop2
+
+    btst #0,%d0                         // odd number of tile ?
+    jeq .Lsd_done
+
+    move.w (%a0)+,%d2
+    add.w %d1,%d2
+    or.w %d3,%d2
+    move.w %d2,(%a1)
+
+.Lsd_done:
+    movm.l (%sp)+,%d2-%d4
+    rts
+
+
+// void prepareTileMapDataExA(u16* dest, const u16* src, u16 num, u32 baseinc, u32 baseor)
+// same as setTileMapDataExA(..) but write to memory buffer (DMA temporary buffer)
+func prepareTileMapDataExA
+    movm.l %d2-%d4,-(%sp)
+
+    move.l 16(%sp),%a1                  // a1 = dest
+    move.l 20(%sp),%a0                  // a0 = src
+    move.w 26(%sp),%d0                  // d0 = num
+    move.l 28(%sp),%d1                  // d1 = baseinc:baseinc
+    move.l 32(%sp),%d3                  // d3 = baseor:baseor
+
+    move.w %d0,%d4
+    lsr.w #3,%d4                        // d4 = num / 8
+    jra .Lpd_check8
+
+.Lpd_loop8:
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)+
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)+
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)+
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)+
+
+.Lpd_check8:
+    dbra %d4,.Lpd_loop8
+
+    move.w %d0,%d4
+    andi.w #7,%d4
+    lsr.w #1,%d4                        // d4 = remaining pairs
+    jra .Lpd_check2
+
+.Lpd_loop2:
+    move.l (%a0)+,%d2
+    add.l %d1,%d2
+    or.l %d3,%d2
+    move.l %d2,(%a1)+
+
+.Lpd_check2:
+    dbra %d4,.Lpd_loop2
+
+    btst #0,%d0                         // odd number of tile ?
+    jeq .Lpd_done
+
+    move.w (%a0)+,%d2
+    add.w %d1,%d2
+    or.w %d3,%d2
+    move.w %d2,(%a1)+
+
+.Lpd_done:
+    movm.l (%sp)+,%d2-%d4
+    rts
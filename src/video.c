@@ -0,0 +1,232 @@
+#include "config.h"
+#include "types.h"
+
+#include "video.h"
+
+#include "memory.h"
+#include "mapper.h"
+#include "dma.h"
+#include "tools.h"
+#include "timer.h"
+#include "sys.h"
+
+
+// frame data header (in word): number of tile run, number of tile, number of tilemap run
+#define FRAME_HEADER_SIZE       3
+
+
+// playing video (NULL = none)
+static const Video* video = NULL;
+// unpacked frame data and RAM copy of video tilemap (DMA sources)
+static u16* frameBuffer;
+static u16* tilemap;
+// tilemap runs of the loaded frame (in frameBuffer)
+static u16* mapRuns;
+// plane VRAM address of video top left position and plane width (in tile)
+static u16 planeAddr;
+static u16 pw;
+// base tile attributes
+static u16 baseAttr;
+// H-Int blanking line (0 = not used)
+static u16 hintLine;
+// next frame to display
+static u16 frame;
+// fence of loaded frame tiles transfer (0 = none)
+static u16 fence;
+// vtimer value when first frame has been displayed
+static u32 startTime;
+// called when first frame is displayed
+static VoidCallback* startCB = NULL;
+
+
+static void loadFrame(u16 num)
+{
+    const VideoFrame* vf = &video->frames[num];
+    const u16 baseIndex = baseAttr & TILE_INDEX_MASK;
+    u16* tileRun;
+    u16* tiles;
+    u16 numRun;
+    bool midFrame;
+
+    // unpack frame data (tiles are transferred from RAM)
+    if (vf->compression != COMPRESSION_NONE) unpack(vf->compression, (u8*) FAR_SAFE(vf->data, vf->size), (u8*) frameBuffer);
+    else memcpy(frameBuffer, FAR_SAFE(vf->data, vf->size), vf->size);
+
+    numRun = frameBuffer[0];
+    tileRun = frameBuffer + FRAME_HEADER_SIZE;
+    tiles = tileRun + (numRun * 2);
+    mapRuns = tiles + (frameBuffer[1] * 16);
+
+    // new tiles go in VRAM slots not displayed by current frame so they can be transferred during active display,
+    // fence is queued as mid frame transfer too so it completes only once all tiles are really transferred
+    midFrame = DMA_getMidFrameTransfer();
+    DMA_setMidFrameTransfer(TRUE);
+
+    while(numRun--)
+    {
+        const u16 ind = *tileRun++;
+        const u16 len = *tileRun++ * 16;
+
+        // queue full --> direct transfer (safe as these tiles aren't displayed yet)
+        if (!DMA_queueDma(DMA_VRAM, tiles, (baseIndex + ind) * 32, len, 2))
+            DMA_doDma(DMA_VRAM, tiles, (baseIndex + ind) * 32, len, 2);
+
+        tiles += len;
+    }
+
+    // queue full (0) --> tiles are considered done on next update
+    fence = DMA_queueFence(NULL);
+    DMA_setMidFrameTransfer(midFrame);
+}
+
+static void applyMap(void)
+{
+    const u16 w = video->w;
+    u16* src = mapRuns;
+    u16 numRun = frameBuffer[2];
+    u16 minPos;
+    u16 maxPos;
+    u16 minRow;
+    u16 numRow;
+    u16 prio;
+
+    // no change
+    if (numRun == 0) return;
+
+    // runs are sorted on position
+    minPos = src[0];
+    maxPos = 0;
+
+    while(numRun--)
+    {
+        const u16 pos = *src++;
+        u16 num = *src++;
+        u16* dst = tilemap + pos;
+
+        maxPos = pos + num;
+        while(num--) *dst++ = *src++ + baseAttr;
+    }
+
+    minRow = minPos / w;
+    numRow = ((maxPos - 1) / w) - minRow + 1;
+
+    // visible update --> always transferred on next VBlank
+    prio = DMA_setQueuePriority(DMA_PRIORITY_HIGH);
+    DMA_queueDmaBlocks(DMA_VRAM, tilemap + (minRow * w), planeAddr + (minRow * pw * 2), w, 2, numRow, w * 2, pw * 2);
+    DMA_setQueuePriority(prio);
+}
+
+static bool isFrameDue(u16 num)
+{
+    const u16 refresh = IS_PAL_SYSTEM ? 50 : 60;
+
+    return ((vtimer - startTime) * video->fps) >= ((u32) num * refresh);
+}
+
+
+bool VID_play(const Video* v, VDPPlane plane, u16 x, u16 y, u16 baseTile, u16 blankLine)
+{
+    const u16 baseIndex = baseTile & TILE_INDEX_MASK;
+
+    VID_stop();
+
+    if ((baseIndex + v->numTile) > (userTileMaxIndex + 1))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("VID_play(..) failed: not enough VRAM tiles, base index = ", baseIndex, " required tiles = ", v->numTile);
+#endif
+        return FALSE;
+    }
+
+    frameBuffer = MEM_alloc(v->maxFrameSize);
+    tilemap = MEM_alloc(v->w * v->h * 2);
+
+    if ((frameBuffer == NULL) || (tilemap == NULL))
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog_U2("VID_play(..) failed: not enough memory, frame buffer = ", v->maxFrameSize, " tilemap = ", v->w * v->h * 2);
+#endif
+        if (frameBuffer) MEM_free(frameBuffer);
+        if (tilemap) MEM_free(tilemap);
+        return FALSE;
+    }
+
+    video = v;
+    planeAddr = VDP_getPlaneAddress(plane, x, y);
+    pw = (plane == WINDOW) ? windowWidth : planeWidth;
+    baseAttr = baseTile;
+    hintLine = blankLine;
+    frame = 0;
+    startTime = 0;
+    // positions not yet updated by frames use first video tile
+    memsetU16(tilemap, baseTile, v->w * v->h);
+
+    // load palette and tile dictionary
+    PAL_setColors(((baseTile & TILE_ATTR_PALETTE_MASK) >> TILE_ATTR_PALETTE_SFT) * 16, v->palette->data, 16, DMA);
+    if (v->dictionary) VDP_loadTileSet(v->dictionary, baseIndex, DMA);
+
+    // extend VBlank DMA capacity
+    if (hintLine) DMA_setHIntFlush(hintLine, TRUE);
+
+    // first frame tiles
+    loadFrame(0);
+
+    return TRUE;
+}
+
+void VID_stop(void)
+{
+    if (video == NULL) return;
+
+    if (hintLine) DMA_setHIntFlush(0, FALSE);
+
+    MEM_free(frameBuffer);
+    MEM_free(tilemap);
+    video = NULL;
+}
+
+bool VID_isPlaying(void)
+{
+    return (video != NULL);
+}
+
+u16 VID_getFrame(void)
+{
+    return frame;
+}
+
+void VID_setStartCallback(VoidCallback* CB)
+{
+    startCB = CB;
+}
+
+bool VID_update(void)
+{
+    if (video == NULL) return FALSE;
+
+    // last frame was displayed on previous VBlank --> done
+    if (frame >= video->numFrame)
+    {
+        VID_stop();
+        return FALSE;
+    }
+
+    // frame tiles not yet transferred or not yet time to display it
+    if (fence && !DMA_isFenceDone(fence)) return TRUE;
+    if (frame && !isFrameDue(frame)) return TRUE;
+
+    applyMap();
+
+    // first frame --> start timing
+    if (frame == 0)
+    {
+        startTime = vtimer;
+        if (startCB) startCB();
+    }
+
+    // prepare next frame (its tiles go to VRAM slots not used by the frame we just queued)
+    if (++frame < video->numFrame) loadFrame(frame);
+    else fence = 0;
+
+    return TRUE;
+}
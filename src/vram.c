@@ -18,6 +18,7 @@
 
 // forward
 static u16* pack(VRAMRegion *region, u16 nsize);
+static u16* findBestFit(VRAMRegion *region, u16 nsize);
 
 
 void VRAM_createRegion(VRAMRegion *region, u16 startIndex, u16 size)
@@ -27,6 +28,8 @@ void VRAM_createRegion(VRAMRegion *region, u16 startIndex, u16 size)
 
     // alloc vram image allocation buffer
     region->vram = MEM_alloc((size + 1) * sizeof(u16));
+    // default policy
+    region->policy = VRAM_POLICY_FIRST_FIT;
 
     VRAM_clearRegion(region);
 }
@@ -103,6 +106,50 @@ u16 VRAM_getLargestFreeBlock(VRAMRegion *region)
     return res;
 }
 
+u16 VRAM_getFragmentation(VRAMRegion *region)
+{
+    u16* b;
+    u16 bsize;
+    u16 csize;
+    u16 largest;
+    u16 total;
+
+    b = region->vram;
+    csize = 0;
+    largest = 0;
+    total = 0;
+
+    while ((bsize = *b))
+    {
+        // memory block used ? --> reset contiguous free size
+        if (bsize & USED_MASK)
+        {
+            csize = 0;
+            b += bsize & SIZE_MASK;
+        }
+        else
+        {
+            // adjacent free blocks are contiguous
+            csize += bsize;
+            total += bsize;
+            if (csize > largest) largest = csize;
+
+            // pass to next block
+            b += bsize;
+        }
+    }
+
+    // no free tile --> no fragmentation
+    if (total == 0) return 0;
+
+    return 100 - divu(mulu(largest, 100), total);
+}
+
+void VRAM_setPolicy(VRAMRegion *region, u16 policy)
+{
+    region->policy = policy;
+}
+
 u16 VRAM_getAllocated(VRAMRegion *region)
 {
     u16* b;
@@ -142,10 +189,11 @@ s16 VRAM_alloc(VRAMRegion *region, u16 size)
     // cache free pointer
     free = region->free;
 
-    if (size > *free)
+    // best fit policy always search for the smallest matching block
+    if ((region->policy == VRAM_POLICY_BEST_FIT) || (size > *free))
     {
         // pack free block
-        p = pack(region, size);
+        p = (region->policy == VRAM_POLICY_BEST_FIT) ? findBestFit(region, size) : pack(region, size);
 
         // no enough memory
         if (p == NULL)
@@ -213,6 +261,62 @@ void VRAM_free(VRAMRegion *region, u16 index)
 #endif
 }
 
+s16 VRAM_moveDown(VRAMRegion *region, u16 maxSize, u16 *fromIndex)
+{
+    u16 *b;
+    u16 *fb;
+    u16 bsize, fsize;
+
+    b = region->vram;
+    fb = b;
+    fsize = 0;
+
+    while ((bsize = *b))
+    {
+        if (bsize & USED_MASK)
+        {
+            bsize &= SIZE_MASK;
+
+            // preceding free area can receive the block without overlap ?
+            if ((fsize >= bsize) && (bsize <= maxSize))
+            {
+                // clear old block (now part of free area)
+                *b = 0;
+                // block now starts at beginning of free area
+                *fb = bsize | USED_MASK;
+                // followed by the (packed) free area
+                fb[bsize] = fsize;
+                // free pointer may have pointed inside the moved block
+                region->free = fb + bsize;
+
+                *fromIndex = ((u16) (b - region->vram)) + region->startIndex;
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+                KLog_U3("VRAM_moveDown(", bsize, ") success: ", *fromIndex, " --> ", ((u16) (fb - region->vram)) + region->startIndex);
+#endif
+
+                return ((s16) (fb - region->vram)) + region->startIndex;
+            }
+
+            // reset free area
+            fsize = 0;
+            // point to next memory block
+            b += bsize;
+            // remember it in case it becomes free
+            fb = b;
+        }
+        else
+        {
+            // increment free size
+            fsize += bsize;
+            // point to next memory block
+            b += bsize;
+        }
+    }
+
+    return -1;
+}
+
 
 /*
  * Pack free blocks and return first matching free block
@@ -271,3 +375,56 @@ static u16* pack(VRAMRegion *region, u16 nsize)
 
     return NULL;
 }
+
+/*
+ * Pack adjacent free blocks and return the smallest matching free block
+ */
+static u16* findBestFit(VRAMRegion *region, u16 nsize)
+{
+    u16 *b;
+    u16 *best;
+    u16 bestSize, psize, nextSize;
+
+    b = region->vram;
+    best = NULL;
+    bestSize = SIZE_MASK + 1;
+
+    while ((psize = *b))
+    {
+        if (psize & USED_MASK)
+        {
+            // point to next memory block
+            b += psize & SIZE_MASK;
+            continue;
+        }
+
+        u16* next = b + psize;
+
+        // pack following free blocks
+        while ((nextSize = *next) && !(nextSize & USED_MASK))
+        {
+            // clear this memory block as it is packed
+            *next = 0;
+            psize += nextSize;
+            next += nextSize;
+        }
+
+        // store packed free size
+        *b = psize;
+
+        // better match ?
+        if ((psize >= nsize) && (psize < bestSize))
+        {
+            best = b;
+            bestSize = psize;
+
+            // exact match --> can't do better
+            if (psize == nsize) break;
+        }
+
+        // point to next memory block
+        b = next;
+    }
+
+    return best;
+}
@@ -7,6 +7,10 @@
 #include "smp_null.h"
 #include "sys.h"
 #include "mapper.h"
+#include "memory.h"
+#include "tools.h"
+#include "timer.h"
+#include "trace.h"
 
 //// just to get xgmstop resource
 #include "vdp.h"
@@ -33,8 +37,56 @@ static u16 xgmTabInd;
 static u16 xgmIdleMean;
 static u16 xgmWaitMean;
 
+// command queue (flushed on next frame process)
+#define CMD_SETPCM          0
+#define CMD_PLAYPCM         1
+#define CMD_SETLOOP         2
+
+typedef struct
+{
+    u8 type;
+    u8 id;
+    u8 priority;
+    u8 channel;
+    const u8* sample;
+    u32 len;
+} XGMQueuedCommand;
+
+static XGMQueuedCommand cmdQueue[XGM_COMMAND_QUEUE_SIZE];
+static u16 cmdRead = 0;
+static u16 cmdWrite = 0;
+
+// PCM stream
+static const u8* streamAddr;
+static u32 streamRemain;
+static u32 streamNextFrame;
+static u16 streamChannel;
+static u8 streamPriority;
+#if (ENABLE_BANK_SWITCH != 0)
+// segment currently played (pinned in a bank region)
+static void* streamSegment;
+static u32 streamSegmentLen;
+#endif
+
+// saved sample id table (see XGM_setKeepPCMTable(..))
+static u8* savedPCMTable = NULL;
+
+// heavy frame table of current music (NULL = none, see XGM_setAutoDelayDMA(..))
+static const u8* heavyFrames = NULL;
+static u32 heavyNumFrame;
+static u32 heavyLoopFrame;
+// next music frame to process and heavy frame requested on last frame process
+static u32 heavyFrame;
+static bool heavyPending = FALSE;
+
 // set next frame helper
 static void setNextXFrame(u16 num, bool set);
+// command queue helpers
+static XGMQueuedCommand* pushCommand(u8 type);
+static void advanceHeavyFrame(u16 num);
+static void flushCommands(void);
+// PCM stream helper
+static void playStreamSegment(void);
 
 
 // Z80_DRIVER_XGM
@@ -73,6 +125,8 @@ void XGM_startPlay(const u8 *song)
     vu8 *pb;
 
     SYS_disableInts();
+    TRACE_begin(TRACE_ID_SOUND);
+    TRACE_value(TRACE_SND_PLAY);
     bool busTaken = Z80_isBusTaken();
 
     // load the appropriate driver if not already done
@@ -109,6 +163,25 @@ void XGM_startPlay(const u8 *song)
     // and bypass the music data size field
     addr += 4;
 
+    heavyFrames = NULL;
+    heavyPending = FALSE;
+    // heavy frame table present (after music data and XD3 tags) ?
+    if (song[0xFF] & 8)
+    {
+        const u8* table = (const u8*) addr;
+
+        // bypass music data
+        table += (table[-4] << 0) | (table[-3] << 8) | ((u32) table[-2] << 16) | ((u32) table[-1] << 24);
+        // bypass XD3 tags if present
+        if (song[0xFF] & 2)
+            table += 4 + ((table[0] << 0) | (table[1] << 8) | ((u32) table[2] << 16) | ((u32) table[3] << 24));
+
+        heavyNumFrame = (table[0] << 0) | (table[1] << 8) | ((u32) table[2] << 16) | ((u32) table[3] << 24);
+        heavyLoopFrame = (table[4] << 0) | (table[5] << 8) | ((u32) table[6] << 16) | ((u32) table[7] << 24);
+        heavyFrame = 0;
+        if (heavyNumFrame) heavyFrames = table + 8;
+    }
+
     // request Z80 BUS
     Z80_requestBus(TRUE);
 
@@ -129,6 +202,7 @@ void XGM_startPlay(const u8 *song)
     setNextXFrame(0, TRUE);
 
     if (!busTaken) Z80_releaseBus();
+    TRACE_end(TRACE_ID_SOUND);
     SYS_enableInts();
 }
 
@@ -143,11 +217,16 @@ void XGM_stopPlay()
     u32 addr;
 
     SYS_disableInts();
+    TRACE_begin(TRACE_ID_SOUND);
+    TRACE_value(TRACE_SND_STOP);
     bool busTaken = Z80_isBusTaken();
 
     // load the appropriate driver if not already done
     Z80_loadDriver(Z80_DRIVER_XGM, TRUE);
 
+    heavyFrames = NULL;
+    heavyPending = FALSE;
+
     Z80_requestBus(TRUE);
 
     // special xgm sequence to stop any sound
@@ -171,6 +250,7 @@ void XGM_stopPlay()
     setNextXFrame(3, TRUE);
 
     if (!busTaken) Z80_releaseBus();
+    TRACE_end(TRACE_ID_SOUND);
     SYS_enableInts();
 }
 
@@ -179,6 +259,8 @@ void XGM_pausePlay()
     vu8 *pb;
 
     SYS_disableInts();
+    TRACE_begin(TRACE_ID_SOUND);
+    TRACE_value(TRACE_SND_PAUSE);
     bool busTaken = Z80_isBusTaken();
 
     // load the appropriate driver if not already done
@@ -195,6 +277,7 @@ void XGM_pausePlay()
     setNextXFrame(0, TRUE);
 
     if (!busTaken) Z80_releaseBus();
+    TRACE_end(TRACE_ID_SOUND);
     SYS_enableInts();
 }
 
@@ -203,6 +286,8 @@ void XGM_resumePlay()
     vu8 *pb;
 
     SYS_disableInts();
+    TRACE_begin(TRACE_ID_SOUND);
+    TRACE_value(TRACE_SND_RESUME);
     bool busTaken = Z80_isBusTaken();
 
     // load the appropriate driver if not already done
@@ -222,6 +307,7 @@ void XGM_resumePlay()
     }
 
     if (!busTaken) Z80_releaseBus();
+    TRACE_end(TRACE_ID_SOUND);
     SYS_enableInts();
 }
 
@@ -257,6 +343,18 @@ void XGM_setPCM(const u8 id, const u8 *sample, const u32 len)
     // load the appropriate driver if not already done
     Z80_loadDriver(Z80_DRIVER_XGM, TRUE);
 
+    if (driverFlags & DRIVER_FLAG_QUEUE_XGM)
+    {
+        XGMQueuedCommand* cmd = pushCommand(CMD_SETPCM);
+
+        cmd->id = id;
+        cmd->sample = sample;
+        cmd->len = len;
+
+        SYS_enableInts();
+        return;
+    }
+
     Z80_requestBus(TRUE);
 
     XGM_setPCMFast(id, sample, len);
@@ -284,11 +382,26 @@ void XGM_startPlayPCM(const u8 id, const u8 priority, const u16 channel)
     vu8 *pb;
 
     SYS_disableInts();
+    TRACE_begin(TRACE_ID_SOUND);
+    TRACE_value((channel << 8) | TRACE_SND_PCM_PLAY);
     bool busTaken = Z80_isBusTaken();
 
     // load the appropriate driver if not already done
     Z80_loadDriver(Z80_DRIVER_XGM, TRUE);
 
+    if (driverFlags & DRIVER_FLAG_QUEUE_XGM)
+    {
+        XGMQueuedCommand* cmd = pushCommand(CMD_PLAYPCM);
+
+        cmd->id = id;
+        cmd->priority = priority & 0xF;
+        cmd->channel = channel;
+
+        TRACE_end(TRACE_ID_SOUND);
+        SYS_enableInts();
+        return;
+    }
+
     Z80_requestBus(TRUE);
 
     // point to Z80 PCM parameters
@@ -304,6 +417,7 @@ void XGM_startPlayPCM(const u8 id, const u8 priority, const u16 channel)
     *pb |= (Z80_DRV_COM_PLAY << channel);
 
     if (!busTaken) Z80_releaseBus();
+    TRACE_end(TRACE_ID_SOUND);
     SYS_enableInts();
 }
 
@@ -312,11 +426,27 @@ void XGM_stopPlayPCM(const u16 channel)
     vu8 *pb;
 
     SYS_disableInts();
+    TRACE_begin(TRACE_ID_SOUND);
+    TRACE_value((channel << 8) | TRACE_SND_PCM_STOP);
     bool busTaken = Z80_isBusTaken();
 
     // load the appropriate driver if not already done
     Z80_loadDriver(Z80_DRIVER_XGM, TRUE);
 
+    if (driverFlags & DRIVER_FLAG_QUEUE_XGM)
+    {
+        XGMQueuedCommand* cmd = pushCommand(CMD_PLAYPCM);
+
+        // use silent PCM (id = 0) with maximum priority
+        cmd->id = 0;
+        cmd->priority = 0xF;
+        cmd->channel = channel;
+
+        TRACE_end(TRACE_ID_SOUND);
+        SYS_enableInts();
+        return;
+    }
+
     Z80_requestBus(TRUE);
 
     // point to Z80 PCM parameters
@@ -332,9 +462,117 @@ void XGM_stopPlayPCM(const u16 channel)
     *pb |= (Z80_DRV_COM_PLAY << channel);
 
     if (!busTaken) Z80_releaseBus();
+    TRACE_end(TRACE_ID_SOUND);
     SYS_enableInts();
 }
 
+void XGM_startStreamPCM(const u8 *sample, const u32 len, const u8 priority, const u16 channel)
+{
+    // stop current stream if any
+    XGM_stopStreamPCM();
+
+    streamAddr = sample;
+    streamRemain = len;
+    streamChannel = channel;
+    streamPriority = priority & 0xF;
+
+#if (ENABLE_BANK_SWITCH != 0)
+    streamSegment = NULL;
+#endif
+
+    playStreamSegment();
+
+    // segments are chained from SYS_doVBlankProcess()
+    VBlankProcess |= PROCESS_XGM_STREAM_TASK;
+}
+
+void XGM_stopStreamPCM()
+{
+    if (!(VBlankProcess & PROCESS_XGM_STREAM_TASK)) return;
+
+    VBlankProcess &= ~PROCESS_XGM_STREAM_TASK;
+    streamRemain = 0;
+    XGM_stopPlayPCM(streamChannel);
+
+#if (ENABLE_BANK_SWITCH != 0)
+    // release segment bank region
+    if (streamSegment) SYS_releaseFarData(streamSegment, streamSegmentLen);
+    streamSegment = NULL;
+#endif
+}
+
+bool XGM_isStreamingPCM()
+{
+    return (VBlankProcess & PROCESS_XGM_STREAM_TASK)?TRUE:FALSE;
+}
+
+// called from SYS_doVBlankProcess() (not from the interrupt as it may change mapper bank)
+bool XGM_doStreamProcess()
+{
+    // current segment not yet done
+    if ((s32) (vtimer - streamNextFrame) < 0) return TRUE;
+
+    // stream done
+    if (!streamRemain)
+    {
+#if (ENABLE_BANK_SWITCH != 0)
+        // release segment bank region
+        if (streamSegment) SYS_releaseFarData(streamSegment, streamSegmentLen);
+        streamSegment = NULL;
+#endif
+        return FALSE;
+    }
+
+    playStreamSegment();
+
+    return TRUE;
+}
+
+static void playStreamSegment()
+{
+    u32 len = streamRemain;
+    const u8* sample = streamAddr;
+
+#if (ENABLE_BANK_SWITCH != 0)
+    const u32 addr = (u32) streamAddr;
+    const u32 farStart = BANK_SWITCH_FIRST_REGION * BANK_SIZE;
+
+    // previous segment is done --> release its bank region
+    if (streamSegment) SYS_releaseFarData(streamSegment, streamSegmentLen);
+    streamSegment = NULL;
+
+    // far data --> play until end of bank, region stays pinned while segment is played
+    if (addr >= farStart)
+    {
+        len = min(len, BANK_SIZE - (addr & BANK_IN_MASK));
+        sample = SYS_acquireFarData((void*) addr, len);
+
+        // all regions are pinned --> stop stream
+        if (sample == NULL)
+        {
+            streamRemain = 0;
+            streamNextFrame = vtimer;
+            return;
+        }
+
+        streamSegment = (void*) sample;
+        streamSegmentLen = len;
+    }
+    // stop at start of far data area
+    else if ((addr + len) > farStart) len = farStart - addr;
+#endif
+
+    streamAddr += len;
+    streamRemain -= len;
+
+    XGM_setPCM(XGM_STREAM_PCM_ID, sample, len);
+    XGM_startPlayPCM(XGM_STREAM_PCM_ID, streamPriority, streamChannel);
+
+    // segment duration in frame (Z80 outputs one sample every 254 cycles: 235.18 bytes per frame on NTSC, 280.96 on PAL)
+    if (IS_PAL_SYSTEM) streamNextFrame = vtimer + (((len * 100) + (28096 / 2)) / 28096);
+    else streamNextFrame = vtimer + (((len * 100) + (23518 / 2)) / 23518);
+}
+
 void XGM_setLoopNumber(s8 value)
 {
     vu8 *pb;
@@ -345,6 +583,15 @@ void XGM_setLoopNumber(s8 value)
     // load the appropriate driver if not already done
     Z80_loadDriver(Z80_DRIVER_XGM, TRUE);
 
+    if (driverFlags & DRIVER_FLAG_QUEUE_XGM)
+    {
+        // +1 as internally 0 = infinite
+        pushCommand(CMD_SETLOOP)->id = value + 1;
+
+        SYS_enableInts();
+        return;
+    }
+
     Z80_requestBus(TRUE);
 
     // point to Z80 PCM parameters
@@ -405,6 +652,118 @@ void XGM_setForceDelayDMA(u16 value)
         driverFlags &= ~DRIVER_FLAG_DELAYDMA_XGM;
 }
 
+u16 XGM_getAutoDelayDMA()
+{
+    return (driverFlags & DRIVER_FLAG_NOAUTODELAY_XGM)?FALSE:TRUE;
+}
+
+void XGM_setAutoDelayDMA(u16 value)
+{
+    // nothing to do
+    if (currentDriver != Z80_DRIVER_XGM)
+        return;
+
+    if (value)
+        driverFlags &= ~DRIVER_FLAG_NOAUTODELAY_XGM;
+    else
+        driverFlags |= DRIVER_FLAG_NOAUTODELAY_XGM;
+}
+
+// returns TRUE if a heavy music frame has been requested on last frame process (DMA should be delayed)
+bool XGM_isHeavyFramePending()
+{
+    return heavyPending && !(driverFlags & DRIVER_FLAG_NOAUTODELAY_XGM);
+}
+
+u16 XGM_getCommandQueue()
+{
+    return driverFlags & DRIVER_FLAG_QUEUE_XGM;
+}
+
+void XGM_setCommandQueue(u16 value)
+{
+    // nothing to do
+    if (currentDriver != Z80_DRIVER_XGM)
+        return;
+
+    if (value)
+    {
+        // start with an empty queue
+        cmdRead = cmdWrite;
+        driverFlags |= DRIVER_FLAG_QUEUE_XGM;
+    }
+    else
+    {
+        SYS_disableInts();
+
+        // send pending commands now
+        if (cmdRead != cmdWrite)
+        {
+            bool busTaken = Z80_isBusTaken();
+
+            Z80_requestBus(TRUE);
+            flushCommands();
+            if (!busTaken) Z80_releaseBus();
+        }
+
+        driverFlags &= ~DRIVER_FLAG_QUEUE_XGM;
+
+        SYS_enableInts();
+    }
+}
+
+u16 XGM_getKeepPCMTable()
+{
+    return driverFlags & DRIVER_FLAG_KEEPPCM_XGM;
+}
+
+void XGM_setKeepPCMTable(u16 value)
+{
+    if (value) driverFlags |= DRIVER_FLAG_KEEPPCM_XGM;
+    else
+    {
+        driverFlags &= ~DRIVER_FLAG_KEEPPCM_XGM;
+
+        // release saved table
+        if (savedPCMTable)
+        {
+            MEM_free(savedPCMTable);
+            savedPCMTable = NULL;
+        }
+    }
+}
+
+// called by Z80_loadDriver(..) / Z80_unloadDriver() before XGM driver is removed
+void XGM_savePCMTable()
+{
+    if (!(driverFlags & DRIVER_FLAG_KEEPPCM_XGM)) return;
+
+    if (!savedPCMTable) savedPCMTable = MEM_alloc(0x400);
+
+    if (!savedPCMTable)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("XGM_savePCMTable() failed: not enough memory to save sample id table");
+#endif
+        return;
+    }
+
+    // sample id table is at $1C00 in Z80 RAM
+    Z80_download(0x1C00, savedPCMTable, 0x400);
+}
+
+// called by Z80_loadDriver(..) after XGM driver upload (first entry = silent sample is already set)
+void XGM_restorePCMTable()
+{
+    if (!savedPCMTable) return;
+
+    if (driverFlags & DRIVER_FLAG_KEEPPCM_XGM)
+        Z80_upload(0x1C04, savedPCMTable + 4, 0x400 - 4, FALSE);
+
+    MEM_free(savedPCMTable);
+    savedPCMTable = NULL;
+}
+
 u16 XGM_getMusicTempo()
 {
     return xgmTempo;
@@ -559,6 +918,114 @@ void setNextXFrame(u16 num, bool set)
     if (set) *pb = num;
     // increment num frame to process
     else *pb += num;
+
+    // send queued commands while we have the bus
+    if (cmdRead != cmdWrite) flushCommands();
+
+    if (!set && heavyFrames) advanceHeavyFrame(num);
+}
+
+// follow music frames in heavy frame table (68000 side estimation, Z80 can be slightly late)
+static void advanceHeavyFrame(u16 num)
+{
+    const u8* table = heavyFrames;
+    u32 frame = heavyFrame;
+    bool heavy = FALSE;
+
+    while(num--)
+    {
+        // end of music
+        if (frame >= heavyNumFrame)
+        {
+            // no loop --> no more heavy frame
+            if (heavyLoopFrame >= heavyNumFrame)
+            {
+                heavyFrames = NULL;
+                break;
+            }
+
+            frame = heavyLoopFrame;
+        }
+
+        if (table[frame >> 3] & (1 << (frame & 7))) heavy = TRUE;
+        frame++;
+    }
+
+    heavyFrame = frame;
+    heavyPending = heavy;
+}
+
+// interrupts should be disabled when calling this method
+static XGMQueuedCommand* pushCommand(u8 type)
+{
+    u16 next = (cmdWrite + 1) & (XGM_COMMAND_QUEUE_SIZE - 1);
+
+    // queue full --> send pending commands now
+    if (next == cmdRead)
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_WARNING)
+        KLog_U1("XGM command queue full, flushing it now (consider to increase XGM_COMMAND_QUEUE_SIZE), size = ", XGM_COMMAND_QUEUE_SIZE);
+#endif
+        bool busTaken = Z80_isBusTaken();
+
+        Z80_requestBus(TRUE);
+        flushCommands();
+        if (!busTaken) Z80_releaseBus();
+    }
+
+    XGMQueuedCommand* result = &cmdQueue[cmdWrite];
+
+    result->type = type;
+    cmdWrite = next;
+
+    return result;
+}
+
+// Z80 bus should be taken when calling this method
+static void flushCommands()
+{
+    vu8 *pb;
+    u16 ind = cmdRead;
+    u8 com = 0;
+
+    while(ind != cmdWrite)
+    {
+        const XGMQueuedCommand* cmd = &cmdQueue[ind];
+
+        switch(cmd->type)
+        {
+            case CMD_SETPCM:
+                XGM_setPCMFast(cmd->id, cmd->sample, cmd->len);
+                break;
+
+            case CMD_PLAYPCM:
+                // point to Z80 PCM parameters
+                pb = (u8 *) (Z80_DRV_PARAMS + 0x04 + (cmd->channel * 2));
+                // set PCM priority and id
+                pb[0x00] = cmd->priority;
+                pb[0x01] = cmd->id;
+                // play PCM channel command
+                com |= Z80_DRV_COM_PLAY << cmd->channel;
+                break;
+
+            case CMD_SETLOOP:
+                // point to Z80 loop parameter
+                pb = (u8 *) (Z80_DRV_PARAMS + 0x0C);
+                *pb = cmd->id;
+                break;
+        }
+
+        ind = (ind + 1) & (XGM_COMMAND_QUEUE_SIZE - 1);
+    }
+
+    // set all play PCM channel commands at once
+    if (com)
+    {
+        pb = (u8 *) Z80_DRV_COMMAND;
+        *pb |= com;
+    }
+
+    cmdRead = ind;
 }
 
 void XGM_nextXFrame(u16 num)
@@ -578,6 +1045,36 @@ void XGM_nextXFrame(u16 num)
     SYS_enableInts();
 }
 
+// wait for the Z80 to complete pending XGM frame(s) before DMA (avoid main BUS contention on PSG writes)
+// interrupts should be disabled and Z80 bus protection enabled when calling this method
+void XGM_waitFrameProcessed(u16 maxSubTick)
+{
+    vu8 *pb;
+    u16 remain = maxSubTick;
+
+    // driver should be loaded here
+    if (currentDriver != Z80_DRIVER_XGM)
+        return;
+
+    // point to MODIFYING_F parameter
+    pb = (u8 *) (Z80_DRV_PARAMS + 0x0E);
+
+    while(TRUE)
+    {
+        bool busTaken = Z80_getAndRequestBus(TRUE);
+        // PENDING_FRM is decremented when frame commands are all executed
+        const bool done = !pb[0] && !pb[1];
+        if (!busTaken) Z80_releaseBus();
+
+        // frame done or Z80 busy for too long --> don't wait more
+        if (done || (remain < 2)) return;
+
+        // let Z80 work without bus request interference for a bit (~200 cycles)
+        waitSubTick(2);
+        remain -= 2;
+    }
+}
+
 // VInt processing for XGM driver
 void XGM_doVBlankProcess()
 {
@@ -5,8 +5,27 @@
 
 #include "vdp.h"
 #include "z80_ctrl.h"
+#include "memory.h"
 
 
+// shadow register file (value and known / pending state bit per register)
+static u8 shadow[2][256];
+static u16 known[2][16];
+static u16 pending[2][16];
+// pending writes in order of submission (part in bit 8), key on/off value stored separately as it's an event
+static u16 queue[YM2612_SHADOW_QUEUE_SIZE];
+static u8 keyValues[YM2612_SHADOW_QUEUE_SIZE];
+static u16 queueLen = 0;
+// last written address for each part (YM2612_write(..) tracking)
+static u8 lastAddr[2];
+
+
+static void setShadow(u16 part, u8 reg, u8 value)
+{
+    shadow[part][reg] = value;
+    known[part][reg >> 4] |= 1 << (reg & 0xF);
+}
+
 static void writeSlotReg(u16 port, u8 ch, u8 sl, u8 reg, u8 value)
 {
     YM2612_write((port * 2) + 0, reg | (sl * 4) | ch);
@@ -91,6 +110,9 @@ void YM2612_reset()
 
     if (!busTaken)
         Z80_releaseBus();
+
+    // shadow doesn't know register values anymore
+    YM2612_resetShadow();
 }
 
 
@@ -113,6 +135,10 @@ void YM2612_write(const u16 port, const u8 data)
     while (*pb < 0);
     // write data
     pb[port & 3] = data;
+
+    // keep shadow updated
+    if (port & 1) setShadow((port >> 1) & 1, lastAddr[(port >> 1) & 1], data);
+    else lastAddr[(port >> 1) & 1] = data;
 }
 
 void YM2612_writeSafe(const u16 port, const u8 data)
@@ -144,6 +170,9 @@ void YM2612_writeReg(const u16 part, const u8 reg, const u8 data)
     while (*pb < 0);
     // set data
     pb[port + 1] = data;
+
+    // keep shadow updated
+    setShadow(part & 1, reg, data);
 }
 
 void YM2612_writeRegSafe(const u16 part, const u8 reg, const u8 data)
@@ -152,6 +181,128 @@ void YM2612_writeRegSafe(const u16 part, const u8 reg, const u8 data)
 }
 
 
+void YM2612_resetShadow()
+{
+    memset(known, 0, sizeof(known));
+    memset(pending, 0, sizeof(pending));
+    queueLen = 0;
+}
+
+u8 YM2612_getShadowReg(const u16 part, const u8 reg)
+{
+    return shadow[part & 1][reg];
+}
+
+bool YM2612_writeRegCached(const u16 part, const u8 reg, const u8 data)
+{
+    const u16 p = part & 1;
+    const u16 bit = 1 << (reg & 0xF);
+
+    // redundant write (key register is an event so always written)
+    if ((reg != 0x28) && (known[p][reg >> 4] & bit) && (shadow[p][reg] == data)) return FALSE;
+
+    YM2612_writeReg(p, reg, data);
+
+    return TRUE;
+}
+
+bool YM2612_writeRegBuffered(const u16 part, const u8 reg, const u8 data)
+{
+    const u16 p = part & 1;
+    const u16 bit = 1 << (reg & 0xF);
+    u16* pend = &pending[p][reg >> 4];
+
+    // key on/off is an event: always queued with its value
+    if (reg == 0x28)
+    {
+        if (queueLen >= YM2612_SHADOW_QUEUE_SIZE) YM2612_flushShadow();
+
+        keyValues[queueLen] = data;
+        queue[queueLen++] = (p << 8) | reg;
+
+        return TRUE;
+    }
+
+    // redundant write (register not already pending so hardware has this value)
+    if (!(*pend & bit) && (known[p][reg >> 4] & bit) && (shadow[p][reg] == data)) return FALSE;
+
+    shadow[p][reg] = data;
+    known[p][reg >> 4] |= bit;
+
+    // already pending --> only value changed
+    if (*pend & bit) return TRUE;
+
+    if (queueLen >= YM2612_SHADOW_QUEUE_SIZE) YM2612_flushShadow();
+
+    *pend |= bit;
+    queue[queueLen++] = (p << 8) | reg;
+
+    return TRUE;
+}
+
+u16 YM2612_flushShadow()
+{
+    const u16 len = queueLen;
+
+    if (!len) return 0;
+
+    vs8 *pb = (s8*) YM2612_BASEPORT;
+    const u16 busTaken = Z80_getAndRequestBus(TRUE);
+
+    for(u16 i = 0; i < len; i++)
+    {
+        const u16 e = queue[i];
+        const u16 p = e >> 8;
+        const u8 reg = e;
+        vs8 *port = pb + (p * 2);
+        u8 value;
+
+        if (reg == 0x28) value = keyValues[i];
+        else
+        {
+            value = shadow[p][reg];
+            pending[p][reg >> 4] &= ~(1 << (reg & 0xF));
+        }
+
+        // wait while YM2612 busy
+        while (*pb < 0);
+        port[0] = reg;
+        // busy flag is not updated immediatly, force wait (needed on MD2)
+        asm volatile ("nop");
+        asm volatile ("nop");
+        asm volatile ("nop");
+        asm volatile ("nop");
+        asm volatile ("nop");
+        while (*pb < 0);
+        port[1] = value;
+
+        // frequency MSB is latched until LSB is written --> always follow it by LSB
+        if (((reg >= 0xA4) && (reg <= 0xA6)) || ((reg >= 0xAC) && (reg <= 0xAE)))
+        {
+            const u8 lsb = reg - 4;
+
+            // LSB value not known yet (it will be written later)
+            if (!(known[p][lsb >> 4] & (1 << (lsb & 0xF)))) continue;
+
+            while (*pb < 0);
+            port[0] = lsb;
+            asm volatile ("nop");
+            asm volatile ("nop");
+            asm volatile ("nop");
+            asm volatile ("nop");
+            asm volatile ("nop");
+            while (*pb < 0);
+            port[1] = shadow[p][lsb];
+        }
+    }
+
+    if (!busTaken) Z80_releaseBus();
+
+    queueLen = 0;
+
+    return len;
+}
+
 void YM2612_enableDAC()
 {
     // enable DAC
@@ -11,12 +11,15 @@
 #include "vdp.h"
 #include "sound.h"
 #include "xgm.h"
+#include "tools.h"
+#include "ext/fractal/fractal.h"
 
 // Z80 drivers
 #include "z80_drv0.h"
 #include "z80_drv1.h"
 #include "z80_drv2.h"
 #include "z80_drv3.h"
+#include "z80_drv4.h"
 #include "z80_xgm.h"
 
 #include "tab_vol.h"
@@ -34,6 +37,8 @@ u16 busProtectSignalAddress;
 
 // we don't want to share it
 extern void XGM_resetLoadCalculation();
+extern void XGM_savePCMTable();
+extern void XGM_restorePCMTable();
 
 
 void Z80_init()
@@ -221,23 +226,45 @@ void Z80_unloadDriver()
     // already unloaded
     if (currentDriver == Z80_DRIVER_NULL) return;
 
+    // keep XGM sample table if requested
+    if (currentDriver == Z80_DRIVER_XGM) XGM_savePCMTable();
+
     // clear Z80 RAM
     Z80_clear(0, Z80_RAM_LEN, TRUE);
 
     currentDriver = Z80_DRIVER_NULL;
 
-    // remove XGM task if present
-    VBlankProcess &= ~PROCESS_XGM_TASK;
+    // remove XGM / Fractal task if present
+    VBlankProcess &= ~(PROCESS_XGM_TASK | PROCESS_FRACTAL_TASK);
 }
 
 void Z80_loadDriver(const u16 driver, const bool waitReady)
 {
     const u8 *drv;
     u16 len;
+    u16 clearEnd;
 
     // already loaded
     if (currentDriver == driver) return;
 
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+    const u32 start = getSubTick();
+#endif
+
+    // keep XGM sample table if requested
+    if (currentDriver == Z80_DRIVER_XGM) XGM_savePCMTable();
+
+    // Fractal uploads its own Z80 driver and does all the setup
+    if (driver == Z80_DRIVER_FRACTAL)
+    {
+#if (MODULE_FRACTAL != 0)
+        Fractal_Init(Fractal_Decompress);
+#elif (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("Z80_loadDriver(..) failed: Fractal driver requires MODULE_FRACTAL to be enabled in config.h");
+#endif
+        return;
+    }
+
     switch(driver)
     {
         case Z80_DRIVER_NULL:
@@ -245,33 +272,54 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             len = sizeof(z80_drv0);
             break;
 
+#if (ENABLE_Z80_DRIVER_PCM != 0)
         case Z80_DRIVER_PCM:
             drv = z80_drv1;
             len = sizeof(z80_drv1);
             break;
+#endif
 
+#if (ENABLE_Z80_DRIVER_2ADPCM != 0)
         case Z80_DRIVER_2ADPCM:
             drv = z80_drv2;
             len = sizeof(z80_drv2);
             break;
+#endif
 
+#if (ENABLE_Z80_DRIVER_4PCM != 0)
         case Z80_DRIVER_4PCM:
             drv = z80_drv3;
             len = sizeof(z80_drv3);
             break;
+#endif
 
+#if (ENABLE_Z80_DRIVER_XGM != 0)
         case Z80_DRIVER_XGM:
             drv = z80_xgm;
             len = sizeof(z80_xgm);
             break;
+#endif
+
+#if (ENABLE_Z80_DRIVER_UNPACK != 0)
+        case Z80_DRIVER_UNPACK:
+            drv = z80_drv4;
+            len = sizeof(z80_drv4);
+            break;
+#endif
 
         default:
-            // no valid driver to load
+            // no valid driver to load (or driver removed from library profile)
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+            KLog_U1("Z80_loadDriver(..) failed: unknown driver or driver disabled in config.h, driver = ", driver);
+#endif
             return;
     }
 
-    // clear z80 memory
-    Z80_clear(0, Z80_RAM_LEN, FALSE);
+    // 4PCM volume table is uploaded right after so don't clear it
+    clearEnd = (driver == Z80_DRIVER_4PCM)?0x1000:Z80_RAM_LEN;
+
+    // clear z80 memory (only part not overwritten by the driver upload)
+    Z80_clear(len, clearEnd - len, FALSE);
     // upload Z80 driver and reset Z80
     Z80_upload(0, drv, len, TRUE);
 
@@ -281,6 +329,7 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
         vu8 *pb;
         u32 addr;
 
+#if (ENABLE_Z80_DRIVER_2ADPCM != 0)
         case Z80_DRIVER_2ADPCM:
             // misc parameters initialisation
             Z80_requestBus(TRUE);
@@ -296,7 +345,9 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             pb[3] = sizeof(smp_null_pcm) >> 15;
             Z80_releaseBus();
             break;
+#endif
 
+#if (ENABLE_Z80_DRIVER_PCM != 0)
         case Z80_DRIVER_PCM:
             // misc parameters initialisation
             Z80_requestBus(TRUE);
@@ -312,7 +363,9 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             pb[3] = sizeof(smp_null) >> 16;
             Z80_releaseBus();
             break;
+#endif
 
+#if (ENABLE_Z80_DRIVER_4PCM != 0)
         case Z80_DRIVER_4PCM:
             // load volume table
             Z80_upload(0x1000, tab_vol, 0x1000, 0);
@@ -331,7 +384,9 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             pb[7] = sizeof(smp_null) >> 16;
             Z80_releaseBus();
             break;
+#endif
 
+#if (ENABLE_Z80_DRIVER_XGM != 0)
         case Z80_DRIVER_XGM:
             // reset sound chips
             YM2612_reset();
@@ -350,7 +405,11 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             pb[2] = sizeof(smp_null) >> 8;
             pb[3] = sizeof(smp_null) >> 16;
             Z80_releaseBus();
+
+            // restore saved sample table if any
+            XGM_restorePCMTable();
             break;
+#endif
     }
 
     // wait driver for being ready
@@ -363,6 +422,7 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             case Z80_DRIVER_PCM:
             case Z80_DRIVER_4PCM:
             case Z80_DRIVER_XGM:
+            case Z80_DRIVER_UNPACK:
                 Z80_releaseBus();
                 // wait bus released
                 while(Z80_isBusTaken());
@@ -393,26 +453,40 @@ void Z80_loadDriver(const u16 driver, const bool waitReady)
             Z80_useBusProtection((Z80_DRV_PARAMS + 0x0D) & 0xFFFF);
             break;
 
+        // RLE unpacker driver
+        case Z80_DRIVER_UNPACK:
+            VBlankProcess &= ~(PROCESS_XGM_TASK | PROCESS_FRACTAL_TASK);
+            // no ROM access from Z80 during DMA
+            Z80_useBusProtection((Z80_DRV_PARAMS + 0x03) & 0xFFFF);
+            break;
+
         default:
-            VBlankProcess &= ~PROCESS_XGM_TASK;
+            VBlankProcess &= ~(PROCESS_XGM_TASK | PROCESS_FRACTAL_TASK);
             // no bus protection (signal address set to 0)
             Z80_useBusProtection(0);
             break;
     }
+
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_INFO)
+    KLog_U2("Z80_loadDriver(..): driver ", driver, " loaded in (subtick) ", getSubTick() - start);
+#endif
 }
 
 void Z80_loadCustomDriver(const u8 *drv, u16 size)
 {
-    // clear z80 memory
-    Z80_clear(0, Z80_RAM_LEN, FALSE);
+    // keep XGM sample table if requested
+    if (currentDriver == Z80_DRIVER_XGM) XGM_savePCMTable();
+
+    // clear z80 memory (only part not overwritten by the driver upload)
+    Z80_clear(size, Z80_RAM_LEN - size, FALSE);
     // upload Z80 driver and reset Z80
     Z80_upload(0, drv, size, TRUE);
 
     // custom driver set
     currentDriver = Z80_DRIVER_CUSTOM;
 
-    // remove XGM task if present
-    VBlankProcess &= ~PROCESS_XGM_TASK;
+    // remove XGM / Fractal task if present
+    VBlankProcess &= ~(PROCESS_XGM_TASK | PROCESS_FRACTAL_TASK);
 }
 
 u16 Z80_isDriverReady()
@@ -0,0 +1,6 @@
+#ifndef _Z80_DRV4_H_
+#define _Z80_DRV4_H_
+
+extern const u8 z80_drv4[0x400];
+
+#endif // _Z80_DRV4_H_
@@ -0,0 +1,221 @@
+#include "config.h"
+#include "types.h"
+
+#include "z80_job.h"
+
+#include "z80_ctrl.h"
+#include "sys.h"
+#include "dma.h"
+#include "tools.h"
+
+
+#if (ENABLE_Z80_DRIVER_UNPACK != 0)
+
+// driver parameters (see z80_drv4.s80)
+#define UNP_SRCADR      (Z80_DRV_PARAMS + 0x00)
+#define UNP_BUFLEN0     (Z80_DRV_PARAMS + 0x04)
+#define UNP_BUFRDY0     (Z80_DRV_PARAMS + 0x08)
+
+// driver buffers
+#define UNP_BUFFER0     (Z80_RAM + 0x1000)
+
+
+// next block to pull (0 or 1)
+static u16 nextBuf;
+
+
+// forward
+static u16 getReadyLength(void);
+static void releaseBlock(void);
+
+
+bool Z80JOB_unpack(const u8* src)
+{
+    vu8 *pb;
+
+    // load driver if needed
+    if (Z80_getLoadedDriver() != Z80_DRIVER_UNPACK)
+        Z80_loadDriver(Z80_DRIVER_UNPACK, TRUE);
+    else if (Z80JOB_isBusy())
+    {
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+        KLog("Z80JOB_unpack(..) failed: unpacking already in progress");
+#endif
+        return FALSE;
+    }
+
+    const u32 addr = (u32) src;
+    const bool busTaken = Z80_getAndRequestBus(TRUE);
+
+    // source address
+    pb = (u8 *) UNP_SRCADR;
+    pb[0] = addr >> 0;
+    pb[1] = addr >> 8;
+    pb[2] = addr >> 16;
+    // buffers empty
+    pb = (u8 *) UNP_BUFRDY0;
+    pb[0] = 0;
+    pb[1] = 0;
+    // start unpacking
+    pb = (u8 *) Z80_DRV_COMMAND;
+    *pb = Z80_DRV_COM_PLAY;
+
+    if (!busTaken) Z80_releaseBus();
+
+    nextBuf = 0;
+
+    return TRUE;
+}
+
+bool Z80JOB_isBusy()
+{
+    vu8 *pb;
+    bool result;
+
+    if (Z80_getLoadedDriver() != Z80_DRIVER_UNPACK) return FALSE;
+
+    const bool busTaken = Z80_getAndRequestBus(TRUE);
+
+    // command pending, unpacking or block ready
+    result = (*((vu8 *) Z80_DRV_COMMAND) & Z80_DRV_COM_PLAY) || (*((vu8 *) Z80_DRV_STATUS) & Z80_DRV_STAT_PLAYING);
+    pb = (u8 *) UNP_BUFRDY0;
+    result |= pb[0] | pb[1];
+
+    if (!busTaken) Z80_releaseBus();
+
+    return result;
+}
+
+
+u16 Z80JOB_pull(u8* dest)
+{
+    if (Z80_getLoadedDriver() != Z80_DRIVER_UNPACK) return 0;
+
+    const bool busTaken = Z80_getAndRequestBus(TRUE);
+    const u16 len = getReadyLength();
+
+    if (len)
+    {
+        // Z80 RAM is only accessible as byte
+        const vu8 *src = (u8 *) (UNP_BUFFER0 + (nextBuf * Z80JOB_BLOCK_SIZE));
+        u8 *dst = dest;
+        u16 i = len;
+
+        while(i--) *dst++ = *src++;
+
+        releaseBlock();
+    }
+
+    if (!busTaken) Z80_releaseBus();
+
+    return len;
+}
+
+u16 Z80JOB_pullToVRAM(u16 vramAddr)
+{
+    u16 len;
+
+    if (Z80_getLoadedDriver() != Z80_DRIVER_UNPACK) return 0;
+
+    // DMA temporary buffer can be flushed on interrupt
+    SYS_disableInts();
+    const bool busTaken = Z80_getAndRequestBus(TRUE);
+
+    len = getReadyLength();
+
+    if (len)
+    {
+        const u16 lenW = (len + 1) >> 1;
+        u16 *dst = DMA_allocateAndQueueDma(DMA_VRAM, vramAddr, lenW, 2);
+
+        if (dst)
+        {
+            // Z80 RAM is only accessible as byte
+            const vu8 *src = (u8 *) (UNP_BUFFER0 + (nextBuf * Z80JOB_BLOCK_SIZE));
+            u16 i = lenW;
+
+            while(i--)
+            {
+                const u16 hi = *src++;
+                *dst++ = (hi << 8) | *src++;
+            }
+
+            releaseBlock();
+        }
+        // DMA queue / buffer full --> keep the block for later
+        else len = 0;
+    }
+
+    if (!busTaken) Z80_releaseBus();
+    SYS_enableInts();
+
+    return len;
+}
+
+
+u32 Z80JOB_unpackAll(const u8* src, u8* dest)
+{
+    u8 *dst = dest;
+
+    if (!Z80JOB_unpack(src)) return 0;
+
+    while(Z80JOB_isBusy())
+        dst += Z80JOB_pull(dst);
+
+    return dst - dest;
+}
+
+
+// Z80 bus should be taken
+static u16 getReadyLength()
+{
+    const vu8 *pb = (u8 *) UNP_BUFRDY0;
+
+    if (!pb[nextBuf]) return 0;
+
+    // little endian length
+    pb = (u8 *) (UNP_BUFLEN0 + (nextBuf * 2));
+    return pb[0] | (pb[1] << 8);
+}
+
+// Z80 bus should be taken
+static void releaseBlock()
+{
+    vu8 *pb = (u8 *) UNP_BUFRDY0;
+
+    // Z80 can refill this buffer
+    pb[nextBuf] = 0;
+    nextBuf ^= 1;
+}
+
+#else
+
+bool Z80JOB_unpack(const u8* src)
+{
+#if (LIB_LOG_LEVEL >= LOG_LEVEL_ERROR)
+    KLog("Z80JOB_unpack(..) failed: unpack driver disabled in config.h (ENABLE_Z80_DRIVER_UNPACK)");
+#endif
+    return FALSE;
+}
+
+bool Z80JOB_isBusy()
+{
+    return FALSE;
+}
+
+u16 Z80JOB_pull(u8* dest)
+{
+    return 0;
+}
+
+u16 Z80JOB_pullToVRAM(u16 vramAddr)
+{
+    return 0;
+}
+
+u32 Z80JOB_unpackAll(const u8* src, u8* dest)
+{
+    return 0;
+}
+
+#endif // ENABLE_Z80_DRIVER_UNPACK
@@ -3,6 +3,7 @@ package sgdk.aplib;
 import java.io.IOException;
 import java.util.ArrayList;
 import java.util.Collections;
+import java.util.stream.IntStream;
 
 /**
  * aPLib compression is a LZSS based lossless compression algorithm by Jorgen Ibsen - http://www.ibsensoftware.com
@@ -12,8 +13,12 @@ import java.util.Collections;
  */
 public class APJ
 {
+    // minimum data size to search matches in parallel (ultra mode)
+    final static int PARALLEL_MIN_SIZE = 4096;
+
     static class Match
     {
+        final private State state;
         final private byte[] data;
         private int index;
 
@@ -24,10 +29,11 @@ public class APJ
         private int cost;
         private int saved;
 
-        public Match(byte[] data, int index, int offset, int length)
+        public Match(State state, byte[] data, int index, int offset, int length)
         {
             super();
 
+            this.state = state;
             this.data = data;
             this.index = index;
 
@@ -90,7 +96,7 @@ public class APJ
                 int c = 2;
 
                 // can re-use last offset ?
-                if (!wasMatch && (lastOffset == offset))
+                if (!state.wasMatch && (state.lastOffset == offset))
                     // minimal variable encoding cost
                     c += 2;
                 else
@@ -189,22 +195,28 @@ public class APJ
         }
     }
 
-    // stats
-    static long statMiss;
-    static long statLiteral;
-    static long statShortZero;
-    static long statRLE1;
-    static long statRLEShort;
-    static long statRLELong;
-    static long statTinyMatch;
-    static long statShortMatch;
-    static long statLongMatch;
-    static long statRepeatMatch;
-
-    static boolean wasMatch;
-    static int lastOffset;
-
-    private static Match findBestMatch(ByteMatchList[] byteMatches, byte[] data, int ind)
+    /**
+     * Packing state (previous block information and stats), one per pack operation so packing is thread safe.
+     */
+    static class State
+    {
+        // stats
+        long statMiss;
+        long statLiteral;
+        long statShortZero;
+        long statRLE1;
+        long statRLEShort;
+        long statRLELong;
+        long statTinyMatch;
+        long statShortMatch;
+        long statLongMatch;
+        long statRepeatMatch;
+
+        boolean wasMatch;
+        int lastOffset;
+    }
+
+    private static Match findBestMatch(State state, ByteMatchList[] byteMatches, byte[] data, int ind)
     {
         // nothing we can do
         if (ind < 1)
@@ -237,7 +249,7 @@ public class APJ
             // less repeat on match
             if (repeat < curRepeat)
             {
-                final Match match = new Match(data, ind, ind - off, repeat + 1);
+                final Match match = new Match(state, data, ind, ind - off, repeat + 1);
 
                 // we use >= as we always prefer shorter offset
                 if (match.getSaved() >= saved)
@@ -271,12 +283,12 @@ public class APJ
                         repeat = (ind - off) - 1;
 
                     // easy optimization
-                    match = getMatch(data, off + repeat, ind + repeat);
+                    match = getMatch(state, data, off + repeat, ind + repeat);
                     // adjust match length
                     match.incLength(repeat);
                 }
                 else
-                    match = getMatch(data, off, ind);
+                    match = getMatch(state, data, off, ind);
 
                 // we use >= as we always prefer shorter offset
                 if (match.getSaved() >= saved)
@@ -293,7 +305,7 @@ public class APJ
         return best;
     }
 
-    private static Match getMatch(byte[] data, int from, int ind)
+    private static Match getMatch(State state, byte[] data, int from, int ind)
     {
         int refOffset;
         int curOffset;
@@ -306,7 +318,7 @@ public class APJ
         while ((curOffset < data.length) && (data[refOffset++] == data[curOffset++]))
             len++;
 
-        return new Match(data, ind, ind - from, len);
+        return new Match(state, data, ind, ind - from, len);
     }
 
     private static int getRepeat(byte[] data, int ind)
@@ -427,15 +439,15 @@ public class APJ
             stream.writeBit((value >> i) & 1);
     }
 
-    private static void writeLiteral(BitWriter stream, int data)
+    private static void writeLiteral(State state, BitWriter stream, int data)
     {
         stream.writeBit(0);
         stream.writeUByte(data);
-        wasMatch = false;
-        statLiteral++;
+        state.wasMatch = false;
+        state.statLiteral++;
     }
 
-    private static void writeTinyBlock(BitWriter stream, int offset)
+    private static void writeTinyBlock(State state, BitWriter stream, int offset)
     {
         // should not be the case
         if ((offset < 0) || (offset > 15))
@@ -452,15 +464,15 @@ public class APJ
         // single byte data (111oooo)
         writeFixedNumber(stream, offset, 4);
 
-        wasMatch = false;
-        statTinyMatch++;
+        state.wasMatch = false;
+        state.statTinyMatch++;
         if (offset == 0)
-            statShortZero++;
+            state.statShortZero++;
         if (offset == 1)
-            statRLE1++;
+            state.statRLE1++;
     }
 
-    private static void writeShortBlock(BitWriter stream, int offset, int length)
+    private static void writeShortBlock(State state, BitWriter stream, int offset, int length)
     {
         // should not be the case
         if ((offset < 1) || (offset > 127))
@@ -483,14 +495,14 @@ public class APJ
         // single byte data (oooooool)
         stream.writeUByte((offset << 1) | (length - 2));
 
-        lastOffset = offset;
-        wasMatch = true;
-        statShortMatch++;
+        state.lastOffset = offset;
+        state.wasMatch = true;
+        state.statShortMatch++;
         if (offset == 1)
-            statRLEShort++;
+            state.statRLEShort++;
     }
 
-    private static void writeBlock(BitWriter stream, int offset, int length)
+    private static void writeBlock(State state, BitWriter stream, int offset, int length)
     {
         // block signature
         stream.writeBit(1);
@@ -499,33 +511,33 @@ public class APJ
         // if the last operations were literal or single byte
         // and the offset is unchanged since the last block copy
         // we can just store a 'null' offset and the length
-        if (!wasMatch && (lastOffset == offset))
+        if (!state.wasMatch && (state.lastOffset == offset))
         {
             // minimal variable number (means 0)
             writeVariableNumber(stream, 2);
             writeVariableNumber(stream, length);
-            statRepeatMatch++;
+            state.statRepeatMatch++;
             if (offset == 1)
-                statRLELong++;
+                state.statRLELong++;
         }
         else
         {
             int highOffset = (offset >> 8) + 2;
             int lowOffset = offset & 0xFF;
 
-            if (!wasMatch)
+            if (!state.wasMatch)
                 highOffset++;
 
             writeVariableNumber(stream, highOffset);
             stream.writeUByte(lowOffset);
             writeVariableNumber(stream, length - getLengthDelta(offset));
-            statLongMatch++;
+            state.statLongMatch++;
             if (offset == 1)
-                statRLELong++;
+                state.statRLELong++;
         }
 
-        lastOffset = offset;
-        wasMatch = true;
+        state.lastOffset = offset;
+        state.wasMatch = true;
     }
 
     private static void writeEndBlock(BitWriter stream)
@@ -587,22 +599,29 @@ public class APJ
             Collections.sort(byteMatches[i]);
 
         // PASS 2: get best match for each source position using the matches table
-        wasMatch = false;
-        lastOffset = -1;
+        final State state = new State();
+        state.wasMatch = false;
+        state.lastOffset = -1;
         final Match[] matches = new Match[data.length];
 
         if (ultra)
         {
-            // ultra compression mode (very slow)
-            for (int i = 1; i < matches.length; i++)
-                matches[i] = findBestMatch(byteMatches, data, i);
+            // ultra compression mode (very slow): best matches are independent (state isn't modified here) so search
+            // them in parallel, result is identical to serial search
+            if (matches.length >= PARALLEL_MIN_SIZE)
+                IntStream.range(1, matches.length).parallel().forEach(i -> matches[i] = findBestMatch(state, byteMatches, data, i));
+            else
+            {
+                for (int i = 1; i < matches.length; i++)
+                    matches[i] = findBestMatch(state, byteMatches, data, i);
+            }
         }
         else
         {
             // fast compression mode
             for (int i = 1; i < matches.length;)
             {
-                final Match match = findBestMatch(byteMatches, data, i);
+                final Match match = findBestMatch(state, byteMatches, data, i);
 
                 matches[i] = match;
 
@@ -612,16 +631,16 @@ public class APJ
 
                     if (match.isShortOrLong())
                     {
-                        lastOffset = match.offset;
-                        wasMatch = true;
+                        state.lastOffset = match.offset;
+                        state.wasMatch = true;
                     }
                     else
-                        wasMatch = false;
+                        state.wasMatch = false;
                 }
                 else
                 {
                     i++;
-                    wasMatch = false;
+                    state.wasMatch = false;
                 }
             }
         }
@@ -661,24 +680,24 @@ public class APJ
         }
 
         // clear stats
-        statMiss = 0;
-        statLiteral = 0;
-        statTinyMatch = 0;
-        statShortMatch = 0;
-        statLongMatch = 0;
-        statRepeatMatch = 0;
-        statRLE1 = 0;
-        statRLEShort = 0;
-        statRLELong = 0;
-        statShortZero = 0;
+        state.statMiss = 0;
+        state.statLiteral = 0;
+        state.statTinyMatch = 0;
+        state.statShortMatch = 0;
+        state.statLongMatch = 0;
+        state.statRepeatMatch = 0;
+        state.statRLE1 = 0;
+        state.statRLEShort = 0;
+        state.statRLELong = 0;
+        state.statShortZero = 0;
 
         // PASS 4: build compressed data from optimal matches
-        lastOffset = 0;
-        wasMatch = false;
+        state.lastOffset = 0;
+        state.wasMatch = false;
 
         // always write first byte as it
         result.writeUByte(data[0]);
-        statLiteral++;
+        state.statLiteral++;
 
         int ind = 1;
         while (ind < matches.length)
@@ -694,21 +713,21 @@ public class APJ
                 done = true;
 
                 if ((l == 1) && (off > 0) && (off < 16))
-                    writeTinyBlock(result, off);
+                    writeTinyBlock(state, result, off);
                 else if ((l >= 2) && (l <= 3) && (off > 0) && (off < 0x80))
-                    writeShortBlock(result, off, l);
+                    writeShortBlock(state, result, off, l);
                 else if ((l >= 2) && (off >= 0x80) && (off < 0x500))
-                    writeBlock(result, off, l);
+                    writeBlock(state, result, off, l);
                 else if ((l >= 3) && (off >= 0x500) && (off < 0x7D00))
-                    writeBlock(result, off, l);
+                    writeBlock(state, result, off, l);
                 else if (l >= 4)
-                    writeBlock(result, off, l);
+                    writeBlock(state, result, off, l);
                 else
                 {
                     // long offset with very small match --> can't encode...
                     done = false;
 //                    System.out.println("Can't encode match: ind=" + ind + " - offset=" + off + " - len=" + l);
-                    statMiss++;
+                    state.statMiss++;
                 }
 
                 if (done)
@@ -721,9 +740,9 @@ public class APJ
                 final byte v = data[ind++];
 
                 if (v == 0)
-                    writeTinyBlock(result, 0);
+                    writeTinyBlock(state, result, 0);
                 else
-                    writeLiteral(result, v);
+                    writeLiteral(state, result, v);
             }
         }
 
@@ -733,13 +752,13 @@ public class APJ
         if (!silent)
         {
             System.out.println("Stats:");
-            System.out.println("Literal: " + statLiteral);
+            System.out.println("Literal: " + state.statLiteral);
             System.out.println(
-                    "Tiny matches: " + statTinyMatch + " - short zero: " + statShortZero + " - RLE1: " + statRLE1);
-            System.out.println("Short matches: " + statShortMatch + " - RLE short: " + statRLEShort);
-            System.out.println("Long matches: " + statLongMatch + " - RLE long: " + statRLELong);
-            System.out.println("Repeat matches: " + statRepeatMatch);
-            System.out.println("Miss(es): " + statMiss);
+                    "Tiny matches: " + state.statTinyMatch + " - short zero: " + state.statShortZero + " - RLE1: " + state.statRLE1);
+            System.out.println("Short matches: " + state.statShortMatch + " - RLE short: " + state.statRLEShort);
+            System.out.println("Long matches: " + state.statLongMatch + " - RLE long: " + state.statRLELong);
+            System.out.println("Repeat matches: " + state.statRepeatMatch);
+            System.out.println("Miss(es): " + state.statMiss);
         }
 
         return result.toByteArray();
@@ -758,6 +777,8 @@ public class APJ
         final BitReader source = new BitReader(data);
         final DynamicByteArray result = new DynamicByteArray();
         int offset, len;
+        int lastOffset;
+        boolean wasMatch;
         boolean done;
 
         lastOffset = 0;
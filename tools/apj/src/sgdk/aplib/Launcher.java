@@ -78,7 +78,7 @@ class Launcher
 
     private static void PrintUsage()
     {
-        System.out.println("APJ (ApLib for Java) packer v1.32 by Stephane Dallongeville (Copyright 2021)");
+        System.out.println("APJ (ApLib for Java) packer v1.40 by Stephane Dallongeville (Copyright 2021)");
         System.out.println("  Pack:       java -jar apj.jar p <input_file> <output_file>");
         System.out.println("  Pack max:   java -jar apj.jar pp <input_file> <output_file>");
         System.out.println("  Unpack:     java -jar apj.jar u <input_file> <output_file>");
@@ -0,0 +1,325 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+
+// sample/bench headless result record
+#define RESULT_MAGIC            0x5347424E
+#define RESULT_VERSION          1
+// magic, version, numTest, numSubTest, checksum, globalScore
+#define RESULT_HEADER_SIZE      16
+
+#define MAX_TEST                32
+#define MAX_SUBTEST             32
+
+
+typedef struct
+{
+    int numTest;
+    int numSubTest;
+    unsigned int globalScore;
+    unsigned int scores[MAX_TEST];
+    unsigned int detailledScores[MAX_TEST][MAX_SUBTEST];
+} Result;
+
+
+static const char* testNames[] =
+{
+    "Memory set",
+    "Memory copy",
+    "Memory alloc/release",
+    "VRAM alloc/release",
+    "Maths basic",
+    "Maths advanced",
+    "Maths functions",
+    "VDP background",
+    "Bitmap mode",
+    "Sprite",
+    "Sort",
+    "DMA",
+    "Map scroll",
+    "Sprite scaling",
+    "Unpack",
+    "Sound driver",
+    "Allocator trace",
+    "Collision"
+};
+
+
+static const char* getTestName(int test)
+{
+    if (test < (int) (sizeof(testNames) / sizeof(testNames[0]))) return testNames[test];
+    return "Unknown";
+}
+
+// KDebug log: "#BENCH version numTest numSubTest globalScore" then "#BENCH Tn score subScores..." per test
+static int parseText(const char* text, Result* result)
+{
+    const char* s = text;
+    int found = 0;
+
+    while((s = strstr(s, "#BENCH ")) != NULL)
+    {
+        s += 7;
+
+        if (*s == 'T')
+        {
+            char* end;
+            const int test = strtol(s + 1, &end, 10);
+            int i;
+
+            if (!found || (test < 0) || (test >= result->numTest)) continue;
+
+            s = end;
+            result->scores[test] = strtoul(s, &end, 10);
+            s = end;
+            for(i = 0; i < result->numSubTest; i++)
+            {
+                result->detailledScores[test][i] = strtoul(s, &end, 10);
+                s = end;
+            }
+        }
+        else
+        {
+            int version, numTest, numSubTest;
+            unsigned int score;
+
+            if (sscanf(s, "%d %d %d %u", &version, &numTest, &numSubTest, &score) != 4) continue;
+            if ((version != RESULT_VERSION) || (numTest > MAX_TEST) || (numSubTest > MAX_SUBTEST)) continue;
+
+            // keep last run only
+            memset(result, 0, sizeof(Result));
+            result->numTest = numTest;
+            result->numSubTest = numSubTest;
+            result->globalScore = score;
+            found = 1;
+        }
+    }
+
+    return found;
+}
+
+static unsigned int getU16(const unsigned char* p, int step)
+{
+    return (p[0] << 8) | p[step];
+}
+
+static unsigned int getU32(const unsigned char* p, int step)
+{
+    return (getU16(p, step) << 16) | getU16(p + (step * 2), step);
+}
+
+// SRAM dump: emulators save 8 bit SRAM either as contiguous bytes or as words (data in odd or even byte)
+static int parseSRAM(const unsigned char* data, long dataSize, Result* result)
+{
+    int step;
+    int start;
+
+    for(step = 1; step <= 2; step++)
+    {
+        for(start = 0; start < step; start++)
+        {
+            const unsigned char* p = data + start;
+            unsigned int checksum;
+            long size;
+            int numTest, numSubTest;
+            int i, j;
+
+            if (((RESULT_HEADER_SIZE * step) + start) > dataSize) continue;
+            if ((getU32(p, step) != RESULT_MAGIC) || (getU16(p + (4 * step), step) != RESULT_VERSION)) continue;
+
+            numTest = getU16(p + (6 * step), step);
+            numSubTest = getU16(p + (8 * step), step);
+            if ((numTest > MAX_TEST) || (numSubTest > MAX_SUBTEST)) continue;
+
+            size = RESULT_HEADER_SIZE + (numTest * 2) + (numTest * numSubTest * 2);
+            if (((size * step) + start) > dataSize) continue;
+
+            // checksum = sum of all words following the checksum field
+            checksum = 0;
+            for(i = 12; i < size; i += 2) checksum += getU16(p + (i * step), step);
+            if ((checksum & 0xFFFF) != getU16(p + (10 * step), step)) continue;
+
+            memset(result, 0, sizeof(Result));
+            result->numTest = numTest;
+            result->numSubTest = numSubTest;
+            result->globalScore = getU32(p + (12 * step), step);
+            p += RESULT_HEADER_SIZE * step;
+            for(i = 0; i < numTest; i++, p += 2 * step) result->scores[i] = getU16(p, step);
+            for(i = 0; i < numTest; i++)
+                for(j = 0; j < numSubTest; j++, p += 2 * step) result->detailledScores[i][j] = getU16(p, step);
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int load(const char* file, Result* result)
+{
+    FILE* f;
+    unsigned char* data;
+    long dataSize;
+    int found;
+
+    f = fopen(file, "rb");
+    if (!f)
+    {
+        printf("Error: can't open '%s'\n", file);
+        return 0;
+    }
+
+    fseek(f, 0, SEEK_END);
+    dataSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    data = malloc(dataSize + 1);
+    if (!data || (fread(data, 1, dataSize, f) != (size_t) dataSize))
+    {
+        printf("Error: can't read '%s'\n", file);
+        fclose(f);
+        free(data);
+        return 0;
+    }
+    fclose(f);
+    data[dataSize] = 0;
+
+    found = parseText((const char*) data, result) || parseSRAM(data, dataSize, result);
+    free(data);
+
+    if (!found) printf("Error: no benchmark result found in '%s'\n", file);
+
+    return found;
+}
+
+static void print(const Result* result)
+{
+    int i, j;
+
+    for(i = 0; i < result->numTest; i++)
+    {
+        printf("%-24s %6u  (", getTestName(i), result->scores[i]);
+        for(j = 0; j < result->numSubTest; j++)
+        {
+            if (!result->detailledScores[i][j]) continue;
+            printf("%s%u", j ? " " : "", result->detailledScores[i][j]);
+        }
+        printf(")\n");
+    }
+    printf("%-24s %6u\n", "Global", result->globalScore);
+}
+
+// returns 1 if new score is below base score minus threshold
+static int compareScore(const char* name, unsigned int base, unsigned int cur, double threshold, int verbose)
+{
+    const double delta = base ? ((((double) cur - (double) base) * 100.0) / (double) base) : 0;
+    const int regression = (delta < -threshold);
+
+    if (verbose || regression || (delta > threshold))
+        printf("%-32s %6u %6u  %+7.2f%%%s\n", name, base, cur, delta, regression ? "  REGRESSION" : "");
+
+    return regression;
+}
+
+static int compare(const Result* base, const Result* cur, double threshold, int verbose)
+{
+    char name[64];
+    int numTest = base->numTest;
+    int numSubTest = base->numSubTest;
+    int result = 0;
+    int i, j;
+
+    if ((cur->numTest != numTest) || (cur->numSubTest != numSubTest))
+    {
+        printf("Warning: different test layout (%d x %d / %d x %d), only common tests are compared\n",
+               numTest, numSubTest, cur->numTest, cur->numSubTest);
+        if (cur->numTest < numTest) numTest = cur->numTest;
+        if (cur->numSubTest < numSubTest) numSubTest = cur->numSubTest;
+    }
+
+    printf("%-32s %6s %6s  %8s\n", "test", "base", "new", "delta");
+
+    for(i = 0; i < numTest; i++)
+    {
+        result += compareScore(getTestName(i), base->scores[i], cur->scores[i], threshold, 1);
+
+        for(j = 0; j < numSubTest; j++)
+        {
+            // unused sub test
+            if (!base->detailledScores[i][j] && !cur->detailledScores[i][j]) continue;
+
+            sprintf(name, "  %s #%d", getTestName(i), j + 1);
+            result += compareScore(name, base->detailledScores[i][j], cur->detailledScores[i][j], threshold, verbose);
+        }
+    }
+
+    compareScore("Global", base->globalScore, cur->globalScore, threshold, 1);
+
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    Result* base;
+    Result* cur;
+    const char* baseFile = NULL;
+    const char* curFile = NULL;
+    double threshold = 5;
+    int verbose = 0;
+    int regressions;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-t") && ((i + 1) < argc)) threshold = strtod(argv[++i], NULL);
+        else if (!strcmp(argv[i], "-v")) verbose = 1;
+        else if (!baseFile) baseFile = argv[i];
+        else curFile = argv[i];
+    }
+
+    if (!baseFile)
+    {
+        printf("Benchmark compare v1.00\n");
+        printf("Display or compare SGDK benchmark results (sample/bench built with BENCH_HEADLESS = 1)\n\n");
+        printf("Usage: benchcmp <base_result> [new_result] [-t threshold] [-v]\n");
+        printf("  result        emulator KDebug log or SRAM dump\n");
+        printf("  -t threshold  regression threshold in percent (default = 5)\n");
+        printf("  -v            display all sub test scores (default = only changes above threshold)\n");
+        printf("Returns 2 when a regression is found (for CI usage)\n");
+        return 1;
+    }
+
+    base = malloc(sizeof(Result));
+    cur = malloc(sizeof(Result));
+    if (!base || !cur)
+    {
+        printf("Error: out of memory\n");
+        return 1;
+    }
+
+    if (!load(baseFile, base)) return 1;
+
+    // display only
+    if (!curFile)
+    {
+        print(base);
+        return 0;
+    }
+
+    if (!load(curFile, cur)) return 1;
+
+    regressions = compare(base, cur, threshold, verbose);
+
+    free(cur);
+    free(base);
+
+    if (regressions)
+    {
+        printf("\n%d regression(s) above %.1f%%\n", regressions, threshold);
+        return 2;
+    }
+
+    printf("\nNo regression above %.1f%%\n", threshold);
+    return 0;
+}
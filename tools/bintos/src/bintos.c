@@ -4,6 +4,10 @@
 #include <string.h>
 #include <inttypes.h>
 #include <ctype.h>
+#include <limits.h>
+
+// DMA can't cross a 128 KB boundary
+#define DMA_BOUNDARY    0x20000
 
 
 static char *getFilename(char *pathname)
@@ -31,6 +35,40 @@ static void removeExtension(char *pathname)
     if (fname) *fname = 0;
 }
 
+static long getFileSize(FILE *f)
+{
+    long result;
+
+    fseek(f, 0, SEEK_END);
+    result = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    return result;
+}
+
+static char *getFullPath(char *pathname, char *dest)
+{
+#ifdef _WIN32
+    if (_fullpath(dest, pathname, 4096) == NULL) strcpy(dest, pathname);
+    // assembler accept '/' separator and '\' would need escaping
+    for (char* s = dest; *s; s++) if (*s == '\\') *s = '/';
+#else
+    if (realpath(pathname, dest) == NULL) strcpy(dest, pathname);
+#endif
+
+    return dest;
+}
+
+// returns alignment so data of given size never crosses a DMA boundary (power of 2 >= size, 128 KB max)
+static int getDMASafeAlign(long size)
+{
+    int result = 2;
+
+    while ((result < size) && (result < DMA_BOUNDARY)) result <<= 1;
+
+    return result;
+}
+
 
 int main(int argc, char **argv)
 {
@@ -41,6 +79,9 @@ int main(int argc, char **argv)
     int formatint;
     int formatintasm;
     int nullfill;
+    int incbin;
+    int dmasafe;
+    long size;
     char *format;
     char *formatasm;
     char *shortname;
@@ -62,6 +103,8 @@ int main(int argc, char **argv)
     total = 0;
     align = 2;
     nullfill = 0;
+    incbin = 0;
+    dmasafe = 0;
 
     // parse parmeters
     for (ii = 1; ii < argc; ii++)
@@ -120,10 +163,27 @@ int main(int argc, char **argv)
             ii++;
             nullfill = strtoimax(argv[ii], NULL, 0);
         }
+        else if (!strcmp(argv[ii], "-incbin"))
+            incbin = 1;
+        else if (!strcmp(argv[ii], "-dmasafe"))
+            dmasafe = 1;
         else if (!FileName[0]) FileName = argv[ii];
         else if (!FileNameOut[0]) FileNameOut = argv[ii];
     }
 
+    if (!FileName[0])
+    {
+        printf("Usage: bintos inputFile [outputFile] [options]\n");
+        printf("Convert a binary file to an assembler (.s) file and its C header (.h) file.\n");
+        printf("Options:\n");
+        printf("  -u8 / -s8 / -u16 / -s16 / -u32 / -s32   data type used in header (default is u8)\n");
+        printf("  -align N      data alignment in byte (default is 2)\n");
+        printf("  -nullfill N   value used to pad data to the data type size (default is 0)\n");
+        printf("  -incbin       include binary file with .incbin directive instead of converting data (faster assembly)\n");
+        printf("  -dmasafe      align data so it never crosses a 128 KB boundary (data > 128 KB start on a boundary)\n");
+        return 1;
+    }
+
     if (!FileNameOut[0]) FileNameOut = strdup(FileName);
 
     ext = getFileExtension(FileName);
@@ -153,16 +213,32 @@ int main(int argc, char **argv)
         return 1;
     }
 
+    size = getFileSize(FileInput);
+
     // force align on 2
     if (align < 2) align = 2;
 
     fprintf(FileOutput, ".section .rodata\n\n");
 
-    fprintf(FileOutput, "    .align  %d\n\n", align);
+    fprintf(FileOutput, "    .align  %d\n", align);
+    // DMA safe placement: also align on power of 2 so data doesn't cross 128 KB boundary
+    if (dmasafe && (getDMASafeAlign(size) > align))
+        fprintf(FileOutput, "    .balign %d\n", getDMASafeAlign(size));
+    fprintf(FileOutput, "\n");
     fprintf(FileOutput, "    .global %s\n", shortname);
     fprintf(FileOutput, "%s:\n", shortname);
 
-    while (1)
+    if (incbin)
+    {
+        // padding to the unit size
+        const int pad = ((size + (formatintasm - 1)) & ~(formatintasm - 1)) - size;
+
+        fprintf(FileOutput, "    .incbin \"%s\"\n", getFullPath(FileName, path));
+        if (pad) fprintf(FileOutput, "    .fill   %d, 1, 0x%02X\n", pad, nullfill & 0xFF);
+
+        total = size;
+    }
+    else while (1)
     {
         // start by setting buffer to nullfill
         memset(temp, nullfill, sizeof(temp));
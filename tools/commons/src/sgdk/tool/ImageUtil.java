@@ -30,11 +30,15 @@ import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.HashMap;
 import java.util.HashSet;
+import java.util.Iterator;
 import java.util.List;
 import java.util.Map;
 import java.util.Set;
 
 import javax.imageio.ImageIO;
+import javax.imageio.ImageReader;
+import javax.imageio.ImageTypeSpecifier;
+import javax.imageio.stream.ImageInputStream;
 
 /**
  * Image utilities class.
@@ -576,6 +580,35 @@ public class ImageUtil
 
     public static BasicImageInfo getBasicInfo(String filename) throws IOException
     {
+        // try to only read image header first (avoid decoding the whole image)
+        try (ImageInputStream iis = ImageIO.createImageInputStream(new File(filename)))
+        {
+            final Iterator<ImageReader> readers = (iis != null) ? ImageIO.getImageReaders(iis) : null;
+
+            if ((readers != null) && readers.hasNext())
+            {
+                final ImageReader reader = readers.next();
+
+                try
+                {
+                    reader.setInput(iis, true, true);
+
+                    // same color model as the one used to decode the image
+                    final Iterator<ImageTypeSpecifier> types = reader.getImageTypes(0);
+                    if (types.hasNext())
+                        return new BasicImageInfo(reader.getWidth(0), reader.getHeight(0), types.next().getColorModel().getPixelSize());
+                }
+                finally
+                {
+                    reader.dispose();
+                }
+            }
+        }
+        catch (IOException e)
+        {
+            // use full image decoding then
+        }
+
         final BufferedImage image;
 
         try
@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define CRASH_DUMP_MAGIC        0x53474344
+#define CRASH_DUMP_VERSION      1
+#define CRASH_DUMP_MAX_SIZE     512
+
+// SRAM file layouts
+#define LAYOUT_BYTE             0
+#define LAYOUT_ODD              1
+#define LAYOUT_EVEN             2
+
+
+static const char* typeNames[] =
+{
+    "UNKNOWN",
+    "BUS ERROR",
+    "ADDRESS ERROR",
+    "ILLEGAL INSTRUCTION",
+    "DIVIDE BY ZERO",
+    "CHK INSTRUCTION",
+    "TRAPV INSTRUCTION",
+    "PRIVILEGE VIOLATION",
+    "EXCEPTION ERROR",
+    "SYS_die()"
+};
+
+static const char* zoneNames[] =
+{
+    "VBlank",
+    "DMA",
+    "Sprite",
+    "Map",
+    "Joy"
+};
+
+static const char* layoutNames[] =
+{
+    "byte",
+    "word (odd)",
+    "word (even)"
+};
+
+static unsigned char dump[CRASH_DUMP_MAX_SIZE];
+static int pos;
+static int size;
+
+
+static unsigned int getU8()
+{
+    if (pos >= size) return 0;
+    return dump[pos++];
+}
+
+static unsigned int getU16()
+{
+    const unsigned int v = getU8() << 8;
+    return v | getU8();
+}
+
+static unsigned int getU32()
+{
+    const unsigned int v = getU16() << 16;
+    return v | getU16();
+}
+
+// extract dump bytes from SRAM file data using given layout, return TRUE if a valid header is found
+static int extract(const unsigned char* data, long dataSize, long offset, int layout)
+{
+    int i;
+
+    for(i = 0; i < CRASH_DUMP_MAX_SIZE; i++)
+    {
+        long adr;
+
+        if (layout == LAYOUT_BYTE) adr = offset + i;
+        else if (layout == LAYOUT_ODD) adr = ((offset + i) * 2) + 1;
+        else adr = (offset + i) * 2;
+
+        dump[i] = (adr < dataSize) ? data[adr] : 0;
+    }
+
+    pos = 0;
+    size = CRASH_DUMP_MAX_SIZE;
+
+    return getU32() == CRASH_DUMP_MAGIC;
+}
+
+static void printDump()
+{
+    unsigned int version, len, sum, s, type;
+    unsigned int i, n;
+
+    pos = 4;
+    version = getU16();
+    len = getU16();
+    sum = getU16();
+
+    if (version != CRASH_DUMP_VERSION) printf("Warning: unsupported dump version %d\n", version);
+    if ((len <= 10) || (len > CRASH_DUMP_MAX_SIZE))
+    {
+        printf("Error: incorrect dump length (%d)\n", len);
+        return;
+    }
+
+    s = 0;
+    for(i = 10; i < len; i++) s += dump[i];
+    if ((s & 0xFFFF) != sum) printf("Warning: checksum mismatch, dump may be corrupted\n");
+
+    // only consider committed data
+    size = len;
+
+    type = getU16();
+    printf("Crash type: %s\n\n", typeNames[(type < (sizeof(typeNames) / sizeof(typeNames[0]))) ? type : 0]);
+
+    {
+        const unsigned int pc = getU32();
+        const unsigned int sr = getU16();
+        const unsigned int ext1 = getU16();
+        const unsigned int ext2 = getU16();
+        const unsigned int addr = getU32();
+
+        if ((type == 1) || (type == 2)) printf("FUNC=%04X ADDR=%08X INST=%04X\n", ext1, addr, ext2);
+        else if ((type == 3) || (type == 5) || (type == 6)) printf("VO=%04X\n", ext1);
+        printf("PC=%08X SR=%04X\n\n", pc, sr);
+    }
+
+    for(i = 0; i < 16; i++)
+        printf("%c%d=%08X%s", (i < 8) ? 'D' : 'A', i & 7, getU32(), ((i & 3) == 3) ? "\n" : " ");
+    printf("\n");
+    for(i = 0; i < 24; i++)
+        printf("SP+%02X=%08X%s", i * 4, getU32(), ((i & 3) == 3) ? "\n" : " ");
+
+    if (type == 9) printf("Note: registers and stack aren't captured by SYS_die(), above values come from last exception\n");
+
+    // performance state
+    if (pos >= size) return;
+
+    printf("\nFrame: %u\n", getU32());
+    printf("Missed frames: %u\n", getU32());
+    {
+        const unsigned int load = getU16();
+        n = getU16();
+        printf("CPU load: %u%%\n", n ? ((load * 100) / (n * 256)) : 0);
+        printf("Last frames load (oldest first):");
+        for(i = 0; i < n; i++)
+        {
+            const unsigned int v = getU16();
+            // upper byte contains the number of missed frames
+            printf(" %u%%%s", ((v & 0xFF) * 100) / 256, (v >> 8) ? "*" : "");
+        }
+        printf("\n");
+    }
+
+    // DMA stats
+    if (getU16())
+    {
+        printf("\nDMA queue statistics:\n");
+        printf("  flushes: %u\n", getU32());
+        printf("  peak bytes: %u\n", getU16());
+        printf("  peak entries: %u\n", getU16());
+        printf("  dropped: %u\n", getU16());
+        printf("  delayed: %u\n", getU16());
+        printf("  truncated: %u\n", getU16());
+        printf("  buffer full: %u\n", getU16());
+        printf("  peak buffer: %u\n", getU16());
+    }
+    else printf("\nDMA queue statistics: not available (ENABLE_DMA_STATS)\n");
+
+    // profiler
+    if (pos >= size) return;
+
+    n = getU16();
+    if (n)
+    {
+        printf("\nProfiler zones (subticks): calls avg max window_max last_frame\n");
+        for(i = 0; i < n; i++)
+        {
+            const unsigned int calls = getU16();
+            const unsigned int avg = getU16();
+            const unsigned int max = getU16();
+            const unsigned int winMax = getU16();
+            const unsigned int frameTime = getU16();
+
+            // unused zone
+            if (!calls) continue;
+
+            if (i < (sizeof(zoneNames) / sizeof(zoneNames[0]))) printf("  %-8s", zoneNames[i]);
+            else printf("  zone %-3d", i);
+            printf(" %5u %5u %5u %5u %5u\n", calls, avg, max, winMax, frameTime);
+        }
+    }
+    else printf("\nProfiler zones: not available (ENABLE_PROFILER)\n");
+
+    // heap
+    if (pos >= size)
+    {
+        printf("\nHeap summary: not available (crashed while parsing heap ?)\n");
+        return;
+    }
+
+    printf("\nHeap summary:\n");
+    printf("  free: %u\n", getU16());
+    printf("  allocated: %u\n", getU16());
+    printf("  largest free block: %u\n", getU16());
+    printf("  peak allocated: %u\n", getU16());
+    printf("  min largest free block: %u\n", getU16());
+}
+
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    unsigned char* data;
+    long dataSize;
+    long offset;
+    int layout;
+    int found;
+
+    if (argc < 2)
+    {
+        printf("Crash dump decoder v1.00\n");
+        printf("Decode SGDK crash dump (ENABLE_CRASH_DUMP) from a SRAM file\n\n");
+        printf("Usage: crashdump <sram_file> [offset]\n");
+        printf("  offset   SRAM offset of the dump as defined by CRASH_DUMP_SRAM_OFFSET (default = 0x7E00)\n");
+        return 1;
+    }
+
+    offset = (argc > 2) ? strtol(argv[2], NULL, 0) : 0x7E00;
+
+    f = fopen(argv[1], "rb");
+    if (!f)
+    {
+        printf("Error: can't open '%s'\n", argv[1]);
+        return 1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    dataSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    data = malloc(dataSize);
+    if (!data || (fread(data, 1, dataSize, f) != (size_t) dataSize))
+    {
+        printf("Error: can't read '%s'\n", argv[1]);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    // depending emulator / flash cart, SRAM can be saved as bytes only or as words (data on odd or even bytes)
+    found = 0;
+    for(layout = LAYOUT_BYTE; layout <= LAYOUT_EVEN; layout++)
+    {
+        if (extract(data, dataSize, offset, layout))
+        {
+            found = 1;
+            break;
+        }
+    }
+
+    free(data);
+
+    if (!found)
+    {
+        printf("No crash dump found at offset 0x%lX\n", offset);
+        return 1;
+    }
+
+    printf("Crash dump found (%s layout)\n", layoutNames[layout]);
+    printDump();
+
+    return 0;
+}
@@ -0,0 +1,354 @@
+package sgdk.dlz;
+
+import java.io.ByteArrayOutputStream;
+
+/**
+ * DLZ (delta LZ) compression, word based format designed for fast 68000 decoding of tiles and tilemaps.<br>
+ * <br>
+ * Format (big endian):<br>
+ * <code>
+ * u32 unpacked size (in byte)<br>
+ * commands (16 bits):<br>
+ * 00LLLLLL LLLLLLLL literal run: L+1 words follow<br>
+ * 01LLLLLL DDDDDDDD delta run: L+1 words, each one = previous word + D (signed byte, D = 0 gives RLE)<br>
+ * 10LLLLLL OOOOOOOO short match: copy L+2 words from O+1 words back<br>
+ * 11LLLLLL LLLLLLLL OOOOOOOO OOOOOOOO long match: copy L+2 words from O+1 words back<br>
+ * last byte (if unpacked size is odd) is stored in the upper byte of an extra word<br>
+ * </code>
+ * Previous word is 0 at start so a delta run can start the data.<br>
+ * Delta runs catch tilemap indexes which usually increment by 1 and plain tile rows (RLE), matches catch repeated tiles
+ * / rows up to 128 KB back.
+ */
+public class DLZ
+{
+    final static int LITERAL_MAX = 0x4000;
+    final static int DELTA_MAX = 0x40;
+    final static int SHORT_MATCH_MIN = 2;
+    final static int SHORT_MATCH_MAX = 0x40 + 1;
+    final static int SHORT_OFFSET_MAX = 0x100;
+    final static int LONG_MATCH_MAX = 0x4000 + 1;
+    final static int LONG_OFFSET_MAX = 0x10000;
+
+    // maximum number of match candidates tested per position
+    final static int MAX_CHAIN = 256;
+
+    // command types
+    final static int CMD_LITERAL = 0;
+    final static int CMD_DELTA = 1;
+    final static int CMD_SHORT = 2;
+    final static int CMD_LONG = 3;
+
+    /**
+     * Pack data using the DLZ algorithm.
+     *
+     * @param data
+     *        data to pack
+     * @return packed data
+     */
+    public static byte[] pack(byte[] data)
+    {
+        final int numWord = data.length / 2;
+        final int[] w = new int[numWord];
+
+        for (int i = 0; i < numWord; i++)
+            w[i] = ((data[(i * 2) + 0] & 0xFF) << 8) | (data[(i * 2) + 1] & 0xFF);
+
+        // match finder: hash chain on word pairs
+        final int[] head = new int[0x10000];
+        final int[] prev = new int[numWord];
+        final int[] matchLen = new int[numWord];
+        final int[] matchOff = new int[numWord];
+        final int[] shortLen = new int[numWord];
+        final int[] shortOff = new int[numWord];
+
+        for (int i = 0; i < head.length; i++)
+            head[i] = -1;
+
+        for (int i = 0; i < numWord; i++)
+        {
+            if (i < (numWord - 1))
+            {
+                final int h = hash(w[i], w[i + 1]);
+                int cand = head[h];
+                int chain = 0;
+
+                while ((cand != -1) && ((i - cand) <= LONG_OFFSET_MAX) && (chain++ < MAX_CHAIN))
+                {
+                    final int max = Math.min(numWord - i, LONG_MATCH_MAX);
+                    int len = 0;
+
+                    while ((len < max) && (w[cand + len] == w[i + len]))
+                        len++;
+
+                    final int off = i - cand;
+
+                    if (len > matchLen[i])
+                    {
+                        matchLen[i] = len;
+                        matchOff[i] = off;
+                    }
+                    if ((off <= SHORT_OFFSET_MAX) && (Math.min(len, SHORT_MATCH_MAX) > shortLen[i]))
+                    {
+                        shortLen[i] = Math.min(len, SHORT_MATCH_MAX);
+                        shortOff[i] = off;
+                    }
+
+                    cand = prev[cand];
+                }
+
+                prev[i] = head[h];
+                head[h] = i;
+            }
+        }
+
+        // optimal parsing (walk backward), cost in byte
+        // cost[i] = best cost from i starting a new command, litCost[i] = best cost from i inside a literal run
+        final int[] cost = new int[numWord + 1];
+        final int[] litCost = new int[numWord + 1];
+        final int[] cmd = new int[numWord];
+        final int[] cmdLen = new int[numWord];
+        final boolean[] litCont = new boolean[numWord + 1];
+
+        cost[numWord] = 0;
+        litCost[numWord] = 0;
+
+        for (int i = numWord - 1; i >= 0; i--)
+        {
+            // literal run starting here
+            int best = 4 + litCost[i + 1];
+            int bestCmd = CMD_LITERAL;
+            int bestLen = 1;
+
+            // delta run
+            final int pw = (i > 0) ? w[i - 1] : 0;
+            final int d = (short) (w[i] - pw);
+
+            if ((d >= -128) && (d <= 127))
+            {
+                int len = 1;
+                int p = w[i];
+
+                while (((i + len) < numWord) && (len < DELTA_MAX) && (((p + d) & 0xFFFF) == w[i + len]))
+                {
+                    p = w[i + len];
+                    len++;
+                }
+                for (int l = 1; l <= len; l++)
+                {
+                    final int c = 2 + cost[i + l];
+
+                    if (c < best)
+                    {
+                        best = c;
+                        bestCmd = CMD_DELTA;
+                        bestLen = l;
+                    }
+                }
+            }
+
+            // short match
+            for (int l = SHORT_MATCH_MIN; l <= shortLen[i]; l++)
+            {
+                final int c = 2 + cost[i + l];
+
+                if (c < best)
+                {
+                    best = c;
+                    bestCmd = CMD_SHORT;
+                    bestLen = l;
+                }
+            }
+
+            // long match (only test all lengths for short enough match)
+            final int ml = matchLen[i];
+            for (int l = SHORT_MATCH_MIN; l <= ml; l++)
+            {
+                if ((l > 256) && (l != ml))
+                    continue;
+
+                final int c = 4 + cost[i + l];
+
+                if (c < best)
+                {
+                    best = c;
+                    bestCmd = CMD_LONG;
+                    bestLen = l;
+                }
+            }
+
+            cost[i] = best;
+            cmd[i] = bestCmd;
+            cmdLen[i] = bestLen;
+
+            // inside a literal run: continue it (2 bytes) or stop it here
+            if ((2 + litCost[i + 1]) <= best)
+            {
+                litCost[i] = 2 + litCost[i + 1];
+                litCont[i] = true;
+            }
+            else
+            {
+                litCost[i] = best;
+                litCont[i] = false;
+            }
+        }
+
+        // build packed data
+        final ByteArrayOutputStream out = new ByteArrayOutputStream(data.length + 16);
+
+        writeLong(out, data.length);
+
+        int i = 0;
+        while (i < numWord)
+        {
+            switch (cmd[i])
+            {
+                case CMD_LITERAL:
+                {
+                    // extend literal run while continuing is better
+                    int end = i + 1;
+                    while ((end < numWord) && litCont[end])
+                        end++;
+
+                    int len = end - i;
+                    while (len > 0)
+                    {
+                        final int n = Math.min(len, LITERAL_MAX);
+
+                        writeWord(out, (CMD_LITERAL << 14) | (n - 1));
+                        for (int j = 0; j < n; j++)
+                            writeWord(out, w[i++]);
+                        len -= n;
+                    }
+                    break;
+                }
+
+                case CMD_DELTA:
+                {
+                    final int pw = (i > 0) ? w[i - 1] : 0;
+                    final int d = (w[i] - pw) & 0xFF;
+
+                    writeWord(out, (CMD_DELTA << 14) | ((cmdLen[i] - 1) << 8) | d);
+                    i += cmdLen[i];
+                    break;
+                }
+
+                case CMD_SHORT:
+                    writeWord(out, (CMD_SHORT << 14) | ((cmdLen[i] - SHORT_MATCH_MIN) << 8) | (shortOff[i] - 1));
+                    i += cmdLen[i];
+                    break;
+
+                case CMD_LONG:
+                    writeWord(out, (CMD_LONG << 14) | (cmdLen[i] - SHORT_MATCH_MIN));
+                    writeWord(out, matchOff[i] - 1);
+                    i += cmdLen[i];
+                    break;
+            }
+        }
+
+        // last byte
+        if ((data.length & 1) != 0)
+            writeWord(out, (data[data.length - 1] & 0xFF) << 8);
+
+        return out.toByteArray();
+    }
+
+    /**
+     * Unpack data using the DLZ algorithm.
+     *
+     * @param data
+     *        data to unpack
+     * @return unpacked data
+     */
+    public static byte[] unpack(byte[] data)
+    {
+        final int size = (readWord(data, 0) << 16) | readWord(data, 2);
+        final int numWord = size / 2;
+        final int[] w = new int[numWord];
+        int ind = 4;
+        int o = 0;
+
+        while (o < numWord)
+        {
+            final int c = readWord(data, ind);
+            ind += 2;
+
+            switch (c >> 14)
+            {
+                case CMD_LITERAL:
+                    for (int n = (c & 0x3FFF) + 1; n > 0; n--)
+                    {
+                        w[o++] = readWord(data, ind);
+                        ind += 2;
+                    }
+                    break;
+
+                case CMD_DELTA:
+                {
+                    final int d = (byte) c;
+                    int p = (o > 0) ? w[o - 1] : 0;
+
+                    for (int n = ((c >> 8) & 0x3F) + 1; n > 0; n--)
+                    {
+                        p = (p + d) & 0xFFFF;
+                        w[o++] = p;
+                    }
+                    break;
+                }
+
+                case CMD_SHORT:
+                {
+                    int r = o - ((c & 0xFF) + 1);
+
+                    for (int n = ((c >> 8) & 0x3F) + SHORT_MATCH_MIN; n > 0; n--)
+                        w[o++] = w[r++];
+                    break;
+                }
+
+                case CMD_LONG:
+                {
+                    int r = o - (readWord(data, ind) + 1);
+                    ind += 2;
+
+                    for (int n = (c & 0x3FFF) + SHORT_MATCH_MIN; n > 0; n--)
+                        w[o++] = w[r++];
+                    break;
+                }
+            }
+        }
+
+        final byte[] result = new byte[size];
+
+        for (int i = 0; i < numWord; i++)
+        {
+            result[(i * 2) + 0] = (byte) (w[i] >> 8);
+            result[(i * 2) + 1] = (byte) w[i];
+        }
+        if ((size & 1) != 0)
+            result[size - 1] = (byte) (readWord(data, ind) >> 8);
+
+        return result;
+    }
+
+    private static int hash(int w0, int w1)
+    {
+        return ((w0 * 31) ^ (w1 * 0x9E37)) & 0xFFFF;
+    }
+
+    private static int readWord(byte[] data, int ind)
+    {
+        return ((data[ind + 0] & 0xFF) << 8) | (data[ind + 1] & 0xFF);
+    }
+
+    private static void writeWord(ByteArrayOutputStream out, int value)
+    {
+        out.write((value >> 8) & 0xFF);
+        out.write(value & 0xFF);
+    }
+
+    private static void writeLong(ByteArrayOutputStream out, int value)
+    {
+        writeWord(out, value >> 16);
+        writeWord(out, value);
+    }
+}
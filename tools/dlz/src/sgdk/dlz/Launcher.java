@@ -0,0 +1,136 @@
+package sgdk.dlz;
+
+import java.io.IOException;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
+import java.util.Arrays;
+
+public class Launcher
+{
+    /**
+     * Launch the application.
+     */
+    public static void main(String[] args)
+    {
+        if (args.length < 2)
+        {
+            showUsage();
+            System.exit(2);
+        }
+
+        final String cmd = args[0].toLowerCase();
+
+        // invalid command
+        if (!cmd.equals("p") && !cmd.equals("u"))
+        {
+            showUsage();
+            System.exit(2);
+        }
+
+        final String inputFile = args[1];
+        final String outputFile;
+        boolean silent;
+
+        if (args.length > 2)
+            outputFile = args[2];
+        else
+        {
+            if (cmd.equals("p"))
+                outputFile = "packed.dat";
+            else
+                outputFile = "unpacked.dat";
+        }
+
+        // assume the fourth argument as silent
+        silent = (args.length > 3);
+
+        if (execute(cmd, inputFile, outputFile, silent))
+            System.exit(0);
+        else
+            System.exit(1);
+    }
+
+    static boolean execute(String cmd, String inputFile, String outputFile, boolean silent)
+    {
+        try
+        {
+            final byte[] data = readBinaryFile(inputFile);
+            byte[] result;
+
+            final long start = System.currentTimeMillis();
+
+            // compress
+            if (cmd.equals("p"))
+            {
+                if (!silent)
+                    System.out.println("Packing " + inputFile + "...");
+
+                result = DLZ.pack(data);
+
+                // get elapsed time
+                final long time = System.currentTimeMillis() - start;
+
+                // verify compression
+                final byte[] unpacked = DLZ.unpack(result);
+
+                if (!silent)
+                {
+                    System.out.println("Initial size " + data.length + " --> packed to " + result.length + " ("
+                            + ((100 * result.length) / Math.max(1, data.length)) + "%) in " + time + " ms");
+                }
+
+                if (!Arrays.equals(data, unpacked))
+                {
+                    System.err.println("Error while verifying compression, result data mismatch input data !");
+                    return false;
+                }
+            }
+            // unpack
+            else
+            {
+                if (!silent)
+                    System.out.println("Unpacking " + inputFile + "...");
+
+                result = DLZ.unpack(data);
+
+                final long time = System.currentTimeMillis() - start;
+                if (!silent)
+                {
+                    System.out.println("Initial size " + data.length + " --> unpacked to " + result.length + " in "
+                            + time + " ms");
+                }
+            }
+
+            writeBinaryFile(result, outputFile);
+        }
+        catch (IOException e)
+        {
+            System.out.println(e);
+            return false;
+        }
+
+        return true;
+    }
+
+    static void showUsage()
+    {
+        System.out.println("DLZ packer v1.00 by Stephane Dallongeville (Copyright 2026)");
+        System.out.println("  Pack:     java -jar dlz.jar p <input_file> <output_file>");
+        System.out.println("  Unpack:   java -jar dlz.jar u <input_file> <output_file>");
+        System.out.println();
+        System.out.println("Tip: using an extra parameter after <output_file> will act as 'silent mode' switch");
+    }
+
+    public static byte[] readBinaryFile(String fileName) throws IOException
+    {
+        Path path = Paths.get(fileName);
+        return Files.readAllBytes(path);
+    }
+
+    public static void writeBinaryFile(byte[] data, String fileName) throws IOException
+    {
+        Path path = Paths.get(fileName);
+        Files.write(path, data);
+    }
+}
@@ -2,7 +2,7 @@ package sgdk.lz4w;
 
 import java.io.ByteArrayOutputStream;
 import java.io.IOException;
-import java.util.ArrayList;
+import java.util.Arrays;
 
 public class LZ4W
 {
@@ -29,6 +29,16 @@ public class LZ4W
     final static int MATCH_OFFSET_MAX = 0x0FF + MATCH_MIN_OFFSET;
     final static int MATCH_LONG_OFFSET_MAX = 0x3FFF + MATCH_LONG_MIN_OFFSET;
 
+    // hash chain match finder: hash table size and maximum number of tested positions (fast / optimal level)
+    final static int HASH_SIZE = 0x10000;
+    final static int FAST_MAX_CHAIN = 16;
+    final static int OPTIMAL_MAX_CHAIN = 1024;
+
+    // parse costs: encoded words first then number of segment (less segments = faster unpacking)
+    final static int WORD_COST = 16;
+    final static int SEGMENT_COST = 1;
+    final static int INFINITE = Integer.MAX_VALUE / 2;
+
     // stats
     static int[] statLiteralSize;
     static int[] statMatchSize;
@@ -51,6 +61,25 @@ public class LZ4W
      *         Cannot be packed using previous data block (try to pack without previous data block)
      */
     public static byte[] pack(byte[] data, int start, boolean silent) throws IOException, IllegalArgumentException
+    {
+        return pack(data, start, silent, false);
+    }
+
+    /**
+     * Pack data using the LZ4W algorithm.
+     *
+     * @param data
+     *        data to pack
+     * @param start
+     *        offset (in byte) where to start packing
+     * @param fast
+     *        fast level: shorter match search and no truncated match tested (faster but lower compression ratio)
+     * @return LZ4W compressed data
+     * @throws IOException
+     * @throws IllegalArgumentException
+     *         Cannot be packed using previous data block (try to pack without previous data block)
+     */
+    public static byte[] pack(byte[] data, int start, boolean silent, boolean fast) throws IOException, IllegalArgumentException
     {
         final DynamicByteArray result = new DynamicByteArray(data.length);
         final DynamicByteArray literal = new DynamicByteArray(1024);
@@ -74,80 +103,38 @@ public class LZ4W
             // adjust offset to word data
             final int offset = start / 2;
 
-            // PASS 1: build the word matches table
-            final WordMatchList[] wordMatches = new WordMatchList[0x10000];
-            for (int i = 0; i < wordMatches.length; i++)
-                wordMatches[i] = new WordMatchList();
-
-            // current offset to start counting word matches
-            int wmOffset = Math.max(offset - MATCH_LONG_OFFSET_MAX, 0);
-            while (wmOffset < wdata.length)
-            {
-                final int off = wmOffset;
-                final short val = wdata[wmOffset++];
-
-                int repeat = 0;
-                while ((wmOffset < wdata.length) && (wdata[wmOffset] == val))
-                {
-                    repeat++;
-                    wmOffset++;
-                }
-
-                // need to unsign val / add new word match
-                wordMatches[val & 0xFFFF].add(new WordMatch(off, repeat));
-            }
-
-            // PASS 2: get best match for each source position using the word matches table
-            final Match[] matches = new Match[wdata.length - offset];
-
-            for (int i = 0; i < matches.length; i++)
-                matches[i] = findBestMatch(wordMatches, wdata, offset + i, start / 2);
-
-            // PASS 3: walk backward in matches and find optimal match length
-            final int costs[] = new int[matches.length + 1];
-
-            // initialize ending cost
-            costs[matches.length] = 0;
-
-            for (int i = matches.length - 1; i >= 0; i--)
-            {
-                // literal cost = next cost + 1
-                final int literalCost = costs[i + 1] + 1;
-                // default match cost
-                int matchCost = Integer.MAX_VALUE;
+            // PASS 1: find longest short and long match for each position (hash chain match finder)
+            final int numWord = wdata.length - offset;
+            final int[] shortLen = new int[numWord];
+            final int[] shortRef = new int[numWord];
+            final int[] longLen = new int[numWord];
+            final int[] longRef = new int[numWord];
 
-                final Match match = matches[i];
+            findMatches(wdata, offset, fast ? FAST_MAX_CHAIN : OPTIMAL_MAX_CHAIN, shortLen, shortRef, longLen, longRef);
 
-                // we have a match ? its cost = current match cost + cost after match sequence
-                if (match != null)
-                    matchCost = match.cost + costs[i + match.length];
+            // PASS 2: optimal parse (minimal encoded size then minimal number of segment)
+            final int[] matchLen = new int[numWord];
+            final int[] matchRef = new int[numWord];
 
-                // literal cost is cheaper than match cost ?
-                if (literalCost < matchCost)
-                {
-                    // change the match to a literal as it is more efficient
-                    costs[i] = literalCost;
-                    matches[i] = null;
-                }
-                else
-                    costs[i] = matchCost;
-            }
+            parse(numWord, shortLen, shortRef, longLen, longRef, fast, matchLen, matchRef);
 
-            // PASS 4: build compressed data from optimal matches
+            // PASS 3: build compressed data from optimal matches
             literal.reset();
             int ind = 0;
             int offAdj = 0;
-            while (ind < matches.length)
+            while (ind < numWord)
             {
-                final Match match = matches[ind];
+                final int matchLength = matchLen[ind];
 
                 // match found ?
-                if (match != null)
+                if (matchLength > 0)
                 {
+                    final int ref = matchRef[ind];
+
                     // add segment
-                    offAdj += addSegment(result, literal, match, offAdj);
+                    offAdj += addSegment(result, literal, new Match(offset + ind, ref, matchLength, ref < offset), offAdj);
                     // adjust index
-                    ind += match.length;
+                    ind += matchLength;
                     // and clear literal data
                     literal.reset();
                 }
@@ -307,187 +294,220 @@ public class LZ4W
         return resultWanted;
     }
 
-    private static Match findBestMatch(WordMatchList[] wordMatches, short[] wdata, int ind, int originStartOffset)
+    private static int hash(short w0, short w1)
     {
-        // nothing we can do
-        if (ind < 1)
-            return null;
-
-        // get word matches for current word
-        final WordMatchList wml = wordMatches[wdata[ind] & 0xFFFF];
-        final int offMin = Math.max(0, ind - MATCH_LONG_OFFSET_MAX);
-
-        // not really useful (only for > 64KB file which rarely happen on Megadrive)
-        // int wmlInd = Collections.binarySearch(wml, new WordMatch(offMin, 0));
-        // if (wmlInd < 0)
-        // wmlInd = (-wmlInd) - 1;
-
-        // find starting index in word match list
-        int wmlInd = 0;
-        while (wmlInd < wml.size())
-        {
-            final WordMatch wm = wml.get(wmlInd);
-
-            // accepted offset ? --> start here
-            if ((wm.offset + wm.repeat) >= offMin)
-                break;
-
-            wmlInd++;
-        }
+        return ((w0 * 31) ^ (w1 * 0x9E37)) & (HASH_SIZE - 1);
+    }
 
-        // get number of repeat for current byte
-        final int curRepeat = getRepeat(wdata, ind);
+    /**
+     * Hash chain match finder: for each position of current data get the longest short match (offset &lt;= 256 and
+     * length &lt;= 16) and the longest long match (previous data block is only accessible through long match).
+     */
+    private static void findMatches(short[] wdata, int offset, int maxChain, int[] shortLen, int[] shortRef, int[] longLen,
+            int[] longRef)
+    {
+        final int[] head = new int[HASH_SIZE];
+        final int[] chain = new int[wdata.length];
 
-        Match best = null;
-        // we want 1 saved word at least
-        int savedWord = 1;
+        Arrays.fill(head, -1);
 
-        // for all accepted word matches
-        while (wmlInd < wml.size())
+        // previous data block is only useful in long match range
+        for (int pos = Math.max(offset - MATCH_LONG_OFFSET_MAX, 0); pos < (wdata.length - 1); pos++)
         {
-            final WordMatch wm = wml.get(wmlInd);
+            final int h = hash(wdata[pos], wdata[pos + 1]);
 
-            int off = wm.offset;
-            int repeat = wm.repeat;
+            // current data ? --> find matches before adding position to chain
+            if (pos >= offset)
+                findMatch(wdata, pos, offset, head[h], chain, maxChain, shortLen, shortRef, longLen, longRef);
 
-            // raised current offset ? --> stop now
-            if (off >= ind)
-                break;
+            chain[pos] = head[h];
+            head[h] = pos;
+        }
+    }
 
-            // need to adjust start ?
-            if (off < offMin)
-            {
-                repeat -= offMin - off;
-                off = offMin;
-            }
+    private static void findMatch(short[] wdata, int pos, int originStart, int first, int[] chain, int maxChain, int[] shortLen,
+            int[] shortRef, int[] longLen, int[] longRef)
+    {
+        final int ind = pos - originStart;
+        final int offMin = pos - MATCH_LONG_OFFSET_MAX;
+        int bestShort = 0;
+        int bestLong = 0;
+        int ref = first;
+        int n = maxChain;
+
+        // chain is ordered from nearest to farthest position so we always prefer shorter offset
+        while ((ref >= 0) && (ref >= offMin) && (n-- > 0))
+        {
+            final boolean rom = ref < originStart;
+            final int rel = pos - ref;
 
-            // can optimize repeat ?
-            if ((off >= originStartOffset) || ((off + repeat) < originStartOffset))
+            // we need to preserve a bit of space for offset adjustment for ROM source
+            if (!rom || (rel <= (MATCH_LONG_OFFSET_MAX - 0x20)))
             {
-                // less repeat on match
-                if (repeat < curRepeat)
+                // ROM source can't go over the previous data block
+                final int maxLen = Math.min(rom ? Math.min(originStart - ref, MATCH_LONG_MAX_SIZE) : MATCH_LONG_MAX_SIZE,
+                        wdata.length - pos);
+                int len = 0;
+
+                while ((len < maxLen) && (wdata[ref + len] == wdata[pos + len]))
+                    len++;
+
+                if (!rom && (rel <= MATCH_OFFSET_MAX) && (Math.min(len, MATCH_MAX_SIZE) > bestShort))
                 {
-                    final Match match = new Match(ind, off, Math.min(MATCH_LONG_MAX_SIZE, repeat + 1),
-                            off < originStartOffset);
-
-                    // we use >= as we always prefer shorter offset
-                    if (match.savedWord >= savedWord)
-                    {
-                        best = match;
-                        savedWord = match.savedWord;
-
-                        // maximum saved ? --> don't continue
-                        if (savedWord == Match.MAX_SAVED_WORD)
-                            return best;
-                    }
+                    bestShort = Math.min(len, MATCH_MAX_SIZE);
+                    shortRef[ind] = ref;
                 }
-                else
+                if (len > bestLong)
                 {
-                    // more repeat on match ?
-                    if (repeat > curRepeat)
-                    {
-                        // bypass extras repeats on match
-                        int delta = repeat - curRepeat;
-                        // fix maximum delta to not raise ind
-                        if ((off + delta) >= ind)
-                            delta = (ind - off) - 1;
-
-                        off += delta;
-                        repeat -= delta;
-                    }
-
-                    Match match;
-
-                    // still some repeat ?
-                    if (repeat > 0)
-                    {
-                        // we raised ind ? --> limit start offset to (ind - 1)
-                        if ((off + repeat) >= ind)
-                            repeat = (ind - off) - 1;
-
-                        // easy optimization (start comparing after repeat)
-                        match = findBestMatchInternal(wdata, off + repeat, ind + repeat, originStartOffset);
-                        // then fix the match
-                        match = new Match(match.curOffset - repeat, match.refOffset - repeat,
-                                Math.min(MATCH_LONG_MAX_SIZE, match.length + repeat),
-                                (match.refOffset - repeat) < originStartOffset);
-                    }
-                    else
-                        match = findBestMatchInternal(wdata, off, ind, originStartOffset);
-
-                    // we use >= as we always prefer short offset
-                    if (match.savedWord >= savedWord)
-                    {
-                        best = match;
-                        savedWord = match.savedWord;
-
-                        // maximum saved ? --> don't continue
-                        if (savedWord == Match.MAX_SAVED_WORD)
-                            return best;
-                    }
+                    bestLong = len;
+                    longRef[ind] = ref;
                 }
+
+                // can't find better ? --> stop here
+                if ((bestLong == MATCH_LONG_MAX_SIZE) && ((bestShort == MATCH_MAX_SIZE) || (rel >= MATCH_OFFSET_MAX)))
+                    break;
             }
-            else
+
+            ref = chain[ref];
+        }
+
+        // match length of 1 can't be encoded (minimum is 2 for short match and 3 for long match)
+        shortLen[ind] = (bestShort > MATCH_MIN_SIZE) ? bestShort : 0;
+        longLen[ind] = (bestLong > MATCH_LONG_MIN_SIZE) ? bestLong : 0;
+    }
+
+    /**
+     * Optimal parse (dynamic programming) using LZ4W segment costs: a segment is 1 word (+ 1 word for long match) and
+     * contains up to 15 literal words followed by a match so we track the number of pending literal words.<br>
+     * Result is stored in <i>matchLen</i> / <i>matchRef</i> (match length = 0 for literal).<br>
+     * Fast mode only tests the longest matches (no truncated matches).
+     */
+    private static void parse(int numWord, int[] shortLen, int[] shortRef, int[] longLen, int[] longRef, boolean fast, int[] matchLen,
+            int[] matchRef)
+    {
+        final int numState = LITERAL_MAX_SIZE + 1;
+        // cost[(pos * numState) + k] = minimal cost to encode words before pos with k pending literal words
+        final int[] cost = new int[(numWord + 1) * numState];
+        // pending literal 1 comes after a full literal segment
+        final boolean[] litOverflow = new boolean[numWord + 1];
+        // match ending at pos (k = 0 state): start position, pending literal at start and reference
+        final int[] from = new int[numWord + 1];
+        final byte[] fromState = new byte[numWord + 1];
+        final int[] fromRef = new int[numWord + 1];
+
+        Arrays.fill(cost, INFINITE);
+        cost[0] = 0;
+
+        for (int pos = 0; pos < numWord; pos++)
+        {
+            final int base = pos * numState;
+            int bestCost = INFINITE;
+            int bestState = 0;
+
+            // literal word
+            for (int k = 0; k < numState; k++)
             {
-                // for each repeated word
-                while ((repeat-- >= 0) && (off < ind))
+                final int c = cost[base + k];
+
+                if (c >= INFINITE)
+                    continue;
+
+                if (c < bestCost)
                 {
-                    final Match match = findBestMatchInternal(wdata, off, ind, originStartOffset);
+                    bestCost = c;
+                    bestState = k;
+                }
+
+                final int nextState;
+                final int nextCost;
 
-                    // we use >= as we always prefer short offset
-                    if (match.savedWord >= savedWord)
-                    {
-                        best = match;
-                        savedWord = match.savedWord;
+                // full literal segment ? --> write it (1 word for segment)
+                if (k == LITERAL_MAX_SIZE)
+                {
+                    nextState = 1;
+                    nextCost = c + WORD_COST + WORD_COST + SEGMENT_COST;
+                }
+                else
+                {
+                    nextState = k + 1;
+                    nextCost = c + WORD_COST;
+                }
 
-                        // maximum saved ? --> don't continue
-                        if (savedWord == Match.MAX_SAVED_WORD)
-                            return best;
-                    }
+                final int next = ((pos + 1) * numState) + nextState;
 
-                    off++;
+                if (nextCost < cost[next])
+                {
+                    cost[next] = nextCost;
+                    if (nextState == 1)
+                        litOverflow[pos + 1] = (k == LITERAL_MAX_SIZE);
                 }
             }
 
-            // next word match
-            wmlInd++;
+            // match segment (pending literal words are part of the segment so cost doesn't depend on state)
+            if (bestCost >= INFINITE)
+                continue;
+
+            final int sl = shortLen[pos];
+            final int ll = longLen[pos];
+
+            for (int len = fast ? sl : (MATCH_MIN_SIZE + 1); (len > 0) && (len <= sl); len++)
+                setMatchCost(cost, from, fromState, fromRef, pos, len, shortRef[pos], bestCost + WORD_COST + SEGMENT_COST, bestState);
+            for (int len = fast ? ll : (MATCH_LONG_MIN_SIZE + 1); (len > 0) && (len <= ll); len++)
+                setMatchCost(cost, from, fromState, fromRef, pos, len, longRef[pos], bestCost + (2 * WORD_COST) + SEGMENT_COST, bestState);
         }
 
-        return best;
-    }
+        // best final state (pending literal words need a last segment)
+        int pos = numWord;
+        int state = 0;
+        int best = INFINITE;
 
-    private static Match findBestMatchInternal(short[] wdata, int from, int ind, int originStart)
-    {
-        final int maxLen;
-        int refOffset;
-        int curOffset;
-        int len;
-
-        // we are referencing ROM data
-        if (from < originStart)
-            maxLen = Math.min(originStart - from, MATCH_LONG_MAX_SIZE);
-        else
-            maxLen = MATCH_LONG_MAX_SIZE;
+        for (int k = 0; k < numState; k++)
+        {
+            final int c = cost[(pos * numState) + k] + ((k > 0) ? (WORD_COST + SEGMENT_COST) : 0);
 
-        // test on simple copy
-        refOffset = from;
-        curOffset = ind;
-        len = 0;
-        while ((curOffset < wdata.length) && (wdata[refOffset++] == wdata[curOffset++]) && (len < maxLen))
-            len++;
+            if (c < best)
+            {
+                best = c;
+                state = k;
+            }
+        }
 
-        return new Match(ind, from, len, from < originStart);
+        // walk back the parse
+        while (pos > 0)
+        {
+            if (state == 0)
+            {
+                final int f = from[pos];
+
+                matchLen[f] = pos - f;
+                matchRef[f] = fromRef[pos];
+                state = fromState[pos];
+                pos = f;
+            }
+            else
+            {
+                if (state > 1)
+                    state--;
+                else
+                    state = litOverflow[pos] ? LITERAL_MAX_SIZE : 0;
+                pos--;
+            }
+        }
     }
 
-    private static int getRepeat(short[] wdata, int ind)
+    private static void setMatchCost(int[] cost, int[] from, byte[] fromState, int[] fromRef, int pos, int len, int ref, int c,
+            int state)
     {
-        final short value = wdata[ind];
+        final int end = pos + len;
+        final int ind = end * (LITERAL_MAX_SIZE + 1);
 
-        int off = ind + 1;
-        while ((off < wdata.length) && (wdata[off] == value))
-            off++;
-
-        return (off - ind) - 1;
+        if (c < cost[ind])
+        {
+            cost[ind] = c;
+            from[end] = pos;
+            fromState[end] = (byte) state;
+            fromRef[end] = ref;
+        }
     }
 
     private static int addSegment(DynamicByteArray result, DynamicByteArray literal, Match match, int offsetDiff)
@@ -753,41 +773,6 @@ public class LZ4W
         }
     }
 
-    @SuppressWarnings("serial")
-    static class WordMatchList extends ArrayList<WordMatch>
-    {
-        WordMatchList()
-        {
-            super();
-        }
-    }
-
-    static class WordMatch implements Comparable<WordMatch>
-    {
-        final int offset;
-        final int repeat;
-
-        public WordMatch(int offset, int repeat)
-        {
-            super();
-
-            this.offset = offset;
-            this.repeat = repeat;
-        }
-
-        @Override
-        public String toString()
-        {
-            return "Off=" + offset + " - Repeat=" + repeat;
-        }
-
-        @Override
-        public int compareTo(WordMatch wm)
-        {
-            return Integer.compare(offset, wm.offset);
-        }
-    }
-
     static class DynamicByteArray extends ByteArrayOutputStream
     {
         public DynamicByteArray()
@@ -22,7 +22,7 @@ public class Launcher
         final String cmd = args[0].toLowerCase();
 
         // invalid command
-        if (!cmd.equals("p") && !cmd.equals("u"))
+        if (!cmd.equals("p") && !cmd.equals("pf") && !cmd.equals("u"))
         {
             showUsage();
             System.exit(2);
@@ -46,7 +46,7 @@ public class Launcher
             outputFile = args[2];
         else
         {
-            if (cmd.equals("p"))
+            if (cmd.startsWith("p"))
                 outputFile = "packed.dat";
             else
                 outputFile = "unpacked.dat";
@@ -77,19 +77,21 @@ public class Launcher
             final long start = System.currentTimeMillis();
 
             // compress
-            if (cmd.equals("p"))
+            if (cmd.startsWith("p"))
             {
+                final boolean fast = cmd.equals("pf");
+
                 if (!silent)
                     System.out.println("Packing " + inputFile + "...");
 
                 try
                 {
-                    result = LZ4W.pack(data, data1.length, silent);
+                    result = LZ4W.pack(data, data1.length, silent, fast);
                 }
                 catch (IllegalArgumentException e1)
                 {
                     // try to pack without previous data block then
-                    result = LZ4W.pack(data2, 0, silent);
+                    result = LZ4W.pack(data2, 0, silent, fast);
                 }
 
                 // get elapsed time
@@ -160,9 +162,10 @@ public class Launcher
 
     static void showUsage()
     {
-        System.out.println("LZ4W packer v1.43 by Stephane Dallongeville (Copyright 2020)");
+        System.out.println("LZ4W packer v1.50 by Stephane Dallongeville (Copyright 2020)");
         System.out.println("  Pack:     java -jar lz4w.jar p <input_file> <output_file>");
         System.out.println("            java -jar lz4w.jar p <prev_file>&<input_file> <output_file>");
+        System.out.println("  Fast:     java -jar lz4w.jar pf <input_file> <output_file> (faster packing, lower ratio)");
         System.out.println("  Unpack:   java -jar lz4w.jar u <input_file> <output_file>");
         System.out.println("            java -jar lz4w.jar u <prev_file>&<input_file> <output_file>");
         System.out.println();
@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define MAX_ENTRY               256
+#define MAX_NAME                64
+#define MAX_LINE                256
+
+
+typedef struct
+{
+    char name[MAX_NAME];
+    unsigned long cycles;
+} Entry;
+
+typedef struct
+{
+    int num;
+    Entry entries[MAX_ENTRY];
+} Result;
+
+
+static int addEntry(Result* result, const char* name, unsigned long cycles)
+{
+    int i;
+
+    // keep last value
+    for(i = 0; i < result->num; i++)
+    {
+        if (!strcmp(result->entries[i].name, name))
+        {
+            result->entries[i].cycles = cycles;
+            return 1;
+        }
+    }
+
+    if (result->num >= MAX_ENTRY) return 0;
+
+    strncpy(result->entries[result->num].name, name, MAX_NAME - 1);
+    result->entries[result->num].name[MAX_NAME - 1] = 0;
+    result->entries[result->num].cycles = cycles;
+    result->num++;
+
+    return 1;
+}
+
+static const Entry* findEntry(const Result* result, const char* name)
+{
+    int i;
+
+    for(i = 0; i < result->num; i++)
+        if (!strcmp(result->entries[i].name, name)) return &result->entries[i];
+
+    return NULL;
+}
+
+// perf ROM log: "#PERF name cycles" lines (KDebug output, can be prefixed by emulator)
+static int loadLog(const char* file, Result* result)
+{
+    char line[MAX_LINE];
+    char name[MAX_NAME];
+    unsigned long cycles;
+    FILE* f;
+    int end;
+
+    f = fopen(file, "rt");
+    if (!f)
+    {
+        printf("Error: can't open '%s'\n", file);
+        return 0;
+    }
+
+    end = 0;
+    result->num = 0;
+    while(fgets(line, sizeof(line), f))
+    {
+        const char* s = strstr(line, "#PERF ");
+
+        if (!s) continue;
+        if (!strncmp(s + 6, "END", 3))
+        {
+            end = 1;
+            continue;
+        }
+        if (sscanf(s + 6, "%63s %lu", name, &cycles) == 2) addEntry(result, name, cycles);
+    }
+    fclose(f);
+
+    if (!result->num)
+    {
+        printf("Error: no perf result found in '%s'\n", file);
+        return 0;
+    }
+    if (!end) printf("Warning: '%s' is incomplete (no #PERF END found)\n", file);
+
+    return 1;
+}
+
+// baseline: "name cycles" lines, '#' starts a comment
+static int loadBaseline(const char* file, Result* result)
+{
+    char line[MAX_LINE];
+    char name[MAX_NAME];
+    unsigned long cycles;
+    FILE* f;
+
+    result->num = 0;
+
+    f = fopen(file, "rt");
+    // no baseline yet
+    if (!f) return 1;
+
+    while(fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%63s %lu", name, &cycles) == 2) addEntry(result, name, cycles);
+    }
+    fclose(f);
+
+    return 1;
+}
+
+static int saveBaseline(const char* file, const Result* result)
+{
+    FILE* f;
+    int i;
+
+    f = fopen(file, "wt");
+    if (!f)
+    {
+        printf("Error: can't write '%s'\n", file);
+        return 0;
+    }
+
+    fprintf(f, "# SGDK routine cycle count baseline (generated by perfcheck -u)\n");
+    for(i = 0; i < result->num; i++)
+        fprintf(f, "%s %lu\n", result->entries[i].name, result->entries[i].cycles);
+    fclose(f);
+
+    return 1;
+}
+
+static int compare(const Result* base, const Result* cur, double threshold)
+{
+    int regressions = 0;
+    int i;
+
+    printf("%-36s %9s %9s  %8s\n", "routine", "base", "new", "delta");
+
+    for(i = 0; i < cur->num; i++)
+    {
+        const Entry* c = &cur->entries[i];
+        const Entry* b = findEntry(base, c->name);
+        double delta;
+        int regression;
+
+        if (!b)
+        {
+            printf("%-36s %9s %9lu  %8s\n", c->name, "-", c->cycles, "new");
+            continue;
+        }
+
+        delta = b->cycles ? ((((double) c->cycles - (double) b->cycles) * 100.0) / (double) b->cycles) : 0;
+        // more cycles = slower
+        regression = (delta > threshold);
+        regressions += regression;
+
+        printf("%-36s %9lu %9lu  %+7.2f%%%s\n", c->name, b->cycles, c->cycles, delta, regression ? "  REGRESSION" : "");
+    }
+
+    for(i = 0; i < base->num; i++)
+        if (!findEntry(cur, base->entries[i].name)) printf("%-36s %9lu %9s  %8s\n", base->entries[i].name, base->entries[i].cycles, "-", "missing");
+
+    return regressions;
+}
+
+int main(int argc, char **argv)
+{
+    Result* base;
+    Result* cur;
+    const char* baseFile = NULL;
+    const char* logFile = NULL;
+    double threshold = 0;
+    int update = 0;
+    int regressions;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-t") && ((i + 1) < argc)) threshold = strtod(argv[++i], NULL);
+        else if (!strcmp(argv[i], "-u")) update = 1;
+        else if (!baseFile) baseFile = argv[i];
+        else logFile = argv[i];
+    }
+
+    if (!logFile)
+    {
+        printf("Perf check v1.00\n");
+        printf("Check SGDK routine cycle counts (sample/perf ROM log) against a baseline\n\n");
+        printf("Usage: perfcheck <baseline> <log> [-t threshold] [-u]\n");
+        printf("  baseline      baseline file ('name cycles' lines)\n");
+        printf("  log           emulator KDebug log of the perf ROM ('#PERF name cycles' lines)\n");
+        printf("  -t threshold  allowed cycles increase in percent (default = 0, cycle accurate emulation is deterministic)\n");
+        printf("  -u            update baseline with log values\n");
+        printf("Returns 2 when a regression is found (for CI usage)\n");
+        return 1;
+    }
+
+    base = malloc(sizeof(Result));
+    cur = malloc(sizeof(Result));
+    if (!base || !cur)
+    {
+        printf("Error: out of memory\n");
+        return 1;
+    }
+
+    if (!loadBaseline(baseFile, base)) return 1;
+    if (!loadLog(logFile, cur)) return 1;
+
+    regressions = compare(base, cur, threshold);
+
+    if (update)
+    {
+        if (!saveBaseline(baseFile, cur)) return 1;
+        printf("\nBaseline '%s' updated\n", baseFile);
+        regressions = 0;
+    }
+
+    free(cur);
+    free(base);
+
+    if (regressions)
+    {
+        printf("\n%d regression(s) above %.1f%%\n", regressions, threshold);
+        return 2;
+    }
+
+    printf("\nNo regression above %.1f%%\n", threshold);
+    return 0;
+}
@@ -12,31 +12,45 @@ import java.nio.file.Files;
 import java.nio.file.Paths;
 import java.util.ArrayList;
 import java.util.Collection;
+import java.util.Arrays;
+import java.util.Collections;
 import java.util.Enumeration;
 import java.util.HashMap;
 import java.util.HashSet;
+import java.util.LinkedHashSet;
 import java.util.List;
 import java.util.Map;
 import java.util.Set;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
 import java.util.jar.JarEntry;
 import java.util.jar.JarFile;
 
 import sgdk.rescomp.processor.AlignProcessor;
+import sgdk.rescomp.processor.BankGroupProcessor;
 import sgdk.rescomp.processor.BinProcessor;
 import sgdk.rescomp.processor.BitmapProcessor;
+import sgdk.rescomp.processor.DirectoryProcessor;
+import sgdk.rescomp.processor.EntitiesProcessor;
 import sgdk.rescomp.processor.ImageProcessor;
 import sgdk.rescomp.processor.MapProcessor;
 import sgdk.rescomp.processor.NearProcessor;
+import sgdk.rescomp.processor.PaletteGroupProcessor;
 import sgdk.rescomp.processor.PaletteProcessor;
 import sgdk.rescomp.processor.SpriteProcessor;
 import sgdk.rescomp.processor.TilemapProcessor;
 import sgdk.rescomp.processor.TilesetProcessor;
 import sgdk.rescomp.processor.UngroupProcessor;
+import sgdk.rescomp.processor.VideoProcessor;
 import sgdk.rescomp.processor.WavProcessor;
 import sgdk.rescomp.processor.XgmProcessor;
 import sgdk.rescomp.resource.Align;
+import sgdk.rescomp.resource.BankGroup;
 import sgdk.rescomp.resource.Bin;
 import sgdk.rescomp.resource.Bitmap;
+import sgdk.rescomp.resource.Directory;
+import sgdk.rescomp.resource.Entities;
 import sgdk.rescomp.resource.Image;
 import sgdk.rescomp.resource.Near;
 import sgdk.rescomp.resource.Palette;
@@ -44,12 +58,23 @@ import sgdk.rescomp.resource.Sprite;
 import sgdk.rescomp.resource.Tilemap;
 import sgdk.rescomp.resource.Tileset;
 import sgdk.rescomp.resource.Ungroup;
+import sgdk.rescomp.resource.Video;
 import sgdk.rescomp.resource.internal.Collision;
 import sgdk.rescomp.resource.internal.SpriteAnimation;
 import sgdk.rescomp.resource.internal.SpriteFrame;
 import sgdk.rescomp.resource.internal.VDPSprite;
+import sgdk.rescomp.tool.BankPlacement;
+import sgdk.rescomp.tool.BankPlacement.Chunk;
+import sgdk.rescomp.tool.BinPacker;
+import sgdk.rescomp.tool.ImageStripReader;
+import sgdk.rescomp.tool.ResCache;
+import sgdk.rescomp.tool.TileOrder;
+import sgdk.rescomp.tool.Util;
+import sgdk.rescomp.tool.VRAMReport;
 import sgdk.rescomp.type.Basics.Compression;
 import sgdk.tool.FileUtil;
+import sgdk.tool.ImageUtil;
+import sgdk.tool.ImageUtil.BasicImageInfo;
 import sgdk.tool.StringUtil;
 
 public class Compiler
@@ -59,6 +84,8 @@ public class Compiler
     // private final static String REGEX_ID = "\\b([A-Za-z][A-Za-z0-9_]*)\\b";
 
     private final static List<Processor> resourceProcessors = new ArrayList<>();
+    // already loaded extension files (server mode compiles several times)
+    private final static Set<String> loadedExtensions = new HashSet<>();
 
     static
     {
@@ -66,14 +93,19 @@ public class Compiler
         resourceProcessors.add(new AlignProcessor());
         resourceProcessors.add(new UngroupProcessor());
         resourceProcessors.add(new NearProcessor());
+        resourceProcessors.add(new DirectoryProcessor());
+        resourceProcessors.add(new BankGroupProcessor());
 
         // resource processors
         resourceProcessors.add(new BinProcessor());
         resourceProcessors.add(new PaletteProcessor());
+        resourceProcessors.add(new PaletteGroupProcessor());
         resourceProcessors.add(new BitmapProcessor());
         resourceProcessors.add(new TilesetProcessor());
         resourceProcessors.add(new TilemapProcessor());
         resourceProcessors.add(new MapProcessor());
+        resourceProcessors.add(new EntitiesProcessor());
+        resourceProcessors.add(new VideoProcessor());
         resourceProcessors.add(new ImageProcessor());
         resourceProcessors.add(new SpriteProcessor());
         resourceProcessors.add(new WavProcessor());
@@ -85,13 +117,45 @@ public class Compiler
     public static String resDir;
 
     // map storing all resources (same object for key and value as we want fast 'contains' check)
-    public static Map<Resource, Resource> resources = new HashMap<>();
+    public static Map<Resource, Resource> resources = Collections.synchronizedMap(new HashMap<>());
     // list to preserve order
     public static List<Resource> resourcesList = new ArrayList<>();
 
+    // number of worker thread used for parallel processing (1 = serial)
+    public static int threads = Runtime.getRuntime().availableProcessors();
+
     // set storing all resource paths
     public static Set<String> resourcesFile = new HashSet<>();
 
+    // resources added (or found) while processing the current resource line (null = no tracking)
+    private static Set<Resource> lineResources = null;
+    // resource --> resource and all its internal resources (used for BANK_GROUP members)
+    private static Map<Resource, Set<Resource>> resourceParts = new HashMap<>();
+
+    // export each resource group in its own output file (see compileSplit(..))
+    public static boolean split = false;
+
+    // reorder sprite frame tilesets export for better LZ4W compression (see TileOrder)
+    public static boolean tileOrder = false;
+
+    // export sprite frames tiles delta against previous animation frame (see SpriteFrame.setTileDelta(..))
+    public static boolean tileDelta = false;
+
+    // reorder BIN export to reduce alignment padding (see BinPacker)
+    public static boolean binPack = false;
+
+    // export precomputed animation steps table (see SpriteAnimation)
+    public static boolean animSteps = false;
+
+    // extract sprite animation tiles common to all frames in a base tileset (see SpriteAnimation)
+    public static boolean baseTiles = false;
+
+    // fast LZ4W packing level (lower compression ratio, for development builds)
+    public static boolean fastPack = false;
+
+    // APLIB ultra packing level (best compression ratio, slower, for release builds)
+    public static boolean ultraPack = false;
+
     public static boolean compile(String fileName, String fileNameOut, boolean header, String depTarget)
     {
         // get application directory
@@ -110,11 +174,6 @@ public class Compiler
             System.err.println("Cannot load extension:" + e.getMessage());
         }
 
-        // reset resources / files lists
-        resources.clear();
-        resourcesList.clear();
-        resourcesFile.clear();
-
         List<String> lines = null;
 
         try
@@ -129,10 +188,43 @@ public class Compiler
             return false;
         }
 
+        VRAMReport.clear();
+
+        final boolean result;
+
+        // one output per resource group ?
+        if (split)
+            result = compileSplit(fileName, lines, fileNameOut, header, depTarget);
+        else
+            result = compile(fileName, lines, fileNameOut, header, depTarget);
+
+        // save VRAM report
+        if (result && !VRAMReport.save())
+            return false;
+
+        return result;
+    }
+
+    private static boolean compile(String fileName, List<String> lines, String fileNameOut, boolean header, String depTarget)
+    {
+        // reset resources / files lists
+        resources.clear();
+        resourcesList.clear();
+        resourcesFile.clear();
+        resourceParts.clear();
+        Util.clearSharedPalettes();
+
+        // decode all images and convert all sounds in parallel first (resources are then processed serially from cache so output doesn't change)
+        prefetchImages(lines);
+        prefetchSounds(lines);
+
         int lineCnt = 1;
         int align = -1;
         boolean group = true;
         boolean near = false;
+        Directory directory = null;
+        BankGroup bankGroup = null;
+        final List<BankGroup> bankGroups = new ArrayList<>();
 
         // process input resource file line by line
         for (String l : lines)
@@ -149,8 +241,11 @@ public class Compiler
             if (line.startsWith("//") || line.startsWith("#"))
                 continue;
 
-            // execute and get resource
+            // execute and get resource (tracking all resources it uses)
+            lineResources = new HashSet<>();
             final Resource resource = execute(line);
+            final Set<Resource> parts = lineResources;
+            lineResources = null;
 
             // can't get resource ? --> error happened, stop here..
             if (resource == null)
@@ -179,10 +274,45 @@ public class Compiler
                 near = true;
                 System.out.println();
             }
+            // DIRECTORY function (not a real resource so handle it specifically)
+            else if (resource instanceof Directory)
+            {
+                // enable asset directory export
+                directory = (Directory) resource;
+                System.out.println();
+            }
+            // BANK_GROUP function (following resources are part of the group)
+            else if (resource instanceof BankGroup)
+            {
+                bankGroup = (BankGroup) resource;
+
+                // add shared resources
+                for (String id : bankGroup.sharedIds)
+                {
+                    final Resource shared = getResourceById(id);
+
+                    if ((shared == null) || !resourceParts.containsKey(shared))
+                    {
+                        System.err.println(fileName + ": BANK_GROUP '" + bankGroup.id + "' references unknown resource '" + id + "' on line " + lineCnt);
+                        return false;
+                    }
+
+                    bankGroup.members.addAll(resourceParts.get(shared));
+                }
+
+                addResource(bankGroup);
+                bankGroups.add(bankGroup);
+                System.out.println();
+            }
             // just store resource
             else
             {
                 addResource(resource);
+                parts.add(resource);
+                resourceParts.put(resource, parts);
+                // part of current bank group
+                if (bankGroup != null)
+                    bankGroup.members.addAll(parts);
                 // show raw size
                 System.out.println(" '" + resource.id + "' raw size: " + resource.totalSize() + " bytes");
                 // show more infos for MAP type resource
@@ -191,6 +321,9 @@ public class Compiler
             }
         }
 
+        // VRAM budget report (split mode: only re-processed groups)
+        VRAMReport.add(split ? FileUtil.getFileName(fileNameOut, true) : fileName, resourcesList);
+
         // separate output
         System.out.println();
 
@@ -270,6 +403,18 @@ public class Compiler
                 binResourcesOfTileset.removeAll(farBinResourcesOfTileset);
                 binResourcesOfBitmap.removeAll(farBinResourcesOfBitmap);
                 binResourcesOfMap.removeAll(farBinResourcesOfMap);
+
+                // reorder sprite frame tilesets so consecutive frames share more data
+                if (tileOrder)
+                {
+                    TileOrder.reset();
+                    TileOrder.reorder(binResourcesOfTileset, getResources(SpriteFrame.class));
+                    TileOrder.reorder(farBinResourcesOfTileset, getResources(SpriteFrame.class));
+
+                    System.out.println("Sprite frame tilesets ordering: " + TileOrder.numFrame + " frames, tiles shared with previous frame "
+                            + TileOrder.sharedBefore + " -> " + TileOrder.sharedAfter);
+                    VRAMReport.addTileOrder(TileOrder.numFrame, TileOrder.sharedBefore, TileOrder.sharedAfter);
+                }
             }
             else
             {
@@ -279,6 +424,9 @@ public class Compiler
                 farBinResourcesOfMap = new ArrayList<>();
             }
 
+            // compress (APLIB / DLZ) all BIN data in parallel, results are cached for the ordered export (LZ4W needs previous data)
+            prefetchPacking(getResources(Bin.class));
+
             // export binary data first !! very important !!
             // otherwise metadata structures can't properly get BIN.doneCompression field value
 
@@ -296,6 +444,12 @@ public class Compiler
             // need to reset binary buffer
             outB.reset();
 
+            BinPacker.reset();
+            // export aligned BIN first to reduce padding
+            if (binPack)
+                exportResources(new ArrayList<Resource>(BinPacker.pack(Arrays.asList(binResourcesOfPalette, binResources, binResourcesOfTilemap,
+                        binResourcesOfTileset, binResourcesOfBitmap, binResourcesOfMap), 0)), outB, outS, outH);
+
             // then export "not far" BIN resources by type for better compression
             exportResources(binResourcesOfPalette, outB, outS, outH);
             exportResources(binResources, outB, outS, outH);
@@ -338,6 +492,50 @@ public class Compiler
                 outB.reset();
             }
 
+            // place FAR BIN data of bank groups in 512 KB aligned chunks (exported first so only first chunk needs padding)
+            if (!near && !bankGroups.isEmpty())
+            {
+                final Set<Resource> allFarBins = new LinkedHashSet<>();
+
+                allFarBins.addAll(farBinResources);
+                allFarBins.addAll(farBinResourcesOfTilemap);
+                allFarBins.addAll(farBinResourcesOfTileset);
+                allFarBins.addAll(farBinResourcesOfBitmap);
+                allFarBins.addAll(farBinResourcesOfMap);
+
+                for (Chunk chunk : BankPlacement.place(bankGroups, allFarBins))
+                {
+                    outS.append("    .balign  " + BankPlacement.BANK_SIZE + "\n\n");
+                    outS.append(chunk.label + ":\n\n");
+                    // need to reset binary buffer
+                    outB.reset();
+
+                    final List<Resource> chunkBins = new ArrayList<>(chunk.bins);
+
+                    // chunk absolute placement is known so we can also avoid DMA boundary crossing
+                    if (binPack)
+                        exportResources(new ArrayList<Resource>(BinPacker.pack(Arrays.asList(chunkBins), BinPacker.DMA_BOUNDARY)), outB, outS, outH);
+                    exportResources(chunkBins, outB, outS, outH);
+
+                    // remove placed BIN from regular export
+                    farBinResources.removeAll(chunk.bins);
+                    farBinResourcesOfTilemap.removeAll(chunk.bins);
+                    farBinResourcesOfTileset.removeAll(chunk.bins);
+                    farBinResourcesOfBitmap.removeAll(chunk.bins);
+                    farBinResourcesOfMap.removeAll(chunk.bins);
+                }
+
+                // need to reset binary buffer
+                outB.reset();
+            }
+            else if (!bankGroups.isEmpty())
+                System.out.println("Warning: BANK_GROUP ignored as NEAR is enabled (all data are in near area)");
+
+            // export aligned "far" BIN first to reduce padding
+            if (binPack)
+                exportResources(new ArrayList<Resource>(BinPacker.pack(Arrays.asList(farBinResources, farBinResourcesOfTilemap, farBinResourcesOfTileset,
+                        farBinResourcesOfBitmap, farBinResourcesOfMap), 0)), outB, outS, outH);
+
             // then export "far" BIN resources by type for better compression
             exportResources(farBinResources, outB, outS, outH);
             // remove already exported ones (just for safety, we already had a tileset bin data = palette bin data)
@@ -374,6 +572,19 @@ public class Compiler
             exportResources(getResources(Image.class), outB, outS, outH);
             exportResources(getResources(Bitmap.class), outB, outS, outH);
             exportResources(getResources(sgdk.rescomp.resource.Map.class), outB, outS, outH);
+            exportResources(getResources(Entities.class), outB, outS, outH);
+            exportResources(getResources(Video.class), outB, outS, outH);
+            exportResources(getResources(BankGroup.class), outB, outS, outH);
+
+            // asset directory of all global resources (exported last as it references them)
+            if (directory != null)
+            {
+                for (Resource res : resourcesList)
+                    if (res.global)
+                        directory.add(res);
+
+                exportResource(directory, outB, outS, outH);
+            }
 
             outH.append("\n");
             outH.append("#endif // _" + headerName + "_H_\n");
@@ -402,6 +613,8 @@ public class Compiler
             System.out.println("-------------");
 
             System.out.println("Binary data: " + (unpackedSize + packedSize) + " bytes");
+            if (binPack)
+                System.out.println("  Alignment padding saved by BIN packing: " + BinPacker.saved + " bytes (estimated)");
             if (unpackedSize > 0)
                 System.out.println("  Unpacked: " + unpackedSize + " bytes");
             if (packedSize > 0)
@@ -440,6 +653,12 @@ public class Compiler
                 miscMetaSize += res.shallowSize();
             for (Resource res : getResources(Palette.class))
                 miscMetaSize += res.shallowSize();
+            for (Resource res : getResources(Entities.class))
+                miscMetaSize += res.shallowSize();
+            for (Resource res : getResources(Video.class))
+                miscMetaSize += res.shallowSize();
+            for (Resource res : getResources(BankGroup.class))
+                miscMetaSize += res.shallowSize();
 
             if (miscMetaSize > 0)
                 System.out.println("Misc metadata (bitmap, image, tilemap, tileset, palette..): " + miscMetaSize + " bytes");
@@ -458,17 +677,14 @@ public class Compiler
 
         try
         {
-            // save .s file
-            out = new BufferedWriter(new FileWriter(fileNameOut));
-            out.write(outS.toString());
-            out.close();
-            // save .h file
+            // save .s file (split mode group files are only rewritten if modified)
+            if (split)
+                writeIfChanged(fileNameOut, outS.toString());
+            else
+                writeFile(fileNameOut, outS.toString());
+            // save .h file (only if modified so sources including it aren't rebuilt)
             if (header)
-            {
-                out = new BufferedWriter(new FileWriter(FileUtil.setExtension(fileNameOut, ".h")));
-                out.write(outH.toString());
-                out.close();
-            }
+                writeIfChanged(FileUtil.setExtension(fileNameOut, ".h"), outH.toString());
             // generate deps file if asked
             if (depTarget != null)
             {
@@ -488,12 +704,377 @@ public class Compiler
         return true;
     }
 
+    /**
+     * Split mode: each resource (with the TILEMAP / MAP resources referencing it) is compiled independently in its own
+     * output file (in a directory named from the output file) so a modified asset only re-processes its group.<br>
+     * Output and header files then just include all group files, group files are only rewritten when modified.<br>
+     * Note that resource deduplication and LZ4W compression can't work across groups.
+     */
+    private static boolean compileSplit(String fileName, List<String> lines, String fileNameOut, boolean header, String depTarget)
+    {
+        final String partDir = FileUtil.setExtension(fileNameOut, "");
+        final String partDirName = FileUtil.getFileName(partDir, false);
+        final String partExt = FileUtil.getFileExtension(fileNameOut, true);
+        // function lines (ALIGN, UNGROUP, NEAR) apply to the whole file so we add them to each group
+        final List<String> functions = new ArrayList<>();
+        final List<SplitGroup> groups = new ArrayList<>();
+        final Map<String, SplitGroup> groupOfId = new HashMap<>();
+
+        for (String l : lines)
+        {
+            final String line = l.trim().replaceAll("\t", " ").replaceAll(" +", " ");
+
+            if (StringUtil.isEmpty(line) || line.startsWith("//") || line.startsWith("#"))
+                continue;
+
+            final String[] fields = splitFields(line);
+            final String type = fields[0].toUpperCase();
+
+            if (type.equals("ALIGN") || type.equals("UNGROUP") || type.equals("NEAR"))
+                functions.add(line);
+            else if (type.equals("DIRECTORY") || type.equals("PALETTE_GROUP") || type.equals("BANK_GROUP"))
+            {
+                System.err.println(fileName + ": " + type + " cannot be used in split mode (-split)");
+                return false;
+            }
+            else if (fields.length < 2)
+            {
+                System.err.println(fileName + ": missing resource name in '" + line + "'");
+                return false;
+            }
+            else
+            {
+                SplitGroup group = null;
+
+                // TILEMAP and MAP can reference a previous TILESET resource --> same group
+                if ((type.equals("TILEMAP") || type.equals("MAP")) && (fields.length > 3))
+                    group = groupOfId.get(fields[3]);
+
+                if (group == null)
+                {
+                    group = new SplitGroup(partDir + "/" + fields[1] + partExt);
+                    groups.add(group);
+                }
+
+                group.lines.add(line);
+                groupOfId.put(fields[1], group);
+            }
+        }
+
+        final List<String> toProcess = new ArrayList<>();
+
+        for (SplitGroup group : groups)
+        {
+            group.lines.addAll(0, functions);
+            group.key = ResCache.getKey("SPLIT", fileName, Boolean.valueOf(header), String.join("\n", group.lines));
+
+            group.upToDate = group.isUpToDate(header);
+            if (!group.upToDate)
+                toProcess.addAll(group.lines);
+        }
+
+        // decode images and convert sounds of all modified groups in parallel
+        prefetchImages(toProcess);
+        prefetchSounds(toProcess);
+
+        final Set<String> allFiles = new HashSet<>();
+        final StringBuilder outS = new StringBuilder(1024);
+        final StringBuilder outH = new StringBuilder(1024);
+
+        for (SplitGroup group : groups)
+        {
+            if (group.upToDate)
+                System.out.println("'" + group.out + "' is up to date");
+            else
+            {
+                // compile the group alone
+                if (!compile(fileName, group.lines, group.out, header, null))
+                    return false;
+
+                group.files.clear();
+                group.files.addAll(resourcesFile);
+                group.saveState();
+
+                System.out.println();
+            }
+
+            allFiles.addAll(group.files);
+
+            final String name = partDirName + "/" + FileUtil.getFileName(group.out, false);
+
+            outS.append("#include \"" + name + partExt + "\"\n");
+            outH.append("#include \"" + name + ".h\"\n");
+        }
+
+        try
+        {
+            // save .s file
+            writeFile(fileNameOut, outS.toString());
+            // save .h file (only if modified so sources including it aren't rebuilt)
+            if (header)
+            {
+                String headerName = FileUtil.getFileName(FileUtil.getDirectory(resDir, false), false);
+                if (StringUtil.isEmpty(headerName))
+                    headerName = "RES";
+                headerName = (headerName + "_" + partDirName).toUpperCase();
+
+                writeIfChanged(FileUtil.setExtension(fileNameOut, ".h"), "#ifndef _" + headerName + "_H_\n" + "#define _" + headerName
+                        + "_H_\n\n" + outH.toString() + "\n#endif // _" + headerName + "_H_\n");
+            }
+            // generate deps file if asked
+            if (depTarget != null)
+            {
+                resourcesFile.clear();
+                resourcesFile.addAll(allFiles);
+                writeFile(FileUtil.setExtension(fileNameOut, ".d"), generateDependency(fileName, depTarget));
+            }
+        }
+        catch (IOException e)
+        {
+            System.err.println("Couldn't create output file:");
+            System.err.println(e.getMessage());
+            return false;
+        }
+
+        return true;
+    }
+
+    static class SplitGroup
+    {
+        // group output file
+        final String out;
+        // group resource lines
+        final List<String> lines;
+        // input files of the group
+        final List<String> files;
+        // key identifying group content (lines, tool version)
+        String key;
+        boolean upToDate;
+
+        SplitGroup(String out)
+        {
+            this.out = out;
+            lines = new ArrayList<>();
+            files = new ArrayList<>();
+        }
+
+        String getStateFile()
+        {
+            return FileUtil.setExtension(out, ".d");
+        }
+
+        // output files exist, group definition didn't change and input files are older than last compilation
+        boolean isUpToDate(boolean header)
+        {
+            final File state = new File(getStateFile());
+
+            if (!state.isFile() || !FileUtil.exists(out) || (header && !FileUtil.exists(FileUtil.setExtension(out, ".h"))))
+                return false;
+
+            try
+            {
+                final List<String> stateLines = Files.readAllLines(state.toPath(), Charset.defaultCharset());
+
+                if (stateLines.isEmpty() || !stateLines.get(0).equals("# " + key))
+                    return false;
+
+                files.clear();
+                for (String line : stateLines)
+                    if (line.startsWith("# file: "))
+                        files.add(line.substring(8));
+
+                for (String file : files)
+                {
+                    final File f = new File(file);
+
+                    if (!f.isFile() || (f.lastModified() > state.lastModified()))
+                        return false;
+                }
+
+                return true;
+            }
+            catch (IOException e)
+            {
+                return false;
+            }
+        }
+
+        // store group key and input files in the group dependency file (also usable by make)
+        void saveState() throws IOException
+        {
+            String result = "# " + key + "\n";
+
+            for (String file : files)
+                result += "# file: " + file + "\n";
+
+            result += getFixedPath(out) + ":";
+            for (String file : files)
+                result += " \\\n" + getFixedPath(file);
+
+            writeFile(getStateFile(), result + "\n");
+        }
+    }
+
+    private static void writeFile(String fileName, String content) throws IOException
+    {
+        FileUtil.ensureParentDirExist(fileName);
+
+        final BufferedWriter out = new BufferedWriter(new FileWriter(fileName));
+        out.write(content);
+        out.close();
+    }
+
+    // write file only if content changed (preserve timestamp for make)
+    private static boolean writeIfChanged(String fileName, String content) throws IOException
+    {
+        final File file = new File(fileName);
+
+        if (file.isFile() && new String(Files.readAllBytes(file.toPath()), Charset.defaultCharset()).equals(content))
+            return false;
+
+        writeFile(fileName, content);
+        return true;
+    }
+
+    private static void runParallel(List<Callable<Object>> tasks)
+    {
+        // nothing to do in parallel
+        if ((threads <= 1) || (tasks.size() <= 1))
+            return;
+
+        final ExecutorService executor = Executors.newFixedThreadPool(Math.min(threads, tasks.size()));
+
+        try
+        {
+            executor.invokeAll(tasks);
+        }
+        catch (InterruptedException e)
+        {
+            // ignore, remaining work will be done serially
+        }
+        finally
+        {
+            executor.shutdownNow();
+        }
+    }
+
+    private static void prefetchImages(List<String> lines)
+    {
+        final Set<String> files = new HashSet<>();
+
+        for (String l : lines)
+        {
+            final String line = l.trim().replaceAll("\t", " ").replaceAll(" +", " ");
+
+            if (StringUtil.isEmpty(line) || line.startsWith("//") || line.startsWith("#"))
+                continue;
+
+            final String[] fields = splitFields(line);
+
+            // file is always the 3rd field
+            if (fields.length > 2)
+            {
+                final String file = FileUtil.adjustPath(resDir, fields[2]);
+                final String ext = FileUtil.getFileExtension(file, false).toLowerCase();
+
+                if ((ext.equals("png") || ext.equals("bmp")) && FileUtil.exists(file))
+                {
+                    try
+                    {
+                        final BasicImageInfo info = ImageUtil.getBasicInfo(file);
+
+                        // huge images aren't cached (decoded by strip when possible)
+                        if (((long) info.w * info.h) < ImageStripReader.STREAMING_MIN_PIXELS)
+                            files.add(file);
+                    }
+                    catch (IOException e)
+                    {
+                        // error will be reported when resource is processed
+                    }
+                }
+            }
+        }
+
+        final List<Callable<Object>> tasks = new ArrayList<>();
+
+        for (String file : files)
+        {
+            tasks.add(() -> {
+                try
+                {
+                    // store in image cache
+                    Util.getImage8bpp(file, false);
+                }
+                catch (Exception e)
+                {
+                    // error will be reported when resource is processed
+                }
+                return null;
+            });
+        }
+
+        runParallel(tasks);
+    }
+
+    private static void prefetchSounds(List<String> lines)
+    {
+        final List<Callable<Object>> tasks = new ArrayList<>();
+
+        for (String l : lines)
+        {
+            final String line = l.trim().replaceAll("\t", " ").replaceAll(" +", " ");
+
+            if (StringUtil.isEmpty(line) || line.startsWith("//") || line.startsWith("#"))
+                continue;
+
+            final String[] fields = splitFields(line);
+
+            if ((fields.length >= 4) && fields[0].equalsIgnoreCase("WAV"))
+            {
+                tasks.add(() -> {
+                    try
+                    {
+                        // store in sound conversion cache
+                        WavProcessor.getData(fields);
+                    }
+                    catch (Exception e)
+                    {
+                        // error will be reported when resource is processed
+                    }
+                    return null;
+                });
+            }
+        }
+
+        runParallel(tasks);
+    }
+
+    private static void prefetchPacking(List<Resource> bins)
+    {
+        final List<Callable<Object>> tasks = new ArrayList<>();
+
+        for (Resource res : bins)
+        {
+            final Bin bin = (Bin) res;
+
+            final boolean auto = (bin.wantedCompression == Compression.AUTO) || (bin.wantedCompression == Compression.AUTO_FAST);
+
+            // APLIB and DLZ results only depend on input data (stored in compression cache)
+            if ((bin.wantedCompression == Compression.APLIB) || auto)
+                tasks.add(() -> Util.appack(bin.data));
+            if ((bin.wantedCompression == Compression.DLZ) || auto)
+                tasks.add(() -> Util.dlzpack(bin.data));
+        }
+
+        runParallel(tasks);
+    }
+
     private static void loadExtensions() throws IOException
     {
         final File rescompExt = StringUtil.isEmpty(resDir) ? new File(EXT_JAR_NAME) : new File(resDir, EXT_JAR_NAME);
 
-        // found an extension ?
-        if (rescompExt.exists())
+        // found an extension (not yet loaded) ?
+        if (rescompExt.exists() && loadedExtensions.add(rescompExt.getAbsolutePath()))
         {
             // build the class loader
             final URLClassLoader classLoader = new URLClassLoader(new URL[] {rescompExt.toURI().toURL()}, Compiler.class.getClassLoader());
@@ -753,7 +1334,7 @@ public class Compiler
         return resources.get(resource);
     }
 
-    public static Resource addResource(Resource resource, boolean internal)
+    public static synchronized Resource addResource(Resource resource, boolean internal)
     {
         // internal resource ?
         if (internal)
@@ -765,6 +1346,8 @@ public class Compiler
             if (result != null)
             {
                 // System.out.println("Duplicated resource found: " + resource.id + " = " + result.id);
+                if (lineResources != null)
+                    lineResources.add(result);
                 return result;
             }
 
@@ -775,6 +1358,8 @@ public class Compiler
         // add resource
         resources.put(resource, resource);
         resourcesList.add(resource);
+        if (lineResources != null)
+            lineResources.add(resource);
 
         return resource;
     }
@@ -801,17 +1386,24 @@ public class Compiler
         return null;
     }
 
+    private static String[] splitFields(String input)
+    {
+        // regex pattern to properly separate quoted string
+        final String pattern = " +(?=(([^\"]*\"){2})*[^\"]*$)";
+        // split on space character and preserve quoted parts
+        final String[] fields = input.split(pattern);
+        // remove quotes
+        for (int f = 0; f < fields.length; f++)
+            fields[f] = fields[f].replaceAll("\"", "");
+
+        return fields;
+    }
+
     private static Resource execute(String input)
     {
         try
         {
-            // regex pattern to properly separate quoted string
-            final String pattern = " +(?=(([^\"]*\"){2})*[^\"]*$)";
-            // split on space character and preserve quoted parts
-            final String[] fields = input.split(pattern);
-            // remove quotes
-            for (int f = 0; f < fields.length; f++)
-                fields[f] = fields[f].replaceAll("\"", "");
+            final String[] fields = splitFields(input);
 
             // get resource type
             final String type = fields[0];
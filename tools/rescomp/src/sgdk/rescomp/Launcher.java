@@ -1,10 +1,92 @@
 package sgdk.rescomp;
 
+import java.io.File;
+import java.util.Arrays;
+
+import sgdk.rescomp.tool.DecodeCost;
+import sgdk.rescomp.tool.ResCache;
+import sgdk.rescomp.tool.VRAMReport;
 import sgdk.tool.FileUtil;
 
 public class Launcher
 {
+    public static final String VERSION = "3.5";
+
     public static void main(String[] args)
+    {
+        // server mode: stay alive and compile requests from clients (see Server)
+        if ((args.length > 0) && args[0].equalsIgnoreCase("-server"))
+        {
+            System.exit(Server.start((args.length > 1) ? getPort(args[1]) : Server.DEFAULT_PORT) ? 0 : -1);
+            return;
+        }
+        // client mode: forward compilation to the server (compile locally if not reachable)
+        if ((args.length > 1) && args[0].equalsIgnoreCase("-client"))
+        {
+            final String[] params = Arrays.copyOfRange(args, 2, args.length);
+            Integer result = Server.request(getPort(args[1]), params);
+
+            if (result == null)
+                result = Integer.valueOf(run(params, null));
+
+            System.exit(result.intValue());
+            return;
+        }
+
+        System.exit(run(args, null));
+    }
+
+    static int getPort(String value)
+    {
+        try
+        {
+            return Integer.parseInt(value);
+        }
+        catch (NumberFormatException e)
+        {
+            System.out.println("Warning: invalid port '" + value + "', using default (" + Server.DEFAULT_PORT + ").");
+            return Server.DEFAULT_PORT;
+        }
+    }
+
+    // resolve path from given base directory (null = current directory)
+    static String resolve(String path, String baseDir)
+    {
+        if ((path == null) || (baseDir == null) || new File(path).isAbsolute())
+            return path;
+
+        return new File(baseDir, path).getPath();
+    }
+
+    // options are static so we need to reset them between server runs
+    static void resetOptions()
+    {
+        Compiler.split = false;
+        Compiler.tileOrder = false;
+        Compiler.tileDelta = false;
+        Compiler.binPack = false;
+        Compiler.animSteps = false;
+        Compiler.baseTiles = false;
+        Compiler.fastPack = false;
+        Compiler.ultraPack = false;
+        Compiler.threads = Runtime.getRuntime().availableProcessors();
+        ResCache.dir = null;
+        VRAMReport.file = null;
+        VRAMReport.maxTile = 0;
+        VRAMReport.maxFrameTile = 0;
+        VRAMReport.maxFrameBytes = 0;
+        VRAMReport.maxFrameSprite = 0;
+        DecodeCost.reset();
+    }
+
+    /**
+     * Parse parameters and compile resources
+     *
+     * @param baseDir
+     *        directory relative paths are resolved from (null = current directory)
+     * @return exit code (0 = success)
+     */
+    public static int run(String[] args, String baseDir)
     {
         // default
         String fileName = null;
@@ -13,6 +95,8 @@ public class Launcher
         boolean header = true;
         boolean dep = false;
 
+        resetOptions();
+
         // parse parameters
         for (int i = 0; i < args.length; i++)
         {
@@ -22,33 +106,94 @@ public class Launcher
                 header = false;
             else if (param.equalsIgnoreCase("-dep"))
                 dep = true;
+            else if (param.equalsIgnoreCase("-split"))
+                Compiler.split = true;
+            else if (param.equalsIgnoreCase("-tileorder"))
+                Compiler.tileOrder = true;
+            else if (param.equalsIgnoreCase("-tiledelta"))
+                Compiler.tileDelta = true;
+            else if (param.equalsIgnoreCase("-binpack"))
+                Compiler.binPack = true;
+            else if (param.equalsIgnoreCase("-animsteps"))
+                Compiler.animSteps = true;
+            else if (param.equalsIgnoreCase("-basetiles"))
+                Compiler.baseTiles = true;
+            else if (param.equalsIgnoreCase("-fastpack"))
+                Compiler.fastPack = true;
+            else if (param.equalsIgnoreCase("-ultrapack"))
+                Compiler.ultraPack = true;
+            else if (param.equalsIgnoreCase("-cache") && ((i + 1) < args.length))
+                ResCache.dir = resolve(args[++i], baseDir);
+            else if (param.equalsIgnoreCase("-report") && ((i + 1) < args.length))
+                VRAMReport.file = resolve(args[++i], baseDir);
+            else if (param.equalsIgnoreCase("-budget") && ((i + 1) < args.length))
+            {
+                if (!VRAMReport.setBudgets(args[++i]))
+                    System.out.println("Warning: invalid budget '" + args[i] + "', expected <name>=<value>[,...] with name = tiles, frametiles, framebytes or sprites.");
+            }
+            else if (param.equalsIgnoreCase("-decodebudget") && ((i + 1) < args.length))
+            {
+                if (!DecodeCost.setBudget(args[++i]))
+                {
+                    System.out.println("Warning: invalid decode budget '" + args[i] + "', expected <cycles per byte>[,<max cycles>], using default.");
+                    DecodeCost.reset();
+                }
+            }
+            else if (param.equalsIgnoreCase("-j") && ((i + 1) < args.length))
+            {
+                try
+                {
+                    Compiler.threads = Math.max(1, Integer.parseInt(args[++i]));
+                }
+                catch (NumberFormatException e)
+                {
+                    System.out.println("Warning: invalid thread number '" + args[i] + "', using default.");
+                }
+            }
             else if (fileName == null)
-                fileName = param;
+                fileName = resolve(param, baseDir);
             else if (fileNameOut == null)
-                fileNameOut = param;
+                fileNameOut = resolve(param, baseDir);
             else if (dep && depTarget == null)
                 depTarget = param;
         }
 
-        System.out.println("ResComp 3.5 - SGDK Resource Compiler - Copyright 2022 (Stephane Dallongeville)");
+        System.out.println("ResComp " + VERSION + " - SGDK Resource Compiler - Copyright 2022 (Stephane Dallongeville)");
 
         if (fileName == null)
         {
             System.out.println("Error: missing the input file.");
             System.out.println();
             System.out.println("Usage:");
-            System.out.println("  rescomp input [output] [-noheader] [-dep <target_file>]");
+            System.out.println("  rescomp input [output] [-noheader] [-dep <target_file>] [-j <n>] [-cache <dir>] [-split] [-report <file>] [-budget <budgets>] [-tileorder] [-tiledelta] [-binpack] [-animsteps] [-basetiles] [-decodebudget <budget>] [-fastpack] [-ultrapack]");
+            System.out.println("  rescomp -server [port]");
+            System.out.println("  rescomp -client <port> <rescomp parameters>");
             System.out.println("    input: the input resource file (.res)");
             System.out.println("    output: the asm output filename (same name is used for the include file)");
             System.out.println("    -noheader: specify that we don't want to generate the header file (.h)");
             System.out.println("    -dep: generate dependencies file (.d) for make (experimental)");
             System.out.println("      <target_file> allow to specify the target filename in the .d file (not the destination of the .d file itself)");
+            System.out.println("    -j: number of worker thread for image decoding and compression (default = number of CPU, 1 = serial)");
+            System.out.println("    -cache: directory of the persistent cache for compression and sprite cutting results (disabled by default)");
+            System.out.println("    -split: compile each resource in its own file (in <output_name>/ directory), only modified ones are processed");
+            System.out.println("    -report: write the VRAM report (VRAM tiles per resource, tiles / DMA bytes / hardware sprites per sprite frame)");
+            System.out.println("    -tileorder: reorder sprite frame tilesets export so consecutive frames share more tiles (better LZ4W compression)");
+            System.out.println("    -tiledelta: export modified tiles against previous frame so sprite engine only uploads them when animation plays in sequence");
+            System.out.println("    -binpack: reorder BIN export to reduce alignment padding (aligned BIN first, gaps filled with small BIN)");
+            System.out.println("    -animsteps: export per animation (frame, duration, next index) table so the sprite engine doesn't resolve loop");
+            System.out.println("    -basetiles: extract tiles common to all frames of a sprite animation so they are uploaded once (not on each frame change)");
+            System.out.println("    -server: stay alive and compile requests from clients on the given local port (default = " + Server.DEFAULT_PORT + ") so JVM start and warm-up are done once");
+            System.out.println("    -client: send the compilation to the rescomp server on the given port (compile locally if the server isn't running)");
+            System.out.println("    -decodebudget: AUTO_FAST compression decode budget as <cycles per byte>[,<max cycles per resource>] (default = 20)");
+            System.out.println("    -fastpack: fast LZ4W packing level (faster compilation but lower compression ratio, for development builds)");
+            System.out.println("    -ultrapack: ultra APLIB packing level (better compression ratio but slower compilation, for release builds)");
+            System.out.println("    -budget: warn when a resource exceeds the given budgets, ex: tiles=512,frametiles=32,framebytes=1024,sprites=8");
             System.out.println("  Ex: rescomp resources.res outres.s");
             System.out.println("  Ex: rescomp resources.res outres.s -noheader -dep");
             System.out.println("  Ex: rescomp resources.res outres.s -dep out/res/gfx.o");
 
             // stop here with error code 1
-            System.exit(1);
+            return 1;
         }
 
         // separate
@@ -62,11 +207,6 @@ public class Launcher
             depTarget = fileNameOut;
 
         // compile resources
-        boolean result = Compiler.compile(fileName, fileNameOut, header, depTarget);
-
-        if (result)
-            System.exit(0);
-        else
-            System.exit(-1);
+        return Compiler.compile(fileName, fileNameOut, header, depTarget) ? 0 : -1;
     }
 }
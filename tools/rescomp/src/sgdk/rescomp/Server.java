@@ -0,0 +1,253 @@
+package sgdk.rescomp;
+
+import java.io.BufferedInputStream;
+import java.io.BufferedOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
+import java.io.File;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.net.InetAddress;
+import java.net.InetSocketAddress;
+import java.net.ServerSocket;
+import java.net.Socket;
+
+/**
+ * Rescomp server mode: a single JVM stays alive and compiles the requests sent by clients (rescomp -client) on a local
+ * port so JVM start, JIT warm-up, extensions loading and in memory caches (WAV conversion..) are done only once.<br>
+ * Requests are processed one at a time (compiler state is static), client output and exit code are forwarded through
+ * the socket.<br>
+ * Request: version (UTF), client current directory (UTF), number of parameter (int) then parameters (UTF).<br>
+ * Answer: frames of type (byte) + data: OUT / ERR = length (int) + bytes, EXIT = exit code (int), REJECT = no data
+ * (client should compile locally).
+ */
+public class Server
+{
+    public final static int DEFAULT_PORT = 7374;
+
+    // parameter to stop the server
+    public final static String SHUTDOWN = "-shutdown";
+
+    final static int CONNECT_TIMEOUT = 1000;
+
+    final static byte FRAME_OUT = 0;
+    final static byte FRAME_ERR = 1;
+    final static byte FRAME_EXIT = 2;
+    final static byte FRAME_REJECT = 3;
+
+    // forward written bytes as frames of given type
+    static class FrameOutputStream extends OutputStream
+    {
+        final DataOutputStream out;
+        final byte type;
+
+        FrameOutputStream(DataOutputStream out, byte type)
+        {
+            super();
+
+            this.out = out;
+            this.type = type;
+        }
+
+        @Override
+        public void write(int b) throws IOException
+        {
+            write(new byte[] {(byte) b}, 0, 1);
+        }
+
+        @Override
+        public void write(byte[] b, int off, int len) throws IOException
+        {
+            synchronized (out)
+            {
+                out.writeByte(type);
+                out.writeInt(len);
+                out.write(b, off, len);
+                out.flush();
+            }
+        }
+    }
+
+    /**
+     * Start the server on given local port (returns when server is stopped)
+     *
+     * @return false if the server couldn't be started
+     */
+    public static boolean start(int port)
+    {
+        final ServerSocket serverSocket;
+
+        try
+        {
+            serverSocket = new ServerSocket(port, 50, InetAddress.getLoopbackAddress());
+        }
+        catch (IOException e)
+        {
+            System.err.println("Couldn't start rescomp server on port " + port + ": " + e.getMessage());
+            return false;
+        }
+
+        System.out.println("ResComp " + Launcher.VERSION + " server listening on port " + port + " (stop it with: rescomp -client " + port + " "
+                + SHUTDOWN + ")");
+
+        try
+        {
+            boolean done = false;
+
+            while (!done)
+            {
+                try (Socket socket = serverSocket.accept())
+                {
+                    done = process(socket);
+                }
+                catch (IOException e)
+                {
+                    System.err.println("Request error: " + e.getMessage());
+                }
+            }
+        }
+        finally
+        {
+            try
+            {
+                serverSocket.close();
+            }
+            catch (IOException e)
+            {
+                // ignore
+            }
+        }
+
+        System.out.println("ResComp server stopped.");
+
+        return true;
+    }
+
+    // process a request, returns true if server should stop
+    static boolean process(Socket socket) throws IOException
+    {
+        final DataInputStream in = new DataInputStream(new BufferedInputStream(socket.getInputStream()));
+        final DataOutputStream out = new DataOutputStream(new BufferedOutputStream(socket.getOutputStream()));
+
+        final String version = in.readUTF();
+        final String dir = in.readUTF();
+        final String[] args = new String[in.readInt()];
+        for (int i = 0; i < args.length; i++)
+            args[i] = in.readUTF();
+
+        // different version --> let the client compile
+        if (!version.equals(Launcher.VERSION))
+        {
+            out.writeByte(FRAME_REJECT);
+            out.flush();
+            return false;
+        }
+
+        if ((args.length == 1) && args[0].equalsIgnoreCase(SHUTDOWN))
+        {
+            out.writeByte(FRAME_EXIT);
+            out.writeInt(0);
+            out.flush();
+            return true;
+        }
+
+        final PrintStream stdOut = System.out;
+        final PrintStream stdErr = System.err;
+        final long start = System.currentTimeMillis();
+        int result;
+
+        // redirect output to client
+        System.setOut(new PrintStream(new BufferedOutputStream(new FrameOutputStream(out, FRAME_OUT)), true));
+        System.setErr(new PrintStream(new BufferedOutputStream(new FrameOutputStream(out, FRAME_ERR)), true));
+
+        try
+        {
+            result = Launcher.run(args, dir);
+        }
+        catch (Throwable t)
+        {
+            t.printStackTrace();
+            result = -1;
+        }
+        finally
+        {
+            System.out.flush();
+            System.err.flush();
+            System.setOut(stdOut);
+            System.setErr(stdErr);
+        }
+
+        System.out.println(String.join(" ", args) + " --> " + ((result == 0) ? "done" : "error") + " (" + (System.currentTimeMillis() - start) + " ms)");
+
+        synchronized (out)
+        {
+            out.writeByte(FRAME_EXIT);
+            out.writeInt(result);
+            out.flush();
+        }
+
+        return false;
+    }
+
+    /**
+     * Send rescomp parameters to the server on given local port and forward its output.
+     *
+     * @return exit code or null if the server isn't reachable (or rejected the request)
+     */
+    public static Integer request(int port, String[] args)
+    {
+        try (Socket socket = new Socket())
+        {
+            socket.connect(new InetSocketAddress(InetAddress.getLoopbackAddress(), port), CONNECT_TIMEOUT);
+
+            final DataOutputStream out = new DataOutputStream(new BufferedOutputStream(socket.getOutputStream()));
+            final DataInputStream in = new DataInputStream(new BufferedInputStream(socket.getInputStream()));
+
+            out.writeUTF(Launcher.VERSION);
+            out.writeUTF(new File("").getAbsolutePath());
+            out.writeInt(args.length);
+            for (String arg : args)
+                out.writeUTF(arg);
+            out.flush();
+
+            while (true)
+            {
+                final byte type;
+
+                try
+                {
+                    type = in.readByte();
+                }
+                catch (EOFException e)
+                {
+                    System.err.println("Rescomp server connection lost.");
+                    return Integer.valueOf(-1);
+                }
+
+                switch (type)
+                {
+                    case FRAME_OUT:
+                    case FRAME_ERR:
+                        final byte[] data = new byte[in.readInt()];
+                        in.readFully(data);
+                        ((type == FRAME_OUT) ? System.out : System.err).write(data);
+                        break;
+
+                    case FRAME_EXIT:
+                        System.out.flush();
+                        return Integer.valueOf(in.readInt());
+
+                    default:
+                        return null;
+                }
+            }
+        }
+        catch (IOException e)
+        {
+            // server not reachable
+            return null;
+        }
+    }
+}
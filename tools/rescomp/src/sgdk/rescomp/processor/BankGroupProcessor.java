@@ -0,0 +1,39 @@
+package sgdk.rescomp.processor;
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+
+import sgdk.rescomp.Processor;
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.BankGroup;
+
+public class BankGroupProcessor implements Processor
+{
+    @Override
+    public String getId()
+    {
+        return "BANK_GROUP";
+    }
+
+    @Override
+    public Resource execute(String[] fields) throws IOException
+    {
+        if (fields.length < 2)
+        {
+            System.out.println("Wrong BANK_GROUP definition");
+            System.out.println("BANK_GROUP name [res1 res2 ...]");
+            System.out.println("  name\tBankGroup variable name, all following resources (until next BANK_GROUP) are part of the group");
+            System.out.println("  res1 res2 ...\tpreviously declared resources also used by the group (shared assets)");
+
+            return null;
+        }
+
+        final List<String> sharedIds = new ArrayList<>();
+        for (int i = 2; i < fields.length; i++)
+            sharedIds.add(fields[i]);
+
+        // build BANK_GROUP resource
+        return new BankGroup(fields[1], sharedIds);
+    }
+}
@@ -34,6 +34,8 @@ public class BinProcessor implements Processor
             System.out.println("                  1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println(
                     "                  2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println(
+                    "                  3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println(
                     "  far           'far' binary data flag to put it at the end of the ROM (useful for bank switch, default = TRUE)");
 
@@ -60,8 +62,8 @@ public class BinProcessor implements Processor
         Compression compression = Compression.NONE;
         if (fields.length >= 7)
             compression = Util.getCompression(fields[6]);
-        if (compression == Compression.AUTO)
-            throw new IllegalArgumentException("Cannot use AUTO compression on BIN resource !");
+        if ((compression == Compression.AUTO) || (compression == Compression.AUTO_FAST))
+            throw new IllegalArgumentException("Cannot use " + compression + " compression on BIN resource !");
         // get far value
         boolean far = true;
         if (fields.length >= 8)
@@ -32,6 +32,7 @@ public class BitmapProcessor implements Processor
             System.out.println("                  0 / NONE        = no compression (default)");
             System.out.println("                  1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                  2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                  3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
 
             return null;
         }
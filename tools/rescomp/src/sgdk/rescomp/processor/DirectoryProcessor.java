@@ -0,0 +1,32 @@
+package sgdk.rescomp.processor;
+
+import java.io.IOException;
+
+import sgdk.rescomp.Processor;
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Directory;
+
+public class DirectoryProcessor implements Processor
+{
+    @Override
+    public String getId()
+    {
+        return "DIRECTORY";
+    }
+
+    @Override
+    public Resource execute(String[] fields) throws IOException
+    {
+        if (fields.length < 2)
+        {
+            System.out.println("Wrong DIRECTORY definition");
+            System.out.println("DIRECTORY name");
+            System.out.println("  name\tAssetDirectory variable name (directory of all resources of the file, see asset_dir.h)");
+
+            return null;
+        }
+
+        // build DIRECTORY resource
+        return new Directory(fields[1]);
+    }
+}
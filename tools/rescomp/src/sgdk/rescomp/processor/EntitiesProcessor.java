@@ -0,0 +1,59 @@
+package sgdk.rescomp.processor;
+
+import java.util.List;
+
+import sgdk.rescomp.Compiler;
+import sgdk.rescomp.Processor;
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Entities;
+import sgdk.rescomp.type.TMX;
+import sgdk.rescomp.type.TMX.TMXObject;
+import sgdk.tool.FileUtil;
+import sgdk.tool.StringUtil;
+
+public class EntitiesProcessor implements Processor
+{
+    @Override
+    public String getId()
+    {
+        return "ENTITIES";
+    }
+
+    @Override
+    public Resource execute(String[] fields) throws Exception
+    {
+        if (fields.length < 4)
+        {
+            System.out.println("Wrong ENTITIES definition");
+            System.out.println("ENTITIES name \"tmx_file\" \"layer_id\" [bucket_size]");
+            System.out.println("  name          EntityTable variable name");
+            System.out.println("  tmx_file      path of the input TMX file (TMX Tiled file)");
+            System.out.println("  layer_id      object layer name we want to extract entities from.");
+            System.out.println("  bucket_size   width (in pixel) of spatial index column, should be a power of 2 (default is 128)");
+
+            return null;
+        }
+
+        // get resource id
+        final String id = fields[1];
+        // get input file
+        final String fileIn = FileUtil.adjustPath(Compiler.resDir, fields[2]);
+        // get layer name
+        final String layerName = fields[3];
+        // get bucket size
+        int bucketSize = 128;
+        if (fields.length >= 5)
+            bucketSize = StringUtil.parseInt(fields[4], bucketSize);
+
+        // add resource file (used for deps generation)
+        Compiler.addResourceFile(fileIn);
+
+        final List<TMXObject> objects = TMX.getObjects(fileIn, layerName);
+        final Entities result = new Entities(id, objects, bucketSize);
+
+        System.out.println(" ENTITIES '" + id + "': " + result.numEntity + " entities, " + result.types.size() + " types, "
+                + result.numBucket + " buckets of " + bucketSize + " pixels");
+
+        return result;
+    }
+}
@@ -27,7 +27,7 @@ public class MapProcessor implements Processor
         if (fields.length < 4)
         {
             System.out.println("Wrong MAP definition");
-            System.out.println("MAP name \"img_file\" tileset_id [compression [mapbase]]");
+            System.out.println("MAP name \"img_file\" tileset_id [compression [mapbase [block_mode]]]");
             System.out.println("  name          Map variable name");
             System.out.println("  img_file      path of the input image file (BMP or PNG image file)");
             System.out.println("  tileset_id    base tileset resource to use (allow to share tileset along several maps)");
@@ -36,11 +36,16 @@ public class MapProcessor implements Processor
             System.out.println("                     0 / NONE        = no compression (default)");
             System.out.println("                     1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                     2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                     3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println("  mapbase       define the base tilemap value, useful to set a default priority, palette and base tile index offset");
             System.out.println(
                     "                    Using a base tile index offset (static tile allocation) allow to use faster MAP decoding function internally.");
+            System.out.println("  block_mode    block encoding, accepted values:");
+            System.out.println("                    NONE  = all blocks are stored as is (default)");
+            System.out.println("                    PATCH = near duplicated blocks are stored as a base block + patch list, blocks are then streamed");
+            System.out.println("                            (unpacked on demand in the map block cache) and stored uncompressed");
             System.out.println();
-            System.out.println("MAP name \"tmx_file\" \"layer_id\" [ts_compression [map_compression [mapbase]]]");
+            System.out.println("MAP name \"tmx_file\" \"layer_id\" [ts_compression [map_compression [mapbase [block_mode]]]]");
             System.out.println("  name              Map variable name");
             System.out.println("  tmx_file          path of the input TMX file (TMX Tiled file)");
             System.out.println("  layer_id          layer name we want to extract map data from.");
@@ -49,8 +54,10 @@ public class MapProcessor implements Processor
             System.out.println("                        0 / NONE        = no compression (default)");
             System.out.println("                        1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                        2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                        3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println("  map_compression   compression type for map (same accepted values then 'ts_compression')");
             System.out.println("  mapbase           define the base tilemap value, useful to set a default priority, palette and base tile index offset");
+            System.out.println("  block_mode        block encoding (same accepted values than image 'block_mode')");
 
             return null;
         }
@@ -79,12 +86,16 @@ public class MapProcessor implements Processor
             int mapBase = 0;
             if (fields.length >= 7)
                 mapBase = StringUtil.parseInt(fields[6], 0);
+            // get block mode
+            int blockMode = Map.BLOCK_MODE_NONE;
+            if (fields.length >= 8)
+                blockMode = getBlockMode(fields[7]);
 
             // build TMX map
             final TMXMap tmxMap = new TMXMap(fileIn, layerName);
             // then build MAP from TMX Map
             return new Map(id, tmxMap.getMapImage(), tmxMap.w * tmxMap.tileSize, tmxMap.h * tmxMap.tileSize, mapBase, 2, tmxMap.getTilesets(id, tileSetCompression),
-                    mapCompression);
+                    mapCompression, tmxMap.getMetatileAttributes(), blockMode);
         }
         else
         // image file
@@ -103,9 +114,23 @@ public class MapProcessor implements Processor
             int mapBase = 0;
             if (fields.length >= 6)
                 mapBase = StringUtil.parseInt(fields[5], 0);
+            // get block mode
+            int blockMode = Map.BLOCK_MODE_NONE;
+            if (fields.length >= 7)
+                blockMode = getBlockMode(fields[6]);
 
             // build MAP from an image
-            return Map.getMap(id, fileIn, mapBase, 2, Util.asList(tileset), compression);
+            return Map.getMap(id, fileIn, mapBase, 2, Util.asList(tileset), compression, blockMode);
         }
     }
+
+    static int getBlockMode(String value)
+    {
+        if (value.equalsIgnoreCase("NONE"))
+            return Map.BLOCK_MODE_NONE;
+        if (value.equalsIgnoreCase("PATCH"))
+            return Map.BLOCK_MODE_PATCH;
+
+        throw new IllegalArgumentException("Unrecognized block mode '" + value + "' (should be NONE or PATCH)");
+    }
 }
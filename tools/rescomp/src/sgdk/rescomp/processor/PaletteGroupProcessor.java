@@ -0,0 +1,79 @@
+package sgdk.rescomp.processor;
+
+import java.util.ArrayList;
+import java.util.List;
+
+import sgdk.rescomp.Compiler;
+import sgdk.rescomp.Processor;
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Palette;
+import sgdk.rescomp.tool.PaletteReducer;
+import sgdk.rescomp.tool.Util;
+import sgdk.tool.FileUtil;
+import sgdk.tool.StringUtil;
+
+public class PaletteGroupProcessor implements Processor
+{
+    @Override
+    public String getId()
+    {
+        return "PALETTE_GROUP";
+    }
+
+    @Override
+    public Resource execute(String[] fields) throws Exception
+    {
+        if (fields.length < 5)
+        {
+            System.out.println("Wrong PALETTE_GROUP definition");
+            System.out.println("PALETTE_GROUP name palettes mode \"file1\" [\"file2\" ...]");
+            System.out.println("  name          Palette variable name (shared palettes)");
+            System.out.println("  palettes      maximum number of 16 colors palette to use (1-4)");
+            System.out.println("  mode          palette assignment, accepted values:");
+            System.out.println("                  TILE  = each tile uses its own palette (IMAGE, TILESET and MAP resources)");
+            System.out.println("                  IMAGE = the whole image uses a single palette (SPRITE resource)");
+            System.out.println("  file          path of the input image files (BMP or PNG image) to remap to the shared palettes");
+
+            return null;
+        }
+
+        // get resource id
+        final String id = fields[1];
+        // get number of palette
+        final int numPalette = StringUtil.parseInt(fields[2], 0);
+        if ((numPalette < 1) || (numPalette > 4))
+        {
+            System.out.println("Invalid number of palette: " + fields[2] + " (should be between 1 and 4)");
+            return null;
+        }
+        // get mode
+        final String mode = fields[3].toUpperCase();
+        if (!mode.equals("TILE") && !mode.equals("IMAGE"))
+        {
+            System.out.println("Unrecognized palette group mode: " + fields[3] + " (should be TILE or IMAGE)");
+            return null;
+        }
+
+        // get input files
+        final List<String> files = new ArrayList<>();
+        for (int i = 4; i < fields.length; i++)
+        {
+            final String fileIn = FileUtil.adjustPath(Compiler.resDir, fields[i]);
+
+            files.add(fileIn);
+            // add resource file (used for deps generation)
+            Compiler.addResourceFile(fileIn);
+        }
+
+        // compute shared palettes
+        final PaletteReducer reducer = new PaletteReducer(files, numPalette, mode.equals("TILE"));
+
+        System.out.println(" PALETTE_GROUP '" + id + "' " + reducer.toString());
+
+        // next resources using these images get remapped pixels and shared palettes
+        for (int i = 0; i < files.size(); i++)
+            Util.setSharedPalette(files.get(i), reducer.images.get(i), reducer.palette);
+
+        return new Palette(id, reducer.palette);
+    }
+}
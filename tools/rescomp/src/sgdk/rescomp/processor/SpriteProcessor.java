@@ -28,7 +28,7 @@ public class SpriteProcessor implements Processor
         if (fields.length < 5)
         {
             System.out.println("Wrong SPRITE definition");
-            System.out.println("SPRITE name \"file\" width heigth [compression [time [collision [opt [iteration]]]]]");
+            System.out.println("SPRITE name \"file\" width heigth [compression [time [collision [opt [iteration [rotation [scale]]]]]]]");
             System.out.println("  name          Sprite variable name");
             System.out.println("  file          the image file to convert to SpriteDefinition structure (BMP or PNG image)");
             System.out.println("  width         width of a single sprite frame in tile");
@@ -38,6 +38,7 @@ public class SpriteProcessor implements Processor
             System.out.println("                  0 / NONE        = no compression (default)");
             System.out.println("                  1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                  2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                  3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println("  time          display frame time in 1/60 of second (time between each animation frame)");
             System.out.println("  collision     collision type: CIRCLE, BOX or NONE (BOX by default)");
             System.out.println("  opt           sprite cutting optimization strategy, accepted values:");
@@ -46,6 +47,9 @@ public class SpriteProcessor implements Processor
             System.out.println("                  2 / TILE      = reduce the number of tiles at the expense of more hardware sprite (using smaller sprite)");
             System.out.println("                  3 / NONE      = no optimization (cover the whole sprite frame)");
             System.out.println("  iteration     number of iteration for sprite cutting optimization (default = 500000)");
+            System.out.println("                or time budget per frame with 'ms' suffix (ex: 200ms), also minimizing hardware sprites per scanline");
+            System.out.println("  rotation      number of pre-rendered rotation steps (ex: 16 = 22.5 degrees step), 0 or 1 = no rotation (default)");
+            System.out.println("  scale         number of pre-rendered scale steps (ex: 4 = 100%, 75%, 50% and 25%), 0 or 1 = no scaling (default)");
 
             return null;
         }
@@ -96,11 +100,37 @@ public class SpriteProcessor implements Processor
         // get max number of iteration
         long iteration = SpriteFrame.DEFAULT_SPRITE_OPTIMIZATION_NUM_ITERATION;
         if (fields.length >= 10)
-            iteration = StringUtil.parseInt(fields[9], SpriteFrame.DEFAULT_SPRITE_OPTIMIZATION_NUM_ITERATION);
+        {
+            final String value = fields[9].trim().toLowerCase();
+
+            // time budget (in ms) ?
+            if (value.endsWith("ms"))
+                iteration = SpriteFrame.getOptimizationTimeBudget(
+                        StringUtil.parseInt(value.substring(0, value.length() - 2).trim(), 0));
+            else
+                iteration = StringUtil.parseInt(fields[9], SpriteFrame.DEFAULT_SPRITE_OPTIMIZATION_NUM_ITERATION);
+        }
+        // get number of rotation step
+        int numRotation = 1;
+        if (fields.length >= 11)
+            numRotation = Math.max(1, StringUtil.parseInt(fields[10], 1));
+        // get number of scale step
+        int numScale = 1;
+        if (fields.length >= 12)
+            numScale = Math.max(1, StringUtil.parseInt(fields[11], 1));
+
+        if ((numRotation > 128) || (numScale > 16))
+        {
+            System.out.println("Wrong SPRITE definition");
+            System.out.println("SPRITE name \"file\" width heigth [compression [time [collision [opt [iteration [rotation [scale]]]]]]]");
+            System.out.println("  rotation should be <= 128 and scale should be <= 16");
+
+            return null;
+        }
 
         // add resource file (used for deps generation)
         Compiler.addResourceFile(fileIn);
         
-        return new Sprite(id, fileIn, wf, hf, compression, time, collision, opt, iteration);
+        return new Sprite(id, fileIn, wf, hf, compression, time, collision, opt, iteration, numRotation, numScale);
     }
 }
@@ -38,6 +38,7 @@ public class TilemapProcessor implements Processor
             System.out.println("                     0 / NONE        = no compression (default)");
             System.out.println("                     1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                     2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                     3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println("  mapopt        define the map optimisation level, accepted values:");
             System.out.println("                     0 / NONE        = no optimisation, each tile is unique");
             System.out.println("                     1 / ALL         = find duplicate and flipped tile (default)");
@@ -53,6 +54,7 @@ public class TilemapProcessor implements Processor
             System.out.println("                        0 / NONE        = no compression (default)");
             System.out.println("                        1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                        2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                        3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println("  map_compression   compression type for map (same accepted values then 'ts_compression')");
             System.out.println("  mapbase           define the base tilemap value, useful to set a default priority, palette and base tile index offset.");
 
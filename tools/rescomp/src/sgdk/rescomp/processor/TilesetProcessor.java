@@ -24,7 +24,7 @@ public class TilesetProcessor implements Processor
         if (fields.length < 3)
         {
             System.out.println("Wrong TILESET definition");
-            System.out.println("TILESET name \"file\" [compression [opt]]");
+            System.out.println("TILESET name \"file\" [compression [opt [ordering]]]");
             System.out.println("  name          Tileset variable name");
             System.out.println("  file          path of the input file (BMP, PNG image file or TSX Tiled file)");
             System.out.println("  compression   compression type, accepted values:");
@@ -32,10 +32,14 @@ public class TilesetProcessor implements Processor
             System.out.println("                  0 / NONE        = no compression (default)");
             System.out.println("                  1 / APLIB       = aplib library (good compression ratio but slow)");
             System.out.println("                  2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast)");
+            System.out.println("                  3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
             System.out.println("  opt           define the optimisation level, accepted values:");
             System.out.println("                  0 / NONE        = no optimisation, each tile is unique (default for TSX file)");
             System.out.println("                  1 / ALL         = ignore duplicated and flipped tile (default for image file)");
             System.out.println("                  2 / DUPLICATE   = ignore duplicated tile only");
+            System.out.println("  ordering      define the tile ordering, accepted values:");
+            System.out.println("                  ROW             = regular 8x8 tiles (default)");
+            System.out.println("                  IM2             = 8x16 tiles for interlaced mode 2 (opt is ignored, image height should be a multiple of 16)");
 
             return null;
         }
@@ -57,10 +61,21 @@ public class TilesetProcessor implements Processor
         // force ALL for TSX format
         if (!tsx && (fields.length >= 5))
             opt = Util.getTileOpt(fields[4]);
+        // get ordering value
+        boolean im2 = false;
+        if (!tsx && (fields.length >= 6))
+        {
+            final String ordering = fields[5].toUpperCase();
+
+            if (ordering.equals("IM2"))
+                im2 = true;
+            else if (!ordering.equals("ROW"))
+                throw new IllegalArgumentException("Unrecognized tile ordering '" + fields[5] + "' (accepted values: ROW, IM2)");
+        }
 
         // add resource file (used for deps generation)
         Compiler.addResourceFile(fileIn);
 
-        return Tileset.getTileset(id, tsx ? TSX.getTSXTilesetPath(fileIn) : fileIn, compression, opt, tsx);
+        return Tileset.getTileset(id, tsx ? TSX.getTSXTilesetPath(fileIn) : fileIn, compression, opt, tsx, im2);
     }
 }
@@ -0,0 +1,101 @@
+package sgdk.rescomp.processor;
+
+import java.io.File;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+
+import sgdk.rescomp.Compiler;
+import sgdk.rescomp.Processor;
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Video;
+import sgdk.rescomp.tool.Util;
+import sgdk.rescomp.type.Basics.Compression;
+import sgdk.tool.FileUtil;
+import sgdk.tool.StringUtil;
+
+public class VideoProcessor implements Processor
+{
+    @Override
+    public String getId()
+    {
+        return "VIDEO";
+    }
+
+    @Override
+    public Resource execute(String[] fields) throws Exception
+    {
+        if (fields.length < 3)
+        {
+            System.out.println("Wrong VIDEO definition");
+            System.out.println("VIDEO name \"frames_dir\" [fps [compression [max_tiles [dict_size [pool_size]]]]]");
+            System.out.println("  name          Video variable name");
+            System.out.println("  frames_dir    path of the directory containing frame images (BMP or PNG, played in file name order)");
+            System.out.println("  fps           frame rate (default is 30)");
+            System.out.println("  compression   frame data compression type, accepted values:");
+            System.out.println("                 -2 / AUTO_FAST  = best compression within decode budget (see -decodebudget option)");
+            System.out.println("                 -1 / BEST / AUTO = use best compression");
+            System.out.println("                  0 / NONE        = no compression");
+            System.out.println("                  1 / APLIB       = aplib library (good compression ratio but slow)");
+            System.out.println("                  2 / FAST / LZ4W = custom lz4 compression (average compression ratio but fast, default)");
+            System.out.println("                  3 / TILE / DLZ  = delta LZ compression (designed for tiles and tilemaps, fast)");
+            System.out.println("  max_tiles     maximum number of new tile per frame, others are delayed to next frames (default is 256, 0 = no limit)");
+            System.out.println("  dict_size     maximum number of recurring tile loaded once at start (default is 128)");
+            System.out.println("  pool_size     number of VRAM tile used for frame tiles (default is automatic)");
+
+            return null;
+        }
+
+        // get resource id
+        final String id = fields[1];
+        // get input directory
+        final String dirIn = FileUtil.adjustPath(Compiler.resDir, fields[2]);
+
+        if (!FileUtil.isDirectory(dirIn))
+            throw new IllegalArgumentException("VIDEO '" + id + "': '" + dirIn + "' isn't a directory");
+
+        int fps = 30;
+        if (fields.length >= 4)
+            fps = StringUtil.parseInt(fields[3], fps);
+        Compression compression = Compression.LZ4W;
+        if (fields.length >= 5)
+            compression = Util.getCompression(fields[4]);
+        int maxTile = 256;
+        if (fields.length >= 6)
+            maxTile = StringUtil.parseInt(fields[5], maxTile);
+        int dictSize = 128;
+        if (fields.length >= 7)
+            dictSize = StringUtil.parseInt(fields[6], dictSize);
+        int poolSize = 0;
+        if (fields.length >= 8)
+            poolSize = StringUtil.parseInt(fields[7], poolSize);
+
+        // frame images in file name order
+        final File[] images = new File(dirIn).listFiles((dir, name) -> {
+            final String ext = FileUtil.getFileExtension(name, false).toLowerCase();
+            return ext.equals("png") || ext.equals("bmp");
+        });
+        if (images == null)
+            throw new IllegalArgumentException("VIDEO '" + id + "': can't read '" + dirIn + "' directory");
+        Arrays.sort(images, (f1, f2) -> f1.getName().compareTo(f2.getName()));
+
+        final List<String> files = new ArrayList<>();
+        for (File image : images)
+        {
+            files.add(image.getPath());
+            // add resource file (used for deps generation)
+            Compiler.addResourceFile(image.getPath());
+        }
+
+        final Video result = new Video(id, files, fps, compression, maxTile, dictSize, poolSize);
+
+        System.out.println(" VIDEO '" + id + "': " + result.numFrame + " frames of " + result.w + "x" + result.h + " tiles at " + fps + " fps, "
+                + result.numColor + " colors, " + result.numUniqueTile + " unique tiles, " + result.numDictTile + " dictionary tiles, "
+                + result.numNewTile + " frame tiles uploaded" + ((result.numDelayedTile > 0) ? " (" + result.numDelayedTile + " delayed)" : "")
+                + ", VRAM tiles=" + (result.numDictTile + result.numPoolTile) + ", frame buffer=" + result.maxFrameSize + " bytes");
+        if (result.numColor > 16)
+            System.out.println("Warning: VIDEO '" + id + "' uses " + result.numColor + " colors, reduced to 16");
+
+        return result;
+    }
+}
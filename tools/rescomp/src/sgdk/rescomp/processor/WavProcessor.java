@@ -8,11 +8,12 @@ import sgdk.rescomp.Compiler;
 import sgdk.rescomp.Processor;
 import sgdk.rescomp.Resource;
 import sgdk.rescomp.resource.Bin;
+import sgdk.rescomp.tool.SoundConverter;
+import sgdk.rescomp.tool.SoundConverter.Quality;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics.Compression;
 import sgdk.rescomp.type.Basics.SoundDriver;
 import sgdk.tool.FileUtil;
-import sgdk.tool.SoundUtil;
 import sgdk.tool.StringUtil;
 
 public class WavProcessor implements Processor
@@ -29,7 +30,7 @@ public class WavProcessor implements Processor
         if (fields.length < 4)
         {
             System.out.println("Wrong WAV definition");
-            System.out.println("WAV name \"file\" driver [out_rate [far]]");
+            System.out.println("WAV name \"file\" driver [out_rate [far [quality]]]");
             System.out.println("  name      variable name");
             System.out.println("  file      path of the .wav file (will be converted to 8 bits signed PCM)");
             System.out.println("  driver    specify the Z80 driver we will use to play the WAV file:");
@@ -50,6 +51,10 @@ public class WavProcessor implements Processor
             System.out.println("              By default the default WAV output rate is used.");
             System.out.println(
                     "  far           'far' binary data flag to put it at the end of the ROM (useful for bank switch, default = TRUE)");
+            System.out.println("  quality   conversion quality, accepted values:");
+            System.out.println("              FAST = basic resampling and DPCM encoding (default)");
+            System.out.println("              GOOD = polyphase resampling and error minimizing DPCM encoding");
+            System.out.println("              BEST = same as GOOD with dithering");
 
             return null;
         }
@@ -59,7 +64,33 @@ public class WavProcessor implements Processor
         // get input file
         final String fileIn = FileUtil.adjustPath(Compiler.resDir, fields[2]);
         // get sound driver
-        SoundDriver driver = Util.getSoundDriver(fields[3]);
+        final SoundDriver driver = Util.getSoundDriver(fields[3]);
+
+        // get far value
+        boolean far = false;
+        if (fields.length >= 6)
+            far = StringUtil.parseBoolean(fields[5], far);
+
+        final byte[] pcmData = getData(fields);
+
+        // add resource file (used for deps generation)
+        Compiler.addResourceFile(fileIn);
+
+        // build BIN resource
+        return new Bin(id, pcmData, (driver == SoundDriver.DPCM2) ? 128 : 256,
+                (driver == SoundDriver.DPCM2) ? 128 : 256, (driver == SoundDriver.DPCM2) ? 136 : 0, Compression.NONE, far);
+    }
+
+    /**
+     * Returns converted sound data for the given WAV resource definition (conversion results are cached so it can be
+     * called in parallel before resources are processed)
+     */
+    public static byte[] getData(String[] fields) throws IOException
+    {
+        // get input file
+        final String fileIn = FileUtil.adjustPath(Compiler.resDir, fields[2]);
+        // get sound driver
+        final SoundDriver driver = Util.getSoundDriver(fields[3]);
 
         int outRate;
 
@@ -88,32 +119,20 @@ public class WavProcessor implements Processor
         if (fields.length >= 5)
             outRate = StringUtil.parseInt(fields[4], outRate);
 
-        // get far value
-        boolean far = false;
-        if (fields.length >= 6)
-            far = StringUtil.parseBoolean(fields[5], far);
-
-        byte[] pcmData;
+        // get quality
+        Quality quality = Quality.FAST;
+        if (fields.length >= 7)
+            quality = SoundConverter.getQuality(fields[6]);
 
         try
         {
-            pcmData = SoundUtil.getRawDataFromWAV(fileIn, 8, outRate, true, true, false);
+            // convert (and compress to DPCM for 2ADPCM driver)
+            return SoundConverter.convert(fileIn, outRate, quality, driver == SoundDriver.DPCM2);
         }
         catch (UnsupportedAudioFileException e)
         {
             System.err.println("Error while converting WAV '" + fileIn + "' to PCM format");
             throw new IOException(e);
         }
-
-        // compress to DPCM
-        if (driver == SoundDriver.DPCM2)
-            pcmData = Util.dpcmPack(pcmData);
-
-        // add resource file (used for deps generation)
-        Compiler.addResourceFile(fileIn);
-
-        // build BIN resource
-        return new Bin(id, pcmData, (driver == SoundDriver.DPCM2) ? 128 : 256,
-                (driver == SoundDriver.DPCM2) ? 128 : 256, (driver == SoundDriver.DPCM2) ? 136 : 0, Compression.NONE, far);
     }
 }
\ No newline at end of file
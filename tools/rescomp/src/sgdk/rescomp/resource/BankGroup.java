@@ -0,0 +1,97 @@
+package sgdk.rescomp.resource;
+
+import java.io.ByteArrayOutputStream;
+import java.util.ArrayList;
+import java.util.LinkedHashSet;
+import java.util.List;
+import java.util.Set;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.Util;
+
+/**
+ * Group of resources used together (typically all assets of a level).<br>
+ * FAR BIN data of group members are placed by BankPlacement so they sit in as few 512 KB banks as possible and the
+ * group is exported as a BankGroup structure (list of used banks) so the runtime can map them all at once (see
+ * SYS_mapBankGroup(..) in mapper.h).
+ */
+public class BankGroup extends Resource
+{
+    // resources referenced by listed resources names (resolved by Compiler)
+    public final List<String> sharedIds;
+    // group members (resources and all their internal resources)
+    public final Set<Resource> members;
+    // labels of banks used by the group (set by BankPlacement)
+    public final List<String> banks;
+
+    final int hc;
+
+    public BankGroup(String id, List<String> sharedIds)
+    {
+        super(id);
+
+        this.sharedIds = new ArrayList<>(sharedIds);
+        members = new LinkedHashSet<>();
+        banks = new ArrayList<>();
+
+        // compute hash code
+        hc = id.hashCode();
+    }
+
+    /**
+     * Returns FAR BIN resources of the group
+     */
+    public List<Bin> getFarBins()
+    {
+        final List<Bin> result = new ArrayList<>();
+
+        for (Resource res : members)
+            if ((res instanceof Bin) && ((Bin) res).far)
+                result.add((Bin) res);
+
+        return result;
+    }
+
+    @Override
+    public int internalHashCode()
+    {
+        return hc;
+    }
+
+    @Override
+    public boolean internalEquals(Object obj)
+    {
+        if (obj instanceof BankGroup)
+            return id.equals(((BankGroup) obj).id);
+
+        return false;
+    }
+
+    @Override
+    public int shallowSize()
+    {
+        return 2 + (banks.size() * 4);
+    }
+
+    @Override
+    public int totalSize()
+    {
+        return shallowSize();
+    }
+
+    @Override
+    public void out(ByteArrayOutputStream outB, StringBuilder outS, StringBuilder outH)
+    {
+        // can't store pointer so we just reset binary stream here (used for compression only)
+        outB.reset();
+
+        // declare
+        Util.decl(outS, outH, "BankGroup", id, 2, global);
+        // number of bank
+        outS.append("    dc.w    " + banks.size() + "\n");
+        // bank start addresses
+        for (String bank : banks)
+            outS.append("    dc.l    " + bank + "\n");
+        outS.append("\n");
+    }
+}
@@ -5,6 +5,7 @@ import java.io.IOException;
 import java.util.Arrays;
 
 import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.DecodeCost;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics.Compression;
 import sgdk.rescomp.type.Basics.PackedData;
@@ -144,6 +145,14 @@ public class Bin extends Resource
                     System.out.print("packed with LZ4W, ");
                     break;
 
+                case DLZ:
+                    System.out.print("packed with DLZ, ");
+                    break;
+
+                case RLE:
+                    System.out.print("packed with RLE, ");
+                    break;
+
                 default:
                     System.out.print("packed with UNKNOW, ");
                     break;
@@ -151,6 +160,15 @@ public class Bin extends Resource
 
             if (doneCompression != Compression.NONE)
                 System.out.println("size = " + packedSize + " (" + Math.round((packedSize * 100f) / baseSize) + "% - origin size = " + baseSize + ")");
+
+            // report decode cost for AUTO_FAST choice
+            if (wantedCompression == Compression.AUTO_FAST)
+            {
+                final long cycles = DecodeCost.getCycles(doneCompression, packedData.data, baseSize);
+
+                System.out.println("    AUTO_FAST: " + doneCompression + " chosen, decode ~" + cycles + " cycles ("
+                        + ((baseSize > 0) ? (cycles / baseSize) : 0) + " cycles per byte)");
+            }
         }
 
         // output binary data (data alignment was done before)
@@ -0,0 +1,217 @@
+package sgdk.rescomp.resource;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.List;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.Util;
+import sgdk.rescomp.type.Basics.Compression;
+import sgdk.tool.StringUtil;
+
+public class Directory extends Resource
+{
+    // asset types (should match ASSET_TYPE_xxx definitions in asset_dir.h)
+    public final static int TYPE_BIN = 0;
+    public final static int TYPE_PALETTE = 1;
+    public final static int TYPE_TILESET = 2;
+    public final static int TYPE_TILEMAP = 3;
+    public final static int TYPE_MAP = 4;
+    public final static int TYPE_IMAGE = 5;
+    public final static int TYPE_BITMAP = 6;
+    public final static int TYPE_SPRITE = 7;
+    public final static int TYPE_OTHER = 255;
+
+    final int hc;
+    final List<Resource> entries;
+
+    public Directory(String id)
+    {
+        super(id);
+
+        entries = new ArrayList<>();
+
+        // compute hash code
+        hc = id.hashCode();
+    }
+
+    /**
+     * FNV-1a hash of resource id (should match ASSETDIR_hash(..) implementation)
+     */
+    public static int hash(String id)
+    {
+        int result = 0x811C9DC5;
+
+        for (int i = 0; i < id.length(); i++)
+        {
+            result ^= id.charAt(i) & 0xFF;
+            result *= 0x01000193;
+        }
+
+        return result;
+    }
+
+    public static int getType(Resource resource)
+    {
+        if (resource instanceof Bin)
+            return TYPE_BIN;
+        if (resource instanceof Palette)
+            return TYPE_PALETTE;
+        if (resource instanceof Tileset)
+            return TYPE_TILESET;
+        if (resource instanceof Tilemap)
+            return TYPE_TILEMAP;
+        if (resource instanceof Map)
+            return TYPE_MAP;
+        if (resource instanceof Image)
+            return TYPE_IMAGE;
+        if (resource instanceof Bitmap)
+            return TYPE_BITMAP;
+        if (resource instanceof Sprite)
+            return TYPE_SPRITE;
+
+        return TYPE_OTHER;
+    }
+
+    /**
+     * Return the main binary data of the resource (used for compression and size informations)
+     */
+    public static Bin getBin(Resource resource)
+    {
+        if (resource instanceof Bin)
+            return (Bin) resource;
+        if (resource instanceof Palette)
+            return ((Palette) resource).bin;
+        if (resource instanceof Tileset)
+            return ((Tileset) resource).bin;
+        if (resource instanceof Tilemap)
+            return ((Tilemap) resource).bin;
+        if (resource instanceof Map)
+            return ((Map) resource).mapBlockIndexesBin;
+        if (resource instanceof Image)
+            return ((Image) resource).tileset.bin;
+        if (resource instanceof Bitmap)
+            return ((Bitmap) resource).bin;
+
+        return null;
+    }
+
+    public void add(Resource resource)
+    {
+        final int h = hash(resource.id);
+
+        // check for hash collision
+        for (Resource res : entries)
+            if (hash(res.id) == h)
+                throw new IllegalArgumentException("DIRECTORY '" + id + "' error: '" + resource.id + "' and '" + res.id + "' have the same hash, rename one of them !");
+
+        entries.add(resource);
+    }
+
+    public int getTableSize()
+    {
+        int result = 1;
+
+        // keep load factor <= 50% so lookup stay close to a single probe
+        while (result < (entries.size() * 2))
+            result <<= 1;
+
+        return result;
+    }
+
+    @Override
+    public int internalHashCode()
+    {
+        return hc;
+    }
+
+    @Override
+    public boolean internalEquals(Object obj)
+    {
+        if (obj instanceof Directory)
+        {
+            final Directory dir = (Directory) obj;
+            return id.equals(dir.id);
+        }
+
+        return false;
+    }
+
+    @Override
+    public int shallowSize()
+    {
+        return 8 + (getTableSize() * 16);
+    }
+
+    @Override
+    public int totalSize()
+    {
+        return shallowSize();
+    }
+
+    @Override
+    public void out(ByteArrayOutputStream outB, StringBuilder outS, StringBuilder outH) throws IOException
+    {
+        // can't store pointer so we just reset binary stream here (used for compression only)
+        outB.reset();
+
+        final int size = getTableSize();
+        final int mask = size - 1;
+        final Resource[] table = new Resource[size];
+
+        // build open addressing hash table (linear probing)
+        for (Resource res : entries)
+        {
+            int slot = hash(res.id) & mask;
+
+            while (table[slot] != null)
+                slot = (slot + 1) & mask;
+
+            table[slot] = res;
+        }
+
+        // asset id definitions
+        outH.append("\n");
+        for (Resource res : entries)
+        {
+            final String name = "ASSETID_" + res.id;
+
+            outH.append("#ifndef " + name + "\n");
+            outH.append("#define " + name + " 0x" + StringUtil.toHexaString(hash(res.id), 8) + "\n");
+            outH.append("#endif\n");
+        }
+
+        // output AssetDirectory structure
+        Util.decl(outS, outH, "AssetDirectory", id, 2, global);
+        // set table mask
+        outS.append("    dc.w    " + mask + "\n");
+        // set number of asset
+        outS.append("    dc.w    " + entries.size() + "\n");
+        // set entries pointer
+        outS.append("    dc.l    " + id + "_entries\n");
+        outS.append("\n");
+
+        // output entries
+        Util.decl(outS, outH, "AssetEntry", id + "_entries", 2, false);
+        for (Resource res : table)
+        {
+            // empty slot
+            if (res == null)
+            {
+                outS.append("    dc.l    0, 0, 0, 0\n");
+                continue;
+            }
+
+            final Bin bin = getBin(res);
+            final int compression = (bin != null) ? (bin.doneCompression.ordinal() - 1) : (Compression.NONE.ordinal() - 1);
+            final int binSize = (bin != null) ? bin.data.length : res.shallowSize();
+
+            // hash, data pointer, unpacked size
+            outS.append("    dc.l    0x" + StringUtil.toHexaString(hash(res.id), 8) + ", " + res.id + ", " + binSize + "\n");
+            // type and compression (no byte data because of GCC bugs with -G parameter), reserved
+            outS.append("    dc.w    " + ((getType(res) << 8) | compression) + ", 0\n");
+        }
+        outS.append("\n");
+    }
+}
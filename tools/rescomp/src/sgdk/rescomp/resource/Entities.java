@@ -0,0 +1,175 @@
+package sgdk.rescomp.resource;
+
+import java.io.ByteArrayOutputStream;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.TreeSet;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.Util;
+import sgdk.rescomp.type.Basics.Compression;
+import sgdk.rescomp.type.TMX.TMXObject;
+import sgdk.tool.StringUtil;
+
+/**
+ * Entity table (EntityTable structure) built from a TMX object layer: entities are sorted by X position and bucketed
+ * by column of <i>bucketSize</i> pixels so the runtime spawner only walks the entities of newly exposed columns.
+ */
+public class Entities extends Resource
+{
+    // entity record size in word (x, y, type, param)
+    final static int ENTITY_SIZE = 4;
+
+    public final int bucketShift;
+    public final int numEntity;
+    public final int numBucket;
+    // object types (type index = position + 1, 0 = no type)
+    public final List<String> types;
+
+    public final Bin entitiesBin;
+    public final Bin bucketsBin;
+
+    final int hc;
+
+    public Entities(String id, List<TMXObject> objects, int bucketSize)
+    {
+        super(id);
+
+        if ((bucketSize < 8) || (Integer.bitCount(bucketSize) != 1))
+            throw new IllegalArgumentException("ENTITIES '" + id + "' bucket size (" + bucketSize + ") should be a power of 2 >= 8");
+
+        bucketShift = Integer.numberOfTrailingZeros(bucketSize);
+
+        // sort on X then Y position (stable so definition order is kept on equal position)
+        final List<TMXObject> sorted = new ArrayList<>(objects);
+        sorted.sort((o1, o2) -> (o1.x != o2.x) ? Integer.compare(o1.x, o2.x) : Integer.compare(o1.y, o2.y));
+
+        // named types (numeric types are used as is)
+        final TreeSet<String> typeSet = new TreeSet<>();
+        for (TMXObject obj : sorted)
+            if (!StringUtil.isEmpty(obj.type) && !isNumeric(obj.type))
+                typeSet.add(obj.type);
+        types = new ArrayList<>(typeSet);
+
+        numEntity = sorted.size();
+        final short[] entities = new short[numEntity * ENTITY_SIZE];
+        int off = 0;
+        int maxX = 0;
+
+        for (TMXObject obj : sorted)
+        {
+            final int x = Math.max(0, Math.min(0xFFFF, obj.x));
+            final int y = Math.max(0, Math.min(0xFFFF, obj.y));
+
+            entities[off++] = (short) x;
+            entities[off++] = (short) y;
+            entities[off++] = (short) getTypeIndex(obj.type);
+            entities[off++] = (short) obj.param;
+
+            maxX = Math.max(maxX, x);
+        }
+
+        // bucket start indexes (numBucket + 1 entries so bucket 'b' entities are in [buckets[b]..buckets[b + 1]])
+        numBucket = (numEntity > 0) ? (maxX >> bucketShift) + 1 : 0;
+        final short[] buckets = new short[numBucket + 1];
+        int ind = 0;
+
+        for (int b = 0; b <= numBucket; b++)
+        {
+            while ((ind < numEntity) && ((entities[ind * ENTITY_SIZE] & 0xFFFF) >> bucketShift) < b)
+                ind++;
+
+            buckets[b] = (short) ind;
+        }
+
+        // entities are read directly so never compressed nor far
+        entitiesBin = (Bin) addInternalResource(new Bin(id + "_entities", entities, Compression.NONE, false));
+        bucketsBin = (Bin) addInternalResource(new Bin(id + "_buckets", buckets, Compression.NONE, false));
+
+        // compute hash code
+        hc = entitiesBin.hashCode() ^ (bucketsBin.hashCode() << 8) ^ bucketShift ^ types.hashCode();
+    }
+
+    static boolean isNumeric(String value)
+    {
+        try
+        {
+            Integer.parseInt(value.trim());
+            return true;
+        }
+        catch (NumberFormatException e)
+        {
+            return false;
+        }
+    }
+
+    int getTypeIndex(String type)
+    {
+        if (StringUtil.isEmpty(type))
+            return 0;
+        if (isNumeric(type))
+            return Integer.parseInt(type.trim());
+
+        return types.indexOf(type) + 1;
+    }
+
+    // type name usable as C identifier
+    static String getTypeName(String type)
+    {
+        return type.toUpperCase().replaceAll("[^A-Z0-9_]", "_");
+    }
+
+    @Override
+    public int internalHashCode()
+    {
+        return hc;
+    }
+
+    @Override
+    public boolean internalEquals(Object obj)
+    {
+        if (obj instanceof Entities)
+        {
+            final Entities entities = (Entities) obj;
+            return (bucketShift == entities.bucketShift) && types.equals(entities.types) && entitiesBin.equals(entities.entitiesBin)
+                    && bucketsBin.equals(entities.bucketsBin);
+        }
+
+        return false;
+    }
+
+    @Override
+    public int shallowSize()
+    {
+        return 2 + 2 + 2 + 4 + 4;
+    }
+
+    @Override
+    public int totalSize()
+    {
+        return entitiesBin.totalSize() + bucketsBin.totalSize() + shallowSize();
+    }
+
+    @Override
+    public void out(ByteArrayOutputStream outB, StringBuilder outS, StringBuilder outH)
+    {
+        // can't store pointer so we just reset binary stream here (used for compression only)
+        outB.reset();
+
+        // entity type defines
+        if (global)
+        {
+            for (int i = 0; i < types.size(); i++)
+                outH.append("#define " + id.toUpperCase() + "_" + getTypeName(types.get(i)) + "    " + (i + 1) + "\n");
+        }
+
+        // declare
+        Util.decl(outS, outH, "EntityTable", id, 2, global);
+        // number of entity, bucket size (shift) and number of bucket
+        outS.append("    dc.w    " + numEntity + ", " + bucketShift + ", " + numBucket + "\n");
+        // set buckets and entities data pointer
+        outS.append("    dc.l    " + bucketsBin.id + "\n");
+        outS.append("    dc.l    " + entitiesBin.id + "\n");
+        outS.append("\n");
+    }
+}
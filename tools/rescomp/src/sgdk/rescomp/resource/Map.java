@@ -7,6 +7,7 @@ import java.util.Arrays;
 import java.util.List;
 
 import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.ImageStripReader;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics.Compression;
 import sgdk.rescomp.type.Basics.TileEquality;
@@ -14,43 +15,44 @@ import sgdk.rescomp.type.Basics.TileOptimization;
 import sgdk.rescomp.type.MapBlock;
 import sgdk.rescomp.type.Metatile;
 import sgdk.rescomp.type.Tile;
-import sgdk.tool.ImageUtil;
-import sgdk.tool.ImageUtil.BasicImageInfo;
 
 public class Map extends Resource
 {
+    // block encoding: all blocks stored as is / near duplicated blocks stored as base block + patch list (streamed)
+    public static final int BLOCK_MODE_NONE = 0;
+    public static final int BLOCK_MODE_PATCH = 1;
+
+    // MapDefinition.compression flags (see map.h)
+    static final int MAP_BLOCKS_STREAM = 0x1000;
+    static final int MAP_BLOCKS_PATCH = 0x2000;
+
     public static Map getMap(String id, String imgFile, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression) throws Exception
     {
-        // get 8bpp pixels and also check image dimension is aligned to tile
-        final byte[] image = Util.getImage8bpp(imgFile, true);
-
-        // happen when we couldn't retrieve palette data from RGB image
-        if (image == null)
-            throw new IllegalArgumentException(
-                    "RGB image '" + imgFile + "' does not contains palette data (see 'Important note about image format' in the rescomp.txt file");
+        return getMap(id, imgFile, mapBase, metatileSize, tilesets, compression, BLOCK_MODE_NONE);
+    }
 
-        // b0-b3 = pixel data; b4-b5 = palette index; b7 = priority bit
-        // check if image try to use bit 6 (probably mean that we have too much colors in our image)
-        for (byte d : image)
+    public static Map getMap(String id, String imgFile, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression, int blockMode)
+            throws Exception
+    {
+        // get 8bpp pixels by strip (huge image are decoded on the fly) and also check image dimension is aligned to tile
+        try (ImageStripReader image = ImageStripReader.open(imgFile, true))
         {
-            // bit 6 used ?
-            if ((d & 0x40) != 0)
+            // happen when we couldn't retrieve palette data from RGB image
+            if (image == null)
                 throw new IllegalArgumentException(
-                        "'" + imgFile + "' has color index in [64..127] range, IMAGE resource requires image with a maximum of 64 colors");
-        }
+                        "RGB image '" + imgFile + "' does not contains palette data (see 'Important note about image format' in the rescomp.txt file");
 
-        // retrieve basic infos about the image
-        final BasicImageInfo imgInfo = ImageUtil.getBasicInfo(imgFile);
-        final int w = imgInfo.w;
-        // we determine 'h' from data length and 'w' as we can crop image vertically to remove palette data
-        final int h = image.length / w;
+            // check color index range (bit 6) on each strip
+            image.checkColorIndexFile = imgFile;
 
-        return new Map(id, image, w, h, mapBase, metatileSize, tilesets, compression);
+            return new Map(id, image, mapBase, metatileSize, tilesets, compression, null, blockMode);
+        }
     }
 
     public final int wb;
     public final int hb;
     public final Compression compression;
+    public final int blockMode;
     final int hc;
 
     public final List<Metatile> metatiles;
@@ -58,6 +60,11 @@ public class Map extends Resource
     public final List<short[]> mapBlockIndexes;
     public final short[] mapBlockRowOffsets;
     public final List<Tileset> tilesets;
+    // metatile attribute table (indexed by metatile index, null if not defined)
+    public final byte[] metatileAttributes;
+    // offset of each block data in mapBlocksBin (BLOCK_MODE_PATCH only)
+    public final int[] blockOffsets;
+    public int numPatchedBlock;
 
     // binary data
     public final Bin metatilesBin;
@@ -67,12 +74,36 @@ public class Map extends Resource
 
     public Map(String id, byte[] image8bpp, int imageWidth, int imageHeight, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression)
             throws IOException, IllegalArgumentException
+    {
+        this(id, new ImageStripReader(image8bpp, imageWidth, imageHeight), mapBase, metatileSize, tilesets, compression, null, BLOCK_MODE_NONE);
+    }
+
+    public Map(String id, byte[] image8bpp, int imageWidth, int imageHeight, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression,
+            int[] attributes, int blockMode) throws IOException, IllegalArgumentException
+    {
+        this(id, new ImageStripReader(image8bpp, imageWidth, imageHeight), mapBase, metatileSize, tilesets, compression, attributes, blockMode);
+    }
+
+    public Map(String id, ImageStripReader image, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression)
+            throws IOException, IllegalArgumentException
+    {
+        this(id, image, mapBase, metatileSize, tilesets, compression, null, BLOCK_MODE_NONE);
+    }
+
+    // build map reading image by strip of 1 block height (128 pixels) so huge image doesn't need to be fully decoded.
+    // 'attributes' gives the attribute of each metatile position (null if none), it becomes part of metatile identity
+    // so the attribute table can be indexed by metatile index at runtime (see MAP_setMetaTileAttributes(..))
+    public Map(String id, ImageStripReader image, int mapBase, int metatileSize, List<Tileset> tilesets, Compression compression, int[] attributes,
+            int blockMode) throws IOException, IllegalArgumentException
     {
         super(id);
 
         // get size in tile
-        final int wt = imageWidth / 8;
-        final int ht = imageHeight / 8;
+        final int wt = image.w / 8;
+        final int ht = image.h / 8;
+        // get size in metatile
+        final int wm = (wt + 1) / 2;
+        final int hm = (ht + 1) / 2;
 
         // base prio, pal attributes and base tile index offset
         final boolean mapBasePrio = (mapBase & Tile.TILE_PRIORITY_MASK) != 0;
@@ -90,6 +121,7 @@ public class Map extends Resource
 
         // store compression
         this.compression = compression;
+        this.blockMode = blockMode;
 
         // get size in block
         wb = (wt + 15) / 16;
@@ -111,6 +143,8 @@ public class Map extends Resource
         // important to always use the same loop order when building Tileset and Tilemap object
         for (int j = 0; j < hb; j++)
         {
+            // get image strip for this block row
+            final byte[] strip = image.read(16 * 8);
             int mbrii = 0;
             final short[] mbRowIndexes = new short[wb];
 
@@ -147,7 +181,7 @@ public class Map extends Resource
                                 }
                                 else
                                 {
-                                    tile = Tile.getTile(image8bpp, wt * 8, ht * 8, ti * 8, tj * 8, 8);
+                                    tile = Tile.getTile(strip, image.w, 16 * 8, ti * 8, (tj - (j * 16)) * 8, 8);
 
                                     // we can use system tiles when we have a base tile offset
                                     if (hasBaseTileIndex && tile.isPlain())
@@ -178,6 +212,16 @@ public class Map extends Resource
                             }
                         }
 
+                        // set metatile attribute
+                        if (attributes != null)
+                        {
+                            final int mx = (i * 8) + bi;
+                            final int my = (j * 8) + bj;
+
+                            if ((mx < wm) && (my < hm))
+                                mt.attr = attributes[(my * wm) + mx];
+                        }
+
                         // update internals (hash code)
                         mt.updateInternals();
 
@@ -247,11 +291,26 @@ public class Map extends Resource
                 mtData[offset++] = attr;
         }
 
+        // build metatile attribute table
+        if (attributes != null)
+        {
+            metatileAttributes = new byte[metatiles.size()];
+            for (int i = 0; i < metatiles.size(); i++)
+                metatileAttributes[i] = (byte) metatiles.get(i).attr;
+        }
+        else
+            metatileAttributes = null;
+
         // build BIN (metatiles data)
         metatilesBin = (Bin) addInternalResource(new Bin(id + "_metatiles", mtData, compression));
 
-        // convert mapBlocks to array
-        if (metatiles.size() > 256)
+        // convert mapBlocks to base block + patch list records (stored uncompressed as they are unpacked individually)
+        if (blockMode == BLOCK_MODE_PATCH)
+        {
+            blockOffsets = new int[mapBlocks.size()];
+            mapBlocksBin = (Bin) addInternalResource(new Bin(id + "_mapBlocks", getPatchedBlocksData(metatiles.size() > 256), Compression.NONE));
+        }
+        else if (metatiles.size() > 256)
         {
             // require 16 bit index
             final short[] mbData = new short[mapBlocks.size() * (8 * 8)];
@@ -264,6 +323,7 @@ public class Map extends Resource
 
             // build BIN (mapBlocks data)
             mapBlocksBin = (Bin) addInternalResource(new Bin(id + "_mapBlocks", mbData, compression));
+            blockOffsets = null;
         }
         else
         {
@@ -278,6 +338,7 @@ public class Map extends Resource
 
             // build BIN (mapBlocks data)
             mapBlocksBin = (Bin) addInternalResource(new Bin(id + "_mapBlocks", mbData, compression));
+            blockOffsets = null;
         }
 
         // require 16 bit index ? --> directly use mapBlockIndexes map
@@ -323,6 +384,9 @@ public class Map extends Resource
                 // add metatiles definition RAW size
                 ts += metatiles.size() * 4 * 2;
             }
+            // patched blocks are unpacked on demand in the block cache
+            if (blockMode == BLOCK_MODE_PATCH)
+                ts -= mapBlocksBin.totalSize();
 
             // above 48 KB ? --> error
             if (ts > (48 * 1024))
@@ -338,6 +402,91 @@ public class Map extends Resource
         hc = tileset.hashCode() ^ metatilesBin.hashCode() ^ mapBlocksBin.hashCode() ^ mapBlockIndexesBin.hashCode() ^ mapBlockRowOffsetsBin.hashCode();
     }
 
+    private static void putShort(ByteArrayOutputStream out, int value)
+    {
+        out.write((value >> 8) & 0xFF);
+        out.write(value & 0xFF);
+    }
+
+    // build block records: 0xFFFF + full block or base block index + patch list (see MAP_BLOCKS_PATCH in map.h)
+    private byte[] getPatchedBlocksData(boolean wide)
+    {
+        final ByteArrayOutputStream result = new ByteArrayOutputStream();
+        final int fullSize = 2 + ((wide ? 2 : 1) * 8 * 8);
+        final int patchEntrySize = wide ? 4 : 2;
+        // full blocks (usable as base block)
+        final List<Integer> bases = new ArrayList<>();
+
+        numPatchedBlock = 0;
+
+        for (int b = 0; b < mapBlocks.size(); b++)
+        {
+            final short[] data = mapBlocks.get(b).data;
+            int best = -1;
+            int bestDiff = Integer.MAX_VALUE;
+
+            // find the closest base block
+            for (Integer base : bases)
+            {
+                final short[] baseData = mapBlocks.get(base.intValue()).data;
+                int diff = 0;
+
+                for (int i = 0; (i < data.length) && (diff < bestDiff); i++)
+                    if (data[i] != baseData[i])
+                        diff++;
+
+                if (diff < bestDiff)
+                {
+                    best = base.intValue();
+                    bestDiff = diff;
+                }
+            }
+
+            blockOffsets[b] = result.size();
+
+            // patch is worth it only if it takes less than half of a full block
+            if ((best != -1) && ((4 + (bestDiff * patchEntrySize)) <= (fullSize / 2)))
+            {
+                final short[] baseData = mapBlocks.get(best).data;
+
+                putShort(result, best);
+                putShort(result, bestDiff);
+
+                for (int i = 0; i < data.length; i++)
+                {
+                    if (data[i] != baseData[i])
+                    {
+                        if (wide)
+                        {
+                            putShort(result, i);
+                            putShort(result, data[i]);
+                        }
+                        else
+                            putShort(result, (i << 8) | (data[i] & 0xFF));
+                    }
+                }
+
+                numPatchedBlock++;
+            }
+            else
+            {
+                putShort(result, 0xFFFF);
+
+                for (short ind : data)
+                {
+                    if (wide)
+                        putShort(result, ind);
+                    else
+                        result.write(ind & 0xFF);
+                }
+
+                bases.add(Integer.valueOf(b));
+            }
+        }
+
+        return result.toByteArray();
+    }
+
     public int getMetaTileIndex(Metatile metatile)
     {
         for (int ind = 0; ind < metatiles.size(); ind++)
@@ -384,6 +533,9 @@ public class Map extends Resource
         result <<= 4;
         result += (metatilesBin.packedData.compression.ordinal() - 1);
 
+        if (blockMode == BLOCK_MODE_PATCH)
+            result |= MAP_BLOCKS_STREAM | MAP_BLOCKS_PATCH;
+
         return result;
     }
 
@@ -399,8 +551,8 @@ public class Map extends Resource
         if (obj instanceof Map)
         {
             final Map map = (Map) obj;
-            return metatiles.equals(map.metatiles) && mapBlocks.equals(map.mapBlocks) && mapBlockIndexesBin.equals(map.mapBlockIndexesBin)
-                    && Arrays.equals(mapBlockRowOffsets, map.mapBlockRowOffsets);
+            return (blockMode == map.blockMode) && metatiles.equals(map.metatiles) && mapBlocks.equals(map.mapBlocks) && mapBlockIndexesBin.equals(map.mapBlockIndexesBin)
+                    && Arrays.equals(mapBlockRowOffsets, map.mapBlockRowOffsets) && Arrays.equals(metatileAttributes, map.metatileAttributes);
         }
 
         return false;
@@ -417,6 +569,12 @@ public class Map extends Resource
     {
         int result = metatilesBin.totalSize() + mapBlocksBin.totalSize() + mapBlockIndexesBin.totalSize() + mapBlockRowOffsetsBin.totalSize() + shallowSize();
 
+        if (metatileAttributes != null)
+            result += (metatileAttributes.length + 1) & ~1;
+        // block pointer table
+        if (blockOffsets != null)
+            result += blockOffsets.length * 4;
+
         return result;
     }
 
@@ -426,6 +584,16 @@ public class Map extends Resource
         // can't store pointer so we just reset binary stream here (used for compression only)
         outB.reset();
 
+        // block pointer table for patched blocks
+        if (blockOffsets != null)
+        {
+            outS.append("    .align 2\n");
+            outS.append(id + "_blockTable:\n");
+            for (int offset : blockOffsets)
+                outS.append("    dc.l    " + mapBlocksBin.id + " + " + offset + "\n");
+            outS.append("\n");
+        }
+
         // output Image structure
         Util.decl(outS, outH, "MapDefinition", id, 2, global);
         // set size in block
@@ -440,13 +608,21 @@ public class Map extends Resource
         outS.append("    dc.w    " + mapBlocks.size() + "\n");
         // set metatile data pointer
         outS.append("    dc.l    " + metatilesBin.id + "\n");
-        // set mapblock data pointer
-        outS.append("    dc.l    " + mapBlocksBin.id + "\n");
+        // set mapblock data (or block pointer table) pointer
+        outS.append("    dc.l    " + ((blockOffsets != null) ? (id + "_blockTable") : mapBlocksBin.id) + "\n");
         // set mapBlockIndexes data pointer
         outS.append("    dc.l    " + mapBlockIndexesBin.id + "\n");
         // set mapBlockRowOffsets data pointer
         outS.append("    dc.l    " + mapBlockRowOffsetsBin.id + "\n");
         outS.append("\n");
+
+        // metatile attribute table (to use with MAP_setMetaTileAttributes(..))
+        if (metatileAttributes != null)
+        {
+            Util.declArray(outS, outH, "u8", id + "_attributes", metatileAttributes.length, 2, global);
+            Util.outS(outS, metatileAttributes, 1);
+            outS.append("\n");
+        }
     }
 
     @Override
@@ -454,6 +630,8 @@ public class Map extends Resource
     {
         // display info about map encoding
         return "MAP '" + id + "' details: " + tilesets.size() + " tilesets, " + metatiles.size() + " metatiles, " + mapBlocks.size()
-                + " blocks, block grid size = " + wb + " x " + hb + " - optimized = " + wb + " x " + mapBlockIndexes.size();
+                + " blocks, block grid size = " + wb + " x " + hb + " - optimized = " + wb + " x " + mapBlockIndexes.size()
+                + ((metatileAttributes != null) ? " - with metatile attributes" : "")
+                + ((blockOffsets != null) ? " - patched blocks = " + numPatchedBlock + " / " + mapBlocks.size() : "");
     }
 }
@@ -18,10 +18,11 @@ public class Palette extends Resource
 
     public Bin bin;
 
-    public Palette(String id, String fileIn, int startIndex, int maxSize, boolean align16) throws Exception
+    /**
+     * Returns palette data (RGBA4444 format with Mega Drive 9 bits color mask) from the given PAL or image file
+     */
+    public static short[] getPaletteData(String fileIn) throws Exception
     {
-        super(id);
-
         String file = fileIn;
         short[] palette;
 
@@ -54,6 +55,23 @@ public class Palette extends Resource
                 palette = ImageUtil.getRGBA4444PaletteFromIndColImage(file, 0x0EEE);
         }
 
+        return palette;
+    }
+
+    public Palette(String id, String fileIn, int startIndex, int maxSize, boolean align16) throws Exception
+    {
+        super(id);
+
+        // image remapped to a shared palette (see PALETTE_GROUP) ?
+        final short[] sharedPalette = Util.getSharedPalette(fileIn);
+        short[] palette;
+
+        // shared palette: extract from wanted start index
+        if (sharedPalette != null)
+            palette = Arrays.copyOfRange(sharedPalette, Math.min(startIndex, sharedPalette.length), sharedPalette.length);
+        else
+            palette = getPaletteData(fileIn);
+
         final int adjMaxSize;
 
         // align max size on 16 entries
@@ -73,6 +91,17 @@ public class Palette extends Resource
         hc = bin.hashCode();
     }
 
+    public Palette(String id, short[] palette)
+    {
+        super(id);
+
+        // build BIN (we never compress palette)
+        bin = (Bin) addInternalResource(new Bin(id + "_data", palette, Compression.NONE, false));
+
+        // compute hash code
+        hc = bin.hashCode();
+    }
+
     public Palette(String id, String file, int maxSize, boolean align16) throws Exception
     {
         this(id, file, 0, maxSize, true);
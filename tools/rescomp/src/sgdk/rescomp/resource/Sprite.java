@@ -19,6 +19,8 @@ public class Sprite extends Resource
 {
     public final int wf; // width of frame cell in tile
     public final int hf; // height of frame cell in tile
+    public final int numRotation; // number of pre-rendered rotation steps per animation
+    public final int numScale; // number of pre-rendered scale steps per animation
     public final List<SpriteAnimation> animations;
     public int maxNumTile;
     public int maxNumSprite;
@@ -28,7 +30,7 @@ public class Sprite extends Resource
     public final Palette palette;
 
     public Sprite(String id, String imgFile, int wf, int hf, Compression compression, int time, CollisionType collision, OptimizationType opt,
-            long optIteration) throws Exception
+            long optIteration, int numRotation, int numScale) throws Exception
     {
         super(id);
 
@@ -44,6 +46,8 @@ public class Sprite extends Resource
         // set frame size
         this.wf = wf;
         this.hf = hf;
+        this.numRotation = Math.max(1, numRotation);
+        this.numScale = Math.max(1, numScale);
 
         // get 8bpp pixels and also check image dimension is aligned to tile
         final byte[] image = Util.getImage8bpp(imgFile, true);
@@ -91,16 +95,47 @@ public class Sprite extends Resource
 
         // get number of animation
         final int numAnim = ht / hf;
+        final int numVariant = this.numRotation * this.numScale;
+        final List<byte[]> variantImages = new ArrayList<>();
+
+        // pre-render rotation / scale variants (each frame cell is transformed around its center)
+        for (int s = 0; s < this.numScale; s++)
+            for (int r = 0; r < this.numRotation; r++)
+                variantImages.add(getTransformedImage(image, w, h, wf * 8, hf * 8, (r * 2d * Math.PI) / this.numRotation,
+                        (double) (this.numScale - s) / this.numScale));
+
+        if (numVariant > 1)
+            System.out.println("Sprite '" + id + "' uses " + this.numRotation + " rotation and " + this.numScale + " scale steps (" + numVariant
+                    + " animations per source animation)");
 
         for (int i = 0; i < numAnim; i++)
         {
-            // build sprite animation
-            SpriteAnimation animation = new SpriteAnimation(id + "_animation" + i, image, wt, ht, i, wf, hf, time, collision, compression, opt, optIteration);
+            final List<SpriteAnimation> variants = new ArrayList<>();
 
-            // check if empty
-            if (!animation.isEmpty())
+            for (int v = 0; v < numVariant; v++)
             {
-                // add as internal resource (get duplicate if exist)
+                final String animId = (numVariant > 1) ? id + "_animation" + i + "_s" + (v / this.numRotation) + "_r" + (v % this.numRotation)
+                        : id + "_animation" + i;
+
+                // build sprite animation
+                variants.add(new SpriteAnimation(animId, variantImages.get(v), wt, ht, i, wf, hf, time, collision, compression, opt, optIteration));
+            }
+
+            // check if empty (variant can't be removed as the runtime computes animation index from rotation / scale step)
+            if (variants.get(0).isEmpty())
+                continue;
+
+            for (SpriteAnimation animation : variants)
+            {
+                if (animation.isEmpty())
+                    throw new IllegalArgumentException("SPRITE '" + id + "' animation #" + i + " has an empty rotation / scale variant (" + animation.id
+                            + "), use a higher minimum scale or a larger sprite");
+                // variants should keep the same frame sequence
+                if (animation.getNumFrame() != variants.get(0).getNumFrame())
+                    throw new IllegalArgumentException("SPRITE '" + id + "' animation #" + i + " has a rotation / scale variant (" + animation.id
+                            + ") with a different number of frame (empty frame), add some margin around frame content");
+
+                // add as internal resource (get duplicate if exist, identical variants share their data)
                 animation = (SpriteAnimation) addInternalResource(animation);
 
                 // update maximum number of tile and sprite
@@ -113,7 +148,47 @@ public class Sprite extends Resource
         }
 
         // compute hash code
-        hc = (wf << 0) ^ (hf << 8) ^ (maxNumTile << 16) ^ (maxNumSprite << 24) ^ animations.hashCode() ^ palette.hashCode();
+        hc = (wf << 0) ^ (hf << 8) ^ (maxNumTile << 16) ^ (maxNumSprite << 24) ^ (this.numRotation << 4) ^ (this.numScale << 12) ^ animations.hashCode()
+                ^ palette.hashCode();
+    }
+
+    // rotate (clockwise on screen) and scale each frame cell of the given 8bpp image around its center (nearest pixel, transparent
+    // outside), content going out of the frame cell is clipped
+    static byte[] getTransformedImage(byte[] image, int w, int h, int cw, int ch, double angle, double scale)
+    {
+        // nothing to do
+        if ((angle == 0d) && (scale == 1d))
+            return image;
+
+        final byte[] result = new byte[image.length];
+        final double cos = Math.cos(angle) / scale;
+        final double sin = Math.sin(angle) / scale;
+        final double cx = cw / 2d;
+        final double cy = ch / 2d;
+
+        for (int yc = 0; yc < h; yc += ch)
+        {
+            for (int xc = 0; xc < w; xc += cw)
+            {
+                for (int y = 0; y < ch; y++)
+                {
+                    final double dy = (y + 0.5d) - cy;
+
+                    for (int x = 0; x < cw; x++)
+                    {
+                        final double dx = (x + 0.5d) - cx;
+                        // inverse transform to get source pixel
+                        final int sx = (int) Math.floor((dx * cos) + (dy * sin) + cx);
+                        final int sy = (int) Math.floor((dy * cos) - (dx * sin) + cy);
+
+                        if ((sx >= 0) && (sx < cw) && (sy >= 0) && (sy < ch))
+                            result[((yc + y) * w) + xc + x] = image[((yc + sy) * w) + xc + sx];
+                    }
+                }
+            }
+        }
+
+        return result;
     }
 
     @Override
@@ -129,7 +204,8 @@ public class Sprite extends Resource
         {
             final Sprite sprite = (Sprite) obj;
             return (wf == sprite.wf) && (hf == sprite.hf) && (maxNumTile == sprite.maxNumTile) && (maxNumSprite == sprite.maxNumSprite)
-                    && animations.equals(sprite.animations) && palette.equals(sprite.palette);
+                    && (numRotation == sprite.numRotation) && (numScale == sprite.numScale) && animations.equals(sprite.animations)
+                    && palette.equals(sprite.palette);
         }
 
         return false;
@@ -144,7 +220,7 @@ public class Sprite extends Resource
     @Override
     public int shallowSize()
     {
-        return (animations.size() * 4) + 2 + 2 + 4 + 2 + 4 + 2 + 2;
+        return (animations.size() * 4) + 2 + 2 + 4 + 2 + 4 + 2 + 2 + 2;
     }
 
     @Override
@@ -188,6 +264,8 @@ public class Sprite extends Resource
         // set maximum number of VDP sprite used by a single animation frame (used for VDP sprite
         // allocation)
         outS.append("    dc.w    " + maxNumSprite + "\n");
+        // set number of rotation and scale steps (pre-rendered variants)
+        outS.append("    dc.w    " + (((numRotation & 0xFF) << 8) | (numScale & 0xFF)) + "\n");
 
         outS.append("\n");
     }
@@ -8,34 +8,46 @@ import java.util.HashMap;
 import java.util.List;
 
 import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.ImageStripReader;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics.Compression;
 import sgdk.rescomp.type.Basics.TileEquality;
 import sgdk.rescomp.type.Basics.TileOptimization;
 import sgdk.rescomp.type.Tile;
-import sgdk.tool.ImageUtil;
-import sgdk.tool.ImageUtil.BasicImageInfo;
 
 public class Tileset extends Resource
 {
     public static Tileset getTileset(String id, String imgFile, Compression compression, TileOptimization tileOpt, boolean addBlank)
             throws Exception
     {
-        // get 8bpp pixels and also check image dimension is aligned to tile
-        final byte[] image = Util.getImage8bpp(imgFile, true);
-        
-        // happen when we couldn't retrieve palette data from RGB image
-        if (image == null)
-            throw new IllegalArgumentException(
-                    "RGB image '" + imgFile + "' does not contains palette data (see 'Important note about image format' in the rescomp.txt file");
-
-        // retrieve basic infos about the image
-        final BasicImageInfo imgInfo = ImageUtil.getBasicInfo(imgFile);
-        final int w = imgInfo.w;
-        // we determine 'h' from data length and 'w' as we can crop image vertically to remove palette data
-        final int h = image.length / w;
-
-        return new Tileset(id, image, w, h, 0, 0, w / 8, h / 8, tileOpt, compression, addBlank);
+        return getTileset(id, imgFile, compression, tileOpt, addBlank, false);
+    }
+
+    public static Tileset getTileset(String id, String imgFile, Compression compression, TileOptimization tileOpt, boolean addBlank,
+            boolean im2) throws Exception
+    {
+        // get 8bpp pixels by strip (huge image are decoded on the fly) and also check image dimension is aligned to tile
+        try (ImageStripReader image = ImageStripReader.open(imgFile, true))
+        {
+            // happen when we couldn't retrieve palette data from RGB image
+            if (image == null)
+                throw new IllegalArgumentException(
+                        "RGB image '" + imgFile + "' does not contains palette data (see 'Important note about image format' in the rescomp.txt file");
+
+            final int w = image.w;
+            final int h = image.h;
+
+            // 8x16 tiles (interlaced mode 2)
+            if (im2)
+            {
+                if (((h / 8) & 1) != 0)
+                    throw new IllegalArgumentException("'" + imgFile + "' height should be a multiple of 16 for IM2 tile ordering.");
+
+                return new Tileset(id, image.read(h), w, h, w / 8, h / 8, compression);
+            }
+
+            return new Tileset(id, image, 0, 0, w / 8, h / 8, tileOpt, compression, addBlank);
+        }
     }
 
     // tiles
@@ -84,6 +96,14 @@ public class Tileset extends Resource
 
     public Tileset(String id, byte[] image8bpp, int imageWidth, int imageHeight, int startTileX, int startTileY, int widthTile, int heightTile,
             TileOptimization opt, Compression compression, boolean addBlank)
+    {
+        this(id, new ImageStripReader(image8bpp, imageWidth, imageHeight), startTileX, startTileY, widthTile, heightTile, opt, compression,
+                addBlank);
+    }
+
+    // build tileset reading image by strip of 1 tile height
+    public Tileset(String id, ImageStripReader image, int startTileX, int startTileY, int widthTile, int heightTile, TileOptimization opt,
+            Compression compression, boolean addBlank)
     {
         super(id);
 
@@ -93,13 +113,36 @@ public class Tileset extends Resource
         tileIndexesMap = new HashMap<>();
         tileByHashcodeMap = new HashMap<>();
 
+        try
+        {
+            // skip rows above start tile
+            if (startTileY > 0)
+                image.read(startTileY * 8);
+        }
+        catch (IOException e)
+        {
+            throw new IllegalArgumentException("Error while reading image: " + e.getMessage(), e);
+        }
+
         // important to always use the same loop order when building Tileset and Tilemap/Map object
         for (int j = 0; j < heightTile; j++)
         {
+            final byte[] strip;
+
+            try
+            {
+                // get image strip for this tile row
+                strip = image.read(8);
+            }
+            catch (IOException e)
+            {
+                throw new IllegalArgumentException("Error while reading image: " + e.getMessage(), e);
+            }
+
             for (int i = 0; i < widthTile; i++)
             {
                 // get tile
-                final Tile tile = Tile.getTile(image8bpp, imageWidth, imageHeight, (i + startTileX) * 8, (j + startTileY) * 8, 8);
+                final Tile tile = Tile.getTile(strip, image.w, 8, (i + startTileX) * 8, 0, 8);
                 // find if tile already exist
                 final int index = getTileIndex(tile, opt);
 
@@ -139,6 +182,48 @@ public class Tileset extends Resource
         hc = bin.hashCode();
     }
 
+    // 8x16 tiles for interlaced mode 2: each 8x16 tile is stored as its top 8x8 tile followed by its bottom 8x8 tile
+    // (no optimization as a 8x16 tile can only be shared as a whole)
+    public Tileset(String id, byte[] image8bpp, int imageWidth, int imageHeight, int widthTile, int heightTile, Compression compression)
+    {
+        super(id);
+
+        tiles = new ArrayList<>();
+        tileIndexesMap = new HashMap<>();
+        tileByHashcodeMap = new HashMap<>();
+
+        for (int j = 0; j < heightTile; j += 2)
+        {
+            for (int i = 0; i < widthTile; i++)
+            {
+                add(Tile.getTile(image8bpp, imageWidth, imageHeight, i * 8, j * 8, 8));
+                add(Tile.getTile(image8bpp, imageWidth, imageHeight, i * 8, (j + 1) * 8, 8));
+            }
+        }
+
+        // build the binary bloc
+        final int[] data = new int[tiles.size() * 8];
+
+        int offset = 0;
+        for (Tile t : tiles)
+        {
+            System.arraycopy(t.data, 0, data, offset, 8);
+            offset += 8;
+        }
+
+        // build BIN (tiles data) with wanted compression
+        final Bin binResource = new Bin(id + "_data", data, compression);
+        // internal
+        binResource.global = false;
+        // keep track of duplicate bin resource here
+        isDuplicate = findResource(binResource) != null;
+        // add as resource (avoid duplicate)
+        bin = (Bin) addInternalResource(binResource);
+
+        // compute hash code
+        hc = bin.hashCode();
+    }
+
     public Tileset(String id, byte[] image8bpp, int imageWidth, int imageHeight, List<? extends Rectangle> sprites, Compression compression)
     {
         super(id);
@@ -0,0 +1,590 @@
+package sgdk.rescomp.resource;
+
+import java.io.ByteArrayOutputStream;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map.Entry;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.Util;
+import sgdk.rescomp.type.Basics.Compression;
+import sgdk.rescomp.type.Basics.TileOptimization;
+import sgdk.tool.ImageUtil;
+
+/**
+ * Frame delta video (Video structure) built from a sequence of frame images.<br>
+ * All frames are remapped to a single 16 colors palette, the tiles recurring the most in frame updates are stored in
+ * a dictionary uploaded once and each frame only stores the tiles changed since previous frame: tiles still present in
+ * VRAM are reused, others are allocated in a VRAM pool slot not displayed by previous frame (so they can be uploaded
+ * before the tilemap update) and tiles exceeding the per frame budget are delayed to next frames (biggest changes
+ * first).<br>
+ * Frame data (words): number of tile run, number of tile, number of tilemap run, tile runs (VRAM index, count), tiles
+ * data then tilemap runs (position, count, tile indexes). VRAM indexes are relative to the video base tile (dictionary
+ * first, then pool).
+ */
+public class Video extends Resource
+{
+    final static int TILE_PIXELS = 64;
+    // tilemap runs separated by up to this number of unchanged entries are merged (a run header costs 2 words)
+    final static int MAX_RUN_GAP = 2;
+    // user VRAM tiles with default planes location (used to limit default pool size)
+    final static int DEFAULT_VRAM_TILES = 1408;
+
+    public final int w;
+    public final int h;
+    public final int fps;
+    public final int numFrame;
+    public final int numDictTile;
+    public final int numPoolTile;
+    public final int maxFrameSize;
+
+    public final Palette palette;
+    public final Tileset dictionary;
+    public final List<Bin> frames;
+
+    // encoding statistics
+    public int numColor;
+    public int numUniqueTile;
+    public int numNewTile;
+    public int numDelayedTile;
+
+    final int hc;
+
+    /**
+     * @param files
+     *        frame image files (in play order)
+     * @param maxTile
+     *        maximum number of new tile per frame (0 = no limit)
+     * @param dictSize
+     *        maximum number of tile in the dictionary
+     * @param poolSize
+     *        number of VRAM tile for frame tiles (0 = automatic)
+     */
+    public Video(String id, List<String> files, int fps, Compression compression, int maxTile, int dictSize, int poolSize) throws Exception
+    {
+        super(id);
+
+        if (files.isEmpty())
+            throw new IllegalArgumentException("VIDEO '" + id + "' doesn't have any frame image");
+        if ((fps < 1) || (fps > 60))
+            throw new IllegalArgumentException("VIDEO '" + id + "' frame rate (" + fps + ") should be in [1..60] range");
+
+        final ImageUtil.BasicImageInfo info = ImageUtil.getBasicInfo(files.get(0));
+
+        w = info.w / 8;
+        h = info.h / 8;
+        if ((w > 64) || (h > 64))
+            throw new IllegalArgumentException("VIDEO '" + id + "' frame size (" + w + " x " + h + " tiles) is too large (64 x 64 max)");
+
+        this.fps = fps;
+        numFrame = files.size();
+
+        // PASS 1: get frame colors to build the video palette
+        final java.util.Map<Integer, Long> colorWeight = new HashMap<>();
+        for (String file : files)
+        {
+            final byte[] image = getImage(file, info);
+            final short[] pal = getSourcePalette(file);
+
+            for (byte pixel : image)
+                colorWeight.merge(Integer.valueOf(getColor(pal, pixel)), Long.valueOf(1), Long::sum);
+        }
+
+        numColor = colorWeight.size();
+
+        final short[] pal = new short[16];
+        final java.util.Map<Integer, Integer> colorIndex = buildPalette(colorWeight, pal);
+
+        // PASS 2: get tiles (id in 'tiles' list) of each frame
+        final java.util.Map<ByteBuffer, Integer> tileIds = new HashMap<>();
+        final List<byte[]> tiles = new ArrayList<>();
+        final List<int[]> frameTiles = new ArrayList<>();
+
+        for (String file : files)
+        {
+            final byte[] image = getImage(file, info);
+            final short[] srcPal = getSourcePalette(file);
+            final int[] ids = new int[w * h];
+
+            for (int ty = 0; ty < h; ty++)
+            {
+                for (int tx = 0; tx < w; tx++)
+                {
+                    final byte[] tile = new byte[TILE_PIXELS];
+
+                    for (int y = 0; y < 8; y++)
+                        for (int x = 0; x < 8; x++)
+                            tile[(y * 8) + x] = colorIndex.get(Integer.valueOf(getColor(srcPal, image[(((ty * 8) + y) * info.w) + (tx * 8) + x])))
+                                    .byteValue();
+
+                    final ByteBuffer key = ByteBuffer.wrap(tile);
+                    Integer tid = tileIds.get(key);
+
+                    if (tid == null)
+                    {
+                        tid = Integer.valueOf(tiles.size());
+                        tileIds.put(key, tid);
+                        tiles.add(tile);
+                    }
+
+                    ids[(ty * w) + tx] = tid.intValue();
+                }
+            }
+
+            frameTiles.add(ids);
+        }
+
+        numUniqueTile = tiles.size();
+
+        // dictionary: tiles needed the most often by frame updates (at least twice)
+        final int[] useCount = new int[tiles.size()];
+        int[] prev = null;
+        for (int[] ids : frameTiles)
+        {
+            for (int pos = 0; pos < ids.length; pos++)
+                if ((prev == null) || (ids[pos] != prev[pos]))
+                    useCount[ids[pos]]++;
+
+            prev = ids;
+        }
+
+        final List<Integer> candidates = new ArrayList<>();
+        for (int t = 0; t < useCount.length; t++)
+            if (useCount[t] >= 2)
+                candidates.add(Integer.valueOf(t));
+        // most used first (stable so first seen tile wins on tie)
+        candidates.sort((t1, t2) -> Integer.compare(useCount[t2.intValue()], useCount[t1.intValue()]));
+
+        final java.util.Map<Integer, Integer> dictIndex = new HashMap<>();
+        final int numDict = Math.min(Math.max(0, dictSize), candidates.size());
+        for (int i = 0; i < numDict; i++)
+            dictIndex.put(candidates.get(i), Integer.valueOf(i));
+
+        numDictTile = numDict;
+        numPoolTile = (poolSize > 0) ? poolSize : Math.max(w * h, Math.min((w * h) + maxTile, DEFAULT_VRAM_TILES - numDict));
+
+        // encode frames
+        final int numPos = w * h;
+        // tile id and tile index (relative to video base tile) displayed at each position (-1 = nothing yet)
+        int[] shown = new int[numPos];
+        int[] shownIndex = new int[numPos];
+        // tile id in each pool slot (-1 = free) and number of displayed position using it
+        final int[] slotTile = new int[numPoolTile];
+        int[] slotRef = new int[numPoolTile];
+        // tile id --> slot containing it
+        final java.util.Map<Integer, Integer> resident = new HashMap<>();
+        int cursor = 0;
+        int maxSize = 0;
+
+        Arrays.fill(shown, -1);
+        Arrays.fill(shownIndex, -1);
+        Arrays.fill(slotTile, -1);
+
+        frames = new ArrayList<>();
+
+        for (int f = 0; f < numFrame; f++)
+        {
+            final int[] ids = frameTiles.get(f);
+            final int[] newShown = shown.clone();
+            final int[] newIndex = shownIndex.clone();
+            // tiles needing a VRAM slot --> positions (in position order)
+            final LinkedHashMap<Integer, List<Integer>> needed = new LinkedHashMap<>();
+
+            for (int pos = 0; pos < numPos; pos++)
+            {
+                final int t = ids[pos];
+
+                if (t == shown[pos])
+                    continue;
+
+                Integer ind = dictIndex.get(Integer.valueOf(t));
+
+                if (ind == null)
+                {
+                    final Integer slot = resident.get(Integer.valueOf(t));
+
+                    if (slot == null)
+                    {
+                        needed.computeIfAbsent(Integer.valueOf(t), k -> new ArrayList<>()).add(Integer.valueOf(pos));
+                        continue;
+                    }
+
+                    ind = Integer.valueOf(numDict + slot.intValue());
+                }
+
+                newShown[pos] = t;
+                newIndex[pos] = ind.intValue();
+            }
+
+            List<Integer> newTiles = new ArrayList<>(needed.keySet());
+
+            // too many new tiles --> keep the ones changing the most pixels (others are delayed to next frames)
+            if ((maxTile > 0) && (newTiles.size() > maxTile))
+            {
+                final java.util.Map<Integer, Integer> errors = new HashMap<>();
+
+                for (Entry<Integer, List<Integer>> entry : needed.entrySet())
+                {
+                    final byte[] tile = tiles.get(entry.getKey().intValue());
+                    int err = 0;
+
+                    for (Integer pos : entry.getValue())
+                    {
+                        final int old = shown[pos.intValue()];
+                        err += (old == -1) ? TILE_PIXELS : getDiff(tile, tiles.get(old));
+                    }
+
+                    errors.put(entry.getKey(), Integer.valueOf(err));
+                }
+
+                final List<Integer> sorted = new ArrayList<>(newTiles);
+                sorted.sort((t1, t2) -> Integer.compare(errors.get(t2).intValue(), errors.get(t1).intValue()));
+
+                final List<Integer> kept = sorted.subList(0, maxTile);
+                for (Integer t : sorted.subList(maxTile, sorted.size()))
+                    numDelayedTile += needed.get(t).size();
+
+                // keep position order so allocated slots stay contiguous
+                newTiles.retainAll(kept);
+            }
+
+            // pool slots referenced by this frame
+            final int[] newRef = new int[numPoolTile];
+            for (int pos = 0; pos < numPos; pos++)
+                if (newIndex[pos] >= numDict)
+                    newRef[newIndex[pos] - numDict]++;
+
+            final ByteArrayOutputStream tileRuns = new ByteArrayOutputStream();
+            final ByteArrayOutputStream tileData = new ByteArrayOutputStream();
+            int numTileRun = 0;
+            int numTile = 0;
+            int runStart = -1;
+            int runLen = 0;
+
+            for (Integer t : newTiles)
+            {
+                int slot = -1;
+
+                // next slot not displayed by previous frame nor by this one
+                for (int i = 0; i < numPoolTile; i++)
+                {
+                    final int s = (cursor + i) % numPoolTile;
+
+                    if ((slotRef[s] == 0) && (newRef[s] == 0))
+                    {
+                        slot = s;
+                        break;
+                    }
+                }
+
+                final List<Integer> positions = needed.get(t);
+
+                // pool full --> delay to next frame
+                if (slot == -1)
+                {
+                    numDelayedTile += positions.size();
+                    continue;
+                }
+
+                cursor = (slot + 1) % numPoolTile;
+
+                // evict previous slot content
+                if (slotTile[slot] != -1)
+                    resident.remove(Integer.valueOf(slotTile[slot]));
+
+                slotTile[slot] = t.intValue();
+                resident.put(t, Integer.valueOf(slot));
+                newRef[slot] += positions.size();
+
+                for (Integer pos : positions)
+                {
+                    newShown[pos.intValue()] = t.intValue();
+                    newIndex[pos.intValue()] = numDict + slot;
+                }
+
+                // extend current tile run or start a new one
+                if ((runLen > 0) && ((runStart + runLen) == (numDict + slot)))
+                    runLen++;
+                else
+                {
+                    if (runLen > 0)
+                    {
+                        writeWord(tileRuns, runStart);
+                        writeWord(tileRuns, runLen);
+                        numTileRun++;
+                    }
+
+                    runStart = numDict + slot;
+                    runLen = 1;
+                }
+
+                write4bpp(tileData, tiles.get(t.intValue()));
+                numTile++;
+            }
+
+            if (runLen > 0)
+            {
+                writeWord(tileRuns, runStart);
+                writeWord(tileRuns, runLen);
+                numTileRun++;
+            }
+
+            numNewTile += numTile;
+
+            // tilemap runs
+            final ByteArrayOutputStream mapRuns = new ByteArrayOutputStream();
+            int numMapRun = 0;
+            int pos = 0;
+
+            while (pos < numPos)
+            {
+                if (newIndex[pos] == shownIndex[pos])
+                {
+                    pos++;
+                    continue;
+                }
+
+                final int start = pos;
+                int end = pos + 1;
+                int p = end;
+
+                // merge runs separated by small gaps
+                while (p < numPos)
+                {
+                    if (newIndex[p] != shownIndex[p])
+                        end = ++p;
+                    else if ((p - end) < MAX_RUN_GAP)
+                        p++;
+                    else
+                        break;
+                }
+
+                writeWord(mapRuns, start);
+                writeWord(mapRuns, end - start);
+                for (int i = start; i < end; i++)
+                    writeWord(mapRuns, newIndex[i]);
+
+                numMapRun++;
+                pos = end;
+            }
+
+            // build frame data
+            final ByteArrayOutputStream data = new ByteArrayOutputStream();
+            writeWord(data, numTileRun);
+            writeWord(data, numTile);
+            writeWord(data, numMapRun);
+            tileRuns.writeTo(data);
+            tileData.writeTo(data);
+            mapRuns.writeTo(data);
+
+            if (data.size() > 0xFFFF)
+                throw new IllegalArgumentException("VIDEO '" + id + "' frame " + f + " data is too large (" + data.size()
+                        + " bytes), reduce max_tiles value");
+
+            maxSize = Math.max(maxSize, data.size());
+            frames.add((Bin) addInternalResource(new Bin(id + "_frame" + f, data.toByteArray(), 2, compression)));
+
+            shown = newShown;
+            shownIndex = newIndex;
+            slotRef = newRef;
+        }
+
+        maxFrameSize = maxSize;
+
+        palette = (Palette) addInternalResource(new Palette(id + "_palette", pal));
+
+        if (numDict > 0)
+        {
+            // dictionary tiles as a 8 pixels wide image
+            final byte[] image = new byte[numDict * TILE_PIXELS];
+            for (int i = 0; i < numDict; i++)
+                System.arraycopy(tiles.get(candidates.get(i).intValue()), 0, image, i * TILE_PIXELS, TILE_PIXELS);
+
+            dictionary = (Tileset) addInternalResource(
+                    new Tileset(id + "_dictionary", image, 8, numDict * 8, 0, 0, 1, numDict, TileOptimization.NONE, compression, false));
+        }
+        else
+            dictionary = null;
+
+        // compute hash code
+        hc = frames.hashCode() ^ palette.hashCode() ^ ((dictionary != null) ? dictionary.hashCode() : 0) ^ (w << 8) ^ (h << 16) ^ (fps << 24);
+    }
+
+    static byte[] getImage(String file, ImageUtil.BasicImageInfo info) throws Exception
+    {
+        final byte[] result = Util.getImage8bpp(file, true);
+
+        // happen when we couldn't retrieve palette data from RGB image
+        if (result == null)
+            throw new IllegalArgumentException(
+                    "RGB image '" + file + "' does not contains palette data (see 'Important note about image format' in the rescomp.txt file");
+
+        final ImageUtil.BasicImageInfo imgInfo = ImageUtil.getBasicInfo(file);
+
+        if ((imgInfo.w != info.w) || (imgInfo.h != info.h))
+            throw new IllegalArgumentException("VIDEO frame '" + file + "' size (" + imgInfo.w + " x " + imgInfo.h
+                    + ") differs from first frame size (" + info.w + " x " + info.h + ")");
+
+        return result;
+    }
+
+    static short[] getSourcePalette(String file) throws Exception
+    {
+        // image may already be remapped by a palette group
+        final short[] result = Util.getSharedPalette(file);
+        return (result != null) ? result : Palette.getPaletteData(file);
+    }
+
+    static int getColor(short[] pal, byte pixel)
+    {
+        final int ind = pixel & 0x3F;
+        return (ind < pal.length) ? (pal[ind] & 0x0EEE) : 0;
+    }
+
+    static int getColorDistance(int c1, int c2)
+    {
+        final int r = ((c1 >> 1) & 7) - ((c2 >> 1) & 7);
+        final int g = ((c1 >> 5) & 7) - ((c2 >> 5) & 7);
+        final int b = ((c1 >> 9) & 7) - ((c2 >> 9) & 7);
+
+        return (r * r * 3) + (g * g * 4) + (b * b * 2);
+    }
+
+    /**
+     * Build the 16 colors palette (most used colors first so index 0 is the most used one) and return the color to
+     * palette index map (colors not fitting in the palette use the closest palette color).
+     */
+    static java.util.Map<Integer, Integer> buildPalette(java.util.Map<Integer, Long> colorWeight, short[] pal)
+    {
+        final List<Integer> colors = new ArrayList<>(colorWeight.keySet());
+        colors.sort((c1, c2) -> {
+            final int cmp = Long.compare(colorWeight.get(c2).longValue(), colorWeight.get(c1).longValue());
+            return (cmp != 0) ? cmp : Integer.compare(c1.intValue(), c2.intValue());
+        });
+
+        final int numColor = Math.min(16, colors.size());
+        for (int i = 0; i < numColor; i++)
+            pal[i] = (short) colors.get(i).intValue();
+
+        final java.util.Map<Integer, Integer> result = new HashMap<>();
+
+        for (int i = 0; i < colors.size(); i++)
+        {
+            int best = i;
+
+            if (i >= 16)
+            {
+                int bestDist = Integer.MAX_VALUE;
+
+                for (int j = 0; j < 16; j++)
+                {
+                    final int dist = getColorDistance(colors.get(i).intValue(), pal[j]);
+
+                    if (dist < bestDist)
+                    {
+                        bestDist = dist;
+                        best = j;
+                    }
+                }
+            }
+
+            result.put(colors.get(i), Integer.valueOf(best));
+        }
+
+        return result;
+    }
+
+    // number of different pixel
+    static int getDiff(byte[] tile1, byte[] tile2)
+    {
+        int result = 0;
+
+        for (int i = 0; i < TILE_PIXELS; i++)
+            if (tile1[i] != tile2[i])
+                result++;
+
+        return result;
+    }
+
+    static void writeWord(ByteArrayOutputStream out, int value)
+    {
+        out.write((value >> 8) & 0xFF);
+        out.write(value & 0xFF);
+    }
+
+    static void write4bpp(ByteArrayOutputStream out, byte[] tile)
+    {
+        for (int i = 0; i < TILE_PIXELS; i += 2)
+            out.write(((tile[i] & 0xF) << 4) | (tile[i + 1] & 0xF));
+    }
+
+    @Override
+    public int internalHashCode()
+    {
+        return hc;
+    }
+
+    @Override
+    public boolean internalEquals(Object obj)
+    {
+        if (obj instanceof Video)
+        {
+            final Video video = (Video) obj;
+            return (w == video.w) && (h == video.h) && (fps == video.fps) && frames.equals(video.frames) && palette.equals(video.palette)
+                    && ((dictionary == null) ? (video.dictionary == null) : dictionary.equals(video.dictionary));
+        }
+
+        return false;
+    }
+
+    @Override
+    public int shallowSize()
+    {
+        return (frames.size() * 8) + (2 * 6) + (4 * 3);
+    }
+
+    @Override
+    public int totalSize()
+    {
+        int result = shallowSize() + palette.totalSize();
+
+        for (Bin bin : frames)
+            result += bin.totalSize();
+        if (dictionary != null)
+            result += dictionary.totalSize();
+
+        return result;
+    }
+
+    @Override
+    public void out(ByteArrayOutputStream outB, StringBuilder outS, StringBuilder outH)
+    {
+        // can't store pointer so we just reset binary stream here (used for compression only)
+        outB.reset();
+
+        // frames table (compression, unpacked size and data pointer)
+        Util.decl(outS, outH, null, id + "_frames", 2, false);
+        for (Bin bin : frames)
+        {
+            outS.append("    dc.w    " + (bin.doneCompression.ordinal() - 1) + ", " + bin.data.length + "\n");
+            outS.append("    dc.l    " + bin.id + "\n");
+        }
+        outS.append("\n");
+
+        // declare
+        Util.decl(outS, outH, "Video", id, 2, global);
+        // size (in tile), frame rate and number of frame
+        outS.append("    dc.w    " + w + ", " + h + ", " + fps + ", " + numFrame + "\n");
+        // max frame data size and number of VRAM tile
+        outS.append("    dc.w    " + maxFrameSize + ", " + (numDictTile + numPoolTile) + "\n");
+        // palette, dictionary and frames pointers
+        outS.append("    dc.l    " + palette.id + "\n");
+        outS.append("    dc.l    " + ((dictionary != null) ? dictionary.id : "0") + "\n");
+        outS.append("    dc.l    " + id + "_frames\n");
+        outS.append("\n");
+    }
+}
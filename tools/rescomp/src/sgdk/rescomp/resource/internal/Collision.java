@@ -105,6 +105,20 @@ public class Collision extends Resource
         }
     }
 
+    // COLLISION_TYPE_XXX value (see sprite_eng.h), differs from the CollisionType order
+    static int getTypeValue(CollisionType type)
+    {
+        switch (type)
+        {
+            case BOX:
+                return 1;
+            case CIRCLE:
+                return 2;
+            default:
+                return 0;
+        }
+    }
+
     @Override
     public int shallowSize()
     {
@@ -125,10 +139,10 @@ public class Collision extends Resource
         Util.decl(outS, outH, "Collision", id, 2, global);
 
         // collision types
-        outS.append("    dc.w    " + ((typeHit.ordinal() << 8) | ((typeAttack.ordinal() << 0) & 0xFF)) + "\n");
+        outS.append("    dc.w    " + ((getTypeValue(typeHit) << 8) | ((getTypeValue(typeAttack) << 0) & 0xFF)) + "\n");
         // binary write
-        outB.write(typeHit.ordinal());
-        outB.write(typeAttack.ordinal());
+        outB.write(getTypeValue(typeHit));
+        outB.write(getTypeValue(typeAttack));
 
         // collision itself
         outCollision(hit, outB, outS, outH, typeAttack != CollisionType.NONE);
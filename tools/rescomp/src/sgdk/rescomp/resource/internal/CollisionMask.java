@@ -0,0 +1,198 @@
+package sgdk.rescomp.resource.internal;
+
+import java.awt.Rectangle;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.Arrays;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.tool.Util;
+
+/**
+ * 1bpp collision mask of a sprite frame (CollisionMask structure).<br>
+ * Mask only covers the opaque area of the frame and is stored as 32 pixels wide columns of u32 rows (column major, bit 31
+ * = leftmost pixel) so the runtime can test 2 masks with shifted 32 bit AND (see COL_testMasks(..)).<br>
+ * H, V and HV flipped variants are optionally exported (index = (vflip << 1) | hflip).
+ */
+public class CollisionMask extends Resource
+{
+    public static final int NUM_VARIANT = 4;
+
+    // mask area in frame (opaque pixels bounding box)
+    public final Rectangle bounds;
+    public final int numCol;
+    // rows for each flip variant (null if not exported)
+    final int[][] rows;
+
+    final int hc;
+
+    /**
+     * @param image8bpp
+     *        frame image (8bpp, pixel is opaque when color index & 0xF != 0)
+     * @param w
+     *        frame width in pixel
+     * @param h
+     *        frame height in pixel
+     * @param flip
+     *        export H, V and HV flipped variants
+     */
+    public CollisionMask(String id, byte[] image8bpp, int w, int h, boolean flip)
+    {
+        super(id);
+
+        bounds = getOpaqueBounds(image8bpp, w, h);
+        numCol = (bounds.width + 31) / 32;
+        rows = new int[NUM_VARIANT][];
+
+        for (int v = 0; v < (flip ? NUM_VARIANT : 1); v++)
+            rows[v] = getRows(image8bpp, w, (v & 1) != 0, (v & 2) != 0);
+
+        int h0 = bounds.hashCode();
+        for (int[] r : rows)
+            h0 = (h0 * 31) ^ ((r != null) ? Arrays.hashCode(r) : 0);
+        hc = h0;
+    }
+
+    static Rectangle getOpaqueBounds(byte[] image8bpp, int w, int h)
+    {
+        int minX = w;
+        int minY = h;
+        int maxX = -1;
+        int maxY = -1;
+
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                if ((image8bpp[(y * w) + x] & 0xF) != 0)
+                {
+                    minX = Math.min(minX, x);
+                    maxX = Math.max(maxX, x);
+                    minY = Math.min(minY, y);
+                    maxY = Math.max(maxY, y);
+                }
+            }
+        }
+
+        // empty mask
+        if (maxX < 0)
+            return new Rectangle();
+
+        return new Rectangle(minX, minY, (maxX - minX) + 1, (maxY - minY) + 1);
+    }
+
+    int[] getRows(byte[] image8bpp, int w, boolean hflip, boolean vflip)
+    {
+        final int mw = bounds.width;
+        final int mh = bounds.height;
+        final int[] result = new int[numCol * mh];
+
+        for (int y = 0; y < mh; y++)
+        {
+            final int sy = bounds.y + (vflip ? (mh - 1) - y : y);
+
+            for (int x = 0; x < mw; x++)
+            {
+                final int sx = bounds.x + (hflip ? (mw - 1) - x : x);
+
+                if ((image8bpp[(sy * w) + sx] & 0xF) != 0)
+                    result[((x / 32) * mh) + y] |= 0x80000000 >>> (x & 31);
+            }
+        }
+
+        return result;
+    }
+
+    public boolean isEmpty()
+    {
+        return bounds.isEmpty();
+    }
+
+    @Override
+    public int internalHashCode()
+    {
+        return hc;
+    }
+
+    @Override
+    public boolean internalEquals(Object obj)
+    {
+        if (obj instanceof CollisionMask)
+        {
+            final CollisionMask mask = (CollisionMask) obj;
+            return bounds.equals(mask.bounds) && Arrays.deepEquals(rows, mask.rows);
+        }
+
+        return false;
+    }
+
+    @Override
+    public String toString()
+    {
+        return id + ": bounds=" + bounds + " numVariant=" + ((rows[1] != null) ? NUM_VARIANT : 1);
+    }
+
+    @Override
+    public int shallowSize()
+    {
+        return 2 + 2 + 2 + (NUM_VARIANT * 4);
+    }
+
+    @Override
+    public int totalSize()
+    {
+        int result = shallowSize();
+
+        for (int[] r : rows)
+            if (r != null)
+                result += r.length * 4;
+
+        return result;
+    }
+
+    @Override
+    public void out(ByteArrayOutputStream outB, StringBuilder outS, StringBuilder outH) throws IOException
+    {
+        // can't store pointer so we just reset binary stream here (used for compression only)
+        outB.reset();
+
+        // CollisionMask structure
+        Util.decl(outS, outH, "CollisionMask", id, 2, global);
+        // mask area in frame
+        outS.append("    dc.w    " + (((bounds.x & 0xFF) << 8) | ((bounds.y << 0) & 0xFF)) + "\n");
+        outS.append("    dc.w    " + (((bounds.width & 0xFF) << 8) | ((bounds.height << 0) & 0xFF)) + "\n");
+        outS.append("    dc.w    " + numCol + "\n");
+        // rows pointer for each flip variant
+        for (int v = 0; v < NUM_VARIANT; v++)
+        {
+            if (rows[v] == null)
+                outS.append("    dc.l    " + 0 + "\n");
+            else
+                outS.append("    dc.l    " + id + "_rows" + v + "\n");
+        }
+        outS.append("\n");
+
+        // rows data
+        for (int v = 0; v < NUM_VARIANT; v++)
+        {
+            final int[] r = rows[v];
+
+            if (r == null)
+                continue;
+
+            Util.decl(outS, outH, "u32", id + "_rows" + v, 2, false);
+            for (int i = 0; i < r.length; i += 4)
+            {
+                outS.append("    dc.l    ");
+                for (int j = i; j < Math.min(i + 4, r.length); j++)
+                {
+                    if (j > i)
+                        outS.append(", ");
+                    outS.append(String.format("0x%08X", Integer.valueOf(r[j])));
+                }
+                outS.append("\n");
+            }
+            outS.append("\n");
+        }
+    }
+}
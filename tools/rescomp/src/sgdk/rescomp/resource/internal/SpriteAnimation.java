@@ -20,9 +20,14 @@ import sgdk.tool.ImageUtil;
 
 public class SpriteAnimation extends Resource
 {
+    // maximum number of VDP sprite per frame
+    final static int MAX_SPRITE = 16;
+
     public final List<SpriteFrame> frames;
     public final Set<SpriteFrame> frameSet;
     public int loopIndex;
+    // base frame (tiles common to all frames, uploaded once), null if none (see Compiler.baseTiles)
+    public SpriteFrame base;
 
     final int hc;
 
@@ -49,22 +54,88 @@ public class SpriteAnimation extends Resource
 
         // get max number of frame
         final int numFrame = w / wf;
+        List<byte[]> images = new ArrayList<>();
 
+        // get image of each frame
         for (int i = 0; i < numFrame; i++)
+            images.add(ImageUtil.getSubImage(image8bpp, new Dimension(w * 8, h * 8),
+                    new Rectangle((i * wf) * 8, (animIndex * hf) * 8, wf * 8, hf * 8)));
+
+        base = null;
+
+        // extract tiles common to all frames in a base frame
+        if (Compiler.baseTiles && (numFrame > 1))
+        {
+            final boolean[] mask = getStaticTiles(images, wf, hf);
+            final List<byte[]> reduced = new ArrayList<>();
+            boolean ok = false;
+
+            for (boolean b : mask)
+                ok |= b;
+            for (byte[] image : images)
+            {
+                final byte[] r = applyMask(image, wf, hf, mask, false);
+
+                // a frame would be empty without base tiles --> not supported
+                ok &= !isTransparent(r);
+                reduced.add(r);
+            }
+
+            if (ok)
+            {
+                final byte[] baseImage = applyMask(images.get(0), wf, hf, mask, true);
+                final int numBaseSprite = SpriteFrame.getSpriteCells(baseImage, wf, hf, opt, optIteration).size();
+
+                // base sprites are drawn with frame sprites so check we don't exceed VDP sprite limit
+                for (int i = 0; ok && (i < reduced.size()); i++)
+                    ok = (numBaseSprite + SpriteFrame.getSpriteCells(reduced.get(i), wf, hf, opt, optIteration).size()) <= MAX_SPRITE;
+
+                if (ok)
+                {
+                    base = (SpriteFrame) addInternalResource(
+                            new SpriteFrame(id + "_base", baseImage, wf, hf, 0, CollisionType.NONE, compression, opt, optIteration));
+                    images = reduced;
+
+                    System.out.println("Sprite animation '" + id + "' uses " + base.getNumTile() + " base tiles common to all frames");
+                }
+                else
+                    System.out.println("Sprite animation '" + id + "' base tiles not used (more than " + MAX_SPRITE + " VDP sprites per frame)");
+            }
+        }
+
+        buildFrames(images, animIndex, wf, hf, time, collision, compression, opt, optIteration);
+
+        if (frames.size() > 255)
+            throw new IllegalArgumentException(
+                    "Sprite animation '" + id + "' has " + frames.size() + " frames (max = 255)");
+
+        // tiles delta against previous frame (first frame against last one for looping)
+        if (Compiler.tileDelta && (frames.size() > 1))
         {
-            // define frame bounds
-            final Rectangle frameBounds = new Rectangle((i * wf) * 8, (animIndex * hf) * 8, wf * 8, hf * 8);
-            // get image for this frame
-            final byte[] frameImage = ImageUtil.getSubImage(image8bpp, new Dimension(w * 8, h * 8), frameBounds);
+            for (int i = 0; i < frames.size(); i++)
+                frames.get(i).setTileDelta(frames.get((i + frames.size() - 1) % frames.size()));
+        }
+
+        // compute hash code
+        hc = loopIndex ^ frames.hashCode() ^ ((base != null) ? base.hashCode() : 0);
+    }
+
+    // build frames from given images (using current base)
+    private void buildFrames(List<byte[]> images, int animIndex, int wf, int hf, int time, CollisionType collision, Compression compression,
+            OptimizationType opt, long optIteration)
+    {
+        for (int i = 0; i < images.size(); i++)
+        {
+            final byte[] frameImage = images.get(i);
 
             // try to search for duplicated frame first
-            SpriteFrame frame = findExistingSpriteFrame(frameImage, frameBounds.getSize(), time, collision);
+            SpriteFrame frame = findExistingSpriteFrame(frameImage, new Dimension(wf * 8, hf * 8), time, collision);
 
             // not found ? --> define new frame
             if (frame == null)
             {
                 frame = new SpriteFrame(id + "_frame" + i, frameImage, wf, hf, time, collision, compression, opt,
-                        optIteration);
+                        optIteration, base);
             }
             else
             {
@@ -81,13 +152,76 @@ public class SpriteAnimation extends Resource
                 frameSet.add(frame);
             }
         }
+    }
 
-        if (frames.size() > 255)
-            throw new IllegalArgumentException(
-                    "Sprite animation '" + id + "' has " + frames.size() + " frames (max = 255)");
+    static boolean isTransparent(byte[] image)
+    {
+        for (byte b : image)
+            if ((b & 0xF) != 0)
+                return false;
 
-        // compute hash code
-        hc = loopIndex ^ frames.hashCode();
+        return true;
+    }
+
+    static boolean isTileTransparent(byte[] image, int w, int tx, int ty)
+    {
+        for (int y = 0; y < 8; y++)
+            for (int x = 0; x < 8; x++)
+                if ((image[(((ty * 8) + y) * w) + (tx * 8) + x] & 0xF) != 0)
+                    return false;
+
+        return true;
+    }
+
+    static boolean isTileEqual(byte[] image1, byte[] image2, int w, int tx, int ty)
+    {
+        for (int y = 0; y < 8; y++)
+        {
+            final int off = (((ty * 8) + y) * w) + (tx * 8);
+
+            for (int x = 0; x < 8; x++)
+                if (image1[off + x] != image2[off + x])
+                    return false;
+        }
+
+        return true;
+    }
+
+    // tiles (not transparent) identical in all frames
+    static boolean[] getStaticTiles(List<byte[]> images, int wf, int hf)
+    {
+        final boolean[] result = new boolean[wf * hf];
+        final byte[] first = images.get(0);
+
+        for (int ty = 0; ty < hf; ty++)
+        {
+            for (int tx = 0; tx < wf; tx++)
+            {
+                boolean same = !isTileTransparent(first, wf * 8, tx, ty);
+
+                for (int i = 1; same && (i < images.size()); i++)
+                    same = isTileEqual(first, images.get(i), wf * 8, tx, ty);
+
+                result[(ty * wf) + tx] = same;
+            }
+        }
+
+        return result;
+    }
+
+    // keep only tiles in mask (keep = true) or tiles out of mask (keep = false), others are cleared
+    static byte[] applyMask(byte[] image, int wf, int hf, boolean[] mask, boolean keep)
+    {
+        final byte[] result = image.clone();
+        final int w = wf * 8;
+
+        for (int ty = 0; ty < hf; ty++)
+            for (int tx = 0; tx < wf; tx++)
+                if (mask[(ty * wf) + tx] != keep)
+                    for (int y = 0; y < 8; y++)
+                        Arrays.fill(result, (((ty * 8) + y) * w) + (tx * 8), (((ty * 8) + y) * w) + (tx * 8) + 8, (byte) 0);
+
+        return result;
     }
 
     private SpriteFrame findExistingSpriteFrame(byte[] frameImage, Dimension dimension, int time,
@@ -97,7 +231,7 @@ public class SpriteAnimation extends Resource
         {
             final SpriteFrame spriteFrame = (SpriteFrame) res;
 
-            if (checkEqual(spriteFrame, frameImage, dimension, time, collision))
+            if ((spriteFrame.base == base) && checkEqual(spriteFrame, frameImage, dimension, time, collision))
                 return spriteFrame;
         }
 
@@ -131,7 +265,8 @@ public class SpriteAnimation extends Resource
         for (SpriteFrame frame : frames)
             result = Math.max(result, frame.getNumTile());
 
-        return result;
+        // base tiles are always in VRAM
+        return result + ((base != null) ? base.getNumTile() : 0);
     }
 
     public int getMaxNumSprite()
@@ -156,7 +291,7 @@ public class SpriteAnimation extends Resource
         if (obj instanceof SpriteAnimation)
         {
             final SpriteAnimation spriteAnim = (SpriteAnimation) obj;
-            return (loopIndex == spriteAnim.loopIndex) && frames.equals(spriteAnim.frames);
+            return (loopIndex == spriteAnim.loopIndex) && frames.equals(spriteAnim.frames) && (base == spriteAnim.base);
         }
 
         return false;
@@ -169,10 +304,16 @@ public class SpriteAnimation extends Resource
                 + getMaxNumSprite();
     }
 
+    // index of frame following the given one (loop resolved)
+    public int getNextIndex(int index)
+    {
+        return ((index + 1) < frames.size()) ? index + 1 : loopIndex;
+    }
+
     @Override
     public int shallowSize()
     {
-        return (frames.size() * 4) + 1 + 1 + 4;
+        return (frames.size() * 4) + 1 + 1 + 4 + 4 + 4 + (Compiler.animSteps ? frames.size() * 6 : 0);
     }
 
     @Override
@@ -182,6 +323,8 @@ public class SpriteAnimation extends Resource
 
         for (SpriteFrame frame : frameSet)
             result += frame.totalSize();
+        if (base != null)
+            result += base.totalSize();
 
         return result + shallowSize();
     }
@@ -199,12 +342,31 @@ public class SpriteAnimation extends Resource
 
         outS.append("\n");
 
+        // precomputed steps table (frame, duration, next index), contiguous for sequential access
+        if (Compiler.animSteps)
+        {
+            Util.decl(outS, outH, null, id + "_steps", 2, false);
+            for (int i = 0; i < frames.size(); i++)
+            {
+                final SpriteFrame frame = frames.get(i);
+
+                outS.append("    dc.l    " + frame.id + "\n");
+                outS.append("    dc.w    " + (((frame.timer & 0xFF) << 8) | (getNextIndex(i) & 0xFF)) + "\n");
+            }
+
+            outS.append("\n");
+        }
+
         // Animation structure
         Util.decl(outS, outH, "Animation", id, 2, global);
         // set number of frame and loop info
         outS.append("    dc.w    " + ((frames.size() << 8) | ((loopIndex << 0) & 0xFF)) + "\n");
         // set frames pointer
         outS.append("    dc.l    " + id + "_frames\n");
+        // set steps pointer
+        outS.append("    dc.l    " + (Compiler.animSteps ? id + "_steps" : "0") + "\n");
+        // set base tileset pointer
+        outS.append("    dc.l    " + ((base != null) ? base.tileset.id : "0") + "\n");
 
         outS.append("\n");
     }
@@ -2,14 +2,20 @@ package sgdk.rescomp.resource.internal;
 
 import java.awt.Dimension;
 import java.awt.Rectangle;
+import java.io.ByteArrayInputStream;
 import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
 import java.io.IOException;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
 
 import sgdk.rescomp.Resource;
 import sgdk.rescomp.resource.Tileset;
+import sgdk.rescomp.tool.ResCache;
 import sgdk.rescomp.tool.SpriteCutter;
 import sgdk.rescomp.tool.Util;
 import sgdk.rescomp.type.Basics;
@@ -23,11 +29,37 @@ import sgdk.tool.ImageUtil;
 public class SpriteFrame extends Resource
 {
     public static final int DEFAULT_SPRITE_OPTIMIZATION_NUM_ITERATION = 500000;
+    // maximum number of modified tiles run for tiles delta
+    public static final int MAX_DELTA_RUN = 4;
+
+    // sprite cutting results of this session (identical frames shared by several animations / sprites are only
+    // solved once)
+    static final Map<String, byte[]> cutResults = new ConcurrentHashMap<>();
+
+    /**
+     * Returns the <i>optIteration</i> value for a sprite cutting time budget (in ms) instead of a number of iteration
+     */
+    public static long getOptimizationTimeBudget(long ms)
+    {
+        return -Math.max(1L, ms);
+    }
 
     public final List<VDPSprite> vdpSprites;
     public final Collision collision;
+    // per pixel collision mask (MASK collision type), null if none
+    public final CollisionMask mask;
     public final Tileset tileset;
     public final int timer;
+    // frame bounding box (area covered by VDP sprites)
+    public final Rectangle bounds;
+    public final int boundsXFlip;
+    public final int boundsYFlip;
+    // animation base frame (tiles common to all frames of the animation, see SpriteAnimation), null if none
+    public final SpriteFrame base;
+
+    // tiles delta against previous animation frame (see setTileDelta(..))
+    SpriteFrame tileDeltaFrom;
+    List<int[]> tileDeltaRuns;
 
     final int hc;
 
@@ -49,9 +81,21 @@ public class SpriteFrame extends Resource
      */
     public SpriteFrame(String id, byte[] frameImage8bpp, int wf, int hf, int timer, CollisionType collisionType,
             Compression compression, OptimizationType opt, long optIteration)
+    {
+        this(id, frameImage8bpp, wf, hf, timer, collisionType, compression, opt, optIteration, null);
+    }
+
+    /**
+     * @param base
+     *        animation base frame: its VDP sprites are drawn first (using the first tiles of the sprite VRAM area) so
+     *        this frame image should not contain base tiles (null = no base)
+     */
+    public SpriteFrame(String id, byte[] frameImage8bpp, int wf, int hf, int timer, CollisionType collisionType,
+            Compression compression, OptimizationType opt, long optIteration, SpriteFrame base)
     {
         super(id);
 
+        this.base = base;
         vdpSprites = new ArrayList<>();
         this.timer = timer;
         this.collisionType = collisionType;
@@ -60,31 +104,7 @@ public class SpriteFrame extends Resource
         this.fhc = computeFastHashcode(frameImage8bpp, frameDim, timer, collisionType);
 
         // get optimized sprite list from the image frame
-        List<SpriteCell> sprites;
-        final int numTile = wf * hf;
-
-        // not default value ? --> force slow optimization
-        if (optIteration != SpriteFrame.DEFAULT_SPRITE_OPTIMIZATION_NUM_ITERATION)
-            sprites = SpriteCutter.getSlowOptimizedSpriteList(frameImage, frameDim, optIteration, opt);
-        else
-        {
-            // always start with the fast optimization first
-            sprites = SpriteCutter.getFastOptimizedSpriteList(frameImage, frameDim, opt);
-
-            // too many sprites used for this sprite with no optimization ? try sprite opti with fast opti
-            if ((sprites.size() > 16) && (opt == OptimizationType.NONE))
-                sprites = SpriteCutter.getFastOptimizedSpriteList(frameImage, frameDim, OptimizationType.MIN_SPRITE);
-
-            // too many sprites used for this sprite ? prefer better (but slower) sprite optimization
-            if ((sprites.size() > 16) || ((numTile > 64) && (sprites.size() > (numTile / 8))))
-                sprites = SpriteCutter.getSlowOptimizedSpriteList(frameImage, frameDim, optIteration,
-                        (opt == OptimizationType.NONE) ? OptimizationType.BALANCED : opt);
-        }
-
-        // above the limit of internal sprite ? force alternative optimization strategy (minimize the number of sprite)
-        if ((sprites.size() > 16) && (opt != OptimizationType.MIN_SPRITE))
-            sprites = SpriteCutter.getSlowOptimizedSpriteList(frameImage, frameDim, optIteration,
-                    OptimizationType.MIN_SPRITE);
+        final List<SpriteCell> sprites = getSpriteCells(frameImage8bpp, wf, hf, opt, optIteration);
 
         // still above the limit (shouldn't be possible as max sprite size is 128x128) ? --> stop here :-(
         if (sprites.size() > 16)
@@ -96,7 +116,11 @@ public class SpriteFrame extends Resource
         {
             // we can exit now, frame will be discarded anyway
             collision = null;
+            mask = null;
             tileset = null;
+            bounds = new Rectangle();
+            boundsXFlip = 0;
+            boundsYFlip = 0;
             hc = 0;
 
             return;
@@ -115,6 +139,7 @@ public class SpriteFrame extends Resource
                 new Tileset(id + "_tileset", frameImage, wf * 8, hf * 8, sprites, compression));
 
         final Collision coll;
+        CollisionMask cmask = null;
 
         // define collision
         if (collisionType == CollisionType.NONE)
@@ -133,6 +158,14 @@ public class SpriteFrame extends Resource
                     // use 75% the size of the frame for the collision
                     c = new Basics.Circle((wf * 8) / 2, (hf * 8) / 2, ((wf * 8) * 3) / 8);
                     break;
+                case MASK:
+                case MASK_FLIP:
+                    // base sprites are part of the frame
+                    cmask = new CollisionMask(id + "_mask", getFullImage(frameImage8bpp, base),
+                            wf * 8, hf * 8, collisionType == CollisionType.MASK_FLIP);
+                    // box collision covers the mask (used for broadphase)
+                    c = new Basics.Box(cmask.bounds);
+                    break;
 
                 default:
                     break;
@@ -146,13 +179,101 @@ public class SpriteFrame extends Resource
             collision = (Collision) addInternalResource(coll);
         else
             collision = null;
+        if ((cmask != null) && !cmask.isEmpty())
+            mask = (CollisionMask) addInternalResource(cmask);
+        else
+            mask = null;
 
         int ind = 0;
         for (SpriteCell sprite : sprites)
             vdpSprites.add(new VDPSprite(id + "_sprite" + ind++, sprite, wf, hf));
 
+        // compute frame bounding box (used for fast visibility computation)
+        Rectangle b = null;
+        for (SpriteCell sprite : sprites)
+        {
+            if (b == null)
+                b = new Rectangle(sprite);
+            else
+                b = b.union(sprite);
+        }
+        // base sprites are part of the frame
+        if (base != null)
+            b = b.union(base.bounds);
+        bounds = b;
+        // flip versions
+        boundsXFlip = (wf * 8) - (bounds.x + bounds.width);
+        boundsYFlip = (hf * 8) - (bounds.y + bounds.height);
+
         hc = (timer << 16) ^ tileset.hashCode() ^ vdpSprites.hashCode()
-                ^ ((collision != null) ? collision.hashCode() : 0);
+                ^ ((collision != null) ? collision.hashCode() : 0) ^ ((mask != null) ? mask.hashCode() : 0)
+                ^ ((base != null) ? base.hashCode() : 0);
+    }
+
+    // returns the frame image merged with base frame image (opaque base pixels)
+    static byte[] getFullImage(byte[] frameImage8bpp, SpriteFrame base)
+    {
+        if (base == null)
+            return frameImage8bpp;
+
+        final byte[] result = frameImage8bpp.clone();
+        for (int i = 0; i < result.length; i++)
+            if ((result[i] & 0xF) == 0)
+                result[i] = base.frameImage[i];
+
+        return result;
+    }
+
+    /**
+     * Returns optimized VDP sprite cells of the given frame image (sprite cutting results are cached)
+     */
+    public static List<SpriteCell> getSpriteCells(byte[] frameImage, int wf, int hf, OptimizationType opt, long optIteration)
+    {
+        final Dimension frameDim = new Dimension(wf * 8, hf * 8);
+        final int numTile = wf * hf;
+        // sprite cutting is slow so we try the session results then the persistent cache first
+        final String cacheKey = ResCache.getKey("SPRITE_CUT", frameImage, Integer.valueOf(wf),
+                Integer.valueOf(hf), opt, Long.valueOf(optIteration));
+        byte[] cached = cutResults.get(cacheKey);
+        if (cached == null)
+            cached = ResCache.get(cacheKey);
+        List<SpriteCell> sprites = spritesFromCache(cached);
+
+        if (sprites != null)
+            cutResults.putIfAbsent(cacheKey, cached);
+        else
+        {
+            // not default value (iteration count or time budget) ? --> force slow optimization
+            if (optIteration != SpriteFrame.DEFAULT_SPRITE_OPTIMIZATION_NUM_ITERATION)
+                sprites = SpriteCutter.getSlowOptimizedSpriteList(frameImage, frameDim, optIteration, opt);
+            else
+            {
+                // always start with the fast optimization first
+                sprites = SpriteCutter.getFastOptimizedSpriteList(frameImage, frameDim, opt);
+
+                // too many sprites used for this sprite with no optimization ? try sprite opti with fast opti
+                if ((sprites.size() > 16) && (opt == OptimizationType.NONE))
+                    sprites = SpriteCutter.getFastOptimizedSpriteList(frameImage, frameDim, OptimizationType.MIN_SPRITE);
+
+                // too many sprites used for this sprite ? prefer better (but slower) sprite optimization
+                if ((sprites.size() > 16) || ((numTile > 64) && (sprites.size() > (numTile / 8))))
+                    sprites = SpriteCutter.getSlowOptimizedSpriteList(frameImage, frameDim, optIteration,
+                            (opt == OptimizationType.NONE) ? OptimizationType.BALANCED : opt);
+            }
+
+            // above the limit of internal sprite ? force alternative optimization strategy (minimize the number of sprite)
+            if ((sprites.size() > 16) && (opt != OptimizationType.MIN_SPRITE))
+                sprites = SpriteCutter.getSlowOptimizedSpriteList(frameImage, frameDim, optIteration,
+                        OptimizationType.MIN_SPRITE);
+
+            // store result
+            final byte[] data = spritesToCache(sprites);
+            if (data != null)
+                cutResults.put(cacheKey, data);
+            ResCache.put(cacheKey, data);
+        }
+
+        return sprites;
     }
 
     /**
@@ -179,9 +300,122 @@ public class SpriteFrame extends Resource
                 ^ frameDim.hashCode();
     }
 
+    static byte[] spritesToCache(List<SpriteCell> sprites)
+    {
+        final ByteArrayOutputStream result = new ByteArrayOutputStream();
+
+        try (DataOutputStream out = new DataOutputStream(result))
+        {
+            out.writeShort(sprites.size());
+            for (SpriteCell spr : sprites)
+            {
+                out.writeShort(spr.x);
+                out.writeShort(spr.y);
+                out.writeShort(spr.width);
+                out.writeShort(spr.height);
+                out.writeByte(spr.opt.ordinal());
+            }
+        }
+        catch (IOException e)
+        {
+            // not cached
+            return null;
+        }
+
+        return result.toByteArray();
+    }
+
+    static List<SpriteCell> spritesFromCache(byte[] data)
+    {
+        // not cached
+        if ((data == null) || (data == ResCache.NULL_VALUE))
+            return null;
+
+        try (DataInputStream in = new DataInputStream(new ByteArrayInputStream(data)))
+        {
+            final int num = in.readShort();
+            final List<SpriteCell> result = new ArrayList<>(num);
+
+            for (int i = 0; i < num; i++)
+            {
+                final int x = in.readShort();
+                final int y = in.readShort();
+                final int w = in.readShort();
+                final int h = in.readShort();
+
+                result.add(new SpriteCell(x, y, w, h, OptimizationType.values()[in.readByte()]));
+            }
+
+            return result;
+        }
+        catch (Exception e)
+        {
+            // corrupted entry, recompute
+            return null;
+        }
+    }
+
+    /**
+     * Compute modified tiles (runs of [first tile, number of tile]) against the given previous animation frame, only
+     * kept if it's worth it (see MAX_DELTA_RUN). A frame shared by several animations keeps its first delta.
+     */
+    public void setTileDelta(SpriteFrame prev)
+    {
+        if ((tileDeltaFrom != null) || (prev == this) || isEmpty() || prev.isEmpty())
+            return;
+
+        final byte[] cur = tileset.bin.data;
+        final byte[] old = prev.tileset.bin.data;
+        final int numTile = getNumTile();
+        final List<int[]> runs = new ArrayList<>();
+        int changed = 0;
+        int[] run = null;
+
+        for (int t = 0; t < numTile; t++)
+        {
+            final int off = t * 32;
+            boolean same = (off + 32) <= old.length;
+
+            for (int i = 0; same && (i < 32); i++)
+                same = cur[off + i] == old[off + i];
+
+            if (same)
+                run = null;
+            else
+            {
+                changed++;
+
+                // extend current run or start a new one
+                if (run != null)
+                    run[1]++;
+                else
+                {
+                    run = new int[] {t, 1};
+                    runs.add(run);
+                }
+            }
+        }
+
+        // not worth it (each run is a DMA queue entry)
+        if ((runs.size() > MAX_DELTA_RUN) || ((changed * 2) > numTile))
+            return;
+
+        tileDeltaFrom = prev;
+        tileDeltaRuns = runs;
+    }
+
+    // tiles delta is exported only for uncompressed tileset (sprite engine uploads tiles directly from ROM)
+    boolean hasTileDelta()
+    {
+        return (tileDeltaFrom != null) && (tileset.bin.doneCompression == Compression.NONE);
+    }
+
     public int getNumSprite()
     {
-        return isEmpty() ? 0 : vdpSprites.size();
+        if (isEmpty())
+            return 0;
+
+        return vdpSprites.size() + ((base != null) ? base.vdpSprites.size() : 0);
     }
 
     public boolean isEmpty()
@@ -208,7 +442,9 @@ public class SpriteFrame extends Resource
             final SpriteFrame spriteFrame = (SpriteFrame) obj;
             return (timer == spriteFrame.timer) && tileset.equals(spriteFrame.tileset)
                     && vdpSprites.equals(spriteFrame.vdpSprites) && ((collision == spriteFrame.collision)
-                            || ((collision != null) && collision.equals(spriteFrame.collision)));
+                            || ((collision != null) && collision.equals(spriteFrame.collision)))
+                    && ((mask == spriteFrame.mask) || ((mask != null) && mask.equals(spriteFrame.mask)))
+                    && (base == spriteFrame.base);
         }
 
         return false;
@@ -223,7 +459,7 @@ public class SpriteFrame extends Resource
     @Override
     public int shallowSize()
     {
-        return (vdpSprites.size() * 6) + 1 + 1 + 4 + 4;
+        return (getNumSprite() * 6) + 1 + 1 + 4 + 4 + 4 + 4 + 6 + (hasTileDelta() ? (4 + 2 + (tileDeltaRuns.size() * 4)) : 0);
     }
 
     @Override
@@ -232,7 +468,8 @@ public class SpriteFrame extends Resource
         if (isEmpty())
             return shallowSize();
 
-        return tileset.totalSize() + ((collision != null) ? collision.totalSize() : 0) + shallowSize();
+        return tileset.totalSize() + ((collision != null) ? collision.totalSize() : 0)
+                + ((mask != null) ? mask.totalSize() : 0) + shallowSize();
     }
 
     @Override
@@ -241,6 +478,17 @@ public class SpriteFrame extends Resource
         // can't store pointer so we just reset binary stream here (used for compression only)
         outB.reset();
 
+        // TileDelta structure
+        if (hasTileDelta())
+        {
+            Util.decl(outS, outH, "TileDelta", id + "_delta", 2, false);
+            outS.append("    dc.l    " + tileDeltaFrom.tileset.id + "\n");
+            outS.append("    dc.w    " + tileDeltaRuns.size() + "\n");
+            for (int[] run : tileDeltaRuns)
+                outS.append("    dc.w    " + run[0] + ", " + run[1] + "\n");
+            outS.append("\n");
+        }
+
         // AnimationFrame structure
         Util.decl(outS, outH, "AnimationFrame", id, 2, global);
         // number of sprite / timer info
@@ -252,9 +500,29 @@ public class SpriteFrame extends Resource
             outS.append("    dc.l    " + 0 + "\n");
         else
             outS.append("    dc.l    " + collision.id + "\n");
+        // set tiles delta pointer
+        if (hasTileDelta())
+            outS.append("    dc.l    " + id + "_delta\n");
+        else
+            outS.append("    dc.l    " + 0 + "\n");
+        // set collision mask pointer
+        if (mask == null)
+            outS.append("    dc.l    " + 0 + "\n");
+        else
+            outS.append("    dc.l    " + mask.id + "\n");
+        // bounding box (boundsX, boundsXFlip, boundsY, boundsYFlip, boundsW, boundsH)
+        outS.append("    dc.w    " + (((bounds.x & 0xFF) << 8) | ((boundsXFlip << 0) & 0xFF)) + "\n");
+        outS.append("    dc.w    " + (((bounds.y & 0xFF) << 8) | ((boundsYFlip << 0) & 0xFF)) + "\n");
+        outS.append("    dc.w    " + (((bounds.width & 0xFF) << 8) | ((bounds.height << 0) & 0xFF)) + "\n");
 
         // array of VDPSrpite - respect VDP sprite field order: (numTile, offsetY, size, offsetX)
-        for (VDPSprite sprite : vdpSprites)
+        // base sprites first so they use the first tiles of the sprite VRAM area (base tileset)
+        final List<VDPSprite> sprites = new ArrayList<>();
+        if (base != null)
+            sprites.addAll(base.vdpSprites);
+        sprites.addAll(vdpSprites);
+
+        for (VDPSprite sprite : sprites)
         {
             outS.append("    dc.w    " + (((sprite.ht * sprite.wt) << 8) | ((sprite.offsetY << 0) & 0xFF)) + "\n");
             outS.append(
@@ -0,0 +1,151 @@
+package sgdk.rescomp.tool;
+
+import java.util.ArrayList;
+import java.util.Collection;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.BankGroup;
+import sgdk.rescomp.resource.Bin;
+
+/**
+ * FAR BIN data placement in 512 KB banks from BANK_GROUP co-usage groups.<br>
+ * Groups are processed in declaration order and their BIN are packed (biggest first) in 512 KB aligned chunks: a BIN
+ * goes first in a chunk already used by its group, then in any chunk with enough room and only then in a new chunk so
+ * each group uses as few banks as possible (a BIN shared by several groups is placed by the first one).<br>
+ * Packed size is only known on export so the raw size (upper bound) is used.
+ */
+public class BankPlacement
+{
+    public final static int BANK_SIZE = 0x80000;
+
+    public static class Chunk
+    {
+        public final String label;
+        public final List<Bin> bins;
+        public int size;
+
+        public Chunk(String label)
+        {
+            this.label = label;
+            bins = new ArrayList<>();
+            size = 0;
+        }
+
+        boolean fit(int binSize)
+        {
+            return (size + binSize) <= BANK_SIZE;
+        }
+
+        void add(Bin bin, int binSize)
+        {
+            bins.add(bin);
+            size += binSize;
+        }
+    }
+
+    // upper bound of BIN size in a chunk (alignment padding and even size)
+    static int getSize(Bin bin)
+    {
+        final int len = bin.data.length + (bin.data.length & 1);
+        return (bin.align > 1) ? len + (bin.align - 1) : len;
+    }
+
+    /**
+     * Place FAR BIN of given groups in 512 KB chunks.
+     *
+     * @param groups
+     *        bank groups (their <i>banks</i> field is filled with used chunks labels)
+     * @param farBins
+     *        FAR BIN resources which will be exported (others BIN of groups are ignored)
+     * @return chunks (placed BIN have to be removed from regular FAR BIN export)
+     */
+    public static List<Chunk> place(List<BankGroup> groups, Collection<Resource> farBins)
+    {
+        final Set<Resource> exported = new HashSet<>(farBins);
+        final Map<Bin, Chunk> placed = new HashMap<>();
+        final List<Chunk> result = new ArrayList<>();
+
+        for (BankGroup group : groups)
+        {
+            final List<Chunk> used = new ArrayList<>();
+            final List<Bin> bins = new ArrayList<>();
+
+            for (Bin bin : group.getFarBins())
+            {
+                if (!exported.contains(bin))
+                    continue;
+
+                final Chunk chunk = placed.get(bin);
+
+                // already placed by a previous group
+                if (chunk != null)
+                {
+                    if (!used.contains(chunk))
+                        used.add(chunk);
+                }
+                // can't be placed in a single bank, keep it in regular FAR BIN export
+                else if (getSize(bin) <= BANK_SIZE)
+                    bins.add(bin);
+            }
+
+            // biggest first (stable sort so result is deterministic)
+            bins.sort((b1, b2) -> Integer.compare(getSize(b2), getSize(b1)));
+
+            for (Bin bin : bins)
+            {
+                final int size = getSize(bin);
+                Chunk chunk = null;
+
+                // first fit in banks already used by the group
+                for (Chunk c : used)
+                {
+                    if (c.fit(size))
+                    {
+                        chunk = c;
+                        break;
+                    }
+                }
+                // then in any bank
+                if (chunk == null)
+                {
+                    for (Chunk c : result)
+                    {
+                        if (c.fit(size))
+                        {
+                            chunk = c;
+                            break;
+                        }
+                    }
+                }
+                // then in a new bank
+                if (chunk == null)
+                {
+                    chunk = new Chunk(".Lbank_chunk" + result.size());
+                    result.add(chunk);
+                }
+
+                chunk.add(bin, size);
+                placed.put(bin, chunk);
+                if (!used.contains(chunk))
+                    used.add(chunk);
+            }
+
+            group.banks.clear();
+            for (Chunk chunk : used)
+                group.banks.add(chunk.label);
+        }
+
+        // report
+        System.out.println();
+        System.out.println("Bank placement: " + placed.size() + " BIN in " + result.size() + " bank(s)");
+        for (BankGroup group : groups)
+            System.out.println("  '" + group.id + "': " + group.banks.size() + " bank(s)");
+
+        return result;
+    }
+}
@@ -0,0 +1,214 @@
+package sgdk.rescomp.tool;
+
+import java.util.ArrayList;
+import java.util.LinkedHashSet;
+import java.util.List;
+import java.util.Set;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Bin;
+import sgdk.rescomp.type.Basics.Compression;
+
+/**
+ * BIN data export ordering to reduce alignment padding.<br>
+ * Only BIN with a known exported size (not compressed) can be placed: BIN requiring an alignment greater than 2 are
+ * exported first (biggest alignment first, only when no padding is needed) and the gaps before the next aligned BIN
+ * are filled with the biggest small BIN which fit in.<br>
+ * When the absolute placement is known (bank chunk, see BankPlacement) all BIN of known size are placed and they
+ * are kept from crossing a 128 KB DMA boundary whenever another BIN can be used first.
+ */
+public class BinPacker
+{
+    public final static int DMA_BOUNDARY = 0x20000;
+
+    // number of bytes of padding saved (for report)
+    public static int saved = 0;
+
+    static int getSize(Bin bin)
+    {
+        return bin.data.length + (bin.data.length & 1);
+    }
+
+    static int getAlign(Bin bin)
+    {
+        return Math.max(2, bin.align);
+    }
+
+    static int getPadding(int offset, int align)
+    {
+        return (align - (offset % align)) % align;
+    }
+
+    static boolean isCrossing(int offset, int size, int boundary)
+    {
+        return (boundary > 0) && (size <= boundary) && ((offset / boundary) != ((offset + size - 1) / boundary));
+    }
+
+    // padding of the given export order
+    static int getPadding(List<Bin> bins)
+    {
+        int result = 0;
+        int offset = 0;
+
+        for (Bin bin : bins)
+        {
+            final int pad = getPadding(offset, getAlign(bin));
+
+            result += pad;
+            offset += pad + getSize(bin);
+        }
+
+        return result;
+    }
+
+    // biggest bin from <i>bins</i> fitting in <i>gap</i> bytes (and not crossing boundary), null if none
+    static Bin getFiller(List<Bin> bins, int offset, int gap, int boundary)
+    {
+        Bin result = null;
+
+        for (Bin bin : bins)
+        {
+            final int size = getSize(bin);
+
+            if ((size <= gap) && !isCrossing(offset, size, boundary) && ((result == null) || (size > getSize(result))))
+                result = bin;
+        }
+
+        return result;
+    }
+
+    /**
+     * Extract and order BIN of known size from the given export lists (BIN exported at section start).
+     *
+     * @param lists
+     *        BIN export lists of the section (extracted BIN are removed from them)
+     * @param boundary
+     *        DMA boundary when the absolute placement is known (also place all BIN of known size), 0 otherwise
+     * @return BIN to export first in the section (start of the list should be aligned on its first BIN alignment)
+     */
+    public static List<Bin> pack(List<List<Resource>> lists, int boundary)
+    {
+        final Set<Bin> known = new LinkedHashSet<>();
+
+        for (List<Resource> list : lists)
+            for (Resource res : list)
+                if ((res instanceof Bin) && (((Bin) res).wantedCompression == Compression.NONE))
+                    known.add((Bin) res);
+
+        final List<Bin> aligned = new ArrayList<>();
+        final List<Bin> small = new ArrayList<>();
+        for (Bin bin : known)
+        {
+            if (getAlign(bin) > 2)
+                aligned.add(bin);
+            else
+                small.add(bin);
+        }
+
+        final List<Bin> result = new ArrayList<>();
+
+        // nothing to gain
+        if (aligned.isEmpty() && (boundary == 0))
+            return result;
+
+        // original padding (aligned BIN were exported in list order)
+        final List<Bin> original = new ArrayList<>();
+        for (List<Resource> list : lists)
+            for (Resource res : list)
+                if (aligned.contains(res) && !original.contains(res))
+                    original.add((Bin) res);
+
+        // biggest alignment first (stable sort so result is deterministic)
+        aligned.sort((b1, b2) -> Integer.compare(getAlign(b2), getAlign(b1)));
+
+        int offset = 0;
+
+        while (!aligned.isEmpty())
+        {
+            Bin next = null;
+            int gap = Integer.MAX_VALUE;
+
+            // aligned BIN not needing padding
+            for (Bin bin : aligned)
+            {
+                final int pad = getPadding(offset, getAlign(bin));
+
+                if (pad == 0)
+                {
+                    next = bin;
+                    break;
+                }
+
+                gap = Math.min(gap, pad);
+            }
+
+            // fill gap before next aligned BIN
+            if (next == null)
+            {
+                next = getFiller(small, offset, gap, boundary);
+
+                // no filler, take the one needing the less padding
+                if (next == null)
+                {
+                    for (Bin bin : aligned)
+                    {
+                        if (getPadding(offset, getAlign(bin)) == gap)
+                        {
+                            next = bin;
+                            break;
+                        }
+                    }
+                }
+            }
+            // avoid crossing DMA boundary
+            else if (isCrossing(offset, getSize(next), boundary))
+            {
+                // gap before boundary
+                final Bin filler = getFiller(small, offset, boundary - (offset % boundary), boundary);
+
+                if (filler != null)
+                    next = filler;
+            }
+
+            offset += getPadding(offset, getAlign(next)) + getSize(next);
+            aligned.remove(next);
+            small.remove(next);
+            result.add(next);
+        }
+
+        // place remaining BIN of known size (original order) when absolute placement is known
+        if (boundary > 0)
+        {
+            while (!small.isEmpty())
+            {
+                Bin next = small.get(0);
+
+                // avoid crossing DMA boundary
+                if (isCrossing(offset, getSize(next), boundary))
+                {
+                    final Bin filler = getFiller(small, offset, boundary - (offset % boundary), boundary);
+
+                    if (filler != null)
+                        next = filler;
+                }
+
+                offset += getSize(next);
+                small.remove(next);
+                result.add(next);
+            }
+        }
+
+        // remove placed BIN from export lists
+        for (List<Resource> list : lists)
+            list.removeAll(result);
+
+        saved += Math.max(0, getPadding(original) - getPadding(result));
+
+        return result;
+    }
+
+    public static void reset()
+    {
+        saved = 0;
+    }
+}
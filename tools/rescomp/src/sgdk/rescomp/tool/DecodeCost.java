@@ -0,0 +1,192 @@
+package sgdk.rescomp.tool;
+
+import sgdk.rescomp.type.Basics.Compression;
+
+/**
+ * 68000 decoding time estimation of packed data (used by AUTO_FAST compression).<br>
+ * LZ4W and DLZ streams are parsed and each command is counted with the cycles of the SGDK unpacker inner loops
+ * (command decoding + word copies), APLIB is bit oriented so we use a simpler per input / output byte model.<br>
+ * Values are estimations (wait states and unpacker setup aren't counted) to compare codecs against a decode budget.
+ */
+public class DecodeCost
+{
+    // LZ4W: segment decoding (jump table dispatch), literal / match word copy and long match extra word
+    final static int LZ4W_SEGMENT = 64;
+    final static int LZ4W_WORD = 12;
+    final static int LZ4W_LONG_MATCH = 24;
+    // DLZ: command decoding, literal / match word copy and delta word (add + store)
+    final static int DLZ_COMMAND = 56;
+    final static int DLZ_WORD = 12;
+    final static int DLZ_DELTA_WORD = 8;
+    // APLIB: per output byte (literal or copy) and per packed byte (tag bits / gamma codes decoding)
+    final static int APLIB_OUT_BYTE = 28;
+    final static int APLIB_IN_BYTE = 110;
+    // NONE: plain copy (move.l loop)
+    final static int NONE_BYTE = 3;
+
+    // AUTO_FAST budget: maximum decode cycles per unpacked byte and per resource (0 = no limit)
+    public static int maxCyclesPerByte = 20;
+    public static int maxCycles = 0;
+
+    /**
+     * Set AUTO_FAST budget from <i>cyclesPerByte[,maxCycles]</i> string
+     *
+     * @return false if the format is invalid
+     */
+    public static boolean setBudget(String value)
+    {
+        final String[] values = value.split(",");
+
+        if ((values.length < 1) || (values.length > 2))
+            return false;
+
+        try
+        {
+            maxCyclesPerByte = Integer.parseInt(values[0].trim());
+            maxCycles = (values.length > 1) ? Integer.parseInt(values[1].trim()) : 0;
+        }
+        catch (NumberFormatException e)
+        {
+            return false;
+        }
+
+        return (maxCyclesPerByte >= 0) && (maxCycles >= 0);
+    }
+
+    public static void reset()
+    {
+        maxCyclesPerByte = 20;
+        maxCycles = 0;
+    }
+
+    static int readWord(byte[] data, int ind)
+    {
+        return ((data[ind + 0] & 0xFF) << 8) | (data[ind + 1] & 0xFF);
+    }
+
+    /**
+     * Returns estimated 68000 cycles to unpack <i>packed</i> data (<i>size</i> = unpacked size in byte)
+     */
+    public static long getCycles(Compression compression, byte[] packed, int size)
+    {
+        switch (compression)
+        {
+            case LZ4W:
+                return getLZ4WCycles(packed);
+
+            case DLZ:
+                return getDLZCycles(packed);
+
+            case APLIB:
+                return ((long) size * APLIB_OUT_BYTE) + ((long) packed.length * APLIB_IN_BYTE);
+
+            default:
+                return (long) size * NONE_BYTE;
+        }
+    }
+
+    static long getLZ4WCycles(byte[] packed)
+    {
+        long result = 0;
+        int ind = 0;
+
+        while ((ind + 1) < packed.length)
+        {
+            final int seg = readWord(packed, ind);
+            ind += 2;
+
+            final int literalLength = (seg >> 12) & 0xF;
+            int matchLength = (seg >> 8) & 0xF;
+            final int matchOffset = seg & 0xFF;
+
+            // end marker
+            if (seg == 0)
+                break;
+
+            result += LZ4W_SEGMENT + (literalLength * LZ4W_WORD);
+            ind += literalLength * 2;
+
+            // long match (offset field gives length, offset in next word)
+            if (matchLength == 0)
+            {
+                if (matchOffset > 0)
+                {
+                    matchLength = matchOffset + 2;
+                    result += LZ4W_LONG_MATCH;
+                    ind += 2;
+                }
+            }
+            else
+                matchLength++;
+
+            result += matchLength * LZ4W_WORD;
+        }
+
+        return result;
+    }
+
+    static long getDLZCycles(byte[] packed)
+    {
+        final int numWord = ((readWord(packed, 0) << 16) | readWord(packed, 2)) / 2;
+        long result = 0;
+        int ind = 4;
+        int o = 0;
+
+        while ((o < numWord) && ((ind + 1) < packed.length))
+        {
+            final int c = readWord(packed, ind);
+            ind += 2;
+
+            final int n;
+
+            switch (c >> 14)
+            {
+                // literal
+                case 0:
+                    n = (c & 0x3FFF) + 1;
+                    result += n * DLZ_WORD;
+                    ind += n * 2;
+                    break;
+
+                // delta
+                case 1:
+                    n = ((c >> 8) & 0x3F) + 1;
+                    result += n * DLZ_DELTA_WORD;
+                    break;
+
+                // short match
+                case 2:
+                    n = ((c >> 8) & 0x3F) + 2;
+                    result += n * DLZ_WORD;
+                    break;
+
+                // long match
+                default:
+                    n = (c & 0x3FFF) + 2;
+                    result += n * DLZ_WORD;
+                    ind += 2;
+                    break;
+            }
+
+            result += DLZ_COMMAND;
+            o += n;
+        }
+
+        return result;
+    }
+
+    /**
+     * Returns true if unpacking <i>packed</i> data fits in the AUTO_FAST decode budget
+     */
+    public static boolean isInBudget(Compression compression, byte[] packed, int size)
+    {
+        final long cycles = getCycles(compression, packed, size);
+
+        if ((maxCyclesPerByte > 0) && (cycles > ((long) maxCyclesPerByte * size)))
+            return false;
+        if ((maxCycles > 0) && (cycles > maxCycles))
+            return false;
+
+        return true;
+    }
+}
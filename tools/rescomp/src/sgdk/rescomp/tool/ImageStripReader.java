@@ -0,0 +1,375 @@
+package sgdk.rescomp.tool;
+
+import java.io.BufferedInputStream;
+import java.io.Closeable;
+import java.io.DataInputStream;
+import java.io.EOFException;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.util.Arrays;
+import java.util.zip.Inflater;
+import java.util.zip.InflaterInputStream;
+
+import sgdk.tool.FileUtil;
+import sgdk.tool.ImageUtil;
+import sgdk.tool.ImageUtil.BasicImageInfo;
+
+/**
+ * Read a 8bpp image by horizontal strips (top to bottom).<br>
+ * Huge indexed PNG images are decoded on the fly so peak memory is proportional to <i>width x strip height</i>
+ * instead of the whole image, others are fully decoded first (see Util.getImage8bpp(..)).<br>
+ * Rows beyond image height are returned as 0 (transparent) pixels.
+ */
+public class ImageStripReader implements Closeable
+{
+    // images with at least this number of pixel are decoded by strip when possible
+    public static final int STREAMING_MIN_PIXELS = 2048 * 2048;
+
+    final static byte[] PNG_SIGNATURE = {(byte) 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+    public final int w;
+    public final int h;
+    // check for color index in [64..127] range (reserved bit 6) when not null (file name used for error message)
+    public String checkColorIndexFile;
+
+    // fully decoded image (null in streaming mode)
+    final byte[] image;
+    // PNG streaming (null for fully decoded image)
+    final InputStream png;
+    final int bitDepth;
+    final int rowBytes;
+    byte[] prevRow;
+    byte[] curRow;
+
+    // next row to read
+    int row;
+
+    /**
+     * Strip reader on an already decoded 8bpp image.
+     */
+    public ImageStripReader(byte[] image8bpp, int w, int h)
+    {
+        super();
+
+        this.w = w;
+        this.h = h;
+        image = image8bpp;
+        png = null;
+        bitDepth = 8;
+        rowBytes = 0;
+        row = 0;
+    }
+
+    // PNG streaming reader
+    ImageStripReader(InputStream png, int w, int h, int bitDepth)
+    {
+        super();
+
+        this.w = w;
+        this.h = h;
+        image = null;
+        this.png = png;
+        this.bitDepth = bitDepth;
+        rowBytes = ((w * bitDepth) + 7) / 8;
+        prevRow = new byte[rowBytes];
+        curRow = new byte[rowBytes];
+        row = 0;
+    }
+
+    /**
+     * Open the given image file (PNG / BMP), same as Util.getImage8bpp(..) but huge indexed PNG images are decoded by
+     * strip.
+     *
+     * @return <i>null</i> if we couldn't retrieve palette data from RGB image
+     */
+    public static ImageStripReader open(String imgFile, boolean checkTileAligned) throws Exception
+    {
+        // retrieve basic infos about the image
+        final BasicImageInfo imgInfo = ImageUtil.getBasicInfo(imgFile);
+
+        // check size is correct
+        if (checkTileAligned)
+        {
+            if ((imgInfo.w & 7) != 0)
+                throw new IllegalArgumentException("'" + imgFile + "' width is '" + imgInfo.w + ", should be a multiple of 8.");
+            if ((imgInfo.h & 7) != 0)
+                throw new IllegalArgumentException("'" + imgFile + "' height is '" + imgInfo.h + ", should be a multiple of 8.");
+        }
+
+        // huge indexed PNG (not remapped to a shared palette) ? --> try streaming
+        if ((imgInfo.bpp <= 8) && !Util.hasSharedPalette(imgFile) && (((long) imgInfo.w * imgInfo.h) >= STREAMING_MIN_PIXELS)
+                && FileUtil.getFileExtension(imgFile, false).equalsIgnoreCase("png"))
+        {
+            final ImageStripReader result = openPNG(imgFile);
+
+            if (result != null)
+                return result;
+        }
+
+        final byte[] image = Util.getImage8bpp(imgFile, checkTileAligned);
+
+        // happen when we couldn't retrieve palette data from RGB image
+        if (image == null)
+            return null;
+
+        // we determine 'h' from data length and 'w' as we can crop image vertically to remove palette data
+        return new ImageStripReader(image, imgInfo.w, image.length / imgInfo.w);
+    }
+
+    // return null if PNG format isn't supported for streaming (not indexed or interlaced)
+    static ImageStripReader openPNG(String imgFile) throws IOException
+    {
+        final DataInputStream in = new DataInputStream(new BufferedInputStream(new FileInputStream(imgFile), 65536));
+        boolean done = false;
+
+        try
+        {
+            final byte[] sig = new byte[8];
+            in.readFully(sig);
+            if (!Arrays.equals(sig, PNG_SIGNATURE))
+                return null;
+
+            // IHDR is always the first chunk
+            final int len = in.readInt();
+            final int type = in.readInt();
+            if ((type != 0x49484452) || (len != 13))
+                return null;
+
+            final int w = in.readInt();
+            final int h = in.readInt();
+            final int bitDepth = in.readUnsignedByte();
+            final int colorType = in.readUnsignedByte();
+            final int compression = in.readUnsignedByte();
+            final int filter = in.readUnsignedByte();
+            final int interlace = in.readUnsignedByte();
+            // CRC
+            in.readInt();
+
+            // only indexed, not interlaced
+            if ((colorType != 3) || (bitDepth > 8) || (compression != 0) || (filter != 0) || (interlace != 0))
+                return null;
+
+            done = true;
+
+            return new ImageStripReader(new InflaterInputStream(new IDATInputStream(in), new Inflater(), 65536), w, h, bitDepth);
+        }
+        finally
+        {
+            if (!done)
+                in.close();
+        }
+    }
+
+    /**
+     * Read the next <i>numRow</i> rows of the image
+     *
+     * @return 8bpp pixels (width x numRow)
+     */
+    public byte[] read(int numRow) throws IOException
+    {
+        final byte[] result = new byte[w * numRow];
+        // number of available rows
+        final int num = Math.max(0, Math.min(numRow, h - row));
+
+        if (image != null)
+            System.arraycopy(image, row * w, result, 0, num * w);
+        else
+        {
+            for (int j = 0; j < num; j++)
+                readPNGRow(result, j * w);
+        }
+
+        row += numRow;
+
+        // b0-b3 = pixel data; b4-b5 = palette index; b7 = priority bit
+        // check if image try to use bit 6 (probably mean that we have too much colors in our image)
+        if (checkColorIndexFile != null)
+        {
+            for (byte d : result)
+            {
+                // bit 6 used ?
+                if ((d & 0x40) != 0)
+                    throw new IllegalArgumentException("'" + checkColorIndexFile
+                            + "' has color index in [64..127] range, IMAGE resource requires image with a maximum of 64 colors");
+            }
+        }
+
+        return result;
+    }
+
+    private void readPNGRow(byte[] dst, int offset) throws IOException
+    {
+        final int filterType = png.read();
+        if (filterType == -1)
+            throw new EOFException("Unexpected end of PNG data");
+
+        // swap row buffers
+        final byte[] prev = curRow;
+        final byte[] cur = prevRow;
+        prevRow = prev;
+        curRow = cur;
+
+        int n = 0;
+        while (n < rowBytes)
+        {
+            final int read = png.read(cur, n, rowBytes - n);
+            if (read < 0)
+                throw new EOFException("Unexpected end of PNG data");
+            n += read;
+        }
+
+        // unfilter (1 byte per pixel max for indexed images)
+        for (int i = 0; i < rowBytes; i++)
+        {
+            final int a = (i > 0) ? (cur[i - 1] & 0xFF) : 0;
+            final int b = prev[i] & 0xFF;
+            final int c = (i > 0) ? (prev[i - 1] & 0xFF) : 0;
+            final int x = cur[i] & 0xFF;
+
+            switch (filterType)
+            {
+                case 0:
+                    break;
+                case 1:
+                    cur[i] = (byte) (x + a);
+                    break;
+                case 2:
+                    cur[i] = (byte) (x + b);
+                    break;
+                case 3:
+                    cur[i] = (byte) (x + ((a + b) >> 1));
+                    break;
+                case 4:
+                {
+                    final int p = (a + b) - c;
+                    final int pa = Math.abs(p - a);
+                    final int pb = Math.abs(p - b);
+                    final int pc = Math.abs(p - c);
+
+                    if ((pa <= pb) && (pa <= pc))
+                        cur[i] = (byte) (x + a);
+                    else if (pb <= pc)
+                        cur[i] = (byte) (x + b);
+                    else
+                        cur[i] = (byte) (x + c);
+                    break;
+                }
+                default:
+                    throw new IOException("Unsupported PNG filter type: " + filterType);
+            }
+        }
+
+        // convert to 8bpp
+        if (bitDepth == 8)
+            System.arraycopy(cur, 0, dst, offset, w);
+        else
+        {
+            final int pixPerByte = 8 / bitDepth;
+            final int mask = (1 << bitDepth) - 1;
+
+            for (int i = 0; i < w; i++)
+            {
+                final int shift = 8 - (((i % pixPerByte) + 1) * bitDepth);
+                dst[offset + i] = (byte) (((cur[i / pixPerByte] & 0xFF) >> shift) & mask);
+            }
+        }
+    }
+
+    @Override
+    public void close() throws IOException
+    {
+        if (png != null)
+            png.close();
+    }
+
+    // concatenated IDAT chunks data
+    static class IDATInputStream extends InputStream
+    {
+        final DataInputStream in;
+        // remaining bytes in current IDAT chunk (-1 = end of IDAT chunks)
+        int remaining;
+        boolean started;
+
+        IDATInputStream(DataInputStream in)
+        {
+            super();
+
+            this.in = in;
+            remaining = 0;
+            started = false;
+        }
+
+        // go to next IDAT chunk, return false if no more
+        boolean nextChunk() throws IOException
+        {
+            while (remaining == 0)
+            {
+                // CRC of previous IDAT chunk
+                if (started)
+                    in.readInt();
+
+                final int len = in.readInt();
+                final int type = in.readInt();
+
+                // IDAT
+                if (type == 0x49444154)
+                {
+                    started = true;
+                    remaining = len;
+                }
+                // IDAT chunks are consecutive so we're done
+                else if (started)
+                {
+                    remaining = -1;
+                    return false;
+                }
+                // skip chunk data and CRC
+                else
+                {
+                    int skip = len + 4;
+                    while (skip > 0)
+                    {
+                        final int n = in.skipBytes(skip);
+                        if (n <= 0)
+                            throw new EOFException("Unexpected end of PNG data");
+                        skip -= n;
+                    }
+                }
+            }
+
+            return remaining > 0;
+        }
+
+        @Override
+        public int read() throws IOException
+        {
+            if ((remaining < 0) || ((remaining == 0) && !nextChunk()))
+                return -1;
+
+            remaining--;
+            return in.readUnsignedByte();
+        }
+
+        @Override
+        public int read(byte[] b, int off, int len) throws IOException
+        {
+            if (len == 0)
+                return 0;
+            if ((remaining < 0) || ((remaining == 0) && !nextChunk()))
+                return -1;
+
+            final int n = in.read(b, off, Math.min(len, remaining));
+            if (n > 0)
+                remaining -= n;
+
+            return n;
+        }
+
+        @Override
+        public void close() throws IOException
+        {
+            in.close();
+        }
+    }
+}
@@ -0,0 +1,382 @@
+package sgdk.rescomp.tool;
+
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.TreeSet;
+
+import sgdk.rescomp.resource.Palette;
+import sgdk.tool.ImageUtil;
+
+/**
+ * Compute a minimal set of shared 16 colors palettes for a group of images and remap them to it.<br>
+ * Colors are compared in the Mega Drive 9 bits color space: each unit (8x8 tile or whole image) needs all its colors
+ * in a single palette, units are packed into palettes and when they don't fit in the wanted number of palette the
+ * closest colors (weighted by pixel count) are merged until they do.<br>
+ * Color index 0 of each palette is kept for transparency (pixels using index 0 of any palette stay transparent).
+ */
+public class PaletteReducer
+{
+    // usable colors per palette (index 0 is transparent)
+    final static int COLORS_PER_PAL = 15;
+
+    // remapped images (same order than input files)
+    public final List<byte[]> images;
+    // shared palettes (numPalette * 16 entries)
+    public final short[] palette;
+    // number of distinct colors, used palette entries and merged colors
+    public int numColorIn;
+    public int numColorOut;
+    public int numMerged;
+
+    // images data
+    final List<byte[]> sources;
+    final List<short[]> sourcePalettes;
+    final List<Integer> widths;
+    final boolean tileUnit;
+
+    // color --> representative color (merged colors)
+    final Map<Integer, Integer> colorMap;
+    // pixel count per color (used to choose merged color)
+    final Map<Integer, Integer> colorWeight;
+
+    /**
+     * @param files
+     *        input image files
+     * @param numPalette
+     *        maximum number of palette (1-4)
+     * @param tileUnit
+     *        if true each tile can use its own palette (IMAGE, TILESET or MAP resource) otherwise the whole image uses
+     *        a single palette (SPRITE resource)
+     */
+    public PaletteReducer(List<String> files, int numPalette, boolean tileUnit) throws Exception
+    {
+        super();
+
+        this.tileUnit = tileUnit;
+        sources = new ArrayList<>();
+        sourcePalettes = new ArrayList<>();
+        widths = new ArrayList<>();
+        colorMap = new HashMap<>();
+        colorWeight = new HashMap<>();
+
+        for (String file : files)
+        {
+            final byte[] image = Util.getImage8bpp(file, true);
+
+            // happen when we couldn't retrieve palette data from RGB image
+            if (image == null)
+                throw new IllegalArgumentException(
+                        "RGB image '" + file + "' does not contains palette data (see 'Important note about image format' in the rescomp.txt file");
+
+            // image may already be remapped by a previous palette group
+            final short[] pal = Util.getSharedPalette(file);
+
+            sources.add(image);
+            sourcePalettes.add((pal != null) ? pal : Palette.getPaletteData(file));
+            widths.add(Integer.valueOf(ImageUtil.getBasicInfo(file).w));
+        }
+
+        // get color set of each unit
+        final List<TreeSet<Integer>> units = getUnits();
+
+        numColorIn = colorWeight.size();
+        numMerged = 0;
+        for (Integer color : colorWeight.keySet())
+            colorMap.put(color, color);
+
+        List<TreeSet<Integer>> palettes;
+
+        // merge closest colors until units fit in wanted number of palette
+        while ((palettes = pack(units, numPalette)) == null)
+        {
+            if (!mergeClosestColors())
+                throw new IllegalArgumentException("Cannot fit images colors in " + numPalette + " palette(s)");
+        }
+
+        numColorOut = 0;
+        for (TreeSet<Integer> pal : palettes)
+            numColorOut += pal.size();
+
+        // build palette (transparent color from first image)
+        final short transparent = (sourcePalettes.get(0).length > 0) ? sourcePalettes.get(0)[0] : 0;
+        palette = new short[numPalette * 16];
+
+        for (int p = 0; p < numPalette; p++)
+        {
+            int ind = p * 16;
+
+            palette[ind++] = transparent;
+            if (p < palettes.size())
+            {
+                for (Integer color : palettes.get(p))
+                    palette[ind++] = (short) color.intValue();
+            }
+        }
+
+        // remap images
+        images = new ArrayList<>();
+        for (int i = 0; i < sources.size(); i++)
+            images.add(remap(i, palettes));
+    }
+
+    static int getColor(short[] pal, int pixel)
+    {
+        final int ind = pixel & 0x3F;
+        return (ind < pal.length) ? (pal[ind] & 0x0EEE) : 0;
+    }
+
+    static boolean isTransparent(int pixel)
+    {
+        return (pixel & 0xF) == 0;
+    }
+
+    // unit rectangles: [x, y, w, h] of image
+    List<int[]> getUnitRects(int imgIndex)
+    {
+        final List<int[]> result = new ArrayList<>();
+        final int w = widths.get(imgIndex).intValue();
+        final int h = sources.get(imgIndex).length / w;
+
+        if (tileUnit)
+        {
+            for (int y = 0; y < h; y += 8)
+                for (int x = 0; x < w; x += 8)
+                    result.add(new int[] {x, y, 8, 8});
+        }
+        else
+            result.add(new int[] {0, 0, w, h});
+
+        return result;
+    }
+
+    List<TreeSet<Integer>> getUnits()
+    {
+        final List<TreeSet<Integer>> result = new ArrayList<>();
+
+        for (int i = 0; i < sources.size(); i++)
+        {
+            final byte[] image = sources.get(i);
+            final short[] pal = sourcePalettes.get(i);
+            final int w = widths.get(i).intValue();
+
+            for (int[] rect : getUnitRects(i))
+            {
+                final TreeSet<Integer> colors = new TreeSet<>();
+
+                for (int y = rect[1]; y < (rect[1] + rect[3]); y++)
+                {
+                    for (int x = rect[0]; x < (rect[0] + rect[2]); x++)
+                    {
+                        final int pixel = image[(y * w) + x] & 0xFF;
+
+                        if (!isTransparent(pixel))
+                        {
+                            final Integer color = Integer.valueOf(getColor(pal, pixel));
+
+                            colors.add(color);
+                            colorWeight.merge(color, Integer.valueOf(1), Integer::sum);
+                        }
+                    }
+                }
+
+                result.add(colors);
+            }
+        }
+
+        return result;
+    }
+
+    TreeSet<Integer> getMappedColors(TreeSet<Integer> colors)
+    {
+        final TreeSet<Integer> result = new TreeSet<>();
+
+        for (Integer color : colors)
+            result.add(colorMap.get(color));
+
+        return result;
+    }
+
+    // pack unit colors in palettes, returns null if they don't fit
+    List<TreeSet<Integer>> pack(List<TreeSet<Integer>> units, int numPalette)
+    {
+        // distinct color sets (with merged colors)
+        final Map<TreeSet<Integer>, Boolean> distinct = new LinkedHashMap<>();
+        for (TreeSet<Integer> unit : units)
+            distinct.put(getMappedColors(unit), Boolean.TRUE);
+
+        final List<TreeSet<Integer>> sets = new ArrayList<>(distinct.keySet());
+        // biggest first (stable sort so result is deterministic)
+        sets.sort((s1, s2) -> Integer.compare(s2.size(), s1.size()));
+
+        final List<TreeSet<Integer>> result = new ArrayList<>();
+
+        for (TreeSet<Integer> set : sets)
+        {
+            if (set.size() > COLORS_PER_PAL)
+                return null;
+
+            int best = -1;
+            int bestAdded = Integer.MAX_VALUE;
+
+            // find palette requiring the less new colors
+            for (int p = 0; p < result.size(); p++)
+            {
+                final TreeSet<Integer> pal = result.get(p);
+                int added = 0;
+
+                for (Integer color : set)
+                    if (!pal.contains(color))
+                        added++;
+
+                if (((pal.size() + added) <= COLORS_PER_PAL) && (added < bestAdded))
+                {
+                    best = p;
+                    bestAdded = added;
+                }
+            }
+
+            if (best != -1)
+                result.get(best).addAll(set);
+            else
+            {
+                if (result.size() >= numPalette)
+                    return null;
+
+                result.add(new TreeSet<>(set));
+            }
+        }
+
+        return result;
+    }
+
+    static int distance(int c1, int c2)
+    {
+        final int dr = ((c1 >> 1) & 7) - ((c2 >> 1) & 7);
+        final int dg = ((c1 >> 5) & 7) - ((c2 >> 5) & 7);
+        final int db = ((c1 >> 9) & 7) - ((c2 >> 9) & 7);
+
+        return (dr * dr) + (dg * dg) + (db * db);
+    }
+
+    // merge the 2 closest remaining colors (the less used one is replaced), returns false if nothing to merge
+    boolean mergeClosestColors()
+    {
+        final TreeSet<Integer> colors = new TreeSet<>(colorMap.values());
+
+        if (colors.size() < 2)
+            return false;
+
+        final Integer[] c = colors.toArray(new Integer[colors.size()]);
+        int bestDist = Integer.MAX_VALUE;
+        long bestWeight = Long.MAX_VALUE;
+        int best1 = 0;
+        int best2 = 0;
+
+        for (int i = 0; i < c.length; i++)
+        {
+            for (int j = i + 1; j < c.length; j++)
+            {
+                final int dist = distance(c[i].intValue(), c[j].intValue());
+                final long weight = (long) getWeight(c[i]) + getWeight(c[j]);
+
+                // closest colors first then less used
+                if ((dist < bestDist) || ((dist == bestDist) && (weight < bestWeight)))
+                {
+                    bestDist = dist;
+                    bestWeight = weight;
+                    best1 = i;
+                    best2 = j;
+                }
+            }
+        }
+
+        // keep the most used color
+        final Integer keep;
+        final Integer drop;
+        if (getWeight(c[best1]) >= getWeight(c[best2]))
+        {
+            keep = c[best1];
+            drop = c[best2];
+        }
+        else
+        {
+            keep = c[best2];
+            drop = c[best1];
+        }
+
+        for (Map.Entry<Integer, Integer> entry : colorMap.entrySet())
+            if (entry.getValue().equals(drop))
+                entry.setValue(keep);
+
+        colorWeight.put(keep, Integer.valueOf(getWeight(keep) + getWeight(drop)));
+        colorWeight.put(drop, Integer.valueOf(0));
+        numMerged++;
+
+        return true;
+    }
+
+    int getWeight(Integer color)
+    {
+        final Integer result = colorWeight.get(color);
+        return (result != null) ? result.intValue() : 0;
+    }
+
+    byte[] remap(int imgIndex, List<TreeSet<Integer>> palettes)
+    {
+        final byte[] image = sources.get(imgIndex);
+        final short[] pal = sourcePalettes.get(imgIndex);
+        final int w = widths.get(imgIndex).intValue();
+        final byte[] result = new byte[image.length];
+
+        for (int[] rect : getUnitRects(imgIndex))
+        {
+            final TreeSet<Integer> colors = new TreeSet<>();
+
+            for (int y = rect[1]; y < (rect[1] + rect[3]); y++)
+            {
+                for (int x = rect[0]; x < (rect[0] + rect[2]); x++)
+                {
+                    final int pixel = image[(y * w) + x] & 0xFF;
+
+                    if (!isTransparent(pixel))
+                        colors.add(colorMap.get(Integer.valueOf(getColor(pal, pixel))));
+                }
+            }
+
+            // find palette containing all unit colors (always exists after packing)
+            int p = 0;
+            while ((p < (palettes.size() - 1)) && !palettes.get(p).containsAll(colors))
+                p++;
+
+            final List<Integer> palColors = new ArrayList<>(palettes.isEmpty() ? new TreeSet<Integer>() : palettes.get(p));
+
+            for (int y = rect[1]; y < (rect[1] + rect[3]); y++)
+            {
+                for (int x = rect[0]; x < (rect[0] + rect[2]); x++)
+                {
+                    final int off = (y * w) + x;
+                    final int pixel = image[off] & 0xFF;
+                    // keep priority bit
+                    int value = (pixel & 0x80) | (p << 4);
+
+                    if (!isTransparent(pixel))
+                        value |= palColors.indexOf(colorMap.get(Integer.valueOf(getColor(pal, pixel)))) + 1;
+
+                    result[off] = (byte) value;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    @Override
+    public String toString()
+    {
+        return "colors: " + numColorIn + " -> " + (numColorIn - numMerged) + " (" + numColorOut + " palette entries in "
+                + (palette.length / 16) + " palette(s)), " + images.size() + " image(s) remapped";
+    }
+}
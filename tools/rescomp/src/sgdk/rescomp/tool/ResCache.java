@@ -0,0 +1,183 @@
+package sgdk.rescomp.tool;
+
+import java.io.File;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.nio.file.StandardCopyOption;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+
+import sgdk.rescomp.Launcher;
+import sgdk.tool.FileUtil;
+
+/**
+ * Persistent on-disk cache for expensive conversion results (compression, sprite cutting).<br>
+ * Entries are content addressed: the key is a SHA-1 of the tool version, the conversion type, its parameters and its
+ * input data so an entry never needs to be invalidated (removing the cache directory is always safe).
+ */
+public class ResCache
+{
+    // cache format version (increase it when cached data format changes)
+    final static int FORMAT_VERSION = 1;
+
+    // returned by get(..) when cached conversion result is null (failed or not valuable)
+    public final static byte[] NULL_VALUE = new byte[0];
+
+    // cache directory (null = cache disabled)
+    public static String dir = null;
+
+    // identify rescomp binary, computed once
+    static String toolId = null;
+
+    public static boolean isEnabled()
+    {
+        return dir != null;
+    }
+
+    static synchronized String getToolId()
+    {
+        if (toolId == null)
+        {
+            String id = Launcher.VERSION + "_" + FORMAT_VERSION;
+
+            try
+            {
+                // so development builds sharing the same version don't reuse stale entries
+                final File jar = new File(ResCache.class.getProtectionDomain().getCodeSource().getLocation().toURI());
+
+                if (jar.isFile())
+                    id += "_" + jar.length() + "_" + jar.lastModified();
+            }
+            catch (Exception e)
+            {
+                // ignore
+            }
+
+            toolId = id;
+        }
+
+        return toolId;
+    }
+
+    static void update(MessageDigest md, byte[] data)
+    {
+        final int len = data.length;
+
+        // length prefix so consecutive parts can't be confused
+        md.update(new byte[] {(byte) (len >> 24), (byte) (len >> 16), (byte) (len >> 8), (byte) len});
+        md.update(data);
+    }
+
+    /**
+     * Build the cache key for the given conversion type and inputs (byte[] parts are hashed as is, others from
+     * their string representation).
+     */
+    public static String getKey(String type, Object... parts)
+    {
+        try
+        {
+            final MessageDigest md = MessageDigest.getInstance("SHA-1");
+
+            update(md, getToolId().getBytes(StandardCharsets.UTF_8));
+            update(md, type.getBytes(StandardCharsets.UTF_8));
+
+            for (Object part : parts)
+            {
+                if (part instanceof byte[])
+                    update(md, (byte[]) part);
+                else
+                    update(md, String.valueOf(part).getBytes(StandardCharsets.UTF_8));
+            }
+
+            final StringBuilder result = new StringBuilder();
+            for (byte b : md.digest())
+                result.append(String.format("%02x", Integer.valueOf(b & 0xFF)));
+
+            return result.toString();
+        }
+        catch (NoSuchAlgorithmException e)
+        {
+            // SHA-1 is always available
+            throw new RuntimeException(e);
+        }
+    }
+
+    static File getFile(String key)
+    {
+        return new File(FileUtil.adjustPath(dir, key.substring(0, 2) + "/" + key + ".bin"));
+    }
+
+    /**
+     * Returns cached data for the given key, NULL_VALUE if a null result was cached or <i>null</i> if not found (or
+     * cache disabled / null key).
+     */
+    public static byte[] get(String key)
+    {
+        if (!isEnabled() || (key == null))
+            return null;
+
+        final File file = getFile(key);
+
+        if (!file.isFile())
+            return null;
+
+        try
+        {
+            final byte[] data = Files.readAllBytes(file.toPath());
+
+            // first byte tells if result is null
+            if (data.length == 0)
+                return null;
+            if (data[0] == 0)
+                return NULL_VALUE;
+
+            final byte[] result = new byte[data.length - 1];
+            System.arraycopy(data, 1, result, 0, result.length);
+
+            return result;
+        }
+        catch (IOException e)
+        {
+            // cache is a best effort, just recompute the value
+            return null;
+        }
+    }
+
+    /**
+     * Store data for the given key (<i>null</i> or NULL_VALUE to store a null result).
+     */
+    public static void put(String key, byte[] value)
+    {
+        if (!isEnabled() || (key == null))
+            return;
+
+        final File file = getFile(key);
+        final boolean isNull = (value == null) || (value == NULL_VALUE);
+        final byte[] data = new byte[isNull ? 1 : value.length + 1];
+
+        data[0] = (byte) (isNull ? 0 : 1);
+        if (!isNull)
+            System.arraycopy(value, 0, data, 1, value.length);
+
+        File tmp = null;
+
+        try
+        {
+            FileUtil.ensureParentDirExist(file);
+
+            // write to temporary file first so concurrent rescomp instances never read a partial entry
+            tmp = File.createTempFile(key, ".tmp", file.getParentFile());
+
+            Files.write(tmp.toPath(), data);
+            Files.move(tmp.toPath(), file.toPath(), StandardCopyOption.REPLACE_EXISTING,
+                    StandardCopyOption.ATOMIC_MOVE);
+        }
+        catch (IOException e)
+        {
+            // cache is a best effort, ignore
+            if (tmp != null)
+                tmp.delete();
+        }
+    }
+}
@@ -0,0 +1,308 @@
+package sgdk.rescomp.tool;
+
+import java.io.File;
+import java.io.IOException;
+import java.util.Map;
+import java.util.Random;
+import java.util.concurrent.ConcurrentHashMap;
+
+import javax.sound.sampled.AudioFormat;
+import javax.sound.sampled.AudioFormat.Encoding;
+import javax.sound.sampled.AudioInputStream;
+import javax.sound.sampled.AudioSystem;
+import javax.sound.sampled.UnsupportedAudioFileException;
+
+import sgdk.tool.FileUtil;
+import sgdk.tool.NetworkUtil;
+import sgdk.tool.SoundUtil;
+
+/**
+ * WAV to 8 bits signed PCM (or 2ADPCM) conversion.<br>
+ * <i>FAST</i> quality uses the Java sound API conversion and the basic DPCM encoder, <i>GOOD</i> uses a windowed sinc
+ * polyphase resampler and a DPCM encoder minimizing the error on the next sample too, <i>BEST</i> adds TPDF dithering
+ * on the 8 bits quantization.<br>
+ * Results are kept in memory (so they can be computed in parallel before resources are processed) and in the
+ * persistent conversion cache (see ResCache).
+ */
+public class SoundConverter
+{
+    public enum Quality
+    {
+        FAST, GOOD, BEST
+    }
+
+    // polyphase resampler parameters (kernel half width in input samples at unity ratio and number of phases)
+    final static int HALF_TAPS = 16;
+    final static int PHASES = 256;
+    // cutoff frequency relative to the output Nyquist frequency (leave room for the filter transition band)
+    final static double CUTOFF = 0.92d;
+
+    final static Map<String, byte[]> cache = new ConcurrentHashMap<>();
+
+    public static Quality getQuality(String value)
+    {
+        for (Quality q : Quality.values())
+            if (q.name().equalsIgnoreCase(value))
+                return q;
+
+        throw new IllegalArgumentException("Unrecognized WAV quality '" + value + "' (should be FAST, GOOD or BEST)");
+    }
+
+    /**
+     * Convert the given WAV file to 8 bits signed PCM (or 4 bits 2ADPCM when <i>dpcm</i> is set)
+     *
+     * @param rate
+     *        output rate (0 = keep input rate)
+     */
+    public static byte[] convert(String file, int rate, Quality quality, boolean dpcm) throws IOException, UnsupportedAudioFileException
+    {
+        final String memKey = file + "|" + rate + "|" + quality + "|" + dpcm;
+        byte[] result = cache.get(memKey);
+
+        if (result != null)
+            return result;
+
+        // try persistent cache
+        final String cacheKey = ResCache.isEnabled()
+                ? ResCache.getKey("WAV", FileUtil.load(file, false), Integer.valueOf(rate), quality, Boolean.valueOf(dpcm))
+                : null;
+        result = ResCache.get(cacheKey);
+
+        if ((result == null) || (result == ResCache.NULL_VALUE))
+        {
+            if (quality == Quality.FAST)
+            {
+                result = SoundUtil.getRawDataFromWAV(file, 8, rate, true, true, false);
+                if (dpcm)
+                    result = Util.dpcmPack(result);
+            }
+            else
+            {
+                final AudioInputStream audioIn = AudioSystem.getAudioInputStream(new File(file));
+                final float[] samples;
+                final float inRate = audioIn.getFormat().getSampleRate();
+
+                try
+                {
+                    samples = readSamples(audioIn, file);
+                }
+                finally
+                {
+                    audioIn.close();
+                }
+
+                result = toPCM8(resample(samples, inRate, (rate <= 0) ? inRate : rate), quality == Quality.BEST);
+                if (dpcm)
+                    result = dpcmPack(result);
+            }
+
+            ResCache.put(cacheKey, result);
+        }
+
+        cache.put(memKey, result);
+
+        return result;
+    }
+
+    // read samples as mono float [-1..1[
+    static float[] readSamples(AudioInputStream audioIn, String file) throws IOException, UnsupportedAudioFileException
+    {
+        final AudioFormat inFormat = audioIn.getFormat();
+        final int channel = inFormat.getChannels();
+        final AudioFormat format = new AudioFormat(Encoding.PCM_SIGNED, inFormat.getSampleRate(), 16, channel, 2 * channel,
+                inFormat.getSampleRate(), false);
+
+        if (!AudioSystem.isConversionSupported(format, inFormat))
+            throw new UnsupportedAudioFileException("Error: couldn't convert '" + file + "' WAV file.");
+
+        final AudioInputStream in = AudioSystem.getAudioInputStream(format, audioIn);
+        final byte[] data;
+
+        try
+        {
+            data = NetworkUtil.download(in);
+        }
+        finally
+        {
+            in.close();
+        }
+
+        final int len = data.length / (2 * channel);
+        final float[] result = new float[len];
+        int off = 0;
+
+        for (int i = 0; i < len; i++)
+        {
+            int sum = 0;
+
+            // mix down channels
+            for (int c = 0; c < channel; c++)
+            {
+                sum += (short) ((data[off] & 0xFF) | (data[off + 1] << 8));
+                off += 2;
+            }
+
+            result[i] = sum / (32768f * channel);
+        }
+
+        return result;
+    }
+
+    static double sinc(double x)
+    {
+        if (x == 0d)
+            return 1d;
+
+        final double px = Math.PI * x;
+        return Math.sin(px) / px;
+    }
+
+    // Blackman window on [-1..1]
+    static double window(double x)
+    {
+        if (Math.abs(x) >= 1d)
+            return 0d;
+
+        return 0.42d + (0.5d * Math.cos(Math.PI * x)) + (0.08d * Math.cos(2d * Math.PI * x));
+    }
+
+    /**
+     * Windowed sinc polyphase resampler
+     */
+    public static float[] resample(float[] in, double inRate, double outRate)
+    {
+        if ((inRate == outRate) || (in.length == 0))
+            return in;
+
+        final double ratio = outRate / inRate;
+        // cutoff relative to input Nyquist (low pass at output Nyquist when downsampling)
+        final double cutoff = Math.min(1d, ratio) * CUTOFF;
+        // kernel is stretched when downsampling so filter quality stays the same
+        final int halfTaps = (int) Math.ceil(HALF_TAPS / Math.min(1d, ratio));
+        final int taps = halfTaps * 2;
+
+        // build phases table (each phase normalized for unity gain)
+        final float[][] table = new float[PHASES + 1][taps];
+        for (int p = 0; p <= PHASES; p++)
+        {
+            double sum = 0d;
+
+            for (int k = 0; k < taps; k++)
+            {
+                final double t = (k - halfTaps + 1) - ((double) p / PHASES);
+                final double v = cutoff * sinc(cutoff * t) * window(t / halfTaps);
+
+                table[p][k] = (float) v;
+                sum += v;
+            }
+
+            for (int k = 0; k < taps; k++)
+                table[p][k] /= sum;
+        }
+
+        final float[] result = new float[(int) Math.floor(in.length * ratio)];
+
+        for (int i = 0; i < result.length; i++)
+        {
+            final double pos = i / ratio;
+            final int ip = (int) Math.floor(pos);
+            final float[] coefs = table[(int) Math.round((pos - ip) * PHASES)];
+            final int base = (ip - halfTaps) + 1;
+            float sum = 0f;
+
+            for (int k = 0; k < taps; k++)
+            {
+                final int ind = base + k;
+
+                if ((ind >= 0) && (ind < in.length))
+                    sum += in[ind] * coefs[k];
+            }
+
+            result[i] = sum;
+        }
+
+        return result;
+    }
+
+    /**
+     * Quantize to 8 bits signed PCM with optional TPDF dithering (fixed seed so output is deterministic)
+     */
+    public static byte[] toPCM8(float[] in, boolean dither)
+    {
+        final byte[] result = new byte[in.length];
+        final Random random = new Random(0);
+
+        for (int i = 0; i < in.length; i++)
+        {
+            float v = in[i] * 128f;
+
+            if (dither)
+                v += random.nextFloat() - random.nextFloat();
+
+            result[i] = (byte) Math.max(-128, Math.min(127, Math.round(v)));
+        }
+
+        return result;
+    }
+
+    // error of the best delta for next sample from given level
+    static int getNextError(int wanted, int level)
+    {
+        int result = Integer.MAX_VALUE;
+
+        for (int d : Util.delta_tab)
+        {
+            final int l = level + d;
+
+            if ((l >= -128) && (l <= 127))
+                result = Math.min(result, (wanted - l) * (wanted - l));
+        }
+
+        return result;
+    }
+
+    /**
+     * 2ADPCM compression (same format as Util.dpcmPack(..)) choosing each delta so the squared error of current and
+     * next sample is minimal (level never overflows as the Z80 driver doesn't saturate it)
+     */
+    public static byte[] dpcmPack(byte[] input)
+    {
+        final byte[] result = new byte[(input.length / 2) + (input.length & 1)];
+
+        int curLevel = 0;
+
+        for (int off = 0; off < (result.length * 2); off++)
+        {
+            final int wanted = (off < input.length) ? input[off] : 0;
+            final int next = ((off + 1) < input.length) ? input[off + 1] : 0;
+            int best = 8;
+            long bestErr = Long.MAX_VALUE;
+
+            for (int i = 0; i < 16; i++)
+            {
+                final int level = curLevel + Util.delta_tab[i];
+
+                if ((level < -128) || (level > 127))
+                    continue;
+
+                final long err = ((long) (wanted - level) * (wanted - level)) + getNextError(next, level);
+
+                if (err < bestErr)
+                {
+                    bestErr = err;
+                    best = i;
+                }
+            }
+
+            curLevel += Util.delta_tab[best];
+
+            // first nibble in low bits
+            if ((off & 1) == 0)
+                result[off >> 1] = (byte) best;
+            else
+                result[off >> 1] |= (byte) (best << 4);
+        }
+
+        return result;
+    }
+}
@@ -23,6 +23,9 @@ import sgdk.tool.ThreadUtil;
 
 public class SpriteCutter
 {
+    // score penalty per hardware sprite on the busiest scanline (time budget mode only)
+    public static final double SCANLINE_WEIGHT = 4d;
+
     private static List<Solution> getFastOptimizedSolutions(byte[] image8bpp, Dimension imageDim, Rectangle frameBounds,
             OptimizationType optimizationType)
     {
@@ -137,7 +140,9 @@ public class SpriteCutter
      * 
      * @param optIteration
      *        Number of iteration for the genetic algorithm (about 100000 it/s on core i5@2Ghz with
-     *        a 128x96 sprite)
+     *        a 128x96 sprite).<br>
+     *        A negative value means a time budget (in ms) instead, in that case the number of hardware sprite
+     *        per scanline is also minimized (see {@link #SCANLINE_WEIGHT}).
      * @param optimizationType
      *        Indicate if we prefer to minimize the number of Sprite, Tile or a mix of both.
      * @see SpriteCutter#startOptimization(Solution, int)
@@ -150,6 +155,10 @@ public class SpriteCutter
         final List<Solution> baseSolutions = new ArrayList<>();
         final SpriteCutter spriteCutter = new SpriteCutter(image8bpp, imageDim, frameBounds);
 
+        // time budget mode ?
+        if (optIteration < 0)
+            spriteCutter.scanlineWeight = SCANLINE_WEIGHT;
+
         // always add the default solution covering the whole sprite frame
         baseSolutions.add(spriteCutter.getDefaultSolution());
 
@@ -179,7 +188,10 @@ public class SpriteCutter
         }
 
         // start optimization with a base of solution (less or more optimized)
-        spriteCutter.startOptimization(baseSolutions, optIteration);
+        if (optIteration < 0)
+            spriteCutter.startOptimization(baseSolutions, 0L, -optIteration);
+        else
+            spriteCutter.startOptimization(baseSolutions, optIteration);
 
         try
         {
@@ -311,6 +323,10 @@ public class SpriteCutter
                 for (SpriteCell cell : cells)
                     result += cell.getScore();
 
+                // penalize hardware sprites sharing the same scanline (sprite per line limit)
+                if (scanlineWeight > 0d)
+                    result += scanlineWeight * getMaxSpritePerLine();
+
                 // if more than 16 sprites (not allowed) we set a penalty
                 if (cells.size() > 16)
                     result *= 2d;
@@ -321,6 +337,23 @@ public class SpriteCutter
             return cachedScore;
         }
 
+        // maximum number of cells on a single line
+        int getMaxSpritePerLine()
+        {
+            final int[] lines = new int[dim.height];
+            int result = 0;
+
+            for (SpriteCell cell : cells)
+            {
+                final int end = Math.min(dim.height, cell.y + cell.height);
+
+                for (int y = Math.max(0, cell.y); y < end; y++)
+                    result = Math.max(result, ++lines[y]);
+            }
+
+            return result;
+        }
+
         public boolean rebuildFrom(List<SpriteCell> sprCells)
         {
             // rebuild solution and coverage
@@ -779,6 +812,7 @@ public class SpriteCutter
         final int maxBranch;
         final int solutionPoolSize;
         final long maxIteration;
+        final long maxTime;
         final int numWorker;
 
         int curBranchId;
@@ -796,18 +830,21 @@ public class SpriteCutter
          *        input solutions to optimize (should be valid)
          * @param numIteration
          *        maximum number of iteration (0 = no maximum)
+         * @param time
+         *        maximum optimization time in ms (0 = no maximum)
          * @param maxBranch
          *        maximum number of alive branch
          * @param solutionPoolSize
          *        maximum number of solution per branch
          */
-        public SolutionOptimizer(List<Solution> bases, long numIteration, int maxBranch, int solutionPoolSize)
+        public SolutionOptimizer(List<Solution> bases, long numIteration, long time, int maxBranch, int solutionPoolSize)
         {
             super();
 
             this.maxBranch = maxBranch;
             this.solutionPoolSize = solutionPoolSize;
             this.maxIteration = numIteration;
+            this.maxTime = time;
 
             globalBestScore = Double.MAX_VALUE;
             numWorker = SystemUtil.getNumberOfCPUs();
@@ -838,10 +875,12 @@ public class SpriteCutter
          *        input solutions to optimize (should be valid)
          * @param numIteration
          *        maximum number of iteration (0 = no maximum)
+         * @param time
+         *        maximum optimization time in ms (0 = no maximum)
          */
-        public SolutionOptimizer(List<Solution> bases, long numIteration)
+        public SolutionOptimizer(List<Solution> bases, long numIteration, long time)
         {
-            this(bases, numIteration, DEFAULT_MAX_BRANCH, DEFAULT_SOLUTION_POOL_SIZE);
+            this(bases, numIteration, time, DEFAULT_MAX_BRANCH, DEFAULT_SOLUTION_POOL_SIZE);
         }
 
         public byte[] getImage()
@@ -867,6 +906,7 @@ public class SpriteCutter
         @Override
         public void run()
         {
+            final long start = System.currentTimeMillis();
             int maxItMul = 1;
 
             while (!interrupted())
@@ -874,8 +914,9 @@ public class SpriteCutter
                 while (executor.getQueue().size() < (numWorker * 2))
                     addNewTask();
 
-                // reached maximum number of iteration ?
-                if ((maxIteration > 0) && (getIterationCount() >= (maxIteration * maxItMul)))
+                // reached maximum number of iteration or time budget ?
+                if (((maxIteration > 0) && (getIterationCount() >= (maxIteration * maxItMul)))
+                        || ((maxTime > 0) && ((System.currentTimeMillis() - start) >= (maxTime * maxItMul))))
                 {
                     final int numSprite = getBestSolution().cells.size();
 
@@ -1011,6 +1052,8 @@ public class SpriteCutter
 
     SolutionOptimizer optimizer;
     long optimizerStart;
+    // score penalty per sprite on the busiest scanline (0 = disabled)
+    double scanlineWeight;
 
     public SpriteCutter(byte[] image8bpp, Dimension imageDim)
     {
@@ -1020,6 +1063,7 @@ public class SpriteCutter
         dim = imageDim;
         numOpaquePixel = ImageUtil.getOpaquePixelCount(image, dim, new Rectangle(dim));
         optimizer = null;
+        scanlineWeight = 0d;
     }
 
     public SpriteCutter(byte[] image8bpp, Dimension imageDim, Rectangle frameBounds)
@@ -1124,12 +1168,23 @@ public class SpriteCutter
      * @see #getOptimizedSolution()
      */
     public void startOptimization(List<Solution> solutions, long numIteration)
+    {
+        startOptimization(solutions, numIteration, 0L);
+    }
+
+    /**
+     * Same as {@link #startOptimization(List, long)} with a time budget.
+     * 
+     * @param time
+     *        maximum optimization time in ms (0 = no limit)
+     */
+    public void startOptimization(List<Solution> solutions, long numIteration, long time)
     {
         if (optimizer != null)
             optimizer.interrupt();
 
         optimizerStart = System.currentTimeMillis();
-        optimizer = new SolutionOptimizer(solutions, numIteration);
+        optimizer = new SolutionOptimizer(solutions, numIteration, time);
     }
 
     public boolean isOptimizationDone()
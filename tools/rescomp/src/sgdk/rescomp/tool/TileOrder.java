@@ -0,0 +1,140 @@
+package sgdk.rescomp.tool;
+
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Bin;
+import sgdk.rescomp.resource.internal.SpriteFrame;
+
+/**
+ * Sprite frame tilesets export ordering.<br>
+ * Each sprite frame tileset already stores the frame tiles contiguously (a frame change is always a single DMA
+ * transfer) so we only reorder the export of frame tileset BIN data: each frame is followed by the remaining frame
+ * sharing the most tiles with it so LZ4W (which can reference previous data) finds more matches.
+ */
+public class TileOrder
+{
+    final static int TILE_SIZE = 32;
+
+    // number of frame tileset and tiles shared with previous frame tileset before / after ordering (for report)
+    public static int numFrame = 0;
+    public static int sharedBefore = 0;
+    public static int sharedAfter = 0;
+
+    static Set<ByteBuffer> getTiles(Bin bin)
+    {
+        final Set<ByteBuffer> result = new HashSet<>();
+
+        // ByteBuffer equals / hashCode use content
+        for (int off = 0; (off + TILE_SIZE) <= bin.data.length; off += TILE_SIZE)
+            result.add(ByteBuffer.wrap(bin.data, off, TILE_SIZE).slice());
+
+        return result;
+    }
+
+    static int getShared(Set<ByteBuffer> tiles1, Set<ByteBuffer> tiles2)
+    {
+        int result = 0;
+
+        for (ByteBuffer tile : tiles1)
+            if (tiles2.contains(tile))
+                result++;
+
+        return result;
+    }
+
+    /**
+     * Reorder sprite frame tilesets BIN in <i>bins</i> (others BIN keep their position).
+     *
+     * @param frames
+     *        all sprite frames
+     */
+    public static void reorder(List<Resource> bins, List<Resource> frames)
+    {
+        final Set<Bin> frameBins = new HashSet<>();
+        for (Resource res : frames)
+        {
+            final SpriteFrame frame = (SpriteFrame) res;
+
+            if (frame.tileset != null)
+                frameBins.add(frame.tileset.bin);
+        }
+
+        // positions of frame BIN in list
+        final List<Integer> positions = new ArrayList<>();
+        final List<Bin> remaining = new ArrayList<>();
+        final Map<Bin, Set<ByteBuffer>> tiles = new HashMap<>();
+
+        for (int i = 0; i < bins.size(); i++)
+        {
+            final Resource res = bins.get(i);
+
+            if (frameBins.contains(res))
+            {
+                final Bin bin = (Bin) res;
+
+                positions.add(Integer.valueOf(i));
+                remaining.add(bin);
+                tiles.put(bin, getTiles(bin));
+            }
+        }
+
+        int before = 0;
+        for (int i = 1; i < remaining.size(); i++)
+            before += getShared(tiles.get(remaining.get(i)), tiles.get(remaining.get(i - 1)));
+
+        numFrame += remaining.size();
+        sharedBefore += before;
+
+        // nothing to reorder
+        if (remaining.size() < 3)
+        {
+            sharedAfter += before;
+            return;
+        }
+
+        // greedy: take the remaining frame sharing the most tiles with the last one (original order on tie)
+        final List<Bin> ordered = new ArrayList<>();
+        Bin last = remaining.remove(0);
+        ordered.add(last);
+
+        while (!remaining.isEmpty())
+        {
+            final Set<ByteBuffer> lastTiles = tiles.get(last);
+            int best = 0;
+            int bestShared = -1;
+
+            for (int i = 0; i < remaining.size(); i++)
+            {
+                final int shared = getShared(tiles.get(remaining.get(i)), lastTiles);
+
+                if (shared > bestShared)
+                {
+                    best = i;
+                    bestShared = shared;
+                }
+            }
+
+            last = remaining.remove(best);
+            ordered.add(last);
+            sharedAfter += bestShared;
+        }
+
+        // put them back in list at frame BIN positions
+        for (int i = 0; i < ordered.size(); i++)
+            bins.set(positions.get(i).intValue(), ordered.get(i));
+    }
+
+    public static void reset()
+    {
+        numFrame = 0;
+        sharedBefore = 0;
+        sharedAfter = 0;
+    }
+}
@@ -6,8 +6,11 @@ import java.io.IOException;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.List;
+import java.util.Map;
+import java.util.concurrent.ConcurrentHashMap;
 
 import sgdk.aplib.APJ;
+import sgdk.dlz.DLZ;
 import sgdk.lz4w.LZ4W;
 import sgdk.rescomp.type.Basics.CollisionType;
 import sgdk.rescomp.type.Basics.Compression;
@@ -26,6 +29,50 @@ public class Util
 {
     final static String[] formatAsm = {"b", "b", "w", "w", "d"};
 
+    // previous data size used to build LZ4W cache key (LZ4W long match offset is 15 bits in word, we keep a margin)
+    final static int LZ4W_PREV_WINDOW = 0x10000;
+
+    // decoded images cache (key = file + removeRGBPalette flag), filled in parallel by Compiler
+    final static Map<String, byte[]> imageCache = new ConcurrentHashMap<>();
+    // APLIB / DLZ compression results cache (identical input always give identical output), backed by ResCache
+    final static Map<DataKey, byte[]> appackCache = new ConcurrentHashMap<>();
+    final static Map<DataKey, byte[]> appackUltraCache = new ConcurrentHashMap<>();
+    final static Map<DataKey, byte[]> dlzpackCache = new ConcurrentHashMap<>();
+    // images remapped to a shared palette (see PALETTE_GROUP resource) and their palette (key = image file)
+    final static Map<String, byte[]> remappedImages = new ConcurrentHashMap<>();
+    final static Map<String, short[]> sharedPalettes = new ConcurrentHashMap<>();
+
+    // byte array wrapper usable as map key (content comparison)
+    static class DataKey
+    {
+        final byte[] data;
+        final int hc;
+
+        DataKey(byte[] data)
+        {
+            this.data = data;
+            hc = Arrays.hashCode(data);
+        }
+
+        @Override
+        public int hashCode()
+        {
+            return hc;
+        }
+
+        @Override
+        public boolean equals(Object obj)
+        {
+            if (obj instanceof DataKey)
+            {
+                final DataKey key = (DataKey) obj;
+                return (hc == key.hc) && Arrays.equals(data, key.data);
+            }
+
+            return false;
+        }
+    }
+
     public static <T> List<T> asList(T element)
     {
         final List<T> result = new ArrayList<>();
@@ -67,12 +114,18 @@ public class Util
 
         if (StringUtil.equals(upText, "AUTO") || StringUtil.equals(upText, "BEST") || StringUtil.equals(upText, "-1"))
             return Compression.AUTO;
+        if (StringUtil.equals(upText, "AUTO_FAST") || StringUtil.equals(upText, "-2"))
+            return Compression.AUTO_FAST;
         if (StringUtil.isEmpty(upText) || StringUtil.equals(upText, "NONE") || StringUtil.equals(upText, "0"))
             return Compression.NONE;
         if (StringUtil.equals(upText, "APLIB") || StringUtil.equals(upText, "1"))
             return Compression.APLIB;
         if (StringUtil.equals(upText, "LZ4W") || StringUtil.equals(upText, "2") || StringUtil.equals(upText, "FAST"))
             return Compression.LZ4W;
+        if (StringUtil.equals(upText, "DLZ") || StringUtil.equals(upText, "3") || StringUtil.equals(upText, "TILE"))
+            return Compression.DLZ;
+        if (StringUtil.equals(upText, "RLE") || StringUtil.equals(upText, "4"))
+            return Compression.RLE;
 
         throw new IllegalArgumentException("Unrecognized compression: '" + text + "'");
     }
@@ -87,6 +140,10 @@ public class Util
             return CollisionType.BOX;
         if (StringUtil.equals(upText, "CIRCLE"))
             return CollisionType.CIRCLE;
+        if (StringUtil.equals(upText, "MASK"))
+            return CollisionType.MASK;
+        if (StringUtil.equals(upText, "MASK_FLIP"))
+            return CollisionType.MASK_FLIP;
 
         throw new IllegalArgumentException("Unrecognized collision: '" + text + "'");
     }
@@ -149,18 +206,34 @@ public class Util
                 throw new IllegalArgumentException("'" + imgFile + "' height is '" + imgInfo.h + ", should be a multiple of 8.");
         }
 
-        // true color / RGB image ?
-        if (imgInfo.bpp > 8)
+        // remapped to a shared palette ?
+        if (removeRGBPalette && remappedImages.containsKey(imgFile))
+            return remappedImages.get(imgFile).clone();
+
+        final String key = imgFile + (removeRGBPalette ? "|1" : "|0");
+        byte[] result = imageCache.get(key);
+
+        // not yet decoded ?
+        if (result == null)
         {
-            // throw new IllegalArgumentException("'" + imgFile + "' is in " + imgInfo.bpp + " bpp format, only indexed
-            // images (8,4,2,1 bpp) are supported.");
-            return ImageUtil.convertRGBTo8bpp(imgFile, removeRGBPalette);
+            // true color / RGB image ?
+            if (imgInfo.bpp > 8)
+            {
+                // throw new IllegalArgumentException("'" + imgFile + "' is in " + imgInfo.bpp + " bpp format, only indexed
+                // images (8,4,2,1 bpp) are supported.");
+                result = ImageUtil.convertRGBTo8bpp(imgFile, removeRGBPalette);
+            }
+            else
+                // get image data and convert to 8 bpp
+                result = ImageUtil.convertTo8bpp(ImageUtil.getIndexedPixels(imgFile), imgInfo.bpp);
+
+            // don't keep huge images in memory
+            if (result.length < ImageStripReader.STREAMING_MIN_PIXELS)
+                imageCache.put(key, result);
         }
 
-        // get image data
-        final byte[] data = ImageUtil.getIndexedPixels(imgFile);
-        // convert to 8 bpp
-        return ImageUtil.convertTo8bpp(data, imgInfo.bpp);
+        // caller may modify image data so return a copy
+        return result.clone();
 
         // // find max color index, should be done after 8bpp conversion
         // final int maxIndex = ArrayMath.max(data, false);
@@ -175,6 +248,35 @@ public class Util
         return getImage8bpp(imgFile, checkTileAligned, true);
     }
 
+    /**
+     * Use the given remapped 8bpp pixels and shared palette for the image file (see PALETTE_GROUP resource)
+     */
+    public static void setSharedPalette(String imgFile, byte[] image8bpp, short[] palette)
+    {
+        remappedImages.put(imgFile, image8bpp);
+        sharedPalettes.put(imgFile, palette);
+    }
+
+    /**
+     * Returns the shared palette of the image file or <i>null</i> if the image isn't remapped (see PALETTE_GROUP
+     * resource)
+     */
+    public static short[] getSharedPalette(String imgFile)
+    {
+        return sharedPalettes.get(imgFile);
+    }
+
+    public static boolean hasSharedPalette(String imgFile)
+    {
+        return sharedPalettes.containsKey(imgFile);
+    }
+
+    public static void clearSharedPalettes()
+    {
+        remappedImages.clear();
+        sharedPalettes.clear();
+    }
+
     public static byte[] sizeAlign(byte[] data, int align, byte fill)
     {
         // compute alignment
@@ -425,8 +527,8 @@ public class Util
             return new PackedData(data, Compression.NONE);
 
         // we need to have a proper defined compression
-        if (forceSelectedCompression && (compression == Compression.AUTO))
-            throw new IllegalArgumentException("Cannot use AUTO compression !");
+        if (forceSelectedCompression && ((compression == Compression.AUTO) || (compression == Compression.AUTO_FAST)))
+            throw new IllegalArgumentException("Cannot use " + compression + " compression !");
 
         // LZ4W compression with byte size ? do it quickly :)
         if (compression == Compression.LZ4W)
@@ -449,9 +551,10 @@ public class Util
             return new PackedData(result, Compression.LZ4W);
         }
 
-        // we don't count AUTO
-        final byte[][] results = new byte[Compression.values().length - 1][];
-        final int[] sizes = new int[Compression.values().length - 1];
+        // we don't count AUTO and AUTO_FAST
+        final byte[][] results = new byte[Compression.values().length - 2][];
+        final int[] sizes = new int[Compression.values().length - 2];
+        final boolean auto = (compression == Compression.AUTO) || (compression == Compression.AUTO_FAST);
         final byte[] prevData;
 
         // init no compression info
@@ -472,10 +575,11 @@ public class Util
         for (Compression comp : Compression.values())
         {
             // ignore AUTO and NONE
-            if ((comp == Compression.AUTO) || (comp == Compression.NONE))
+            if ((comp == Compression.AUTO) || (comp == Compression.AUTO_FAST) || (comp == Compression.NONE))
                 continue;
 
-            if ((compression == Compression.AUTO) || (compression == comp))
+            // RLE is never selected automatically
+            if ((auto && (comp != Compression.RLE)) || (compression == comp))
             {
                 final int compIndex = comp.ordinal() - 1;
                 byte[] out;
@@ -490,6 +594,14 @@ public class Util
                         out = lz4wpack(prevData, data);
                         break;
 
+                    case DLZ:
+                        out = dlzpack(data);
+                        break;
+
+                    case RLE:
+                        out = rlepack(data);
+                        break;
+
                     default:
                         out = null;
                         break;
@@ -522,11 +634,16 @@ public class Util
         for (Compression comp : Compression.values())
         {
             // ignore AUTO and NONE
-            if ((comp == Compression.AUTO) || (comp == Compression.NONE))
+            if ((comp == Compression.AUTO) || (comp == Compression.AUTO_FAST) || (comp == Compression.NONE))
                 continue;
 
             final int compIndex = comp.ordinal() - 1;
 
+            // AUTO_FAST only accepts compression fitting in decode budget
+            if ((compression == Compression.AUTO_FAST) && (results[compIndex] != null)
+                    && !DecodeCost.isInBudget(comp, results[compIndex], sizes[0]))
+                continue;
+
             if (results[compIndex] != null)
             {
                 if (isCompressionValuable(comp, sizes[compIndex], sizes[0]) && (sizes[compIndex] < minSize))
@@ -548,15 +665,38 @@ public class Util
 
     public static byte[] appack(byte[] data)
     {
+        final DataKey key = new DataKey(data);
+        // ultra level gives different result
+        final Map<DataKey, byte[]> cache = sgdk.rescomp.Compiler.ultraPack ? appackUltraCache : appackCache;
+        byte[] result = cache.get(key);
+
+        // already packed ?
+        if (result != null)
+            return (result == ResCache.NULL_VALUE) ? null : result;
+
+        // try persistent cache
+        final String cacheKey = ResCache.isEnabled() ? ResCache.getKey("APLIB", Boolean.valueOf(sgdk.rescomp.Compiler.ultraPack), data) : null;
+        result = ResCache.get(cacheKey);
+        if (result != null)
+        {
+            cache.put(key, result);
+            return (result == ResCache.NULL_VALUE) ? null : result;
+        }
+
         try
         {
-            return APJ.pack(data, false, true);
+            result = APJ.pack(data, sgdk.rescomp.Compiler.ultraPack, true);
         }
         catch (Exception e)
         {
             System.err.println(e.getMessage());
-            return null;
+            result = null;
         }
+
+        cache.put(key, (result == null) ? ResCache.NULL_VALUE : result);
+        ResCache.put(cacheKey, result);
+
+        return result;
     }
 
     public static boolean appack(String fin, String fout)
@@ -565,7 +705,8 @@ public class Util
         FileUtil.delete(fout, false);
 
         // build complete command line
-        final String[] cmd = new String[] {"java", "-jar", FileUtil.adjustPath(sgdk.rescomp.Compiler.currentDir, "apj.jar"), "p", fin, fout, "-s"};
+        final String[] cmd = new String[] {"java", "-jar", FileUtil.adjustPath(sgdk.rescomp.Compiler.currentDir, "apj.jar"), sgdk.rescomp.Compiler.ultraPack ? "pp" : "p", fin, fout,
+                "-s"};
 
         String cmdLine = "";
         for (String s : cmd)
@@ -589,32 +730,147 @@ public class Util
         return FileUtil.exists(fout);
     }
 
+    /**
+     * Byte RLE packing (see rle_unpack(..) / Z80 unpacker driver): 0 = end, 1-127 = number of literal byte following,
+     * 128-255 = following byte repeated (value - 126) times (2 to 129)
+     */
+    public static byte[] rlepack(byte[] data)
+    {
+        final ByteArrayOutputStream result = new ByteArrayOutputStream();
+        int ind = 0;
+        int litStart = 0;
+
+        while (ind < data.length)
+        {
+            int run = 1;
+            while (((ind + run) < data.length) && (run < 129) && (data[ind + run] == data[ind]))
+                run++;
+
+            if (run >= 2)
+            {
+                rleOutLiterals(result, data, litStart, ind);
+                result.write(run + 126);
+                result.write(data[ind]);
+                ind += run;
+                litStart = ind;
+            }
+            else
+                ind++;
+        }
+
+        rleOutLiterals(result, data, litStart, ind);
+        // end marker
+        result.write(0);
+
+        return result.toByteArray();
+    }
+
+    static void rleOutLiterals(ByteArrayOutputStream out, byte[] data, int start, int end)
+    {
+        int ind = start;
+
+        while (ind < end)
+        {
+            final int n = Math.min(127, end - ind);
+
+            out.write(n);
+            out.write(data, ind, n);
+            ind += n;
+        }
+    }
+
+    public static byte[] dlzpack(byte[] data)
+    {
+        final DataKey key = new DataKey(data);
+        byte[] result = dlzpackCache.get(key);
+
+        // already packed ?
+        if (result != null)
+            return (result == ResCache.NULL_VALUE) ? null : result;
+
+        // try persistent cache
+        final String cacheKey = ResCache.isEnabled() ? ResCache.getKey("DLZ", data) : null;
+        result = ResCache.get(cacheKey);
+        if (result != null)
+        {
+            dlzpackCache.put(key, result);
+            return (result == ResCache.NULL_VALUE) ? null : result;
+        }
+
+        try
+        {
+            result = DLZ.pack(data);
+
+            // verify compression
+            if (!Arrays.equals(DLZ.unpack(result), data))
+            {
+                System.err.println("Error while verifying DLZ compression, result data mismatch input data !");
+                result = null;
+            }
+        }
+        catch (Exception e)
+        {
+            System.err.println(e.getMessage());
+            result = null;
+        }
+
+        dlzpackCache.put(key, (result == null) ? ResCache.NULL_VALUE : result);
+        ResCache.put(cacheKey, result);
+
+        return result;
+    }
+
     public static byte[] lz4wpack(byte[] prev, byte[] data)
     {
         final int prevLen = (prev != null) ? prev.length : 0;
+        String cacheKey = null;
+
+        if (ResCache.isEnabled())
+        {
+            // LZ4W matches can't go further than 32 KB back so only the end of previous data matters
+            final int prevKeyLen = Math.min(prevLen, LZ4W_PREV_WINDOW);
+            final byte[] prevKey = new byte[prevKeyLen];
+
+            if (prevKeyLen > 0)
+                System.arraycopy(prev, prevLen - prevKeyLen, prevKey, 0, prevKeyLen);
+
+            cacheKey = ResCache.getKey("LZ4W", Integer.valueOf(prevLen & 1), Boolean.valueOf(sgdk.rescomp.Compiler.fastPack), prevKey, data);
+
+            final byte[] cached = ResCache.get(cacheKey);
+            if (cached != null)
+                return (cached == ResCache.NULL_VALUE) ? null : cached;
+        }
+
         final byte[] buf = new byte[prevLen + data.length];
 
         if (prev != null)
             System.arraycopy(prev, 0, buf, 0, prevLen);
         System.arraycopy(data, 0, buf, prevLen, data.length);
 
+        byte[] result;
+
         try
         {
             try
             {
-                return LZ4W.pack(buf, prevLen, true);
+                result = LZ4W.pack(buf, prevLen, true, sgdk.rescomp.Compiler.fastPack);
             }
             catch (IllegalArgumentException e1)
             {
                 // try to pack without previous data block then
-                return LZ4W.pack(data, 0, true);
+                result = LZ4W.pack(data, 0, true, sgdk.rescomp.Compiler.fastPack);
             }
         }
         catch (Exception e)
         {
             System.err.println(e.getMessage());
-            return null;
+            result = null;
         }
+
+        if (cacheKey != null)
+            ResCache.put(cacheKey, result);
+
+        return result;
     }
 
     public static boolean lz4wpack(String prev, String fin, String fout)
@@ -623,7 +879,7 @@ public class Util
         FileUtil.delete(fout, false);
 
         // build complete command line
-        final String[] cmd = new String[] {"java", "-jar", FileUtil.adjustPath(sgdk.rescomp.Compiler.currentDir, "lz4w.jar"), "p",
+        final String[] cmd = new String[] {"java", "-jar", FileUtil.adjustPath(sgdk.rescomp.Compiler.currentDir, "lz4w.jar"), sgdk.rescomp.Compiler.fastPack ? "pf" : "p",
                 (!StringUtil.isEmpty(prev) ? prev + "@" : "") + fin, fout, "-s"};
         // final String[] cmd = new String[] {"java", "-jar",
         // FileUtil.adjustPath(sgdk.rescomp.Compiler.currentDir, "lz4w.jar"), "p", fin, fout, "-s"};
@@ -0,0 +1,226 @@
+package sgdk.rescomp.tool;
+
+import java.util.HashSet;
+import java.util.List;
+import java.util.Set;
+
+import sgdk.rescomp.Resource;
+import sgdk.rescomp.resource.Image;
+import sgdk.rescomp.resource.Map;
+import sgdk.rescomp.resource.Sprite;
+import sgdk.rescomp.resource.Tileset;
+import sgdk.rescomp.resource.internal.SpriteAnimation;
+import sgdk.rescomp.resource.internal.SpriteFrame;
+import sgdk.tool.FileUtil;
+
+/**
+ * VRAM budget report: VRAM tiles needed at runtime by each resource, and for sprites the maximum tiles / hardware
+ * sprites per animation frame and the DMA cost (bytes) of a frame change.<br>
+ * Resources exceeding the configured budgets (see {@link #setBudgets(String)}) are reported as warnings.
+ */
+public class VRAMReport
+{
+    final static int TILE_SIZE = 32;
+
+    // report file (null = no report file)
+    public static String file = null;
+
+    // budgets (0 = no limit)
+    public static int maxTile = 0;
+    public static int maxFrameTile = 0;
+    public static int maxFrameBytes = 0;
+    public static int maxFrameSprite = 0;
+
+    // report content
+    static final StringBuilder report = new StringBuilder();
+    static int numWarning = 0;
+
+    public static boolean isEnabled()
+    {
+        return (file != null) || (maxTile > 0) || (maxFrameTile > 0) || (maxFrameBytes > 0) || (maxFrameSprite > 0);
+    }
+
+    /**
+     * Set budgets from a comma separated list of <i>name=value</i> where name is:<br>
+     * <i>tiles</i> = VRAM tiles per resource<br>
+     * <i>frametiles</i> = tiles per sprite animation frame<br>
+     * <i>framebytes</i> = DMA bytes per sprite frame change<br>
+     * <i>sprites</i> = hardware sprites per sprite animation frame
+     *
+     * @return false if the format is invalid
+     */
+    public static boolean setBudgets(String value)
+    {
+        for (String budget : value.split(","))
+        {
+            final String[] kv = budget.trim().split("=");
+
+            if (kv.length != 2)
+                return false;
+
+            final int v;
+
+            try
+            {
+                v = Integer.parseInt(kv[1].trim());
+            }
+            catch (NumberFormatException e)
+            {
+                return false;
+            }
+
+            final String name = kv[0].trim().toLowerCase();
+
+            if (name.equals("tiles"))
+                maxTile = v;
+            else if (name.equals("frametiles"))
+                maxFrameTile = v;
+            else if (name.equals("framebytes"))
+                maxFrameBytes = v;
+            else if (name.equals("sprites"))
+                maxFrameSprite = v;
+            else
+                return false;
+        }
+
+        return true;
+    }
+
+    public static void clear()
+    {
+        report.setLength(0);
+        numWarning = 0;
+    }
+
+    static void checkBudget(String id, String what, int value, int budget)
+    {
+        if ((budget > 0) && (value > budget))
+        {
+            final String warning = "Warning: '" + id + "' " + what + " = " + value + " exceeds budget (" + budget + ")";
+
+            System.out.println(warning);
+            report.append("  ").append(warning).append("\n");
+            numWarning++;
+        }
+    }
+
+    static int getNumTile(Tileset tileset)
+    {
+        return (tileset != null) ? tileset.getNumTile() : 0;
+    }
+
+    /**
+     * Add the given resources (only global TILESET, IMAGE, MAP and SPRITE ones are considered) to the report
+     */
+    public static void add(String fileName, List<Resource> resources)
+    {
+        if (!isEnabled())
+            return;
+
+        report.append(fileName).append(":\n");
+
+        for (Resource res : resources)
+        {
+            if (!res.global)
+                continue;
+
+            if (res instanceof Sprite)
+                addSprite((Sprite) res);
+            else
+            {
+                final int numTile;
+
+                if (res instanceof Tileset)
+                    numTile = getNumTile((Tileset) res);
+                else if (res instanceof Image)
+                    numTile = getNumTile(((Image) res).tileset);
+                else if (res instanceof Map)
+                {
+                    int n = 0;
+                    for (Tileset tileset : ((Map) res).tilesets)
+                        n += getNumTile(tileset);
+                    numTile = n;
+                }
+                else
+                    continue;
+
+                report.append(String.format("  %-32s %-8s VRAM tiles=%d (%d bytes)\n", res.id,
+                        res.getClass().getSimpleName().toUpperCase(), Integer.valueOf(numTile),
+                        Integer.valueOf(numTile * TILE_SIZE)));
+                checkBudget(res.id, "VRAM tiles", numTile, maxTile);
+            }
+        }
+
+        report.append("\n");
+    }
+
+    static void addSprite(Sprite sprite)
+    {
+        // tiles of all distinct frames (VRAM needed when all frames are preloaded)
+        final Set<Tileset> tilesets = new HashSet<>();
+        int allFrameTile = 0;
+
+        for (SpriteAnimation anim : sprite.animations)
+        {
+            for (SpriteFrame frame : anim.frames)
+            {
+                if ((frame.tileset != null) && tilesets.add(frame.tileset))
+                    allFrameTile += frame.getNumTile();
+            }
+        }
+
+        report.append(String.format("  %-32s %-8s VRAM tiles=%d (%d bytes) all frames=%d tiles, max sprites=%d\n",
+                sprite.id, "SPRITE", Integer.valueOf(sprite.maxNumTile), Integer.valueOf(sprite.maxNumTile * TILE_SIZE),
+                Integer.valueOf(allFrameTile), Integer.valueOf(sprite.maxNumSprite)));
+        checkBudget(sprite.id, "VRAM tiles", sprite.maxNumTile, maxTile);
+
+        for (SpriteAnimation anim : sprite.animations)
+        {
+            final int frameTile = anim.getMaxNumTile();
+            // frame change = upload of the new frame tiles
+            final int frameBytes = frameTile * TILE_SIZE;
+            final int frameSprite = anim.getMaxNumSprite();
+
+            report.append(String.format("    %-30s frames=%d max frame tiles=%d, frame change=%d bytes (1 DMA), max sprites=%d\n",
+                    anim.id, Integer.valueOf(anim.frames.size()), Integer.valueOf(frameTile), Integer.valueOf(frameBytes),
+                    Integer.valueOf(frameSprite)));
+            checkBudget(anim.id, "tiles per frame", frameTile, maxFrameTile);
+            checkBudget(anim.id, "bytes per frame change", frameBytes, maxFrameBytes);
+            checkBudget(anim.id, "hardware sprites per frame", frameSprite, maxFrameSprite);
+        }
+    }
+
+    /**
+     * Add sprite frame tilesets ordering result (see TileOrder)
+     */
+    public static void addTileOrder(int numFrame, int sharedBefore, int sharedAfter)
+    {
+        if (!isEnabled())
+            return;
+
+        // frame tiles are always stored contiguously so a frame change is always a single DMA transfer
+        report.append(String.format("  tile ordering: %d frames, DMA transfers per frame change=1 before / 1 after, "
+                + "tiles shared with previous frame=%d before / %d after\n\n", Integer.valueOf(numFrame),
+                Integer.valueOf(sharedBefore), Integer.valueOf(sharedAfter)));
+    }
+
+    /**
+     * Save the report file (if defined)
+     *
+     * @return false if an error occurred while saving the file
+     */
+    public static boolean save()
+    {
+        if (file == null)
+            return true;
+
+        final StringBuilder result = new StringBuilder();
+
+        result.append("VRAM report (").append(numWarning).append(" budget warning(s))\n\n");
+        result.append(report);
+
+        FileUtil.ensureParentDirExist(file);
+
+        return FileUtil.save(file, result.toString().getBytes(), true);
+    }
+}
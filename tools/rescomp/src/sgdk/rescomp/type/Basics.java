@@ -11,7 +11,9 @@ public class Basics
 
     public static enum Compression
     {
-        AUTO, NONE, APLIB, LZ4W
+        // AUTO_FAST (best ratio within decode budget, see DecodeCost) is last so others keep their index
+        // RLE is only used on request (Z80 unpacker friendly, not selected by AUTO)
+        AUTO, NONE, APLIB, LZ4W, DLZ, RLE, AUTO_FAST
     }
 
     public static enum TileOptimization
@@ -40,7 +42,7 @@ public class Basics
 
     public static enum CollisionType
     {
-        NONE, CIRCLE, BOX
+        NONE, CIRCLE, BOX, MASK, MASK_FLIP
     }
 
     public static interface CollisionBase
@@ -13,6 +13,8 @@ public class Metatile
     final int size;
     // contains tile index and attribute for size x size block grid
     final public short[] data;
+    // metatile attribute (collision...), metatiles with different attribute are distinct
+    public int attr;
 
     int hc;
 
@@ -27,12 +29,13 @@ public class Metatile
 
         this.size = size;
         data = new short[size * size];
+        attr = 0;
         hc = 0;
     }
 
     private void computeHashCode()
     {
-        hc = size ^ Arrays.hashCode(data);
+        hc = size ^ Arrays.hashCode(data) ^ (attr << 24);
     }
 
     public void set(int index, short tileattr)
@@ -58,7 +61,7 @@ public class Metatile
         {
             final Metatile mt = (Metatile) obj;
 
-            return (mt.hashCode() == hashCode()) && (mt.size == size) && Arrays.equals(mt.data, data);
+            return (mt.hashCode() == hashCode()) && (mt.size == size) && (mt.attr == attr) && Arrays.equals(mt.data, data);
         }
 
         return super.equals(obj);
@@ -31,6 +31,8 @@ public class TMX
     static final String ID_OBJECTGROUP = "objectgroup";
     static final String ID_OBJECT = "object";
     static final String ID_TEXT = "text";
+    static final String ID_PROPERTIES = "properties";
+    static final String ID_PROPERTY = "property";
 
     static final String ATTR_ID = "id";
     static final String ATTR_NAME = "name";
@@ -50,6 +52,10 @@ public class TMX
     static final String ATTR_TYPE = "type";
     static final String ATTR_X = "x";
     static final String ATTR_Y = "y";
+    static final String ATTR_CLASS = "class";
+    static final String ATTR_VALUE = "value";
+
+    static final String PROPERTY_PARAM = "param";
 
     static final String ATTR_VALUE_ORTHOGONAL = "orthogonal";
     static final String ATTR_VALUE_RIGHT_DOWN = "right-down";
@@ -59,6 +65,7 @@ public class TMX
     static final String SUFFIX_PRIORITY = " priority";
     static final String SUFFIX_LOW_PRIORITY = " low";
     static final String SUFFIX_HIGH_PRIORITY = " high";
+    static final String SUFFIX_ATTRIBUTE = " attr";
 
     static final int TMX_HFLIP = (1 << 31);
     static final int TMX_VFLIP = (1 << 30);
@@ -79,6 +86,73 @@ public class TMX
     // </object>
     // </objectgroup>
 
+    public static class TMXObject
+    {
+        public final String name;
+        public final String type;
+        // position in pixel
+        public final int x;
+        public final int y;
+        // 'param' custom property (0 if not defined)
+        public final int param;
+
+        public TMXObject(String name, String type, int x, int y, int param)
+        {
+            super();
+
+            this.name = name;
+            this.type = type;
+            this.x = x;
+            this.y = y;
+            this.param = param;
+        }
+    }
+
+    /**
+     * Returns objects of the given object layer (objectgroup) from the TMX file
+     */
+    public static List<TMXObject> getObjects(String file, String layerName) throws Exception
+    {
+        if (!FileUtil.exists(file))
+            throw new FileNotFoundException("TMX file '" + file + " not found !");
+
+        final Document doc = XMLUtil.loadDocument(file);
+        final Element mapElement = XMLUtil.getRootElement(doc);
+
+        // check this is the map node
+        if (!mapElement.getNodeName().toLowerCase().equals(ID_MAP))
+            throw new Exception("Expected " + ID_MAP + " root node in TMX file: " + file + ", " + mapElement.getNodeName() + " found.");
+
+        final Element layer = getLayer(XMLUtil.getElements(mapElement, ID_OBJECTGROUP), layerName);
+        if (layer == null)
+            throw new Exception("No object layer '" + layerName + "' found in TMX file: " + file);
+
+        final List<TMXObject> result = new ArrayList<>();
+
+        for (Element objElement : XMLUtil.getElements(layer, ID_OBJECT))
+        {
+            // 'type' renamed to 'class' since Tiled 1.9
+            String type = XMLUtil.getAttributeValue(objElement, ATTR_TYPE, "");
+            if (StringUtil.isEmpty(type))
+                type = XMLUtil.getAttributeValue(objElement, ATTR_CLASS, "");
+
+            int param = 0;
+            final Element properties = XMLUtil.getElement(objElement, ID_PROPERTIES);
+            if (properties != null)
+            {
+                for (Element property : XMLUtil.getElements(properties, ID_PROPERTY))
+                    if (StringUtil.equals(getAttribute(property, ATTR_NAME, ""), PROPERTY_PARAM))
+                        param = StringUtil.parseInt(XMLUtil.getAttributeValue(property, ATTR_VALUE, "0"), 0);
+            }
+
+            result.add(new TMXObject(XMLUtil.getAttributeValue(objElement, ATTR_NAME, ""), type,
+                    (int) Math.floor(XMLUtil.getAttributeDoubleValue(objElement, ATTR_X, 0d)),
+                    (int) Math.floor(XMLUtil.getAttributeDoubleValue(objElement, ATTR_Y, 0d)), param));
+        }
+
+        return result;
+    }
+
     public static class TMXMap
     {
         public final String file;
@@ -89,6 +163,8 @@ public class TMX
         public final List<TSXTileset> tsxTilesets;
         public final List<TSXTileset> usedTilesets;
         public final int[] map;
+        // attribute (collision...) of each tile (null if not defined)
+        public final int[] attributes;
 
         public TMXMap(String file, String layerName) throws Exception
         {
@@ -264,6 +340,8 @@ public class TMX
                 }
             }
 
+            attributes = getAttributes(layers);
+
             // keep trace of tilesets which are really used
             usedTilesets = new ArrayList<>(usedTilesetsSet);
             // sort on startTileIndex
@@ -271,6 +349,63 @@ public class TMX
                 Collections.sort(usedTilesets);
         }
 
+        // get attributes from attribute layer ('attr' tile property or local tile index) or from 'attr' property of map tiles
+        private int[] getAttributes(List<Element> layers) throws Exception
+        {
+            final Element attrLayer = getLayer(layers, layerName + SUFFIX_ATTRIBUTE);
+            // tile index is in low 24 bits for both
+            final int[] data = (attrLayer != null) ? getMapData(attrLayer, w, h, file) : map;
+            final int[] result = new int[data.length];
+            boolean defined = attrLayer != null;
+
+            for (int i = 0; i < data.length; i++)
+            {
+                final int tileInd = data[i] & 0xFFFFFF;
+
+                if (tileInd != 0)
+                {
+                    final TSXTileset tileset = getTSXTilesetFor(tileInd);
+                    int attr = (tileset != null) ? tileset.getTileAttribute(tileInd) : -1;
+
+                    if (attr != -1)
+                        defined = true;
+                    // use local tile index for attribute layer
+                    else if (attrLayer != null)
+                        attr = (tileset != null) ? tileInd - tileset.startTileIndex : 0;
+                    else
+                        attr = 0;
+
+                    if ((attr < 0) || (attr > 255))
+                        throw new Exception("Tile attribute value (" + attr + ") should be in [0..255] range in TMX file: " + file);
+
+                    result[i] = attr;
+                }
+            }
+
+            // no tile with 'attr' property --> no attribute
+            return defined ? result : null;
+        }
+
+        /**
+         * Returns attributes for each 16x16 metatile (attribute of all tiles covering the metatile are OR-ed) or null
+         * if the TMX does not define attributes
+         */
+        public int[] getMetatileAttributes()
+        {
+            if (attributes == null)
+                return null;
+
+            final int mw = ((w * tileSize) + 15) / 16;
+            final int mh = ((h * tileSize) + 15) / 16;
+            final int[] result = new int[mw * mh];
+
+            for (int y = 0; y < (h * tileSize); y += 8)
+                for (int x = 0; x < (w * tileSize); x += 8)
+                    result[((y / 16) * mw) + (x / 16)] |= attributes[((y / tileSize) * w) + (x / tileSize)];
+
+            return result;
+        }
+
         private TSXTileset getTSXTilesetFor(int tileInd)
         {
             for (TSXTileset tileset : tsxTilesets)
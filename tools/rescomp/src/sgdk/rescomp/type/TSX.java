@@ -1,6 +1,8 @@
 package sgdk.rescomp.type;
 
 import java.io.FileNotFoundException;
+import java.util.HashMap;
+import java.util.Map;
 
 import org.w3c.dom.Document;
 import org.w3c.dom.Element;
@@ -18,6 +20,9 @@ public class TSX
 {
     static final String ID_TILESET = "tileset";
     static final String ID_IMAGE = "image";
+    static final String ID_TILE = "tile";
+    static final String ID_PROPERTIES = "properties";
+    static final String ID_PROPERTY = "property";
 
     static final String ATTR_VERSION = "version";
     static final String ATTR_TILEDVERSION = "tiledversion";
@@ -30,11 +35,20 @@ public class TSX
     static final String ATTR_COLUMNS = "columns";
     static final String ATTR_SOURCE = "source";
     static final String ATTR_TRANS = "trans";
+    static final String ATTR_ID = "id";
+    static final String ATTR_VALUE = "value";
+
+    static final String PROPERTY_ATTR = "attr";
 
     // <?xml version="1.0" encoding="UTF-8"?>
     // <tileset version="1.2" tiledversion="2019.02.10" name="Bathing_Spot" tilewidth="16" tileheight="16"
     // tilecount="368" columns="23">
     // <image source="../tileset/Bathing_Spot.png" trans="e00080" width="368" height="256"/>
+    // <tile id="12">
+    // <properties>
+    // <property name="attr" type="int" value="1"/>
+    // </properties>
+    // </tile>
     // </tileset>
 
     public static class TSXTileset implements Comparable<TSXTileset>
@@ -47,6 +61,8 @@ public class TSX
         public int numTile;
         public int transparentColor;
         public String tilesetImagePath;
+        // 'attr' custom property of tiles (local tile index --> attribute)
+        public final Map<Integer, Integer> tileAttributes = new HashMap<>();
 
         public TSXTileset(String tmxFile, int startInd, Element tilesetElement) throws Exception
         {
@@ -107,13 +123,39 @@ public class TSX
             numTile = imageTileWidth * imageTileHeigt;
 
             transparentColor = XMLUtil.getAttributeIntValue(imageElement, ATTR_TRANS, 0);
-            tilesetImagePath = XMLUtil.getAttributeValue(imageElement, ATTR_SOURCE, "");        }
+            tilesetImagePath = XMLUtil.getAttributeValue(imageElement, ATTR_SOURCE, "");
+
+            // get tiles 'attr' property (collision...)
+            for (Element tileElement : XMLUtil.getElements(tilesetElement, ID_TILE))
+            {
+                final Element properties = XMLUtil.getElement(tileElement, ID_PROPERTIES);
+
+                if (properties != null)
+                {
+                    for (Element property : XMLUtil.getElements(properties, ID_PROPERTY))
+                    {
+                        if (StringUtil.equals(getAttribute(property, ATTR_NAME, ""), PROPERTY_ATTR))
+                            tileAttributes.put(Integer.valueOf(XMLUtil.getAttributeIntValue(tileElement, ATTR_ID, 0)),
+                                    Integer.valueOf(StringUtil.parseInt(XMLUtil.getAttributeValue(property, ATTR_VALUE, "0"), 0)));
+                    }
+                }
+            }
+        }
 
         public boolean containsTile(int tileInd)
         {
             return (tileInd >= startTileIndex) && (tileInd < (startTileIndex + numTile));
         }
 
+        /**
+         * Returns the 'attr' property of the given tile (-1 if not defined)
+         */
+        public int getTileAttribute(int tileInd)
+        {
+            final Integer result = tileAttributes.get(Integer.valueOf(tileInd - startTileIndex));
+            return (result != null) ? result.intValue() : -1;
+        }
+
         public String getTilesetPath() throws FileNotFoundException
         {
             return Util.getAdjustedPath(tilesetImagePath, file);
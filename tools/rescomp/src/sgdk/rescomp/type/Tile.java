@@ -253,10 +253,12 @@ public class Tile implements Comparable<Tile>
     public final boolean prio;
     public final boolean empty;
 
-    final int[] hFlip;
-    final int[] vFlip;
-    final int[] hvFlip;
+    // flipped versions, only computed when needed for flip equality test
+    int[] hFlip;
+    int[] vFlip;
+    int[] hvFlip;
 
+    // flip invariant hash code (minimum of the 4 flip versions hash code)
     final int hc;
 
     public Tile(int[] data, int size, int pal, boolean prio, int plain)
@@ -286,11 +288,8 @@ public class Tile implements Comparable<Tile>
         }
         empty = emp;
 
-        hFlip = getFlipped(true, false);
-        vFlip = getFlipped(false, true);
-        hvFlip = getFlipped(true, true);
-
-        hc = getHash(data) + getHash(hFlip) + getHash(vFlip) + getHash(hvFlip);
+        hc = Math.min(Math.min(getFlippedHash(false, false), getFlippedHash(true, false)),
+                Math.min(getFlippedHash(false, true), getFlippedHash(true, true)));
     }
 
     public Tile(byte[] pixel8bpp, int size, int pal, boolean prio, int plain)
@@ -325,6 +324,49 @@ public class Tile implements Comparable<Tile>
         return plain;
     }
 
+    // positional hash of the flipped tile data (computed without building the flipped array)
+    private int getFlippedHash(boolean hflip, boolean vflip)
+    {
+        final int rowSize = (size / 8);
+        int result = 1;
+
+        for (int j = 0; j < size; j++)
+        {
+            final int row = (vflip ? (size - 1) - j : j) * rowSize;
+
+            for (int i = 0; i < rowSize; i++)
+            {
+                if (hflip)
+                    result = (31 * result) + TypeUtil.swapNibble32(data[row + (rowSize - 1) - i]);
+                else
+                    result = (31 * result) + data[row + i];
+            }
+        }
+
+        return result;
+    }
+
+    private int[] getHFlip()
+    {
+        if (hFlip == null)
+            hFlip = getFlipped(true, false);
+        return hFlip;
+    }
+
+    private int[] getVFlip()
+    {
+        if (vFlip == null)
+            vFlip = getFlipped(false, true);
+        return vFlip;
+    }
+
+    private int[] getHVFlip()
+    {
+        if (hvFlip == null)
+            hvFlip = getFlipped(true, true);
+        return hvFlip;
+    }
+
     private int[] getFlipped(boolean hflip, boolean vflip)
     {
         final int[] result = new int[data.length];
@@ -364,34 +406,32 @@ public class Tile implements Comparable<Tile>
 
     public TileEquality getEquality(Tile tile)
     {
+        // hash code is flip invariant so different hash means no equality at all
+        if (tile.hc != hc)
+            return TileEquality.NONE;
+
         // perfect equality
         if (Arrays.equals(tile.data, data))
             return TileEquality.EQUAL;
 
-        // hflip
-        if (Arrays.equals(tile.data, hFlip))
-            return TileEquality.HFLIP;
-        // vflip
-        if (Arrays.equals(tile.data, vFlip))
-            return TileEquality.VFLIP;
-        // hvflip
-        if (Arrays.equals(tile.data, hvFlip))
-            return TileEquality.HVFLIP;
-
-        return TileEquality.NONE;
+        return getFlipEquality(tile);
     }
 
     // only test for flip version here
     public TileEquality getFlipEquality(Tile tile)
     {
+        // hash code is flip invariant so different hash means no flip equality
+        if (tile.hc != hc)
+            return TileEquality.NONE;
+
         // hflip
-        if (Arrays.equals(tile.data, hFlip))
+        if (Arrays.equals(tile.data, getHFlip()))
             return TileEquality.HFLIP;
         // vflip
-        if (Arrays.equals(tile.data, vFlip))
+        if (Arrays.equals(tile.data, getVFlip()))
             return TileEquality.VFLIP;
         // hvflip
-        if (Arrays.equals(tile.data, hvFlip))
+        if (Arrays.equals(tile.data, getHVFlip()))
             return TileEquality.HVFLIP;
 
         return TileEquality.NONE;
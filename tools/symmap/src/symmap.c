@@ -0,0 +1,573 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+
+#define MAX_LINE                4096
+#define MAX_NAME                256
+
+// mapper bank size (bank 0 is never switched)
+#define BANK_SIZE               0x80000
+// boot code marker in md.ld, hot functions are placed right after it
+#define LD_MARKER               "KEEP(*(.text.keepboot))"
+
+// memory type of an input section
+#define TYPE_TEXT               0
+#define TYPE_RODATA             1
+#define TYPE_DATA               2
+#define TYPE_BSS                3
+#define TYPE_NUM                4
+
+
+typedef struct
+{
+    char name[MAX_LINE];
+    unsigned int size[TYPE_NUM];
+} Module;
+
+typedef struct
+{
+    char name[MAX_NAME];
+    char section[MAX_NAME];
+    unsigned int addr;
+    unsigned int end;
+    unsigned int size;
+    int type;
+    int module;
+} Symbol;
+
+typedef struct
+{
+    char name[MAX_NAME];
+    double weight;
+    int order;
+} Hot;
+
+
+static Module* modules;
+static int numModule;
+static Symbol* symbols;
+static int numSymbol;
+static Hot* hots;
+static int numHot;
+
+static const char* typeNames[TYPE_NUM] = { "text", "rodata", "data", "bss" };
+
+
+static void* grow(void* array, int num, size_t elemSize)
+{
+    // grow by power of 2
+    if ((num & (num - 1)) == 0)
+    {
+        array = realloc(array, (num ? (num * 2) : 64) * elemSize);
+        if (!array)
+        {
+            printf("Error: out of memory\n");
+            exit(1);
+        }
+    }
+
+    return array;
+}
+
+static int getModule(const char* name)
+{
+    int i;
+
+    for(i = 0; i < numModule; i++)
+        if (!strcmp(modules[i].name, name)) return i;
+
+    modules = grow(modules, numModule, sizeof(Module));
+    memset(&modules[numModule], 0, sizeof(Module));
+    strcpy(modules[numModule].name, name);
+
+    return numModule++;
+}
+
+static int getType(const char* outSection, const char* inSection)
+{
+    if (!strcmp(outSection, ".text"))
+    {
+        if (!strncmp(inSection, ".rodata", 7) || !strcmp(inSection, ".rodata_bin") || !strcmp(inSection, ".rodata_binf"))
+            return TYPE_RODATA;
+        return TYPE_TEXT;
+    }
+    if (!strcmp(outSection, ".data")) return TYPE_DATA;
+    if (!strcmp(outSection, ".bss") || !strcmp(outSection, ".ramregion")) return TYPE_BSS;
+
+    // debug and discarded sections
+    return -1;
+}
+
+static int isHex(const char* s)
+{
+    if ((s[0] != '0') || (s[1] != 'x')) return 0;
+
+    return isxdigit((unsigned char) s[2]);
+}
+
+static void addSymbol(const char* name, const char* section, unsigned int addr, unsigned int end, int type, int module)
+{
+    Symbol* sym;
+
+    // already added from its section name
+    if (numSymbol && (symbols[numSymbol - 1].addr == addr) && !strcmp(symbols[numSymbol - 1].name, name)) return;
+
+    symbols = grow(symbols, numSymbol, sizeof(Symbol));
+    sym = &symbols[numSymbol++];
+
+    strncpy(sym->name, name, MAX_NAME - 1);
+    sym->name[MAX_NAME - 1] = 0;
+    strncpy(sym->section, section, MAX_NAME - 1);
+    sym->section[MAX_NAME - 1] = 0;
+    sym->addr = addr;
+    sym->end = end;
+    sym->size = 0;
+    sym->type = type;
+    sym->module = module;
+}
+
+// parse GNU ld map file (-Wl,-Map=out/rom.map), returns number of input sections
+static int parseMap(FILE* f)
+{
+    char line[MAX_LINE];
+    char outSection[MAX_NAME];
+    char inSection[MAX_NAME];
+    char pendingSection[MAX_NAME];
+    unsigned int secAddr = 0;
+    unsigned int secEnd = 0;
+    int type = -1;
+    int module = -1;
+    int inMap = 0;
+    int result = 0;
+
+    outSection[0] = 0;
+    inSection[0] = 0;
+    pendingSection[0] = 0;
+
+    while(fgets(line, sizeof(line), f))
+    {
+        char name[MAX_NAME];
+        char s1[MAX_NAME];
+        char s2[MAX_NAME];
+        char mod[MAX_LINE];
+        int n;
+
+        // skip archive / discarded sections / memory configuration parts
+        if (!inMap)
+        {
+            if (!strncmp(line, "Linker script and memory map", 28)) inMap = 1;
+            continue;
+        }
+
+        // output section
+        if (line[0] == '.')
+        {
+            if (sscanf(line, "%255s", outSection) != 1) outSection[0] = 0;
+            pendingSection[0] = 0;
+            module = -1;
+            continue;
+        }
+
+        if (line[0] != ' ') continue;
+
+        // symbol definition
+        n = sscanf(line, " %255s %255s %255s", s1, s2, name);
+        if ((n == 2) && isHex(s1) && !isHex(s2) && (line[1] == ' '))
+        {
+            // symbols defined in input section (linker script symbols are ignored)
+            if ((module != -1) && (type != -1))
+            {
+                const unsigned int addr = strtoul(s1, NULL, 16);
+
+                if ((addr >= secAddr) && (addr < secEnd)) addSymbol(s2, inSection, addr, secEnd, type, module);
+            }
+            continue;
+        }
+
+        // input section (name can be alone on its line when too long)
+        if ((line[1] != ' ') && (line[1] != '*'))
+        {
+            n = sscanf(line, " %255s", name);
+            if (n != 1) continue;
+
+            if (sscanf(line, " %*s %255s %255s %4095[^\r\n]", s1, s2, mod) != 3)
+            {
+                strcpy(pendingSection, name);
+                continue;
+            }
+
+            strcpy(inSection, name);
+        }
+        else if (pendingSection[0] && (sscanf(line, " %255s %255s %4095[^\r\n]", s1, s2, mod) == 3) && isHex(s1))
+        {
+            strcpy(inSection, pendingSection);
+            pendingSection[0] = 0;
+        }
+        else continue;
+
+        pendingSection[0] = 0;
+        if (!isHex(s1) || !isHex(s2)) continue;
+
+        secAddr = strtoul(s1, NULL, 16);
+        secEnd = secAddr + strtoul(s2, NULL, 16);
+        type = getType(outSection, inSection);
+        module = -1;
+
+        if ((type == -1) || (secEnd == secAddr)) continue;
+
+        // "load address" suffix of .data input sections
+        {
+            char* s = strstr(mod, " load address");
+            if (s) *s = 0;
+        }
+
+        module = getModule(mod);
+        modules[module].size[type] += secEnd - secAddr;
+        result++;
+
+        // -ffunction-sections / -fdata-sections: section name gives the symbol (static symbols aren't listed in map)
+        {
+            const char* s = strchr(inSection + 1, '.');
+            if (s && s[1] && !strchr(s + 1, '.')) addSymbol(s + 1, inSection, secAddr, secEnd, type, module);
+        }
+    }
+
+    return result;
+}
+
+static int compareSymbolAddr(const void* a, const void* b)
+{
+    const Symbol* s1 = a;
+    const Symbol* s2 = b;
+
+    if (s1->addr < s2->addr) return -1;
+    if (s1->addr > s2->addr) return 1;
+    return 0;
+}
+
+static int compareSymbolSize(const void* a, const void* b)
+{
+    const Symbol* s1 = a;
+    const Symbol* s2 = b;
+
+    if (s1->size > s2->size) return -1;
+    if (s1->size < s2->size) return 1;
+    return strcmp(s1->name, s2->name);
+}
+
+static unsigned int getModuleROM(const Module* m)
+{
+    return m->size[TYPE_TEXT] + m->size[TYPE_RODATA] + m->size[TYPE_DATA];
+}
+
+static int compareModule(const void* a, const void* b)
+{
+    const unsigned int r1 = getModuleROM(a);
+    const unsigned int r2 = getModuleROM(b);
+
+    if (r1 > r2) return -1;
+    if (r1 < r2) return 1;
+    return strcmp(((const Module*) a)->name, ((const Module*) b)->name);
+}
+
+static int compareHot(const void* a, const void* b)
+{
+    const Hot* h1 = a;
+    const Hot* h2 = b;
+
+    if (h1->weight > h2->weight) return -1;
+    if (h1->weight < h2->weight) return 1;
+    return h1->order - h2->order;
+}
+
+// symbol size = distance to next symbol or to end of its input section
+static void computeSymbolSizes(void)
+{
+    int i;
+
+    qsort(symbols, numSymbol, sizeof(Symbol), compareSymbolAddr);
+
+    for(i = 0; i < numSymbol; i++)
+    {
+        Symbol* sym = &symbols[i];
+        int j = i + 1;
+
+        // aliases share the same address
+        while((j < numSymbol) && (symbols[j].addr == sym->addr)) j++;
+
+        if ((j < numSymbol) && (symbols[j].addr < sym->end)) sym->size = symbols[j].addr - sym->addr;
+        else sym->size = sym->end - sym->addr;
+    }
+}
+
+static const Symbol* findSymbol(const char* name)
+{
+    int i;
+
+    for(i = 0; i < numSymbol; i++)
+        if (!strcmp(symbols[i].name, name)) return &symbols[i];
+
+    return NULL;
+}
+
+// hot function list: one function per line with optional weight (sample / call count) before or after the name
+static int parseHot(FILE* f)
+{
+    char line[MAX_LINE];
+
+    while(fgets(line, sizeof(line), f))
+    {
+        char t1[MAX_NAME];
+        char t2[MAX_NAME];
+        char* end;
+        char* comment = strchr(line, '#');
+        Hot* hot;
+        int n;
+
+        if (comment) *comment = 0;
+
+        n = sscanf(line, " %255s %255s", t1, t2);
+        if (n < 1) continue;
+
+        hots = grow(hots, numHot, sizeof(Hot));
+        hot = &hots[numHot];
+        hot->order = numHot;
+        // no weight --> keep file order
+        hot->weight = 0;
+
+        if (n == 2)
+        {
+            hot->weight = strtod(t1, &end);
+            if (*end == 0) strcpy(hot->name, t2);
+            else
+            {
+                hot->weight = strtod(t2, NULL);
+                strcpy(hot->name, t1);
+            }
+        }
+        else strcpy(hot->name, t1);
+
+        numHot++;
+    }
+
+    qsort(hots, numHot, sizeof(Hot), compareHot);
+
+    return numHot;
+}
+
+static void printReport(int top)
+{
+    unsigned int total[TYPE_NUM];
+    int i, t;
+
+    memset(total, 0, sizeof(total));
+    qsort(modules, numModule, sizeof(Module), compareModule);
+
+    printf("%-40s %8s %8s %8s %8s %8s %8s\n", "module", typeNames[TYPE_TEXT], typeNames[TYPE_RODATA], typeNames[TYPE_DATA],
+           typeNames[TYPE_BSS], "ROM", "RAM");
+
+    for(i = 0; i < numModule; i++)
+    {
+        const Module* m = &modules[i];
+        const char* name = m->name;
+
+        // keep end of long path
+        if (strlen(name) > 40) name += strlen(name) - 40;
+
+        printf("%-40s %8u %8u %8u %8u %8u %8u\n", name, m->size[TYPE_TEXT], m->size[TYPE_RODATA], m->size[TYPE_DATA],
+               m->size[TYPE_BSS], getModuleROM(m), m->size[TYPE_DATA] + m->size[TYPE_BSS]);
+
+        for(t = 0; t < TYPE_NUM; t++) total[t] += m->size[t];
+    }
+
+    printf("%-40s %8u %8u %8u %8u %8u %8u\n\n", "total", total[TYPE_TEXT], total[TYPE_RODATA], total[TYPE_DATA], total[TYPE_BSS],
+           total[TYPE_TEXT] + total[TYPE_RODATA] + total[TYPE_DATA], total[TYPE_DATA] + total[TYPE_BSS]);
+
+    if (top > 0)
+    {
+        Symbol* sorted = malloc(numSymbol * sizeof(Symbol));
+
+        memcpy(sorted, symbols, numSymbol * sizeof(Symbol));
+        qsort(sorted, numSymbol, sizeof(Symbol), compareSymbolSize);
+
+        printf("%d largest symbols:\n", top);
+        for(i = 0; (i < top) && (i < numSymbol); i++)
+            printf("  %08X %8u %-7s %s\n", sorted[i].addr, sorted[i].size, typeNames[sorted[i].type], sorted[i].name);
+        printf("\n");
+
+        free(sorted);
+    }
+}
+
+static void printHotReport(void)
+{
+    unsigned int size = 0;
+    int bankCross = 0;
+    int i;
+
+    printf("Hot functions:\n");
+
+    for(i = 0; i < numHot; i++)
+    {
+        const Symbol* sym = findSymbol(hots[i].name);
+
+        if (!sym)
+        {
+            printf("  %-32s not found\n", hots[i].name);
+            continue;
+        }
+
+        printf("  %-32s %08X %6u  bank %u  %s", sym->name, sym->addr, sym->size, sym->addr / BANK_SIZE, sym->section);
+        // can't be moved alone
+        if (strncmp(sym->section, ".text.", 6) || strcmp(sym->section + 6, sym->name))
+            printf("  (not in its own section, compile with -ffunction-sections)");
+        printf("\n");
+
+        size += sym->size;
+        if (sym->addr >= BANK_SIZE) bankCross++;
+    }
+
+    printf("  %u bytes", size);
+    if (bankCross) printf(", %d function(s) outside fixed bank 0", bankCross);
+    printf("\n\n");
+}
+
+// copy base linker script (md.ld) with hot function sections placed right after boot code
+static int writeLinkerScript(const char* baseFile, const char* outFile)
+{
+    char line[MAX_LINE];
+    FILE* in;
+    FILE* out;
+    int done = 0;
+    int i;
+
+    in = fopen(baseFile, "r");
+    if (!in)
+    {
+        printf("Error: can't open '%s'\n", baseFile);
+        return 0;
+    }
+    out = fopen(outFile, "w");
+    if (!out)
+    {
+        printf("Error: can't create '%s'\n", outFile);
+        fclose(in);
+        return 0;
+    }
+
+    while(fgets(line, sizeof(line), in))
+    {
+        char* marker = done ? NULL : strstr(line, LD_MARKER);
+
+        if (!marker)
+        {
+            fputs(line, out);
+            continue;
+        }
+
+        marker += strlen(LD_MARKER);
+        fwrite(line, 1, marker - line, out);
+        fprintf(out, "\n    /* hot functions (generated by symmap) */\n");
+        for(i = 0; i < numHot; i++)
+            fprintf(out, "    *(.text.%s)\n", hots[i].name);
+        // remaining input sections
+        while(*marker == ' ') marker++;
+        fprintf(out, "    %s", marker);
+
+        done = 1;
+    }
+
+    fclose(in);
+    fclose(out);
+
+    if (!done)
+    {
+        printf("Error: boot code marker '%s' not found in '%s'\n", LD_MARKER, baseFile);
+        return 0;
+    }
+
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    const char* mapFile = NULL;
+    const char* hotFile = NULL;
+    const char* baseFile = NULL;
+    const char* ldFile = NULL;
+    int top = 20;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-top") && ((i + 1) < argc)) top = strtol(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "-hot") && ((i + 1) < argc)) hotFile = argv[++i];
+        else if (!strcmp(argv[i], "-ld") && ((i + 2) < argc))
+        {
+            baseFile = argv[++i];
+            ldFile = argv[++i];
+        }
+        else if (!mapFile) mapFile = argv[i];
+    }
+
+    if (!mapFile)
+    {
+        printf("Symbol map v1.00\n");
+        printf("Report ROM / RAM usage per module from the linker map file and build a hot function link order\n\n");
+        printf("Usage: symmap <map_file> [-top n] [-hot hot_file [-ld base_ld out_ld]]\n");
+        printf("  map_file     GNU ld map file (out/rom.map)\n");
+        printf("  -top n       number of largest symbols to display (default = 20)\n");
+        printf("  -hot file    hot function list, one function per line with optional weight (profiler sample or call count),\n");
+        printf("               functions are sorted on weight (file order when no weight)\n");
+        printf("  -ld in out   copy linker script (md.ld) placing hot functions contiguously right after boot code (fixed bank 0),\n");
+        printf("               use it with LINKER_SCRIPT=out in makefile (sources should be compiled with -ffunction-sections)\n");
+        return 1;
+    }
+
+    f = fopen(mapFile, "r");
+    if (!f)
+    {
+        printf("Error: can't open '%s'\n", mapFile);
+        return 1;
+    }
+
+    if (!parseMap(f))
+    {
+        printf("Error: no memory map found in '%s'\n", mapFile);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+
+    computeSymbolSizes();
+    printReport(top);
+
+    if (hotFile)
+    {
+        f = fopen(hotFile, "r");
+        if (!f)
+        {
+            printf("Error: can't open '%s'\n", hotFile);
+            return 1;
+        }
+        parseHot(f);
+        fclose(f);
+
+        printHotReport();
+
+        if (ldFile)
+        {
+            if (!writeLinkerScript(baseFile, ldFile)) return 1;
+            printf("%d hot function(s) placed in '%s'\n", numHot, ldFile);
+        }
+    }
+
+    free(hots);
+    free(symbols);
+    free(modules);
+
+    return 0;
+}
@@ -0,0 +1,483 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define TRACE_MAGIC             0x53545243
+
+// event types
+#define TRACE_BEGIN             0
+#define TRACE_END               1
+#define TRACE_INSTANT           2
+#define TRACE_EXT               3
+
+// extended events
+#define TRACE_EXT_FRAME         0
+#define TRACE_EXT_VALUE         1
+#define TRACE_EXT_LOST          2
+#define TRACE_EXT_CONFIG        3
+
+// library event ids
+#define TRACE_ID_VINT           16
+#define TRACE_ID_HINT           17
+#define TRACE_ID_SOUND          18
+
+#define MAX_ID                  64
+#define MAX_EVENT               (1024 * 1024)
+
+
+static const char* zoneNames[] =
+{
+    "VBlank",
+    "DMA",
+    "Sprite",
+    "Map",
+    "Joy"
+};
+
+static const char* soundNames[] =
+{
+    "XGM play",
+    "XGM stop",
+    "XGM pause",
+    "XGM resume",
+    "XGM PCM play",
+    "XGM PCM stop"
+};
+
+static char* names[MAX_ID];
+static unsigned int* events;
+static int numEvent;
+
+// video config
+static int pal, h40, v30;
+// V counter value --> scanline(s) (counter can take the same value twice in a frame)
+static int lineOf[256][2];
+static int lineCnt[256];
+static int lines;
+static int vintLine;
+static int hLen;
+static int hPos[256];
+static double lineUs;
+
+static int lastFrame;
+static int frameValid;
+static double lastTime;
+
+// pending event output (so a value event can be attached)
+static char pending[256];
+static int hasPending;
+static int first;
+static FILE* out;
+
+
+static void addEvent(unsigned int e)
+{
+    if (numEvent < MAX_EVENT) events[numEvent++] = e;
+}
+
+static int hexValue(int c)
+{
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    if ((c >= 'A') && (c <= 'F')) return (c - 'A') + 10;
+    if ((c >= 'a') && (c <= 'f')) return (c - 'a') + 10;
+    return -1;
+}
+
+// KDebug log: "#TRC " followed by 8 hex digits per event
+static int parseText(const char* text)
+{
+    const char* s = text;
+    int found = 0;
+
+    while((s = strstr(s, "#TRC ")) != NULL)
+    {
+        s += 5;
+        found = 1;
+
+        for(;;)
+        {
+            unsigned int e = 0;
+            int i;
+
+            for(i = 0; i < 8; i++)
+            {
+                const int v = hexValue(s[i]);
+
+                if (v < 0) break;
+                e = (e << 4) | v;
+            }
+
+            if (i < 8) break;
+
+            addEvent(e);
+            s += 8;
+        }
+    }
+
+    return found;
+}
+
+static unsigned int getU16(const unsigned char* p, int swap)
+{
+    if (swap) return (p[1] << 8) | p[0];
+    return (p[0] << 8) | p[1];
+}
+
+static unsigned int getU32(const unsigned char* p, int swap)
+{
+    return (getU16(p, swap) << 16) | getU16(p + 2, swap);
+}
+
+// RAM dump: find TraceBuffer header (some emulators save RAM with byte swapped words)
+static int parseRAM(const unsigned char* data, long dataSize)
+{
+    long i;
+    int swap;
+
+    for(swap = 0; swap < 2; swap++)
+    {
+        for(i = 0; (i + 8) <= dataSize; i += 2)
+        {
+            unsigned int size, pos, start, n;
+
+            if (getU32(data + i, swap) != TRACE_MAGIC) continue;
+
+            size = getU16(data + i + 4, swap);
+            pos = getU16(data + i + 6, swap);
+
+            // not a valid header
+            if ((size == 0) || (size & (size - 1)) || ((i + 8 + (size * 4)) > dataSize)) continue;
+
+            // ring buffer wrapped ? (write position is a 16 bits counter)
+            if (pos > size)
+            {
+                start = pos - size;
+                n = size;
+            }
+            else
+            {
+                start = 0;
+                n = pos;
+            }
+
+            while(n--)
+            {
+                addEvent(getU32(data + i + 8 + ((start & (size - 1)) * 4), swap));
+                start++;
+            }
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void addLines(int from, int to, int* line)
+{
+    int v;
+
+    for(v = from; v <= to; v++)
+    {
+        lineOf[v][lineCnt[v]++] = *line;
+        (*line)++;
+    }
+}
+
+static void setConfig(int config)
+{
+    int line, h;
+
+    pal = config & 1;
+    h40 = (config >> 1) & 1;
+    v30 = (config >> 2) & 1;
+
+    memset(lineCnt, 0, sizeof(lineCnt));
+    line = 0;
+
+    // V counter sequence
+    if (pal)
+    {
+        lines = 313;
+        lineUs = 64.0;
+
+        addLines(0x00, 0xFF, &line);
+        if (v30)
+        {
+            addLines(0x00, 0x0A, &line);
+            addLines(0xD2, 0xFF, &line);
+        }
+        else
+        {
+            addLines(0x00, 0x02, &line);
+            addLines(0xCA, 0xFF, &line);
+        }
+    }
+    else
+    {
+        lines = 262;
+        lineUs = 63.556;
+
+        if (v30)
+        {
+            addLines(0x00, 0xFF, &line);
+            addLines(0x00, 0x05, &line);
+        }
+        else
+        {
+            addLines(0x00, 0xEA, &line);
+            addLines(0xE5, 0xFF, &line);
+        }
+    }
+
+    vintLine = v30 ? 240 : 224;
+
+    // H counter sequence
+    memset(hPos, 0, sizeof(hPos));
+    hLen = 0;
+    if (h40)
+    {
+        for(h = 0x00; h <= 0xB6; h++) hPos[h] = hLen++;
+        for(h = 0xE4; h <= 0xFF; h++) hPos[h] = hLen++;
+    }
+    else
+    {
+        for(h = 0x00; h <= 0x93; h++) hPos[h] = hLen++;
+        for(h = 0xE9; h <= 0xFF; h++) hPos[h] = hLen++;
+    }
+}
+
+// get full frame number from its low bits
+static int unwrapFrame(int low, int bits)
+{
+    const int range = 1 << bits;
+    const int mask = range - 1;
+    int f;
+
+    if (!frameValid)
+    {
+        frameValid = 1;
+        lastFrame = low;
+        return low;
+    }
+
+    f = (lastFrame & ~mask) | low;
+    if (f < (lastFrame - (range / 2))) f += range;
+    else if (f > (lastFrame + (range / 2))) f -= range;
+
+    lastFrame = f;
+
+    return f;
+}
+
+// event time in micro second (frame starts on V-Int)
+static double getTime(int frame, unsigned int hv)
+{
+    const int v = (hv >> 8) & 0xFF;
+    const double h = (double) hPos[hv & 0xFF] / hLen;
+    double best = -1;
+    int i;
+
+    // ambiguous V counter value: use first time after last event
+    for(i = 0; i < lineCnt[v]; i++)
+    {
+        const int rel = (lineOf[v][i] - vintLine + lines) % lines;
+        const double t = (((double) frame * lines) + rel + h) * lineUs;
+
+        if (best < 0) best = t;
+        else if (((best < lastTime) && (t > best)) || ((t >= lastTime) && (t < best))) best = t;
+    }
+
+    if (best < 0) best = ((double) frame * lines) * lineUs;
+
+    lastTime = best;
+
+    return best;
+}
+
+static void flushPending(const char* args)
+{
+    if (!hasPending) return;
+
+    fprintf(out, "%s\n    {%s%s}", first ? "" : ",", pending, args);
+    first = 0;
+    hasPending = 0;
+}
+
+static const char* getName(int id)
+{
+    static char tmp[32];
+
+    if (names[id]) return names[id];
+    if (id < (int) (sizeof(zoneNames) / sizeof(zoneNames[0]))) return zoneNames[id];
+    if (id == TRACE_ID_VINT) return "V-Int";
+    if (id == TRACE_ID_HINT) return "H-Int";
+    if (id == TRACE_ID_SOUND) return "Sound";
+
+    sprintf(tmp, (id < 16) ? "Zone %d" : "Event %d", id);
+
+    return tmp;
+}
+
+static void decode()
+{
+    int i;
+
+    first = 1;
+    hasPending = 0;
+    frameValid = 0;
+    lastTime = 0;
+    setConfig(0);
+
+    fprintf(out, "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [");
+
+    for(i = 0; i < numEvent; i++)
+    {
+        const unsigned int e = events[i];
+        const int type = e >> 30;
+        const int id = (e >> 24) & 0x3F;
+
+        if (type == TRACE_EXT)
+        {
+            const int value = e & 0xFFFF;
+            char args[96];
+
+            switch(id)
+            {
+                case TRACE_EXT_FRAME:
+                    flushPending("");
+                    unwrapFrame(value, 16);
+                    fprintf(out, "%s\n    {\"name\": \"Frame %d\", \"ph\": \"i\", \"s\": \"g\", \"ts\": %.2f, \"pid\": 0, \"tid\": 0}",
+                            first ? "" : ",", lastFrame, ((double) lastFrame * lines) * lineUs);
+                    first = 0;
+                    break;
+
+                case TRACE_EXT_VALUE:
+                    if (hasPending && (strstr(pending, "\"Sound\"") != NULL) && ((value & 0xFF) < (int) (sizeof(soundNames) / sizeof(soundNames[0]))))
+                        sprintf(args, ", \"args\": {\"cmd\": \"%s\", \"channel\": %d}", soundNames[value & 0xFF], value >> 8);
+                    else
+                        sprintf(args, ", \"args\": {\"value\": %d}", value);
+                    flushPending(args);
+                    break;
+
+                case TRACE_EXT_LOST:
+                    flushPending("");
+                    fprintf(out, "%s\n    {\"name\": \"Lost %d events\", \"ph\": \"i\", \"s\": \"g\", \"ts\": %.2f, \"pid\": 0, \"tid\": 0}",
+                            first ? "" : ",", value, lastTime);
+                    first = 0;
+                    break;
+
+                case TRACE_EXT_CONFIG:
+                    if ((value & 7) != ((v30 << 2) | (h40 << 1) | pal)) setConfig(value);
+                    break;
+            }
+        }
+        else
+        {
+            static const char* phases = "BEi";
+            const int frame = unwrapFrame((e >> 16) & 0xFF, 8);
+            const double t = getTime(frame, e & 0xFFFF);
+            // interrupts on their own track
+            const int tid = ((id == TRACE_ID_VINT) || (id == TRACE_ID_HINT)) ? 1 : 0;
+
+            flushPending("");
+            sprintf(pending, "\"name\": \"%s\", \"ph\": \"%c\", %s\"ts\": %.2f, \"pid\": 0, \"tid\": %d",
+                    getName(id), phases[type], (type == TRACE_INSTANT) ? "\"s\": \"t\", " : "", t, tid);
+            hasPending = 1;
+        }
+    }
+
+    flushPending("");
+
+    fprintf(out, "\n  ],\n  \"otherData\": {\"video\": \"%s %s\"}\n}\n", pal ? "PAL" : "NTSC", v30 ? "V30" : "V28");
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f;
+    unsigned char* data;
+    long dataSize;
+    const char* outFile = NULL;
+    const char* inFile = NULL;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-n") && ((i + 1) < argc))
+        {
+            // custom event name: id=name
+            char* s = argv[++i];
+            char* eq = strchr(s, '=');
+            const int id = strtol(s, NULL, 0);
+
+            if (eq && (id >= 0) && (id < MAX_ID)) names[id] = eq + 1;
+        }
+        else if (!inFile) inFile = argv[i];
+        else outFile = argv[i];
+    }
+
+    if (!inFile)
+    {
+        printf("Trace decoder v1.00\n");
+        printf("Convert SGDK trace events (ENABLE_TRACE) to Chrome trace JSON (chrome://tracing, Perfetto)\n\n");
+        printf("Usage: tracedec <input_file> [output_file] [-n id=name]...\n");
+        printf("  input_file   emulator KDebug log (TRACE_KDEBUG = 1) or work RAM dump (TRACE_KDEBUG = 0)\n");
+        printf("  output_file  JSON output file (default = stdout)\n");
+        printf("  -n id=name   name of a user event id\n");
+        return 1;
+    }
+
+    f = fopen(inFile, "rb");
+    if (!f)
+    {
+        printf("Error: can't open '%s'\n", inFile);
+        return 1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    dataSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    data = malloc(dataSize + 1);
+    events = malloc(MAX_EVENT * sizeof(unsigned int));
+    if (!data || !events || (fread(data, 1, dataSize, f) != (size_t) dataSize))
+    {
+        printf("Error: can't read '%s'\n", inFile);
+        fclose(f);
+        return 1;
+    }
+    fclose(f);
+    data[dataSize] = 0;
+
+    numEvent = 0;
+    if (!parseText((const char*) data) && !parseRAM(data, dataSize))
+    {
+        printf("Error: no trace data found in '%s'\n", inFile);
+        return 1;
+    }
+
+    if (outFile)
+    {
+        out = fopen(outFile, "w");
+        if (!out)
+        {
+            printf("Error: can't create '%s'\n", outFile);
+            return 1;
+        }
+    }
+    else out = stdout;
+
+    decode();
+
+    if (out != stdout)
+    {
+        fclose(out);
+        fprintf(stderr, "%d events converted to '%s'\n", numEvent, outFile);
+    }
+
+    free(events);
+    free(data);
+
+    return 0;
+}
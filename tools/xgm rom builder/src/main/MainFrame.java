@@ -488,19 +488,43 @@ public class MainFrame extends JFrame implements ActionListener
 
                 try
                 {
+                    final SamplePool pool = new SamplePool();
+                    final int[][] poolOffsets = new int[len][];
+                    final int[] trackAddrs = new int[len];
+                    final VGMFile[] compiled = new VGMFile[len];
+
+                    // compile tracks and build shared sample pool
                     int vgmAddr = startXGMLocation;
-                    for (int i = 0; i < vgms.size(); i++)
+                    for (int i = 0; i < len; i++)
                     {
-                        // set VGM address in list
-                        Util.setIntSwapped(rom, XGMListLocation + (i * 4), vgmAddr);
-
-                        final VGMFile vgm = compileVGM(vgms.get(i));
-                        System.arraycopy(vgm.xgc, 0, rom, vgmAddr, vgm.xgc.length);
-                        vgmAddr = (vgmAddr + vgm.xgc.length + 0xFF) & 0xFFFF00;
+                        compiled[i] = compileVGM(vgms.get(i));
+                        poolOffsets[i] = pool.addTrack(compiled[i].xgc);
+                        trackAddrs[i] = vgmAddr;
+                        // track without sample data
+                        vgmAddr = (vgmAddr + (compiled[i].xgc.length - (Util.getXGCMusicDataOffset(compiled[i].xgc) - 4))
+                                + 0x100 + 0xFF) & 0xFFFF00;
 
                         processingBar.setValue(i + 1);
                     }
 
+                    // sample pool is located after tracks
+                    final int poolAddr = vgmAddr;
+                    for (int i = 0; i < len; i++)
+                    {
+                        final byte[] xgc = SamplePool.remapTrack(compiled[i].xgc, poolOffsets[i], trackAddrs[i], poolAddr);
+
+                        // set VGM address in list
+                        Util.setIntSwapped(rom, XGMListLocation + (i * 4), trackAddrs[i]);
+                        System.arraycopy(xgc, 0, rom, trackAddrs[i], xgc.length);
+                    }
+
+                    final byte[] poolData = pool.getData();
+                    System.arraycopy(poolData, 0, rom, poolAddr, poolData.length);
+                    vgmAddr = (poolAddr + poolData.length + 0xFF) & 0xFFFF00;
+
+                    System.out.println("Sample pool: " + pool.numSample + " samples, " + pool.numIdentical + " identical and "
+                            + pool.numSimilar + " near identical merged, " + pool.savedSize + " bytes saved");
+
                     // align output size on 128KB
                     final byte[] out = new byte[(vgmAddr + 0x1FFFF) & 0x7E0000];
                     System.arraycopy(rom, 0, out, 0, vgmAddr);
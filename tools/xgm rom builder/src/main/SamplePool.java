@@ -0,0 +1,202 @@
+package main;
+
+import java.io.ByteArrayOutputStream;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * Sample pool shared by all tracks of the ROM.<br>
+ * Identical and near identical samples (same drum sample resampled or slightly altered by different VGM rips) are
+ * stored only once after the tracks, the XGC sample id table of each track is rewritten to point into the pool.<br>
+ * XGM driver uses sample addresses relative to the track sample table (24 bit, 256 bytes aligned) so the pool must
+ * be located after all tracks.
+ */
+public class SamplePool
+{
+    // near identical samples: same length, mean and maximum absolute difference (8 bit signed PCM)
+    final static double MAX_MEAN_DIFF = 1d;
+    final static int MAX_DIFF = 8;
+    // silent sample mark
+    final static int SILENT = 0xFFFF00;
+
+    // pool samples
+    final List<byte[]> samples;
+    // offset of each sample in pool
+    final List<Integer> offsets;
+    // exact data --> pool sample index
+    final Map<ByteBuffer, Integer> dataMap;
+    // length --> pool sample indexes (near identical search)
+    final Map<Integer, List<Integer>> lengthMap;
+
+    int size;
+    int numSample;
+    int numIdentical;
+    int numSimilar;
+    int savedSize;
+
+    public SamplePool()
+    {
+        super();
+
+        samples = new ArrayList<>();
+        offsets = new ArrayList<>();
+        dataMap = new HashMap<>();
+        lengthMap = new HashMap<>();
+        size = 0;
+        numSample = 0;
+        numIdentical = 0;
+        numSimilar = 0;
+        savedSize = 0;
+    }
+
+    static boolean isSimilar(byte[] data1, byte[] data2)
+    {
+        long diffSum = 0;
+
+        for (int i = 0; i < data1.length; i++)
+        {
+            final int diff = Math.abs(data1[i] - data2[i]);
+
+            if (diff > MAX_DIFF)
+                return false;
+
+            diffSum += diff;
+        }
+
+        return diffSum <= (data1.length * MAX_MEAN_DIFF);
+    }
+
+    /**
+     * Add sample to the pool and returns its offset in pool (existing offset for identical or near identical sample)
+     */
+    public int add(byte[] data)
+    {
+        final ByteBuffer key = ByteBuffer.wrap(data);
+
+        numSample++;
+
+        // identical sample
+        final Integer ind = dataMap.get(key);
+        if (ind != null)
+        {
+            numIdentical++;
+            savedSize += data.length;
+            return offsets.get(ind.intValue()).intValue();
+        }
+
+        // near identical sample
+        List<Integer> sameLength = lengthMap.get(Integer.valueOf(data.length));
+        if (sameLength != null)
+        {
+            for (Integer i : sameLength)
+            {
+                if (isSimilar(samples.get(i.intValue()), data))
+                {
+                    numSimilar++;
+                    savedSize += data.length;
+                    dataMap.put(key, i);
+                    return offsets.get(i.intValue()).intValue();
+                }
+            }
+        }
+        else
+        {
+            sameLength = new ArrayList<>();
+            lengthMap.put(Integer.valueOf(data.length), sameLength);
+        }
+
+        // new sample
+        final Integer newInd = Integer.valueOf(samples.size());
+        final int result = size;
+
+        samples.add(data);
+        offsets.add(Integer.valueOf(result));
+        dataMap.put(key, newInd);
+        sameLength.add(newInd);
+        size += data.length;
+
+        return result;
+    }
+
+    /**
+     * Returns pool data
+     */
+    public byte[] getData()
+    {
+        final ByteArrayOutputStream result = new ByteArrayOutputStream(size);
+
+        for (byte[] data : samples)
+            result.write(data, 0, data.length);
+
+        return result.toByteArray();
+    }
+
+    /**
+     * Add samples of the given XGC track to the pool and returns their pool offsets (-1 = silent sample)
+     */
+    public int[] addTrack(byte[] xgc)
+    {
+        final int[] result = new int[0x3F];
+
+        for (int i = 0; i < 0x3F; i++)
+        {
+            final int offset = ((xgc[(i * 4) + 0] & 0xFF) << 8) | ((xgc[(i * 4) + 1] & 0xFF) << 16);
+            final int len = ((xgc[(i * 4) + 2] & 0xFF) << 8) | ((xgc[(i * 4) + 3] & 0xFF) << 16);
+
+            if ((offset == SILENT) || (len == 0))
+                result[i] = -1;
+            else
+                result[i] = add(Arrays.copyOfRange(xgc, 0x100 + offset, 0x100 + offset + len));
+        }
+
+        return result;
+    }
+
+    /**
+     * Returns the XGC track without its sample data, sample id table pointing to the pool
+     *
+     * @param xgc
+     *        original XGC track
+     * @param poolOffsets
+     *        pool offsets of track samples (see {@link #addTrack(byte[])})
+     * @param trackAddr
+     *        track address in ROM
+     * @param poolAddr
+     *        pool address in ROM (after the tracks)
+     */
+    public static byte[] remapTrack(byte[] xgc, int[] poolOffsets, int trackAddr, int poolAddr)
+    {
+        // music data size field
+        final int musicOffset = Util.getXGCMusicDataOffset(xgc) - 4;
+        final byte[] result = new byte[0x100 + (xgc.length - musicOffset)];
+
+        // sample id table
+        System.arraycopy(xgc, 0, result, 0, 0x100);
+        for (int i = 0; i < 0x3F; i++)
+        {
+            if (poolOffsets[i] != -1)
+            {
+                // relative to track sample data
+                final int offset = (poolAddr + poolOffsets[i]) - (trackAddr + 0x100);
+
+                if ((offset < 0) || (offset >= SILENT))
+                    throw new IllegalArgumentException("Sample pool out of range");
+
+                result[(i * 4) + 0] = (byte) (offset >> 8);
+                result[(i * 4) + 1] = (byte) (offset >> 16);
+            }
+        }
+        // no more sample data
+        result[0xFC] = 0;
+        result[0xFD] = 0;
+
+        // music data size, music data and XD3 tag
+        System.arraycopy(xgc, musicOffset, result, 0x100, xgc.length - musicOffset);
+
+        return result;
+    }
+}
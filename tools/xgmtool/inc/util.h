@@ -23,6 +23,15 @@ typedef struct LList_
     struct LList_ *next;
 } LList;
 
+// contiguous copy of a command list with the time of each element (fast time seek)
+typedef struct
+{
+    LList** elements;
+    // time when element happen (sum of previous element durations), sorted
+    int* times;
+    int size;
+} TimeIndex;
+
 
 //void initList(List* list);
 //List* createList();
@@ -56,6 +65,10 @@ LList* removeFromLList(LList* linkedElement);
 //void* removeFromLList(LList* list, int index);
 
 void** llistToArray(LList* list);
+
+TimeIndex* createTimeIndex(LList* list, int (*getDuration)(void* element));
+void deleteTimeIndex(TimeIndex* index);
+LList* getTimeIndexElementAt(TimeIndex* index, int time);
 //void** listToArray(List* list);
 //LList* listToLList(List* list);
 //List* linkedListToList(LList* list);
@@ -82,6 +95,8 @@ int inEx2(FILE* fin, int inOffset, int size, unsigned char* dest, int outOffset)
 bool out(unsigned char* data, int inOffset, int size, int intSize, bool swap, char* out);
 bool outEx(unsigned char* data, int inOffset, int size, int intSize, bool swap, FILE* fout, int outOffset);
 
+FILE* openTempFile();
+
 unsigned char* resample(unsigned char* data, int offset, int len, int inputRate, int outputRate, int align, int* outSize);
 
 
@@ -45,9 +45,11 @@ int VGM_getTime(VGM* vgm, VGMCommand* command);
 int VGM_getTimeInFrame(VGM* vgm, VGMCommand* command);
 LList* VGM_getCommandElementAtTime(VGM* vgm, int time);
 VGMCommand* VGM_getCommandAtTime(VGM* vgm, int time);
+TimeIndex* VGM_createTimeIndex(VGM* vgm);
 void VGM_cleanCommands(VGM* vgm);
 void VGM_cleanSamples(VGM* vgm);
 void VGM_fixKeyCommands(VGM* vgm);
+void VGM_cleanYMCommands(VGM* vgm);
 //Sample* VGM_getSample(VGM* vgm, int sampleOffset, int len);
 Sample* VGM_getSample(VGM* vgm, int sampleOffset);
 void VGM_convertWaits(VGM* vgm);
@@ -0,0 +1,51 @@
+#ifndef XGP_H_
+#define XGP_H_
+
+/*
+ * XGP (packed XGC) binary format, an experimental compressed variant of XGC music data.
+ * It is *not* the XGM2 format (see bin/xgm_v2.txt) and no Z80 driver plays it yet.
+ *
+ * $0000   252  sample id table (same as XGC)
+ * $00FC     2  sample data bloc size / 256 (SLEN)
+ * $00FE     1  version (0x01)
+ * $00FF     1  bit #0: NTSC / PAL
+ * $0100  SLEN  sample data bloc
+ * ...       4  music data bloc size (MLEN), followed by MLEN bytes of music data
+ * ...       4  0 (end of track list)
+ *
+ * Music data commands are listed below: waits are merged (short/medium/long), YM writes use up to 16 register pairs,
+ * frequency sets use a single command and XGP_REF replaces a repeated command block (address relative to music data,
+ * block size) which never contains a reference, loop or end command so only one return address is needed.
+ */
+
+#include "xgm.h"
+
+
+#define XGP_WAIT_SHORT     0x00
+#define XGP_WAIT_MEDIUM    0x0E
+#define XGP_WAIT_LONG      0x0F
+#define XGP_PSG            0x10
+#define XGP_YM2612_PORT0   0x20
+#define XGP_YM2612_PORT1   0x30
+#define XGP_YM2612_FREQ    0x40
+#define XGP_YM2612_REGKEY  0x50
+#define XGP_PCM            0x60
+#define XGP_YM2612_LFO     0x70
+#define XGP_YM2612_CH3     0x71
+#define XGP_YM2612_DAC     0x72
+
+// don't use command above 0x7F
+#define XGP_REF            0x7D
+#define XGP_LOOP           0x7E
+#define XGP_END            0x7F
+
+// minimum and maximum size (in byte) of a block replaced by a reference command
+#define XGP_REF_MIN        6
+#define XGP_REF_MAX        255
+
+
+unsigned char* XGP_asByteArray(XGM* xgm, int *outSize);
+XGM* XGM_createFromXGPData(unsigned char* data, int dataSize);
+
+
+#endif // XGP_H_
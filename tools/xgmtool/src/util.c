@@ -358,6 +358,71 @@ void** llistToArray(LList* list)
 }
 
 
+/**
+ * Build time index of the given list (single pass), <i>getDuration</i> returns the duration of an element
+ */
+TimeIndex* createTimeIndex(LList* list, int (*getDuration)(void* element))
+{
+    TimeIndex* result = malloc(sizeof(TimeIndex));
+    const int size = getSizeLList(list);
+    LList* l;
+    int time;
+    int i;
+
+    result->elements = malloc(sizeof(LList*) * max(1, size));
+    result->times = malloc(sizeof(int) * max(1, size));
+    result->size = size;
+
+    i = 0;
+    time = 0;
+    l = list;
+    while(l != NULL)
+    {
+        result->elements[i] = l;
+        result->times[i] = time;
+        time += getDuration(l->element);
+        i++;
+        l = l->next;
+    }
+
+    return result;
+}
+
+void deleteTimeIndex(TimeIndex* index)
+{
+    if (index == NULL) return;
+
+    free(index->elements);
+    free(index->times);
+    free(index);
+}
+
+/**
+ * Return first list element happening at or after the specified time (NULL if none)
+ */
+LList* getTimeIndexElementAt(TimeIndex* index, int time)
+{
+    int low = 0;
+    int high = index->size;
+
+    // binary search of first element with time >= specified time
+    while(low < high)
+    {
+        const int mid = (low + high) / 2;
+
+        if (index->times[mid] < time)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low < index->size)
+        return index->elements[low];
+
+    return NULL;
+}
+
+
 //LList* listToLList(List* list)
 //{
 //    LList* result;
@@ -654,13 +719,21 @@ bool outEx(unsigned char* data, int inOffset, int size, int intSize, bool swap,
 }
 
 
+/**
+ * Open a new temporary binary file (unique and deleted on close so conversions can run in parallel)
+ */
+FILE* openTempFile()
+{
+    return tmpfile();
+}
+
 unsigned char* resample(unsigned char* data, int offset, int len, int inputRate, int outputRate, int align, int* outSize)
 {
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
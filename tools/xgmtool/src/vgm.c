@@ -322,10 +322,14 @@ VGM* VGM_createFromXGM(XGM* xgm)
         XGMCommand* command = XGM_getCommandAtOffset(xgm, loopOffset);
         XGMCommand* loopCommand = XGM_getLoopCommand(xgm);
 
+        // single pass for both seeks
+        TimeIndex* index = VGM_createTimeIndex(result);
+        const int loopTime = XGM_getTime(xgm, command);
+
         // insert a VGM loop start command at corresponding position
         if (command != NULL)
         {
-            LList* c = VGM_getCommandElementAtTime(result, XGM_getTime(xgm, command));
+            LList* c = getTimeIndexElementAt(index, loopTime);
             insertBeforeLList(c, VGMCommand_create(VGM_LOOP_START, time));
 //            insertAfterLList(c, VGMCommand_create(VGM_LOOP, time));
         }
@@ -333,7 +337,7 @@ VGM* VGM_createFromXGM(XGM* xgm)
         // insert a VGM loop end command at corresponding position
         if (loopCommand != NULL)
         {
-            LList* c = VGM_getCommandElementAtTime(result, XGM_getTime(xgm, command) + 1);
+            LList* c = getTimeIndexElementAt(index, loopTime + 1);
             // end of list ?
             if (c == NULL)
             {
@@ -344,6 +348,8 @@ VGM* VGM_createFromXGM(XGM* xgm)
             }
             else insertBeforeLList(c, VGMCommand_create(VGM_LOOP_END, time));
         }
+
+        deleteTimeIndex(index);
     }
 
     return result;
@@ -462,6 +468,20 @@ VGMCommand* VGM_getCommandAtTime(VGM* vgm, int time)
     return NULL;
 }
 
+static int VGM_getCommandDuration(void* command)
+{
+    return VGMCommand_getWaitValue(command);
+}
+
+/**
+ * Build time index of commands (in 1/44100th of second) for fast multiple seeks (see getTimeIndexElementAt(..)).<br>
+ * Index must be rebuilt if commands are added or removed.
+ */
+TimeIndex* VGM_createTimeIndex(VGM* vgm)
+{
+    return createTimeIndex(vgm->commands, VGM_getCommandDuration);
+}
+
 
 static void VGM_parse(VGM* vgm)
 {
@@ -1099,17 +1119,22 @@ void VGM_cleanCommands(VGM* vgm)
     LList* com;
 
     int cnt = 0;
+    int time = 0;
+    int frameTime;
     bool hasKeyCom;
 
     startCom = vgm->commands;
     do
     {
         endCom = startCom;
+        // frame commands happen at frame start time (wait is the last one)
+        frameTime = time;
 
         do
         {
             command = endCom->element;
             endCom = endCom->next;
+            time += VGMCommand_getWaitValue(command);
             cnt++;
         }
         while ((endCom != NULL) && !VGMCommand_isWait(command) && !VGMCommand_isEnd(command));
@@ -1211,7 +1236,7 @@ void VGM_cleanCommands(VGM* vgm)
                     if (!silent)
                     {
                         printf("Warning: more than 1 PCM command in a single frame !\n");
-                        printf("Command stream start removed at %g\n", (double) VGM_getTime(vgm, command) / 44100);
+                        printf("Command stream start removed at %g\n", (double) frameTime / 44100);
                     }
 
                     // remove the command
@@ -1225,7 +1250,7 @@ void VGM_cleanCommands(VGM* vgm)
                 if (hasStreamRate)
                 {
                     if (!silent)
-                        printf("Command stream rate removed at %g\n", (double) VGM_getTime(vgm, command) / 44100);
+                        printf("Command stream rate removed at %g\n", (double) frameTime / 44100);
 
                     // remove the command
                     removeFromLList(com);
@@ -1559,6 +1584,125 @@ void VGM_fixKeyCommands(VGM* vgm)
     }
 }
 
+/**
+ * Return true if a write to this YM2612 register can be removed when it doesn't change register value
+ */
+static bool VGM_canRemoveYMWrite(int port, int reg)
+{
+    // key, timer control (reset flags) and DAC enable writes are always kept
+    if ((port == 0) && ((reg == 0x27) || (reg == 0x28) || (reg == 0x2B)))
+        return false;
+    // dual registers are handled by pair (frequency MSB is latched until LSB write)
+    if (YM2612_getDualReg(reg) != NULL)
+        return false;
+
+    return !YM2612_canIgnore(port, reg);
+}
+
+/**
+ * Return true if the YM2612 write doesn't change the specified state
+ */
+static bool VGM_isSameYMWrite(YM2612* state, VGMCommand* command)
+{
+    const int port = VGMCommand_getYM2612Port(command);
+    const int reg = VGMCommand_getYM2612Register(command);
+
+    return state->init[port][reg] && (YM2612_get(state, port, reg) == VGMCommand_getYM2612Value(command));
+}
+
+static LList* VGM_removeCommand(VGM* vgm, LList* element)
+{
+    if (element == vgm->commands)
+        vgm->commands = element->next;
+
+    return removeFromLList(element);
+}
+
+/**
+ * Remove YM2612 writes which don't change YM2612 state (tracked along the whole command stream).<br>
+ * This method should be called after VGM_fixKeyCommands(..) as key commands can be moved there.
+ */
+void VGM_cleanYMCommands(VGM* vgm)
+{
+    YM2612* state;
+    LList* commands;
+    int numRemoved;
+    int sizeRemoved;
+
+    state = YM2612_create();
+    numRemoved = 0;
+    sizeRemoved = 0;
+
+    commands = vgm->commands;
+    while(commands != NULL)
+    {
+        VGMCommand* command = commands->element;
+
+        // loop start --> state on loop is unknown
+        if (VGMCommand_isLoopStart(command))
+            YM2612_clear(state);
+        else if (VGMCommand_isYM2612Write(command))
+        {
+            const int port = VGMCommand_getYM2612Port(command);
+            const int reg = VGMCommand_getYM2612Register(command);
+            const int* dual = YM2612_getDualReg(reg);
+            bool remove = false;
+
+            // key write --> remove if key state doesn't change (same operators already ON / OFF)
+            if (VGMCommand_isYM2612KeyWrite(command))
+                remove = !YM2612_set(state, port, reg, VGMCommand_getYM2612Value(command));
+            // dual register MSB directly followed by its LSB --> remove pair if both are unchanged
+            else if ((dual != NULL) && (dual[0] == reg) && (commands->next != NULL))
+            {
+                VGMCommand* next = commands->next->element;
+
+                if ((VGMCommand_getYM2612Port(next) == port) && (VGMCommand_getYM2612Register(next) == dual[1]))
+                {
+                    if (VGM_isSameYMWrite(state, command) && VGM_isSameYMWrite(state, next))
+                    {
+                        numRemoved += 2;
+                        sizeRemoved += command->size + next->size;
+                        VGM_removeCommand(vgm, commands);
+                        commands = VGM_removeCommand(vgm, commands->next);
+                        continue;
+                    }
+
+                    YM2612_set(state, port, reg, VGMCommand_getYM2612Value(command));
+                    YM2612_set(state, port, dual[1], VGMCommand_getYM2612Value(next));
+                    commands = commands->next->next;
+                    continue;
+                }
+
+                YM2612_set(state, port, reg, VGMCommand_getYM2612Value(command));
+            }
+            else
+            {
+                remove = VGM_canRemoveYMWrite(port, reg) && VGM_isSameYMWrite(state, command);
+                YM2612_set(state, port, reg, VGMCommand_getYM2612Value(command));
+            }
+
+            if (remove)
+            {
+                numRemoved++;
+                sizeRemoved += command->size;
+                commands = VGM_removeCommand(vgm, commands);
+                continue;
+            }
+        }
+
+        commands = commands->next;
+    }
+
+    free(state);
+
+    if (!silent)
+    {
+        printf("Redundant YM2612 writes removed: %d (%d bytes saved)\n", numRemoved, sizeRemoved);
+        if (verbose)
+            printf("Number of command after YM2612 commands clean: %d\n", getSizeLList(vgm->commands));
+    }
+}
+
 static int VGM_getSampleDataSize(VGM* vgm)
 {
     LList* b;
@@ -1639,11 +1783,11 @@ unsigned char* VGM_asByteArray(VGM* vgm, int* outSize)
     int i;
     int gd3Offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
@@ -12,9 +12,16 @@
 #include "../inc/gd3.h"
 
 
+// frame size (in byte) from which a frame is considered heavy to process
+#define XGC_HEAVY_FRAME_SIZE    64
+// PSG commands weight in frame size (Z80 accesses PSG through the 68000 BUS so it stalls with DMA)
+#define XGC_PSG_WEIGHT          4
+
+
 // forward
 static void XGC_extractMusic(XGM* xgc, XGM* xgm);
 static int XGC_computeLenInFrameOf(LList* commands);
+static unsigned char* XGC_getHeavyFrames(XGM* source, int* numFrame, int* loopFrame);
 
 XGM* XGC_create(XGM* xgm)
 {
@@ -114,6 +121,7 @@ static void XGC_extractMusic(XGM* xgc, XGM* xgm)
     YM2612* ymState;
     int j, size;
     int time;
+    int numFrame;
     bool hasKeyCom;
 
     time = 0;
@@ -125,6 +133,8 @@ static void XGC_extractMusic(XGM* xgc, XGM* xgm)
     xgcCommands = createElement(XGCCommand_createFrameSizeCommand(0));
     xgcCommands = insertAfterLList(xgcCommands, XGCCommand_createFrameSizeCommand(0));
     xgcCommands = insertAfterLList(xgcCommands, XGCCommand_createFrameSizeCommand(0));
+    // number of frame in xgcCommands (avoid parsing the whole list for warnings)
+    numFrame = 3;
 
     XGMCommand* loopCommand = XGM_getLoopPointedCommand(xgm);
     int loopOffset = -1;
@@ -281,7 +291,7 @@ static void XGC_extractMusic(XGM* xgc, XGM* xgm)
 
                     if (!silent)
                     {
-                        int frameInd = XGC_computeLenInFrameOf(getHeadLList(xgcCommands));
+                        int frameInd = numFrame;
                         int id = XGMCommand_getPCMId(command);
 
                         // we are ignoring a real play command --> display it
@@ -377,7 +387,7 @@ static void XGC_extractMusic(XGM* xgc, XGM* xgm)
 //                if ((frameInd > 10) && (!silent))
                 if (!silent)
                 {
-                    int frameInd = XGC_computeLenInFrameOf(getHeadLList(xgcCommands)) + (XGC_computeLenInFrameOf(newCommands) - 1);
+                    int frameInd = numFrame + (XGC_computeLenInFrameOf(newCommands) - 1);
                     printf("Warning: frame >= 256 at frame %4X (need to split frame)\n", frameInd);
                 }
 
@@ -402,6 +412,7 @@ static void XGC_extractMusic(XGM* xgc, XGM* xgm)
         XGCCommand_setFrameSizeSize(sizeCommand, size);
 
         // finally add the new commands
+        numFrame += XGC_computeLenInFrameOf(newCommands);
         xgcCommands = insertAllAfterLList(xgcCommands, newCommands);
     }
 
@@ -618,6 +629,81 @@ void XGC_computeAllFrameSize(XGM* source)
     }
 }
 
+/**
+ * Build heavy frame bitmap: frames which take long to process (PSG writes weight more as Z80 uses the 68000 BUS for PSG)
+ */
+static unsigned char* XGC_getHeavyFrames(XGM* source, int* numFrame, int* loopFrame)
+{
+    unsigned char* result;
+    LList* com;
+    int loopOffset;
+    int frame;
+    int size;
+    bool heavy;
+    bool skip;
+
+    result = calloc(max(1, (XGC_computeLenInFrame(source) + 8) / 8), 1);
+
+    // get loop offset
+    loopOffset = -1;
+    com = source->commands;
+    while(com != NULL)
+    {
+        XGMCommand* command = com->element;
+
+        if (XGMCommand_isLoop(command))
+            loopOffset = XGMCommand_getLoopOffset(command);
+
+        com = com->next;
+    }
+
+    *loopFrame = -1;
+    frame = -1;
+    size = 0;
+    heavy = false;
+    skip = false;
+    com = source->commands;
+    while(com != NULL)
+    {
+        XGMCommand* command = com->element;
+
+        if (XGCCommand_isFrameSize(command))
+        {
+            // previous frame has been split (frame skip) --> same music frame
+            if (!skip)
+            {
+                if ((frame >= 0) && heavy)
+                    result[frame >> 3] |= 1 << (frame & 7);
+
+                frame++;
+                size = 0;
+                heavy = false;
+            }
+
+            if ((command->offset == loopOffset) && (*loopFrame == -1))
+                *loopFrame = frame;
+        }
+
+        if (XGCCommand_isPSGEnvWrite(command) || XGCCommand_isPSGToneWrite(command))
+            size += command->size * XGC_PSG_WEIGHT;
+        else
+            size += command->size;
+        if (size >= XGC_HEAVY_FRAME_SIZE)
+            heavy = true;
+
+        skip = XGCCommand_isFrameSkip(command);
+        com = com->next;
+    }
+
+    // last frame
+    if ((frame >= 0) && heavy)
+        result[frame >> 3] |= 1 << (frame & 7);
+
+    *numFrame = frame + 1;
+
+    return result;
+}
+
 static int XGC_computeLenInFrameOf(LList* commands)
 {
     LList* com = commands;
@@ -710,12 +796,13 @@ unsigned char* XGC_asByteArray(XGM* source, int *outSize)
     int s;
     int offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    unsigned char data4[4];
+    FILE* f = openTempFile();
     LList* l;
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
@@ -770,7 +857,8 @@ unsigned char* XGC_asByteArray(XGM* source, int *outSize)
     byte |= source->pal?1:0;
     // b1=XD3 tags
     byte |= (source->xd3 != NULL)?2:0;
-    // b2=multi track, others=reserved
+    // b2=multi track, b3=heavy frame table, others=reserved
+    byte |= 8;
     fwrite(&byte, 1, 1, f);
 
     // 0100-XXXX: sample data
@@ -828,6 +916,20 @@ unsigned char* XGC_asByteArray(XGM* source, int *outSize)
         fwrite(data, 1, s, f);
     }
 
+    // heavy frame table (used by 68000 side to delay DMA on these frames)
+    int numFrame, loopFrame;
+    unsigned char* heavy = XGC_getHeavyFrames(source, &numFrame, &loopFrame);
+
+    // +0000: number of frame
+    setInt(data4, 0, numFrame);
+    fwrite(data4, 1, 4, f);
+    // +0004: loop frame (-1 = no loop)
+    setInt(data4, 0, loopFrame);
+    fwrite(data4, 1, 4, f);
+    // +0008: heavy frame bitmap (bit #(n & 7) of byte #(n / 8) = frame n)
+    fwrite(heavy, 1, (numFrame + 7) / 8, f);
+    free(heavy);
+
     unsigned char* result = inEx(f, 0, getFileSizeEx(f), outSize);
 
     fclose(f);
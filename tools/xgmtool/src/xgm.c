@@ -842,12 +842,12 @@ unsigned char* XGM_asByteArray(XGM* xgm, int *outSize)
     int i;
     int offset;
     unsigned char byte;
-    FILE* f = fopen("tmp.bin", "wb+");
+    FILE* f = openTempFile();
     LList* l;
 
     if (f == NULL)
     {
-        printf("Error: cannot open file tmp.bin\n");
+        printf("Error: cannot open temporary file\n");
         return NULL;
     }
 
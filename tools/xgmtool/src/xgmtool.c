@@ -2,19 +2,37 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "../inc/xgmtool.h"
 #include "../inc/util.h"
 #include "../inc/vgm.h"
 #include "../inc/xgm.h"
 #include "../inc/xgc.h"
+#include "../inc/xgp.h"
 
 #define SYSTEM_AUTO     -1
 #define SYSTEM_NTSC     0
 #define SYSTEM_PAL      1
 
+#define MAX_LINE        1024
 
-const char* version = "1.73";
+
+// batch conversion job
+typedef struct
+{
+    char* inFile;
+    char* outFile;
+    int errCode;
+} Job;
+
+
+const char* version = "1.74";
 int sys;
 bool silent;
 bool verbose;
@@ -22,124 +40,46 @@ bool sampleRateFix;
 bool sampleIgnore;
 bool delayKeyOff;
 
+// batch conversion jobs
+static Job* jobs;
+static int numJob;
+static int nextJob;
+static pthread_mutex_t jobMutex = PTHREAD_MUTEX_INITIALIZER;
 
-int main(int argc, char *argv[ ])
+
+/**
+ * Convert <i>inFile</i> to <i>outFile</i> (operation depends on file extensions), returns error code (0 = no error)
+ */
+static int convert(char* inFile, char* outFile)
 {
-    int i;
     FILE *infile, *outfile;
 
-    if (argc < 3)
-    {
-        printf("XGMTool %s - Stephane Dallongeville - copyright 2020\n", version);
-        printf("\n");
-        printf("Usage: xgmtool inputFile outputFile <options>\n");
-        printf("XGMTool can do the following operations:\n");
-        printf(" - Optimize and reduce size of Sega Megadrive VGM file\n");
-        printf("   Note that it won't work correctly on VGM file which require sub frame accurate timing.\n");
-        printf(" - Convert a Sega Megadrive VGM file to XGM file\n");
-        printf(" - Convert a XGM file to Sega Megadrive VGM file\n");
-        printf(" - Compile a XGM file into a binary file (XGC) ready to played by the Z80 XGM driver\n");
-        printf(" - Convert a XGC binary file to XGM file (experimental)\n");
-        printf(" - Convert a XGC binary file to Sega Megadrive VGM file (experimental)\n");
-        printf("\n");
-        printf("Optimize VGM:\n");
-        printf("  xgmtool input.vgm output.vgm\n");
-        printf("\n");
-        printf("Convert VGM to XGM:\n");
-        printf("  xgmtool input.vgm output.xgm\n");
-        printf("\n");
-        printf("Convert and compile VGM to binary/XGC:\n");
-        printf("  xgmtool input.vgm output.bin\n");
-        printf("  xgmtool input.vgm output.xgc\n");
-        printf("\n");
-        printf("Convert XGM to VGM:\n");
-        printf("  xgmtool input.xgm output.vgm\n");
-        printf("\n");
-        printf("Compile XGM to binary/XGC:\n");
-        printf("  xgmtool input.xgm output.bin\n");
-        printf("  xgmtool input.xgm output.xgc\n");
-        printf("\n");
-        printf("Convert XGC to XGM (experimental):\n");
-        printf("  xgmtool input.xgc output.xgm\n");
-        printf("\n");
-        printf("Compile XGC to VGM (experimental):\n");
-        printf("  xgmtool input.xgc output.vgm\n");
-        printf("\n");
-        printf("The action xmgtool performs is dependant from the input and output file extension.\n");
-        printf("Supported options:\n");
-        printf("-s\tenable silent mode (no message except error and warning).\n");
-        printf("-v\tenable verbose mode (give more info about conversion).\n");
-        printf("-n\tforce NTSC timing (only meaningful for VGM to XGM conversion).\n");
-        printf("-p\tforce PAL timing (only meaningful for VGM to XGM conversion).\n");
-        printf("-di\tdisable PCM sample auto ignore (it can help when PCM are not properly extracted).\n");
-        printf("-dr\tdisable PCM sample rate auto fix (it can help when PCM are not properly extracted).\n");
-        printf("-dd\tdisable delayed KEY OFF event when we have KEY ON/OFF in a single frame (it can fix incorrect instrument sound).\n");
-
-        exit(1);
-    }
-
-    sys = SYSTEM_AUTO;
-    silent = false;
-    verbose = false;
-    sampleIgnore = true;
-    sampleRateFix = true;
-    delayKeyOff = true;
-
     // Open source for binary read (will fail if file does not exist)
-    if ((infile = fopen(argv[1], "rb")) == NULL)
+    if ((infile = fopen(inFile, "rb")) == NULL)
     {
-        printf("Error: the source file %s could not be opened\n", argv[1]);
-        exit(2);
+        printf("Error: the source file %s could not be opened\n", inFile);
+        return 2;
     }
+    // can close
+    fclose(infile);
 
     // test open output for write
-    if ((outfile = fopen(argv[2], "wb")) == NULL)
+    if ((outfile = fopen(outFile, "wb")) == NULL)
     {
-        printf("Error: the output file %s could not be opened\n", argv[2]);
-        exit(3);
+        printf("Error: the output file %s could not be opened\n", outFile);
+        return 3;
     }
     // can close
     fclose(outfile);
 
-    // options
-    for(i = 3; i < argc; i++)
-    {
-        if (!strcasecmp(argv[i], "-s"))
-        {
-            silent = true;
-            verbose = false;
-        }
-        else if (!strcasecmp(argv[i], "-v"))
-        {
-            verbose = true;
-            silent = false;
-        }
-        else if (!strcasecmp(argv[i], "-di"))
-            sampleIgnore = false;
-        else if (!strcasecmp(argv[i], "-dr"))
-            sampleRateFix = false;
-        else if (!strcasecmp(argv[i], "-dd"))
-            delayKeyOff = false;
-        else if (!strcasecmp(argv[i], "-n"))
-            sys = SYSTEM_NTSC;
-        else if (!strcasecmp(argv[i], "-p"))
-            sys = SYSTEM_PAL;
-        else
-            printf("Warning: option %s not recognized (ignored)\n", argv[i]);
-    }
-
-    // silent mode has priority
-    if (silent)
-        verbose = false;
-
-    char* inExt = getFileExtension(argv[1]);
-    char* outExt = getFileExtension(argv[2]);
+    char* inExt = getFileExtension(inFile);
+    char* outExt = getFileExtension(outFile);
     int errCode = 0;
 
     // VGM or empty (assumed as VGM)
     if (!strcasecmp(inExt, "VGM") || !strlen(inExt))
     {
-        if ((!strcasecmp(outExt, "VGM")) || (!strcasecmp(outExt, "XGM")) || (!strcasecmp(outExt, "BIN")) || (!strcasecmp(outExt, "XGC")))
+        if ((!strcasecmp(outExt, "VGM")) || (!strcasecmp(outExt, "XGM")) || (!strcasecmp(outExt, "BIN")) || (!strcasecmp(outExt, "XGC")) || (!strcasecmp(outExt, "XGP")))
         {
             // VGM optimization
             int inDataSize;
@@ -150,8 +90,8 @@ int main(int argc, char *argv[ ])
 //            VGM* optVgm;
 
             // load file
-            inData = readBinaryFile(argv[1], &inDataSize);
-            if (inData == NULL) exit(1);
+            inData = readBinaryFile(inFile, &inDataSize);
+            if (inData == NULL) return 1;
             // load VGM
             if (sys == SYSTEM_NTSC)
                 inData[0x24] = 60;
@@ -159,24 +99,25 @@ int main(int argc, char *argv[ ])
                 inData[0x24] = 50;
             // create with conversion
             vgm = VGM_create(inData, inDataSize, 0, true);
-            if (vgm == NULL) exit(1);
+            if (vgm == NULL) return 1;
 //            // optimize
 //            optVgm = VGM_createFromVGM(vgm, true);
-//            if (optVgm == NULL) exit(1);
+//            if (optVgm == NULL) return 1;
 
             VGM_convertWaits(vgm);
             VGM_cleanCommands(vgm);
             VGM_cleanSamples(vgm);
             VGM_fixKeyCommands(vgm);
+            VGM_cleanYMCommands(vgm);
 
             // VGM output
             if (!strcasecmp(outExt, "VGM"))
             {
                 // get byte array
                 outData = VGM_asByteArray(vgm, &outDataSize);
-                if (outData == NULL) exit(1);
+                if (outData == NULL) return 1;
                 // write to file
-                writeBinaryFile(outData, outDataSize, argv[2]);
+                writeBinaryFile(outData, outDataSize, outFile);
             }
             else
             {
@@ -184,7 +125,7 @@ int main(int argc, char *argv[ ])
 
                 // convert to XGM
                 xgm = XGM_createFromVGM(vgm);
-                if (xgm == NULL) exit(1);
+                if (xgm == NULL) return 1;
 
                 // XGM output
                 if (!strcasecmp(outExt, "XGM"))
@@ -192,31 +133,37 @@ int main(int argc, char *argv[ ])
                     // get byte array
                     outData = XGM_asByteArray(xgm, &outDataSize);
                 }
+                // XGP output
+                else if (!strcasecmp(outExt, "XGP"))
+                {
+                    // get byte array
+                    outData = XGP_asByteArray(xgm, &outDataSize);
+                }
                 else
                 {
                     XGM* xgc;
 
                     // convert to XGC (compiled XGM)
                     xgc = XGC_create(xgm);
-                    if (xgc == NULL) exit(1);
+                    if (xgc == NULL) return 1;
                     // get byte array
                     outData = XGC_asByteArray(xgc, &outDataSize);
                 }
 
-                if (outData == NULL) exit(1);
+                if (outData == NULL) return 1;
                 // write to file
-                writeBinaryFile(outData, outDataSize, argv[2]);
+                writeBinaryFile(outData, outDataSize, outFile);
             }
         }
         else
         {
-            printf("Error: the output file %s is incorrect (should be a VGM, XGM or BIN/XGC file)\n", argv[2]);
+            printf("Error: the output file %s is incorrect (should be a VGM, XGM, BIN/XGC or XGP file)\n", outFile);
             errCode = 4;
         }
     }
     else if (!strcasecmp(inExt, "XGM"))
     {
-        if ((!strcasecmp(outExt, "VGM")) || (!strcasecmp(outExt, "BIN")) || (!strcasecmp(outExt, "XGC")))
+        if ((!strcasecmp(outExt, "VGM")) || (!strcasecmp(outExt, "BIN")) || (!strcasecmp(outExt, "XGC")) || (!strcasecmp(outExt, "XGP")))
         {
             // XGM to VGM
             int inDataSize;
@@ -226,11 +173,11 @@ int main(int argc, char *argv[ ])
             XGM* xgm;
 
             // load file
-            inData = readBinaryFile(argv[1], &inDataSize);
-            if (inData == NULL) exit(1);
+            inData = readBinaryFile(inFile, &inDataSize);
+            if (inData == NULL) return 1;
             // load XGM
             xgm = XGM_createFromData(inData, inDataSize);
-            if (xgm == NULL) exit(1);
+            if (xgm == NULL) return 1;
 
             // VGM conversion
             if (!strcasecmp(outExt, "VGM"))
@@ -239,36 +186,42 @@ int main(int argc, char *argv[ ])
 
                 // convert to VGM
                 vgm = VGM_createFromXGM(xgm);
-                if (vgm == NULL) exit(1);
+                if (vgm == NULL) return 1;
                 // get byte array
                 outData = VGM_asByteArray(vgm, &outDataSize);
             }
+            // XGP conversion
+            else if (!strcasecmp(outExt, "XGP"))
+            {
+                // get byte array
+                outData = XGP_asByteArray(xgm, &outDataSize);
+            }
             else
             {
                 XGM* xgc;
 
                 // convert to XGC (compiled XGM)
                 xgc = XGC_create(xgm);
-                if (xgc == NULL) exit(1);
+                if (xgc == NULL) return 1;
                 // get byte array
                 outData = XGC_asByteArray(xgc, &outDataSize);
             }
 
-            if (outData == NULL) exit(1);
+            if (outData == NULL) return 1;
             // write to file
-            writeBinaryFile(outData, outDataSize, argv[2]);
+            writeBinaryFile(outData, outDataSize, outFile);
         }
         else
         {
-            printf("Error: the output file %s is incorrect (should be a VGM or BIN/XGC file)\n", argv[2]);
+            printf("Error: the output file %s is incorrect (should be a VGM, BIN/XGC or XGP file)\n", outFile);
             errCode = 4;
         }
     }
-    else if (!strcasecmp(inExt, "XGC"))
+    else if ((!strcasecmp(inExt, "XGC")) || (!strcasecmp(inExt, "XGP")))
     {
         if ((!strcasecmp(outExt, "VGM")) || (!strcasecmp(outExt, "XGM")))
         {
-            // XGC to XGM
+            // XGC / XGP to XGM
             int inDataSize;
             unsigned char* inData;
             int outDataSize;
@@ -276,11 +229,14 @@ int main(int argc, char *argv[ ])
             XGM* xgm;
 
             // load file
-            inData = readBinaryFile(argv[1], &inDataSize);
-            if (inData == NULL) exit(1);
+            inData = readBinaryFile(inFile, &inDataSize);
+            if (inData == NULL) return 1;
             // load XGM
-            xgm = XGM_createFromXGCData(inData, inDataSize);
-            if (xgm == NULL) exit(1);
+            if (!strcasecmp(inExt, "XGP"))
+                xgm = XGM_createFromXGPData(inData, inDataSize);
+            else
+                xgm = XGM_createFromXGCData(inData, inDataSize);
+            if (xgm == NULL) return 1;
 
             // VGM conversion
             if (!strcasecmp(outExt, "VGM"))
@@ -289,7 +245,7 @@ int main(int argc, char *argv[ ])
 
                 // convert to VGM
                 vgm = VGM_createFromXGM(xgm);
-                if (vgm == NULL) exit(1);
+                if (vgm == NULL) return 1;
                 // get byte array
                 outData = VGM_asByteArray(vgm, &outDataSize);
             }
@@ -299,25 +255,315 @@ int main(int argc, char *argv[ ])
                 outData = XGM_asByteArray(xgm, &outDataSize);
             }
 
-            if (outData == NULL) exit(1);
+            if (outData == NULL) return 1;
             // write to file
-            writeBinaryFile(outData, outDataSize, argv[2]);
+            writeBinaryFile(outData, outDataSize, outFile);
         }
         else
         {
-            printf("Error: the output file %s is incorrect (should be a XGM or VGM file)\n", argv[2]);
+            printf("Error: the output file %s is incorrect (should be a XGM or VGM file)\n", outFile);
             errCode = 4;
         }
     }
     else
     {
-        printf("Error: the input file %s is incorrect (should be a VGM, XGM or XGC file)\n", argv[1]);
+        printf("Error: the input file %s is incorrect (should be a VGM, XGM, XGC or XGP file)\n", inFile);
         errCode = 4;
     }
 
-    fclose(infile);
+    return errCode;
+}
 
-    remove("tmp.bin");
+static char* readToken(char** line)
+{
+    char* s = *line;
+    char* result;
 
-    return errCode;
+    // skip spaces
+    while((*s == ' ') || (*s == '\t')) s++;
+    if ((*s == 0) || (*s == '#')) return NULL;
+
+    // quoted path
+    if (*s == '"')
+    {
+        result = ++s;
+        while((*s != 0) && (*s != '"')) s++;
+    }
+    else
+    {
+        result = s;
+        while((*s != 0) && (*s != ' ') && (*s != '\t')) s++;
+    }
+
+    if (*s != 0) *s++ = 0;
+    *line = s;
+
+    return result;
+}
+
+/**
+ * Read batch manifest (one "inputFile outputFile" pair per line), returns number of job (-1 on error)
+ */
+static int readManifest(char* fileName)
+{
+    char line[MAX_LINE];
+    int allocated;
+    int lineNum;
+    FILE* f;
+
+    if ((f = fopen(fileName, "r")) == NULL)
+    {
+        printf("Error: the manifest file %s could not be opened\n", fileName);
+        return -1;
+    }
+
+    jobs = NULL;
+    numJob = 0;
+    allocated = 0;
+    lineNum = 0;
+    while(fgets(line, MAX_LINE, f) != NULL)
+    {
+        char* l = line;
+        char* in;
+        char* out;
+
+        lineNum++;
+        // remove end of line
+        line[strcspn(line, "\r\n")] = 0;
+
+        in = readToken(&l);
+        // empty line or comment
+        if (in == NULL) continue;
+        out = readToken(&l);
+
+        if (out == NULL)
+        {
+            printf("Error: missing output file at line %d of %s\n", lineNum, fileName);
+            fclose(f);
+            return -1;
+        }
+
+        if (numJob >= allocated)
+        {
+            allocated = max(16, allocated * 2);
+            jobs = realloc(jobs, allocated * sizeof(Job));
+        }
+
+        jobs[numJob].inFile = strdup(in);
+        jobs[numJob].outFile = strdup(out);
+        jobs[numJob].errCode = 0;
+        numJob++;
+    }
+
+    fclose(f);
+
+    return numJob;
+}
+
+static void* convertThread(void* arg)
+{
+    // jobs are taken from the shared job list
+    (void) arg;
+
+    while(true)
+    {
+        int j;
+
+        // get next job
+        pthread_mutex_lock(&jobMutex);
+        j = nextJob++;
+        pthread_mutex_unlock(&jobMutex);
+
+        if (j >= numJob) break;
+
+        if (!silent)
+            printf("Converting %s to %s\n", jobs[j].inFile, jobs[j].outFile);
+
+        jobs[j].errCode = convert(jobs[j].inFile, jobs[j].outFile);
+    }
+
+    return NULL;
+}
+
+static int getNumCPU()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    return sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+}
+
+/**
+ * Convert all files of the manifest using <i>numThread</i> worker threads, returns number of failed conversion
+ */
+static int convertBatch(char* manifest, int numThread)
+{
+    pthread_t* threads;
+    int numError;
+    int i;
+
+    if (readManifest(manifest) < 0)
+        return -1;
+
+    if (numThread < 1) numThread = getNumCPU();
+    numThread = max(1, min(numThread, numJob));
+
+    if (!silent)
+        printf("Converting %d files using %d threads\n", numJob, numThread);
+
+    nextJob = 0;
+    threads = malloc(numThread * sizeof(pthread_t));
+    for (i = 0; i < numThread; i++)
+        pthread_create(&threads[i], NULL, convertThread, NULL);
+    for (i = 0; i < numThread; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    numError = 0;
+    for (i = 0; i < numJob; i++)
+    {
+        if (jobs[i].errCode != 0)
+        {
+            printf("Error: conversion of %s failed (error code %d)\n", jobs[i].inFile, jobs[i].errCode);
+            numError++;
+        }
+    }
+
+    if (!silent)
+        printf("Batch conversion done: %d converted, %d failed\n", numJob - numError, numError);
+
+    return numError;
+}
+
+
+int main(int argc, char *argv[ ])
+{
+    int i;
+    int numThread;
+    bool batch;
+
+    if (argc < 3)
+    {
+        printf("XGMTool %s - Stephane Dallongeville - copyright 2020\n", version);
+        printf("\n");
+        printf("Usage: xgmtool inputFile outputFile <options>\n");
+        printf("       xgmtool -b manifestFile <options>\n");
+        printf("XGMTool can do the following operations:\n");
+        printf(" - Optimize and reduce size of Sega Megadrive VGM file\n");
+        printf("   Note that it won't work correctly on VGM file which require sub frame accurate timing.\n");
+        printf(" - Convert a Sega Megadrive VGM file to XGM file\n");
+        printf(" - Convert a XGM file to Sega Megadrive VGM file\n");
+        printf(" - Compile a XGM file into a binary file (XGC) ready to played by the Z80 XGM driver\n");
+        printf(" - Convert a XGC binary file to XGM file (experimental)\n");
+        printf(" - Convert a XGC binary file to Sega Megadrive VGM file (experimental)\n");
+        printf(" - Compile a XGM file into a packed XGC binary file (XGP, reference compressed music data, not yet playable by the driver)\n");
+        printf(" - Convert a XGP binary file to XGM or VGM file\n");
+        printf("\n");
+        printf("Optimize VGM:\n");
+        printf("  xgmtool input.vgm output.vgm\n");
+        printf("\n");
+        printf("Convert VGM to XGM:\n");
+        printf("  xgmtool input.vgm output.xgm\n");
+        printf("\n");
+        printf("Convert and compile VGM to binary/XGC:\n");
+        printf("  xgmtool input.vgm output.bin\n");
+        printf("  xgmtool input.vgm output.xgc\n");
+        printf("\n");
+        printf("Convert and compile VGM to packed binary/XGP:\n");
+        printf("  xgmtool input.vgm output.xgp\n");
+        printf("\n");
+        printf("Convert XGM to VGM:\n");
+        printf("  xgmtool input.xgm output.vgm\n");
+        printf("\n");
+        printf("Compile XGM to binary/XGC:\n");
+        printf("  xgmtool input.xgm output.bin\n");
+        printf("  xgmtool input.xgm output.xgc\n");
+        printf("\n");
+        printf("Compile XGM to packed binary/XGP:\n");
+        printf("  xgmtool input.xgm output.xgp\n");
+        printf("\n");
+        printf("Convert XGC to XGM (experimental):\n");
+        printf("  xgmtool input.xgc output.xgm\n");
+        printf("\n");
+        printf("Compile XGC to VGM (experimental):\n");
+        printf("  xgmtool input.xgc output.vgm\n");
+        printf("\n");
+        printf("Convert XGP to XGM or VGM:\n");
+        printf("  xgmtool input.xgp output.xgm\n");
+        printf("  xgmtool input.xgp output.vgm\n");
+        printf("\n");
+        printf("Batch conversion (files are converted in parallel):\n");
+        printf("  xgmtool -b manifest.txt\n");
+        printf("  manifest.txt contains one \"inputFile outputFile\" pair per line (use quotes for path with space, # for comment)\n");
+        printf("\n");
+        printf("The action xmgtool performs is dependant from the input and output file extension.\n");
+        printf("Supported options:\n");
+        printf("-s\tenable silent mode (no message except error and warning).\n");
+        printf("-v\tenable verbose mode (give more info about conversion).\n");
+        printf("-n\tforce NTSC timing (only meaningful for VGM to XGM conversion).\n");
+        printf("-p\tforce PAL timing (only meaningful for VGM to XGM conversion).\n");
+        printf("-di\tdisable PCM sample auto ignore (it can help when PCM are not properly extracted).\n");
+        printf("-dr\tdisable PCM sample rate auto fix (it can help when PCM are not properly extracted).\n");
+        printf("-dd\tdisable delayed KEY OFF event when we have KEY ON/OFF in a single frame (it can fix incorrect instrument sound).\n");
+        printf("-j N\tnumber of conversion thread in batch mode (default is number of CPU).\n");
+
+        exit(1);
+    }
+
+    sys = SYSTEM_AUTO;
+    silent = false;
+    verbose = false;
+    sampleIgnore = true;
+    sampleRateFix = true;
+    delayKeyOff = true;
+    numThread = 0;
+    batch = !strcasecmp(argv[1], "-b");
+
+    // options
+    for(i = 3; i < argc; i++)
+    {
+        if (!strcasecmp(argv[i], "-s"))
+        {
+            silent = true;
+            verbose = false;
+        }
+        else if (!strcasecmp(argv[i], "-v"))
+        {
+            verbose = true;
+            silent = false;
+        }
+        else if (!strcasecmp(argv[i], "-di"))
+            sampleIgnore = false;
+        else if (!strcasecmp(argv[i], "-dr"))
+            sampleRateFix = false;
+        else if (!strcasecmp(argv[i], "-dd"))
+            delayKeyOff = false;
+        else if (!strcasecmp(argv[i], "-n"))
+            sys = SYSTEM_NTSC;
+        else if (!strcasecmp(argv[i], "-p"))
+            sys = SYSTEM_PAL;
+        else if (!strcasecmp(argv[i], "-j") && ((i + 1) < argc))
+            numThread = atoi(argv[++i]);
+        else
+            printf("Warning: option %s not recognized (ignored)\n", argv[i]);
+    }
+
+    // silent mode has priority
+    if (silent)
+        verbose = false;
+
+    if (batch)
+    {
+        const int numError = convertBatch(argv[2], numThread);
+
+        if (numError < 0) return 2;
+        if (numError > 0) return 5;
+        return 0;
+    }
+
+    return convert(argv[1], argv[2]);
 }
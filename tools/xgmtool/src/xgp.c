@@ -0,0 +1,713 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../inc/xgmtool.h"
+#include "../inc/xgp.h"
+#include "../inc/xgmcom.h"
+#include "../inc/xgmsmp.h"
+#include "../inc/util.h"
+
+
+#define HASH_SIZE       4096
+#define MAX_CANDIDATE   256
+
+
+// compiled XGP command
+typedef struct
+{
+    unsigned char data[1 + (16 * 2)];
+    int size;
+    // offset in music data bloc
+    int offset;
+    // -1 = literal, >= 0 = replaced by a reference to this command (first command of the reference block), -2 = part of a replaced block
+    int ref;
+    // number of command in the reference block
+    int refLen;
+    // can be part of a reference block (not a loop or end command)
+    bool canRef;
+    unsigned int hash;
+} XGPCommand;
+
+typedef struct
+{
+    XGPCommand* commands;
+    int num;
+    int allocated;
+} XGPCommandList;
+
+
+static XGPCommand* XGP_addCommand(XGPCommandList* list, int command, unsigned char* data, int size);
+static void XGP_addWait(XGPCommandList* list, int frames);
+static void XGP_addYMPortCommands(XGPCommandList* list, XGMCommand* command);
+static void XGP_compress(XGPCommandList* list, int loopIndex);
+static int XGP_computeOffsets(XGPCommandList* list);
+static bool XGP_isSameCommand(XGPCommand* com1, XGPCommand* com2);
+static void XGP_parseMusic(XGM* xgm, unsigned char* data, int offset, int size, LList** commands, XGMCommand** offsetMap, int *loopOffset);
+
+
+unsigned char* XGP_asByteArray(XGM* xgm, int *outSize)
+{
+    XGPCommandList list;
+    LList* com;
+    LList* loopElement;
+    int loopIndex;
+    int frames;
+    int i, s;
+    int offset;
+    unsigned char byte;
+    FILE* f;
+
+    if (!silent)
+        printf("Converting to XGP...\n");
+
+    list.commands = NULL;
+    list.num = 0;
+    list.allocated = 0;
+
+    XGM_computeAllOffset(xgm);
+    loopElement = XGM_getLoopPointedCommandElement(xgm);
+    loopIndex = -1;
+    frames = 0;
+
+    com = xgm->commands;
+    while(com != NULL)
+    {
+        XGMCommand* command = com->element;
+
+        // loop start --> flush pending wait so loop point is a command boundary
+        if (com == loopElement)
+        {
+            XGP_addWait(&list, frames);
+            frames = 0;
+            loopIndex = list.num;
+        }
+
+        // consecutive frames are merged in a single wait command
+        if (XGMCommand_isFrame(command)) frames++;
+        else
+        {
+            XGP_addWait(&list, frames);
+            frames = 0;
+
+            if (XGMCommand_isPSGWrite(command))
+                XGP_addCommand(&list, XGP_PSG | (command->data[0] & 0x0F), command->data + 1, command->size - 1);
+            else if (XGMCommand_isYM2612Write(command))
+                XGP_addYMPortCommands(&list, command);
+            else if (XGMCommand_isYM2612RegKeyWrite(command))
+                XGP_addCommand(&list, XGP_YM2612_REGKEY | (command->data[0] & 0x0F), command->data + 1, command->size - 1);
+            else if (XGMCommand_isPCM(command))
+                XGP_addCommand(&list, XGP_PCM | (command->data[0] & 0x0F), command->data + 1, 1);
+            else if (XGMCommand_isLoop(command))
+            {
+                unsigned char offs[3] = { 0, 0, 0 };
+                XGP_addCommand(&list, XGP_LOOP, offs, 3)->canRef = false;
+            }
+            else if (XGMCommand_isEnd(command))
+                XGP_addCommand(&list, XGP_END, NULL, 0)->canRef = false;
+        }
+
+        com = com->next;
+    }
+
+    // last frames
+    XGP_addWait(&list, frames);
+
+    const int rawSize = XGP_computeOffsets(&list);
+
+    // replace repeated command blocks by reference commands
+    XGP_compress(&list, loopIndex);
+
+    const int len = XGP_computeOffsets(&list);
+
+    if (verbose)
+    {
+        printf("XGP number of command: %d\n", list.num);
+        printf("XGP music data size: %d (%d before reference compression)\n", len, rawSize);
+    }
+
+    f = openTempFile();
+    if (f == NULL)
+    {
+        printf("Error: cannot open temporary file\n");
+        free(list.commands);
+        return NULL;
+    }
+
+    // 0000-00FB: sample id table
+    // fixed size : 252 bytes, limit music to 63 samples max
+    offset = 0;
+    s = 0;
+    com = xgm->samples;
+    while(com != NULL)
+    {
+        XGMSample* sample = com->element;
+        const int slen = sample->dataSize;
+
+        byte = offset >> 8;
+        fwrite(&byte, 1, 1, f);
+        byte = offset >> 16;
+        fwrite(&byte, 1, 1, f);
+        byte = slen >> 8;
+        fwrite(&byte, 1, 1, f);
+        byte = slen >> 16;
+        fwrite(&byte, 1, 1, f);
+
+        offset += slen;
+        s++;
+        com = com->next;
+    }
+    for (; s < 0x3F; s++)
+    {
+        // special mark for silent sample
+        byte = 0xFF;
+        fwrite(&byte, 1, 1, f);
+        fwrite(&byte, 1, 1, f);
+        byte = 0x01;
+        fwrite(&byte, 1, 1, f);
+        byte = 0x00;
+        fwrite(&byte, 1, 1, f);
+    }
+
+    // 00FC-00FD: sample block size *256 (2 bytes)
+    byte = offset >> 8;
+    fwrite(&byte, 1, 1, f);
+    byte = offset >> 16;
+    fwrite(&byte, 1, 1, f);
+
+    // init PAL flag if needed (default is NTSC)
+    if (xgm->pal == -1)
+        xgm->pal = 0;
+
+    // 00FE: XGP version
+    byte = 0x01;
+    fwrite(&byte, 1, 1, f);
+    // 00FF: misc info
+    byte = 0x00;
+    // b0=NTSC/PAL
+    byte |= xgm->pal?1:0;
+    // b1=XD3 tags (not yet supported), b2=multi track, others=reserved
+    fwrite(&byte, 1, 1, f);
+
+    // 0100-XXXX: sample data
+    com = xgm->samples;
+    while(com != NULL)
+    {
+        XGMSample* sample = com->element;
+        fwrite(sample->data, 1, sample->dataSize, f);
+        com = com->next;
+    }
+
+    // XXXX+0000: music data size (in byte)
+    byte = len >> 0;
+    fwrite(&byte, 1, 1, f);
+    byte = len >> 8;
+    fwrite(&byte, 1, 1, f);
+    byte = len >> 16;
+    fwrite(&byte, 1, 1, f);
+    byte = len >> 24;
+    fwrite(&byte, 1, 1, f);
+
+    // XXXX+0004: music data
+    for (i = 0; i < list.num; i++)
+    {
+        XGPCommand* command = &list.commands[i];
+
+        if (command->ref == -1)
+        {
+            // set loop offset
+            if ((command->data[0] == XGP_LOOP) && (loopIndex != -1))
+                setInt24(command->data, 1, list.commands[loopIndex].offset);
+
+            fwrite(command->data, 1, command->size, f);
+        }
+        else if (command->ref >= 0)
+        {
+            unsigned char ref[5];
+            int size = 0;
+
+            for (s = 0; s < command->refLen; s++)
+                size += list.commands[i + s].size;
+
+            ref[0] = XGP_REF;
+            setInt24(ref, 1, list.commands[command->ref].offset);
+            ref[4] = size;
+
+            fwrite(ref, 1, 5, f);
+        }
+    }
+
+    // XXXX+0004+len: end of track list (multi track not yet supported)
+    byte = 0;
+    fwrite(&byte, 1, 1, f);
+    fwrite(&byte, 1, 1, f);
+    fwrite(&byte, 1, 1, f);
+    fwrite(&byte, 1, 1, f);
+
+    free(list.commands);
+
+    *outSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    unsigned char* result = malloc(*outSize);
+
+    if (fread(result, 1, *outSize, f) != (size_t) *outSize)
+        printf("Error: cannot read temporary file\n");
+
+    fclose(f);
+
+    if (!silent)
+        printf("XGP music data size: %d bytes\n", len);
+
+    return result;
+}
+
+XGM* XGM_createFromXGPData(unsigned char* data, int dataSize)
+{
+    int s;
+    XGM* result = XGM_create();
+
+    if (!silent)
+        printf("Parsing XGM from XGP file...\n");
+
+    // sample table + header + music data size
+    if (dataSize < 0x104)
+    {
+        printf("Error: XGP file is too small !\n");
+        return NULL;
+    }
+
+    // sample id table
+    LList* samples = NULL;
+    for (s = 0; s < 0x3F; s++)
+    {
+        int offset = getInt16(data, (s * 4) + 0);
+        int len = getInt16(data, (s * 4) + 2);
+
+        // ignore empty sample
+        if ((offset != 0xFFFF) && (len != 0x0001))
+        {
+            offset <<= 8;
+            len <<= 8;
+
+            // add sample
+            samples = insertAfterLList(samples, XGMSample_create(s + 1, data + (offset + 0x100), len, offset));
+        }
+    }
+
+    result->samples = getHeadLList(samples);
+
+    // calculate music data offset (sample block size + 0x100)
+    int offset = (getInt16(data, 0xFC) << 8) + 0x100;
+    result->pal = data[0xFF] & 1;
+
+    if ((offset + 4) > dataSize)
+    {
+        printf("Error: XGP sample data bloc exceeds file size !\n");
+        return NULL;
+    }
+
+    // get music data length
+    int len = getInt(data, offset);
+
+    if ((len < 0) || ((offset + 4 + len) > dataSize))
+    {
+        printf("Error: XGP music data bloc exceeds file size !\n");
+        return NULL;
+    }
+
+    if (verbose)
+    {
+        printf("XGP sample number: %d\n", getSizeLList(result->samples));
+        printf("XGP start music data: %6X  len: %d\n", offset + 4, len);
+    }
+
+    // first XGM command built from each XGP command (used to retrieve loop point)
+    XGMCommand** offsetMap = calloc(len + 1, sizeof(XGMCommand*));
+    LList* commands = NULL;
+    int loopOffset = -1;
+
+    XGP_parseMusic(result, data + offset + 4, 0, len, &commands, offsetMap, &loopOffset);
+    result->commands = getHeadLList(commands);
+
+    // set loop offset
+    if (loopOffset != -1)
+    {
+        XGMCommand* loopCommand = XGM_getLoopCommand(result);
+        XGMCommand* target = ((loopOffset >= 0) && (loopOffset < len))?offsetMap[loopOffset]:NULL;
+
+        XGM_computeAllOffset(result);
+
+        if ((loopCommand != NULL) && (target != NULL))
+            setInt24(loopCommand->data, 1, target->offset);
+        else
+            printf("Warning: incorrect XGP loop offset %6X (ignored)\n", loopOffset);
+    }
+
+    free(offsetMap);
+
+    if (!silent)
+        printf("XGM duration: %d frames (%d seconds)\n", XGM_computeLenInFrame(result), XGM_computeLenInSecond(result));
+
+    return result;
+}
+
+
+static XGPCommand* XGP_addCommand(XGPCommandList* list, int command, unsigned char* data, int size)
+{
+    XGPCommand* result;
+    int i;
+
+    if (list->num >= list->allocated)
+    {
+        list->allocated = max(1024, list->allocated * 2);
+        list->commands = realloc(list->commands, list->allocated * sizeof(XGPCommand));
+    }
+
+    result = &list->commands[list->num++];
+
+    result->data[0] = command;
+    if (size > 0) memcpy(result->data + 1, data, size);
+    result->size = size + 1;
+    result->offset = 0;
+    result->ref = -1;
+    result->refLen = 0;
+    result->canRef = true;
+
+    // FNV-1a hash
+    result->hash = 2166136261u;
+    for (i = 0; i < result->size; i++)
+        result->hash = (result->hash ^ result->data[i]) * 16777619u;
+
+    return result;
+}
+
+static void XGP_addWait(XGPCommandList* list, int frames)
+{
+    unsigned char data[2];
+    int remain = frames;
+
+    while(remain > 0)
+    {
+        if (remain <= 14)
+        {
+            XGP_addCommand(list, XGP_WAIT_SHORT | (remain - 1), NULL, 0);
+            remain = 0;
+        }
+        else if (remain <= (15 + 255))
+        {
+            data[0] = remain - 15;
+            XGP_addCommand(list, XGP_WAIT_MEDIUM, data, 1);
+            remain = 0;
+        }
+        else
+        {
+            const int w = min(remain, 0x10000);
+
+            data[0] = (w - 1) >> 0;
+            data[1] = (w - 1) >> 8;
+            XGP_addCommand(list, XGP_WAIT_LONG, data, 2);
+            remain -= w;
+        }
+    }
+}
+
+static void XGP_addYMPortCommands(XGPCommandList* list, XGMCommand* command)
+{
+    unsigned char pending[16 * 2];
+    const int port = XGMCommand_getYM2612Port(command);
+    const int num = XGMCommand_getYM2612WriteCount(command);
+    const int baseCom = port?XGP_YM2612_PORT1:XGP_YM2612_PORT0;
+    unsigned char* d = command->data + 1;
+    int numPending = 0;
+    int i;
+
+    for (i = 0; i < num; i++)
+    {
+        const int reg = d[(i * 2) + 0];
+        const int value = d[(i * 2) + 1];
+        int special = -1;
+
+        // frequency set: MSB ($A4-$A6 or CH3 special mode $AC-$AE) directly followed by LSB
+        if ((i + 1) < num)
+        {
+            if ((reg >= 0xA4) && (reg <= 0xA6) && ((d[(i * 2) + 2]) == (reg - 4)))
+                special = XGP_YM2612_FREQ | (reg - 0xA4) | (port << 3);
+            else if ((port == 0) && (reg >= 0xAC) && (reg <= 0xAE) && ((d[(i * 2) + 2]) == (reg - 4)))
+                special = XGP_YM2612_FREQ | (reg - 0xAC) | 4;
+        }
+        // global registers
+        if ((special == -1) && (port == 0))
+        {
+            if (reg == 0x22) special = XGP_YM2612_LFO;
+            else if (reg == 0x27) special = XGP_YM2612_CH3;
+            else if (reg == 0x2B) special = XGP_YM2612_DAC;
+        }
+
+        if (special != -1)
+        {
+            unsigned char data[2];
+
+            // keep write order
+            if (numPending)
+            {
+                XGP_addCommand(list, baseCom | (numPending - 1), pending, numPending * 2);
+                numPending = 0;
+            }
+
+            data[0] = value;
+
+            if ((special & 0xF0) == XGP_YM2612_FREQ)
+            {
+                // LSB
+                data[1] = d[(i * 2) + 3];
+                XGP_addCommand(list, special, data, 2);
+                i++;
+            }
+            else XGP_addCommand(list, special, data, 1);
+        }
+        else
+        {
+            pending[(numPending * 2) + 0] = reg;
+            pending[(numPending * 2) + 1] = value;
+            numPending++;
+
+            if (numPending == 16)
+            {
+                XGP_addCommand(list, baseCom | (numPending - 1), pending, numPending * 2);
+                numPending = 0;
+            }
+        }
+    }
+
+    if (numPending)
+        XGP_addCommand(list, baseCom | (numPending - 1), pending, numPending * 2);
+}
+
+static void XGP_compress(XGPCommandList* list, int loopIndex)
+{
+    XGPCommand* coms = list->commands;
+    const int num = list->num;
+    int* head = malloc(HASH_SIZE * sizeof(int));
+    int* chain = malloc(max(1, num) * sizeof(int));
+    int i;
+
+    for (i = 0; i < HASH_SIZE; i++)
+        head[i] = -1;
+
+    i = 0;
+    while(i < num)
+    {
+        const unsigned int h = coms[i].hash & (HASH_SIZE - 1);
+        int bestSrc = -1;
+        int bestLen = 0;
+        int bestSize = 0;
+
+        if (coms[i].canRef)
+        {
+            int cand = head[h];
+            int depth = 0;
+
+            while((cand != -1) && (depth++ < MAX_CANDIDATE))
+            {
+                int len = 0;
+                int size = 0;
+
+                // source block: literal commands located before the replaced block
+                // replaced block: can't contain the loop point (except as first command)
+                while(((i + len) < num) && ((cand + len) < i) &&
+                      (coms[cand + len].ref == -1) && coms[cand + len].canRef && coms[i + len].canRef &&
+                      ((len == 0) || ((i + len) != loopIndex)) &&
+                      ((size + coms[i + len].size) <= XGP_REF_MAX) &&
+                      XGP_isSameCommand(&coms[cand + len], &coms[i + len]))
+                {
+                    size += coms[i + len].size;
+                    len++;
+                }
+
+                if (size > bestSize)
+                {
+                    bestSrc = cand;
+                    bestLen = len;
+                    bestSize = size;
+                }
+
+                cand = chain[cand];
+            }
+        }
+
+        // reference command is 5 bytes long
+        if (bestSize >= XGP_REF_MIN)
+        {
+            int k;
+
+            coms[i].ref = bestSrc;
+            coms[i].refLen = bestLen;
+            // replaced commands can't be used as source
+            for (k = 1; k < bestLen; k++)
+                coms[i + k].ref = -2;
+
+            i += bestLen;
+        }
+        else
+        {
+            chain[i] = head[h];
+            head[h] = i;
+            i++;
+        }
+    }
+
+    free(head);
+    free(chain);
+}
+
+static int XGP_computeOffsets(XGPCommandList* list)
+{
+    int offset = 0;
+    int i;
+
+    for (i = 0; i < list->num; i++)
+    {
+        XGPCommand* command = &list->commands[i];
+
+        command->offset = offset;
+
+        if (command->ref == -1) offset += command->size;
+        else if (command->ref >= 0) offset += 5;
+    }
+
+    return offset;
+}
+
+static bool XGP_isSameCommand(XGPCommand* com1, XGPCommand* com2)
+{
+    if ((com1->hash != com2->hash) || (com1->size != com2->size))
+        return false;
+
+    return arrayEquals(com1->data, com2->data, com1->size);
+}
+
+static XGMCommand* XGP_createXGMCommand(int command, unsigned char* data, int size)
+{
+    unsigned char* d = malloc(size + 1);
+
+    d[0] = command;
+    if (size > 0) memcpy(d + 1, data, size);
+
+    return XGMCommand_create(d, size + 1);
+}
+
+static void XGP_parseMusic(XGM* xgm, unsigned char* data, int offset, int size, LList** commands, XGMCommand** offsetMap, int *loopOffset)
+{
+    int off = offset;
+
+    while(off < (offset + size))
+    {
+        unsigned char* d = data + off;
+        const int com = d[0];
+        const int x = com & 0x0F;
+        LList* first = *commands;
+        int frames = 0;
+        int len = 1;
+
+        switch(com & 0xF0)
+        {
+            case 0x00:
+                if (x == 0x0E)
+                {
+                    frames = d[1] + 15;
+                    len = 2;
+                }
+                else if (x == 0x0F)
+                {
+                    frames = (d[1] | (d[2] << 8)) + 1;
+                    len = 3;
+                }
+                else frames = x + 1;
+
+                while(frames--)
+                    *commands = insertAfterLList(*commands, XGMCommand_createFrameCommand());
+                break;
+
+            case XGP_PSG:
+                len = x + 2;
+                *commands = insertAfterLList(*commands, XGP_createXGMCommand(XGM_PSG | x, d + 1, x + 1));
+                break;
+
+            case XGP_YM2612_PORT0:
+            case XGP_YM2612_PORT1:
+                len = ((x + 1) * 2) + 1;
+                *commands = insertAfterLList(*commands, XGP_createXGMCommand((((com & 0xF0) == XGP_YM2612_PORT0)?XGM_YM2612_PORT0:XGM_YM2612_PORT1) | x, d + 1, (x + 1) * 2));
+                break;
+
+            case XGP_YM2612_FREQ:
+            {
+                unsigned char regs[4];
+
+                len = 3;
+                regs[0] = ((x & 4)?0xAC:0xA4) + (x & 3);
+                regs[1] = d[1];
+                regs[2] = regs[0] - 4;
+                regs[3] = d[2];
+                *commands = insertAfterLList(*commands, XGP_createXGMCommand(((x & 8)?XGM_YM2612_PORT1:XGM_YM2612_PORT0) | 1, regs, 4));
+                break;
+            }
+
+            case XGP_YM2612_REGKEY:
+                len = x + 2;
+                *commands = insertAfterLList(*commands, XGP_createXGMCommand(XGM_YM2612_REGKEY | x, d + 1, x + 1));
+                break;
+
+            case XGP_PCM:
+                len = 2;
+                *commands = insertAfterLList(*commands, XGP_createXGMCommand(XGM_PCM | x, d + 1, 1));
+                break;
+
+            case 0x70:
+                if (com <= XGP_YM2612_DAC)
+                {
+                    unsigned char regs[2];
+
+                    len = 2;
+                    regs[0] = (com == XGP_YM2612_LFO)?0x22:((com == XGP_YM2612_CH3)?0x27:0x2B);
+                    regs[1] = d[1];
+                    *commands = insertAfterLList(*commands, XGP_createXGMCommand(XGM_YM2612_PORT0 | 0, regs, 2));
+                }
+                else if (com == XGP_REF)
+                {
+                    len = 5;
+
+                    // nested reference isn't allowed
+                    if (offsetMap != NULL)
+                        XGP_parseMusic(xgm, data, getInt24(d, 1), d[4], commands, NULL, loopOffset);
+                    else
+                        printf("Warning: nested XGP reference command at %6X (ignored)\n", off);
+                }
+                else if (com == XGP_LOOP)
+                {
+                    len = 4;
+                    *loopOffset = getInt24(d, 1);
+                    *commands = insertAfterLList(*commands, XGMCommand_createLoopCommand(0));
+                }
+                else if (com == XGP_END)
+                {
+                    *commands = insertAfterLList(*commands, XGMCommand_createEndCommand());
+                    // stop here
+                    if (offsetMap != NULL)
+                        off = offset + size;
+                }
+                else printf("Warning: unknown XGP command %2X at %6X (ignored)\n", com, off);
+                break;
+
+            default:
+                printf("Warning: unknown XGP command %2X at %6X (ignored)\n", com, off);
+                break;
+        }
+
+        // keep trace of first XGM command for this XGP command
+        if ((offsetMap != NULL) && (off < (offset + size)) && (*commands != first))
+            offsetMap[off] = (first != NULL)?first->next->element:getHeadLList(*commands)->element;
+
+        off += len;
+    }
+}